@@ -200,6 +200,7 @@ def envoy_dependencies(skip_targets = []):
     _com_google_protobuf()
     _com_github_envoyproxy_sqlparser()
     _com_googlesource_quiche()
+    _com_googlesource_code_re2()
 
     # Used for bundling gcovr into a relocatable .par file.
     _repository_impl("subpar")
@@ -435,6 +436,13 @@ def _com_google_googletest():
 # the direct Bazel path at all sites.  This will make it easier to
 # pull in more bits of abseil as needed, and is now the preferred
 # method for pure Bazel deps.
+def _com_googlesource_code_re2():
+    _repository_impl("com_googlesource_code_re2")
+    native.bind(
+        name = "re2",
+        actual = "@com_googlesource_code_re2//:re2",
+    )
+
 def _com_google_absl():
     _repository_impl("com_google_absl")
     native.bind(
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/compressor/compressor.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/filter_config.h"
+
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace Compressor {
+
+/**
+ * Creates the compressors of a compressor library, one per compressed stream.
+ */
+class CompressorFactory {
+public:
+  virtual ~CompressorFactory() {}
+
+  /**
+   * @return CompressorPtr a new compressor, ready to compress a stream.
+   */
+  virtual CompressorPtr createCompressor() PURE;
+
+  /**
+   * @return const std::string& the content coding of the compressed streams, e.g. "gzip", as used
+   *         in the accept-encoding and content-encoding headers.
+   */
+  virtual const std::string& contentEncoding() const PURE;
+};
+
+typedef std::unique_ptr<CompressorFactory> CompressorFactoryPtr;
+
+/**
+ * Implemented by each compressor library, e.g. gzip, and registered via
+ * Registry::registerFactory() or the convenience class RegisterFactory.
+ */
+class NamedCompressorLibraryConfigFactory {
+public:
+  virtual ~NamedCompressorLibraryConfigFactory() {}
+
+  /**
+   * Create a particular CompressorFactory implementation. If the implementation is unable to
+   * produce a factory with the provided parameters, it should throw an EnvoyException. The
+   * returned pointer should always be valid.
+   * @param config supplies the library specific configuration, of the type returned by
+   *        createEmptyConfigProto().
+   * @param context supplies the context of the filter using the library.
+   */
+  virtual CompressorFactoryPtr
+  createCompressorFactoryFromProto(const Protobuf::Message& config,
+                                   Server::Configuration::FactoryContext& context) PURE;
+
+  /**
+   * @return ProtobufTypes::MessagePtr an empty library specific configuration.
+   */
+  virtual ProtobufTypes::MessagePtr createEmptyConfigProto() PURE;
+
+  /**
+   * @return std::string the identifying name for a particular implementation of a compressor
+   *         library produced by the factory.
+   */
+  virtual std::string name() const PURE;
+};
+
+} // namespace Compressor
+} // namespace Envoy
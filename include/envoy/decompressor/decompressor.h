@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "envoy/buffer/buffer.h"
 
 namespace Envoy {
@@ -19,7 +21,23 @@ public:
    */
   virtual void decompress(const Buffer::Instance& input_buffer,
                           Buffer::Instance& output_buffer) PURE;
+
+  /**
+   * Decompresses data received from a peer, which may be malformed or expand to more data than the
+   * receiver is willing to hold, from one buffer into another buffer.
+   * @param input_buffer supplies the buffer with compressed data.
+   * @param output_buffer supplies the buffer to output decompressed data.
+   * @param max_output_bytes supplies the maximum number of bytes to output. The decompression
+   *        stops once the output reaches it, after outputting at most one chunk of the
+   *        decompressor's output beyond it.
+   * @return bool false if the compressed data is malformed or its decompressed data exceeds
+   *         max_output_bytes, in which case the decompressor must not be used anymore.
+   */
+  virtual bool decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer,
+                          uint64_t max_output_bytes) PURE;
 };
 
+typedef std::unique_ptr<Decompressor> DecompressorPtr;
+
 } // namespace Decompressor
 } // namespace Envoy
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/decompressor/decompressor.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/filter_config.h"
+
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace Decompressor {
+
+/**
+ * Creates the decompressors of a decompressor library, one per compressed stream.
+ */
+class DecompressorFactory {
+public:
+  virtual ~DecompressorFactory() {}
+
+  /**
+   * @return DecompressorPtr a new decompressor, ready to decompress a stream.
+   */
+  virtual DecompressorPtr createDecompressor() PURE;
+
+  /**
+   * @return const std::string& the content coding of the decompressed streams, e.g. "gzip", as
+   *         used in the content-encoding header.
+   */
+  virtual const std::string& contentEncoding() const PURE;
+};
+
+typedef std::unique_ptr<DecompressorFactory> DecompressorFactoryPtr;
+
+/**
+ * Implemented by each decompressor library, e.g. gzip, and registered via
+ * Registry::registerFactory() or the convenience class RegisterFactory.
+ */
+class NamedDecompressorLibraryConfigFactory {
+public:
+  virtual ~NamedDecompressorLibraryConfigFactory() {}
+
+  /**
+   * Create a particular DecompressorFactory implementation. If the implementation is unable to
+   * produce a factory with the provided parameters, it should throw an EnvoyException. The
+   * returned pointer should always be valid.
+   * @param config supplies the library specific configuration, of the type returned by
+   *        createEmptyConfigProto().
+   * @param context supplies the context of the filter using the library.
+   */
+  virtual DecompressorFactoryPtr
+  createDecompressorFactoryFromProto(const Protobuf::Message& config,
+                                     Server::Configuration::FactoryContext& context) PURE;
+
+  /**
+   * @return ProtobufTypes::MessagePtr an empty library specific configuration.
+   */
+  virtual ProtobufTypes::MessagePtr createEmptyConfigProto() PURE;
+
+  /**
+   * @return std::string the identifying name for a particular implementation of a decompressor
+   *         library produced by the factory.
+   */
+  virtual std::string name() const PURE;
+};
+
+} // namespace Decompressor
+} // namespace Envoy
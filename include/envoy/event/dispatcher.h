@@ -17,11 +17,32 @@
 #include "envoy/network/listen_socket.h"
 #include "envoy/network/listener.h"
 #include "envoy/network/transport_socket.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/thread/thread.h"
 
 namespace Envoy {
 namespace Event {
 
+/**
+ * All dispatcher stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_DISPATCHER_STATS(HISTOGRAM)                                                            \
+  HISTOGRAM(file_event_duration_us)                                                                \
+  HISTOGRAM(post_callback_duration_us)                                                             \
+  HISTOGRAM(post_delay_us)                                                                         \
+  HISTOGRAM(post_queue_depth)                                                                      \
+  HISTOGRAM(timer_duration_us)
+// clang-format on
+
+/**
+ * Struct definition for all dispatcher stats. @see stats_macros.h
+ */
+struct DispatcherStats {
+  ALL_DISPATCHER_STATS(GENERATE_HISTOGRAM_STRUCT)
+};
+
 /**
  * Callback invoked when a dispatcher post() runs.
  */
@@ -39,6 +60,16 @@ public:
    */
   virtual TimeSource& timeSource() PURE;
 
+  /**
+   * Start recording how long the callbacks run by this dispatcher take, and how long posted
+   * callbacks wait before they run. Recording is off until this is called, as it reads the clock
+   * around every callback. Must be called before run() or from the dispatcher's thread.
+   * @param scope the scope to create the stats in.
+   * @param prefix the prefix for the stats, e.g. "server." for stats named
+   *        "server.dispatcher.<stat>".
+   */
+  virtual void initializeStats(Stats::Scope& scope, const std::string& prefix) PURE;
+
   /**
    * Clear any items in the deferred deletion queue.
    */
@@ -104,19 +135,22 @@ public:
    * @param bind_to_port controls whether the listener binds to a transport port or not.
    * @param hand_off_restored_destination_connections controls whether the listener searches for
    *        another listener after restoring the destination address of a new connection.
+   * @param max_connections_to_accept_per_socket_event supplies the maximum number of connections
+   *        to accept each time the socket becomes readable.
    * @return Network::ListenerPtr a new listener that is owned by the caller.
    */
-  virtual Network::ListenerPtr createListener(Network::Socket& socket,
-                                              Network::ListenerCallbacks& cb, bool bind_to_port,
-                                              bool hand_off_restored_destination_connections) PURE;
+  virtual Network::ListenerPtr
+  createListener(Network::Socket& socket, Network::ListenerCallbacks& cb, bool bind_to_port,
+                 bool hand_off_restored_destination_connections,
+                 uint32_t max_connections_to_accept_per_socket_event) PURE;
 
   /**
    * Create a logical udp listener on a specific port.
    * @param socket supplies the socket to listen on.
    * @param cb supplies the udp listener callbacks to invoke for listener events.
-   * @return Network::ListenerPtr a new listener that is owned by the caller.
+   * @return Network::UdpListenerPtr a new listener that is owned by the caller.
    */
-  virtual Network::ListenerPtr createUdpListener(Network::Socket& socket,
+  virtual Network::UdpListenerPtr createUdpListener(Network::Socket& socket,
                                                  Network::UdpListenerCallbacks& cb) PURE;
   /**
    * Allocate a timer. @see Timer for docs on how to use the timer.
@@ -124,6 +158,15 @@ public:
    */
   virtual Event::TimerPtr createTimer(TimerCb cb) PURE;
 
+  /**
+   * Allocate a coarse timer, which is rounded up to the next millisecond and may fire up to a
+   * millisecond late, but which is cheaper to enable and disable than a timer allocated by
+   * createTimer(). Suited to idle and request timeouts, which are re-armed often and rarely fire.
+   * @see Timer for docs on how to use the timer.
+   * @param cb supplies the callback to invoke when the timer fires.
+   */
+  virtual Event::TimerPtr createCoarseTimer(TimerCb cb) PURE;
+
   /**
    * Submit an item for deferred delete. @see DeferredDeletable.
    */
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #include "envoy/buffer/buffer.h"
 #include "envoy/common/pure.h"
@@ -10,6 +12,8 @@
 #include "envoy/http/metadata_interface.h"
 #include "envoy/http/protocol.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Http {
 
@@ -216,6 +220,10 @@ struct Http1Settings {
   bool accept_http_10_{false};
   // Set a default host if no Host: header is present for HTTP/1.0 requests.`
   std::string default_host_for_http_10_;
+  // The maximum number of requests outstanding on a connection at once. 1 disables pipelining.
+  uint32_t max_pipelined_requests_{1};
+  // The time an upstream pipelined connection may wait for the response to its oldest request.
+  absl::optional<std::chrono::milliseconds> pipeline_head_of_line_timeout_;
 };
 
 /**
@@ -229,6 +237,20 @@ struct Http2Settings {
   uint32_t initial_connection_window_size_{DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE};
   bool allow_connect_{DEFAULT_ALLOW_CONNECT};
   bool allow_metadata_{DEFAULT_ALLOW_METADATA};
+  // Upper bound on the dynamic table size used by the HPACK encoder. The peer's
+  // SETTINGS_HEADER_TABLE_SIZE may lower it further. Unset means hpack_table_size_.
+  absl::optional<uint32_t> hpack_encoder_table_size_;
+  // Headers that are always encoded as never indexed literals, so that neither this encoder nor
+  // any intermediary adds their values to a dynamic table.
+  std::vector<LowerCaseString> never_index_headers_;
+  // Upstream connection pools only: number of connections to spread streams over per host.
+  uint32_t max_connections_per_host_{DEFAULT_MAX_CONNECTIONS_PER_HOST};
+  // Size that the receive windows grow to as the bandwidth-delay product estimate of the
+  // connection grows. Unset, or at most initial_stream_window_size_, keeps the windows fixed.
+  absl::optional<uint32_t> max_adaptive_window_size_;
+
+  // one connection per host, on which all streams are multiplexed
+  static const uint32_t DEFAULT_MAX_CONNECTIONS_PER_HOST = 1;
 
   // disable HPACK compression
   static const uint32_t MIN_HPACK_TABLE_SIZE = 0;
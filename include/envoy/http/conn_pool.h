@@ -6,6 +6,7 @@
 #include "envoy/common/pure.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/http/codec.h"
+#include "envoy/stream_info/stream_info.h"
 #include "envoy/upstream/upstream.h"
 
 namespace Envoy {
@@ -58,9 +59,12 @@ public:
    * @param encoder supplies the request encoder to use.
    * @param host supplies the description of the host that will carry the request. For logical
    *             connection pools the description may be different each time this is called.
+   * @param info supplies the stream info of the connection that will carry the request, e.g. the
+   *             timings of its establishment.
    */
   virtual void onPoolReady(Http::StreamEncoder& encoder,
-                           Upstream::HostDescriptionConstSharedPtr host) PURE;
+                           Upstream::HostDescriptionConstSharedPtr host,
+                           const StreamInfo::StreamInfo& info) PURE;
 };
 
 /**
@@ -102,6 +106,13 @@ public:
    */
   virtual bool hasActiveConnections() const PURE;
 
+  /**
+   * Establish a connection ahead of any stream if the pool has no connection yet, so that the
+   * first stream does not wait for the connection handshake. This is a noop if the cluster's
+   * circuit breakers do not allow another connection.
+   */
+  virtual void prefetchConnection() PURE;
+
   /**
    * Create a new stream on the pool.
    * @param response_decoder supplies the decoder events to fire when the response is
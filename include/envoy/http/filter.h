@@ -12,6 +12,7 @@
 #include "envoy/http/header_map.h"
 #include "envoy/router/router.h"
 #include "envoy/ssl/connection.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/tracing/http_tracer.h"
 #include "envoy/upstream/upstream.h"
 
@@ -636,6 +637,28 @@ class StreamFilter : public virtual StreamDecoderFilter, public virtual StreamEn
 
 typedef std::shared_ptr<StreamFilter> StreamFilterSharedPtr;
 
+/**
+ * All stats of the time spent in an HTTP filter, in microseconds. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_HTTP_FILTER_TIMING_STATS(HISTOGRAM)                                                    \
+  HISTOGRAM(decode_headers_us)                                                                     \
+  HISTOGRAM(decode_data_us)                                                                        \
+  HISTOGRAM(decode_trailers_us)                                                                    \
+  HISTOGRAM(decode_stopped_us)                                                                     \
+  HISTOGRAM(encode_headers_us)                                                                     \
+  HISTOGRAM(encode_data_us)                                                                        \
+  HISTOGRAM(encode_trailers_us)                                                                    \
+  HISTOGRAM(encode_stopped_us)
+// clang-format on
+
+/**
+ * Struct definition for all the stats of the time spent in an HTTP filter. @see stats_macros.h
+ */
+struct FilterTimingStats {
+  ALL_HTTP_FILTER_TIMING_STATS(GENERATE_HISTOGRAM_STRUCT)
+};
+
 /**
  * These callbacks are provided by the connection manager to the factory so that the factory can
  * build the filter chain in an application specific way.
@@ -667,6 +690,14 @@ public:
    * @param handler supplies the handler to add.
    */
   virtual void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) PURE;
+
+  /**
+   * Set the stats that the time spent in the filters added from now on is recorded in, until they
+   * are set again.
+   * @param stats supplies the stats, or nullptr for the filters added from now on not to be timed.
+   *        The stats must outlive the stream.
+   */
+  virtual void setFilterTimingStats(FilterTimingStats* stats) PURE;
 };
 
 /**
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -65,12 +66,15 @@ typedef std::unordered_set<LowerCaseString, LowerCaseStringHash> LowerCaseStrUno
 typedef std::vector<std::pair<const Http::LowerCaseString, const std::string>>
     LowerCaseStrPairVector;
 
+class HeaderArena; // Defined in common/http/header_arena.h.
+
 /**
  * This is a string implementation for use in header processing. It is heavily optimized for
  * performance. It supports 3 different types of storage and can switch between them:
  * 1) A reference.
  * 2) Interned string.
- * 3) Heap allocated storage.
+ * 3) Heap allocated storage. If the string was constructed with a HeaderArena, this storage is
+ *    allocated from the arena instead of the heap.
  */
 class HeaderString {
 public:
@@ -95,6 +99,13 @@ public:
    */
   explicit HeaderString(const std::string& ref_value);
 
+  /**
+   * Constructor for inline storage that allocates any larger storage from an arena.
+   * @param arena supplies the arena, or nullptr to use the heap. The arena MUST outlive the string
+   *        and any string it is moved into, since the arena travels with the string on a move.
+   */
+  explicit HeaderString(HeaderArena* arena);
+
   HeaderString(HeaderString&& move_value);
   ~HeaderString();
 
@@ -182,6 +193,7 @@ private:
     uint32_t dynamic_capacity_;
   };
 
+  char* allocateDynamic(uint64_t capacity);
   void freeDynamic();
   // Used by ASSERTs to validate internal consistency. E.g. valid HTTP header keys/values should
   // never contain embedded NULLs.
@@ -189,6 +201,7 @@ private:
 
   uint32_t string_length_;
   Type type_;
+  HeaderArena* arena_{};
 };
 
 /**
@@ -499,6 +512,20 @@ public:
    */
   virtual void removePrefix(const LowerCaseString& prefix) PURE;
 
+  /**
+   * Predicate for removeIf().
+   * @param header supplies the header to test.
+   * @return bool whether to remove the header.
+   */
+  typedef std::function<bool(const HeaderEntry& header)> HeaderMatchPredicate;
+
+  /**
+   * Remove all headers that match a predicate, in a single pass over the map. This is cheaper than
+   * a remove() per key when removing several keys that are not inline headers.
+   * @param predicate supplies the predicate, which is called once per header.
+   */
+  virtual void removeIf(const HeaderMatchPredicate& predicate) PURE;
+
   /**
    * @return the number of headers in the map.
    */
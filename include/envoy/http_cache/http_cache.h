@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/common/time.h"
+#include "envoy/http/header_map.h"
+
+namespace Envoy {
+namespace HttpCache {
+
+/**
+ * A response stored in an HTTP cache. Entries are not modified once they are inserted, so that the
+ * streams of all the workers can share them.
+ */
+struct CacheEntry {
+  // The headers of the response. nullptr for an entry that only records the request headers that
+  // the responses of its key vary on.
+  Http::HeaderMapPtr headers_;
+  // The body of the response.
+  std::shared_ptr<const std::string> body_;
+  // When the response was received.
+  SystemTime response_time_;
+  // The lowercase names of the request headers listed by the vary header of the response.
+  std::vector<std::string> vary_;
+};
+
+typedef std::shared_ptr<const CacheEntry> CacheEntryConstSharedPtr;
+
+/**
+ * The storage of the responses of an HTTP cache. A storage is shared by the workers, so that its
+ * implementations must be thread safe.
+ */
+class HttpCache {
+public:
+  virtual ~HttpCache() {}
+
+  /**
+   * @param key supplies the key of a response.
+   * @return CacheEntryConstSharedPtr the entry stored under the key, nullptr if there is none.
+   */
+  virtual CacheEntryConstSharedPtr lookup(const std::string& key) PURE;
+
+  /**
+   * Store an entry under a key, replacing the entry already stored under it. The storage may
+   * evict entries, including this one, to bound its size.
+   * @param key supplies the key of the response.
+   * @param entry supplies the entry.
+   */
+  virtual void insert(const std::string& key, CacheEntryConstSharedPtr entry) PURE;
+
+  /**
+   * Remove the entry stored under a key, if any.
+   * @param key supplies the key of the response.
+   */
+  virtual void remove(const std::string& key) PURE;
+};
+
+typedef std::shared_ptr<HttpCache> HttpCacheSharedPtr;
+
+} // namespace HttpCache
+} // namespace Envoy
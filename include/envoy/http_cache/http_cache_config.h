@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+
+#include "envoy/http_cache/http_cache.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/filter_config.h"
+
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace HttpCache {
+
+/**
+ * Implemented by each HTTP cache storage, e.g. in-memory, and registered via
+ * Registry::registerFactory() or the convenience class RegisterFactory.
+ */
+class NamedHttpCacheConfigFactory {
+public:
+  virtual ~NamedHttpCacheConfigFactory() {}
+
+  /**
+   * Create a particular HttpCache implementation. If the implementation is unable to produce a
+   * storage with the provided parameters, it should throw an EnvoyException. The returned pointer
+   * should always be valid.
+   * @param config supplies the storage specific configuration, of the type returned by
+   *        createEmptyConfigProto().
+   * @param stats_prefix supplies the prefix of the stats of the storage.
+   * @param context supplies the context of the filter using the storage.
+   */
+  virtual HttpCacheSharedPtr
+  createHttpCacheFromProto(const Protobuf::Message& config, const std::string& stats_prefix,
+                           Server::Configuration::FactoryContext& context) PURE;
+
+  /**
+   * @return ProtobufTypes::MessagePtr an empty storage specific configuration.
+   */
+  virtual ProtobufTypes::MessagePtr createEmptyConfigProto() PURE;
+
+  /**
+   * @return std::string the identifying name for a particular implementation of an HTTP cache
+   *         storage produced by the factory.
+   */
+  virtual std::string name() const PURE;
+};
+
+} // namespace HttpCache
+} // namespace Envoy
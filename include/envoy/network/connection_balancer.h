@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/network/listen_socket.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A per worker handler of the connections of a listener, which a ConnectionBalancer can hand newly
+ * accepted sockets to.
+ */
+class BalancedConnectionHandler {
+public:
+  virtual ~BalancedConnectionHandler() {}
+
+  /**
+   * @return uint64_t the number of connections owned by the handler, including sockets that have
+   *         been handed to it but not yet processed. This may be called from any thread.
+   */
+  virtual uint64_t numConnections() const PURE;
+
+  /**
+   * Account for a socket that is about to be handed to the handler. This may be called from any
+   * thread.
+   */
+  virtual void incNumConnections() PURE;
+
+  /**
+   * Hand a socket to the handler. The socket will be processed on the handler's thread. This may be
+   * called from any thread.
+   * @param socket supplies the accepted socket.
+   */
+  virtual void post(ConnectionSocketPtr&& socket) PURE;
+};
+
+/**
+ * Balances the connections of a listener across the per worker handlers of that listener.
+ */
+class ConnectionBalancer {
+public:
+  virtual ~ConnectionBalancer() {}
+
+  /**
+   * Register a handler that sockets can be handed to. This may be called from any thread.
+   * @param handler supplies the handler.
+   */
+  virtual void registerHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Unregister a handler. Once this returns, no more sockets will be handed to the handler. This
+   * may be called from any thread.
+   * @param handler supplies the handler previously passed to registerHandler().
+   */
+  virtual void unregisterHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Decide which handler should own a newly accepted socket and hand the socket over to it if it is
+   * not the handler that accepted the socket. This is done before any listener filters run.
+   * @param current_handler supplies the handler that accepted the socket.
+   * @param socket supplies the socket. It is only moved from if it was handed over.
+   * @return bool true if the socket was handed to a different handler, false if current_handler
+   *         should process it.
+   */
+  virtual bool balance(BalancedConnectionHandler& current_handler,
+                       ConnectionSocketPtr& socket) PURE;
+};
+
+typedef std::unique_ptr<ConnectionBalancer> ConnectionBalancerPtr;
+
+} // namespace Network
+} // namespace Envoy
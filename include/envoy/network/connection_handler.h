@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <list>
 #include <memory>
 
 #include "envoy/network/connection.h"
@@ -25,7 +26,9 @@ public:
   virtual uint64_t numConnections() PURE;
 
   /**
-   * Adds listener to the handler.
+   * Adds listener to the handler. If the handler already has a listener with the same tag, that
+   * listener keeps its socket and connections and uses the new configuration from now on. This is
+   * used for updates that only change filter chains.
    * @param config listener configuration options.
    */
   virtual void addListener(ListenerConfig& config) PURE;
@@ -45,6 +48,15 @@ public:
    */
   virtual void removeListeners(uint64_t listener_tag) PURE;
 
+  /**
+   * Close the connections of a listener that were created from any of the given filter chains. The
+   * listener itself and its other connections are not affected.
+   * @param listener_tag supplies the tag passed to addListener().
+   * @param filter_chains supplies the filter chains whose connections should be closed.
+   */
+  virtual void removeFilterChains(uint64_t listener_tag,
+                                  const std::list<const FilterChain*>& filter_chains) PURE;
+
   /**
    * Stop listeners using the listener tag as a key. This will not close any connections and is used
    * for draining.
@@ -17,6 +17,8 @@ namespace Network {
 
 class Connection;
 class ConnectionSocket;
+class UdpListener;
+struct UdpData;
 
 /**
  * Status codes returned by filters that can cause future filters to not get iterated to.
@@ -239,6 +241,68 @@ public:
  */
 typedef std::function<void(ListenerFilterManager& filter_manager)> ListenerFilterFactoryCb;
 
+/**
+ * Callbacks used by individual UDP listener read filter instances to communicate with the listener.
+ */
+class UdpReadFilterCallbacks {
+public:
+  virtual ~UdpReadFilterCallbacks() {}
+
+  /**
+   * @return UdpListener& the listener the filter is installed on, which also sends datagrams.
+   */
+  virtual UdpListener& udpListener() PURE;
+};
+
+/**
+ * UDP listener read filter. It is installed on a UDP listener and is handed every datagram received
+ * by the listener.
+ */
+class UdpListenerReadFilter {
+public:
+  virtual ~UdpListenerReadFilter() {}
+
+  /**
+   * Called when a datagram is received by the listener.
+   * @param data supplies the datagram, whose buffer can be taken over by the filter.
+   */
+  virtual void onData(UdpData& data) PURE;
+
+  /**
+   * Called after the datagrams received by a single system call have been passed to onData(), e.g.
+   * to send the datagrams queued while handling them in a batch.
+   * @param datagrams supplies the number of datagrams received by the system call.
+   */
+  virtual void onReceiveBatchComplete(uint32_t datagrams) PURE;
+};
+
+typedef std::unique_ptr<UdpListenerReadFilter> UdpListenerReadFilterPtr;
+
+/**
+ * Interface for adding UDP listener filters to a manager.
+ */
+class UdpListenerFilterManager {
+public:
+  virtual ~UdpListenerFilterManager() {}
+
+  /**
+   * Add a read filter to the UDP listener. A UDP listener has a single read filter.
+   * @param filter supplies the filter being added.
+   */
+  virtual void addReadFilter(UdpListenerReadFilterPtr&& filter) PURE;
+};
+
+/**
+ * This function is used to wrap the creation of a UDP listener filter chain for a new listener.
+ * Filter factories create the filter and add it to the filter manager.
+ * @param filter_manager supplies the filter manager for the listener to install filters to.
+ * @param callbacks supplies the callbacks that the filter uses to communicate with the listener.
+ * Typically the function will install a single filter.
+ */
+typedef std::function<void(UdpListenerFilterManager& filter_manager,
+                           UdpReadFilterCallbacks& callbacks)>
+    UdpListenerFilterFactoryCb;
+
 /**
  * Interface representing a single filter chain.
  */
@@ -299,6 +363,15 @@ public:
    * @return true if filter chain was created successfully. Otherwise false.
    */
   virtual bool createListenerFilterChain(ListenerFilterManager& listener) PURE;
+
+  /**
+   * Called to create the filter chain of a UDP listener.
+   * @param udp_listener supplies the UDP listener to create the chain on.
+   * @param callbacks supplies the callbacks the filters use to communicate with the listener.
+   * @return true if filter chain was created successfully. Otherwise false.
+   */
+  virtual bool createUdpListenerFilterChain(UdpListenerFilterManager& udp_listener,
+                                            UdpReadFilterCallbacks& callbacks) PURE;
 };
 
 } // namespace Network
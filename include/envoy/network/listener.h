@@ -1,17 +1,30 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "envoy/api/os_sys_calls_common.h"
+#include "envoy/buffer/buffer.h"
 #include "envoy/common/exception.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/listen_socket.h"
 #include "envoy/stats/scope.h"
 
 namespace Envoy {
 namespace Network {
 
+/**
+ * The number of connections a listener accepts per socket event when no limit is configured, which
+ * means that every connection waiting in the listen backlog is accepted.
+ */
+constexpr uint32_t DefaultMaxConnectionsToAcceptPerSocketEvent =
+    std::numeric_limits<uint32_t>::max();
+
 /**
  * A configuration for an individual listener.
  */
@@ -80,6 +93,20 @@ public:
    * @return const std::string& the listener's name.
    */
   virtual const std::string& name() const PURE;
+
+  /**
+   * @return ConnectionBalancer& the balancer that spreads the listener's connections across the
+   *         workers. It is shared by all workers.
+   */
+  virtual ConnectionBalancer& connectionBalancer() PURE;
+
+  /**
+   * @return uint32_t the maximum number of connections to accept each time the listen socket
+   *         becomes readable. Connections beyond the limit stay in the listen backlog until the
+   *         next event loop iteration, so that a burst of new connections cannot starve the
+   *         existing ones.
+   */
+  virtual uint32_t maxConnectionsToAcceptPerSocketEvent() const PURE;
 };
 
 /**
@@ -104,6 +131,17 @@ public:
    * @param new_connection supplies the new connection that is moved into the callee.
    */
   virtual void onNewConnection(ConnectionPtr&& new_connection) PURE;
+
+  /**
+   * Called after the connections that were ready when the listen socket became readable have been
+   * accepted, or after the per event accept limit has been reached. Not called if no connection
+   * was accepted.
+   * @param duration supplies the time it took to accept the connections and run onAccept() for
+   *        each of them.
+   * @param limit_reached is true if accepting stopped because of the per event accept limit, in
+   *        which case more connections may be waiting in the listen backlog.
+   */
+  virtual void onAcceptBatchComplete(std::chrono::microseconds duration, bool limit_reached) PURE;
 };
 
 /**
@@ -139,7 +177,15 @@ public:
    *
    * @param data UdpData from the underlying socket.
    */
-  virtual void onData(const UdpData& data) PURE;
+  virtual void onData(UdpData& data) PURE;
+
+  /**
+   * Called after the datagrams received by a single system call have been passed to onData(). Not
+   * called if no datagram was received.
+   *
+   * @param datagrams supplies the number of datagrams received by the system call.
+   */
+  virtual void onReceiveBatchComplete(uint32_t datagrams) PURE;
 
   /**
    * Called when the underlying socket is ready for write.
@@ -179,6 +225,44 @@ public:
 
 typedef std::unique_ptr<Listener> ListenerPtr;
 
+/**
+ * A datagram to send from a UDP listener.
+ */
+struct UdpSendData {
+  const Address::Instance& peer_address_;
+  const Buffer::Instance& buffer_;
+};
+
+/**
+ * A UDP listener, which can also send datagrams from its socket.
+ */
+class UdpListener : public virtual Listener {
+public:
+  virtual ~UdpListener() {}
+
+  /**
+   * @return Event::Dispatcher& the dispatcher the listener runs on.
+   */
+  virtual Event::Dispatcher& dispatcher() PURE;
+
+  /**
+   * @return const Address::InstanceConstSharedPtr& the local address of the listener's socket.
+   */
+  virtual const Address::InstanceConstSharedPtr& localAddress() const PURE;
+
+  /**
+   * Send datagrams from the listener's socket, in order, with as few system calls as the platform
+   * allows. Like any UDP socket, this is best effort: the datagrams that don't fit in the socket
+   * buffer are not sent.
+   * @param datagrams supplies the datagrams to send.
+   * @return Api::SysCallIntResult the number of datagrams sent, along with the error that stopped
+   *         the sending of the others if not all of them were sent.
+   */
+  virtual Api::SysCallIntResult send(const std::vector<UdpSendData>& datagrams) PURE;
+};
+
+typedef std::unique_ptr<UdpListener> UdpListenerPtr;
+
 /**
  * Thrown when there is a runtime error creating/binding a listener.
  */
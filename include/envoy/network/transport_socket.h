@@ -75,6 +75,12 @@ public:
    */
   virtual void setReadBufferReady() PURE;
 
+  /**
+   * Schedule a write of the connection's write buffer in the event loop. This is used by transport
+   * sockets that complete writes asynchronously, to carry on writing once a write has completed.
+   */
+  virtual void flushWriteBuffer() PURE;
+
   /**
    * Raise a connection event to the connection. This can be used by a secure socket (e.g. TLS)
    * to raise a connected event when handshake is done.
@@ -10,6 +10,7 @@
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/v2/core/base.pb.h"
+#include "envoy/common/regex.h"
 #include "envoy/config/typed_metadata.h"
 #include "envoy/http/codec.h"
 #include "envoy/http/codes.h"
@@ -101,9 +102,21 @@ public:
   virtual const std::list<std::string>& allowOrigins() const PURE;
 
   /*
-   * @return std::list<std::regex>& regexes that match allowed origins.
+   * @return std::vector<Regex::CompiledMatcherPtr>& regexes that match allowed origins.
    */
-  virtual const std::list<std::regex>& allowOriginRegexes() const PURE;
+  virtual const std::vector<Regex::CompiledMatcherPtr>& allowOriginRegexes() const PURE;
+
+  /**
+   * @param origin supplies the value of an origin header.
+   * @return bool whether the origin is one of allowOrigins(), or allowOrigins() has "*".
+   */
+  virtual bool allowsOrigin(absl::string_view origin) const PURE;
+
+  /**
+   * @param origin supplies the value of an origin header.
+   * @return bool whether the origin matches one of allowOriginRegexes().
+   */
+  virtual bool allowsOriginRegex(absl::string_view origin) const PURE;
 
   /**
    * @return std::string access-control-allow-methods value.
@@ -311,6 +324,11 @@ public:
    *         present.
    */
   virtual const envoy::type::FractionalPercent& defaultValue() const PURE;
+
+  /**
+   * @return whether requests should be shadowed as they stream instead of once they are complete.
+   */
+  virtual bool streaming() const PURE;
 };
 
 /**
@@ -328,7 +346,7 @@ public:
 };
 
 class RateLimitPolicy;
-class Config;
+class CommonConfig;
 
 /**
  * All route specific config returned by the method at
@@ -364,9 +382,9 @@ public:
   virtual const RateLimitPolicy& rateLimitPolicy() const PURE;
 
   /**
-   * @return const Config& the RouteConfiguration that owns this virtual host.
+   * @return const CommonConfig& the RouteConfiguration level settings shared by this virtual host.
    */
-  virtual const Config& routeConfig() const PURE;
+  virtual const CommonConfig& routeConfig() const PURE;
 
   /**
    * @return const RouteSpecificFilterConfig* the per-filter config pre-processed object for
@@ -446,6 +464,23 @@ public:
    * will be canceled immediately.
    */
   virtual bool hedgeOnPerTryTimeout() const PURE;
+
+  /**
+   * @return bool indicating whether a hedged request should be sent to another host when the
+   * response to a complete request is slower than the cluster's estimated 95th percentile latency.
+   */
+  virtual bool hedgeOnLatency() const PURE;
+
+  /**
+   * @return the minimum time to wait for a response before sending a latency hedged request.
+   */
+  virtual std::chrono::milliseconds latencyHedgeMinDelay() const PURE;
+
+  /**
+   * @return the maximum number of outstanding latency hedged requests to the cluster, as a
+   * percentage of the active requests to the cluster.
+   */
+  virtual double latencyHedgeBudgetPercent() const PURE;
 };
 
 class MetadataMatchCriterion {
@@ -587,6 +622,12 @@ public:
    */
   virtual const RetryPolicy& retryPolicy() const PURE;
 
+  /**
+   * @return uint32_t the maximum number of request body bytes to buffer for retries and
+   *         shadowing, beyond which the request is neither retried nor shadowed.
+   */
+  virtual uint32_t retryShadowBufferLimit() const PURE;
+
   /**
    * @return const ShadowPolicy& the shadow policy for the route. All routes have a shadow policy
    *         even if no shadowing takes place.
@@ -747,6 +788,14 @@ public:
    */
   virtual const RouteSpecificFilterConfig* perFilterConfig(const std::string& name) const PURE;
 
+  /**
+   * @return bool true if the route configuration selects this route for every request with the
+   *         same :authority, :path and :method headers, regardless of any other header, runtime
+   *         value or random value. The result of a route lookup may only be cached on those
+   *         headers when this is true.
+   */
+  virtual bool cacheable() const PURE;
+
   /**
    * This is a helper on top of perFilterConfig() that casts the return object to the specified
    * type.
@@ -759,22 +808,12 @@ public:
 typedef std::shared_ptr<const Route> RouteConstSharedPtr;
 
 /**
- * The router configuration.
+ * The settings of a route configuration that are not specific to a virtual host. Virtual hosts
+ * may be shared by successive versions of a route configuration when these are unchanged.
  */
-class Config {
+class CommonConfig {
 public:
-  virtual ~Config() {}
-
-  /**
-   * Based on the incoming HTTP request headers, determine the target route (containing either a
-   * route entry or a direct response entry) for the request.
-   * @param headers supplies the request headers.
-   * @param random_value supplies the random seed to use if a runtime choice is required. This
-   *        allows stable choices between calls if desired.
-   * @return the route or nullptr if there is no matching route for the request.
-   */
-  virtual RouteConstSharedPtr route(const Http::HeaderMap& headers,
-                                    uint64_t random_value) const PURE;
+  virtual ~CommonConfig() {}
 
   /**
    * Return a list of headers that will be cleaned from any requests that are not from an internal
@@ -788,6 +827,23 @@ public:
   virtual const std::string& name() const PURE;
 };
 
+/**
+ * The router configuration.
+ */
+class Config : public CommonConfig {
+public:
+  /**
+   * Based on the incoming HTTP request headers, determine the target route (containing either a
+   * route entry or a direct response entry) for the request.
+   * @param headers supplies the request headers.
+   * @param random_value supplies the random seed to use if a runtime choice is required. This
+   *        allows stable choices between calls if desired.
+   * @return the route or nullptr if there is no matching route for the request.
+   */
+  virtual RouteConstSharedPtr route(const Http::HeaderMap& headers,
+                                    uint64_t random_value) const PURE;
+};
+
 typedef std::shared_ptr<const Config> ConfigConstSharedPtr;
 
 } // namespace Router
@@ -4,15 +4,41 @@
 #include <memory>
 #include <string>
 
+#include "envoy/buffer/buffer.h"
+#include "envoy/http/header_map.h"
 #include "envoy/http/message.h"
 
 namespace Envoy {
 namespace Router {
 
 /**
- * Interface used to shadow complete requests to an alternate upstream cluster in a "fire and
- * forget" fashion. Right now this interface takes a fully buffered request and cannot be used for
- * streaming. This is sufficient for current use cases.
+ * A request being shadowed as it streams. Destroying the stream before the end of the request
+ * resets the shadow, while a complete request is left to finish in a "fire and forget" fashion.
+ */
+class ShadowStream {
+public:
+  virtual ~ShadowStream() {}
+
+  /**
+   * Send request body data to the shadow.
+   * @param data supplies the data to send.
+   * @param end_stream supplies whether this is the end of the request.
+   */
+  virtual void sendData(Buffer::Instance& data, bool end_stream) PURE;
+
+  /**
+   * Send the request trailers to the shadow, which ends the request.
+   * @param trailers supplies the trailers to send.
+   */
+  virtual void sendTrailers(Http::HeaderMap& trailers) PURE;
+};
+
+typedef std::unique_ptr<ShadowStream> ShadowStreamPtr;
+
+/**
+ * Interface used to shadow requests to an alternate upstream cluster in a "fire and forget"
+ * fashion. Requests are either shadowed once fully buffered, or streamed to the shadow as they
+ * arrive.
  */
 class ShadowWriter {
 public:
@@ -26,6 +52,17 @@ public:
    */
   virtual void shadow(const std::string& cluster, Http::MessagePtr&& request,
                       std::chrono::milliseconds timeout) PURE;
+
+  /**
+   * Start shadowing a request whose body is yet to come.
+   * @param cluster supplies the cluster name to shadow to.
+   * @param headers supplies the request headers.
+   * @param timeout supplies the shadowed request timeout, measured from the end of the request.
+   * @return ShadowStreamPtr the stream to send the rest of the request to, or nullptr if the
+   *         request can't be shadowed.
+   */
+  virtual ShadowStreamPtr streamingShadow(const std::string& cluster, Http::HeaderMapPtr&& headers,
+                                          std::chrono::milliseconds timeout) PURE;
 };
 
 typedef std::unique_ptr<ShadowWriter> ShadowWriterPtr;
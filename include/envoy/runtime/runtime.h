@@ -25,7 +25,7 @@ public:
   virtual ~RandomGenerator() {}
 
   /**
-   * @return uint64_t a new random number.
+   * @return uint64_t a new random number. The numbers are not suitable for cryptographic use.
    */
   virtual uint64_t random() PURE;
 
@@ -34,10 +34,37 @@ public:
    * for example, 7c25513b-0466-4558-a64c-12c6704f37ed
    */
   virtual std::string uuid() PURE;
+
+  /**
+   * Write a uuid4 into a caller provided buffer, without allocating.
+   * @param buffer supplies the buffer of at least 36 chars the uuid is written to. The uuid is not
+   *        null terminated.
+   */
+  virtual void uuid(char* buffer) PURE;
 };
 
 typedef std::unique_ptr<RandomGenerator> RandomGeneratorPtr;
 
+/**
+ * A runtime key interned into an index, so that snapshots look up its value with an array index
+ * instead of hashing the key. Handles should be created once, at configuration time, and kept by
+ * the code that uses them on the request path.
+ */
+class FeatureHandle {
+public:
+  virtual ~FeatureHandle() {}
+
+  /**
+   * @return const std::string& the runtime key of the handle.
+   */
+  virtual const std::string& key() const PURE;
+
+  /**
+   * @return uint32_t the index of the key in the snapshots.
+   */
+  virtual uint32_t index() const PURE;
+};
+
 /**
  * A snapshot of runtime data.
  */
@@ -172,6 +199,40 @@ public:
                               const envoy::type::FractionalPercent& default_value,
                               uint64_t random_value) const PURE;
 
+  /**
+   * Same as featureEnabled(const std::string&, uint64_t), with the key resolved by a handle.
+   */
+  virtual bool featureEnabled(const FeatureHandle& handle, uint64_t default_value) const PURE;
+
+  /**
+   * Same as featureEnabled(const std::string&, uint64_t, uint64_t), with the key resolved by a
+   * handle.
+   */
+  virtual bool featureEnabled(const FeatureHandle& handle, uint64_t default_value,
+                              uint64_t random_value) const PURE;
+
+  /**
+   * Same as featureEnabled(const std::string&, uint64_t, uint64_t, uint64_t), with the key resolved
+   * by a handle.
+   */
+  virtual bool featureEnabled(const FeatureHandle& handle, uint64_t default_value,
+                              uint64_t random_value, uint64_t num_buckets) const PURE;
+
+  /**
+   * Same as featureEnabled(const std::string&, const envoy::type::FractionalPercent&), with the key
+   * resolved by a handle.
+   */
+  virtual bool featureEnabled(const FeatureHandle& handle,
+                              const envoy::type::FractionalPercent& default_value) const PURE;
+
+  /**
+   * Same as featureEnabled(const std::string&, const envoy::type::FractionalPercent&, uint64_t),
+   * with the key resolved by a handle.
+   */
+  virtual bool featureEnabled(const FeatureHandle& handle,
+                              const envoy::type::FractionalPercent& default_value,
+                              uint64_t random_value) const PURE;
+
   /**
    * Fetch raw runtime data based on key.
    * @param key supplies the key to fetch.
@@ -188,6 +249,11 @@ public:
    */
   virtual uint64_t getInteger(const std::string& key, uint64_t default_value) const PURE;
 
+  /**
+   * Same as getInteger(const std::string&, uint64_t), with the key resolved by a handle.
+   */
+  virtual uint64_t getInteger(const FeatureHandle& handle, uint64_t default_value) const PURE;
+
   /**
    * Fetch the OverrideLayers that provide values in this snapshot. Layers are ordered from bottom
    * to top; for instance, the second layer's entries override the first layer's entries, and so on.
@@ -45,5 +45,11 @@ typedef SecretProvider<envoy::api::v2::auth::CertificateValidationContext>
 typedef std::shared_ptr<CertificateValidationContextConfigProvider>
     CertificateValidationContextConfigProviderSharedPtr;
 
+typedef std::unique_ptr<envoy::api::v2::auth::TlsSessionTicketKeys> TlsSessionTicketKeysPtr;
+typedef SecretProvider<envoy::api::v2::auth::TlsSessionTicketKeys>
+    TlsSessionTicketKeysConfigProvider;
+typedef std::shared_ptr<TlsSessionTicketKeysConfigProvider>
+    TlsSessionTicketKeysConfigProviderSharedPtr;
+
 } // namespace Secret
 } // namespace Envoy
@@ -70,6 +70,13 @@ public:
    */
   virtual std::chrono::milliseconds statsFlushInterval() const PURE;
 
+  /**
+   * @return absl::optional<std::chrono::milliseconds> the time interval between histogram merges,
+   *         if histograms are merged separately from flushing to the stat sinks. If not set,
+   *         histograms are merged before each flush.
+   */
+  virtual absl::optional<std::chrono::milliseconds> histogramMergeInterval() const PURE;
+
   /**
    * @return std::chrono::milliseconds the time interval after which we count a nonresponsive thread
    *         event as a "miss" statistic.
@@ -41,9 +41,11 @@ public:
    * Retrieve a listening socket on the specified address from the parent process. The socket will
    * be duplicated across process boundaries.
    * @param address supplies the address of the socket to duplicate, e.g. tcp://127.0.0.1:5000.
+   * @param worker_index supplies the index of the worker the socket is for. Listeners that use
+   *        reuse_port have a socket per worker, other listeners only have one for worker 0.
    * @return int the fd or -1 if there is no bound listen port in the parent.
    */
-  virtual int duplicateParentListenSocket(const std::string& address) PURE;
+  virtual int duplicateParentListenSocket(const std::string& address, uint32_t worker_index) PURE;
 
   /**
    * Retrieve stats from our parent process.
@@ -51,6 +53,14 @@ public:
    */
   virtual void getParentStats(GetParentStatsInfo& info) PURE;
 
+  /**
+   * Merge the values of the parent process's counters and gauges into the stats of this process,
+   * if stats are transferred on hot restart (see Server::Options::hotRestartStatsTransfer()). This
+   * is called right after stats were flushed to the sinks: merged counter increments are reported
+   * by the parent's sinks, not by ours.
+   */
+  virtual void mergeParentStats() PURE;
+
   /**
    * Initialize the restarter after primary server initialization begins. The hot restart
    * implementation needs to be created early to deal with shared memory, logging, etc. so
@@ -47,12 +47,16 @@ public:
    * @param socket_type the type of socket (stream or datagram) to create.
    * @param options to be set on the created socket just before calling 'bind()'.
    * @param bind_to_port supplies whether to actually bind the socket.
+   * @param worker_index supplies the index of the worker that will listen on the socket. This is
+   *        always 0 unless the listener uses reuse_port, in which case every worker gets its own
+   *        socket.
    * @return Network::SocketSharedPtr an initialized and potentially bound socket.
    */
   virtual Network::SocketSharedPtr
   createListenSocket(Network::Address::InstanceConstSharedPtr address,
                      Network::Address::SocketType socket_type,
-                     const Network::Socket::OptionsSharedPtr& options, bool bind_to_port) PURE;
+                     const Network::Socket::OptionsSharedPtr& options, bool bind_to_port,
+                     uint32_t worker_index) PURE;
 
   /**
    * Creates a list of filter factories.
@@ -74,6 +78,16 @@ public:
       const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
       Configuration::ListenerFactoryContext& context) PURE;
 
+  /**
+   * Creates a list of UDP listener filter factories.
+   * @param filters supplies the proto configuration.
+   * @param context supplies the factory creation context.
+   * @return std::vector<Network::UdpListenerFilterFactoryCb> the list of filter factories.
+   */
+  virtual std::vector<Network::UdpListenerFilterFactoryCb> createUdpListenerFilterFactoryList(
+      const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
+      Configuration::ListenerFactoryContext& context) PURE;
+
   /**
    * @return DrainManagerPtr a new drain manager.
    * @param drain_type supplies the type of draining to do for the owning listener.
@@ -127,6 +141,17 @@ public:
    */
   virtual std::vector<std::reference_wrapper<Network::ListenerConfig>> listeners() PURE;
 
+  /**
+   * Find the socket that a worker listens on for the currently loaded listener bound to an address.
+   * Workers share a single socket unless the listener uses reuse_port.
+   * @param address supplies the bound address of the listener.
+   * @param worker_index supplies the index of the worker.
+   * @return Network::Socket* the socket, or nullptr if no listener is bound to the address or the
+   *         listener has no socket of its own for the worker.
+   */
+  virtual Network::Socket* findListenSocket(const Network::Address::Instance& address,
+                                            uint32_t worker_index) PURE;
+
   /**
    * @return uint64_t the total number of connections owned by all listeners across all workers.
    */
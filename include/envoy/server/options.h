@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "envoy/admin/v2alpha/server_info.pb.h"
 #include "envoy/common/pure.h"
@@ -68,6 +69,18 @@ public:
    */
   virtual std::chrono::seconds drainTime() const PURE;
 
+  /**
+   * @return uint32_t the maximum number of connections each worker is told to drain close per
+   *         second during a drain sequence, or 0 for no limit.
+   */
+  virtual uint32_t drainRatePerWorker() const PURE;
+
+  /**
+   * @return const std::vector<uint32_t>& the CPUs the worker threads are pinned to, worker N
+   *         running on CPU N modulo their number, or an empty list for unpinned workers.
+   */
+  virtual const std::vector<uint32_t>& workerCpus() const PURE;
+
   /**
    * @return const std::string& the path to the configuration file.
    */
@@ -133,6 +146,12 @@ public:
    */
   virtual std::chrono::milliseconds fileFlushIntervalMsec() const PURE;
 
+  /**
+   * @return uint64_t the maximum number of bytes buffered per log file before writes are dropped,
+   *         or 0 for no limit.
+   */
+  virtual uint64_t fileMaxBufferedBytes() const PURE;
+
   /**
    * @return const std::string& the server's cluster.
    */
@@ -164,6 +183,12 @@ public:
    */
   virtual bool hotRestartDisabled() const PURE;
 
+  /**
+   * @return bool indicating whether stats live in heap memory and are transferred from the parent
+   *         process over the hot restart domain socket, instead of living in shared memory.
+   */
+  virtual bool hotRestartStatsTransfer() const PURE;
+
   /**
    * @return bool indicating whether system signal listeners are enabled.
    */
@@ -174,11 +199,6 @@ public:
    */
   virtual bool mutexTracingEnabled() const PURE;
 
-  /**
-   * @return whether to use the old libevent evbuffer-based Buffer implementation.
-   */
-  virtual bool libeventBufferEnabled() const PURE;
-
   /**
    * @return bool indicating whether cpuset size should determine the number of worker threads.
    */
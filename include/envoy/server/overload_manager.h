@@ -70,6 +70,10 @@ public:
 
   // Overload action to try to shrink the heap by releasing free memory.
   const std::string ShrinkHeap = "envoy.overload_actions.shrink_heap";
+
+  // Overload action to reduce the number of concurrent streams accepted on HTTP/2 connections.
+  const std::string ReduceHttp2MaxConcurrentStreams =
+      "envoy.overload_actions.reduce_http2_max_concurrent_streams";
 };
 
 typedef ConstSingleton<OverloadActionNameValues> OverloadActionNames;
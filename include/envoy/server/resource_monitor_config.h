@@ -4,6 +4,7 @@
 #include "envoy/common/pure.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/server/resource_monitor.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "common/protobuf/protobuf.h"
 
@@ -25,6 +26,12 @@ public:
    * @return reference to the Api object
    */
   virtual Api::Api& api() PURE;
+
+  /**
+   * @return ThreadLocal::SlotAllocator& the thread local storage of the server, which may be used
+   *         to run work on every thread.
+   */
+  virtual ThreadLocal::SlotAllocator& threadLocal() PURE;
 };
 
 /**
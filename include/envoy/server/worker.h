@@ -1,9 +1,14 @@
 #pragma once
 
 #include <functional>
+#include <list>
+#include <string>
 
 #include "envoy/server/guarddog.h"
 #include "envoy/server/overload_manager.h"
+#include "envoy/stats/scope.h"
+
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Server {
@@ -37,6 +42,14 @@ public:
    */
   virtual uint64_t numConnections() PURE;
 
+  /**
+   * Start recording the stats of the worker's event loop. Must be called before start().
+   * @see Event::Dispatcher::initializeStats.
+   * @param scope supplies the scope to create the stats in.
+   * @param prefix supplies the prefix for the stats.
+   */
+  virtual void initializeStats(Stats::Scope& scope, const std::string& prefix) PURE;
+
   /**
    * Start the worker thread.
    * @param guard_dog supplies the guard dog to use for thread watching.
@@ -57,6 +70,18 @@ public:
   virtual void removeListener(Network::ListenerConfig& listener,
                               std::function<void()> completion) PURE;
 
+  /**
+   * Close the connections of a listener that were created from any of the given filter chains.
+   * @param listener_tag supplies the tag of the listener.
+   * @param filter_chains supplies the filter chains whose connections should be closed. The filter
+   *        chains must stay alive until the completion is called.
+   * @param completion supplies the completion to be called when the connections have been closed.
+   *        This completion is called on the worker thread. No locking is performed by the worker.
+   */
+  virtual void removeFilterChains(uint64_t listener_tag,
+                                  const std::list<const Network::FilterChain*>& filter_chains,
+                                  std::function<void()> completion) PURE;
+
   /**
    * Stop a listener from accepting new connections. This is used for server draining.
    * @param listener supplies the listener to stop.
@@ -83,9 +108,12 @@ public:
   virtual ~WorkerFactory() {}
 
   /**
+   * @param overload_manager supplies the overload manager the worker registers with.
+   * @param cpu supplies the CPU the thread of the worker is pinned to, if any.
    * @return WorkerPtr a new worker.
    */
-  virtual WorkerPtr createWorker(OverloadManager& overload_manager) PURE;
+  virtual WorkerPtr createWorker(OverloadManager& overload_manager,
+                                 absl::optional<uint32_t> cpu) PURE;
 };
 
 } // namespace Server
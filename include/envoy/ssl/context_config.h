@@ -57,6 +57,12 @@ public:
    */
   virtual unsigned maxProtocolVersion() const PURE;
 
+  /**
+   * @return true if the encryption of outgoing records should be handed over to the kernel after
+   *         the handshake, where the negotiated parameters allow it.
+   */
+  virtual bool kernelTlsOffload() const PURE;
+
   /**
    * @return true if the ContextConfig is able to provide secrets to create SSL context,
    * and false if dynamic secrets are expected but are not downloaded from SDS server yet.
@@ -119,6 +125,12 @@ public:
    * are candidates for decrypting received tickets.
    */
   virtual const std::vector<SessionTicketKey>& sessionTicketKeys() const PURE;
+
+  /**
+   * @return The prefix of the scope of the stats of the contexts, empty if they use the scope of
+   * the listener itself.
+   */
+  virtual const std::string& statPrefix() const PURE;
 };
 
 typedef std::unique_ptr<ServerContextConfig> ServerContextConfigPtr;
@@ -1,14 +1,29 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/tls_certificate_config.h"
 #include "envoy/stats/scope.h"
+#include "envoy/thread/thread.h"
 
 namespace Envoy {
 namespace Ssl {
 
+/**
+ * Keeps the certificates parsed by ContextManager::prefetchCertificates() cached while it is alive.
+ */
+class CertificatePrefetch {
+public:
+  virtual ~CertificatePrefetch() {}
+};
+
+typedef std::unique_ptr<CertificatePrefetch> CertificatePrefetchPtr;
+
 /**
  * Manages all of the SSL contexts in the process
  */
@@ -38,6 +53,26 @@ public:
    * Iterate through all currently allocated contexts.
    */
   virtual void iterateContexts(std::function<void(const Context&)> callback) PURE;
+
+  /**
+   * Parse certificate chains and private keys ahead of building the contexts that use them,
+   * spreading large batches over several threads. Contexts built while the returned handle is
+   * alive use the parsed certificates instead of parsing them again. Certificates that can't be
+   * parsed are skipped, building a context with them reports the error.
+   * @param tls_certificates supplies the certificates to parse.
+   * @param thread_factory supplies the factory of the threads to parse on.
+   * @param threads supplies the maximum number of threads to parse on.
+   * @return CertificatePrefetchPtr the handle that keeps the parsed certificates cached.
+   */
+  virtual CertificatePrefetchPtr
+  prefetchCertificates(const std::vector<const TlsCertificateConfig*>& tls_certificates,
+                       Thread::ThreadFactory& thread_factory, uint32_t threads) PURE;
+
+  /**
+   * Access the private key operations manager, which is part of SSL
+   * context manager.
+   */
+  virtual PrivateKeyMethodManager& privateKeyMethodManager() PURE;
 };
 
 } // namespace Ssl
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+#include "envoy/api/v2/auth/cert.pb.h"
+#include "envoy/registry/registry.h"
+#include "envoy/ssl/private_key/private_key.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Implemented by each private key method provider, e.g. for an HSM or a TLS accelerator, and
+ * registered via Registry::registerFactory() or the convenience class RegisterFactory.
+ */
+class PrivateKeyMethodProviderInstanceFactory {
+public:
+  virtual ~PrivateKeyMethodProviderInstanceFactory() {}
+
+  /**
+   * Create a particular PrivateKeyMethodProvider implementation. If the implementation is
+   * unable to produce a PrivateKeyMethodProvider with the provided parameters, it should throw
+   * an EnvoyException. The returned pointer should always be valid.
+   * @param config supplies the PrivateKeyProvider message, including the provider specific
+   * configuration.
+   * @param factory_context supplies the context of the transport socket factory.
+   */
+  virtual PrivateKeyMethodProviderSharedPtr createPrivateKeyMethodProviderInstance(
+      const envoy::api::v2::auth::PrivateKeyProvider& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context) PURE;
+
+  /**
+   * @return std::string the identifying name for a particular implementation of
+   * PrivateKeyMethodProvider produced by the factory.
+   */
+  virtual std::string name() const PURE;
+};
+
+} // namespace Ssl
+} // namespace Envoy
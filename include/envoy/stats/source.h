@@ -45,6 +45,31 @@ public:
    */
   virtual const std::vector<ParentHistogramSharedPtr>& cachedHistograms() PURE;
 
+  /**
+   * Returns the used counters whose value changed since the last flush that asked for them, which
+   * lets sinks skip re-sending stats that are idle. Will use cached values if already accessed and
+   * clearCache() hasn't been called since.
+   * @return std::vector<CounterSharedPtr>& changed counters. Note: reference may not be valid
+   * after clearCache() is called.
+   */
+  virtual const std::vector<CounterSharedPtr>& cachedChangedCounters() PURE;
+
+  /**
+   * Returns the used gauges whose value changed since the last flush that asked for them. Will use
+   * cached values if already accessed and clearCache() hasn't been called since.
+   * @return std::vector<GaugeSharedPtr>& changed gauges. Note: reference may not be valid after
+   * clearCache() is called.
+   */
+  virtual const std::vector<GaugeSharedPtr>& cachedChangedGauges() PURE;
+
+  /**
+   * Returns the used parent histograms that merged new values since the last flush that asked for
+   * them. Will use cached values if already accessed and clearCache() hasn't been called since.
+   * @return std::vector<ParentHistogramSharedPtr>& changed histograms. Note: reference may not be
+   * valid after clearCache() is called.
+   */
+  virtual const std::vector<ParentHistogramSharedPtr>& cachedChangedHistograms() PURE;
+
   /**
    * Resets the cache so that any future calls to get cached metrics will refresh the set.
    */
@@ -12,6 +12,7 @@
 namespace Envoy {
 namespace Stats {
 
+class StatName;
 struct Tag;
 
 /**
@@ -25,24 +26,18 @@ public:
    * as streaming out the name to a stats sink or admin request, or comparing
    * against it in a test. Independent of the evolution of the data
    * representation for the name, this method will be available. For storing the
-   * name as a map key, however, nameCStr() is a better choice, albeit one that
-   * might change in the future to return a symbolized representation of the
-   * elaborated string.
+   * name as a map key, however, statName() is a better choice, as this method
+   * elaborates the name from its symbolized representation.
    */
   virtual std::string name() const PURE;
 
   /**
-   * Returns the full name of the Metric as a nul-terminated string. The
-   * intention is use this as a hash-map key, so that the stat name storage
-   * is not duplicated in every map. You cannot use name() above for this,
-   * as it returns a std::string by value, as not all stat implementations
-   * contain the name as a std::string.
-   *
-   * Note that in the future, the plan is to replace this method with one that
-   * returns a reference to a symbolized representation of the elaborated string
-   * (see source/common/stats/symbol_table_impl.h).
+   * Returns the symbolized name of the Metric. This is intended for use as a
+   * hash-map key, so that the stat name storage is not duplicated in every
+   * map. The storage is owned by the Metric, so the returned StatName is only
+   * valid for the lifetime of the Metric.
    */
-  virtual const char* nameCStr() const PURE;
+  virtual StatName statName() const PURE;
 
   /**
    * Returns a vector of configurable tags to identify this Metric.
@@ -135,6 +135,7 @@ public:
 #endif
 
 private:
+  friend class HeapStatDataAllocator;
   friend class StatNameStorage;
   friend class StatNameList;
 
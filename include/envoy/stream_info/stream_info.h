@@ -65,6 +65,40 @@ enum ResponseFlag {
 };
 
 struct UpstreamTiming {
+  /**
+   * Sets the time when the router started the upstream request, i.e. asked the connection pool for
+   * a stream.
+   */
+  void onUpstreamRequestStart(TimeSource& time_source) {
+    ASSERT(!upstream_request_start_);
+    upstream_request_start_ = time_source.monotonicTime();
+  }
+
+  /**
+   * Sets the time when an upstream connection started to connect.
+   */
+  void onUpstreamConnectStart(TimeSource& time_source) {
+    ASSERT(!upstream_connect_start_);
+    upstream_connect_start_ = time_source.monotonicTime();
+  }
+
+  /**
+   * Sets the time when an upstream connection completed the connect of its socket.
+   */
+  void onUpstreamConnectComplete(TimeSource& time_source) {
+    ASSERT(!upstream_connect_complete_);
+    upstream_connect_complete_ = time_source.monotonicTime();
+  }
+
+  /**
+   * Sets the time when an upstream connection completed the handshake of its transport socket,
+   * e.g. TLS.
+   */
+  void onUpstreamHandshakeComplete(TimeSource& time_source) {
+    ASSERT(!upstream_handshake_complete_);
+    upstream_handshake_complete_ = time_source.monotonicTime();
+  }
+
   /**
    * Sets the time when the first byte of the request was sent upstream.
    */
@@ -101,6 +135,12 @@ struct UpstreamTiming {
   absl::optional<MonotonicTime> last_upstream_tx_byte_sent_;
   absl::optional<MonotonicTime> first_upstream_rx_byte_received_;
   absl::optional<MonotonicTime> last_upstream_rx_byte_received_;
+  absl::optional<MonotonicTime> upstream_request_start_;
+  // The connection establishment times are recorded on the stream info of the upstream connection,
+  // and copied to the upstream timing of the requests that waited for the connection.
+  absl::optional<MonotonicTime> upstream_connect_start_;
+  absl::optional<MonotonicTime> upstream_connect_complete_;
+  absl::optional<MonotonicTime> upstream_handshake_complete_;
 };
 
 /**
@@ -182,6 +222,13 @@ public:
    */
   virtual void setUpstreamTiming(const UpstreamTiming& upstream_timing) PURE;
 
+  /**
+   * @return the upstream timing information of this stream. The stream info of an upstream
+   * connection only records the times of the connection establishment in it.
+   */
+  virtual UpstreamTiming& upstreamTiming() PURE;
+  virtual const UpstreamTiming& upstreamTiming() const PURE;
+
   /**
    * @return the duration between the first byte of the request was sent upstream and the start of
    * the request. There may be a considerable delta between lastDownstreamByteReceived and this
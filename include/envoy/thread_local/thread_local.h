@@ -81,6 +81,17 @@ public:
   virtual SlotPtr allocateSlot() PURE;
 };
 
+/**
+ * A batch of slot updates, which are delivered to the worker threads when it is destroyed.
+ * @see Instance::startUpdateBatch().
+ */
+class UpdateBatch {
+public:
+  virtual ~UpdateBatch() {}
+};
+
+typedef std::unique_ptr<UpdateBatch> UpdateBatchPtr;
+
 /**
  * Interface for getting and setting thread local data as well as registering a thread
  */
@@ -109,6 +120,17 @@ public:
    */
   virtual void shutdownThread() PURE;
 
+  /**
+   * Start batching slot updates, e.g. while applying a config update that touches many slots.
+   * Until the returned batch is destroyed, the callbacks that Slot::set(), Slot::runOnAllThreads()
+   * and slot destruction run on the worker threads are queued, and then delivered to each worker
+   * thread with a single post. The main thread still runs its part of each update immediately.
+   * Batches may nest, in which case the updates are delivered when the outermost batch ends. Must
+   * be called on the main thread.
+   * @return UpdateBatchPtr the batch, which ends when it is destroyed.
+   */
+  virtual UpdateBatchPtr startUpdateBatch() PURE;
+
   /**
    * @return Event::Dispatcher& the thread local dispatcher.
    */
@@ -8,6 +8,8 @@
 #include "envoy/common/pure.h"
 #include "envoy/http/header_map.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Tracing {
 
@@ -78,10 +80,12 @@ public:
 
   /**
    * Attach metadata to a Span, to be handled in an implementation-dependent fashion.
+   * The name and the value are only valid for the duration of the call, e.g. they may refer to
+   * request headers, so an implementation copies those of the tags it actually exports.
    * @param name the name of the tag
    * @param value the value to associate with the tag
    */
-  virtual void setTag(const std::string& name, const std::string& value) PURE;
+  virtual void setTag(absl::string_view name, absl::string_view value) PURE;
 
   /**
    * Record an event associated with a span, to be handled in an implementation-dependent fashion.
@@ -5,12 +5,14 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/api.h"
 #include "envoy/api/v2/cds.pb.h"
 #include "envoy/config/bootstrap/v2/bootstrap.pb.h"
 #include "envoy/config/grpc_mux.h"
+#include "envoy/event/dispatcher.h"
 #include "envoy/grpc/async_client_manager.h"
 #include "envoy/http/async_client.h"
 #include "envoy/http/conn_pool.h"
@@ -65,6 +67,25 @@ public:
 
 typedef std::unique_ptr<ClusterUpdateCallbacksHandle> ClusterUpdateCallbacksHandlePtr;
 
+/**
+ * Handle for a request to instantiate an on-demand cluster. Deleting the handle cancels the
+ * request, after which its callback is not called anymore.
+ */
+class OnDemandClusterHandle {
+public:
+  virtual ~OnDemandClusterHandle() {}
+};
+
+typedef std::unique_ptr<OnDemandClusterHandle> OnDemandClusterHandlePtr;
+
+/**
+ * Called on the requesting thread when a requested on-demand cluster finished warming, or when it
+ * could not be instantiated.
+ * @param available supplies whether the cluster can now be obtained from ClusterManager::get() on
+ *        the requesting thread.
+ */
+typedef std::function<void(bool available)> OnDemandClusterCallback;
+
 class ClusterManagerFactory;
 
 /**
@@ -236,6 +257,32 @@ public:
   virtual ClusterManagerFactory& clusterManagerFactory() PURE;
 
   virtual std::size_t warmingClusterCount() const PURE;
+
+  /**
+   * @return HealthCheckerDispatcherPoolSharedPtr the pool of dispatchers that health checkers run
+   *         their sessions on, or nullptr if health checking runs on the main thread.
+   */
+  virtual HealthCheckerDispatcherPoolSharedPtr healthCheckerDispatcherPool() PURE;
+
+  /**
+   * Request a declared on-demand cluster to be instantiated. This can be called from any thread.
+   * @param cluster supplies the cluster name.
+   * @param dispatcher supplies the dispatcher of the calling thread, which the callback is called
+   *        on.
+   * @param callback supplies the callback to call once the cluster is available or failed.
+   * @return OnDemandClusterHandlePtr a handle that cancels the request when deleted, or nullptr if
+   *         there is no on-demand cluster with that name. The callback is not called in the latter
+   *         case.
+   */
+  virtual OnDemandClusterHandlePtr requestOnDemandCluster(const std::string& cluster,
+                                                          Event::Dispatcher& dispatcher,
+                                                          OnDemandClusterCallback callback) PURE;
+
+  /**
+   * @return std::vector<std::string> the names of the on-demand clusters that are declared but
+   *         not instantiated, and so are not part of clusters().
+   */
+  virtual std::vector<std::string> declaredOnDemandClusters() const PURE;
 };
 
 typedef std::unique_ptr<ClusterManager> ClusterManagerPtr;
@@ -308,9 +355,12 @@ public:
 
   /**
    * Create a CDS API provider from configuration proto.
+   * @param cds_config supplies the CDS config source.
+   * @param config_threads supplies the number of threads to decode CDS updates on.
+   * @param cm supplies the cluster manager the clusters are added to.
    */
   virtual CdsApiPtr createCds(const envoy::api::v2::core::ConfigSource& cds_config,
-                              ClusterManager& cm) PURE;
+                              uint32_t config_threads, ClusterManager& cm) PURE;
 
   /**
    * Returns the secret manager.
@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "envoy/data/core/v2alpha/health_check_event.pb.h"
+#include "envoy/event/dispatcher.h"
 #include "envoy/upstream/upstream.h"
 
 namespace Envoy {
@@ -57,6 +58,23 @@ public:
 
 typedef std::shared_ptr<HealthChecker> HealthCheckerSharedPtr;
 
+/**
+ * Pool of dispatchers, each running on its own thread, that run active health checking off the
+ * main thread.
+ */
+class HealthCheckerDispatcherPool {
+public:
+  virtual ~HealthCheckerDispatcherPool() {}
+
+  /**
+   * @return Event::Dispatcher& the dispatcher to run the next health check session on. The
+   *         dispatchers are handed out round robin. Must be called on the main thread.
+   */
+  virtual Event::Dispatcher& nextDispatcher() PURE;
+};
+
+typedef std::shared_ptr<HealthCheckerDispatcherPool> HealthCheckerDispatcherPoolSharedPtr;
+
 std::ostream& operator<<(std::ostream& out, HealthState state);
 std::ostream& operator<<(std::ostream& out, HealthTransition changed_state);
 
@@ -79,10 +79,22 @@ public:
    */
   virtual Resource& retries() PURE;
 
+  /**
+   * @return bool whether the active retries are limited by a retry budget, which scales with the
+   *         active and pending requests, rather than by a fixed maximum.
+   */
+  virtual bool hasRetryBudget() PURE;
+
   /**
    * @return Resource& active connection pools.
    */
   virtual Resource& connectionPools() PURE;
+
+  /**
+   * @return uint64_t the maximum number of connections to a single upstream host, counted across
+   *         all worker threads.
+   */
+  virtual uint64_t maxConnectionsPerHost() PURE;
 };
 
 } // namespace Upstream
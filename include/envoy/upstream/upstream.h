@@ -96,6 +96,13 @@ public:
   virtual CreateConnectionData
   createHealthCheckConnection(Event::Dispatcher& dispatcher) const PURE;
 
+  /**
+   * @param priority supplies the resource priority of the connection pool asking.
+   * @return true if another connection may be opened to this host without exceeding the
+   *         cluster's per host connection limit. Connections are counted across all workers.
+   */
+  virtual bool canCreateConnection(ResourcePriority priority) const PURE;
+
   /**
    * @return host specific gauges.
    */
@@ -275,6 +282,23 @@ public:
    */
   virtual const HostVector& degradedHosts() const PURE;
 
+  /**
+   * The *Ptr() variants below return the immutable vectors that back the set, which callers may
+   * share instead of copying. A host set update replaces the vectors rather than changing them.
+   * @return all hosts that make up the set at the current time.
+   */
+  virtual HostVectorConstSharedPtr hostsPtr() const PURE;
+
+  /**
+   * @return same as healthyHosts, as a shared immutable vector.
+   */
+  virtual HostVectorConstSharedPtr healthyHostsPtr() const PURE;
+
+  /**
+   * @return same as degradedHosts, as a shared immutable vector.
+   */
+  virtual HostVectorConstSharedPtr degradedHostsPtr() const PURE;
+
   /**
    * @return hosts per locality.
    */
@@ -290,6 +314,21 @@ public:
    */
   virtual const HostsPerLocality& degradedHostsPerLocality() const PURE;
 
+  /**
+   * @return same as hostsPerLocality, as a shared immutable object.
+   */
+  virtual HostsPerLocalityConstSharedPtr hostsPerLocalityPtr() const PURE;
+
+  /**
+   * @return same as healthyHostsPerLocality, as a shared immutable object.
+   */
+  virtual HostsPerLocalityConstSharedPtr healthyHostsPerLocalityPtr() const PURE;
+
+  /**
+   * @return same as degradedHostsPerLocality, as a shared immutable object.
+   */
+  virtual HostsPerLocalityConstSharedPtr degradedHostsPerLocalityPtr() const PURE;
+
   /**
    * @return weights for each locality in the host set.
    */
@@ -464,6 +503,8 @@ public:
   COUNTER  (upstream_cx_idle_timeout)                                                              \
   COUNTER  (upstream_cx_connect_attempts_exceeded)                                                 \
   COUNTER  (upstream_cx_overflow)                                                                  \
+  COUNTER  (upstream_cx_prefetch)                                                                  \
+  COUNTER  (upstream_cx_pipeline_timeout)                                                          \
   HISTOGRAM(upstream_cx_connect_ms)                                                                \
   HISTOGRAM(upstream_cx_length_ms)                                                                 \
   COUNTER  (upstream_cx_destroy)                                                                   \
@@ -486,6 +527,8 @@ public:
   COUNTER  (upstream_rq_pending_total)                                                             \
   COUNTER  (upstream_rq_pending_overflow)                                                          \
   COUNTER  (upstream_rq_pending_failure_eject)                                                     \
+  COUNTER  (upstream_rq_prefetched)                                                                \
+  COUNTER  (upstream_rq_pipelined)                                                                 \
   GAUGE    (upstream_rq_pending_active)                                                            \
   COUNTER  (upstream_rq_cancelled)                                                                 \
   COUNTER  (upstream_rq_maintenance_mode)                                                          \
@@ -496,6 +539,11 @@ public:
   COUNTER  (upstream_rq_retry)                                                                     \
   COUNTER  (upstream_rq_retry_success)                                                             \
   COUNTER  (upstream_rq_retry_overflow)                                                            \
+  COUNTER  (upstream_rq_retry_budget_exceeded)                                                     \
+  COUNTER  (upstream_rq_hedged)                                                                    \
+  COUNTER  (upstream_rq_hedge_won)                                                                 \
+  COUNTER  (upstream_rq_hedge_budget_exceeded)                                                     \
+  GAUGE    (upstream_rq_hedge_active)                                                              \
   COUNTER  (upstream_flow_control_paused_reading_total)                                            \
   COUNTER  (upstream_flow_control_resumed_reading_total)                                           \
   COUNTER  (upstream_flow_control_backed_up_total)                                                 \
@@ -514,6 +562,8 @@ public:
   COUNTER  (update_failure)                                                                        \
   COUNTER  (update_empty)                                                                          \
   COUNTER  (update_no_rebuild)                                                                     \
+  COUNTER  (update_coalesced)                                                                      \
+  HISTOGRAM(update_time_us)                                                                        \
   GAUGE    (version)
 // clang-format on
 
@@ -582,6 +632,26 @@ typedef std::shared_ptr<const ProtocolOptionsConfig> ProtocolOptionsConfigConstS
  */
 class ClusterTypedMetadataFactory : public Envoy::Config::TypedMetadataFactory {};
 
+/**
+ * An estimate of the 95th percentile of the latencies of the requests to a cluster, which follows
+ * the latencies as they change. The estimate is shared by all the workers.
+ */
+class LatencyEstimator {
+public:
+  virtual ~LatencyEstimator() {}
+
+  /**
+   * Update the estimate with the latency of a request.
+   * @param latency supplies the time from the end of the request to the end of its response.
+   */
+  virtual void recordLatency(std::chrono::milliseconds latency) PURE;
+
+  /**
+   * @return the estimated 95th percentile latency, or absl::nullopt if no latency was recorded.
+   */
+  virtual absl::optional<std::chrono::milliseconds> latencyP95() const PURE;
+};
+
 /**
  * Information about a given upstream cluster.
  */
@@ -625,6 +695,12 @@ public:
    */
   virtual uint64_t features() const PURE;
 
+  /**
+   * @return const Http::Http1Settings& for HTTP/1 connections created on behalf of this cluster.
+   *         @see Http::Http1Settings.
+   */
+  virtual const Http::Http1Settings& http1Settings() const PURE;
+
   /**
    * @return const Http::Http2Settings& for HTTP/2 connections created on behalf of this cluster.
    *         @see Http::Http2Settings.
@@ -762,11 +838,27 @@ public:
    */
   virtual bool drainConnectionsOnHostRemoval() const PURE;
 
+  /**
+   * @return float the minimum ratio of connections to pending and active requests that HTTP
+   *         connection pools for this cluster maintain per host.
+   */
+  virtual float perUpstreamPrefetchRatio() const PURE;
+
+  /**
+   * @return whether each worker connects to a host as soon as it is added to the cluster.
+   */
+  virtual bool prefetchOnHostAdd() const PURE;
+
   /**
    * @return eds cluster service_name of the cluster.
    */
   virtual absl::optional<std::string> eds_service_name() const PURE;
 
+  /**
+   * @return LatencyEstimator& the estimate of the latencies of the requests to the cluster.
+   */
+  virtual LatencyEstimator& latencyEstimator() const PURE;
+
 protected:
   /**
    * Invoked by extensionProtocolOptionsTyped.
@@ -782,6 +874,8 @@ protected:
 typedef std::shared_ptr<const ClusterInfo> ClusterInfoConstSharedPtr;
 
 class HealthChecker;
+class ThreadAwareLoadBalancer;
+typedef std::unique_ptr<ThreadAwareLoadBalancer> ThreadAwareLoadBalancerPtr;
 
 /**
  * An upstream cluster (group of hosts). This class is the "primary" singleton cluster used amongst
@@ -836,6 +930,15 @@ public:
    * @return the const PrioritySet for the cluster.
    */
   virtual const PrioritySet& prioritySet() const PURE;
+
+  /**
+   * Create the load balancer of a cluster whose load balancer type is
+   * LoadBalancerType::ClusterProvided. This is called once on the main thread when the cluster is
+   * added to the cluster manager.
+   * @return ThreadAwareLoadBalancerPtr the load balancer, or nullptr if the cluster does not
+   *         provide one.
+   */
+  virtual ThreadAwareLoadBalancerPtr createThreadAwareLoadBalancer() PURE;
 };
 
 typedef std::shared_ptr<Cluster> ClusterSharedPtr;
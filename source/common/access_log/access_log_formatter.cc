@@ -1,6 +1,8 @@
 #include "common/access_log/access_log_formatter.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -27,19 +29,42 @@ namespace {
 // empty.
 StreamInfoFormatter::FieldExtractor sslConnectionInfoStringExtractor(
     std::function<std::string(const Ssl::ConnectionInfo& connection_info)> string_extractor) {
-  return [string_extractor](const StreamInfo::StreamInfo& stream_info) {
+  return [string_extractor](const StreamInfo::StreamInfo& stream_info, std::string& output) {
     if (stream_info.downstreamSslConnection() == nullptr) {
-      return UnspecifiedValueString;
+      output += UnspecifiedValueString;
+      return;
     }
 
     const auto value = string_extractor(*stream_info.downstreamSslConnection());
-    if (value.empty()) {
-      return UnspecifiedValueString;
-    } else {
-      return value;
-    }
+    output += value.empty() ? UnspecifiedValueString : value;
   };
 }
+
+// Appends a string, or "-" if it is empty.
+void appendOrUnspecified(const std::string& value, std::string& output) {
+  output += value.empty() ? UnspecifiedValueString : value;
+}
+
+void appendDuration(const absl::optional<std::chrono::nanoseconds>& time, std::string& output) {
+  if (time) {
+    output += fmt::format_int(
+                  std::chrono::duration_cast<std::chrono::milliseconds>(time.value()).count())
+                  .c_str();
+  } else {
+    output += UnspecifiedValueString;
+  }
+}
+
+// Appends the duration between two times, or "-" if either of them is unknown.
+void appendDuration(const absl::optional<MonotonicTime>& start,
+                    const absl::optional<MonotonicTime>& end, std::string& output) {
+  if (start && end) {
+    appendDuration(std::chrono::nanoseconds(end.value() - start.value()), output);
+  } else {
+    output += UnspecifiedValueString;
+  }
+}
+
 } // namespace
 
 const std::string AccessLogFormatUtils::DEFAULT_FORMAT =
@@ -74,8 +99,24 @@ AccessLogFormatUtils::protocolToString(const absl::optional<Http::Protocol>& pro
   return UnspecifiedValueString;
 }
 
+std::string AppendingFormatterProvider::format(const Http::HeaderMap& request_headers,
+                                               const Http::HeaderMap& response_headers,
+                                               const Http::HeaderMap& response_trailers,
+                                               const StreamInfo::StreamInfo& stream_info) const {
+  std::string value;
+  formatTo(request_headers, response_headers, response_trailers, stream_info, value);
+  return value;
+}
+
 FormatterImpl::FormatterImpl(const std::string& format) {
-  providers_ = AccessLogFormatParser::parse(format);
+  for (FormatterProviderPtr& provider : AccessLogFormatParser::parse(format)) {
+    const auto* plain_string = dynamic_cast<const PlainStringFormatter*>(provider.get());
+    if (plain_string != nullptr) {
+      segments_.push_back({plain_string->str(), nullptr});
+    } else {
+      segments_.push_back({"", std::move(provider)});
+    }
+  }
 }
 
 std::string FormatterImpl::format(const Http::HeaderMap& request_headers,
@@ -84,18 +125,35 @@ std::string FormatterImpl::format(const Http::HeaderMap& request_headers,
                                   const StreamInfo::StreamInfo& stream_info) const {
   std::string log_line;
   log_line.reserve(256);
+  formatTo(request_headers, response_headers, response_trailers, stream_info, log_line);
+  return log_line;
+}
 
-  for (const FormatterProviderPtr& provider : providers_) {
-    log_line += provider->format(request_headers, response_headers, response_trailers, stream_info);
+void FormatterImpl::formatTo(const Http::HeaderMap& request_headers,
+                             const Http::HeaderMap& response_headers,
+                             const Http::HeaderMap& response_trailers,
+                             const StreamInfo::StreamInfo& stream_info,
+                             std::string& output) const {
+  for (const Segment& segment : segments_) {
+    if (segment.provider_ == nullptr) {
+      output += segment.literal_;
+    } else {
+      segment.provider_->formatTo(request_headers, response_headers, response_trailers,
+                                  stream_info, output);
+    }
   }
-
-  return log_line;
 }
 
 JsonFormatterImpl::JsonFormatterImpl(std::unordered_map<std::string, std::string>& format_mapping) {
-  for (const auto& pair : format_mapping) {
-    auto providers = AccessLogFormatParser::parse(pair.second);
-    json_output_format_.emplace(pair.first, FormatterPtr{new FormatterImpl(pair.second)});
+  // The keys are sorted, so that the fields of every line are in the same order.
+  const std::map<std::string, std::string> sorted_mapping(format_mapping.begin(),
+                                                          format_mapping.end());
+  fields_.reserve(sorted_mapping.size());
+  for (const auto& pair : sorted_mapping) {
+    std::string key;
+    appendJsonString(pair.first, key);
+    key += ':';
+    fields_.push_back({std::move(key), FormatterImpl(pair.second)});
   }
 }
 
@@ -103,34 +161,87 @@ std::string JsonFormatterImpl::format(const Http::HeaderMap& request_headers,
                                       const Http::HeaderMap& response_headers,
                                       const Http::HeaderMap& response_trailers,
                                       const StreamInfo::StreamInfo& stream_info) const {
-  const auto output_map = toMap(request_headers, response_headers, response_trailers, stream_info);
+  std::string log_line;
+  log_line.reserve(256);
+  formatTo(request_headers, response_headers, response_trailers, stream_info, log_line);
+  return log_line;
+}
 
-  ProtobufWkt::Struct output_struct;
-  for (const auto& pair : output_map) {
-    ProtobufWkt::Value string_value;
-    string_value.set_string_value(pair.second);
-    (*output_struct.mutable_fields())[pair.first] = string_value;
+void JsonFormatterImpl::formatTo(const Http::HeaderMap& request_headers,
+                                 const Http::HeaderMap& response_headers,
+                                 const Http::HeaderMap& response_trailers,
+                                 const StreamInfo::StreamInfo& stream_info,
+                                 std::string& output) const {
+  output += '{';
+  for (const Field& field : fields_) {
+    if (&field != &fields_.front()) {
+      output += ',';
+    }
+    output += field.key_;
+
+    // The value is formatted in place, and only copied to be escaped if it needs to be.
+    output += '"';
+    const size_t value_start = output.size();
+    field.formatter_.formatTo(request_headers, response_headers, response_trailers, stream_info,
+                              output);
+    const auto needs_escaping = [](char c) {
+      return static_cast<unsigned char>(c) < 0x20 || c == '"' || c == '\\';
+    };
+    if (std::any_of(output.begin() + value_start, output.end(), needs_escaping)) {
+      const std::string value = output.substr(value_start);
+      output.resize(value_start - 1);
+      appendJsonString(value, output);
+    } else {
+      output += '"';
+    }
   }
+  output += "}\n";
+}
 
-  ProtobufTypes::String log_line;
-  const auto conversion_status = Protobuf::util::MessageToJsonString(output_struct, &log_line);
-  if (!conversion_status.ok()) {
-    log_line =
-        fmt::format("Error serializing access log to JSON: {}", conversion_status.ToString());
-  }
+void JsonFormatterImpl::appendJsonString(absl::string_view value, std::string& output) {
+  static const char HexDigits[] = "0123456789abcdef";
 
-  return absl::StrCat(log_line, "\n");
-}
+  output += '"';
+  size_t unescaped_start = 0;
+  for (size_t i = 0; i < value.size(); i++) {
+    const unsigned char c = value[i];
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
 
-std::unordered_map<std::string, std::string> JsonFormatterImpl::toMap(
-    const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
-    const Http::HeaderMap& response_trailers, const StreamInfo::StreamInfo& stream_info) const {
-  std::unordered_map<std::string, std::string> output;
-  for (const auto& pair : json_output_format_) {
-    output.emplace(pair.first, pair.second->format(request_headers, response_headers,
-                                                   response_trailers, stream_info));
+    output.append(value.data() + unescaped_start, i - unescaped_start);
+    unescaped_start = i + 1;
+    switch (c) {
+    case '"':
+      output += "\\\"";
+      break;
+    case '\\':
+      output += "\\\\";
+      break;
+    case '\b':
+      output += "\\b";
+      break;
+    case '\f':
+      output += "\\f";
+      break;
+    case '\n':
+      output += "\\n";
+      break;
+    case '\r':
+      output += "\\r";
+      break;
+    case '\t':
+      output += "\\t";
+      break;
+    default:
+      output += "\\u00";
+      output += HexDigits[c >> 4];
+      output += HexDigits[c & 0xf];
+      break;
+    }
   }
-  return output;
+  output.append(value.data() + unescaped_start, value.size() - unescaped_start);
+  output += '"';
 }
 
 void AccessLogFormatParser::parseCommandHeader(const std::string& token, const size_t start,
@@ -278,98 +389,112 @@ std::vector<FormatterProviderPtr> AccessLogFormatParser::parse(const std::string
 StreamInfoFormatter::StreamInfoFormatter(const std::string& field_name) {
 
   if (field_name == "REQUEST_DURATION") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return AccessLogFormatUtils::durationToString(stream_info.lastDownstreamRxByteReceived());
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendDuration(stream_info.lastDownstreamRxByteReceived(), output);
     };
   } else if (field_name == "RESPONSE_DURATION") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return AccessLogFormatUtils::durationToString(stream_info.firstUpstreamRxByteReceived());
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendDuration(stream_info.firstUpstreamRxByteReceived(), output);
     };
   } else if (field_name == "RESPONSE_TX_DURATION") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
       auto downstream = stream_info.lastDownstreamTxByteSent();
       auto upstream = stream_info.firstUpstreamRxByteReceived();
 
       if (downstream && upstream) {
-        auto val = downstream.value() - upstream.value();
-        return AccessLogFormatUtils::durationToString(val);
+        appendDuration(downstream.value() - upstream.value(), output);
+        return;
       }
 
-      return UnspecifiedValueString;
+      output += UnspecifiedValueString;
+    };
+  } else if (field_name == "FILTER_DURATION") {
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendDuration(stream_info.startTimeMonotonic(),
+                     stream_info.upstreamTiming().upstream_request_start_, output);
+    };
+  } else if (field_name == "UPSTREAM_POOL_WAIT_DURATION") {
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      const StreamInfo::UpstreamTiming& timing = stream_info.upstreamTiming();
+      appendDuration(timing.upstream_request_start_, timing.first_upstream_tx_byte_sent_, output);
+    };
+  } else if (field_name == "UPSTREAM_CONNECT_DURATION") {
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      const StreamInfo::UpstreamTiming& timing = stream_info.upstreamTiming();
+      appendDuration(timing.upstream_connect_start_, timing.upstream_connect_complete_, output);
+    };
+  } else if (field_name == "UPSTREAM_HANDSHAKE_DURATION") {
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      const StreamInfo::UpstreamTiming& timing = stream_info.upstreamTiming();
+      appendDuration(timing.upstream_connect_complete_, timing.upstream_handshake_complete_,
+                     output);
     };
   } else if (field_name == "BYTES_RECEIVED") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return fmt::format_int(stream_info.bytesReceived()).str();
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += fmt::format_int(stream_info.bytesReceived()).c_str();
     };
   } else if (field_name == "PROTOCOL") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return AccessLogFormatUtils::protocolToString(stream_info.protocol());
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += AccessLogFormatUtils::protocolToString(stream_info.protocol());
     };
   } else if (field_name == "RESPONSE_CODE") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return stream_info.responseCode() ? fmt::format_int(stream_info.responseCode().value()).str()
-                                        : "0";
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += stream_info.responseCode()
+                    ? fmt::format_int(stream_info.responseCode().value()).c_str()
+                    : "0";
     };
   } else if (field_name == "BYTES_SENT") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return fmt::format_int(stream_info.bytesSent()).str();
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += fmt::format_int(stream_info.bytesSent()).c_str();
     };
   } else if (field_name == "DURATION") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return AccessLogFormatUtils::durationToString(stream_info.requestComplete());
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendDuration(stream_info.requestComplete(), output);
     };
   } else if (field_name == "RESPONSE_FLAGS") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return StreamInfo::ResponseFlagUtils::toShortString(stream_info);
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += StreamInfo::ResponseFlagUtils::toShortString(stream_info);
     };
   } else if (field_name == "UPSTREAM_HOST") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      if (stream_info.upstreamHost()) {
-        return stream_info.upstreamHost()->address()->asString();
-      } else {
-        return UnspecifiedValueString;
-      }
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += stream_info.upstreamHost() ? stream_info.upstreamHost()->address()->asString()
+                                           : UnspecifiedValueString;
     };
   } else if (field_name == "UPSTREAM_CLUSTER") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      std::string upstream_cluster_name;
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
       if (nullptr != stream_info.upstreamHost()) {
-        upstream_cluster_name = stream_info.upstreamHost()->cluster().name();
+        appendOrUnspecified(stream_info.upstreamHost()->cluster().name(), output);
+      } else {
+        output += UnspecifiedValueString;
       }
-
-      return upstream_cluster_name.empty() ? UnspecifiedValueString : upstream_cluster_name;
     };
   } else if (field_name == "UPSTREAM_LOCAL_ADDRESS") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return stream_info.upstreamLocalAddress() != nullptr
-                 ? stream_info.upstreamLocalAddress()->asString()
-                 : UnspecifiedValueString;
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += stream_info.upstreamLocalAddress() != nullptr
+                    ? stream_info.upstreamLocalAddress()->asString()
+                    : UnspecifiedValueString;
     };
   } else if (field_name == "DOWNSTREAM_LOCAL_ADDRESS") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return stream_info.downstreamLocalAddress()->asString();
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += stream_info.downstreamLocalAddress()->asString();
     };
   } else if (field_name == "DOWNSTREAM_LOCAL_ADDRESS_WITHOUT_PORT") {
-    field_extractor_ = [](const Envoy::StreamInfo::StreamInfo& stream_info) {
-      return StreamInfo::Utility::formatDownstreamAddressNoPort(
+    field_extractor_ = [](const Envoy::StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += StreamInfo::Utility::formatDownstreamAddressNoPort(
           *stream_info.downstreamLocalAddress());
     };
   } else if (field_name == "DOWNSTREAM_REMOTE_ADDRESS") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return stream_info.downstreamRemoteAddress()->asString();
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += stream_info.downstreamRemoteAddress()->asString();
     };
   } else if (field_name == "DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return StreamInfo::Utility::formatDownstreamAddressNoPort(
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output += StreamInfo::Utility::formatDownstreamAddressNoPort(
           *stream_info.downstreamRemoteAddress());
     };
   } else if (field_name == "REQUESTED_SERVER_NAME") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      if (!stream_info.requestedServerName().empty()) {
-        return stream_info.requestedServerName();
-      } else {
-        return UnspecifiedValueString;
-      }
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendOrUnspecified(stream_info.requestedServerName(), output);
     };
   } else if (field_name == "DOWNSTREAM_PEER_URI_SAN") {
     field_extractor_ =
@@ -392,30 +517,27 @@ StreamInfoFormatter::StreamInfoFormatter(const std::string& field_name) {
           return connection_info.subjectLocalCertificate();
         });
   } else if (field_name == "UPSTREAM_TRANSPORT_FAILURE_REASON") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      if (!stream_info.upstreamTransportFailureReason().empty()) {
-        return stream_info.upstreamTransportFailureReason();
-      } else {
-        return UnspecifiedValueString;
-      }
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendOrUnspecified(stream_info.upstreamTransportFailureReason(), output);
     };
   } else {
     throw EnvoyException(fmt::format("Not supported field in StreamInfo: {}", field_name));
   }
 }
 
-std::string StreamInfoFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                        const Http::HeaderMap&,
-                                        const StreamInfo::StreamInfo& stream_info) const {
-  return field_extractor_(stream_info);
+void StreamInfoFormatter::formatTo(const Http::HeaderMap&, const Http::HeaderMap&,
+                                   const Http::HeaderMap&,
+                                   const StreamInfo::StreamInfo& stream_info,
+                                   std::string& output) const {
+  field_extractor_(stream_info, output);
 }
 
 PlainStringFormatter::PlainStringFormatter(const std::string& str) : str_(str) {}
 
-std::string PlainStringFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                         const Http::HeaderMap&,
-                                         const StreamInfo::StreamInfo&) const {
-  return str_;
+void PlainStringFormatter::formatTo(const Http::HeaderMap&, const Http::HeaderMap&,
+                                    const Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                                    std::string& output) const {
+  output += str_;
 }
 
 HeaderFormatter::HeaderFormatter(const std::string& main_header,
@@ -423,25 +545,20 @@ HeaderFormatter::HeaderFormatter(const std::string& main_header,
                                  absl::optional<size_t> max_length)
     : main_header_(main_header), alternative_header_(alternative_header), max_length_(max_length) {}
 
-std::string HeaderFormatter::format(const Http::HeaderMap& headers) const {
+void HeaderFormatter::formatTo(const Http::HeaderMap& headers, std::string& output) const {
   const Http::HeaderEntry* header = headers.get(main_header_);
 
   if (!header && !alternative_header_.get().empty()) {
     header = headers.get(alternative_header_);
   }
 
-  std::string header_value_string;
-  if (!header) {
-    header_value_string = UnspecifiedValueString;
-  } else {
-    header_value_string = header->value().c_str();
+  absl::string_view header_value =
+      header ? header->value().getStringView() : absl::string_view(UnspecifiedValueString);
+  if (max_length_ && header_value.length() > max_length_.value()) {
+    header_value = header_value.substr(0, max_length_.value());
   }
 
-  if (max_length_ && header_value_string.length() > max_length_.value()) {
-    return header_value_string.substr(0, max_length_.value());
-  }
-
-  return header_value_string;
+  output.append(header_value.data(), header_value.size());
 }
 
 ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
@@ -449,11 +566,11 @@ ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
                                                  absl::optional<size_t> max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string ResponseHeaderFormatter::format(const Http::HeaderMap&,
-                                            const Http::HeaderMap& response_headers,
-                                            const Http::HeaderMap&,
-                                            const StreamInfo::StreamInfo&) const {
-  return HeaderFormatter::format(response_headers);
+void ResponseHeaderFormatter::formatTo(const Http::HeaderMap&,
+                                       const Http::HeaderMap& response_headers,
+                                       const Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                                       std::string& output) const {
+  HeaderFormatter::formatTo(response_headers, output);
 }
 
 RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
@@ -461,10 +578,10 @@ RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
                                                absl::optional<size_t> max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string RequestHeaderFormatter::format(const Http::HeaderMap& request_headers,
-                                           const Http::HeaderMap&, const Http::HeaderMap&,
-                                           const StreamInfo::StreamInfo&) const {
-  return HeaderFormatter::format(request_headers);
+void RequestHeaderFormatter::formatTo(const Http::HeaderMap& request_headers,
+                                      const Http::HeaderMap&, const Http::HeaderMap&,
+                                      const StreamInfo::StreamInfo&, std::string& output) const {
+  HeaderFormatter::formatTo(request_headers, output);
 }
 
 ResponseTrailerFormatter::ResponseTrailerFormatter(const std::string& main_header,
@@ -472,10 +589,10 @@ ResponseTrailerFormatter::ResponseTrailerFormatter(const std::string& main_heade
                                                    absl::optional<size_t> max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string ResponseTrailerFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                             const Http::HeaderMap& response_trailers,
-                                             const StreamInfo::StreamInfo&) const {
-  return HeaderFormatter::format(response_trailers);
+void ResponseTrailerFormatter::formatTo(const Http::HeaderMap&, const Http::HeaderMap&,
+                                        const Http::HeaderMap& response_trailers,
+                                        const StreamInfo::StreamInfo&, std::string& output) const {
+  HeaderFormatter::formatTo(response_trailers, output);
 }
 
 MetadataFormatter::MetadataFormatter(const std::string& filter_namespace,
@@ -514,21 +631,22 @@ DynamicMetadataFormatter::DynamicMetadataFormatter(const std::string& filter_nam
                                                    absl::optional<size_t> max_length)
     : MetadataFormatter(filter_namespace, path, max_length) {}
 
-std::string DynamicMetadataFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                             const Http::HeaderMap&,
-                                             const StreamInfo::StreamInfo& stream_info) const {
-  return MetadataFormatter::format(stream_info.dynamicMetadata());
+void DynamicMetadataFormatter::formatTo(const Http::HeaderMap&, const Http::HeaderMap&,
+                                        const Http::HeaderMap&,
+                                        const StreamInfo::StreamInfo& stream_info,
+                                        std::string& output) const {
+  output += MetadataFormatter::format(stream_info.dynamicMetadata());
 }
 
 StartTimeFormatter::StartTimeFormatter(const std::string& format) : date_formatter_(format) {}
 
-std::string StartTimeFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                       const Http::HeaderMap&,
-                                       const StreamInfo::StreamInfo& stream_info) const {
+void StartTimeFormatter::formatTo(const Http::HeaderMap&, const Http::HeaderMap&,
+                                  const Http::HeaderMap&, const StreamInfo::StreamInfo& stream_info,
+                                  std::string& output) const {
   if (date_formatter_.formatString().empty()) {
-    return AccessLogDateTimeFormatter::fromTime(stream_info.startTime());
+    output += AccessLogDateTimeFormatter::fromTime(stream_info.startTime());
   } else {
-    return date_formatter_.fromTime(stream_info.startTime());
+    output += date_formatter_.fromTime(stream_info.startTime());
   }
 }
 
@@ -11,6 +11,7 @@
 
 #include "common/common/utility.h"
 
+#include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
@@ -83,52 +84,92 @@ private:
 };
 
 /**
- * Composite formatter implementation.
+ * Base class of the formatter providers, which append their value to the output. format() returns
+ * the appended value.
+ */
+class AppendingFormatterProvider : public FormatterProvider {
+public:
+  // FormatterProvider
+  std::string format(const Http::HeaderMap& request_headers,
+                     const Http::HeaderMap& response_headers,
+                     const Http::HeaderMap& response_trailers,
+                     const StreamInfo::StreamInfo& stream_info) const override;
+};
+
+/**
+ * Composite formatter implementation. The format is parsed into a flat list of segments, each
+ * either a string literal that is appended as is or a provider of a value.
  */
 class FormatterImpl : public Formatter {
 public:
   FormatterImpl(const std::string& format);
 
-  // Formatter::format
+  // Formatter
   std::string format(const Http::HeaderMap& request_headers,
                      const Http::HeaderMap& response_headers,
                      const Http::HeaderMap& response_trailers,
                      const StreamInfo::StreamInfo& stream_info) const override;
+  void formatTo(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+                const Http::HeaderMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, std::string& output) const override;
 
 private:
-  std::vector<FormatterProviderPtr> providers_;
+  struct Segment {
+    std::string literal_;
+    // nullptr for a string literal.
+    FormatterProviderPtr provider_;
+  };
+
+  std::vector<Segment> segments_;
 };
 
+/**
+ * Formatter of a JSON object with the configured keys, whose values are formatted by a
+ * FormatterImpl each. The object is written directly into the output, with the keys in order.
+ */
 class JsonFormatterImpl : public Formatter {
 public:
   JsonFormatterImpl(std::unordered_map<std::string, std::string>& format_mapping);
 
-  // Formatter::format
+  // Formatter
   std::string format(const Http::HeaderMap& request_headers,
                      const Http::HeaderMap& response_headers,
                      const Http::HeaderMap& response_trailers,
                      const StreamInfo::StreamInfo& stream_info) const override;
+  void formatTo(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+                const Http::HeaderMap& response_trailers,
+                const StreamInfo::StreamInfo& stream_info, std::string& output) const override;
+
+  /**
+   * Append a string to the output as a JSON string. Bytes that are not ASCII are copied as is.
+   * @param value supplies the string.
+   * @param output supplies the output.
+   */
+  static void appendJsonString(absl::string_view value, std::string& output);
 
 private:
-  std::vector<FormatterProviderPtr> providers_;
-  std::map<const std::string, Envoy::AccessLog::FormatterPtr> json_output_format_;
+  struct Field {
+    // The key of the field, already escaped and followed by a ':'.
+    std::string key_;
+    FormatterImpl formatter_;
+  };
 
-  std::unordered_map<std::string, std::string>
-  toMap(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
-        const Http::HeaderMap& response_trailers, const StreamInfo::StreamInfo& stream_info) const;
+  std::vector<Field> fields_;
 };
 
 /**
  * Formatter for string literal. It ignores headers and stream info and returns string by which it
  * was initialized.
  */
-class PlainStringFormatter : public FormatterProvider {
+class PlainStringFormatter : public AppendingFormatterProvider {
 public:
   PlainStringFormatter(const std::string& str);
 
-  // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const StreamInfo::StreamInfo&) const override;
+  // FormatterProvider
+  void formatTo(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                const StreamInfo::StreamInfo&, std::string& output) const override;
+
+  const std::string& str() const { return str_; }
 
 private:
   std::string str_;
@@ -139,7 +180,7 @@ public:
   HeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                   absl::optional<size_t> max_length);
 
-  std::string format(const Http::HeaderMap& headers) const;
+  void formatTo(const Http::HeaderMap& headers, std::string& output) const;
 
 private:
   Http::LowerCaseString main_header_;
@@ -150,55 +191,60 @@ private:
 /**
  * Formatter based on request header.
  */
-class RequestHeaderFormatter : public FormatterProvider, HeaderFormatter {
+class RequestHeaderFormatter : public AppendingFormatterProvider, HeaderFormatter {
 public:
   RequestHeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                          absl::optional<size_t> max_length);
 
-  // Formatter::format
-  std::string format(const Http::HeaderMap& request_headers, const Http::HeaderMap&,
-                     const Http::HeaderMap&, const StreamInfo::StreamInfo&) const override;
+  // FormatterProvider
+  void formatTo(const Http::HeaderMap& request_headers, const Http::HeaderMap&,
+                const Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                std::string& output) const override;
 };
 
 /**
  * Formatter based on the response header.
  */
-class ResponseHeaderFormatter : public FormatterProvider, HeaderFormatter {
+class ResponseHeaderFormatter : public AppendingFormatterProvider, HeaderFormatter {
 public:
   ResponseHeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                           absl::optional<size_t> max_length);
 
-  // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap& response_headers,
-                     const Http::HeaderMap&, const StreamInfo::StreamInfo&) const override;
+  // FormatterProvider
+  void formatTo(const Http::HeaderMap&, const Http::HeaderMap& response_headers,
+                const Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                std::string& output) const override;
 };
 
 /**
  * Formatter based on the response trailer.
  */
-class ResponseTrailerFormatter : public FormatterProvider, HeaderFormatter {
+class ResponseTrailerFormatter : public AppendingFormatterProvider, HeaderFormatter {
 public:
   ResponseTrailerFormatter(const std::string& main_header, const std::string& alternative_header,
                            absl::optional<size_t> max_length);
 
-  // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&,
-                     const Http::HeaderMap& response_trailers,
-                     const StreamInfo::StreamInfo&) const override;
+  // FormatterProvider
+  void formatTo(const Http::HeaderMap&, const Http::HeaderMap&,
+                const Http::HeaderMap& response_trailers, const StreamInfo::StreamInfo&,
+                std::string& output) const override;
 };
 
 /**
  * Formatter based on the StreamInfo field.
  */
-class StreamInfoFormatter : public FormatterProvider {
+class StreamInfoFormatter : public AppendingFormatterProvider {
 public:
   StreamInfoFormatter(const std::string& field_name);
 
-  // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const StreamInfo::StreamInfo& stream_info) const override;
+  // FormatterProvider
+  void formatTo(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                const StreamInfo::StreamInfo& stream_info, std::string& output) const override;
 
-  using FieldExtractor = std::function<std::string(const StreamInfo::StreamInfo&)>;
+  /**
+   * Appends a field of the stream info to the output.
+   */
+  using FieldExtractor = std::function<void(const StreamInfo::StreamInfo&, std::string& output)>;
 
 private:
   FieldExtractor field_extractor_;
@@ -223,24 +269,26 @@ private:
 /**
  * Formatter based on the DynamicMetadata from StreamInfo.
  */
-class DynamicMetadataFormatter : public FormatterProvider, MetadataFormatter {
+class DynamicMetadataFormatter : public AppendingFormatterProvider, MetadataFormatter {
 public:
   DynamicMetadataFormatter(const std::string& filter_namespace,
                            const std::vector<std::string>& path, absl::optional<size_t> max_length);
 
-  // FormatterProvider::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const StreamInfo::StreamInfo& stream_info) const override;
+  // FormatterProvider
+  void formatTo(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                const StreamInfo::StreamInfo& stream_info, std::string& output) const override;
 };
 
 /**
  * Formatter
  */
-class StartTimeFormatter : public FormatterProvider {
+class StartTimeFormatter : public AppendingFormatterProvider {
 public:
   StartTimeFormatter(const std::string& format);
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const StreamInfo::StreamInfo&) const override;
+
+  // FormatterProvider
+  void formatTo(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                const StreamInfo::StreamInfo& stream_info, std::string& output) const override;
 
 private:
   const Envoy::DateFormatter date_formatter_;
@@ -23,18 +23,19 @@ AccessLogFileSharedPtr AccessLogManagerImpl::createAccessLog(const std::string&
 
   access_logs_[file_name] = std::make_shared<AccessLogFileImpl>(
       api_.fileSystem().createFile(file_name), dispatcher_, lock_, file_stats_,
-      file_flush_interval_msec_, api_.threadFactory());
+      file_flush_interval_msec_, file_max_buffered_bytes_, api_.threadFactory());
   return access_logs_[file_name];
 }
 
 AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                                      Thread::BasicLockable& lock, AccessLogFileStats& stats,
                                      std::chrono::milliseconds flush_interval_msec,
+                                     uint64_t max_buffered_bytes,
                                      Thread::ThreadFactory& thread_factory)
-    : file_(std::move(file)), file_lock_(lock),
+    : file_(std::move(file)), file_lock_(lock), max_buffered_bytes_(max_buffered_bytes),
       flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        requestFlush();
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
       thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats) {
@@ -52,20 +53,23 @@ void AccessLogFileImpl::open() {
 void AccessLogFileImpl::reopen() { reopen_file_ = true; }
 
 AccessLogFileImpl::~AccessLogFileImpl() {
+  Thread::ThreadPtr flush_thread;
   {
-    Thread::LockGuard lock(write_lock_);
+    Thread::LockGuard lock(flush_event_lock_);
     flush_thread_exit_ = true;
     flush_event_.notifyOne();
+    flush_thread = std::move(flush_thread_);
   }
 
-  if (flush_thread_ != nullptr) {
-    flush_thread_->join();
+  if (flush_thread != nullptr) {
+    flush_thread->join();
   }
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (file_->isOpen()) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
+    drainShards(about_to_write_buffer_);
+    if (about_to_write_buffer_.length() > 0) {
+      doWrite(about_to_write_buffer_);
     }
 
     const Api::IoCallBoolResult result = file_->close();
@@ -101,29 +105,37 @@ void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
   buffer.drain(buffer.length());
 }
 
+void AccessLogFileImpl::drainShards(Buffer::Instance& buffer) {
+  for (WriteShard& shard : write_shards_) {
+    Thread::LockGuard shard_lock(shard.lock_);
+    shard_buffered_bytes_ -= shard.buffer_.length();
+    buffer.move(shard.buffer_);
+  }
+}
+
 void AccessLogFileImpl::flushThreadFunc() {
 
   while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
-
     {
-      Thread::LockGuard write_lock(write_lock_);
+      Thread::LockGuard event_lock(flush_event_lock_);
 
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_) {
+      // flush_event_ can be woken up either by large enough write shards or by timer.
+      // In case it was timer, the write shards can be empty.
+      while (!flush_requested_ && !flush_thread_exit_) {
         // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
+        flush_event_.wait(flush_event_lock_);
       }
 
       if (flush_thread_exit_) {
         return;
       }
+      flush_requested_ = false;
+    }
 
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      ASSERT(flush_buffer_.length() > 0);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
+    Thread::LockGuard flush_lock(flush_lock_);
+    drainShards(about_to_write_buffer_);
+    if (about_to_write_buffer_.length() == 0) {
+      continue;
     }
 
     // if we failed to open file before, then simply ignore
@@ -146,44 +158,62 @@ void AccessLogFileImpl::flushThreadFunc() {
 }
 
 void AccessLogFileImpl::flush() {
-  std::unique_lock<Thread::BasicLockable> flush_buffer_lock;
-
-  {
-    Thread::LockGuard write_lock(write_lock_);
-
-    // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
-    // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
-    // but has not yet completed doWrite(). This would allow flush() to
-    // return before the pending data has actually been written to disk.
-    flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
-
-    about_to_write_buffer_.move(flush_buffer_);
-    ASSERT(flush_buffer_.length() == 0);
+  // flush_lock_ must be held while draining the write shards or else it is
+  // possible that flushThreadFunc() has already moved data from the shards
+  // to about_to_write_buffer_, but has not yet completed doWrite(). This
+  // would allow flush() to return before the pending data has actually been
+  // written to disk.
+  Thread::LockGuard flush_lock(flush_lock_);
+  drainShards(about_to_write_buffer_);
+  if (about_to_write_buffer_.length() == 0) {
+    return;
   }
 
   doWrite(about_to_write_buffer_);
 }
 
 void AccessLogFileImpl::write(absl::string_view data) {
-  Thread::LockGuard lock(write_lock_);
+  if (!flush_thread_created_) {
+    Thread::LockGuard event_lock(flush_event_lock_);
+    if (flush_thread_ == nullptr) {
+      createFlushStructures();
+      flush_thread_created_ = true;
+    }
+  }
 
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
+  // The limit is checked without holding any lock, so concurrent writes may exceed it slightly.
+  if (max_buffered_bytes_ > 0 && shard_buffered_bytes_ + data.size() > max_buffered_bytes_) {
+    stats_.write_dropped_.inc();
+    return;
   }
 
+  // Each thread sticks to a shard, so that the shard lock is normally uncontended.
+  static std::atomic<uint32_t> next_shard;
+  static thread_local const uint32_t shard_index = next_shard++ % NUM_WRITE_SHARDS;
+  WriteShard& shard = write_shards_[shard_index];
   stats_.write_buffered_.inc();
   stats_.write_total_buffered_.add(data.length());
-  flush_buffer_.add(data.data(), data.size());
-  if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
-    flush_event_.notifyOne();
+  if (!shard.lock_.tryLock()) {
+    stats_.write_blocked_.inc();
+    shard.lock_.lock();
+  }
+  shard.buffer_.add(data.data(), data.size());
+  const uint64_t buffered_bytes = shard_buffered_bytes_ += data.size();
+  shard.lock_.unlock();
+
+  // Only the write that crosses the threshold wakes up the flush thread, which drains all the
+  // shards.
+  if (buffered_bytes > MIN_FLUSH_SIZE && buffered_bytes - data.size() <= MIN_FLUSH_SIZE) {
+    requestFlush();
   }
 }
 
+void AccessLogFileImpl::requestFlush() {
+  Thread::LockGuard event_lock(flush_event_lock_);
+  flush_requested_ = true;
+  flush_event_.notifyOne();
+}
+
 void AccessLogFileImpl::createFlushStructures() {
   flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); });
   flush_timer_->enableTimer(flush_interval_msec_);
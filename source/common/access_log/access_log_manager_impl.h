@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <string>
 #include <unordered_map>
 
@@ -18,6 +20,8 @@ namespace Envoy {
 // clang-format off
 #define ACCESS_LOG_FILE_STATS(COUNTER, GAUGE)                                                      \
   COUNTER(write_buffered)                                                                          \
+  COUNTER(write_blocked)                                                                           \
+  COUNTER(write_dropped)                                                                           \
   COUNTER(write_completed)                                                                         \
   COUNTER(flushed_by_timer)                                                                        \
   COUNTER(reopen_failed)                                                                           \
@@ -32,10 +36,12 @@ namespace AccessLog {
 
 class AccessLogManagerImpl : public AccessLogManager {
 public:
-  AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec, Api::Api& api,
+  AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec,
+                       uint64_t file_max_buffered_bytes, Api::Api& api,
                        Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
                        Stats::Store& stats_store)
-      : file_flush_interval_msec_(file_flush_interval_msec), api_(api), dispatcher_(dispatcher),
+      : file_flush_interval_msec_(file_flush_interval_msec),
+        file_max_buffered_bytes_(file_max_buffered_bytes), api_(api), dispatcher_(dispatcher),
         lock_(lock), file_stats_{ACCESS_LOG_FILE_STATS(
                          POOL_COUNTER_PREFIX(stats_store, "access_log_file."),
                          POOL_GAUGE_PREFIX(stats_store, "access_log_file."))} {}
@@ -46,6 +52,7 @@ public:
 
 private:
   const std::chrono::milliseconds file_flush_interval_msec_;
+  const uint64_t file_max_buffered_bytes_;
   Api::Api& api_;
   Event::Dispatcher& dispatcher_;
   Thread::BasicLockable& lock_;
@@ -59,12 +66,18 @@ private:
  * This implementation uses a flush thread per file, with the idea there there aren't that many
  * files. If this turns out to be a good implementation we can potentially have a single flush
  * thread that flushes all files, but we will start with this.
+ *
+ * Writes are appended to one of several write shards, each with a lock and a buffer of its own,
+ * picked by the writing thread. Each worker thread thus mostly has a shard to itself, so that
+ * the workers do not contend on a single lock for every log line. The flush thread drains all
+ * the shards before writing to disk. Log lines of different threads may therefore be reordered
+ * within a flush, but each log line is written whole.
  */
 class AccessLogFileImpl : public AccessLogFile {
 public:
   AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                     Thread::BasicLockable& lock, AccessLogFileStats& stats_,
-                    std::chrono::milliseconds flush_interval_msec,
+                    std::chrono::milliseconds flush_interval_msec, uint64_t max_buffered_bytes,
                     Thread::ThreadFactory& thread_factory);
   ~AccessLogFileImpl();
 
@@ -80,20 +93,31 @@ public:
   void flush() override;
 
 private:
+  struct WriteShard {
+    Thread::MutexBasicLockable lock_;
+    Buffer::OwnedImpl buffer_ GUARDED_BY(lock_);
+  };
+
   void doWrite(Buffer::Instance& buffer);
+  void drainShards(Buffer::Instance& buffer);
   void flushThreadFunc();
   void open();
   void createFlushStructures();
+  void requestFlush();
 
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
+  // Number of write shards. Threads are assigned to shards round-robin, so this bounds the number
+  // of workers that have a shard to themselves.
+  static const uint32_t NUM_WRITE_SHARDS = 16;
 
   Filesystem::FilePtr file_;
 
   // These locks are always acquired in the following order if multiple locks are held:
-  //    1) write_lock_
-  //    2) flush_lock_
+  //    1) flush_lock_
+  //    2) the lock_ of a write shard
   //    3) file_lock_
+  // flush_event_lock_ is never held together with another lock.
   Thread::BasicLockable& file_lock_;      // This lock is used only by the flush thread when writing
                                           // to disk. This is used to make sure that file blocks do
                                           // not get interleaved by multiple processes writing to
@@ -104,23 +128,27 @@ private:
                                           // and all other data used during flushing and file
                                           // re-opening.
   Thread::MutexBasicLockable
-      write_lock_; // The lock is used when filling the flush buffer. It allows
-                   // multiple threads to write to the same file at relatively
-                   // high performance. It is always local to the process.
-  Thread::ThreadPtr flush_thread_;
+      flush_event_lock_; // This lock is used to wake up the flush thread, either when enough data
+                         // is buffered or when the timer fires, and guards the creation of the
+                         // flush thread.
+  Thread::ThreadPtr flush_thread_ GUARDED_BY(flush_event_lock_);
   Thread::CondVar flush_event_;
-  std::atomic<bool> flush_thread_exit_{};
+  bool flush_requested_ GUARDED_BY(flush_event_lock_){};
+  bool flush_thread_exit_ GUARDED_BY(flush_event_lock_){};
+  std::atomic<bool> flush_thread_created_{};
   std::atomic<bool> reopen_file_{};
-  Buffer::OwnedImpl
-      flush_buffer_ GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It gets
-                                             // filled and then flushed either when max size is
-                                             // reached or when a timer fires.
+  std::array<WriteShard, NUM_WRITE_SHARDS>
+      write_shards_; // These buffers are filled by the worker threads, and flushed either when
+                     // MIN_FLUSH_SIZE is reached or when a timer fires.
+  std::atomic<uint64_t> shard_buffered_bytes_{}; // Bytes buffered in all of the write shards.
+  const uint64_t max_buffered_bytes_; // Writes are dropped once the write shards buffer this
+                                      // many bytes. Zero means no limit.
   // TODO(jmarantz): this should be GUARDED_BY(flush_lock_) but the analysis cannot poke through
   // the std::make_unique assignment. I do not believe it's possible to annotate this properly now
   // due to limitations in the clang thread annotation analysis.
   Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only by the flush thread. Data
-                                            // is moved from flush_buffer_ under lock, and then
-                                            // the lock is released so that flush_buffer_ can
+                                            // is moved from the write shards under their locks,
+                                            // which are released so that the shards can
                                             // continue to fill. This buffer is then used for the
                                             // final write to disk.
   Event::TimerPtr flush_timer_;
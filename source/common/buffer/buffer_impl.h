@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <climits>
+#include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <string>
@@ -10,7 +12,6 @@
 
 #include "common/common/assert.h"
 #include "common/common/non_copyable.h"
-#include "common/event/libevent.h"
 
 namespace Envoy {
 namespace Buffer {
@@ -203,6 +204,50 @@ protected:
 
 using SlicePtr = std::unique_ptr<Slice>;
 
+/**
+ * Per-thread free lists of the memory blocks backing OwnedSlices. Blocks of up to
+ * MaxPooledPages pages are kept on a free list for their size when freed and handed out again by
+ * the next allocation of the same size on the same thread, so that steady state proxying does
+ * not go to malloc for buffer slices. Larger blocks always come from the heap.
+ */
+class SlicePool {
+public:
+  static constexpr uint64_t PageSize = 4096;
+  static constexpr uint64_t MaxPooledPages = 4;
+  // Upper bound on the number of free blocks of each size kept by each thread.
+  static constexpr uint64_t MaxFreeBlocksPerSize = 32;
+
+  /**
+   * @param size supplies the block size in bytes. Must be a multiple of PageSize.
+   * @return a block of at least the requested size.
+   */
+  static void* allocate(uint64_t size);
+
+  /**
+   * @param block supplies a block returned by allocate(), possibly on another thread.
+   * @param size supplies the size passed to allocate().
+   */
+  static void deallocate(void* block, uint64_t size);
+
+  /**
+   * @return the number of allocations, across all threads, served from a free list. Each thread
+   *         publishes its count periodically, so this may lag behind slightly.
+   */
+  static uint64_t hits();
+
+  /**
+   * @return the number of allocations, across all threads, of a poolable size that had to go to
+   *         the heap. Each thread publishes its count periodically, so this may lag behind
+   *         slightly.
+   */
+  static uint64_t misses();
+
+  /**
+   * Publish the calling thread's hit and miss counts. Exposed for testing.
+   */
+  static void flushStatsForTest();
+};
+
 class OwnedSlice : public Slice {
 public:
   /**
@@ -233,11 +278,24 @@ public:
   // Custom delete operator to keep C++14 from using the global operator delete(void*, size_t),
   // which would result in the compiler error:
   // "exception cleanup for this placement new selects non-placement operator delete"
-  static void operator delete(void* address) { ::operator delete(address); }
+  // The block size is read from the header in front of the object, which is not part of the
+  // (already destroyed) object.
+  static void operator delete(void* address) {
+    BlockHeader* header = static_cast<BlockHeader*>(address) - 1;
+    SlicePool::deallocate(header, header->size_);
+  }
 
 private:
+  // Precedes every OwnedSlice in its block so that operator delete knows the block size.
+  struct alignas(alignof(std::max_align_t)) BlockHeader {
+    uint64_t size_;
+  };
+
   static void* operator new(size_t object_size, size_t data_size) {
-    return ::operator new(object_size + data_size);
+    const uint64_t block_size = sizeof(BlockHeader) + object_size + data_size;
+    BlockHeader* header = static_cast<BlockHeader*>(SlicePool::allocate(block_size));
+    header->size_ = block_size;
+    return header + 1;
   }
 
   OwnedSlice(uint64_t size) : Slice(0, 0, size) { base_ = storage_; }
@@ -245,12 +303,14 @@ private:
   /**
    * Compute a slice size big enough to hold a specified amount of data.
    * @param data_size the minimum amount of data the slice must be able to store, in bytes.
-   * @return a recommended slice size, in bytes.
+   * @return a recommended slice size, in bytes, such that the whole block is a multiple of the
+   *         page size.
    */
   static uint64_t sliceSize(uint64_t data_size) {
-    static constexpr uint64_t PageSize = 4096;
-    const uint64_t num_pages = (sizeof(OwnedSlice) + data_size + PageSize - 1) / PageSize;
-    return num_pages * PageSize - sizeof(OwnedSlice);
+    static constexpr uint64_t PageSize = SlicePool::PageSize;
+    static constexpr uint64_t Overhead = sizeof(BlockHeader) + sizeof(OwnedSlice);
+    const uint64_t num_pages = (Overhead + data_size + PageSize - 1) / PageSize;
+    return num_pages * PageSize - Overhead;
   }
 
   uint8_t storage_[];
@@ -460,9 +520,8 @@ private:
 
 class LibEventInstance : public Instance {
 public:
-  // Allows access into the underlying buffer for move() optimizations.
-  virtual Event::Libevent::BufferPtr& buffer() PURE;
-  // Called after accessing the memory in buffer() directly to allow any post-processing.
+  // Called after the contents of the buffer have been moved out directly to allow any
+  // post-processing.
   virtual void postProcess() PURE;
 };
 
@@ -524,8 +583,10 @@ public:
   Api::IoCallUint64Result write(Network::IoHandle& io_handle) override;
   std::string toString() const override;
 
+  // The most slices write() passes to a single writev().
+  static constexpr uint64_t MaxWriteSlices = IOV_MAX;
+
   // LibEventInstance
-  Event::Libevent::BufferPtr& buffer() override { return buffer_; }
   virtual void postProcess() override;
 
   /**
@@ -541,45 +602,18 @@ public:
    */
   void appendSliceForTest(absl::string_view data);
 
-  // Support for choosing the buffer implementation at runtime.
-  // TODO(brian-pane) remove this once the new implementation has been
-  // running in production for a while.
-
-  /** @return whether this buffer uses the old evbuffer-based implementation. */
-  bool usesOldImpl() const { return old_impl_; }
-
-  /**
-   * @param use_old_impl whether to use the evbuffer-based implementation for new buffers
-   * @warning Except for testing code, this method should be called at most once per process,
-   *          before any OwnedImpl objects are created. The reason is that it is unsafe to
-   *          mix and match buffers with different implementations. The move() method,
-   *          in particular, only works if the source and destination objects are using
-   *          the same destination.
-   */
-  static void useOldImpl(bool use_old_impl);
-
 private:
   /**
    * @param rhs another buffer
-   * @return whether the rhs buffer is also an instance of OwnedImpl (or a subclass) that
-   *         uses the same internal implementation as this buffer.
+   * @return whether the rhs buffer is also an instance of OwnedImpl (or a subclass).
    */
   bool isSameBufferImpl(const Instance& rhs) const;
 
-  /** Whether to use the old evbuffer implementation when constructing new OwnedImpl objects. */
-  static bool use_old_impl_;
-
-  /** Whether this buffer uses the old evbuffer implementation. */
-  bool old_impl_;
-
   /** Ring buffer of slices. */
   SliceDeque slices_;
 
   /** Sum of the dataSize of all slices. */
   OverflowDetectingUInt64 length_;
-
-  /** Used when old_impl_==true */
-  Event::Libevent::BufferPtr buffer_;
 };
 
 } // namespace Buffer
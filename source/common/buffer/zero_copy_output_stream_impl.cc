@@ -0,0 +1,49 @@
+#include "common/buffer/zero_copy_output_stream_impl.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Buffer {
+
+constexpr uint64_t ZeroCopyOutputStreamImpl::DefaultBlockSize;
+
+ZeroCopyOutputStreamImpl::ZeroCopyOutputStreamImpl(Buffer::Instance& buffer, uint64_t block_size)
+    : buffer_(buffer),
+      block_size_(std::min<uint64_t>(block_size, std::numeric_limits<int>::max())) {
+  ASSERT(block_size_ > 0);
+}
+
+ZeroCopyOutputStreamImpl::~ZeroCopyOutputStreamImpl() { finish(); }
+
+void ZeroCopyOutputStreamImpl::finish() {
+  if (reserved_) {
+    buffer_.commit(&reservation_, 1);
+    reserved_ = false;
+  }
+}
+
+bool ZeroCopyOutputStreamImpl::Next(void** data, int* size) {
+  finish();
+
+  const uint64_t num_slices = buffer_.reserve(block_size_, &reservation_, 1);
+  ASSERT(num_slices == 1);
+  ASSERT(reservation_.len_ > 0 && reservation_.len_ <= block_size_);
+  reserved_ = true;
+  byte_count_ += reservation_.len_;
+  *data = reservation_.mem_;
+  *size = static_cast<int>(reservation_.len_);
+  return true;
+}
+
+void ZeroCopyOutputStreamImpl::BackUp(int count) {
+  ASSERT(reserved_);
+  ASSERT(count >= 0 && static_cast<uint64_t>(count) <= reservation_.len_);
+  reservation_.len_ -= count;
+  byte_count_ -= count;
+}
+
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include "envoy/buffer/buffer.h"
+
+#include "common/common/non_copyable.h"
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * Output stream that lets protobuf serialize directly into space reserved at the end of a buffer,
+ * one slice at a time, so that a serialized message never needs a contiguous allocation of its
+ * full size or a copy into the buffer. The bytes written are committed to the buffer when the
+ * next slice is requested, and on finish() or destruction.
+ */
+class ZeroCopyOutputStreamImpl : public Protobuf::io::ZeroCopyOutputStream, NonCopyable {
+public:
+  static constexpr uint64_t DefaultBlockSize = 16384;
+
+  /**
+   * @param buffer supplies the buffer to append to. It must not be mutated by anything else while
+   *        the stream has not finished.
+   * @param block_size supplies the size of the space reserved by each call of Next().
+   */
+  explicit ZeroCopyOutputStreamImpl(Buffer::Instance& buffer,
+                                    uint64_t block_size = DefaultBlockSize);
+  ~ZeroCopyOutputStreamImpl();
+
+  /**
+   * Commit the bytes written so far. The stream must not be written to afterwards.
+   */
+  void finish();
+
+  // Protobuf::io::ZeroCopyOutputStream
+  // See
+  // https://developers.google.com/protocol-buffers/docs/reference/cpp/google.protobuf.io.zero_copy_stream#ZeroCopyOutputStream
+  // for each method details.
+  bool Next(void** data, int* size) override;
+  void BackUp(int count) override;
+  ProtobufTypes::Int64 ByteCount() const override { return byte_count_; }
+
+private:
+  Buffer::Instance& buffer_;
+  const uint64_t block_size_;
+  // The space handed out by the last call of Next() that has not been committed yet.
+  Buffer::RawSlice reservation_{};
+  bool reserved_{};
+  uint64_t byte_count_{};
+};
+
+} // namespace Buffer
+} // namespace Envoy
@@ -1,8 +1,15 @@
 #include "common/common/base64.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+#include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/stack_array.h"
 
@@ -47,6 +54,79 @@ constexpr unsigned char URL_REVERSE_LOOKUP_TABLE[256] = {
     64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64};
 // clang-format on
 
+#ifdef __SSSE3__
+// The higher nibbles of the characters of the standard alphabet, as bits, by their lower nibble.
+alignas(16) constexpr uint8_t ALLOWED_HIGHER_NIBBLES[16] = {
+    0b10101000, 0b11111000, 0b11111000, 0b11111000, 0b11111000, 0b11111000, 0b11111000, 0b11111000,
+    0b11111000, 0b11111000, 0b11110000, 0b01010100, 0b01010000, 0b01010000, 0b01010000, 0b01010100};
+// The bit of each higher nibble in the table above. Bytes of 0x80 and more have none.
+alignas(16) constexpr uint8_t HIGHER_NIBBLE_BITS[16] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20,
+                                                        0x40, 0x80, 0,    0,    0,    0,
+                                                        0,    0,    0,    0};
+
+// Encodes the first 12 of 16 bytes into 16 characters of the standard alphabet, following
+// http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html.
+void encode12(const uint8_t* input, char* output) {
+  __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+  // Each 32 bit lane gets the bytes b1, b0, b2, b1 of a group of 3 bytes b0, b1, b2, from which
+  // the multiplications shift the four 6 bit indices of the group into bytes of their own.
+  in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(t1, t3);
+
+  // The offset from each index to its character depends on its range: A-Z, a-z, 0-9, + or /.
+  __m128i ranges = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  ranges = _mm_or_si128(ranges, _mm_and_si128(upper, _mm_set1_epi8(13)));
+  const __m128i offsets =
+      _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  const __m128i chars = _mm_add_epi8(_mm_shuffle_epi8(offsets, ranges), indices);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(output), chars);
+}
+
+// Decodes 16 characters of the standard alphabet into the first 12 of 16 bytes, following
+// http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html. Returns false, without writing the
+// output, if a character isn't in the alphabet.
+bool decode16(const char* input, uint8_t* output) {
+  const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+  const __m128i higher_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+  const __m128i lower_nibbles = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+
+  // A character is in the alphabet if its higher nibble is one of those its lower nibble allows.
+  const __m128i allowed = _mm_shuffle_epi8(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(ALLOWED_HIGHER_NIBBLES)), lower_nibbles);
+  const __m128i higher_nibble_bits = _mm_shuffle_epi8(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(HIGHER_NIBBLE_BITS)), higher_nibbles);
+  const __m128i invalid =
+      _mm_cmpeq_epi8(_mm_and_si128(allowed, higher_nibble_bits), _mm_setzero_si128());
+  if (_mm_movemask_epi8(invalid) != 0) {
+    return false;
+  }
+
+  // The offset from each character to its index depends on its higher nibble, but for '/' which
+  // shares it with '+'.
+  const __m128i offsets = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+  const __m128i offset =
+      _mm_or_si128(_mm_andnot_si128(slash, _mm_shuffle_epi8(offsets, higher_nibbles)),
+                   _mm_and_si128(slash, _mm_set1_epi8(16)));
+  const __m128i indices = _mm_add_epi8(in, offset);
+
+  // Packs the four 6 bit indices of each 32 bit lane into 3 bytes, which are then moved to the
+  // first 12 bytes in order.
+  const __m128i pairs = _mm_maddubs_epi16(indices, _mm_set1_epi32(0x01400140));
+  const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+  const __m128i bytes = _mm_shuffle_epi8(
+      groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(output), bytes);
+  return true;
+}
+#endif
+
 inline bool decodeBase(const uint8_t cur_char, uint64_t pos, std::string& ret,
                        const unsigned char* const reverse_lookup_table) {
   const unsigned char c = reverse_lookup_table[static_cast<uint32_t>(cur_char)];
@@ -98,127 +178,295 @@ inline bool decodeLast(const uint8_t cur_char, uint64_t pos, std::string& ret,
   return true;
 }
 
-inline void encodeBase(const uint8_t cur_char, uint64_t pos, uint8_t& next_c, std::string& ret,
-                       const char* const char_table) {
-  switch (pos % 3) {
-  case 0:
-    ret.push_back(char_table[cur_char >> 2]);
-    next_c = (cur_char & 0x03) << 4;
-    break;
-  case 1:
-    ret.push_back(char_table[next_c | (cur_char >> 4)]);
-    next_c = (cur_char & 0x0f) << 2;
-    break;
-  case 2:
-    ret.push_back(char_table[next_c | (cur_char >> 6)]);
-    ret.push_back(char_table[cur_char & 0x3f]);
-    next_c = 0;
-    break;
+// Encodes the groups of 3 bytes of [input, input + length) into 4 characters each. Returns the
+// number of bytes encoded, i.e. length / 3 * 3.
+uint64_t encodeGroups(const uint8_t* input, uint64_t length, char* output,
+                      const char* const char_table) {
+  uint64_t i = 0;
+#ifdef __SSSE3__
+  if (char_table == CHAR_TABLE) {
+    // 12 bytes are encoded at a time, from 16 byte loads.
+    for (; length - i >= 16; i += 12, output += 16) {
+      encode12(input + i, output);
+    }
+  }
+#endif
+  for (; length - i >= 3; i += 3, output += 4) {
+    const uint32_t group = input[i] << 16 | input[i + 1] << 8 | input[i + 2];
+    output[0] = char_table[group >> 18];
+    output[1] = char_table[(group >> 12) & 0x3f];
+    output[2] = char_table[(group >> 6) & 0x3f];
+    output[3] = char_table[group & 0x3f];
   }
+  return i;
 }
 
-inline void encodeLast(uint64_t pos, uint8_t last_char, std::string& ret,
-                       const char* const char_table, bool add_padding) {
-  switch (pos % 3) {
+// Encodes the last 1 or 2 bytes of an input, that don't make a group of 3. Returns the number of
+// characters written.
+uint64_t encodeTail(const uint8_t* input, uint64_t length, char* output,
+                    const char* const char_table, bool add_padding) {
+  switch (length) {
   case 1:
-    ret.push_back(char_table[last_char]);
-    if (add_padding) {
-      ret.push_back('=');
-      ret.push_back('=');
+    output[0] = char_table[input[0] >> 2];
+    output[1] = char_table[(input[0] & 0x03) << 4];
+    if (!add_padding) {
+      return 2;
     }
-    break;
+    output[2] = '=';
+    output[3] = '=';
+    return 4;
   case 2:
-    ret.push_back(char_table[last_char]);
-    if (add_padding) {
-      ret.push_back('=');
+    output[0] = char_table[input[0] >> 2];
+    output[1] = char_table[(input[0] & 0x03) << 4 | input[1] >> 4];
+    output[2] = char_table[(input[1] & 0x0f) << 2];
+    if (!add_padding) {
+      return 3;
     }
-    break;
+    output[3] = '=';
+    return 4;
   default:
-    break;
+    return 0;
   }
 }
 
-} // namespace
+// Encodes the first length bytes of a buffer slice by slice, carrying the groups of 3 bytes that
+// span slices over. Returns the number of characters written.
+uint64_t encodeSlices(const Buffer::Instance& buffer, uint64_t length, char* output) {
+  const uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
+  buffer.getRawSlices(slices.begin(), num_slices);
 
-std::string Base64::decode(const std::string& input) {
-  if (input.length() % 4 || input.empty()) {
-    return EMPTY_STRING;
+  uint64_t output_length = 0;
+  uint8_t group[3];
+  uint64_t group_length = 0;
+  for (const Buffer::RawSlice& slice : slices) {
+    if (length == 0) {
+      break;
+    }
+    const uint8_t* input = static_cast<const uint8_t*>(slice.mem_);
+    uint64_t input_length = std::min<uint64_t>(slice.len_, length);
+    length -= input_length;
+
+    if (group_length > 0) {
+      const uint64_t copied = std::min(3 - group_length, input_length);
+      memcpy(group + group_length, input, copied);
+      group_length += copied;
+      input += copied;
+      input_length -= copied;
+      if (group_length < 3) {
+        continue;
+      }
+      output_length += encodeGroups(group, 3, output + output_length, CHAR_TABLE) / 3 * 4;
+      group_length = 0;
+    }
+
+    const uint64_t encoded = encodeGroups(input, input_length, output + output_length, CHAR_TABLE);
+    output_length += encoded / 3 * 4;
+    group_length = input_length - encoded;
+    memcpy(group, input + encoded, group_length);
   }
+  return output_length + encodeTail(group, group_length, output + output_length, CHAR_TABLE, true);
+}
 
-  // Last position before "valid" padding character.
-  uint64_t last = input.length() - 1;
-  size_t max_length = input.length() / 4 * 3;
-  // At most last two chars can be '='.
-  if (input[input.length() - 1] == '=') {
-    max_length--;
-    last = input.length() - 2;
-    if (input[input.length() - 2] == '=') {
-      max_length--;
-      last = input.length() - 3;
+// Decodes the quads of [input, input + length), length being a multiple of 4, into 3 bytes each,
+// up to the first quad with a character that isn't in the alphabet, e.g. padding. Returns the
+// number of characters decoded.
+uint64_t decodeQuads(const char* input, uint64_t length, uint8_t* output) {
+  uint64_t i = 0;
+#ifdef __SSSE3__
+  // 16 characters are decoded at a time, into 16 byte stores of which 12 bytes are kept. The
+  // characters left after them always decode to the 4 bytes more that the stores overwrite.
+  for (; length - i >= 24; i += 16, output += 12) {
+    if (!decode16(input + i, output)) {
+      break;
     }
   }
+#endif
+  for (; length - i >= 4; i += 4, output += 3) {
+    const uint32_t a = REVERSE_LOOKUP_TABLE[static_cast<uint8_t>(input[i])];
+    const uint32_t b = REVERSE_LOOKUP_TABLE[static_cast<uint8_t>(input[i + 1])];
+    const uint32_t c = REVERSE_LOOKUP_TABLE[static_cast<uint8_t>(input[i + 2])];
+    const uint32_t d = REVERSE_LOOKUP_TABLE[static_cast<uint8_t>(input[i + 3])];
+    if ((a | b | c | d) & 64) {
+      break;
+    }
+    const uint32_t group = a << 18 | b << 12 | c << 6 | d;
+    output[0] = group >> 16;
+    output[1] = group >> 8;
+    output[2] = group;
+  }
+  return i;
+}
 
-  std::string ret;
-  ret.reserve(max_length);
-  for (uint64_t i = 0; i < last; ++i) {
-    if (!decodeBase(input[i], i, ret, REVERSE_LOOKUP_TABLE)) {
-      return EMPTY_STRING;
+// Decodes a quad, which may be padded. Returns the number of bytes decoded, 0 if the quad is
+// invalid.
+uint64_t decodeQuad(const char* input, uint8_t* output) {
+  const uint32_t a = REVERSE_LOOKUP_TABLE[static_cast<uint8_t>(input[0])];
+  const uint32_t b = REVERSE_LOOKUP_TABLE[static_cast<uint8_t>(input[1])];
+  if ((a | b) & 64) {
+    return 0;
+  }
+  if (input[3] == '=') {
+    if (input[2] == '=') {
+      // The unused bits at the tail must be 0.
+      if (b & 0x0f) {
+        return 0;
+      }
+      output[0] = a << 2 | b >> 4;
+      return 1;
+    }
+    const uint32_t c = REVERSE_LOOKUP_TABLE[static_cast<uint8_t>(input[2])];
+    if ((c & 64) || (c & 0x03)) {
+      return 0;
     }
+    output[0] = a << 2 | b >> 4;
+    output[1] = b << 4 | c >> 2;
+    return 2;
   }
+  const uint32_t c = REVERSE_LOOKUP_TABLE[static_cast<uint8_t>(input[2])];
+  const uint32_t d = REVERSE_LOOKUP_TABLE[static_cast<uint8_t>(input[3])];
+  if ((c | d) & 64) {
+    return 0;
+  }
+  output[0] = a << 2 | b >> 4;
+  output[1] = b << 4 | c >> 2;
+  output[2] = c << 6 | d;
+  return 3;
+}
 
-  if (!decodeLast(input[last], last, ret, REVERSE_LOOKUP_TABLE)) {
+// Decodes the quads of [input, input + length), length being a multiple of 4, any of which may be
+// padded. Returns false if a quad is invalid.
+bool decodePaddedQuads(const char* input, uint64_t length, uint8_t* output,
+                       uint64_t& output_length) {
+  uint64_t i = 0;
+  while (true) {
+    const uint64_t decoded = decodeQuads(input + i, length - i, output + output_length);
+    i += decoded;
+    output_length += decoded / 4 * 3;
+    if (i == length) {
+      return true;
+    }
+    const uint64_t decoded_bytes = decodeQuad(input + i, output + output_length);
+    if (decoded_bytes == 0) {
+      return false;
+    }
+    i += 4;
+    output_length += decoded_bytes;
+  }
+}
+
+} // namespace
+
+std::string Base64::decode(const std::string& input) {
+  if (input.length() % 4 || input.empty()) {
     return EMPTY_STRING;
   }
 
+  // Only the last quad may be padded.
+  const uint64_t last = input.length() - 4;
+  std::string ret(input.length() / 4 * 3, '\0');
+  uint8_t* output = reinterpret_cast<uint8_t*>(&ret[0]);
+  if (decodeQuads(input.data(), last, output) != last) {
+    return EMPTY_STRING;
+  }
+  const uint64_t decoded_bytes = decodeQuad(input.data() + last, output + last / 4 * 3);
+  if (decoded_bytes == 0) {
+    return EMPTY_STRING;
+  }
+  ret.resize(last / 4 * 3 + decoded_bytes);
   return ret;
 }
 
-std::string Base64::encode(const Buffer::Instance& buffer, uint64_t length) {
-  uint64_t output_length = (std::min(length, buffer.length()) + 2) / 3 * 4;
-  std::string ret;
-  ret.reserve(output_length);
+bool Base64::decode(Buffer::Instance& input, Buffer::Instance& output) {
+  const uint64_t length = input.length() / 4 * 4;
+  if (length == 0) {
+    return true;
+  }
 
-  uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+  const uint64_t num_slices = input.getRawSlices(nullptr, 0);
   STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
-  buffer.getRawSlices(slices.begin(), num_slices);
-
-  uint64_t j = 0;
-  uint8_t next_c = 0;
+  input.getRawSlices(slices.begin(), num_slices);
+
+  Buffer::RawSlice output_slice;
+  output.reserve(length / 4 * 3, &output_slice, 1);
+  uint8_t* output_mem = static_cast<uint8_t*>(output_slice.mem_);
+  uint64_t output_length = 0;
+  uint64_t remaining = length;
+  char quad[4];
+  uint64_t quad_length = 0;
   for (const Buffer::RawSlice& slice : slices) {
-    const uint8_t* slice_mem = static_cast<const uint8_t*>(slice.mem_);
-
-    for (uint64_t i = 0; i < slice.len_ && j < length; ++i, ++j) {
-      encodeBase(slice_mem[i], j, next_c, ret, CHAR_TABLE);
+    if (remaining == 0) {
+      break;
+    }
+    const char* slice_mem = static_cast<const char*>(slice.mem_);
+    uint64_t slice_length = std::min<uint64_t>(slice.len_, remaining);
+    remaining -= slice_length;
+
+    // Completes the quad carried over from the previous slices.
+    if (quad_length > 0) {
+      const uint64_t copied = std::min(4 - quad_length, slice_length);
+      memcpy(quad + quad_length, slice_mem, copied);
+      quad_length += copied;
+      slice_mem += copied;
+      slice_length -= copied;
+      if (quad_length < 4) {
+        continue;
+      }
+      const uint64_t decoded_bytes = decodeQuad(quad, output_mem + output_length);
+      if (decoded_bytes == 0) {
+        return false;
+      }
+      output_length += decoded_bytes;
+      quad_length = 0;
     }
 
-    if (j == length) {
-      break;
+    const uint64_t quads_length = slice_length / 4 * 4;
+    if (!decodePaddedQuads(slice_mem, quads_length, output_mem, output_length)) {
+      return false;
     }
+    quad_length = slice_length - quads_length;
+    memcpy(quad, slice_mem + quads_length, quad_length);
   }
+  ASSERT(quad_length == 0);
 
-  encodeLast(j, next_c, ret, CHAR_TABLE, true);
+  if (output_length > 0) {
+    output_slice.len_ = output_length;
+    output.commit(&output_slice, 1);
+  }
+  input.drain(length);
+  return true;
+}
 
+std::string Base64::encode(const Buffer::Instance& buffer, uint64_t length) {
+  length = std::min(length, buffer.length());
+  std::string ret((length + 2) / 3 * 4, '\0');
+  ret.resize(encodeSlices(buffer, length, &ret[0]));
   return ret;
 }
 
+void Base64::encode(Buffer::Instance& input, Buffer::Instance& output) {
+  const uint64_t length = input.length();
+  if (length == 0) {
+    return;
+  }
+  Buffer::RawSlice output_slice;
+  output.reserve((length + 2) / 3 * 4, &output_slice, 1);
+  output_slice.len_ = encodeSlices(input, length, static_cast<char*>(output_slice.mem_));
+  output.commit(&output_slice, 1);
+  input.drain(length);
+}
+
 std::string Base64::encode(const char* input, uint64_t length) {
   return encode(input, length, true);
 }
 
 std::string Base64::encode(const char* input, uint64_t length, bool add_padding) {
-  uint64_t output_length = (length + 2) / 3 * 4;
-  std::string ret;
-  ret.reserve(output_length);
-
-  uint64_t pos = 0;
-  uint8_t next_c = 0;
-
-  for (uint64_t i = 0; i < length; ++i) {
-    encodeBase(input[i], pos++, next_c, ret, CHAR_TABLE);
-  }
-
-  encodeLast(pos, next_c, ret, CHAR_TABLE, add_padding);
-
+  std::string ret((length + 2) / 3 * 4, '\0');
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(input);
+  const uint64_t encoded = encodeGroups(bytes, length, &ret[0], CHAR_TABLE);
+  const uint64_t output_length = encoded / 3 * 4;
+  ret.resize(output_length + encodeTail(bytes + encoded, length - encoded, &ret[output_length],
+                                        CHAR_TABLE, add_padding));
   return ret;
 }
 
@@ -245,19 +493,12 @@ std::string Base64Url::decode(const std::string& input) {
 }
 
 std::string Base64Url::encode(const char* input, uint64_t length) {
-  uint64_t output_length = (length + 2) / 3 * 4;
-  std::string ret;
-  ret.reserve(output_length);
-
-  uint64_t pos = 0;
-  uint8_t next_c = 0;
-
-  for (uint64_t i = 0; i < length; ++i) {
-    encodeBase(input[i], pos++, next_c, ret, URL_CHAR_TABLE);
-  }
-
-  encodeLast(pos, next_c, ret, URL_CHAR_TABLE, false);
-
+  std::string ret((length + 2) / 3 * 4, '\0');
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(input);
+  const uint64_t encoded = encodeGroups(bytes, length, &ret[0], URL_CHAR_TABLE);
+  const uint64_t output_length = encoded / 3 * 4;
+  ret.resize(output_length + encodeTail(bytes + encoded, length - encoded, &ret[output_length],
+                                        URL_CHAR_TABLE, false));
   return ret;
 }
 
@@ -10,6 +10,8 @@ namespace Envoy {
 /**
  * A utility class to support base64 encoding, which is defined in RFC4648 Section 4.
  * See https://tools.ietf.org/html/rfc4648#section-4
+ *
+ * When built with SSSE3, 16 characters are encoded or decoded at a time.
  */
 class Base64 {
 public:
@@ -20,6 +22,14 @@ public:
    */
   static std::string encode(const Buffer::Instance& buffer, uint64_t length);
 
+  /**
+   * Base64 encode a buffer into another one, slice by slice, without linearizing the input or
+   * copying the encoded data. The encoded data is padded.
+   * @param input supplies the buffer to encode, which is drained.
+   * @param output supplies the buffer the encoded data is appended to.
+   */
+  static void encode(Buffer::Instance& input, Buffer::Instance& output);
+
   /**
    * Base64 encode an input char buffer with a given length.
    * @param input char array to encode.
@@ -43,6 +53,18 @@ public:
    * bytes.
    */
   static std::string decode(const std::string& input);
+
+  /**
+   * Base64 decode the complete quads of a buffer into another one, slice by slice, without
+   * linearizing the input or copying the decoded data. Any quad may be padded, as when base64
+   * strings are concatenated, e.g. the frames of a gRPC-Web text body.
+   * @param input supplies the buffer to decode. Its complete quads are drained, and the 0 to 3
+   *        characters of a trailing partial quad are left in it.
+   * @param output supplies the buffer the decoded data is appended to.
+   * @return bool false if the input isn't valid base64, in which case both buffers are left
+   *         unchanged.
+   */
+  static bool decode(Buffer::Instance& input, Buffer::Instance& output);
 };
 
 /**
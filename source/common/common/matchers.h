@@ -8,6 +8,7 @@
 #include "envoy/type/matcher/string.pb.h"
 #include "envoy/type/matcher/value.pb.h"
 
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/protobuf/protobuf.h"
 
@@ -74,7 +75,9 @@ class StringMatcher : public ValueMatcher {
 public:
   StringMatcher(const envoy::type::matcher::StringMatcher& matcher) : matcher_(matcher) {
     if (matcher.match_pattern_case() == envoy::type::matcher::StringMatcher::kRegex) {
-      regex_ = RegexUtil::parseRegex(matcher_.regex());
+      regex_ = Regex::Utility::parseStdRegexAsCompiledMatcher(matcher_.regex());
+    } else if (matcher.match_pattern_case() == envoy::type::matcher::StringMatcher::kSafeRegex) {
+      regex_ = Regex::Utility::parseRegex(matcher_.safe_regex());
     }
   }
 
@@ -84,7 +87,8 @@ public:
 
 private:
   const envoy::type::matcher::StringMatcher matcher_;
-  std::regex regex_;
+  // Shared so that matchers remain copyable. The compiled regex is immutable.
+  Regex::CompiledMatcherSharedPtr regex_;
 };
 
 class LowerCaseStringMatcher : public ValueMatcher {
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * Intrusive, lock-free, unbounded queue with any number of producers and a single consumer, after
+ * Dmitry Vyukov's non-intrusive MPSC node-based queue. push() is wait-free and costs a single
+ * atomic exchange. pop() never blocks, but may report an empty queue while a push() that started
+ * before it has not completed, so consumers must be told of such pushes some other way, e.g. by a
+ * count that producers increment before pushing.
+ *
+ * The queue doesn't own its nodes: a node belongs to the queue from the push() that links it to
+ * the pop() that returns it.
+ */
+class MpscQueue : NonCopyable {
+public:
+  class Node {
+  public:
+    virtual ~Node() {}
+
+  private:
+    friend class MpscQueue;
+
+    std::atomic<Node*> next_{nullptr};
+  };
+
+  MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+  /**
+   * Append a node to the queue. May be called from any thread.
+   * @param node supplies the node, which must not be in a queue.
+   */
+  void push(Node& node) {
+    node.next_.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head_.exchange(&node, std::memory_order_acq_rel);
+    // Between the exchange and this store, the node is in the queue but not reachable from tail_.
+    prev->next_.store(&node, std::memory_order_release);
+  }
+
+  /**
+   * Remove the node at the front of the queue. Must only be called from the consumer's thread.
+   * @return Node* the node at the front of the queue, or nullptr if the queue is empty or its
+   *         front node is still being pushed.
+   */
+  Node* pop() {
+    Node* tail = tail_;
+    Node* next = tail->next_.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next_.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      tail_ = next;
+      return tail;
+    }
+
+    // tail is the last linked node. Unless another push() has already swapped head_, put the stub
+    // behind it, so that tail can be handed out without leaving the queue without a node.
+    if (tail != head_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    push(stub_);
+    next = tail->next_.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      tail_ = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+private:
+  Node stub_;
+  // The last pushed node, swapped by producers.
+  std::atomic<Node*> head_;
+  // The front node, only touched by the consumer.
+  Node* tail_;
+};
+
+} // namespace Envoy
@@ -0,0 +1,133 @@
+#include "common/common/object_pool.h"
+
+#include <array>
+#include <atomic>
+#include <new>
+#include <vector>
+
+namespace Envoy {
+namespace {
+
+// Hit and miss counts published by all threads.
+std::atomic<uint64_t> object_pool_hits{0};
+std::atomic<uint64_t> object_pool_misses{0};
+
+// Set once the calling thread's pool has been destroyed during thread exit. Blocks freed after
+// that point go straight back to the heap.
+thread_local bool thread_object_pool_destroyed = false;
+
+// Blocks of a poolable size are allocated with the size of their size class, wherever they are
+// allocated, since they may be freed into the free list of any thread.
+uint64_t blockSize(uint64_t size) {
+  if (size > ObjectPool::MaxPooledSize) {
+    return size;
+  }
+  return (size + ObjectPool::SizeClass - 1) / ObjectPool::SizeClass * ObjectPool::SizeClass;
+}
+
+class ThreadObjectPool {
+public:
+  ~ThreadObjectPool() {
+    flushStats();
+    for (auto& free_list : free_lists_) {
+      for (void* block : free_list) {
+        ::operator delete(block);
+      }
+    }
+    thread_object_pool_destroyed = true;
+  }
+
+  void* allocate(uint64_t size) {
+    std::vector<void*>* free_list = freeList(size);
+    if (free_list == nullptr) {
+      return ::operator new(size);
+    }
+    void* block;
+    if (!free_list->empty()) {
+      block = free_list->back();
+      free_list->pop_back();
+      hits_++;
+    } else {
+      block = ::operator new(blockSize(size));
+      misses_++;
+    }
+    if (hits_ + misses_ >= FlushInterval) {
+      flushStats();
+    }
+    return block;
+  }
+
+  void deallocate(void* block, uint64_t size) {
+    std::vector<void*>* free_list = freeList(size);
+    if (free_list == nullptr || free_list->size() >= ObjectPool::MaxFreeBlocksPerSize) {
+      ::operator delete(block);
+      return;
+    }
+    free_list->push_back(block);
+  }
+
+  void flushStats() {
+    object_pool_hits += hits_;
+    object_pool_misses += misses_;
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+private:
+  // Publishing to the shared counters on every allocation would make them a point of contention
+  // between workers, so each thread batches this many allocations.
+  static constexpr uint64_t FlushInterval = 64;
+  static constexpr uint64_t NumSizeClasses = ObjectPool::MaxPooledSize / ObjectPool::SizeClass;
+
+  std::vector<void*>* freeList(uint64_t size) {
+    if (size == 0 || size > ObjectPool::MaxPooledSize) {
+      return nullptr;
+    }
+    return &free_lists_[blockSize(size) / ObjectPool::SizeClass - 1];
+  }
+
+  std::array<std::vector<void*>, NumSizeClasses> free_lists_;
+  uint64_t hits_{};
+  uint64_t misses_{};
+};
+
+ThreadObjectPool* threadObjectPool() {
+  if (thread_object_pool_destroyed) {
+    return nullptr;
+  }
+  static thread_local ThreadObjectPool pool;
+  return &pool;
+}
+
+} // namespace
+
+constexpr uint64_t ObjectPool::SizeClass;
+constexpr uint64_t ObjectPool::MaxPooledSize;
+constexpr uint64_t ObjectPool::MaxFreeBlocksPerSize;
+
+void* ObjectPool::allocate(uint64_t size) {
+  ThreadObjectPool* pool = threadObjectPool();
+  return pool != nullptr ? pool->allocate(size) : ::operator new(blockSize(size));
+}
+
+void ObjectPool::deallocate(void* block, uint64_t size) {
+  ThreadObjectPool* pool = threadObjectPool();
+  if (pool != nullptr) {
+    pool->deallocate(block, size);
+  } else {
+    ::operator delete(block);
+  }
+}
+
+uint64_t ObjectPool::hits() { return object_pool_hits; }
+
+uint64_t ObjectPool::misses() { return object_pool_misses; }
+
+void ObjectPool::flushStatsForTest() {
+  ThreadObjectPool* pool = threadObjectPool();
+  if (pool != nullptr) {
+    pool->flushStats();
+  }
+}
+
+} // namespace Envoy
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Envoy {
+
+/**
+ * Per thread free lists for the objects that are allocated and destroyed for every request, e.g.
+ * HTTP streams, their filters and their upstream requests. A block freed by a thread is kept for
+ * the next allocation of the same size class on that thread, so that steady state proxying does
+ * not go to malloc for them. Since these objects are destroyed by deferred deletion on the thread
+ * that created them, the block is usually reused by the next request of the same worker. Larger
+ * blocks always come from the heap.
+ */
+class ObjectPool {
+public:
+  // Sizes are rounded up to a multiple of the size class.
+  static constexpr uint64_t SizeClass = 64;
+  static constexpr uint64_t MaxPooledSize = 4096;
+  // Upper bound on the number of free blocks of each size class kept by each thread.
+  static constexpr uint64_t MaxFreeBlocksPerSize = 64;
+
+  /**
+   * @param size supplies the block size in bytes.
+   * @return a block of at least the requested size.
+   */
+  static void* allocate(uint64_t size);
+
+  /**
+   * @param block supplies a block returned by allocate(), possibly on another thread.
+   * @param size supplies the size passed to allocate().
+   */
+  static void deallocate(void* block, uint64_t size);
+
+  /**
+   * @return the number of allocations, across all threads, served from a free list. Each thread
+   *         publishes its count periodically, so this may lag behind slightly.
+   */
+  static uint64_t hits();
+
+  /**
+   * @return the number of allocations, across all threads, of a poolable size that had to go to
+   *         the heap. Each thread publishes its count periodically, so this may lag behind
+   *         slightly.
+   */
+  static uint64_t misses();
+
+  /**
+   * Publish the calling thread's counts, so that hits() and misses() are exact for it.
+   */
+  static void flushStatsForTest();
+
+  /**
+   * Allocator for std::allocate_shared(), which allocates the object and its control block as a
+   * single block from the pool.
+   */
+  template <class T> class Allocator {
+  public:
+    typedef T value_type;
+
+    Allocator() {}
+    template <class U> Allocator(const Allocator<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(ObjectPool::allocate(n * sizeof(T))); }
+    void deallocate(T* block, size_t n) { ObjectPool::deallocate(block, n * sizeof(T)); }
+
+    template <class U> bool operator==(const Allocator<U>&) const { return true; }
+    template <class U> bool operator!=(const Allocator<U>&) const { return false; }
+  };
+};
+
+/**
+ * Base class that makes a class, and the classes derived from it, allocate their objects from the
+ * ObjectPool. Objects deleted through a pointer to a base class must have a virtual destructor, so
+ * that the size of their dynamic type is passed to operator delete.
+ */
+class PooledObject {
+public:
+  static void* operator new(size_t size) { return ObjectPool::allocate(size); }
+  static void operator delete(void* object, size_t size) { ObjectPool::deallocate(object, size); }
+};
+
+} // namespace Envoy
@@ -17,10 +17,19 @@
 
 namespace Envoy {
 
-PerfOperation::PerfOperation()
-    : context_(PerfAnnotationContext::getOrCreate()), start_time_(context_->currentTime()) {}
+std::atomic<bool> PerfAnnotationContext::enabled_{false};
+
+PerfOperation::PerfOperation(bool always) {
+  if (always || PerfAnnotationContext::enabled()) {
+    context_ = PerfAnnotationContext::getOrCreate();
+    start_time_ = context_->currentTime();
+  }
+}
 
 void PerfOperation::record(absl::string_view category, absl::string_view description) {
+  if (context_ == nullptr) {
+    return;
+  }
   const MonotonicTime end_time = context_->currentTime();
   const std::chrono::nanoseconds duration =
       std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time_);
@@ -49,8 +58,6 @@ void PerfAnnotationContext::record(std::chrono::nanoseconds duration, absl::stri
   }
 }
 
-// TODO(jmarantz): Consider hooking up perf information-dump into admin console, if
-// we find a performance problem we want to annotate with a live server.
 void PerfAnnotationContext::dump() { std::cout << toString() << std::endl; }
 
 std::string PerfAnnotationContext::toString() {
@@ -1,9 +1,9 @@
 #pragma once
 
-#ifdef ENVOY_PERF_ANNOTATION
-
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <string>
 #include <unordered_map>
 
 #include "common/common/thread.h"
@@ -11,13 +11,15 @@
 
 #include "absl/strings/string_view.h"
 
-// Performance Annotation system, enabled with
+// Performance Annotation system. By default, the macros for instrumenting code for performance
+// analysis only record while annotations are enabled at runtime, either via
+// PerfAnnotationContext::setEnabled() or via the /perf_annotation admin endpoint. While they are
+// disabled, an annotated operation costs a relaxed load and a branch, and the arguments of
+// PERF_RECORD are not evaluated. Enabling with
 //   bazel --define=perf_annotation=enabled ...
 // or, in individual .cc files:
 //   #define ENVOY_PERF_ANNOTATION
-// In the absence of such directives, the support classes are built and tested.
-// However, the macros for instrumenting code for performance analysis will expand
-// to nothing.
+// makes the macros record unconditionally.
 //
 // See also: https://github.com/LLNL/Caliper -- it may be worth integrating with
 // that for added functionality, particularly around loops.
@@ -26,11 +28,13 @@
 // https://labs.vmware.com/vmtj/methodology-for-performance-analysis-of-vmware-vsphere-under-tier-1-applications
 // https://dl.acm.org/citation.cfm?id=1899945&dl=ACM&coll=DL
 
+#ifdef ENVOY_PERF_ANNOTATION
+
 /**
  * Initiates a performance operation, storing its state in perf_var. A perf_var
  * can then be reported multiple times.
  */
-#define PERF_OPERATION(perf_var) Envoy::PerfOperation perf_var
+#define PERF_OPERATION(perf_var) Envoy::PerfOperation perf_var(true)
 
 /**
  * Records performance data initiated with PERF_OPERATION. The category and description
@@ -43,16 +47,40 @@
   } while (false)
 
 /**
- * Dumps recorded performance data to stdout. Expands to nothing if not enabled.
+ * Dumps recorded performance data to stdout.
  */
 #define PERF_DUMP() Envoy::PerfAnnotationContext::dump()
 
 /**
  * Returns the aggregated performance data as a formatted multi-line string, showing a
- * formatted table of values. Returns "" if perf-annotation is disabled.
+ * formatted table of values.
  */
 #define PERF_TO_STRING() Envoy::PerfAnnotationContext::toString()
 
+#else
+
+// Macros that only record while annotations are enabled at runtime. These are contrived to work
+// syntactically as a C++ statement (e.g. if (foo) PERF_RECORD(...) else PERF_RECORD(...)).
+
+#define PERF_OPERATION(perf_var) Envoy::PerfOperation perf_var
+#define PERF_RECORD(perf, category, description)                                                   \
+  do {                                                                                             \
+    if (perf.enabled()) {                                                                          \
+      perf.record(category, description);                                                          \
+    }                                                                                              \
+  } while (false)
+#define PERF_DUMP()                                                                                \
+  do {                                                                                             \
+    if (Envoy::PerfAnnotationContext::enabled()) {                                                 \
+      Envoy::PerfAnnotationContext::dump();                                                        \
+    }                                                                                              \
+  } while (false)
+#define PERF_TO_STRING()                                                                           \
+  (Envoy::PerfAnnotationContext::enabled() ? Envoy::PerfAnnotationContext::toString()              \
+                                           : std::string())
+
+#endif
+
 /**
  * Clears all performance data.
  */
@@ -69,9 +97,9 @@
 namespace Envoy {
 
 /**
- * Defines a context for collecting performance data. Note that this class is
- * fully declared and defined even if ENVOY_PERF_AUTOMATION is off. We depend on
- * the macros to disable performance collection for production.
+ * Defines a context for collecting performance data. Note that this class is declared and defined
+ * regardless of ENVOY_PERF_ANNOTATION, which only selects whether the macros record
+ * unconditionally or while enabled at runtime.
  */
 class PerfAnnotationContext {
 public:
@@ -111,6 +139,18 @@ public:
    */
   static void clear();
 
+  /**
+   * @return whether the macros record without ENVOY_PERF_ANNOTATION.
+   */
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * Enable or disable the recording of the macros without ENVOY_PERF_ANNOTATION. Operations that
+   * start while disabled are not recorded.
+   * @param enabled supplies whether to record.
+   */
+  static void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
 private:
   /**
    * PerfAnnotationContext construction should be done via getOrCreate().
@@ -134,6 +174,8 @@ private:
 
   using DurationStatsMap = std::unordered_map<CategoryDescription, DurationStats, Hash>;
 
+  static std::atomic<bool> enabled_;
+
   // Maps {category, description} to DurationStats.
 #if PERF_THREAD_SAFE
   DurationStatsMap duration_stats_map_ GUARDED_BY(mutex_);
@@ -155,40 +197,28 @@ private:
  */
 class PerfOperation {
 public:
-  PerfOperation();
+  /**
+   * @param always supplies whether to record even if annotations are not enabled at runtime.
+   */
+  explicit PerfOperation(bool always = false);
 
   /**
    * Report an event relative to the operation in progress. Note report can be called
    * multiple times on a single PerfOperation, with distinct category/description combinations.
+   * Does nothing if the operation is not recording.
    * @param category the name of a category for the recording.
    * @param description the name of description for the recording.
    */
   void record(absl::string_view category, absl::string_view description);
 
+  /**
+   * @return whether the operation is recording.
+   */
+  bool enabled() const { return context_ != nullptr; }
+
 private:
-  PerfAnnotationContext* context_;
+  PerfAnnotationContext* context_{};
   MonotonicTime start_time_;
 };
 
 } // namespace Envoy
-
-#else
-
-// Macros that expand to nothing when performance collection is disabled. These are contrived to
-// work syntactically as a C++ statement (e.g. if (foo) PERF_RECORD(...) else PERF_RECORD(...)).
-
-#define PERF_OPERATION(perf_var)                                                                   \
-  do {                                                                                             \
-  } while (false)
-#define PERF_RECORD(perf, category, description)                                                   \
-  do {                                                                                             \
-  } while (false)
-#define PERF_DUMP()                                                                                \
-  do {                                                                                             \
-  } while (false)
-#define PERF_TO_STRING() ""
-#define PERF_CLEAR()                                                                               \
-  do {                                                                                             \
-  } while (false)
-
-#endif
@@ -0,0 +1,111 @@
+#include "common/common/regex.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/utility.h"
+
+#include "re2/re2.h"
+#include "re2/set.h"
+
+namespace Envoy {
+namespace Regex {
+namespace {
+
+class CompiledStdMatcher : public CompiledMatcher {
+public:
+  CompiledStdMatcher(std::regex&& regex) : regex_(std::move(regex)) {}
+
+  // CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return std::regex_match(value.begin(), value.end(), regex_);
+  }
+
+private:
+  const std::regex regex_;
+};
+
+class CompiledGoogleReMatcher : public CompiledMatcher {
+public:
+  CompiledGoogleReMatcher(const envoy::type::matcher::RegexMatcher& config)
+      : regex_(config.regex(), re2::RE2::Quiet) {
+    if (!regex_.ok()) {
+      throw EnvoyException(regex_.error());
+    }
+
+    const uint32_t max_program_size = config.google_re2().has_max_program_size()
+                                          ? config.google_re2().max_program_size().value()
+                                          : Utility::DefaultMaxProgramSize;
+    if (static_cast<uint32_t>(regex_.ProgramSize()) > max_program_size) {
+      throw EnvoyException(fmt::format("regex '{}' RE2 program size of {} > max program size of "
+                                       "{}. Increase configured max program size if necessary.",
+                                       config.regex(), regex_.ProgramSize(), max_program_size));
+    }
+  }
+
+  // CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return re2::RE2::FullMatch(re2::StringPiece(value.data(), value.size()), regex_);
+  }
+
+private:
+  const re2::RE2 regex_;
+};
+
+class CompiledGoogleReSetMatcher : public CompiledMatcher {
+public:
+  CompiledGoogleReSetMatcher(
+      const Protobuf::RepeatedPtrField<envoy::type::matcher::RegexMatcher>& config)
+      : regex_set_(quietOptions(), re2::RE2::ANCHOR_BOTH) {
+    for (const auto& matcher : config) {
+      // Google Re2 is the only currently supported engine.
+      ASSERT(matcher.has_google_re2());
+      std::string error;
+      if (regex_set_.Add(matcher.regex(), &error) < 0) {
+        throw EnvoyException(error);
+      }
+    }
+    if (!regex_set_.Compile()) {
+      throw EnvoyException("regex set is too large to compile");
+    }
+  }
+
+  // CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return regex_set_.Match(re2::StringPiece(value.data(), value.size()), nullptr);
+  }
+
+private:
+  static re2::RE2::Options quietOptions() {
+    re2::RE2::Options options;
+    options.set_log_errors(false);
+    return options;
+  }
+
+  re2::RE2::Set regex_set_;
+};
+
+} // namespace
+
+constexpr uint32_t Utility::DefaultMaxProgramSize;
+
+CompiledMatcherPtr Utility::parseRegex(const envoy::type::matcher::RegexMatcher& matcher) {
+  // Google Re2 is the only currently supported engine.
+  ASSERT(matcher.has_google_re2());
+  return std::make_unique<const CompiledGoogleReMatcher>(matcher);
+}
+
+CompiledMatcherPtr Utility::parseRegexSet(
+    const Protobuf::RepeatedPtrField<envoy::type::matcher::RegexMatcher>& matchers) {
+  ASSERT(!matchers.empty());
+  return std::make_unique<const CompiledGoogleReSetMatcher>(matchers);
+}
+
+CompiledMatcherPtr Utility::parseStdRegexAsCompiledMatcher(const std::string& regex,
+                                                           std::regex::flag_type flags) {
+  return std::make_unique<const CompiledStdMatcher>(RegexUtil::parseRegex(regex, flags));
+}
+
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <regex>
+
+#include "envoy/common/regex.h"
+#include "envoy/type/matcher/regex.pb.h"
+
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * The regex engine used by consumers that must operate on raw regex strings rather than a
+ * RegexMatcher config.
+ */
+enum class Type { Re2, StdRegex };
+
+class Utility {
+public:
+  /**
+   * Construct a compiled regex matcher from a match config.
+   * @param matcher supplies the regex match config.
+   * @return CompiledMatcherPtr the compiled matcher.
+   * @throw EnvoyException if the regex is invalid or exceeds the configured limits.
+   */
+  static CompiledMatcherPtr parseRegex(const envoy::type::matcher::RegexMatcher& matcher);
+
+  /**
+   * Construct a single compiled regex matcher from several match configs, which matches a value if
+   * any of them does. Matching takes linear time in the length of the value whatever the number
+   * of regexes, instead of one pass per regex.
+   * @param matchers supplies the regex match configs, which must not be empty. Unlike
+   *        parseRegex(), their program sizes are not checked.
+   * @return CompiledMatcherPtr the compiled matcher.
+   * @throw EnvoyException if one of the regexes is invalid.
+   */
+  static CompiledMatcherPtr
+  parseRegexSet(const Protobuf::RepeatedPtrField<envoy::type::matcher::RegexMatcher>& matchers);
+
+  /**
+   * Construct a compiled regex matcher backed by std::regex from a regex string. This exists for
+   * legacy configuration fields which are documented to use ECMAScript regex semantics. New code
+   * should prefer parseRegex().
+   * @param regex supplies the regex string.
+   * @param flags supplies the std::regex parser flags.
+   * @return CompiledMatcherPtr the compiled matcher.
+   * @throw EnvoyException if the regex string is invalid.
+   */
+  static CompiledMatcherPtr parseStdRegexAsCompiledMatcher(const std::string& regex,
+                                                           std::regex::flag_type flags =
+                                                               std::regex::optimize);
+
+  // The default RE2 program size limit, used when the config does not specify one.
+  static constexpr uint32_t DefaultMaxProgramSize = 100;
+};
+
+} // namespace Regex
+} // namespace Envoy
@@ -9,6 +9,7 @@
 #include "common/common/logger.h"
 #include "common/common/macros.h"
 #include "common/config/utility.h"
+#include "common/memory/accounting.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
 
@@ -64,6 +65,7 @@ private:
       const auto typed_resources = Config::Utility::getTypedResources<ResourceType>(message);
       config_update_available = true;
       callbacks_->onConfigUpdate(typed_resources, message.version_info());
+      config_bytes_.set(Config::Utility::resourcesByteSize(typed_resources));
       stats_.version_.set(HashUtil::xxHash64(message.version_info()));
       stats_.update_success_.inc();
       ENVOY_LOG(debug, "Filesystem config update accepted for {}: {}", path_,
@@ -86,6 +88,8 @@ private:
   SubscriptionCallbacks<ResourceType>* callbacks_{};
   SubscriptionStats stats_;
   Api::Api& api_;
+  // Size of the resources of the last update that the callbacks accepted.
+  Memory::AccountedBytes config_bytes_{Memory::AccountingTag::Config};
 };
 
 } // namespace Config
@@ -146,15 +146,31 @@ void GrpcMuxImpl::handleResponse(std::unique_ptr<envoy::api::v2::DiscoveryRespon
     // build a map here from resource name to resource and then walk watches_.
     // We have to walk all watches (and need an efficient map as a result) to
     // ensure we deliver empty config updates when a resource is dropped.
-    std::unordered_map<std::string, ProtobufWkt::Any> resources;
+    // The map points into the message rather than copying the resources, which
+    // keeps large EDS responses from being held in memory several times.
+    std::unordered_map<std::string, PendingResource> resources;
     GrpcMuxCallbacks& callbacks = api_state_[type_url].watches_.front()->callbacks_;
-    for (const auto& resource : message->resources()) {
+    for (auto& resource : *message->mutable_resources()) {
       if (type_url != resource.type_url()) {
         throw EnvoyException(fmt::format("{} does not match {} type URL in DiscoveryResponse {}",
                                          resource.type_url(), type_url, message->DebugString()));
       }
-      const std::string resource_name = callbacks.resourceName(resource);
-      resources.emplace(resource_name, resource);
+      resources.emplace(callbacks.resourceName(resource), PendingResource{&resource});
+    }
+    // A resource can be moved out of the message into the update of the last watch that needs it,
+    // unless a watch without resource names needs the whole message.
+    bool move_resources = true;
+    for (auto watch : api_state_[type_url].watches_) {
+      if (watch->resources_.empty()) {
+        move_resources = false;
+        break;
+      }
+      for (const auto& watched_resource_name : watch->resources_) {
+        auto it = resources.find(watched_resource_name);
+        if (it != resources.end()) {
+          it->second.watches_++;
+        }
+      }
     }
     for (auto watch : api_state_[type_url].watches_) {
       // onConfigUpdate should be called in all cases for single watch xDS (Cluster and Listener)
@@ -165,10 +181,14 @@ void GrpcMuxImpl::handleResponse(std::unique_ptr<envoy::api::v2::DiscoveryRespon
         continue;
       }
       Protobuf::RepeatedPtrField<ProtobufWkt::Any> found_resources;
-      for (auto watched_resource_name : watch->resources_) {
+      for (const auto& watched_resource_name : watch->resources_) {
         auto it = resources.find(watched_resource_name);
         if (it != resources.end()) {
-          found_resources.Add()->MergeFrom(it->second);
+          if (move_resources && --it->second.watches_ == 0) {
+            found_resources.Add()->Swap(it->second.resource_);
+          } else {
+            found_resources.Add()->MergeFrom(*it->second.resource_);
+          }
         }
       }
       // onConfigUpdate should be called only on watches(clusters/routes) that have updates in the
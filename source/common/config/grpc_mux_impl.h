@@ -71,6 +71,13 @@ private:
     bool inserted_;
   };
 
+  // A resource of a DiscoveryResponse that is being delivered to the watches.
+  struct PendingResource {
+    ProtobufWkt::Any* resource_;
+    // Number of watches that have yet to receive the resource.
+    uint32_t watches_{};
+  };
+
   // Per muxed API state.
   struct ApiState {
     // Watches on the returned resources for the API;
@@ -6,10 +6,14 @@
 
 #include "common/common/assert.h"
 #include "common/common/logger.h"
+#include "common/config/utility.h"
 #include "common/grpc/common.h"
+#include "common/memory/accounting.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Config {
 
@@ -56,15 +60,30 @@ public:
   void onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
                       const std::string& version_info) override {
     disableInitFetchTimeoutTimer();
+    // Management servers commonly resend their whole state, e.g. when the stream is reestablished.
+    // A response that carries the same version and resource bytes as the last accepted one would
+    // not change anything, so skip decoding it and calling the callbacks.
+    const uint64_t update_hash = updateHash(resources, version_info);
+    if (last_update_hash_.has_value() && last_update_hash_.value() == update_hash) {
+      stats_.update_success_.inc();
+      stats_.update_attempt_.inc();
+      ENVOY_LOG(debug, "gRPC config for {} unchanged at version {}", type_url_, version_info);
+      return;
+    }
+    // Unpack straight into the elements of the typed field, rather than into temporaries that are
+    // then copied, since EDS responses can be very large.
     Protobuf::RepeatedPtrField<ResourceType> typed_resources;
-    std::transform(resources.cbegin(), resources.cend(),
-                   Protobuf::RepeatedPtrFieldBackInserter(&typed_resources),
-                   MessageUtil::anyConvert<ResourceType>);
+    typed_resources.Reserve(resources.size());
+    for (const auto& resource : resources) {
+      MessageUtil::unpackTo(resource, *typed_resources.Add());
+    }
     // TODO(mattklein123): In the future if we start tracking per-resource versions, we need to
     // supply those versions to onConfigUpdate() along with the xDS response ("system")
     // version_info. This way, both types of versions can be tracked and exposed for debugging by
     // the configuration update targets.
     callbacks_->onConfigUpdate(typed_resources, version_info);
+    last_update_hash_ = update_hash;
+    config_bytes_.set(Utility::resourcesByteSize(typed_resources));
     stats_.update_success_.inc();
     stats_.update_attempt_.inc();
     stats_.version_.set(HashUtil::xxHash64(version_info));
@@ -92,6 +111,17 @@ public:
   }
 
 private:
+  // Hashes the encoded resources as received, which is much cheaper than decoding them.
+  static uint64_t updateHash(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+                             const std::string& version_info) {
+    uint64_t hash = HashUtil::xxHash64(version_info);
+    for (const auto& resource : resources) {
+      hash = HashUtil::xxHash64(resource.type_url(), hash);
+      hash = HashUtil::xxHash64(resource.value(), hash);
+    }
+    return hash;
+  }
+
   void disableInitFetchTimeoutTimer() {
     if (init_fetch_timeout_timer_) {
       init_fetch_timeout_timer_->disableTimer();
@@ -107,6 +137,10 @@ private:
   Event::Dispatcher& dispatcher_;
   std::chrono::milliseconds init_fetch_timeout_;
   Event::TimerPtr init_fetch_timeout_timer_;
+  // Hash of the last update that the callbacks accepted.
+  absl::optional<uint64_t> last_update_hash_;
+  // Size of the resources of the last update that the callbacks accepted.
+  Memory::AccountedBytes config_bytes_{Memory::AccountingTag::Config};
 };
 
 } // namespace Config
@@ -12,6 +12,7 @@
 #include "common/config/utility.h"
 #include "common/http/headers.h"
 #include "common/http/rest_api_fetcher.h"
+#include "common/memory/accounting.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
 
@@ -100,6 +101,7 @@ public:
     const auto typed_resources = Config::Utility::getTypedResources<ResourceType>(message);
     try {
       callbacks_->onConfigUpdate(typed_resources, message.version_info());
+      config_bytes_.set(Config::Utility::resourcesByteSize(typed_resources));
       request_.set_version_info(message.version_info());
       stats_.version_.set(HashUtil::xxHash64(request_.version_info()));
       stats_.update_success_.inc();
@@ -139,6 +141,8 @@ private:
   Event::Dispatcher& dispatcher_;
   std::chrono::milliseconds init_fetch_timeout_;
   Event::TimerPtr init_fetch_timeout_timer_;
+  // Size of the resources of the last update that the callbacks accepted.
+  Memory::AccountedBytes config_bytes_{Memory::AccountingTag::Config};
 };
 
 } // namespace Config
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/api/v2/discovery.pb.h"
+#include "envoy/config/subscription.h"
+#include "envoy/filesystem/filesystem.h"
+
+#include "common/common/fmt.h"
+#include "common/common/hash.h"
+#include "common/common/logger.h"
+#include "common/config/utility.h"
+#include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/str_join.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * Subscription decorator that writes every accepted state-of-the-world update of the wrapped
+ * subscription to a binary DiscoveryResponse snapshot, and applies the snapshot when the
+ * subscription starts, before the wrapped subscription has delivered anything. A snapshot that
+ * cannot be read or that is rejected is ignored, and the subscription waits for the management
+ * server as if there was none.
+ */
+template <class ResourceType>
+class SnapshotSubscriptionImpl : public Subscription<ResourceType>,
+                                 public SubscriptionCallbacks<ResourceType>,
+                                 Logger::Loggable<Logger::Id::config> {
+public:
+  SnapshotSubscriptionImpl(std::unique_ptr<Subscription<ResourceType>>&& subscription,
+                           const std::string& path_prefix, Api::Api& api)
+      : subscription_(std::move(subscription)), path_prefix_(path_prefix), api_(api) {}
+
+  /**
+   * @param path_prefix supplies the configured snapshot path prefix.
+   * @param resources supplies the names of the subscribed resources.
+   * @return std::string the path of the snapshot of a subscription to the resources.
+   */
+  static std::string snapshotPath(const std::string& path_prefix,
+                                  const std::vector<std::string>& resources) {
+    std::string path = path_prefix + ResourceType::descriptor()->full_name();
+    if (!resources.empty()) {
+      std::vector<std::string> sorted_resources(resources);
+      std::sort(sorted_resources.begin(), sorted_resources.end());
+      path += fmt::format(".{:016x}", HashUtil::xxHash64(absl::StrJoin(sorted_resources, ",")));
+    }
+    return path + MessageUtil::FileExtensions::get().ProtoBinary;
+  }
+
+  // Config::Subscription
+  void start(const std::vector<std::string>& resources,
+             SubscriptionCallbacks<ResourceType>& callbacks) override {
+    callbacks_ = &callbacks;
+    path_ = snapshotPath(path_prefix_, resources);
+    loadSnapshot();
+    subscription_->start(resources, *this);
+  }
+
+  void updateResources(const std::vector<std::string>& resources) override {
+    path_ = snapshotPath(path_prefix_, resources);
+    last_snapshot_hash_ = 0;
+    subscription_->updateResources(resources);
+  }
+
+  // Config::SubscriptionCallbacks
+  void onConfigUpdate(const Protobuf::RepeatedPtrField<ResourceType>& resources,
+                      const std::string& version_info) override {
+    callbacks_->onConfigUpdate(resources, version_info);
+    writeSnapshot(resources, version_info);
+  }
+
+  void onConfigUpdate(const Protobuf::RepeatedPtrField<envoy::api::v2::Resource>& added_resources,
+                      const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                      const std::string& system_version_info) override {
+    // Delta subscriptions are not snapshotted, see SubscriptionFactory.
+    callbacks_->onConfigUpdate(added_resources, removed_resources, system_version_info);
+  }
+
+  void onConfigUpdateFailed(const EnvoyException* e) override {
+    callbacks_->onConfigUpdateFailed(e);
+  }
+
+  std::string resourceName(const ProtobufWkt::Any& resource) override {
+    return callbacks_->resourceName(resource);
+  }
+
+private:
+  void loadSnapshot() {
+    if (!api_.fileSystem().fileExists(path_)) {
+      return;
+    }
+    try {
+      const std::string contents = api_.fileSystem().fileReadToEnd(path_);
+      envoy::api::v2::DiscoveryResponse snapshot;
+      if (!snapshot.ParseFromString(contents)) {
+        throw EnvoyException("unable to parse the snapshot as a binary DiscoveryResponse");
+      }
+      const auto resources = Utility::getTypedResources<ResourceType>(snapshot);
+      callbacks_->onConfigUpdate(resources, snapshot.version_info());
+      last_snapshot_hash_ = HashUtil::xxHash64(contents);
+      ENVOY_LOG(info, "applied {} resources of version {} from snapshot {}", resources.size(),
+                snapshot.version_info(), path_);
+    } catch (const EnvoyException& e) {
+      ENVOY_LOG(warn, "ignoring snapshot {}: {}", path_, e.what());
+    }
+  }
+
+  void writeSnapshot(const Protobuf::RepeatedPtrField<ResourceType>& resources,
+                     const std::string& version_info) {
+    envoy::api::v2::DiscoveryResponse snapshot;
+    snapshot.set_version_info(version_info);
+    snapshot.set_type_url("type.googleapis.com/" + ResourceType::descriptor()->full_name());
+    for (const auto& resource : resources) {
+      snapshot.add_resources()->PackFrom(resource);
+    }
+    std::string contents;
+    snapshot.SerializeToString(&contents);
+    // Management servers usually send the same resources again after reconnecting.
+    const uint64_t hash = HashUtil::xxHash64(contents);
+    if (hash == last_snapshot_hash_) {
+      return;
+    }
+
+    // Write to a temporary file and move it over the snapshot, so that a crash while writing
+    // never leaves a truncated snapshot behind.
+    const std::string temporary_path = path_ + ".tmp";
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    file << contents;
+    file.close();
+    if (file.fail()) {
+      ENVOY_LOG(warn, "unable to write snapshot {}", temporary_path);
+      return;
+    }
+    if (std::rename(temporary_path.c_str(), path_.c_str()) != 0) {
+      ENVOY_LOG(warn, "unable to move snapshot {} to {}", temporary_path, path_);
+      return;
+    }
+    last_snapshot_hash_ = hash;
+    ENVOY_LOG(debug, "wrote {} resources of version {} to snapshot {}", resources.size(),
+              version_info, path_);
+  }
+
+  std::unique_ptr<Subscription<ResourceType>> subscription_;
+  const std::string path_prefix_;
+  Api::Api& api_;
+  SubscriptionCallbacks<ResourceType>* callbacks_{};
+  std::string path_;
+  // Hash of the contents of the snapshot on disk, 0 when there is none or it is unknown.
+  uint64_t last_snapshot_hash_{};
+};
+
+} // namespace Config
+} // namespace Envoy
@@ -13,6 +13,7 @@
 #include "common/config/grpc_mux_subscription_impl.h"
 #include "common/config/grpc_subscription_impl.h"
 #include "common/config/http_subscription_impl.h"
+#include "common/config/snapshot_subscription_impl.h"
 #include "common/config/utility.h"
 #include "common/protobuf/protobuf.h"
 
@@ -45,6 +46,11 @@ public:
       Api::Api& api) {
     std::unique_ptr<Subscription<ResourceType>> result;
     SubscriptionStats stats = Utility::generateStats(scope);
+    if (!config.snapshot_path_prefix().empty() && config.has_api_config_source() &&
+        config.api_config_source().api_type() ==
+            envoy::api::v2::core::ApiConfigSource::DELTA_GRPC) {
+      throw EnvoyException("snapshot_path_prefix is not supported with the DELTA_GRPC API type");
+    }
     switch (config.config_source_specifier_case()) {
     case envoy::api::v2::core::ConfigSource::kPath: {
       Utility::checkFilesystemSubscriptionBackingPath(config.path(), api);
@@ -105,6 +111,10 @@ public:
     default:
       throw EnvoyException("Missing config source specifier in envoy::api::v2::core::ConfigSource");
     }
+    if (!config.snapshot_path_prefix().empty()) {
+      result.reset(new SnapshotSubscriptionImpl<ResourceType>(
+          std::move(result), config.snapshot_path_prefix(), api));
+    }
     return result;
   }
 };
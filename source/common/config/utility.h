@@ -77,6 +77,21 @@ public:
     return typed_resources;
   }
 
+  /**
+   * Compute the serialized size of resources, for the memory accounting of the config that is
+   * currently in use.
+   * @param resources supplies the resources.
+   * @return uint64_t the sum of the serialized sizes of the resources.
+   */
+  template <class ResourceType>
+  static uint64_t resourcesByteSize(const Protobuf::RepeatedPtrField<ResourceType>& resources) {
+    uint64_t bytes = 0;
+    for (const auto& resource : resources) {
+      bytes += resource.ByteSizeLong();
+    }
+    return bytes;
+  }
+
   /**
    * Legacy APIs uses JSON and do not have an explicit version.
    * @param input the input to hash.
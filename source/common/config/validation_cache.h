@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_set>
+
+#include "envoy/common/time.h"
+#include "envoy/stats/histogram.h"
+#include "envoy/stats/scope.h"
+
+#include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * Remembers the resources of a subscription that passed validation in its last update, so that an
+ * update only runs the PGV and deprecation checks on the resources that changed. Resources are
+ * identified by a hash of their config. Only the resources of the last update are kept, which
+ * bounds the cache by the size of the resource set.
+ *
+ * The time it takes to validate an update is recorded in the update_validation_time_us histogram
+ * of the subscription's scope.
+ */
+class ValidationCache {
+public:
+  ValidationCache(Stats::Scope& scope, TimeSource& time_source)
+      : validation_time_(scope.histogram("update_validation_time_us")),
+        time_source_(time_source) {}
+
+  /**
+   * Validate the resources of an update with MessageUtil::validate(), skipping the ones that
+   * passed validation in the last update. Note the corresponding `.pb.validate.h` for the resource
+   * has to be included in the source file of the caller.
+   * @param resources supplies the resources of the update.
+   * @throw ProtoValidationException if a changed resource does not pass validation. The cache is
+   *        not changed in that case.
+   */
+  template <class ResourceType>
+  void validate(const Protobuf::RepeatedPtrField<ResourceType>& resources) {
+    const MonotonicTime start = time_source_.monotonicTime();
+    std::unordered_set<uint64_t> validated;
+    validated.reserve(resources.size());
+    for (const auto& resource : resources) {
+      const uint64_t hash = MessageUtil::hash(resource);
+      if (!contains(hash)) {
+        MessageUtil::validate(resource);
+      }
+      validated.insert(hash);
+    }
+    replace(std::move(validated));
+    recordValidationTime(start);
+  }
+
+  /**
+   * @param hash supplies the hash of a resource.
+   * @return TRUE if the resource passed validation in the last update. This does not modify the
+   *         cache, so it can be called from several threads at once.
+   */
+  bool contains(uint64_t hash) const { return validated_.count(hash) > 0; }
+
+  /**
+   * Replace the cache by the hashes of the resources of an update that passed validation.
+   * @param validated supplies the hashes.
+   */
+  void replace(std::unordered_set<uint64_t>&& validated) { validated_ = std::move(validated); }
+
+  /**
+   * Record the time it took to validate an update.
+   * @param start supplies the time the validation started at.
+   */
+  void recordValidationTime(MonotonicTime start) {
+    validation_time_.recordValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     time_source_.monotonicTime() - start)
+                                     .count());
+  }
+
+  /**
+   * @return uint64_t the number of resources in the cache.
+   */
+  uint64_t size() const { return validated_.size(); }
+
+private:
+  Stats::Histogram& validation_time_;
+  TimeSource& time_source_;
+  std::unordered_set<uint64_t> validated_;
+};
+
+} // namespace Config
+} // namespace Envoy
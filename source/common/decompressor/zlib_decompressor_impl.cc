@@ -1,5 +1,6 @@
 #include "common/decompressor/zlib_decompressor_impl.h"
 
+#include <limits>
 #include <memory>
 
 #include "envoy/common/exception.h"
@@ -13,16 +14,13 @@ namespace Decompressor {
 ZlibDecompressorImpl::ZlibDecompressorImpl() : ZlibDecompressorImpl(4096) {}
 
 ZlibDecompressorImpl::ZlibDecompressorImpl(uint64_t chunk_size)
-    : chunk_size_{chunk_size}, initialized_{false}, chunk_char_ptr_(new unsigned char[chunk_size]),
-      zstream_ptr_(new z_stream(), [](z_stream* z) {
+    : chunk_size_{chunk_size}, initialized_{false}, zstream_ptr_(new z_stream(), [](z_stream* z) {
         inflateEnd(z);
         delete z;
       }) {
   zstream_ptr_->zalloc = Z_NULL;
   zstream_ptr_->zfree = Z_NULL;
   zstream_ptr_->opaque = Z_NULL;
-  zstream_ptr_->avail_out = chunk_size_;
-  zstream_ptr_->next_out = chunk_char_ptr_.get();
 }
 
 void ZlibDecompressorImpl::init(int64_t window_bits) {
@@ -36,28 +34,48 @@ uint64_t ZlibDecompressorImpl::checksum() { return zstream_ptr_->adler; }
 
 void ZlibDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
                                       Buffer::Instance& output_buffer) {
+  const bool decompressed =
+      decompress(input_buffer, output_buffer, std::numeric_limits<uint64_t>::max());
+  RELEASE_ASSERT(decompressed, "malformed compressed data");
+}
+
+bool ZlibDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
+                                      Buffer::Instance& output_buffer, uint64_t max_output_bytes) {
+  if (failed_) {
+    return false;
+  }
+
   const uint64_t num_slices = input_buffer.getRawSlices(nullptr, 0);
   STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
   input_buffer.getRawSlices(slices.begin(), num_slices);
 
+  uint64_t output_bytes = 0;
   for (const Buffer::RawSlice& input_slice : slices) {
     zstream_ptr_->avail_in = input_slice.len_;
     zstream_ptr_->next_in = static_cast<Bytef*>(input_slice.mem_);
-    while (inflateNext()) {
-      if (zstream_ptr_->avail_out == 0) {
-        output_buffer.add(static_cast<void*>(chunk_char_ptr_.get()),
-                          chunk_size_ - zstream_ptr_->avail_out);
-        chunk_char_ptr_ = std::make_unique<unsigned char[]>(chunk_size_);
-        zstream_ptr_->avail_out = chunk_size_;
-        zstream_ptr_->next_out = chunk_char_ptr_.get();
+    bool more = true;
+    while (more) {
+      // Inflate straight into the space reserved at the end of the output buffer, so that the
+      // decompressed data isn't copied, and the free space left in the last slice of the output
+      // buffer is filled before a new slice is allocated.
+      Buffer::RawSlice output_slice;
+      output_buffer.reserve(chunk_size_, &output_slice, 1);
+      zstream_ptr_->avail_out = output_slice.len_;
+      zstream_ptr_->next_out = static_cast<Bytef*>(output_slice.mem_);
+      more = inflateNext();
+
+      output_slice.len_ -= zstream_ptr_->avail_out;
+      if (output_slice.len_ > 0) {
+        output_buffer.commit(&output_slice, 1);
+        output_bytes += output_slice.len_;
+      }
+      if (failed_ || output_bytes > max_output_bytes) {
+        failed_ = true;
+        return false;
       }
     }
   }
-
-  const uint64_t n_output{chunk_size_ - zstream_ptr_->avail_out};
-  if (n_output > 0) {
-    output_buffer.add(static_cast<void*>(chunk_char_ptr_.get()), n_output);
-  }
+  return true;
 }
 
 bool ZlibDecompressorImpl::inflateNext() {
@@ -73,6 +91,11 @@ bool ZlibDecompressorImpl::inflateNext() {
     return false; // This means that zlib needs more input, so stop here.
   }
 
+  if (result == Z_DATA_ERROR || result == Z_NEED_DICT || result == Z_MEM_ERROR) {
+    failed_ = true;
+    return false;
+  }
+
   RELEASE_ASSERT(result == Z_OK, "");
   return true;
 }
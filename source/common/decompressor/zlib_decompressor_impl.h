@@ -42,14 +42,17 @@ public:
 
   // Decompressor
   void decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer) override;
+  bool decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer,
+                  uint64_t max_output_bytes) override;
 
 private:
   bool inflateNext();
 
   const uint64_t chunk_size_;
   bool initialized_;
+  // Set once the compressed data is found malformed, or its decompressed data too large.
+  bool failed_{};
 
-  std::unique_ptr<unsigned char[]> chunk_char_ptr_;
   std::unique_ptr<z_stream, std::function<void(z_stream*)>> zstream_ptr_;
 };
 
@@ -9,9 +9,9 @@
 #include "envoy/api/api.h"
 #include "envoy/network/listen_socket.h"
 #include "envoy/network/listener.h"
+#include "envoy/stats/timespan.h"
 
 #include "common/buffer/buffer_impl.h"
-#include "common/common/lock_guard.h"
 #include "common/common/thread.h"
 #include "common/event/file_event_impl.h"
 #include "common/event/libevent_scheduler.h"
@@ -27,6 +27,11 @@
 
 namespace Envoy {
 namespace Event {
+namespace {
+
+constexpr std::chrono::milliseconds CoarseTimerResolution{1};
+
+} // namespace
 
 DispatcherImpl::DispatcherImpl(Api::Api& api, Event::TimeSystem& time_system)
     : DispatcherImpl(std::make_unique<Buffer::WatermarkBufferFactory>(), api, time_system) {}
@@ -37,9 +42,22 @@ DispatcherImpl::DispatcherImpl(Buffer::WatermarkFactoryPtr&& factory, Api::Api&
       scheduler_(time_system.createScheduler(base_scheduler_)),
       deferred_delete_timer_(createTimer([this]() -> void { clearDeferredDeleteList(); })),
       post_timer_(createTimer([this]() -> void { runPostCallbacks(); })),
-      current_to_delete_(&to_delete_1_) {}
+      coarse_timers_(*this, CoarseTimerResolution), current_to_delete_(&to_delete_1_) {}
 
-DispatcherImpl::~DispatcherImpl() {}
+DispatcherImpl::~DispatcherImpl() {
+  // Callbacks that never ran are destroyed without running.
+  while (MpscQueue::Node* node = post_callbacks_.pop()) {
+    delete static_cast<PostedCallback*>(node);
+  }
+}
+
+void DispatcherImpl::initializeStats(Stats::Scope& scope, const std::string& prefix) {
+  ASSERT(isThreadSafe());
+  const std::string stats_prefix = prefix + "dispatcher.";
+  stats_ = std::make_unique<DispatcherStats>(
+      DispatcherStats{ALL_DISPATCHER_STATS(POOL_HISTOGRAM_PREFIX(scope, stats_prefix))});
+  stats_enabled_ = true;
+}
 
 void DispatcherImpl::clearDeferredDeleteList() {
   ASSERT(isThreadSafe());
@@ -100,6 +118,16 @@ Network::DnsResolverSharedPtr DispatcherImpl::createDnsResolver(
 FileEventPtr DispatcherImpl::createFileEvent(int fd, FileReadyCb cb, FileTriggerType trigger,
                                              uint32_t events) {
   ASSERT(isThreadSafe());
+  if (stats_ != nullptr) {
+    // The event may be destroyed by its own callback, so nothing captured by this lambda may be
+    // used once cb() returns. The span holds what it needs.
+    cb = [this, cb](uint32_t events) -> void {
+      Stats::TimespanWithUnit<std::chrono::microseconds> span(stats_->file_event_duration_us_,
+                                                              timeSource());
+      cb(events);
+      span.complete();
+    };
+  }
   return FileEventPtr{new FileEventImpl(*this, fd, cb, trigger, events)};
 }
 
@@ -110,21 +138,40 @@ Filesystem::WatcherPtr DispatcherImpl::createFilesystemWatcher() {
 
 Network::ListenerPtr
 DispatcherImpl::createListener(Network::Socket& socket, Network::ListenerCallbacks& cb,
-                               bool bind_to_port, bool hand_off_restored_destination_connections) {
+                               bool bind_to_port, bool hand_off_restored_destination_connections,
+                               uint32_t max_connections_to_accept_per_socket_event) {
   ASSERT(isThreadSafe());
-  return Network::ListenerPtr{new Network::ListenerImpl(*this, socket, cb, bind_to_port,
-                                                        hand_off_restored_destination_connections)};
+  return Network::ListenerPtr{new Network::ListenerImpl(
+      *this, socket, cb, bind_to_port, hand_off_restored_destination_connections,
+      max_connections_to_accept_per_socket_event)};
 }
 
-Network::ListenerPtr DispatcherImpl::createUdpListener(Network::Socket& socket,
-                                                       Network::UdpListenerCallbacks& cb) {
+Network::UdpListenerPtr DispatcherImpl::createUdpListener(Network::Socket& socket,
+                                                          Network::UdpListenerCallbacks& cb) {
   ASSERT(isThreadSafe());
-  return Network::ListenerPtr{new Network::UdpListenerImpl(*this, socket, cb)};
+  return Network::UdpListenerPtr{new Network::UdpListenerImpl(*this, socket, cb)};
 }
 
 TimerPtr DispatcherImpl::createTimer(TimerCb cb) {
   ASSERT(isThreadSafe());
-  return scheduler_->createTimer(cb);
+  return scheduler_->createTimer(wrapTimerCallback(std::move(cb)));
+}
+
+TimerPtr DispatcherImpl::createCoarseTimer(TimerCb cb) {
+  ASSERT(isThreadSafe());
+  return coarse_timers_.createTimer(wrapTimerCallback(std::move(cb)));
+}
+
+TimerCb DispatcherImpl::wrapTimerCallback(TimerCb cb) {
+  if (stats_ == nullptr) {
+    return cb;
+  }
+  return [this, cb]() -> void {
+    Stats::TimespanWithUnit<std::chrono::microseconds> span(stats_->timer_duration_us_,
+                                                            timeSource());
+    cb();
+    span.complete();
+  };
 }
 
 void DispatcherImpl::deferredDelete(DeferredDeletablePtr&& to_delete) {
@@ -144,12 +191,13 @@ SignalEventPtr DispatcherImpl::listenForSignal(int signal_num, SignalCb cb) {
 }
 
 void DispatcherImpl::post(std::function<void()> callback) {
-  bool do_post;
-  {
-    Thread::LockGuard lock(post_lock_);
-    do_post = post_callbacks_.empty();
-    post_callbacks_.push_back(callback);
-  }
+  const MonotonicTime posted_time = stats_enabled_.load(std::memory_order_relaxed)
+                                        ? timeSource().monotonicTime()
+                                        : MonotonicTime();
+  // Only the post that makes the queue non-empty arms the timer. The others are run by the pass
+  // that is already due.
+  const bool do_post = pending_post_callbacks_.fetch_add(1, std::memory_order_acq_rel) == 0;
+  post_callbacks_.push(*new PostedCallback(std::move(callback), posted_time));
 
   if (do_post) {
     post_timer_->enableTimer(std::chrono::milliseconds(0));
@@ -173,23 +221,40 @@ void DispatcherImpl::run(RunType type) {
 }
 
 void DispatcherImpl::runPostCallbacks() {
-  while (true) {
-    // It is important that this declaration is inside the body of the loop so that the callback is
-    // destructed while post_lock_ is not held. If callback is declared outside the loop and reused
-    // for each iteration, the previous iteration's callback is destructed when callback is
-    // re-assigned, which happens while holding the lock. This can lead to a deadlock (via
-    // recursive mutex acquisition) if destroying the callback runs a destructor, which through some
-    // callstack calls post() on this dispatcher.
-    std::function<void()> callback;
-    {
-      Thread::LockGuard lock(post_lock_);
-      if (post_callbacks_.empty()) {
-        return;
-      }
-      callback = post_callbacks_.front();
-      post_callbacks_.pop_front();
+  uint64_t ran = 0;
+  while (MpscQueue::Node* node = post_callbacks_.pop()) {
+    // The callback is destroyed before the next one runs, as the destructors of its captures may
+    // post() to this dispatcher.
+    std::unique_ptr<PostedCallback> posted(static_cast<PostedCallback*>(node));
+    ran++;
+    if (stats_ == nullptr) {
+      posted->callback_();
+      continue;
+    }
+
+    const MonotonicTime start = timeSource().monotonicTime();
+    // Callbacks posted before stats were enabled have no post time.
+    if (posted->posted_time_ != MonotonicTime()) {
+      stats_->post_delay_us_.recordValue(
+          std::chrono::duration_cast<std::chrono::microseconds>(start - posted->posted_time_)
+              .count());
     }
-    callback();
+    posted->callback_();
+    stats_->post_callback_duration_us_.recordValue(
+        std::chrono::duration_cast<std::chrono::microseconds>(timeSource().monotonicTime() - start)
+            .count());
+  }
+
+  if (ran > 0 && stats_ != nullptr) {
+    stats_->post_queue_depth_.recordValue(ran);
+  }
+  // Callbacks posted since the queue became non-empty didn't arm the timer. Those that this pass
+  // couldn't see, as their push was still in progress, run in the next pass.
+  const uint64_t pending =
+      ran == 0 ? pending_post_callbacks_.load(std::memory_order_acquire)
+               : pending_post_callbacks_.fetch_sub(ran, std::memory_order_acq_rel) - ran;
+  if (pending > 0) {
+    post_timer_->enableTimer(std::chrono::milliseconds(0));
   }
 }
 
@@ -2,7 +2,9 @@
 
 #include <cstdint>
 #include <functional>
-#include <list>
+#include <atomic>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "envoy/api/api.h"
@@ -12,9 +14,11 @@
 #include "envoy/network/connection_handler.h"
 
 #include "common/common/logger.h"
+#include "common/common/mpsc_queue.h"
 #include "common/common/thread.h"
 #include "common/event/libevent.h"
 #include "common/event/libevent_scheduler.h"
+#include "common/event/timer_wheel.h"
 
 namespace Envoy {
 namespace Event {
@@ -36,6 +40,7 @@ public:
 
   // Event::Dispatcher
   TimeSource& timeSource() override { return api_.timeSource(); }
+  void initializeStats(Stats::Scope& scope, const std::string& prefix) override;
   void clearDeferredDeleteList() override;
   Network::ConnectionPtr
   createServerConnection(Network::ConnectionSocketPtr&& socket,
@@ -52,10 +57,12 @@ public:
   Filesystem::WatcherPtr createFilesystemWatcher() override;
   Network::ListenerPtr createListener(Network::Socket& socket, Network::ListenerCallbacks& cb,
                                       bool bind_to_port,
-                                      bool hand_off_restored_destination_connections) override;
-  Network::ListenerPtr createUdpListener(Network::Socket& socket,
-                                         Network::UdpListenerCallbacks& cb) override;
+                                      bool hand_off_restored_destination_connections,
+                                      uint32_t max_connections_to_accept_per_socket_event) override;
+  Network::UdpListenerPtr createUdpListener(Network::Socket& socket,
+                                            Network::UdpListenerCallbacks& cb) override;
   TimerPtr createTimer(TimerCb cb) override;
+  TimerPtr createCoarseTimer(TimerCb cb) override;
   void deferredDelete(DeferredDeletablePtr&& to_delete) override;
   void exit() override;
   SignalEventPtr listenForSignal(int signal_num, SignalCb cb) override;
@@ -64,7 +71,17 @@ public:
   Buffer::WatermarkFactory& getWatermarkFactory() override { return *buffer_factory_; }
 
 private:
+  struct PostedCallback : public MpscQueue::Node {
+    PostedCallback(std::function<void()>&& callback, MonotonicTime posted_time)
+        : callback_(std::move(callback)), posted_time_(posted_time) {}
+
+    std::function<void()> callback_;
+    // Only set while stats are enabled.
+    const MonotonicTime posted_time_;
+  };
+
   void runPostCallbacks();
+  TimerCb wrapTimerCallback(TimerCb cb);
 
   // Validate that an operation is thread safe, i.e. it's invoked on the same thread that the
   // dispatcher run loop is executing on. We allow run_tid_ == nullptr for tests where we don't
@@ -74,16 +91,26 @@ private:
   Api::Api& api_;
   Thread::ThreadIdPtr run_tid_;
   Buffer::WatermarkFactoryPtr buffer_factory_;
+  // Declared before the timers, as createTimer() reads it.
+  std::unique_ptr<DispatcherStats> stats_;
   LibeventScheduler base_scheduler_;
   SchedulerPtr scheduler_;
   TimerPtr deferred_delete_timer_;
   TimerPtr post_timer_;
+  // Multiplexes the coarse timers onto a single timer of scheduler_. Declared before the deferred
+  // deletion lists, as the objects they hold may own coarse timers.
+  TimerWheel coarse_timers_;
   std::vector<DeferredDeletablePtr> to_delete_1_;
   std::vector<DeferredDeletablePtr> to_delete_2_;
   std::vector<DeferredDeletablePtr>* current_to_delete_;
-  Thread::MutexBasicLockable post_lock_;
-  std::list<std::function<void()>> post_callbacks_ GUARDED_BY(post_lock_);
+  MpscQueue post_callbacks_;
+  // The callbacks that were posted but haven't been run yet. Incremented before a callback is
+  // pushed, so that it covers the callbacks whose push is in progress, which pop() can't see yet.
+  std::atomic<uint64_t> pending_post_callbacks_{};
   bool deferred_deleting_{};
+  // Lets post() tell whether to record the post time without touching stats_, as post() may be
+  // called from any thread.
+  std::atomic<bool> stats_enabled_{};
 };
 
 } // namespace Event
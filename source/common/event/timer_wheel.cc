@@ -0,0 +1,145 @@
+#include "common/event/timer_wheel.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Event {
+
+TimerWheel::TimerWheel(Dispatcher& dispatcher, std::chrono::milliseconds resolution)
+    : time_source_(dispatcher.timeSource()), resolution_(resolution),
+      start_(time_source_.monotonicTime()),
+      tick_timer_(dispatcher.createTimer([this]() -> void { onTick(); })) {
+  ASSERT(resolution_.count() > 0);
+}
+
+TimerPtr TimerWheel::createTimer(const TimerCb& cb) { return TimerPtr{new WheelTimer(*this, cb)}; }
+
+void TimerWheel::WheelTimer::disableTimer() {
+  if (slot_ != nullptr) {
+    wheel_.unlink(*this);
+  }
+}
+
+void TimerWheel::WheelTimer::enableTimer(const std::chrono::milliseconds& d) {
+  disableTimer();
+
+  const uint64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                              wheel_.time_source_.monotonicTime() - wheel_.start_)
+                              .count();
+  const uint64_t resolution_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(wheel_.resolution_).count();
+  if (wheel_.armed_timers_ == 0) {
+    // Nothing is linked, so the wheel can skip the ticks that went by while it was idle.
+    wheel_.current_tick_ = std::max(wheel_.current_tick_, now_us / resolution_us);
+  }
+
+  // Round up to the next tick, so that the timer never fires early, and never expire in the tick
+  // that is being processed.
+  const uint64_t d_us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+  expiry_tick_ = std::max((now_us + d_us + resolution_us - 1) / resolution_us,
+                          wheel_.current_tick_ + 1);
+  wheel_.link(*this);
+  wheel_.armed_timers_++;
+  if (!wheel_.tick_timer_->enabled() || expiry_tick_ < wheel_.scheduled_tick_) {
+    wheel_.scheduleTick();
+  }
+}
+
+uint64_t TimerWheel::currentTimeTick() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time_source_.monotonicTime() -
+                                                               start_)
+             .count() /
+         resolution_.count();
+}
+
+void TimerWheel::link(WheelTimer& timer) {
+  // Pick the lowest level whose span covers the remaining ticks, and the slot of that level that
+  // cascades (or, for level 0, fires) in the tick the timer expires.
+  const uint64_t max_ticks = (1ULL << (SlotBits * Levels)) - 1;
+  const uint64_t tick = std::min(timer.expiry_tick_, current_tick_ + max_ticks);
+  const uint64_t remaining = tick - current_tick_;
+  uint32_t level = 0;
+  while (level < Levels - 1 && remaining >= (1ULL << (SlotBits * (level + 1)))) {
+    level++;
+  }
+
+  auto& slot = slots_[level][(tick >> (SlotBits * level)) & (SlotsPerLevel - 1)];
+  timer.slot_ = &slot;
+  timer.position_ = slot.insert(slot.end(), &timer);
+}
+
+void TimerWheel::unlink(WheelTimer& timer) {
+  ASSERT(armed_timers_ > 0);
+  timer.slot_->erase(timer.position_);
+  timer.slot_ = nullptr;
+  armed_timers_--;
+}
+
+void TimerWheel::cascade(uint32_t level) {
+  // Place the timers of the slot again, which moves all of them to lower levels except for those
+  // beyond the span of the wheel.
+  std::list<WheelTimer*> timers;
+  timers.swap(slots_[level][(current_tick_ >> (SlotBits * level)) & (SlotsPerLevel - 1)]);
+  for (WheelTimer* timer : timers) {
+    link(*timer);
+  }
+}
+
+void TimerWheel::advanceTick() {
+  current_tick_++;
+  for (uint32_t level = Levels - 1; level > 0; level--) {
+    if ((current_tick_ & ((1ULL << (SlotBits * level)) - 1)) == 0) {
+      cascade(level);
+    }
+  }
+
+  // Callbacks can enable and disable timers, including the ones in this slot. Timers they enable
+  // expire in a later tick, so they never land in this slot.
+  auto& slot = slots_[0][current_tick_ & (SlotsPerLevel - 1)];
+  while (!slot.empty()) {
+    WheelTimer& timer = *slot.front();
+    ASSERT(timer.expiry_tick_ == current_tick_);
+    unlink(timer);
+    timer.cb_();
+  }
+}
+
+void TimerWheel::onTick() {
+  const uint64_t time_tick = currentTimeTick();
+  while (current_tick_ < time_tick && armed_timers_ > 0) {
+    advanceTick();
+  }
+  if (armed_timers_ > 0) {
+    scheduleTick();
+  }
+}
+
+void TimerWheel::scheduleTick() {
+  // Skip to the first tick of the current rotation of level 0 that expires timers, or to the end
+  // of the rotation, where the higher levels cascade. Timers that expire in later rotations are
+  // never linked to the level 0 slots that follow the current tick.
+  const uint64_t rotation_end = (current_tick_ | (SlotsPerLevel - 1)) + 1;
+  scheduled_tick_ = current_tick_ + 1;
+  while (scheduled_tick_ < rotation_end &&
+         slots_[0][scheduled_tick_ & (SlotsPerLevel - 1)].empty()) {
+    scheduled_tick_++;
+  }
+
+  const MonotonicTime next_tick = start_ + resolution_ * static_cast<int64_t>(scheduled_tick_);
+  const MonotonicTime now = time_source_.monotonicTime();
+  std::chrono::milliseconds delay(0);
+  if (next_tick > now) {
+    // Round up so that the tick timer never fires before the tick is due.
+    const auto remaining = next_tick - now;
+    delay = std::chrono::duration_cast<std::chrono::milliseconds>(remaining);
+    if (delay < remaining) {
+      delay += std::chrono::milliseconds(1);
+    }
+  }
+  tick_timer_->enableTimer(delay);
+}
+
+} // namespace Event
+} // namespace Envoy
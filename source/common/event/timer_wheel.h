@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Hierarchical timer wheel that multiplexes many coarse timers onto a single dispatcher timer.
+ * Timers are rounded up to a multiple of the wheel's resolution, and enabling or disabling one is
+ * O(1) regardless of how many timers are armed. All timers that expire within the same tick fire
+ * from a single dispatcher event. The dispatcher timer is only armed while a wheel timer is, and
+ * only for the ticks that expire timers or cascade the higher levels.
+ *
+ * The wheel and its timers must be used from the dispatcher's thread, and the wheel must outlive
+ * its timers.
+ */
+class TimerWheel : public Scheduler {
+public:
+  TimerWheel(Dispatcher& dispatcher, std::chrono::milliseconds resolution);
+
+  // Event::Scheduler
+  TimerPtr createTimer(const TimerCb& cb) override;
+
+  /**
+   * @return uint64_t the number of armed timers.
+   */
+  uint64_t armedTimers() const { return armed_timers_; }
+
+private:
+  class WheelTimer : public Timer {
+  public:
+    WheelTimer(TimerWheel& wheel, const TimerCb& cb) : wheel_(wheel), cb_(cb) {}
+    ~WheelTimer() { disableTimer(); }
+
+    // Event::Timer
+    void disableTimer() override;
+    void enableTimer(const std::chrono::milliseconds& d) override;
+    bool enabled() override { return slot_ != nullptr; }
+
+  private:
+    friend class TimerWheel;
+
+    TimerWheel& wheel_;
+    const TimerCb cb_;
+    uint64_t expiry_tick_{};
+    // The slot this timer is linked into, nullptr when the timer is disabled.
+    std::list<WheelTimer*>* slot_{};
+    std::list<WheelTimer*>::iterator position_;
+  };
+
+  // Each level has 64 slots, so that the four levels cover 2^24 ticks. Timers beyond that are kept
+  // in the last slot of the top level and placed again when it cascades.
+  static constexpr uint32_t SlotBits = 6;
+  static constexpr uint32_t SlotsPerLevel = 1 << SlotBits;
+  static constexpr uint32_t Levels = 4;
+
+  uint64_t currentTimeTick() const;
+  void link(WheelTimer& timer);
+  void unlink(WheelTimer& timer);
+  void cascade(uint32_t level);
+  void onTick();
+  void advanceTick();
+  void scheduleTick();
+
+  TimeSource& time_source_;
+  const std::chrono::milliseconds resolution_;
+  const MonotonicTime start_;
+  TimerPtr tick_timer_;
+  // The tick the tick timer is armed for, while it is armed.
+  uint64_t scheduled_tick_{};
+  uint64_t current_tick_{};
+  uint64_t armed_timers_{};
+  std::array<std::array<std::list<WheelTimer*>, SlotsPerLevel>, Levels> slots_;
+};
+
+} // namespace Event
+} // namespace Envoy
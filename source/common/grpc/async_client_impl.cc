@@ -1,5 +1,6 @@
 #include "common/grpc/async_client_impl.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/buffer/zero_copy_input_stream_impl.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/utility.h"
@@ -177,7 +178,9 @@ void AsyncStreamImpl::onReset() {
 }
 
 void AsyncStreamImpl::sendMessage(const Protobuf::Message& request, bool end_stream) {
-  stream_->sendData(*Common::serializeBody(request), end_stream);
+  Buffer::OwnedImpl body;
+  Common::serializeToGrpcFrame(request, body);
+  stream_->sendData(body, end_stream);
 }
 
 void AsyncStreamImpl::closeStream() {
@@ -3,6 +3,7 @@
 #include "envoy/grpc/async_client.h"
 
 #include "common/common/linked_object.h"
+#include "common/common/object_pool.h"
 #include "common/grpc/codec.h"
 #include "common/http/async_client_impl.h"
 
@@ -37,7 +38,8 @@ private:
   friend class AsyncStreamImpl;
 };
 
-class AsyncStreamImpl : public AsyncStream,
+class AsyncStreamImpl : public PooledObject,
+                        public AsyncStream,
                         Http::AsyncClient::StreamCallbacks,
                         public Event::DeferredDeletable,
                         LinkedObject<AsyncStreamImpl> {
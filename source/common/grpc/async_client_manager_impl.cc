@@ -32,14 +32,25 @@ AsyncClientFactoryImpl::AsyncClientFactoryImpl(Upstream::ClusterManager& cm,
 
 AsyncClientManagerImpl::AsyncClientManagerImpl(Upstream::ClusterManager& cm,
                                                ThreadLocal::Instance& tls, TimeSource& time_source,
-                                               Api::Api& api)
+                                               Api::Api& api,
+                                               uint32_t google_grpc_completion_threads)
     : cm_(cm), tls_(tls), time_source_(time_source), api_(api) {
 #ifdef ENVOY_GOOGLE_GRPC
   google_tls_slot_ = tls.allocateSlot();
-  google_tls_slot_->set(
-      [&api](Event::Dispatcher&) { return std::make_shared<GoogleAsyncClientThreadLocal>(api); });
+  if (google_grpc_completion_threads > 0) {
+    // The silos keep the pool alive until the last of them is gone.
+    auto pool = std::make_shared<GoogleCompletionQueuePool>(api, google_grpc_completion_threads);
+    google_tls_slot_->set([pool](Event::Dispatcher& dispatcher) {
+      return std::make_shared<GoogleAsyncClientThreadLocal>(dispatcher, pool);
+    });
+  } else {
+    google_tls_slot_->set([&api](Event::Dispatcher&) {
+      return std::make_shared<GoogleAsyncClientThreadLocal>(api);
+    });
+  }
 #else
   UNREFERENCED_PARAMETER(api_);
+  UNREFERENCED_PARAMETER(google_grpc_completion_threads);
 #endif
 }
 
@@ -42,8 +42,11 @@ private:
 
 class AsyncClientManagerImpl : public AsyncClientManager {
 public:
+  // The Google gRPC clients share a pool of google_grpc_completion_threads completion queue
+  // threads if it is not 0, or have a completion thread per TLS silo otherwise.
   AsyncClientManagerImpl(Upstream::ClusterManager& cm, ThreadLocal::Instance& tls,
-                         TimeSource& time_source, Api::Api& api);
+                         TimeSource& time_source, Api::Api& api,
+                         uint32_t google_grpc_completion_threads);
 
   // Grpc::AsyncClientManager
   AsyncClientFactoryPtr factoryForGrpcService(const envoy::api::v2::core::GrpcService& config,
@@ -1,12 +1,13 @@
 #include "common/grpc/codec.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
 #include "common/buffer/buffer_impl.h"
-#include "common/common/stack_array.h"
+#include "common/common/assert.h"
 
 namespace Envoy {
 namespace Grpc {
@@ -23,80 +24,129 @@ void Encoder::newFrame(uint8_t flags, uint64_t length, std::array<uint8_t, 5>& o
 
 Decoder::Decoder() : state_(State::FH_FLAG) {}
 
+namespace {
+
+// Assembles the frames of the streaming decode() into the frames of the vector output.
+class FrameCollector : public FrameCallbacks {
+public:
+  FrameCollector(Frame& frame, std::vector<Frame>& output) : frame_(frame), output_(output) {}
+
+  // FrameCallbacks
+  void onFrameStart(uint8_t flags, uint32_t length) override {
+    frame_.flags_ = flags;
+    frame_.length_ = length;
+    if (length > 0) {
+      frame_.data_ = std::make_unique<Buffer::OwnedImpl>();
+    }
+  }
+  void onFrameData(Buffer::Instance& data) override { frame_.data_->move(data); }
+  void onFrameEnd() override {
+    output_.push_back(std::move(frame_));
+    frame_.flags_ = 0;
+    frame_.length_ = 0;
+  }
+
+private:
+  Frame& frame_;
+  std::vector<Frame>& output_;
+};
+
+} // namespace
+
 bool Decoder::decode(Buffer::Instance& input, std::vector<Frame>& output) {
-  uint64_t count = input.getRawSlices(nullptr, 0);
-  STACK_ARRAY(slices, Buffer::RawSlice, count);
-  input.getRawSlices(slices.begin(), count);
-  for (const Buffer::RawSlice& slice : slices) {
-    uint8_t* mem = reinterpret_cast<uint8_t*>(slice.mem_);
-    for (uint64_t j = 0; j < slice.len_;) {
-      uint8_t c = *mem;
-      switch (state_) {
-      case State::FH_FLAG:
-        if (c & ~GRPC_FH_COMPRESSED) {
-          // Unsupported flags.
-          return false;
-        }
-        frame_.flags_ = c;
-        state_ = State::FH_LEN_0;
-        mem++;
-        j++;
-        break;
-      case State::FH_LEN_0:
-        frame_.length_ = static_cast<uint32_t>(c) << 24;
-        state_ = State::FH_LEN_1;
-        mem++;
-        j++;
-        break;
-      case State::FH_LEN_1:
-        frame_.length_ |= static_cast<uint32_t>(c) << 16;
-        state_ = State::FH_LEN_2;
-        mem++;
-        j++;
-        break;
-      case State::FH_LEN_2:
-        frame_.length_ |= static_cast<uint32_t>(c) << 8;
-        state_ = State::FH_LEN_3;
-        mem++;
-        j++;
-        break;
-      case State::FH_LEN_3:
-        frame_.length_ |= static_cast<uint32_t>(c);
-        if (frame_.length_ == 0) {
-          output.push_back(std::move(frame_));
-          state_ = State::FH_FLAG;
-        } else {
-          frame_.data_ = std::make_unique<Buffer::OwnedImpl>();
-          state_ = State::DATA;
-        }
-        mem++;
-        j++;
-        break;
-      case State::DATA:
-        uint64_t remain_in_buffer = slice.len_ - j;
-        uint64_t remain_in_frame = frame_.length_ - frame_.data_->length();
-        if (remain_in_buffer <= remain_in_frame) {
-          frame_.data_->add(mem, remain_in_buffer);
-          mem += remain_in_buffer;
-          j += remain_in_buffer;
-        } else {
-          frame_.data_->add(mem, remain_in_frame);
-          mem += remain_in_frame;
-          j += remain_in_frame;
-        }
-        if (frame_.length_ == frame_.data_->length()) {
-          output.push_back(std::move(frame_));
-          frame_.flags_ = 0;
-          frame_.length_ = 0;
-          state_ = State::FH_FLAG;
-        }
-        break;
+  FrameCollector collector(frame_, output);
+  return decode(input, collector);
+}
+
+bool Decoder::decode(Buffer::Instance& input, FrameCallbacks& callbacks) {
+  while (input.length() > 0) {
+    if (state_ == State::DATA) {
+      decodeData(input, callbacks);
+      continue;
+    }
+
+    if (state_ == State::FH_FLAG && input.length() >= GRPC_FRAME_HEADER_SIZE) {
+      // The whole header is decoded at once unless it was split.
+      std::array<uint8_t, GRPC_FRAME_HEADER_SIZE> header;
+      input.copyOut(0, header.size(), header.data());
+      if (header[0] & ~GRPC_FH_COMPRESSED) {
+        // Unsupported flags.
+        return false;
+      }
+      input.drain(header.size());
+      flags_ = header[0];
+      length_ = static_cast<uint32_t>(header[1]) << 24 | static_cast<uint32_t>(header[2]) << 16 |
+                static_cast<uint32_t>(header[3]) << 8 | static_cast<uint32_t>(header[4]);
+      onHeaderDecoded(callbacks);
+      continue;
+    }
+
+    uint8_t c;
+    input.copyOut(0, sizeof(c), &c);
+    switch (state_) {
+    case State::FH_FLAG:
+      if (c & ~GRPC_FH_COMPRESSED) {
+        // Unsupported flags.
+        return false;
       }
+      flags_ = c;
+      state_ = State::FH_LEN_0;
+      break;
+    case State::FH_LEN_0:
+      length_ = static_cast<uint32_t>(c) << 24;
+      state_ = State::FH_LEN_1;
+      break;
+    case State::FH_LEN_1:
+      length_ |= static_cast<uint32_t>(c) << 16;
+      state_ = State::FH_LEN_2;
+      break;
+    case State::FH_LEN_2:
+      length_ |= static_cast<uint32_t>(c) << 8;
+      state_ = State::FH_LEN_3;
+      break;
+    case State::FH_LEN_3:
+      length_ |= static_cast<uint32_t>(c);
+      onHeaderDecoded(callbacks);
+      break;
+    case State::DATA:
+      NOT_REACHED_GCOVR_EXCL_LINE;
     }
+    input.drain(sizeof(c));
   }
-  input.drain(input.length());
   return true;
 }
 
+void Decoder::onHeaderDecoded(FrameCallbacks& callbacks) {
+  callbacks.onFrameStart(flags_, length_);
+  if (length_ == 0) {
+    callbacks.onFrameEnd();
+    flags_ = 0;
+    state_ = State::FH_FLAG;
+  } else {
+    remaining_ = length_;
+    state_ = State::DATA;
+  }
+}
+
+void Decoder::decodeData(Buffer::Instance& input, FrameCallbacks& callbacks) {
+  const uint64_t size = std::min<uint64_t>(input.length(), remaining_);
+  if (size == input.length()) {
+    callbacks.onFrameData(input);
+    input.drain(input.length());
+  } else {
+    // Only the slice that the payload ends in is copied.
+    Buffer::OwnedImpl data;
+    data.move(input, size);
+    callbacks.onFrameData(data);
+  }
+  remaining_ -= size;
+  if (remaining_ == 0) {
+    callbacks.onFrameEnd();
+    flags_ = 0;
+    length_ = 0;
+    state_ = State::FH_FLAG;
+  }
+}
+
 } // namespace Grpc
 } // namespace Envoy
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "envoy/buffer/buffer.h"
+#include "envoy/common/pure.h"
 
 namespace Envoy {
 namespace Grpc {
@@ -34,6 +35,26 @@ public:
   void newFrame(uint8_t flags, uint64_t length, std::array<uint8_t, 5>& output);
 };
 
+// Callbacks of the streaming Decoder::decode(), which are invoked in order for every frame.
+class FrameCallbacks {
+public:
+  virtual ~FrameCallbacks() {}
+
+  // Called once the header of a frame is decoded. A frame without payload ends right away.
+  // @param flags supplies the GRPC data frame flags.
+  // @param length supplies the GRPC data frame length.
+  virtual void onFrameStart(uint8_t flags, uint32_t length) PURE;
+
+  // Called with the next part of the payload of the current frame as soon as it is decoded. The
+  // slices of the input that hold payload only are moved to the buffer rather than copied. The
+  // data may be moved out of the buffer, and whatever is left is drained after the call.
+  // @param data supplies the payload.
+  virtual void onFrameData(Buffer::Instance& data) PURE;
+
+  // Called once all the payload of the current frame was passed to onFrameData().
+  virtual void onFrameEnd() PURE;
+};
+
 class Decoder {
 public:
   Decoder();
@@ -41,16 +62,28 @@ public:
   // Decodes the given buffer with GRPC data frame. Drains the input buffer when
   // decoding succeeded (returns true). If the input is not sufficient to make a
   // complete GRPC data frame, it will be buffered in the decoder. If a decoding
-  // error happened, the input buffer remains unchanged.
+  // error happened, the input buffer is drained up to the header of the invalid
+  // frame, and the frames before it are in output. The payload of a frame is
+  // moved out of the input without copying the slices that hold payload only.
   // @param input supplies the binary octets wrapped in a GRPC data frame.
   // @param output supplies the buffer to store the decoded data.
   // @return bool whether the decoding succeeded or not.
   bool decode(Buffer::Instance& input, std::vector<Frame>& output);
 
+  // Decodes the given buffer with GRPC data frames without buffering the payload
+  // of a frame, which is passed to the callbacks as it arrives. Drains the input
+  // buffer when decoding succeeded (returns true). If a decoding error happened,
+  // the input buffer is drained up to the header of the invalid frame. A decoder
+  // must only be used with one of the two variants of decode().
+  // @param input supplies the binary octets wrapped in a GRPC data frame.
+  // @param callbacks supplies the callbacks to pass the decoded frames to.
+  // @return bool whether the decoding succeeded or not.
+  bool decode(Buffer::Instance& input, FrameCallbacks& callbacks);
+
   // Determine the length of the current frame being decoded. This is useful when supplying a
   // partial frame to decode() and wanting to know how many more bytes need to be read to complete
   // the frame.
-  uint32_t length() const { return frame_.length_; }
+  uint32_t length() const { return length_; }
 
   // Indicates whether it has buffered any partial data.
   bool hasBufferedData() const { return state_ != State::FH_FLAG; }
@@ -88,7 +121,15 @@ private:
     DATA,
   };
 
+  void onHeaderDecoded(FrameCallbacks& callbacks);
+  void decodeData(Buffer::Instance& input, FrameCallbacks& callbacks);
+
   State state_;
+  uint8_t flags_{};
+  uint32_t length_{};
+  // The payload bytes of the current frame that are yet to be decoded.
+  uint32_t remaining_{};
+  // The frame that the vector output of decode() is assembling.
   Frame frame_;
 };
 } // namespace Grpc
@@ -7,12 +7,14 @@
 #include <string>
 
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/zero_copy_output_stream_impl.h"
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
 #include "common/common/macros.h"
 #include "common/common/utility.h"
+#include "common/grpc/codec.h"
 #include "common/http/headers.h"
 #include "common/http/message_impl.h"
 #include "common/http/utility.h"
@@ -112,25 +114,47 @@ bool Common::resolveServiceAndMethod(const Http::HeaderEntry* path, std::string*
 }
 
 Buffer::InstancePtr Common::serializeBody(const Protobuf::Message& message) {
-  // http://www.grpc.io/docs/guides/wire.html
-  // Reserve enough space for the entire message and the 5 byte header.
   Buffer::InstancePtr body(new Buffer::OwnedImpl());
+  serializeToGrpcFrame(message, *body);
+  return body;
+}
+
+void Common::serializeToGrpcFrame(const Protobuf::Message& message, Buffer::Instance& output) {
+  // http://www.grpc.io/docs/guides/wire.html
   const uint32_t size = message.ByteSize();
-  const uint32_t alloc_size = size + 5;
-  Buffer::RawSlice iovec;
-  body->reserve(alloc_size, &iovec, 1);
-  ASSERT(iovec.len_ >= alloc_size);
-  iovec.len_ = alloc_size;
-  uint8_t* current = reinterpret_cast<uint8_t*>(iovec.mem_);
-  *current++ = 0; // flags
+  uint8_t header[GRPC_FRAME_HEADER_SIZE];
+  header[0] = 0; // flags
   const uint32_t nsize = htonl(size);
-  std::memcpy(current, reinterpret_cast<const void*>(&nsize), sizeof(uint32_t));
-  current += sizeof(uint32_t);
-  Protobuf::io::ArrayOutputStream stream(current, size, -1);
-  Protobuf::io::CodedOutputStream codec_stream(&stream);
-  message.SerializeWithCachedSizes(&codec_stream);
-  body->commit(&iovec, 1);
-  return body;
+  std::memcpy(&header[1], reinterpret_cast<const void*>(&nsize), sizeof(uint32_t));
+
+  if (size + GRPC_FRAME_HEADER_SIZE <= Buffer::ZeroCopyOutputStreamImpl::DefaultBlockSize) {
+    // Reserve enough space for the entire message and the 5 byte header, so that small messages
+    // end up in a single slice.
+    const uint32_t alloc_size = size + GRPC_FRAME_HEADER_SIZE;
+    Buffer::RawSlice iovec;
+    output.reserve(alloc_size, &iovec, 1);
+    ASSERT(iovec.len_ >= alloc_size);
+    iovec.len_ = alloc_size;
+    uint8_t* current = reinterpret_cast<uint8_t*>(iovec.mem_);
+    std::memcpy(current, header, GRPC_FRAME_HEADER_SIZE);
+    current += GRPC_FRAME_HEADER_SIZE;
+    Protobuf::io::ArrayOutputStream stream(current, size, -1);
+    Protobuf::io::CodedOutputStream codec_stream(&stream);
+    message.SerializeWithCachedSizes(&codec_stream);
+    output.commit(&iovec, 1);
+    return;
+  }
+
+  // Larger messages are serialized block by block into reserved slices instead of into one
+  // contiguous allocation of their full size.
+  output.add(header, GRPC_FRAME_HEADER_SIZE);
+  Buffer::ZeroCopyOutputStreamImpl stream(output);
+  {
+    Protobuf::io::CodedOutputStream codec_stream(&stream);
+    message.SerializeWithCachedSizes(&codec_stream);
+  }
+  stream.finish();
+  ASSERT(static_cast<uint64_t>(stream.ByteCount()) == size);
 }
 
 std::chrono::milliseconds Common::getGrpcTimeout(Http::HeaderMap& request_headers) {
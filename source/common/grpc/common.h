@@ -123,6 +123,13 @@ public:
    */
   static Buffer::InstancePtr serializeBody(const Protobuf::Message& message);
 
+  /**
+   * Serialize a protobuf message as a gRPC frame directly into the space at the end of a buffer.
+   * @param message supplies the message to serialize.
+   * @param output supplies the buffer to append the frame to.
+   */
+  static void serializeToGrpcFrame(const Protobuf::Message& message, Buffer::Instance& output);
+
   /**
    * Prepare headers for protobuf service.
    */
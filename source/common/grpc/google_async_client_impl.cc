@@ -13,10 +13,48 @@
 namespace Envoy {
 namespace Grpc {
 
+GoogleCompletionQueuePool::GoogleCompletionQueuePool(Api::Api& api, uint32_t num_threads) {
+  ASSERT(num_threads > 0);
+  for (uint32_t i = 0; i < num_threads; i++) {
+    queues_.emplace_back(std::make_unique<Queue>());
+    Queue& queue = *queues_.back();
+    queue.thread_ = api.threadFactory().createThread(
+        [&queue] { GoogleAsyncClientThreadLocal::runCompletionQueue(queue.cq_); });
+  }
+}
+
+GoogleCompletionQueuePool::~GoogleCompletionQueuePool() {
+  // The pool is only destroyed once all the TLS silos that use it are gone, which drained their
+  // streams, so there are no operations left in flight.
+  for (auto& queue : queues_) {
+    queue->cq_.Shutdown();
+  }
+  ENVOY_LOG(debug, "Joining {} completion queue pool threads", queues_.size());
+  for (auto& queue : queues_) {
+    queue->thread_->join();
+  }
+}
+
+grpc::CompletionQueue& GoogleCompletionQueuePool::nextCompletionQueue() {
+  return queues_[next_queue_++ % queues_.size()]->cq_;
+}
+
 GoogleAsyncClientThreadLocal::GoogleAsyncClientThreadLocal(Api::Api& api)
-    : completion_thread_(api.threadFactory().createThread([this] { completionThread(); })) {}
+    : cq_(std::make_unique<grpc::CompletionQueue>()),
+      completion_thread_(api.threadFactory().createThread([this] { runCompletionQueue(*cq_); })),
+      completion_queue_(cq_.get()) {}
+
+GoogleAsyncClientThreadLocal::GoogleAsyncClientThreadLocal(
+    Event::Dispatcher& dispatcher, GoogleCompletionQueuePoolSharedPtr pool)
+    : pool_(std::move(pool)), dispatcher_(&dispatcher),
+      completed_ops_(std::make_shared<CompletedOps>()),
+      completion_queue_(&pool_->nextCompletionQueue()) {}
 
 GoogleAsyncClientThreadLocal::~GoogleAsyncClientThreadLocal() {
+  if (pool_ != nullptr) {
+    Thread::LockGuard lock(completed_ops_->lock_);
+    completed_ops_->draining_ = true;
+  }
   // Force streams to shutdown and invoke TryCancel() to start the drain of
   // pending op. If we don't do this, Shutdown() below can jam on pending ops.
   // This is also required to satisfy the contract that once Shutdown is called,
@@ -27,7 +65,25 @@ GoogleAsyncClientThreadLocal::~GoogleAsyncClientThreadLocal() {
     // we point to the next one first.
     (*it++)->resetStream();
   }
-  cq_.Shutdown();
+
+  if (pool_ != nullptr) {
+    // The shared completion queue outlives the silo, so wait here for the completions of the
+    // cancelled operations, including those that were already posted to the dispatcher.
+    while (!streams_.empty()) {
+      std::vector<CompletedOp> ops;
+      {
+        Thread::LockGuard lock(completed_ops_->lock_);
+        while (completed_ops_->ops_.empty()) {
+          completed_ops_->draining_cv_.wait(completed_ops_->lock_);
+        }
+        ops.swap(completed_ops_->ops_);
+      }
+      handleCompletedOps(ops);
+    }
+    return;
+  }
+
+  cq_->Shutdown();
   ENVOY_LOG(debug, "Joining completionThread");
   completion_thread_->join();
   ENVOY_LOG(debug, "Joined completionThread");
@@ -37,33 +93,67 @@ GoogleAsyncClientThreadLocal::~GoogleAsyncClientThreadLocal() {
   }
 }
 
-void GoogleAsyncClientThreadLocal::completionThread() {
+void GoogleAsyncClientThreadLocal::runCompletionQueue(grpc::CompletionQueue& cq) {
   ENVOY_LOG(debug, "completionThread running");
   void* tag;
   bool ok;
-  while (cq_.Next(&tag, &ok)) {
+  while (cq.Next(&tag, &ok)) {
     const auto& google_async_tag = *reinterpret_cast<GoogleAsyncTag*>(tag);
     const GoogleAsyncTag::Operation op = google_async_tag.op_;
     GoogleAsyncStreamImpl& stream = google_async_tag.stream_;
     ENVOY_LOG(trace, "completionThread CQ event {} {}", op, ok);
-    Thread::LockGuard lock(stream.completed_ops_lock_);
-
-    // It's an invariant that there must only be one pending post for arbitrary
-    // length completed_ops_, otherwise we can race in stream destruction, where
-    // we process multiple events in onCompletedOps() but have only partially
-    // consumed the posts on the dispatcher.
-    // TODO(htuch): This may result in unbounded processing on the silo thread
-    // in onCompletedOps() in extreme cases, when we emplace_back() in
-    // completionThread() at a high rate, consider bounding the length of such
-    // sequences if this behavior becomes an issue.
-    if (stream.completed_ops_.empty()) {
-      stream.dispatcher_.post([&stream] { stream.onCompletedOps(); });
-    }
-    stream.completed_ops_.emplace_back(op, ok);
+    stream.tls_.onCompletedOp(stream, op, ok);
   }
   ENVOY_LOG(debug, "completionThread exiting");
 }
 
+void GoogleAsyncClientThreadLocal::onCompletedOp(GoogleAsyncStreamImpl& stream,
+                                                 GoogleAsyncTag::Operation op, bool ok) {
+  if (pool_ != nullptr) {
+    // A single post delivers all the completions of the silo that arrive before it runs, across
+    // all its streams.
+    Thread::LockGuard lock(completed_ops_->lock_);
+    if (completed_ops_->draining_) {
+      completed_ops_->draining_cv_.notifyOne();
+    } else if (completed_ops_->ops_.empty()) {
+      std::shared_ptr<CompletedOps> completed_ops = completed_ops_;
+      dispatcher_->post([completed_ops] {
+        std::vector<CompletedOp> ops;
+        {
+          Thread::LockGuard lock(completed_ops->lock_);
+          ops.swap(completed_ops->ops_);
+        }
+        handleCompletedOps(ops);
+      });
+    }
+    completed_ops_->ops_.push_back({&stream, op, ok});
+    return;
+  }
+
+  Thread::LockGuard lock(stream.completed_ops_lock_);
+
+  // It's an invariant that there must only be one pending post for arbitrary
+  // length completed_ops_, otherwise we can race in stream destruction, where
+  // we process multiple events in onCompletedOps() but have only partially
+  // consumed the posts on the dispatcher.
+  // TODO(htuch): This may result in unbounded processing on the silo thread
+  // in onCompletedOps() in extreme cases, when we emplace_back() in
+  // completionThread() at a high rate, consider bounding the length of such
+  // sequences if this behavior becomes an issue.
+  if (stream.completed_ops_.empty()) {
+    stream.dispatcher_.post([&stream] { stream.onCompletedOps(); });
+  }
+  stream.completed_ops_.emplace_back(op, ok);
+}
+
+void GoogleAsyncClientThreadLocal::handleCompletedOps(std::vector<CompletedOp>& ops) {
+  // A stream is only deleted once all its operations completed, so none of the streams can be
+  // deleted before its last completion in the batch is handled.
+  for (const CompletedOp& completed_op : ops) {
+    completed_op.stream_->handleOpCompletion(completed_op.op_, completed_op.ok_);
+  }
+}
+
 GoogleAsyncClientImpl::GoogleAsyncClientImpl(Event::Dispatcher& dispatcher,
                                              GoogleAsyncClientThreadLocal& tls,
                                              GoogleStubFactory& stub_factory,
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <queue>
+#include <vector>
 
 #include "envoy/api/api.h"
+#include "envoy/event/dispatcher.h"
 #include "envoy/grpc/async_client.h"
 #include "envoy/stats/scope.h"
 #include "envoy/thread/thread.h"
@@ -61,13 +64,51 @@ struct GoogleAsyncTag {
   }
 };
 
+/**
+ * A fixed set of completion queues, each with a thread blocking on it, that is shared by the
+ * Google gRPC clients of all the TLS silos instead of a completion thread per silo. Each silo is
+ * assigned one of the queues round robin, and the completions of its operations are handed to its
+ * dispatcher in batches, which bounds the number of threads regardless of the number of workers
+ * and coalesces the cross-thread wakeups of concurrent completions.
+ */
+class GoogleCompletionQueuePool : Logger::Loggable<Logger::Id::grpc> {
+public:
+  GoogleCompletionQueuePool(Api::Api& api, uint32_t num_threads);
+  ~GoogleCompletionQueuePool();
+
+  /**
+   * @return grpc::CompletionQueue& the queue for the next TLS silo, picked round robin.
+   */
+  grpc::CompletionQueue& nextCompletionQueue();
+
+  /**
+   * @return size_t the number of completion queues and threads.
+   */
+  size_t size() const { return queues_.size(); }
+
+private:
+  struct Queue {
+    grpc::CompletionQueue cq_;
+    Thread::ThreadPtr thread_;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::atomic<uint32_t> next_queue_{};
+};
+
+typedef std::shared_ptr<GoogleCompletionQueuePool> GoogleCompletionQueuePoolSharedPtr;
+
 class GoogleAsyncClientThreadLocal : public ThreadLocal::ThreadLocalObject,
                                      Logger::Loggable<Logger::Id::grpc> {
 public:
+  // Runs a dedicated completion thread for the silo.
   GoogleAsyncClientThreadLocal(Api::Api& api);
+  // Uses a completion queue of a shared pool, which delivers the completions to dispatcher.
+  GoogleAsyncClientThreadLocal(Event::Dispatcher& dispatcher,
+                               GoogleCompletionQueuePoolSharedPtr pool);
   ~GoogleAsyncClientThreadLocal();
 
-  grpc::CompletionQueue& completionQueue() { return cq_; }
+  grpc::CompletionQueue& completionQueue() { return *completion_queue_; }
 
   void registerStream(GoogleAsyncStreamImpl* stream) {
     ASSERT(streams_.find(stream) == streams_.end());
@@ -80,22 +121,49 @@ public:
     streams_.erase(it);
   }
 
+  // Block on cq until it is shut down, handing each completion to the TLS silo of its stream.
+  static void runCompletionQueue(grpc::CompletionQueue& cq);
+
 private:
-  void completionThread();
+  struct CompletedOp {
+    GoogleAsyncStreamImpl* stream_;
+    GoogleAsyncTag::Operation op_;
+    bool ok_;
+  };
+
+  // The completions of a silo that uses a shared pool, which have not been handled yet. This is
+  // shared with the callbacks posted to the dispatcher, so that a callback that runs after the
+  // silo is gone finds nothing to do.
+  struct CompletedOps {
+    Thread::MutexBasicLockable lock_;
+    std::vector<CompletedOp> ops_ GUARDED_BY(lock_);
+    // Set while the silo is shutting down, when completions are handled by the destructor
+    // instead of being posted to the dispatcher.
+    bool draining_ GUARDED_BY(lock_){};
+    Thread::CondVar draining_cv_;
+  };
+
+  void onCompletedOp(GoogleAsyncStreamImpl& stream, GoogleAsyncTag::Operation op, bool ok);
+  static void handleCompletedOps(std::vector<CompletedOp>& ops);
 
-  // The CompletionQueue for in-flight operations. This must precede completion_thread_ to ensure it
-  // is constructed before the thread runs.
-  grpc::CompletionQueue cq_;
   // The threading model for the Google gRPC C++ library is not directly compatible with Envoy's
   // siloed model. We resolve this by issuing non-blocking asynchronous
   // operations on the GoogleAsyncClientImpl silo thread, and then synchronously
-  // blocking on a completion queue, cq_, on a distinct thread. When cq_ events
+  // blocking on a completion queue on a distinct thread. When completion queue events
   // are delivered, we cross-post to the silo dispatcher to continue the
   // operation.
   //
-  // We have an independent completion thread for each TLS silo (i.e. one per worker and
-  // also one for the main thread).
+  // By default, we have an independent completion queue and thread for each TLS silo (i.e. one per
+  // worker and also one for the main thread). The completion queue must precede
+  // completion_thread_ to ensure it is constructed before the thread runs.
+  std::unique_ptr<grpc::CompletionQueue> cq_;
   Thread::ThreadPtr completion_thread_;
+  // Alternatively, the silo uses one of the completion queues of a shared pool.
+  GoogleCompletionQueuePoolSharedPtr pool_;
+  Event::Dispatcher* dispatcher_{};
+  std::shared_ptr<CompletedOps> completed_ops_;
+  // The completion queue for in-flight operations, either cq_ or one of the pool.
+  grpc::CompletionQueue* completion_queue_;
   // Track all streams that are currently using this CQ, so we can notify them
   // on shutdown.
   std::unordered_set<GoogleAsyncStreamImpl*> streams_;
@@ -216,7 +284,8 @@ private:
   // GoogleAsyncClient silo thread.
   void onCompletedOps();
   // Handle Operation completion on GoogleAsyncClient silo thread. This is posted by
-  // GoogleAsyncClientThreadLocal::completionThread() when a message is received on cq_.
+  // GoogleAsyncClientThreadLocal::runCompletionQueue() when a message is received on the
+  // completion queue.
   void handleOpCompletion(GoogleAsyncTag::Operation op, bool ok);
   // Convert from Google gRPC client std::multimap metadata to Envoy Http::HeaderMap.
   void metadataTranslate(const std::multimap<grpc::string_ref, grpc::string_ref>& grpc_metadata,
@@ -262,9 +331,9 @@ private:
 
   GoogleAsyncClientImpl& parent_;
   GoogleAsyncClientThreadLocal& tls_;
-  // Latch our own version of this reference, so that completionThread() doesn't
+  // Latch our own version of this reference, so that runCompletionQueue() doesn't
   // try and access via parent_, which might not exist in teardown. We assume
-  // that the dispatcher lives longer than completionThread() life, which should
+  // that the dispatcher lives longer than runCompletionQueue() life, which should
   // hold for the expected server object lifetimes.
   Event::Dispatcher& dispatcher_;
   // We hold a ref count on the stub_ to allow the stream to wait for its tags
@@ -292,8 +361,8 @@ private:
   // Count of the tags in-flight. This must hit zero before the stream can be
   // freed.
   uint32_t inflight_tags_{};
-  // Queue of completed (op, ok) passed from completionThread() to
-  // handleOpCompletion().
+  // Queue of completed (op, ok) passed from the completion thread of the TLS silo to
+  // handleOpCompletion(). Unused when the silo uses a shared completion queue pool.
   std::deque<std::pair<GoogleAsyncTag::Operation, bool>>
       completed_ops_ GUARDED_BY(completed_ops_lock_);
   Thread::MutexBasicLockable completed_ops_lock_;
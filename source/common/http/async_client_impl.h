@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
@@ -27,6 +28,7 @@
 
 #include "common/common/empty_string.h"
 #include "common/common/linked_object.h"
+#include "common/common/object_pool.h"
 #include "common/http/message_impl.h"
 #include "common/router/router.h"
 #include "common/stream_info/stream_info_impl.h"
@@ -69,7 +71,8 @@ private:
  * Implementation of AsyncRequest. This implementation is capable of sending HTTP requests to a
  * ConnectionPool asynchronously.
  */
-class AsyncStreamImpl : public AsyncClient::Stream,
+class AsyncStreamImpl : public PooledObject,
+                        public AsyncClient::Stream,
                         public StreamDecoderFilterCallbacks,
                         public Event::DeferredDeletable,
                         Logger::Loggable<Logger::Id::http>,
@@ -93,9 +96,11 @@ private:
   struct NullCorsPolicy : public Router::CorsPolicy {
     // Router::CorsPolicy
     const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-    const std::list<std::regex>& allowOriginRegexes() const override {
+    const std::vector<Regex::CompiledMatcherPtr>& allowOriginRegexes() const override {
       return allow_origin_regex_;
     };
+    bool allowsOrigin(absl::string_view) const override { return false; };
+    bool allowsOriginRegex(absl::string_view) const override { return false; };
     const std::string& allowMethods() const override { return EMPTY_STRING; };
     const std::string& allowHeaders() const override { return EMPTY_STRING; };
     const std::string& exposeHeaders() const override { return EMPTY_STRING; };
@@ -105,7 +110,7 @@ private:
     bool shadowEnabled() const override { return false; };
 
     static const std::list<std::string> allow_origin_;
-    static const std::list<std::regex> allow_origin_regex_;
+    static const std::vector<Regex::CompiledMatcherPtr> allow_origin_regex_;
     static const absl::optional<bool> allow_credentials_;
   };
 
@@ -116,6 +121,11 @@ private:
       return additional_request_chance_;
     }
     bool hedgeOnPerTryTimeout() const override { return false; }
+    bool hedgeOnLatency() const override { return false; }
+    std::chrono::milliseconds latencyHedgeMinDelay() const override {
+      return std::chrono::milliseconds(0);
+    }
+    double latencyHedgeBudgetPercent() const override { return 0; }
 
     const envoy::type::FractionalPercent additional_request_chance_;
   };
@@ -157,6 +167,7 @@ private:
     const std::string& cluster() const override { return EMPTY_STRING; }
     const std::string& runtimeKey() const override { return EMPTY_STRING; }
     const envoy::type::FractionalPercent& defaultValue() const override { return default_value_; }
+    bool streaming() const override { return false; }
 
   private:
     envoy::type::FractionalPercent default_value_;
@@ -218,6 +229,9 @@ private:
     }
     const Router::RateLimitPolicy& rateLimitPolicy() const override { return rate_limit_policy_; }
     const Router::RetryPolicy& retryPolicy() const override { return retry_policy_; }
+    uint32_t retryShadowBufferLimit() const override {
+      return std::numeric_limits<uint32_t>::max();
+    }
     const Router::ShadowPolicy& shadowPolicy() const override { return shadow_policy_; }
     std::chrono::milliseconds timeout() const override {
       if (timeout_) {
@@ -283,6 +297,7 @@ private:
     const Router::RouteSpecificFilterConfig* perFilterConfig(const std::string&) const override {
       return nullptr;
     }
+    bool cacheable() const override { return false; }
 
     RouteEntryImpl route_entry_;
   };
@@ -83,6 +83,11 @@ public:
    */
   absl::string_view connectionFailureReason() { return connection_->transportFailureReason(); }
 
+  /**
+   * @return the stream info of the underlying connection.
+   */
+  const StreamInfo::StreamInfo& streamInfo() { return connection_->streamInfo(); }
+
   /**
    * @return size_t the number of outstanding requests that have not completed or been reset.
    */
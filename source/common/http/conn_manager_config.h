@@ -1,12 +1,19 @@
 #pragma once
 
+#include <chrono>
+#include <vector>
+
 #include "envoy/http/filter.h"
 #include "envoy/router/rds.h"
 #include "envoy/stats/scope.h"
 
 #include "common/http/date_provider.h"
+#include "common/http/header_utility.h"
+#include "common/http/route_cache.h"
 #include "common/network/utility.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Http {
 
@@ -39,6 +46,8 @@ namespace Http {
   GAUGE    (downstream_cx_tx_bytes_buffered)                                                       \
   COUNTER  (downstream_cx_drain_close)                                                             \
   COUNTER  (downstream_cx_idle_timeout)                                                            \
+  COUNTER  (downstream_cx_idle_compaction)                                                         \
+  GAUGE    (downstream_cx_idle_compacted_active)                                                   \
   COUNTER  (downstream_cx_overload_disable_keepalive)                                              \
   COUNTER  (downstream_cx_delayed_close_timeout)                                                   \
   COUNTER  (downstream_flow_control_paused_reading_total)                                          \
@@ -62,8 +71,11 @@ namespace Http {
   HISTOGRAM(downstream_rq_time)                                                                    \
   COUNTER  (downstream_rq_idle_timeout)                                                            \
   COUNTER  (downstream_rq_overload_close)                                                          \
+  COUNTER  (downstream_rq_overload_refused_stream)                                                 \
   COUNTER  (downstream_rq_timeout)                                                            \
-  COUNTER  (rs_too_large)
+  COUNTER  (rs_too_large)                                                                          \
+  COUNTER  (route_cache_hit)                                                                       \
+  COUNTER  (route_cache_miss)
 // clang-format on
 
 /**
@@ -88,7 +100,8 @@ struct ConnectionManagerStats {
   COUNTER(service_forced)                                                                          \
   COUNTER(client_enabled)                                                                          \
   COUNTER(not_traceable)                                                                           \
-  COUNTER(health_check)
+  COUNTER(health_check)                                                                            \
+  COUNTER(tail_sampled)
 // clang-format on
 
 /**
@@ -98,6 +111,16 @@ struct ConnectionManagerTracingStats {
   CONN_MAN_TRACING_STATS(GENERATE_COUNTER_STRUCT)
 };
 
+/**
+ * Rules keeping the spans of the requests that were not sampled when they started, evaluated once
+ * the requests have ended. A request is kept if it matches any of the rules.
+ */
+struct TracingTailSamplingConfig {
+  absl::optional<std::chrono::milliseconds> latency_threshold_;
+  bool errors_;
+  std::vector<HeaderUtility::HeaderData> request_headers_;
+};
+
 /**
  * Configuration for tracing which is set on the connection manager level.
  * Http Tracing can be enabled/disabled on a per connection manager basis.
@@ -110,6 +133,7 @@ struct TracingConnectionManagerConfig {
   uint64_t random_sampling_;
   uint64_t overall_sampling_;
   bool verbose_;
+  absl::optional<TracingTailSamplingConfig> tail_sampling_;
 };
 
 typedef std::unique_ptr<TracingConnectionManagerConfig> TracingConnectionManagerConfigPtr;
@@ -223,6 +247,11 @@ public:
    */
   virtual absl::optional<std::chrono::milliseconds> idleTimeout() const PURE;
 
+  /**
+   * @return optional time after which the codec of an idle HTTP/1 connection is released.
+   */
+  virtual absl::optional<std::chrono::milliseconds> idleCompactionTimeout() const PURE;
+
   /**
    * @return maximum request headers size the connection manager will accept.
    */
@@ -340,6 +369,12 @@ public:
    * @return supplies the http1 settings.
    */
   virtual const Http::Http1Settings& http1Settings() const PURE;
+
+  /**
+   * @return RouteCache* the route cache of the calling worker thread, or nullptr if route caching
+   *         is disabled.
+   */
+  virtual RouteCache* routeCache() PURE;
 };
 } // namespace Http
 } // namespace Envoy
@@ -108,6 +108,11 @@ ConnectionManagerImpl::ConnectionManagerImpl(ConnectionManagerConfig& config,
           overload_manager ? overload_manager->getThreadLocalOverloadState().getState(
                                  Server::OverloadActionNames::get().DisableHttpKeepAlive)
                            : Server::OverloadManager::getInactiveState()),
+      overload_reduce_http2_max_concurrent_streams_ref_(
+          overload_manager
+              ? overload_manager->getThreadLocalOverloadState().getState(
+                    Server::OverloadActionNames::get().ReduceHttp2MaxConcurrentStreams)
+              : Server::OverloadManager::getInactiveState()),
       time_source_(time_source) {}
 
 const HeaderMapImpl& ConnectionManagerImpl::continueHeader() {
@@ -127,11 +132,17 @@ void ConnectionManagerImpl::initializeReadFilterCallbacks(Network::ReadFilterCal
   read_callbacks_->connection().addConnectionCallbacks(*this);
 
   if (config_.idleTimeout()) {
-    connection_idle_timer_ = read_callbacks_->connection().dispatcher().createTimer(
+    connection_idle_timer_ = read_callbacks_->connection().dispatcher().createCoarseTimer(
         [this]() -> void { onIdleTimeout(); });
     connection_idle_timer_->enableTimer(config_.idleTimeout().value());
   }
 
+  if (config_.idleCompactionTimeout()) {
+    connection_compaction_timer_ = read_callbacks_->connection().dispatcher().createCoarseTimer(
+        [this]() -> void { onIdleCompactionTimeout(); });
+    connection_compaction_timer_->enableTimer(config_.idleCompactionTimeout().value());
+  }
+
   read_callbacks_->connection().setDelayedCloseTimeout(config_.delayedCloseTimeout());
 
   read_callbacks_->connection().setConnectionStats(
@@ -147,12 +158,13 @@ ConnectionManagerImpl::~ConnectionManagerImpl() {
     stats_.named_.downstream_cx_ssl_active_.dec();
   }
 
-  if (codec_) {
-    if (codec_->protocol() == Protocol::Http2) {
-      stats_.named_.downstream_cx_http2_active_.dec();
-    } else {
-      stats_.named_.downstream_cx_http1_active_.dec();
-    }
+  if (codec_ && codec_->protocol() == Protocol::Http2) {
+    stats_.named_.downstream_cx_http2_active_.dec();
+  } else if (codec_ || codec_released_) {
+    stats_.named_.downstream_cx_http1_active_.dec();
+  }
+  if (codec_released_) {
+    stats_.named_.downstream_cx_idle_compacted_active_.dec();
   }
 
   conn_length_->complete();
@@ -208,6 +220,10 @@ void ConnectionManagerImpl::doEndStream(ActiveStream& stream) {
   if (connection_idle_timer_ && streams_.empty()) {
     connection_idle_timer_->enableTimer(config_.idleTimeout().value());
   }
+
+  if (connection_compaction_timer_ && streams_.empty()) {
+    connection_compaction_timer_->enableTimer(config_.idleCompactionTimeout().value());
+  }
 }
 
 void ConnectionManagerImpl::doDeferredStreamDestroy(ActiveStream& stream) {
@@ -238,6 +254,10 @@ StreamDecoder& ConnectionManagerImpl::newStream(StreamEncoder& response_encoder,
     connection_idle_timer_->disableTimer();
   }
 
+  if (connection_compaction_timer_) {
+    connection_compaction_timer_->disableTimer();
+  }
+
   ENVOY_CONN_LOG(debug, "new stream", read_callbacks_->connection());
   ActiveStreamPtr new_stream(new ActiveStream(*this));
   new_stream->state_.is_internally_created_ = is_internally_created;
@@ -255,7 +275,17 @@ StreamDecoder& ConnectionManagerImpl::newStream(StreamEncoder& response_encoder,
 Network::FilterStatus ConnectionManagerImpl::onData(Buffer::Instance& data, bool) {
   if (!codec_) {
     codec_ = config_.createCodec(read_callbacks_->connection(), data, *this);
-    if (codec_->protocol() == Protocol::Http2) {
+    if (codec_released_) {
+      // The connection already counts as an HTTP/1 connection, unless the peer has switched to the
+      // HTTP/2 preface in the meantime.
+      codec_released_ = false;
+      stats_.named_.downstream_cx_idle_compacted_active_.dec();
+      if (codec_->protocol() == Protocol::Http2) {
+        stats_.named_.downstream_cx_http1_active_.dec();
+        stats_.named_.downstream_cx_http2_total_.inc();
+        stats_.named_.downstream_cx_http2_active_.inc();
+      }
+    } else if (codec_->protocol() == Protocol::Http2) {
       stats_.named_.downstream_cx_http2_total_.inc();
       stats_.named_.downstream_cx_http2_active_.inc();
     } else {
@@ -267,6 +297,7 @@ Network::FilterStatus ConnectionManagerImpl::onData(Buffer::Instance& data, bool
   bool redispatch;
   do {
     redispatch = false;
+    const uint64_t length_before_dispatch = data.length();
 
     try {
       codec_->dispatch(data);
@@ -291,14 +322,20 @@ Network::FilterStatus ConnectionManagerImpl::onData(Buffer::Instance& data, bool
     // The HTTP/1 codec will pause dispatch after a single message is complete. We want to
     // either redispatch if there are no streams and we have more data. If we have a single
     // complete non-WebSocket stream but have not responded yet we will pause socket reads
-    // to apply back pressure.
+    // to apply back pressure. When requests may be pipelined, we keep dispatching until as many
+    // streams as may be pipelined are in flight, unless the connection is draining, and pause
+    // socket reads when they are complete, or when data is left that we do not dispatch.
     if (codec_->protocol() != Protocol::Http2) {
+      const uint32_t max_pipelined_requests = config_.http1Settings().max_pipelined_requests_;
       if (read_callbacks_->connection().state() == Network::Connection::State::Open &&
-          data.length() > 0 && streams_.empty()) {
+          data.length() > 0 && data.length() < length_before_dispatch &&
+          (streams_.empty() || (drain_state_ == DrainState::NotDraining &&
+                                streams_.size() < max_pipelined_requests))) {
         redispatch = true;
       }
 
-      if (!streams_.empty() && streams_.front()->state_.remote_complete_) {
+      if (!streams_.empty() && streams_.front()->state_.remote_complete_ &&
+          (streams_.size() >= max_pipelined_requests || (data.length() > 0 && !redispatch))) {
         read_callbacks_->connection().readDisable(true);
       }
     }
@@ -330,6 +367,11 @@ void ConnectionManagerImpl::onEvent(Network::ConnectionEvent event) {
       connection_idle_timer_.reset();
     }
 
+    if (connection_compaction_timer_) {
+      connection_compaction_timer_->disableTimer();
+      connection_compaction_timer_.reset();
+    }
+
     if (drain_timer_) {
       drain_timer_->disableTimer();
       drain_timer_.reset();
@@ -367,6 +409,24 @@ void ConnectionManagerImpl::onIdleTimeout() {
   }
 }
 
+void ConnectionManagerImpl::onIdleCompactionTimeout() {
+  // Between requests the HTTP/1 codec holds no state that outlives a request, but its parser and
+  // output buffer keep the memory of the largest request seen. The codec is only released while
+  // nothing is buffered towards the peer, so that no watermark callback is pending on it. HTTP/2
+  // codecs hold connection level HPACK and flow control state and are kept.
+  if (!codec_ || !streams_.empty() || drain_state_ != DrainState::NotDraining ||
+      codec_->protocol() == Protocol::Http2 || codec_->wantsToWrite() ||
+      read_callbacks_->connection().aboveHighWatermark()) {
+    return;
+  }
+
+  ENVOY_CONN_LOG(debug, "idle compaction", read_callbacks_->connection());
+  stats_.named_.downstream_cx_idle_compaction_.inc();
+  stats_.named_.downstream_cx_idle_compacted_active_.inc();
+  codec_.reset();
+  codec_released_ = true;
+}
+
 void ConnectionManagerImpl::onDrainTimeout() {
   ASSERT(drain_state_ != DrainState::NotDraining);
   codec_->goAway();
@@ -424,15 +484,17 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
 
   if (connection_manager_.config_.streamIdleTimeout().count()) {
     idle_timeout_ms_ = connection_manager_.config_.streamIdleTimeout();
-    stream_idle_timer_ = connection_manager_.read_callbacks_->connection().dispatcher().createTimer(
-        [this]() -> void { onIdleTimeout(); });
+    stream_idle_timer_ =
+        connection_manager_.read_callbacks_->connection().dispatcher().createCoarseTimer(
+            [this]() -> void { onIdleTimeout(); });
     resetIdleTimer();
   }
 
   if (connection_manager_.config_.requestTimeout().count()) {
     std::chrono::milliseconds request_timeout_ms_ = connection_manager_.config_.requestTimeout();
-    request_timer_ = connection_manager.read_callbacks_->connection().dispatcher().createTimer(
-        [this]() -> void { onRequestTimeout(); });
+    request_timer_ =
+        connection_manager.read_callbacks_->connection().dispatcher().createCoarseTimer(
+            [this]() -> void { onRequestTimeout(); });
     request_timer_->enableTimer(request_timeout_ms_);
   }
 
@@ -464,6 +526,13 @@ ConnectionManagerImpl::ActiveStream::~ActiveStream() {
   }
 
   if (active_span_) {
+    if (tail_sampling_ &&
+        ConnectionManagerUtility::isTailSampled(
+            connection_manager_.config_.tracingConfig()->tail_sampling_.value(),
+            request_headers_.get(), stream_info_)) {
+      connection_manager_.config_.tracingStats().tail_sampled_.inc();
+      active_span_->setSampled(true);
+    }
     Tracing::HttpTracerUtility::finalizeSpan(*active_span_, request_headers_.get(), stream_info_,
                                              *this);
   }
@@ -508,6 +577,7 @@ void ConnectionManagerImpl::ActiveStream::onRequestTimeout() {
 void ConnectionManagerImpl::ActiveStream::addStreamDecoderFilterWorker(
     StreamDecoderFilterSharedPtr filter, bool dual_filter) {
   ActiveStreamDecoderFilterPtr wrapper(new ActiveStreamDecoderFilter(*this, filter, dual_filter));
+  wrapper->timing_stats_ = filter_timing_stats_;
   filter->setDecoderFilterCallbacks(*wrapper);
   wrapper->moveIntoListBack(std::move(wrapper), decoder_filters_);
 }
@@ -515,6 +585,7 @@ void ConnectionManagerImpl::ActiveStream::addStreamDecoderFilterWorker(
 void ConnectionManagerImpl::ActiveStream::addStreamEncoderFilterWorker(
     StreamEncoderFilterSharedPtr filter, bool dual_filter) {
   ActiveStreamEncoderFilterPtr wrapper(new ActiveStreamEncoderFilter(*this, filter, dual_filter));
+  wrapper->timing_stats_ = filter_timing_stats_;
   filter->setEncoderFilterCallbacks(*wrapper);
   wrapper->moveIntoList(std::move(wrapper), encoder_filters_);
 }
@@ -595,6 +666,22 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
     return;
   }
 
+  // Refuse the streams of an HTTP/2 connection beyond the reduced limit when overloaded. The
+  // stream is reset with REFUSED_STREAM, which tells the client that it is safe to retry it.
+  if (connection_manager_.overload_reduce_http2_max_concurrent_streams_ref_ ==
+          Server::OverloadActionState::Active &&
+      connection_manager_.codec_->protocol() == Protocol::Http2 &&
+      connection_manager_.streams_.size() >
+          connection_manager_.runtime_.snapshot().getInteger(
+              "overload.reduced_http2_max_concurrent_streams", 100)) {
+    ENVOY_STREAM_LOG(debug, "refusing stream due to envoy overload", *this);
+    state_.created_filter_chain_ = true;
+    state_.local_complete_ = true;
+    connection_manager_.stats_.named_.downstream_rq_overload_refused_stream_.inc();
+    response_encoder_->getStream().resetStream(StreamResetReason::LocalRefusedStreamReset);
+    return;
+  }
+
   if (!connection_manager_.config_.proxy100Continue() && request_headers_->Expect() &&
       request_headers_->Expect()->value() == Headers::get().ExpectValues._100Continue.c_str()) {
     // Note in the case Envoy is handling 100-Continue complexity, it skips the filter chain
@@ -734,6 +821,10 @@ void ConnectionManagerImpl::ActiveStream::traceRequest() {
       Tracing::HttpTracerUtility::isTracing(stream_info_, *request_headers_);
   ConnectionManagerImpl::chargeTracingStats(tracing_decision.reason,
                                             connection_manager_.config_.tracingStats());
+  // The spans of health checks are never kept.
+  tail_sampling_ = !tracing_decision.traced &&
+                   tracing_decision.reason != Tracing::Reason::HealthCheck &&
+                   connection_manager_.config_.tracingConfig()->tail_sampling_.has_value();
 
   active_span_ = connection_manager_.tracer().startSpan(*this, *request_headers_, stream_info_,
                                                         tracing_decision);
@@ -909,7 +1000,11 @@ void ConnectionManagerImpl::ActiveStream::decodeData(ActiveStreamDecoderFilter*
 
     state_.filter_call_state_ |= FilterCallState::DecodeData;
     (*entry)->end_stream_ = end_stream && !request_trailers_;
+    const MonotonicTime start = (*entry)->callbackStart();
     FilterDataStatus status = (*entry)->handle_->decodeData(data, (*entry)->end_stream_);
+    if ((*entry)->timing_stats_ != nullptr) {
+      (*entry)->recordTime((*entry)->timing_stats_->decode_data_us_, start);
+    }
     if ((*entry)->end_stream_) {
       (*entry)->handle_->decodeComplete();
     }
@@ -1006,7 +1101,11 @@ void ConnectionManagerImpl::ActiveStream::decodeTrailers(ActiveStreamDecoderFilt
   for (; entry != decoder_filters_.end(); entry++) {
     ASSERT(!(state_.filter_call_state_ & FilterCallState::DecodeTrailers));
     state_.filter_call_state_ |= FilterCallState::DecodeTrailers;
+    const MonotonicTime start = (*entry)->callbackStart();
     FilterTrailersStatus status = (*entry)->handle_->decodeTrailers(trailers);
+    if ((*entry)->timing_stats_ != nullptr) {
+      (*entry)->recordTime((*entry)->timing_stats_->decode_trailers_us_, start);
+    }
     (*entry)->handle_->decodeComplete();
     (*entry)->end_stream_ = true;
     state_.filter_call_state_ &= ~FilterCallState::DecodeTrailers;
@@ -1063,7 +1162,19 @@ void ConnectionManagerImpl::startDrainSequence() {
 void ConnectionManagerImpl::ActiveStream::refreshCachedRoute() {
   Router::RouteConstSharedPtr route;
   if (request_headers_ != nullptr) {
-    route = snapped_route_config_->route(*request_headers_, stream_id_);
+    RouteCache* route_cache = connection_manager_.config_.routeCache();
+    if (route_cache != nullptr) {
+      route = route_cache->find(snapped_route_config_, *request_headers_);
+    }
+    if (route != nullptr) {
+      connection_manager_.stats_.named_.route_cache_hit_.inc();
+    } else {
+      route = snapped_route_config_->route(*request_headers_, stream_id_);
+      if (route_cache != nullptr) {
+        connection_manager_.stats_.named_.route_cache_miss_.inc();
+        route_cache->insert(snapped_route_config_, *request_headers_, route);
+      }
+    }
   }
   stream_info_.route_entry_ = route ? route->routeEntry() : nullptr;
   cached_route_ = std::move(route);
@@ -1154,7 +1265,11 @@ void ConnectionManagerImpl::ActiveStream::encodeHeaders(ActiveStreamEncoderFilte
     state_.filter_call_state_ |= FilterCallState::EncodeHeaders;
     (*entry)->end_stream_ =
         encoding_headers_only_ || (end_stream && continue_data_entry == encoder_filters_.end());
+    const MonotonicTime start = (*entry)->callbackStart();
     FilterHeadersStatus status = (*entry)->handle_->encodeHeaders(headers, (*entry)->end_stream_);
+    if ((*entry)->timing_stats_ != nullptr) {
+      (*entry)->recordTime((*entry)->timing_stats_->encode_headers_us_, start);
+    }
     if ((*entry)->end_stream_) {
       (*entry)->handle_->encodeComplete();
     }
@@ -1372,7 +1487,11 @@ void ConnectionManagerImpl::ActiveStream::encodeData(ActiveStreamEncoderFilter*
     recordLatestDataFilter(entry, state_.latest_data_encoding_filter_, encoder_filters_);
 
     (*entry)->end_stream_ = end_stream && !response_trailers_;
+    const MonotonicTime start = (*entry)->callbackStart();
     FilterDataStatus status = (*entry)->handle_->encodeData(data, (*entry)->end_stream_);
+    if ((*entry)->timing_stats_ != nullptr) {
+      (*entry)->recordTime((*entry)->timing_stats_->encode_data_us_, start);
+    }
     if ((*entry)->end_stream_) {
       (*entry)->handle_->encodeComplete();
     }
@@ -1422,7 +1541,11 @@ void ConnectionManagerImpl::ActiveStream::encodeTrailers(ActiveStreamEncoderFilt
   for (; entry != encoder_filters_.end(); entry++) {
     ASSERT(!(state_.filter_call_state_ & FilterCallState::EncodeTrailers));
     state_.filter_call_state_ |= FilterCallState::EncodeTrailers;
+    const MonotonicTime start = (*entry)->callbackStart();
     FilterTrailersStatus status = (*entry)->handle_->encodeTrailers(trailers);
+    if ((*entry)->timing_stats_ != nullptr) {
+      (*entry)->recordTime((*entry)->timing_stats_->encode_trailers_us_, start);
+    }
     (*entry)->handle_->encodeComplete();
     (*entry)->end_stream_ = true;
     state_.filter_call_state_ &= ~FilterCallState::EncodeTrailers;
@@ -1551,6 +1674,10 @@ void ConnectionManagerImpl::ActiveStreamFilterBase::commonContinue() {
                    static_cast<const void*>(this));
   ASSERT(stopped_);
   stopped_ = false;
+  if (timing_stats_ != nullptr && stopped_time_ != MonotonicTime()) {
+    recordTime(stoppedTimeHistogram(), stopped_time_);
+    stopped_time_ = MonotonicTime();
+  }
 
   // Only resume with do100ContinueHeaders() if we've actually seen a 100-Continue.
   if (parent_.has_continue_headers_ && !continue_headers_continued_) {
@@ -1582,6 +1709,25 @@ void ConnectionManagerImpl::ActiveStreamFilterBase::commonContinue() {
   }
 }
 
+void ConnectionManagerImpl::ActiveStreamFilterBase::setStopped() {
+  stopped_ = true;
+  if (timing_stats_ != nullptr) {
+    stopped_time_ = parent_.connection_manager_.time_source_.monotonicTime();
+  }
+}
+
+MonotonicTime ConnectionManagerImpl::ActiveStreamFilterBase::callbackStart() {
+  return timing_stats_ != nullptr ? parent_.connection_manager_.time_source_.monotonicTime()
+                                  : MonotonicTime();
+}
+
+void ConnectionManagerImpl::ActiveStreamFilterBase::recordTime(Stats::Histogram& histogram,
+                                                               MonotonicTime start) {
+  histogram.recordValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                            parent_.connection_manager_.time_source_.monotonicTime() - start)
+                            .count());
+}
+
 bool ConnectionManagerImpl::ActiveStreamFilterBase::commonHandleAfter100ContinueHeadersCallback(
     FilterHeadersStatus status) {
   ASSERT(parent_.has_continue_headers_);
@@ -1589,7 +1735,7 @@ bool ConnectionManagerImpl::ActiveStreamFilterBase::commonHandleAfter100Continue
   ASSERT(!stopped_);
 
   if (status == FilterHeadersStatus::StopIteration) {
-    stopped_ = true;
+    setStopped();
     return false;
   } else {
     ASSERT(status == FilterHeadersStatus::Continue);
@@ -1604,7 +1750,7 @@ bool ConnectionManagerImpl::ActiveStreamFilterBase::commonHandleAfterHeadersCall
   ASSERT(!stopped_);
 
   if (status == FilterHeadersStatus::StopIteration) {
-    stopped_ = true;
+    setStopped();
     return false;
   } else if (status == FilterHeadersStatus::ContinueAndEndStream) {
     // Set headers_only to true so we know to end early if necessary,
@@ -1648,7 +1794,7 @@ bool ConnectionManagerImpl::ActiveStreamFilterBase::commonHandleAfterDataCallbac
       ASSERT(headers_continued_);
     }
   } else {
-    stopped_ = true;
+    setStopped();
     if (status == FilterDataStatus::StopIterationAndBuffer ||
         status == FilterDataStatus::StopIterationAndWatermark) {
       buffer_was_streaming = status == FilterDataStatus::StopIterationAndWatermark;
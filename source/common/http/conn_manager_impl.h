@@ -27,6 +27,7 @@
 
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/linked_object.h"
+#include "common/common/object_pool.h"
 #include "common/grpc/common.h"
 #include "common/http/conn_manager_config.h"
 #include "common/http/user_agent.h"
@@ -79,10 +80,14 @@ public:
   void onEvent(Network::ConnectionEvent event) override;
   // Pass connection watermark events on to all the streams associated with that connection.
   void onAboveWriteBufferHighWatermark() override {
-    codec_->onUnderlyingConnectionAboveWriteBufferHighWatermark();
+    if (codec_) {
+      codec_->onUnderlyingConnectionAboveWriteBufferHighWatermark();
+    }
   }
   void onBelowWriteBufferLowWatermark() override {
-    codec_->onUnderlyingConnectionBelowWriteBufferLowWatermark();
+    if (codec_) {
+      codec_->onUnderlyingConnectionBelowWriteBufferLowWatermark();
+    }
   }
 
   TimeSource& timeSource() { return time_source_; }
@@ -93,7 +98,7 @@ private:
   /**
    * Base class wrapper for both stream encoder and decoder filters.
    */
-  struct ActiveStreamFilterBase : public virtual StreamFilterCallbacks {
+  struct ActiveStreamFilterBase : public virtual StreamFilterCallbacks, public PooledObject {
     ActiveStreamFilterBase(ActiveStream& parent, bool dual_filter)
         : parent_(parent), headers_continued_(false), continue_headers_continued_(false),
           stopped_(false), end_stream_(false), dual_filter_(dual_filter) {}
@@ -106,6 +111,10 @@ private:
     bool commonHandleAfterTrailersCallback(FilterTrailersStatus status);
 
     void commonContinue();
+    void setStopped();
+    // Starts timing a filter callback, if the time spent in the filter is recorded.
+    MonotonicTime callbackStart();
+    void recordTime(Stats::Histogram& histogram, MonotonicTime start);
     virtual bool canContinue() PURE;
     virtual Buffer::WatermarkBufferPtr createBuffer() PURE;
     virtual Buffer::WatermarkBufferPtr& bufferedData() PURE;
@@ -115,6 +124,7 @@ private:
     virtual void doData(bool end_stream) PURE;
     virtual void doTrailers() PURE;
     virtual const HeaderMapPtr& trailers() PURE;
+    virtual Stats::Histogram& stoppedTimeHistogram() PURE;
 
     // Http::StreamFilterCallbacks
     const Network::Connection* connection() override;
@@ -135,6 +145,10 @@ private:
     // If true, end_stream is called for this filter.
     bool end_stream_ : 1;
     const bool dual_filter_ : 1;
+    // The stats of the time spent in the filter, or nullptr if it is not recorded.
+    FilterTimingStats* timing_stats_{};
+    // When the filter stopped iteration, if the time spent in the filter is recorded.
+    MonotonicTime stopped_time_;
   };
 
   /**
@@ -168,6 +182,7 @@ private:
     }
     void doTrailers() override { parent_.decodeTrailers(this, *parent_.request_trailers_); }
     const HeaderMapPtr& trailers() override { return parent_.request_trailers_; }
+    Stats::Histogram& stoppedTimeHistogram() override { return timing_stats_->decode_stopped_us_; }
 
     // Http::StreamDecoderFilterCallbacks
     void addDecodedData(Buffer::Instance& data, bool streaming) override;
@@ -209,7 +224,11 @@ private:
     // called here may change the content type, so we must check it before the call.
     FilterHeadersStatus decodeHeaders(HeaderMap& headers, bool end_stream) {
       is_grpc_request_ = Grpc::Common::hasGrpcContentType(headers);
+      const MonotonicTime start = callbackStart();
       FilterHeadersStatus status = handle_->decodeHeaders(headers, end_stream);
+      if (timing_stats_ != nullptr) {
+        recordTime(timing_stats_->decode_headers_us_, start);
+      }
       if (end_stream) {
         handle_->decodeComplete();
       }
@@ -251,6 +270,7 @@ private:
     }
     void doTrailers() override { parent_.encodeTrailers(this, *parent_.response_trailers_); }
     const HeaderMapPtr& trailers() override { return parent_.response_trailers_; }
+    Stats::Histogram& stoppedTimeHistogram() override { return timing_stats_->encode_stopped_us_; }
 
     // Http::StreamEncoderFilterCallbacks
     void addEncodedData(Buffer::Instance& data, bool streaming) override;
@@ -282,6 +302,7 @@ private:
    * or pushes.
    */
   struct ActiveStream : LinkedObject<ActiveStream>,
+                        public PooledObject,
                         public Event::DeferredDeletable,
                         public StreamCallbacks,
                         public StreamDecoder,
@@ -342,6 +363,7 @@ private:
       addStreamEncoderFilterWorker(filter, true);
     }
     void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) override;
+    void setFilterTimingStats(FilterTimingStats* stats) override { filter_timing_stats_ = stats; }
 
     // Tracing::TracingConfig
     Tracing::OperationName operationName() const override;
@@ -434,6 +456,8 @@ private:
     std::list<ActiveStreamDecoderFilterPtr> decoder_filters_;
     std::list<ActiveStreamEncoderFilterPtr> encoder_filters_;
     std::list<AccessLog::InstanceSharedPtr> access_log_handlers_;
+    // The timing stats of the filters that are added next while the filter chain is created.
+    FilterTimingStats* filter_timing_stats_{};
     Stats::TimespanPtr request_response_timespan_;
     // Per-stream idle timeout.
     Event::TimerPtr stream_idle_timer_;
@@ -452,6 +476,9 @@ private:
     // is ever called, this is set to true so commonContinue resumes processing the 100-Continue.
     bool has_continue_headers_{};
     bool is_head_request_{};
+    // Whether the span of the request, which was not sampled when it started, is kept if the
+    // request matches the tail sampling rules once it has ended.
+    bool tail_sampling_{};
     // Whether a filter has indicated that the request should be treated as a headers only request.
     bool decoding_headers_only_{};
     // Whether a filter has indicated that the response should be treated as a headers only
@@ -480,6 +507,7 @@ private:
 
   void resetAllStreams();
   void onIdleTimeout();
+  void onIdleCompactionTimeout();
   void onDrainTimeout();
   void startDrainSequence();
   Tracing::HttpTracer& tracer() { return http_context_.tracer(); }
@@ -499,6 +527,12 @@ private:
   // connection. When there are active streams it is disarmed in favor of each stream's
   // stream_idle_timer_.
   Event::TimerPtr connection_idle_timer_;
+  // Like connection_idle_timer_, only armed when there are no streams on the connection. When it
+  // fires the HTTP/1 codec is released, to be re-created when the next request arrives.
+  Event::TimerPtr connection_compaction_timer_;
+  // Whether the codec was released by the compaction timer, in which case the connection is still
+  // accounted for as an HTTP/1 connection.
+  bool codec_released_{};
   Event::TimerPtr drain_timer_;
   Runtime::RandomGenerator& random_generator_;
   Http::Context& http_context_;
@@ -511,6 +545,7 @@ private:
   // lookup in the hot path of processing each request.
   const Server::OverloadActionState& overload_stop_accepting_requests_ref_;
   const Server::OverloadActionState& overload_disable_keepalive_ref_;
+  const Server::OverloadActionState& overload_reduce_http2_max_concurrent_streams_ref_;
   TimeSource& time_source_;
 };
 
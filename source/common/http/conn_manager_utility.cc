@@ -1,5 +1,6 @@
 #include "common/http/conn_manager_utility.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <string>
@@ -7,11 +8,13 @@
 #include "common/access_log/access_log_formatter.h"
 #include "common/common/empty_string.h"
 #include "common/common/utility.h"
+#include "common/http/codes.h"
 #include "common/http/headers.h"
 #include "common/http/http1/codec_impl.h"
 #include "common/http/http2/codec_impl.h"
 #include "common/http/utility.h"
 #include "common/network/utility.h"
+#include "common/runtime/runtime_impl.h"
 #include "common/runtime/uuid_util.h"
 #include "common/tracing/http_tracer_impl.h"
 
@@ -170,8 +173,19 @@ Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequest
     request_headers.removeEnvoyIpTags();
     request_headers.removeEnvoyOriginalUrl();
 
-    for (const LowerCaseString& header : route_config.internalOnlyHeaders()) {
-      request_headers.remove(header);
+    // A single pass over the map removes all the internal only headers, rather than one pass per
+    // header that is not inline.
+    const std::list<LowerCaseString>& internal_only_headers = route_config.internalOnlyHeaders();
+    if (internal_only_headers.size() == 1) {
+      request_headers.remove(internal_only_headers.front());
+    } else if (!internal_only_headers.empty()) {
+      request_headers.removeIf([&internal_only_headers](const HeaderEntry& header) -> bool {
+        const absl::string_view key = header.key().getStringView();
+        return std::any_of(internal_only_headers.begin(), internal_only_headers.end(),
+                           [key](const LowerCaseString& internal_only_header) {
+                             return internal_only_header.get() == key;
+                           });
+      });
     }
   }
 
@@ -203,10 +217,10 @@ Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequest
 
   // Generate x-request-id for all edge requests, or if there is none.
   if (config.generateRequestId() && (edge_request || !request_headers.RequestId())) {
-    // TODO(PiotrSikora) PERF: Write UUID directly to the header map.
-    const std::string uuid = random.uuid();
-    ASSERT(!uuid.empty());
-    request_headers.insertRequestId().value(uuid);
+    // The UUID fits in the inline buffer of the header value, so nothing is allocated.
+    char uuid[Runtime::RandomGeneratorImpl::UUID_LENGTH];
+    random.uuid(uuid);
+    request_headers.insertRequestId().value(uuid, sizeof(uuid));
   }
 
   mutateTracingRequestHeader(request_headers, runtime, config);
@@ -229,29 +243,50 @@ void ConnectionManagerUtility::mutateTracingRequestHeader(HeaderMap& request_hea
     return;
   }
 
+  static const Runtime::FeatureHandleImpl client_enabled("tracing.client_enabled");
+  static const Runtime::FeatureHandleImpl random_sampling("tracing.random_sampling");
+  static const Runtime::FeatureHandleImpl global_enabled("tracing.global_enabled");
+
   // Do not apply tracing transformations if we are currently tracing.
   if (UuidTraceStatus::NoTrace == UuidUtils::isTraceableUuid(x_request_id)) {
     if (request_headers.ClientTraceId() &&
-        runtime.snapshot().featureEnabled("tracing.client_enabled",
+        runtime.snapshot().featureEnabled(client_enabled,
                                           config.tracingConfig()->client_sampling_)) {
       UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::Client);
     } else if (request_headers.EnvoyForceTrace()) {
       UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::Forced);
-    } else if (runtime.snapshot().featureEnabled("tracing.random_sampling",
+    } else if (runtime.snapshot().featureEnabled(random_sampling,
                                                  config.tracingConfig()->random_sampling_, result,
                                                  10000)) {
       UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::Sampled);
     }
   }
 
-  if (!runtime.snapshot().featureEnabled("tracing.global_enabled",
-                                         config.tracingConfig()->overall_sampling_, result)) {
+  if (!runtime.snapshot().featureEnabled(global_enabled, config.tracingConfig()->overall_sampling_,
+                                         result)) {
     UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::NoTrace);
   }
 
   request_headers.RequestId()->value(x_request_id);
 }
 
+bool ConnectionManagerUtility::isTailSampled(const TracingTailSamplingConfig& config,
+                                             const HeaderMap* request_headers,
+                                             const StreamInfo::StreamInfo& stream_info) {
+  if (config.errors_ &&
+      (!stream_info.responseCode() || CodeUtility::is5xx(stream_info.responseCode().value()))) {
+    return true;
+  }
+
+  if (config.latency_threshold_ && stream_info.requestComplete() &&
+      stream_info.requestComplete().value() > config.latency_threshold_.value()) {
+    return true;
+  }
+
+  return request_headers != nullptr && !config.request_headers_.empty() &&
+         HeaderUtility::matchHeaders(*request_headers, config.request_headers_);
+}
+
 void ConnectionManagerUtility::mutateXfccRequestHeader(HeaderMap& request_headers,
                                                        Network::Connection& connection,
                                                        ConnectionManagerConfig& config) {
@@ -59,6 +59,17 @@ public:
   static void mutateResponseHeaders(HeaderMap& response_headers, const HeaderMap* request_headers,
                                     const std::string& via);
 
+  /**
+   * Evaluate the tail sampling rules for a request that has ended.
+   * @param config supplies the tail sampling rules.
+   * @param request_headers supplies the request headers, if any were received.
+   * @param stream_info supplies the stream info of the ended request.
+   * @return bool whether the span of the request should be kept.
+   */
+  static bool isTailSampled(const TracingTailSamplingConfig& config,
+                            const HeaderMap* request_headers,
+                            const StreamInfo::StreamInfo& stream_info);
+
 private:
   /**
    * Mutate request headers if request needs to be traced.
@@ -17,12 +17,17 @@ TlsCachingDateProviderImpl::TlsCachingDateProviderImpl(Event::Dispatcher& dispat
 }
 
 void TlsCachingDateProviderImpl::onRefreshDate() {
-  std::string new_date_string = date_formatter_.now(time_source_);
+  const SystemTime now = time_source_.systemTime();
+  std::string new_date_string = date_formatter_.fromTime(now);
   tls_->set([new_date_string](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::make_shared<ThreadLocalCachedDate>(new_date_string);
   });
 
-  refresh_timer_->enableTimer(std::chrono::milliseconds(500));
+  // The date has a resolution of a second, so it only needs refreshing once the next second
+  // starts.
+  const uint64_t millis_since_epoch =
+      std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+  refresh_timer_->enableTimer(std::chrono::milliseconds(1000 - millis_since_epoch % 1000));
 }
 
 void TlsCachingDateProviderImpl::setDateHeader(HeaderMap& headers) {
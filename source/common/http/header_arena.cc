@@ -0,0 +1,82 @@
+#include "common/http/header_arena.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "common/common/assert.h"
+#include "common/memory/accounting.h"
+
+namespace Envoy {
+namespace Http {
+
+constexpr size_t HeaderArena::Alignment;
+constexpr size_t HeaderArena::InitialBlockSize;
+constexpr size_t HeaderArena::MaxBlockSize;
+
+HeaderArena::~HeaderArena() {
+  Memory::Accounting::released(Memory::AccountingTag::HeaderMap, bytes_reserved_);
+  while (blocks_ != nullptr) {
+    Block* next = blocks_->next_;
+    free(blocks_);
+    blocks_ = next;
+  }
+}
+
+char* HeaderArena::newBlock(size_t size) {
+  Block* block = static_cast<Block*>(malloc(blockHeaderSize() + size));
+  RELEASE_ASSERT(block != nullptr, "");
+  block->next_ = blocks_;
+  blocks_ = block;
+  bytes_reserved_ += size;
+  Memory::Accounting::allocated(Memory::AccountingTag::HeaderMap, size);
+  return reinterpret_cast<char*>(block) + blockHeaderSize();
+}
+
+void* HeaderArena::allocate(size_t size) {
+  size = roundUp(std::max<size_t>(size, 1));
+
+  for (FreeList& free_list : free_lists_) {
+    if (free_list.size_ == size && free_list.head_ != nullptr) {
+      FreeChunk* chunk = free_list.head_;
+      free_list.head_ = chunk->next_;
+      return chunk;
+    }
+  }
+
+  if (size > remaining_) {
+    if (size > next_block_size_ / 4) {
+      // Large allocations get a block of their own so that the rest of the current block is not
+      // wasted.
+      return newBlock(size);
+    }
+    current_ = newBlock(next_block_size_);
+    remaining_ = next_block_size_;
+    next_block_size_ = std::min(next_block_size_ * 2, MaxBlockSize);
+  }
+
+  void* result = current_;
+  current_ += size;
+  remaining_ -= size;
+  return result;
+}
+
+void HeaderArena::deallocate(void* ptr, size_t size) {
+  size = roundUp(std::max<size_t>(size, 1));
+  static_assert(sizeof(FreeChunk) <= Alignment, "");
+
+  FreeChunk* chunk = static_cast<FreeChunk*>(ptr);
+  for (FreeList& free_list : free_lists_) {
+    if (free_list.size_ == size) {
+      chunk->next_ = free_list.head_;
+      free_list.head_ = chunk;
+      return;
+    }
+  }
+  if (free_lists_.size() < MaxFreeLists) {
+    chunk->next_ = nullptr;
+    free_lists_.push_back({size, chunk});
+  }
+}
+
+} // namespace Http
+} // namespace Envoy
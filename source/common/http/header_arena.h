@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "common/common/non_copyable.h"
+#include "common/memory/accounting.h"
+
+#include "absl/container/inlined_vector.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * Bump allocator for the entries and string bodies of the header maps belonging to a single
+ * stream. Memory is carved out of a small number of geometrically growing blocks and is returned
+ * to the system in one shot when the arena is destroyed. Freed allocations are kept on exact size
+ * free lists so that headers which are removed and re-added, or values which are repeatedly
+ * overwritten, do not grow the arena.
+ *
+ * The arena is not thread safe. It is shared (see HeaderArenaSharedPtr) by every header map that
+ * allocates from it, so that it lives as long as the longest lived of those maps, e.g. response
+ * headers that are handed from an upstream codec stream to the downstream stream.
+ */
+class HeaderArena : NonCopyable {
+public:
+  // Every allocation is aligned to this boundary.
+  static constexpr size_t Alignment = alignof(std::max_align_t);
+
+  ~HeaderArena();
+
+  /**
+   * @param size supplies the number of bytes to allocate.
+   * @return memory aligned to Alignment that remains valid until deallocate() is called or the
+   *         arena is destroyed.
+   */
+  void* allocate(size_t size);
+
+  /**
+   * Return memory to the arena for reuse by a later allocation of the same size.
+   * @param ptr supplies memory previously returned by allocate().
+   * @param size supplies the size passed to allocate().
+   */
+  void deallocate(void* ptr, size_t size);
+
+  /**
+   * @return the number of block bytes obtained from the system. Exposed for testing.
+   */
+  uint64_t bytesReserved() const { return bytes_reserved_; }
+
+  static constexpr size_t InitialBlockSize = 4096;
+  static constexpr size_t MaxBlockSize = 64 * 1024;
+
+private:
+  struct Block {
+    Block* next_;
+  };
+  struct FreeChunk {
+    FreeChunk* next_;
+  };
+  struct FreeList {
+    size_t size_;
+    FreeChunk* head_;
+  };
+
+  static size_t roundUp(size_t size) { return (size + Alignment - 1) & ~(Alignment - 1); }
+  // The block header is padded so that the first allocation is aligned.
+  static constexpr size_t blockHeaderSize() {
+    return (sizeof(Block) + Alignment - 1) & ~(Alignment - 1);
+  }
+  char* newBlock(size_t size);
+
+  Block* blocks_{};
+  char* current_{};
+  size_t remaining_{};
+  size_t next_block_size_{InitialBlockSize};
+  uint64_t bytes_reserved_{};
+  // Header maps allocate few distinct sizes (list nodes and a handful of string capacities), so
+  // only that many sizes are tracked. Chunks of other sizes stay unused until the arena goes away.
+  static constexpr size_t MaxFreeLists = 8;
+  absl::InlinedVector<FreeList, MaxFreeLists> free_lists_;
+};
+
+typedef std::shared_ptr<HeaderArena> HeaderArenaSharedPtr;
+
+/**
+ * Standard allocator over an optional HeaderArena. Without an arena it falls back to the heap.
+ */
+template <class T> class HeaderArenaAllocator {
+public:
+  typedef T value_type;
+
+  explicit HeaderArenaAllocator(HeaderArena* arena) : arena_(arena) {}
+  template <class U>
+  HeaderArenaAllocator(const HeaderArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    static_assert(alignof(T) <= HeaderArena::Alignment, "");
+    if (arena_ == nullptr) {
+      Memory::Accounting::allocated(Memory::AccountingTag::HeaderMap, n * sizeof(T));
+      return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    if (arena_ == nullptr) {
+      Memory::Accounting::released(Memory::AccountingTag::HeaderMap, n * sizeof(T));
+      std::allocator<T>().deallocate(ptr, n);
+    } else {
+      arena_->deallocate(ptr, n * sizeof(T));
+    }
+  }
+
+  HeaderArena* arena() const { return arena_; }
+
+  template <class U> bool operator==(const HeaderArenaAllocator<U>& rhs) const {
+    return arena_ == rhs.arena();
+  }
+  template <class U> bool operator!=(const HeaderArenaAllocator<U>& rhs) const {
+    return arena_ != rhs.arena();
+  }
+
+private:
+  HeaderArena* arena_;
+};
+
+} // namespace Http
+} // namespace Envoy
@@ -1,13 +1,17 @@
 #include "common/http/header_map_impl.h"
 
 #include <cstdint>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
+#include "common/common/hash.h"
 #include "common/common/utility.h"
+#include "common/memory/accounting.h"
 #include "common/singleton/const_singleton.h"
 
 #include "absl/strings/match.h"
@@ -54,8 +58,11 @@ HeaderString::HeaderString(const std::string& ref_value) : type_(Type::Reference
   ASSERT(valid());
 }
 
+HeaderString::HeaderString(HeaderArena* arena) : HeaderString() { arena_ = arena; }
+
 HeaderString::HeaderString(HeaderString&& move_value) {
   type_ = move_value.type_;
+  arena_ = move_value.arena_;
   string_length_ = move_value.string_length_;
   switch (move_value.type_) {
   case Type::Reference: {
@@ -84,9 +91,27 @@ HeaderString::HeaderString(HeaderString&& move_value) {
 
 HeaderString::~HeaderString() { freeDynamic(); }
 
+char* HeaderString::allocateDynamic(uint64_t capacity) {
+  char* buf;
+  if (arena_ != nullptr) {
+    buf = static_cast<char*>(arena_->allocate(capacity));
+  } else {
+    // The arena accounts for its own blocks.
+    Memory::Accounting::allocated(Memory::AccountingTag::HeaderMap, capacity);
+    buf = static_cast<char*>(malloc(capacity));
+  }
+  RELEASE_ASSERT(buf != nullptr, "");
+  return buf;
+}
+
 void HeaderString::freeDynamic() {
   if (type_ == Type::Dynamic) {
-    free(buffer_.dynamic_);
+    if (arena_ != nullptr) {
+      arena_->deallocate(buffer_.dynamic_, dynamic_capacity_);
+    } else {
+      Memory::Accounting::released(Memory::AccountingTag::HeaderMap, dynamic_capacity_);
+      free(buffer_.dynamic_);
+    }
   }
 }
 
@@ -107,8 +132,7 @@ void HeaderString::append(const char* data, uint32_t size) {
     } else {
       dynamic_capacity_ = MinDynamicCapacity;
     }
-    char* buf = static_cast<char*>(malloc(dynamic_capacity_));
-    RELEASE_ASSERT(buf != nullptr, "");
+    char* buf = allocateDynamic(dynamic_capacity_);
     memcpy(buf, buffer_.ref_, string_length_);
     buffer_.dynamic_ = buf;
     break;
@@ -129,8 +153,7 @@ void HeaderString::append(const char* data, uint32_t size) {
     if (type_ == Type::Inline) {
       const uint64_t new_capacity = newCapacity(string_length_, size);
       validateCapacity(new_capacity);
-      buffer_.dynamic_ = static_cast<char*>(malloc(new_capacity));
-      RELEASE_ASSERT(buffer_.dynamic_ != nullptr, "");
+      buffer_.dynamic_ = allocateDynamic(new_capacity);
       memcpy(buffer_.dynamic_, inline_buffer_, string_length_);
       dynamic_capacity_ = new_capacity;
       type_ = Type::Dynamic;
@@ -140,9 +163,19 @@ void HeaderString::append(const char* data, uint32_t size) {
         validateCapacity(new_capacity);
 
         // Need to reallocate.
-        dynamic_capacity_ = new_capacity;
-        buffer_.dynamic_ = static_cast<char*>(realloc(buffer_.dynamic_, dynamic_capacity_));
-        RELEASE_ASSERT(buffer_.dynamic_ != nullptr, "");
+        if (arena_ == nullptr) {
+          Memory::Accounting::allocated(Memory::AccountingTag::HeaderMap,
+                                        new_capacity - dynamic_capacity_);
+          dynamic_capacity_ = new_capacity;
+          buffer_.dynamic_ = static_cast<char*>(realloc(buffer_.dynamic_, dynamic_capacity_));
+          RELEASE_ASSERT(buffer_.dynamic_ != nullptr, "");
+        } else {
+          char* buf = allocateDynamic(new_capacity);
+          memcpy(buf, buffer_.dynamic_, string_length_);
+          freeDynamic();
+          buffer_.dynamic_ = buf;
+          dynamic_capacity_ = new_capacity;
+        }
       }
     }
   }
@@ -193,17 +226,15 @@ void HeaderString::setCopy(const char* data, uint32_t size) {
     if (type_ == Type::Inline) {
       dynamic_capacity_ = size * 2;
       validateCapacity(dynamic_capacity_);
-      buffer_.dynamic_ = static_cast<char*>(malloc(dynamic_capacity_));
-      RELEASE_ASSERT(buffer_.dynamic_ != nullptr, "");
+      buffer_.dynamic_ = allocateDynamic(dynamic_capacity_);
       type_ = Type::Dynamic;
     } else {
       if (size + 1 > dynamic_capacity_) {
         // Need to reallocate. Use free/malloc to avoid the copy since we are about to overwrite.
+        freeDynamic();
         dynamic_capacity_ = size * 2;
         validateCapacity(dynamic_capacity_);
-        free(buffer_.dynamic_);
-        buffer_.dynamic_ = static_cast<char*>(malloc(dynamic_capacity_));
-        RELEASE_ASSERT(buffer_.dynamic_ != nullptr, "");
+        buffer_.dynamic_ = allocateDynamic(dynamic_capacity_);
       }
     }
   }
@@ -255,7 +286,8 @@ template <> bool HeaderMapImpl::HeaderList::isPseudoHeader(const LowerCaseString
   return key.get().c_str()[0] == ':';
 }
 
-HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key) : key_(key) {}
+HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key, HeaderArena* arena)
+    : key_(key), value_(arena) {}
 
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value)
     : key_(key), value_(std::move(value)) {}
@@ -278,23 +310,86 @@ void HeaderMapImpl::HeaderEntryImpl::value(const HeaderEntry& header) {
 }
 
 #define INLINE_HEADER_STATIC_MAP_ENTRY(name)                                                       \
-  add(Headers::get().name.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {            \
+  add(Headers::get().name.get(), [](HeaderMapImpl& h) -> StaticLookupResponse {                    \
     return {&h.inline_headers_.name##_, &Headers::get().name};                                     \
   });
 
 /**
  * This is the static lookup table that is used to determine whether a header is one of the O(1)
- * headers. This uses a trie for lookup time at most equal to the size of the incoming string.
+ * headers. The set of keys is fixed, so on construction we search for a hash seed under which
+ * every key lands in its own slot of a small power of two table (a perfect hash). A lookup is then
+ * a single hash of the incoming string followed by a single key comparison.
+ *
+ * The inline header names are runtime constants (see HeaderValues) rather than constexpr strings,
+ * so the search runs once when the singleton is first used instead of at compile time.
  */
-struct HeaderMapImpl::StaticLookupTable : public TrieLookupTable<EntryCb> {
+struct HeaderMapImpl::StaticLookupTable {
   StaticLookupTable() {
     ALL_INLINE_HEADERS(INLINE_HEADER_STATIC_MAP_ENTRY)
 
     // Special case where we map a legacy host header to :authority.
-    add(Headers::get().HostLegacy.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {
+    add(Headers::get().HostLegacy.get(), [](HeaderMapImpl& h) -> StaticLookupResponse {
       return {&h.inline_headers_.Host_, &Headers::get().Host};
     });
+
+    build();
   }
+
+  EntryCb find(absl::string_view key) const {
+    const uint8_t index = slots_[HashUtil::xxHash64(key, seed_) & mask_];
+    if (index == 0) {
+      return nullptr;
+    }
+    const Entry& entry = entries_[index - 1];
+    return entry.key_ == key ? entry.cb_ : nullptr;
+  }
+
+private:
+  struct Entry {
+    absl::string_view key_;
+    EntryCb cb_;
+  };
+
+  // Keys reference the HeaderValues singleton, which outlives any lookup.
+  void add(absl::string_view key, EntryCb cb) { entries_.push_back({key, cb}); }
+
+  void build() {
+    // Slots hold entry index + 1 so that zero marks an empty slot.
+    RELEASE_ASSERT(entries_.size() < std::numeric_limits<uint8_t>::max(), "");
+    // With the table at least eight times the number of keys a collision free seed is found within
+    // a few dozen attempts. Grow the table if we are unlucky rather than searching for long.
+    size_t size = 1;
+    while (size < 8 * entries_.size()) {
+      size *= 2;
+    }
+    for (;; size *= 2) {
+      mask_ = size - 1;
+      for (seed_ = 0; seed_ < MaxSeedAttempts; seed_++) {
+        if (tryBuild(size)) {
+          return;
+        }
+      }
+    }
+  }
+
+  bool tryBuild(size_t size) {
+    slots_.assign(size, 0);
+    for (size_t i = 0; i < entries_.size(); i++) {
+      uint8_t& slot = slots_[HashUtil::xxHash64(entries_[i].key_, seed_) & mask_];
+      if (slot != 0) {
+        return false;
+      }
+      slot = static_cast<uint8_t>(i + 1);
+    }
+    return true;
+  }
+
+  static constexpr uint64_t MaxSeedAttempts = 256;
+
+  std::vector<Entry> entries_;
+  std::vector<uint8_t> slots_;
+  uint64_t seed_{};
+  uint64_t mask_{};
 };
 
 void HeaderMapImpl::appendToHeader(HeaderString& header, absl::string_view data) {
@@ -307,7 +402,12 @@ void HeaderMapImpl::appendToHeader(HeaderString& header, absl::string_view data)
   header.append(data.data(), data.size());
 }
 
-HeaderMapImpl::HeaderMapImpl() { memset(&inline_headers_, 0, sizeof(inline_headers_)); }
+HeaderMapImpl::HeaderMapImpl() : HeaderMapImpl(nullptr) {}
+
+HeaderMapImpl::HeaderMapImpl(HeaderArenaSharedPtr arena)
+    : arena_(std::move(arena)), headers_(arena_.get()) {
+  memset(&inline_headers_, 0, sizeof(inline_headers_));
+}
 
 HeaderMapImpl::HeaderMapImpl(
     const std::initializer_list<std::pair<LowerCaseString, std::string>>& values)
@@ -352,7 +452,7 @@ bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
 }
 
 void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
-  EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.c_str());
+  EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.getStringView());
   if (cb) {
     key.clear();
     StaticLookupResponse ref_lookup_response = cb(*this);
@@ -363,7 +463,7 @@ void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
       value.clear();
     }
   } else {
-    std::list<HeaderEntryImpl>::iterator i = headers_.insert(std::move(key), std::move(value));
+    HeaderEntryList::iterator i = headers_.insert(std::move(key), std::move(value));
     i->entry_ = i;
   }
 }
@@ -389,7 +489,7 @@ void HeaderMapImpl::addReference(const LowerCaseString& key, const std::string&
 
 void HeaderMapImpl::addReferenceKey(const LowerCaseString& key, uint64_t value) {
   HeaderString ref_key(key);
-  HeaderString new_value;
+  HeaderString new_value(arena_.get());
   new_value.setInteger(value);
   insertByKey(std::move(ref_key), std::move(new_value));
   ASSERT(new_value.empty()); // NOLINT(bugprone-use-after-move)
@@ -397,7 +497,7 @@ void HeaderMapImpl::addReferenceKey(const LowerCaseString& key, uint64_t value)
 
 void HeaderMapImpl::addReferenceKey(const LowerCaseString& key, const std::string& value) {
   HeaderString ref_key(key);
-  HeaderString new_value;
+  HeaderString new_value(arena_.get());
   new_value.setCopy(value.c_str(), value.size());
   insertByKey(std::move(ref_key), std::move(new_value));
   ASSERT(new_value.empty()); // NOLINT(bugprone-use-after-move)
@@ -411,9 +511,9 @@ void HeaderMapImpl::addCopy(const LowerCaseString& key, uint64_t value) {
     appendToHeader(entry->value(), buf);
     return;
   }
-  HeaderString new_key;
+  HeaderString new_key(arena_.get());
   new_key.setCopy(key.get().c_str(), key.get().size());
-  HeaderString new_value;
+  HeaderString new_value(arena_.get());
   new_value.setInteger(value);
   insertByKey(std::move(new_key), std::move(new_value));
   ASSERT(new_key.empty());   // NOLINT(bugprone-use-after-move)
@@ -426,9 +526,9 @@ void HeaderMapImpl::addCopy(const LowerCaseString& key, const std::string& value
     appendToHeader(entry->value(), value);
     return;
   }
-  HeaderString new_key;
+  HeaderString new_key(arena_.get());
   new_key.setCopy(key.get().c_str(), key.get().size());
-  HeaderString new_value;
+  HeaderString new_value(arena_.get());
   new_value.setCopy(value.c_str(), value.size());
   insertByKey(std::move(new_key), std::move(new_value));
   ASSERT(new_key.empty());   // NOLINT(bugprone-use-after-move)
@@ -444,7 +544,7 @@ void HeaderMapImpl::setReference(const LowerCaseString& key, const std::string&
 
 void HeaderMapImpl::setReferenceKey(const LowerCaseString& key, const std::string& value) {
   HeaderString ref_key(key);
-  HeaderString new_value;
+  HeaderString new_value(arena_.get());
   new_value.setCopy(value.c_str(), value.size());
   remove(key);
   insertByKey(std::move(ref_key), std::move(new_value));
@@ -499,7 +599,7 @@ void HeaderMapImpl::iterateReverse(ConstIterateCb cb, void* context) const {
 
 HeaderMap::Lookup HeaderMapImpl::lookup(const LowerCaseString& key,
                                         const HeaderEntry** entry) const {
-  EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get());
   if (cb) {
     // The accessor callbacks for predefined inline headers take a HeaderMapImpl& as an argument;
     // even though we don't make any modifications, we need to cast_cast in order to use the
@@ -521,7 +621,7 @@ HeaderMap::Lookup HeaderMapImpl::lookup(const LowerCaseString& key,
 }
 
 void HeaderMapImpl::remove(const LowerCaseString& key) {
-  EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get());
   if (cb) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     removeInline(ref_lookup_response.entry_);
@@ -537,12 +637,18 @@ void HeaderMapImpl::remove(const LowerCaseString& key) {
 }
 
 void HeaderMapImpl::removePrefix(const LowerCaseString& prefix) {
+  removeIf([&prefix](const HeaderEntry& entry) -> bool {
+    return absl::StartsWith(entry.key().getStringView(), prefix.get());
+  });
+}
+
+void HeaderMapImpl::removeIf(const HeaderMatchPredicate& predicate) {
   headers_.remove_if([&](const HeaderEntryImpl& entry) {
-    bool to_remove = absl::StartsWith(entry.key().getStringView(), prefix.get());
+    bool to_remove = predicate(entry);
     if (to_remove) {
       // If this header should be removed, make sure any references in the
       // static lookup table are cleared as well.
-      EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(entry.key().c_str());
+      EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(entry.key().getStringView());
       if (cb) {
         StaticLookupResponse ref_lookup_response = cb(*this);
         if (ref_lookup_response.entry_) {
@@ -560,7 +666,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key);
+  HeaderEntryList::iterator i = headers_.insert(key, arena_.get());
   i->entry_ = i;
   *entry = &(*i);
   return **entry;
@@ -574,7 +680,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key, std::move(value));
+  HeaderEntryList::iterator i = headers_.insert(key, std::move(value));
   i->entry_ = i;
   *entry = &(*i);
   return **entry;
@@ -599,5 +705,95 @@ void HeaderMapImpl::removeInline(HeaderEntryImpl** ptr_to_entry) {
   headers_.erase(entry->entry_);
 }
 
+namespace {
+
+/**
+ * The values are few and short, so they are bucketed by length and a lookup compares the value
+ * with the handful of constants of the same length. Values longer than the longest constant, e.g.
+ * cookies or paths, are rejected without looking at their content.
+ */
+struct StaticValueTable {
+  StaticValueTable() {
+    const HeaderValues& headers = Headers::get();
+    for (const std::string* value : {
+             &headers.MethodValues.Connect,
+             &headers.MethodValues.Get,
+             &headers.MethodValues.Head,
+             &headers.MethodValues.Post,
+             &headers.MethodValues.Options,
+             &headers.SchemeValues.Http,
+             &headers.SchemeValues.Https,
+             &headers.ContentTypeValues.Text,
+             &headers.ContentTypeValues.TextEventStream,
+             &headers.ContentTypeValues.TextUtf8,
+             &headers.ContentTypeValues.Html,
+             &headers.ContentTypeValues.Grpc,
+             &headers.ContentTypeValues.GrpcWeb,
+             &headers.ContentTypeValues.GrpcWebProto,
+             &headers.ContentTypeValues.GrpcWebText,
+             &headers.ContentTypeValues.GrpcWebTextProto,
+             &headers.ContentTypeValues.Json,
+             &headers.ContentTypeValues.OctetStream,
+             &headers.ContentTypeValues.Protobuf,
+             &headers.ConnectionValues.Close,
+             &headers.ConnectionValues.KeepAlive,
+             &headers.ConnectionValues.Upgrade,
+             &headers.UpgradeValues.WebSocket,
+             &headers.CacheControlValues.NoCache,
+             &headers.CacheControlValues.NoStore,
+             &headers.TransferEncodingValues.Chunked,
+             &headers.TransferEncodingValues.Deflate,
+             &headers.TransferEncodingValues.Gzip,
+             &headers.AcceptEncodingValues.Identity,
+             &headers.AcceptEncodingValues.Wildcard,
+             &headers.GrpcAcceptEncodingValues.Default,
+             &headers.TEValues.Trailers,
+             &headers.ExpectValues._100Continue,
+             &headers.EnvoyInternalRequestValues.True,
+         }) {
+      add(*value);
+    }
+    for (const std::string& value : own_values_) {
+      add(value);
+    }
+  }
+
+  const std::string* find(absl::string_view value) const {
+    if (value.size() >= buckets_.size()) {
+      return nullptr;
+    }
+    for (const std::string* candidate : buckets_[value.size()]) {
+      if (*candidate == value) {
+        return candidate;
+      }
+    }
+    return nullptr;
+  }
+
+private:
+  void add(const std::string& value) {
+    if (find(value) != nullptr) {
+      // Several of the HeaderValues constants share a value, e.g. "gzip" or "true".
+      return;
+    }
+    if (value.size() >= buckets_.size()) {
+      buckets_.resize(value.size() + 1);
+    }
+    buckets_[value.size()].push_back(&value);
+  }
+
+  // Common values that HeaderValues has no constant for, mostly :status codes.
+  const std::vector<std::string> own_values_{"0",   "/",   "200", "201", "204", "206", "301", "302",
+                                             "304", "400", "401", "403", "404", "429", "500", "502",
+                                             "503", "504"};
+  std::vector<std::vector<const std::string*>> buckets_;
+};
+
+} // namespace
+
+const std::string* StaticHeaderValues::find(absl::string_view value) {
+  return ConstSingleton<StaticValueTable>::get().find(value);
+}
+
 } // namespace Http
 } // namespace Envoy
@@ -9,6 +9,7 @@
 #include "envoy/http/header_map.h"
 
 #include "common/common/non_copyable.h"
+#include "common/http/header_arena.h"
 #include "common/http/headers.h"
 
 namespace Envoy {
@@ -46,6 +47,11 @@ public:
   static void appendToHeader(HeaderString& header, absl::string_view data);
 
   HeaderMapImpl();
+  /**
+   * @param arena supplies the arena to allocate header entries and values from. The map keeps the
+   *        arena alive. If nullptr, the heap is used.
+   */
+  explicit HeaderMapImpl(HeaderArenaSharedPtr arena);
   explicit HeaderMapImpl(
       const std::initializer_list<std::pair<LowerCaseString, std::string>>& values);
   explicit HeaderMapImpl(const HeaderMap& rhs) : HeaderMapImpl() { copyFrom(rhs); }
@@ -78,6 +84,7 @@ public:
   Lookup lookup(const LowerCaseString& key, const HeaderEntry** entry) const override;
   void remove(const LowerCaseString& key) override;
   void removePrefix(const LowerCaseString& key) override;
+  void removeIf(const HeaderMatchPredicate& predicate) override;
   size_t size() const override { return headers_.size(); }
 
 protected:
@@ -85,8 +92,11 @@ protected:
   void copyFrom(const HeaderMap& rhs);
   void clear() { removePrefix(LowerCaseString("")); }
 
+  struct HeaderEntryImpl;
+  typedef std::list<HeaderEntryImpl, HeaderArenaAllocator<HeaderEntryImpl>> HeaderEntryList;
+
   struct HeaderEntryImpl : public HeaderEntry, NonCopyable {
-    HeaderEntryImpl(const LowerCaseString& key);
+    HeaderEntryImpl(const LowerCaseString& key, HeaderArena* arena);
     HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value);
     HeaderEntryImpl(HeaderString&& key, HeaderString&& value);
 
@@ -101,7 +111,7 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
+    HeaderEntryList::iterator entry_;
   };
 
   struct StaticLookupResponse {
@@ -113,7 +123,7 @@ protected:
 
   /**
    * This is the static lookup table that is used to determine whether a header is one of the O(1)
-   * headers. This uses a trie for lookup time at most equal to the size of the incoming string.
+   * headers. This uses a perfect hash so that a lookup is one hash and one key comparison.
    */
   struct StaticLookupTable; // Defined in header_map_impl.cc.
 
@@ -134,14 +144,16 @@ protected:
    */
   class HeaderList : NonCopyable {
   public:
-    HeaderList() : pseudo_headers_end_(headers_.end()) {}
+    explicit HeaderList(HeaderArena* arena)
+        : headers_(HeaderArenaAllocator<HeaderEntryImpl>(arena)),
+          pseudo_headers_end_(headers_.end()) {}
 
     template <class Key> bool isPseudoHeader(const Key& key) { return key.c_str()[0] == ':'; }
 
     template <class Key, class... Value>
-    std::list<HeaderEntryImpl>::iterator insert(Key&& key, Value&&... value) {
+    HeaderEntryList::iterator insert(Key&& key, Value&&... value) {
       const bool is_pseudo_header = isPseudoHeader(key);
-      std::list<HeaderEntryImpl>::iterator i =
+      HeaderEntryList::iterator i =
           headers_.emplace(is_pseudo_header ? pseudo_headers_end_ : headers_.end(),
                            std::forward<Key>(key), std::forward<Value>(value)...);
       if (!is_pseudo_header && pseudo_headers_end_ == headers_.end()) {
@@ -150,7 +162,7 @@ protected:
       return i;
     }
 
-    std::list<HeaderEntryImpl>::iterator erase(std::list<HeaderEntryImpl>::iterator i) {
+    HeaderEntryList::iterator erase(HeaderEntryList::iterator i) {
       if (pseudo_headers_end_ == i) {
         pseudo_headers_end_++;
       }
@@ -169,17 +181,17 @@ protected:
       });
     }
 
-    std::list<HeaderEntryImpl>::iterator begin() { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::iterator end() { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_iterator begin() const { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::const_iterator end() const { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rend() const { return headers_.rend(); }
+    HeaderEntryList::iterator begin() { return headers_.begin(); }
+    HeaderEntryList::iterator end() { return headers_.end(); }
+    HeaderEntryList::const_iterator begin() const { return headers_.begin(); }
+    HeaderEntryList::const_iterator end() const { return headers_.end(); }
+    HeaderEntryList::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
+    HeaderEntryList::const_reverse_iterator rend() const { return headers_.rend(); }
     size_t size() const { return headers_.size(); }
 
   private:
-    std::list<HeaderEntryImpl> headers_;
-    std::list<HeaderEntryImpl>::iterator pseudo_headers_end_;
+    HeaderEntryList headers_;
+    HeaderEntryList::iterator pseudo_headers_end_;
   };
 
   void insertByKey(HeaderString&& key, HeaderString&& value);
@@ -190,6 +202,8 @@ protected:
 
   void removeInline(HeaderEntryImpl** entry);
 
+  // Declared before the entries so that it outlives them.
+  const HeaderArenaSharedPtr arena_;
   AllInlineHeaders inline_headers_;
   HeaderList headers_;
 
@@ -198,5 +212,21 @@ protected:
 
 typedef std::unique_ptr<HeaderMapImpl> HeaderMapImplPtr;
 
+/**
+ * Process-wide table of header values that are common enough to be worth sharing, e.g. methods,
+ * schemes, content types and status codes. A codec that decodes one of them can reference the
+ * constant instead of copying the value into every header map.
+ */
+class StaticHeaderValues {
+public:
+  /**
+   * Look up a decoded header value.
+   * @param value supplies the value.
+   * @return const std::string* the constant equal to the value, which lives for the lifetime of
+   *         the process, or nullptr if there is none.
+   */
+  static const std::string* find(absl::string_view value);
+};
+
 } // namespace Http
 } // namespace Envoy
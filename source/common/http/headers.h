@@ -115,6 +115,7 @@ public:
   struct {
     const std::string NoCache{"no-cache"};
     const std::string NoCacheMaxAge0{"no-cache, max-age=0"};
+    const std::string NoStore{"no-store"};
     const std::string NoTransform{"no-transform"};
   } CacheControlValues;
 
@@ -129,6 +130,8 @@ public:
     const std::string GrpcWebText{"application/grpc-web-text"};
     const std::string GrpcWebTextProto{"application/grpc-web-text+proto"};
     const std::string Json{"application/json"};
+    const std::string OctetStream{"application/octet-stream"};
+    const std::string Protobuf{"application/x-protobuf"};
   } ContentTypeValues;
 
   struct {
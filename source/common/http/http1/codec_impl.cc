@@ -1,5 +1,6 @@
 #include "common/http/http1/codec_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -8,13 +9,17 @@
 #include "envoy/http/header_map.h"
 #include "envoy/network/connection.h"
 
+#include "common/common/cleanup.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
 #include "common/common/stack_array.h"
 #include "common/common/utility.h"
 #include "common/http/exception.h"
 #include "common/http/headers.h"
+#include "common/http/http1/fast_parser_impl.h"
+#include "common/http/http1/legacy_parser_impl.h"
 #include "common/http/utility.h"
+#include "common/runtime/runtime_impl.h"
 
 namespace Envoy {
 namespace Http {
@@ -29,10 +34,22 @@ StreamEncoderImpl::StreamEncoderImpl(ConnectionImpl& connection) : connection_(c
   }
 }
 
+uint64_t StreamEncoderImpl::headerBlockSize(const HeaderMap& headers) {
+  // Each header takes ": " and CRLF on top of its key and value. Pseudo headers are counted even
+  // though they are skipped, and :authority is counted though it is encoded as the shorter host,
+  // which only makes this an overestimate. The block may gain one framing header and ends with
+  // CRLF.
+  static const uint64_t framing_header_size =
+      std::max(Headers::get().TransferEncoding.get().size() +
+                   Headers::get().TransferEncodingValues.Chunked.size(),
+               Headers::get().ContentLength.get().size() + 1) +
+      4;
+  return headers.byteSize() + headers.size() * 4 + framing_header_size + 2;
+}
+
 void StreamEncoderImpl::encodeHeader(const char* key, uint32_t key_size, const char* value,
                                      uint32_t value_size) {
-
-  connection_.reserveBuffer(key_size + value_size + 4);
+  // The whole header block has been reserved by encodeHeaders().
   ASSERT(key_size > 0);
 
   connection_.copyToBuffer(key, key_size);
@@ -51,6 +68,11 @@ void StreamEncoderImpl::encode100ContinueHeaders(const HeaderMap& headers) {
 }
 
 void StreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_stream) {
+  connection_.reserveBuffer(headerBlockSize(headers));
+  encodeHeaderBlock(headers, end_stream);
+}
+
+void StreamEncoderImpl::encodeHeaderBlock(const HeaderMap& headers, bool end_stream) {
   bool saw_content_length = false;
   headers.iterate(
       [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
@@ -124,14 +146,13 @@ void StreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_stream)
     }
   }
 
-  connection_.reserveBuffer(2);
   connection_.addCharToBuffer('\r');
   connection_.addCharToBuffer('\n');
 
   if (end_stream) {
     endEncode();
   } else {
-    connection_.flushOutput();
+    connection_.flushOutput(held_output_);
   }
 }
 
@@ -139,21 +160,28 @@ void StreamEncoderImpl::encodeData(Buffer::Instance& data, bool end_stream) {
   // end_stream may be indicated with a zero length data buffer. If that is the case, so not
   // actually write the zero length buffer out.
   if (data.length() > 0) {
+    // The chunk framing is written into the reserved space of the output buffer, which follows the
+    // headers or the previous chunk, rather than into buffers of its own, and the data is moved in
+    // between.
     if (chunk_encoding_) {
-      connection_.buffer().add(fmt::format("{:x}\r\n", data.length()));
+      connection_.reserveBuffer(2 * sizeof(uint64_t) + CRLF.size());
+      connection_.addHexToBuffer(data.length());
+      connection_.copyToBuffer(CRLF.data(), CRLF.size());
+      connection_.commitBuffer();
     }
 
     connection_.buffer().move(data);
 
     if (chunk_encoding_) {
-      connection_.buffer().add(CRLF);
+      connection_.reserveBuffer(CRLF.size());
+      connection_.copyToBuffer(CRLF.data(), CRLF.size());
     }
   }
 
   if (end_stream) {
     endEncode();
   } else {
-    connection_.flushOutput();
+    connection_.flushOutput(held_output_);
   }
 }
 
@@ -161,21 +189,21 @@ void StreamEncoderImpl::encodeTrailers(const HeaderMap&) { endEncode(); }
 
 void StreamEncoderImpl::endEncode() {
   if (chunk_encoding_) {
-    connection_.buffer().add(LAST_CHUNK);
+    connection_.reserveBuffer(LAST_CHUNK.size());
+    connection_.copyToBuffer(LAST_CHUNK.data(), LAST_CHUNK.size());
   }
 
-  connection_.flushOutput();
-  connection_.onEncodeComplete();
+  connection_.flushOutput(held_output_);
+  connection_.onEncodeComplete(*this);
 }
 
-void ConnectionImpl::flushOutput() {
-  if (reserved_current_) {
-    reserved_iovec_.len_ = reserved_current_ - static_cast<char*>(reserved_iovec_.mem_);
-    output_buffer_.commit(&reserved_iovec_, 1);
-    reserved_current_ = nullptr;
+void ConnectionImpl::flushOutput(Buffer::Instance* held_output) {
+  commitBuffer();
+  if (held_output != nullptr) {
+    held_output->move(output_buffer_);
+  } else {
+    connection().write(output_buffer_, false);
   }
-
-  connection().write(output_buffer_, false);
   ASSERT(0UL == output_buffer_.length());
 }
 
@@ -188,6 +216,22 @@ void ConnectionImpl::addIntToBuffer(uint64_t i) {
   reserved_current_ += StringUtil::itoa(reserved_current_, bufferRemainingSize(), i);
 }
 
+void ConnectionImpl::addHexToBuffer(uint64_t i) {
+  static const char HexDigits[] = "0123456789abcdef";
+  // The digits are produced from the least significant one.
+  char digits[2 * sizeof(uint64_t)];
+  size_t num_digits = 0;
+  do {
+    digits[num_digits++] = HexDigits[i & 0xf];
+    i >>= 4;
+  } while (i != 0);
+
+  ASSERT(bufferRemainingSize() >= num_digits);
+  while (num_digits > 0) {
+    *reserved_current_++ = digits[--num_digits];
+  }
+}
+
 uint64_t ConnectionImpl::bufferRemainingSize() {
   return reserved_iovec_.len_ - (reserved_current_ - static_cast<char*>(reserved_iovec_.mem_));
 }
@@ -203,17 +247,21 @@ void ConnectionImpl::reserveBuffer(uint64_t size) {
     return;
   }
 
-  if (reserved_current_) {
-    reserved_iovec_.len_ = reserved_current_ - static_cast<char*>(reserved_iovec_.mem_);
-    output_buffer_.commit(&reserved_iovec_, 1);
-  }
-
+  commitBuffer();
   // TODO PERF: It would be better to allow a split reservation. That will make fill code more
   //            complicated.
   output_buffer_.reserve(std::max<uint64_t>(4096, size), &reserved_iovec_, 1);
   reserved_current_ = static_cast<char*>(reserved_iovec_.mem_);
 }
 
+void ConnectionImpl::commitBuffer() {
+  if (reserved_current_) {
+    reserved_iovec_.len_ = reserved_current_ - static_cast<char*>(reserved_iovec_.mem_);
+    output_buffer_.commit(&reserved_iovec_, 1);
+    reserved_current_ = nullptr;
+  }
+}
+
 void StreamEncoderImpl::resetStream(StreamResetReason reason) {
   connection_.onResetStreamBase(reason);
 }
@@ -228,8 +276,13 @@ static const char HTTP_10_RESPONSE_PREFIX[] = "HTTP/1.0 ";
 void ResponseStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_stream) {
   started_response_ = true;
   uint64_t numeric_status = Utility::getResponseStatus(headers);
+  const char* status_string = CodeUtility::toString(static_cast<Code>(numeric_status));
+  uint32_t status_string_len = strlen(status_string);
 
-  connection_.reserveBuffer(4096);
+  // Reserve the status line and the header block in one go so that the response headers are
+  // serialized into a single contiguous slice.
+  connection_.reserveBuffer(sizeof(RESPONSE_PREFIX) - 1 + StringUtil::MIN_ITOA_OUT_LEN + 1 +
+                            status_string_len + 2 + headerBlockSize(headers));
   if (connection_.protocol() == Protocol::Http10 && connection_.supports_http_10()) {
     connection_.copyToBuffer(HTTP_10_RESPONSE_PREFIX, sizeof(HTTP_10_RESPONSE_PREFIX) - 1);
   } else {
@@ -237,9 +290,6 @@ void ResponseStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end
   }
   connection_.addIntToBuffer(numeric_status);
   connection_.addCharToBuffer(' ');
-
-  const char* status_string = CodeUtility::toString(static_cast<Code>(numeric_status));
-  uint32_t status_string_len = strlen(status_string);
   connection_.copyToBuffer(status_string, status_string_len);
 
   connection_.addCharToBuffer('\r');
@@ -254,7 +304,7 @@ void ResponseStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end
     setIsContentLengthAllowed(true);
   }
 
-  StreamEncoderImpl::encodeHeaders(headers, end_stream);
+  encodeHeaderBlock(headers, end_stream);
 }
 
 static const char REQUEST_POSTFIX[] = " HTTP/1.1\r\n";
@@ -269,61 +319,34 @@ void RequestStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_
     head_request_ = true;
   }
   connection_.onEncodeHeaders(headers);
-  connection_.reserveBuffer(std::max(4096U, path->value().size() + 4096));
+  connection_.reserveBuffer(method->value().size() + 1 + path->value().size() +
+                            sizeof(REQUEST_POSTFIX) - 1 + headerBlockSize(headers));
   connection_.copyToBuffer(method->value().c_str(), method->value().size());
   connection_.addCharToBuffer(' ');
   connection_.copyToBuffer(path->value().c_str(), path->value().size());
   connection_.copyToBuffer(REQUEST_POSTFIX, sizeof(REQUEST_POSTFIX) - 1);
 
-  StreamEncoderImpl::encodeHeaders(headers, end_stream);
-}
-
-http_parser_settings ConnectionImpl::settings_{
-    [](http_parser* parser) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onMessageBeginBase();
-      return 0;
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onUrl(at, length);
-      return 0;
-    },
-    nullptr, // on_status
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onHeaderField(at, length);
-      return 0;
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onHeaderValue(at, length);
-      return 0;
-    },
-    [](http_parser* parser) -> int {
-      return static_cast<ConnectionImpl*>(parser->data)->onHeadersCompleteBase();
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onBody(at, length);
-      return 0;
-    },
-    [](http_parser* parser) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onMessageCompleteBase();
-      return 0;
-    },
-    nullptr, // on_chunk_header
-    nullptr  // on_chunk_complete
-};
+  encodeHeaderBlock(headers, end_stream);
+}
 
 const ToLowerTable& ConnectionImpl::toLowerTable() {
   static ToLowerTable* table = new ToLowerTable();
   return *table;
 }
 
-ConnectionImpl::ConnectionImpl(Network::Connection& connection, http_parser_type type,
+ConnectionImpl::ConnectionImpl(Network::Connection& connection, MessageType type,
                                uint32_t max_headers_kb)
     : connection_(connection), output_buffer_([&]() -> void { this->onBelowLowWatermark(); },
                                               [&]() -> void { this->onAboveHighWatermark(); }),
       max_headers_kb_(max_headers_kb) {
   output_buffer_.setWatermarks(connection.bufferLimit());
-  http_parser_init(&parser_, type);
-  parser_.data = this;
+  if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http1_fast_parser")) {
+    // Header lines that straddle reads are buffered by the parser, so bound them by the same limit
+    // as the whole header block.
+    parser_ = std::make_unique<FastHttpParserImpl>(type, parser_callbacks_, max_headers_kb * 1024);
+  } else {
+    parser_ = std::make_unique<LegacyHttpParserImpl>(type, parser_callbacks_);
+  }
 }
 
 void ConnectionImpl::completeLastHeader() {
@@ -331,8 +354,17 @@ void ConnectionImpl::completeLastHeader() {
                  current_header_field_.c_str(), current_header_value_.c_str());
   if (!current_header_field_.empty()) {
     toLowerTable().toLowerCase(current_header_field_.buffer(), current_header_field_.size());
-    current_header_map_->addViaMove(std::move(current_header_field_),
-                                    std::move(current_header_value_));
+    // A common value goes into the map as a reference rather than by copying its bytes.
+    const std::string* static_value =
+        StaticHeaderValues::find(current_header_value_.getStringView());
+    if (static_value != nullptr) {
+      current_header_value_.clear();
+      current_header_map_->addViaMove(std::move(current_header_field_),
+                                      HeaderString(*static_value));
+    } else {
+      current_header_map_->addViaMove(std::move(current_header_field_),
+                                      std::move(current_header_value_));
+    }
   }
 
   header_parsing_state_ = HeaderParsingState::Field;
@@ -346,16 +378,12 @@ bool ConnectionImpl::maybeDirectDispatch(Buffer::Instance& data) {
     return false;
   }
 
-  ssize_t total_parsed = 0;
-  uint64_t num_slices = data.getRawSlices(nullptr, 0);
-  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
-  data.getRawSlices(slices.begin(), num_slices);
-  for (const Buffer::RawSlice& slice : slices) {
-    total_parsed += slice.len_;
-    onBody(static_cast<const char*>(slice.mem_), slice.len_);
-  }
-  ENVOY_CONN_LOG(trace, "direct-dispatched {} bytes", connection_, total_parsed);
-  data.drain(total_parsed);
+  ENVOY_CONN_LOG(trace, "direct-dispatched {} bytes", connection_, data.length());
+  if (data.length() > 0) {
+    Buffer::OwnedImpl buffer;
+    buffer.move(data);
+    onBody(buffer);
+  }
   return true;
 }
 
@@ -367,22 +395,28 @@ void ConnectionImpl::dispatch(Buffer::Instance& data) {
   }
 
   // Always unpause before dispatch.
-  http_parser_pause(&parser_, 0);
+  parser_->resume();
 
   ssize_t total_parsed = 0;
   if (data.length() > 0) {
     uint64_t num_slices = data.getRawSlices(nullptr, 0);
     STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
     data.getRawSlices(slices.begin(), num_slices);
+    // Each slice is drained once parsed, so that the slice being parsed is at the front of the
+    // buffer, where onBodyBase() can move it out of.
+    dispatching_buffer_ = &data;
+    Cleanup dispatching([this]() { dispatching_buffer_ = nullptr; });
     for (const Buffer::RawSlice& slice : slices) {
-      total_parsed += dispatchSlice(static_cast<const char*>(slice.mem_), slice.len_);
+      dispatching_bytes_moved_ = 0;
+      const size_t parsed = dispatchSlice(static_cast<const char*>(slice.mem_), slice.len_);
+      total_parsed += parsed;
+      data.drain(parsed - dispatching_bytes_moved_);
     }
   } else {
     dispatchSlice(nullptr, 0);
   }
 
   ENVOY_CONN_LOG(trace, "parsed {} bytes", connection_, total_parsed);
-  data.drain(total_parsed);
 
   // If an upgrade has been handled and there is body data or early upgrade
   // payload to send on, send it on.
@@ -390,16 +424,39 @@ void ConnectionImpl::dispatch(Buffer::Instance& data) {
 }
 
 size_t ConnectionImpl::dispatchSlice(const char* slice, size_t len) {
-  ssize_t rc = http_parser_execute(&parser_, &settings_, slice, len);
-  if (HTTP_PARSER_ERRNO(&parser_) != HPE_OK && HTTP_PARSER_ERRNO(&parser_) != HPE_PAUSED) {
+  const size_t rc = parser_->execute(slice, len);
+  const http_errno error = parser_->error();
+  // A header line that is too long to be buffered by the parser.
+  if (error == HPE_HEADER_OVERFLOW) {
+    error_code_ = Http::Code::RequestHeaderFieldsTooLarge;
+    sendProtocolError();
+    throw CodecProtocolException("headers size exceeds limit");
+  }
+  if (error != HPE_OK && error != HPE_PAUSED) {
     sendProtocolError();
     throw CodecProtocolException("http/1.1 protocol error: " +
-                                 std::string(http_errno_name(HTTP_PARSER_ERRNO(&parser_))));
+                                 std::string(http_errno_name(error)));
   }
 
   return rc;
 }
 
+void ConnectionImpl::onBodyBase(const char* data, size_t length) {
+  Buffer::OwnedImpl buffer;
+  // A span that is a whole slice of the buffer being dispatched, e.g. a large chunk or a part of a
+  // large body that fills a read, is moved rather than copied.
+  Buffer::RawSlice slice;
+  if (dispatching_buffer_ != nullptr && length > 0 &&
+      dispatching_buffer_->getRawSlices(&slice, 1) > 0 && slice.mem_ == data &&
+      slice.len_ == length) {
+    buffer.move(*dispatching_buffer_, length);
+    dispatching_bytes_moved_ += length;
+  } else {
+    buffer.add(data, length);
+  }
+  onBody(buffer);
+}
+
 void ConnectionImpl::onHeaderField(const char* data, size_t length) {
   if (header_parsing_state_ == HeaderParsingState::Done) {
     // Ignore trailers.
@@ -434,7 +491,7 @@ void ConnectionImpl::onHeaderValue(const char* data, size_t length) {
 int ConnectionImpl::onHeadersCompleteBase() {
   ENVOY_CONN_LOG(trace, "headers complete", connection_);
   completeLastHeader();
-  if (!(parser_.http_major == 1 && parser_.http_minor == 1)) {
+  if (!parser_->isHttp11()) {
     // This is not necessarily true, but it's good enough since higher layers only care if this is
     // HTTP/1.1 or not.
     protocol_ = Protocol::Http10;
@@ -448,7 +505,7 @@ int ConnectionImpl::onHeadersCompleteBase() {
   current_header_map_.reset();
   header_parsing_state_ = HeaderParsingState::Done;
 
-  // Returning 2 informs http_parser to not expect a body or further data on this connection.
+  // Returning 2 informs the parser to not expect a body or further data on this connection.
   return handling_upgrade_ ? 2 : rc;
 }
 
@@ -459,7 +516,7 @@ void ConnectionImpl::onMessageCompleteBase() {
     // upgrade payload will be treated as stream body.
     ASSERT(!deferred_end_stream_headers_);
     ENVOY_CONN_LOG(trace, "Pausing parser due to upgrade.", connection_);
-    http_parser_pause(&parser_, 1);
+    parser_->pause();
     return;
   }
   onMessageComplete();
@@ -468,7 +525,8 @@ void ConnectionImpl::onMessageCompleteBase() {
 void ConnectionImpl::onMessageBeginBase() {
   ENVOY_CONN_LOG(trace, "message begin", connection_);
   ASSERT(!current_header_map_);
-  current_header_map_ = std::make_unique<HeaderMapImpl>();
+  // Each message gets its own arena, which lives as long as the header map handed to the decoder.
+  current_header_map_ = std::make_unique<HeaderMapImpl>(std::make_shared<HeaderArena>());
   header_parsing_state_ = HeaderParsingState::Field;
   onMessageBegin();
 }
@@ -482,45 +540,78 @@ void ConnectionImpl::onResetStreamBase(StreamResetReason reason) {
 ServerConnectionImpl::ServerConnectionImpl(Network::Connection& connection,
                                            ServerConnectionCallbacks& callbacks,
                                            Http1Settings settings, uint32_t max_request_headers_kb)
-    : ConnectionImpl(connection, HTTP_REQUEST, max_request_headers_kb), callbacks_(callbacks),
-      codec_settings_(settings) {}
+    : ConnectionImpl(connection, MessageType::Request, max_request_headers_kb),
+      callbacks_(callbacks), codec_settings_(settings) {}
+
+void ServerConnectionImpl::dispatch(Buffer::Instance& data) {
+  // While as many requests as may be pipelined are waiting for their responses, the ones after
+  // them stay in the buffer.
+  if (!handling_upgrade_ && !active_requests_.empty() &&
+      active_requests_.size() >= codec_settings_.max_pipelined_requests_ &&
+      active_requests_.back()->remote_complete_) {
+    return;
+  }
+
+  ConnectionImpl::dispatch(data);
+}
+
+void ServerConnectionImpl::onEncodeComplete(StreamEncoderImpl& encoder) {
+  const auto request = std::find_if(active_requests_.begin(), active_requests_.end(),
+                                    [&encoder](const ActiveRequestPtr& active_request) {
+                                      return &active_request->response_encoder_ == &encoder;
+                                    });
+  ASSERT(request != active_requests_.end());
+  (*request)->local_complete_ = true;
+  if (request != active_requests_.begin()) {
+    // The response is held until the responses to the requests before it are written.
+    return;
+  }
 
-void ServerConnectionImpl::onEncodeComplete() {
-  ASSERT(active_request_);
-  if (active_request_->remote_complete_) {
-    // Only do this if remote is complete. If we are replying before the request is complete the
-    // only logical thing to do is for higher level code to reset() / close the connection so we
-    // leave the request around so that it can fire reset callbacks.
-    active_request_.reset();
+  // Only do this if remote is complete. If we are replying before the request is complete the
+  // only logical thing to do is for higher level code to reset() / close the connection so we
+  // leave the request around so that it can fire reset callbacks.
+  while (!active_requests_.empty() && active_requests_.front()->local_complete_ &&
+         active_requests_.front()->remote_complete_) {
+    active_requests_.pop_front();
+    if (!active_requests_.empty()) {
+      // The next response is written from now on, starting with what it held so far.
+      ActiveRequest& next_request = *active_requests_.front();
+      next_request.response_encoder_.holdOutput(nullptr);
+      if (next_request.held_response_.length() > 0) {
+        connection_.write(next_request.held_response_, false);
+      }
+    }
   }
 }
 
 void ServerConnectionImpl::handlePath(HeaderMapImpl& headers, unsigned int method) {
+  ActiveRequest* active_request = parsingRequest();
+  ASSERT(active_request != nullptr);
   HeaderString path(Headers::get().Path);
 
   bool is_connect = (method == HTTP_CONNECT);
 
   // The url is relative or a wildcard when the method is OPTIONS. Nothing to do here.
-  if (active_request_->request_url_.c_str()[0] == '/' ||
-      ((method == HTTP_OPTIONS) && active_request_->request_url_.c_str()[0] == '*')) {
-    headers.addViaMove(std::move(path), std::move(active_request_->request_url_));
+  if (active_request->request_url_.c_str()[0] == '/' ||
+      ((method == HTTP_OPTIONS) && active_request->request_url_.c_str()[0] == '*')) {
+    headers.addViaMove(std::move(path), std::move(active_request->request_url_));
     return;
   }
 
   // If absolute_urls and/or connect are not going be handled, copy the url and return.
   // This forces the behavior to be backwards compatible with the old codec behavior.
   if (!codec_settings_.allow_absolute_url_) {
-    headers.addViaMove(std::move(path), std::move(active_request_->request_url_));
+    headers.addViaMove(std::move(path), std::move(active_request->request_url_));
     return;
   }
 
   if (is_connect) {
-    headers.addViaMove(std::move(path), std::move(active_request_->request_url_));
+    headers.addViaMove(std::move(path), std::move(active_request->request_url_));
     return;
   }
 
   Utility::Url absolute_url;
-  if (!absolute_url.initialize(active_request_->request_url_.getStringView())) {
+  if (!absolute_url.initialize(active_request->request_url_.getStringView())) {
     sendProtocolError();
     throw CodecProtocolException("http/1.1 protocol error: invalid url in request line");
   }
@@ -534,24 +625,25 @@ void ServerConnectionImpl::handlePath(HeaderMapImpl& headers, unsigned int metho
   headers.insertHost().value(std::string(absolute_url.host_and_port()));
 
   headers.insertPath().value(std::string(absolute_url.path()));
-  active_request_->request_url_.clear();
+  active_request->request_url_.clear();
 }
 
 int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
   // Handle the case where response happens prior to request complete. It's up to upper layer code
   // to disconnect the connection but we shouldn't fire any more events since it doesn't make
   // sense.
-  if (active_request_) {
-    const char* method_string = http_method_str(static_cast<http_method>(parser_.method));
+  ActiveRequest* active_request = parsingRequest();
+  if (active_request != nullptr) {
+    const char* method_string = http_method_str(parser_->method());
 
     // Inform the response encoder about any HEAD method, so it can set content
     // length and transfer encoding headers correctly.
-    active_request_->response_encoder_.isResponseToHeadRequest(parser_.method == HTTP_HEAD);
+    active_request->response_encoder_.isResponseToHeadRequest(parser_->method() == HTTP_HEAD);
 
     // Currently, CONNECT is not supported, however; http_parser_parse_url needs to know about
     // CONNECT
-    handlePath(*headers, parser_.method);
-    ASSERT(active_request_->request_url_.empty());
+    handlePath(*headers, parser_->method());
+    ASSERT(active_request->request_url_.empty());
 
     headers->insertMethod().value(method_string, strlen(method_string));
 
@@ -561,14 +653,13 @@ int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
     // with message complete. This allows upper layers to behave like HTTP/2 and prevents a proxy
     // scenario where the higher layers stream through and implicitly switch to chunked transfer
     // encoding because end stream with zero body length has not yet been indicated.
-    if (parser_.flags & F_CHUNKED ||
-        (parser_.content_length > 0 && parser_.content_length != ULLONG_MAX) || handling_upgrade_) {
-      active_request_->request_decoder_->decodeHeaders(std::move(headers), false);
+    if (parser_->isChunked() || parser_->contentLength().value_or(0) > 0 || handling_upgrade_) {
+      active_request->request_decoder_->decodeHeaders(std::move(headers), false);
 
       // If the connection has been closed (or is closing) after decoding headers, pause the parser
       // so we return control to the caller.
       if (connection_.state() != Network::Connection::State::Open) {
-        http_parser_pause(&parser_, 1);
+        parser_->pause();
       }
 
     } else {
@@ -581,59 +672,73 @@ int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
 
 void ServerConnectionImpl::onMessageBegin() {
   if (!resetStreamCalled()) {
-    ASSERT(!active_request_);
-    active_request_ = std::make_unique<ActiveRequest>(*this);
-    active_request_->request_decoder_ = &callbacks_.newStream(active_request_->response_encoder_);
+    ASSERT(active_requests_.size() < codec_settings_.max_pipelined_requests_);
+    active_requests_.emplace_back(std::make_unique<ActiveRequest>(*this));
+    ActiveRequest& active_request = *active_requests_.back();
+    if (active_requests_.size() > 1) {
+      active_request.response_encoder_.holdOutput(&active_request.held_response_);
+    }
+    active_request.request_decoder_ = &callbacks_.newStream(active_request.response_encoder_);
   }
 }
 
 void ServerConnectionImpl::onUrl(const char* data, size_t length) {
-  if (active_request_) {
-    active_request_->request_url_.append(data, length);
+  ActiveRequest* active_request = parsingRequest();
+  if (active_request != nullptr) {
+    active_request->request_url_.append(data, length);
   }
 }
 
-void ServerConnectionImpl::onBody(const char* data, size_t length) {
+void ServerConnectionImpl::onBody(Buffer::Instance& data) {
   ASSERT(!deferred_end_stream_headers_);
-  if (active_request_) {
-    ENVOY_CONN_LOG(trace, "body size={}", connection_, length);
-    Buffer::OwnedImpl buffer(data, length);
-    active_request_->request_decoder_->decodeData(buffer, false);
+  ActiveRequest* active_request = parsingRequest();
+  if (active_request != nullptr) {
+    ENVOY_CONN_LOG(trace, "body size={}", connection_, data.length());
+    active_request->request_decoder_->decodeData(data, false);
   }
 }
 
 void ServerConnectionImpl::onMessageComplete() {
-  if (active_request_) {
+  ActiveRequest* active_request = parsingRequest();
+  if (active_request != nullptr) {
     Buffer::OwnedImpl buffer;
-    active_request_->remote_complete_ = true;
+    active_request->remote_complete_ = true;
 
     if (deferred_end_stream_headers_) {
-      active_request_->request_decoder_->decodeHeaders(std::move(deferred_end_stream_headers_),
-                                                       true);
+      active_request->request_decoder_->decodeHeaders(std::move(deferred_end_stream_headers_),
+                                                      true);
       deferred_end_stream_headers_.reset();
     } else {
-      active_request_->request_decoder_->decodeData(buffer, true);
+      active_request->request_decoder_->decodeData(buffer, true);
     }
   }
 
   // Always pause the parser so that the calling code can process 1 request at a time and apply
   // back pressure. However this means that the calling code needs to detect if there is more data
   // in the buffer and dispatch it again.
-  http_parser_pause(&parser_, 1);
+  parser_->pause();
 }
 
 void ServerConnectionImpl::onResetStream(StreamResetReason reason) {
-  ASSERT(active_request_);
-  active_request_->response_encoder_.runResetCallbacks(reason);
-  active_request_.reset();
+  ASSERT(!active_requests_.empty());
+  // The connection cannot be used after a reset, so the requests pipelined with the one that is
+  // reset are reset as well.
+  std::list<ActiveRequestPtr> active_requests;
+  active_requests.swap(active_requests_);
+  for (const ActiveRequestPtr& active_request : active_requests) {
+    active_request->response_encoder_.runResetCallbacks(reason);
+  }
 }
 
 void ServerConnectionImpl::sendProtocolError() {
   // We do this here because we may get a protocol error before we have a logical stream. Higher
   // layers can only operate on streams, so there is no coherent way to allow them to send an error
   // "out of band." On one hand this is kind of a hack but on the other hand it normalizes HTTP/1.1
-  // to look more like HTTP/2 to higher layers.
-  if (!active_request_ || !active_request_->response_encoder_.startedResponse()) {
+  // to look more like HTTP/2 to higher layers. The response cannot be written ahead of the
+  // responses to the requests pipelined before the one in error, if any.
+  if (active_requests_.empty() ||
+      (active_requests_.size() == 1 && !active_requests_.front()->remote_complete_ &&
+       !active_requests_.front()->response_encoder_.startedResponse())) {
     Buffer::OwnedImpl bad_request_response(
         fmt::format("HTTP/1.1 {} {}\r\ncontent-length: 0\r\nconnection: close\r\n\r\n",
                     std::to_string(enumToInt(error_code_)), CodeUtility::toString(error_code_)));
@@ -643,23 +748,23 @@ void ServerConnectionImpl::sendProtocolError() {
 }
 
 void ServerConnectionImpl::onAboveHighWatermark() {
-  if (active_request_) {
-    active_request_->response_encoder_.runHighWatermarkCallbacks();
+  for (const ActiveRequestPtr& active_request : active_requests_) {
+    active_request->response_encoder_.runHighWatermarkCallbacks();
   }
 }
 void ServerConnectionImpl::onBelowLowWatermark() {
-  if (active_request_) {
-    active_request_->response_encoder_.runLowWatermarkCallbacks();
+  for (const ActiveRequestPtr& active_request : active_requests_) {
+    active_request->response_encoder_.runLowWatermarkCallbacks();
   }
 }
 
 ClientConnectionImpl::ClientConnectionImpl(Network::Connection& connection, ConnectionCallbacks&)
-    : ConnectionImpl(connection, HTTP_RESPONSE, MAX_RESPONSE_HEADERS_KB) {}
+    : ConnectionImpl(connection, MessageType::Response, MAX_RESPONSE_HEADERS_KB) {}
 
 bool ClientConnectionImpl::cannotHaveBody() {
   if ((!pending_responses_.empty() && pending_responses_.front().head_request_) ||
-      parser_.status_code == 204 || parser_.status_code == 304 ||
-      (parser_.status_code >= 200 && parser_.content_length == 0)) {
+      parser_->statusCode() == 204 || parser_->statusCode() == 304 ||
+      (parser_->statusCode() >= 200 && parser_->contentLength() == uint64_t(0))) {
     return true;
   } else {
     return false;
@@ -673,13 +778,17 @@ StreamEncoder& ClientConnectionImpl::newStream(StreamDecoder& response_decoder)
   // Streams are responsible for unwinding any outstanding readDisable(true)
   // calls done on the underlying connection as they are destroyed. As this is
   // the only place a HTTP/1 stream is destroyed where the Network::Connection is
-  // reused, unwind any outstanding readDisable() calls here.
-  while (!connection_.readEnabled()) {
-    connection_.readDisable(false);
+  // reused, unwind any outstanding readDisable() calls here. A request pipelined behind others
+  // leaves them to the streams that are still pending.
+  if (pending_responses_.empty()) {
+    while (!connection_.readEnabled()) {
+      connection_.readDisable(false);
+    }
   }
-  request_encoder_ = std::make_unique<RequestStreamEncoderImpl>(*this);
-  pending_responses_.emplace_back(&response_decoder);
-  return *request_encoder_;
+  completed_request_encoders_.clear();
+  pending_responses_.emplace_back(std::make_unique<RequestStreamEncoderImpl>(*this),
+                                  &response_decoder);
+  return *pending_responses_.back().encoder_;
 }
 
 void ClientConnectionImpl::onEncodeHeaders(const HeaderMap& headers) {
@@ -689,7 +798,7 @@ void ClientConnectionImpl::onEncodeHeaders(const HeaderMap& headers) {
 }
 
 int ClientConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
-  headers->insertStatus().value(parser_.status_code);
+  headers->insertStatus().value(parser_->statusCode());
 
   // Handle the case where the client is closing a kept alive connection (by sending a 408
   // with a 'Connection: close' header). In this case we just let response flush out followed
@@ -697,7 +806,7 @@ int ClientConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
   if (pending_responses_.empty() && !resetStreamCalled()) {
     throw PrematureResponseException(std::move(headers));
   } else if (!pending_responses_.empty()) {
-    if (parser_.status_code == 100) {
+    if (parser_->statusCode() == 100) {
       // http-parser treats 100 continue headers as their own complete response.
       // Swallow the spurious onMessageComplete and continue processing.
       ignore_message_complete_for_100_continue_ = true;
@@ -709,17 +818,15 @@ int ClientConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
     }
   }
 
-  // Here we deal with cases where the response cannot have a body, but http_parser does not deal
+  // Here we deal with cases where the response cannot have a body, but the parser does not deal
   // with it for us.
   return cannotHaveBody() ? 1 : 0;
 }
 
-void ClientConnectionImpl::onBody(const char* data, size_t length) {
+void ClientConnectionImpl::onBody(Buffer::Instance& data) {
   ASSERT(!deferred_end_stream_headers_);
   if (!pending_responses_.empty()) {
-    Buffer::OwnedImpl buffer;
-    buffer.add(data, length);
-    pending_responses_.front().decoder_->decodeData(buffer, false);
+    pending_responses_.front().decoder_->decodeData(data, false);
   }
 }
 
@@ -731,8 +838,9 @@ void ClientConnectionImpl::onMessageComplete() {
   }
   if (!pending_responses_.empty()) {
     // After calling decodeData() with end stream set to true, we should no longer be able to reset.
-    PendingResponse response = pending_responses_.front();
+    PendingResponse response = std::move(pending_responses_.front());
     pending_responses_.pop_front();
+    completed_request_encoders_.push_back(std::move(response.encoder_));
 
     if (deferred_end_stream_headers_) {
       response.decoder_->decodeHeaders(std::move(deferred_end_stream_headers_), true);
@@ -745,25 +853,29 @@ void ClientConnectionImpl::onMessageComplete() {
 }
 
 void ClientConnectionImpl::onResetStream(StreamResetReason reason) {
-  // Only raise reset if we did not already dispatch a complete response.
-  if (!pending_responses_.empty()) {
-    pending_responses_.clear();
-    request_encoder_->runResetCallbacks(reason);
+  // Only raise reset if we did not already dispatch a complete response. The connection cannot be
+  // used after a reset, so this resets all of the requests pipelined on it.
+  std::list<PendingResponse> pending_responses;
+  pending_responses.swap(pending_responses_);
+  for (const PendingResponse& response : pending_responses) {
+    response.encoder_->runResetCallbacks(reason);
   }
 }
 
 void ClientConnectionImpl::onAboveHighWatermark() {
   // This should never happen without an active stream/request.
   ASSERT(!pending_responses_.empty());
-  request_encoder_->runHighWatermarkCallbacks();
+  for (const PendingResponse& response : pending_responses_) {
+    response.encoder_->runHighWatermarkCallbacks();
+  }
 }
 
 void ClientConnectionImpl::onBelowLowWatermark() {
   // This can get called without an active stream/request when upstream decides to do bad things
   // such as sending multiple responses to the same request, causing us to close the connection, but
   // in doing so go below low watermark.
-  if (!pending_responses_.empty()) {
-    request_encoder_->runLowWatermarkCallbacks();
+  for (const PendingResponse& response : pending_responses_) {
+    response.encoder_->runLowWatermarkCallbacks();
   }
 }
 
@@ -1,7 +1,5 @@
 #pragma once
 
-#include <http_parser.h>
-
 #include <array>
 #include <cstdint>
 #include <list>
@@ -17,6 +15,7 @@
 #include "common/http/codec_helper.h"
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http1/parser.h"
 
 namespace Envoy {
 namespace Http {
@@ -49,12 +48,32 @@ public:
 
   void isResponseToHeadRequest(bool value) { is_response_to_head_request_ = value; }
 
+  /**
+   * Hold the encoded output in a buffer rather than writing it to the connection, e.g. for the
+   * response to a pipelined request while the responses to the requests before it are written.
+   * @param held_output supplies the buffer to hold the output in, or nullptr to write it.
+   */
+  void holdOutput(Buffer::Instance* held_output) { held_output_ = held_output; }
+
 protected:
   StreamEncoderImpl(ConnectionImpl& connection);
 
   static const std::string CRLF;
   static const std::string LAST_CHUNK;
 
+  /**
+   * @return uint64_t an upper bound of the size of the header block encodeHeaderBlock() writes.
+   */
+  static uint64_t headerBlockSize(const HeaderMap& headers);
+
+  /**
+   * Encode the header block, i.e. everything after the request or status line. The caller must
+   * have reserved headerBlockSize() bytes.
+   * @param headers supplies the headers to encode.
+   * @param end_stream supplies whether this is a header only request/response.
+   */
+  void encodeHeaderBlock(const HeaderMap& headers, bool end_stream);
+
   ConnectionImpl& connection_;
   void setIsContentLengthAllowed(bool value) { is_content_length_allowed_ = value; }
 
@@ -77,6 +96,7 @@ private:
   bool processing_100_continue_{false};
   bool is_response_to_head_request_{false};
   bool is_content_length_allowed_{true};
+  Buffer::Instance* held_output_{};
 };
 
 /**
@@ -121,9 +141,10 @@ public:
   Network::Connection& connection() { return connection_; }
 
   /**
-   * Called when the active encoder has completed encoding the outbound half of the stream.
+   * Called when an encoder has completed encoding the outbound half of the stream.
+   * @param encoder supplies the encoder.
    */
-  virtual void onEncodeComplete() PURE;
+  virtual void onEncodeComplete(StreamEncoderImpl& encoder) PURE;
 
   /**
    * Called when headers are encoded.
@@ -139,15 +160,19 @@ public:
 
   /**
    * Flush all pending output from encoding.
+   * @param held_output supplies the buffer to move the output into rather than writing it to the
+   *        connection, if any. @see StreamEncoderImpl::holdOutput().
    */
-  void flushOutput();
+  void flushOutput(Buffer::Instance* held_output = nullptr);
 
   void addCharToBuffer(char c);
   void addIntToBuffer(uint64_t i);
+  void addHexToBuffer(uint64_t i);
   Buffer::WatermarkBuffer& buffer() { return output_buffer_; }
   uint64_t bufferRemainingSize();
   void copyToBuffer(const char* data, uint64_t length);
   void reserveBuffer(uint64_t size);
+  void commitBuffer();
 
   // Http::Connection
   void dispatch(Buffer::Instance& data) override;
@@ -165,13 +190,13 @@ public:
   bool maybeDirectDispatch(Buffer::Instance& data);
 
 protected:
-  ConnectionImpl(Network::Connection& connection, http_parser_type type,
+  ConnectionImpl(Network::Connection& connection, MessageType type,
                  uint32_t max_request_headers_kb);
 
   bool resetStreamCalled() { return reset_stream_called_; }
 
   Network::Connection& connection_;
-  http_parser parser_;
+  ParserPtr parser_;
   HeaderMapPtr deferred_end_stream_headers_;
   Http::Code error_code_{Http::Code::BadRequest};
   bool handling_upgrade_{};
@@ -179,6 +204,30 @@ protected:
 private:
   enum class HeaderParsingState { Field, Value, Done };
 
+  /**
+   * Forwards the events of parser_ to the connection.
+   */
+  class ParserCallbacksImpl : public ParserCallbacks {
+  public:
+    ParserCallbacksImpl(ConnectionImpl& parent) : parent_(parent) {}
+
+    // Http1::ParserCallbacks
+    void onMessageBegin() override { parent_.onMessageBeginBase(); }
+    void onUrl(const char* data, size_t length) override { parent_.onUrl(data, length); }
+    void onHeaderField(const char* data, size_t length) override {
+      parent_.onHeaderField(data, length);
+    }
+    void onHeaderValue(const char* data, size_t length) override {
+      parent_.onHeaderValue(data, length);
+    }
+    int onHeadersComplete() override { return parent_.onHeadersCompleteBase(); }
+    void onBody(const char* data, size_t length) override { parent_.onBodyBase(data, length); }
+    void onMessageComplete() override { parent_.onMessageCompleteBase(); }
+
+  private:
+    ConnectionImpl& parent_;
+  };
+
   /**
    * Called in order to complete an in progress header decode.
    */
@@ -228,11 +277,14 @@ private:
   virtual int onHeadersComplete(HeaderMapImplPtr&& headers) PURE;
 
   /**
-   * Called when body data is received.
+   * Called when body data is received. A base routine moves the span out of the buffer being
+   * dispatched if it is a whole slice of it, and copies it otherwise, and then a virtual dispatch
+   * is invoked with the buffered span.
    * @param data supplies the start address.
    * @param length supplies the length.
    */
-  virtual void onBody(const char* data, size_t length) PURE;
+  void onBodyBase(const char* data, size_t length);
+  virtual void onBody(Buffer::Instance& data) PURE;
 
   /**
    * Called when the request/response is complete.
@@ -262,9 +314,10 @@ private:
    */
   virtual void onBelowLowWatermark() PURE;
 
-  static http_parser_settings settings_;
   static const ToLowerTable& toLowerTable();
 
+  ParserCallbacksImpl parser_callbacks_{*this};
+
   HeaderMapImplPtr current_header_map_;
   HeaderParsingState header_parsing_state_{HeaderParsingState::Field};
   HeaderString current_header_field_;
@@ -273,6 +326,10 @@ private:
   Buffer::WatermarkBuffer output_buffer_;
   Buffer::RawSlice reserved_iovec_;
   char* reserved_current_{};
+  // The buffer being dispatched, while dispatch() parses it, and the number of bytes of its
+  // current slice that onBodyBase() moved out of it.
+  Buffer::Instance* dispatching_buffer_{};
+  uint64_t dispatching_bytes_moved_{};
   Protocol protocol_{Protocol::Http11};
   const uint32_t max_headers_kb_;
 };
@@ -287,19 +344,42 @@ public:
 
   virtual bool supports_http_10() override { return codec_settings_.accept_http_10_; }
 
+  // Http::Connection
+  void dispatch(Buffer::Instance& data) override;
+
 private:
   /**
    * An active HTTP/1.1 request.
    */
   struct ActiveRequest {
-    ActiveRequest(ConnectionImpl& connection) : response_encoder_(connection) {}
+    ActiveRequest(ConnectionImpl& connection)
+        : response_encoder_(connection),
+          held_response_([this]() -> void { response_encoder_.runLowWatermarkCallbacks(); },
+                         [this]() -> void { response_encoder_.runHighWatermarkCallbacks(); }) {
+      held_response_.setWatermarks(connection.bufferLimit());
+    }
 
     HeaderString request_url_;
     StreamDecoder* request_decoder_{};
     ResponseStreamEncoderImpl response_encoder_;
+    // The response to a pipelined request, while the responses to the requests before it are
+    // written.
+    Buffer::WatermarkBuffer held_response_;
     bool remote_complete_{};
+    bool local_complete_{};
   };
 
+  typedef std::unique_ptr<ActiveRequest> ActiveRequestPtr;
+
+  /**
+   * @return ActiveRequest* the request whose message is being parsed, if any.
+   */
+  ActiveRequest* parsingRequest() {
+    return !active_requests_.empty() && !active_requests_.back()->remote_complete_
+               ? active_requests_.back().get()
+               : nullptr;
+  }
+
   /**
    * Manipulate the request's first line, parsing the url and converting to a relative path if
    * necessary. Compute Host / :authority headers based on 7230#5.7 and 7230#6
@@ -311,12 +391,12 @@ private:
   void handlePath(HeaderMapImpl& headers, unsigned int method);
 
   // ConnectionImpl
-  void onEncodeComplete() override;
+  void onEncodeComplete(StreamEncoderImpl& encoder) override;
   void onEncodeHeaders(const HeaderMap&) override {}
   void onMessageBegin() override;
   void onUrl(const char* data, size_t length) override;
   int onHeadersComplete(HeaderMapImplPtr&& headers) override;
-  void onBody(const char* data, size_t length) override;
+  void onBody(Buffer::Instance& data) override;
   void onMessageComplete() override;
   void onResetStream(StreamResetReason reason) override;
   void sendProtocolError() override;
@@ -324,7 +404,9 @@ private:
   void onBelowLowWatermark() override;
 
   ServerConnectionCallbacks& callbacks_;
-  std::unique_ptr<ActiveRequest> active_request_;
+  // The requests whose responses are not written yet, oldest first. Only the oldest one writes its
+  // response, and the ones pipelined behind it hold theirs.
+  std::list<ActiveRequestPtr> active_requests_;
   Http1Settings codec_settings_;
 };
 
@@ -340,8 +422,10 @@ public:
 
 private:
   struct PendingResponse {
-    PendingResponse(StreamDecoder* decoder) : decoder_(decoder) {}
+    PendingResponse(std::unique_ptr<RequestStreamEncoderImpl>&& encoder, StreamDecoder* decoder)
+        : encoder_(std::move(encoder)), decoder_(decoder) {}
 
+    std::unique_ptr<RequestStreamEncoderImpl> encoder_;
     StreamDecoder* decoder_;
     bool head_request_{};
   };
@@ -349,20 +433,24 @@ private:
   bool cannotHaveBody();
 
   // ConnectionImpl
-  void onEncodeComplete() override {}
+  void onEncodeComplete(StreamEncoderImpl&) override {}
   void onEncodeHeaders(const HeaderMap& headers) override;
   void onMessageBegin() override {}
   void onUrl(const char*, size_t) override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
   int onHeadersComplete(HeaderMapImplPtr&& headers) override;
-  void onBody(const char* data, size_t length) override;
+  void onBody(Buffer::Instance& data) override;
   void onMessageComplete() override;
   void onResetStream(StreamResetReason reason) override;
   void sendProtocolError() override {}
   void onAboveHighWatermark() override;
   void onBelowLowWatermark() override;
 
-  std::unique_ptr<RequestStreamEncoderImpl> request_encoder_;
+  // The requests whose responses are not complete yet, oldest first. More than one are pending
+  // when requests are pipelined.
   std::list<PendingResponse> pending_responses_;
+  // The encoders of the requests whose responses completed since the last new stream, which they
+  // outlive.
+  std::list<std::unique_ptr<RequestStreamEncoderImpl>> completed_request_encoders_;
   // Set true between receiving 100-Continue headers and receiving the spurious onMessageComplete.
   bool ignore_message_complete_for_100_continue_{};
 
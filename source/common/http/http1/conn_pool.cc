@@ -1,5 +1,6 @@
 #include "common/http/http1/conn_pool.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -27,7 +28,10 @@ ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSha
                            const Network::ConnectionSocket::OptionsSharedPtr& options)
     : ConnPoolImplBase(std::move(host), std::move(priority)), dispatcher_(dispatcher),
       socket_options_(options),
-      upstream_ready_timer_(dispatcher_.createTimer([this]() { onUpstreamReady(); })) {}
+      upstream_ready_timer_(dispatcher_.createTimer([this]() { onUpstreamReady(); })),
+      max_pipelined_requests_(host_->cluster().http1Settings().max_pipelined_requests_),
+      pipeline_head_of_line_timeout_(
+          host_->cluster().http1Settings().pipeline_head_of_line_timeout_) {}
 
 ConnPoolImpl::~ConnPoolImpl() {
   while (!ready_clients_.empty()) {
@@ -47,10 +51,11 @@ void ConnPoolImpl::drainConnections() {
     ready_clients_.front()->codec_client_->close();
   }
 
-  // We drain busy clients by manually setting remaining requests to 1. Thus, when the next
-  // response completes the client will be destroyed.
+  // We drain busy clients by manually setting remaining requests to the number of requests in
+  // flight, or 1 while connecting. Thus, when the last of them completes the client will be
+  // destroyed.
   for (const auto& client : busy_clients_) {
-    client->remaining_requests_ = 1;
+    client->remaining_requests_ = std::max<uint64_t>(client->stream_wrappers_.size(), 1);
   }
 }
 
@@ -65,11 +70,36 @@ bool ConnPoolImpl::hasActiveConnections() const {
 
 void ConnPoolImpl::attachRequestToClient(ActiveClient& client, StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) {
-  ASSERT(!client.stream_wrapper_);
+  ASSERT(client.stream_wrappers_.empty() || canPipeline(client));
   host_->cluster().stats().upstream_rq_total_.inc();
   host_->stats().rq_total_.inc();
-  client.stream_wrapper_ = std::make_unique<StreamWrapper>(response_decoder, client);
-  callbacks.onPoolReady(*client.stream_wrapper_, client.real_host_description_);
+  if (client.prefetched_) {
+    host_->cluster().stats().upstream_rq_prefetched_.inc();
+    client.prefetched_ = false;
+  }
+  if (!client.stream_wrappers_.empty()) {
+    host_->cluster().stats().upstream_rq_pipelined_.inc();
+  }
+  client.stream_wrappers_.emplace_back(std::make_unique<StreamWrapper>(response_decoder, client));
+  if (client.pipeline_timer_ != nullptr && client.stream_wrappers_.size() == 2) {
+    client.pipeline_timer_->enableTimer(pipeline_head_of_line_timeout_.value());
+  }
+  callbacks.onPoolReady(*client.stream_wrappers_.back(), client.real_host_description_,
+                        client.codec_client_->streamInfo());
+}
+
+bool ConnPoolImpl::canPipeline(const ActiveClient& client) const {
+  // A request is only pipelined behind requests that are completely sent, on a connection that
+  // may serve it.
+  const uint64_t num_requests = client.stream_wrappers_.size();
+  return num_requests > 0 && num_requests < max_pipelined_requests_ &&
+         client.stream_wrappers_.back()->encode_complete_ &&
+         (client.remaining_requests_ == 0 || num_requests < client.remaining_requests_) &&
+         !client.codec_client_->remoteClosed() &&
+         std::none_of(client.stream_wrappers_.begin(), client.stream_wrappers_.end(),
+                      [](const StreamWrapperPtr& stream_wrapper) {
+                        return stream_wrapper->saw_close_header_;
+                      });
 }
 
 void ConnPoolImpl::checkForDrained() {
@@ -84,34 +114,78 @@ void ConnPoolImpl::checkForDrained() {
   }
 }
 
-void ConnPoolImpl::createNewConnection() {
-  ENVOY_LOG(debug, "creating a new connection");
+void ConnPoolImpl::createNewConnection(bool prefetch) {
+  ENVOY_LOG(debug, "creating a new connection{}", prefetch ? " ahead of demand" : "");
   ActiveClientPtr client(new ActiveClient(*this));
+  if (prefetch) {
+    client->prefetched_ = true;
+    host_->cluster().stats().upstream_cx_prefetch_.inc();
+  }
   client->moveIntoList(std::move(client), busy_clients_);
 }
 
+void ConnPoolImpl::prefetchConnection() {
+  if (ready_clients_.empty() && busy_clients_.empty() &&
+      host_->cluster().resourceManager(priority_).connections().canCreate() &&
+      host_->canCreateConnection(priority_)) {
+    createNewConnection(true);
+  }
+}
+
+void ConnPoolImpl::prefetchConnections() {
+  const float ratio = host_->cluster().perUpstreamPrefetchRatio();
+  if (ratio <= 1.0) {
+    return;
+  }
+
+  // Every connection serves one request at a time, so keep ratio connections per request that is
+  // either waiting for a connection or in flight.
+  const float wanted = ratio * (pending_requests_.size() + num_active_requests_);
+  while (ready_clients_.size() + busy_clients_.size() < wanted &&
+         host_->cluster().resourceManager(priority_).connections().canCreate() &&
+         host_->canCreateConnection(priority_)) {
+    createNewConnection(true);
+  }
+}
+
 ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_decoder,
                                                      ConnectionPool::Callbacks& callbacks) {
   if (!ready_clients_.empty()) {
+    // Use the most recently released connection.
     ready_clients_.front()->moveBetweenLists(ready_clients_, busy_clients_);
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_clients_.front()->codec_client_);
     attachRequestToClient(*busy_clients_.front(), response_decoder, callbacks);
+    prefetchConnections();
     return nullptr;
   }
 
+  if (max_pipelined_requests_ > 1) {
+    for (const ActiveClientPtr& client : busy_clients_) {
+      if (canPipeline(*client)) {
+        ENVOY_CONN_LOG(debug, "pipelining on existing connection", *client->codec_client_);
+        attachRequestToClient(*client, response_decoder, callbacks);
+        prefetchConnections();
+        return nullptr;
+      }
+    }
+  }
+
   if (host_->cluster().resourceManager(priority_).pendingRequests().canCreate()) {
     bool can_create_connection =
-        host_->cluster().resourceManager(priority_).connections().canCreate();
+        host_->cluster().resourceManager(priority_).connections().canCreate() &&
+        host_->canCreateConnection(priority_);
     if (!can_create_connection) {
       host_->cluster().stats().upstream_cx_overflow_.inc();
     }
 
     // If we have no connections at all, make one no matter what so we don't starve.
     if ((ready_clients_.size() == 0 && busy_clients_.size() == 0) || can_create_connection) {
-      createNewConnection();
+      createNewConnection(false);
     }
 
-    return newPendingRequest(response_decoder, callbacks);
+    ConnectionPool::Cancellable* pending = newPendingRequest(response_decoder, callbacks);
+    prefetchConnections();
+    return pending;
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, absl::string_view(),
@@ -129,8 +203,8 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
                    client.codec_client_->connectionFailureReason());
     ActiveClientPtr removed;
     bool check_for_drained = true;
-    if (client.stream_wrapper_) {
-      if (!client.stream_wrapper_->decode_complete_) {
+    if (!client.stream_wrappers_.empty()) {
+      if (!client.stream_wrappers_.front()->decode_complete_) {
         if (event == Network::ConnectionEvent::LocalClose) {
           host_->cluster().stats().upstream_cx_destroy_local_with_active_rq_.inc();
         }
@@ -140,8 +214,8 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
         host_->cluster().stats().upstream_cx_destroy_with_active_rq_.inc();
       }
 
-      // There is an active request attached to this client. The underlying codec client will
-      // already have "reset" the stream to fire the reset callback. All we do here is just
+      // There are active requests attached to this client. The underlying codec client will
+      // already have "reset" the streams to fire the reset callbacks. All we do here is just
       // destroy the client.
       removed = client.removeFromList(busy_clients_);
     } else if (!client.connect_timer_) {
@@ -170,7 +244,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
 
     // If we have pending requests and we just lost a connection we should make a new one.
     if (pending_requests_.size() > (ready_clients_.size() + busy_clients_.size())) {
-      createNewConnection();
+      createNewConnection(false);
     }
 
     if (check_for_drained) {
@@ -200,16 +274,28 @@ void ConnPoolImpl::onDownstreamReset(ActiveClient& client) {
 
 void ConnPoolImpl::onResponseComplete(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "response complete", *client.codec_client_);
-  if (!client.stream_wrapper_->encode_complete_) {
+  const StreamWrapper& stream_wrapper = *client.stream_wrappers_.front();
+  if (!stream_wrapper.encode_complete_) {
     ENVOY_CONN_LOG(debug, "response before request complete", *client.codec_client_);
     onDownstreamReset(client);
-  } else if (client.stream_wrapper_->saw_close_header_ || client.codec_client_->remoteClosed()) {
+  } else if (stream_wrapper.saw_close_header_ || client.codec_client_->remoteClosed()) {
     ENVOY_CONN_LOG(debug, "saw upstream connection: close", *client.codec_client_);
     onDownstreamReset(client);
   } else if (client.remaining_requests_ > 0 && --client.remaining_requests_ == 0) {
     ENVOY_CONN_LOG(debug, "maximum requests per connection", *client.codec_client_);
     host_->cluster().stats().upstream_cx_max_requests_.inc();
     onDownstreamReset(client);
+  } else if (client.stream_wrappers_.size() > 1) {
+    // The client stays busy with the requests pipelined behind this one, and may take another.
+    client.stream_wrappers_.pop_front();
+    if (client.pipeline_timer_ != nullptr) {
+      if (client.stream_wrappers_.size() > 1) {
+        client.pipeline_timer_->enableTimer(pipeline_head_of_line_timeout_.value());
+      } else {
+        client.pipeline_timer_->disableTimer();
+      }
+    }
+    enableUpstreamReady();
   } else {
     // Upstream connection might be closed right after response is complete. Setting delay=true
     // here to attach pending requests in next dispatcher loop to handle that case.
@@ -230,13 +316,39 @@ void ConnPoolImpl::onUpstreamReady() {
     pending_requests_.pop_back();
     client.moveBetweenLists(ready_clients_, busy_clients_);
   }
+
+  // Pipeline the requests that are left on the busy clients. At most one request is attached to a
+  // client per pass, as attaching may close it. Sending the request completely makes the client
+  // take the next one.
+  if (max_pipelined_requests_ > 1) {
+    auto it = busy_clients_.begin();
+    while (!pending_requests_.empty() && it != busy_clients_.end()) {
+      ActiveClient& client = **it++;
+      if (canPipeline(client)) {
+        ENVOY_CONN_LOG(debug, "pipelining next request", *client.codec_client_);
+        attachRequestToClient(client, pending_requests_.back()->decoder_,
+                              pending_requests_.back()->callbacks_);
+        pending_requests_.pop_back();
+      }
+    }
+  }
+}
+
+void ConnPoolImpl::enableUpstreamReady() {
+  if (!pending_requests_.empty() && !upstream_ready_enabled_) {
+    upstream_ready_enabled_ = true;
+    upstream_ready_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
 }
 
 void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
-  client.stream_wrapper_.reset();
+  client.stream_wrappers_.clear();
+  if (client.pipeline_timer_ != nullptr) {
+    client.pipeline_timer_->disableTimer();
+  }
   if (pending_requests_.empty() || delay) {
     // There is nothing to service or delayed processing is requested, so just move the connection
-    // into the ready list.
+    // onto the front of the ready list, where it will be picked up first.
     ENVOY_CONN_LOG(debug, "moving to ready", *client.codec_client_);
     client.moveBetweenLists(busy_clients_, ready_clients_);
   } else {
@@ -248,9 +360,8 @@ void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
     pending_requests_.pop_back();
   }
 
-  if (delay && !pending_requests_.empty() && !upstream_ready_enabled_) {
-    upstream_ready_enabled_ = true;
-    upstream_ready_timer_->enableTimer(std::chrono::milliseconds(0));
+  if (delay) {
+    enableUpstreamReady();
   }
 
   checkForDrained();
@@ -263,14 +374,23 @@ ConnPoolImpl::StreamWrapper::StreamWrapper(StreamDecoder& response_decoder, Acti
   StreamEncoderWrapper::inner_.getStream().addCallbacks(*this);
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.inc();
   parent_.parent_.host_->stats().rq_active_.inc();
+  parent_.parent_.num_active_requests_++;
 }
 
 ConnPoolImpl::StreamWrapper::~StreamWrapper() {
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.dec();
   parent_.parent_.host_->stats().rq_active_.dec();
+  parent_.parent_.num_active_requests_--;
 }
 
-void ConnPoolImpl::StreamWrapper::onEncodeComplete() { encode_complete_ = true; }
+void ConnPoolImpl::StreamWrapper::onEncodeComplete() {
+  encode_complete_ = true;
+  // A pending request may be pipelined behind this one now. It is attached in the next dispatcher
+  // loop rather than while this request is being encoded.
+  if (parent_.parent_.max_pipelined_requests_ > 1) {
+    parent_.parent_.enableUpstreamReady();
+  }
+}
 
 void ConnPoolImpl::StreamWrapper::decodeHeaders(HeaderMapPtr&& headers, bool end_stream) {
   if (headers->Connection() &&
@@ -310,6 +430,9 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
       parent_.host_->cluster().stats().upstream_cx_length_ms_, parent_.dispatcher_.timeSource());
   connect_timer_->enableTimer(parent_.host_->cluster().connectTimeout());
   parent_.host_->cluster().resourceManager(parent_.priority_).connections().inc();
+  if (parent_.max_pipelined_requests_ > 1 && parent_.pipeline_head_of_line_timeout_) {
+    pipeline_timer_ = parent_.dispatcher_.createTimer([this]() -> void { onPipelineTimeout(); });
+  }
 
   codec_client_->setConnectionStats(
       {parent_.host_->cluster().stats().upstream_cx_rx_bytes_total_,
@@ -334,6 +457,14 @@ void ConnPoolImpl::ActiveClient::onConnectTimeout() {
   codec_client_->close();
 }
 
+void ConnPoolImpl::ActiveClient::onPipelineTimeout() {
+  // Closing the client resets the pipelined requests along with the one that holds them up, which
+  // lets calling code retry them elsewhere.
+  ENVOY_CONN_LOG(debug, "pipelined requests head of line timeout", *codec_client_);
+  parent_.host_->cluster().stats().upstream_cx_pipeline_timeout_.inc();
+  codec_client_->close();
+}
+
 CodecClientPtr ProdConnPoolImpl::createCodecClient(Upstream::Host::CreateConnectionData& data) {
   CodecClientPtr codec{new CodecClientProd(CodecClient::Type::HTTP1, std::move(data.connection_),
                                            data.host_description_, dispatcher_)};
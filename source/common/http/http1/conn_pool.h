@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -41,6 +42,7 @@ public:
   void addDrainedCallback(DrainedCb cb) override;
   void drainConnections() override;
   bool hasActiveConnections() const override;
+  void prefetchConnection() override;
   ConnectionPool::Cancellable* newStream(StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) override;
 
@@ -86,6 +88,7 @@ protected:
     ~ActiveClient();
 
     void onConnectTimeout();
+    void onPipelineTimeout();
 
     // Network::ConnectionCallbacks
     void onEvent(Network::ConnectionEvent event) override {
@@ -97,18 +100,31 @@ protected:
     ConnPoolImpl& parent_;
     CodecClientPtr codec_client_;
     Upstream::HostDescriptionConstSharedPtr real_host_description_;
-    StreamWrapperPtr stream_wrapper_;
+    // The requests in flight, oldest first. More than one are in flight when requests are
+    // pipelined.
+    std::list<StreamWrapperPtr> stream_wrappers_;
     Event::TimerPtr connect_timer_;
+    // Armed while the response to the oldest request holds up the requests pipelined behind it,
+    // if the cluster configures a head of line timeout.
+    Event::TimerPtr pipeline_timer_;
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
+    // Set while a connection established ahead of demand has not served its first request.
+    bool prefetched_{};
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
 
   void attachRequestToClient(ActiveClient& client, StreamDecoder& response_decoder,
                              ConnectionPool::Callbacks& callbacks);
+  /**
+   * @return bool whether another request may be pipelined on a busy client.
+   */
+  bool canPipeline(const ActiveClient& client) const;
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
-  void createNewConnection();
+  void createNewConnection(bool prefetch);
+  void enableUpstreamReady();
+  void prefetchConnections();
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onDownstreamReset(ActiveClient& client);
   void onResponseComplete(ActiveClient& client);
@@ -117,12 +133,18 @@ protected:
 
   Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
+  // Idle clients, most recently used first. Reusing the front keeps traffic on warm connections
+  // and leaves the ones at the back to be closed by the cluster's idle timeout.
   std::list<ActiveClientPtr> ready_clients_;
   std::list<ActiveClientPtr> busy_clients_;
   std::list<DrainedCb> drained_callbacks_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
   Event::TimerPtr upstream_ready_timer_;
   bool upstream_ready_enabled_{false};
+  // Requests attached to a client. The remaining busy clients are still connecting.
+  uint64_t num_active_requests_{};
+  const uint32_t max_pipelined_requests_;
+  const absl::optional<std::chrono::milliseconds> pipeline_head_of_line_timeout_;
 };
 
 /**
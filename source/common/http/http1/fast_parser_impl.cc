@@ -0,0 +1,686 @@
+#include "common/http/http1/fast_parser_impl.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#include "common/common/macros.h"
+
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+typedef std::array<bool, 256> CharTable;
+
+// RFC 7230 tchar.
+const CharTable& tokenChars() {
+  static const CharTable* table = []() {
+    CharTable* table = new CharTable();
+    for (int c = '0'; c <= '9'; c++) {
+      (*table)[c] = true;
+    }
+    for (int c = 'a'; c <= 'z'; c++) {
+      (*table)[c] = true;
+      (*table)[c - 'a' + 'A'] = true;
+    }
+    for (const char c : absl::string_view("!#$%&'*+-.^_`|~")) {
+      (*table)[static_cast<uint8_t>(c)] = true;
+    }
+    return table;
+  }();
+  return *table;
+}
+
+// Control characters and DEL are not allowed in request targets. Neither is space, which separates
+// the target from the version.
+const CharTable& invalidUrlChars() {
+  static const CharTable* table = []() {
+    CharTable* table = new CharTable();
+    for (int c = 0; c <= ' '; c++) {
+      (*table)[c] = true;
+    }
+    (*table)[0x7f] = true;
+    return table;
+  }();
+  return *table;
+}
+
+// Control characters other than HT and DEL are not allowed in header values. This matches what
+// http_parser accepts.
+const CharTable& invalidValueChars() {
+  static const CharTable* table = []() {
+    CharTable* table = new CharTable();
+    for (int c = 0; c < ' '; c++) {
+      (*table)[c] = c != '\t';
+    }
+    (*table)[0x7f] = true;
+    return table;
+  }();
+  return *table;
+}
+
+#ifdef __SSE4_2__
+// The same sets as above, as inclusive byte ranges for _mm_cmpestri().
+alignas(16) const char InvalidUrlRanges[16] = "\x00\x20\x7f\x7f";
+constexpr int InvalidUrlRangesSize = 4;
+alignas(16) const char InvalidValueRanges[16] = "\x00\x08\x0a\x1f\x7f\x7f";
+constexpr int InvalidValueRangesSize = 6;
+#endif
+
+/**
+ * @return the first character of [begin, end) that is set in table, or end if there is none. When
+ *         SSE4.2 is available, 16 characters are checked at a time against the equivalent ranges.
+ */
+const char* findChar(const char* begin, const char* end, const CharTable& table,
+                     const char* ranges, int ranges_size) {
+#ifdef __SSE4_2__
+  const __m128i ranges16 = _mm_load_si128(reinterpret_cast<const __m128i*>(ranges));
+  while (end - begin >= 16) {
+    const __m128i data16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const int index = _mm_cmpestri(ranges16, ranges_size, data16, 16,
+                                   _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+    if (index != 16) {
+      return begin + index;
+    }
+    begin += 16;
+  }
+#else
+  UNREFERENCED_PARAMETER(ranges);
+  UNREFERENCED_PARAMETER(ranges_size);
+#endif
+  for (; begin < end; begin++) {
+    if (table[static_cast<uint8_t>(*begin)]) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+bool validUrl(absl::string_view url) {
+#ifdef __SSE4_2__
+  const char* ranges = InvalidUrlRanges;
+  const int ranges_size = InvalidUrlRangesSize;
+#else
+  const char* ranges = nullptr;
+  const int ranges_size = 0;
+#endif
+  const char* end = url.data() + url.size();
+  return findChar(url.data(), end, invalidUrlChars(), ranges, ranges_size) == end;
+}
+
+bool validHeaderValue(absl::string_view value) {
+#ifdef __SSE4_2__
+  const char* ranges = InvalidValueRanges;
+  const int ranges_size = InvalidValueRangesSize;
+#else
+  const char* ranges = nullptr;
+  const int ranges_size = 0;
+#endif
+  const char* end = value.data() + value.size();
+  return findChar(value.data(), end, invalidValueChars(), ranges, ranges_size) == end;
+}
+
+bool validHeaderName(absl::string_view name) {
+  if (name.empty()) {
+    return false;
+  }
+  const CharTable& table = tokenChars();
+  for (const char c : name) {
+    if (!table[static_cast<uint8_t>(c)]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool isWhitespace(char c) { return c == ' ' || c == '\t'; }
+
+absl::string_view trimWhitespace(absl::string_view value) {
+  while (!value.empty() && isWhitespace(value.front())) {
+    value.remove_prefix(1);
+  }
+  while (!value.empty() && isWhitespace(value.back())) {
+    value.remove_suffix(1);
+  }
+  return value;
+}
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+int hexValue(char c) {
+  if (isDigit(c)) {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+struct MethodName {
+  absl::string_view name_;
+  http_method method_;
+};
+
+#define METHOD_NAME(num, name, string) {#string, HTTP_##name},
+const MethodName MethodNames[] = {HTTP_METHOD_MAP(METHOD_NAME)};
+#undef METHOD_NAME
+
+bool lookupMethod(absl::string_view name, http_method& method) {
+  for (const MethodName& entry : MethodNames) {
+    if (name == entry.name_) {
+      method = entry.method_;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isMethodPrefix(absl::string_view prefix) {
+  for (const MethodName& entry : MethodNames) {
+    if (absl::StartsWith(entry.name_, prefix)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+FastHttpParserImpl::FastHttpParserImpl(MessageType type, ParserCallbacks& callbacks,
+                                       uint32_t max_line_bytes)
+    : type_(type), callbacks_(callbacks), max_line_bytes_(max_line_bytes) {}
+
+http_errno FastHttpParserImpl::error() const {
+  if (error_ != HPE_OK) {
+    return error_;
+  }
+  return paused_ ? HPE_PAUSED : HPE_OK;
+}
+
+size_t FastHttpParserImpl::execute(const char* data, size_t length) {
+  if (error_ != HPE_OK || paused_) {
+    return 0;
+  }
+  if (length == 0) {
+    onEof();
+    return 0;
+  }
+
+  const char* current = data;
+  const char* const end = data + length;
+  // HeadersDone does not consume any input, so it is processed even once the span is exhausted.
+  while ((current < end || state_ == State::HeadersDone) && error_ == HPE_OK && !paused_) {
+    current = parseStep(current, end);
+    if (stop_) {
+      stop_ = false;
+      break;
+    }
+  }
+  return current - data;
+}
+
+const char* FastHttpParserImpl::parseStep(const char* current, const char* end) {
+  absl::string_view line;
+  switch (state_) {
+  case State::MessageStart:
+    // Like http_parser, tolerate empty lines ahead of a message.
+    while (current < end && (*current == '\r' || *current == '\n')) {
+      current++;
+    }
+    if (current == end) {
+      break;
+    }
+    // As http_parser does, reject a bad first character before the message begins.
+    if (type_ == MessageType::Request && !isMethodPrefix(absl::string_view(current, 1))) {
+      setError(HPE_INVALID_METHOD);
+    } else if (type_ == MessageType::Response && *current != 'H') {
+      setError(HPE_INVALID_CONSTANT);
+    } else {
+      beginMessage();
+    }
+    break;
+
+  case State::FirstLine:
+    if (readLine(current, end, line)) {
+      if (type_ == MessageType::Request) {
+        parseRequestLine(line);
+      } else {
+        parseStatusLine(line);
+      }
+      line_buffer_.clear();
+    } else if (type_ == MessageType::Request) {
+      checkPartialRequestLine();
+    }
+    break;
+
+  case State::HeaderLine:
+    if (readLine(current, end, line)) {
+      if (line.empty()) {
+        completeHeaders();
+      } else {
+        parseHeaderLine(line, false);
+      }
+      line_buffer_.clear();
+    }
+    break;
+
+  case State::HeadersDone:
+    setupBody();
+    break;
+
+  case State::Body: {
+    const uint64_t length = std::min<uint64_t>(body_remaining_, end - current);
+    body_remaining_ -= length;
+    callbacks_.onBody(current, length);
+    current += length;
+    if (body_remaining_ == 0) {
+      completeMessage();
+    }
+    break;
+  }
+
+  case State::BodyUntilEof:
+    callbacks_.onBody(current, end - current);
+    current = end;
+    break;
+
+  case State::ChunkSize:
+    if (readLine(current, end, line)) {
+      parseChunkSize(line);
+      line_buffer_.clear();
+    }
+    break;
+
+  case State::ChunkData: {
+    const uint64_t length = std::min<uint64_t>(body_remaining_, end - current);
+    body_remaining_ -= length;
+    callbacks_.onBody(current, length);
+    current += length;
+    if (body_remaining_ == 0) {
+      state_ = State::ChunkDataEnd;
+    }
+    break;
+  }
+
+  case State::ChunkDataEnd:
+    if (readLine(current, end, line)) {
+      if (line.empty()) {
+        state_ = State::ChunkSize;
+      } else {
+        setError(HPE_INVALID_CHUNK_SIZE);
+      }
+      line_buffer_.clear();
+    }
+    break;
+
+  case State::Trailers:
+    if (readLine(current, end, line)) {
+      if (line.empty()) {
+        completeMessage();
+      } else {
+        parseHeaderLine(line, true);
+      }
+      line_buffer_.clear();
+    }
+    break;
+
+  case State::Dead:
+    while (current < end && (*current == '\r' || *current == '\n')) {
+      current++;
+    }
+    if (current < end) {
+      setError(HPE_CLOSED_CONNECTION);
+    }
+    break;
+  }
+
+  return current;
+}
+
+bool FastHttpParserImpl::readLine(const char*& current, const char* end, absl::string_view& line) {
+  const size_t available = end - current;
+  const char* lf = static_cast<const char*>(memchr(current, '\n', available));
+  if (lf == nullptr) {
+    if (line_buffer_.size() + available > max_line_bytes_) {
+      setError(HPE_HEADER_OVERFLOW);
+      return false;
+    }
+    line_buffer_.append(current, available);
+    current = end;
+    return false;
+  }
+
+  if (line_buffer_.empty()) {
+    // The common case: the whole line is in this span and is used in place.
+    line = absl::string_view(current, lf - current);
+  } else {
+    line_buffer_.append(current, lf - current);
+    line = line_buffer_;
+  }
+  current = lf + 1;
+  if (!line.empty() && line.back() == '\r') {
+    line.remove_suffix(1);
+  }
+  return true;
+}
+
+void FastHttpParserImpl::onEof() {
+  switch (state_) {
+  case State::MessageStart:
+  case State::Dead:
+    break;
+  case State::BodyUntilEof:
+    completeMessage();
+    break;
+  default:
+    setError(HPE_INVALID_EOF_STATE);
+    break;
+  }
+}
+
+void FastHttpParserImpl::beginMessage() {
+  method_ = {};
+  status_code_ = 0;
+  http_major_ = 0;
+  http_minor_ = 0;
+  seen_header_ = false;
+  chunked_ = false;
+  content_length_ = absl::nullopt;
+  connection_close_ = false;
+  connection_keep_alive_ = false;
+  connection_upgrade_ = false;
+  upgrade_header_ = false;
+  upgrade_ = false;
+  skip_body_ = false;
+  body_remaining_ = 0;
+
+  state_ = State::FirstLine;
+  callbacks_.onMessageBegin();
+}
+
+void FastHttpParserImpl::parseRequestLine(absl::string_view line) {
+  const size_t method_end = line.find(' ');
+  if (method_end == absl::string_view::npos ||
+      !lookupMethod(line.substr(0, method_end), method_)) {
+    setError(HPE_INVALID_METHOD);
+    return;
+  }
+
+  absl::string_view url = line.substr(method_end + 1);
+  const size_t url_end = url.find(' ');
+  if (url_end == absl::string_view::npos) {
+    // A request line without a version is HTTP/0.9.
+    http_major_ = 0;
+    http_minor_ = 9;
+  } else {
+    if (!parseVersion(url.substr(url_end + 1))) {
+      setError(HPE_INVALID_VERSION);
+      return;
+    }
+    url = url.substr(0, url_end);
+  }
+  if (url.empty() || !validUrl(url)) {
+    setError(HPE_INVALID_URL);
+    return;
+  }
+
+  state_ = State::HeaderLine;
+  callbacks_.onUrl(url.data(), url.size());
+}
+
+void FastHttpParserImpl::checkPartialRequestLine() {
+  // Like http_parser, fail as soon as the method cannot be valid rather than once the line is
+  // complete.
+  const absl::string_view partial = line_buffer_;
+  const size_t method_end = partial.find(' ');
+  http_method method;
+  const bool valid = method_end == absl::string_view::npos
+                         ? isMethodPrefix(partial)
+                         : lookupMethod(partial.substr(0, method_end), method);
+  if (!valid) {
+    setError(HPE_INVALID_METHOD);
+  }
+}
+
+void FastHttpParserImpl::parseStatusLine(absl::string_view line) {
+  const size_t version_end = line.find(' ');
+  if (version_end == absl::string_view::npos || !parseVersion(line.substr(0, version_end))) {
+    setError(HPE_INVALID_VERSION);
+    return;
+  }
+
+  // The status code has at most three digits and is followed by an optional reason phrase.
+  absl::string_view status = line.substr(version_end + 1);
+  const size_t status_end = std::min(status.find(' '), status.size());
+  if (status_end == 0 || status_end > 3) {
+    setError(HPE_INVALID_STATUS);
+    return;
+  }
+  for (size_t i = 0; i < status_end; i++) {
+    if (!isDigit(status[i])) {
+      setError(HPE_INVALID_STATUS);
+      return;
+    }
+    status_code_ = status_code_ * 10 + (status[i] - '0');
+  }
+
+  state_ = State::HeaderLine;
+}
+
+bool FastHttpParserImpl::parseVersion(absl::string_view version) {
+  if (version.size() != 8 || !absl::StartsWith(version, "HTTP/") || !isDigit(version[5]) ||
+      version[6] != '.' || !isDigit(version[7])) {
+    return false;
+  }
+  http_major_ = version[5] - '0';
+  http_minor_ = version[7] - '0';
+  return true;
+}
+
+void FastHttpParserImpl::parseHeaderLine(absl::string_view line, bool trailer) {
+  if (isWhitespace(line.front())) {
+    // obs-fold: the line continues the value of the previous header.
+    if (!seen_header_ || !validHeaderValue(line)) {
+      setError(HPE_INVALID_HEADER_TOKEN);
+      return;
+    }
+    callbacks_.onHeaderValue(line.data(), line.size());
+    return;
+  }
+
+  const size_t colon = line.find(':');
+  if (colon == absl::string_view::npos) {
+    setError(HPE_INVALID_HEADER_TOKEN);
+    return;
+  }
+  const absl::string_view name = line.substr(0, colon);
+  absl::string_view value = line.substr(colon + 1);
+  while (!value.empty() && isWhitespace(value.front())) {
+    value.remove_prefix(1);
+  }
+  if (!validHeaderName(name) || !validHeaderValue(value)) {
+    setError(HPE_INVALID_HEADER_TOKEN);
+    return;
+  }
+
+  if (!trailer) {
+    processFramingHeader(name, value);
+    if (error_ != HPE_OK) {
+      return;
+    }
+  }
+
+  seen_header_ = true;
+  callbacks_.onHeaderField(name.data(), name.size());
+  // Empty values are reported too, so that the next name is never mistaken for a continuation.
+  callbacks_.onHeaderValue(value.data(), value.size());
+}
+
+void FastHttpParserImpl::processFramingHeader(absl::string_view name, absl::string_view value) {
+  if (absl::EqualsIgnoreCase(name, "content-length")) {
+    if (content_length_.has_value()) {
+      setError(HPE_UNEXPECTED_CONTENT_LENGTH);
+      return;
+    }
+    value = trimWhitespace(value);
+    if (value.empty()) {
+      setError(HPE_INVALID_CONTENT_LENGTH);
+      return;
+    }
+    uint64_t length = 0;
+    for (const char c : value) {
+      if (!isDigit(c) || length > (std::numeric_limits<uint64_t>::max() - 9) / 10) {
+        setError(HPE_INVALID_CONTENT_LENGTH);
+        return;
+      }
+      length = length * 10 + (c - '0');
+    }
+    content_length_ = length;
+  } else if (absl::EqualsIgnoreCase(name, "transfer-encoding")) {
+    // Only the final coding determines the framing.
+    const size_t last_comma = value.rfind(',');
+    const absl::string_view coding =
+        last_comma == absl::string_view::npos ? value : value.substr(last_comma + 1);
+    chunked_ = absl::EqualsIgnoreCase(trimWhitespace(coding), "chunked");
+  } else if (absl::EqualsIgnoreCase(name, "connection")) {
+    while (!value.empty()) {
+      const size_t comma = std::min(value.find(','), value.size());
+      const absl::string_view token = trimWhitespace(value.substr(0, comma));
+      if (absl::EqualsIgnoreCase(token, "close")) {
+        connection_close_ = true;
+      } else if (absl::EqualsIgnoreCase(token, "keep-alive")) {
+        connection_keep_alive_ = true;
+      } else if (absl::EqualsIgnoreCase(token, "upgrade")) {
+        connection_upgrade_ = true;
+      }
+      value.remove_prefix(std::min(comma + 1, value.size()));
+    }
+  } else if (absl::EqualsIgnoreCase(name, "upgrade")) {
+    upgrade_header_ = true;
+  }
+
+  // A message cannot be framed by both.
+  if (chunked_ && content_length_.has_value()) {
+    setError(HPE_UNEXPECTED_CONTENT_LENGTH);
+  }
+}
+
+void FastHttpParserImpl::parseChunkSize(absl::string_view line) {
+  if (line.empty() || hexValue(line.front()) < 0) {
+    setError(HPE_INVALID_CHUNK_SIZE);
+    return;
+  }
+
+  uint64_t size = 0;
+  size_t i = 0;
+  for (; i < line.size() && hexValue(line[i]) >= 0; i++) {
+    if (size > (std::numeric_limits<uint64_t>::max() >> 4)) {
+      setError(HPE_INVALID_CONTENT_LENGTH);
+      return;
+    }
+    size = (size << 4) | hexValue(line[i]);
+  }
+  // Chunk extensions are ignored.
+  if (i < line.size() && line[i] != ';' && !isWhitespace(line[i])) {
+    setError(HPE_INVALID_CHUNK_SIZE);
+    return;
+  }
+
+  if (size == 0) {
+    state_ = State::Trailers;
+  } else {
+    body_remaining_ = size;
+    state_ = State::ChunkData;
+  }
+}
+
+void FastHttpParserImpl::completeHeaders() {
+  if (upgrade_header_ && connection_upgrade_) {
+    // For responses the upgrade headers only announce support unless the status is 101.
+    upgrade_ = type_ == MessageType::Request || status_code_ == 101;
+  } else {
+    upgrade_ = type_ == MessageType::Request && method_ == HTTP_CONNECT;
+  }
+
+  state_ = State::HeadersDone;
+  switch (callbacks_.onHeadersComplete()) {
+  case 2:
+    upgrade_ = true;
+    FALLTHRU;
+  case 1:
+    skip_body_ = true;
+    break;
+  default:
+    break;
+  }
+}
+
+void FastHttpParserImpl::setupBody() {
+  const bool has_body = chunked_ || (content_length_.has_value() && content_length_.value() > 0);
+  if (upgrade_ && ((type_ == MessageType::Request && method_ == HTTP_CONNECT) || skip_body_ ||
+                   !has_body)) {
+    // The rest of the stream is in a different protocol, so stop here.
+    completeMessage();
+    stop_ = true;
+    return;
+  }
+
+  if (skip_body_) {
+    completeMessage();
+  } else if (chunked_) {
+    state_ = State::ChunkSize;
+  } else if (content_length_.has_value()) {
+    if (content_length_.value() == 0) {
+      completeMessage();
+    } else {
+      body_remaining_ = content_length_.value();
+      state_ = State::Body;
+    }
+  } else if (messageNeedsEof()) {
+    state_ = State::BodyUntilEof;
+  } else {
+    completeMessage();
+  }
+}
+
+void FastHttpParserImpl::completeMessage() {
+  state_ = shouldKeepAlive() ? State::MessageStart : State::Dead;
+  callbacks_.onMessageComplete();
+}
+
+bool FastHttpParserImpl::messageNeedsEof() const {
+  if (type_ == MessageType::Request) {
+    return false;
+  }
+  if (status_code_ / 100 == 1 || status_code_ == 204 || status_code_ == 304 || skip_body_) {
+    return false;
+  }
+  return !chunked_ && !content_length_.has_value();
+}
+
+bool FastHttpParserImpl::shouldKeepAlive() const {
+  if (http_major_ > 0 && http_minor_ > 0) {
+    if (connection_close_) {
+      return false;
+    }
+  } else if (!connection_keep_alive_) {
+    return false;
+  }
+  return !messageNeedsEof();
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "common/http/http1/parser.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Line oriented HTTP/1 parser. The request/status line, header lines and chunk size lines are
+ * located with memchr() and validated with table lookups (SSE4.2 string instructions when the
+ * build enables them), after which the callbacks receive pointers straight into the span being
+ * parsed. Only a line that straddles two spans is copied, into a buffer bounded by max_line_bytes.
+ * Bodies are never copied.
+ *
+ * Errors and framing decisions follow http_parser, see LegacyHttpParserImpl, so that the two can
+ * be used interchangeably. Unlike http_parser, the name and value of a header are each delivered
+ * in a single callback, and a header line longer than max_line_bytes fails with
+ * HPE_HEADER_OVERFLOW.
+ */
+class FastHttpParserImpl : public Parser {
+public:
+  FastHttpParserImpl(MessageType type, ParserCallbacks& callbacks, uint32_t max_line_bytes);
+
+  // Http1::Parser
+  size_t execute(const char* data, size_t length) override;
+  void pause() override { paused_ = true; }
+  void resume() override { paused_ = false; }
+  http_errno error() const override;
+  http_method method() const override { return method_; }
+  uint16_t statusCode() const override { return status_code_; }
+  bool isHttp11() const override { return http_major_ == 1 && http_minor_ == 1; }
+  bool isChunked() const override { return chunked_; }
+  absl::optional<uint64_t> contentLength() const override { return content_length_; }
+
+private:
+  enum class State {
+    MessageStart,
+    FirstLine,
+    HeaderLine,
+    // The header block has been handed to the callbacks, but the body framing has not been set up.
+    HeadersDone,
+    Body,
+    BodyUntilEof,
+    ChunkSize,
+    ChunkData,
+    ChunkDataEnd,
+    Trailers,
+    // The connection cannot carry another message.
+    Dead
+  };
+
+  const char* parseStep(const char* current, const char* end);
+  bool readLine(const char*& current, const char* end, absl::string_view& line);
+  void onEof();
+
+  void beginMessage();
+  void parseRequestLine(absl::string_view line);
+  void checkPartialRequestLine();
+  void parseStatusLine(absl::string_view line);
+  bool parseVersion(absl::string_view version);
+  void parseHeaderLine(absl::string_view line, bool trailer);
+  void processFramingHeader(absl::string_view name, absl::string_view value);
+  void parseChunkSize(absl::string_view line);
+  void completeHeaders();
+  void setupBody();
+  void completeMessage();
+  bool messageNeedsEof() const;
+  bool shouldKeepAlive() const;
+  void setError(http_errno error) { error_ = error; }
+
+  const MessageType type_;
+  ParserCallbacks& callbacks_;
+  const uint32_t max_line_bytes_;
+
+  State state_{State::MessageStart};
+  http_errno error_{HPE_OK};
+  bool paused_{};
+  // Set when execute() must return because the rest of the stream is in a different protocol.
+  bool stop_{};
+  // Holds the start of a line that straddles the spans passed to execute().
+  std::string line_buffer_;
+
+  // State of the current message.
+  http_method method_{};
+  uint16_t status_code_{};
+  uint8_t http_major_{};
+  uint8_t http_minor_{};
+  bool seen_header_{};
+  bool chunked_{};
+  absl::optional<uint64_t> content_length_;
+  bool connection_close_{};
+  bool connection_keep_alive_{};
+  bool connection_upgrade_{};
+  bool upgrade_header_{};
+  bool upgrade_{};
+  bool skip_body_{};
+  uint64_t body_remaining_{};
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
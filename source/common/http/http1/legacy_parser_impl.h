@@ -0,0 +1,37 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Parser backed by the callback based nodejs http_parser.
+ */
+class LegacyHttpParserImpl : public Parser {
+public:
+  LegacyHttpParserImpl(MessageType type, ParserCallbacks& callbacks);
+
+  // Http1::Parser
+  size_t execute(const char* data, size_t length) override;
+  void pause() override { http_parser_pause(&parser_, 1); }
+  void resume() override { http_parser_pause(&parser_, 0); }
+  http_errno error() const override { return HTTP_PARSER_ERRNO(&parser_); }
+  http_method method() const override { return static_cast<http_method>(parser_.method); }
+  uint16_t statusCode() const override { return parser_.status_code; }
+  bool isHttp11() const override { return parser_.http_major == 1 && parser_.http_minor == 1; }
+  bool isChunked() const override { return parser_.flags & F_CHUNKED; }
+  absl::optional<uint64_t> contentLength() const override;
+
+private:
+  static http_parser_settings settings_;
+
+  http_parser parser_;
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
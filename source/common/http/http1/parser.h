@@ -0,0 +1,131 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+enum class MessageType { Request, Response };
+
+/**
+ * Events raised by a Parser as it makes progress through HTTP/1 messages. Data pointers are only
+ * valid for the duration of the call. Callbacks may throw, in which case the parser must not be
+ * used again.
+ */
+class ParserCallbacks {
+public:
+  virtual ~ParserCallbacks() {}
+
+  /**
+   * Called when the first byte of a message has been seen.
+   */
+  virtual void onMessageBegin() PURE;
+
+  /**
+   * Called with (a part of) the request target. Not called for responses.
+   */
+  virtual void onUrl(const char* data, size_t length) PURE;
+
+  /**
+   * Called with (a part of) a header name. Also called for trailers.
+   */
+  virtual void onHeaderField(const char* data, size_t length) PURE;
+
+  /**
+   * Called with (a part of) a header value. Also called for trailers.
+   */
+  virtual void onHeaderValue(const char* data, size_t length) PURE;
+
+  /**
+   * Called once the header block has been parsed.
+   * @return 0 to continue with the framing the headers imply, 1 if the message has no body, 2 if
+   *         the message has no body and the rest of the stream is in a different protocol.
+   */
+  virtual int onHeadersComplete() PURE;
+
+  /**
+   * Called with (a part of) the body, with any chunked encoding removed. The parser does not read
+   * the span again once it has been reported, so the callee may take over its memory.
+   */
+  virtual void onBody(const char* data, size_t length) PURE;
+
+  /**
+   * Called when the message is complete.
+   */
+  virtual void onMessageComplete() PURE;
+};
+
+/**
+ * Incremental parser of a stream of HTTP/1 messages. Errors are reported with the http_parser
+ * error codes so that the parsers are interchangeable.
+ */
+class Parser {
+public:
+  virtual ~Parser() {}
+
+  /**
+   * Parse the next span of the stream.
+   * @param data supplies the start of the span.
+   * @param length supplies the length of the span. A length of 0 signals the end of the stream.
+   * @return size_t the number of bytes consumed. This is less than length if the parser has been
+   *         paused or an error occurred, see error().
+   */
+  virtual size_t execute(const char* data, size_t length) PURE;
+
+  /**
+   * Pause the parser. Typically called from a callback, in which case execute() returns once the
+   * callback returns.
+   */
+  virtual void pause() PURE;
+
+  /**
+   * Clear a previous pause().
+   */
+  virtual void resume() PURE;
+
+  /**
+   * @return http_errno HPE_OK, HPE_PAUSED if paused, or the error that stopped the parser.
+   */
+  virtual http_errno error() const PURE;
+
+  /**
+   * @return http_method the method of the current request.
+   */
+  virtual http_method method() const PURE;
+
+  /**
+   * @return uint16_t the status code of the current response.
+   */
+  virtual uint16_t statusCode() const PURE;
+
+  /**
+   * @return bool whether the current message is HTTP/1.1.
+   */
+  virtual bool isHttp11() const PURE;
+
+  /**
+   * @return bool whether the current message uses chunked transfer encoding.
+   */
+  virtual bool isChunked() const PURE;
+
+  /**
+   * @return the content-length of the current message, if any. Only valid from
+   *         ParserCallbacks::onHeadersComplete().
+   */
+  virtual absl::optional<uint64_t> contentLength() const PURE;
+};
+
+typedef std::unique_ptr<Parser> ParserPtr;
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,69 @@
+#include "common/http/http2/bdp_estimator.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+namespace {
+constexpr std::chrono::microseconds InitialProbeInterval = std::chrono::milliseconds(100);
+constexpr std::chrono::microseconds MaxProbeInterval = std::chrono::seconds(10);
+} // namespace
+
+BdpEstimator::BdpEstimator(uint32_t initial_estimate, uint32_t max_estimate,
+                           TimeSource& time_source)
+    : max_estimate_(max_estimate), time_source_(time_source), estimate_(initial_estimate),
+      probe_interval_(InitialProbeInterval) {
+  ASSERT(initial_estimate > 0);
+}
+
+bool BdpEstimator::onDataReceived(uint64_t bytes) {
+  if (probing_) {
+    accumulator_ += bytes;
+    return false;
+  }
+  if (estimate_ >= max_estimate_) {
+    return false;
+  }
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (now < next_probe_) {
+    return false;
+  }
+  probing_ = true;
+  probe_start_ = now;
+  accumulator_ = 0;
+  return true;
+}
+
+bool BdpEstimator::onProbeAcked() {
+  ASSERT(probing_);
+  probing_ = false;
+  const MonotonicTime now = time_source_.monotonicTime();
+  // A round trip below the resolution of the clock counts as one microsecond.
+  const double rtt_us = std::max<int64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(now - probe_start_).count(), 1);
+  const double bandwidth = accumulator_ / rtt_us;
+
+  bool grew = false;
+  if (accumulator_ > 2 * static_cast<uint64_t>(estimate_) / 3 && bandwidth > bandwidth_) {
+    estimate_ = std::min<uint64_t>(
+        std::max<uint64_t>(accumulator_, 2 * static_cast<uint64_t>(estimate_)), max_estimate_);
+    bandwidth_ = bandwidth;
+    probe_interval_ /= 2;
+    stable_probes_ = 0;
+    grew = true;
+  } else if (++stable_probes_ >= 2) {
+    probe_interval_ =
+        std::min(std::max(probe_interval_ * 2, InitialProbeInterval), MaxProbeInterval);
+  }
+  next_probe_ = now + probe_interval_;
+  accumulator_ = 0;
+  return grew;
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
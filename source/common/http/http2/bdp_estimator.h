@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "envoy/common/time.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * Estimates the bandwidth-delay product of a connection to size its receive flow-control windows,
+ * the way gRPC does. A probe counts the DATA bytes received during the round trip of a PING that
+ * is sent when data arrives. If they come close to the current estimate while the measured
+ * bandwidth still increases, the window rather than the path limits the throughput, so the
+ * estimate at least doubles, up to a maximum. Probes follow each other more closely while the
+ * estimate grows, and back off once it is stable.
+ */
+class BdpEstimator {
+public:
+  /**
+   * @param initial_estimate supplies the initial estimate, which is the initial window size.
+   * @param max_estimate supplies the size that the estimate never grows beyond.
+   * @param time_source supplies the time source that round trips and probe intervals are measured
+   *        with.
+   */
+  BdpEstimator(uint32_t initial_estimate, uint32_t max_estimate, TimeSource& time_source);
+
+  /**
+   * Account for received DATA payload.
+   * @param bytes supplies the number of payload bytes received.
+   * @return bool whether a probe started, for which the caller must send a PING.
+   */
+  bool onDataReceived(uint64_t bytes);
+
+  /**
+   * Complete the probe in flight when the ACK of its PING is received.
+   * @return bool whether the estimate grew.
+   */
+  bool onProbeAcked();
+
+  /**
+   * @return bool whether a probe is in flight.
+   */
+  bool probing() const { return probing_; }
+
+  /**
+   * @return uint32_t the current estimate in bytes.
+   */
+  uint32_t estimate() const { return estimate_; }
+
+private:
+  const uint32_t max_estimate_;
+  TimeSource& time_source_;
+  uint32_t estimate_;
+  // The highest bandwidth measured by a probe that grew the estimate, in bytes per microsecond.
+  double bandwidth_{};
+  // DATA bytes received since the probe in flight started.
+  uint64_t accumulator_{};
+  bool probing_{};
+  MonotonicTime probe_start_;
+  MonotonicTime next_probe_;
+  std::chrono::microseconds probe_interval_;
+  // The number of probes in a row that did not grow the estimate.
+  uint32_t stable_probes_{};
+};
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
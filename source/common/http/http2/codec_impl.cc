@@ -1,6 +1,7 @@
 #include "common/http/http2/codec_impl.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -13,6 +14,7 @@
 #include "common/common/assert.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
+#include "common/common/macros.h"
 #include "common/common/stack_array.h"
 #include "common/common/utility.h"
 #include "common/http/codes.h"
@@ -23,6 +25,10 @@ namespace Envoy {
 namespace Http {
 namespace Http2 {
 
+// The opaque data of the PINGs that probe the bandwidth-delay product, which tells their ACKs
+// apart from those of PINGs sent by anyone else.
+static const uint8_t BDP_PING_DATA[8] = {'e', 'n', 'v', 'o', 'y', 'b', 'd', 'p'};
+
 bool Utility::reconstituteCrumbledCookies(const HeaderString& key, const HeaderString& value,
                                           HeaderString& cookies) {
   if (key != Headers::get().Cookie.get().c_str()) {
@@ -61,7 +67,8 @@ template <typename T> static T* remove_const(const void* object) {
 }
 
 ConnectionImpl::StreamImpl::StreamImpl(ConnectionImpl& parent, uint32_t buffer_limit)
-    : parent_(parent), headers_(new HeaderMapImpl()), local_end_stream_sent_(false),
+    : parent_(parent), header_arena_(std::make_shared<HeaderArena>()),
+      headers_(new HeaderMapImpl(header_arena_)), local_end_stream_sent_(false),
       remote_end_stream_(false), data_deferred_(false),
       waiting_for_non_informational_headers_(false),
       pending_receive_buffer_high_watermark_called_(false),
@@ -71,8 +78,9 @@ ConnectionImpl::StreamImpl::StreamImpl(ConnectionImpl& parent, uint32_t buffer_l
   }
 }
 
-static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& header) {
-  uint8_t flags = 0;
+static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& header,
+                         bool never_index) {
+  uint8_t flags = never_index ? NGHTTP2_NV_FLAG_NO_INDEX : 0;
   if (header.key().type() == HeaderString::Type::Reference) {
     flags |= NGHTTP2_NV_FLAG_NO_COPY_NAME;
   }
@@ -86,14 +94,24 @@ static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& he
 
 void ConnectionImpl::StreamImpl::buildHeaders(std::vector<nghttp2_nv>& final_headers,
                                               const HeaderMap& headers) {
+  struct Context {
+    std::vector<nghttp2_nv>& final_headers_;
+    const ConnectionImpl& connection_;
+    uint64_t header_bytes_;
+  } context{final_headers, parent_, 0};
+
   final_headers.reserve(headers.size());
   headers.iterate(
       [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
-        std::vector<nghttp2_nv>* final_headers = static_cast<std::vector<nghttp2_nv>*>(context);
-        insertHeader(*final_headers, header);
+        Context* build = static_cast<Context*>(context);
+        insertHeader(build->final_headers_, header, build->connection_.neverIndex(header.key()));
+        build->header_bytes_ += header.key().size() + header.value().size();
         return HeaderMap::Iterate::Continue;
       },
-      &final_headers);
+      &context);
+
+  parent_.tx_header_bytes_ += context.header_bytes_;
+  parent_.stats_.tx_header_bytes_.add(context.header_bytes_);
 }
 
 void ConnectionImpl::StreamImpl::encode100ContinueHeaders(const HeaderMap& headers) {
@@ -251,6 +269,17 @@ ssize_t ConnectionImpl::StreamImpl::onDataSourceRead(uint64_t length, uint32_t*
       }
     }
 
+    // nghttp2 never asks for more than the peer's windows allow, so when they bound this frame
+    // and data remains, the stream stalls until the peer sends WINDOW_UPDATE.
+    if (pending_send_data_.length() > length) {
+      const int32_t window =
+          std::min(nghttp2_session_get_stream_remote_window_size(parent_.session_, stream_id_),
+                   nghttp2_session_get_remote_window_size(parent_.session_));
+      if (window >= 0 && static_cast<uint64_t>(window) <= length) {
+        parent_.stats_.tx_flow_control_stall_.inc();
+      }
+    }
+
     return std::min(length, pending_send_data_.length());
   }
 }
@@ -347,7 +376,16 @@ void ConnectionImpl::StreamImpl::onMetadataDecoded(MetadataMapPtr&& metadata_map
   decoder_->decodeMetadata(std::move(metadata_map_ptr));
 }
 
-ConnectionImpl::~ConnectionImpl() { nghttp2_session_del(session_); }
+ConnectionImpl::~ConnectionImpl() {
+  if (tx_header_bytes_ > 0) {
+    stats_.tx_header_compression_percent_.recordValue(tx_header_block_bytes_ * 100 /
+                                                      tx_header_bytes_);
+  }
+  if (bdp_estimator_ != nullptr) {
+    stats_.rx_window_size_.recordValue(bdp_estimator_->estimate());
+  }
+  nghttp2_session_del(session_);
+}
 
 void ConnectionImpl::dispatch(Buffer::Instance& data) {
   ENVOY_CONN_LOG(trace, "dispatching {} bytes", connection_, data.length());
@@ -372,11 +410,30 @@ void ConnectionImpl::dispatch(Buffer::Instance& data) {
   sendPendingFrames();
 }
 
+bool ConnectionImpl::neverIndex(const HeaderString& key) const {
+  if (never_index_headers_.empty()) {
+    return false;
+  }
+  // The list is expected to hold a handful of names, so a scan beats hashing every header.
+  const absl::string_view name = key.getStringView();
+  for (const LowerCaseString& never_index : never_index_headers_) {
+    if (never_index.get() == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
 ConnectionImpl::StreamImpl* ConnectionImpl::getStream(int32_t stream_id) {
   return static_cast<StreamImpl*>(nghttp2_session_get_stream_user_data(session_, stream_id));
 }
 
 int ConnectionImpl::onData(int32_t stream_id, const uint8_t* data, size_t len) {
+  if (bdp_estimator_ != nullptr && bdp_estimator_->onDataReceived(len)) {
+    int rc = nghttp2_submit_ping(session_, NGHTTP2_FLAG_NONE, BDP_PING_DATA);
+    ASSERT(rc == 0);
+  }
+
   StreamImpl* stream = getStream(stream_id);
   // If this results in buffering too much data, the watermark buffer will call
   // pendingRecvBufferHighWatermark, resulting in ++read_disable_count_
@@ -391,6 +448,27 @@ int ConnectionImpl::onData(int32_t stream_id, const uint8_t* data, size_t len) {
   return 0;
 }
 
+void ConnectionImpl::onBdpProbeAcked() {
+  if (!bdp_estimator_->onProbeAcked()) {
+    return;
+  }
+
+  // The peer applies the new initial window to all streams, including the open ones. The
+  // per-stream buffer limit stays at the initial window, so a slow consumer still stops the flow
+  // of data through the watermarks rather than by the window.
+  const uint32_t window_size = bdp_estimator_->estimate();
+  ENVOY_CONN_LOG(debug, "growing receive windows to {}", connection_, window_size);
+  stats_.rx_window_increase_.inc();
+  nghttp2_settings_entry setting{NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, window_size};
+  int rc = nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, &setting, 1);
+  ASSERT(rc == 0);
+  if (window_size > local_connection_window_size_) {
+    local_connection_window_size_ = window_size;
+    rc = nghttp2_session_set_local_window_size(session_, NGHTTP2_FLAG_NONE, 0, window_size);
+    ASSERT(rc == 0);
+  }
+}
+
 void ConnectionImpl::goAway() {
   int rc = nghttp2_submit_goaway(session_, NGHTTP2_FLAG_NONE,
                                  nghttp2_session_get_last_proc_stream_id(session_),
@@ -419,6 +497,13 @@ int ConnectionImpl::onFrameReceived(const nghttp2_frame* frame) {
     return 0;
   }
 
+  if (frame->hd.type == NGHTTP2_PING && (frame->hd.flags & NGHTTP2_FLAG_ACK) &&
+      bdp_estimator_ != nullptr && bdp_estimator_->probing() &&
+      memcmp(frame->ping.opaque_data, BDP_PING_DATA, sizeof(BDP_PING_DATA)) == 0) {
+    onBdpProbeAcked();
+    return 0;
+  }
+
   StreamImpl* stream = getStream(frame->hd.stream_id);
   if (!stream) {
     return 0;
@@ -534,6 +619,11 @@ int ConnectionImpl::onFrameSend(const nghttp2_frame* frame) {
   }
 
   case NGHTTP2_HEADERS:
+    // nghttp2 reports the whole header block here, including any CONTINUATION frames. Envoy sends
+    // neither padding nor priority, so this is the HPACK encoded size.
+    tx_header_block_bytes_ += frame->hd.length;
+    stats_.tx_header_block_bytes_.add(frame->hd.length);
+    FALLTHRU;
   case NGHTTP2_DATA: {
     StreamImpl* stream = getStream(frame->hd.stream_id);
     stream->local_end_stream_sent_ = frame->hd.flags & NGHTTP2_FLAG_END_STREAM;
@@ -791,7 +881,13 @@ ConnectionImpl::Http2Callbacks::Http2Callbacks() {
         HeaderString name;
         name.setCopy(reinterpret_cast<const char*>(raw_name), name_length);
         HeaderString value;
-        value.setCopy(reinterpret_cast<const char*>(raw_value), value_length);
+        const std::string* static_value = StaticHeaderValues::find(
+            absl::string_view(reinterpret_cast<const char*>(raw_value), value_length));
+        if (static_value != nullptr) {
+          value.setReference(*static_value);
+        } else {
+          value.setCopy(reinterpret_cast<const char*>(raw_value), value_length);
+        }
         return static_cast<ConnectionImpl*>(user_data)->onHeader(frame, std::move(name),
                                                                  std::move(value));
       });
@@ -872,8 +968,10 @@ ConnectionImpl::Http2Options::Http2Options(const Http2Settings& http2_settings)
   // trigger the check within nghttp2, as we check request headers length in codec_impl::saveHeader.
   nghttp2_option_set_max_send_header_block_length(options_, 0x2000000);
 
-  if (http2_settings.hpack_table_size_ != NGHTTP2_DEFAULT_HEADER_TABLE_SIZE) {
-    nghttp2_option_set_max_deflate_dynamic_table_size(options_, http2_settings.hpack_table_size_);
+  const uint32_t encoder_table_size =
+      http2_settings.hpack_encoder_table_size_.value_or(http2_settings.hpack_table_size_);
+  if (encoder_table_size != NGHTTP2_DEFAULT_HEADER_TABLE_SIZE) {
+    nghttp2_option_set_max_deflate_dynamic_table_size(options_, encoder_table_size);
   }
 
   if (http2_settings.allow_metadata_) {
@@ -928,7 +1026,7 @@ int ClientConnectionImpl::onBeginHeaders(const nghttp2_frame* frame) {
   if (frame->headers.cat == NGHTTP2_HCAT_HEADERS) {
     StreamImpl* stream = getStream(frame->hd.stream_id);
     ASSERT(!stream->headers_);
-    stream->headers_ = std::make_unique<HeaderMapImpl>();
+    stream->headers_ = std::make_unique<HeaderMapImpl>(stream->header_arena_);
   }
 
   return 0;
@@ -964,7 +1062,7 @@ int ServerConnectionImpl::onBeginHeaders(const nghttp2_frame* frame) {
 
     StreamImpl* stream = getStream(frame->hd.stream_id);
     ASSERT(!stream->headers_);
-    stream->headers_ = std::make_unique<HeaderMapImpl>();
+    stream->headers_ = std::make_unique<HeaderMapImpl>(stream->header_arena_);
     return 0;
   }
 
@@ -17,6 +17,7 @@
 #include "common/common/logger.h"
 #include "common/http/codec_helper.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http2/bdp_estimator.h"
 #include "common/http/http2/metadata_decoder.h"
 #include "common/http/http2/metadata_encoder.h"
 #include "common/http/utility.h"
@@ -38,21 +39,27 @@ const std::string CLIENT_MAGIC_PREFIX = "PRI * HTTP/2";
  * All stats for the HTTP/2 codec. @see stats_macros.h
  */
 // clang-format off
-#define ALL_HTTP2_CODEC_STATS(COUNTER)                                                             \
+#define ALL_HTTP2_CODEC_STATS(COUNTER, HISTOGRAM)                                                  \
   COUNTER(header_overflow)                                                                         \
   COUNTER(headers_cb_no_stream)                                                                    \
   COUNTER(rx_messaging_error)                                                                      \
   COUNTER(rx_reset)                                                                                \
+  COUNTER(rx_window_increase)                                                                      \
   COUNTER(too_many_header_frames)                                                                  \
   COUNTER(trailers)                                                                                \
-  COUNTER(tx_reset)
+  COUNTER(tx_header_block_bytes)                                                                   \
+  COUNTER(tx_header_bytes)                                                                         \
+  COUNTER(tx_flow_control_stall)                                                                   \
+  COUNTER(tx_reset)                                                                                \
+  HISTOGRAM(rx_window_size)                                                                        \
+  HISTOGRAM(tx_header_compression_percent)
 // clang-format on
 
 /**
  * Wrapper struct for the HTTP/2 codec stats. @see stats_macros.h
  */
 struct CodecStats {
-  ALL_HTTP2_CODEC_STATS(GENERATE_COUNTER_STRUCT)
+  ALL_HTTP2_CODEC_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 class Utility {
@@ -80,10 +87,20 @@ class ConnectionImpl : public virtual Connection, protected Logger::Loggable<Log
 public:
   ConnectionImpl(Network::Connection& connection, Stats::Scope& stats,
                  const Http2Settings& http2_settings, const uint32_t max_request_headers_kb)
-      : stats_{ALL_HTTP2_CODEC_STATS(POOL_COUNTER_PREFIX(stats, "http2."))},
+      : stats_{ALL_HTTP2_CODEC_STATS(POOL_COUNTER_PREFIX(stats, "http2."),
+                                     POOL_HISTOGRAM_PREFIX(stats, "http2."))},
         connection_(connection), max_request_headers_kb_(max_request_headers_kb),
-        per_stream_buffer_limit_(http2_settings.initial_stream_window_size_), dispatching_(false),
-        raised_goaway_(false), pending_deferred_reset_(false) {}
+        per_stream_buffer_limit_(http2_settings.initial_stream_window_size_),
+        never_index_headers_(http2_settings.never_index_headers_),
+        local_connection_window_size_(http2_settings.initial_connection_window_size_),
+        dispatching_(false), raised_goaway_(false), pending_deferred_reset_(false) {
+    if (http2_settings.max_adaptive_window_size_.value_or(0) >
+        http2_settings.initial_stream_window_size_) {
+      bdp_estimator_ = std::make_unique<BdpEstimator>(
+          http2_settings.initial_stream_window_size_,
+          http2_settings.max_adaptive_window_size_.value(), connection.dispatcher().timeSource());
+    }
+  }
 
   ~ConnectionImpl();
 
@@ -154,7 +171,7 @@ protected:
     ssize_t onDataSourceRead(uint64_t length, uint32_t* data_flags);
     int onDataSourceSend(const uint8_t* framehd, size_t length);
     void resetStreamWorker(StreamResetReason reason);
-    static void buildHeaders(std::vector<nghttp2_nv>& final_headers, const HeaderMap& headers);
+    void buildHeaders(std::vector<nghttp2_nv>& final_headers, const HeaderMap& headers);
     void saveHeader(HeaderString&& name, HeaderString&& value);
     virtual void submitHeaders(const std::vector<nghttp2_nv>& final_headers,
                                nghttp2_data_provider* provider) PURE;
@@ -207,6 +224,8 @@ protected:
     bool buffers_overrun() const { return read_disable_count_ > 0; }
 
     ConnectionImpl& parent_;
+    // Shared by the headers and trailers received on this stream.
+    HeaderArenaSharedPtr header_arena_;
     HeaderMapImplPtr headers_;
     StreamDecoder* decoder_{};
     int32_t stream_id_{-1};
@@ -281,6 +300,7 @@ protected:
 
   ConnectionImpl* base() { return this; }
   StreamImpl* getStream(int32_t stream_id);
+  bool neverIndex(const HeaderString& key) const;
   int saveHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value);
   void sendPendingFrames();
   void sendSettings(const Http2Settings& http2_settings, bool disable_push);
@@ -294,12 +314,22 @@ protected:
   const uint32_t max_request_headers_kb_;
   uint32_t per_stream_buffer_limit_;
   bool allow_metadata_;
+  const std::vector<LowerCaseString> never_index_headers_;
+  // Header bytes handed to nghttp2 on this connection, and the size of the HPACK encoded blocks
+  // that carried them. Their ratio is recorded when the connection is destroyed.
+  uint64_t tx_header_bytes_{};
+  uint64_t tx_header_block_bytes_{};
+  // Grows the receive windows when adaptive windows are configured, otherwise nullptr.
+  std::unique_ptr<BdpEstimator> bdp_estimator_;
+  // The connection-level receive window size, which only grows.
+  uint32_t local_connection_window_size_;
 
 private:
   virtual ConnectionCallbacks& callbacks() PURE;
   virtual int onBeginHeaders(const nghttp2_frame* frame) PURE;
   int onData(int32_t stream_id, const uint8_t* data, size_t len);
   int onFrameReceived(const nghttp2_frame* frame);
+  void onBdpProbeAcked();
   int onFrameSend(const nghttp2_frame* frame);
   virtual int onHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value) PURE;
   int onInvalidFrame(int32_t stream_id, int error_code);
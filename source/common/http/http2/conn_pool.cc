@@ -22,12 +22,14 @@ ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSha
       socket_options_(options) {}
 
 ConnPoolImpl::~ConnPoolImpl() {
-  if (primary_client_) {
-    primary_client_->client_->close();
+  for (auto it = primary_clients_.begin(); it != primary_clients_.end();) {
+    ActiveClient& client = **it++;
+    client.client_->close();
   }
 
-  if (draining_client_) {
-    draining_client_->client_->close();
+  for (auto it = draining_clients_.begin(); it != draining_clients_.end();) {
+    ActiveClient& client = **it++;
+    client.client_->close();
   }
 
   // Make sure all clients are destroyed before we are destroyed.
@@ -35,8 +37,9 @@ ConnPoolImpl::~ConnPoolImpl() {
 }
 
 void ConnPoolImpl::ConnPoolImpl::drainConnections() {
-  if (primary_client_ != nullptr) {
-    movePrimaryClientToDraining();
+  for (auto it = primary_clients_.begin(); it != primary_clients_.end();) {
+    ActiveClient& client = **it++;
+    movePrimaryClientToDraining(client);
   }
 }
 
@@ -46,12 +49,16 @@ void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
 }
 
 bool ConnPoolImpl::hasActiveConnections() const {
-  if (primary_client_ && primary_client_->client_->numActiveRequests() > 0) {
-    return true;
+  for (const ActiveClientPtr& client : primary_clients_) {
+    if (client->client_->numActiveRequests() > 0) {
+      return true;
+    }
   }
 
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
-    return true;
+  for (const ActiveClientPtr& client : draining_clients_) {
+    if (client->client_->numActiveRequests() > 0) {
+      return true;
+    }
   }
 
   return !pending_requests_.empty();
@@ -63,17 +70,19 @@ void ConnPoolImpl::checkForDrained() {
   }
 
   bool drained = true;
-  if (primary_client_) {
-    if (primary_client_->client_->numActiveRequests() == 0) {
-      primary_client_->client_->close();
-      ASSERT(!primary_client_);
+  for (auto it = primary_clients_.begin(); it != primary_clients_.end();) {
+    ActiveClient& client = **it++;
+    if (client.client_->numActiveRequests() == 0) {
+      client.client_->close();
     } else {
       drained = false;
     }
   }
 
-  ASSERT(!draining_client_ || (draining_client_->client_->numActiveRequests() > 0));
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
+  for (const ActiveClientPtr& client : draining_clients_) {
+    ASSERT(client->client_->numActiveRequests() > 0);
+  }
+  if (!draining_clients_.empty()) {
     drained = false;
   }
 
@@ -85,7 +94,48 @@ void ConnPoolImpl::checkForDrained() {
   }
 }
 
-void ConnPoolImpl::newClientStream(Http::StreamDecoder& response_decoder,
+void ConnPoolImpl::prefetchConnection() {
+  if (primary_clients_.empty() &&
+      host_->cluster().resourceManager(priority_).connections().canCreate() &&
+      host_->canCreateConnection(priority_)) {
+    createNewClient().prefetched_ = true;
+    host_->cluster().stats().upstream_cx_prefetch_.inc();
+  }
+}
+
+ConnPoolImpl::ActiveClient& ConnPoolImpl::createNewClient() {
+  ActiveClientPtr client = std::make_unique<ActiveClient>(*this);
+  ActiveClient& created = *client;
+  client->moveIntoListBack(std::move(client), primary_clients_);
+  return created;
+}
+
+ConnPoolImpl::ActiveClient* ConnPoolImpl::leastLoadedReadyClient() {
+  ActiveClient* least_loaded = nullptr;
+  for (const ActiveClientPtr& client : primary_clients_) {
+    if (client->upstream_ready_ &&
+        (least_loaded == nullptr ||
+         client->client_->numActiveRequests() < least_loaded->client_->numActiveRequests())) {
+      least_loaded = client.get();
+    }
+  }
+  return least_loaded;
+}
+
+bool ConnPoolImpl::hasConnectingClient() const {
+  for (const ActiveClientPtr& client : primary_clients_) {
+    if (!client->upstream_ready_) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t ConnPoolImpl::maxConnections() const {
+  return host_->cluster().http2Settings().max_connections_per_host_;
+}
+
+void ConnPoolImpl::newClientStream(ActiveClient& client, Http::StreamDecoder& response_decoder,
                                    ConnectionPool::Callbacks& callbacks) {
   if (!host_->cluster().resourceManager(priority_).requests().canCreate()) {
     ENVOY_LOG(debug, "max requests overflow");
@@ -93,15 +143,19 @@ void ConnPoolImpl::newClientStream(Http::StreamDecoder& response_decoder,
                             nullptr);
     host_->cluster().stats().upstream_rq_pending_overflow_.inc();
   } else {
-    ENVOY_CONN_LOG(debug, "creating stream", *primary_client_->client_);
-    primary_client_->total_streams_++;
+    ENVOY_CONN_LOG(debug, "creating stream", *client.client_);
+    client.total_streams_++;
+    if (client.prefetched_) {
+      host_->cluster().stats().upstream_rq_prefetched_.inc();
+      client.prefetched_ = false;
+    }
     host_->stats().rq_total_.inc();
     host_->stats().rq_active_.inc();
     host_->cluster().stats().upstream_rq_total_.inc();
     host_->cluster().stats().upstream_rq_active_.inc();
     host_->cluster().resourceManager(priority_).requests().inc();
-    callbacks.onPoolReady(primary_client_->client_->newStream(response_decoder),
-                          primary_client_->real_host_description_);
+    callbacks.onPoolReady(client.client_->newStream(response_decoder),
+                          client.real_host_description_, client.client_->streamInfo());
   }
 }
 
@@ -115,16 +169,28 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
     max_streams = maxTotalStreams();
   }
 
-  if (primary_client_ && primary_client_->total_streams_ >= max_streams) {
-    movePrimaryClientToDraining();
+  for (auto it = primary_clients_.begin(); it != primary_clients_.end();) {
+    ActiveClient& client = **it++;
+    if (client.total_streams_ >= max_streams) {
+      movePrimaryClientToDraining(client);
+    }
   }
 
-  if (!primary_client_) {
-    primary_client_ = std::make_unique<ActiveClient>(*this);
+  // Open another connection when every connected primary already carries streams, so that load
+  // spreads over up to maxConnections() connections. The new connection is established in the
+  // background and this stream still goes to the least loaded connected primary. Only one
+  // connection is established at a time so that a burst does not open all of them at once, and
+  // extra connections also respect the per host connection limit shared by all workers.
+  ActiveClient* client = leastLoadedReadyClient();
+  if (primary_clients_.empty() ||
+      (client != nullptr && client->client_->numActiveRequests() > 0 &&
+       primary_clients_.size() < maxConnections() && !hasConnectingClient() &&
+       host_->canCreateConnection(priority_))) {
+    createNewClient();
   }
 
-  // If the primary client is not connected yet, queue up the request.
-  if (!primary_client_->upstream_ready_) {
+  // If no primary client is connected yet, queue up the request.
+  if (client == nullptr) {
     // If we're not allowed to enqueue more requests, fail fast.
     if (!host_->cluster().resourceManager(priority_).pendingRequests().canCreate()) {
       ENVOY_LOG(debug, "max pending requests overflow");
@@ -139,7 +205,7 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
 
   // We already have an active client that's connected to upstream, so attempt to establish a
   // new stream.
-  newClientStream(response_decoder, callbacks);
+  newClientStream(*client, response_decoder, callbacks);
   return nullptr;
 }
 
@@ -171,12 +237,12 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
                            client.client_->connectionFailureReason());
     }
 
-    if (&client == primary_client_.get()) {
+    if (!client.draining_) {
       ENVOY_CONN_LOG(debug, "destroying primary client", *client.client_);
-      dispatcher_.deferredDelete(std::move(primary_client_));
+      dispatcher_.deferredDelete(client.removeFromList(primary_clients_));
     } else {
       ENVOY_CONN_LOG(debug, "destroying draining client", *client.client_);
-      dispatcher_.deferredDelete(std::move(draining_client_));
+      dispatcher_.deferredDelete(client.removeFromList(draining_clients_));
     }
 
     if (client.closed_with_active_rq_) {
@@ -197,25 +263,25 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 }
 
-void ConnPoolImpl::movePrimaryClientToDraining() {
-  ENVOY_CONN_LOG(debug, "moving primary to draining", *primary_client_->client_);
-  if (draining_client_) {
-    // This should pretty much never happen, but is possible if we start draining and then get
-    // a goaway for example. In this case just kill the current draining connection. It's not
-    // worth keeping a list.
-    draining_client_->client_->close();
-  }
-
-  ASSERT(!draining_client_);
-  if (primary_client_->client_->numActiveRequests() == 0) {
+void ConnPoolImpl::movePrimaryClientToDraining(ActiveClient& client) {
+  ENVOY_CONN_LOG(debug, "moving primary to draining", *client.client_);
+  ASSERT(!client.draining_);
+  if (client.client_->numActiveRequests() == 0) {
     // If we are making a new connection and the primary does not have any active requests just
     // close it now.
-    primary_client_->client_->close();
-  } else {
-    draining_client_ = std::move(primary_client_);
+    client.client_->close();
+    return;
+  }
+
+  if (draining_clients_.size() >= maxConnections()) {
+    // This should pretty much never happen, but is possible if we start draining and then get
+    // a goaway for example. In this case just kill the oldest draining connection, so that the
+    // pool never holds more than twice the number of primary connections.
+    draining_clients_.back()->client_->close();
   }
 
-  ASSERT(!primary_client_);
+  client.draining_ = true;
+  client.moveBetweenLists(primary_clients_, draining_clients_);
 }
 
 void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
@@ -227,8 +293,8 @@ void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
 void ConnPoolImpl::onGoAway(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "remote goaway", *client.client_);
   host_->cluster().stats().upstream_cx_close_notify_.inc();
-  if (&client == primary_client_.get()) {
-    movePrimaryClientToDraining();
+  if (!client.draining_) {
+    movePrimaryClientToDraining(client);
   }
 }
 
@@ -238,7 +304,7 @@ void ConnPoolImpl::onStreamDestroy(ActiveClient& client) {
   host_->stats().rq_active_.dec();
   host_->cluster().stats().upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
-  if (&client == draining_client_.get() && client.client_->numActiveRequests() == 0) {
+  if (client.draining_ && client.client_->numActiveRequests() == 0) {
     // Close out the draining client if we no long have active requests.
     client.client_->close();
   }
@@ -264,9 +330,12 @@ void ConnPoolImpl::onStreamReset(ActiveClient& client, Http::StreamResetReason r
 }
 
 void ConnPoolImpl::onUpstreamReady() {
-  // Establishes new codec streams for each pending request.
+  // Establishes new codec streams for each pending request, spread over the connected primaries.
   while (!pending_requests_.empty()) {
-    newClientStream(pending_requests_.back()->decoder_, pending_requests_.back()->callbacks_);
+    ActiveClient* client = leastLoadedReadyClient();
+    ASSERT(client != nullptr);
+    newClientStream(*client, pending_requests_.back()->decoder_,
+                    pending_requests_.back()->callbacks_);
     pending_requests_.pop_back();
   }
 }
@@ -0,0 +1,69 @@
+#include "common/http/route_cache.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Http {
+
+RouteCache::RouteCache(uint32_t max_entries) : max_entries_(max_entries) {
+  ASSERT(max_entries_ > 0);
+}
+
+bool RouteCache::buildKey(const HeaderMap& headers) {
+  if (headers.Host() == nullptr || headers.Path() == nullptr || headers.Method() == nullptr) {
+    return false;
+  }
+
+  // Header values cannot contain NUL, so it is safe to use as a separator.
+  key_buffer_.clear();
+  for (const HeaderEntry* entry : {headers.Method(), headers.Host(), headers.Path()}) {
+    const absl::string_view value = entry->value().getStringView();
+    key_buffer_.append(value.data(), value.size());
+    key_buffer_.push_back('\0');
+  }
+  return true;
+}
+
+void RouteCache::checkConfig(const Router::ConfigConstSharedPtr& config) {
+  if (config_ != config) {
+    entries_.clear();
+    lru_.clear();
+    config_ = config;
+  }
+}
+
+Router::RouteConstSharedPtr RouteCache::find(const Router::ConfigConstSharedPtr& config,
+                                             const HeaderMap& headers) {
+  checkConfig(config);
+  if (lru_.empty() || !buildKey(headers)) {
+    return nullptr;
+  }
+
+  auto it = entries_.find(key_buffer_);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->route_;
+}
+
+void RouteCache::insert(const Router::ConfigConstSharedPtr& config, const HeaderMap& headers,
+                        const Router::RouteConstSharedPtr& route) {
+  if (route == nullptr || !route->cacheable()) {
+    return;
+  }
+  checkConfig(config);
+  if (!buildKey(headers) || entries_.find(key_buffer_) != entries_.end()) {
+    return;
+  }
+
+  if (lru_.size() >= max_entries_) {
+    entries_.erase(lru_.back().key_);
+    lru_.pop_back();
+  }
+  lru_.push_front({key_buffer_, route});
+  entries_.emplace(lru_.front().key_, lru_.begin());
+}
+
+} // namespace Http
+} // namespace Envoy
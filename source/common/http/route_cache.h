@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+
+#include "envoy/http/header_map.h"
+#include "envoy/router/router.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * Bounded least recently used cache of route lookups keyed on the :authority, :path and :method
+ * request headers. Only routes that report Router::Route::cacheable() are stored, so a cached
+ * route is always the route that Router::Config::route() would return for the same keys.
+ *
+ * Entries are only valid for the route configuration they were computed from. The cache holds a
+ * reference to that configuration and drops every entry when asked about a different one.
+ *
+ * The cache is not thread safe. The connection manager keeps one per worker.
+ */
+class RouteCache {
+public:
+  /**
+   * @param max_entries supplies the maximum number of cached routes. Must be greater than zero.
+   */
+  explicit RouteCache(uint32_t max_entries);
+
+  /**
+   * Look up a previously cached route.
+   * @param config supplies the route configuration the lookup is for.
+   * @param headers supplies the request headers.
+   * @return the cached route or nullptr if there is none.
+   */
+  Router::RouteConstSharedPtr find(const Router::ConfigConstSharedPtr& config,
+                                   const HeaderMap& headers);
+
+  /**
+   * Cache the result of a route lookup, evicting the least recently used entry if the cache is
+   * full. Nothing is cached if the route is not cacheable.
+   * @param config supplies the route configuration that produced the route.
+   * @param headers supplies the request headers the route was selected for.
+   * @param route supplies the selected route.
+   */
+  void insert(const Router::ConfigConstSharedPtr& config, const HeaderMap& headers,
+              const Router::RouteConstSharedPtr& route);
+
+  /**
+   * @return the number of cached routes.
+   */
+  size_t size() const { return lru_.size(); }
+
+private:
+  struct Entry {
+    std::string key_;
+    Router::RouteConstSharedPtr route_;
+  };
+  typedef std::list<Entry> EntryList;
+
+  // Builds the lookup key for the headers into key_buffer_. Returns false if any of the key
+  // headers are missing.
+  bool buildKey(const HeaderMap& headers);
+  // Drops every entry if the configuration differs from the one the entries were computed for.
+  void checkConfig(const Router::ConfigConstSharedPtr& config);
+
+  const uint32_t max_entries_;
+  Router::ConfigConstSharedPtr config_;
+  // Most recently used entries first.
+  EntryList lru_;
+  // Keys are views into the Entry keys, which list nodes keep at a stable address.
+  absl::flat_hash_map<absl::string_view, EntryList::iterator> entries_;
+  // Reused for every lookup to avoid allocating on the request path.
+  std::string key_buffer_;
+};
+
+} // namespace Http
+} // namespace Envoy
@@ -269,6 +269,17 @@ Utility::parseHttp2Settings(const envoy::api::v2::core::Http2ProtocolOptions& co
                                       Http::Http2Settings::DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE);
   ret.allow_connect_ = config.allow_connect();
   ret.allow_metadata_ = config.allow_metadata();
+  if (config.has_hpack_encoder_table_size()) {
+    ret.hpack_encoder_table_size_ = config.hpack_encoder_table_size().value();
+  }
+  if (config.has_max_adaptive_window_size()) {
+    ret.max_adaptive_window_size_ = config.max_adaptive_window_size().value();
+  }
+  ret.max_connections_per_host_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      config, max_connections_per_host, Http::Http2Settings::DEFAULT_MAX_CONNECTIONS_PER_HOST);
+  for (const std::string& header : config.never_index_headers()) {
+    ret.never_index_headers_.emplace_back(header);
+  }
   return ret;
 }
 
@@ -278,6 +289,11 @@ Utility::parseHttp1Settings(const envoy::api::v2::core::Http1ProtocolOptions& co
   ret.allow_absolute_url_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, allow_absolute_url, false);
   ret.accept_http_10_ = config.accept_http_10();
   ret.default_host_for_http_10_ = config.default_host_for_http_10();
+  ret.max_pipelined_requests_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_pipelined_requests, 1);
+  if (config.has_pipeline_head_of_line_timeout()) {
+    ret.pipeline_head_of_line_timeout_ = std::chrono::milliseconds(
+        DurationUtil::durationToMilliseconds(config.pipeline_head_of_line_timeout()));
+  }
   return ret;
 }
 
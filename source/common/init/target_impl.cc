@@ -50,5 +50,45 @@ bool TargetImpl::ready() {
   return false;
 }
 
+SharedTargetImpl::SharedTargetImpl(absl::string_view name, InitializeFn fn)
+    : name_(fmt::format("shared target {}", name)),
+      fn_(std::make_shared<InternalInitalizeFn>([this, fn](WatcherHandlePtr watcher_handle) {
+        if (ready_) {
+          // The target is already initialized, so the manager needn't wait for it.
+          watcher_handle->ready();
+          return;
+        }
+        watcher_handles_.push_back(std::move(watcher_handle));
+        if (!initialized_) {
+          initialized_ = true;
+          fn();
+        }
+      })) {}
+
+SharedTargetImpl::~SharedTargetImpl() { ENVOY_LOG(debug, "{} destroyed", name_); }
+
+absl::string_view SharedTargetImpl::name() const { return name_; }
+
+TargetHandlePtr SharedTargetImpl::createHandle(absl::string_view handle_name) const {
+  // Note: can't use std::make_unique here because TargetHandleImpl ctor is private.
+  return std::unique_ptr<TargetHandle>(
+      new TargetHandleImpl(handle_name, name_, std::weak_ptr<InternalInitalizeFn>(fn_)));
+}
+
+bool SharedTargetImpl::ready() {
+  if (!initialized_ || ready_) {
+    return false;
+  }
+  ready_ = true;
+  // Move the handles out first, in case signaling a manager destroys this target.
+  std::vector<WatcherHandlePtr> watcher_handles;
+  watcher_handles.swap(watcher_handles_);
+  bool result = false;
+  for (const WatcherHandlePtr& watcher_handle : watcher_handles) {
+    result = watcher_handle->ready() || result;
+  }
+  return result;
+}
+
 } // namespace Init
 } // namespace Envoy
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 
 #include "envoy/init/target.h"
 
@@ -29,6 +30,7 @@ using InternalInitalizeFn = std::function<void(WatcherHandlePtr)>;
 class TargetHandleImpl : public TargetHandle, Logger::Loggable<Logger::Id::init> {
 private:
   friend class TargetImpl;
+  friend class SharedTargetImpl;
   TargetHandleImpl(absl::string_view handle_name, absl::string_view name,
                    std::weak_ptr<InternalInitalizeFn> fn);
 
@@ -85,5 +87,47 @@ private:
   const std::shared_ptr<InternalInitalizeFn> fn_;
 };
 
+/**
+ * A SharedTargetImpl is a target that can be registered with any number of Managers, e.g. an RDS
+ * subscription shared by several warming listeners, so that each of them waits for it. Its
+ * callback is only called once, by the first manager to initialize it, and `ready` signals every
+ * manager that initialized it so far. The managers that initialize it after it is ready are
+ * signaled immediately.
+ */
+class SharedTargetImpl : public Target, Logger::Loggable<Logger::Id::init> {
+public:
+  /**
+   * @param name a human-readable target name, for logging / debugging
+   * @fn a callback function to invoke when `initialize` is first called on one of the handles.
+   */
+  SharedTargetImpl(absl::string_view name, InitializeFn fn);
+  ~SharedTargetImpl() override;
+
+  // Init::Target
+  absl::string_view name() const override;
+  TargetHandlePtr createHandle(absl::string_view handle_name) const override;
+
+  /**
+   * Signal to the init managers that initialized this target that it has finished initializing.
+   * Calling it before initialization begins, or a second time, will have no effect.
+   * @return true if at least one init manager received this call, false otherwise.
+   */
+  bool ready();
+
+private:
+  // Human-readable name for logging
+  const std::string name_;
+
+  // Handles to the internal watchers of the ManagerImpls waiting for this target
+  std::vector<WatcherHandlePtr> watcher_handles_;
+
+  // Whether the callback function was called, and whether `ready` was called after it
+  bool initialized_{};
+  bool ready_{};
+
+  // The callback function, called via TargetHandleImpl by the managers
+  const std::shared_ptr<InternalInitalizeFn> fn_;
+};
+
 } // namespace Init
 } // namespace Envoy
@@ -0,0 +1,99 @@
+#include "common/memory/accounting.h"
+
+#include <array>
+#include <atomic>
+
+namespace Envoy {
+namespace Memory {
+
+namespace {
+
+// Byte counts published by all threads. A count may be transiently negative when a thread that
+// releases memory allocated by another thread publishes first.
+std::array<std::atomic<int64_t>, Accounting::NumTags> published_bytes;
+
+// Set once the calling thread's pending changes have been published during thread exit. Changes
+// made after that point are published right away.
+thread_local bool thread_accounting_destroyed = false;
+
+class ThreadAccounting {
+public:
+  ~ThreadAccounting() {
+    flush();
+    thread_accounting_destroyed = true;
+  }
+
+  void add(AccountingTag tag, int64_t bytes) {
+    const size_t index = static_cast<size_t>(tag);
+    int64_t& pending = pending_bytes_[index];
+    pending += bytes;
+    if (pending >= Accounting::FlushBytes || pending <= -Accounting::FlushBytes) {
+      published_bytes[index] += pending;
+      pending = 0;
+    }
+  }
+
+  void flush() {
+    for (size_t i = 0; i < Accounting::NumTags; i++) {
+      published_bytes[i] += pending_bytes_[i];
+      pending_bytes_[i] = 0;
+    }
+  }
+
+private:
+  std::array<int64_t, Accounting::NumTags> pending_bytes_{};
+};
+
+ThreadAccounting* threadAccounting() {
+  if (thread_accounting_destroyed) {
+    return nullptr;
+  }
+  static thread_local ThreadAccounting accounting;
+  return &accounting;
+}
+
+void add(AccountingTag tag, int64_t bytes) {
+  ThreadAccounting* accounting = threadAccounting();
+  if (accounting != nullptr) {
+    accounting->add(tag, bytes);
+  } else {
+    published_bytes[static_cast<size_t>(tag)] += bytes;
+  }
+}
+
+} // namespace
+
+constexpr size_t Accounting::NumTags;
+constexpr int64_t Accounting::FlushBytes;
+
+void Accounting::allocated(AccountingTag tag, uint64_t bytes) {
+  add(tag, static_cast<int64_t>(bytes));
+}
+
+void Accounting::released(AccountingTag tag, uint64_t bytes) {
+  add(tag, -static_cast<int64_t>(bytes));
+}
+
+uint64_t Accounting::bytes(AccountingTag tag) {
+  const int64_t bytes = published_bytes[static_cast<size_t>(tag)];
+  return bytes > 0 ? bytes : 0;
+}
+
+void Accounting::flushForTest() {
+  ThreadAccounting* accounting = threadAccounting();
+  if (accounting != nullptr) {
+    accounting->flush();
+  }
+}
+
+void AccountedBytes::set(uint64_t bytes) {
+  if (bytes > bytes_) {
+    Accounting::allocated(tag_, bytes - bytes_);
+  } else if (bytes < bytes_) {
+    Accounting::released(tag_, bytes_ - bytes);
+  }
+  bytes_ = bytes;
+}
+
+} // namespace Memory
+} // namespace Envoy
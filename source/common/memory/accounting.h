@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Memory {
+
+/**
+ * Subsystems whose allocations are accounted separately from the heap totals in Memory::Stats.
+ */
+enum class AccountingTag {
+  // Slices of Buffer::OwnedImpl.
+  Buffer,
+  // Entries and string bodies of HTTP header maps, including header arena blocks.
+  HeaderMap,
+  // Stat data allocated by the stat allocator.
+  Stats,
+  // Serialized size of the xDS resources currently accepted by the subscriptions.
+  Config,
+};
+
+/**
+ * Counts the bytes allocated by each subsystem. The counts are kept at the allocation sites of the
+ * subsystems, since heap hooks cannot tell who an allocation belongs to. Each thread batches its
+ * changes and publishes them once they amount to FlushBytes, so the published counts may be off by
+ * up to that many bytes per thread.
+ */
+class Accounting {
+public:
+  static constexpr size_t NumTags = static_cast<size_t>(AccountingTag::Config) + 1;
+  static constexpr int64_t FlushBytes = 64 * 1024;
+
+  /**
+   * Account bytes allocated on behalf of a subsystem.
+   * @param tag supplies the subsystem.
+   * @param bytes supplies the number of bytes allocated.
+   */
+  static void allocated(AccountingTag tag, uint64_t bytes);
+
+  /**
+   * Account bytes released by a subsystem. The release does not have to happen on the thread that
+   * accounted the allocation.
+   * @param tag supplies the subsystem.
+   * @param bytes supplies the number of bytes released.
+   */
+  static void released(AccountingTag tag, uint64_t bytes);
+
+  /**
+   * @param tag supplies the subsystem.
+   * @return uint64_t the bytes currently allocated by the subsystem, as published by all threads.
+   */
+  static uint64_t bytes(AccountingTag tag);
+
+  /**
+   * Publish the calling thread's pending changes right away.
+   */
+  static void flushForTest();
+};
+
+/**
+ * A byte count that is accounted to a subsystem for as long as the object lives, for memory whose
+ * size is known as a whole rather than per allocation.
+ */
+class AccountedBytes : NonCopyable {
+public:
+  explicit AccountedBytes(AccountingTag tag) : tag_(tag) {}
+  ~AccountedBytes() { set(0); }
+
+  /**
+   * Replace the accounted byte count.
+   * @param bytes supplies the new count.
+   */
+  void set(uint64_t bytes);
+
+  uint64_t value() const { return bytes_; }
+
+private:
+  const AccountingTag tag_;
+  uint64_t bytes_{};
+};
+
+} // namespace Memory
+} // namespace Envoy
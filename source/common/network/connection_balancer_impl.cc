@@ -0,0 +1,47 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+void ExactConnectionBalancerImpl::registerHandler(BalancedConnectionHandler& handler) {
+  Thread::LockGuard lock(lock_);
+  handlers_.push_back(&handler);
+}
+
+void ExactConnectionBalancerImpl::unregisterHandler(BalancedConnectionHandler& handler) {
+  Thread::LockGuard lock(lock_);
+  const auto it = std::find(handlers_.begin(), handlers_.end(), &handler);
+  ASSERT(it != handlers_.end());
+  handlers_.erase(it);
+}
+
+bool ExactConnectionBalancerImpl::balance(BalancedConnectionHandler& current_handler,
+                                          ConnectionSocketPtr& socket) {
+  // The socket is handed over while the lock is held, so that the target cannot be unregistered
+  // and destroyed in the meantime.
+  Thread::LockGuard lock(lock_);
+  // Ties go to the current handler, which avoids a needless trip to another thread.
+  BalancedConnectionHandler* target = &current_handler;
+  uint64_t target_connections = current_handler.numConnections();
+  for (BalancedConnectionHandler* handler : handlers_) {
+    const uint64_t connections = handler->numConnections();
+    if (connections < target_connections) {
+      target = handler;
+      target_connections = connections;
+    }
+  }
+
+  if (target == &current_handler) {
+    return false;
+  }
+  target->incNumConnections();
+  target->post(std::move(socket));
+  return true;
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "envoy/network/connection_balancer.h"
+
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Balancer that hands every newly accepted socket to the handler with the fewest connections. A
+ * lock is taken for each accepted socket, so this trades some accept throughput for an even
+ * distribution of long lived connections across workers.
+ */
+class ExactConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler& handler) override;
+  void unregisterHandler(BalancedConnectionHandler& handler) override;
+  bool balance(BalancedConnectionHandler& current_handler, ConnectionSocketPtr& socket) override;
+
+private:
+  Thread::MutexBasicLockable lock_;
+  std::vector<BalancedConnectionHandler*> handlers_ GUARDED_BY(lock_);
+};
+
+/**
+ * Balancer that leaves every socket with the handler that accepted it.
+ */
+class NopConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler&) override {}
+  void unregisterHandler(BalancedConnectionHandler&) override {}
+  bool balance(BalancedConnectionHandler&, ConnectionSocketPtr&) override { return false; }
+};
+
+} // namespace Network
+} // namespace Envoy
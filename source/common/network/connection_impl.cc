@@ -516,6 +516,7 @@ void ConnectionImpl::onWriteReady() {
     if (error == 0) {
       ENVOY_CONN_LOG(debug, "connected", *this);
       connecting_ = false;
+      stream_info_.upstreamTiming().onUpstreamConnectComplete(dispatcher_.timeSource());
       transport_socket_->onConnected();
       // It's possible that we closed during the connect callback.
       if (state() != State::Open) {
@@ -642,6 +643,7 @@ ClientConnectionImpl::ClientConnectionImpl(
 
 void ClientConnectionImpl::connect() {
   ENVOY_CONN_LOG(debug, "connecting to {}", *this, socket_->remoteAddress()->asString());
+  stream_info_.upstreamTiming().onUpstreamConnectStart(dispatcher().timeSource());
   const Api::SysCallIntResult result = socket_->remoteAddress()->connect(ioHandle().fd());
   if (result.rc_ == 0) {
     // write will become ready.
@@ -12,6 +12,7 @@
 
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/logger.h"
+#include "common/common/object_pool.h"
 #include "common/event/libevent.h"
 #include "common/network/filter_manager_impl.h"
 #include "common/stream_info/stream_info_impl.h"
@@ -46,7 +47,8 @@ public:
 /**
  * Implementation of Network::Connection.
  */
-class ConnectionImpl : public virtual Connection,
+class ConnectionImpl : public PooledObject,
+                       public virtual Connection,
                        public BufferSource,
                        public TransportSocketCallbacks,
                        protected Logger::Loggable<Logger::Id::connection> {
@@ -117,6 +119,7 @@ public:
   // fair sharing of CPU resources, the underlying event loop does not make any fairness guarantees.
   // Reconsider how to make fairness happen.
   void setReadBufferReady() override { file_event_->activate(Event::FileReadyType::Read); }
+  void flushWriteBuffer() override { file_event_->activate(Event::FileReadyType::Write); }
 
   // Obtain global next connection ID. This should only be used in tests.
   static uint64_t nextGlobalIdForTest() { return next_global_id_; }
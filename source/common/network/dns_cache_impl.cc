@@ -0,0 +1,154 @@
+#include "common/network/dns_cache_impl.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+DnsCacheImpl::DnsCacheImpl(DnsResolverSharedPtr resolver, Event::Dispatcher& dispatcher,
+                           std::chrono::milliseconds ttl, Stats::Scope& scope)
+    : resolver_(std::move(resolver)), dispatcher_(dispatcher),
+      time_source_(dispatcher.timeSource()), ttl_(ttl),
+      stats_{ALL_DNS_CACHE_STATS(POOL_COUNTER_PREFIX(scope, "dns_cache."),
+                                 POOL_GAUGE_PREFIX(scope, "dns_cache."),
+                                 POOL_HISTOGRAM_PREFIX(scope, "dns_cache."))} {
+  ASSERT(ttl_.count() > 0);
+}
+
+DnsCacheImpl::~DnsCacheImpl() {
+  for (const auto& entry : entries_) {
+    if (entry.second->active_query_ != nullptr) {
+      entry.second->active_query_->cancel();
+    }
+  }
+  stats_.entries_.sub(entries_.size());
+}
+
+std::string DnsCacheImpl::key(const std::string& dns_name, DnsLookupFamily dns_lookup_family) {
+  std::string key;
+  key.reserve(dns_name.size() + 1);
+  key.push_back(static_cast<char>('0' + static_cast<int>(dns_lookup_family)));
+  key.append(dns_name);
+  return key;
+}
+
+bool DnsCacheImpl::fresh(const Entry& entry) const {
+  return entry.resolved_ && time_source_.monotonicTime() < entry.expiry_;
+}
+
+ActiveDnsQuery* DnsCacheImpl::resolve(const std::string& dns_name,
+                                      DnsLookupFamily dns_lookup_family, ResolveCb callback) {
+  const std::string entry_key = key(dns_name, dns_lookup_family);
+  EntryPtr& new_entry = entries_[entry_key];
+  if (new_entry == nullptr) {
+    new_entry = std::make_unique<Entry>(dns_name, dns_lookup_family);
+    new_entry->refresh_timer_ =
+        dispatcher_.createTimer([this, entry_key]() { onRefreshTimer(entry_key); });
+    stats_.entries_.inc();
+  }
+  Entry& entry = *new_entry;
+
+  if (fresh(entry)) {
+    stats_.hit_.inc();
+    entry.used_ = true;
+    callback(std::list<Address::InstanceConstSharedPtr>(entry.addresses_));
+    return nullptr;
+  }
+
+  stats_.miss_.inc();
+  entry.pending_resolutions_.emplace_back(std::make_unique<PendingResolution>(callback));
+  PendingResolution* pending_resolution = entry.pending_resolutions_.back().get();
+  if (entry.querying_) {
+    stats_.coalesced_.inc();
+    return pending_resolution;
+  }
+  // The entry may be gone once the query is started, if it completes synchronously.
+  return startQuery(entry_key, entry) ? pending_resolution : nullptr;
+}
+
+bool DnsCacheImpl::startQuery(const std::string& key, Entry& entry) {
+  stats_.query_.inc();
+  entry.querying_ = true;
+  entry.query_start_ = time_source_.monotonicTime();
+  ActiveDnsQuery* query = resolver_->resolve(
+      entry.dns_name_, entry.dns_lookup_family_,
+      [this, key](const std::list<Address::InstanceConstSharedPtr>&& addresses) -> void {
+        onQueryComplete(key, std::list<Address::InstanceConstSharedPtr>(addresses));
+      });
+  if (query == nullptr) {
+    return false;
+  }
+  entry.active_query_ = query;
+  return true;
+}
+
+void DnsCacheImpl::onQueryComplete(const std::string& key,
+                                   std::list<Address::InstanceConstSharedPtr>&& addresses) {
+  auto it = entries_.find(key);
+  ASSERT(it != entries_.end());
+  Entry& entry = *it->second;
+  const MonotonicTime now = time_source_.monotonicTime();
+  stats_.query_latency_.recordValue(
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - entry.query_start_).count());
+  entry.querying_ = false;
+  entry.active_query_ = nullptr;
+  entry.used_ = false;
+
+  bool erase_entry = false;
+  if (!addresses.empty()) {
+    entry.addresses_ = addresses;
+    entry.resolved_ = true;
+    entry.expiry_ = now + ttl_;
+    // Refresh once 90% of the TTL has passed, to leave the query time to complete.
+    entry.refresh_timer_->enableTimer(ttl_ - ttl_ / 10);
+  } else {
+    ENVOY_LOG(debug, "DNS query for {} failed", entry.dns_name_);
+    stats_.failure_.inc();
+    if (fresh(entry)) {
+      // A refresh failed. Keep the addresses until they expire, and try again then if the name is
+      // still being resolved.
+      entry.refresh_timer_->enableTimer(
+          std::chrono::duration_cast<std::chrono::milliseconds>(entry.expiry_ - now));
+    } else {
+      erase_entry = true;
+    }
+  }
+
+  // The callbacks may resolve names again, so the entry must be consistent before they run.
+  std::list<PendingResolutionPtr> pending_resolutions;
+  pending_resolutions.swap(entry.pending_resolutions_);
+  const std::list<Address::InstanceConstSharedPtr> resolved =
+      fresh(entry) ? entry.addresses_ : std::list<Address::InstanceConstSharedPtr>();
+  if (erase_entry) {
+    erase(key);
+  }
+  for (const PendingResolutionPtr& pending_resolution : pending_resolutions) {
+    if (!pending_resolution->cancelled_) {
+      pending_resolution->callback_(std::list<Address::InstanceConstSharedPtr>(resolved));
+    }
+  }
+}
+
+void DnsCacheImpl::onRefreshTimer(const std::string key) {
+  auto it = entries_.find(key);
+  ASSERT(it != entries_.end());
+  Entry& entry = *it->second;
+  if (entry.querying_) {
+    return;
+  }
+  if (!entry.used_) {
+    ENVOY_LOG(debug, "dropping unused DNS cache entry for {}", entry.dns_name_);
+    erase(key);
+    return;
+  }
+  stats_.refresh_.inc();
+  startQuery(key, entry);
+}
+
+void DnsCacheImpl::erase(const std::string& key) {
+  entries_.erase(key);
+  stats_.entries_.dec();
+}
+
+} // namespace Network
+} // namespace Envoy
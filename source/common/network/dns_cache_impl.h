@@ -0,0 +1,124 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/network/dns.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * All DNS cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_DNS_CACHE_STATS(COUNTER, GAUGE, HISTOGRAM)                                             \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(coalesced)                                                                               \
+  COUNTER(query)                                                                                   \
+  COUNTER(refresh)                                                                                 \
+  COUNTER(failure)                                                                                 \
+  GAUGE  (entries)                                                                                 \
+  HISTOGRAM(query_latency)
+// clang-format on
+
+/**
+ * Struct definition for all DNS cache stats. @see stats_macros.h
+ */
+struct DnsCacheStats {
+  ALL_DNS_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * A DnsResolver that caches the resolutions of another resolver, so that the clusters resolving
+ * the same name share its queries. A name is resolved by a single query at a time, which all the
+ * resolutions of the name started meanwhile wait for. Resolved addresses are cached for a fixed
+ * TTL, since the resolver does not report the TTLs of the records, and a name that was resolved
+ * again since its last query is refreshed shortly before its entry expires, so that periodic
+ * resolutions keep being answered from the cache. Failed queries are not cached. All calls and
+ * callbacks are assumed to happen on the thread that owns the dispatcher.
+ */
+class DnsCacheImpl : public DnsResolver, Logger::Loggable<Logger::Id::upstream> {
+public:
+  DnsCacheImpl(DnsResolverSharedPtr resolver, Event::Dispatcher& dispatcher,
+               std::chrono::milliseconds ttl, Stats::Scope& scope);
+  ~DnsCacheImpl();
+
+  // Network::DnsResolver
+  ActiveDnsQuery* resolve(const std::string& dns_name, DnsLookupFamily dns_lookup_family,
+                          ResolveCb callback) override;
+
+  /**
+   * @return uint64_t the number of names in the cache.
+   */
+  uint64_t size() const { return entries_.size(); }
+
+private:
+  struct PendingResolution : public ActiveDnsQuery {
+    explicit PendingResolution(ResolveCb callback) : callback_(callback) {}
+
+    // Network::ActiveDnsQuery
+    void cancel() override {
+      // The query still goes ahead for the other resolutions of the name and for the cache, so
+      // the resolution is only dropped once the query completes.
+      cancelled_ = true;
+    }
+
+    const ResolveCb callback_;
+    bool cancelled_{};
+  };
+  typedef std::unique_ptr<PendingResolution> PendingResolutionPtr;
+
+  struct Entry {
+    Entry(const std::string& dns_name, DnsLookupFamily dns_lookup_family)
+        : dns_name_(dns_name), dns_lookup_family_(dns_lookup_family) {}
+
+    const std::string dns_name_;
+    const DnsLookupFamily dns_lookup_family_;
+    // The addresses of the last successful query, valid until expiry_.
+    std::list<Address::InstanceConstSharedPtr> addresses_;
+    bool resolved_{};
+    MonotonicTime expiry_;
+    // Whether the name was resolved again since its last query, and so is worth refreshing.
+    bool used_{};
+    // The query in flight, if any, and the resolutions waiting for it.
+    bool querying_{};
+    ActiveDnsQuery* active_query_{};
+    MonotonicTime query_start_;
+    std::list<PendingResolutionPtr> pending_resolutions_;
+    Event::TimerPtr refresh_timer_;
+  };
+  typedef std::unique_ptr<Entry> EntryPtr;
+
+  static std::string key(const std::string& dns_name, DnsLookupFamily dns_lookup_family);
+
+  bool fresh(const Entry& entry) const;
+  // Returns false if the query completed synchronously.
+  bool startQuery(const std::string& key, Entry& entry);
+  void onQueryComplete(const std::string& key,
+                       std::list<Address::InstanceConstSharedPtr>&& addresses);
+  // Takes the key by value, since dropping the entry destroys the timer callback that owns it.
+  void onRefreshTimer(std::string key);
+  void erase(const std::string& key);
+
+  DnsResolverSharedPtr resolver_;
+  Event::Dispatcher& dispatcher_;
+  TimeSource& time_source_;
+  const std::chrono::milliseconds ttl_;
+  DnsCacheStats stats_;
+  std::unordered_map<std::string, EntryPtr> entries_;
+};
+
+} // namespace Network
+} // namespace Envoy
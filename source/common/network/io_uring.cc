@@ -0,0 +1,204 @@
+#include "common/network/io_uring.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include "common/common/assert.h"
+
+#ifdef ENVOY_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Not defined by older C libraries. The numbers are the same on all architectures but alpha.
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+#endif
+
+namespace Envoy {
+namespace Network {
+
+#ifdef ENVOY_IO_URING
+
+IoUring::IoUring(uint32_t entries) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  const int fd = syscall(__NR_io_uring_setup, entries, &params);
+  if (fd < 0) {
+    return;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  // Kernels that map both rings at once still support mapping them separately.
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                  IORING_OFF_SQ_RING);
+  cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                  IORING_OFF_CQ_RING);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                    IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (cq_ring_ != MAP_FAILED) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sqes != MAP_FAILED) {
+      munmap(sqes, sqes_size_);
+    }
+    ::close(fd);
+    return;
+  }
+
+  char* sq_ring = static_cast<char*>(sq_ring_);
+  sq_head_ = reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.tail);
+  sq_array_ = reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.array);
+  sq_mask_ = *reinterpret_cast<uint32_t*>(sq_ring + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  sq_local_tail_ = *sq_tail_;
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+  char* cq_ring = static_cast<char*>(cq_ring_);
+  cq_head_ = reinterpret_cast<uint32_t*>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t*>(cq_ring + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32_t*>(cq_ring + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+
+  fd_ = fd;
+}
+
+IoUring::~IoUring() {
+  if (fd_ < 0) {
+    return;
+  }
+  munmap(sqes_, sqes_size_);
+  munmap(cq_ring_, cq_ring_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  ::close(fd_);
+}
+
+bool IoUring::registerBuffers(const struct iovec* iovecs, uint32_t count) {
+  ASSERT(isSupported());
+  return syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, iovecs, count) == 0;
+}
+
+bool IoUring::registerEventFd(int event_fd) {
+  ASSERT(isSupported());
+  return syscall(__NR_io_uring_register, fd_, IORING_REGISTER_EVENTFD, &event_fd, 1) == 0;
+}
+
+io_uring_sqe* IoUring::nextSqe() {
+  ASSERT(isSupported());
+  if (sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+    return nullptr;
+  }
+  const uint32_t index = sq_local_tail_ & sq_mask_;
+  io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  ++sq_local_tail_;
+  return sqe;
+}
+
+bool IoUring::prepareWritev(int fd, const struct iovec* iovecs, uint32_t count,
+                            uint64_t user_data) {
+  io_uring_sqe* sqe = nextSqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_WRITEV;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(iovecs);
+  sqe->len = count;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool IoUring::prepareWriteFixed(int fd, const void* buffer, uint32_t length,
+                                uint16_t buffer_index, uint64_t user_data) {
+  io_uring_sqe* sqe = nextSqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_WRITE_FIXED;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buffer);
+  sqe->len = length;
+  sqe->buf_index = buffer_index;
+  sqe->user_data = user_data;
+  return true;
+}
+
+uint32_t IoUring::pending() const {
+  if (!isSupported()) {
+    return 0;
+  }
+  return sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+}
+
+int IoUring::submit() {
+  const uint32_t to_submit = pending();
+  if (to_submit == 0) {
+    return 0;
+  }
+  // Publish the prepared entries before the kernel is told about them.
+  __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+  const int rc = syscall(__NR_io_uring_enter, fd_, to_submit, 0, 0, nullptr, 0);
+  return rc < 0 ? -errno : rc;
+}
+
+uint32_t IoUring::forEachCompletion(const CompletionCb& cb) {
+  ASSERT(isSupported());
+  uint32_t head = *cq_head_;
+  const uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  uint32_t reaped = 0;
+  while (head != tail) {
+    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    const uint64_t user_data = cqe.user_data;
+    const int32_t result = cqe.res;
+    ++head;
+    ++reaped;
+    // Hand the entry back to the kernel before the callback, which may prepare and submit more.
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    cb(user_data, result);
+  }
+  return reaped;
+}
+
+#else
+
+IoUring::IoUring(uint32_t) {}
+
+IoUring::~IoUring() {}
+
+bool IoUring::registerBuffers(const struct iovec*, uint32_t) { return false; }
+
+bool IoUring::registerEventFd(int) { return false; }
+
+io_uring_sqe* IoUring::nextSqe() { return nullptr; }
+
+bool IoUring::prepareWritev(int, const struct iovec*, uint32_t, uint64_t) { return false; }
+
+bool IoUring::prepareWriteFixed(int, const void*, uint32_t, uint16_t, uint64_t) { return false; }
+
+uint32_t IoUring::pending() const { return 0; }
+
+int IoUring::submit() { return 0; }
+
+uint32_t IoUring::forEachCompletion(const CompletionCb&) { return 0; }
+
+#endif
+
+} // namespace Network
+} // namespace Envoy
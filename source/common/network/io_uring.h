@@ -0,0 +1,129 @@
+#pragma once
+
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "common/common/non_copyable.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ENVOY_IO_URING 1
+#endif
+#endif
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Minimal wrapper around a Linux io_uring submission and completion queue pair, on top of the raw
+ * system calls. Operations are prepared in the submission queue, and handed to the kernel together
+ * by a single io_uring_enter() in submit(). Not thread safe.
+ *
+ * On platforms, kernels and C libraries without io_uring the ring is never set up, and
+ * isSupported() returns false.
+ */
+class IoUring : NonCopyable {
+public:
+  typedef std::function<void(uint64_t user_data, int32_t result)> CompletionCb;
+
+  /**
+   * @param entries supplies the size of the submission queue, which the kernel rounds up to a power
+   *        of 2. The completion queue is twice as large.
+   */
+  explicit IoUring(uint32_t entries);
+  ~IoUring();
+
+  /**
+   * @return bool whether the ring was set up.
+   */
+  bool isSupported() const { return fd_ >= 0; }
+
+  /**
+   * @return uint32_t the number of entries of the submission queue.
+   */
+  uint32_t entries() const { return sq_entries_; }
+
+  /**
+   * Register buffers with the kernel, for use by prepareWriteFixed(). The buffers must stay valid
+   * for as long as the ring.
+   * @param iovecs supplies the buffers.
+   * @param count supplies the number of buffers.
+   * @return bool whether the buffers were registered.
+   */
+  bool registerBuffers(const struct iovec* iovecs, uint32_t count);
+
+  /**
+   * Have the kernel signal an eventfd each time it posts a completion.
+   * @param event_fd supplies the eventfd.
+   * @return bool whether the eventfd was registered.
+   */
+  bool registerEventFd(int event_fd);
+
+  /**
+   * Prepare a writev() of a file descriptor. The iovecs must stay valid until the write completes.
+   * @return bool false if the submission queue is full.
+   */
+  bool prepareWritev(int fd, const struct iovec* iovecs, uint32_t count, uint64_t user_data);
+
+  /**
+   * Prepare a write() of a file descriptor from a registered buffer.
+   * @param buffer supplies the data, which must lie within the registered buffer at buffer_index.
+   * @return bool false if the submission queue is full.
+   */
+  bool prepareWriteFixed(int fd, const void* buffer, uint32_t length, uint16_t buffer_index,
+                         uint64_t user_data);
+
+  /**
+   * @return uint32_t the number of prepared operations that the kernel hasn't consumed yet.
+   */
+  uint32_t pending() const;
+
+  /**
+   * Hand the prepared operations to the kernel.
+   * @return int the number of operations submitted, or -errno.
+   */
+  int submit();
+
+  /**
+   * Reap the completions posted by the kernel, without blocking.
+   * @param cb supplies the callback invoked with the user data of the operation of each completion,
+   *        and its result, as returned by the equivalent system call or -errno.
+   * @return uint32_t the number of completions reaped.
+   */
+  uint32_t forEachCompletion(const CompletionCb& cb);
+
+private:
+  io_uring_sqe* nextSqe();
+
+  int fd_{-1};
+  void* sq_ring_{};
+  size_t sq_ring_size_{};
+  void* cq_ring_{};
+  size_t cq_ring_size_{};
+  io_uring_sqe* sqes_{};
+  size_t sqes_size_{};
+
+  // Submission queue, shared with the kernel. The kernel consumes entries from sq_head_.
+  uint32_t* sq_head_{};
+  uint32_t* sq_tail_{};
+  uint32_t* sq_array_{};
+  uint32_t sq_mask_{};
+  uint32_t sq_entries_{};
+  // Tail including the prepared entries that aren't published to the kernel yet.
+  uint32_t sq_local_tail_{};
+
+  // Completion queue, shared with the kernel. The kernel posts entries at cq_tail_.
+  uint32_t* cq_head_{};
+  uint32_t* cq_tail_{};
+  uint32_t cq_mask_{};
+  io_uring_cqe* cqes_{};
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,176 @@
+#include "common/network/io_uring_worker.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#ifdef ENVOY_IO_URING
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace Envoy {
+namespace Network {
+
+constexpr uint32_t IoUringWorker::DefaultEntries;
+constexpr uint32_t IoUringWorker::FixedBufferSize;
+constexpr uint32_t IoUringWorker::FixedBufferCount;
+constexpr uint64_t IoUringWorker::MaxWriteSize;
+
+void IoUringWrite::detach() {
+  callbacks_ = nullptr;
+  // The socket may be closed as soon as this returns, so the write must have reached the kernel,
+  // which holds a reference to the socket from then on.
+  worker_.submit();
+}
+
+IoUringWorker::IoUringWorker(Event::Dispatcher& dispatcher, uint32_t entries)
+    : dispatcher_(dispatcher), ring_(std::make_unique<IoUring>(entries)) {
+#ifdef ENVOY_IO_URING
+  if (!ring_->isSupported()) {
+    ENVOY_LOG(debug, "io_uring is not supported, writing sockets with system calls");
+    return;
+  }
+
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd_ < 0 || !ring_->registerEventFd(event_fd_)) {
+    ENVOY_LOG(warn, "failed to register an eventfd with io_uring: {}", errno);
+    return;
+  }
+  file_event_ = dispatcher_.createFileEvent(
+      event_fd_, [this](uint32_t) { onCompletions(); }, Event::FileTriggerType::Edge,
+      Event::FileReadyType::Read);
+  submit_timer_ = dispatcher_.createTimer([this]() { submit(); });
+
+  for (uint32_t i = 0; i < FixedBufferCount; i++) {
+    fixed_buffers_.push_back({Buffer::SlicePool::allocate(FixedBufferSize), FixedBufferSize});
+  }
+  if (!ring_->registerBuffers(fixed_buffers_.data(), fixed_buffers_.size())) {
+    // Typically RLIMIT_MEMLOCK is too low. All the writes use writev() then.
+    ENVOY_LOG(debug, "failed to register buffers with io_uring: {}", errno);
+    for (const struct iovec& buffer : fixed_buffers_) {
+      Buffer::SlicePool::deallocate(buffer.iov_base, buffer.iov_len);
+    }
+    fixed_buffers_.clear();
+  }
+  for (uint32_t i = 0; i < fixed_buffers_.size(); i++) {
+    free_fixed_buffers_.push_back(i);
+  }
+#endif
+}
+
+IoUringWorker::~IoUringWorker() {
+  // Closing the ring cancels the writes in flight, and unregisters the buffers.
+  file_event_.reset();
+  ring_.reset();
+  writes_.clear();
+  for (const struct iovec& buffer : fixed_buffers_) {
+    Buffer::SlicePool::deallocate(buffer.iov_base, buffer.iov_len);
+  }
+#ifdef ENVOY_IO_URING
+  if (event_fd_ >= 0) {
+    ::close(event_fd_);
+  }
+#endif
+}
+
+IoUringWrite* IoUringWorker::write(int fd, const Buffer::Instance& data,
+                                   IoUringWriteCallbacks& callbacks) {
+  // Bounding the writes in flight by the submission queue keeps the completion queue, which is
+  // twice as large, from overflowing.
+  if (!isSupported() || writes_.size() >= ring_->entries()) {
+    return nullptr;
+  }
+
+  const uint64_t length = std::min(data.length(), MaxWriteSize);
+  ASSERT(length > 0);
+  IoUringWritePtr new_write = std::make_unique<IoUringWrite>(*this, fd, callbacks);
+  if (length <= FixedBufferSize && !free_fixed_buffers_.empty()) {
+    new_write->fixed_buffer_ = free_fixed_buffers_.back();
+    free_fixed_buffers_.pop_back();
+    new_write->iovec_ = {fixed_buffers_[new_write->fixed_buffer_].iov_base, length};
+  } else {
+    new_write->heap_data_.reset(new uint8_t[length]);
+    new_write->iovec_ = {new_write->heap_data_.get(), length};
+  }
+  data.copyOut(0, length, new_write->iovec_.iov_base);
+
+  IoUringWrite& write = *new_write;
+  new_write->moveIntoListBack(std::move(new_write), writes_);
+  prepare(write);
+  return &write;
+}
+
+void IoUringWorker::submit() {
+  if (submit_timer_ != nullptr) {
+    submit_timer_->disableTimer();
+  }
+  const int rc = ring_->submit();
+  if (rc < 0) {
+    // The entries stay in the submission queue, and are submitted again on the next iteration.
+    ENVOY_LOG(debug, "io_uring submission failed: {}", -rc);
+    submit_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
+void IoUringWorker::prepare(IoUringWrite& write) {
+  const uint64_t user_data = reinterpret_cast<uint64_t>(&write);
+  bool prepared;
+  do {
+    if (write.fixed_buffer_ >= 0) {
+      prepared = ring_->prepareWriteFixed(write.fd_, write.iovec_.iov_base, write.iovec_.iov_len,
+                                          write.fixed_buffer_, user_data);
+    } else {
+      prepared = ring_->prepareWritev(write.fd_, &write.iovec_, 1, user_data);
+    }
+    // The writes in flight are bounded by the size of the submission queue, so there is room once
+    // the kernel has consumed the queued entries.
+    if (!prepared) {
+      submit();
+    }
+  } while (!prepared);
+
+  if (!submit_timer_->enabled()) {
+    submit_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
+void IoUringWorker::onCompletions() {
+#ifdef ENVOY_IO_URING
+  // Reset the eventfd before reaping, so that completions posted from now on signal it again.
+  uint64_t count;
+  const ssize_t rc = ::read(event_fd_, &count, sizeof(count));
+  UNREFERENCED_PARAMETER(rc);
+#endif
+  ring_->forEachCompletion([this](uint64_t user_data, int32_t result) {
+    onWriteComplete(*reinterpret_cast<IoUringWrite*>(user_data), result);
+  });
+}
+
+void IoUringWorker::onWriteComplete(IoUringWrite& write, int32_t result) {
+  IoUringWritePtr completed = write.removeFromList(writes_);
+  if (completed->fixed_buffer_ >= 0) {
+    free_fixed_buffers_.push_back(completed->fixed_buffer_);
+  }
+  if (completed->callbacks_ != nullptr) {
+    completed->callbacks_->onWriteComplete(result);
+  }
+}
+
+ThreadLocalIoUringWorkers::ThreadLocalIoUringWorkers(ThreadLocal::SlotAllocator& tls)
+    : slot_(tls.allocateSlot()) {
+  slot_->set([](Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalWorker>(dispatcher);
+  });
+}
+
+IoUringWorker* ThreadLocalIoUringWorkers::get() {
+  IoUringWorker& worker = slot_->getTyped<ThreadLocalWorker>().worker_;
+  return worker.isSupported() ? &worker : nullptr;
+}
+
+} // namespace Network
+} // namespace Envoy
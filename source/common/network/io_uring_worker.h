@@ -0,0 +1,165 @@
+#pragma once
+
+#include <sys/uio.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/pure.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/file_event.h"
+#include "envoy/event/timer.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/linked_object.h"
+#include "common/common/logger.h"
+#include "common/network/io_uring.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Callbacks for the completion of a write submitted to an IoUringWorker.
+ */
+class IoUringWriteCallbacks {
+public:
+  virtual ~IoUringWriteCallbacks() {}
+
+  /**
+   * Called once the write has completed.
+   * @param result supplies the number of bytes written, which may be less than the length of the
+   *        write, or -errno if the write failed.
+   */
+  virtual void onWriteComplete(int32_t result) PURE;
+};
+
+class IoUringWorker;
+
+/**
+ * A write of a socket owned by an IoUringWorker, from its submission until its completion.
+ */
+class IoUringWrite : public LinkedObject<IoUringWrite> {
+public:
+  IoUringWrite(IoUringWorker& worker, int fd, IoUringWriteCallbacks& callbacks)
+      : worker_(worker), fd_(fd), callbacks_(&callbacks) {}
+
+  /**
+   * Stop notifying the callbacks of the write, before they are destroyed or the socket is closed.
+   * The write still goes ahead, as a write() that returned before the socket was closed would have.
+   */
+  void detach();
+
+private:
+  friend class IoUringWorker;
+
+  IoUringWorker& worker_;
+  const int fd_;
+  IoUringWriteCallbacks* callbacks_;
+  // The data of the write, in a registered buffer or, if fixed_buffer_ is -1, in heap_data_.
+  struct iovec iovec_ {};
+  int32_t fixed_buffer_{-1};
+  std::unique_ptr<uint8_t[]> heap_data_;
+};
+
+/**
+ * Submits the socket writes of a dispatcher to an io_uring. The writes queued during an iteration
+ * of the event loop are handed to the kernel together, by a single system call at the end of the
+ * iteration, and their completions are reaped once the kernel signals them through an eventfd
+ * watched by the dispatcher.
+ *
+ * The data of a write is copied out of the buffer it is written from, so that the buffer is only
+ * drained of what the kernel reports as written, and so that the kernel never reads memory that
+ * may have been freed and reused once the socket is closed. Writes that fit are copied into
+ * buffers registered with the ring, which saves the kernel pinning the pages of each write. The
+ * registered buffers are allocated from the buffer slice pool, and so come from the same per
+ * thread free lists as the slices of the connection buffers.
+ */
+class IoUringWorker : Logger::Loggable<Logger::Id::connection> {
+public:
+  static constexpr uint32_t DefaultEntries = 256;
+  static constexpr uint32_t FixedBufferSize = 16384;
+  static constexpr uint32_t FixedBufferCount = 64;
+  // Upper bound on the length of a single write.
+  static constexpr uint64_t MaxWriteSize = 262144;
+
+  /**
+   * @param dispatcher supplies the dispatcher of the sockets, which must outlive the worker.
+   * @param entries supplies the size of the submission queue, which also bounds the number of
+   *        writes in flight.
+   */
+  IoUringWorker(Event::Dispatcher& dispatcher, uint32_t entries = DefaultEntries);
+  ~IoUringWorker();
+
+  /**
+   * @return bool whether the worker's ring is set up. If not, write() always returns nullptr.
+   */
+  bool isSupported() const { return ring_->isSupported() && file_event_ != nullptr; }
+
+  /**
+   * Submit a write of the front of a buffer, of up to MaxWriteSize bytes, to a socket.
+   * @param fd supplies the socket, which must stay open until the write completes or is detached.
+   * @param data supplies the buffer, which is copied from and left untouched.
+   * @param callbacks supplies the callbacks notified when the write completes.
+   * @return IoUringWrite* the write, owned by the worker, or nullptr if the ring is full or isn't
+   *         supported.
+   */
+  IoUringWrite* write(int fd, const Buffer::Instance& data, IoUringWriteCallbacks& callbacks);
+
+  /**
+   * Hand the queued writes to the kernel now, rather than at the end of the event loop iteration.
+   */
+  void submit();
+
+  /**
+   * @return uint64_t the number of writes in flight.
+   */
+  uint64_t writes() const { return writes_.size(); }
+
+private:
+  typedef std::unique_ptr<IoUringWrite> IoUringWritePtr;
+
+  void prepare(IoUringWrite& write);
+  void onCompletions();
+  void onWriteComplete(IoUringWrite& write, int32_t result);
+
+  Event::Dispatcher& dispatcher_;
+  std::unique_ptr<IoUring> ring_;
+  int event_fd_{-1};
+  Event::FileEventPtr file_event_;
+  Event::TimerPtr submit_timer_;
+  std::vector<struct iovec> fixed_buffers_;
+  std::vector<uint16_t> free_fixed_buffers_;
+  std::list<IoUringWritePtr> writes_;
+};
+
+/**
+ * An IoUringWorker per thread, shared by the transport socket factories that use io_uring.
+ */
+class ThreadLocalIoUringWorkers : public Singleton::Instance {
+public:
+  explicit ThreadLocalIoUringWorkers(ThreadLocal::SlotAllocator& tls);
+
+  /**
+   * @return IoUringWorker* the worker of the calling thread, or nullptr if io_uring isn't
+   *         supported.
+   */
+  IoUringWorker* get();
+
+private:
+  struct ThreadLocalWorker : public ThreadLocal::ThreadLocalObject {
+    explicit ThreadLocalWorker(Event::Dispatcher& dispatcher) : worker_(dispatcher) {}
+
+    IoUringWorker worker_;
+  };
+
+  ThreadLocal::SlotPtr slot_;
+};
+
+typedef std::shared_ptr<ThreadLocalIoUringWorkers> ThreadLocalIoUringWorkersSharedPtr;
+
+} // namespace Network
+} // namespace Envoy
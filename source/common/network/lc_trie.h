@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <climits>
+#include <utility>
 #include <vector>
 
 #include "envoy/common/exception.h"
@@ -414,7 +415,8 @@ private:
   public:
     /**
      * Construct a LC-Trie for IpType.
-     * @param data supplies a vector of data and CIDR ranges (in IpPrefix format).
+     * @param data supplies a vector of data and CIDR ranges (in IpPrefix format). The vector is
+     *             consumed by the construction.
      * @param fill_factor supplies the fraction of completeness to use when calculating the branch
      *                    value for a sub-trie.
      * @param root_branching_factor supplies the branching factor at the root. The paper suggests
@@ -442,7 +444,7 @@ private:
         return;
       }
 
-      ip_prefixes_ = data;
+      ip_prefixes_ = std::move(data);
       std::sort(ip_prefixes_.begin(), ip_prefixes_.end());
 
       // Build the trie_.
@@ -454,6 +456,18 @@ private:
       ASSERT(next_free_index <= trie_.size());
       trie_.resize(next_free_index);
       trie_.shrink_to_fit();
+
+      // A lookup only reads the CIDR range and the data of the leaf it ends at. They are copied
+      // out of ip_prefixes_, whose data sets are hash sets of their own, into two dense arrays
+      // indexed like ip_prefixes_, and ip_prefixes_ is released.
+      leaf_ranges_.reserve(ip_prefixes_.size());
+      leaf_data_.reserve(ip_prefixes_.size());
+      for (const auto& ip_prefix : ip_prefixes_) {
+        leaf_ranges_.push_back({ip_prefix.ip_, ip_prefix.length_});
+        leaf_data_.emplace_back(ip_prefix.data_.begin(), ip_prefix.data_.end());
+      }
+      ip_prefixes_.clear();
+      ip_prefixes_.shrink_to_fit();
     }
 
     // Thin wrapper around computeBranch output to facilitate code readability.
@@ -678,12 +692,33 @@ private:
       uint32_t address_ : 20; // If this 20-bit size changes, please change MaxLcTrieNodes too.
     };
 
+    /**
+     * The CIDR range of a leaf, without its data.
+     */
+    struct LeafRange {
+      /**
+       * @param address supplies an IP address to check against this range.
+       * @return bool true if this range contains the address.
+       */
+      bool contains(const IpType& address) const {
+        return (extractBits<IpType, address_size>(0, length_, ip_) ==
+                extractBits<IpType, address_size>(0, length_, address));
+      }
+
+      IpType ip_;
+      uint32_t length_;
+    };
+
+    // The sorted CIDR ranges and data the trie_ is built from. Only used during the build.
+    std::vector<IpPrefix<IpType>> ip_prefixes_;
+
     // The CIDR range and data needs to be maintained separately from the LC-Trie. A LC-Trie skips
     // chunks of data while searching for a match. This means that the node found in the LC-Trie
     // is not guaranteed to have the IP address in range. The last step prior to returning
     // associated data is to check the CIDR range pointed to by the node in the LC-Trie has
-    // the IP address in range.
-    std::vector<IpPrefix<IpType>> ip_prefixes_;
+    // the IP address in range. Both are indexed by the address_ of the leaf nodes of the trie_.
+    std::vector<LeafRange> leaf_ranges_;
+    std::vector<std::vector<T>> leaf_data_;
 
     // Main trie search structure.
     std::vector<LcNode> trie_;
@@ -733,9 +768,8 @@ LcTrie<T>::LcTrieInternal<IpType, address_size>::getData(const IpType& ip_addres
   // The path taken through the trie to match the ip_address may have contained skips,
   // so it is necessary to check whether the matched prefix really contains the
   // ip_address.
-  const auto& prefix = ip_prefixes_[address];
-  if (prefix.contains(ip_address)) {
-    return std::vector<T>(prefix.data_.begin(), prefix.data_.end());
+  if (leaf_ranges_[address].contains(ip_address)) {
+    return leaf_data_[address];
   }
   return std::vector<T>();
 }
@@ -1,5 +1,7 @@
 #include "common/network/listener_impl.h"
 
+#include <fcntl.h>
+#include <sys/socket.h>
 #include <sys/un.h>
 
 #include "envoy/common/exception.h"
@@ -8,27 +10,74 @@
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
 #include "common/event/dispatcher_impl.h"
-#include "common/event/file_event_impl.h"
 #include "common/network/address_impl.h"
 #include "common/network/io_socket_handle_impl.h"
 
-#include "event2/listener.h"
-
 namespace Envoy {
 namespace Network {
 
-void ListenerImpl::listenCallback(evconnlistener*, evutil_socket_t fd, sockaddr* remote_addr,
-                                  int remote_addr_len, void* arg) {
-  ListenerImpl* listener = static_cast<ListenerImpl*>(arg);
+namespace {
+
+// The backlog that libevent's evconnlistener used to listen with, kept for compatibility.
+constexpr int ListenBacklog = 128;
+
+int acceptNonBlocking(int fd, sockaddr* addr, socklen_t* addr_len) {
+#if defined(__APPLE__)
+  // accept4() is not available, so the flags are set with separate system calls.
+  const int new_fd = ::accept(fd, addr, addr_len);
+  if (new_fd >= 0) {
+    RELEASE_ASSERT(fcntl(new_fd, F_SETFL, O_NONBLOCK) != -1, "");
+    RELEASE_ASSERT(fcntl(new_fd, F_SETFD, FD_CLOEXEC) != -1, "");
+  }
+  return new_fd;
+#else
+  return ::accept4(fd, addr, addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#endif
+}
+
+} // namespace
+
+void ListenerImpl::onSocketEvent(uint32_t events) {
+  ASSERT(events == Event::FileReadyType::Read);
+  const MonotonicTime start = dispatcher_.timeSource().monotonicTime();
+
+  uint32_t accepted = 0;
+  while (accepted < max_connections_to_accept_per_socket_event_) {
+    sockaddr_storage remote_addr;
+    socklen_t remote_addr_len = sizeof(remote_addr);
+    const int fd = acceptNonBlocking(socket_.ioHandle().fd(),
+                                     reinterpret_cast<sockaddr*>(&remote_addr), &remote_addr_len);
+    if (fd < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      // This can happen if we run out of FDs or memory. In those cases just crash.
+      PANIC(fmt::format("listener accept failure: {}", strerror(errno)));
+    }
+
+    accepted++;
+    onAcceptedSocket(fd, remote_addr, remote_addr_len);
+  }
 
+  if (accepted > 0) {
+    cb_.onAcceptBatchComplete(std::chrono::duration_cast<std::chrono::microseconds>(
+                                  dispatcher_.timeSource().monotonicTime() - start),
+                              accepted == max_connections_to_accept_per_socket_event_);
+  }
+}
+
+void ListenerImpl::onAcceptedSocket(int fd, const sockaddr_storage& remote_addr,
+                                    socklen_t remote_addr_len) {
   // Create the IoSocketHandleImpl for the fd here.
   IoHandlePtr io_handle = std::make_unique<IoSocketHandleImpl>(fd);
 
   // Get the local address from the new socket if the listener is listening on IP ANY
   // (e.g., 0.0.0.0 for IPv4) (local_address_ is nullptr in this case).
   const Address::InstanceConstSharedPtr& local_address =
-      listener->local_address_ ? listener->local_address_
-                               : listener->getLocalAddress(io_handle->fd());
+      local_address_ ? local_address_ : getLocalAddress(io_handle->fd());
   // The accept() call that filled in remote_addr doesn't fill in more than the sa_family field
   // for Unix domain sockets; apparently there isn't a mechanism in the kernel to get the
   // sockaddr_un associated with the client socket when starting from the server socket.
@@ -37,21 +86,17 @@ void ListenerImpl::listenCallback(evconnlistener*, evutil_socket_t fd, sockaddr*
   // if the socket is a v4 socket, but for v6 sockets this will create an IPv4 remote address if an
   // IPv4 local_address was created from an IPv6 mapped IPv4 address.
   const Address::InstanceConstSharedPtr& remote_address =
-      (remote_addr->sa_family == AF_UNIX)
+      (remote_addr.ss_family == AF_UNIX)
           ? Address::peerAddressFromFd(io_handle->fd())
-          : Address::addressFromSockAddr(*reinterpret_cast<const sockaddr_storage*>(remote_addr),
-                                         remote_addr_len,
+          : Address::addressFromSockAddr(remote_addr, remote_addr_len,
                                          local_address->ip()->version() == Address::IpVersion::v6);
-  listener->cb_.onAccept(
+  cb_.onAccept(
       std::make_unique<AcceptedSocketImpl>(std::move(io_handle), local_address, remote_address),
-      listener->hand_off_restored_destination_connections_);
+      hand_off_restored_destination_connections_);
 }
 
 void ListenerImpl::setupServerSocket(Event::DispatcherImpl& dispatcher, Socket& socket) {
-  listener_.reset(
-      evconnlistener_new(&dispatcher.base(), listenCallback, this, 0, -1, socket.ioHandle().fd()));
-
-  if (!listener_) {
+  if (::listen(socket.ioHandle().fd(), ListenBacklog) < 0) {
     throw CreateListenerException(
         fmt::format("cannot listen on socket: {}", socket.localAddress()->asString()));
   }
@@ -62,34 +107,34 @@ void ListenerImpl::setupServerSocket(Event::DispatcherImpl& dispatcher, Socket&
                                               socket.localAddress()->asString()));
   }
 
-  evconnlistener_set_error_cb(listener_.get(), errorCallback);
+  // The event is level triggered so that connections left in the backlog once the per event
+  // accept limit is reached are picked up on the next event loop iteration.
+  file_event_ = dispatcher.createFileEvent(
+      socket.ioHandle().fd(), [this](uint32_t events) -> void { onSocketEvent(events); },
+      Event::FileTriggerType::Level, Event::FileReadyType::Read);
 }
 
 ListenerImpl::ListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, ListenerCallbacks& cb,
-                           bool bind_to_port, bool hand_off_restored_destination_connections)
+                           bool bind_to_port, bool hand_off_restored_destination_connections,
+                           uint32_t max_connections_to_accept_per_socket_event)
     : BaseListenerImpl(dispatcher, socket), cb_(cb),
       hand_off_restored_destination_connections_(hand_off_restored_destination_connections),
-      listener_(nullptr) {
+      max_connections_to_accept_per_socket_event_(max_connections_to_accept_per_socket_event) {
+  ASSERT(max_connections_to_accept_per_socket_event_ > 0);
   if (bind_to_port) {
     setupServerSocket(dispatcher, socket);
   }
 }
 
-void ListenerImpl::errorCallback(evconnlistener*, void*) {
-  // We should never get an error callback. This can happen if we run out of FDs or memory. In those
-  // cases just crash.
-  PANIC(fmt::format("listener accept failure: {}", strerror(errno)));
-}
-
 void ListenerImpl::enable() {
-  if (listener_.get()) {
-    evconnlistener_enable(listener_.get());
+  if (file_event_) {
+    file_event_->setEnabled(Event::FileReadyType::Read);
   }
 }
 
 void ListenerImpl::disable() {
-  if (listener_.get()) {
-    evconnlistener_disable(listener_.get());
+  if (file_event_) {
+    file_event_->setEnabled(0);
   }
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "envoy/event/file_event.h"
+
 #include "base_listener_impl.h"
 
 namespace Envoy {
@@ -12,7 +14,8 @@ namespace Network {
 class ListenerImpl : public BaseListenerImpl {
 public:
   ListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, ListenerCallbacks& cb,
-               bool bind_to_port, bool hand_off_restored_destination_connections);
+               bool bind_to_port, bool hand_off_restored_destination_connections,
+               uint32_t max_connections_to_accept_per_socket_event);
 
   void disable() override;
   void enable() override;
@@ -24,11 +27,11 @@ protected:
   const bool hand_off_restored_destination_connections_;
 
 private:
-  static void listenCallback(evconnlistener*, evutil_socket_t fd, sockaddr* remote_addr,
-                             int remote_addr_len, void* arg);
-  static void errorCallback(evconnlistener* listener, void* context);
+  void onSocketEvent(uint32_t events);
+  void onAcceptedSocket(int fd, const sockaddr_storage& remote_addr, socklen_t remote_addr_len);
 
-  Event::Libevent::ListenerPtr listener_;
+  const uint32_t max_connections_to_accept_per_socket_event_;
+  Event::FileEventPtr file_event_;
 };
 
 } // namespace Network
@@ -1,5 +1,7 @@
 #include "common/network/raw_buffer_socket.h"
 
+#include <algorithm>
+
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/http/headers.h"
@@ -7,6 +9,8 @@
 namespace Envoy {
 namespace Network {
 
+constexpr uint64_t RawBufferSocket::DefaultReadSize;
+
 void RawBufferSocket::setTransportSocketCallbacks(TransportSocketCallbacks& callbacks) {
   callbacks_ = &callbacks;
 }
@@ -16,8 +20,11 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
   uint64_t bytes_read = 0;
   bool end_stream = false;
   do {
-    // 16K read is arbitrary. TODO(mattklein123) PERF: Tune the read size.
-    Api::IoCallUint64Result result = buffer.read(callbacks_->ioHandle(), 16384);
+    uint64_t max_length = read_size_;
+    if (read_budget_ != 0) {
+      max_length = std::min(max_length, read_budget_ - bytes_read);
+    }
+    Api::IoCallUint64Result result = buffer.read(callbacks_->ioHandle(), max_length);
 
     if (result.ok()) {
       ENVOY_CONN_LOG(trace, "read returns: {}", callbacks_->connection(), result.rc_);
@@ -27,7 +34,10 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
         break;
       }
       bytes_read += result.rc_;
-      if (callbacks_->shouldDrainReadBuffer()) {
+      // Once the budget is spent, resume on the next dispatcher iteration so that a fast sender
+      // cannot starve the other connections of the worker.
+      if (callbacks_->shouldDrainReadBuffer() ||
+          (read_budget_ != 0 && bytes_read >= read_budget_)) {
         callbacks_->setReadBufferReady();
         break;
       }
@@ -46,20 +56,46 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
 }
 
 IoResult RawBufferSocket::doWrite(Buffer::Instance& buffer, bool end_stream) {
-  PostIoAction action;
-  uint64_t bytes_written = 0;
   ASSERT(!shutdown_ || buffer.length() == 0);
-  do {
-    if (buffer.length() == 0) {
-      if (end_stream && !shutdown_) {
-        // Ignore the result. This can only fail if the connection failed. In that case, the
-        // error will be detected on the next read, and dealt with appropriately.
-        ::shutdown(callbacks_->ioHandle().fd(), SHUT_WR);
-        shutdown_ = true;
+  uint64_t bytes_written = 0;
+  if (io_uring_ != nullptr) {
+    if (io_uring_write_ != nullptr) {
+      // A socket has a single write in flight. The rest of the buffer is written once it completes.
+      return {PostIoAction::KeepOpen, 0, false};
+    }
+    // The data of a write stays in the buffer until the write completes.
+    bytes_written = io_uring_written_;
+    buffer.drain(bytes_written);
+    io_uring_written_ = 0;
+    if (io_uring_error_ != 0) {
+      ENVOY_CONN_LOG(trace, "io_uring write error: {}", callbacks_->connection(), io_uring_error_);
+      return {PostIoAction::Close, bytes_written, false};
+    }
+    if (!io_uring_blocked_ && buffer.length() > 0) {
+      io_uring_write_ = io_uring_->write(callbacks_->ioHandle().fd(), buffer, *this);
+      if (io_uring_write_ != nullptr) {
+        return {PostIoAction::KeepOpen, bytes_written, false};
       }
-      action = PostIoAction::KeepOpen;
-      break;
+      // The ring is full, write with system calls.
     }
+    // Kernels that can't wait for room in a full socket complete its writes with EAGAIN. Writing
+    // with system calls until the socket blocks makes its write event fire once there is room.
+    io_uring_blocked_ = false;
+  }
+
+  const PostIoAction action = writeUntilBlocked(buffer, bytes_written);
+  if (action == PostIoAction::KeepOpen && buffer.length() == 0 && end_stream && !shutdown_) {
+    // Ignore the result. This can only fail if the connection failed. In that case, the
+    // error will be detected on the next read, and dealt with appropriately.
+    ::shutdown(callbacks_->ioHandle().fd(), SHUT_WR);
+    shutdown_ = true;
+  }
+  return {action, bytes_written, false};
+}
+
+PostIoAction RawBufferSocket::writeUntilBlocked(Buffer::Instance& buffer,
+                                                uint64_t& bytes_written) {
+  while (buffer.length() > 0) {
     Api::IoCallUint64Result result = buffer.write(callbacks_->ioHandle());
 
     if (result.ok()) {
@@ -69,17 +105,37 @@ IoResult RawBufferSocket::doWrite(Buffer::Instance& buffer, bool end_stream) {
       ENVOY_CONN_LOG(trace, "write error: {}", callbacks_->connection(),
                      result.err_->getErrorDetails());
       if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
-        action = PostIoAction::KeepOpen;
-      } else {
-        action = PostIoAction::Close;
+        return PostIoAction::KeepOpen;
       }
-      break;
+      return PostIoAction::Close;
     }
-  } while (true);
+  }
+  return PostIoAction::KeepOpen;
+}
 
-  return {action, bytes_written, false};
+void RawBufferSocket::onWriteComplete(int32_t result) {
+  ENVOY_CONN_LOG(trace, "io_uring write returns: {}", callbacks_->connection(), result);
+  io_uring_write_ = nullptr;
+  if (result >= 0) {
+    io_uring_written_ = result;
+  } else if (result == -EAGAIN) {
+    io_uring_blocked_ = true;
+  } else if (result != -EINTR) {
+    io_uring_error_ = -result;
+  }
+  // Drain what was written, and carry on with the rest of the buffer or the pending shutdown.
+  callbacks_->flushWriteBuffer();
 }
 
+void RawBufferSocket::closeSocket(Network::ConnectionEvent) {
+  if (io_uring_write_ != nullptr) {
+    io_uring_write_->detach();
+    io_uring_write_ = nullptr;
+  }
+}
+
+RawBufferSocket::~RawBufferSocket() { closeSocket(ConnectionEvent::LocalClose); }
+
 std::string RawBufferSocket::protocol() const { return EMPTY_STRING; }
 absl::string_view RawBufferSocket::failureReason() const { return EMPTY_STRING; }
 
@@ -87,7 +143,9 @@ void RawBufferSocket::onConnected() { callbacks_->raiseEvent(ConnectionEvent::Co
 
 TransportSocketPtr
 RawBufferSocketFactory::createTransportSocket(TransportSocketOptionsSharedPtr) const {
-  return std::make_unique<RawBufferSocket>();
+  // Sockets are created on the thread of the dispatcher that runs them.
+  return std::make_unique<RawBufferSocket>(read_size_, read_budget_,
+                                           io_uring_ != nullptr ? io_uring_->get() : nullptr);
 }
 
 bool RawBufferSocketFactory::implementsSecureTransport() const { return false; }
@@ -5,33 +5,83 @@
 #include "envoy/network/transport_socket.h"
 
 #include "common/common/logger.h"
+#include "common/network/io_uring_worker.h"
 
 namespace Envoy {
 namespace Network {
 
-class RawBufferSocket : public TransportSocket, protected Logger::Loggable<Logger::Id::connection> {
+class RawBufferSocket : public TransportSocket,
+                        public IoUringWriteCallbacks,
+                        protected Logger::Loggable<Logger::Id::connection> {
 public:
+  // 16K read is arbitrary. TODO(mattklein123) PERF: Tune the read size.
+  static constexpr uint64_t DefaultReadSize = 16384;
+
+  /**
+   * @param read_size supplies the maximum number of bytes requested by each read syscall.
+   * @param read_budget supplies the maximum number of bytes doRead() reads before yielding to
+   *        other connections on the same dispatcher, or 0 to read until the socket would block.
+   * @param io_uring supplies the io_uring worker of the socket's dispatcher that writes are
+   *        submitted to, or nullptr to write with system calls.
+   */
+  explicit RawBufferSocket(uint64_t read_size = DefaultReadSize, uint64_t read_budget = 0,
+                           IoUringWorker* io_uring = nullptr)
+      : read_size_(read_size), read_budget_(read_budget), io_uring_(io_uring) {}
+  ~RawBufferSocket();
+
   // Network::TransportSocket
   void setTransportSocketCallbacks(TransportSocketCallbacks& callbacks) override;
   std::string protocol() const override;
   absl::string_view failureReason() const override;
   bool canFlushClose() override { return true; }
-  void closeSocket(Network::ConnectionEvent) override {}
+  void closeSocket(Network::ConnectionEvent) override;
   void onConnected() override;
   IoResult doRead(Buffer::Instance& buffer) override;
   IoResult doWrite(Buffer::Instance& buffer, bool end_stream) override;
   const Ssl::ConnectionInfo* ssl() const override { return nullptr; }
 
+  // Network::IoUringWriteCallbacks
+  void onWriteComplete(int32_t result) override;
+
 private:
+  PostIoAction writeUntilBlocked(Buffer::Instance& buffer, uint64_t& bytes_written);
+
+  const uint64_t read_size_;
+  const uint64_t read_budget_;
+  IoUringWorker* io_uring_;
   TransportSocketCallbacks* callbacks_{};
+  // The write in flight in io_uring_, if any.
+  IoUringWrite* io_uring_write_{};
+  // The number of bytes written by the last write completed by io_uring_, to be drained from the
+  // write buffer.
+  uint64_t io_uring_written_{};
+  // Whether the last write completed by io_uring_ found the socket full.
+  bool io_uring_blocked_{};
+  int io_uring_error_{};
   bool shutdown_{};
 };
 
 class RawBufferSocketFactory : public TransportSocketFactory {
 public:
+  /**
+   * @param read_size supplies the read size of the sockets created. @see RawBufferSocket.
+   * @param read_budget supplies the read budget of the sockets created. @see RawBufferSocket.
+   * @param io_uring supplies the io_uring workers that the sockets created submit their writes
+   *        to, or nullptr to write with system calls. @see RawBufferSocket.
+   */
+  explicit RawBufferSocketFactory(uint64_t read_size = RawBufferSocket::DefaultReadSize,
+                                  uint64_t read_budget = 0,
+                                  ThreadLocalIoUringWorkersSharedPtr io_uring = nullptr)
+      : read_size_(read_size), read_budget_(read_budget), io_uring_(std::move(io_uring)) {}
+
   // Network::TransportSocketFactory
   TransportSocketPtr createTransportSocket(TransportSocketOptionsSharedPtr options) const override;
   bool implementsSecureTransport() const override;
+
+private:
+  const uint64_t read_size_;
+  const uint64_t read_budget_;
+  const ThreadLocalIoUringWorkersSharedPtr io_uring_;
 };
 
 } // namespace Network
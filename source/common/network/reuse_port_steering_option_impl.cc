@@ -0,0 +1,131 @@
+#include "common/network/reuse_port_steering_option_impl.h"
+
+#ifdef __linux__
+#include <linux/filter.h>
+#endif
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+#include "common/network/socket_option_impl.h"
+
+namespace Envoy {
+namespace Network {
+
+namespace {
+
+#ifdef __linux__
+// The loads of a program are relative to the UDP payload, unless they are offset by this, which
+// makes them relative to the network header.
+constexpr uint32_t NetworkHeader = static_cast<uint32_t>(SKF_NET_OFF);
+
+// Loads the source address into A, with the words of an IPv6 address folded together. The
+// datagrams that an IPv6 socket receives from IPv4 clients have an IPv4 header.
+std::vector<sock_filter> sourceIpProgram() {
+  return {
+      BPF_STMT(BPF_LD | BPF_B | BPF_ABS, NetworkHeader),
+      BPF_STMT(BPF_ALU | BPF_RSH | BPF_K, 4),
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 6, 0, 11),
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, NetworkHeader + 8),
+      BPF_STMT(BPF_MISC | BPF_TAX, 0),
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, NetworkHeader + 12),
+      BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+      BPF_STMT(BPF_MISC | BPF_TAX, 0),
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, NetworkHeader + 16),
+      BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+      BPF_STMT(BPF_MISC | BPF_TAX, 0),
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, NetworkHeader + 20),
+      BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+      BPF_JUMP(BPF_JMP | BPF_JA, 1, 0, 0),
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, NetworkHeader + 12),
+  };
+}
+
+// Loads the leading 4 bytes of the destination connection ID into A. It follows the first byte of
+// a short header, and the first byte, the version and the connection ID length of a long header.
+std::vector<sock_filter> quicConnectionIdProgram() {
+  return {
+      BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+      BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x80, 2, 0),
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 1),
+      BPF_JUMP(BPF_JMP | BPF_JA, 1, 0, 0),
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 6),
+  };
+}
+#endif
+
+} // namespace
+
+ReusePortSteeringOptionImpl::ReusePortSteeringOptionImpl(ReusePortFlowKey flow_key,
+                                                         uint32_t sockets) {
+  ASSERT(sockets > 0);
+#ifdef __linux__
+  std::vector<sock_filter> program;
+  switch (flow_key) {
+  case ReusePortFlowKey::SourceIp:
+    program = sourceIpProgram();
+    break;
+  case ReusePortFlowKey::QuicConnectionId:
+    program = quicConnectionIdProgram();
+    break;
+  }
+  // A failed load ends the program with a return value of 0, i.e. the first socket.
+  program.push_back(BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, sockets));
+  program.push_back(BPF_STMT(BPF_RET | BPF_A, 0));
+  program_.assign(reinterpret_cast<const char*>(program.data()),
+                  program.size() * sizeof(sock_filter));
+#else
+  UNREFERENCED_PARAMETER(flow_key);
+#endif
+}
+
+bool ReusePortSteeringOptionImpl::setOption(
+    Socket& socket, envoy::api::v2::core::SocketOption::SocketState state) const {
+  // The program can only be attached once the socket is part of a reuse_port group.
+  if (state != envoy::api::v2::core::SocketOption::STATE_BOUND) {
+    return true;
+  }
+  if (!isSupported()) {
+    ENVOY_LOG(warn, "Attaching a reuse_port steering program is not supported on this platform");
+    return false;
+  }
+
+#ifdef __linux__
+  sock_fprog program;
+  program.len = program_.size() / sizeof(sock_filter);
+  program.filter = reinterpret_cast<sock_filter*>(const_cast<char*>(program_.data()));
+  const Api::SysCallIntResult result = SocketOptionImpl::setSocketOption(
+      socket, ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF,
+      absl::string_view(reinterpret_cast<const char*>(&program), sizeof(program)));
+  if (result.rc_ != 0) {
+    ENVOY_LOG(warn, "Attaching a reuse_port steering program failed: {}",
+              strerror(result.errno_));
+    return false;
+  }
+#else
+  UNREFERENCED_PARAMETER(socket);
+#endif
+  return true;
+}
+
+// The steering does not affect the connections made on the socket, so it needs no hash key.
+void ReusePortSteeringOptionImpl::hashKey(std::vector<uint8_t>&) const {}
+
+absl::optional<Socket::Option::Details> ReusePortSteeringOptionImpl::getOptionDetails(
+    const Socket&, envoy::api::v2::core::SocketOption::SocketState state) const {
+  if (state != envoy::api::v2::core::SocketOption::STATE_BOUND || !isSupported()) {
+    return absl::nullopt;
+  }
+
+  Socket::Option::Details info;
+  info.name_ = ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF;
+  info.value_ = program_;
+  return absl::optional<Option::Details>(std::move(info));
+}
+
+bool ReusePortSteeringOptionImpl::isSupported() const {
+  return ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF.has_value() && !program_.empty();
+}
+
+} // namespace Network
+} // namespace Envoy
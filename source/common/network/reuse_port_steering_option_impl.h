@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/network/listen_socket.h"
+
+#include "common/common/logger.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * The part of a datagram that decides which socket of a reuse_port group receives it.
+ */
+enum class ReusePortFlowKey {
+  // The source IP address, which keeps the datagrams of a client on the same socket when its port
+  // changes, e.g. after a NAT rebinding.
+  SourceIp,
+  // The leading 4 bytes of the destination connection ID of a QUIC packet, which keeps the packets
+  // of a QUIC connection on the same socket when the client address changes.
+  QuicConnectionId,
+};
+
+/**
+ * Socket option that attaches a classic BPF program to the reuse_port group of a socket once it is
+ * bound, which steers every datagram to the socket whose index in the group is its flow key modulo
+ * the number of sockets. The sockets of a group are indexed in the order they were bound, so the
+ * steering is exact while the listener's sockets are the only ones bound to the port. Datagrams
+ * whose flow key cannot be read go to the first socket. The leading bytes of a connection ID are
+ * read as a big endian integer.
+ */
+class ReusePortSteeringOptionImpl : public Socket::Option,
+                                    Logger::Loggable<Logger::Id::connection> {
+public:
+  /**
+   * @param flow_key supplies the flow key the datagrams are steered by.
+   * @param sockets supplies the number of sockets of the reuse_port group.
+   */
+  ReusePortSteeringOptionImpl(ReusePortFlowKey flow_key, uint32_t sockets);
+
+  // Socket::Option
+  bool setOption(Socket& socket,
+                 envoy::api::v2::core::SocketOption::SocketState state) const override;
+  void hashKey(std::vector<uint8_t>& key) const override;
+  absl::optional<Details>
+  getOptionDetails(const Socket& socket,
+                   envoy::api::v2::core::SocketOption::SocketState state) const override;
+
+  bool isSupported() const;
+
+private:
+  // The instructions of the program, in the layout of struct sock_filter, which keeps them alive
+  // for the setsockopt() calls that refer to them.
+  std::string program_;
+};
+
+} // namespace Network
+} // namespace Envoy
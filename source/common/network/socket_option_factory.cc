@@ -94,5 +94,31 @@ SocketOptionFactory::buildTcpFastOpenOptions(uint32_t queue_length) {
   return options;
 }
 
+std::unique_ptr<Socket::Options> SocketOptionFactory::buildReusePortOptions() {
+  std::unique_ptr<Socket::Options> options = std::make_unique<Socket::Options>();
+  // Every socket sharing the port must have the option set before it is bound.
+  options->push_back(std::make_shared<Network::SocketOptionImpl>(
+      envoy::api::v2::core::SocketOption::STATE_PREBIND, ENVOY_SOCKET_SO_REUSEPORT, 1));
+  return options;
+}
+
+std::unique_ptr<Socket::Options>
+SocketOptionFactory::buildReusePortSteeringOptions(ReusePortFlowKey flow_key, uint32_t sockets) {
+  std::unique_ptr<Socket::Options> options = std::make_unique<Socket::Options>();
+  options->push_back(std::make_shared<Network::ReusePortSteeringOptionImpl>(flow_key, sockets));
+  return options;
+}
+
+std::unique_ptr<Socket::Options> SocketOptionFactory::buildIncomingCpuOptions(uint32_t cpu) {
+  std::unique_ptr<Socket::Options> options = std::make_unique<Socket::Options>();
+  // Unlike the other options, this one is left out where it isn't supported, as the CPU only
+  // steers the connections and failing to set it doesn't change how the socket behaves.
+  if (ENVOY_SOCKET_SO_INCOMING_CPU.has_value()) {
+    options->push_back(std::make_shared<Network::SocketOptionImpl>(
+        envoy::api::v2::core::SocketOption::STATE_PREBIND, ENVOY_SOCKET_SO_INCOMING_CPU, cpu));
+  }
+  return options;
+}
+
 } // namespace Network
 } // namespace Envoy
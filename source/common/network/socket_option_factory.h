@@ -7,6 +7,7 @@
 #include "envoy/network/listen_socket.h"
 
 #include "common/common/logger.h"
+#include "common/network/reuse_port_steering_option_impl.h"
 #include "common/protobuf/protobuf.h"
 
 #include "absl/types/optional.h"
@@ -29,6 +30,10 @@ public:
   static std::unique_ptr<Socket::Options> buildIpTransparentOptions();
   static std::unique_ptr<Socket::Options> buildSocketMarkOptions(uint32_t mark);
   static std::unique_ptr<Socket::Options> buildTcpFastOpenOptions(uint32_t queue_length);
+  static std::unique_ptr<Socket::Options> buildReusePortOptions();
+  static std::unique_ptr<Socket::Options> buildReusePortSteeringOptions(ReusePortFlowKey flow_key,
+                                                                        uint32_t sockets);
+  static std::unique_ptr<Socket::Options> buildIncomingCpuOptions(uint32_t cpu);
   static std::unique_ptr<Socket::Options> buildLiteralOptions(
       const Protobuf::RepeatedPtrField<envoy::api::v2::core::SocketOption>& socket_options);
 };
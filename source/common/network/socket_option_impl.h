@@ -46,6 +46,27 @@ namespace Network {
 #define ENVOY_SOCKET_SO_KEEPALIVE Network::SocketOptionName()
 #endif
 
+#ifdef SO_REUSEPORT
+#define ENVOY_SOCKET_SO_REUSEPORT                                                                  \
+  Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_REUSEPORT))
+#else
+#define ENVOY_SOCKET_SO_REUSEPORT Network::SocketOptionName()
+#endif
+
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+#define ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF                                                      \
+  Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF))
+#else
+#define ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF Network::SocketOptionName()
+#endif
+
+#ifdef SO_INCOMING_CPU
+#define ENVOY_SOCKET_SO_INCOMING_CPU                                                               \
+  Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_INCOMING_CPU))
+#else
+#define ENVOY_SOCKET_SO_INCOMING_CPU Network::SocketOptionName()
+#endif
+
 #ifdef SO_MARK
 #define ENVOY_SOCKET_SO_MARK Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_MARK))
 #else
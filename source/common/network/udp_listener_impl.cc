@@ -31,6 +31,9 @@ UdpListenerImpl::UdpListenerImpl(Event::DispatcherImpl& dispatcher, Socket& sock
     throw CreateListenerException(fmt::format("cannot set post-bound socket option on socket: {}",
                                               socket.localAddress()->asString()));
   }
+
+  // Checked once the socket options are all set, since GRO needs room for the coalesced datagrams.
+  batch_ = std::make_unique<UdpPacketBatch>(UdpPacketBatch::groEnabled(socket.ioHandle().fd()));
 }
 
 UdpListenerImpl::~UdpListenerImpl() {
@@ -44,32 +47,18 @@ void UdpListenerImpl::enable() {
   file_event_->setEnabled(Event::FileReadyType::Read | Event::FileReadyType::Write);
 }
 
-UdpListenerImpl::ReceiveResult UdpListenerImpl::doRecvFrom(sockaddr_storage& peer_addr,
-                                                           socklen_t& addr_len) {
-  constexpr uint64_t const read_length = 16384;
-
-  Buffer::InstancePtr buffer = std::make_unique<Buffer::OwnedImpl>();
-
-  addr_len = sizeof(sockaddr_storage);
-  memset(&peer_addr, 0, addr_len);
+Event::Dispatcher& UdpListenerImpl::dispatcher() { return dispatcher_; }
 
-  Buffer::RawSlice slice;
-  const uint64_t num_slices = buffer->reserve(read_length, &slice, 1);
-
-  ASSERT(num_slices == 1);
+const Address::InstanceConstSharedPtr& UdpListenerImpl::localAddress() const {
+  return socket_.localAddress();
+}
 
-  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
-  const Api::SysCallSizeResult result =
-      os_sys_calls.recvfrom(socket_.ioHandle().fd(), slice.mem_, read_length, 0,
-                            reinterpret_cast<struct sockaddr*>(&peer_addr), &addr_len);
-  if (result.rc_ < 0) {
-    return ReceiveResult{Api::SysCallIntResult{static_cast<int>(result.rc_), result.errno_},
-                         nullptr};
-  }
-  slice.len_ = std::min(slice.len_, static_cast<size_t>(result.rc_));
-  buffer->commit(&slice, 1);
+Api::SysCallIntResult UdpListenerImpl::send(const std::vector<UdpSendData>& datagrams) {
+  return UdpPacketBatch::sendTo(socket_.ioHandle().fd(), *socket_.localAddress(), datagrams);
+}
 
-  return ReceiveResult{Api::SysCallIntResult{static_cast<int>(result.rc_), 0}, std::move(buffer)};
+Api::SysCallIntResult UdpListenerImpl::doRecvBatch(const UdpPacketBatch::ReceiveCb& cb) {
+  return batch_->receive(socket_.ioHandle().fd(), true, cb);
 }
 
 void UdpListenerImpl::onSocketEvent(short flags) {
@@ -85,80 +74,36 @@ void UdpListenerImpl::onSocketEvent(short flags) {
 }
 
 void UdpListenerImpl::handleReadCallback() {
-  sockaddr_storage addr;
-  socklen_t addr_len = 0;
-
-  do {
-    ReceiveResult recv_result = doRecvFrom(addr, addr_len);
-    if ((recv_result.result_.rc_ < 0)) {
-      if (recv_result.result_.errno_ != EAGAIN) {
-        cb_.onError(UdpListenerCallbacks::ErrorCode::SyscallError, recv_result.result_.errno_);
+  const Address::InstanceConstSharedPtr& local_address = socket_.localAddress();
+  RELEASE_ASSERT((local_address != nullptr),
+                 fmt::format("Unable to get local address for fd: {}", socket_.ioHandle().fd()));
+
+  while (true) {
+    uint32_t datagrams = 0;
+    const Api::SysCallIntResult result =
+        doRecvBatch([this, &local_address, &datagrams](
+                        const Address::InstanceConstSharedPtr& peer_address,
+                        Buffer::InstancePtr&& buffer) -> void {
+          UdpData data{local_address, peer_address, std::move(buffer)};
+          cb_.onData(data);
+          datagrams++;
+        });
+    if (result.rc_ < 0) {
+      if (result.errno_ != EAGAIN) {
+        cb_.onError(UdpListenerCallbacks::ErrorCode::SyscallError, result.errno_);
       }
       return;
     }
 
-    if (recv_result.result_.rc_ == 0) {
-      // TODO(conqerAtapple): Is zero length packet interesting?
-      return;
+    if (datagrams > 0) {
+      cb_.onReceiveBatchComplete(datagrams);
     }
 
-    Address::InstanceConstSharedPtr local_address = socket_.localAddress();
-
-    RELEASE_ASSERT(
-        addr_len > 0,
-        fmt::format(
-            "Unable to get remote address for fd: {}, local address: {}. address length is 0 ",
-            socket_.ioHandle().fd(), local_address->asString()));
-
-    Address::InstanceConstSharedPtr peer_address;
-
-    // TODO(conqerAtApple): Current implementation of Address::addressFromSockAddr
-    // cannot be used here unfortunately. This should belong in Address namespace.
-    switch (addr.ss_family) {
-    case AF_INET: {
-      const struct sockaddr_in* sin = reinterpret_cast<const struct sockaddr_in*>(&addr);
-      ASSERT(AF_INET == sin->sin_family);
-      peer_address = std::make_shared<Address::Ipv4Instance>(sin);
-
-      break;
-    }
-    case AF_INET6: {
-      const struct sockaddr_in6* sin6 = reinterpret_cast<const struct sockaddr_in6*>(&addr);
-      ASSERT(AF_INET6 == sin6->sin6_family);
-      if (IN6_IS_ADDR_V4MAPPED(&sin6->sin6_addr)) {
-#if defined(__APPLE__)
-        struct sockaddr_in sin = {
-            {}, AF_INET, sin6->sin6_port, {sin6->sin6_addr.__u6_addr.__u6_addr32[3]}, {}};
-#else
-        struct sockaddr_in sin = {AF_INET, sin6->sin6_port, {sin6->sin6_addr.s6_addr32[3]}, {}};
-#endif
-        peer_address = std::make_shared<Address::Ipv4Instance>(&sin);
-      } else {
-        peer_address = std::make_shared<Address::Ipv6Instance>(*sin6, true);
-      }
-
-      break;
-    }
-
-    default:
-      RELEASE_ASSERT(false,
-                     fmt::format("Unsupported address family: {}, local address: {}, receive size: "
-                                 "{}, address length: {}",
-                                 addr.ss_family, local_address->asString(), recv_result.result_.rc_,
-                                 addr_len));
-      break;
+    // A batch that isn't full means that the socket was drained.
+    if (static_cast<uint32_t>(result.rc_) < UdpPacketBatch::MaxBatchSize) {
+      return;
     }
-
-    RELEASE_ASSERT((peer_address != nullptr),
-                   fmt::format("Unable to get remote address for fd: {}, local address: {} ",
-                               socket_.ioHandle().fd(), local_address->asString()));
-
-    RELEASE_ASSERT((local_address != nullptr),
-                   fmt::format("Unable to get local address for fd: {}", socket_.ioHandle().fd()));
-
-    cb_.onData(UdpData{local_address, peer_address, std::move(recv_result.buffer_)});
-
-  } while (true);
+  }
 }
 
 void UdpListenerImpl::handleWriteCallback() { cb_.onWriteReady(socket_); }
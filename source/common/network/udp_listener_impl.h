@@ -1,10 +1,13 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
+#include <vector>
 
 #include "common/buffer/buffer_impl.h"
 #include "common/event/event_impl_base.h"
 #include "common/event/file_event_impl.h"
+#include "common/network/udp_packet_batch.h"
 
 #include "base_listener_impl.h"
 
@@ -12,24 +15,28 @@ namespace Envoy {
 namespace Network {
 
 /**
- * libevent implementation of Network::Listener for UDP.
+ * libevent implementation of Network::UdpListener. Datagrams are received in batches, with
+ * UdpPacketBatch::MaxBatchSize datagrams per system call at most. If UDP GRO is enabled on the
+ * socket by its socket options, the datagrams coalesced by the kernel are split before being
+ * passed to the callbacks.
  */
-class UdpListenerImpl : public BaseListenerImpl {
+class UdpListenerImpl : public BaseListenerImpl, public UdpListener {
 public:
   UdpListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, UdpListenerCallbacks& cb);
 
   ~UdpListenerImpl();
 
-  virtual void disable() override;
-  virtual void enable() override;
+  // Network::Listener
+  void disable() override;
+  void enable() override;
 
-  struct ReceiveResult {
-    Api::SysCallIntResult result_;
-    Buffer::InstancePtr buffer_;
-  };
+  // Network::UdpListener
+  Event::Dispatcher& dispatcher() override;
+  const Address::InstanceConstSharedPtr& localAddress() const override;
+  Api::SysCallIntResult send(const std::vector<UdpSendData>& datagrams) override;
 
   // Useful for testing/mocking.
-  virtual ReceiveResult doRecvFrom(sockaddr_storage& peer_addr, socklen_t& addr_len);
+  virtual Api::SysCallIntResult doRecvBatch(const UdpPacketBatch::ReceiveCb& cb);
 
 protected:
   void handleWriteCallback();
@@ -40,6 +47,7 @@ protected:
 private:
   void onSocketEvent(short flags);
   Event::FileEventPtr file_event_;
+  std::unique_ptr<UdpPacketBatch> batch_;
 };
 
 } // namespace Network
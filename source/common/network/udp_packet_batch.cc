@@ -0,0 +1,308 @@
+#include "common/network/udp_packet_batch.h"
+
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/macros.h"
+#include "common/network/address_impl.h"
+
+#if defined(__linux__) && !defined(UDP_GRO)
+// Not defined by older C libraries. Kernels without UDP GRO reject the socket option.
+#define UDP_GRO 104
+#endif
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+// Fill the socket address of a peer for a socket bound to the given local address.
+socklen_t peerSockAddr(const Address::Instance& peer_address,
+                       const Address::Instance& local_address, sockaddr_storage& address) {
+  const Address::Ip* ip = peer_address.ip();
+  ASSERT(ip != nullptr);
+  memset(&address, 0, sizeof(address));
+
+  const bool ipv6_socket = local_address.ip() != nullptr &&
+                           local_address.ip()->version() == Address::IpVersion::v6;
+  if (ip->version() == Address::IpVersion::v4 && !ipv6_socket) {
+    sockaddr_in* sin = reinterpret_cast<sockaddr_in*>(&address);
+    sin->sin_family = AF_INET;
+    sin->sin_port = htons(ip->port());
+    sin->sin_addr.s_addr = ip->ipv4()->address();
+    return sizeof(sockaddr_in);
+  }
+
+  sockaddr_in6* sin6 = reinterpret_cast<sockaddr_in6*>(&address);
+  sin6->sin6_family = AF_INET6;
+  sin6->sin6_port = htons(ip->port());
+  if (ip->version() == Address::IpVersion::v4) {
+    // The IPv4-mapped address of the peer, ::ffff:a.b.c.d.
+    const uint32_t ipv4_address = ip->ipv4()->address();
+    sin6->sin6_addr.s6_addr[10] = 0xff;
+    sin6->sin6_addr.s6_addr[11] = 0xff;
+    memcpy(&sin6->sin6_addr.s6_addr[12], &ipv4_address, sizeof(ipv4_address));
+  } else {
+    const absl::uint128 ipv6_address = ip->ipv6()->address();
+    memcpy(&sin6->sin6_addr.s6_addr, &ipv6_address, sizeof(ipv6_address));
+  }
+  return sizeof(sockaddr_in6);
+}
+
+uint64_t numSlices(const Buffer::Instance& buffer) { return buffer.getRawSlices(nullptr, 0); }
+
+// Point a message at the raw slices of its datagram, which are appended to iovecs. The vector must
+// have been reserved for all the slices of the batch, so that the message's pointer stays valid.
+void setIovecs(const Buffer::Instance& buffer, std::vector<iovec>& iovecs, msghdr& message) {
+  const uint64_t num_slices = numSlices(buffer);
+  std::vector<Buffer::RawSlice> slices(num_slices);
+  buffer.getRawSlices(slices.data(), num_slices);
+
+  message.msg_iov = iovecs.data() + iovecs.size();
+  message.msg_iovlen = num_slices;
+  for (const Buffer::RawSlice& slice : slices) {
+    iovecs.push_back({slice.mem_, slice.len_});
+  }
+}
+
+} // namespace
+
+constexpr uint32_t UdpPacketBatch::MaxBatchSize;
+constexpr uint64_t UdpPacketBatch::MaxDatagramSize;
+constexpr uint64_t UdpPacketBatch::MaxGroDatagramSize;
+
+UdpPacketBatch::UdpPacketBatch(bool gro)
+    : gro_(gro), max_datagram_size_(gro ? MaxGroDatagramSize : MaxDatagramSize),
+      buffer_(new uint8_t[MaxBatchSize * max_datagram_size_]) {}
+
+Api::SysCallIntResult UdpPacketBatch::receive(int fd, bool peer_addresses, const ReceiveCb& cb) {
+#if defined(__linux__)
+  // Room for the segment size of the messages coalesced by GRO.
+  union ControlBuffer {
+    cmsghdr align_;
+    char data_[CMSG_SPACE(sizeof(int))];
+  };
+
+  mmsghdr headers[MaxBatchSize];
+  iovec iovecs[MaxBatchSize];
+  sockaddr_storage addresses[MaxBatchSize];
+  ControlBuffer controls[MaxBatchSize];
+  memset(headers, 0, sizeof(headers));
+  for (uint32_t i = 0; i < MaxBatchSize; i++) {
+    iovecs[i].iov_base = buffer_.get() + i * max_datagram_size_;
+    iovecs[i].iov_len = max_datagram_size_;
+    msghdr& header = headers[i].msg_hdr;
+    header.msg_iov = &iovecs[i];
+    header.msg_iovlen = 1;
+    if (peer_addresses) {
+      header.msg_name = &addresses[i];
+      header.msg_namelen = sizeof(addresses[i]);
+    }
+    if (gro_) {
+      header.msg_control = controls[i].data_;
+      header.msg_controllen = sizeof(controls[i].data_);
+    }
+  }
+
+  const int rc = ::recvmmsg(fd, headers, MaxBatchSize, 0, nullptr);
+  if (rc < 0) {
+    return {rc, errno};
+  }
+
+  Address::InstanceConstSharedPtr peer_address;
+  const sockaddr_storage* last_address = nullptr;
+  socklen_t last_address_length = 0;
+  for (int i = 0; i < rc; i++) {
+    const msghdr& header = headers[i].msg_hdr;
+    const uint64_t length = headers[i].msg_len;
+    if (length == 0) {
+      continue;
+    }
+
+    // Consecutive datagrams of a batch usually come from the same peer, which is only converted
+    // once.
+    if (peer_addresses &&
+        (last_address == nullptr || header.msg_namelen != last_address_length ||
+         memcmp(&addresses[i], last_address, last_address_length) != 0)) {
+      peer_address = peerAddress(addresses[i], header.msg_namelen);
+      last_address = &addresses[i];
+      last_address_length = header.msg_namelen;
+    }
+
+    uint64_t segment_size = length;
+    if (gro_) {
+      for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+           cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&header), cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+          int gso_size;
+          memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+          if (gso_size > 0) {
+            segment_size = gso_size;
+          }
+        }
+      }
+    }
+
+    const uint8_t* data = static_cast<const uint8_t*>(iovecs[i].iov_base);
+    for (uint64_t offset = 0; offset < length; offset += segment_size) {
+      const uint64_t segment_length = std::min(segment_size, length - offset);
+      cb(peer_address, std::make_unique<Buffer::OwnedImpl>(data + offset, segment_length));
+    }
+  }
+
+  return {rc, 0};
+#else
+  sockaddr_storage address;
+  socklen_t address_length = sizeof(address);
+  memset(&address, 0, address_length);
+
+  const Api::SysCallSizeResult result = Api::OsSysCallsSingleton::get().recvfrom(
+      fd, buffer_.get(), max_datagram_size_, 0, reinterpret_cast<sockaddr*>(&address),
+      &address_length);
+  if (result.rc_ < 0) {
+    return {static_cast<int>(result.rc_), result.errno_};
+  }
+
+  if (result.rc_ > 0) {
+    cb(peer_addresses ? peerAddress(address, address_length) : nullptr,
+       std::make_unique<Buffer::OwnedImpl>(buffer_.get(), result.rc_));
+  }
+  return {1, 0};
+#endif
+}
+
+Api::SysCallIntResult UdpPacketBatch::sendTo(int fd, const Address::Instance& local_address,
+                                             const std::vector<UdpSendData>& datagrams) {
+  uint64_t num_slices = 0;
+  for (const UdpSendData& datagram : datagrams) {
+    num_slices += numSlices(datagram.buffer_);
+  }
+
+  std::vector<sockaddr_storage> addresses(datagrams.size());
+  std::vector<iovec> iovecs;
+  iovecs.reserve(num_slices);
+  std::vector<msghdr> messages(datagrams.size());
+  for (size_t i = 0; i < datagrams.size(); i++) {
+    msghdr& message = messages[i];
+    memset(&message, 0, sizeof(message));
+    message.msg_name = &addresses[i];
+    message.msg_namelen = peerSockAddr(datagrams[i].peer_address_, local_address, addresses[i]);
+    setIovecs(datagrams[i].buffer_, iovecs, message);
+  }
+
+  return sendMessages(fd, messages);
+}
+
+Api::SysCallIntResult UdpPacketBatch::send(int fd,
+                                           const std::vector<Buffer::InstancePtr>& datagrams) {
+  uint64_t num_slices = 0;
+  for (const Buffer::InstancePtr& datagram : datagrams) {
+    num_slices += numSlices(*datagram);
+  }
+
+  std::vector<iovec> iovecs;
+  iovecs.reserve(num_slices);
+  std::vector<msghdr> messages(datagrams.size());
+  for (size_t i = 0; i < datagrams.size(); i++) {
+    memset(&messages[i], 0, sizeof(messages[i]));
+    setIovecs(*datagrams[i], iovecs, messages[i]);
+  }
+
+  return sendMessages(fd, messages);
+}
+
+Api::SysCallIntResult UdpPacketBatch::sendMessages(int fd, std::vector<msghdr>& messages) {
+  int sent = 0;
+#if defined(__linux__)
+  std::vector<mmsghdr> headers(messages.size());
+  for (size_t i = 0; i < messages.size(); i++) {
+    headers[i].msg_hdr = messages[i];
+    headers[i].msg_len = 0;
+  }
+
+  // The kernel sends at most 1024 (UIO_MAXIOV) messages per call, and may send fewer.
+  static constexpr size_t MaxMessagesPerCall = 1024;
+  while (static_cast<size_t>(sent) < headers.size()) {
+    const unsigned int count = std::min(headers.size() - sent, MaxMessagesPerCall);
+    const int rc = ::sendmmsg(fd, &headers[sent], count, 0);
+    if (rc < 0) {
+      return {sent, errno};
+    }
+    sent += rc;
+  }
+#else
+  for (msghdr& message : messages) {
+    if (::sendmsg(fd, &message, 0) < 0) {
+      return {sent, errno};
+    }
+    sent++;
+  }
+#endif
+  return {sent, 0};
+}
+
+bool UdpPacketBatch::groEnabled(int fd) {
+#if defined(__linux__)
+  int value = 0;
+  socklen_t length = sizeof(value);
+  const Api::SysCallIntResult result =
+      Api::OsSysCallsSingleton::get().getsockopt(fd, IPPROTO_UDP, UDP_GRO, &value, &length);
+  return result.rc_ == 0 && value != 0;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  return false;
+#endif
+}
+
+bool UdpPacketBatch::enableGro(int fd) {
+#if defined(__linux__)
+  const int value = 1;
+  return Api::OsSysCallsSingleton::get()
+             .setsockopt(fd, IPPROTO_UDP, UDP_GRO, &value, sizeof(value))
+             .rc_ == 0;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  return false;
+#endif
+}
+
+Address::InstanceConstSharedPtr UdpPacketBatch::peerAddress(const sockaddr_storage& address,
+                                                            socklen_t address_length) {
+  RELEASE_ASSERT(address_length > 0, "unable to get the peer address of a datagram");
+
+  // TODO(conqerAtApple): Current implementation of Address::addressFromSockAddr
+  // cannot be used here unfortunately. This should belong in Address namespace.
+  switch (address.ss_family) {
+  case AF_INET: {
+    const sockaddr_in* sin = reinterpret_cast<const sockaddr_in*>(&address);
+    return std::make_shared<Address::Ipv4Instance>(sin);
+  }
+  case AF_INET6: {
+    const sockaddr_in6* sin6 = reinterpret_cast<const sockaddr_in6*>(&address);
+    if (IN6_IS_ADDR_V4MAPPED(&sin6->sin6_addr)) {
+#if defined(__APPLE__)
+      struct sockaddr_in sin = {
+          {}, AF_INET, sin6->sin6_port, {sin6->sin6_addr.__u6_addr.__u6_addr32[3]}, {}};
+#else
+      struct sockaddr_in sin = {AF_INET, sin6->sin6_port, {sin6->sin6_addr.s6_addr32[3]}, {}};
+#endif
+      return std::make_shared<Address::Ipv4Instance>(&sin);
+    }
+    return std::make_shared<Address::Ipv6Instance>(*sin6, true);
+  }
+  default:
+    RELEASE_ASSERT(false, fmt::format("unsupported address family of a datagram peer: {}, address "
+                                      "length: {}",
+                                      address.ss_family, address_length));
+    return nullptr;
+  }
+}
+
+} // namespace Network
+} // namespace Envoy
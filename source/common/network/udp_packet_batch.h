@@ -0,0 +1,117 @@
+#pragma once
+
+#include <sys/socket.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/buffer/buffer.h"
+#include "envoy/network/address.h"
+#include "envoy/network/listener.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Receives and sends batches of UDP datagrams, with recvmmsg() and sendmmsg() on Linux and with one
+ * system call per datagram elsewhere. A batch is received into memory that is reused by every
+ * batch, and each datagram is then copied into a buffer of its own size, so that small datagrams
+ * don't each hold on to a reservation of the maximum datagram size. When UDP GRO is enabled on a
+ * socket, the kernel may coalesce consecutive datagrams of a flow into one message, which is split
+ * back into the original datagrams.
+ */
+class UdpPacketBatch : NonCopyable {
+public:
+  /**
+   * @param gro supplies whether UDP GRO is enabled on the sockets the batch receives from, in which
+   *        case a message may hold up to MaxGroDatagramSize bytes of coalesced datagrams.
+   */
+  explicit UdpPacketBatch(bool gro);
+
+  /**
+   * Called for each received datagram.
+   * @param peer_address supplies the sender of the datagram, or nullptr if the peer addresses were
+   *        not requested.
+   * @param buffer supplies the contents of the datagram.
+   */
+  typedef std::function<void(const Address::InstanceConstSharedPtr& peer_address,
+                             Buffer::InstancePtr&& buffer)>
+      ReceiveCb;
+
+  /**
+   * Receive up to MaxBatchSize messages from a socket with a single system call. Empty datagrams
+   * are not passed to the callback.
+   * @param fd supplies the non-blocking socket to receive from.
+   * @param peer_addresses supplies whether the senders of the datagrams are passed to the callback.
+   *        A connected socket only receives from its peer, so its owner may skip the conversions.
+   * @param cb supplies the callback invoked for each received datagram.
+   * @return Api::SysCallIntResult the number of messages read from the socket, or the error of the
+   *         system call. Fewer than MaxBatchSize messages means that the socket was drained.
+   */
+  Api::SysCallIntResult receive(int fd, bool peer_addresses, const ReceiveCb& cb);
+
+  /**
+   * Send datagrams to their peers from an unconnected socket, in order.
+   * @param fd supplies the non-blocking socket.
+   * @param local_address supplies the address the socket is bound to. IPv4 peers of an IPv6 socket
+   *        are sent to at their IPv4-mapped address.
+   * @param datagrams supplies the datagrams.
+   * @return Api::SysCallIntResult the number of datagrams sent, along with the error that stopped
+   *         the sending of the others if not all of them were sent.
+   */
+  static Api::SysCallIntResult sendTo(int fd, const Address::Instance& local_address,
+                                      const std::vector<UdpSendData>& datagrams);
+
+  /**
+   * Send datagrams to the peer of a connected socket, in order.
+   * @param fd supplies the non-blocking connected socket.
+   * @param datagrams supplies the datagrams.
+   * @return Api::SysCallIntResult the number of datagrams sent, along with the error that stopped
+   *         the sending of the others if not all of them were sent.
+   */
+  static Api::SysCallIntResult send(int fd, const std::vector<Buffer::InstancePtr>& datagrams);
+
+  /**
+   * @return bool whether UDP GRO is enabled on a socket, e.g. through the socket options of a
+   *         listener.
+   */
+  static bool groEnabled(int fd);
+
+  /**
+   * Enable UDP GRO on a socket.
+   * @return bool whether the platform supports UDP GRO and it was enabled.
+   */
+  static bool enableGro(int fd);
+
+  /**
+   * Convert the peer address returned by a receive system call. IPv4-mapped IPv6 addresses are
+   * converted to IPv4 addresses.
+   */
+  static Address::InstanceConstSharedPtr peerAddress(const sockaddr_storage& address,
+                                                     socklen_t address_length);
+
+#if defined(__linux__)
+  static constexpr uint32_t MaxBatchSize = 16;
+#else
+  static constexpr uint32_t MaxBatchSize = 1;
+#endif
+  // The maximum size of a received datagram without GRO. Larger datagrams are truncated.
+  static constexpr uint64_t MaxDatagramSize = 16384;
+  // The maximum size of the datagrams coalesced into a message with GRO.
+  static constexpr uint64_t MaxGroDatagramSize = 65535;
+
+private:
+  static Api::SysCallIntResult sendMessages(int fd, std::vector<msghdr>& messages);
+
+  const bool gro_;
+  const uint64_t max_datagram_size_;
+  std::unique_ptr<uint8_t[]> buffer_;
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,246 @@
+#include "common/profiler/cpu_sampler.h"
+
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+#include "common/profiler/profiler.h"
+
+namespace Envoy {
+namespace Profiler {
+
+namespace {
+
+// A sample is written by the signal handler of the thread that owns it while another thread may
+// be reading it, so its sequence number is odd while it is written and advances by two per write.
+// A sequence number of 0 means the sample was never written.
+struct Sample {
+  std::atomic<uint64_t> sequence_{0};
+  std::atomic<uint32_t> depth_{0};
+  std::array<std::atomic<uintptr_t>, CpuSampler::MaxStackDepth> pcs_;
+};
+
+struct SampleRing {
+  std::array<Sample, CpuSampler::SamplesPerThread> samples_;
+  // Only accessed by the signal handler of the thread that owns the ring.
+  uint64_t next_{};
+};
+
+struct ThreadState {
+  // Allocated the first time sampling starts while the thread is registered, and kept until the
+  // thread unregisters, since its signal handler may be writing to it at any time.
+  std::unique_ptr<SampleRing> ring_;
+  // The ring the signal handler records into, once allocated.
+  std::atomic<SampleRing*> active_ring_{nullptr};
+};
+
+struct Registry {
+  Thread::MutexBasicLockable mutex_;
+  std::list<ThreadState*> threads_ GUARDED_BY(mutex_);
+  uint32_t frequency_hz_ GUARDED_BY(mutex_){};
+};
+
+Registry& registry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+// The state of the calling thread, if it is registered.
+thread_local ThreadState* thread_state = nullptr;
+
+std::atomic<bool> sampler_running{false};
+std::atomic<uint64_t> sampler_samples{0};
+
+// The frames of the signal handler and of the signal trampoline, which are not part of the
+// interrupted stack.
+constexpr int SignalFrames = 2;
+
+void allocateRing(ThreadState& state) {
+  if (state.ring_ == nullptr) {
+    state.ring_ = std::make_unique<SampleRing>();
+    state.active_ring_.store(state.ring_.get(), std::memory_order_release);
+  }
+}
+
+void onProfilingSignal(int) {
+  const int saved_errno = errno;
+  ThreadState* state = thread_state;
+  SampleRing* ring =
+      state != nullptr ? state->active_ring_.load(std::memory_order_acquire) : nullptr;
+  if (ring != nullptr) {
+    void* pcs[CpuSampler::MaxStackDepth + SignalFrames];
+    const int depth = std::max(backtrace(pcs, CpuSampler::MaxStackDepth + SignalFrames) -
+                                   SignalFrames,
+                               0);
+    Sample& sample = ring->samples_[ring->next_++ % CpuSampler::SamplesPerThread];
+    const uint64_t sequence = sample.sequence_.load(std::memory_order_relaxed);
+    sample.sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    sample.depth_.store(depth, std::memory_order_relaxed);
+    for (int i = 0; i < depth; i++) {
+      sample.pcs_[i].store(reinterpret_cast<uintptr_t>(pcs[i + SignalFrames]),
+                           std::memory_order_relaxed);
+    }
+    sample.sequence_.store(sequence + 2, std::memory_order_release);
+    sampler_samples.fetch_add(1, std::memory_order_relaxed);
+  }
+  errno = saved_errno;
+}
+
+// Copies a sample, or returns false if it was never written or is being written.
+bool readSample(const Sample& sample, std::vector<uintptr_t>& pcs) {
+  const uint64_t sequence = sample.sequence_.load(std::memory_order_acquire);
+  if (sequence == 0 || sequence % 2 != 0) {
+    return false;
+  }
+  const uint32_t depth = std::min(sample.depth_.load(std::memory_order_relaxed),
+                                  CpuSampler::MaxStackDepth);
+  pcs.resize(depth);
+  for (uint32_t i = 0; i < depth; i++) {
+    pcs[i] = sample.pcs_[i].load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return depth > 0 && sample.sequence_.load(std::memory_order_relaxed) == sequence;
+}
+
+} // namespace
+
+constexpr uint32_t CpuSampler::SamplesPerThread;
+constexpr uint32_t CpuSampler::MaxStackDepth;
+constexpr uint32_t CpuSampler::DefaultFrequencyHz;
+constexpr uint32_t CpuSampler::MaxFrequencyHz;
+
+CpuSampler::ScopedThread::ScopedThread() {
+  ASSERT(thread_state == nullptr);
+  ThreadState* state = new ThreadState();
+  Registry& threads = registry();
+  Thread::LockGuard lock(threads.mutex_);
+  if (sampler_running) {
+    allocateRing(*state);
+  }
+  threads.threads_.push_back(state);
+  thread_state = state;
+}
+
+CpuSampler::ScopedThread::~ScopedThread() {
+  ThreadState* state = thread_state;
+  thread_state = nullptr;
+  // Keep the compiler from deferring the store past the removal, since the signal handler of this
+  // thread may run at any point.
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+  Registry& threads = registry();
+  Thread::LockGuard lock(threads.mutex_);
+  threads.threads_.remove(state);
+  delete state;
+}
+
+bool CpuSampler::start(uint32_t frequency_hz) {
+  if (frequency_hz == 0 || frequency_hz > MaxFrequencyHz || Cpu::profilerEnabled()) {
+    return false;
+  }
+
+  Registry& threads = registry();
+  Thread::LockGuard lock(threads.mutex_);
+  // The first call of backtrace() may allocate while it loads the unwinder, which must not happen
+  // in the signal handler.
+  void* pc;
+  backtrace(&pc, 1);
+  for (ThreadState* state : threads.threads_) {
+    allocateRing(*state);
+  }
+
+  // The handler stays installed once sampling stops, since the default action of SIGPROF is to
+  // terminate the process and a signal may still be pending.
+  struct sigaction action = {};
+  action.sa_handler = onProfilingSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, nullptr) != 0) {
+    return false;
+  }
+
+  struct itimerval timer = {};
+  const uint32_t period_us = 1000000 / frequency_hz;
+  timer.it_interval.tv_sec = period_us / 1000000;
+  timer.it_interval.tv_usec = period_us % 1000000;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    return false;
+  }
+  threads.frequency_hz_ = frequency_hz;
+  sampler_running = true;
+  return true;
+}
+
+void CpuSampler::stop() {
+  Registry& threads = registry();
+  Thread::LockGuard lock(threads.mutex_);
+  if (!sampler_running) {
+    return;
+  }
+  struct itimerval timer = {};
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  sampler_running = false;
+}
+
+bool CpuSampler::running() { return sampler_running; }
+
+uint64_t CpuSampler::samples() { return sampler_samples; }
+
+std::string CpuSampler::profile() {
+  // Identical stacks are aggregated into a single record.
+  std::map<std::vector<uintptr_t>, uint64_t> stacks;
+  uint64_t period_us;
+  {
+    Registry& threads = registry();
+    Thread::LockGuard lock(threads.mutex_);
+    std::vector<uintptr_t> pcs;
+    for (const ThreadState* state : threads.threads_) {
+      if (state->ring_ == nullptr) {
+        continue;
+      }
+      for (const Sample& sample : state->ring_->samples_) {
+        if (readSample(sample, pcs)) {
+          stacks[pcs]++;
+        }
+      }
+    }
+    period_us =
+        1000000 / (threads.frequency_hz_ != 0 ? threads.frequency_hz_ : DefaultFrequencyHz);
+  }
+
+  // The header holds the header size in words, the format version, the sampling period and the
+  // flags, and the trailer is a record of a single sample with one frame of 0.
+  std::vector<uintptr_t> words{0, 3, 0, period_us, 0};
+  for (const auto& stack : stacks) {
+    words.push_back(stack.second);
+    words.push_back(stack.first.size());
+    words.insert(words.end(), stack.first.begin(), stack.first.end());
+  }
+  words.insert(words.end(), {0, 1, 0});
+
+  std::string profile(reinterpret_cast<const char*>(words.data()),
+                      words.size() * sizeof(uintptr_t));
+  // pprof maps the addresses to the loaded binaries with the memory map that follows the trailer.
+  std::ifstream maps("/proc/self/maps");
+  profile.append(std::istreambuf_iterator<char>(maps), std::istreambuf_iterator<char>());
+  return profile;
+}
+
+} // namespace Profiler
+} // namespace Envoy
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Profiler {
+
+/**
+ * Always-on, low overhead CPU profiling. While started, the process receives SIGPROF at the
+ * configured frequency of consumed CPU time, and the thread that receives the signal records its
+ * stack into a ring buffer of its recent samples. Only the threads that registered with a
+ * ScopedThread record, e.g. the main thread and the workers. The samples of all registered threads
+ * can be downloaded at any time as a profile for pprof.
+ *
+ * The sampler cannot run at the same time as the gperftools profiler of Profiler::Cpu, since both
+ * rely on SIGPROF.
+ */
+class CpuSampler {
+public:
+  // The number of recent samples kept per registered thread.
+  static constexpr uint32_t SamplesPerThread = 2048;
+  // Deeper stacks are truncated to their innermost frames.
+  static constexpr uint32_t MaxStackDepth = 32;
+  static constexpr uint32_t DefaultFrequencyHz = 100;
+  static constexpr uint32_t MaxFrequencyHz = 1000;
+
+  /**
+   * Registers the calling thread for sampling for the lifetime of the object.
+   */
+  class ScopedThread : NonCopyable {
+  public:
+    ScopedThread();
+    ~ScopedThread();
+  };
+
+  /**
+   * Start sampling, or change the frequency if already started.
+   * @param frequency_hz supplies the number of samples per second of CPU time, at most
+   *        MaxFrequencyHz.
+   * @return bool whether sampling started.
+   */
+  static bool start(uint32_t frequency_hz);
+
+  /**
+   * Stop sampling. The recorded samples are kept until they are overwritten after a restart.
+   */
+  static void stop();
+
+  /**
+   * @return bool whether sampling is started.
+   */
+  static bool running();
+
+  /**
+   * @return uint64_t the number of samples recorded since the process started, including the ones
+   *         that have since been overwritten.
+   */
+  static uint64_t samples();
+
+  /**
+   * Render the samples currently held by all registered threads in the legacy binary CPU profile
+   * format of gperftools, followed by the memory map of the process, as understood by pprof.
+   * @return std::string the profile.
+   */
+  static std::string profile();
+};
+
+} // namespace Profiler
+} // namespace Envoy
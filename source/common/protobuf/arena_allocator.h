@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <string>
+
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+
+/**
+ * Allocator for standard containers that allocates from a protobuf arena, so that containers owned
+ * by the same object as the arena, e.g. a stream, are freed with it at once. Memory is only given
+ * back to the arena when it is destroyed, so this suits containers that seldom shrink. With a null
+ * arena, the allocator uses the heap.
+ */
+template <class T> class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(Protobuf::Arena* arena) : arena_(arena) {}
+  template <class U> ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    if (arena_ == nullptr) {
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    // Arena allocations are aligned to 8 bytes, which is enough for the nodes of the containers.
+    static_assert(alignof(T) <= 8, "type is over-aligned for a protobuf arena");
+    return reinterpret_cast<T*>(Protobuf::Arena::CreateArray<char>(arena_, n * sizeof(T)));
+  }
+
+  void deallocate(T* block, size_t) {
+    if (arena_ == nullptr) {
+      ::operator delete(block);
+    }
+  }
+
+  Protobuf::Arena* arena() const { return arena_; }
+
+  template <class U> bool operator==(const ArenaAllocator<U>& other) const {
+    return arena_ == other.arena();
+  }
+  template <class U> bool operator!=(const ArenaAllocator<U>& other) const {
+    return arena_ != other.arena();
+  }
+
+private:
+  Protobuf::Arena* arena_;
+};
+
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> ArenaString;
+
+} // namespace Envoy
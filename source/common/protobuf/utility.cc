@@ -76,6 +76,37 @@ MissingFieldException::MissingFieldException(const std::string& field_name,
     : EnvoyException(
           fmt::format("Field '{}' is missing in: {}", field_name, message.DebugString())) {}
 
+HashingOutputStream::HashingOutputStream() : state_(XXH64_createState()) {
+  XXH64_reset(state_, 0);
+}
+
+HashingOutputStream::~HashingOutputStream() { XXH64_freeState(state_); }
+
+bool HashingOutputStream::Next(void** data, int* size) {
+  flush();
+  *data = buffer_;
+  *size = sizeof(buffer_);
+  buffered_ = sizeof(buffer_);
+  byte_count_ += sizeof(buffer_);
+  return true;
+}
+
+void HashingOutputStream::BackUp(int count) {
+  ASSERT(count >= 0 && count <= buffered_);
+  buffered_ -= count;
+  byte_count_ -= count;
+}
+
+uint64_t HashingOutputStream::hash() {
+  flush();
+  return XXH64_digest(state_);
+}
+
+void HashingOutputStream::flush() {
+  XXH64_update(state_, buffer_, buffered_);
+  buffered_ = 0;
+}
+
 ProtoValidationException::ProtoValidationException(const std::string& validation_error,
                                                    const Protobuf::Message& message)
     : EnvoyException(fmt::format("Proto constraint validation failed ({}): {}", validation_error,
@@ -102,6 +102,36 @@ public:
   MissingFieldException(const std::string& field_name, const Protobuf::Message& message);
 };
 
+/**
+ * ZeroCopyOutputStream that feeds the bytes written to it into xxHash64 instead of storing them,
+ * so that messages can be hashed while they are serialized. The result is the same as
+ * HashUtil::xxHash64() of the written bytes.
+ */
+class HashingOutputStream : public Protobuf::io::ZeroCopyOutputStream {
+public:
+  HashingOutputStream();
+  ~HashingOutputStream();
+
+  // Protobuf::io::ZeroCopyOutputStream
+  bool Next(void** data, int* size) override;
+  void BackUp(int count) override;
+  Protobuf::int64 ByteCount() const override { return byte_count_; }
+
+  /**
+   * @return uint64_t the hash of the bytes written so far. Any CodedOutputStream writing to this
+   *         stream must have been destroyed first, so that it has returned its unused buffer.
+   */
+  uint64_t hash();
+
+private:
+  void flush();
+
+  XXH64_state_t* const state_;
+  char buffer_[1024];
+  int buffered_{};
+  Protobuf::int64 byte_count_{};
+};
+
 class RepeatedPtrUtil {
 public:
   static std::string join(const Protobuf::RepeatedPtrField<ProtobufTypes::String>& source,
@@ -126,18 +156,17 @@ public:
   static std::size_t hash(const Protobuf::RepeatedPtrField<ProtoType>& source) {
     // Use Protobuf::io::CodedOutputStream to force deterministic serialization, so that the same
     // message doesn't hash to different values.
-    ProtobufTypes::String text;
+    HashingOutputStream hashing_stream;
     {
-      // For memory safety, the StringOutputStream needs to be destroyed before
-      // we read the string.
-      Protobuf::io::StringOutputStream string_stream(&text);
-      Protobuf::io::CodedOutputStream coded_stream(&string_stream);
+      // The CodedOutputStream needs to be destroyed before we read the hash, so that it returns
+      // the part of the buffer it didn't write to.
+      Protobuf::io::CodedOutputStream coded_stream(&hashing_stream);
       coded_stream.SetSerializationDeterministic(true);
       for (const auto& message : source) {
         message.SerializeToCodedStream(&coded_stream);
       }
     }
-    return HashUtil::xxHash64(text);
+    return hashing_stream.hash();
   }
 };
 
@@ -172,16 +201,16 @@ public:
   static std::size_t hash(const Protobuf::Message& message) {
     // Use Protobuf::io::CodedOutputStream to force deterministic serialization, so that the same
     // message doesn't hash to different values.
-    ProtobufTypes::String text;
+    // The message is hashed as it is serialized, without building the serialized string.
+    HashingOutputStream hashing_stream;
     {
-      // For memory safety, the StringOutputStream needs to be destroyed before
-      // we read the string.
-      Protobuf::io::StringOutputStream string_stream(&text);
-      Protobuf::io::CodedOutputStream coded_stream(&string_stream);
+      // The CodedOutputStream needs to be destroyed before we read the hash, so that it returns
+      // the part of the buffer it didn't write to.
+      Protobuf::io::CodedOutputStream coded_stream(&hashing_stream);
       coded_stream.SetSerializationDeterministic(true);
       message.SerializeToCodedStream(&coded_stream);
     }
-    return HashUtil::xxHash64(text);
+    return hashing_stream.hash();
   }
 
   static ProtoUnknownFieldsMode proto_unknown_fields;
@@ -263,12 +292,22 @@ public:
   template <class MessageType>
   static inline MessageType anyConvert(const ProtobufWkt::Any& message) {
     MessageType typed_message;
+    unpackTo(message, typed_message);
+    return typed_message;
+  };
+
+  /**
+   * Convert from google.protobuf.Any to a typed message in place, which avoids the copy of
+   * anyConvert() when the typed message already exists, e.g. as an element of a repeated field.
+   * @param message source google.protobuf.Any message.
+   * @param typed_message destination of the typed message inside the Any.
+   */
+  static void unpackTo(const ProtobufWkt::Any& message, Protobuf::Message& typed_message) {
     if (!message.UnpackTo(&typed_message)) {
       throw EnvoyException("Unable to unpack " + message.DebugString());
     }
     checkUnknownFields(typed_message);
-    return typed_message;
-  };
+  }
 
   /**
    * Convert between two protobufs via a JSON round-trip. This is used to translate arbitrary
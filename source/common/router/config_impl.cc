@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <limits>
 #include <map>
 #include <memory>
 #include <regex>
@@ -20,6 +21,7 @@
 #include "common/common/fmt.h"
 #include "common/common/hash.h"
 #include "common/common/logger.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/config/metadata.h"
 #include "common/config/rds_json.h"
@@ -57,13 +59,24 @@ std::string SslRedirector::newPath(const Http::HeaderMap& headers) const {
   return Http::Utility::createSslRedirectPath(headers);
 }
 
+constexpr uint64_t HedgePolicyImpl::DefaultLatencyHedgeMinDelayMs;
+constexpr double HedgePolicyImpl::DefaultLatencyHedgeBudgetPercent;
+
 HedgePolicyImpl::HedgePolicyImpl(const envoy::api::v2::route::HedgePolicy& hedge_policy)
     : initial_requests_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(hedge_policy, initial_requests, 1)),
       additional_request_chance_(hedge_policy.additional_request_chance()),
-      hedge_on_per_try_timeout_(hedge_policy.hedge_on_per_try_timeout()) {}
+      hedge_on_per_try_timeout_(hedge_policy.hedge_on_per_try_timeout()),
+      hedge_on_latency_(hedge_policy.has_latency_hedging()),
+      latency_hedge_min_delay_(PROTOBUF_GET_MS_OR_DEFAULT(hedge_policy.latency_hedging(), min_delay,
+                                                          DefaultLatencyHedgeMinDelayMs)),
+      latency_hedge_budget_percent_(hedge_policy.latency_hedging().has_budget()
+                                        ? hedge_policy.latency_hedging().budget().value()
+                                        : DefaultLatencyHedgeBudgetPercent) {}
 
 HedgePolicyImpl::HedgePolicyImpl()
-    : initial_requests_(1), additional_request_chance_({}), hedge_on_per_try_timeout_(false) {}
+    : initial_requests_(1), additional_request_chance_({}), hedge_on_per_try_timeout_(false),
+      hedge_on_latency_(false), latency_hedge_min_delay_(DefaultLatencyHedgeMinDelayMs),
+      latency_hedge_budget_percent_(DefaultLatencyHedgeBudgetPercent) {}
 
 RetryPolicyImpl::RetryPolicyImpl(const envoy::api::v2::route::RetryPolicy& retry_policy) {
   per_try_timeout_ =
@@ -126,9 +139,18 @@ CorsPolicyImpl::CorsPolicyImpl(const envoy::api::v2::route::CorsPolicy& config,
     : config_(config), loader_(loader) {
   for (const auto& origin : config.allow_origin()) {
     allow_origin_.push_back(origin);
+    allow_origin_set_.insert(origin);
+    allow_any_origin_ |= origin == "*";
   }
   for (const auto& regex : config.allow_origin_regex()) {
-    allow_origin_regex_.push_back(RegexUtil::parseRegex(regex));
+    allow_origin_regex_.push_back(Regex::Utility::parseStdRegexAsCompiledMatcher(regex));
+  }
+  allow_origin_std_regex_count_ = allow_origin_regex_.size();
+  for (const auto& regex : config.allow_origin_safe_regex()) {
+    allow_origin_regex_.push_back(Regex::Utility::parseRegex(regex));
+  }
+  if (!config.allow_origin_safe_regex().empty()) {
+    allow_origin_safe_regex_set_ = Regex::Utility::parseRegexSet(config.allow_origin_safe_regex());
   }
   allow_methods_ = config.allow_methods();
   allow_headers_ = config.allow_headers();
@@ -140,12 +162,26 @@ CorsPolicyImpl::CorsPolicyImpl(const envoy::api::v2::route::CorsPolicy& config,
   legacy_enabled_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enabled, true);
 }
 
+bool CorsPolicyImpl::allowsOrigin(absl::string_view origin) const {
+  return allow_any_origin_ || allow_origin_set_.contains(origin);
+}
+
+bool CorsPolicyImpl::allowsOriginRegex(absl::string_view origin) const {
+  for (size_t i = 0; i < allow_origin_std_regex_count_; i++) {
+    if (allow_origin_regex_[i]->match(origin)) {
+      return true;
+    }
+  }
+  return allow_origin_safe_regex_set_ != nullptr && allow_origin_safe_regex_set_->match(origin);
+}
+
 ShadowPolicyImpl::ShadowPolicyImpl(const envoy::api::v2::route::RouteAction& config) {
   if (!config.has_request_mirror_policy()) {
     return;
   }
 
   cluster_ = config.request_mirror_policy().cluster();
+  streaming_ = config.request_mirror_policy().streaming();
 
   if (config.request_mirror_policy().has_runtime_fraction()) {
     runtime_key_ = config.request_mirror_policy().runtime_fraction().runtime_key();
@@ -328,18 +364,26 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
       strip_query_(route.redirect().strip_query()),
       hedge_policy_(buildHedgePolicy(vhost.hedgePolicy(), route.route())),
       retry_policy_(buildRetryPolicy(vhost.retryPolicy(), route.route())),
+      retry_shadow_buffer_limit_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          route, per_request_buffer_limit_bytes, std::numeric_limits<uint32_t>::max())),
       rate_limit_policy_(route.route().rate_limits()), shadow_policy_(route.route()),
       priority_(ConfigUtility::parsePriority(route.route().priority())),
       total_cluster_weight_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.route().weighted_clusters(), total_weight, 100UL)),
-      route_action_request_headers_parser_(
-          HeaderParser::configure(route.route().request_headers_to_add())),
-      route_action_response_headers_parser_(HeaderParser::configure(
-          route.route().response_headers_to_add(), route.route().response_headers_to_remove())),
-      request_headers_parser_(HeaderParser::configure(route.request_headers_to_add(),
-                                                      route.request_headers_to_remove())),
-      response_headers_parser_(HeaderParser::configure(route.response_headers_to_add(),
-                                                       route.response_headers_to_remove())),
+      request_headers_parser_(HeaderParser::merge(
+          {HeaderParser::configure(route.route().request_headers_to_add()).get(),
+           HeaderParser::configure(route.request_headers_to_add(),
+                                   route.request_headers_to_remove())
+               .get(),
+           &vhost.requestHeaderParser(), &vhost.globalRouteConfig().requestHeaderParser()})),
+      response_headers_parser_(HeaderParser::merge(
+          {HeaderParser::configure(route.route().response_headers_to_add(),
+                                   route.route().response_headers_to_remove())
+               .get(),
+           HeaderParser::configure(route.response_headers_to_add(),
+                                   route.response_headers_to_remove())
+               .get(),
+           &vhost.responseHeaderParser(), &vhost.globalRouteConfig().responseHeaderParser()})),
       metadata_(route.metadata()), typed_metadata_(route.metadata()),
       match_grpc_(route.match().has_grpc()), opaque_config_(parseOpaqueConfig(route)),
       decorator_(parseDecorator(route)),
@@ -415,11 +459,23 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
       throw EnvoyException(fmt::format("Duplicate upgrade {}", upgrade_config.upgrade_type()));
     }
   }
+
+  // The path (including the query string), authority and method are the keys of a route cache
+  // lookup. Anything else that influences matching makes the lookup result uncacheable. Weighted
+  // and header selected clusters are handled by clusterEntry() returning a DynamicRouteEntry.
+  cacheable_ = vhost.routesCacheable() && runtime_ == absl::nullopt && !match_grpc_;
+  for (const auto& header_data : config_headers_) {
+    if (header_data.name_ != Http::Headers::get().Host &&
+        header_data.name_ != Http::Headers::get().Path &&
+        header_data.name_ != Http::Headers::get().Method) {
+      cacheable_ = false;
+    }
+  }
 }
 
 bool RouteEntryImplBase::evaluateRuntimeMatch(const uint64_t random_value) const {
   return !runtime_ ? true
-                   : loader_.snapshot().featureEnabled(runtime_->fractional_runtime_key_,
+                   : loader_.snapshot().featureEnabled(runtime_->fractional_runtime_handle_,
                                                        runtime_->fractional_runtime_default_,
                                                        random_value);
 }
@@ -454,11 +510,8 @@ void RouteEntryImplBase::finalizeRequestHeaders(Http::HeaderMap& headers,
                                                 bool insert_envoy_original_path) const {
   // Append user-specified request headers in the following order: route-action-level headers,
   // route-level headers, virtual host level headers and finally global connection manager level
-  // headers.
-  route_action_request_headers_parser_->evaluateHeaders(headers, stream_info);
+  // headers. The levels are merged into a single parser when the route is configured.
   request_headers_parser_->evaluateHeaders(headers, stream_info);
-  vhost_.requestHeaderParser().evaluateHeaders(headers, stream_info);
-  vhost_.globalRouteConfig().requestHeaderParser().evaluateHeaders(headers, stream_info);
   if (!host_rewrite_.empty()) {
     headers.Host()->value(host_rewrite_);
   }
@@ -473,22 +526,18 @@ void RouteEntryImplBase::finalizeResponseHeaders(Http::HeaderMap& headers,
                                                  const StreamInfo::StreamInfo& stream_info) const {
   // Append user-specified response headers in the following order: route-action-level headers,
   // route-level headers, virtual host level headers and finally global connection manager level
-  // headers.
-  route_action_response_headers_parser_->evaluateHeaders(headers, stream_info);
+  // headers. The levels are merged into a single parser when the route is configured.
   response_headers_parser_->evaluateHeaders(headers, stream_info);
-  vhost_.responseHeaderParser().evaluateHeaders(headers, stream_info);
-  vhost_.globalRouteConfig().responseHeaderParser().evaluateHeaders(headers, stream_info);
 }
 
 absl::optional<RouteEntryImplBase::RuntimeData>
 RouteEntryImplBase::loadRuntimeData(const envoy::api::v2::route::RouteMatch& route_match) {
   absl::optional<RuntimeData> runtime;
-  RuntimeData runtime_data;
 
   if (route_match.has_runtime_fraction()) {
-    runtime_data.fractional_runtime_default_ = route_match.runtime_fraction().default_value();
-    runtime_data.fractional_runtime_key_ = route_match.runtime_fraction().runtime_key();
-    return runtime_data;
+    runtime.emplace(RuntimeData{
+        Runtime::FeatureHandleImpl(route_match.runtime_fraction().runtime_key()),
+        route_match.runtime_fraction().default_value()});
   }
 
   return runtime;
@@ -827,7 +876,13 @@ RegexRouteEntryImpl::RegexRouteEntryImpl(const VirtualHostImpl& vhost,
                                          const envoy::api::v2::route::Route& route,
                                          Server::Configuration::FactoryContext& factory_context)
     : RouteEntryImplBase(vhost, route, factory_context),
-      regex_(RegexUtil::parseRegex(route.match().regex())), regex_str_(route.match().regex()) {}
+      regex_(route.match().path_specifier_case() == envoy::api::v2::route::RouteMatch::kSafeRegex
+                 ? Regex::Utility::parseRegex(route.match().safe_regex())
+                 : Regex::Utility::parseStdRegexAsCompiledMatcher(route.match().regex())),
+      regex_str_(route.match().path_specifier_case() ==
+                         envoy::api::v2::route::RouteMatch::kSafeRegex
+                     ? route.match().safe_regex().regex()
+                     : route.match().regex()) {}
 
 void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
                                             bool insert_envoy_original_path) const {
@@ -835,7 +890,7 @@ void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
   const char* query_string_start = Http::Utility::findQueryStringStart(path);
   // TODO(yuval-k): This ASSERT can happen if the path was changed by a filter without clearing the
   // route cache. We should consider if ASSERT-ing is the desired behavior in this case.
-  ASSERT(std::regex_match(path.c_str(), query_string_start, regex_));
+  ASSERT(regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str())));
   std::string matched_path(path.c_str(), query_string_start);
 
   finalizePathHeader(headers, matched_path, insert_envoy_original_path);
@@ -846,7 +901,7 @@ RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
   if (RouteEntryImplBase::matchRoute(headers, random_value)) {
     const Http::HeaderString& path = headers.Path()->value();
     const char* query_string_start = Http::Utility::findQueryStringStart(path);
-    if (std::regex_match(path.c_str(), query_string_start, regex_)) {
+    if (regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str()))) {
       return clusterEntry(headers, random_value);
     }
   }
@@ -854,7 +909,7 @@ RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
 }
 
 VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtual_host,
-                                 const ConfigImpl& global_route_config,
+                                 const CommonConfigImplConstSharedPtr& global_route_config,
                                  Server::Configuration::FactoryContext& factory_context,
                                  bool validate_clusters)
     : name_(virtual_host.name()), rate_limit_policy_(virtual_host.rate_limits()),
@@ -880,6 +935,9 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtu
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
 
+  // The SSL redirect depends on headers other than the route cache keys.
+  routes_cacheable_ = ssl_requirements_ == SslRequirements::NONE;
+
   // Retry and Hedge policies must be set before routes, since they may use them.
   if (virtual_host.has_retry_policy()) {
     retry_policy_ = virtual_host.retry_policy();
@@ -894,15 +952,34 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtu
     const bool has_path =
         route.match().path_specifier_case() == envoy::api::v2::route::RouteMatch::kPath;
     const bool has_regex =
-        route.match().path_specifier_case() == envoy::api::v2::route::RouteMatch::kRegex;
+        route.match().path_specifier_case() == envoy::api::v2::route::RouteMatch::kRegex ||
+        route.match().path_specifier_case() == envoy::api::v2::route::RouteMatch::kSafeRegex;
+    // Only case sensitive prefix and path routes are indexed. Everything else is evaluated in
+    // order alongside the indexed candidates. Header, query parameter and runtime conditions are
+    // still checked by the route itself, so they do not prevent indexing.
+    const bool case_sensitive =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.match(), case_sensitive, true);
+    const uint32_t position = routes_.size();
     if (has_prefix) {
       routes_.emplace_back(new PrefixRouteEntryImpl(*this, route, factory_context));
+      if (case_sensitive) {
+        route_index_.addPrefix(route.match().prefix(), position);
+      } else {
+        route_index_.addUnindexed(position);
+      }
     } else if (has_path) {
       routes_.emplace_back(new PathRouteEntryImpl(*this, route, factory_context));
+      if (case_sensitive) {
+        route_index_.addExactPath(route.match().path(), position);
+      } else {
+        route_index_.addUnindexed(position);
+      }
     } else {
       ASSERT(has_regex);
       routes_.emplace_back(new RegexRouteEntryImpl(*this, route, factory_context));
+      route_index_.addUnindexed(position);
     }
+    routes_cacheable_ = routes_.back()->cacheable();
 
     if (validate_clusters) {
       routes_.back()->validateClusters(factory_context.clusterManager());
@@ -935,39 +1012,41 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
   name_ = virtual_cluster.name();
 }
 
-const Config& VirtualHostImpl::routeConfig() const { return global_route_config_; }
+const CommonConfig& VirtualHostImpl::routeConfig() const { return *global_route_config_; }
 
 const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::string& name) const {
   return per_filter_configs_.get(name);
 }
 
-const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const std::string& host) const {
-  // We do a longest wildcard suffix match against the host that's passed in.
-  // (e.g. foo-bar.baz.com should match *-bar.baz.com before matching *.baz.com)
-  // This is done by scanning the length => wildcards map looking for every
-  // wildcard whose size is < length.
-  for (const auto& iter : wildcard_virtual_host_suffixes_) {
-    const uint32_t wildcard_length = iter.first;
-    const auto& wildcard_map = iter.second;
-    // >= because *.foo.com shouldn't match .foo.com.
-    if (wildcard_length >= host.size()) {
-      continue;
-    }
-    const auto& match = wildcard_map.find(host.substr(host.size() - wildcard_length));
-    if (match != wildcard_map.end()) {
-      return match->second.get();
-    }
-  }
-  return nullptr;
-}
-
 RouteMatcher::RouteMatcher(const envoy::api::v2::RouteConfiguration& route_config,
-                           const ConfigImpl& global_route_config,
+                           const CommonConfigImplConstSharedPtr& global_route_config,
                            Server::Configuration::FactoryContext& factory_context,
-                           bool validate_clusters) {
+                           bool validate_clusters, const RouteMatcher* previous) {
   for (const auto& virtual_host_config : route_config.virtual_hosts()) {
-    VirtualHostSharedPtr virtual_host(new VirtualHostImpl(virtual_host_config, global_route_config,
-                                                          factory_context, validate_clusters));
+    VirtualHostSharedPtr virtual_host;
+    if (validate_clusters) {
+      // Cluster validation depends on the cluster manager state at load time, so nothing is
+      // reused or indexed for reuse.
+      virtual_host = std::make_shared<VirtualHostImpl>(virtual_host_config, global_route_config,
+                                                       factory_context, validate_clusters);
+      virtual_hosts_built_++;
+    } else {
+      const uint64_t hash = MessageUtil::hash(virtual_host_config);
+      if (previous != nullptr) {
+        const auto it = previous->virtual_hosts_by_hash_.find(hash);
+        if (it != previous->virtual_hosts_by_hash_.end()) {
+          virtual_host = it->second;
+          virtual_hosts_reused_++;
+        }
+      }
+      if (virtual_host == nullptr) {
+        virtual_host = std::make_shared<VirtualHostImpl>(virtual_host_config, global_route_config,
+                                                         factory_context, validate_clusters);
+        virtual_hosts_built_++;
+      }
+      virtual_hosts_by_hash_.emplace(hash, virtual_host);
+    }
+
     for (const std::string& domain_name : virtual_host_config.domains()) {
       const std::string domain = Http::LowerCaseString(domain_name).get();
       if ("*" == domain) {
@@ -976,7 +1055,10 @@ RouteMatcher::RouteMatcher(const envoy::api::v2::RouteConfiguration& route_confi
         }
         default_virtual_host_ = virtual_host;
       } else if (domain.size() > 0 && '*' == domain[0]) {
-        wildcard_virtual_host_suffixes_[domain.size() - 1].emplace(domain.substr(1), virtual_host);
+        wildcard_virtual_host_suffixes_.add(absl::string_view(domain).substr(1), virtual_host);
+      } else if (domain.size() > 0 && '*' == domain[domain.size() - 1]) {
+        wildcard_virtual_host_prefixes_.add(
+            absl::string_view(domain).substr(0, domain.size() - 1), virtual_host);
       } else {
         if (virtual_hosts_.find(domain) != virtual_hosts_.end()) {
           throw EnvoyException(fmt::format(
@@ -999,9 +1081,40 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
-  for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
-    RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+  if (headers.Path() == nullptr) {
+    // Without a path the index cannot help, so evaluate every route in order.
+    for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
+      RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+      if (nullptr != route_entry) {
+        return route_entry;
+      }
+    }
+    return nullptr;
+  }
+
+  // Check for a route that matches the request. The index yields the (ordered) routes whose path
+  // specifier can match; these are merged with the unindexed routes so that the routes are still
+  // evaluated in configuration order and the first match wins.
+  const Http::HeaderString& path = headers.Path()->value();
+  const char* query_string_start = Http::Utility::findQueryStringStart(path);
+  RouteIndex::Candidates candidates;
+  route_index_.findCandidates(path.getStringView(),
+                              absl::string_view(path.c_str(), query_string_start - path.c_str()),
+                              candidates);
+
+  const std::vector<uint32_t>& unindexed = route_index_.unindexed();
+  auto indexed_it = candidates.begin();
+  auto unindexed_it = unindexed.begin();
+  while (indexed_it != candidates.end() || unindexed_it != unindexed.end()) {
+    uint32_t position;
+    if (unindexed_it == unindexed.end() ||
+        (indexed_it != candidates.end() && *indexed_it < *unindexed_it)) {
+      position = *indexed_it++;
+    } else {
+      position = *unindexed_it++;
+    }
+
+    RouteConstSharedPtr route_entry = routes_[position]->matches(headers, random_value);
     if (nullptr != route_entry) {
       return route_entry;
     }
@@ -1012,7 +1125,8 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
 
 const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::HeaderMap& headers) const {
   // Fast path the case where we only have a default virtual host.
-  if (virtual_hosts_.empty() && wildcard_virtual_host_suffixes_.empty() && default_virtual_host_) {
+  if (virtual_hosts_.empty() && wildcard_virtual_host_suffixes_.empty() &&
+      wildcard_virtual_host_prefixes_.empty() && default_virtual_host_) {
     return default_virtual_host_.get();
   }
 
@@ -1023,10 +1137,18 @@ const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::HeaderMap& head
   if (iter != virtual_hosts_.end()) {
     return iter->second.get();
   }
+  // Longest suffix wildcard first (e.g. foo-bar.baz.com matches *-bar.baz.com before *.baz.com),
+  // then longest prefix wildcard.
   if (!wildcard_virtual_host_suffixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(host);
+    const VirtualHostSharedPtr* vhost = wildcard_virtual_host_suffixes_.findLongest(host);
+    if (vhost != nullptr) {
+      return vhost->get();
+    }
+  }
+  if (!wildcard_virtual_host_prefixes_.empty()) {
+    const VirtualHostSharedPtr* vhost = wildcard_virtual_host_prefixes_.findLongest(host);
     if (vhost != nullptr) {
-      return vhost;
+      return vhost->get();
     }
   }
   return default_virtual_host_.get();
@@ -1065,22 +1187,53 @@ VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const
   return nullptr;
 }
 
-ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config,
-                       Server::Configuration::FactoryContext& factory_context,
-                       bool validate_clusters_default)
-    : name_(config.name()) {
-  route_matcher_ = std::make_unique<RouteMatcher>(
-      config, *this, factory_context,
-      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default));
+namespace {
+
+// Hashes every field of the route configuration except the virtual hosts, which are hashed
+// individually when they are considered for reuse.
+uint64_t commonConfigHash(const envoy::api::v2::RouteConfiguration& config) {
+  envoy::api::v2::RouteConfiguration common;
+  common.set_name(config.name());
+  *common.mutable_internal_only_headers() = config.internal_only_headers();
+  *common.mutable_response_headers_to_add() = config.response_headers_to_add();
+  *common.mutable_response_headers_to_remove() = config.response_headers_to_remove();
+  *common.mutable_request_headers_to_add() = config.request_headers_to_add();
+  *common.mutable_request_headers_to_remove() = config.request_headers_to_remove();
+  return MessageUtil::hash(common);
+}
+
+} // namespace
 
+CommonConfigImpl::CommonConfigImpl(const envoy::api::v2::RouteConfiguration& config)
+    : request_headers_parser_(HeaderParser::configure(config.request_headers_to_add(),
+                                                      config.request_headers_to_remove())),
+      response_headers_parser_(HeaderParser::configure(config.response_headers_to_add(),
+                                                       config.response_headers_to_remove())),
+      name_(config.name()), hash_(commonConfigHash(config)) {
   for (const std::string& header : config.internal_only_headers()) {
     internal_only_headers_.push_back(Http::LowerCaseString(header));
   }
+}
+
+ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config,
+                       Server::Configuration::FactoryContext& factory_context,
+                       bool validate_clusters_default, const ConfigImpl* previous) {
+  const bool validate_clusters =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default);
+
+  // Virtual hosts hold on to the common configuration, so they can only be reused if it is
+  // unchanged. In that case the previous common configuration is shared as well.
+  const RouteMatcher* previous_matcher = nullptr;
+  if (previous != nullptr && !validate_clusters &&
+      previous->shared_config_->hash() == commonConfigHash(config)) {
+    shared_config_ = previous->shared_config_;
+    previous_matcher = previous->route_matcher_.get();
+  } else {
+    shared_config_ = std::make_shared<CommonConfigImpl>(config);
+  }
 
-  request_headers_parser_ =
-      HeaderParser::configure(config.request_headers_to_add(), config.request_headers_to_remove());
-  response_headers_parser_ = HeaderParser::configure(config.response_headers_to_add(),
-                                                     config.response_headers_to_remove());
+  route_matcher_ = std::make_unique<RouteMatcher>(config, shared_config_, factory_context,
+                                                  validate_clusters, previous_matcher);
 }
 
 namespace {
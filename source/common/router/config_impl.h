@@ -17,14 +17,19 @@
 #include "envoy/server/filter_config.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/common/regex.h"
 #include "common/config/metadata.h"
 #include "common/http/header_utility.h"
 #include "common/router/config_utility.h"
+#include "common/router/domain_trie.h"
 #include "common/router/header_formatter.h"
 #include "common/router/header_parser.h"
 #include "common/router/metadatamatchcriteria_impl.h"
+#include "common/router/route_index.h"
 #include "common/router/router_ratelimit.h"
+#include "common/runtime/runtime_impl.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
@@ -85,6 +90,8 @@ public:
   const RouteSpecificFilterConfig* perFilterConfig(const std::string&) const override {
     return nullptr;
   }
+  // The redirect depends on x-forwarded-proto and x-envoy-internal.
+  bool cacheable() const override { return false; }
 
 private:
   static const SslRedirector SSL_REDIRECTOR;
@@ -99,7 +106,11 @@ public:
 
   // Router::CorsPolicy
   const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-  const std::list<std::regex>& allowOriginRegexes() const override { return allow_origin_regex_; }
+  const std::vector<Regex::CompiledMatcherPtr>& allowOriginRegexes() const override {
+    return allow_origin_regex_;
+  }
+  bool allowsOrigin(absl::string_view origin) const override;
+  bool allowsOriginRegex(absl::string_view origin) const override;
   const std::string& allowMethods() const override { return allow_methods_; };
   const std::string& allowHeaders() const override { return allow_headers_; };
   const std::string& exposeHeaders() const override { return expose_headers_; };
@@ -126,7 +137,15 @@ private:
   const envoy::api::v2::route::CorsPolicy config_;
   Runtime::Loader& loader_;
   std::list<std::string> allow_origin_;
-  std::list<std::regex> allow_origin_regex_;
+  std::vector<Regex::CompiledMatcherPtr> allow_origin_regex_;
+  // The origins are looked up in a set, and the safe regexes matched with a single combined regex,
+  // so that checking an origin doesn't take a pass per allowed origin.
+  absl::flat_hash_set<std::string> allow_origin_set_;
+  bool allow_any_origin_{};
+  // The legacy ECMAScript regexes, which can't be combined, are the first ones of
+  // allow_origin_regex_.
+  size_t allow_origin_std_regex_count_{};
+  Regex::CompiledMatcherPtr allow_origin_safe_regex_set_;
   std::string allow_methods_;
   std::string allow_headers_;
   std::string expose_headers_;
@@ -135,20 +154,53 @@ private:
   bool legacy_enabled_;
 };
 
-class ConfigImpl;
+/**
+ * Route configuration state that is not specific to a virtual host. Virtual hosts share ownership
+ * of it so that they can outlive the ConfigImpl that built them when they are reused by a later
+ * version of the same route configuration.
+ */
+class CommonConfigImpl : public CommonConfig {
+public:
+  CommonConfigImpl(const envoy::api::v2::RouteConfiguration& config);
+
+  const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
+  const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
+
+  /**
+   * @return uint64_t a hash of every field of the route configuration that this object was built
+   *         from. Two objects with the same hash are interchangeable.
+   */
+  uint64_t hash() const { return hash_; }
+
+  // Router::CommonConfig
+  const std::list<Http::LowerCaseString>& internalOnlyHeaders() const override {
+    return internal_only_headers_;
+  }
+  const std::string& name() const override { return name_; }
+
+private:
+  std::list<Http::LowerCaseString> internal_only_headers_;
+  HeaderParserPtr request_headers_parser_;
+  HeaderParserPtr response_headers_parser_;
+  const std::string name_;
+  const uint64_t hash_;
+};
+
+typedef std::shared_ptr<const CommonConfigImpl> CommonConfigImplConstSharedPtr;
+
 /**
  * Holds all routing configuration for an entire virtual host.
  */
 class VirtualHostImpl : public VirtualHost {
 public:
   VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtual_host,
-                  const ConfigImpl& global_route_config,
+                  const CommonConfigImplConstSharedPtr& global_route_config,
                   Server::Configuration::FactoryContext& factory_context, bool validate_clusters);
 
   RouteConstSharedPtr getRouteFromEntries(const Http::HeaderMap& headers,
                                           uint64_t random_value) const;
   const VirtualCluster* virtualClusterFromEntries(const Http::HeaderMap& headers) const;
-  const ConfigImpl& globalRouteConfig() const { return global_route_config_; }
+  const CommonConfigImpl& globalRouteConfig() const { return *global_route_config_; }
   const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
   const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
 
@@ -156,7 +208,7 @@ public:
   const CorsPolicy* corsPolicy() const override { return cors_policy_.get(); }
   const std::string& name() const override { return name_; }
   const RateLimitPolicy& rateLimitPolicy() const override { return rate_limit_policy_; }
-  const Config& routeConfig() const override;
+  const CommonConfig& routeConfig() const override;
   const RouteSpecificFilterConfig* perFilterConfig(const std::string&) const override;
   bool includeAttemptCount() const override { return include_attempt_count_; }
   const absl::optional<envoy::api::v2::route::RetryPolicy>& retryPolicy() const {
@@ -165,6 +217,11 @@ public:
   const absl::optional<envoy::api::v2::route::HedgePolicy>& hedgePolicy() const {
     return hedge_policy_;
   }
+  /**
+   * @return true if every route added so far is matched solely on the :authority, :path and
+   *         :method headers, so that the outcome of evaluating them is cacheable on those headers.
+   */
+  bool routesCacheable() const { return routes_cacheable_; }
 
 private:
   enum class SslRequirements { NONE, EXTERNAL_ONLY, ALL };
@@ -192,18 +249,20 @@ private:
 
   const std::string name_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  // Narrows the routes that need to be evaluated for a request path. Built once at construction.
+  RouteIndex route_index_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
   std::unique_ptr<const CorsPolicyImpl> cors_policy_;
-  const ConfigImpl& global_route_config_; // See note in RouteEntryImplBase::clusterEntry() on why
-                                          // raw ref to the top level config is currently safe.
+  const CommonConfigImplConstSharedPtr global_route_config_;
   HeaderParserPtr request_headers_parser_;
   HeaderParserPtr response_headers_parser_;
   PerFilterConfigs per_filter_configs_;
   const bool include_attempt_count_;
   absl::optional<envoy::api::v2::route::RetryPolicy> retry_policy_;
   absl::optional<envoy::api::v2::route::HedgePolicy> hedge_policy_;
+  bool routes_cacheable_{};
 };
 
 typedef std::shared_ptr<VirtualHostImpl> VirtualHostSharedPtr;
@@ -254,11 +313,13 @@ public:
   const std::string& cluster() const override { return cluster_; }
   const std::string& runtimeKey() const override { return runtime_key_; }
   const envoy::type::FractionalPercent& defaultValue() const override { return default_value_; }
+  bool streaming() const override { return streaming_; }
 
 private:
   std::string cluster_;
   std::string runtime_key_;
   envoy::type::FractionalPercent default_value_;
+  bool streaming_{};
 };
 
 /**
@@ -307,11 +368,22 @@ public:
     return additional_request_chance_;
   }
   bool hedgeOnPerTryTimeout() const override { return hedge_on_per_try_timeout_; }
+  bool hedgeOnLatency() const override { return hedge_on_latency_; }
+  std::chrono::milliseconds latencyHedgeMinDelay() const override {
+    return latency_hedge_min_delay_;
+  }
+  double latencyHedgeBudgetPercent() const override { return latency_hedge_budget_percent_; }
+
+  static constexpr uint64_t DefaultLatencyHedgeMinDelayMs = 10;
+  static constexpr double DefaultLatencyHedgeBudgetPercent = 10;
 
 private:
   const uint32_t initial_requests_;
   const envoy::type::FractionalPercent additional_request_chance_;
   const bool hedge_on_per_try_timeout_;
+  const bool hedge_on_latency_;
+  const std::chrono::milliseconds latency_hedge_min_delay_;
+  const double latency_hedge_budget_percent_;
 };
 
 /**
@@ -380,6 +452,7 @@ public:
   Upstream::ResourcePriority priority() const override { return priority_; }
   const RateLimitPolicy& rateLimitPolicy() const override { return rate_limit_policy_; }
   const RetryPolicy& retryPolicy() const override { return retry_policy_; }
+  uint32_t retryShadowBufferLimit() const override { return retry_shadow_buffer_limit_; }
   const ShadowPolicy& shadowPolicy() const override { return shadow_policy_; }
   const VirtualCluster* virtualCluster(const Http::HeaderMap& headers) const override {
     return vhost_.virtualClusterFromEntries(headers);
@@ -418,6 +491,7 @@ public:
   const RouteEntry* routeEntry() const override;
   const Decorator* decorator() const override { return decorator_.get(); }
   const RouteSpecificFilterConfig* perFilterConfig(const std::string&) const override;
+  bool cacheable() const override { return cacheable_; }
 
 protected:
   const bool case_sensitive_;
@@ -439,7 +513,7 @@ protected:
 
 private:
   struct RuntimeData {
-    std::string fractional_runtime_key_{};
+    Runtime::FeatureHandleImpl fractional_runtime_handle_;
     envoy::type::FractionalPercent fractional_runtime_default_{};
   };
 
@@ -469,6 +543,7 @@ private:
     Upstream::ResourcePriority priority() const override { return parent_->priority(); }
     const RateLimitPolicy& rateLimitPolicy() const override { return parent_->rateLimitPolicy(); }
     const RetryPolicy& retryPolicy() const override { return parent_->retryPolicy(); }
+    uint32_t retryShadowBufferLimit() const override { return parent_->retryShadowBufferLimit(); }
     const ShadowPolicy& shadowPolicy() const override { return parent_->shadowPolicy(); }
     std::chrono::milliseconds timeout() const override { return parent_->timeout(); }
     absl::optional<std::chrono::milliseconds> idleTimeout() const override {
@@ -516,6 +591,8 @@ private:
     const RouteSpecificFilterConfig* perFilterConfig(const std::string& name) const override {
       return parent_->perFilterConfig(name);
     };
+    // Selected per request from a header or a random weight.
+    bool cacheable() const override { return false; }
 
   private:
     const RouteEntryImplBase* parent_;
@@ -611,6 +688,7 @@ private:
   const bool strip_query_;
   const HedgePolicyImpl hedge_policy_;
   const RetryPolicyImpl retry_policy_;
+  const uint32_t retry_shadow_buffer_limit_;
   const RateLimitPolicyImpl rate_limit_policy_;
   const ShadowPolicyImpl shadow_policy_;
   const Upstream::ResourcePriority priority_;
@@ -622,8 +700,8 @@ private:
   const uint64_t total_cluster_weight_;
   std::unique_ptr<const HashPolicyImpl> hash_policy_;
   MetadataMatchCriteriaConstPtr metadata_match_criteria_;
-  HeaderParserPtr route_action_request_headers_parser_;
-  HeaderParserPtr route_action_response_headers_parser_;
+  // The route action, route, virtual host and connection manager level headers to add and remove,
+  // merged in the order in which they are applied.
   HeaderParserPtr request_headers_parser_;
   HeaderParserPtr response_headers_parser_;
   envoy::api::v2::core::Metadata metadata_;
@@ -639,6 +717,9 @@ private:
   PerFilterConfigs per_filter_configs_;
   TimeSource& time_source_;
   InternalRedirectAction internal_redirect_action_;
+  // Whether this route and every route before it in the virtual host are matched solely on the
+  // :authority, :path and :method headers.
+  bool cacheable_{};
 };
 
 /**
@@ -704,7 +785,7 @@ public:
   void rewritePathHeader(Http::HeaderMap& headers, bool insert_envoy_original_path) const override;
 
 private:
-  const std::regex regex_;
+  const Regex::CompiledMatcherPtr regex_;
   const std::string regex_str_;
 };
 
@@ -714,29 +795,36 @@ private:
  */
 class RouteMatcher {
 public:
+  /**
+   * @param previous supplies an optional matcher built from an earlier version of the route
+   *        configuration with the same common configuration. Virtual hosts whose configuration is
+   *        unchanged are taken from it instead of being rebuilt.
+   */
   RouteMatcher(const envoy::api::v2::RouteConfiguration& config,
-               const ConfigImpl& global_http_config,
-               Server::Configuration::FactoryContext& factory_context, bool validate_clusters);
+               const CommonConfigImplConstSharedPtr& global_route_config,
+               Server::Configuration::FactoryContext& factory_context, bool validate_clusters,
+               const RouteMatcher* previous);
 
   RouteConstSharedPtr route(const Http::HeaderMap& headers, uint64_t random_value) const;
+  uint64_t virtualHostsReused() const { return virtual_hosts_reused_; }
+  uint64_t virtualHostsBuilt() const { return virtual_hosts_built_; }
 
 private:
   const VirtualHostImpl* findVirtualHost(const Http::HeaderMap& headers) const;
-  const VirtualHostImpl* findWildcardVirtualHost(const std::string& host) const;
 
   std::unordered_map<std::string, VirtualHostSharedPtr> virtual_hosts_;
-  // std::greater as a minor optimization to iterate from more to less specific
-  //
-  // A note on using an unordered_map versus a vector of (string, VirtualHostSharedPtr) pairs:
-  //
-  // Based on local benchmarks, each vector entry costs around 20ns for recall and (string)
-  // comparison with a fixed cost of about 25ns. For unordered_map, the empty map costs about 65ns
-  // and climbs to about 110ns once there are any entries.
-  //
-  // The break-even is 4 entries.
-  std::map<int64_t, std::unordered_map<std::string, VirtualHostSharedPtr>, std::greater<int64_t>>
-      wildcard_virtual_host_suffixes_;
+  // Suffix wildcards (*.foo.com) keyed by the reversed suffix and prefix wildcards (foo.*) keyed by
+  // the prefix. Both resolve the longest match in time proportional to the host length.
+  DomainTrie<VirtualHostSharedPtr> wildcard_virtual_host_suffixes_{
+      DomainTrie<VirtualHostSharedPtr>::Direction::Reverse};
+  DomainTrie<VirtualHostSharedPtr> wildcard_virtual_host_prefixes_{
+      DomainTrie<VirtualHostSharedPtr>::Direction::Forward};
   VirtualHostSharedPtr default_virtual_host_;
+  // Virtual hosts keyed by the hash of their configuration. Only populated when virtual hosts may
+  // be reused, i.e. when clusters are not validated.
+  std::unordered_map<uint64_t, VirtualHostSharedPtr> virtual_hosts_by_hash_;
+  uint64_t virtual_hosts_reused_{};
+  uint64_t virtual_hosts_built_{};
 };
 
 /**
@@ -744,12 +832,31 @@ private:
  */
 class ConfigImpl : public Config {
 public:
+  /**
+   * @param previous supplies an optional configuration built from an earlier version of the same
+   *        route configuration by the same factory context. When clusters are not validated and
+   *        only virtual hosts changed, unchanged virtual hosts are shared with it.
+   */
   ConfigImpl(const envoy::api::v2::RouteConfiguration& config,
              Server::Configuration::FactoryContext& factory_context,
-             bool validate_clusters_default);
+             bool validate_clusters_default, const ConfigImpl* previous = nullptr);
 
-  const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
-  const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
+  const HeaderParser& requestHeaderParser() const {
+    return shared_config_->requestHeaderParser();
+  };
+  const HeaderParser& responseHeaderParser() const {
+    return shared_config_->responseHeaderParser();
+  };
+
+  /**
+   * @return uint64_t the number of virtual hosts shared with the previous configuration.
+   */
+  uint64_t virtualHostsReused() const { return route_matcher_->virtualHostsReused(); }
+
+  /**
+   * @return uint64_t the number of virtual hosts built for this configuration.
+   */
+  uint64_t virtualHostsBuilt() const { return route_matcher_->virtualHostsBuilt(); }
 
   // Router::Config
   RouteConstSharedPtr route(const Http::HeaderMap& headers, uint64_t random_value) const override {
@@ -757,17 +864,14 @@ public:
   }
 
   const std::list<Http::LowerCaseString>& internalOnlyHeaders() const override {
-    return internal_only_headers_;
+    return shared_config_->internalOnlyHeaders();
   }
 
-  const std::string& name() const override { return name_; }
+  const std::string& name() const override { return shared_config_->name(); }
 
 private:
+  CommonConfigImplConstSharedPtr shared_config_;
   std::unique_ptr<RouteMatcher> route_matcher_;
-  std::list<Http::LowerCaseString> internal_only_headers_;
-  HeaderParserPtr request_headers_parser_;
-  HeaderParserPtr response_headers_parser_;
-  const std::string name_;
 };
 
 /**
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Compact radix trie used to resolve wildcard domains. A forward trie holds the literal part of
+ * prefix wildcards (``foo.*``) and a reverse trie holds the literal part of suffix wildcards
+ * (``*.foo.com``) with its characters reversed, so that a lookup walks the host from its last
+ * character. Either way a lookup touches at most host length characters regardless of the number
+ * of domains configured, and returns the value of the longest matching key.
+ *
+ * Unlike TrieLookupTable, nodes only store the edges that exist, which keeps memory proportional
+ * to the total length of the configured domains.
+ */
+template <class Value> class DomainTrie {
+public:
+  enum class Direction { Forward, Reverse };
+
+  explicit DomainTrie(Direction direction) : direction_(direction) {}
+
+  /**
+   * Adds an entry to the trie.
+   * @param key supplies the literal part of the wildcard domain in natural (left to right) order.
+   * @param value supplies the value to associate with the key. It must convert to true.
+   * @return false if a value already exists for the key. The existing value is kept.
+   */
+  bool add(absl::string_view key, Value value) {
+    Node* node = &root_;
+    size_t offset = 0;
+    while (offset < key.size()) {
+      Node* child = node->findChild(charAt(key, offset));
+      if (child == nullptr) {
+        // No edge shares the next character, so the rest of the key becomes a new leaf.
+        auto leaf = std::make_unique<Node>();
+        leaf->label_.reserve(key.size() - offset);
+        for (; offset < key.size(); offset++) {
+          leaf->label_.push_back(charAt(key, offset));
+        }
+        node->children_.push_back(std::move(leaf));
+        node_count_++;
+        node = node->children_.back().get();
+        break;
+      }
+
+      size_t common = 0;
+      while (common < child->label_.size() && offset + common < key.size() &&
+             child->label_[common] == charAt(key, offset + common)) {
+        common++;
+      }
+
+      if (common < child->label_.size()) {
+        // The key diverges from (or ends inside) the child's edge. Split the edge so that the
+        // shared part becomes its own node.
+        for (NodePtr& slot : node->children_) {
+          if (slot.get() == child) {
+            auto split = std::make_unique<Node>();
+            split->label_ = child->label_.substr(0, common);
+            child->label_ = child->label_.substr(common);
+            split->children_.push_back(std::move(slot));
+            slot = std::move(split);
+            child = slot.get();
+            break;
+          }
+        }
+        node_count_++;
+      }
+
+      node = child;
+      offset += common;
+    }
+
+    if (node->value_) {
+      return false;
+    }
+    node->value_ = std::move(value);
+    return true;
+  }
+
+  /**
+   * Finds the value of the longest key that matches the host. A key never matches the whole host
+   * because the wildcard must match at least one character.
+   * @param host supplies the host in natural (left to right) order.
+   * @return the value of the longest matching key or nullptr if none match.
+   */
+  const Value* findLongest(absl::string_view host) const {
+    const Node* node = &root_;
+    const Value* result = nullptr;
+    size_t offset = 0;
+    while (offset < host.size()) {
+      if (node->value_) {
+        result = &node->value_;
+      }
+      node = node->findChild(charAt(host, offset));
+      if (node == nullptr || host.size() - offset <= node->label_.size()) {
+        // Either nothing matches further, or the next key would consume the whole host and leave
+        // nothing for the wildcard.
+        break;
+      }
+      for (size_t i = 0; i < node->label_.size(); i++) {
+        if (node->label_[i] != charAt(host, offset + i)) {
+          return result;
+        }
+      }
+      offset += node->label_.size();
+    }
+    return result;
+  }
+
+  /**
+   * @return true if no entries have been added.
+   */
+  bool empty() const { return root_.children_.empty() && !root_.value_; }
+
+  /**
+   * @return the number of trie nodes. Exposed for testing.
+   */
+  uint64_t nodeCount() const { return node_count_; }
+
+private:
+  struct Node;
+  typedef std::unique_ptr<Node> NodePtr;
+
+  struct Node {
+    // The edge label leading from the parent node to this node, in traversal order.
+    std::string label_;
+    Value value_{};
+    // There is at most one child per leading label character.
+    std::vector<NodePtr> children_;
+
+    Node* findChild(char c) const {
+      for (const NodePtr& child : children_) {
+        if (child->label_[0] == c) {
+          return child.get();
+        }
+      }
+      return nullptr;
+    }
+  };
+
+  char charAt(absl::string_view str, size_t offset) const {
+    return direction_ == Direction::Forward ? str[offset] : str[str.size() - 1 - offset];
+  }
+
+  const Direction direction_;
+  Node root_;
+  uint64_t node_count_{1};
+};
+
+} // namespace Router
+} // namespace Envoy
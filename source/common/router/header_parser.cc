@@ -30,13 +30,15 @@ enum class ParserState {
 
 std::string unescape(absl::string_view sv) { return absl::StrReplaceAll(sv, {{"%%", "%"}}); }
 
+} // namespace
+
 // Implements a state machine to parse custom headers. Each character of the custom header format
 // is either literal text (with % escaped as %%) or part of a %VAR% or %VAR(["args"])% expression.
 // The statement machine does minimal validation of the arguments (if any) and does not know the
 // names of valid variables. Interpretation of the variable name and arguments is delegated to
 // StreamInfoHeaderFormatter.
-HeaderFormatterPtr
-parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option) {
+HeaderParser::Instruction
+HeaderParser::parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option) {
   const std::string& key = header_value_option.header().key();
   // PGV constraints provide this guarantee.
   ASSERT(!key.empty());
@@ -50,13 +52,14 @@ parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option
   }
 
   const bool append = PROTOBUF_GET_WRAPPED_OR_DEFAULT(header_value_option, append, true);
+  Instruction instruction{Http::LowerCaseString(key), false, append, "", {}};
 
   absl::string_view format(header_value_option.header().value());
   if (format.empty()) {
-    return std::make_unique<PlainHeaderFormatter>("", append);
+    return instruction;
   }
 
-  std::vector<HeaderFormatterPtr> formatters;
+  std::vector<Segment>& segments = instruction.segments_;
 
   size_t pos = 0, start = 0;
   ParserState state = ParserState::Literal;
@@ -87,7 +90,7 @@ parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option
       state = ParserState::VariableName;
       if (pos > start) {
         absl::string_view literal = format.substr(start, pos - start);
-        formatters.emplace_back(new PlainHeaderFormatter(unescape(literal), append));
+        segments.push_back({unescape(literal), nullptr});
       }
       start = pos + 1;
       break;
@@ -96,8 +99,8 @@ parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option
       // Consume "VAR" from "%VAR%" or "%VAR(...)%"
       if (ch == '%') {
         // Found complete variable name, add formatter.
-        formatters.emplace_back(
-            new StreamInfoHeaderFormatter(format.substr(start, pos - start), append));
+        segments.push_back({"", std::make_shared<const StreamInfoHeaderFormatter>(
+                                    format.substr(start, pos - start), append)});
         start = pos + 1;
         state = ParserState::Literal;
         break;
@@ -177,8 +180,8 @@ parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option
     case ParserState::ExpectVariableEnd:
       // Search for closing % of a %VAR(...)% expression
       if (ch == '%') {
-        formatters.emplace_back(
-            new StreamInfoHeaderFormatter(format.substr(start, pos - start), append));
+        segments.push_back({"", std::make_shared<const StreamInfoHeaderFormatter>(
+                                    format.substr(start, pos - start), append)});
         start = pos + 1;
         state = ParserState::Literal;
         break;
@@ -206,38 +209,29 @@ parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option
   if (pos > start) {
     // Trailing constant data.
     absl::string_view literal = format.substr(start, pos - start);
-    formatters.emplace_back(new PlainHeaderFormatter(unescape(literal), append));
+    segments.push_back({unescape(literal), nullptr});
   }
 
-  ASSERT(formatters.size() > 0);
+  ASSERT(segments.size() > 0);
 
-  if (formatters.size() == 1) {
-    return std::move(formatters[0]);
+  // Without variables, the value is a single literal.
+  if (segments.size() == 1 && segments[0].formatter_ == nullptr) {
+    instruction.value_ = std::move(segments[0].literal_);
+    segments.clear();
   }
 
-  return std::make_unique<CompoundHeaderFormatter>(std::move(formatters), append);
+  return instruction;
 }
 
-} // namespace
-
 HeaderParserPtr HeaderParser::configure(
     const Protobuf::RepeatedPtrField<envoy::api::v2::core::HeaderValueOption>& headers_to_add) {
-  HeaderParserPtr header_parser(new HeaderParser());
-
-  for (const auto& header_value_option : headers_to_add) {
-    HeaderFormatterPtr header_formatter = parseInternal(header_value_option);
-
-    header_parser->headers_to_add_.emplace_back(
-        Http::LowerCaseString(header_value_option.header().key()), std::move(header_formatter));
-  }
-
-  return header_parser;
+  return configure(headers_to_add, Protobuf::RepeatedPtrField<ProtobufTypes::String>());
 }
 
 HeaderParserPtr HeaderParser::configure(
     const Protobuf::RepeatedPtrField<envoy::api::v2::core::HeaderValueOption>& headers_to_add,
     const Protobuf::RepeatedPtrField<ProtobufTypes::String>& headers_to_remove) {
-  HeaderParserPtr header_parser = configure(headers_to_add);
+  HeaderParserPtr header_parser(new HeaderParser());
 
   for (const auto& header : headers_to_remove) {
     // We reject :-prefix (e.g. :path) removal here. This is dangerous, since other aspects of
@@ -246,29 +240,62 @@ HeaderParserPtr HeaderParser::configure(
     if (header[0] == ':' || Http::LowerCaseString(header).get() == "host") {
       throw EnvoyException(":-prefixed or host headers may not be removed");
     }
-    header_parser->headers_to_remove_.emplace_back(header);
+    header_parser->instructions_.push_back({Http::LowerCaseString(header), true, false, "", {}});
+  }
+
+  for (const auto& header_value_option : headers_to_add) {
+    header_parser->instructions_.push_back(parseInternal(header_value_option));
   }
 
   return header_parser;
 }
 
+HeaderParserPtr HeaderParser::merge(const std::vector<const HeaderParser*>& parsers) {
+  HeaderParserPtr header_parser(new HeaderParser());
+  for (const HeaderParser* parser : parsers) {
+    header_parser->instructions_.insert(header_parser->instructions_.end(),
+                                        parser->instructions_.begin(), parser->instructions_.end());
+  }
+  return header_parser;
+}
+
 void HeaderParser::evaluateHeaders(Http::HeaderMap& headers,
                                    const StreamInfo::StreamInfo& stream_info) const {
-  // Removing headers in the headers_to_remove_ list first makes
-  // remove-before-add the default behavior as expected by users.
-  for (const auto& header : headers_to_remove_) {
-    headers.remove(header);
-  }
+  for (const Instruction& instruction : instructions_) {
+    if (instruction.remove_) {
+      headers.remove(instruction.key_);
+      continue;
+    }
 
-  for (const auto& formatter : headers_to_add_) {
-    const std::string value = formatter.second->format(stream_info);
-    if (!value.empty()) {
-      if (formatter.second->append()) {
-        headers.addReferenceKey(formatter.first, value);
+    if (instruction.segments_.empty()) {
+      if (instruction.value_.empty()) {
+        continue;
+      }
+      // Both the key and the value live as long as the route configuration.
+      if (instruction.append_) {
+        headers.addReference(instruction.key_, instruction.value_);
       } else {
-        headers.setReferenceKey(formatter.first, value);
+        headers.setReference(instruction.key_, instruction.value_);
       }
+      continue;
+    }
+
+    Http::HeaderString value;
+    for (const Segment& segment : instruction.segments_) {
+      if (segment.formatter_ == nullptr) {
+        value.append(segment.literal_.c_str(), segment.literal_.size());
+      } else {
+        const std::string formatted = segment.formatter_->format(stream_info);
+        value.append(formatted.c_str(), formatted.size());
+      }
+    }
+    if (value.empty()) {
+      continue;
+    }
+    if (!instruction.append_) {
+      headers.remove(instruction.key_);
     }
+    headers.addViaMove(Http::HeaderString(instruction.key_), std::move(value));
   }
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -17,9 +18,9 @@ class HeaderParser;
 typedef std::unique_ptr<HeaderParser> HeaderParserPtr;
 
 /**
- * HeaderParser manipulates Http::HeaderMap instances. Headers to be added are pre-parsed to select
- * between a constant value implementation and a dynamic value implementation based on
- * StreamInfo::StreamInfo fields.
+ * HeaderParser manipulates Http::HeaderMap instances. Headers to be added are pre-parsed into
+ * either a constant value, which the header maps reference, or a list of literal and
+ * StreamInfo::StreamInfo based segments, which are written straight into the header value.
  */
 class HeaderParser {
 public:
@@ -39,14 +40,41 @@ public:
       const Protobuf::RepeatedPtrField<envoy::api::v2::core::HeaderValueOption>& headers_to_add,
       const Protobuf::RepeatedPtrField<ProtobufTypes::String>& headers_to_remove);
 
+  /*
+   * @param parsers supplies the parsers to merge, in the order in which they are evaluated
+   * @return HeaderParserPtr a parser whose evaluateHeaders is equivalent to calling evaluateHeaders
+   *         on each of the parsers in turn
+   */
+  static HeaderParserPtr merge(const std::vector<const HeaderParser*>& parsers);
+
   void evaluateHeaders(Http::HeaderMap& headers, const StreamInfo::StreamInfo& stream_info) const;
 
 protected:
   HeaderParser() {}
 
 private:
-  std::vector<std::pair<Http::LowerCaseString, HeaderFormatterPtr>> headers_to_add_;
-  std::vector<Http::LowerCaseString> headers_to_remove_;
+  // A part of the value of a header to add, either literal text or a StreamInfo variable.
+  struct Segment {
+    std::string literal_;
+    std::shared_ptr<const StreamInfoHeaderFormatter> formatter_;
+  };
+
+  // A header to remove or to add. The removals of a parser come before its additions, so that
+  // remove-before-add is the default behavior.
+  struct Instruction {
+    Http::LowerCaseString key_;
+    bool remove_;
+    bool append_;
+    // The value of a header to add without variables, which the header maps reference.
+    std::string value_;
+    // The value of a header to add with variables. Empty if the value is constant.
+    std::vector<Segment> segments_;
+  };
+
+  static Instruction parseInternal(
+      const envoy::api::v2::core::HeaderValueOption& header_value_option);
+
+  std::vector<Instruction> instructions_;
 };
 
 } // namespace Router
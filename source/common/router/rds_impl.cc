@@ -63,7 +63,7 @@ RdsRouteConfigSubscription::RdsRouteConfigSubscription(
       init_target_(fmt::format("RdsRouteConfigSubscription {}", route_config_name_),
                    [this]() { subscription_->start({route_config_name_}, *this); }),
       scope_(factory_context.scope().createScope(stat_prefix + "rds." + route_config_name_ + ".")),
-      stats_({ALL_RDS_STATS(POOL_COUNTER(*scope_))}),
+      stats_({ALL_RDS_STATS(POOL_COUNTER(*scope_), POOL_HISTOGRAM(*scope_))}),
       route_config_provider_manager_(route_config_provider_manager),
       manager_identifier_(manager_identifier), time_source_(factory_context.timeSource()),
       last_updated_(factory_context.timeSource().systemTime()) {
@@ -102,15 +102,16 @@ void RdsRouteConfigSubscription::onConfigUpdate(const ResourceVector& resources,
     throw EnvoyException(fmt::format("Unexpected RDS resource length: {}", resources.size()));
   }
   const auto& route_config = resources[0];
-  MessageUtil::validate(route_config);
   // TODO(PiotrSikora): Remove this hack once fixed internally.
   if (!(route_config.name() == route_config_name_)) {
     throw EnvoyException(fmt::format("Unexpected RDS configuration (expecting {}): {}",
                                      route_config_name_, route_config.name()));
   }
 
+  // The last config passed validation, so only a changed config needs to be validated.
   const uint64_t new_hash = MessageUtil::hash(route_config);
   if (!config_info_ || new_hash != config_info_.value().last_config_hash_) {
+    MessageUtil::validate(route_config);
     config_info_ = {new_hash, version_info};
     route_config_proto_ = route_config;
     stats_.config_reload_.inc();
@@ -137,8 +138,7 @@ RdsRouteConfigProviderImpl::RdsRouteConfigProviderImpl(
       tls_(factory_context.threadLocal().allocateSlot()) {
   ConfigConstSharedPtr initial_config;
   if (subscription_->config_info_.has_value()) {
-    initial_config =
-        std::make_shared<ConfigImpl>(subscription_->route_config_proto_, factory_context_, false);
+    initial_config = buildConfig();
   } else {
     initial_config = std::make_shared<NullConfigImpl>();
   }
@@ -165,9 +165,24 @@ absl::optional<RouteConfigProvider::ConfigInfo> RdsRouteConfigProviderImpl::conf
   }
 }
 
+std::shared_ptr<const ConfigImpl> RdsRouteConfigProviderImpl::buildConfig() {
+  RdsStats& stats = subscription_->stats_;
+  Stats::Timespan build_timer(stats.config_build_time_ms_, factory_context_.timeSource());
+  auto new_config = std::make_shared<const ConfigImpl>(subscription_->route_config_proto_,
+                                                       factory_context_, false, config_.get());
+  build_timer.complete();
+
+  stats.virtual_host_reused_.add(new_config->virtualHostsReused());
+  stats.virtual_host_rebuilt_.add(new_config->virtualHostsBuilt());
+  ENVOY_LOG(debug, "rds: built configuration {}: reused {} virtual hosts, rebuilt {}",
+            subscription_->route_config_name_, new_config->virtualHostsReused(),
+            new_config->virtualHostsBuilt());
+  config_ = new_config;
+  return new_config;
+}
+
 void RdsRouteConfigProviderImpl::onConfigUpdate() {
-  ConfigConstSharedPtr new_config(
-      new ConfigImpl(subscription_->route_config_proto_, factory_context_, false));
+  ConfigConstSharedPtr new_config = buildConfig();
   tls_->runOnAllThreads(
       [this, new_config]() -> void { tls_->getTyped<ThreadLocalConfig>().config_ = new_config; });
 }
@@ -196,9 +211,6 @@ Router::RouteConfigProviderPtr RouteConfigProviderManagerImpl::createRdsRouteCon
     // of simplicity.
     subscription.reset(new RdsRouteConfigSubscription(rds, manager_identifier, factory_context,
                                                       stat_prefix, *this));
-
-    factory_context.initManager().add(subscription->init_target_);
-
     route_config_subscriptions_.insert({manager_identifier, subscription});
   } else {
     // Because the RouteConfigProviderManager's weak_ptrs only get cleaned up
@@ -207,6 +219,8 @@ Router::RouteConfigProviderPtr RouteConfigProviderManagerImpl::createRdsRouteCon
     subscription = it->second.lock();
   }
   ASSERT(subscription);
+  // Every listener sharing the subscription waits for it, not just the one that created it.
+  factory_context.initManager().add(subscription->init_target_);
 
   Router::RouteConfigProviderPtr new_provider{
       new RdsRouteConfigProviderImpl(std::move(subscription), factory_context)};
@@ -19,11 +19,14 @@
 #include "envoy/server/filter_config.h"
 #include "envoy/singleton/instance.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/stats/timespan.h"
 #include "envoy/thread_local/thread_local.h"
 
 #include "common/common/logger.h"
 #include "common/init/target_impl.h"
 #include "common/protobuf/utility.h"
+#include "common/router/config_impl.h"
 
 namespace Envoy {
 namespace Router {
@@ -74,9 +77,12 @@ private:
  * All RDS stats. @see stats_macros.h
  */
 // clang-format off
-#define ALL_RDS_STATS(COUNTER)                                                                     \
+#define ALL_RDS_STATS(COUNTER, HISTOGRAM)                                                          \
   COUNTER(config_reload)                                                                           \
-  COUNTER(update_empty)
+  COUNTER(update_empty)                                                                            \
+  COUNTER(virtual_host_reused)                                                                     \
+  COUNTER(virtual_host_rebuilt)                                                                    \
+  HISTOGRAM(config_build_time_ms)
 
 // clang-format on
 
@@ -84,7 +90,7 @@ private:
  * Struct definition for all RDS stats. @see stats_macros.h
  */
 struct RdsStats {
-  ALL_RDS_STATS(GENERATE_COUNTER_STRUCT)
+  ALL_RDS_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 class RdsRouteConfigProviderImpl;
@@ -124,7 +130,7 @@ private:
       RouteConfigProviderManagerImpl& route_config_provider_manager);
 
   const std::string route_config_name_;
-  Init::TargetImpl init_target_;
+  Init::SharedTargetImpl init_target_;
   std::unique_ptr<Envoy::Config::Subscription<envoy::api::v2::RouteConfiguration>> subscription_;
   Stats::ScopePtr scope_;
   RdsStats stats_;
@@ -169,9 +175,16 @@ private:
   RdsRouteConfigProviderImpl(RdsRouteConfigSubscriptionSharedPtr&& subscription,
                              Server::Configuration::FactoryContext& factory_context);
 
+  // Builds a new configuration from the subscription's current proto, reusing unchanged
+  // virtual hosts of the last configuration built by this provider.
+  std::shared_ptr<const ConfigImpl> buildConfig();
+
   RdsRouteConfigSubscriptionSharedPtr subscription_;
   Server::Configuration::FactoryContext& factory_context_;
   ThreadLocal::SlotPtr tls_;
+  // The most recent configuration, owned by the main thread. Only used as the source of virtual
+  // hosts to reuse when the next update is built.
+  std::shared_ptr<const ConfigImpl> config_;
 
   friend class RouteConfigProviderManagerImpl;
 };
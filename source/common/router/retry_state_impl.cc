@@ -11,6 +11,7 @@
 #include "common/http/codes.h"
 #include "common/http/headers.h"
 #include "common/http/utility.h"
+#include "common/runtime/runtime_impl.h"
 
 namespace Envoy {
 namespace Router {
@@ -168,10 +169,14 @@ RetryStatus RetryStateImpl::shouldRetry(bool would_retry, DoRetryCallback callba
 
   if (!cluster_.resourceManager(priority_).retries().canCreate()) {
     cluster_.stats().upstream_rq_retry_overflow_.inc();
+    if (cluster_.resourceManager(priority_).hasRetryBudget()) {
+      cluster_.stats().upstream_rq_retry_budget_exceeded_.inc();
+    }
     return RetryStatus::NoOverflow;
   }
 
-  if (!runtime_.snapshot().featureEnabled("upstream.use_retry", 100)) {
+  static const Runtime::FeatureHandleImpl use_retry("upstream.use_retry");
+  if (!runtime_.snapshot().featureEnabled(use_retry, 100)) {
     return RetryStatus::No;
   }
 
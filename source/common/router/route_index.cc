@@ -0,0 +1,108 @@
+#include "common/router/route_index.h"
+
+#include <algorithm>
+
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Router {
+
+RouteIndex::PrefixNode* RouteIndex::PrefixNode::findChild(char c) const {
+  for (const PrefixNodePtr& child : children_) {
+    if (child->label_[0] == c) {
+      return child.get();
+    }
+  }
+  return nullptr;
+}
+
+void RouteIndex::insertSorted(std::vector<uint32_t>& positions, uint32_t position) {
+  positions.insert(std::upper_bound(positions.begin(), positions.end(), position), position);
+}
+
+void RouteIndex::addExactPath(absl::string_view path, uint32_t position) {
+  insertSorted(exact_paths_[std::string(path)], position);
+}
+
+void RouteIndex::addPrefix(absl::string_view prefix, uint32_t position) {
+  has_prefixes_ = true;
+  PrefixNode* node = &prefix_root_;
+  absl::string_view remaining = prefix;
+  while (!remaining.empty()) {
+    PrefixNode* child = node->findChild(remaining[0]);
+    if (child == nullptr) {
+      // No edge shares the next byte, so the rest of the prefix becomes a new leaf.
+      auto leaf = std::make_unique<PrefixNode>();
+      leaf->label_ = std::string(remaining);
+      node->children_.push_back(std::move(leaf));
+      prefix_node_count_++;
+      node = node->children_.back().get();
+      break;
+    }
+
+    size_t common = 0;
+    while (common < child->label_.size() && common < remaining.size() &&
+           child->label_[common] == remaining[common]) {
+      common++;
+    }
+
+    if (common < child->label_.size()) {
+      // The prefix diverges from (or ends inside) the child's edge. Split the edge so that the
+      // shared part becomes its own node.
+      for (PrefixNodePtr& slot : node->children_) {
+        if (slot.get() == child) {
+          auto split = std::make_unique<PrefixNode>();
+          split->label_ = child->label_.substr(0, common);
+          child->label_ = child->label_.substr(common);
+          split->children_.push_back(std::move(slot));
+          slot = std::move(split);
+          child = slot.get();
+          break;
+        }
+      }
+      prefix_node_count_++;
+    }
+
+    node = child;
+    remaining.remove_prefix(common);
+  }
+
+  insertSorted(node->positions_, position);
+}
+
+void RouteIndex::addUnindexed(uint32_t position) { insertSorted(unindexed_, position); }
+
+void RouteIndex::findCandidates(absl::string_view path, absl::string_view path_without_query,
+                                Candidates& candidates) const {
+  if (!exact_paths_.empty()) {
+    const auto it = exact_paths_.find(path_without_query);
+    if (it != exact_paths_.end()) {
+      candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    }
+  }
+
+  if (has_prefixes_) {
+    const PrefixNode* node = &prefix_root_;
+    absl::string_view remaining = path;
+    while (true) {
+      candidates.insert(candidates.end(), node->positions_.begin(), node->positions_.end());
+      if (remaining.empty()) {
+        break;
+      }
+      const PrefixNode* child = node->findChild(remaining[0]);
+      if (child == nullptr || !absl::StartsWith(remaining, child->label_)) {
+        break;
+      }
+      remaining.remove_prefix(child->label_.size());
+      node = child;
+    }
+  }
+
+  // Positions from each source are already ordered, but the combination is not.
+  if (candidates.size() > 1) {
+    std::sort(candidates.begin(), candidates.end());
+  }
+}
+
+} // namespace Router
+} // namespace Envoy
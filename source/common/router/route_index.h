@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Compiled lookup structure over the routes of a single virtual host. Routes are identified by
+ * their position in the virtual host route list. Exact path routes are indexed in a hash map,
+ * prefix routes in a radix trie, and everything else (regex, case insensitive matching) is kept
+ * in an ordered list that must always be scanned.
+ *
+ * The index only narrows the set of routes whose path specifier can match a request path. Callers
+ * are still expected to run the full route match (headers, query parameters, runtime, etc.) on
+ * every candidate in ascending position order to preserve first-match semantics.
+ */
+class RouteIndex {
+public:
+  // Ordered list of candidate route positions. Most lookups produce only a handful of candidates
+  // so these are kept inline to avoid a heap allocation per request.
+  typedef absl::InlinedVector<uint32_t, 8> Candidates;
+
+  /**
+   * Index a route that matches when the path (without query string) equals the given path.
+   * @param path supplies the exact path.
+   * @param position supplies the position of the route in the virtual host.
+   */
+  void addExactPath(absl::string_view path, uint32_t position);
+
+  /**
+   * Index a route that matches when the path starts with the given prefix.
+   * @param prefix supplies the path prefix.
+   * @param position supplies the position of the route in the virtual host.
+   */
+  void addPrefix(absl::string_view prefix, uint32_t position);
+
+  /**
+   * Add a route that cannot be indexed by path and must always be considered.
+   * @param position supplies the position of the route in the virtual host.
+   */
+  void addUnindexed(uint32_t position);
+
+  /**
+   * Find all indexed routes whose path specifier matches the given path.
+   * @param path supplies the full request path (including any query string).
+   * @param path_without_query supplies the request path with the query string removed.
+   * @param candidates supplies the vector to fill. On return it holds the matching positions in
+   *        ascending order. Unindexed routes are not included; see unindexed().
+   */
+  void findCandidates(absl::string_view path, absl::string_view path_without_query,
+                      Candidates& candidates) const;
+
+  /**
+   * @return the positions, in ascending order, of routes that are not indexed by path.
+   */
+  const std::vector<uint32_t>& unindexed() const { return unindexed_; }
+
+  /**
+   * @return the number of prefix trie nodes. Exposed for testing.
+   */
+  uint64_t prefixNodeCount() const { return prefix_node_count_; }
+
+private:
+  struct PrefixNode;
+  typedef std::unique_ptr<PrefixNode> PrefixNodePtr;
+
+  struct PrefixNode {
+    // The edge label leading from the parent node to this node.
+    std::string label_;
+    // Positions of routes whose prefix ends exactly at this node, in ascending order.
+    std::vector<uint32_t> positions_;
+    // Children keyed by the first byte of their label. There is at most one child per byte.
+    std::vector<PrefixNodePtr> children_;
+
+    PrefixNode* findChild(char c) const;
+  };
+
+  static void insertSorted(std::vector<uint32_t>& positions, uint32_t position);
+
+  absl::flat_hash_map<std::string, std::vector<uint32_t>> exact_paths_;
+  PrefixNode prefix_root_;
+  uint64_t prefix_node_count_{1};
+  bool has_prefixes_{};
+  std::vector<uint32_t> unindexed_;
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "common/router/router.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <memory>
@@ -13,9 +14,11 @@
 #include "envoy/upstream/cluster_manager.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/enum_to_int.h"
+#include "common/common/stack_array.h"
 #include "common/common/utility.h"
 #include "common/grpc/common.h"
 #include "common/http/codes.h"
@@ -112,6 +115,33 @@ bool FilterUtility::shouldShadow(const ShadowPolicy& policy, Runtime::Loader& ru
   return true;
 }
 
+void FilterUtility::shareData(Buffer::Instance& data, Buffer::Instance& copy) {
+  const RetainedDataConstSharedPtr retained = retainData(data);
+  referenceData(retained, data);
+  referenceData(retained, copy);
+}
+
+FilterUtility::RetainedDataConstSharedPtr FilterUtility::retainData(Buffer::Instance& data) {
+  auto retained = std::make_shared<Buffer::OwnedImpl>();
+  retained->move(data);
+  return retained;
+}
+
+void FilterUtility::referenceData(const RetainedDataConstSharedPtr& retained,
+                                  Buffer::Instance& buffer) {
+  // Each fragment holds a reference to the retained data, so that it is freed once the last
+  // buffer referencing it is drained.
+  const uint64_t num_slices = retained->getRawSlices(nullptr, 0);
+  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
+  retained->getRawSlices(slices.begin(), num_slices);
+  for (const Buffer::RawSlice& slice : slices) {
+    auto* fragment = new Buffer::BufferFragmentImpl(
+        slice.mem_, slice.len_,
+        [retained](const void*, size_t, const Buffer::BufferFragmentImpl* self) { delete self; });
+    buffer.addBufferFragment(*fragment);
+  }
+}
+
 FilterUtility::TimeoutData
 FilterUtility::finalTimeout(const RouteEntry& route, Http::HeaderMap& request_headers,
                             bool insert_envoy_expected_request_timeout_ms, bool grpc_request) {
@@ -377,6 +407,14 @@ Http::FilterHeadersStatus Filter::decodeHeaders(Http::HeaderMap& headers, bool e
                        config_.random_, callbacks_->dispatcher(), route_entry_->priority());
   do_shadowing_ = FilterUtility::shouldShadow(route_entry_->shadowPolicy(), config_.runtime_,
                                               callbacks_->streamId());
+  if (do_shadowing_ && route_entry_->shadowPolicy().streaming() && !end_stream) {
+    // The body is sent to the shadow as it streams, so that it doesn't need to be buffered.
+    shadow_stream_ = config_.shadowWriter().streamingShadow(
+        route_entry_->shadowPolicy().cluster(), std::make_unique<Http::HeaderMapImpl>(headers),
+        timeout_.global_timeout_);
+    do_shadowing_ = false;
+  }
+  do_hedging_ = route_entry_->hedgePolicy().hedgeOnLatency();
 
   ENVOY_STREAM_LOG(debug, "router decoding headers:\n{}", *callbacks_, headers);
 
@@ -413,21 +451,40 @@ void Filter::sendNoHealthyUpstreamResponse() {
 }
 
 Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_stream) {
-  bool buffering = (retry_state_ && retry_state_->enabled()) || do_shadowing_;
-  if (buffering && buffer_limit_ > 0 &&
-      getLength(callbacks_->decodingBuffer()) + data.length() > buffer_limit_) {
-    // The request is larger than we should buffer. Give up on the retry/shadow
-    cluster_->stats().retry_or_shadow_abandoned_.inc();
-    retry_state_.reset();
-    buffering = false;
-    do_shadowing_ = false;
+  bool buffering = (retry_state_ && retry_state_->enabled()) || do_shadowing_ || do_hedging_;
+  if (buffering) {
+    const uint64_t buffered = getLength(callbacks_->decodingBuffer()) + data.length();
+    const bool over_route_limit = buffered > route_entry_->retryShadowBufferLimit();
+    if (over_route_limit || (buffer_limit_ > 0 && buffered > buffer_limit_)) {
+      // The request is larger than we should buffer. Give up on the retry/shadow/hedge
+      cluster_->stats().retry_or_shadow_abandoned_.inc();
+      if (over_route_limit) {
+        config_.stats_.rq_retry_shadow_buffer_limit_exceeded_.inc();
+      }
+      retry_state_.reset();
+      retained_body_.clear();
+      buffering = false;
+      do_shadowing_ = false;
+      do_hedging_ = false;
+    }
+  }
+
+  if (shadow_stream_) {
+    // The shadow shares the slices of the data with the upstream request instead of a copy.
+    Buffer::OwnedImpl shadow_data;
+    FilterUtility::shareData(data, shadow_data);
+    shadow_stream_->sendData(shadow_data, end_stream);
   }
 
   if (buffering) {
-    // If we are going to buffer for retries or shadowing, we need to make a copy before encoding
-    // since it's all moves from here on.
-    Buffer::OwnedImpl copy(data);
-    upstream_request_->encodeData(copy, end_stream);
+    // If we are going to buffer for retries or shadowing, we need to retain the data before
+    // encoding since it's all moves from here on. Every attempt references the retained data
+    // instead of a copy.
+    retained_body_.push_back(FilterUtility::retainData(data));
+    FilterUtility::referenceData(retained_body_.back(), data);
+    Buffer::OwnedImpl attempt_data;
+    FilterUtility::referenceData(retained_body_.back(), attempt_data);
+    upstream_request_->encodeData(attempt_data, end_stream);
 
     // If we are potentially going to retry or shadow this request we need to buffer.
     // This will not cause the connection manager to 413 because before we hit the
@@ -449,6 +506,9 @@ Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_strea
 Http::FilterTrailersStatus Filter::decodeTrailers(Http::HeaderMap& trailers) {
   ENVOY_STREAM_LOG(debug, "router decoding trailers:\n{}", *callbacks_, trailers);
   downstream_trailers_ = &trailers;
+  if (shadow_stream_) {
+    shadow_stream_->sendTrailers(trailers);
+  }
   upstream_request_->encodeTrailers(trailers);
   onRequestComplete();
   return Http::FilterTrailersStatus::StopIteration;
@@ -470,11 +530,21 @@ void Filter::cleanup() {
     callbacks_->streamInfo().setUpstreamTiming(upstream_request_->upstream_timing_);
   }
   upstream_request_.reset();
+  if (hedge_request_) {
+    resetHedgeRequest();
+  }
   retry_state_.reset();
+  retained_body_.clear();
+  // A shadow whose request is not complete is reset.
+  shadow_stream_.reset();
   if (response_timeout_) {
     response_timeout_->disableTimer();
     response_timeout_.reset();
   }
+  if (hedge_timer_) {
+    hedge_timer_->disableTimer();
+    hedge_timer_.reset();
+  }
 }
 
 void Filter::maybeDoShadowing() {
@@ -485,8 +555,8 @@ void Filter::maybeDoShadowing() {
   ASSERT(!route_entry_->shadowPolicy().cluster().empty());
   Http::MessagePtr request(new Http::RequestMessageImpl(
       Http::HeaderMapPtr{new Http::HeaderMapImpl(*downstream_headers_)}));
-  if (callbacks_->decodingBuffer()) {
-    request->body() = std::make_unique<Buffer::OwnedImpl>(*callbacks_->decodingBuffer());
+  if (!retained_body_.empty()) {
+    request->body() = retainedBody();
   }
   if (downstream_trailers_) {
     request->trailers(Http::HeaderMapPtr{new Http::HeaderMapImpl(*downstream_trailers_)});
@@ -496,6 +566,14 @@ void Filter::maybeDoShadowing() {
                                 timeout_.global_timeout_);
 }
 
+Buffer::InstancePtr Filter::retainedBody() const {
+  Buffer::InstancePtr body = std::make_unique<Buffer::OwnedImpl>();
+  for (const FilterUtility::RetainedDataConstSharedPtr& retained : retained_body_) {
+    FilterUtility::referenceData(retained, *body);
+  }
+  return body;
+}
+
 void Filter::onRequestComplete() {
   downstream_end_stream_ = true;
   Event::Dispatcher& dispatcher = callbacks_->dispatcher();
@@ -508,12 +586,102 @@ void Filter::onRequestComplete() {
     maybeDoShadowing();
 
     if (timeout_.global_timeout_.count() > 0) {
-      response_timeout_ = dispatcher.createTimer([this]() -> void { onResponseTimeout(); });
+      response_timeout_ = dispatcher.createCoarseTimer([this]() -> void { onResponseTimeout(); });
       response_timeout_->enableTimer(timeout_.global_timeout_);
     }
+
+    if (do_hedging_) {
+      // The request is hedged once it has taken longer than most requests to the cluster.
+      const absl::optional<std::chrono::milliseconds> latency =
+          cluster_->latencyEstimator().latencyP95();
+      if (latency) {
+        hedge_timer_ = dispatcher.createTimer([this]() -> void { onHedgeTimeout(); });
+        hedge_timer_->enableTimer(
+            std::max(latency.value(), route_entry_->hedgePolicy().latencyHedgeMinDelay()));
+      }
+    }
   }
 }
 
+void Filter::onHedgeTimeout() {
+  // There is nothing to hedge once the response started, or during a retry backoff.
+  if (downstream_response_started_ || !upstream_request_) {
+    return;
+  }
+
+  // The budget always allows one hedged request, so that clusters with few requests can hedge.
+  Upstream::ClusterStats& stats = cluster_->stats();
+  const double budget =
+      std::max(1.0, stats.upstream_rq_active_.value() *
+                        route_entry_->hedgePolicy().latencyHedgeBudgetPercent() / 100);
+  if (stats.upstream_rq_hedge_active_.value() >= budget) {
+    stats.upstream_rq_hedge_budget_exceeded_.inc();
+    return;
+  }
+
+  selecting_hedge_host_ = true;
+  Http::ConnectionPool::Instance* conn_pool = getConnPool();
+  selecting_hedge_host_ = false;
+  if (!conn_pool) {
+    return;
+  }
+
+  ENVOY_STREAM_LOG(debug, "hedging upstream request", *callbacks_);
+  stats.upstream_rq_hedged_.inc();
+  stats.upstream_rq_hedge_active_.inc();
+  hedge_request_ = std::make_unique<UpstreamRequest>(*this, *conn_pool);
+  hedge_request_->encodeHeaders(retained_body_.empty() && !downstream_trailers_);
+  // It's possible we got immediately reset.
+  if (hedge_request_) {
+    if (!retained_body_.empty()) {
+      hedge_request_->encodeData(*retainedBody(), !downstream_trailers_);
+    }
+
+    if (downstream_trailers_) {
+      hedge_request_->encodeTrailers(*downstream_trailers_);
+    }
+  }
+}
+
+void Filter::onHedgedResponse(UpstreamRequest& upstream_request) {
+  if (!hedge_request_) {
+    return;
+  }
+
+  if (&upstream_request == hedge_request_.get()) {
+    cluster_->stats().upstream_rq_hedge_won_.inc();
+    upstream_request_.swap(hedge_request_);
+  }
+  resetHedgeRequest();
+  // Both requests selected a host, and the downstream info reports the host of the response.
+  callbacks_->streamInfo().onUpstreamHostSelected(upstream_request_->upstream_host_);
+}
+
+bool Filter::maybeDropHedgedRequest(UpstreamRequest& upstream_request, Http::Code code) {
+  if (!hedge_request_) {
+    return false;
+  }
+
+  ENVOY_STREAM_LOG(debug, "dropping failed hedged upstream request", *callbacks_);
+  if (upstream_request.upstream_host_) {
+    upstream_request.upstream_host_->outlierDetector().putHttpResponseCode(enumToInt(code));
+    upstream_request.upstream_host_->stats().rq_error_.inc();
+  }
+  if (&upstream_request == upstream_request_.get()) {
+    upstream_request_.swap(hedge_request_);
+  }
+  // This destroys the failed request, which is the caller, like a retry does.
+  hedge_request_.reset();
+  cluster_->stats().upstream_rq_hedge_active_.dec();
+  return true;
+}
+
+void Filter::resetHedgeRequest() {
+  hedge_request_->resetStream();
+  hedge_request_.reset();
+  cluster_->stats().upstream_rq_hedge_active_.dec();
+}
+
 void Filter::onDestroy() {
   if (upstream_request_ && !attempting_internal_redirect_with_complete_stream_) {
     upstream_request_->resetStream();
@@ -830,6 +998,14 @@ void Filter::onUpstreamComplete() {
     upstream_request_->resetStream();
   }
 
+  if (route_entry_->hedgePolicy().hedgeOnLatency() &&
+      DateUtil::timePointValid(downstream_request_complete_time_)) {
+    cluster_->latencyEstimator().recordLatency(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            callbacks_->dispatcher().timeSource().monotonicTime() -
+            downstream_request_complete_time_));
+  }
+
   if (config_.emit_dynamic_stats_ && !callbacks_->streamInfo().healthCheck() &&
       DateUtil::timePointValid(downstream_request_complete_time_)) {
     Event::Dispatcher& dispatcher = callbacks_->dispatcher();
@@ -895,6 +1071,11 @@ bool Filter::setupRetry(bool end_stream) {
   }
 
   upstream_request_.reset();
+  // A retried request isn't hedged.
+  if (hedge_timer_) {
+    hedge_timer_->disableTimer();
+    hedge_timer_.reset();
+  }
   return true;
 }
 
@@ -949,13 +1130,12 @@ void Filter::doRetry() {
   ASSERT(response_timeout_ || timeout_.global_timeout_.count() == 0);
   ASSERT(!upstream_request_);
   upstream_request_ = std::make_unique<UpstreamRequest>(*this, *conn_pool);
-  upstream_request_->encodeHeaders(!callbacks_->decodingBuffer() && !downstream_trailers_);
+  upstream_request_->encodeHeaders(retained_body_.empty() && !downstream_trailers_);
   // It's possible we got immediately reset.
   if (upstream_request_) {
-    if (callbacks_->decodingBuffer()) {
-      // If we are doing a retry we need to make a copy.
-      Buffer::OwnedImpl copy(*callbacks_->decodingBuffer());
-      upstream_request_->encodeData(copy, !downstream_trailers_);
+    if (!retained_body_.empty()) {
+      // If we are doing a retry the attempt references the retained body.
+      upstream_request_->encodeData(*retainedBody(), !downstream_trailers_);
     }
 
     if (downstream_trailers_) {
@@ -1001,6 +1181,7 @@ Filter::UpstreamRequest::~UpstreamRequest() {
 
 void Filter::UpstreamRequest::decode100ContinueHeaders(Http::HeaderMapPtr&& headers) {
   ASSERT(100 == Http::Utility::getResponseStatus(*headers));
+  parent_.onHedgedResponse(*this);
   parent_.onUpstream100ContinueHeaders(std::move(headers));
 }
 
@@ -1012,6 +1193,7 @@ void Filter::UpstreamRequest::decodeHeaders(Http::HeaderMapPtr&& headers, bool e
   upstream_headers_ = headers.get();
   const uint64_t response_code = Http::Utility::getResponseStatus(*headers);
   stream_info_.response_code_ = static_cast<uint32_t>(response_code);
+  parent_.onHedgedResponse(*this);
   parent_.onUpstreamHeaders(response_code, std::move(headers), end_stream);
 }
 
@@ -1044,6 +1226,7 @@ void Filter::UpstreamRequest::encodeHeaders(bool end_stream) {
   // It's possible for a reset to happen inline within the newStream() call. In this case, we might
   // get deleted inline as well. Only write the returned handle out if it is not nullptr to deal
   // with this case.
+  upstream_timing_.onUpstreamRequestStart(parent_.callbacks_->dispatcher().timeSource());
   Http::ConnectionPool::Cancellable* handle = conn_pool_.newStream(*this, *this);
   if (handle) {
     conn_pool_stream_handle_ = handle;
@@ -1093,7 +1276,9 @@ void Filter::UpstreamRequest::onResetStream(Http::StreamResetReason reason,
   clearRequestEncoder();
   if (!calling_encode_headers_) {
     stream_info_.setResponseFlag(parent_.streamResetReasonToResponseFlag(reason));
-    parent_.onUpstreamReset(reason, transport_failure_reason);
+    if (!parent_.maybeDropHedgedRequest(*this, Http::Code::ServiceUnavailable)) {
+      parent_.onUpstreamReset(reason, transport_failure_reason);
+    }
   } else {
     deferred_reset_reason_ = reason;
   }
@@ -1118,7 +1303,7 @@ void Filter::UpstreamRequest::setupPerTryTimeout() {
   ASSERT(!per_try_timeout_);
   if (parent_.timeout_.per_try_timeout_.count() > 0) {
     per_try_timeout_ =
-        parent_.callbacks_->dispatcher().createTimer([this]() -> void { onPerTryTimeout(); });
+        parent_.callbacks_->dispatcher().createCoarseTimer([this]() -> void { onPerTryTimeout(); });
     per_try_timeout_->enableTimer(parent_.timeout_.per_try_timeout_);
   }
 }
@@ -1134,7 +1319,9 @@ void Filter::UpstreamRequest::onPerTryTimeout() {
     }
     resetStream();
     stream_info_.setResponseFlag(StreamInfo::ResponseFlag::UpstreamRequestTimeout);
-    parent_.onPerTryTimeout();
+    if (!parent_.maybeDropHedgedRequest(*this, parent_.timeout_response_code_)) {
+      parent_.onPerTryTimeout();
+    }
   } else {
     ENVOY_STREAM_LOG(debug,
                      "ignored upstream per try timeout due to already started downstream response",
@@ -1161,11 +1348,26 @@ void Filter::UpstreamRequest::onPoolFailure(Http::ConnectionPool::PoolFailureRea
 }
 
 void Filter::UpstreamRequest::onPoolReady(Http::StreamEncoder& request_encoder,
-                                          Upstream::HostDescriptionConstSharedPtr host) {
+                                          Upstream::HostDescriptionConstSharedPtr host,
+                                          const StreamInfo::StreamInfo& info) {
   ENVOY_STREAM_LOG(debug, "pool ready", *parent_.callbacks_);
 
   // TODO(ggreenway): set upstream local address in the StreamInfo.
   onUpstreamHostSelected(host);
+
+  // The establishment of the connection is only part of the timing of the requests that waited
+  // for it, and not of the ones that reuse it.
+  const StreamInfo::UpstreamTiming& connection_timing = info.upstreamTiming();
+  const absl::optional<MonotonicTime>& connection_ready =
+      connection_timing.upstream_handshake_complete_
+          ? connection_timing.upstream_handshake_complete_
+          : connection_timing.upstream_connect_complete_;
+  if (connection_ready &&
+      connection_ready.value() >= upstream_timing_.upstream_request_start_.value()) {
+    upstream_timing_.upstream_connect_start_ = connection_timing.upstream_connect_start_;
+    upstream_timing_.upstream_connect_complete_ = connection_timing.upstream_connect_complete_;
+    upstream_timing_.upstream_handshake_complete_ = connection_timing.upstream_handshake_complete_;
+  }
   request_encoder.getStream().addCallbacks(*this);
 
   setupPerTryTimeout();
@@ -1182,6 +1384,14 @@ void Filter::UpstreamRequest::onPoolReady(Http::StreamEncoder& request_encoder,
   }
 
   upstream_timing_.onFirstUpstreamTxByteSent(parent_.callbacks_->dispatcher().timeSource());
+  if (parent_.config_.emit_dynamic_stats_ && !parent_.callbacks_->streamInfo().healthCheck()) {
+    parent_.cluster_->statsScope()
+        .histogram("upstream_rq_pool_wait_ms")
+        .recordValue(std::chrono::duration_cast<std::chrono::milliseconds>(
+                         upstream_timing_.first_upstream_tx_byte_sent_.value() -
+                         upstream_timing_.upstream_request_start_.value())
+                         .count());
+  }
   request_encoder.encodeHeaders(*parent_.downstream_headers_,
                                 !buffered_request_body_ && encode_complete_ && !encode_trailers_);
   calling_encode_headers_ = false;
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/config/filter/http/router/v2/router.pb.h"
 #include "envoy/http/codec.h"
@@ -22,6 +23,7 @@
 #include "common/common/hash.h"
 #include "common/common/hex.h"
 #include "common/common/logger.h"
+#include "common/common/object_pool.h"
 #include "common/config/well_known_names.h"
 #include "common/http/utility.h"
 #include "common/router/config_impl.h"
@@ -41,7 +43,8 @@ namespace Router {
   COUNTER(rq_redirect)                                                                             \
   COUNTER(rq_direct_response)                                                                      \
   COUNTER(rq_total)                                                                                \
-  COUNTER(rq_reset_after_downstream_response_started)
+  COUNTER(rq_reset_after_downstream_response_started)                                              \
+  COUNTER(rq_retry_shadow_buffer_limit_exceeded)
 // clang-format on
 
 /**
@@ -77,6 +80,32 @@ public:
   static bool shouldShadow(const ShadowPolicy& policy, Runtime::Loader& runtime,
                            uint64_t stable_random);
 
+  /**
+   * Make a copy of data that shares its slices instead of copying the bytes. The slices of the
+   * original are replaced by references to the same storage, which is released once both buffers
+   * are drained.
+   * @param data supplies the data to copy.
+   * @param copy supplies the buffer to add the copy to.
+   */
+  static void shareData(Buffer::Instance& data, Buffer::Instance& copy);
+
+  typedef std::shared_ptr<const Buffer::Instance> RetainedDataConstSharedPtr;
+
+  /**
+   * Retain data in immutable storage that buffers can reference without a copy.
+   * @param data supplies the data to retain. It is drained.
+   * @return RetainedDataConstSharedPtr the retained data.
+   */
+  static RetainedDataConstSharedPtr retainData(Buffer::Instance& data);
+
+  /**
+   * Add references to retained data to a buffer. The retained data is kept alive until the
+   * references are drained.
+   * @param retained supplies the retained data.
+   * @param buffer supplies the buffer to add the references to.
+   */
+  static void referenceData(const RetainedDataConstSharedPtr& retained, Buffer::Instance& buffer);
+
   /**
    * Determine the final timeout to use based on the route as well as the request headers.
    * @param route supplies the request route.
@@ -150,7 +179,7 @@ class Filter : Logger::Loggable<Logger::Id::router>,
 public:
   Filter(FilterConfig& config)
       : config_(config), downstream_response_started_(false), downstream_end_stream_(false),
-        do_shadowing_(false), is_retry_(false),
+        do_shadowing_(false), do_hedging_(false), is_retry_(false), selecting_hedge_host_(false),
         attempting_internal_redirect_with_complete_stream_(false) {}
 
   ~Filter();
@@ -209,6 +238,11 @@ public:
   const Http::HeaderMap* downstreamHeaders() const override { return downstream_headers_; }
 
   bool shouldSelectAnotherHost(const Upstream::Host& host) override {
+    // A hedged request avoids the host of the request it hedges.
+    if (selecting_hedge_host_) {
+      return upstream_request_->upstream_host_.get() == &host;
+    }
+
     // We only care about host selection when performing a retry, at which point we consult the
     // RetryState to see if we're configured to avoid certain hosts during retries.
     if (!is_retry_) {
@@ -266,7 +300,8 @@ protected:
   RetryStatePtr retry_state_;
 
 private:
-  struct UpstreamRequest : public Http::StreamDecoder,
+  struct UpstreamRequest : public PooledObject,
+                           public Http::StreamDecoder,
                            public Http::StreamCallbacks,
                            public Http::ConnectionPool::Callbacks {
     UpstreamRequest(Filter& parent, Http::ConnectionPool::Instance& pool);
@@ -314,7 +349,8 @@ private:
                        absl::string_view transport_failure_reason,
                        Upstream::HostDescriptionConstSharedPtr host) override;
     void onPoolReady(Http::StreamEncoder& request_encoder,
-                     Upstream::HostDescriptionConstSharedPtr host) override;
+                     Upstream::HostDescriptionConstSharedPtr host,
+                     const StreamInfo::StreamInfo& info) override;
 
     void setRequestEncoder(Http::StreamEncoder& request_encoder);
     void clearRequestEncoder();
@@ -371,6 +407,17 @@ private:
                                          Upstream::ResourcePriority priority) PURE;
   Http::ConnectionPool::Instance* getConnPool();
   void maybeDoShadowing();
+  void onHedgeTimeout();
+  // Called when an upstream request receives response headers. If the request was hedged, the
+  // first request to respond is kept and the other is cancelled.
+  void onHedgedResponse(UpstreamRequest& upstream_request);
+  // Called when an upstream request fails. If the request was hedged, the failed request is
+  // dropped and the response is left to the other request.
+  // @return bool whether the failed request was dropped.
+  bool maybeDropHedgedRequest(UpstreamRequest& upstream_request, Http::Code code);
+  void resetHedgeRequest();
+  // @return a buffer referencing the retained request body.
+  Buffer::InstancePtr retainedBody() const;
   bool maybeRetryReset(Http::StreamResetReason reset_reason);
   void onPerTryTimeout();
   void onRequestComplete();
@@ -411,6 +458,12 @@ private:
   FilterUtility::TimeoutData timeout_;
   Http::Code timeout_response_code_ = Http::Code::GatewayTimeout;
   UpstreamRequestPtr upstream_request_;
+  // The request hedging upstream_request_ on another host, while both are outstanding.
+  UpstreamRequestPtr hedge_request_;
+  Event::TimerPtr hedge_timer_;
+  ShadowStreamPtr shadow_stream_;
+  // The request body retained for retries and shadowing, in decoding order.
+  std::vector<FilterUtility::RetainedDataConstSharedPtr> retained_body_;
   bool grpc_request_{};
   Http::HeaderMap* downstream_headers_{};
   Http::HeaderMap* downstream_trailers_{};
@@ -424,7 +477,9 @@ private:
   bool downstream_response_started_ : 1;
   bool downstream_end_stream_ : 1;
   bool do_shadowing_ : 1;
+  bool do_hedging_ : 1;
   bool is_retry_ : 1;
+  bool selecting_hedge_host_ : 1;
   bool include_attempt_count_ : 1;
   bool attempting_internal_redirect_with_complete_stream_ : 1;
   uint32_t attempt_count_{1};
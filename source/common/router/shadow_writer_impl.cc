@@ -13,24 +13,118 @@ namespace Router {
 
 void ShadowWriterImpl::shadow(const std::string& cluster, Http::MessagePtr&& request,
                               std::chrono::milliseconds timeout) {
+  if (!prepare(cluster, request->headers())) {
+    return;
+  }
+
+  // This is basically fire and forget. We don't handle cancelling.
+  cm_.httpAsyncClientForCluster(cluster).send(
+      std::move(request), *this, Http::AsyncClient::RequestOptions().setTimeout(timeout));
+}
+
+ShadowStreamPtr ShadowWriterImpl::streamingShadow(const std::string& cluster,
+                                                  Http::HeaderMapPtr&& headers,
+                                                  std::chrono::milliseconds timeout) {
+  if (!prepare(cluster, *headers)) {
+    return nullptr;
+  }
+
+  return std::make_unique<ShadowStreamImpl>(cm_.httpAsyncClientForCluster(cluster),
+                                            std::move(headers), timeout);
+}
+
+bool ShadowWriterImpl::prepare(const std::string& cluster, Http::HeaderMap& headers) {
   // It's possible that the cluster specified in the route configuration no longer exists due
   // to a CDS removal. Check that it still exists before shadowing.
   // TODO(mattklein123): Optimally we would have a stat but for now just fix the crashing issue.
   if (!cm_.get(cluster)) {
     ENVOY_LOG(debug, "shadow cluster '{}' does not exist", cluster);
-    return;
+    return false;
   }
 
-  ASSERT(!request->headers().Host()->value().empty());
+  ASSERT(!headers.Host()->value().empty());
   // Switch authority to add a shadow postfix. This allows upstream logging to make more sense.
-  auto parts = StringUtil::splitToken(request->headers().Host()->value().c_str(), ":");
+  auto parts = StringUtil::splitToken(headers.Host()->value().c_str(), ":");
   ASSERT(parts.size() > 0 && parts.size() <= 2);
-  request->headers().Host()->value(
-      parts.size() == 2 ? absl::StrJoin(parts, "-shadow:")
-                        : absl::StrCat(request->headers().Host()->value().c_str(), "-shadow"));
-  // This is basically fire and forget. We don't handle cancelling.
-  cm_.httpAsyncClientForCluster(cluster).send(
-      std::move(request), *this, Http::AsyncClient::RequestOptions().setTimeout(timeout));
+  headers.Host()->value(parts.size() == 2
+                            ? absl::StrJoin(parts, "-shadow:")
+                            : absl::StrCat(headers.Host()->value().c_str(), "-shadow"));
+  return true;
+}
+
+void ShadowStreamCallbacks::onReset() {
+  if (request_ != nullptr) {
+    request_->callbacks_ = nullptr;
+  }
+  delete this;
+}
+
+void ShadowStreamCallbacks::onResponse(bool end_stream) {
+  if (!end_stream) {
+    return;
+  }
+
+  response_complete_ = true;
+  // Once the request is complete too, the async client stream is done without further callbacks.
+  if (request_ == nullptr) {
+    delete this;
+  }
+}
+
+ShadowStreamImpl::ShadowStreamImpl(Http::AsyncClient& client, Http::HeaderMapPtr&& headers,
+                                   std::chrono::milliseconds timeout)
+    : callbacks_(new ShadowStreamCallbacks(*this, std::move(headers))) {
+  Http::AsyncClient::Stream* stream =
+      client.start(*callbacks_, Http::AsyncClient::StreamOptions().setTimeout(timeout));
+  if (stream == nullptr) {
+    // The callbacks were reset inline.
+    ASSERT(callbacks_ == nullptr);
+    return;
+  }
+
+  callbacks_->stream_ = stream;
+  stream->sendHeaders(*callbacks_->headers_, false);
+}
+
+ShadowStreamImpl::~ShadowStreamImpl() {
+  // The request is not complete, so that the shadow is reset.
+  if (callbacks_ != nullptr) {
+    callbacks_->stream_->reset();
+  }
+}
+
+void ShadowStreamImpl::sendData(Buffer::Instance& data, bool end_stream) {
+  Http::AsyncClient::Stream* stream = this->stream(end_stream);
+  if (stream != nullptr) {
+    stream->sendData(data, end_stream);
+  }
+}
+
+void ShadowStreamImpl::sendTrailers(Http::HeaderMap& trailers) {
+  Http::AsyncClient::Stream* stream = this->stream(true);
+  if (stream != nullptr) {
+    stream->sendTrailers(trailers);
+  }
+}
+
+Http::AsyncClient::Stream* ShadowStreamImpl::stream(bool end_stream) {
+  if (callbacks_ == nullptr) {
+    return nullptr;
+  }
+
+  Http::AsyncClient::Stream* stream = callbacks_->stream_;
+  if (callbacks_->response_complete_) {
+    // The shadow responded before the end of the request, which is then reset rather than sent.
+    stream->reset();
+    ASSERT(callbacks_ == nullptr);
+    return nullptr;
+  }
+
+  if (end_stream) {
+    callbacks_->request_ = nullptr;
+    callbacks_ = nullptr;
+  }
+  return stream;
 }
 
 } // namespace Router
@@ -22,14 +22,79 @@ public:
   // Router::ShadowWriter
   void shadow(const std::string& cluster, Http::MessagePtr&& request,
               std::chrono::milliseconds timeout) override;
+  ShadowStreamPtr streamingShadow(const std::string& cluster, Http::HeaderMapPtr&& headers,
+                                  std::chrono::milliseconds timeout) override;
 
   // Http::AsyncClient::Callbacks
   void onSuccess(Http::MessagePtr&&) override {}
   void onFailure(Http::AsyncClient::FailureReason) override {}
 
 private:
+  /**
+   * @return whether the cluster still exists, after which the host of the headers is switched to
+   *         add a shadow postfix.
+   */
+  bool prepare(const std::string& cluster, Http::HeaderMap& headers);
+
   Upstream::ClusterManager& cm_;
 };
 
+class ShadowStreamImpl;
+
+/**
+ * The async client callbacks of a streaming shadow. They drain the response, and outlive the
+ * ShadowStreamImpl sending a complete request until the response is done, deleting themselves
+ * with the async client stream.
+ */
+class ShadowStreamCallbacks : public Http::AsyncClient::StreamCallbacks {
+public:
+  ShadowStreamCallbacks(ShadowStreamImpl& request, Http::HeaderMapPtr&& headers)
+      : request_(&request), headers_(std::move(headers)) {}
+
+  // Http::AsyncClient::StreamCallbacks
+  void onHeaders(Http::HeaderMapPtr&&, bool end_stream) override { onResponse(end_stream); }
+  void onData(Buffer::Instance&, bool end_stream) override { onResponse(end_stream); }
+  void onTrailers(Http::HeaderMapPtr&&) override { onResponse(true); }
+  void onReset() override;
+
+  // The sender of the request, or nullptr once the request is complete.
+  ShadowStreamImpl* request_;
+  // The async client stream references the request headers until it is done.
+  Http::HeaderMapPtr headers_;
+  Http::AsyncClient::Stream* stream_{};
+  bool response_complete_{};
+
+private:
+  void onResponse(bool end_stream);
+};
+
+/**
+ * Implementation of ShadowStream that sends the request on an async client stream. The stream is
+ * reset when its response completes before the request.
+ */
+class ShadowStreamImpl : public ShadowStream {
+public:
+  ShadowStreamImpl(Http::AsyncClient& client, Http::HeaderMapPtr&& headers,
+                   std::chrono::milliseconds timeout);
+  ~ShadowStreamImpl();
+
+  // Router::ShadowStream
+  void sendData(Buffer::Instance& data, bool end_stream) override;
+  void sendTrailers(Http::HeaderMap& trailers) override;
+
+private:
+  friend class ShadowStreamCallbacks;
+
+  /**
+   * @param end_stream supplies whether the request ends with what is sent next.
+   * @return the stream to send more of the request on, or nullptr if there is none. Once the
+   *         request ends, the callbacks are left to finish on their own.
+   */
+  Http::AsyncClient::Stream* stream(bool end_stream);
+
+  // The callbacks of the stream, or nullptr once the stream is reset or the request is complete.
+  ShadowStreamCallbacks* callbacks_;
+};
+
 } // namespace Router
 } // namespace Envoy
@@ -4,6 +4,7 @@
 #include <random>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "envoy/event/dispatcher.h"
 #include "envoy/thread_local/thread_local.h"
@@ -11,6 +12,7 @@
 
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
+#include "common/common/lock_guard.h"
 #include "common/common/utility.h"
 #include "common/filesystem/directory.h"
 #include "common/protobuf/utility.h"
@@ -32,46 +34,97 @@ bool runtimeFeatureEnabled(const std::string& feature) {
   return RuntimeFeaturesDefaults::get().enabledByDefault(feature);
 }
 
+namespace {
+
+/**
+ * The keys interned by the feature handles.
+ */
+struct FeatureHandleRegistry {
+  Thread::MutexBasicLockable lock_;
+  std::unordered_map<std::string, uint32_t> indices_ GUARDED_BY(lock_);
+  std::vector<std::string> keys_ GUARDED_BY(lock_);
+};
+
+FeatureHandleRegistry& featureHandleRegistry() {
+  // Never destroyed, as handles may be static.
+  static FeatureHandleRegistry* registry = new FeatureHandleRegistry();
+  return *registry;
+}
+
+uint32_t internFeatureKey(const std::string& key) {
+  FeatureHandleRegistry& registry = featureHandleRegistry();
+  Thread::LockGuard lock(registry.lock_);
+  auto it = registry.indices_.emplace(key, registry.keys_.size()).first;
+  if (it->second == registry.keys_.size()) {
+    registry.keys_.push_back(key);
+  }
+  return it->second;
+}
+
+} // namespace
+
+FeatureHandleImpl::FeatureHandleImpl(const std::string& key)
+    : key_(key), index_(internFeatureKey(key)) {}
+
+std::vector<std::string> FeatureHandleImpl::keys() {
+  FeatureHandleRegistry& registry = featureHandleRegistry();
+  Thread::LockGuard lock(registry.lock_);
+  return registry.keys_;
+}
+
 const size_t RandomGeneratorImpl::UUID_LENGTH = 36;
 
-uint64_t RandomGeneratorImpl::random() {
-  // Prefetch 256 * sizeof(uint64_t) bytes of randomness. buffered_idx is initialized to 256,
-  // i.e. out-of-range value, so the buffer will be filled with randomness on the first call
-  // to this function.
-  //
-  // There is a diminishing return when increasing the prefetch size, as illustrated below in
-  // a test that generates 1,000,000,000 uint64_t numbers (results on Intel Xeon E5-1650v3).
-  //
-  // //test/common/runtime:runtime_impl_test - Random.DISABLED_benchmarkRandom
-  //
-  //  prefetch  |  time  | improvement
-  // (uint64_t) |  (ms)  | (% vs prev)
-  // ---------------------------------
-  //         32 | 25,931 |
-  //         64 | 15,124 | 42% faster
-  //        128 |  9,653 | 36% faster
-  //        256 |  6,930 | 28% faster  <-- used right now
-  //        512 |  5,571 | 20% faster
-  //       1024 |  4,888 | 12% faster
-  //       2048 |  4,594 |  6% faster
-  //       4096 |  4,424 |  4% faster
-  //       8192 |  4,386 |  1% faster
-
-  const size_t prefetch = 256;
-  static thread_local uint64_t buffered[prefetch];
-  static thread_local size_t buffered_idx = prefetch;
-
-  if (buffered_idx >= prefetch) {
-    int rc = RAND_bytes(reinterpret_cast<uint8_t*>(buffered), sizeof(buffered));
-    ASSERT(rc == 1);
-    buffered_idx = 0;
+namespace {
+
+/**
+ * xoshiro256** generator, see http://xoshiro.di.unimi.it/xoshiro256starstar.c. It is much faster
+ * than reading prefetched randomness from BoringSSL, which random() used to do, and is good enough
+ * for the non-cryptographic uses of random(): load balancing, sampling, jitter and IDs.
+ */
+class Xoshiro256 {
+public:
+  Xoshiro256() {
+    // The state must not be all zeros.
+    do {
+      int rc = RAND_bytes(reinterpret_cast<uint8_t*>(state_), sizeof(state_));
+      ASSERT(rc == 1);
+    } while ((state_[0] | state_[1] | state_[2] | state_[3]) == 0);
+  }
+
+  uint64_t next() {
+    const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+    const uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl(state_[3], 45);
+    return result;
   }
 
-  // Consume uint64_t from the buffer.
-  return buffered[buffered_idx++];
+private:
+  static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  uint64_t state_[4];
+};
+
+} // namespace
+
+uint64_t RandomGeneratorImpl::random() {
+  // Each thread has a generator of its own, seeded on its first call to this function, so that
+  // no lock is needed.
+  static thread_local Xoshiro256 generator;
+  return generator.next();
 }
 
 std::string RandomGeneratorImpl::uuid() {
+  std::string result(UUID_LENGTH, '\0');
+  uuid(&result[0]);
+  return result;
+}
+
+void RandomGeneratorImpl::uuid(char* uuid) {
   // Prefetch 2048 bytes of randomness. buffered_idx is initialized to sizeof(buffered),
   // i.e. out-of-range value, so the buffer will be filled with randomness on the first
   // call to this function.
@@ -113,7 +166,6 @@ std::string RandomGeneratorImpl::uuid() {
 
   // Convert UUID to a string representation, e.g. a121e9e1-feae-4136-9e0e-6fac343d56c9.
   static const char* const hex = "0123456789abcdef";
-  char uuid[UUID_LENGTH];
 
   for (uint8_t i = 0; i < 4; i++) {
     const uint8_t d = rand[i];
@@ -152,8 +204,6 @@ std::string RandomGeneratorImpl::uuid() {
     uuid[2 * i + 4] = hex[d >> 4];
     uuid[2 * i + 5] = hex[d & 0x0f];
   }
-
-  return std::string(uuid, UUID_LENGTH);
 }
 
 bool SnapshotImpl::deprecatedFeatureEnabled(const std::string& key) const {
@@ -187,59 +237,143 @@ bool SnapshotImpl::runtimeFeatureEnabled(const std::string& key) const {
 
 bool SnapshotImpl::featureEnabled(const std::string& key, uint64_t default_value,
                                   uint64_t random_value, uint64_t num_buckets) const {
-  return random_value % num_buckets < std::min(getInteger(key, default_value), num_buckets);
+  return entryFeatureEnabled(find(key), default_value, random_value, num_buckets);
 }
 
 bool SnapshotImpl::featureEnabled(const std::string& key, uint64_t default_value) const {
-  // Avoid PRNG if we know we don't need it.
-  uint64_t cutoff = std::min(getInteger(key, default_value), static_cast<uint64_t>(100));
-  if (cutoff == 0) {
-    return false;
-  } else if (cutoff == 100) {
-    return true;
-  } else {
-    return generator_.random() % 100 < cutoff;
-  }
+  return entryFeatureEnabled(find(key), default_value);
 }
 
 bool SnapshotImpl::featureEnabled(const std::string& key, uint64_t default_value,
                                   uint64_t random_value) const {
-  return featureEnabled(key, default_value, random_value, 100);
+  return entryFeatureEnabled(find(key), default_value, random_value, 100);
 }
 
 const std::string& SnapshotImpl::get(const std::string& key) const {
-  auto entry = values_.find(key);
-  if (entry == values_.end()) {
+  const Entry* entry = find(key);
+  if (entry == nullptr) {
     return EMPTY_STRING;
   } else {
-    return entry->second.raw_string_value_;
+    return entry->raw_string_value_;
   }
 }
 
 bool SnapshotImpl::featureEnabled(const std::string& key,
                                   const envoy::type::FractionalPercent& default_value) const {
-  return featureEnabled(key, default_value, generator_.random());
+  return entryFeatureEnabled(find(key), default_value);
 }
 
 bool SnapshotImpl::featureEnabled(const std::string& key,
                                   const envoy::type::FractionalPercent& default_value,
                                   uint64_t random_value) const {
-  const auto& entry = values_.find(key);
+  return entryFeatureEnabled(find(key), default_value, random_value);
+}
+
+uint64_t SnapshotImpl::getInteger(const std::string& key, uint64_t default_value) const {
+  return entryInteger(find(key), default_value);
+}
+
+bool SnapshotImpl::featureEnabled(const FeatureHandle& handle, uint64_t default_value) const {
+  return entryFeatureEnabled(find(handle), default_value);
+}
+
+bool SnapshotImpl::featureEnabled(const FeatureHandle& handle, uint64_t default_value,
+                                  uint64_t random_value) const {
+  return entryFeatureEnabled(find(handle), default_value, random_value, 100);
+}
+
+bool SnapshotImpl::featureEnabled(const FeatureHandle& handle, uint64_t default_value,
+                                  uint64_t random_value, uint64_t num_buckets) const {
+  return entryFeatureEnabled(find(handle), default_value, random_value, num_buckets);
+}
+
+bool SnapshotImpl::featureEnabled(const FeatureHandle& handle,
+                                  const envoy::type::FractionalPercent& default_value) const {
+  return entryFeatureEnabled(find(handle), default_value);
+}
+
+bool SnapshotImpl::featureEnabled(const FeatureHandle& handle,
+                                  const envoy::type::FractionalPercent& default_value,
+                                  uint64_t random_value) const {
+  return entryFeatureEnabled(find(handle), default_value, random_value);
+}
+
+uint64_t SnapshotImpl::getInteger(const FeatureHandle& handle, uint64_t default_value) const {
+  return entryInteger(find(handle), default_value);
+}
+
+bool SnapshotImpl::getBoolean(const std::string& key, bool& value) const {
+  const Entry* entry = find(key);
+  if (entry != nullptr && entry->bool_value_.has_value()) {
+    value = entry->bool_value_.value();
+    return true;
+  }
+  return false;
+}
+
+const Snapshot::Entry* SnapshotImpl::find(const std::string& key) const {
+  auto entry = values_.find(key);
+  return entry == values_.end() ? nullptr : &entry->second;
+}
+
+const Snapshot::Entry* SnapshotImpl::find(const FeatureHandle& handle) const {
+  if (handle.index() < handle_entries_.size()) {
+    return handle_entries_[handle.index()];
+  }
+  // The key was interned after the snapshot was created.
+  return find(handle.key());
+}
+
+bool SnapshotImpl::entryFeatureEnabled(const Entry* entry, uint64_t default_value) const {
+  // Avoid PRNG if we know we don't need it.
+  uint64_t cutoff = std::min(entryInteger(entry, default_value), static_cast<uint64_t>(100));
+  if (cutoff == 0) {
+    return false;
+  } else if (cutoff == 100) {
+    return true;
+  } else {
+    return generator_.random() % 100 < cutoff;
+  }
+}
+
+bool SnapshotImpl::entryFeatureEnabled(const Entry* entry, uint64_t default_value,
+                                       uint64_t random_value, uint64_t num_buckets) {
+  return random_value % num_buckets < std::min(entryInteger(entry, default_value), num_buckets);
+}
+
+bool SnapshotImpl::entryFeatureEnabled(const Entry* entry,
+                                       const envoy::type::FractionalPercent& default_value) const {
+  // Avoid PRNG if we know we don't need it, e.g. for the features that are sampled at 0%.
+  uint64_t numerator = default_value.numerator();
+  if (entry != nullptr && entry->fractional_percent_value_.has_value()) {
+    numerator = entry->fractional_percent_value_.value().numerator();
+  } else if (entry != nullptr && entry->uint_value_.has_value()) {
+    numerator = entry->uint_value_.value();
+  }
+  if (numerator == 0) {
+    return false;
+  }
+  return entryFeatureEnabled(entry, default_value, generator_.random());
+}
+
+bool SnapshotImpl::entryFeatureEnabled(const Entry* entry,
+                                       const envoy::type::FractionalPercent& default_value,
+                                       uint64_t random_value) {
   envoy::type::FractionalPercent percent;
-  if (entry != values_.end() && entry->second.fractional_percent_value_.has_value()) {
-    percent = entry->second.fractional_percent_value_.value();
-  } else if (entry != values_.end() && entry->second.uint_value_.has_value()) {
+  if (entry != nullptr && entry->fractional_percent_value_.has_value()) {
+    percent = entry->fractional_percent_value_.value();
+  } else if (entry != nullptr && entry->uint_value_.has_value()) {
     // Check for > 100 because the runtime value is assumed to be specified as
     // an integer, and it also ensures that truncating the uint64_t runtime
     // value into a uint32_t percent numerator later is safe
-    if (entry->second.uint_value_.value() > 100) {
+    if (entry->uint_value_.value() > 100) {
       return true;
     }
 
     // The runtime value was specified as an integer rather than a fractional
     // percent proto. To preserve legacy semantics, we treat it as a percentage
     // (i.e. denominator of 100).
-    percent.set_numerator(entry->second.uint_value_.value());
+    percent.set_numerator(entry->uint_value_.value());
     percent.set_denominator(envoy::type::FractionalPercent::HUNDRED);
   } else {
     percent = default_value;
@@ -248,22 +382,12 @@ bool SnapshotImpl::featureEnabled(const std::string& key,
   return ProtobufPercentHelper::evaluateFractionalPercent(percent, random_value);
 }
 
-uint64_t SnapshotImpl::getInteger(const std::string& key, uint64_t default_value) const {
-  auto entry = values_.find(key);
-  if (entry == values_.end() || !entry->second.uint_value_) {
+uint64_t SnapshotImpl::entryInteger(const Entry* entry, uint64_t default_value) {
+  if (entry == nullptr || !entry->uint_value_) {
     return default_value;
   } else {
-    return entry->second.uint_value_.value();
-  }
-}
-
-bool SnapshotImpl::getBoolean(const std::string& key, bool& value) const {
-  auto entry = values_.find(key);
-  if (entry != values_.end() && entry->second.bool_value_.has_value()) {
-    value = entry->second.bool_value_.value();
-    return true;
+    return entry->uint_value_.value();
   }
-  return false;
 }
 
 const std::vector<Snapshot::OverrideLayerConstPtr>& SnapshotImpl::getLayers() const {
@@ -280,6 +404,12 @@ SnapshotImpl::SnapshotImpl(RandomGenerator& generator, RuntimeStats& stats,
     }
   }
   stats.num_keys_.set(values_.size());
+
+  const std::vector<std::string> keys = FeatureHandleImpl::keys();
+  handle_entries_.reserve(keys.size());
+  for (const std::string& key : keys) {
+    handle_entries_.push_back(find(key));
+  }
 }
 
 SnapshotImpl::Entry SnapshotImpl::createEntry(const std::string& value) {
@@ -29,18 +29,41 @@ bool runtimeFeatureEnabled(const std::string& feature);
 using RuntimeSingleton = ThreadSafeSingleton<Loader>;
 
 /**
- * Implementation of RandomGenerator that uses per-thread RANLUX generators seeded with current
- * time.
+ * Implementation of RandomGenerator that uses per-thread xoshiro256** generators seeded from the
+ * OS for random numbers, and randomness buffered per thread from BoringSSL for UUIDs.
  */
 class RandomGeneratorImpl : public RandomGenerator {
 public:
   // Runtime::RandomGenerator
   uint64_t random() override;
   std::string uuid() override;
+  void uuid(char* buffer) override;
 
   static const size_t UUID_LENGTH;
 };
 
+/**
+ * Implementation of FeatureHandle that interns its key in a process wide registry. The index of a
+ * key is the same for all the handles of the key, and keys are never removed from the registry.
+ */
+class FeatureHandleImpl : public FeatureHandle {
+public:
+  explicit FeatureHandleImpl(const std::string& key);
+
+  // Runtime::FeatureHandle
+  const std::string& key() const override { return key_; }
+  uint32_t index() const override { return index_; }
+
+  /**
+   * @return std::vector<std::string> the interned keys, ordered by index.
+   */
+  static std::vector<std::string> keys();
+
+private:
+  const std::string key_;
+  const uint32_t index_;
+};
+
 /**
  * All runtime stats. @see stats_macros.h
  */
@@ -86,6 +109,17 @@ public:
                       uint64_t random_value) const override;
   const std::string& get(const std::string& key) const override;
   uint64_t getInteger(const std::string& key, uint64_t default_value) const override;
+  bool featureEnabled(const FeatureHandle& handle, uint64_t default_value) const override;
+  bool featureEnabled(const FeatureHandle& handle, uint64_t default_value,
+                      uint64_t random_value) const override;
+  bool featureEnabled(const FeatureHandle& handle, uint64_t default_value, uint64_t random_value,
+                      uint64_t num_buckets) const override;
+  bool featureEnabled(const FeatureHandle& handle,
+                      const envoy::type::FractionalPercent& default_value) const override;
+  bool featureEnabled(const FeatureHandle& handle,
+                      const envoy::type::FractionalPercent& default_value,
+                      uint64_t random_value) const override;
+  uint64_t getInteger(const FeatureHandle& handle, uint64_t default_value) const override;
   const std::vector<OverrideLayerConstPtr>& getLayers() const override;
 
   static Entry createEntry(const std::string& value);
@@ -109,8 +143,23 @@ private:
   static bool parseEntryUintValue(Entry& entry);
   static void parseEntryFractionalPercentValue(Entry& entry);
 
+  const Entry* find(const std::string& key) const;
+  const Entry* find(const FeatureHandle& handle) const;
+  bool entryFeatureEnabled(const Entry* entry, uint64_t default_value) const;
+  bool entryFeatureEnabled(const Entry* entry,
+                           const envoy::type::FractionalPercent& default_value) const;
+  static bool entryFeatureEnabled(const Entry* entry, uint64_t default_value,
+                                  uint64_t random_value, uint64_t num_buckets);
+  static bool entryFeatureEnabled(const Entry* entry,
+                                  const envoy::type::FractionalPercent& default_value,
+                                  uint64_t random_value);
+  static uint64_t entryInteger(const Entry* entry, uint64_t default_value);
+
   const std::vector<OverrideLayerConstPtr> layers_;
   EntryMap values_;
+  // The entries of the keys interned when the snapshot was created, by handle index. Keys without
+  // a value have a null entry.
+  std::vector<const Entry*> handle_entries_;
   RandomGenerator& generator_;
   RuntimeStats& stats_;
 };
@@ -22,10 +22,8 @@ SdsApi::SdsApi(const LocalInfo::LocalInfo& local_info, Event::Dispatcher& dispat
       cluster_manager_(cluster_manager), sds_config_(sds_config), sds_config_name_(sds_config_name),
       secret_hash_(0), clean_up_(destructor_cb), api_(api) {
   Config::Utility::checkLocalInfo("sds", local_info_);
-  // TODO(JimmyCYJ): Implement chained_init_manager, so that multiple init_manager
-  // can be chained together to behave as one init_manager. In that way, we let
-  // two listeners which share same SdsApi to register at separate init managers, and
-  // each init manager has a chance to initialize its targets.
+  // The listeners and clusters that share this SdsApi register the same target with their own init
+  // managers, see registerInitTarget().
   init_manager.add(init_target_);
 }
 
@@ -38,7 +36,6 @@ void SdsApi::onConfigUpdate(const ResourceVector& resources, const std::string&)
     throw EnvoyException(fmt::format("Unexpected SDS secrets length: {}", resources.size()));
   }
   const auto& secret = resources[0];
-  MessageUtil::validate(secret);
 
   // Wrap sds_config_name_ in string_view to deal with proto string/std::string incompatibility
   // issues within Google.
@@ -47,8 +44,10 @@ void SdsApi::onConfigUpdate(const ResourceVector& resources, const std::string&)
         fmt::format("Unexpected SDS secret (expecting {}): {}", sds_config_name_, secret.name()));
   }
 
+  // The current secret passed validation, so only a changed secret needs to be validated.
   const uint64_t new_hash = MessageUtil::hash(secret);
   if (new_hash != secret_hash_) {
+    MessageUtil::validate(secret);
     validateConfig(secret);
     secret_hash_ = new_hash;
     setSecret(secret);
@@ -36,6 +36,13 @@ public:
          const envoy::api::v2::core::ConfigSource& sds_config, const std::string& sds_config_name,
          std::function<void()> destructor_cb, Api::Api& api);
 
+  /**
+   * Makes another init manager, e.g. the one of a listener sharing this SdsApi with the listener
+   * that created it, wait for the secret to be fetched.
+   * @param init_manager supplies the init manager to register with.
+   */
+  void registerInitTarget(Init::Manager& init_manager) { init_manager.add(init_target_); }
+
   // Config::SubscriptionCallbacks
   // TODO(fredlas) deduplicate
   void onConfigUpdate(const ResourceVector& resources, const std::string& version_info) override;
@@ -56,7 +63,7 @@ protected:
 
 private:
   void initialize();
-  Init::TargetImpl init_target_;
+  Init::SharedTargetImpl init_target_;
   const LocalInfo::LocalInfo& local_info_;
   Event::Dispatcher& dispatcher_;
   Runtime::RandomGenerator& random_;
@@ -74,9 +81,11 @@ private:
 
 class TlsCertificateSdsApi;
 class CertificateValidationContextSdsApi;
+class TlsSessionTicketKeysSdsApi;
 typedef std::shared_ptr<TlsCertificateSdsApi> TlsCertificateSdsApiSharedPtr;
 typedef std::shared_ptr<CertificateValidationContextSdsApi>
     CertificateValidationContextSdsApiSharedPtr;
+typedef std::shared_ptr<TlsSessionTicketKeysSdsApi> TlsSessionTicketKeysSdsApiSharedPtr;
 
 /**
  * TlsCertificateSdsApi implementation maintains and updates dynamic TLS certificate secrets.
@@ -180,5 +189,65 @@ private:
       validation_callback_manager_;
 };
 
+/**
+ * TlsSessionTicketKeysSdsApi implementation maintains and updates dynamic TLS session ticket keys
+ * secrets.
+ */
+class TlsSessionTicketKeysSdsApi : public SdsApi, public TlsSessionTicketKeysConfigProvider {
+public:
+  static TlsSessionTicketKeysSdsApiSharedPtr
+  create(Server::Configuration::TransportSocketFactoryContext& secret_provider_context,
+         const envoy::api::v2::core::ConfigSource& sds_config, const std::string& sds_config_name,
+         std::function<void()> destructor_cb) {
+    return std::make_shared<TlsSessionTicketKeysSdsApi>(
+        secret_provider_context.localInfo(), secret_provider_context.dispatcher(),
+        secret_provider_context.random(), secret_provider_context.stats(),
+        secret_provider_context.clusterManager(), *secret_provider_context.initManager(),
+        sds_config, sds_config_name, destructor_cb, secret_provider_context.api());
+  }
+
+  TlsSessionTicketKeysSdsApi(const LocalInfo::LocalInfo& local_info, Event::Dispatcher& dispatcher,
+                             Runtime::RandomGenerator& random, Stats::Store& stats,
+                             Upstream::ClusterManager& cluster_manager, Init::Manager& init_manager,
+                             const envoy::api::v2::core::ConfigSource& sds_config,
+                             const std::string& sds_config_name,
+                             std::function<void()> destructor_cb, Api::Api& api)
+      : SdsApi(local_info, dispatcher, random, stats, cluster_manager, init_manager, sds_config,
+               sds_config_name, destructor_cb, api) {}
+
+  // SecretProvider
+  const envoy::api::v2::auth::TlsSessionTicketKeys* secret() const override {
+    return session_ticket_keys_secrets_.get();
+  }
+  Common::CallbackHandle* addUpdateCallback(std::function<void()> callback) override {
+    return update_callback_manager_.add(callback);
+  }
+
+  /**
+   * Add a callback that validates the session ticket keys of an update before it is accepted.
+   * @param callback supplies the callback, which throws an EnvoyException if the keys are invalid.
+   * @return CallbackHandle the handle which can remove the callback.
+   */
+  Common::CallbackHandle* addValidationCallback(
+      std::function<void(const envoy::api::v2::auth::TlsSessionTicketKeys&)> callback) {
+    return validation_callback_manager_.add(callback);
+  }
+
+protected:
+  void setSecret(const envoy::api::v2::auth::Secret& secret) override {
+    session_ticket_keys_secrets_ =
+        std::make_unique<envoy::api::v2::auth::TlsSessionTicketKeys>(secret.session_ticket_keys());
+  }
+
+  void validateConfig(const envoy::api::v2::auth::Secret& secret) override {
+    validation_callback_manager_.runCallbacks(secret.session_ticket_keys());
+  }
+
+private:
+  TlsSessionTicketKeysPtr session_ticket_keys_secrets_;
+  Common::CallbackManager<const envoy::api::v2::auth::TlsSessionTicketKeys&>
+      validation_callback_manager_;
+};
+
 } // namespace Secret
 } // namespace Envoy
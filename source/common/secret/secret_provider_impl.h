@@ -40,5 +40,20 @@ private:
   Secret::CertificateValidationContextPtr certificate_validation_context_;
 };
 
+class TlsSessionTicketKeysConfigProviderImpl : public TlsSessionTicketKeysConfigProvider {
+public:
+  TlsSessionTicketKeysConfigProviderImpl(
+      const envoy::api::v2::auth::TlsSessionTicketKeys& session_ticket_keys);
+
+  const envoy::api::v2::auth::TlsSessionTicketKeys* secret() const override {
+    return session_ticket_keys_.get();
+  }
+
+  Common::CallbackHandle* addUpdateCallback(std::function<void()>) override { return nullptr; }
+
+private:
+  Secret::TlsSessionTicketKeysPtr session_ticket_keys_;
+};
+
 } // namespace Secret
 } // namespace Envoy
@@ -1,6 +1,7 @@
 #include "common/ssl/tls_certificate_config_impl.h"
 
 #include "envoy/common/exception.h"
+#include "envoy/server/transport_socket_config.h"
 
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
@@ -12,7 +13,8 @@ namespace Ssl {
 static const std::string INLINE_STRING = "<inline>";
 
 TlsCertificateConfigImpl::TlsCertificateConfigImpl(
-    const envoy::api::v2::auth::TlsCertificate& config, Api::Api& api)
+    const envoy::api::v2::auth::TlsCertificate& config,
+    Server::Configuration::TransportSocketFactoryContext* factory_context, Api::Api& api)
     : certificate_chain_(Config::DataSource::read(config.certificate_chain(), true, api)),
       certificate_chain_path_(
           Config::DataSource::getPath(config.certificate_chain())
@@ -23,8 +25,24 @@ TlsCertificateConfigImpl::TlsCertificateConfigImpl(
       password_(Config::DataSource::read(config.password(), true, api)),
       password_path_(Config::DataSource::getPath(config.password())
                          .value_or(password_.empty() ? EMPTY_STRING : INLINE_STRING)) {
+  if (config.has_private_key_provider()) {
+    if (config.has_private_key()) {
+      throw EnvoyException(fmt::format(
+          "Certificate configuration can't have both private_key and private_key_provider"));
+    }
+    if (factory_context != nullptr) {
+      private_key_method_ =
+          factory_context->sslContextManager()
+              .privateKeyMethodManager()
+              .createPrivateKeyMethodProvider(config.private_key_provider(), *factory_context);
+    }
+    if (private_key_method_ == nullptr) {
+      throw EnvoyException(fmt::format("Failed to load private key provider: {}",
+                                       config.private_key_provider().provider_name()));
+    }
+  }
 
-  if (certificate_chain_.empty() || private_key_.empty()) {
+  if (certificate_chain_.empty() || (private_key_.empty() && private_key_method_ == nullptr)) {
     throw EnvoyException(fmt::format("Failed to load incomplete certificate from {}, {}",
                                      certificate_chain_path_, private_key_path_));
   }
@@ -2,14 +2,12 @@
 
 #include "common/common/lock_guard.h"
 #include "common/common/thread.h"
-#include "common/common/utility.h"
+#include "common/memory/accounting.h"
 
 namespace Envoy {
 namespace Stats {
 
-HeapStatData::HeapStatData(absl::string_view key) {
-  StringUtil::strlcpy(name_, key.data(), key.size() + 1);
-}
+HeapStatData::HeapStatData(SymbolEncoding& encoding) { encoding.moveToStorage(symbol_storage_); }
 
 HeapStatDataAllocator::~HeapStatDataAllocator() { ASSERT(stats_.empty()); }
 
@@ -18,8 +16,9 @@ HeapStatData* HeapStatDataAllocator::alloc(absl::string_view name) {
   // required to use this allocator. Note that data must be freed by calling
   // its free() method, and not by destruction, thus the more complex use of
   // unique_ptr.
+  SymbolEncoding encoding = symbolTable().encode(name);
   std::unique_ptr<HeapStatData, std::function<void(HeapStatData * d)>> data(
-      HeapStatData::alloc(name), [](HeapStatData* d) { d->free(); });
+      HeapStatData::alloc(encoding), [](HeapStatData* d) { d->free(); });
   Thread::ReleasableLockGuard lock(mutex_);
   auto ret = stats_.insert(data.get());
   HeapStatData* existing_data = *ret.first;
@@ -29,6 +28,10 @@ HeapStatData* HeapStatDataAllocator::alloc(absl::string_view name) {
     return data.release();
   }
   ++existing_data->ref_count_;
+
+  // The existing data already holds references to the symbols, so drop the ones
+  // taken when encoding the name for the lookup.
+  symbolTable().free(data->statName());
   return existing_data;
 }
 
@@ -44,16 +47,21 @@ void HeapStatDataAllocator::free(HeapStatData& data) {
     ASSERT(key_removed == 1);
   }
 
+  symbolTable().free(data.statName());
   data.free();
 }
 
-HeapStatData* HeapStatData::alloc(absl::string_view name) {
-  void* memory = ::malloc(sizeof(HeapStatData) + name.size() + 1);
+HeapStatData* HeapStatData::alloc(SymbolEncoding& encoding) {
+  const uint64_t bytes = sizeof(HeapStatData) + encoding.bytesRequired();
+  void* memory = ::malloc(bytes);
   ASSERT(memory);
-  return new (memory) HeapStatData(name);
+  Memory::Accounting::allocated(Memory::AccountingTag::Stats, bytes);
+  return new (memory) HeapStatData(encoding);
 }
 
 void HeapStatData::free() {
+  Memory::Accounting::released(Memory::AccountingTag::Stats,
+                               sizeof(HeapStatData) + statName().size());
   this->~HeapStatData();
   ::free(this); // matches malloc() call above.
 }
@@ -10,6 +10,7 @@
 #include "common/common/thread.h"
 #include "common/common/thread_annotations.h"
 #include "common/stats/stat_data_allocator_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "absl/container/flat_hash_set.h"
 
@@ -22,30 +23,30 @@ namespace Stats {
  */
 struct HeapStatData {
   /**
-   * @returns absl::string_view the name as a string_view.
+   * @returns StatName the symbolized name, which is held inline in this structure.
    */
-  absl::string_view key() const { return name_; }
+  StatName statName() const { return StatName(symbol_storage_); }
 
   /**
-   * @returns std::string the name as a const char*.
+   * Allocates a HeapStatData holding the encoded name. The references to the
+   * symbols taken by encoding are transferred to the HeapStatData, and must be
+   * released via SymbolTable::free(statName()) prior to free().
    */
-  const char* name() const { return name_; }
-
-  static HeapStatData* alloc(absl::string_view name);
+  static HeapStatData* alloc(SymbolEncoding& encoding);
   void free();
 
   std::atomic<uint64_t> value_{0};
   std::atomic<uint64_t> pending_increment_{0};
   std::atomic<uint16_t> flags_{0};
   std::atomic<uint16_t> ref_count_{1};
-  char name_[];
+  SymbolTable::Storage symbol_storage_;
 
 private:
   /**
    * You cannot construct/destruct a HeapStatData directly with new/delete as
    * it's variable-size. Use alloc()/free() methods above.
    */
-  explicit HeapStatData(absl::string_view name);
+  explicit HeapStatData(SymbolEncoding& encoding);
   ~HeapStatData() {}
 };
 
@@ -61,26 +62,24 @@ public:
   // StatDataAllocatorImpl
   HeapStatData* alloc(absl::string_view name) override;
   void free(HeapStatData& data) override;
+  StatName statName(const HeapStatData& data) const override { return data.statName(); }
 
   // StatDataAllocator
   bool requiresBoundedStatNameSize() const override { return false; }
 
 private:
   struct HeapStatHash {
-    size_t operator()(const HeapStatData* a) const { return HashUtil::xxHash64(a->key()); }
+    size_t operator()(const HeapStatData* a) const { return a->statName().hash(); }
   };
   struct HeapStatCompare {
     bool operator()(const HeapStatData* a, const HeapStatData* b) const {
-      return (a->key() == b->key());
+      return (a->statName() == b->statName());
     }
   };
 
-  // TODO(jmarantz): See https://github.com/envoyproxy/envoy/pull/3927 and
-  //  https://github.com/envoyproxy/envoy/issues/3585, which can help reorganize
-  // the heap stats using a ref-counted symbol table to compress the stat strings.
   using StatSet = absl::flat_hash_set<HeapStatData*, HeapStatHash, HeapStatCompare>;
 
-  // An unordered set of HeapStatData pointers which keys off the key()
+  // An unordered set of HeapStatData pointers which keys off the statName()
   // field in each object. This necessitates a custom comparator and hasher.
   StatSet stats_ GUARDED_BY(mutex_);
   // A mutex is needed here to protect the stats_ object from both alloc() and free() operations.
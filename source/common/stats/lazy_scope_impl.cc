@@ -0,0 +1,41 @@
+#include "common/stats/lazy_scope_impl.h"
+
+#include <string>
+#include <unordered_set>
+
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Stats {
+
+namespace {
+
+// The names passed to lazy scopes come from the stats macros, so there are only a handful of
+// distinct ones across all scopes. Interning them keeps each lazy stat to a few pointers.
+const std::string& internName(const std::string& name) {
+  static Thread::MutexBasicLockable* mutex = new Thread::MutexBasicLockable();
+  static std::unordered_set<std::string>* names = new std::unordered_set<std::string>();
+  Thread::LockGuard lock(*mutex);
+  return *names->insert(name).first;
+}
+
+} // namespace
+
+Counter& LazyScopeImpl::counter(const std::string& name) {
+  counters_.emplace_back(scope_, internName(name));
+  return counters_.back();
+}
+
+Gauge& LazyScopeImpl::gauge(const std::string& name) {
+  gauges_.emplace_back(scope_, internName(name));
+  return gauges_.back();
+}
+
+Histogram& LazyScopeImpl::histogram(const std::string& name) {
+  histograms_.emplace_back(scope_, internName(name));
+  return histograms_.back();
+}
+
+} // namespace Stats
+} // namespace Envoy
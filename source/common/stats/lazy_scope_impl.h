@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "envoy/stats/histogram.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats.h"
+
+#include "common/stats/symbol_table_impl.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Base for the lazy stats handed out by LazyScopeImpl. The underlying stat is looked up in the
+ * wrapped scope on first write, or when its name or tags are needed. Reads of a stat that has not
+ * been created yet see an unused, zero-valued stat, exactly as a freshly created stat would.
+ *
+ * Concurrent first writers may each look the stat up, which is harmless as scopes return the same
+ * stat for the same name.
+ */
+template <class StatType, StatType& (Scope::*Lookup)(const std::string&)>
+class LazyStatImpl : public StatType {
+public:
+  LazyStatImpl(Scope& scope, const std::string& name) : scope_(scope), name_(name) {}
+
+  // Stats::Metric
+  std::string name() const override { return stat().name(); }
+  StatName statName() const override { return stat().statName(); }
+  const std::vector<Tag>& tags() const override { return stat().tags(); }
+  const std::string& tagExtractedName() const override { return stat().tagExtractedName(); }
+  bool used() const override {
+    StatType* stat = stat_.load(std::memory_order_acquire);
+    return stat != nullptr && stat->used();
+  }
+
+protected:
+  StatType& stat() const {
+    StatType* stat = stat_.load(std::memory_order_acquire);
+    if (stat == nullptr) {
+      stat = &(scope_.*Lookup)(name_);
+      stat_.store(stat, std::memory_order_release);
+    }
+    return *stat;
+  }
+
+  StatType* statIfCreated() const { return stat_.load(std::memory_order_acquire); }
+
+private:
+  Scope& scope_;
+  const std::string& name_;
+  mutable std::atomic<StatType*> stat_{nullptr};
+};
+
+class LazyCounterImpl : public LazyStatImpl<Counter, &Scope::counter> {
+public:
+  using LazyStatImpl::LazyStatImpl;
+
+  // Stats::Counter
+  void add(uint64_t amount) override { stat().add(amount); }
+  void inc() override { stat().inc(); }
+  uint64_t latch() override {
+    Counter* counter = statIfCreated();
+    return counter != nullptr ? counter->latch() : 0;
+  }
+  void reset() override {
+    Counter* counter = statIfCreated();
+    if (counter != nullptr) {
+      counter->reset();
+    }
+  }
+  uint64_t value() const override {
+    Counter* counter = statIfCreated();
+    return counter != nullptr ? counter->value() : 0;
+  }
+};
+
+class LazyGaugeImpl : public LazyStatImpl<Gauge, &Scope::gauge> {
+public:
+  using LazyStatImpl::LazyStatImpl;
+
+  // Stats::Gauge
+  void add(uint64_t amount) override { stat().add(amount); }
+  void dec() override { stat().dec(); }
+  void inc() override { stat().inc(); }
+  void set(uint64_t value) override { stat().set(value); }
+  void sub(uint64_t amount) override { stat().sub(amount); }
+  uint64_t value() const override {
+    Gauge* gauge = statIfCreated();
+    return gauge != nullptr ? gauge->value() : 0;
+  }
+};
+
+class LazyHistogramImpl : public LazyStatImpl<Histogram, &Scope::histogram> {
+public:
+  using LazyStatImpl::LazyStatImpl;
+
+  // Stats::Histogram
+  void recordValue(uint64_t value) override { stat().recordValue(value); }
+};
+
+/**
+ * A scope that defers creating stats in the wrapped scope until they are first written. This is
+ * meant for building strongly named stats structs (see stats_macros.h) for objects that may never
+ * see traffic, such as clusters: a stat that is never written costs a small proxy rather than a
+ * full stat, and does not show up in the store.
+ *
+ * Each call returns a new proxy, so callers should look a name up once and hold the reference, as
+ * the stats structs do. The wrapped scope must outlive this scope. Scopes created from this scope
+ * are not lazy.
+ */
+class LazyScopeImpl : public Scope {
+public:
+  explicit LazyScopeImpl(Scope& scope) : scope_(scope) {}
+
+  // Stats::Scope
+  ScopePtr createScope(const std::string& name) override { return scope_.createScope(name); }
+  void deliverHistogramToSinks(const Histogram& histogram, uint64_t value) override {
+    scope_.deliverHistogramToSinks(histogram, value);
+  }
+  Counter& counter(const std::string& name) override;
+  Gauge& gauge(const std::string& name) override;
+  NullGaugeImpl& nullGauge(const std::string& name) override { return scope_.nullGauge(name); }
+  Histogram& histogram(const std::string& name) override;
+  const Stats::StatsOptions& statsOptions() const override { return scope_.statsOptions(); }
+  const SymbolTable& symbolTable() const override { return scope_.symbolTable(); }
+  SymbolTable& symbolTable() override { return scope_.symbolTable(); }
+
+private:
+  Scope& scope_;
+  std::deque<LazyCounterImpl> counters_;
+  std::deque<LazyGaugeImpl> gauges_;
+  std::deque<LazyHistogramImpl> histograms_;
+};
+
+} // namespace Stats
+} // namespace Envoy
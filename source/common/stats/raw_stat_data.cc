@@ -64,12 +64,25 @@ Stats::RawStatData* RawStatDataAllocator::alloc(absl::string_view name) {
   if (!value_created.second) {
     ++data->ref_count_;
   }
+  auto local = stat_names_.find(data);
+  if (local == stat_names_.end()) {
+    stat_names_.emplace(data, LocalStatName{StatNameStorage(data->key(), symbolTable()), 1});
+  } else {
+    ++local->second.ref_count_;
+  }
   return data;
 }
 
 void RawStatDataAllocator::free(Stats::RawStatData& data) {
   // We must hold the lock since the reference decrement can race with an initialize above.
   Thread::LockGuard lock(mutex_);
+  auto local = stat_names_.find(&data);
+  ASSERT(local != stat_names_.end());
+  if (--local->second.ref_count_ == 0) {
+    local->second.stat_name_.free(symbolTable());
+    stat_names_.erase(local);
+  }
+
   ASSERT(data.ref_count_ > 0);
   --data.ref_count_;
   if (data.ref_count_ > 0) {
@@ -80,6 +93,13 @@ void RawStatDataAllocator::free(Stats::RawStatData& data) {
   memset(static_cast<void*>(&data), 0, Stats::RawStatData::structSizeWithOptions(options_));
 }
 
+StatName RawStatDataAllocator::statName(const Stats::RawStatData& data) const {
+  Thread::LockGuard lock(mutex_);
+  auto local = stat_names_.find(&data);
+  ASSERT(local != stat_names_.end());
+  return local->second.stat_name_.statName();
+}
+
 template class StatDataAllocatorImpl<RawStatData>;
 
 } // namespace Stats
@@ -20,7 +20,9 @@
 #include "common/common/hash.h"
 #include "common/common/thread.h"
 #include "common/stats/stat_data_allocator_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
@@ -106,10 +108,21 @@ public:
   bool requiresBoundedStatNameSize() const override { return true; }
   Stats::RawStatData* alloc(absl::string_view name) override;
   void free(Stats::RawStatData& data) override;
+  StatName statName(const Stats::RawStatData& data) const override;
 
 private:
+  // The shared-memory block holds nul-terminated names so it can be adopted
+  // across a hot restart, but symbols are local to each process. We keep a
+  // symbolized copy of each name referenced by this process, counting the
+  // references held by this process separately from the shared ref_count_.
+  struct LocalStatName {
+    StatNameStorage stat_name_;
+    uint32_t ref_count_;
+  };
+
   Thread::BasicLockable& mutex_;
   RawStatDataSet& stats_set_ GUARDED_BY(mutex_);
+  absl::flat_hash_map<const RawStatData*, LocalStatName> stat_names_ GUARDED_BY(mutex_);
   const StatsOptions& options_;
 };
 
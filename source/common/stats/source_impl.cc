@@ -5,6 +5,37 @@
 namespace Envoy {
 namespace Stats {
 
+namespace {
+
+/**
+ * Returns the used stats whose value differs from the one recorded in last, and records the
+ * current values in last for next time.
+ */
+template <class StatType, class ValueFn>
+std::vector<std::shared_ptr<StatType>>
+changedStats(const std::vector<std::shared_ptr<StatType>>& stats,
+             SourceImpl::LastValues<StatType>& last, ValueFn value_fn) {
+  std::vector<std::shared_ptr<StatType>> changed;
+  absl::flat_hash_map<const StatType*, uint64_t> values;
+  values.reserve(stats.size());
+  for (const std::shared_ptr<StatType>& stat : stats) {
+    if (!stat->used()) {
+      continue;
+    }
+    const uint64_t value = value_fn(*stat);
+    const auto it = last.values_.find(stat.get());
+    if (it == last.values_.end() || it->second != value) {
+      changed.push_back(stat);
+    }
+    values.emplace(stat.get(), value);
+  }
+  last.stats_ = stats;
+  last.values_ = std::move(values);
+  return changed;
+}
+
+} // namespace
+
 std::vector<CounterSharedPtr>& SourceImpl::cachedCounters() {
   if (!counters_) {
     counters_ = store_.counters();
@@ -24,10 +55,38 @@ std::vector<ParentHistogramSharedPtr>& SourceImpl::cachedHistograms() {
   return *histograms_;
 }
 
+std::vector<CounterSharedPtr>& SourceImpl::cachedChangedCounters() {
+  if (!changed_counters_) {
+    changed_counters_ = changedStats(cachedCounters(), last_counters_,
+                                     [](const Counter& counter) { return counter.value(); });
+  }
+  return *changed_counters_;
+}
+std::vector<GaugeSharedPtr>& SourceImpl::cachedChangedGauges() {
+  if (!changed_gauges_) {
+    changed_gauges_ = changedStats(cachedGauges(), last_gauges_,
+                                   [](const Gauge& gauge) { return gauge.value(); });
+  }
+  return *changed_gauges_;
+}
+std::vector<ParentHistogramSharedPtr>& SourceImpl::cachedChangedHistograms() {
+  if (!changed_histograms_) {
+    // The cumulative sample count only moves when a merge picked up new values.
+    changed_histograms_ =
+        changedStats(cachedHistograms(), last_histograms_, [](const ParentHistogram& histogram) {
+          return static_cast<uint64_t>(histogram.cumulativeStatistics().sampleCount());
+        });
+  }
+  return *changed_histograms_;
+}
+
 void SourceImpl::clearCache() {
   counters_.reset();
   gauges_.reset();
   histograms_.reset();
+  changed_counters_.reset();
+  changed_gauges_.reset();
+  changed_histograms_.reset();
 }
 
 } // namespace Stats
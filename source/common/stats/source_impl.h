@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include "envoy/stats/source.h"
 #include "envoy/stats/stats.h"
 #include "envoy/stats/store.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
@@ -17,13 +21,30 @@ public:
   std::vector<CounterSharedPtr>& cachedCounters() override;
   std::vector<GaugeSharedPtr>& cachedGauges() override;
   std::vector<ParentHistogramSharedPtr>& cachedHistograms() override;
+  std::vector<CounterSharedPtr>& cachedChangedCounters() override;
+  std::vector<GaugeSharedPtr>& cachedChangedGauges() override;
+  std::vector<ParentHistogramSharedPtr>& cachedChangedHistograms() override;
   void clearCache() override;
 
+  // The values of a stat type as of the last time its changed stats were computed. The stats are
+  // held on to as well, so that a deleted stat's address can't be reused by a new one and mistaken
+  // for it.
+  template <class StatType> struct LastValues {
+    std::vector<std::shared_ptr<StatType>> stats_;
+    absl::flat_hash_map<const StatType*, uint64_t> values_;
+  };
+
 private:
   Store& store_;
   absl::optional<std::vector<CounterSharedPtr>> counters_;
   absl::optional<std::vector<GaugeSharedPtr>> gauges_;
   absl::optional<std::vector<ParentHistogramSharedPtr>> histograms_;
+  absl::optional<std::vector<CounterSharedPtr>> changed_counters_;
+  absl::optional<std::vector<GaugeSharedPtr>> changed_gauges_;
+  absl::optional<std::vector<ParentHistogramSharedPtr>> changed_histograms_;
+  LastValues<Counter> last_counters_;
+  LastValues<Gauge> last_gauges_;
+  LastValues<ParentHistogram> last_histograms_;
 };
 
 } // namespace Stats
@@ -9,6 +9,7 @@
 
 #include "common/common/assert.h"
 #include "common/stats/metric_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "absl/strings/string_view.h"
 
@@ -54,6 +55,12 @@ public:
    */
   virtual void free(StatData& data) PURE;
 
+  /**
+   * @param data the data returned by alloc().
+   * @return StatName the symbolized name of the stat, valid until the data is freed.
+   */
+  virtual StatName statName(const StatData& data) const PURE;
+
   SymbolTable& symbolTable() override { return symbol_table_; }
   const SymbolTable& symbolTable() const override { return symbol_table_; }
 
@@ -76,8 +83,8 @@ public:
   ~CounterImpl() { alloc_.free(data_); }
 
   // Stats::Metric
-  std::string name() const override { return std::string(data_.name()); }
-  const char* nameCStr() const override { return data_.name(); }
+  std::string name() const override { return alloc_.symbolTable().toString(statName()); }
+  StatName statName() const override { return alloc_.statName(data_); }
 
   // Stats::Counter
   void add(uint64_t amount) override {
@@ -106,7 +113,7 @@ public:
   NullCounterImpl() {}
   ~NullCounterImpl() {}
   std::string name() const override { return ""; }
-  const char* nameCStr() const override { return ""; }
+  StatName statName() const override { return StatName(); }
   const std::string& tagExtractedName() const override { CONSTRUCT_ON_FIRST_USE(std::string, ""); }
   const std::vector<Tag>& tags() const override { CONSTRUCT_ON_FIRST_USE(std::vector<Tag>, {}); }
   void add(uint64_t) override {}
@@ -128,8 +135,8 @@ public:
   ~GaugeImpl() { alloc_.free(data_); }
 
   // Stats::Metric
-  std::string name() const override { return std::string(data_.name()); }
-  const char* nameCStr() const override { return data_.name(); }
+  std::string name() const override { return alloc_.symbolTable().toString(statName()); }
+  StatName statName() const override { return alloc_.statName(data_); }
 
   // Stats::Gauge
   virtual void add(uint64_t amount) override {
@@ -164,7 +171,7 @@ public:
   NullGaugeImpl() {}
   ~NullGaugeImpl() {}
   std::string name() const override { return ""; }
-  const char* nameCStr() const override { return ""; }
+  StatName statName() const override { return StatName(); }
   const std::string& tagExtractedName() const override { CONSTRUCT_ON_FIRST_USE(std::string, ""); }
   const std::vector<Tag>& tags() const override { CONSTRUCT_ON_FIRST_USE(std::vector<Tag>, {}); }
   void add(uint64_t) override {}
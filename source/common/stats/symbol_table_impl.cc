@@ -136,12 +136,27 @@ SymbolEncoding SymbolTableImpl::encode(const absl::string_view name) {
   std::vector<Symbol> symbols;
   symbols.reserve(tokens.size());
 
-  // Now take the lock and populate the Symbol objects, which involves bumping
-  // ref-counts in this.
+  // Now populate the Symbol objects, which involves bumping ref-counts in
+  // this. Tokens that already have a symbol only need the lock shared, so the
+  // common case of re-encoding a known name does not serialize callers.
   {
-    Thread::LockGuard lock(lock_);
+    absl::ReaderMutexLock lock(&lock_);
     for (auto& token : tokens) {
-      symbols.push_back(toSymbol(token));
+      auto encode_find = encode_map_.find(token);
+      if (encode_find == encode_map_.end()) {
+        break;
+      }
+      ++encode_find->second.ref_count_;
+      symbols.push_back(encode_find->second.symbol_);
+    }
+  }
+
+  // Symbolize the remaining tokens, starting with the first one that was
+  // missing, with the lock held exclusively.
+  if (symbols.size() < tokens.size()) {
+    absl::MutexLock lock(&lock_);
+    for (uint64_t i = symbols.size(); i < tokens.size(); ++i) {
+      symbols.push_back(toSymbol(tokens[i]));
     }
   }
 
@@ -153,7 +168,7 @@ SymbolEncoding SymbolTableImpl::encode(const absl::string_view name) {
 }
 
 uint64_t SymbolTableImpl::numSymbols() const {
-  Thread::LockGuard lock(lock_);
+  absl::ReaderMutexLock lock(&lock_);
   ASSERT(encode_map_.size() == decode_map_.size());
   return encode_map_.size();
 }
@@ -167,7 +182,7 @@ std::string SymbolTableImpl::decodeSymbolVec(const SymbolVec& symbols) const {
   name_tokens.reserve(symbols.size());
   {
     // Hold the lock only while decoding symbols.
-    Thread::LockGuard lock(lock_);
+    absl::ReaderMutexLock lock(&lock_);
     for (Symbol symbol : symbols) {
       name_tokens.push_back(fromSymbol(symbol));
     }
@@ -179,15 +194,11 @@ void SymbolTableImpl::incRefCount(const StatName& stat_name) {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   SymbolVec symbols = SymbolEncoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
+  // The caller holds a reference to each symbol, so none of them can be
+  // erased while we add ours.
+  absl::ReaderMutexLock lock(&lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
-
-    auto encode_search = encode_map_.find(*decode_search->second);
-    ASSERT(encode_search != encode_map_.end());
-
-    ++encode_search->second.ref_count_;
+    ++sharedSymbol(symbol).ref_count_;
   }
 }
 
@@ -195,8 +206,30 @@ void SymbolTableImpl::free(const StatName& stat_name) {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   SymbolVec symbols = SymbolEncoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
-  for (Symbol symbol : symbols) {
+  // Drop every reference that is not the last one for its symbol with the lock
+  // held shared. Taking a count from 1 to 0 would race with a concurrent
+  // encode() finding the symbol, so those are left for the exclusive pass.
+  SymbolVec last_references;
+  {
+    absl::ReaderMutexLock lock(&lock_);
+    for (Symbol symbol : symbols) {
+      std::atomic<uint32_t>& ref_count = sharedSymbol(symbol).ref_count_;
+      uint32_t count = ref_count.load();
+      // On failure compare_exchange_weak() reloads count, so this retries with the current value.
+      while (count > 1 && !ref_count.compare_exchange_weak(count, count - 1)) {
+      }
+      if (count <= 1) {
+        last_references.push_back(symbol);
+      }
+    }
+  }
+
+  if (last_references.empty()) {
+    return;
+  }
+
+  absl::MutexLock lock(&lock_);
+  for (Symbol symbol : last_references) {
     auto decode_search = decode_map_.find(symbol);
     ASSERT(decode_search != decode_map_.end());
 
@@ -204,11 +237,8 @@ void SymbolTableImpl::free(const StatName& stat_name) {
     ASSERT(encode_search != encode_map_.end());
 
     // If that was the last remaining client usage of the symbol, erase the
-    // current mappings and add the now-unused symbol to the reuse pool.
-    //
-    // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
-    // symbol_table_speed_test.cc, relative to breaking out the decrement into a
-    // separate step, likely due to the non-trivial dereferences in EXPR.
+    // current mappings and add the now-unused symbol to the reuse pool. Another
+    // thread may have picked up a new reference since the shared pass.
     if (--encode_search->second.ref_count_ == 0) {
       decode_map_.erase(decode_search);
       encode_map_.erase(encode_search);
@@ -216,6 +246,16 @@ void SymbolTableImpl::free(const StatName& stat_name) {
     }
   }
 }
+
+SymbolTableImpl::SharedSymbol& SymbolTableImpl::sharedSymbol(Symbol symbol) {
+  auto decode_search = decode_map_.find(symbol);
+  ASSERT(decode_search != decode_map_.end());
+
+  auto encode_search = encode_map_.find(*decode_search->second);
+  ASSERT(encode_search != encode_map_.end());
+  return encode_search->second;
+}
+
 Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
   Symbol result;
   auto encode_find = encode_map_.find(sv);
@@ -243,7 +283,7 @@ Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
 }
 
 absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const
-    EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    SHARED_LOCKS_REQUIRED(lock_) {
   auto search = decode_map_.find(symbol);
   RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
   return {*search->second};
@@ -270,7 +310,7 @@ bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
 
   // Calling fromSymbol requires holding the lock, as it needs read-access to
   // the maps that are written when adding new symbols.
-  Thread::LockGuard lock(lock_);
+  absl::ReaderMutexLock lock(&lock_);
   for (uint64_t i = 0, n = std::min(av.size(), bv.size()); i < n; ++i) {
     if (av[i] != bv[i]) {
       bool ret = fromSymbol(av[i]) < fromSymbol(bv[i]);
@@ -282,7 +322,7 @@ bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTableImpl::debugPrint() const {
-  Thread::LockGuard lock(lock_);
+  absl::ReaderMutexLock lock(&lock_);
   std::vector<Symbol> symbols;
   for (const auto& p : decode_map_) {
     symbols.push_back(p.first);
@@ -291,7 +331,7 @@ void SymbolTableImpl::debugPrint() const {
   for (Symbol symbol : symbols) {
     std::string& token = *decode_map_.find(symbol)->second;
     const SharedSymbol& shared_symbol = encode_map_.find(token)->second;
-    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token, shared_symbol.ref_count_);
+    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token, shared_symbol.ref_count_.load());
   }
 }
 #endif
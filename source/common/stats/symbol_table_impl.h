@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include <stack>
@@ -13,7 +14,6 @@
 
 #include "common/common/assert.h"
 #include "common/common/hash.h"
-#include "common/common/lock_guard.h"
 #include "common/common/non_copyable.h"
 #include "common/common/thread.h"
 #include "common/common/utility.h"
@@ -21,6 +21,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Stats {
@@ -127,6 +128,12 @@ private:
  * that if a string is encoded, the resulting stat is destroyed, and then that
  * same string is re-encoded, it may or may not encode to the same underlying
  * symbol.
+ *
+ * The maps are guarded by a reader/writer lock. Encoding names whose tokens all
+ * have symbols already, decoding, and dropping references other than the last
+ * one only take the lock shared, adjusting the atomic reference counts, so
+ * workers creating stats for existing names never wait on each other. The lock
+ * is only taken exclusively to add a new symbol or remove an unused one.
  */
 class SymbolTableImpl : public SymbolTable {
 public:
@@ -153,12 +160,19 @@ private:
   struct SharedSymbol {
     SharedSymbol(Symbol symbol) : symbol_(symbol), ref_count_(1) {}
 
+    // The map only moves values while rehashing, which happens with lock_ held
+    // exclusively, so no reader can be touching the count at the same time.
+    SharedSymbol(SharedSymbol&& src) : symbol_(src.symbol_), ref_count_(src.ref_count_.load()) {}
+
     Symbol symbol_;
-    uint32_t ref_count_;
+
+    // Adjusted with lock_ held shared, except that dropping the last reference
+    // requires lock_ held exclusively, as that erases the symbol.
+    std::atomic<uint32_t> ref_count_;
   };
 
-  // This must be called during both encode() and free().
-  mutable Thread::MutexBasicLockable lock_;
+  // Held shared to look up existing symbols, and exclusively to add or remove them.
+  mutable absl::Mutex lock_;
 
   /**
    * Decodes a vector of symbols back into its period-delimited stat name. If
@@ -185,13 +199,22 @@ private:
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  absl::string_view fromSymbol(Symbol symbol) const SHARED_LOCKS_REQUIRED(lock_);
+
+  /**
+   * Looks up the shared symbol record for a symbol that the caller holds a
+   * reference to.
+   *
+   * @param symbol the symbol to look up.
+   * @return SharedSymbol& the record holding the symbol's reference count.
+   */
+  SharedSymbol& sharedSymbol(Symbol symbol) SHARED_LOCKS_REQUIRED(lock_);
 
   // Stages a new symbol for use. To be called after a successful insertion.
-  void newSymbol();
+  void newSymbol() EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   Symbol monotonicCounter() {
-    Thread::LockGuard lock(lock_);
+    absl::ReaderMutexLock lock(&lock_);
     return monotonic_counter_;
   }
 
@@ -200,7 +223,7 @@ private:
   Symbol next_symbol_ GUARDED_BY(lock_);
 
   // If the free pool is exhausted, we monotonically increase this counter.
-  Symbol monotonic_counter_;
+  Symbol monotonic_counter_ GUARDED_BY(lock_);
 
   // Bitmap implementation.
   // The encode map stores both the symbol and the ref count of that symbol.
@@ -2,10 +2,12 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <string>
 
 #include "envoy/common/exception.h"
 
+#include "common/common/assert.h"
 #include "common/common/perf_annotation.h"
 #include "common/common/utility.h"
 
@@ -23,12 +25,11 @@ bool regexStartsWithDot(absl::string_view regex) {
 
 } // namespace
 
-TagExtractorImpl::TagExtractorImpl(const std::string& name, const std::string& regex,
-                                   const std::string& substr)
-    : name_(name), prefix_(std::string(extractRegexPrefix(regex))), substr_(substr),
-      regex_(RegexUtil::parseRegex(regex)) {}
+TagExtractorImplBase::TagExtractorImplBase(const std::string& name, const std::string& regex,
+                                           const std::string& substr)
+    : name_(name), prefix_(std::string(extractRegexPrefix(regex))), substr_(substr) {}
 
-std::string TagExtractorImpl::extractRegexPrefix(absl::string_view regex) {
+std::string TagExtractorImplBase::extractRegexPrefix(absl::string_view regex) {
   std::string prefix;
   if (absl::StartsWith(regex, "^")) {
     for (absl::string_view::size_type i = 1; i < regex.size(); ++i) {
@@ -47,9 +48,10 @@ std::string TagExtractorImpl::extractRegexPrefix(absl::string_view regex) {
   return prefix;
 }
 
-TagExtractorPtr TagExtractorImpl::createTagExtractor(const std::string& name,
-                                                     const std::string& regex,
-                                                     const std::string& substr) {
+TagExtractorPtr TagExtractorImplBase::createTagExtractor(const std::string& name,
+                                                         const std::string& regex,
+                                                         const std::string& substr,
+                                                         Regex::Type re_type) {
 
   if (name.empty()) {
     throw EnvoyException("tag_name cannot be empty");
@@ -59,13 +61,37 @@ TagExtractorPtr TagExtractorImpl::createTagExtractor(const std::string& name,
     throw EnvoyException(fmt::format(
         "No regex specified for tag specifier and no default regex for name: '{}'", name));
   }
-  return TagExtractorPtr{new TagExtractorImpl(name, regex, substr)};
+  switch (re_type) {
+  case Regex::Type::Re2:
+    return TagExtractorPtr{new TagExtractorRe2Impl(name, regex, substr)};
+  case Regex::Type::StdRegex:
+    return TagExtractorPtr{new TagExtractorImpl(name, regex, substr)};
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
 }
 
-bool TagExtractorImpl::substrMismatch(const std::string& stat_name) const {
+bool TagExtractorImplBase::substrMismatch(const std::string& stat_name) const {
   return !substr_.empty() && stat_name.find(substr_) == std::string::npos;
 }
 
+void TagExtractorImplBase::addTag(const std::string& stat_name, absl::string_view remove_subexpr,
+                                  absl::string_view value_subexpr, std::vector<Tag>& tags,
+                                  IntervalSet<size_t>& remove_characters) const {
+  tags.emplace_back();
+  Tag& tag = tags.back();
+  tag.name_ = name_;
+  tag.value_ = std::string(value_subexpr);
+
+  // Determines which characters to remove from stat_name to elide remove_subexpr.
+  const std::string::size_type start = remove_subexpr.data() - stat_name.data();
+  const std::string::size_type end = start + remove_subexpr.size();
+  remove_characters.insert(start, end);
+}
+
+TagExtractorImpl::TagExtractorImpl(const std::string& name, const std::string& regex,
+                                   const std::string& substr)
+    : TagExtractorImplBase(name, regex, substr), regex_(RegexUtil::parseRegex(regex)) {}
+
 bool TagExtractorImpl::extractTag(const std::string& stat_name, std::vector<Tag>& tags,
                                   IntervalSet<size_t>& remove_characters) const {
   PERF_OPERATION(perf);
@@ -87,15 +113,50 @@ bool TagExtractorImpl::extractTag(const std::string& stat_name, std::vector<Tag>
     // second submatch, then the value_subexpr is the same as the remove_subexpr.
     const auto& value_subexpr = match.size() > 2 ? match[2] : remove_subexpr;
 
-    tags.emplace_back();
-    Tag& tag = tags.back();
-    tag.name_ = name_;
-    tag.value_ = value_subexpr.str();
+    addTag(stat_name,
+           absl::string_view(stat_name.data() + (remove_subexpr.first - stat_name.begin()),
+                             remove_subexpr.length()),
+           absl::string_view(stat_name.data() + (value_subexpr.first - stat_name.begin()),
+                             value_subexpr.length()),
+           tags, remove_characters);
+    PERF_RECORD(perf, "re-match", name_);
+    return true;
+  }
+  PERF_RECORD(perf, "re-miss", name_);
+  return false;
+}
+
+TagExtractorRe2Impl::TagExtractorRe2Impl(const std::string& name, const std::string& regex,
+                                         const std::string& substr)
+    : TagExtractorImplBase(name, regex, substr), regex_(regex, re2::RE2::Quiet) {
+  if (!regex_.ok()) {
+    throw EnvoyException(fmt::format("Invalid regex '{}': {}", regex, regex_.error()));
+  }
+}
+
+bool TagExtractorRe2Impl::extractTag(const std::string& stat_name, std::vector<Tag>& tags,
+                                     IntervalSet<size_t>& remove_characters) const {
+  PERF_OPERATION(perf);
+
+  if (substrMismatch(stat_name)) {
+    PERF_RECORD(perf, "re-skip-substr", name_);
+    return false;
+  }
 
-    // Determines which characters to remove from stat_name to elide remove_subexpr.
-    std::string::size_type start = remove_subexpr.first - stat_name.begin();
-    std::string::size_type end = remove_subexpr.second - stat_name.begin();
-    remove_characters.insert(start, end);
+  // remove_subexpr is the first submatch and value_subexpr the optional second submatch, with the
+  // same semantics as TagExtractorImpl::extractTag(). Group 0 is the whole match.
+  re2::StringPiece groups[3];
+  const int num_groups = std::min(regex_.NumberOfCapturingGroups() + 1, 3);
+  // An optional group that did not participate in the match has a null data pointer.
+  if (num_groups > 1 &&
+      regex_.Match(stat_name, 0, stat_name.size(), re2::RE2::UNANCHORED, groups, num_groups) &&
+      groups[1].data() != nullptr) {
+    const re2::StringPiece& remove_subexpr = groups[1];
+    const re2::StringPiece& value_subexpr =
+        num_groups > 2 && groups[2].data() != nullptr ? groups[2] : remove_subexpr;
+
+    addTag(stat_name, absl::string_view(remove_subexpr.data(), remove_subexpr.size()),
+           absl::string_view(value_subexpr.data(), value_subexpr.size()), tags, remove_characters);
     PERF_RECORD(perf, "re-match", name_);
     return true;
   }
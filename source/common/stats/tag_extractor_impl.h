@@ -6,12 +6,18 @@
 
 #include "envoy/stats/tag_extractor.h"
 
+#include "common/common/regex.h"
+
 #include "absl/strings/string_view.h"
+#include "re2/re2.h"
 
 namespace Envoy {
 namespace Stats {
 
-class TagExtractorImpl : public TagExtractor {
+/**
+ * Shared functionality for regex based tag extractors. Subclasses supply the regex engine.
+ */
+class TagExtractorImplBase : public TagExtractor {
 public:
   /**
    * Creates a tag extractor from the regex provided. name and regex must be non-empty.
@@ -20,16 +26,16 @@ public:
    * @param substr a substring that -- if provided -- must be present in a stat name
    *               in order to match the regex. This is an optional performance tweak
    *               to avoid large numbers of failed regex lookups.
+   * @param re_type the regex engine to use for the extractor.
    * @return TagExtractorPtr newly constructed TagExtractor.
    */
   static TagExtractorPtr createTagExtractor(const std::string& name, const std::string& regex,
-                                            const std::string& substr = "");
+                                            const std::string& substr = "",
+                                            Regex::Type re_type = Regex::Type::StdRegex);
 
-  TagExtractorImpl(const std::string& name, const std::string& regex,
-                   const std::string& substr = "");
+  TagExtractorImplBase(const std::string& name, const std::string& regex,
+                       const std::string& substr = "");
   std::string name() const override { return name_; }
-  bool extractTag(const std::string& tag_extracted_name, std::vector<Tag>& tags,
-                  IntervalSet<size_t>& remove_characters) const override;
   absl::string_view prefixToken() const override { return prefix_; }
 
   /**
@@ -39,7 +45,7 @@ public:
    */
   bool substrMismatch(const std::string& stat_name) const;
 
-private:
+protected:
   /**
    * Examines a regex string, looking for the pattern: ^alphanumerics_with_underscores\.
    * Returns "alphanumerics_with_underscores" if that pattern is found, empty-string otherwise.
@@ -47,11 +53,53 @@ private:
    * @return std::string the prefix, or "" if no prefix found.
    */
   static std::string extractRegexPrefix(absl::string_view regex);
+
+  /**
+   * Records a tag and the characters to remove once a regex has matched.
+   * @param remove_subexpr the span of stat_name to remove from the tag extracted name.
+   * @param value_subexpr the span of stat_name containing the tag value.
+   */
+  void addTag(const std::string& stat_name, absl::string_view remove_subexpr,
+              absl::string_view value_subexpr, std::vector<Tag>& tags,
+              IntervalSet<size_t>& remove_characters) const;
+
   const std::string name_;
   const std::string prefix_;
   const std::string substr_;
+};
+
+/**
+ * Tag extractor using the std::regex (ECMAScript) engine.
+ */
+class TagExtractorImpl : public TagExtractorImplBase {
+public:
+  TagExtractorImpl(const std::string& name, const std::string& regex,
+                   const std::string& substr = "");
+
+  // Stats::TagExtractor
+  bool extractTag(const std::string& tag_extracted_name, std::vector<Tag>& tags,
+                  IntervalSet<size_t>& remove_characters) const override;
+
+private:
   const std::regex regex_;
 };
 
+/**
+ * Tag extractor using the linear time RE2 engine. Note that RE2 does not support lookahead, so
+ * the default extractor regexes cannot be expressed with it.
+ */
+class TagExtractorRe2Impl : public TagExtractorImplBase {
+public:
+  TagExtractorRe2Impl(const std::string& name, const std::string& regex,
+                      const std::string& substr = "");
+
+  // Stats::TagExtractor
+  bool extractTag(const std::string& tag_extracted_name, std::vector<Tag>& tags,
+                  IntervalSet<size_t>& remove_characters) const override;
+
+private:
+  const re2::RE2 regex_;
+};
+
 } // namespace Stats
 } // namespace Envoy
@@ -34,6 +34,10 @@ TagProducerImpl::TagProducerImpl(const envoy::config::metrics::v2::StatsConfig&
       } else {
         addExtractor(Stats::TagExtractorImpl::createTagExtractor(name, tag_specifier.regex()));
       }
+    } else if (tag_specifier.tag_value_case() ==
+               envoy::config::metrics::v2::TagSpecifier::kSafeRegex) {
+      addExtractor(Stats::TagExtractorImpl::createTagExtractor(
+          name, tag_specifier.safe_regex().regex(), "", Regex::Type::Re2));
     } else if (tag_specifier.tag_value_case() ==
                envoy::config::metrics::v2::TagSpecifier::kFixedValue) {
       default_tags_.emplace_back(Stats::Tag{name, tag_specifier.fixed_value()});
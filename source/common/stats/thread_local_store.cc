@@ -1,10 +1,12 @@
 #include "common/stats/thread_local_store.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <list>
 #include <memory>
 #include <string>
+#include <thread>
 
 #include "envoy/stats/histogram.h"
 #include "envoy/stats/sink.h"
@@ -21,6 +23,14 @@
 namespace Envoy {
 namespace Stats {
 
+namespace {
+
+// The number of parent histograms a thread claims at a time when merging in parallel. Large enough
+// to keep contention on the shared cursor low, small enough to spread the work across workers.
+constexpr uint64_t HistogramMergeChunkSize = 64;
+
+} // namespace
+
 ThreadLocalStoreImpl::ThreadLocalStoreImpl(const StatsOptions& stats_options,
                                            StatDataAllocator& alloc)
     : stats_options_(stats_options), alloc_(alloc), default_scope_(createScope("")),
@@ -52,13 +62,13 @@ void ThreadLocalStoreImpl::setStatsMatcher(StatsMatcherPtr&& stats_matcher) {
 
 template <class StatMapClass, class StatListClass>
 void ThreadLocalStoreImpl::removeRejectedStats(StatMapClass& map, StatListClass& list) {
-  std::vector<const char*> remove_list;
+  std::vector<StatName> remove_list;
   for (auto& stat : map) {
-    if (rejects(stat.first)) {
+    if (rejects(stat.second->name())) {
       remove_list.push_back(stat.first);
     }
   }
-  for (const char* stat_name : remove_list) {
+  for (StatName stat_name : remove_list) {
     auto iter = map.find(stat_name);
     ASSERT(iter != map.end());
     list.push_back(iter->second); // Save SharedPtr to the list to avoid invalidating refs to stat.
@@ -76,7 +86,7 @@ bool ThreadLocalStoreImpl::rejects(const std::string& name) const {
 std::vector<CounterSharedPtr> ThreadLocalStoreImpl::counters() const {
   // Handle de-dup due to overlapping scopes.
   std::vector<CounterSharedPtr> ret;
-  ConstCharStarHashSet names;
+  StatNameHashSet names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
     for (auto& counter : scope->central_cache_.counters_) {
@@ -99,7 +109,7 @@ ScopePtr ThreadLocalStoreImpl::createScope(const std::string& name) {
 std::vector<GaugeSharedPtr> ThreadLocalStoreImpl::gauges() const {
   // Handle de-dup due to overlapping scopes.
   std::vector<GaugeSharedPtr> ret;
-  ConstCharStarHashSet names;
+  StatNameHashSet names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
     for (auto& gauge : scope->central_cache_.gauges_) {
@@ -158,17 +168,65 @@ void ThreadLocalStoreImpl::mergeHistograms(PostMergeCb merge_complete_cb) {
             }
           }
         },
-        [this, merge_complete_cb]() -> void { mergeInternal(merge_complete_cb); });
+        [this, merge_complete_cb]() -> void { mergeParentHistograms(merge_complete_cb); });
   } else {
     // If server is shutting down, just call the callback to allow flush to continue.
     merge_complete_cb();
   }
 }
 
-void ThreadLocalStoreImpl::mergeInternal(PostMergeCb merge_complete_cb) {
+void ThreadLocalStoreImpl::mergeParentHistograms(PostMergeCb merge_complete_cb) {
+  if (shutting_down_) {
+    return;
+  }
+
+  std::vector<ParentHistogramImplSharedPtr> histograms;
+  {
+    Thread::LockGuard lock(lock_);
+    for (ScopeImpl* scope : scopes_) {
+      for (const auto& name_histogram_pair : scope->central_cache_.histograms_) {
+        histograms.push_back(name_histogram_pair.second);
+      }
+    }
+  }
+
+  // Folding the TLS histograms into the parents is the bulk of the merge cost, so spread it
+  // across the workers. runOnAllThreads() runs the callback on the main thread synchronously
+  // before posting it to the workers, so the main thread sits this phase out; otherwise it would
+  // claim every chunk before any worker got to run. Whatever the workers leave behind (e.g. if
+  // there are none) is merged on the main thread in mergeInternal().
+  HistogramMergeStateSharedPtr state = std::make_shared<HistogramMergeState>(std::move(histograms));
+  const std::thread::id main_thread_id = std::this_thread::get_id();
+  tls_->runOnAllThreads(
+      [this, state, main_thread_id]() -> void {
+        if (std::this_thread::get_id() != main_thread_id && !shutting_down_) {
+          mergeHistogramChunks(*state);
+        }
+      },
+      [this, state, merge_complete_cb]() -> void { mergeInternal(*state, merge_complete_cb); });
+}
+
+void ThreadLocalStoreImpl::mergeHistogramChunks(HistogramMergeState& state) {
+  const uint64_t size = state.histograms_.size();
+  for (uint64_t begin = state.next_.fetch_add(HistogramMergeChunkSize); begin < size;
+       begin = state.next_.fetch_add(HistogramMergeChunkSize)) {
+    const uint64_t end = std::min(begin + HistogramMergeChunkSize, size);
+    for (uint64_t i = begin; i < end; ++i) {
+      state.needs_refresh_[i] = state.histograms_[i]->mergeTlsHistograms();
+    }
+  }
+}
+
+void ThreadLocalStoreImpl::mergeInternal(HistogramMergeState& state,
+                                         PostMergeCb merge_complete_cb) {
   if (!shutting_down_) {
-    for (const ParentHistogramSharedPtr& histogram : histograms()) {
-      histogram->merge();
+    mergeHistogramChunks(state);
+    // The statistics are read on the main thread, so they are only refreshed here, and only for
+    // the histograms that saw values recently.
+    for (uint64_t i = 0; i < state.histograms_.size(); ++i) {
+      if (state.needs_refresh_[i]) {
+        state.histograms_[i]->refreshStatistics();
+      }
     }
     merge_complete_cb();
     merge_in_progress_ = false;
@@ -251,20 +309,15 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
     StatMap<std::shared_ptr<StatType>>* tls_cache, SharedStringSet* tls_rejected_stats,
     StatType& null_stat) {
 
-  const char* stat_key = name.c_str();
-
   // We do name-rejections on the full name, prior to truncation.
   if (tls_rejected_stats != nullptr &&
-      tls_rejected_stats->find(stat_key) != tls_rejected_stats->end()) {
+      tls_rejected_stats->find(name.c_str()) != tls_rejected_stats->end()) {
     return null_stat;
   }
 
-  std::unique_ptr<std::string> truncation_buffer;
   absl::string_view truncated_name = parent_.truncateStatNameIfNeeded(name);
-  if (truncated_name.size() < name.size()) {
-    truncation_buffer = std::make_unique<std::string>(std::string(truncated_name));
-    stat_key = truncation_buffer->c_str(); // must be nul-terminated.
-  }
+  StatNameTempStorage stat_name_storage(truncated_name, parent_.symbolTable());
+  StatName stat_key = stat_name_storage.statName();
 
   // If we have a valid cache entry, return it.
   if (tls_cache) {
@@ -286,11 +339,11 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
     return null_stat;
   } else {
     // If we had to truncate, warn now that we've missed all caches.
-    if (truncation_buffer != nullptr) {
+    if (truncated_name.size() < name.size()) {
       ENVOY_LOG_MISC(
           warn,
           "Statistic '{}' is too long with {} characters, it will be truncated to {} characters",
-          name, name.size(), truncation_buffer->size());
+          name, name.size(), truncated_name.size());
     }
 
     std::vector<Tag> tags;
@@ -310,13 +363,13 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
                        std::move(tags));              // NOLINT(bugprone-use-after-move)
       ASSERT(stat != nullptr);
     }
-    central_ref = &central_cache_map[stat->nameCStr()];
+    central_ref = &central_cache_map[stat->statName()];
     *central_ref = stat;
   }
 
   // If we have a TLS cache, insert the stat.
   if (tls_cache) {
-    tls_cache->insert(std::make_pair((*central_ref)->nameCStr(), *central_ref));
+    tls_cache->insert(std::make_pair((*central_ref)->statName(), *central_ref));
   }
 
   // Finally we return the reference.
@@ -330,13 +383,13 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::counter(const std::string& name) {
 
   // Determine the final name based on the prefix and the passed name.
   //
-  // Note that we can do map.find(final_name.c_str()), but we cannot do
-  // map[final_name.c_str()] as the char*-keyed maps would then save the pointer
-  // to a temporary, and address sanitization errors would follow. Instead we
-  // must do a find() first, using the value if it succeeds. If it fails, then
-  // after we construct the stat we can insert it into the required maps. This
-  // strategy costs an extra hash lookup for each miss, but saves time
-  // re-copying the string and significant memory overhead.
+  // Note that we can do map.find() with a StatName encoded into temporary
+  // storage, but we cannot do map[] with it as the StatName-keyed maps would
+  // then save a reference to a temporary, and address sanitization errors would
+  // follow. Instead we must do a find() first, using the value if it succeeds.
+  // If it fails, then after we construct the stat we can insert it into the
+  // required maps, keyed by the StatName held in the stat. This strategy costs
+  // an extra hash lookup for each miss, but saves significant memory overhead.
   std::string final_name = prefix_ + name;
 
   // We now find the TLS cache. This might remain null if we don't have TLS
@@ -381,12 +434,6 @@ Gauge& ThreadLocalStoreImpl::ScopeImpl::gauge(const std::string& name) {
 
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
-  //
-  // Note that we can do map.find(final_name.c_str()), but we cannot do
-  // map[final_name.c_str()] as the char*-keyed maps would then save the pointer to
-  // a temporary, and address sanitization errors would follow. Instead we must
-  // do a find() first, using that if it succeeds. If it fails, then after we
-  // construct the stat we can insert it into the required maps.
   std::string final_name = prefix_ + name;
 
   StatMap<GaugeSharedPtr>* tls_cache = nullptr;
@@ -413,31 +460,30 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
 
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
-  //
-  // Note that we can do map.find(final_name.c_str()), but we cannot do
-  // map[final_name.c_str()] as the char*-keyed maps would then save the pointer to
-  // a temporary, and address sanitization errors would follow. Instead we must
-  // do a find() first, using that if it succeeds. If it fails, then after we
-  // construct the stat we can insert it into the required maps.
   std::string final_name = prefix_ + name;
 
   StatMap<ParentHistogramSharedPtr>* tls_cache = nullptr;
   SharedStringSet* tls_rejected_stats = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
     TlsCacheEntry& entry = parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_];
-    tls_cache = &entry.parent_histograms_;
-    auto iter = tls_cache->find(final_name.c_str());
-    if (iter != tls_cache->end()) {
-      return *iter->second;
-    }
     tls_rejected_stats = &entry.rejected_stats_;
     if (tls_rejected_stats->find(final_name.c_str()) != tls_rejected_stats->end()) {
       return null_histogram_;
     }
+    tls_cache = &entry.parent_histograms_;
+  }
+
+  StatNameTempStorage stat_name_storage(final_name, parent_.symbolTable());
+  StatName stat_key = stat_name_storage.statName();
+  if (tls_cache != nullptr) {
+    auto iter = tls_cache->find(stat_key);
+    if (iter != tls_cache->end()) {
+      return *iter->second;
+    }
   }
 
   Thread::LockGuard lock(parent_.lock_);
-  auto iter = central_cache_.histograms_.find(final_name.c_str());
+  auto iter = central_cache_.histograms_.find(stat_key);
   ParentHistogramImplSharedPtr* central_ref = nullptr;
   if (iter != central_cache_.histograms_.end()) {
     central_ref = &iter->second;
@@ -449,17 +495,17 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
     std::string tag_extracted_name = parent_.getTagsForName(final_name, tags);
     auto stat = std::make_shared<ParentHistogramImpl>(
         final_name, parent_, *this, std::move(tag_extracted_name), std::move(tags));
-    central_ref = &central_cache_.histograms_[stat->nameCStr()];
+    central_ref = &central_cache_.histograms_[stat->statName()];
     *central_ref = stat;
   }
 
   if (tls_cache != nullptr) {
-    tls_cache->insert(std::make_pair((*central_ref)->nameCStr(), *central_ref));
+    tls_cache->insert(std::make_pair((*central_ref)->statName(), *central_ref));
   }
   return **central_ref;
 }
 
-Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(const std::string& name,
+Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(StatName name,
                                                          ParentHistogramImpl& parent) {
   // tlsHistogram() is generally not called for a histogram that is rejected by
   // the matcher, so no further rejection-checking is needed at this level.
@@ -469,35 +515,37 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(const std::string& name
   StatMap<TlsHistogramSharedPtr>* tls_cache = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
     tls_cache = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].histograms_;
-    auto iter = tls_cache->find(name.c_str());
+    auto iter = tls_cache->find(name);
     if (iter != tls_cache->end()) {
       return *iter->second;
     }
   }
 
   std::vector<Tag> tags;
-  std::string tag_extracted_name = parent_.getTagsForName(name, tags);
+  std::string tag_extracted_name = parent_.getTagsForName(symbolTable().toString(name), tags);
   TlsHistogramSharedPtr hist_tls_ptr = std::make_shared<ThreadLocalHistogramImpl>(
-      name, std::move(tag_extracted_name), std::move(tags));
+      name, symbolTable(), std::move(tag_extracted_name), std::move(tags));
 
   parent.addTlsHistogram(hist_tls_ptr);
 
   if (tls_cache) {
-    tls_cache->insert(std::make_pair(hist_tls_ptr->nameCStr(), hist_tls_ptr));
+    tls_cache->insert(std::make_pair(hist_tls_ptr->statName(), hist_tls_ptr));
   }
   return *hist_tls_ptr;
 }
 
-ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(const std::string& name,
+ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(StatName name, SymbolTable& symbol_table,
                                                    std::string&& tag_extracted_name,
                                                    std::vector<Tag>&& tags)
     : MetricImpl(std::move(tag_extracted_name), std::move(tags)), current_active_(0), flags_(0),
-      created_thread_id_(std::this_thread::get_id()), name_(name) {
+      created_thread_id_(std::this_thread::get_id()), symbol_table_(symbol_table),
+      name_(name, symbol_table) {
   histograms_[0] = hist_alloc();
   histograms_[1] = hist_alloc();
 }
 
 ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
+  name_.free(symbol_table_);
   hist_free(histograms_[0]);
   hist_free(histograms_[1]);
 }
@@ -508,10 +556,14 @@ void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   flags_ |= Flags::Used;
 }
 
-void ThreadLocalHistogramImpl::merge(histogram_t* target) {
+bool ThreadLocalHistogramImpl::merge(histogram_t* target) {
   histogram_t** other_histogram = &histograms_[otherHistogramIndex()];
+  if (hist_sample_count(*other_histogram) == 0) {
+    return false;
+  }
   hist_accumulate(target, other_histogram, 1);
   hist_clear(*other_histogram);
+  return true;
 }
 
 ParentHistogramImpl::ParentHistogramImpl(const std::string& name, Store& parent,
@@ -520,15 +572,16 @@ ParentHistogramImpl::ParentHistogramImpl(const std::string& name, Store& parent,
     : MetricImpl(std::move(tag_extracted_name), std::move(tags)), parent_(parent),
       tls_scope_(tls_scope), interval_histogram_(hist_alloc()), cumulative_histogram_(hist_alloc()),
       interval_statistics_(interval_histogram_), cumulative_statistics_(cumulative_histogram_),
-      merged_(false), name_(name) {}
+      merged_(false), interval_has_values_(false), name_(name, parent.symbolTable()) {}
 
 ParentHistogramImpl::~ParentHistogramImpl() {
+  name_.free(parent_.symbolTable());
   hist_free(interval_histogram_);
   hist_free(cumulative_histogram_);
 }
 
 void ParentHistogramImpl::recordValue(uint64_t value) {
-  Histogram& tls_histogram = tls_scope_.tlsHistogram(name(), *this);
+  Histogram& tls_histogram = tls_scope_.tlsHistogram(statName(), *this);
   tls_histogram.recordValue(value);
   parent_.deliverHistogramToSinks(*this, value);
 }
@@ -539,23 +592,41 @@ bool ParentHistogramImpl::used() const {
 }
 
 void ParentHistogramImpl::merge() {
+  if (mergeTlsHistograms()) {
+    refreshStatistics();
+  }
+}
+
+bool ParentHistogramImpl::mergeTlsHistograms() {
   Thread::ReleasableLockGuard lock(merge_lock_);
-  if (merged_ || usedLockHeld()) {
-    hist_clear(interval_histogram_);
-    // Here we could copy all the pointers to TLS histograms in the tls_histogram_ list,
-    // then release the lock before we do the actual merge. However it is not a big deal
-    // because the tls_histogram merge is not that expensive as it is a single histogram
-    // merge and adding TLS histograms is rare.
-    for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
-      tls_histogram->merge(interval_histogram_);
-    }
-    // Since TLS merge is done, we can release the lock here.
-    lock.release();
+  if (!merged_ && !usedLockHeld()) {
+    return false;
+  }
+  hist_clear(interval_histogram_);
+  // Here we could copy all the pointers to TLS histograms in the tls_histogram_ list,
+  // then release the lock before we do the actual merge. However it is not a big deal
+  // because the tls_histogram merge is not that expensive as it is a single histogram
+  // merge and adding TLS histograms is rare.
+  bool has_values = false;
+  for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
+    has_values |= tls_histogram->merge(interval_histogram_);
+  }
+  // Since TLS merge is done, we can release the lock here.
+  lock.release();
+  // An idle histogram's statistics are unchanged, unless the previous interval had values that
+  // now have to be cleared out of the interval statistics.
+  const bool needs_refresh = !merged_ || has_values || interval_has_values_;
+  interval_has_values_ = has_values;
+  if (has_values) {
     hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
-    cumulative_statistics_.refresh(cumulative_histogram_);
-    interval_statistics_.refresh(interval_histogram_);
-    merged_ = true;
   }
+  merged_ = true;
+  return needs_refresh;
+}
+
+void ParentHistogramImpl::refreshStatistics() {
+  cumulative_statistics_.refresh(cumulative_histogram_);
+  interval_statistics_.refresh(interval_histogram_);
 }
 
 const std::string ParentHistogramImpl::quantileSummary() const {
@@ -12,6 +12,7 @@
 #include "common/stats/heap_stat_data.h"
 #include "common/stats/histogram_impl.h"
 #include "common/stats/source_impl.h"
+#include "common/stats/symbol_table_impl.h"
 #include "common/stats/utility.h"
 
 #include "absl/container/flat_hash_map.h"
@@ -28,11 +29,15 @@ namespace Stats {
  */
 class ThreadLocalHistogramImpl : public Histogram, public MetricImpl {
 public:
-  ThreadLocalHistogramImpl(const std::string& name, std::string&& tag_extracted_name,
-                           std::vector<Tag>&& tags);
+  ThreadLocalHistogramImpl(StatName name, SymbolTable& symbol_table,
+                           std::string&& tag_extracted_name, std::vector<Tag>&& tags);
   ~ThreadLocalHistogramImpl();
 
-  void merge(histogram_t* target);
+  /**
+   * Merges the values collected before the last beginMerge() into target and clears them.
+   * @return bool whether any values were merged.
+   */
+  bool merge(histogram_t* target);
 
   /**
    * Called in the beginning of merge process. Swaps the histogram used for collection so that we do
@@ -49,8 +54,8 @@ public:
   bool used() const override { return flags_ & Flags::Used; }
 
   // Stats::Metric
-  std::string name() const override { return name_; }
-  const char* nameCStr() const override { return name_.c_str(); }
+  std::string name() const override { return symbol_table_.toString(name_.statName()); }
+  StatName statName() const override { return name_.statName(); }
 
 private:
   uint64_t otherHistogramIndex() const { return 1 - current_active_; }
@@ -58,7 +63,8 @@ private:
   histogram_t* histograms_[2];
   std::atomic<uint16_t> flags_;
   std::thread::id created_thread_id_;
-  const std::string name_;
+  SymbolTable& symbol_table_;
+  StatNameStorage name_;
 };
 
 typedef std::shared_ptr<ThreadLocalHistogramImpl> TlsHistogramSharedPtr;
@@ -86,6 +92,21 @@ public:
    */
   void merge() override;
 
+  /**
+   * First half of merge(): folds the TLS histograms into the interval and cumulative histograms.
+   * This only touches state that is not visible to readers, so different histograms can be merged
+   * on different threads.
+   * @return bool whether the statistics need to be refreshed, which is false when no values were
+   *         recorded in this interval or the previous one.
+   */
+  bool mergeTlsHistograms();
+
+  /**
+   * Second half of merge(): recomputes the interval and cumulative statistics. This must run on
+   * the main thread, which reads the statistics.
+   */
+  void refreshStatistics();
+
   const HistogramStatistics& intervalStatistics() const override { return interval_statistics_; }
   const HistogramStatistics& cumulativeStatistics() const override {
     return cumulative_statistics_;
@@ -94,8 +115,8 @@ public:
   const std::string bucketSummary() const override;
 
   // Stats::Metric
-  std::string name() const override { return name_; }
-  const char* nameCStr() const override { return name_.c_str(); }
+  std::string name() const override { return parent_.symbolTable().toString(name_.statName()); }
+  StatName statName() const override { return name_.statName(); }
 
 private:
   bool usedLockHeld() const EXCLUSIVE_LOCKS_REQUIRED(merge_lock_);
@@ -109,7 +130,8 @@ private:
   mutable Thread::MutexBasicLockable merge_lock_;
   std::list<TlsHistogramSharedPtr> tls_histograms_ GUARDED_BY(merge_lock_);
   bool merged_;
-  const std::string name_;
+  bool interval_has_values_;
+  StatNameStorage name_;
 };
 
 typedef std::shared_ptr<ParentHistogramImpl> ParentHistogramImplSharedPtr;
@@ -126,7 +148,7 @@ public:
    * @return a ThreadLocalHistogram within the scope's namespace.
    * @param name name of the histogram with scope prefix attached.
    */
-  virtual Histogram& tlsHistogram(const std::string& name, ParentHistogramImpl& parent) PURE;
+  virtual Histogram& tlsHistogram(StatName name, ParentHistogramImpl& parent) PURE;
 };
 
 /**
@@ -174,7 +196,9 @@ public:
   const Stats::StatsOptions& statsOptions() const override { return stats_options_; }
 
 private:
-  template <class Stat> using StatMap = ConstCharStarHashMap<Stat>;
+  // The maps are keyed by the StatName held in the stat they map to, so the
+  // name storage is not duplicated per map entry.
+  template <class Stat> using StatMap = StatNameHashMap<Stat>;
 
   struct TlsCacheEntry {
     StatMap<CounterSharedPtr> counters_;
@@ -215,7 +239,7 @@ private:
     Gauge& gauge(const std::string& name) override;
     NullGaugeImpl& nullGauge(const std::string&) override { return null_gauge_; }
     Histogram& histogram(const std::string& name) override;
-    Histogram& tlsHistogram(const std::string& name, ParentHistogramImpl& parent) override;
+    Histogram& tlsHistogram(StatName name, ParentHistogramImpl& parent) override;
     const Stats::StatsOptions& statsOptions() const override { return parent_.statsOptions(); }
 
     template <class StatType>
@@ -268,7 +292,22 @@ private:
   std::string getTagsForName(const std::string& name, std::vector<Tag>& tags) const;
   void clearScopeFromCaches(uint64_t scope_id);
   void releaseScopeCrossThread(ScopeImpl* scope);
-  void mergeInternal(PostMergeCb mergeCb);
+  // The parent histograms being merged during a flush. Threads claim chunks of histograms to
+  // merge by advancing next_, and mark the ones whose statistics need a refresh.
+  struct HistogramMergeState {
+    explicit HistogramMergeState(std::vector<ParentHistogramImplSharedPtr>&& histograms)
+        : histograms_(std::move(histograms)), needs_refresh_(histograms_.size(), 0) {}
+
+    const std::vector<ParentHistogramImplSharedPtr> histograms_;
+    // uint8_t rather than bool, so that threads marking different histograms don't share bytes.
+    std::vector<uint8_t> needs_refresh_;
+    std::atomic<uint64_t> next_{0};
+  };
+  typedef std::shared_ptr<HistogramMergeState> HistogramMergeStateSharedPtr;
+
+  void mergeParentHistograms(PostMergeCb merge_complete_cb);
+  void mergeHistogramChunks(HistogramMergeState& state);
+  void mergeInternal(HistogramMergeState& state, PostMergeCb merge_complete_cb);
   absl::string_view truncateStatNameIfNeeded(absl::string_view name);
   bool rejects(const std::string& name) const;
   bool rejectsAll() const { return stats_matcher_->rejectsAll(); }
@@ -6,6 +6,8 @@
 
 #include "envoy/stream_info/filter_state.h"
 
+#include "common/protobuf/arena_allocator.h"
+
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
@@ -13,6 +15,13 @@ namespace StreamInfo {
 
 class FilterStateImpl : public FilterState {
 public:
+  /**
+   * @param arena supplies the arena of the stream to allocate the names and the index of the data
+   *        from, or nullptr to allocate them from the heap.
+   */
+  explicit FilterStateImpl(Protobuf::Arena* arena = nullptr)
+      : data_storage_(DataNameLess(), ArenaAllocator<DataStorage::value_type>(arena)) {}
+
   // FilterState
   void setData(absl::string_view data_name, std::unique_ptr<Object>&& data,
                FilterState::StateType state_type) override;
@@ -26,10 +35,19 @@ private:
     FilterState::StateType state_type_;
   };
 
-  // The explicit non-type-specific comparator is necessary to allow use of find() method
-  // with absl::string_view. See
+  // The transparent comparator allows find() with an absl::string_view. See
   // https://stackoverflow.com/questions/20317413/what-are-transparent-comparators.
-  std::map<std::string, std::unique_ptr<FilterObject>, std::less<>> data_storage_;
+  struct DataNameLess {
+    typedef void is_transparent;
+
+    bool operator()(absl::string_view lhs, absl::string_view rhs) const { return lhs < rhs; }
+  };
+
+  typedef std::map<ArenaString, FilterObject, DataNameLess,
+                   ArenaAllocator<std::pair<const ArenaString, FilterObject>>>
+      DataStorage;
+
+  DataStorage data_storage_;
 };
 
 } // namespace StreamInfo
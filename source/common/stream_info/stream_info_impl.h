@@ -7,6 +7,8 @@
 #include "envoy/stream_info/stream_info.h"
 
 #include "common/common/assert.h"
+#include "common/common/object_pool.h"
+#include "common/protobuf/protobuf.h"
 #include "common/stream_info/filter_state_impl.h"
 
 namespace Envoy {
@@ -15,7 +17,9 @@ namespace StreamInfo {
 struct StreamInfoImpl : public StreamInfo {
   explicit StreamInfoImpl(TimeSource& time_source)
       : time_source_(time_source), start_time_(time_source.systemTime()),
-        start_time_monotonic_(time_source.monotonicTime()) {}
+        start_time_monotonic_(time_source.monotonicTime()), arena_(arenaOptions()),
+        metadata_(*Protobuf::Arena::CreateMessage<envoy::api::v2::core::Metadata>(&arena_)),
+        filter_state_(&arena_) {}
 
   StreamInfoImpl(Http::Protocol protocol, TimeSource& time_source) : StreamInfoImpl(time_source) {
     protocol_ = protocol;
@@ -47,6 +51,10 @@ struct StreamInfoImpl : public StreamInfo {
     upstream_timing_ = upstream_timing;
   }
 
+  UpstreamTiming& upstreamTiming() override { return upstream_timing_; }
+
+  const UpstreamTiming& upstreamTiming() const override { return upstream_timing_; }
+
   absl::optional<std::chrono::nanoseconds> firstUpstreamTxByteSent() const override {
     return duration(upstream_timing_.first_upstream_tx_byte_sent_);
   }
@@ -209,10 +217,23 @@ struct StreamInfoImpl : public StreamInfo {
   Upstream::HostDescriptionConstSharedPtr upstream_host_{};
   bool health_check_request_{};
   const Router::RouteEntry* route_entry_{};
-  envoy::api::v2::core::Metadata metadata_{};
-  FilterStateImpl filter_state_{};
+  // The dynamic metadata and the filter state index are allocated from an arena owned by the
+  // stream, which frees them at once when the stream is destroyed. It must outlive both.
+  Protobuf::Arena arena_;
+  envoy::api::v2::core::Metadata& metadata_;
+  FilterStateImpl filter_state_;
 
 private:
+  // The blocks of the arena come from the per thread object pool, so that they are reused by the
+  // next stream of the thread. The block size is capped to the largest size the pool keeps.
+  static Protobuf::ArenaOptions arenaOptions() {
+    Protobuf::ArenaOptions options;
+    options.max_block_size = ObjectPool::MaxPooledSize;
+    options.block_alloc = [](size_t size) { return ObjectPool::allocate(size); };
+    options.block_dealloc = [](void* block, size_t size) { ObjectPool::deallocate(block, size); };
+    return options;
+  }
+
   uint64_t bytes_received_{};
   uint64_t bytes_sent_{};
   Network::Address::InstanceConstSharedPtr upstream_local_address_;
@@ -92,7 +92,8 @@ ConnectionPool::Cancellable* ConnPoolImpl::newConnection(ConnectionPool::Callbac
 
   if (host_->cluster().resourceManager(priority_).pendingRequests().canCreate()) {
     bool can_create_connection =
-        host_->cluster().resourceManager(priority_).connections().canCreate();
+        host_->cluster().resourceManager(priority_).connections().canCreate() &&
+        host_->canCreateConnection(priority_);
     if (!can_create_connection) {
       host_->cluster().stats().upstream_cx_overflow_.inc();
     }
@@ -74,6 +74,10 @@ Config::Config(const envoy::config::filter::network::tcp_proxy::v2::TcpProxy& co
     return ThreadLocal::ThreadLocalObjectSharedPtr(new UpstreamDrainManager());
   });
 
+  if (config.has_per_connection_buffer_limit_bytes()) {
+    per_connection_buffer_limit_bytes_ = config.per_connection_buffer_limit_bytes().value();
+  }
+
   if (config.has_deprecated_v1()) {
     for (const envoy::config::filter::network::tcp_proxy::v2::TcpProxy::DeprecatedV1::TCPRoute&
              route_desc : config.deprecated_v1().routes()) {
@@ -171,7 +175,8 @@ UpstreamDrainManager& Config::drainManager() {
 
 Filter::Filter(ConfigSharedPtr config, Upstream::ClusterManager& cluster_manager,
                TimeSource& time_source)
-    : config_(config), cluster_manager_(cluster_manager), downstream_callbacks_(*this),
+    : config_(config), cluster_manager_(cluster_manager), time_source_(time_source),
+      downstream_callbacks_(*this),
       upstream_callbacks_(new UpstreamCallbacks(this)), stream_info_(time_source) {
   ASSERT(config != nullptr);
 }
@@ -188,7 +193,7 @@ Filter::~Filter() {
 }
 
 TcpProxyStats Config::SharedConfig::generateStats(Stats::Scope& scope) {
-  return {ALL_TCP_PROXY_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope))};
+  return {ALL_TCP_PROXY_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
 
 void Filter::initializeReadFilterCallbacks(Network::ReadFilterCallbacks& callbacks) {
@@ -201,6 +206,9 @@ void Filter::initialize(Network::ReadFilterCallbacks& callbacks, bool set_connec
 
   read_callbacks_->connection().addConnectionCallbacks(downstream_callbacks_);
   read_callbacks_->connection().enableHalfClose(true);
+  if (config_->perConnectionBufferLimitBytes().has_value()) {
+    read_callbacks_->connection().setBufferLimits(config_->perConnectionBufferLimitBytes().value());
+  }
   getStreamInfo().setDownstreamLocalAddress(read_callbacks_->connection().localAddress());
   getStreamInfo().setDownstreamRemoteAddress(read_callbacks_->connection().remoteAddress());
   getStreamInfo().setDownstreamSslConnection(read_callbacks_->connection().ssl());
@@ -435,9 +443,18 @@ void Filter::onPoolReady(Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
   Network::ClientConnection& connection = upstream_conn_data_->connection();
 
   connection.enableHalfClose(true);
+  if (config_->perConnectionBufferLimitBytes().has_value()) {
+    connection.setBufferLimits(config_->perConnectionBufferLimitBytes().value());
+  }
 
   getStreamInfo().onUpstreamHostSelected(host);
   getStreamInfo().setUpstreamLocalAddress(connection.localAddress());
+  // The time from the downstream connection to the upstream one being ready, including the
+  // connect attempts that failed.
+  config_->stats().upstream_cx_setup_ms_.recordValue(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          time_source_.monotonicTime() - getStreamInfo().startTimeMonotonic())
+          .count());
 
   // Simulate the event that onPoolReady represents.
   upstream_callbacks_->onEvent(Network::ConnectionEvent::Connected);
@@ -545,7 +562,7 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
       // The idle_timer_ can be moved to a Drainer, so related callbacks call into
       // the UpstreamCallbacks, which has the same lifetime as the timer, and can dispatch
       // the call to either TcpProxy or to Drainer, depending on the current state.
-      idle_timer_ = read_callbacks_->connection().dispatcher().createTimer(
+      idle_timer_ = read_callbacks_->connection().dispatcher().createCoarseTimer(
           [upstream_callbacks = upstream_callbacks_]() { upstream_callbacks->onIdleTimeout(); });
       resetIdleTimer();
       read_callbacks_->connection().addBytesSentCallback([this](uint64_t) { resetIdleTimer(); });
@@ -35,7 +35,7 @@ namespace TcpProxy {
  * All tcp proxy stats. @see stats_macros.h
  */
 // clang-format off
-#define ALL_TCP_PROXY_STATS(COUNTER, GAUGE)                                                        \
+#define ALL_TCP_PROXY_STATS(COUNTER, GAUGE, HISTOGRAM)                                             \
   COUNTER(downstream_cx_rx_bytes_total)                                                            \
   GAUGE  (downstream_cx_rx_bytes_buffered)                                                         \
   COUNTER(downstream_cx_tx_bytes_total)                                                            \
@@ -46,14 +46,15 @@ namespace TcpProxy {
   COUNTER(downstream_flow_control_resumed_reading_total)                                           \
   COUNTER(idle_timeout)                                                                            \
   COUNTER(upstream_flush_total)                                                                    \
-  GAUGE  (upstream_flush_active)
+  GAUGE  (upstream_flush_active)                                                                   \
+  HISTOGRAM(upstream_cx_setup_ms)
 // clang-format on
 
 /**
  * Struct definition for all tcp proxy stats. @see stats_macros.h
  */
 struct TcpProxyStats {
-  ALL_TCP_PROXY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+  ALL_TCP_PROXY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 class Drainer;
@@ -107,6 +108,9 @@ public:
   const TcpProxyStats& stats() { return shared_config_->stats(); }
   const std::vector<AccessLog::InstanceSharedPtr>& accessLogs() { return access_logs_; }
   uint32_t maxConnectAttempts() const { return max_connect_attempts_; }
+  const absl::optional<uint32_t>& perConnectionBufferLimitBytes() const {
+    return per_connection_buffer_limit_bytes_;
+  }
   const absl::optional<std::chrono::milliseconds>& idleTimeout() {
     return shared_config_->idleTimeout();
   }
@@ -147,6 +151,7 @@ private:
   uint64_t total_cluster_weight_;
   std::vector<AccessLog::InstanceSharedPtr> access_logs_;
   const uint32_t max_connect_attempts_;
+  absl::optional<uint32_t> per_connection_buffer_limit_bytes_;
   ThreadLocal::SlotPtr upstream_drain_manager_slot_;
   SharedConfigSharedPtr shared_config_;
   std::unique_ptr<const Router::MetadataMatchCriteria> cluster_metadata_match_criteria_;
@@ -276,6 +281,7 @@ protected:
 
   const ConfigSharedPtr config_;
   Upstream::ClusterManager& cluster_manager_;
+  TimeSource& time_source_;
   Network::ReadFilterCallbacks* read_callbacks_{};
   Tcp::ConnectionPool::Cancellable* upstream_handle_{};
   Tcp::ConnectionPool::ConnectionDataPtr upstream_conn_data_;
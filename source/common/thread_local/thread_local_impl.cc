@@ -83,12 +83,51 @@ void InstanceImpl::runOnAllThreads(Event::PostCb cb) {
   ASSERT(std::this_thread::get_id() == main_thread_id_);
   ASSERT(!shutdown_);
 
+  postToWorkers(cb);
+
+  // Handle main thread.
+  cb();
+}
+
+void InstanceImpl::postToWorkers(Event::PostCb cb) {
+  if (batch_depth_ > 0) {
+    batched_callbacks_.push_back(std::move(cb));
+    return;
+  }
+
   for (Event::Dispatcher& dispatcher : registered_threads_) {
     dispatcher.post(cb);
   }
+}
 
-  // Handle main thread.
-  cb();
+UpdateBatchPtr InstanceImpl::startUpdateBatch() {
+  ASSERT(std::this_thread::get_id() == main_thread_id_);
+  ASSERT(!shutdown_);
+  return std::make_unique<UpdateBatchImpl>(*this);
+}
+
+void InstanceImpl::endUpdateBatch() {
+  ASSERT(std::this_thread::get_id() == main_thread_id_);
+  ASSERT(batch_depth_ > 0);
+  if (--batch_depth_ > 0 || batched_callbacks_.empty()) {
+    return;
+  }
+
+  // The workers share the callbacks, which run in the order they were queued.
+  auto callbacks =
+      std::make_shared<const std::vector<Event::PostCb>>(std::move(batched_callbacks_));
+  batched_callbacks_.clear();
+  if (shutdown_) {
+    // The workers are shutting down, and shutdownThread() cleans up their slots.
+    return;
+  }
+  for (Event::Dispatcher& dispatcher : registered_threads_) {
+    dispatcher.post([callbacks]() -> void {
+      for (const Event::PostCb& cb : *callbacks) {
+        cb();
+      }
+    });
+  }
 }
 
 void InstanceImpl::runOnAllThreads(Event::PostCb cb, Event::PostCb all_threads_complete_cb) {
@@ -100,24 +139,22 @@ void InstanceImpl::runOnAllThreads(Event::PostCb cb, Event::PostCb all_threads_c
   cb();
   std::shared_ptr<std::atomic<uint64_t>> worker_count =
       std::make_shared<std::atomic<uint64_t>>(registered_threads_.size());
-  for (Event::Dispatcher& dispatcher : registered_threads_) {
-    dispatcher.post([this, worker_count, cb, all_threads_complete_cb]() -> void {
-      cb();
-      if (--*worker_count == 0) {
-        main_thread_dispatcher_->post(all_threads_complete_cb);
-      }
-    });
-  }
+  postToWorkers([this, worker_count, cb, all_threads_complete_cb]() -> void {
+    cb();
+    if (--*worker_count == 0) {
+      main_thread_dispatcher_->post(all_threads_complete_cb);
+    }
+  });
 }
 
 void InstanceImpl::SlotImpl::set(InitializeCb cb) {
   ASSERT(std::this_thread::get_id() == parent_.main_thread_id_);
   ASSERT(!parent_.shutdown_);
 
-  for (Event::Dispatcher& dispatcher : parent_.registered_threads_) {
-    const uint32_t index = index_;
-    dispatcher.post([index, cb, &dispatcher]() -> void { setThreadLocal(index, cb(dispatcher)); });
-  }
+  // Each worker's dispatcher was stored in its thread local data when the worker was registered.
+  const uint32_t index = index_;
+  parent_.postToWorkers(
+      [index, cb]() -> void { setThreadLocal(index, cb(*thread_local_data_.dispatcher_)); });
 
   // Handle main thread.
   setThreadLocal(index_, cb(*parent_.main_thread_dispatcher_));
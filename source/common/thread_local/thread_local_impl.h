@@ -25,9 +25,17 @@ public:
   void registerThread(Event::Dispatcher& dispatcher, bool main_thread) override;
   void shutdownGlobalThreading() override;
   void shutdownThread() override;
+  UpdateBatchPtr startUpdateBatch() override;
   Event::Dispatcher& dispatcher() override;
 
 private:
+  struct UpdateBatchImpl : public UpdateBatch {
+    UpdateBatchImpl(InstanceImpl& parent) : parent_(parent) { parent_.batch_depth_++; }
+    ~UpdateBatchImpl() { parent_.endUpdateBatch(); }
+
+    InstanceImpl& parent_;
+  };
+
   struct SlotImpl : public Slot {
     SlotImpl(InstanceImpl& parent, uint64_t index) : parent_(parent), index_(index) {}
     ~SlotImpl() { parent_.removeSlot(*this); }
@@ -52,6 +60,9 @@ private:
   void removeSlot(SlotImpl& slot);
   void runOnAllThreads(Event::PostCb cb);
   void runOnAllThreads(Event::PostCb cb, Event::PostCb main_callback);
+  // Run a callback on all the worker threads, or queue it while a batch is open.
+  void postToWorkers(Event::PostCb cb);
+  void endUpdateBatch();
   static void setThreadLocal(uint32_t index, ThreadLocalObjectSharedPtr object);
 
   static thread_local ThreadLocalData thread_local_data_;
@@ -60,6 +71,9 @@ private:
   std::thread::id main_thread_id_;
   Event::Dispatcher* main_thread_dispatcher_{};
   std::atomic<bool> shutdown_{};
+  // The number of open update batches, and the worker callbacks queued by them.
+  uint32_t batch_depth_{};
+  std::vector<Event::PostCb> batched_callbacks_;
 };
 
 } // namespace ThreadLocal
@@ -4,7 +4,6 @@
 
 #include "common/access_log/access_log_formatter.h"
 #include "common/common/assert.h"
-#include "common/common/fmt.h"
 #include "common/common/macros.h"
 #include "common/common/utility.h"
 #include "common/http/codes.h"
@@ -14,6 +13,8 @@
 #include "common/runtime/uuid_util.h"
 #include "common/stream_info/utility.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Envoy {
 namespace Tracing {
 
@@ -22,21 +23,20 @@ static std::string buildResponseCode(const StreamInfo::StreamInfo& info) {
   return info.responseCode() ? std::to_string(info.responseCode().value()) : "0";
 }
 
-static std::string valueOrDefault(const Http::HeaderEntry* header, const char* default_value) {
-  return header ? header->value().c_str() : default_value;
+static absl::string_view valueOrDefault(const Http::HeaderEntry* header,
+                                        absl::string_view default_value) {
+  return header ? header->value().getStringView() : default_value;
 }
 
 static std::string buildUrl(const Http::HeaderMap& request_headers) {
-  std::string path = request_headers.EnvoyOriginalPath()
-                         ? request_headers.EnvoyOriginalPath()->value().c_str()
-                         : request_headers.Path()->value().c_str();
+  absl::string_view path = request_headers.EnvoyOriginalPath()
+                               ? request_headers.EnvoyOriginalPath()->value().getStringView()
+                               : request_headers.Path()->value().getStringView();
   static const size_t max_path_length = 128;
-  if (path.length() > max_path_length) {
-    path = path.substr(0, max_path_length);
-  }
+  path = path.substr(0, max_path_length);
 
-  return fmt::format("{}://{}{}", valueOrDefault(request_headers.ForwardedProto(), ""),
-                     valueOrDefault(request_headers.Host(), ""), path);
+  return absl::StrCat(valueOrDefault(request_headers.ForwardedProto(), ""), "://",
+                      valueOrDefault(request_headers.Host(), ""), path);
 }
 
 const std::string HttpTracerUtility::IngressOperation = "ingress";
@@ -124,14 +124,16 @@ static void annotateVerbose(Span& span, const StreamInfo::StreamInfo& stream_inf
 void HttpTracerUtility::finalizeSpan(Span& span, const Http::HeaderMap* request_headers,
                                      const StreamInfo::StreamInfo& stream_info,
                                      const Config& tracing_config) {
-  // Pre response data.
+  // Pre response data. The header values are passed to the span as views, which it copies only if
+  // it exports them.
   if (request_headers) {
     if (request_headers->RequestId()) {
       span.setTag(Tracing::Tags::get().GuidXRequestId,
-                  std::string(request_headers->RequestId()->value().c_str()));
+                  request_headers->RequestId()->value().getStringView());
     }
     span.setTag(Tracing::Tags::get().HttpUrl, buildUrl(*request_headers));
-    span.setTag(Tracing::Tags::get().HttpMethod, request_headers->Method()->value().c_str());
+    span.setTag(Tracing::Tags::get().HttpMethod,
+                request_headers->Method()->value().getStringView());
     span.setTag(Tracing::Tags::get().DownstreamCluster,
                 valueOrDefault(request_headers->EnvoyDownstreamServiceCluster(), "-"));
     span.setTag(Tracing::Tags::get().UserAgent, valueOrDefault(request_headers->UserAgent(), "-"));
@@ -140,14 +142,14 @@ void HttpTracerUtility::finalizeSpan(Span& span, const Http::HeaderMap* request_
 
     if (request_headers->ClientTraceId()) {
       span.setTag(Tracing::Tags::get().GuidXClientTraceId,
-                  std::string(request_headers->ClientTraceId()->value().c_str()));
+                  request_headers->ClientTraceId()->value().getStringView());
     }
 
     // Build tags based on the custom headers.
     for (const Http::LowerCaseString& header : tracing_config.requestHeadersForTags()) {
       const Http::HeaderEntry* entry = request_headers->get(header);
       if (entry) {
-        span.setTag(header.get(), entry->value().c_str());
+        span.setTag(header.get(), entry->value().getStringView());
       }
     }
   }
@@ -131,7 +131,7 @@ public:
 
   // Tracing::Span
   void setOperation(const std::string&) override {}
-  void setTag(const std::string&, const std::string&) override {}
+  void setTag(absl::string_view, absl::string_view) override {}
   void log(SystemTime, const std::string&) override {}
   void finishSpan() override {}
   void injectContext(Http::HeaderMap&) override {}
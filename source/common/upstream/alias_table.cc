@@ -0,0 +1,54 @@
+#include "common/upstream/alias_table.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+AliasTable::AliasTable(const std::vector<double>& weights) {
+  if (weights.empty()) {
+    return;
+  }
+
+  double total_weight = 0;
+  for (const double weight : weights) {
+    ASSERT(weight >= 0);
+    total_weight += weight;
+  }
+  ASSERT(total_weight > 0);
+
+  // Vose's algorithm: scale the weights so that they average 1, then repeatedly fill the bucket of
+  // a weight below 1 with the excess of a weight above 1.
+  const uint32_t size = weights.size();
+  std::vector<double> scaled(size);
+  std::vector<uint32_t> small;
+  std::vector<uint32_t> large;
+  for (uint32_t i = 0; i < size; ++i) {
+    scaled[i] = weights[i] * size / total_weight;
+    (scaled[i] < 1 ? small : large).push_back(i);
+  }
+
+  const double scale = 4294967296.0; // 2^32
+  buckets_.resize(size);
+  while (!small.empty() && !large.empty()) {
+    const uint32_t less = small.back();
+    small.pop_back();
+    const uint32_t more = large.back();
+    large.pop_back();
+
+    buckets_[less] = {static_cast<uint64_t>(scaled[less] * scale), less, more};
+    scaled[more] = (scaled[more] + scaled[less]) - 1;
+    (scaled[more] < 1 ? small : large).push_back(more);
+  }
+
+  // Whatever is left has a probability of 1, up to floating point error.
+  for (const uint32_t i : large) {
+    buckets_[i] = {1ULL << 32, i, i};
+  }
+  for (const uint32_t i : small) {
+    buckets_[i] = {1ULL << 32, i, i};
+  }
+}
+
+} // namespace Upstream
+} // namespace Envoy
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Alias method table (https://en.wikipedia.org/wiki/Alias_method) for O(1) weighted random
+ * selection. The table is built once in O(n) from a set of weights and is immutable afterwards,
+ * so a pick needs no mutable state and a table can be shared across threads.
+ */
+class AliasTable {
+public:
+  /**
+   * Build a table from non-negative weights whose sum is positive. An empty set of weights builds
+   * an empty table.
+   */
+  explicit AliasTable(const std::vector<double>& weights);
+
+  /**
+   * Pick an index with a probability proportional to its weight.
+   * @param random supplies a uniformly distributed random number. The low 32 bits pick a bucket
+   *        and the high 32 bits pick between the bucket and its alias.
+   * @return uint32_t the index of the picked weight. Must not be called on an empty table.
+   */
+  uint32_t pick(uint64_t random) const {
+    const Bucket& bucket = buckets_[(random & 0xFFFFFFFF) % buckets_.size()];
+    return (random >> 32) < bucket.threshold_ ? bucket.index_ : bucket.alias_;
+  }
+
+  uint32_t size() const { return buckets_.size(); }
+  bool empty() const { return buckets_.empty(); }
+
+private:
+  struct Bucket {
+    // The bucket's own index is picked when the high 32 bits of the random number are below
+    // threshold_, which is the bucket's probability scaled to 2^32.
+    uint64_t threshold_;
+    uint32_t index_;
+    uint32_t alias_;
+  };
+
+  std::vector<Bucket> buckets_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
@@ -1,12 +1,17 @@
 #include "common/upstream/cds_api_impl.h"
 
+#include <algorithm>
+#include <chrono>
 #include <string>
+#include <unordered_set>
 
 #include "envoy/api/v2/cds.pb.validate.h"
 #include "envoy/api/v2/cluster/outlier_detection.pb.validate.h"
 #include "envoy/stats/scope.h"
+#include "envoy/thread/thread.h"
 
 #include "common/common/cleanup.h"
+#include "common/common/hash.h"
 #include "common/common/utility.h"
 #include "common/config/resources.h"
 #include "common/config/subscription_factory.h"
@@ -20,14 +25,18 @@ CdsApiPtr CdsApiImpl::create(const envoy::api::v2::core::ConfigSource& cds_confi
                              ClusterManager& cm, Event::Dispatcher& dispatcher,
                              Runtime::RandomGenerator& random,
                              const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
-                             Api::Api& api) {
-  return CdsApiPtr{new CdsApiImpl(cds_config, cm, dispatcher, random, local_info, scope, api)};
+                             Api::Api& api, ThreadLocal::Instance& tls, uint32_t config_threads) {
+  return CdsApiPtr{new CdsApiImpl(cds_config, cm, dispatcher, random, local_info, scope, api, tls,
+                                  config_threads)};
 }
 
 CdsApiImpl::CdsApiImpl(const envoy::api::v2::core::ConfigSource& cds_config, ClusterManager& cm,
                        Event::Dispatcher& dispatcher, Runtime::RandomGenerator& random,
-                       const LocalInfo::LocalInfo& local_info, Stats::Scope& scope, Api::Api& api)
-    : cm_(cm), scope_(scope.createScope("cluster_manager.cds.")) {
+                       const LocalInfo::LocalInfo& local_info, Stats::Scope& scope, Api::Api& api,
+                       ThreadLocal::Instance& tls, uint32_t config_threads)
+    : cm_(cm), api_(api), tls_(tls), config_threads_(config_threads),
+      scope_(scope.createScope("cluster_manager.cds.")),
+      stats_({ALL_CDS_STATS(POOL_GAUGE(*scope_))}), validation_cache_(*scope_, api.timeSource()) {
   Config::Utility::checkLocalInfo("cds", local_info);
 
   const bool is_delta = (cds_config.api_config_source().api_type() ==
@@ -40,6 +49,11 @@ CdsApiImpl::CdsApiImpl(const envoy::api::v2::core::ConfigSource& cds_config, Clu
           "envoy.api.v2.ClusterDiscoveryService.FetchClusters", grpc_method, api);
 }
 
+void CdsApiImpl::initialize() {
+  init_start_time_ = api_.timeSource().monotonicTime();
+  subscription_->start({}, *this);
+}
+
 void CdsApiImpl::onConfigUpdate(const ResourceVector& resources, const std::string& version_info) {
   ClusterManager::ClusterInfoMap clusters_to_remove = cm_.clusters();
   for (const auto& cluster : resources) {
@@ -49,6 +63,19 @@ void CdsApiImpl::onConfigUpdate(const ResourceVector& resources, const std::stri
   for (const auto& cluster : clusters_to_remove) {
     *to_remove_repeated.Add() = cluster.first;
   }
+  // Declared on-demand clusters are not part of the clusters of the cluster manager.
+  const std::vector<std::string> declared_on_demand_clusters = cm_.declaredOnDemandClusters();
+  if (!declared_on_demand_clusters.empty()) {
+    std::unordered_set<std::string> cluster_names;
+    for (const auto& cluster : resources) {
+      cluster_names.insert(cluster.name());
+    }
+    for (const auto& cluster_name : declared_on_demand_clusters) {
+      if (cluster_names.count(cluster_name) == 0) {
+        *to_remove_repeated.Add() = cluster_name;
+      }
+    }
+  }
   Protobuf::RepeatedPtrField<envoy::api::v2::Resource> to_add_repeated;
   for (const auto& cluster : resources) {
     envoy::api::v2::Resource* to_add = to_add_repeated.Add();
@@ -66,13 +93,48 @@ void CdsApiImpl::onConfigUpdate(
   cm_.adsMux().pause(Config::TypeUrl::get().ClusterLoadAssignment);
   Cleanup eds_resume([this] { cm_.adsMux().resume(Config::TypeUrl::get().ClusterLoadAssignment); });
 
+  const MonotonicTime validation_start = api_.timeSource().monotonicTime();
+  std::vector<DecodedCluster> decoded_clusters = decodeClusters(added_resources);
+  // Deprecation checks use the runtime and stats, so they run here rather than with the rest of
+  // the validation. Clusters that passed validation in the last update are not checked again.
+  std::unordered_set<uint64_t> validated;
+  for (DecodedCluster& decoded : decoded_clusters) {
+    if (!decoded.unpack_error_.empty()) {
+      continue;
+    }
+    if (!decoded.previously_validated_) {
+      try {
+        MessageUtil::checkForDeprecation(decoded.cluster_);
+      } catch (const EnvoyException& e) {
+        decoded.deprecation_error_ = e.what();
+        continue;
+      }
+    }
+    if (decoded.validation_error_.empty()) {
+      validated.insert(decoded.hash_);
+    }
+  }
+  validation_cache_.replace(std::move(validated));
+  validation_cache_.recordValidationTime(validation_start);
+
+  // The thread local updates of all the added, updated and removed clusters reach each worker
+  // with a single post.
+  ThreadLocal::UpdateBatchPtr tls_batch = tls_.startUpdateBatch();
   std::vector<std::string> exception_msgs;
   std::unordered_set<std::string> cluster_names;
-  for (const auto& resource : added_resources) {
-    envoy::api::v2::Cluster cluster;
+  for (int i = 0; i < added_resources.size(); i++) {
+    const auto& resource = added_resources[i];
+    const envoy::api::v2::Cluster& cluster = decoded_clusters[i].cluster_;
     try {
-      cluster = MessageUtil::anyConvert<envoy::api::v2::Cluster>(resource.resource());
-      MessageUtil::validate(cluster);
+      if (!decoded_clusters[i].unpack_error_.empty()) {
+        throw EnvoyException(decoded_clusters[i].unpack_error_);
+      }
+      if (!decoded_clusters[i].deprecation_error_.empty()) {
+        throw EnvoyException(decoded_clusters[i].deprecation_error_);
+      }
+      if (!decoded_clusters[i].validation_error_.empty()) {
+        throw ProtoValidationException(decoded_clusters[i].validation_error_, cluster);
+      }
       if (!cluster_names.insert(cluster.name()).second) {
         throw EnvoyException(fmt::format("duplicate cluster {} found", cluster.name()));
       }
@@ -115,6 +177,7 @@ void CdsApiImpl::onConfigUpdate(
       ENVOY_LOG(debug, "cds: remove cluster '{}'", resource_name);
     }
   }
+  tls_batch.reset();
 
   runInitializeCallbackIfAny();
   if (!exception_msgs.empty()) {
@@ -124,6 +187,52 @@ void CdsApiImpl::onConfigUpdate(
   system_version_info_ = system_version_info;
 }
 
+std::vector<CdsApiImpl::DecodedCluster>
+CdsApiImpl::decodeClusters(const Protobuf::RepeatedPtrField<envoy::api::v2::Resource>& resources) {
+  std::vector<DecodedCluster> decoded_clusters(resources.size());
+  // Decodes and validates every stride-th resource starting at first. This only touches the
+  // resources and decoded_clusters, and reads the validation cache, so that it can run on the
+  // config threads.
+  const auto decode = [this, &resources, &decoded_clusters](int first, int stride) {
+    for (int i = first; i < resources.size(); i += stride) {
+      DecodedCluster& decoded = decoded_clusters[i];
+      const ProtobufWkt::Any& resource = resources[i].resource();
+      decoded.hash_ = HashUtil::xxHash64(resource.value(), HashUtil::xxHash64(resource.type_url()));
+      decoded.previously_validated_ = validation_cache_.contains(decoded.hash_);
+      try {
+        decoded.cluster_ = MessageUtil::anyConvert<envoy::api::v2::Cluster>(resource);
+      } catch (const EnvoyException& e) {
+        decoded.unpack_error_ = e.what();
+        continue;
+      }
+      if (decoded.previously_validated_) {
+        continue;
+      }
+      if (!Validate(decoded.cluster_, &decoded.validation_error_) &&
+          decoded.validation_error_.empty()) {
+        decoded.validation_error_ = "invalid cluster";
+      }
+    }
+  };
+
+  // Spreading small updates over threads costs more than it saves.
+  const int threads = std::min<int>(config_threads_, resources.size() / MinClustersPerConfigThread);
+  if (threads <= 1) {
+    decode(0, 1);
+    return decoded_clusters;
+  }
+
+  std::vector<Thread::ThreadPtr> config_threads;
+  for (int i = 0; i < threads; i++) {
+    config_threads.push_back(
+        api_.threadFactory().createThread([&decode, i, threads]() -> void { decode(i, threads); }));
+  }
+  for (auto& thread : config_threads) {
+    thread->join();
+  }
+  return decoded_clusters;
+}
+
 void CdsApiImpl::onConfigUpdateFailed(const EnvoyException*) {
   // We need to allow server startup to continue, even if we have a bad
   // config.
@@ -131,6 +240,12 @@ void CdsApiImpl::onConfigUpdateFailed(const EnvoyException*) {
 }
 
 void CdsApiImpl::runInitializeCallbackIfAny() {
+  if (init_start_time_.has_value()) {
+    stats_.init_duration_ms_.set(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     api_.timeSource().monotonicTime() - init_start_time_.value())
+                                     .count());
+    init_start_time_.reset();
+  }
   if (initialize_callback_) {
     initialize_callback_();
     initialize_callback_ = nullptr;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <string>
+#include <vector>
 
 #include "envoy/api/api.h"
 #include "envoy/api/v2/cds.pb.h"
@@ -8,13 +10,33 @@
 #include "envoy/event/dispatcher.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/common/logger.h"
+#include "common/config/validation_cache.h"
+
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Upstream {
 
+/**
+ * All CDS API stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_CDS_STATS(GAUGE)                                                                       \
+  GAUGE(init_duration_ms)
+// clang-format on
+
+/**
+ * Struct definition for all CDS API stats. @see stats_macros.h
+ */
+struct CdsStats {
+  ALL_CDS_STATS(GENERATE_GAUGE_STRUCT)
+};
+
 /**
  * CDS API implementation that fetches via Subscription.
  */
@@ -25,10 +47,10 @@ public:
   static CdsApiPtr create(const envoy::api::v2::core::ConfigSource& cds_config, ClusterManager& cm,
                           Event::Dispatcher& dispatcher, Runtime::RandomGenerator& random,
                           const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
-                          Api::Api& api);
+                          Api::Api& api, ThreadLocal::Instance& tls, uint32_t config_threads);
 
   // Upstream::CdsApi
-  void initialize() override { subscription_->start({}, *this); }
+  void initialize() override;
   void setInitializedCb(std::function<void()> callback) override {
     initialize_callback_ = callback;
   }
@@ -45,16 +67,40 @@ public:
   }
 
 private:
+  // A cluster decoded from a CDS resource, along with the errors from decoding and validating it.
+  struct DecodedCluster {
+    envoy::api::v2::Cluster cluster_;
+    // Hash of the encoded resource, which identifies it in the validation cache.
+    uint64_t hash_{};
+    // Whether the resource passed validation in the last update, so that it was not validated.
+    bool previously_validated_{};
+    std::string unpack_error_;
+    std::string deprecation_error_;
+    std::string validation_error_;
+  };
+
   CdsApiImpl(const envoy::api::v2::core::ConfigSource& cds_config, ClusterManager& cm,
              Event::Dispatcher& dispatcher, Runtime::RandomGenerator& random,
-             const LocalInfo::LocalInfo& local_info, Stats::Scope& scope, Api::Api& api);
+             const LocalInfo::LocalInfo& local_info, Stats::Scope& scope, Api::Api& api,
+             ThreadLocal::Instance& tls, uint32_t config_threads);
+  // Updates with fewer clusters per config thread than this are decoded on the main thread.
+  static constexpr int MinClustersPerConfigThread = 64;
+
+  std::vector<DecodedCluster>
+  decodeClusters(const Protobuf::RepeatedPtrField<envoy::api::v2::Resource>& resources);
   void runInitializeCallbackIfAny();
 
   ClusterManager& cm_;
+  Api::Api& api_;
+  ThreadLocal::Instance& tls_;
+  const uint32_t config_threads_;
   std::unique_ptr<Config::Subscription<envoy::api::v2::Cluster>> subscription_;
   std::string system_version_info_;
   std::function<void()> initialize_callback_;
   Stats::ScopePtr scope_;
+  CdsStats stats_;
+  Config::ValidationCache validation_cache_;
+  absl::optional<MonotonicTime> init_start_time_;
 };
 
 } // namespace Upstream
@@ -109,7 +109,8 @@ ClusterSharedPtr ClusterFactoryImplBase::create(const envoy::api::v2::Cluster& c
     } else {
       new_cluster->setHealthChecker(HealthCheckerFactory::create(
           cluster.health_checks()[0], *new_cluster, context.runtime(), context.random(),
-          context.dispatcher(), context.logManager()));
+          context.dispatcher(), context.logManager(),
+          context.clusterManager().healthCheckerDispatcherPool()));
     }
   }
 
@@ -31,6 +31,7 @@
 #include "common/router/shadow_writer_impl.h"
 #include "common/tcp/conn_pool.h"
 #include "common/upstream/cds_api_impl.h"
+#include "common/upstream/health_checker_dispatcher_pool.h"
 #include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/maglev_lb.h"
 #include "common/upstream/original_dst_cluster.h"
@@ -182,9 +183,13 @@ ClusterManagerImpl::ClusterManagerImpl(
           admin.getConfigTracker().add("clusters", [this] { return dumpClusterConfigs(); })),
       time_source_(main_thread_dispatcher.timeSource()), dispatcher_(main_thread_dispatcher),
       http_context_(http_context) {
-  async_client_manager_ =
-      std::make_unique<Grpc::AsyncClientManagerImpl>(*this, tls, time_source_, api);
   const auto& cm_config = bootstrap.cluster_manager();
+  async_client_manager_ = std::make_unique<Grpc::AsyncClientManagerImpl>(
+      *this, tls, time_source_, api, cm_config.google_grpc_completion_threads());
+  if (cm_config.health_check_threads() > 0) {
+    health_checker_dispatcher_pool_ =
+        std::make_shared<HealthCheckerDispatcherPoolImpl>(api, cm_config.health_check_threads());
+  }
   if (cm_config.has_outlier_detection()) {
     const std::string event_log_file_path = cm_config.outlier_detection().event_log_path();
     if (!event_log_file_path.empty()) {
@@ -251,7 +256,8 @@ ClusterManagerImpl::ClusterManagerImpl(
 
   // We can now potentially create the CDS API once the backing cluster exists.
   if (bootstrap.dynamic_resources().has_cds_config()) {
-    cds_api_ = factory_.createCds(bootstrap.dynamic_resources().cds_config(), *this);
+    cds_api_ = factory_.createCds(bootstrap.dynamic_resources().cds_config(),
+                                  bootstrap.cluster_manager().cds_config_threads(), *this);
     init_helper_.setCds(cds_api_.get());
   } else {
     init_helper_.setCds(nullptr);
@@ -354,6 +360,9 @@ void ClusterManagerImpl::onClusterInit(Cluster& cluster) {
     }
     postThreadLocalClusterUpdate(cluster, host_set->priority(), host_set->hosts(), HostVector{});
   }
+
+  // Requests waiting for an on-demand cluster can proceed now.
+  finishOnDemandRequests(cluster.info()->name(), true);
 }
 
 bool ClusterManagerImpl::scheduleUpdate(const Cluster& cluster, uint32_t priority, bool mergeable,
@@ -442,6 +451,14 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::api::v2::Cluster& clust
   const auto existing_active_cluster = active_clusters_.find(cluster_name);
   const auto existing_warming_cluster = warming_clusters_.find(cluster_name);
   const uint64_t new_hash = MessageUtil::hash(cluster);
+  if (cluster.has_on_demand() && existing_active_cluster == active_clusters_.end() &&
+      existing_warming_cluster == warming_clusters_.end()) {
+    const auto existing_on_demand_cluster = on_demand_clusters_.find(cluster_name);
+    if (existing_on_demand_cluster == on_demand_clusters_.end() ||
+        !existing_on_demand_cluster->second->instantiated_) {
+      return declareOnDemandCluster(cluster, version_info, new_hash);
+    }
+  }
   if ((existing_active_cluster != active_clusters_.end() &&
        existing_active_cluster->second->blockUpdate(new_hash)) ||
       (existing_warming_cluster != warming_clusters_.end() &&
@@ -459,6 +476,26 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::api::v2::Cluster& clust
     cm_stats_.cluster_added_.inc();
   }
 
+  if (cluster.has_on_demand()) {
+    auto& on_demand = on_demand_clusters_[cluster_name];
+    if (on_demand == nullptr) {
+      on_demand = std::make_unique<OnDemandCluster>();
+      Thread::LockGuard lock(on_demand_names_lock_);
+      on_demand_names_.insert(cluster_name);
+    }
+    on_demand->config_ = cluster;
+    on_demand->config_hash_ = new_hash;
+    on_demand->version_info_ = version_info;
+    on_demand->instantiated_ = true;
+    enableOnDemandIdleTimer(cluster_name, *on_demand);
+  } else if (on_demand_clusters_.count(cluster_name) > 0) {
+    // The cluster is not on-demand anymore.
+    finishOnDemandRequests(cluster_name, false);
+    on_demand_clusters_.erase(cluster_name);
+    Thread::LockGuard lock(on_demand_names_lock_);
+    on_demand_names_.erase(cluster_name);
+  }
+
   // There are two discrete paths here depending on when we are adding/updating a cluster.
   // 1) During initial server load we use the init manager which handles complex logic related to
   //    primary/secondary init, static/CDS init, warming all clusters, etc.
@@ -506,8 +543,18 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::api::v2::Cluster& clust
 }
 
 void ClusterManagerImpl::createOrUpdateThreadLocalCluster(ClusterData& cluster) {
+  // The subset load balancers of the workers share the hosts of their subsets, and the zone aware
+  // load balancers share their locality routing state.
+  SubsetHostsCacheSharedPtr subset_hosts_cache;
+  LocalityRoutingCacheSharedPtr locality_routing_cache;
+  if (cluster.cluster_->info()->lbSubsetInfo().isEnabled()) {
+    subset_hosts_cache = std::make_shared<SubsetHostsCache>();
+  } else if (!local_cluster_name_.empty()) {
+    locality_routing_cache = std::make_shared<LocalityRoutingCache>();
+  }
   tls_->runOnAllThreads([this, new_cluster = cluster.cluster_->info(),
-                         thread_aware_lb_factory = cluster.loadBalancerFactory()]() -> void {
+                         thread_aware_lb_factory = cluster.loadBalancerFactory(),
+                         subset_hosts_cache, locality_routing_cache]() -> void {
     ThreadLocalClusterManagerImpl& cluster_manager =
         tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
@@ -518,7 +565,8 @@ void ClusterManagerImpl::createOrUpdateThreadLocalCluster(ClusterData& cluster)
     }
 
     auto thread_local_cluster = new ThreadLocalClusterManagerImpl::ClusterEntry(
-        cluster_manager, new_cluster, thread_aware_lb_factory);
+        cluster_manager, new_cluster, thread_aware_lb_factory, subset_hosts_cache,
+        locality_routing_cache);
     cluster_manager.thread_local_clusters_[new_cluster->name()].reset(thread_local_cluster);
     for (auto& cb : cluster_manager.update_callbacks_) {
       cb->onClusterAddOrUpdate(*thread_local_cluster);
@@ -527,6 +575,26 @@ void ClusterManagerImpl::createOrUpdateThreadLocalCluster(ClusterData& cluster)
 }
 
 bool ClusterManagerImpl::removeCluster(const std::string& cluster_name) {
+  bool removed = removeActiveOrWarmingCluster(cluster_name);
+
+  const auto on_demand = on_demand_clusters_.find(cluster_name);
+  if (on_demand != on_demand_clusters_.end()) {
+    if (!on_demand->second->instantiated_) {
+      ENVOY_LOG(info, "removing declared on-demand cluster {}", cluster_name);
+      removed = true;
+      cm_stats_.cluster_removed_.inc();
+      cm_stats_.declared_on_demand_clusters_.dec();
+    }
+    finishOnDemandRequests(cluster_name, false);
+    on_demand_clusters_.erase(on_demand);
+    Thread::LockGuard lock(on_demand_names_lock_);
+    on_demand_names_.erase(cluster_name);
+  }
+
+  return removed;
+}
+
+bool ClusterManagerImpl::removeActiveOrWarmingCluster(const std::string& cluster_name) {
   bool removed = false;
   auto existing_active_cluster = active_clusters_.find(cluster_name);
   if (existing_active_cluster != active_clusters_.end() &&
@@ -573,7 +641,21 @@ void ClusterManagerImpl::loadCluster(const envoy::api::v2::Cluster& cluster,
   ClusterSharedPtr new_cluster =
       factory_.clusterFromProto(cluster, *this, outlier_event_logger_, added_via_api);
 
+  ThreadAwareLoadBalancerPtr cluster_provided_lb;
+  if (new_cluster->info()->lbType() == LoadBalancerType::ClusterProvided) {
+    cluster_provided_lb = new_cluster->createThreadAwareLoadBalancer();
+    if (cluster_provided_lb == nullptr) {
+      throw EnvoyException(fmt::format("cluster manager: cluster '{}' does not provide a load "
+                                       "balancer for LB type 'cluster_provided'",
+                                       cluster.name()));
+    }
+  }
+
   if (!added_via_api) {
+    if (cluster.has_on_demand()) {
+      throw EnvoyException(fmt::format(
+          "cluster manager: on_demand is not supported for static cluster '{}'", cluster.name()));
+    }
     if (cluster_map.find(new_cluster->info()->name()) != cluster_map.end()) {
       throw EnvoyException(
           fmt::format("cluster manager: duplicate cluster '{}'", new_cluster->info()->name()));
@@ -608,18 +690,168 @@ void ClusterManagerImpl::loadCluster(const envoy::api::v2::Cluster& cluster,
   if (cluster_reference.info()->lbType() == LoadBalancerType::RingHash) {
     cluster_entry_it->second->thread_aware_lb_ = std::make_unique<RingHashLoadBalancer>(
         cluster_reference.prioritySet(), cluster_reference.info()->stats(),
-        cluster_reference.info()->statsScope(), runtime_, random_,
+        cluster_reference.info()->statsScope(), runtime_, random_, time_source_,
         cluster_reference.info()->lbRingHashConfig(), cluster_reference.info()->lbConfig());
   } else if (cluster_reference.info()->lbType() == LoadBalancerType::Maglev) {
     cluster_entry_it->second->thread_aware_lb_ = std::make_unique<MaglevLoadBalancer>(
         cluster_reference.prioritySet(), cluster_reference.info()->stats(),
-        cluster_reference.info()->statsScope(), runtime_, random_,
+        cluster_reference.info()->statsScope(), runtime_, random_, time_source_,
         cluster_reference.info()->lbConfig());
+  } else if (cluster_reference.info()->lbType() == LoadBalancerType::ClusterProvided) {
+    cluster_entry_it->second->thread_aware_lb_ = std::move(cluster_provided_lb);
   }
 
   updateGauges();
 }
 
+bool ClusterManagerImpl::declareOnDemandCluster(const envoy::api::v2::Cluster& cluster,
+                                                const std::string& version_info,
+                                                uint64_t config_hash) {
+  auto& on_demand = on_demand_clusters_[cluster.name()];
+  if (on_demand == nullptr) {
+    on_demand = std::make_unique<OnDemandCluster>();
+    cm_stats_.declared_on_demand_clusters_.inc();
+    Thread::LockGuard lock(on_demand_names_lock_);
+    on_demand_names_.insert(cluster.name());
+  } else if (on_demand->config_hash_ == config_hash) {
+    return false;
+  }
+
+  ENVOY_LOG(debug, "declare on-demand cluster {}", cluster.name());
+  on_demand->config_ = cluster;
+  on_demand->config_hash_ = config_hash;
+  on_demand->version_info_ = version_info;
+  return true;
+}
+
+OnDemandClusterHandlePtr
+ClusterManagerImpl::requestOnDemandCluster(const std::string& cluster,
+                                           Event::Dispatcher& dispatcher,
+                                           OnDemandClusterCallback callback) {
+  {
+    Thread::LockGuard lock(on_demand_names_lock_);
+    if (on_demand_names_.count(cluster) == 0) {
+      return nullptr;
+    }
+  }
+
+  // The cluster is instantiated on the main thread, and the callback is posted back to the
+  // requesting thread, after the thread local cluster update that was posted when the cluster
+  // finished warming.
+  auto handle = std::make_unique<OnDemandClusterHandleImpl>();
+  std::shared_ptr<bool> cancelled = handle->cancelled_;
+  dispatcher_.post([this, cluster, &dispatcher, cancelled, callback]() -> void {
+    instantiateOnDemandCluster(cluster, [&dispatcher, cancelled, callback](bool available) -> void {
+      dispatcher.post([cancelled, callback, available]() -> void {
+        if (!*cancelled) {
+          callback(available);
+        }
+      });
+    });
+  });
+  return std::move(handle);
+}
+
+std::vector<std::string> ClusterManagerImpl::declaredOnDemandClusters() const {
+  std::vector<std::string> names;
+  for (const auto& on_demand : on_demand_clusters_) {
+    if (!on_demand.second->instantiated_) {
+      names.push_back(on_demand.first);
+    }
+  }
+  return names;
+}
+
+void ClusterManagerImpl::instantiateOnDemandCluster(const std::string& cluster_name,
+                                                    OnDemandClusterCallback callback) {
+  const auto it = on_demand_clusters_.find(cluster_name);
+  if (it == on_demand_clusters_.end()) {
+    // The cluster was removed after it was requested.
+    callback(false);
+    return;
+  }
+  if (active_clusters_.count(cluster_name) > 0) {
+    callback(true);
+    return;
+  }
+
+  OnDemandCluster& on_demand = *it->second;
+  on_demand.requests_.push_back(callback);
+  if (on_demand.instantiated_) {
+    // The cluster is warming already.
+    return;
+  }
+
+  ENVOY_LOG(info, "instantiating on-demand cluster {}", cluster_name);
+  on_demand.instantiated_ = true;
+  cm_stats_.declared_on_demand_clusters_.dec();
+  cm_stats_.cluster_on_demand_instantiated_.inc();
+  // The requests are completed by onClusterInit() once the cluster finished warming.
+  const envoy::api::v2::Cluster config = on_demand.config_;
+  try {
+    addOrUpdateCluster(config, on_demand.version_info_,
+                       [](const std::string&, ClusterWarmingState) {});
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG(warn, "unable to instantiate on-demand cluster {}: {}", cluster_name, e.what());
+    on_demand.instantiated_ = false;
+    cm_stats_.declared_on_demand_clusters_.inc();
+    finishOnDemandRequests(cluster_name, false);
+  }
+}
+
+void ClusterManagerImpl::finishOnDemandRequests(const std::string& cluster_name, bool available) {
+  const auto it = on_demand_clusters_.find(cluster_name);
+  if (it == on_demand_clusters_.end() || it->second->requests_.empty()) {
+    return;
+  }
+  std::list<OnDemandClusterCallback> requests;
+  requests.swap(it->second->requests_);
+  for (const auto& request : requests) {
+    request(available);
+  }
+}
+
+void ClusterManagerImpl::enableOnDemandIdleTimer(const std::string& cluster_name,
+                                                 OnDemandCluster& on_demand) {
+  if (!on_demand.config_.on_demand().has_idle_timeout()) {
+    on_demand.idle_timer_.reset();
+    return;
+  }
+  if (on_demand.idle_timer_ == nullptr) {
+    on_demand.idle_timer_ = dispatcher_.createTimer(
+        [this, cluster_name]() -> void { onOnDemandIdleTimeout(cluster_name); });
+  }
+  on_demand.idle_timer_->enableTimer(std::chrono::milliseconds(
+      PROTOBUF_GET_MS_REQUIRED(on_demand.config_.on_demand(), idle_timeout)));
+}
+
+void ClusterManagerImpl::onOnDemandIdleTimeout(const std::string& cluster_name) {
+  OnDemandCluster& on_demand = *on_demand_clusters_.at(cluster_name);
+  ASSERT(on_demand.instantiated_);
+  const auto active_cluster = active_clusters_.find(cluster_name);
+  // A cluster is idle when it had no new requests or connections since the last check, and has
+  // none active. Clusters that are warming are checked again later.
+  if (active_cluster != active_clusters_.end() && warming_clusters_.count(cluster_name) == 0) {
+    const ClusterStats& stats = active_cluster->second->cluster_->info()->stats();
+    const uint64_t rq_total = stats.upstream_rq_total_.value();
+    const uint64_t cx_total = stats.upstream_cx_total_.value();
+    if (rq_total == on_demand.last_rq_total_ && cx_total == on_demand.last_cx_total_ &&
+        stats.upstream_rq_active_.value() == 0 && stats.upstream_cx_active_.value() == 0) {
+      ENVOY_LOG(info, "removing idle on-demand cluster {}", cluster_name);
+      removeActiveOrWarmingCluster(cluster_name);
+      on_demand.instantiated_ = false;
+      on_demand.last_rq_total_ = 0;
+      on_demand.last_cx_total_ = 0;
+      cm_stats_.cluster_on_demand_evicted_.inc();
+      cm_stats_.declared_on_demand_clusters_.inc();
+      return;
+    }
+    on_demand.last_rq_total_ = rq_total;
+    on_demand.last_cx_total_ = cx_total;
+  }
+  enableOnDemandIdleTimer(cluster_name, on_demand);
+}
+
 void ClusterManagerImpl::updateGauges() {
   cm_stats_.active_clusters_.set(active_clusters_.size());
   cm_stats_.warming_clusters_.set(warming_clusters_.size());
@@ -676,26 +908,21 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(const Cluster& cluster, ui
                                                       const HostVector& hosts_removed) {
   const auto& host_set = cluster.prioritySet().hostSetsPerPriority()[priority];
 
-  // TODO(htuch): Can we skip these copies by exporting out const shared_ptr from HostSet?
-  HostVectorConstSharedPtr hosts_copy(new HostVector(host_set->hosts()));
-  HostVectorConstSharedPtr healthy_hosts_copy(new HostVector(host_set->healthyHosts()));
-  HostVectorConstSharedPtr degraded_hosts_copy(new HostVector(host_set->degradedHosts()));
-  HostsPerLocalityConstSharedPtr hosts_per_locality_copy = host_set->hostsPerLocality().clone();
-  HostsPerLocalityConstSharedPtr healthy_hosts_per_locality_copy =
-      host_set->healthyHostsPerLocality().clone();
-  HostsPerLocalityConstSharedPtr degraded_hosts_per_locality_copy =
-      host_set->degradedHostsPerLocality().clone();
-
-  tls_->runOnAllThreads([this, name = cluster.info()->name(), priority, hosts_copy,
-                         healthy_hosts_copy, degraded_hosts_copy, hosts_per_locality_copy,
-                         healthy_hosts_per_locality_copy, degraded_hosts_per_locality_copy,
+  // The host set's vectors are immutable, so every worker shares them rather than a copy: a worker
+  // adopts the new host set by swapping pointers.
+  tls_->runOnAllThreads([this, name = cluster.info()->name(), priority,
+                         hosts = host_set->hostsPtr(), healthy_hosts = host_set->healthyHostsPtr(),
+                         degraded_hosts = host_set->degradedHostsPtr(),
+                         hosts_per_locality = host_set->hostsPerLocalityPtr(),
+                         healthy_hosts_per_locality = host_set->healthyHostsPerLocalityPtr(),
+                         degraded_hosts_per_locality = host_set->degradedHostsPerLocalityPtr(),
                          locality_weights = host_set->localityWeights(), hosts_added, hosts_removed,
                          overprovisioning_factor = host_set->overprovisioningFactor()]() {
     ThreadLocalClusterManagerImpl::updateClusterMembership(
         name, priority,
-        HostSetImpl::updateHostsParams(hosts_copy, hosts_per_locality_copy, healthy_hosts_copy,
-                                       healthy_hosts_per_locality_copy, degraded_hosts_copy,
-                                       degraded_hosts_per_locality_copy),
+        HostSetImpl::updateHostsParams(hosts, hosts_per_locality, healthy_hosts,
+                                       healthy_hosts_per_locality, degraded_hosts,
+                                       degraded_hosts_per_locality),
         locality_weights, hosts_added, hosts_removed, *tls_, overprovisioning_factor);
   });
 }
@@ -985,6 +1212,12 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::updateClusterMembership(
     ENVOY_LOG(debug, "re-creating local LB for TLS cluster {}", name);
     cluster_entry->lb_ = cluster_entry->lb_factory_->create();
   }
+
+  if (cluster_entry->cluster_info_->prefetchOnHostAdd()) {
+    for (const HostSharedPtr& host : hosts_added) {
+      cluster_entry->prefetchConnPool(host);
+    }
+  }
 }
 
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::onHostHealthFailure(
@@ -1052,7 +1285,9 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::getHttpConnPoolsContainer(
 
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
     ThreadLocalClusterManagerImpl& parent, ClusterInfoConstSharedPtr cluster,
-    const LoadBalancerFactorySharedPtr& lb_factory)
+    const LoadBalancerFactorySharedPtr& lb_factory,
+    const SubsetHostsCacheSharedPtr& subset_hosts_cache,
+    const LocalityRoutingCacheSharedPtr& locality_routing_cache)
     : parent_(parent), lb_factory_(lb_factory), cluster_info_(cluster),
       http_async_client_(cluster, parent.parent_.stats_, parent.thread_local_dispatcher_,
                          parent.parent_.local_info_, parent.parent_, parent.parent_.runtime_,
@@ -1067,42 +1302,47 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
     lb_ = std::make_unique<SubsetLoadBalancer>(
         cluster->lbType(), priority_set_, parent_.local_priority_set_, cluster->stats(),
         cluster->statsScope(), parent.parent_.runtime_, parent.parent_.random_,
-        cluster->lbSubsetInfo(), cluster->lbRingHashConfig(), cluster->lbLeastRequestConfig(),
-        cluster->lbConfig());
+        parent.parent_.time_source_, cluster->lbSubsetInfo(), cluster->lbRingHashConfig(),
+        cluster->lbLeastRequestConfig(), cluster->lbConfig(), subset_hosts_cache);
   } else {
     switch (cluster->lbType()) {
     case LoadBalancerType::LeastRequest: {
       ASSERT(lb_factory_ == nullptr);
       lb_ = std::make_unique<LeastRequestLoadBalancer>(
           priority_set_, parent_.local_priority_set_, cluster->stats(), parent.parent_.runtime_,
-          parent.parent_.random_, cluster->lbConfig(), cluster->lbLeastRequestConfig());
+          parent.parent_.random_, cluster->lbConfig(), cluster->lbLeastRequestConfig(),
+          locality_routing_cache);
       break;
     }
     case LoadBalancerType::Random: {
       ASSERT(lb_factory_ == nullptr);
-      lb_ = std::make_unique<RandomLoadBalancer>(priority_set_, parent_.local_priority_set_,
-                                                 cluster->stats(), parent.parent_.runtime_,
-                                                 parent.parent_.random_, cluster->lbConfig());
+      lb_ = std::make_unique<RandomLoadBalancer>(
+          priority_set_, parent_.local_priority_set_, cluster->stats(), parent.parent_.runtime_,
+          parent.parent_.random_, cluster->lbConfig(), locality_routing_cache);
       break;
     }
     case LoadBalancerType::RoundRobin: {
       ASSERT(lb_factory_ == nullptr);
-      lb_ = std::make_unique<RoundRobinLoadBalancer>(priority_set_, parent_.local_priority_set_,
-                                                     cluster->stats(), parent.parent_.runtime_,
-                                                     parent.parent_.random_, cluster->lbConfig());
+      lb_ = std::make_unique<RoundRobinLoadBalancer>(
+          priority_set_, parent_.local_priority_set_, cluster->stats(), parent.parent_.runtime_,
+          parent.parent_.random_, cluster->lbConfig(), locality_routing_cache);
       break;
     }
     case LoadBalancerType::RingHash:
-    case LoadBalancerType::Maglev: {
+    case LoadBalancerType::Maglev:
+    case LoadBalancerType::ClusterProvided: {
       ASSERT(lb_factory_ != nullptr);
       lb_ = lb_factory_->create();
       break;
     }
     case LoadBalancerType::OriginalDst: {
       ASSERT(lb_factory_ == nullptr);
+      // The load balancer owns this worker's original destination hosts, and has their connection
+      // pools drained when they expire.
       lb_ = std::make_unique<OriginalDstCluster::LoadBalancer>(
-          priority_set_, parent.parent_.active_clusters_.at(cluster->name())->cluster_,
-          cluster->lbOriginalDstConfig());
+          parent.parent_.active_clusters_.at(cluster->name())->cluster_,
+          cluster->lbOriginalDstConfig(), parent.thread_local_dispatcher_,
+          [&parent](const HostVector& hosts_removed) { parent.drainConnPools(hosts_removed); });
       break;
     }
     }
@@ -1167,6 +1407,29 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
   }
 }
 
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::prefetchConnPool(
+    const HostConstSharedPtr& host) {
+  // Warm the pool that connPool() selects for requests without downstream socket options.
+  const Http::Protocol protocol = (cluster_info_->features() & ClusterInfo::Features::HTTP2)
+                                      ? Http::Protocol::Http2
+                                      : Http::Protocol::Http11;
+  std::vector<uint8_t> hash_key = {uint8_t(protocol)};
+
+  ConnPoolsContainer& container = *parent_.getHttpConnPoolsContainer(host, true);
+  ConnPoolsContainer::ConnPools::OptPoolRef pool =
+      container.pools_->getPool(ResourcePriority::Default, hash_key, [&]() {
+        return parent_.parent_.factory_.allocateConnPool(parent_.thread_local_dispatcher_, host,
+                                                         ResourcePriority::Default, protocol,
+                                                         nullptr);
+      });
+
+  if (pool.has_value()) {
+    ENVOY_LOG(debug, "prefetching connection to {} for TLS cluster {}", host->address()->asString(),
+              cluster_info_->name());
+    pool.value().get().prefetchConnection();
+  }
+}
+
 Tcp::ConnectionPool::Instance*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPool(
     ResourcePriority priority, LoadBalancerContext* context,
@@ -1249,9 +1512,9 @@ ClusterSharedPtr ProdClusterManagerFactory::clusterFromProto(
 }
 
 CdsApiPtr ProdClusterManagerFactory::createCds(const envoy::api::v2::core::ConfigSource& cds_config,
-                                               ClusterManager& cm) {
+                                               uint32_t config_threads, ClusterManager& cm) {
   return CdsApiImpl::create(cds_config, cm, main_thread_dispatcher_, random_, local_info_, stats_,
-                            api_);
+                            api_, tls_, config_threads);
 }
 
 } // namespace Upstream
@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "envoy/api/api.h"
@@ -20,10 +21,15 @@
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 #include "common/config/grpc_mux_impl.h"
 #include "common/http/async_client_impl.h"
+#include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/load_stats_reporter.h"
 #include "common/upstream/priority_conn_pool_map.h"
+#include "common/upstream/subset_lb.h"
 #include "common/upstream/upstream_impl.h"
 
 namespace Envoy {
@@ -65,7 +71,7 @@ public:
                                     Outlier::EventLoggerSharedPtr outlier_event_logger,
                                     bool added_via_api) override;
   CdsApiPtr createCds(const envoy::api::v2::core::ConfigSource& cds_config,
-                      ClusterManager& cm) override;
+                      uint32_t config_threads, ClusterManager& cm) override;
   Secret::SecretManager& secretManager() override { return secret_manager_; }
 
 protected:
@@ -125,6 +131,14 @@ public:
 private:
   void maybeFinishInitialize();
   void onClusterInit(Cluster& cluster);
+  bool declareOnDemandCluster(const envoy::api::v2::Cluster& cluster,
+                              const std::string& version_info, uint64_t config_hash);
+  void instantiateOnDemandCluster(const std::string& cluster_name,
+                                  OnDemandClusterCallback callback);
+  void finishOnDemandRequests(const std::string& cluster_name, bool available);
+  void enableOnDemandIdleTimer(const std::string& cluster_name, OnDemandCluster& on_demand);
+  void onOnDemandIdleTimeout(const std::string& cluster_name);
+  bool removeActiveOrWarmingCluster(const std::string& cluster_name);
 
   std::function<void(Cluster& cluster)> per_cluster_init_callback_;
   CdsApi* cds_{};
@@ -142,12 +156,15 @@ private:
 #define ALL_CLUSTER_MANAGER_STATS(COUNTER, GAUGE)                                                  \
   COUNTER(cluster_added)                                                                           \
   COUNTER(cluster_modified)                                                                        \
+  COUNTER(cluster_on_demand_evicted)                                                               \
+  COUNTER(cluster_on_demand_instantiated)                                                          \
   COUNTER(cluster_removed)                                                                         \
   COUNTER(cluster_updated)                                                                         \
   COUNTER(cluster_updated_via_merge)                                                               \
   COUNTER(update_merge_cancelled)                                                                  \
   COUNTER(update_out_of_merge_window)                                                              \
   GAUGE  (active_clusters)                                                                         \
+  GAUGE  (declared_on_demand_clusters)                                                             \
   GAUGE  (warming_clusters)
 // clang-format on
 
@@ -205,6 +222,7 @@ public:
   void shutdown() override {
     cds_api_.reset();
     ads_mux_.reset();
+    on_demand_clusters_.clear();
     active_clusters_.clear();
   }
 
@@ -222,6 +240,14 @@ public:
 
   std::size_t warmingClusterCount() const override { return warming_clusters_.size(); }
 
+  HealthCheckerDispatcherPoolSharedPtr healthCheckerDispatcherPool() override {
+    return health_checker_dispatcher_pool_;
+  }
+  OnDemandClusterHandlePtr requestOnDemandCluster(const std::string& cluster,
+                                                  Event::Dispatcher& dispatcher,
+                                                  OnDemandClusterCallback callback) override;
+  std::vector<std::string> declaredOnDemandClusters() const override;
+
 protected:
   virtual void postThreadLocalHostRemoval(const Cluster& cluster, const HostVector& hosts_removed);
   virtual void postThreadLocalClusterUpdate(const Cluster& cluster, uint32_t priority,
@@ -283,7 +309,9 @@ private:
 
     struct ClusterEntry : public ThreadLocalCluster {
       ClusterEntry(ThreadLocalClusterManagerImpl& parent, ClusterInfoConstSharedPtr cluster,
-                   const LoadBalancerFactorySharedPtr& lb_factory);
+                   const LoadBalancerFactorySharedPtr& lb_factory,
+                   const SubsetHostsCacheSharedPtr& subset_hosts_cache,
+                   const LocalityRoutingCacheSharedPtr& locality_routing_cache);
       ~ClusterEntry();
 
       Http::ConnectionPool::Instance* connPool(ResourcePriority priority, Http::Protocol protocol,
@@ -293,6 +321,8 @@ private:
       tcpConnPool(ResourcePriority priority, LoadBalancerContext* context,
                   Network::TransportSocketOptionsSharedPtr transport_socket_options);
 
+      void prefetchConnPool(const HostConstSharedPtr& host);
+
       // Upstream::ThreadLocalCluster
       const PrioritySet& prioritySet() override { return priority_set_; }
       ClusterInfoConstSharedPtr info() override { return cluster_info_; }
@@ -418,6 +448,30 @@ private:
     // (the expected behavior).
     MonotonicTime last_updated_;
   };
+  // A cluster with an on-demand config, which is either only declared or instantiated, i.e. in
+  // the active or warming clusters.
+  struct OnDemandCluster {
+    envoy::api::v2::Cluster config_;
+    uint64_t config_hash_{};
+    std::string version_info_;
+    bool instantiated_{};
+    // Callbacks of the requests waiting for the cluster to finish warming.
+    std::list<OnDemandClusterCallback> requests_;
+    // Checks whether an instantiated cluster became idle.
+    Event::TimerPtr idle_timer_;
+    uint64_t last_rq_total_{};
+    uint64_t last_cx_total_{};
+  };
+  typedef std::unique_ptr<OnDemandCluster> OnDemandClusterPtr;
+
+  struct OnDemandClusterHandleImpl : public OnDemandClusterHandle {
+    OnDemandClusterHandleImpl() : cancelled_(std::make_shared<bool>(false)) {}
+    ~OnDemandClusterHandleImpl() override { *cancelled_ = true; }
+
+    // Only accessed on the requesting thread.
+    std::shared_ptr<bool> cancelled_;
+  };
+
   using PendingUpdatesPtr = std::unique_ptr<PendingUpdates>;
   using PendingUpdatesByPriorityMap = std::unordered_map<uint32_t, PendingUpdatesPtr>;
   using PendingUpdatesByPriorityMapPtr = std::unique_ptr<PendingUpdatesByPriorityMap>;
@@ -432,10 +486,20 @@ private:
   void loadCluster(const envoy::api::v2::Cluster& cluster, const std::string& version_info,
                    bool added_via_api, ClusterMap& cluster_map);
   void onClusterInit(Cluster& cluster);
+  bool declareOnDemandCluster(const envoy::api::v2::Cluster& cluster,
+                              const std::string& version_info, uint64_t config_hash);
+  void instantiateOnDemandCluster(const std::string& cluster_name,
+                                  OnDemandClusterCallback callback);
+  void finishOnDemandRequests(const std::string& cluster_name, bool available);
+  void enableOnDemandIdleTimer(const std::string& cluster_name, OnDemandCluster& on_demand);
+  void onOnDemandIdleTimeout(const std::string& cluster_name);
+  bool removeActiveOrWarmingCluster(const std::string& cluster_name);
   void postThreadLocalHealthFailure(const HostSharedPtr& host);
   void updateGauges();
 
   ClusterManagerFactory& factory_;
+  // Declared before the clusters so that it outlives the health checkers running on it.
+  HealthCheckerDispatcherPoolSharedPtr health_checker_dispatcher_pool_;
   Runtime::Loader& runtime_;
   Stats::Store& stats_;
   ThreadLocal::SlotPtr tls_;
@@ -462,6 +526,10 @@ private:
   ClusterUpdatesMap updates_map_;
   Event::Dispatcher& dispatcher_;
   Http::Context& http_context_;
+  std::unordered_map<std::string, OnDemandClusterPtr> on_demand_clusters_;
+  // The names of on_demand_clusters_, for requestOnDemandCluster() on the workers.
+  mutable Thread::MutexBasicLockable on_demand_names_lock_;
+  std::unordered_set<std::string> on_demand_names_ GUARDED_BY(on_demand_names_lock_);
 };
 
 } // namespace Upstream
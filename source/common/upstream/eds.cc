@@ -1,6 +1,7 @@
 #include "common/upstream/eds.h"
 
 #include "envoy/api/v2/eds.pb.validate.h"
+#include "envoy/stats/timespan.h"
 
 #include "common/config/subscription_factory.h"
 
@@ -16,18 +17,28 @@ EdsClusterImpl::EdsClusterImpl(
       cm_(factory_context.clusterManager()), local_info_(factory_context.localInfo()),
       cluster_name_(cluster.eds_cluster_config().service_name().empty()
                         ? cluster.name()
-                        : cluster.eds_cluster_config().service_name()) {
+                        : cluster.eds_cluster_config().service_name()),
+      time_source_(factory_context.api().timeSource()),
+      update_debounce_window_(std::chrono::milliseconds(
+          PROTOBUF_GET_MS_OR_DEFAULT(cluster.eds_cluster_config(), update_debounce_window, 0))) {
   Config::Utility::checkLocalInfo("eds", local_info_);
 
   const auto& eds_config = cluster.eds_cluster_config().eds_config();
   Event::Dispatcher& dispatcher = factory_context.dispatcher();
+  if (update_debounce_window_.count() > 0) {
+    update_debounce_timer_ = dispatcher.createTimer([this]() -> void { onUpdateDebounceTimer(); });
+  }
   Runtime::RandomGenerator& random = factory_context.random();
   Upstream::ClusterManager& cm = factory_context.clusterManager();
+  const bool is_delta = (eds_config.api_config_source().api_type() ==
+                         envoy::api::v2::core::ApiConfigSource::DELTA_GRPC);
+  const std::string grpc_method = is_delta
+                                      ? "envoy.api.v2.EndpointDiscoveryService.DeltaEndpoints"
+                                      : "envoy.api.v2.EndpointDiscoveryService.StreamEndpoints";
   subscription_ = Config::SubscriptionFactory::subscriptionFromConfigSource<
       envoy::api::v2::ClusterLoadAssignment>(
       eds_config, local_info_, dispatcher, cm, random, info_->statsScope(),
-      "envoy.api.v2.EndpointDiscoveryService.FetchEndpoints",
-      "envoy.api.v2.EndpointDiscoveryService.StreamEndpoints", factory_context.api());
+      "envoy.api.v2.EndpointDiscoveryService.FetchEndpoints", grpc_method, factory_context.api());
 }
 
 void EdsClusterImpl::startPreInit() { subscription_->start({cluster_name_}, *this); }
@@ -115,8 +126,72 @@ void EdsClusterImpl::onConfigUpdate(const ResourceVector& resources, const std::
                                      cluster_load_assignment.cluster_name()));
   }
 
+  // Once the first assignment has been applied, coalesce the assignments that arrive within the
+  // debounce window and only apply the latest one when it expires.
+  if (update_debounce_timer_ != nullptr && cluster_load_assignment_hash_.has_value()) {
+    if (pending_cluster_load_assignment_.has_value()) {
+      info_->stats().update_coalesced_.inc();
+    } else {
+      update_debounce_timer_->enableTimer(update_debounce_window_);
+    }
+    pending_cluster_load_assignment_ = cluster_load_assignment;
+    return;
+  }
+
+  applyClusterLoadAssignment(cluster_load_assignment);
+}
+
+void EdsClusterImpl::onUpdateDebounceTimer() {
+  ASSERT(pending_cluster_load_assignment_.has_value());
+  const envoy::api::v2::ClusterLoadAssignment cluster_load_assignment =
+      std::move(pending_cluster_load_assignment_.value());
+  pending_cluster_load_assignment_.reset();
+  // The update has already been acknowledged, so a failure can only be logged.
+  try {
+    applyClusterLoadAssignment(cluster_load_assignment);
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG(warn, "Failed to apply debounced EDS assignment for cluster {}: {}", info_->name(),
+              e.what());
+  }
+}
+
+void EdsClusterImpl::applyClusterLoadAssignment(
+    const envoy::api::v2::ClusterLoadAssignment& cluster_load_assignment) {
+  // Management servers commonly resend an unchanged assignment, e.g. on every reconnect. Applying
+  // it would create and diff a host for every endpoint to change nothing, so skip it. That is not
+  // the case when hosts that are missing from the assignment are kept until they fail active
+  // health checking, as a repeated assignment then removes the hosts that failed since.
+  const uint64_t cluster_load_assignment_hash = MessageUtil::hash(cluster_load_assignment);
+  const bool keeps_unreferenced_hosts =
+      health_checker_ != nullptr && !info_->drainConnectionsOnHostRemoval();
+  if (!keeps_unreferenced_hosts && cluster_load_assignment_hash_.has_value() &&
+      cluster_load_assignment_hash_.value() == cluster_load_assignment_hash) {
+    ENVOY_LOG(debug, "EDS assignment for cluster {} is unchanged", info_->name());
+    info_->stats().update_no_rebuild_.inc();
+    onPreInitComplete();
+    return;
+  }
+
+  Stats::TimespanWithUnit<std::chrono::microseconds> update_timer(info_->stats().update_time_us_,
+                                                                  time_source_);
   BatchUpdateHelper helper(*this, cluster_load_assignment);
   priority_set_.batchHostUpdate(helper);
+  cluster_load_assignment_hash_ = cluster_load_assignment_hash;
+  update_timer.complete();
+}
+
+void EdsClusterImpl::onConfigUpdate(
+    const Protobuf::RepeatedPtrField<envoy::api::v2::Resource>& added_resources,
+    const Protobuf::RepeatedPtrField<std::string>&, const std::string& system_version_info) {
+  // The unit of a delta update is a whole ClusterLoadAssignment, and an EDS cluster subscribes to
+  // exactly one. An update that only removes it carries no assignment, which keeps the previous
+  // one just like an empty state of the world update.
+  ResourceVector resources;
+  for (const auto& resource : added_resources) {
+    *resources.Add() =
+        MessageUtil::anyConvert<envoy::api::v2::ClusterLoadAssignment>(resource.resource());
+  }
+  onConfigUpdate(resources, system_version_info);
 }
 
 bool EdsClusterImpl::updateHostsPerLocality(
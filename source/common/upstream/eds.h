@@ -2,7 +2,9 @@
 
 #include "envoy/api/v2/core/base.pb.h"
 #include "envoy/api/v2/eds.pb.h"
+#include "envoy/common/time.h"
 #include "envoy/config/subscription.h"
+#include "envoy/event/timer.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/secret/secret_manager.h"
 #include "envoy/stats/scope.h"
@@ -33,10 +35,9 @@ public:
   // Config::SubscriptionCallbacks
   // TODO(fredlas) deduplicate
   void onConfigUpdate(const ResourceVector& resources, const std::string& version_info) override;
-  void onConfigUpdate(const Protobuf::RepeatedPtrField<envoy::api::v2::Resource>&,
-                      const Protobuf::RepeatedPtrField<std::string>&, const std::string&) override {
-    NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
-  }
+  void onConfigUpdate(const Protobuf::RepeatedPtrField<envoy::api::v2::Resource>& added_resources,
+                      const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                      const std::string& system_version_info) override;
   void onConfigUpdateFailed(const EnvoyException* e) override;
   std::string resourceName(const ProtobufWkt::Any& resource) override {
     return MessageUtil::anyConvert<envoy::api::v2::ClusterLoadAssignment>(resource).cluster_name();
@@ -50,6 +51,9 @@ private:
                               LocalityWeightsMap& new_locality_weights_map,
                               PriorityStateManager& priority_state_manager,
                               std::unordered_map<std::string, HostSharedPtr>& updated_hosts);
+  void applyClusterLoadAssignment(
+      const envoy::api::v2::ClusterLoadAssignment& cluster_load_assignment);
+  void onUpdateDebounceTimer();
 
   // ClusterImplBase
   void startPreInit() override;
@@ -72,8 +76,16 @@ private:
   std::unique_ptr<Config::Subscription<envoy::api::v2::ClusterLoadAssignment>> subscription_;
   const LocalInfo::LocalInfo& local_info_;
   const std::string cluster_name_;
+  TimeSource& time_source_;
   std::vector<LocalityWeightsMap> locality_weights_map_;
   HostMap all_hosts_;
+  // Hash of the last applied ClusterLoadAssignment.
+  absl::optional<uint64_t> cluster_load_assignment_hash_;
+  // Only created when an update debounce window is configured.
+  Event::TimerPtr update_debounce_timer_;
+  const std::chrono::milliseconds update_debounce_window_;
+  // The latest assignment received within the debounce window, applied when the window expires.
+  absl::optional<envoy::api::v2::ClusterLoadAssignment> pending_cluster_load_assignment_;
 };
 
 class EdsClusterFactory : public ClusterFactoryImplBase {
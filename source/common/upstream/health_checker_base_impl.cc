@@ -31,23 +31,67 @@ HealthCheckerImplBase::HealthCheckerImplBase(const Cluster& cluster,
       unhealthy_edge_interval_(
           PROTOBUF_GET_MS_OR_DEFAULT(config, unhealthy_edge_interval, unhealthy_interval_.count())),
       healthy_edge_interval_(
-          PROTOBUF_GET_MS_OR_DEFAULT(config, healthy_edge_interval, interval_.count())) {
+          PROTOBUF_GET_MS_OR_DEFAULT(config, healthy_edge_interval, interval_.count())),
+      // Durations below a millisecond round up to the finest resolution timers have.
+      timer_wheel_resolution_(
+          config.has_timer_wheel_resolution()
+              ? std::max<uint64_t>(1, PROTOBUF_GET_MS_REQUIRED(config, timer_wheel_resolution))
+              : 0) {
   cluster_.prioritySet().addMemberUpdateCb(
       [this](const HostVector& hosts_added, const HostVector& hosts_removed) -> void {
         onClusterMemberUpdate(hosts_added, hosts_removed);
       });
 }
 
+HealthCheckerSharedPtr
+HealthCheckerImplBase::runOnDispatcherPool(std::shared_ptr<HealthCheckerImplBase> health_checker,
+                                           HealthCheckerDispatcherPoolSharedPtr dispatcher_pool) {
+  ASSERT(health_checker->active_sessions_.empty());
+  health_checker->dispatcher_pool_ = std::move(dispatcher_pool);
+  return std::make_shared<DispatcherPoolHealthChecker>(std::move(health_checker));
+}
+
+Event::TimerPtr HealthCheckerImplBase::createTimer(Event::Dispatcher& dispatcher,
+                                                   const Event::TimerCb& cb) {
+  if (timer_wheel_resolution_.count() == 0) {
+    return dispatcher.createTimer(cb);
+  }
+
+  Thread::LockGuard lock(timer_wheels_lock_);
+  std::unique_ptr<Event::TimerWheel>& timer_wheel = timer_wheels_[&dispatcher];
+  if (timer_wheel == nullptr) {
+    timer_wheel = std::make_unique<Event::TimerWheel>(dispatcher, timer_wheel_resolution_);
+  }
+  return timer_wheel->createTimer(cb);
+}
+
 void HealthCheckerImplBase::decHealthy() {
   ASSERT(local_process_healthy_ > 0);
   local_process_healthy_--;
-  refreshHealthyStat();
+  onHealthyCountChange();
 }
 
 void HealthCheckerImplBase::decDegraded() {
   ASSERT(local_process_degraded_ > 0);
   local_process_degraded_--;
+  onHealthyCountChange();
+}
+
+void HealthCheckerImplBase::flushResults() {
+  std::vector<std::pair<HostSharedPtr, HealthTransition>> results;
+  {
+    Thread::LockGuard lock(results_lock_);
+    results.swap(pending_results_);
+    flush_posted_ = false;
+  }
+
+  refreshRuntimeValues();
   refreshHealthyStat();
+  for (const auto& result : results) {
+    for (const HostStatusCb& cb : callbacks_) {
+      cb(result.first, result.second);
+    }
+  }
 }
 
 HealthCheckerStats HealthCheckerImplBase::generateStats(Stats::Scope& scope) {
@@ -58,12 +102,12 @@ HealthCheckerStats HealthCheckerImplBase::generateStats(Stats::Scope& scope) {
 
 void HealthCheckerImplBase::incHealthy() {
   local_process_healthy_++;
-  refreshHealthyStat();
+  onHealthyCountChange();
 }
 
 void HealthCheckerImplBase::incDegraded() {
   local_process_degraded_++;
-  refreshHealthyStat();
+  onHealthyCountChange();
 }
 
 std::chrono::milliseconds HealthCheckerImplBase::interval(HealthState state,
@@ -109,9 +153,13 @@ std::chrono::milliseconds HealthCheckerImplBase::interval(HealthState state,
     base_time_ms += (random_.random() % interval_jitter_.count());
   }
 
-  const uint64_t min_interval = runtime_.snapshot().getInteger("health_check.min_interval", 0);
-  const uint64_t max_interval = runtime_.snapshot().getInteger(
-      "health_check.max_interval", std::numeric_limits<uint64_t>::max());
+  uint64_t min_interval = min_interval_ms_;
+  uint64_t max_interval = max_interval_ms_;
+  if (!runsOnDispatcherPool()) {
+    min_interval = runtime_.snapshot().getInteger("health_check.min_interval", 0);
+    max_interval = runtime_.snapshot().getInteger("health_check.max_interval",
+                                                  std::numeric_limits<uint64_t>::max());
+  }
 
   uint64_t final_ms = std::min(base_time_ms, max_interval);
   // We force a non-zero final MS, to prevent live lock.
@@ -121,11 +169,18 @@ std::chrono::milliseconds HealthCheckerImplBase::interval(HealthState state,
 
 void HealthCheckerImplBase::addHosts(const HostVector& hosts) {
   for (const HostSharedPtr& host : hosts) {
-    active_sessions_[host] = makeSession(host);
+    ActiveHealthCheckSessionPtr& session = active_sessions_[host];
+    session = makeSession(host);
     host->setActiveHealthFailureType(Host::ActiveHealthFailureType::UNKNOWN);
     host->setHealthChecker(
         HealthCheckHostMonitorPtr{new HealthCheckHostMonitorImpl(shared_from_this(), host)});
-    active_sessions_[host]->start();
+    if (runsOnDispatcherPool()) {
+      // The session is only deleted by a later post to the same dispatcher.
+      ActiveHealthCheckSession* raw_session = session.get();
+      session->dispatcher_.post([raw_session]() -> void { raw_session->start(); });
+    } else {
+      session->start();
+    }
   }
 }
 
@@ -135,10 +190,37 @@ void HealthCheckerImplBase::onClusterMemberUpdate(const HostVector& hosts_added,
   for (const HostSharedPtr& host : hosts_removed) {
     auto session_iter = active_sessions_.find(host);
     ASSERT(active_sessions_.end() != session_iter);
+    removeSession(std::move(session_iter->second));
     active_sessions_.erase(session_iter);
   }
 }
 
+void HealthCheckerImplBase::onHealthyCountChange() {
+  if (runsOnDispatcherPool()) {
+    // Sessions on different threads would race on the gauges, so the main thread sets them.
+    scheduleFlush();
+  } else {
+    refreshHealthyStat();
+  }
+}
+
+void HealthCheckerImplBase::refreshRuntimeValues() {
+  min_interval_ms_ = runtime_.snapshot().getInteger("health_check.min_interval", 0);
+  max_interval_ms_ = runtime_.snapshot().getInteger("health_check.max_interval",
+                                                    std::numeric_limits<uint64_t>::max());
+}
+
+void HealthCheckerImplBase::removeSession(ActiveHealthCheckSessionPtr&& session) {
+  if (!runsOnDispatcherPool()) {
+    session.reset();
+    return;
+  }
+
+  // The session's connections and timers belong to its dispatcher, so it is destroyed there.
+  ActiveHealthCheckSession* raw_session = session.release();
+  raw_session->dispatcher_.post([raw_session]() -> void { delete raw_session; });
+}
+
 void HealthCheckerImplBase::refreshHealthyStat() {
   // Each hot restarted process health checks independently. To make the stats easier to read,
   // we assume that both processes will converge and the last one that writes wins for the host.
@@ -147,6 +229,17 @@ void HealthCheckerImplBase::refreshHealthyStat() {
 }
 
 void HealthCheckerImplBase::runCallbacks(HostSharedPtr host, HealthTransition changed_state) {
+  if (runsOnDispatcherPool()) {
+    // Sessions on the dispatcher pool queue their results for the main thread, which runs the
+    // callbacks of all results queued in the meantime at once.
+    {
+      Thread::LockGuard lock(results_lock_);
+      pending_results_.emplace_back(std::move(host), changed_state);
+    }
+    scheduleFlush();
+    return;
+  }
+
   // When a parent process shuts down, it will kill all of the active health checking sessions,
   // which will decrement the healthy count and the healthy stat in the parent. If the child is
   // stable and does not update, the healthy stat will be wrong. This routine is called any time
@@ -158,6 +251,36 @@ void HealthCheckerImplBase::runCallbacks(HostSharedPtr host, HealthTransition ch
   }
 }
 
+void HealthCheckerImplBase::scheduleFlush() {
+  {
+    Thread::LockGuard lock(results_lock_);
+    if (flush_posted_) {
+      return;
+    }
+    flush_posted_ = true;
+  }
+
+  // The sessions are stopped before the health checker is released, so it is alive here. It may
+  // be gone by the time the main thread runs the flush.
+  std::weak_ptr<HealthCheckerImplBase> weak_this = shared_from_this();
+  dispatcher_.post([weak_this]() -> void {
+    std::shared_ptr<HealthCheckerImplBase> shared_this = weak_this.lock();
+    if (shared_this != nullptr) {
+      shared_this->flushResults();
+    }
+  });
+}
+
+Event::Dispatcher& HealthCheckerImplBase::sessionDispatcher() {
+  if (!runsOnDispatcherPool()) {
+    return dispatcher_;
+  }
+
+  Event::Dispatcher& dispatcher = dispatcher_pool_->nextDispatcher();
+  session_dispatchers_.insert(&dispatcher);
+  return dispatcher;
+}
+
 void HealthCheckerImplBase::HealthCheckHostMonitorImpl::setUnhealthy() {
   // This is called cross thread. The cluster/health checker might already be gone.
   std::shared_ptr<HealthCheckerImplBase> health_checker = health_checker_.lock();
@@ -186,21 +309,84 @@ void HealthCheckerImplBase::setUnhealthyCrossThread(const HostSharedPtr& host) {
       return;
     }
 
-    session->second->setUnhealthy(envoy::data::core::v2alpha::HealthCheckFailureType::PASSIVE);
+    ActiveHealthCheckSession* raw_session = session->second.get();
+    if (shared_this->runsOnDispatcherPool()) {
+      // A removed session is deleted by a later post to the same dispatcher.
+      raw_session->dispatcher_.post([raw_session]() -> void {
+        raw_session->setUnhealthy(envoy::data::core::v2alpha::HealthCheckFailureType::PASSIVE);
+      });
+    } else {
+      raw_session->setUnhealthy(envoy::data::core::v2alpha::HealthCheckFailureType::PASSIVE);
+    }
   });
 }
 
 void HealthCheckerImplBase::start() {
+  if (runsOnDispatcherPool()) {
+    refreshRuntimeValues();
+  }
   for (auto& host_set : cluster_.prioritySet().hostSetsPerPriority()) {
     addHosts(host_set->hosts());
   }
 }
 
+void HealthCheckerImplBase::stopSessions() {
+  struct StopState {
+    Thread::MutexBasicLockable lock_;
+    Thread::CondVar stopped_;
+    uint64_t remaining_ GUARDED_BY(lock_){};
+  };
+
+  // Hand every pool dispatcher its sessions to destroy, along with its timer wheel. Sessions that
+  // were removed earlier are deleted by posts that run before these.
+  std::unordered_map<Event::Dispatcher*, std::vector<ActiveHealthCheckSessionPtr>> sessions;
+  for (Event::Dispatcher* dispatcher : session_dispatchers_) {
+    sessions[dispatcher];
+  }
+  for (auto& session : active_sessions_) {
+    sessions[&session.second->dispatcher_].push_back(std::move(session.second));
+  }
+  active_sessions_.clear();
+  session_dispatchers_.clear();
+
+  auto state = std::make_shared<StopState>();
+  {
+    Thread::LockGuard lock(state->lock_);
+    state->remaining_ = sessions.size();
+  }
+  for (auto& dispatcher_sessions : sessions) {
+    Event::Dispatcher& dispatcher = *dispatcher_sessions.first;
+    std::vector<ActiveHealthCheckSessionPtr>* to_destroy = &dispatcher_sessions.second;
+    dispatcher.post([this, &dispatcher, to_destroy, state]() -> void {
+      to_destroy->clear();
+      {
+        Thread::LockGuard lock(timer_wheels_lock_);
+        timer_wheels_.erase(&dispatcher);
+      }
+      Thread::LockGuard lock(state->lock_);
+      state->remaining_--;
+      state->stopped_.notifyOne();
+    });
+  }
+
+  {
+    Thread::LockGuard lock(state->lock_);
+    while (state->remaining_ > 0) {
+      state->stopped_.wait(state->lock_);
+    }
+  }
+  refreshHealthyStat();
+}
+
+void HealthCheckerImplBase::ActiveHealthCheckSession::start() {
+  interval_timer_ = parent_.createTimer(dispatcher_, [this]() -> void { onIntervalBase(); });
+  timeout_timer_ = parent_.createTimer(dispatcher_, [this]() -> void { onTimeoutBase(); });
+  onIntervalBase();
+}
+
 HealthCheckerImplBase::ActiveHealthCheckSession::ActiveHealthCheckSession(
     HealthCheckerImplBase& parent, HostSharedPtr host)
-    : host_(host), parent_(parent),
-      interval_timer_(parent.dispatcher_.createTimer([this]() -> void { onIntervalBase(); })),
-      timeout_timer_(parent.dispatcher_.createTimer([this]() -> void { onTimeoutBase(); })) {
+    : host_(host), dispatcher_(parent.sessionDispatcher()), parent_(parent) {
 
   if (!host->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
     parent.incHealthy();
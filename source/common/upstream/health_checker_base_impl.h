@@ -1,5 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/v2/core/health_check.pb.h"
 #include "envoy/event/timer.h"
@@ -7,7 +14,11 @@
 #include "envoy/stats/scope.h"
 #include "envoy/upstream/health_checker.h"
 
+#include "common/common/lock_guard.h"
 #include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+#include "common/event/timer_wheel.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -45,12 +56,24 @@ public:
   void addHostCheckCompleteCb(HostStatusCb callback) override { callbacks_.push_back(callback); }
   void start() override;
 
+  /**
+   * Run the sessions of a health checker on a pool of dispatchers. Results are handed to the main
+   * thread in batches, where the host status callbacks run.
+   * @param health_checker supplies the health checker, which must not have been started yet.
+   * @param dispatcher_pool supplies the pool to run the sessions on.
+   * @return HealthCheckerSharedPtr a health checker that owns health_checker, and stops its
+   *         sessions on the pool's threads when it is destroyed.
+   */
+  static HealthCheckerSharedPtr
+  runOnDispatcherPool(std::shared_ptr<HealthCheckerImplBase> health_checker,
+                      HealthCheckerDispatcherPoolSharedPtr dispatcher_pool);
+
 protected:
   class ActiveHealthCheckSession {
   public:
     virtual ~ActiveHealthCheckSession();
     HealthTransition setUnhealthy(envoy::data::core::v2alpha::HealthCheckFailureType type);
-    void start() { onIntervalBase(); }
+    void start();
 
   protected:
     ActiveHealthCheckSession(HealthCheckerImplBase& parent, HostSharedPtr host);
@@ -60,8 +83,12 @@ protected:
     void handleFailure(envoy::data::core::v2alpha::HealthCheckFailureType type);
 
     HostSharedPtr host_;
+    // The dispatcher the session runs on, which all of its connections and timers must use.
+    Event::Dispatcher& dispatcher_;
 
   private:
+    friend class HealthCheckerImplBase;
+
     virtual void onInterval() PURE;
     void onIntervalBase();
     virtual void onTimeout() PURE;
@@ -82,7 +109,22 @@ protected:
                         Runtime::RandomGenerator& random, HealthCheckEventLoggerPtr&& event_logger);
 
   virtual ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host) PURE;
+  /**
+   * Create a timer for a session on the session's dispatcher, in that dispatcher's timer wheel if
+   * one is configured. Must be called on the dispatcher's thread.
+   */
+  Event::TimerPtr createTimer(Event::Dispatcher& dispatcher, const Event::TimerCb& cb);
   virtual envoy::data::core::v2alpha::HealthCheckerType healthCheckerType() const PURE;
+  /**
+   * Read the runtime values that sessions use while running on the dispatcher pool, whose threads
+   * have no runtime snapshot. Called on the main thread when checking starts and with every batch
+   * of results.
+   */
+  virtual void refreshRuntimeValues();
+  /**
+   * @return bool whether the sessions run on a dispatcher pool.
+   */
+  bool runsOnDispatcherPool() const { return dispatcher_pool_ != nullptr; }
 
   const bool always_log_health_check_failures_;
   const Cluster& cluster_;
@@ -109,17 +151,39 @@ private:
     std::weak_ptr<Host> host_;
   };
 
+  class DispatcherPoolHealthChecker : public HealthChecker {
+  public:
+    DispatcherPoolHealthChecker(std::shared_ptr<HealthCheckerImplBase> health_checker)
+        : health_checker_(std::move(health_checker)) {}
+    ~DispatcherPoolHealthChecker() { health_checker_->stopSessions(); }
+
+    // Upstream::HealthChecker
+    void addHostCheckCompleteCb(HostStatusCb callback) override {
+      health_checker_->addHostCheckCompleteCb(callback);
+    }
+    void start() override { health_checker_->start(); }
+
+  private:
+    std::shared_ptr<HealthCheckerImplBase> health_checker_;
+  };
+
   void addHosts(const HostVector& hosts);
   void decHealthy();
   void decDegraded();
+  void flushResults();
   HealthCheckerStats generateStats(Stats::Scope& scope);
   void incHealthy();
   void incDegraded();
   std::chrono::milliseconds interval(HealthState state, HealthTransition changed_state) const;
   void onClusterMemberUpdate(const HostVector& hosts_added, const HostVector& hosts_removed);
+  void onHealthyCountChange();
   void refreshHealthyStat();
+  void removeSession(ActiveHealthCheckSessionPtr&& session);
   void runCallbacks(HostSharedPtr host, HealthTransition changed_state);
+  void scheduleFlush();
+  Event::Dispatcher& sessionDispatcher();
   void setUnhealthyCrossThread(const HostSharedPtr& host);
+  void stopSessions();
 
   static const std::chrono::milliseconds NO_TRAFFIC_INTERVAL;
 
@@ -131,9 +195,27 @@ private:
   const std::chrono::milliseconds unhealthy_interval_;
   const std::chrono::milliseconds unhealthy_edge_interval_;
   const std::chrono::milliseconds healthy_edge_interval_;
+  // Zero when timers are not put in a timer wheel.
+  const std::chrono::milliseconds timer_wheel_resolution_;
+  HealthCheckerDispatcherPoolSharedPtr dispatcher_pool_;
+  Thread::MutexBasicLockable timer_wheels_lock_;
+  // One wheel per dispatcher, created by the first session timer on it. Declared before the
+  // sessions so that the wheels outlive their timers.
+  std::unordered_map<Event::Dispatcher*, std::unique_ptr<Event::TimerWheel>>
+      timer_wheels_ GUARDED_BY(timer_wheels_lock_);
   std::unordered_map<HostSharedPtr, ActiveHealthCheckSessionPtr> active_sessions_;
-  uint64_t local_process_healthy_{};
-  uint64_t local_process_degraded_{};
+  // The pool dispatchers that sessions were handed to, which must be drained before the health
+  // checker goes away.
+  std::unordered_set<Event::Dispatcher*> session_dispatchers_;
+  std::atomic<uint64_t> local_process_healthy_{};
+  std::atomic<uint64_t> local_process_degraded_{};
+  // Runtime bounds of the interval, used instead of the runtime on the dispatcher pool.
+  std::atomic<uint64_t> min_interval_ms_{};
+  std::atomic<uint64_t> max_interval_ms_{std::numeric_limits<uint64_t>::max()};
+  Thread::MutexBasicLockable results_lock_;
+  std::vector<std::pair<HostSharedPtr, HealthTransition>>
+      pending_results_ GUARDED_BY(results_lock_);
+  bool flush_posted_ GUARDED_BY(results_lock_){};
 };
 
 class HealthCheckEventLoggerImpl : public HealthCheckEventLogger {
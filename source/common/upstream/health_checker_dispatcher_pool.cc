@@ -0,0 +1,50 @@
+#include "common/upstream/health_checker_dispatcher_pool.h"
+
+#include <chrono>
+
+#include "envoy/event/timer.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+HealthCheckerDispatcherPoolImpl::HealthCheckerDispatcherPoolImpl(Api::Api& api, uint32_t threads) {
+  ASSERT(threads > 0);
+  for (uint32_t i = 0; i < threads; i++) {
+    dispatchers_.emplace_back(api.allocateDispatcher());
+  }
+  for (auto& dispatcher : dispatchers_) {
+    Event::Dispatcher& thread_dispatcher = *dispatcher;
+    threads_.emplace_back(api.threadFactory().createThread(
+        [this, &thread_dispatcher]() -> void { threadRoutine(thread_dispatcher); }));
+  }
+}
+
+HealthCheckerDispatcherPoolImpl::~HealthCheckerDispatcherPoolImpl() {
+  for (auto& dispatcher : dispatchers_) {
+    dispatcher->exit();
+  }
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+Event::Dispatcher& HealthCheckerDispatcherPoolImpl::nextDispatcher() {
+  Event::Dispatcher& dispatcher = *dispatchers_[next_dispatcher_];
+  next_dispatcher_ = (next_dispatcher_ + 1) % dispatchers_.size();
+  return dispatcher;
+}
+
+void HealthCheckerDispatcherPoolImpl::threadRoutine(Event::Dispatcher& dispatcher) {
+  // The dispatcher returns as soon as it has nothing to wait on, which is the case before the
+  // first health checker hands it a session. Keep a timer armed so that it runs until exit().
+  Event::TimerPtr keepalive_timer;
+  keepalive_timer = dispatcher.createTimer(
+      [&keepalive_timer]() -> void { keepalive_timer->enableTimer(std::chrono::hours(1)); });
+  keepalive_timer->enableTimer(std::chrono::hours(1));
+  dispatcher.run(Event::Dispatcher::RunType::Block);
+}
+
+} // namespace Upstream
+} // namespace Envoy
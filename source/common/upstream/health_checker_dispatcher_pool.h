@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/thread/thread.h"
+#include "envoy/upstream/health_checker.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Pool of health check threads, each running its own dispatcher until the pool is destroyed.
+ */
+class HealthCheckerDispatcherPoolImpl : public HealthCheckerDispatcherPool {
+public:
+  HealthCheckerDispatcherPoolImpl(Api::Api& api, uint32_t threads);
+  ~HealthCheckerDispatcherPoolImpl();
+
+  // Upstream::HealthCheckerDispatcherPool
+  Event::Dispatcher& nextDispatcher() override;
+
+private:
+  void threadRoutine(Event::Dispatcher& dispatcher);
+
+  std::vector<Event::DispatcherPtr> dispatchers_;
+  std::vector<Thread::ThreadPtr> threads_;
+  uint32_t next_dispatcher_{};
+};
+
+} // namespace Upstream
+} // namespace Envoy
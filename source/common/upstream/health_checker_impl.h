@@ -29,13 +29,16 @@ public:
    * @param random supplies the random generator.
    * @param dispatcher supplies the dispatcher.
    * @param event_logger supplies the event_logger.
+   * @param dispatcher_pool supplies the pool of dispatchers to run the sessions of built in health
+   *        checkers on, or nullptr to run them on the main thread dispatcher.
    * @return a health checker.
    */
   static HealthCheckerSharedPtr create(const envoy::api::v2::core::HealthCheck& health_check_config,
                                        Upstream::Cluster& cluster, Runtime::Loader& runtime,
                                        Runtime::RandomGenerator& random,
                                        Event::Dispatcher& dispatcher,
-                                       AccessLog::AccessLogManager& log_manager);
+                                       AccessLog::AccessLogManager& log_manager,
+                                       HealthCheckerDispatcherPoolSharedPtr dispatcher_pool);
 };
 
 /**
@@ -129,14 +132,19 @@ private:
   envoy::data::core::v2alpha::HealthCheckerType healthCheckerType() const override {
     return envoy::data::core::v2alpha::HealthCheckerType::HTTP;
   }
+  void refreshRuntimeValues() override;
 
   Http::CodecClient::Type codecClientType(bool use_http2);
+  bool verifyCluster();
 
   const std::string path_;
   const std::string host_value_;
   absl::optional<std::string> service_name_;
   Router::HeaderParserPtr request_headers_parser_;
   const HttpStatusChecker http_status_checker_;
+  // The health_check.verify_cluster runtime value, used instead of the runtime on the dispatcher
+  // pool.
+  std::atomic<uint64_t> verify_cluster_percent_{100};
 
 protected:
   const Http::CodecClient::Type codec_client_type_;
@@ -1,8 +1,11 @@
 #include "common/upstream/health_discovery_service.h"
 
+#include <unordered_map>
+
 #include "envoy/stats/scope.h"
 
 #include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -76,6 +79,13 @@ void HdsDelegate::handleFailure() {
 envoy::service::discovery::v2::HealthCheckRequestOrEndpointHealthResponse
 HdsDelegate::sendResponse() {
   envoy::service::discovery::v2::HealthCheckRequestOrEndpointHealthResponse response;
+  size_t endpoints = 0;
+  for (const auto& cluster : hds_clusters_) {
+    for (const auto& hosts : cluster->prioritySet().hostSetsPerPriority()) {
+      endpoints += hosts->hosts().size();
+    }
+  }
+  response.mutable_endpoint_health_response()->mutable_endpoints_health()->Reserve(endpoints);
   for (const auto& cluster : hds_clusters_) {
     for (const auto& hosts : cluster->prioritySet().hostSetsPerPriority()) {
       for (const auto& host : hosts->hosts()) {
@@ -117,9 +127,17 @@ void HdsDelegate::onReceiveInitialMetadata(Http::HeaderMapPtr&& metadata) {
 
 void HdsDelegate::processMessage(
     std::unique_ptr<envoy::service::discovery::v2::HealthCheckSpecifier>&& message) {
-  ENVOY_LOG(debug, "New health check response message {} ", message->DebugString());
   ASSERT(message);
 
+  // The clusters whose config is unchanged are kept along with their health checkers and the
+  // health of their hosts, rather than being rebuilt with every host unhealthy until checked again.
+  std::unordered_multimap<uint64_t, HdsClusterPtr> previous_clusters;
+  for (size_t i = 0; i < hds_clusters_.size(); i++) {
+    previous_clusters.emplace(hds_cluster_hashes_[i], std::move(hds_clusters_[i]));
+  }
+  hds_clusters_.clear();
+  hds_cluster_hashes_.clear();
+
   for (const auto& cluster_health_check : message->cluster_health_checks()) {
     // Create HdsCluster config
     static const envoy::api::v2::core::BindConfig bind_config;
@@ -144,6 +162,16 @@ void HdsDelegate::processMessage(
       cluster_config.add_health_checks()->MergeFrom(health_check);
     }
 
+    const uint64_t cluster_hash = MessageUtil::hash(cluster_config);
+    hds_cluster_hashes_.push_back(cluster_hash);
+    auto previous_cluster = previous_clusters.find(cluster_hash);
+    if (previous_cluster != previous_clusters.end()) {
+      ENVOY_LOG(debug, "Keeping HdsCluster {}", cluster_config.name());
+      hds_clusters_.push_back(std::move(previous_cluster->second));
+      previous_clusters.erase(previous_cluster);
+      continue;
+    }
+
     ENVOY_LOG(debug, "New HdsCluster config {} ", cluster_config.DebugString());
 
     // Create HdsCluster
@@ -155,16 +183,11 @@ void HdsDelegate::processMessage(
   }
 }
 
-// TODO(lilika): Add support for subsequent HealthCheckSpecifier messages that
-// might modify the HdsClusters
 void HdsDelegate::onReceiveMessage(
     std::unique_ptr<envoy::service::discovery::v2::HealthCheckSpecifier>&& message) {
   stats_.requests_.inc();
   ENVOY_LOG(debug, "New health check response message {} ", message->DebugString());
 
-  // Reset
-  hds_clusters_.clear();
-
   // Set response
   auto server_response_ms = PROTOBUF_GET_MS_REQUIRED(*message, interval);
 
@@ -245,7 +268,7 @@ void HdsCluster::startHealthchecks(AccessLog::AccessLogManager& access_log_manag
 
   for (auto& health_check : cluster_.health_checks()) {
     health_checkers_.push_back(Upstream::HealthCheckerFactory::create(
-        health_check, *this, runtime, random, dispatcher, access_log_manager));
+        health_check, *this, runtime, random, dispatcher, access_log_manager, nullptr));
     health_checkers_.back()->start();
   }
 }
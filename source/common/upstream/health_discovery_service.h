@@ -55,6 +55,7 @@ public:
   Outlier::Detector* outlierDetector() override { return outlier_detector_.get(); }
   const Outlier::Detector* outlierDetector() const override { return outlier_detector_.get(); }
   void initialize(std::function<void()> callback) override;
+  ThreadAwareLoadBalancerPtr createThreadAwareLoadBalancer() override { return nullptr; }
 
   // Creates and starts healthcheckers to its endpoints
   void startHealthchecks(AccessLog::AccessLogManager& access_log_manager, Runtime::Loader& runtime,
@@ -71,7 +72,8 @@ private:
   std::function<void()> initialization_complete_callback_;
 
   Runtime::Loader& runtime_;
-  const envoy::api::v2::Cluster& cluster_;
+  // A copy, since the cluster can outlive the HealthCheckSpecifier it was built from.
+  const envoy::api::v2::Cluster cluster_;
   const envoy::api::v2::core::BindConfig& bind_config_;
   Stats::Store& stats_;
   Ssl::ContextManager& ssl_context_manager_;
@@ -165,6 +167,8 @@ private:
 
   std::vector<std::string> clusters_;
   std::vector<HdsClusterPtr> hds_clusters_;
+  // The hashes of the configs of hds_clusters_, by which unchanged clusters are found.
+  std::vector<uint64_t> hds_cluster_hashes_;
 
   Event::TimerPtr hds_stream_response_timer_;
   Event::TimerPtr hds_retry_timer_;
@@ -9,6 +9,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/common/assert.h"
+#include "common/common/lock_guard.h"
 #include "common/common/stack_array.h"
 #include "common/protobuf/utility.h"
 
@@ -255,16 +256,41 @@ LoadBalancerBase::chooseHostSet(LoadBalancerContext* context) {
           priority_and_source.second};
 }
 
+LocalityRoutingCache::PerPriorityStateConstSharedPtr LocalityRoutingCache::getOrCompute(
+    const HostSet& host_set, const HostSet& local_host_set,
+    const std::function<PerPriorityStateConstSharedPtr()>& compute) {
+  const HostVectorConstSharedPtr healthy_hosts = host_set.healthyHostsPtr();
+  const HostsPerLocalityConstSharedPtr healthy_hosts_per_locality =
+      host_set.healthyHostsPerLocalityPtr();
+  const HostsPerLocalityConstSharedPtr local_healthy_hosts_per_locality =
+      local_host_set.healthyHostsPerLocalityPtr();
+
+  // The state is computed while holding the lock, so that the other workers that regenerate it at
+  // the same time wait for it instead of computing it as well.
+  Thread::LockGuard lock(mutex_);
+  if (state_ == nullptr || healthy_hosts_.lock() != healthy_hosts ||
+      healthy_hosts_per_locality_.lock() != healthy_hosts_per_locality ||
+      local_healthy_hosts_per_locality_.lock() != local_healthy_hosts_per_locality) {
+    state_ = compute();
+    healthy_hosts_ = healthy_hosts;
+    healthy_hosts_per_locality_ = healthy_hosts_per_locality;
+    local_healthy_hosts_per_locality_ = local_healthy_hosts_per_locality;
+  }
+  return state_;
+}
+
 ZoneAwareLoadBalancerBase::ZoneAwareLoadBalancerBase(
     const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
     Runtime::Loader& runtime, Runtime::RandomGenerator& random,
-    const envoy::api::v2::Cluster::CommonLbConfig& common_config)
+    const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+    const LocalityRoutingCacheSharedPtr& locality_routing_cache)
     : LoadBalancerBase(priority_set, stats, runtime, random, common_config),
       local_priority_set_(local_priority_set),
       routing_enabled_(PROTOBUF_PERCENT_TO_ROUNDED_INTEGER_OR_DEFAULT(
           common_config.zone_aware_lb_config(), routing_enabled, 100, 100)),
       min_cluster_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(common_config.zone_aware_lb_config(),
-                                                        min_cluster_size, 6U)) {
+                                                        min_cluster_size, 6U)),
+      locality_routing_cache_(locality_routing_cache) {
   ASSERT(!priority_set.hostSetsPerPriority().empty());
   resizePerPriorityState();
   priority_set_.addPriorityUpdateCb(
@@ -301,20 +327,29 @@ ZoneAwareLoadBalancerBase::~ZoneAwareLoadBalancerBase() {
 
 void ZoneAwareLoadBalancerBase::regenerateLocalityRoutingStructures() {
   ASSERT(local_priority_set_);
-  stats_.lb_recalculate_zone_structures_.inc();
   // resizePerPriorityState should ensure these stay in sync.
   ASSERT(per_priority_state_.size() == priority_set_.hostSetsPerPriority().size());
 
   // We only do locality routing for P=0
-  uint32_t priority = 0;
-  PerPriorityState& state = *per_priority_state_[priority];
+  const auto compute = [this]() { return computeLocalityRoutingStructures(); };
+  per_priority_state_[0] =
+      locality_routing_cache_ != nullptr
+          ? locality_routing_cache_->getOrCompute(*priority_set_.hostSetsPerPriority()[0],
+                                                  localHostSet(), compute)
+          : compute();
+}
+
+ZoneAwareLoadBalancerBase::PerPriorityStateConstSharedPtr
+ZoneAwareLoadBalancerBase::computeLocalityRoutingStructures() {
+  stats_.lb_recalculate_zone_structures_.inc();
+  auto state = std::make_shared<PerPriorityState>();
   // Do not perform any calculations if we cannot perform locality routing based on non runtime
   // params.
   if (earlyExitNonLocalityRouting()) {
-    state.locality_routing_state_ = LocalityRoutingState::NoLocalityRouting;
-    return;
+    state->locality_routing_state_ = LocalityRoutingState::NoLocalityRouting;
+    return state;
   }
-  HostSet& host_set = *priority_set_.hostSetsPerPriority()[priority];
+  HostSet& host_set = *priority_set_.hostSetsPerPriority()[0];
   ASSERT(host_set.healthyHostsPerLocality().hasLocalLocality());
   const size_t num_localities = host_set.healthyHostsPerLocality().get().size();
   ASSERT(num_localities > 0);
@@ -336,16 +371,16 @@ void ZoneAwareLoadBalancerBase::regenerateLocalityRoutingStructures() {
   // If we have lower percent of hosts in the local cluster in the same locality,
   // we can push all of the requests directly to upstream cluster in the same locality.
   if (upstream_percentage[0] >= local_percentage[0]) {
-    state.locality_routing_state_ = LocalityRoutingState::LocalityDirect;
-    return;
+    state->locality_routing_state_ = LocalityRoutingState::LocalityDirect;
+    return state;
   }
 
-  state.locality_routing_state_ = LocalityRoutingState::LocalityResidual;
+  state->locality_routing_state_ = LocalityRoutingState::LocalityResidual;
 
   // If we cannot route all requests to the same locality, calculate what percentage can be routed.
   // For example, if local percentage is 20% and upstream is 10%
   // we can route only 50% of requests directly.
-  state.local_percent_to_route_ = upstream_percentage[0] * 10000 / local_percentage[0];
+  state->local_percent_to_route_ = upstream_percentage[0] * 10000 / local_percentage[0];
 
   // Local locality does not have additional capacity (we have already routed what we could).
   // Now we need to figure out how much traffic we can route cross locality and to which exact
@@ -363,28 +398,30 @@ void ZoneAwareLoadBalancerBase::regenerateLocalityRoutingStructures() {
   // residual_capacity: 0 10000 15000
   // Now to find a locality to route (bucket) we could simply iterate over residual_capacity
   // searching where sampled value is placed.
-  state.residual_capacity_.resize(num_localities);
+  std::vector<uint64_t>& residual_capacity = state->residual_capacity_;
+  residual_capacity.resize(num_localities);
 
   // Local locality (index 0) does not have residual capacity as we have routed all we could.
-  state.residual_capacity_[0] = 0;
+  residual_capacity[0] = 0;
   for (size_t i = 1; i < num_localities; ++i) {
     // Only route to the localities that have additional capacity.
     if (upstream_percentage[i] > local_percentage[i]) {
-      state.residual_capacity_[i] =
-          state.residual_capacity_[i - 1] + upstream_percentage[i] - local_percentage[i];
+      residual_capacity[i] =
+          residual_capacity[i - 1] + upstream_percentage[i] - local_percentage[i];
     } else {
       // Locality with index "i" does not have residual capacity, but we keep accumulating previous
       // values to make search easier on the next step.
-      state.residual_capacity_[i] = state.residual_capacity_[i - 1];
+      residual_capacity[i] = residual_capacity[i - 1];
     }
   }
+  return state;
 }
 
 void ZoneAwareLoadBalancerBase::resizePerPriorityState() {
   const uint32_t size = priority_set_.hostSetsPerPriority().size();
   while (per_priority_state_.size() < size) {
     // Note for P!=0, PerPriorityState is created with NoLocalityRouting and never changed.
-    per_priority_state_.push_back(std::make_unique<PerPriorityState>());
+    per_priority_state_.push_back(std::make_shared<const PerPriorityState>());
   }
 }
 
@@ -471,7 +508,7 @@ void ZoneAwareLoadBalancerBase::calculateLocalityPercentage(
 }
 
 uint32_t ZoneAwareLoadBalancerBase::tryChooseLocalLocalityHosts(const HostSet& host_set) {
-  PerPriorityState& state = *per_priority_state_[host_set.priority()];
+  const PerPriorityState& state = *per_priority_state_[host_set.priority()];
   ASSERT(state.locality_routing_state_ != LocalityRoutingState::NoLocalityRouting);
 
   // At this point it's guaranteed to be at least 2 localities & local exists.
@@ -599,17 +636,19 @@ const HostVector& ZoneAwareLoadBalancerBase::hostSourceToHosts(HostsSource hosts
 EdfLoadBalancerBase::EdfLoadBalancerBase(
     const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
     Runtime::Loader& runtime, Runtime::RandomGenerator& random,
-    const envoy::api::v2::Cluster::CommonLbConfig& common_config)
+    const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+    const LocalityRoutingCacheSharedPtr& locality_routing_cache)
     : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
-                                common_config),
+                                common_config, locality_routing_cache),
       seed_(random_.random()) {
-  // We fully recompute the schedulers for a given host set here on membership change, which is
-  // consistent with what other LB implementations do (e.g. thread aware).
+  // We fully recompute the schedulers for a given host set on the first pick after a membership
+  // change, which is consistent with what other LB implementations do (e.g. thread aware).
   // The downside of a full recompute is that time complexity is O(n * log n),
   // so we will need to do better at delta tracking to scale (see
   // https://github.com/envoyproxy/envoy/issues/2874).
-  priority_set.addPriorityUpdateCb(
-      [this](uint32_t priority, const HostVector&, const HostVector&) { refresh(priority); });
+  priority_set.addPriorityUpdateCb([this](uint32_t priority, const HostVector&, const HostVector&) {
+    stale_priorities_.insert(priority);
+  });
 }
 
 void EdfLoadBalancerBase::initialize() {
@@ -623,6 +662,9 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
     // Nuke existing scheduler if it exists.
     auto& scheduler = scheduler_[source] = Scheduler{};
     refreshHostSource(source);
+    if (!buildsEdfSchedule()) {
+      return;
+    }
 
     // Populate scheduler with host list.
     // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
@@ -670,12 +712,12 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
 }
 
 HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* context) {
+  for (const uint32_t priority : stale_priorities_) {
+    refresh(priority);
+  }
+  stale_priorities_.clear();
+
   const HostsSource hosts_source = hostSourceToUse(context);
-  auto scheduler_it = scheduler_.find(hosts_source);
-  // We should always have a scheduler for any return value from
-  // hostSourceToUse() via the construction in refresh();
-  ASSERT(scheduler_it != scheduler_.end());
-  auto& scheduler = scheduler_it->second;
 
   // As has been commented in both EdfLoadBalancerBase::refresh and
   // BaseDynamicClusterImpl::updateDynamicHostList, we must do a runtime pivot here to determine
@@ -685,11 +727,7 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   // the same but not 1 (like 42), we will use the EDF schedule not the unweighted pick. This is
   // not optimal. If this is fixed, remove the note in the arch overview docs for the LR LB.
   if (stats_.max_host_weight_.value() != 1) {
-    auto host = scheduler.edf_.pick();
-    if (host != nullptr) {
-      scheduler.edf_.add(hostWeight(*host), host);
-    }
-    return host;
+    return weightedHostPick(hosts_source);
   } else {
     const HostVector& hosts_to_use = hostSourceToHosts(hosts_source);
     if (hosts_to_use.size() == 0) {
@@ -699,6 +737,72 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   }
 }
 
+HostConstSharedPtr EdfLoadBalancerBase::weightedHostPick(const HostsSource& hosts_source) {
+  auto scheduler_it = scheduler_.find(hosts_source);
+  // We should always have a scheduler for any return value from
+  // hostSourceToUse() via the construction in refresh();
+  ASSERT(scheduler_it != scheduler_.end());
+  auto& scheduler = scheduler_it->second;
+
+  auto host = scheduler.edf_.pick();
+  if (host != nullptr) {
+    scheduler.edf_.add(hostWeight(*host), host);
+  }
+  return host;
+}
+
+void WeightedSamplingLoadBalancerBase::refreshHostSource(const HostsSource& source) {
+  const HostVector& hosts = hostSourceToHosts(source);
+  std::vector<double> weights;
+  weights.reserve(hosts.size());
+  for (const auto& host : hosts) {
+    weights.push_back(host->weight());
+  }
+  alias_tables_.erase(source);
+  alias_tables_.emplace(source, AliasTable(weights));
+}
+
+const AliasTable& WeightedSamplingLoadBalancerBase::aliasTable(const HostsSource& source) const {
+  auto alias_table_it = alias_tables_.find(source);
+  // Like the EDF schedulers, the alias tables are built for every host source in refresh(), which
+  // runs again whenever the hosts change.
+  ASSERT(alias_table_it != alias_tables_.end());
+  return alias_table_it->second;
+}
+
+HostConstSharedPtr LeastRequestLoadBalancer::weightedHostPick(const HostsSource& hosts_source) {
+  const HostVector& hosts_to_use = hostSourceToHosts(hosts_source);
+  const AliasTable& alias_table = aliasTable(hosts_source);
+  ASSERT(alias_table.size() == hosts_to_use.size());
+  if (hosts_to_use.empty()) {
+    return nullptr;
+  }
+
+  HostConstSharedPtr candidate_host = nullptr;
+  for (uint32_t choice_idx = 0; choice_idx < choice_count_; ++choice_idx) {
+    const HostSharedPtr& sampled_host = hosts_to_use[alias_table.pick(random_.random())];
+
+    if (candidate_host == nullptr) {
+      // Make a first choice to start the comparisons.
+      candidate_host = sampled_host;
+      continue;
+    }
+
+    // Compare active requests per unit of weight, i.e. sampled_active_rq / sampled_weight <
+    // candidate_active_rq / candidate_weight. Weights may change without a refresh, in which case
+    // the sampling is stale until the next refresh but the comparison still uses the new weights.
+    const uint64_t candidate_load =
+        candidate_host->stats().rq_active_.value() * sampled_host->weight();
+    const uint64_t sampled_load =
+        sampled_host->stats().rq_active_.value() * candidate_host->weight();
+    if (sampled_load < candidate_load) {
+      candidate_host = sampled_host;
+    }
+  }
+
+  return candidate_host;
+}
+
 HostConstSharedPtr LeastRequestLoadBalancer::unweightedHostPick(const HostVector& hosts_to_use,
                                                                 const HostsSource&) {
   HostSharedPtr candidate_host = nullptr;
@@ -722,13 +826,14 @@ HostConstSharedPtr LeastRequestLoadBalancer::unweightedHostPick(const HostVector
   return candidate_host;
 }
 
-HostConstSharedPtr RandomLoadBalancer::chooseHostOnce(LoadBalancerContext* context) {
-  const HostVector& hosts_to_use = hostSourceToHosts(hostSourceToUse(context));
+HostConstSharedPtr RandomLoadBalancer::weightedHostPick(const HostsSource& hosts_source) {
+  const HostVector& hosts_to_use = hostSourceToHosts(hosts_source);
+  const AliasTable& alias_table = aliasTable(hosts_source);
+  ASSERT(alias_table.size() == hosts_to_use.size());
   if (hosts_to_use.empty()) {
     return nullptr;
   }
-
-  return hosts_to_use[random_.random() % hosts_to_use.size()];
+  return hosts_to_use[alias_table.pick(random_.random())];
 }
 
 } // namespace Upstream
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <queue>
 #include <set>
 #include <vector>
@@ -10,7 +12,10 @@
 #include "envoy/upstream/load_balancer.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 #include "common/protobuf/utility.h"
+#include "common/upstream/alias_table.h"
 #include "common/upstream/edf_scheduler.h"
 
 namespace Envoy {
@@ -150,16 +155,69 @@ public:
   uint32_t hostSelectionRetryCount() const override { return 1; }
 };
 
+/**
+ * The locality routing state of P=0, which the zone aware load balancers of a cluster on all
+ * workers compute from the same host vectors of the cluster and of the local cluster. The first
+ * load balancer that needs the state for the current vectors computes it, and the others share it.
+ */
+class LocalityRoutingCache {
+public:
+  enum class LocalityRoutingState {
+    // Locality based routing is off.
+    NoLocalityRouting,
+    // All queries can be routed to the local locality.
+    LocalityDirect,
+    // The local locality can not handle the anticipated load. Residual load will be spread across
+    // various other localities.
+    LocalityResidual
+  };
+
+  struct PerPriorityState {
+    // The percent of requests which can be routed to the local locality.
+    uint64_t local_percent_to_route_{};
+    // Tracks the current state of locality based routing.
+    LocalityRoutingState locality_routing_state_{LocalityRoutingState::NoLocalityRouting};
+    // When locality_routing_state_ == LocalityResidual this tracks the capacity
+    // for each of the non-local localities to determine what traffic should be
+    // routed where.
+    std::vector<uint64_t> residual_capacity_;
+  };
+  typedef std::shared_ptr<const PerPriorityState> PerPriorityStateConstSharedPtr;
+
+  /**
+   * @return the state computed for the current healthy hosts of host_set and local_host_set, or
+   *         the result of compute() if there is none.
+   * @param host_set supplies the P=0 host set of the cluster.
+   * @param local_host_set supplies the host set of the local cluster.
+   * @param compute supplies the function that computes the state for the current hosts.
+   */
+  PerPriorityStateConstSharedPtr
+  getOrCompute(const HostSet& host_set, const HostSet& local_host_set,
+               const std::function<PerPriorityStateConstSharedPtr()>& compute);
+
+private:
+  Thread::MutexBasicLockable mutex_;
+  // The vectors that the state was computed from, which never change once shared.
+  std::weak_ptr<const HostVector> healthy_hosts_ GUARDED_BY(mutex_);
+  std::weak_ptr<const HostsPerLocality> healthy_hosts_per_locality_ GUARDED_BY(mutex_);
+  std::weak_ptr<const HostsPerLocality> local_healthy_hosts_per_locality_ GUARDED_BY(mutex_);
+  PerPriorityStateConstSharedPtr state_ GUARDED_BY(mutex_);
+};
+
+typedef std::shared_ptr<LocalityRoutingCache> LocalityRoutingCacheSharedPtr;
+
 /**
  * Base class for zone aware load balancers
  */
 class ZoneAwareLoadBalancerBase : public LoadBalancerBase {
 protected:
   // Both priority_set and local_priority_set if non-null must have at least one host set.
+  // locality_routing_cache, if non-null, is shared with the load balancers of the other workers.
   ZoneAwareLoadBalancerBase(const PrioritySet& priority_set, const PrioritySet* local_priority_set,
                             ClusterStats& stats, Runtime::Loader& runtime,
                             Runtime::RandomGenerator& random,
-                            const envoy::api::v2::Cluster::CommonLbConfig& common_config);
+                            const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+                            const LocalityRoutingCacheSharedPtr& locality_routing_cache);
   ~ZoneAwareLoadBalancerBase();
 
   // When deciding which hosts to use on an LB decision, we need to know how to index into the
@@ -230,15 +288,9 @@ protected:
   const HostVector& hostSourceToHosts(HostsSource hosts_source);
 
 private:
-  enum class LocalityRoutingState {
-    // Locality based routing is off.
-    NoLocalityRouting,
-    // All queries can be routed to the local locality.
-    LocalityDirect,
-    // The local locality can not handle the anticipated load. Residual load will be spread across
-    // various other localities.
-    LocalityResidual
-  };
+  typedef LocalityRoutingCache::LocalityRoutingState LocalityRoutingState;
+  typedef LocalityRoutingCache::PerPriorityState PerPriorityState;
+  typedef LocalityRoutingCache::PerPriorityStateConstSharedPtr PerPriorityStateConstSharedPtr;
 
   /**
    * Increase per_priority_state_ to at least priority_set.hostSetsPerPriority().size()
@@ -269,6 +321,11 @@ private:
    */
   void regenerateLocalityRoutingStructures();
 
+  /**
+   * @return the locality aware routing structures of P=0 for the current hosts.
+   */
+  PerPriorityStateConstSharedPtr computeLocalityRoutingStructures();
+
   HostSet& localHostSet() const { return *local_priority_set_->hostSetsPerPriority()[0]; }
 
   static HostsSource::SourceType localitySourceType(HostAvailability host_availability) {
@@ -298,20 +355,10 @@ private:
 
   const uint32_t routing_enabled_;
   const uint64_t min_cluster_size_;
+  const LocalityRoutingCacheSharedPtr locality_routing_cache_;
 
-  struct PerPriorityState {
-    // The percent of requests which can be routed to the local locality.
-    uint64_t local_percent_to_route_{};
-    // Tracks the current state of locality based routing.
-    LocalityRoutingState locality_routing_state_{LocalityRoutingState::NoLocalityRouting};
-    // When locality_routing_state_ == LocalityResidual this tracks the capacity
-    // for each of the non-local localities to determine what traffic should be
-    // routed where.
-    std::vector<uint64_t> residual_capacity_;
-  };
-  typedef std::unique_ptr<PerPriorityState> PerPriorityStatePtr;
   // Routing state broken out for each priority level in priority_set_.
-  std::vector<PerPriorityStatePtr> per_priority_state_;
+  std::vector<PerPriorityStateConstSharedPtr> per_priority_state_;
   Common::CallbackHandle* local_priority_set_member_update_cb_handle_{};
 };
 
@@ -330,14 +377,16 @@ private:
  * instances.
  *
  * This base class also supports unweighted selection which derived classes can use to customize
- * behavior. Derived classes can also override how host weight is determined when in weighted mode.
+ * behavior. Derived classes can also override how host weight is determined when in weighted mode,
+ * or replace the EDF schedule with their own weighted selection.
  */
 class EdfLoadBalancerBase : public ZoneAwareLoadBalancerBase {
 public:
   EdfLoadBalancerBase(const PrioritySet& priority_set, const PrioritySet* local_priority_set,
                       ClusterStats& stats, Runtime::Loader& runtime,
                       Runtime::RandomGenerator& random,
-                      const envoy::api::v2::Cluster::CommonLbConfig& common_config);
+                      const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+                      const LocalityRoutingCacheSharedPtr& locality_routing_cache);
 
   // Upstream::LoadBalancerBase
   HostConstSharedPtr chooseHostOnce(LoadBalancerContext* context) override;
@@ -360,12 +409,21 @@ protected:
 private:
   void refresh(uint32_t priority);
   virtual void refreshHostSource(const HostsSource& source) PURE;
-  virtual double hostWeight(const Host& host) PURE;
+  virtual double hostWeight(const Host& host) { return host.weight(); }
   virtual HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
                                                 const HostsSource& source) PURE;
+  // Whether refresh() builds an EDF schedule for each host source. Derived classes that don't use
+  // the schedule must also override weightedHostPick().
+  virtual bool buildsEdfSchedule() const { return true; }
+  // Picks a host when any host is weighted. By default, picks from the EDF schedule.
+  virtual HostConstSharedPtr weightedHostPick(const HostsSource& source);
 
   // Scheduler for each valid HostsSource.
   std::unordered_map<HostsSource, Scheduler, HostsSourceHash> scheduler_;
+  // Priorities whose host set changed since their schedules were built. They are rebuilt on the
+  // next pick, so a burst of host set updates costs a single rebuild, and none at all on a worker
+  // that doesn't pick from the cluster in between.
+  std::set<uint32_t> stale_priorities_;
 };
 
 /**
@@ -377,9 +435,10 @@ public:
   RoundRobinLoadBalancer(const PrioritySet& priority_set, const PrioritySet* local_priority_set,
                          ClusterStats& stats, Runtime::Loader& runtime,
                          Runtime::RandomGenerator& random,
-                         const envoy::api::v2::Cluster::CommonLbConfig& common_config)
+                         const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+                         const LocalityRoutingCacheSharedPtr& locality_routing_cache = nullptr)
       : EdfLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
-                            common_config) {
+                            common_config, locality_routing_cache) {
     initialize();
   }
 
@@ -390,7 +449,6 @@ private:
     // is it probably doesn't matter.
     rr_indexes_.insert({source, seed_});
   }
-  double hostWeight(const Host& host) override { return host.weight(); }
   HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
                                         const HostsSource& source) override {
     // To avoid storing the RR index in the base class, we end up using a second map here with
@@ -403,6 +461,37 @@ private:
   std::unordered_map<HostsSource, uint64_t, HostsSourceHash> rr_indexes_;
 };
 
+/**
+ * Base implementation of load balancers that sample hosts at random with a probability
+ * proportional to their weight when any host is weighted. Instead of an EDF schedule, an alias
+ * table is built for each host source on refresh. A table is immutable once built, so a weighted
+ * pick is O(1) and needs no per pick bookkeeping.
+ */
+class WeightedSamplingLoadBalancerBase : public EdfLoadBalancerBase {
+public:
+  WeightedSamplingLoadBalancerBase(const PrioritySet& priority_set,
+                                   const PrioritySet* local_priority_set, ClusterStats& stats,
+                                   Runtime::Loader& runtime, Runtime::RandomGenerator& random,
+                                   const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+                                   const LocalityRoutingCacheSharedPtr& locality_routing_cache)
+      : EdfLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
+                            common_config, locality_routing_cache) {}
+
+protected:
+  /**
+   * @return the alias table of a host source, which samples indexes into
+   *         hostSourceToHosts(source) with a probability proportional to the host weights at
+   *         refresh time.
+   */
+  const AliasTable& aliasTable(const HostsSource& source) const;
+
+private:
+  void refreshHostSource(const HostsSource& source) override;
+  bool buildsEdfSchedule() const override { return false; }
+
+  std::unordered_map<HostsSource, AliasTable, HostsSourceHash> alias_tables_;
+};
+
 /**
  * Weighted Least Request load balancer.
  *
@@ -411,24 +500,22 @@ private:
  * is based on http://www.eecs.harvard.edu/~michaelm/postscripts/mythesis.pdf and is known as P2C
  * (power of two choices).
  *
- * When any hosts have a weight that is not 1, an RR EDF schedule is used. Host weight is scaled
- * by the number of active requests at pick/insert time. Thus, hosts will never fully drain as
- * they would in normal P2C, though they will get picked less and less often. In the future, we
- * can consider two alternate algorithms:
- * 1) Expand out all hosts by weight (using more memory) and do standard P2C.
- * 2) Use a weighted Maglev table, and perform P2C on two random hosts selected from the table.
- *    The benefit of the Maglev table is at the expense of resolution, memory usage is capped.
- *    Additionally, the Maglev table can be shared amongst all threads.
+ * When any hosts have a weight that is not 1, weighted P2C is used instead: the N hosts are
+ * sampled with a probability proportional to their weight from an alias table, which is built on
+ * each host set refresh and picks in O(1), and the host with the fewest active requests per unit
+ * of weight is chosen. Like unweighted P2C, this tracks the live request load, and a host with the
+ * highest load will drain.
  */
-class LeastRequestLoadBalancer : public EdfLoadBalancerBase {
+class LeastRequestLoadBalancer : public WeightedSamplingLoadBalancerBase {
 public:
   LeastRequestLoadBalancer(
       const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
       Runtime::Loader& runtime, Runtime::RandomGenerator& random,
       const envoy::api::v2::Cluster::CommonLbConfig& common_config,
-      const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig> least_request_config)
-      : EdfLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
-                            common_config),
+      const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig> least_request_config,
+      const LocalityRoutingCacheSharedPtr& locality_routing_cache = nullptr)
+      : WeightedSamplingLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
+                                         common_config, locality_routing_cache),
         choice_count_(
             least_request_config.has_value()
                 ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(least_request_config.value(), choice_count, 2)
@@ -437,39 +524,35 @@ public:
   }
 
 private:
-  void refreshHostSource(const HostsSource&) override {}
-  double hostWeight(const Host& host) override {
-    // Here we scale host weight by the number of active requests at the time we do the pick. We
-    // always add 1 to avoid division by 0. Note that if all weights are 1, the EDF schedule is
-    // unlikely to yield the same result as P2C given the lack of randomness as well as the fact
-    // that hosts are always picked, regardless of their current request load at the time of pick.
-    // It might be possible to do better by picking two hosts off of the schedule, and selecting
-    // the one with fewer active requests at the time of selection.
-    // TODO(mattklein123): @htuch brings up the point that how we are scaling weight here might not
-    // be the only/best way of doing this. Essentially, it makes weight and active requests equally
-    // important. Are they equally important in practice? There is no right answer here and we might
-    // want to iterate on this as we gain more experience.
-    return static_cast<double>(host.weight()) / (host.stats().rq_active_.value() + 1);
-  }
   HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
                                         const HostsSource& source) override;
+  HostConstSharedPtr weightedHostPick(const HostsSource& source) override;
+
   const uint32_t choice_count_;
 };
 
 /**
- * Random load balancer that picks a random host out of all hosts.
+ * Random load balancer that picks a random host out of all hosts. When any hosts have a weight
+ * that is not 1, hosts are picked with a probability proportional to their weight.
  */
-class RandomLoadBalancer : public ZoneAwareLoadBalancerBase {
+class RandomLoadBalancer : public WeightedSamplingLoadBalancerBase {
 public:
   RandomLoadBalancer(const PrioritySet& priority_set, const PrioritySet* local_priority_set,
                      ClusterStats& stats, Runtime::Loader& runtime,
                      Runtime::RandomGenerator& random,
-                     const envoy::api::v2::Cluster::CommonLbConfig& common_config)
-      : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
-                                  common_config) {}
+                     const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+                     const LocalityRoutingCacheSharedPtr& locality_routing_cache = nullptr)
+      : WeightedSamplingLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
+                                         common_config, locality_routing_cache) {
+    initialize();
+  }
 
-  // Upstream::LoadBalancerBase
-  HostConstSharedPtr chooseHostOnce(LoadBalancerContext* context) override;
+private:
+  HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
+                                        const HostsSource&) override {
+    return hosts_to_use[random_.random() % hosts_to_use.size()];
+  }
+  HostConstSharedPtr weightedHostPick(const HostsSource& source) override;
 };
 
 /**
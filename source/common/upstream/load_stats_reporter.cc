@@ -42,9 +42,12 @@ void LoadStatsReporter::establishNewStream() {
 
 void LoadStatsReporter::sendLoadStatsRequest() {
   request_.mutable_cluster_stats()->Clear();
-  for (const auto& cluster_name_and_timestamp : clusters_) {
+  // clusters() copies the map of all the clusters, of which there can be tens of thousands, so it
+  // is taken once per report rather than once per reported cluster.
+  const auto cluster_info_map = cm_.clusters();
+  const auto now = time_source_.monotonicTime().time_since_epoch();
+  for (auto& cluster_name_and_timestamp : clusters_) {
     const std::string& cluster_name = cluster_name_and_timestamp.first;
-    auto cluster_info_map = cm_.clusters();
     auto it = cluster_info_map.find(cluster_name);
     if (it == cluster_info_map.end()) {
       ENVOY_LOG(debug, "Cluster {} does not exist", cluster_name);
@@ -80,12 +83,11 @@ void LoadStatsReporter::sendLoadStatsRequest() {
     }
     cluster_stats->set_total_dropped_requests(
         cluster.info()->loadReportStats().upstream_rq_dropped_.latch());
-    const auto now = time_source_.monotonicTime().time_since_epoch();
     const auto measured_interval = now - cluster_name_and_timestamp.second;
     cluster_stats->mutable_load_report_interval()->MergeFrom(
         Protobuf::util::TimeUtil::MicrosecondsToDuration(
             std::chrono::duration_cast<std::chrono::microseconds>(measured_interval).count()));
-    clusters_[cluster_name] = now;
+    cluster_name_and_timestamp.second = now;
   }
 
   ENVOY_LOG(trace, "Sending LoadStatsRequest: {}", request_.DebugString());
@@ -135,12 +137,12 @@ void LoadStatsReporter::startLoadReportPeriod() {
     }
   }
   clusters_.clear();
+  const auto cluster_info_map = cm_.clusters();
   // Reset stats for all hosts in clusters we are tracking.
   for (const std::string& cluster_name : message_->clusters()) {
     clusters_.emplace(cluster_name, existing_clusters.count(cluster_name) > 0
                                         ? existing_clusters[cluster_name]
                                         : time_source_.monotonicTime().time_since_epoch());
-    auto cluster_info_map = cm_.clusters();
     auto it = cluster_info_map.find(cluster_name);
     if (it == cluster_info_map.end()) {
       continue;
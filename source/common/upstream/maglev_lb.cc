@@ -1,5 +1,7 @@
 #include "common/upstream/maglev_lb.h"
 
+#include "envoy/stats/timespan.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -22,15 +24,17 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
   // Implementation of pseudocode listing 1 in the paper (see header file for more info).
   std::vector<TableBuildEntry> table_build_entries;
   table_build_entries.reserve(normalized_host_weights.size());
+  hosts_.reserve(normalized_host_weights.size());
   for (const auto& host_weight : normalized_host_weights) {
     const auto& host = host_weight.first;
     const std::string& address = host->address()->asString();
-    table_build_entries.emplace_back(host, HashUtil::xxHash64(address) % table_size_,
+    table_build_entries.emplace_back(HashUtil::xxHash64(address) % table_size_,
                                      (HashUtil::xxHash64(address, 1) % (table_size_ - 1)) + 1,
                                      host_weight.second);
+    hosts_.push_back(host);
   }
 
-  table_.resize(table_size_);
+  table_.resize(table_size_, UnassignedEntry);
 
   // Iterate through the table build entries as many times as it takes to fill up the table.
   uint64_t table_index = 0;
@@ -46,12 +50,12 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
       }
       entry.target_weight_ += max_normalized_weight;
       uint64_t c = permutation(entry);
-      while (table_[c] != nullptr) {
+      while (table_[c] != UnassignedEntry) {
         entry.next_++;
         c = permutation(entry);
       }
 
-      table_[c] = entry.host_;
+      table_[c] = i;
       entry.next_++;
       entry.count_++;
       table_index++;
@@ -69,7 +73,7 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
 
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
     for (uint64_t i = 0; i < table_.size(); i++) {
-      ENVOY_LOG(trace, "maglev: i={} host={}", i, table_[i]->address()->asString());
+      ENVOY_LOG(trace, "maglev: i={} host={}", i, hosts_[table_[i]]->address()->asString());
     }
   }
 }
@@ -79,7 +83,7 @@ HostConstSharedPtr MaglevTable::chooseHost(uint64_t hash) const {
     return nullptr;
   }
 
-  return table_[hash % table_size_];
+  return hosts_[table_[hash % table_size_]];
 }
 
 uint64_t MaglevTable::permutation(const TableBuildEntry& entry) {
@@ -88,15 +92,27 @@ uint64_t MaglevTable::permutation(const TableBuildEntry& entry) {
 
 MaglevLoadBalancer::MaglevLoadBalancer(const PrioritySet& priority_set, ClusterStats& stats,
                                        Stats::Scope& scope, Runtime::Loader& runtime,
-                                       Runtime::RandomGenerator& random,
+                                       Runtime::RandomGenerator& random, TimeSource& time_source,
                                        const envoy::api::v2::Cluster::CommonLbConfig& common_config,
                                        uint64_t table_size)
     : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random, common_config),
       scope_(scope.createScope("maglev_lb.")), stats_(generateStats(*scope_)),
-      table_size_(table_size) {}
+      time_source_(time_source), table_size_(table_size) {}
+
+ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr
+MaglevLoadBalancer::createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
+                                       double /* min_normalized_weight */,
+                                       double max_normalized_weight) {
+  Stats::TimespanWithUnit<std::chrono::microseconds> build_timer(stats_.table_build_time_us_,
+                                                                 time_source_);
+  auto table = std::make_shared<MaglevTable>(normalized_host_weights, max_normalized_weight,
+                                             table_size_, stats_);
+  build_timer.complete();
+  return table;
+}
 
 MaglevLoadBalancerStats MaglevLoadBalancer::generateStats(Stats::Scope& scope) {
-  return {ALL_MAGLEV_LOAD_BALANCER_STATS(POOL_GAUGE(scope))};
+  return {ALL_MAGLEV_LOAD_BALANCER_STATS(POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
 
 } // namespace Upstream
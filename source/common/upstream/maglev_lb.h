@@ -1,5 +1,8 @@
 #pragma once
 
+#include <limits>
+
+#include "envoy/common/time.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 
@@ -13,16 +16,17 @@ namespace Upstream {
  * All Maglev load balancer stats. @see stats_macros.h
  */
 // clang-format off
-#define ALL_MAGLEV_LOAD_BALANCER_STATS(GAUGE)                                                      \
+#define ALL_MAGLEV_LOAD_BALANCER_STATS(GAUGE, HISTOGRAM)                                           \
   GAUGE(min_entries_per_host)                                                                      \
-  GAUGE(max_entries_per_host)
+  GAUGE(max_entries_per_host)                                                                      \
+  HISTOGRAM(table_build_time_us)
 // clang-format on
 
 /**
  * Struct definition for all Maglev load balancer stats. @see stats_macros.h
  */
 struct MaglevLoadBalancerStats {
-  ALL_MAGLEV_LOAD_BALANCER_STATS(GENERATE_GAUGE_STRUCT)
+  ALL_MAGLEV_LOAD_BALANCER_STATS(GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -30,6 +34,9 @@ struct MaglevLoadBalancerStats {
  * https://static.googleusercontent.com/media/research.google.com/en//pubs/archive/44824.pdf
  * section 3.4. Specifically, the algorithm shown in pseudocode listening 1 is implemented
  * with a fixed table size of 65537. This is the recommended table size in section 5.3.
+ *
+ * The table holds indices into a host vector rather than a host pointer per entry, which keeps it
+ * 4 bytes per entry and avoids a reference count update per entry when it is built and destroyed.
  */
 class MaglevTable : public ThreadAwareLoadBalancerBase::HashingLoadBalancer,
                     Logger::Loggable<Logger::Id::upstream> {
@@ -45,10 +52,9 @@ public:
 
 private:
   struct TableBuildEntry {
-    TableBuildEntry(const HostConstSharedPtr& host, uint64_t offset, uint64_t skip, double weight)
-        : host_(host), offset_(offset), skip_(skip), weight_(weight) {}
+    TableBuildEntry(uint64_t offset, uint64_t skip, double weight)
+        : offset_(offset), skip_(skip), weight_(weight) {}
 
-    HostConstSharedPtr host_;
     const uint64_t offset_;
     const uint64_t skip_;
     const double weight_;
@@ -59,8 +65,13 @@ private:
 
   uint64_t permutation(const TableBuildEntry& entry);
 
+  // Marks a table entry that has not been assigned a host yet while the table is built.
+  static const uint32_t UnassignedEntry = std::numeric_limits<uint32_t>::max();
+
   const uint64_t table_size_;
-  std::vector<HostConstSharedPtr> table_;
+  std::vector<HostConstSharedPtr> hosts_;
+  // Index into hosts_ of the host of each table entry.
+  std::vector<uint32_t> table_;
   MaglevLoadBalancerStats& stats_;
 };
 
@@ -71,6 +82,7 @@ class MaglevLoadBalancer : public ThreadAwareLoadBalancerBase {
 public:
   MaglevLoadBalancer(const PrioritySet& priority_set, ClusterStats& stats, Stats::Scope& scope,
                      Runtime::Loader& runtime, Runtime::RandomGenerator& random,
+                     TimeSource& time_source,
                      const envoy::api::v2::Cluster::CommonLbConfig& common_config,
                      uint64_t table_size = MaglevTable::DefaultTableSize);
 
@@ -80,15 +92,13 @@ private:
   // ThreadAwareLoadBalancerBase
   HashingLoadBalancerSharedPtr
   createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double /* min_normalized_weight */, double max_normalized_weight) override {
-    return std::make_shared<MaglevTable>(normalized_host_weights, max_normalized_weight,
-                                         table_size_, stats_);
-  }
+                     double min_normalized_weight, double max_normalized_weight) override;
 
   static MaglevLoadBalancerStats generateStats(Stats::Scope& scope);
 
   Stats::ScopePtr scope_;
   MaglevLoadBalancerStats stats_;
+  TimeSource& time_source_;
   const uint64_t table_size_;
 };
 
@@ -23,25 +23,28 @@ namespace Upstream {
 // and throws an exception otherwise.
 
 OriginalDstCluster::LoadBalancer::LoadBalancer(
-    PrioritySet& priority_set, ClusterSharedPtr& parent,
-    const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>& config)
-    : priority_set_(priority_set), parent_(std::static_pointer_cast<OriginalDstCluster>(parent)),
-      info_(parent->info()), use_http_header_(config ? config.value().use_http_header() : false) {
-  // priority_set_ is initially empty.
-  priority_set_.addMemberUpdateCb(
-      [this](const HostVector& hosts_added, const HostVector& hosts_removed) -> void {
-        // Update the hosts map
-        // TODO(ramaraochavali): use cluster stats and move the log lines to debug.
-        for (const HostSharedPtr& host : hosts_removed) {
-          ENVOY_LOG(debug, "Removing host {}.", host->address()->asString());
-          host_map_.remove(host);
-        }
-        for (const HostSharedPtr& host : hosts_added) {
-          if (host_map_.insert(host)) {
-            ENVOY_LOG(debug, "Adding host {}.", host->address()->asString());
-          }
-        }
-      });
+    const ClusterSharedPtr& parent,
+    const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>& config,
+    Event::Dispatcher& dispatcher, HostsRemovedCb hosts_removed_cb)
+    : info_(parent->info()), use_http_header_(config ? config.value().use_http_header() : false),
+      cleanup_interval_ms_(std::static_pointer_cast<OriginalDstCluster>(parent)->cleanupInterval()),
+      hosts_removed_cb_(std::move(hosts_removed_cb)),
+      cleanup_timer_(dispatcher.createTimer([this]() -> void { cleanup(); })) {
+  cleanup_timer_->enableTimer(cleanup_interval_ms_);
+}
+
+OriginalDstCluster::LoadBalancer::~LoadBalancer() {
+  HostVector hosts_removed;
+  hosts_removed.reserve(current_hosts_.size() + previous_hosts_.size());
+  for (const auto& host : current_hosts_) {
+    hosts_removed.emplace_back(host.second);
+  }
+  for (const auto& host : previous_hosts_) {
+    hosts_removed.emplace_back(host.second);
+  }
+  if (!hosts_removed.empty()) {
+    hosts_removed_cb_(hosts_removed);
+  }
 }
 
 HostConstSharedPtr OriginalDstCluster::LoadBalancer::chooseHost(LoadBalancerContext* context) {
@@ -63,12 +66,21 @@ HostConstSharedPtr OriginalDstCluster::LoadBalancer::chooseHost(LoadBalancerCont
 
     if (dst_host) {
       const Network::Address::Instance& dst_addr = *dst_host.get();
-
-      // Check if a host with the destination address is already in the host set.
-      HostSharedPtr host = host_map_.find(dst_addr);
-      if (host) {
-        ENVOY_LOG(debug, "Using existing host {}.", host->address()->asString());
-        host->used(true); // Mark as used.
+      const std::string& dst_addr_str = dst_addr.asString();
+
+      // Check if a host with the destination address is already known to this worker. A host
+      // that was last used during the previous cleanup interval moves back to the current one.
+      auto host_it = current_hosts_.find(dst_addr_str);
+      if (host_it != current_hosts_.end()) {
+        ENVOY_LOG(debug, "Using existing host {}.", host_it->second->address()->asString());
+        return host_it->second;
+      }
+      host_it = previous_hosts_.find(dst_addr_str);
+      if (host_it != previous_hosts_.end()) {
+        ENVOY_LOG(debug, "Using existing host {}.", host_it->second->address()->asString());
+        HostSharedPtr host = host_it->second;
+        previous_hosts_.erase(host_it);
+        current_hosts_.emplace(dst_addr_str, host);
         return std::move(host);
       }
       // Add a new host
@@ -77,7 +89,7 @@ HostConstSharedPtr OriginalDstCluster::LoadBalancer::chooseHost(LoadBalancerCont
         Network::Address::InstanceConstSharedPtr host_ip_port(
             Network::Utility::copyInternetAddressAndPort(*dst_ip));
         // Create a host we can use immediately.
-        host.reset(
+        HostSharedPtr host(
             new HostImpl(info_, info_->name() + dst_addr.asString(), std::move(host_ip_port),
                          envoy::api::v2::core::Metadata::default_instance(), 1,
                          envoy::api::v2::core::Locality().default_instance(),
@@ -85,21 +97,7 @@ HostConstSharedPtr OriginalDstCluster::LoadBalancer::chooseHost(LoadBalancerCont
                          0, envoy::api::v2::core::HealthStatus::UNKNOWN));
 
         ENVOY_LOG(debug, "Created host {}.", host->address()->asString());
-        // Add the new host to the map. We just failed to find it in
-        // our local map above, so insert without checking (2nd arg == false).
-        host_map_.insert(host, false);
-
-        if (std::shared_ptr<OriginalDstCluster> parent = parent_.lock()) {
-          // lambda cannot capture a member by value.
-          std::weak_ptr<OriginalDstCluster> post_parent = parent_;
-          parent->dispatcher_.post([post_parent, host]() mutable {
-            // The main cluster may have disappeared while this post was queued.
-            if (std::shared_ptr<OriginalDstCluster> parent = post_parent.lock()) {
-              parent->addHost(host);
-            }
-          });
-        }
-
+        current_hosts_.emplace(dst_addr_str, host);
         return std::move(host);
       } else {
         ENVOY_LOG(debug, "Failed to create host for {}.", dst_addr.asString());
@@ -111,6 +109,25 @@ HostConstSharedPtr OriginalDstCluster::LoadBalancer::chooseHost(LoadBalancerCont
   return nullptr;
 }
 
+void OriginalDstCluster::LoadBalancer::cleanup() {
+  ENVOY_LOG(trace, "Stale original dst hosts cleanup triggered.");
+  // Only the hosts that were not used during the last full interval are visited.
+  HostVector hosts_removed;
+  hosts_removed.reserve(previous_hosts_.size());
+  for (const auto& host : previous_hosts_) {
+    ENVOY_LOG(debug, "Removing stale host {}.", host.second->address()->asString());
+    hosts_removed.emplace_back(host.second);
+  }
+  previous_hosts_.clear();
+  previous_hosts_.swap(current_hosts_);
+
+  if (!hosts_removed.empty()) {
+    hosts_removed_cb_(hosts_removed);
+  }
+
+  cleanup_timer_->enableTimer(cleanup_interval_ms_);
+}
+
 Network::Address::InstanceConstSharedPtr
 OriginalDstCluster::LoadBalancer::requestOverrideHost(LoadBalancerContext* context) {
   Network::Address::InstanceConstSharedPtr request_host;
@@ -135,54 +152,8 @@ OriginalDstCluster::OriginalDstCluster(
     Server::Configuration::TransportSocketFactoryContext& factory_context,
     Stats::ScopePtr&& stats_scope, bool added_via_api)
     : ClusterImplBase(config, runtime, factory_context, std::move(stats_scope), added_via_api),
-      dispatcher_(factory_context.dispatcher()),
       cleanup_interval_ms_(
-          std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(config, cleanup_interval, 5000))),
-      cleanup_timer_(dispatcher_.createTimer([this]() -> void { cleanup(); })) {
-
-  cleanup_timer_->enableTimer(cleanup_interval_ms_);
-}
-
-void OriginalDstCluster::addHost(HostSharedPtr& host) {
-  // Given the current config, only EDS clusters support multiple priorities.
-  ASSERT(priority_set_.hostSetsPerPriority().size() == 1);
-  const auto& first_host_set = priority_set_.getOrCreateHostSet(0);
-  HostVectorSharedPtr new_hosts(new HostVector(first_host_set.hosts()));
-  new_hosts->emplace_back(host);
-  priority_set_.updateHosts(0,
-                            HostSetImpl::partitionHosts(new_hosts, HostsPerLocalityImpl::empty()),
-                            {}, {std::move(host)}, {}, absl::nullopt);
-}
-
-void OriginalDstCluster::cleanup() {
-  HostVectorSharedPtr new_hosts(new HostVector);
-  HostVector to_be_removed;
-  // Given the current config, only EDS clusters support multiple priorities.
-  ASSERT(priority_set_.hostSetsPerPriority().size() == 1);
-  const auto& host_set = priority_set_.getOrCreateHostSet(0);
-  ENVOY_LOG(trace, "Stale original dst hosts cleanup triggered.");
-  if (!host_set.hosts().empty()) {
-    ENVOY_LOG(debug, "Cleaning up stale original dst hosts.");
-    for (const HostSharedPtr& host : host_set.hosts()) {
-      if (host->used()) {
-        ENVOY_LOG(debug, "Keeping active host {}.", host->address()->asString());
-        new_hosts->emplace_back(host);
-        host->used(false); // Mark to be removed during the next round.
-      } else {
-        ENVOY_LOG(debug, "Removing stale host {}.", host->address()->asString());
-        to_be_removed.emplace_back(host);
-      }
-    }
-  }
-
-  if (to_be_removed.size() > 0) {
-    priority_set_.updateHosts(0,
-                              HostSetImpl::partitionHosts(new_hosts, HostsPerLocalityImpl::empty()),
-                              {}, {}, to_be_removed, absl::nullopt);
-  }
-
-  cleanup_timer_->enableTimer(cleanup_interval_ms_);
-}
+          std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(config, cleanup_interval, 5000))) {}
 
 ClusterImplBaseSharedPtr OriginalDstClusterFactory::createClusterImpl(
     const envoy::api::v2::Cluster& cluster, ClusterFactoryContext& context,
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <string>
 #include <unordered_map>
 
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
 #include "envoy/secret/secret_manager.h"
 #include "envoy/server/transport_socket_config.h"
 #include "envoy/stats/scope.h"
@@ -25,6 +28,11 @@ namespace Upstream {
  * original destination address of the downstream connection. These hosts are also automatically
  * cleaned up after they have not seen traffic for a configurable cleanup interval time
  * ("cleanup_interval_ms").
+ *
+ * The hosts are owned by the load balancer of each worker rather than by the cluster, so that a
+ * new original destination never goes through the main thread and never causes the host set to be
+ * copied and re-broadcast to the workers. As a result the hosts do not appear in the cluster's
+ * host set.
  */
 class OriginalDstCluster : public ClusterImplBase {
 public:
@@ -35,88 +43,65 @@ public:
   // Upstream::Cluster
   InitializePhase initializePhase() const override { return InitializePhase::Primary; }
 
+  typedef std::function<void(const HostVector& hosts_removed)> HostsRemovedCb;
+
   /**
    * Special Load Balancer for Original Dst Cluster.
    *
-   * Load balancer gets called with the downstream context which can be used to make sure the
-   * Original Dst cluster has a Host for the original destination. Normally load balancers can't
-   * modify clusters, but in this case we access a singleton OriginalDstCluster that we can ask to
-   * add hosts on demand. Additions are synced with all other threads so that the host set in the
-   * cluster remains (eventually) consistent. If multiple threads add a host to the same upstream
-   * address then two distinct HostSharedPtr's (with the same upstream IP address) will be added,
-   * and both of them will eventually time out.
+   * Load balancer gets called with the downstream context which can be used to make sure there is
+   * a Host for the original destination. Each worker's load balancer keeps its own map of hosts,
+   * which it looks up without any locking and adds new hosts to right away. If several workers
+   * see the same original destination then each of them creates a distinct HostSharedPtr (with
+   * the same upstream IP address), and each of them times out independently.
+   *
+   * Hosts expire by generation: the hosts used during the current cleanup interval are in one map
+   * and the hosts only used during the previous interval are in another, so a cleanup only visits
+   * the hosts that expire.
    */
   class LoadBalancer : public Upstream::LoadBalancer {
   public:
-    LoadBalancer(PrioritySet& priority_set, ClusterSharedPtr& parent,
-                 const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>& config);
+    /**
+     * @param parent supplies the original destination cluster.
+     * @param config supplies the original destination LB config.
+     * @param dispatcher supplies the dispatcher of the worker the load balancer is used on.
+     * @param hosts_removed_cb supplies the callback invoked on the worker with the hosts that
+     *        expired, so that their connection pools can be drained. It is also invoked with all
+     *        the remaining hosts when the load balancer is destroyed.
+     */
+    LoadBalancer(const ClusterSharedPtr& parent,
+                 const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>& config,
+                 Event::Dispatcher& dispatcher, HostsRemovedCb hosts_removed_cb);
+    ~LoadBalancer();
 
     // Upstream::LoadBalancer
     HostConstSharedPtr chooseHost(LoadBalancerContext* context) override;
 
   private:
-    /**
-     * Map from an host IP address/port to a HostSharedPtr. Due to races multiple distinct host
-     * objects with the same address can be created, so we need to use a multimap.
-     */
-    class HostMap {
-    public:
-      bool insert(const HostSharedPtr& host, bool check = true) {
-        if (check) {
-          auto range = map_.equal_range(host->address()->asString());
-          auto it = std::find_if(
-              range.first, range.second,
-              [&host](const decltype(map_)::value_type pair) { return pair.second == host; });
-          if (it != range.second) {
-            return false; // 'host' already in the map, no need to insert.
-          }
-        }
-        map_.emplace(host->address()->asString(), host);
-        return true;
-      }
-
-      void remove(const HostSharedPtr& host) {
-        auto range = map_.equal_range(host->address()->asString());
-        auto it =
-            std::find_if(range.first, range.second, [&host](const decltype(map_)::value_type pair) {
-              return pair.second == host;
-            });
-        ASSERT(it != range.second);
-        map_.erase(it);
-      }
-
-      HostSharedPtr find(const Network::Address::Instance& address) {
-        auto it = map_.find(address.asString());
-
-        if (it != map_.end()) {
-          return it->second;
-        }
-        return nullptr;
-      }
-
-    private:
-      std::unordered_multimap<std::string, HostSharedPtr> map_;
-    };
+    // Map from a host IP address/port to the host.
+    typedef std::unordered_map<std::string, HostSharedPtr> HostMap;
 
     Network::Address::InstanceConstSharedPtr requestOverrideHost(LoadBalancerContext* context);
+    void cleanup();
 
-    PrioritySet& priority_set_;                // Thread local priority set.
-    std::weak_ptr<OriginalDstCluster> parent_; // Primary cluster managed by the main thread.
     ClusterInfoConstSharedPtr info_;
     const bool use_http_header_;
-    HostMap host_map_;
+    const std::chrono::milliseconds cleanup_interval_ms_;
+    const HostsRemovedCb hosts_removed_cb_;
+    const Event::TimerPtr cleanup_timer_;
+    // Hosts used since the last cleanup.
+    HostMap current_hosts_;
+    // Hosts used during the previous cleanup interval but not since, which expire at the next
+    // cleanup unless they are used again.
+    HostMap previous_hosts_;
   };
 
-private:
-  void addHost(HostSharedPtr&);
-  void cleanup();
+  std::chrono::milliseconds cleanupInterval() const { return cleanup_interval_ms_; }
 
+private:
   // ClusterImplBase
   void startPreInit() override { onPreInitComplete(); }
 
-  Event::Dispatcher& dispatcher_;
   const std::chrono::milliseconds cleanup_interval_ms_;
-  Event::TimerPtr cleanup_timer_;
 };
 
 class OriginalDstClusterFactory : public ClusterFactoryImplBase {
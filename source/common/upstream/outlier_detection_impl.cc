@@ -49,7 +49,7 @@ void DetectorHostMonitorImpl::updateCurrentSuccessRateBucket() {
 }
 
 void DetectorHostMonitorImpl::putHttpResponseCode(uint64_t response_code) {
-  success_rate_accumulator_bucket_.load()->total_request_counter_++;
+  success_rate_accumulator_bucket_.load()->incTotalRequests();
   if (Http::CodeUtility::is5xx(response_code)) {
     std::shared_ptr<DetectorImpl> detector = detector_.lock();
     if (!detector) {
@@ -72,7 +72,7 @@ void DetectorHostMonitorImpl::putHttpResponseCode(uint64_t response_code) {
       detector->onConsecutive5xx(host_.lock());
     }
   } else {
-    success_rate_accumulator_bucket_.load()->success_request_counter_++;
+    success_rate_accumulator_bucket_.load()->incSuccessRequests();
     consecutive_5xx_ = 0;
     consecutive_gateway_failure_ = 0;
   }
@@ -363,32 +363,31 @@ void DetectorImpl::onConsecutiveErrorWorker(
   }
 }
 
-Utility::EjectionPair Utility::successRateEjectionThreshold(
-    double success_rate_sum, const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-    double success_rate_stdev_factor) {
+void SuccessRateStatistics::add(double success_rate) {
+  count_++;
+  const double delta = success_rate - mean_;
+  mean_ += delta / count_;
+  m2_ += delta * (success_rate - mean_);
+}
+
+Utility::EjectionPair
+Utility::successRateEjectionThreshold(const SuccessRateStatistics& statistics,
+                                      double success_rate_stdev_factor) {
   // This function is using mean and standard deviation as statistical measures for outlier
-  // detection. First the mean is calculated by dividing the sum of success rate data over the
-  // number of data points. Then variance is calculated by taking the mean of the
-  // squared difference of data points to the mean of the data. Then standard deviation is
+  // detection. The mean and the variance, the mean of the squared difference of data points to
+  // the mean of the data, are maintained as the data points are added. Then standard deviation is
   // calculated by taking the square root of the variance. Then the outlier threshold is
   // calculated as the difference between the mean and the product of the standard
   // deviation and a constant factor.
   //
   // For example with a data set that looks like success_rate_data = {50, 100, 100, 100, 100} the
   // math would work as follows:
-  // success_rate_sum = 450
   // mean = 90
   // variance = 400
   // stdev = 20
   // threshold returned = 52
-  double mean = success_rate_sum / valid_success_rate_hosts.size();
-  double variance = 0;
-  std::for_each(valid_success_rate_hosts.begin(), valid_success_rate_hosts.end(),
-                [&variance, mean](HostSuccessRatePair v) {
-                  variance += std::pow(v.success_rate_ - mean, 2);
-                });
-  variance /= valid_success_rate_hosts.size();
-  double stdev = std::sqrt(variance);
+  const double mean = statistics.mean();
+  const double stdev = std::sqrt(statistics.variance());
 
   return {mean, (mean - (success_rate_stdev_factor * stdev))};
 }
@@ -398,8 +397,7 @@ void DetectorImpl::processSuccessRateEjections() {
       "outlier_detection.success_rate_minimum_hosts", config_.successRateMinimumHosts());
   uint64_t success_rate_request_volume = runtime_.snapshot().getInteger(
       "outlier_detection.success_rate_request_volume", config_.successRateRequestVolume());
-  std::vector<HostSuccessRatePair> valid_success_rate_hosts;
-  double success_rate_sum = 0;
+  SuccessRateStatistics statistics;
 
   // Reset the Detector's success rate mean and stdev.
   success_rate_average_ = -1;
@@ -410,9 +408,8 @@ void DetectorImpl::processSuccessRateEjections() {
     return;
   }
 
-  // reserve upper bound of vector size to avoid reallocation.
-  valid_success_rate_hosts.reserve(host_monitors_.size());
-
+  // The statistics are updated as the hosts are visited, so only the valid hosts are visited
+  // again to find the outliers.
   for (const auto& host : host_monitors_) {
     // Don't do work if the host is already ejected.
     if (!host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
@@ -420,25 +417,23 @@ void DetectorImpl::processSuccessRateEjections() {
           host.second->successRateAccumulator().getSuccessRate(success_rate_request_volume);
 
       if (host_success_rate) {
-        valid_success_rate_hosts.emplace_back(
-            HostSuccessRatePair(host.first, host_success_rate.value()));
-        success_rate_sum += host_success_rate.value();
+        valid_success_rate_hosts_.emplace_back(host.first, host_success_rate.value());
+        statistics.add(host_success_rate.value());
         host.second->successRate(host_success_rate.value());
       }
     }
   }
 
-  if (!valid_success_rate_hosts.empty() &&
-      valid_success_rate_hosts.size() >= success_rate_minimum_hosts) {
+  if (statistics.count() > 0 && statistics.count() >= success_rate_minimum_hosts) {
     double success_rate_stdev_factor =
         runtime_.snapshot().getInteger("outlier_detection.success_rate_stdev_factor",
                                        config_.successRateStdevFactor()) /
         1000.0;
-    Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(
-        success_rate_sum, valid_success_rate_hosts, success_rate_stdev_factor);
+    Utility::EjectionPair ejection_pair =
+        Utility::successRateEjectionThreshold(statistics, success_rate_stdev_factor);
     success_rate_average_ = ejection_pair.success_rate_average_;
     success_rate_ejection_threshold_ = ejection_pair.ejection_threshold_;
-    for (const auto& host_success_rate_pair : valid_success_rate_hosts) {
+    for (const auto& host_success_rate_pair : valid_success_rate_hosts_) {
       if (host_success_rate_pair.success_rate_ < success_rate_ejection_threshold_) {
         stats_.ejections_success_rate_.inc(); // Deprecated.
         stats_.ejections_detected_success_rate_.inc();
@@ -447,12 +442,15 @@ void DetectorImpl::processSuccessRateEjections() {
       }
     }
   }
+
+  // Keep the storage, but not the hosts.
+  valid_success_rate_hosts_.clear();
 }
 
 void DetectorImpl::onIntervalTimer() {
   MonotonicTime now = time_source_.monotonicTime();
 
-  for (auto host : host_monitors_) {
+  for (const auto& host : host_monitors_) {
     checkHostForUneject(host.first, host.second, now);
 
     // Need to update the writer bucket to keep the data valid.
@@ -530,10 +528,39 @@ void EventLoggerImpl::setCommonEventParams(
   TimestampUtil::systemClockToTimestamp(time_source_.systemTime(), *event.mutable_timestamp());
 }
 
+void SuccessRateAccumulatorBucket::reset() {
+  for (Shard& shard : shards_) {
+    shard.success_request_counter_ = 0;
+    shard.total_request_counter_ = 0;
+  }
+}
+
+uint64_t SuccessRateAccumulatorBucket::successRequests() const {
+  uint64_t success_requests = 0;
+  for (const Shard& shard : shards_) {
+    success_requests += shard.success_request_counter_.load(std::memory_order_relaxed);
+  }
+  return success_requests;
+}
+
+uint64_t SuccessRateAccumulatorBucket::totalRequests() const {
+  uint64_t total_requests = 0;
+  for (const Shard& shard : shards_) {
+    total_requests += shard.total_request_counter_.load(std::memory_order_relaxed);
+  }
+  return total_requests;
+}
+
+SuccessRateAccumulatorBucket::Shard& SuccessRateAccumulatorBucket::shard() {
+  // Threads are spread over the shards in the order they first count a request.
+  static std::atomic<uint32_t> next_shard{0};
+  static thread_local const uint32_t shard_index = next_shard++ % NumShards;
+  return shards_[shard_index];
+}
+
 SuccessRateAccumulatorBucket* SuccessRateAccumulator::updateCurrentWriter() {
   // Right now current is being written to and backup is not. Flush the backup and swap.
-  backup_success_rate_bucket_->success_request_counter_ = 0;
-  backup_success_rate_bucket_->total_request_counter_ = 0;
+  backup_success_rate_bucket_->reset();
 
   current_success_rate_bucket_.swap(backup_success_rate_bucket_);
 
@@ -542,12 +569,13 @@ SuccessRateAccumulatorBucket* SuccessRateAccumulator::updateCurrentWriter() {
 
 absl::optional<double>
 SuccessRateAccumulator::getSuccessRate(uint64_t success_rate_request_volume) {
-  if (backup_success_rate_bucket_->total_request_counter_ < success_rate_request_volume) {
+  const uint64_t total_requests = backup_success_rate_bucket_->totalRequests();
+  if (total_requests < success_rate_request_volume) {
     return absl::optional<double>();
   }
 
-  return absl::optional<double>(backup_success_rate_bucket_->success_request_counter_ * 100.0 /
-                                backup_success_rate_bucket_->total_request_counter_);
+  return absl::optional<double>(backup_success_rate_bucket_->successRequests() * 100.0 /
+                                total_requests);
 }
 
 } // namespace Outlier
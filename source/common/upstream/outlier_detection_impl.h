@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -62,9 +63,32 @@ struct HostSuccessRatePair {
   double success_rate_;
 };
 
-struct SuccessRateAccumulatorBucket {
-  std::atomic<uint64_t> success_request_counter_;
-  std::atomic<uint64_t> total_request_counter_;
+/**
+ * Request counters of a host for one success rate interval. Every thread counts into its own
+ * shard, so that the workers sending requests to a host do not contend on a single cache line.
+ * The shards are summed when the interval ends.
+ */
+class SuccessRateAccumulatorBucket {
+public:
+  void incSuccessRequests() { shard().success_request_counter_++; }
+  void incTotalRequests() { shard().total_request_counter_++; }
+  void reset();
+  uint64_t successRequests() const;
+  uint64_t totalRequests() const;
+
+private:
+  struct Shard {
+    std::atomic<uint64_t> success_request_counter_{};
+    std::atomic<uint64_t> total_request_counter_{};
+    // Keeps the counters of different shards on different cache lines.
+    char padding_[64 - 2 * sizeof(std::atomic<uint64_t>)];
+  };
+
+  static constexpr uint32_t NumShards = 4;
+
+  Shard& shard();
+
+  std::array<Shard, NumShards> shards_;
 };
 
 /**
@@ -99,6 +123,24 @@ private:
   std::unique_ptr<SuccessRateAccumulatorBucket> backup_success_rate_bucket_;
 };
 
+/**
+ * Streaming mean and variance of host success rates (Welford's algorithm). It takes a single pass
+ * over the hosts and stays accurate when the success rates are close to each other.
+ */
+class SuccessRateStatistics {
+public:
+  void add(double success_rate);
+  uint64_t count() const { return count_; }
+  double mean() const { return mean_; }
+  double variance() const { return count_ == 0 ? 0 : m2_ / count_; }
+
+private:
+  uint64_t count_{};
+  double mean_{};
+  // The sum of the squared differences to the mean.
+  double m2_{};
+};
+
 class DetectorImpl;
 
 /**
@@ -256,6 +298,8 @@ private:
   Event::TimerPtr interval_timer_;
   std::list<ChangeStateCb> callbacks_;
   std::unordered_map<HostSharedPtr, DetectorHostMonitorImpl*> host_monitors_;
+  // Reused by every interval so that its storage is only allocated once.
+  std::vector<HostSuccessRatePair> valid_success_rate_hosts_;
   EventLoggerSharedPtr event_logger_;
   double success_rate_average_;
   double success_rate_ejection_threshold_;
@@ -296,15 +340,13 @@ public:
    * This function returns an EjectionPair for success rate outlier detection. The pair contains
    * the average success rate of all valid hosts in the cluster and the ejection threshold.
    * If a host's success rate is under this threshold, the host is an outlier.
-   * @param success_rate_sum is the sum of the data in the success_rate_data vector.
-   * @param valid_success_rate_hosts is the vector containing the individual success rate data
-   *        points.
+   * @param statistics supplies the mean and variance of the success rates of the valid hosts.
+   * @param success_rate_stdev_factor supplies the number of standard deviations below the mean
+   *        the threshold is at.
    * @return EjectionPair.
    */
-  static EjectionPair
-  successRateEjectionThreshold(double success_rate_sum,
-                               const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-                               double success_rate_stdev_factor);
+  static EjectionPair successRateEjectionThreshold(const SuccessRateStatistics& statistics,
+                                                   double success_rate_stdev_factor);
 };
 
 } // namespace Outlier
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <memory>
@@ -11,6 +12,8 @@
 
 #include "common/common/assert.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -22,21 +25,29 @@ namespace Upstream {
  *    occur during high contention.
  * 2) Though atomics are used, it is possible for resources to temporarily go above the supplied
  *    maximums. This should not effect overall behavior.
+ * 3) The remaining retries of a retry budget are only updated when the retries change, although
+ *    the budget also changes with the active and pending requests.
  */
 class ResourceManagerImpl : public ResourceManager {
 public:
   ResourceManagerImpl(Runtime::Loader& runtime, const std::string& runtime_key,
                       uint64_t max_connections, uint64_t max_pending_requests,
                       uint64_t max_requests, uint64_t max_retries, uint64_t max_connection_pools,
-                      ClusterCircuitBreakersStats cb_stats)
-      : connections_(max_connections, runtime, runtime_key + "max_connections", cb_stats.cx_open_,
+                      uint64_t max_connections_per_host, ClusterCircuitBreakersStats cb_stats,
+                      absl::optional<double> retry_budget_percent,
+                      absl::optional<uint32_t> min_retry_concurrency)
+      : runtime_(runtime),
+        max_connections_per_host_runtime_key_(runtime_key + "max_connections_per_host"),
+        max_connections_per_host_(max_connections_per_host),
+        connections_(max_connections, runtime, runtime_key + "max_connections", cb_stats.cx_open_,
                      cb_stats.remaining_cx_),
         pending_requests_(max_pending_requests, runtime, runtime_key + "max_pending_requests",
                           cb_stats.rq_pending_open_, cb_stats.remaining_pending_),
         requests_(max_requests, runtime, runtime_key + "max_requests", cb_stats.rq_open_,
                   cb_stats.remaining_rq_),
-        retries_(max_retries, runtime, runtime_key + "max_retries", cb_stats.rq_retry_open_,
-                 cb_stats.remaining_retries_),
+        has_retry_budget_(retry_budget_percent.has_value()),
+        retries_(createRetries(retry_budget_percent, min_retry_concurrency, max_retries, runtime,
+                               runtime_key, cb_stats)),
         connection_pools_(max_connection_pools, runtime, runtime_key + "max_connection_pools",
                           cb_stats.cx_pool_open_, cb_stats.remaining_cx_pools_) {}
 
@@ -44,8 +55,13 @@ public:
   Resource& connections() override { return connections_; }
   Resource& pendingRequests() override { return pending_requests_; }
   Resource& requests() override { return requests_; }
-  Resource& retries() override { return retries_; }
+  Resource& retries() override { return *retries_; }
+  bool hasRetryBudget() override { return has_retry_budget_; }
   Resource& connectionPools() override { return connection_pools_; }
+  uint64_t maxConnectionsPerHost() override {
+    return runtime_.snapshot().getInteger(max_connections_per_host_runtime_key_,
+                                          max_connections_per_host_);
+  }
 
 private:
   struct ResourceImpl : public Resource {
@@ -72,6 +88,7 @@ private:
       open_gauge_.set(canCreate() ? 0 : 1);
     }
     uint64_t max() override { return runtime_.snapshot().getInteger(runtime_key_, max_); }
+    uint64_t count() const { return current_; }
 
     /**
      * We set the gauge instead of incrementing and decrementing because,
@@ -105,10 +122,56 @@ private:
     Stats::Gauge& remaining_;
   };
 
+  typedef std::unique_ptr<ResourceImpl> ResourceImplPtr;
+
+  /**
+   * Retries limited to a percentage of the active and pending requests. The minimum retry
+   * concurrency is the maximum of the underlying resource, so that it can be overridden by runtime.
+   */
+  struct RetryBudgetImpl : public ResourceImpl {
+    RetryBudgetImpl(double budget_percent, uint64_t min_retry_concurrency,
+                    Runtime::Loader& runtime, const std::string& runtime_key,
+                    Stats::Gauge& open_gauge, Stats::Gauge& remaining,
+                    const ResourceImpl& pending_requests, const ResourceImpl& requests)
+        : ResourceImpl(min_retry_concurrency, runtime, runtime_key, open_gauge, remaining),
+          budget_percent_(budget_percent), pending_requests_(pending_requests),
+          requests_(requests) {}
+
+    // Upstream::Resource
+    uint64_t max() override {
+      const uint64_t active = pending_requests_.count() + requests_.count();
+      return std::max(static_cast<uint64_t>(budget_percent_ / 100 * active), ResourceImpl::max());
+    }
+
+    const double budget_percent_;
+    const ResourceImpl& pending_requests_;
+    const ResourceImpl& requests_;
+  };
+
+  ResourceImplPtr createRetries(absl::optional<double> retry_budget_percent,
+                                absl::optional<uint32_t> min_retry_concurrency,
+                                uint64_t max_retries, Runtime::Loader& runtime,
+                                const std::string& runtime_key,
+                                ClusterCircuitBreakersStats& cb_stats) {
+    if (!retry_budget_percent.has_value()) {
+      return std::make_unique<ResourceImpl>(max_retries, runtime, runtime_key + "max_retries",
+                                            cb_stats.rq_retry_open_, cb_stats.remaining_retries_);
+    }
+    ASSERT(min_retry_concurrency.has_value());
+    return std::make_unique<RetryBudgetImpl>(
+        retry_budget_percent.value(), min_retry_concurrency.value(), runtime,
+        runtime_key + "retry_budget.min_retry_concurrency", cb_stats.rq_retry_open_,
+        cb_stats.remaining_retries_, pending_requests_, requests_);
+  }
+
+  Runtime::Loader& runtime_;
+  const std::string max_connections_per_host_runtime_key_;
+  const uint64_t max_connections_per_host_;
   ResourceImpl connections_;
   ResourceImpl pending_requests_;
   ResourceImpl requests_;
-  ResourceImpl retries_;
+  const bool has_retry_budget_;
+  const ResourceImplPtr retries_;
   ResourceImpl connection_pools_;
 };
 
@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 
+#include "envoy/stats/timespan.h"
+
 #include "common/common/assert.h"
 #include "common/upstream/load_balancer_impl.h"
 
@@ -15,11 +17,12 @@ namespace Upstream {
 
 RingHashLoadBalancer::RingHashLoadBalancer(
     const PrioritySet& priority_set, ClusterStats& stats, Stats::Scope& scope,
-    Runtime::Loader& runtime, Runtime::RandomGenerator& random,
+    Runtime::Loader& runtime, Runtime::RandomGenerator& random, TimeSource& time_source,
     const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& config,
     const envoy::api::v2::Cluster::CommonLbConfig& common_config)
     : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random, common_config),
       scope_(scope.createScope("ring_hash_lb.")), stats_(generateStats(*scope_)),
+      time_source_(time_source),
       min_ring_size_(config ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.value(), minimum_ring_size,
                                                               DefaultMinRingSize)
                             : DefaultMinRingSize),
@@ -36,45 +39,55 @@ RingHashLoadBalancer::RingHashLoadBalancer(
   }
 }
 
+ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr
+RingHashLoadBalancer::createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
+                                         double min_normalized_weight,
+                                         double /* max_normalized_weight */) {
+  Stats::TimespanWithUnit<std::chrono::microseconds> build_timer(stats_.ring_build_time_us_,
+                                                                 time_source_);
+  auto ring = std::make_shared<Ring>(normalized_host_weights, min_normalized_weight,
+                                     min_ring_size_, max_ring_size_, hash_function_, stats_);
+  build_timer.complete();
+  return ring;
+}
+
 RingHashLoadBalancerStats RingHashLoadBalancer::generateStats(Stats::Scope& scope) {
-  return {ALL_RING_HASH_LOAD_BALANCER_STATS(POOL_GAUGE(scope))};
+  return {ALL_RING_HASH_LOAD_BALANCER_STATS(POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
 
 HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h) const {
-  if (ring_.empty()) {
+  const uint64_t size = hashes_.size() - 1;
+  if (size == 0) {
     return nullptr;
   }
 
-  // Ported from https://github.com/RJ/ketama/blob/master/libketama/ketama.c (ketama_get_server)
-  // I've generally kept the variable names to make the code easier to compare.
-  // NOTE: The algorithm depends on using signed integers for lowp, midp, and highp. Do not
-  //       change them!
-  int64_t lowp = 0;
-  int64_t highp = ring_.size();
-  while (true) {
-    int64_t midp = (lowp + highp) / 2;
-
-    if (midp == static_cast<int64_t>(ring_.size())) {
-      return ring_[0].host_;
-    }
-
-    uint64_t midval = ring_[midp].hash_;
-    uint64_t midval1 = midp == 0 ? 0 : ring_[midp - 1].hash_;
-
-    if (h <= midval && h > midval1) {
-      return ring_[midp].host_;
-    }
-
-    if (midval < h) {
-      lowp = midp + 1;
-    } else {
-      highp = midp - 1;
-    }
+  // Like ketama, pick the first entry whose hash is >= h, wrapping around to the first entry.
+  // Descend the implicit tree, going right whenever the slot's hash is < h. The slot we want is
+  // the last one where we went left: strip the trailing right turns (one bits), and the left turn
+  // (zero bit) preceding them. A result of 0 means every hash is < h.
+  uint64_t k = 1;
+  while (k <= size) {
+    k = 2 * k + (hashes_[k] < h);
+  }
+  k >>= __builtin_ffsll(~k);
+  return hosts_[host_indices_[k == 0 ? first_slot_ : k]];
+}
 
-    if (lowp > highp) {
-      return ring_[0].host_;
-    }
+void RingHashLoadBalancer::Ring::layout(const std::vector<RingEntry>& sorted_entries,
+                                        uint64_t& sorted_index, uint64_t k) {
+  // An in-order walk of the implicit tree visits the slots in sorted order. The depth is only
+  // log2 of the ring size.
+  if (k > sorted_entries.size()) {
+    return;
+  }
+  layout(sorted_entries, sorted_index, 2 * k);
+  if (sorted_index == 0) {
+    first_slot_ = k;
   }
+  hashes_[k] = sorted_entries[sorted_index].hash_;
+  host_indices_[k] = sorted_entries[sorted_index].host_index_;
+  ++sorted_index;
+  layout(sorted_entries, sorted_index, 2 * k + 1);
 }
 
 using HashFunction = envoy::api::v2::Cluster_RingHashLbConfig_HashFunction;
@@ -82,7 +95,7 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
                                  double min_normalized_weight, uint64_t min_ring_size,
                                  uint64_t max_ring_size, HashFunction hash_function,
                                  RingHashLoadBalancerStats& stats)
-    : stats_(stats) {
+    : hashes_(1), host_indices_(1), stats_(stats) {
   ENVOY_LOG(trace, "ring hash: building ring");
 
   // We can't do anything sensible with no hosts.
@@ -101,7 +114,9 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
 
   // Reserve memory for the entire ring up front.
   const uint64_t ring_size = std::ceil(scale);
-  ring_.reserve(ring_size);
+  std::vector<RingEntry> ring;
+  ring.reserve(ring_size);
+  hosts_.reserve(normalized_host_weights.size());
 
   // Populate the hash ring by walking through the (host, weight) pairs in normalized_host_weights,
   // and generating (scale * weight) hashes for each host. Since these aren't necessarily whole
@@ -127,6 +142,8 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   uint64_t max_hashes_per_host = 0;
   for (const auto& entry : normalized_host_weights) {
     const auto& host = entry.first;
+    const uint32_t host_index = hosts_.size();
+    hosts_.push_back(host);
     const std::string& address_string = host->address()->asString();
     uint64_t offset_start = address_string.size();
 
@@ -158,7 +175,7 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
               : HashUtil::xxHash64(hash_key);
 
       ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key.data(), hash);
-      ring_.push_back({hash, host});
+      ring.push_back({hash, host_index});
       ++i;
       ++current_hashes;
     }
@@ -166,16 +183,22 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
     max_hashes_per_host = std::max(i, max_hashes_per_host);
   }
 
-  std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
-    return lhs.hash_ < rhs.hash_;
+  // Break ties on the host index so that the ring does not depend on the sort implementation.
+  std::sort(ring.begin(), ring.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
+    return lhs.hash_ < rhs.hash_ || (lhs.hash_ == rhs.hash_ && lhs.host_index_ < rhs.host_index_);
   });
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
-    for (const auto& entry : ring_) {
-      ENVOY_LOG(trace, "ring hash: host={} hash={}", entry.host_->address()->asString(),
-                entry.hash_);
+    for (const auto& entry : ring) {
+      ENVOY_LOG(trace, "ring hash: host={} hash={}",
+                hosts_[entry.host_index_]->address()->asString(), entry.hash_);
     }
   }
 
+  hashes_.resize(ring.size() + 1);
+  host_indices_.resize(ring.size() + 1);
+  uint64_t sorted_index = 0;
+  layout(ring, sorted_index, 1);
+
   stats_.size_.set(ring_size);
   stats_.min_hashes_per_host_.set(min_hashes_per_host);
   stats_.max_hashes_per_host_.set(max_hashes_per_host);
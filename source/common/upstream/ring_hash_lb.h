@@ -2,6 +2,7 @@
 
 #include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
@@ -16,17 +17,18 @@ namespace Upstream {
  * All ring hash load balancer stats. @see stats_macros.h
  */
 // clang-format off
-#define ALL_RING_HASH_LOAD_BALANCER_STATS(GAUGE)                                                   \
+#define ALL_RING_HASH_LOAD_BALANCER_STATS(GAUGE, HISTOGRAM)                                        \
   GAUGE(size)                                                                                      \
   GAUGE(min_hashes_per_host)                                                                       \
-  GAUGE(max_hashes_per_host)
+  GAUGE(max_hashes_per_host)                                                                       \
+  HISTOGRAM(ring_build_time_us)
 // clang-format on
 
 /**
  * Struct definition for all ring hash load balancer stats. @see stats_macros.h
  */
 struct RingHashLoadBalancerStats {
-  ALL_RING_HASH_LOAD_BALANCER_STATS(GENERATE_GAUGE_STRUCT)
+  ALL_RING_HASH_LOAD_BALANCER_STATS(GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -43,6 +45,7 @@ class RingHashLoadBalancer : public ThreadAwareLoadBalancerBase,
 public:
   RingHashLoadBalancer(const PrioritySet& priority_set, ClusterStats& stats, Stats::Scope& scope,
                        Runtime::Loader& runtime, Runtime::RandomGenerator& random,
+                       TimeSource& time_source,
                        const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& config,
                        const envoy::api::v2::Cluster::CommonLbConfig& common_config);
 
@@ -53,9 +56,15 @@ private:
 
   struct RingEntry {
     uint64_t hash_;
-    HostConstSharedPtr host_;
+    uint32_t host_index_;
   };
 
+  /**
+   * The ring is stored as the sorted entry hashes in Eytzinger (breadth first) order, with the
+   * index into hosts_ of each entry in a parallel array. An entry costs 12 bytes rather than the
+   * 24 bytes of a hash and a host pointer, and a lookup walks the implicit search tree without
+   * data dependent branches. Both arrays are 1-indexed; slot 0 is unused.
+   */
   struct Ring : public HashingLoadBalancer {
     Ring(const NormalizedHostWeightVector& normalized_host_weights, double min_normalized_weight,
          uint64_t min_ring_size, uint64_t max_ring_size, HashFunction hash_function,
@@ -64,7 +73,14 @@ private:
     // ThreadAwareLoadBalancerBase::HashingLoadBalancer
     HostConstSharedPtr chooseHost(uint64_t hash) const override;
 
-    std::vector<RingEntry> ring_;
+    // Fills eytzinger slot k and its subtree from sorted_entries, starting at sorted_index.
+    void layout(const std::vector<RingEntry>& sorted_entries, uint64_t& sorted_index, uint64_t k);
+
+    std::vector<HostConstSharedPtr> hosts_;
+    std::vector<uint64_t> hashes_;
+    std::vector<uint32_t> host_indices_;
+    // Slot holding the smallest hash, which a hash beyond the last entry wraps around to.
+    uint64_t first_slot_{};
 
     RingHashLoadBalancerStats& stats_;
   };
@@ -73,15 +89,13 @@ private:
   // ThreadAwareLoadBalancerBase
   HashingLoadBalancerSharedPtr
   createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double min_normalized_weight, double /* max_normalized_weight */) override {
-    return std::make_shared<Ring>(normalized_host_weights, min_normalized_weight, min_ring_size_,
-                                  max_ring_size_, hash_function_, stats_);
-  }
+                     double min_normalized_weight, double max_normalized_weight) override;
 
   static RingHashLoadBalancerStats generateStats(Stats::Scope& scope);
 
   Stats::ScopePtr scope_;
   RingHashLoadBalancerStats stats_;
+  TimeSource& time_source_;
 
   static const uint64_t DefaultMinRingSize = 1024;
   static const uint64_t DefaultMaxRingSize = 1024 * 1024 * 8;
@@ -1,5 +1,6 @@
 #include "common/upstream/subset_lb.h"
 
+#include <algorithm>
 #include <memory>
 #include <unordered_set>
 
@@ -7,6 +8,8 @@
 #include "envoy/runtime/runtime.h"
 
 #include "common/common/assert.h"
+#include "common/common/hash.h"
+#include "common/common/lock_guard.h"
 #include "common/config/metadata.h"
 #include "common/config/well_known_names.h"
 #include "common/protobuf/utility.h"
@@ -17,26 +20,93 @@
 namespace Envoy {
 namespace Upstream {
 
+namespace {
+
+// Extends the hashed key of subset metadata with a key and value, so that the key of the metadata
+// of a subset and that of the match criteria that select it are equal.
+uint64_t subsetKey(uint64_t key, absl::string_view name, uint64_t value_hash) {
+  key = HashUtil::xxHash64(name, key);
+  return HashUtil::xxHash64(
+      absl::string_view(reinterpret_cast<const char*>(&value_hash), sizeof(value_hash)), key);
+}
+
+uint64_t subsetKey(const SubsetHostsCache::SubsetMetadata& metadata) {
+  uint64_t key = 0;
+  for (const auto& kv : metadata) {
+    key = subsetKey(key, kv.first, ValueUtil::hash(kv.second));
+  }
+  return key;
+}
+
+bool metadataEqual(const SubsetHostsCache::SubsetMetadata& lhs,
+                   const SubsetHostsCache::SubsetMetadata& rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (lhs[i].first != rhs[i].first || !ValueUtil::equal(lhs[i].second, rhs[i].second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+SubsetHostsCache::Hosts SubsetHostsCache::getOrCompute(
+    uint64_t key, const absl::optional<SubsetMetadata>& metadata, const HostSet& original_host_set,
+    const std::function<Hosts()>& compute) {
+  const HostVectorConstSharedPtr original_hosts = original_host_set.hostsPtr();
+  const HostsPerLocalityConstSharedPtr original_hosts_per_locality =
+      original_host_set.hostsPerLocalityPtr();
+
+  // The hosts are computed while holding the lock, so that the other workers that update the
+  // subset at the same time wait for them instead of computing them as well.
+  Thread::LockGuard lock(mutex_);
+  std::vector<Entry>& entries = entries_[key];
+  auto entry = std::find_if(entries.begin(), entries.end(), [&](const Entry& candidate) {
+    return candidate.priority_ == original_host_set.priority() &&
+           candidate.metadata_.has_value() == metadata.has_value() &&
+           (!metadata.has_value() || metadataEqual(candidate.metadata_.value(), metadata.value()));
+  });
+  if (entry == entries.end()) {
+    entry = entries.insert(entries.end(),
+                           Entry{original_host_set.priority(), metadata, {}, {}, {}});
+  } else if (entry->original_hosts_.lock() == original_hosts &&
+             entry->original_hosts_per_locality_.lock() == original_hosts_per_locality) {
+    return entry->hosts_;
+  }
+
+  entry->original_hosts_ = original_hosts;
+  entry->original_hosts_per_locality_ = original_hosts_per_locality;
+  entry->hosts_ = compute();
+  return entry->hosts_;
+}
+
 SubsetLoadBalancer::SubsetLoadBalancer(
     LoadBalancerType lb_type, PrioritySet& priority_set, const PrioritySet* local_priority_set,
     ClusterStats& stats, Stats::Scope& scope, Runtime::Loader& runtime,
-    Runtime::RandomGenerator& random, const LoadBalancerSubsetInfo& subsets,
+    Runtime::RandomGenerator& random, TimeSource& time_source,
+    const LoadBalancerSubsetInfo& subsets,
     const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& lb_ring_hash_config,
     const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>& least_request_config,
-    const envoy::api::v2::Cluster::CommonLbConfig& common_config)
+    const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+    const SubsetHostsCacheSharedPtr& hosts_cache)
     : lb_type_(lb_type), lb_ring_hash_config_(lb_ring_hash_config),
       least_request_config_(least_request_config), common_config_(common_config), stats_(stats),
-      scope_(scope), runtime_(runtime), random_(random), fallback_policy_(subsets.fallbackPolicy()),
+      scope_(scope), runtime_(runtime), random_(random), time_source_(time_source),
+      fallback_policy_(subsets.fallbackPolicy()),
       default_subset_metadata_(subsets.defaultSubset().fields().begin(),
                                subsets.defaultSubset().fields().end()),
       subset_keys_(subsets.subsetKeys()), original_priority_set_(priority_set),
-      original_local_priority_set_(local_priority_set),
+      original_local_priority_set_(local_priority_set), hosts_cache_(hosts_cache),
       locality_weight_aware_(subsets.localityWeightAware()),
       scale_locality_weight_(subsets.scaleLocalityWeight()) {
   ASSERT(subsets.isEnabled());
 
   if (fallback_policy_ != envoy::api::v2::Cluster::LbSubsetConfig::NO_FALLBACK) {
     HostPredicate predicate;
+    absl::optional<SubsetMetadata> metadata;
     if (fallback_policy_ == envoy::api::v2::Cluster::LbSubsetConfig::ANY_ENDPOINT) {
       predicate = [](const Host&) -> bool { return true; };
 
@@ -45,6 +115,7 @@ SubsetLoadBalancer::SubsetLoadBalancer(
       predicate = [this](const Host& host) -> bool {
         return hostMatches(default_subset_metadata_, host);
       };
+      metadata = default_subset_metadata_;
 
       ENVOY_LOG(debug, "subset lb: creating fallback load balancer for {}",
                 describeMetadata(default_subset_metadata_));
@@ -52,7 +123,8 @@ SubsetLoadBalancer::SubsetLoadBalancer(
 
     fallback_subset_ = std::make_unique<LbSubsetEntry>();
     fallback_subset_->priority_subset_ = std::make_unique<PrioritySubsetImpl>(
-        *this, predicate, locality_weight_aware_, scale_locality_weight_);
+        *this, predicate, locality_weight_aware_, scale_locality_weight_,
+        subsetKey(default_subset_metadata_), std::move(metadata));
   }
 
   if (subsets.panicModeAny()) {
@@ -60,7 +132,7 @@ SubsetLoadBalancer::SubsetLoadBalancer(
 
     panic_mode_subset_ = std::make_unique<LbSubsetEntry>();
     panic_mode_subset_->priority_subset_ = std::make_unique<PrioritySubsetImpl>(
-        *this, predicate, locality_weight_aware_, scale_locality_weight_);
+        *this, predicate, locality_weight_aware_, scale_locality_weight_, 0, absl::nullopt);
   }
 
   // Create filtered default subset (if necessary) and other subsets based on current hosts.
@@ -165,45 +237,49 @@ HostConstSharedPtr SubsetLoadBalancer::tryChooseHostFromContext(LoadBalancerCont
   return entry->priority_subset_->lb_->chooseHost(context);
 }
 
-// Iterates over the given metadata match criteria (which must be lexically sorted by key) and find
-// a matching LbSubsetEntryPtr, if any.
+// Finds the LbSubsetEntryPtr of the given metadata match criteria (which must be lexically sorted
+// by key), if any.
 SubsetLoadBalancer::LbSubsetEntryPtr SubsetLoadBalancer::findSubset(
     const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria) {
-  const LbSubsetMap* subsets = &subsets_;
+  if (match_criteria.empty()) {
+    return nullptr;
+  }
 
   // Because the match_criteria and the host metadata used to populate subsets_ are sorted in the
-  // same order, we can iterate over the criteria and perform a lookup for each key and value,
-  // starting with the root LbSubsetMap and using the previous iteration's LbSubsetMap thereafter
-  // (tracked in subsets). If ever a criterion's key or value is not found, there is no subset for
-  // this criteria. If we reach the last criterion, we've found the LbSubsetEntry for the criteria,
-  // which may or may not have a subset attached to it.
-  for (uint32_t i = 0; i < match_criteria.size(); i++) {
-    const Router::MetadataMatchCriterion& match_criterion = *match_criteria[i];
-    const auto& subset_it = subsets->find(match_criterion.name());
-    if (subset_it == subsets->end()) {
-      // No subsets with this key (at this level in the hierarchy).
-      break;
-    }
-
-    const ValueSubsetMap& vs_map = subset_it->second;
-    const auto& vs_it = vs_map.find(match_criterion.value());
-    if (vs_it == vs_map.end()) {
-      // No subsets with this value.
-      break;
-    }
-
-    const LbSubsetEntryPtr& entry = vs_it->second;
-    if (i + 1 == match_criteria.size()) {
-      // We've reached the end of the criteria, and they all matched.
+  // same order, the key of the criteria is that of the metadata of the entry they select, if any.
+  // An entry with another metadata may have the same key, so the entries are compared with the
+  // criteria.
+  uint64_t key = 0;
+  for (const auto& match_criterion : match_criteria) {
+    key = subsetKey(key, match_criterion->name(), match_criterion->value().hash());
+  }
+  const auto entries = subset_index_.find(key);
+  if (entries == subset_index_.end()) {
+    return nullptr;
+  }
+  for (const LbSubsetEntryPtr& entry : entries->second) {
+    if (entry->matches(match_criteria)) {
       return entry;
     }
-
-    subsets = &entry->children_;
   }
 
   return nullptr;
 }
 
+bool SubsetLoadBalancer::LbSubsetEntry::matches(
+    const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& criteria) const {
+  if (criteria.size() != metadata_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < criteria.size(); i++) {
+    if (criteria[i]->name() != metadata_[i].first ||
+        !ValueUtil::equal(criteria[i]->value().value(), metadata_[i].second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void SubsetLoadBalancer::updateFallbackSubset(uint32_t priority, const HostVector& hosts_added,
                                               const HostVector& hosts_removed) {
   if (fallback_subset_ == nullptr) {
@@ -243,7 +319,7 @@ void SubsetLoadBalancer::processSubsets(
         SubsetMetadata kvs = extractSubsetMetadata(keys, *host);
         if (!kvs.empty()) {
           // The host has metadata for each key, find or create its subset.
-          LbSubsetEntryPtr entry = findOrCreateSubset(subsets_, kvs, 0);
+          LbSubsetEntryPtr entry = findOrCreateSubset(subsets_, kvs, 0, 0);
           if (subsets_modified.find(entry) != subsets_modified.end()) {
             // We've already invoked the callback for this entry.
             continue;
@@ -296,7 +372,6 @@ void SubsetLoadBalancer::update(uint32_t priority, const HostVector& hosts_added
                  },
                  [&](LbSubsetEntryPtr entry, HostPredicate predicate, const SubsetMetadata& kvs,
                      bool adding_host) {
-                   UNREFERENCED_PARAMETER(kvs);
                    if (adding_host) {
                      ENVOY_LOG(debug, "subset lb: creating load balancer for {}",
                                describeMetadata(kvs));
@@ -305,7 +380,8 @@ void SubsetLoadBalancer::update(uint32_t priority, const HostVector& hosts_added
                      // with only removed hosts is a degenerate case and we leave the entry
                      // uninitialized.)
                      entry->priority_subset_.reset(new PrioritySubsetImpl(
-                         *this, predicate, locality_weight_aware_, scale_locality_weight_));
+                         *this, predicate, locality_weight_aware_, scale_locality_weight_,
+                         entry->key_, kvs));
                      stats_.lb_subsets_active_.inc();
                      stats_.lb_subsets_created_.inc();
                    }
@@ -391,12 +467,13 @@ std::string SubsetLoadBalancer::describeMetadata(const SubsetLoadBalancer::Subse
 // LbSubsetEntryPtr.
 SubsetLoadBalancer::LbSubsetEntryPtr
 SubsetLoadBalancer::findOrCreateSubset(LbSubsetMap& subsets, const SubsetMetadata& kvs,
-                                       uint32_t idx) {
+                                       uint32_t idx, uint64_t key) {
   ASSERT(idx < kvs.size());
 
   const std::string& name = kvs[idx].first;
   const ProtobufWkt::Value& pb_value = kvs[idx].second;
   const HashedValue value(pb_value);
+  key = subsetKey(key, name, value.hash());
   LbSubsetEntryPtr entry;
 
   const auto& kv_it = subsets.find(name);
@@ -410,7 +487,9 @@ SubsetLoadBalancer::findOrCreateSubset(LbSubsetMap& subsets, const SubsetMetadat
 
   if (!entry) {
     // Not found. Create an uninitialized entry.
-    entry.reset(new LbSubsetEntry());
+    entry =
+        std::make_shared<LbSubsetEntry>(key, SubsetMetadata(kvs.begin(), kvs.begin() + idx + 1));
+    subset_index_[key].push_back(entry);
     if (kv_it != subsets.end()) {
       ValueSubsetMap& value_subset_map = kv_it->second;
       value_subset_map.emplace(value, entry);
@@ -426,7 +505,7 @@ SubsetLoadBalancer::findOrCreateSubset(LbSubsetMap& subsets, const SubsetMetadat
     return entry;
   }
 
-  return findOrCreateSubset(entry->children_, kvs, idx);
+  return findOrCreateSubset(entry->children_, kvs, idx, key);
 }
 
 // Invokes cb for each LbSubsetEntryPtr in subsets.
@@ -443,13 +522,13 @@ void SubsetLoadBalancer::forEachSubset(LbSubsetMap& subsets,
 
 // Initialize a new HostSubsetImpl and LoadBalancer from the SubsetLoadBalancer, filtering hosts
 // with the given predicate.
-SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(const SubsetLoadBalancer& subset_lb,
-                                                           HostPredicate predicate,
-                                                           bool locality_weight_aware,
-                                                           bool scale_locality_weight)
+SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(
+    const SubsetLoadBalancer& subset_lb, HostPredicate predicate, bool locality_weight_aware,
+    bool scale_locality_weight, uint64_t key, absl::optional<SubsetMetadata> metadata)
     : PrioritySetImpl(), original_priority_set_(subset_lb.original_priority_set_),
       predicate_(predicate), locality_weight_aware_(locality_weight_aware),
-      scale_locality_weight_(scale_locality_weight) {
+      scale_locality_weight_(scale_locality_weight), hosts_cache_(subset_lb.hosts_cache_.get()),
+      key_(key), metadata_(std::move(metadata)) {
 
   for (size_t i = 0; i < original_priority_set_.hostSetsPerPriority().size(); ++i) {
     empty_ &= getOrCreateHostSet(i).hosts().empty();
@@ -484,7 +563,7 @@ SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(const SubsetLoadBalan
     // can also use a thread aware sub-LB properly. The following works fine but is not optimal.
     thread_aware_lb_ = std::make_unique<RingHashLoadBalancer>(
         *this, subset_lb.stats_, subset_lb.scope_, subset_lb.runtime_, subset_lb.random_,
-        subset_lb.lb_ring_hash_config_, subset_lb.common_config_);
+        subset_lb.time_source_, subset_lb.lb_ring_hash_config_, subset_lb.common_config_);
     thread_aware_lb_->initialize();
     lb_ = thread_aware_lb_->factory()->create();
     break;
@@ -495,12 +574,13 @@ SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(const SubsetLoadBalan
     // can also use a thread aware sub-LB properly. The following works fine but is not optimal.
     thread_aware_lb_ = std::make_unique<MaglevLoadBalancer>(
         *this, subset_lb.stats_, subset_lb.scope_, subset_lb.runtime_, subset_lb.random_,
-        subset_lb.common_config_);
+        subset_lb.time_source_, subset_lb.common_config_);
     thread_aware_lb_->initialize();
     lb_ = thread_aware_lb_->factory()->create();
     break;
 
   case LoadBalancerType::OriginalDst:
+  case LoadBalancerType::ClusterProvided:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
 
@@ -530,45 +610,50 @@ void SubsetLoadBalancer::HostSubsetImpl::update(const HostVector& hosts_added,
     }
   }
 
-  HostVectorSharedPtr hosts(new HostVector());
-  HostVectorSharedPtr healthy_hosts(new HostVector());
-  HostVectorSharedPtr degraded_hosts(new HostVector());
-
-  // It's possible that hosts_added == original_host_set_.hosts(), e.g.: when
-  // calling refreshSubsets() if only metadata change. If so, we can avoid the
-  // predicate() call.
-  for (const auto host : original_host_set_.hosts()) {
-    bool host_seen = predicate_added.count(host) == 1;
-    if (host_seen || predicate(*host)) {
-      hosts->emplace_back(host);
-      switch (host->health()) {
-      case Host::Health::Healthy:
-        healthy_hosts->emplace_back(host);
-        break;
-      case Host::Health::Degraded:
-        degraded_hosts->emplace_back(host);
-        break;
-      case Host::Health::Unhealthy:
-        break;
+  const auto compute = [&]() -> SubsetHostsCache::Hosts {
+    HostVectorSharedPtr hosts(new HostVector());
+    // It's possible that hosts_added == original_host_set_.hosts(), e.g.: when
+    // calling refreshSubsets() if only metadata change. If so, we can avoid the
+    // predicate() call.
+    for (const auto host : original_host_set_.hosts()) {
+      if (predicate_added.count(host) == 1 || predicate(*host)) {
+        hosts->emplace_back(host);
       }
     }
-  }
 
-  // Calling predicate() is expensive since it involves metadata lookups; so we
-  // avoid it in the 2nd call to filter() by using the result from the first call
-  // to filter() as the starting point.
-  //
-  // Also, if we only have one locality we can avoid the first call to filter() by
-  // just creating a new HostsPerLocality from the list of all hosts.
-  //
-  // TODO(rgs1): merge these two filter() calls in one loop.
-  HostsPerLocalityConstSharedPtr hosts_per_locality;
+    // Calling predicate() is expensive since it involves metadata lookups. If we only have one
+    // locality we can avoid it by just creating a new HostsPerLocality from the list of all hosts.
+    HostsPerLocalityConstSharedPtr hosts_per_locality;
+    if (original_host_set_.hostsPerLocality().get().size() == 1) {
+      hosts_per_locality.reset(new HostsPerLocalityImpl(
+          *hosts, original_host_set_.hostsPerLocality().hasLocalLocality()));
+    } else {
+      hosts_per_locality = original_host_set_.hostsPerLocality().filter(predicate);
+    }
+    return {hosts, hosts_per_locality};
+  };
+  // The hosts of the subset are shared with the other workers, while each one partitions them by
+  // the current health of the hosts.
+  const SubsetHostsCache::Hosts subset_hosts =
+      hosts_cache_ != nullptr
+          ? hosts_cache_->getOrCompute(key_, metadata_, original_host_set_, compute)
+          : compute();
+  const HostVectorConstSharedPtr& hosts = subset_hosts.hosts_;
+  const HostsPerLocalityConstSharedPtr& hosts_per_locality = subset_hosts.hosts_per_locality_;
 
-  if (original_host_set_.hostsPerLocality().get().size() == 1) {
-    hosts_per_locality.reset(
-        new HostsPerLocalityImpl(*hosts, original_host_set_.hostsPerLocality().hasLocalLocality()));
-  } else {
-    hosts_per_locality = original_host_set_.hostsPerLocality().filter(predicate);
+  HostVectorSharedPtr healthy_hosts(new HostVector());
+  HostVectorSharedPtr degraded_hosts(new HostVector());
+  for (const auto& host : *hosts) {
+    switch (host->health()) {
+    case Host::Health::Healthy:
+      healthy_hosts->emplace_back(host);
+      break;
+    case Host::Health::Degraded:
+      degraded_hosts->emplace_back(host);
+      break;
+    case Host::Health::Unhealthy:
+      break;
+    }
   }
 
   HostsPerLocalityConstSharedPtr healthy_hosts_per_locality = hosts_per_locality->filter(
@@ -627,8 +712,8 @@ HostSetImplPtr SubsetLoadBalancer::PrioritySubsetImpl::createHostSet(
 
   ASSERT(!overprovisioning_factor.has_value() ||
          overprovisioning_factor.value() == host_set->overprovisioningFactor());
-  return HostSetImplPtr{
-      new HostSubsetImpl(*host_set, locality_weight_aware_, scale_locality_weight_)};
+  return HostSetImplPtr{new HostSubsetImpl(*host_set, locality_weight_aware_,
+                                            scale_locality_weight_, hosts_cache_, key_, metadata_)};
 }
 
 void SubsetLoadBalancer::PrioritySubsetImpl::update(uint32_t priority,
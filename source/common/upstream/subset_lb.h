@@ -6,29 +6,79 @@
 #include <string>
 #include <unordered_map>
 
+#include "envoy/common/time.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
 #include "envoy/upstream/load_balancer.h"
 
 #include "common/common/macros.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
 #include "common/upstream/upstream_impl.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Upstream {
 
+/**
+ * The hosts of the subsets of a cluster, shared by the subset load balancers of all workers.
+ * Workers share the main thread's immutable host vectors, so the first load balancer that updates
+ * a subset of a priority from given host vectors computes its hosts for the others, which only
+ * partition them by health.
+ */
+class SubsetHostsCache {
+public:
+  typedef std::vector<std::pair<std::string, ProtobufWkt::Value>> SubsetMetadata;
+
+  struct Hosts {
+    HostVectorConstSharedPtr hosts_;
+    HostsPerLocalityConstSharedPtr hosts_per_locality_;
+  };
+
+  /**
+   * @param key supplies the hashed key of the subset.
+   * @param metadata supplies the metadata of the subset, or nullopt for the subset of all hosts.
+   * @param original_host_set supplies the host set that the subset is part of.
+   * @param compute supplies the function that computes the hosts of the subset.
+   * @return Hosts the hosts of the subset, computed by compute unless they were already computed
+   *         from the current host vectors of original_host_set.
+   */
+  Hosts getOrCompute(uint64_t key, const absl::optional<SubsetMetadata>& metadata,
+                     const HostSet& original_host_set, const std::function<Hosts()>& compute);
+
+private:
+  struct Entry {
+    uint32_t priority_;
+    absl::optional<SubsetMetadata> metadata_;
+    // The vectors the hosts were computed from. Expired once the host set is updated, and never
+    // equal to a vector that is allocated later.
+    std::weak_ptr<const HostVector> original_hosts_;
+    std::weak_ptr<const HostsPerLocality> original_hosts_per_locality_;
+    Hosts hosts_;
+  };
+
+  Thread::MutexBasicLockable mutex_;
+  // Keyed by the key of the subset, with an entry per subset and priority.
+  absl::flat_hash_map<uint64_t, std::vector<Entry>> entries_ GUARDED_BY(mutex_);
+};
+
+typedef std::shared_ptr<SubsetHostsCache> SubsetHostsCacheSharedPtr;
+
 class SubsetLoadBalancer : public LoadBalancer, Logger::Loggable<Logger::Id::upstream> {
 public:
   SubsetLoadBalancer(
       LoadBalancerType lb_type, PrioritySet& priority_set, const PrioritySet* local_priority_set,
       ClusterStats& stats, Stats::Scope& scope, Runtime::Loader& runtime,
-      Runtime::RandomGenerator& random, const LoadBalancerSubsetInfo& subsets,
+      Runtime::RandomGenerator& random, TimeSource& time_source,
+      const LoadBalancerSubsetInfo& subsets,
       const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& lb_ring_hash_config,
       const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>& least_request_config,
-      const envoy::api::v2::Cluster::CommonLbConfig& common_config);
+      const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+      const SubsetHostsCacheSharedPtr& hosts_cache = nullptr);
   ~SubsetLoadBalancer();
 
   // Upstream::LoadBalancer
@@ -36,15 +86,18 @@ public:
 
 private:
   typedef std::function<bool(const Host&)> HostPredicate;
+  typedef SubsetHostsCache::SubsetMetadata SubsetMetadata;
 
   // Represents a subset of an original HostSet.
   class HostSubsetImpl : public HostSetImpl {
   public:
     HostSubsetImpl(const HostSet& original_host_set, bool locality_weight_aware,
-                   bool scale_locality_weight)
+                   bool scale_locality_weight, SubsetHostsCache* hosts_cache, uint64_t key,
+                   const absl::optional<SubsetMetadata>& metadata)
         : HostSetImpl(original_host_set.priority(), original_host_set.overprovisioningFactor()),
           original_host_set_(original_host_set), locality_weight_aware_(locality_weight_aware),
-          scale_locality_weight_(scale_locality_weight) {}
+          scale_locality_weight_(scale_locality_weight), hosts_cache_(hosts_cache), key_(key),
+          metadata_(metadata) {}
 
     void update(const HostVector& hosts_added, const HostVector& hosts_removed,
                 HostPredicate predicate);
@@ -58,13 +111,19 @@ private:
     const HostSet& original_host_set_;
     const bool locality_weight_aware_;
     const bool scale_locality_weight_;
+    SubsetHostsCache* const hosts_cache_;
+    const uint64_t key_;
+    const absl::optional<SubsetMetadata>& metadata_;
   };
 
   // Represents a subset of an original PrioritySet.
   class PrioritySubsetImpl : public PrioritySetImpl {
   public:
+    // The key and metadata identify the subset in the hosts cache, the subset of all hosts if the
+    // metadata is nullopt.
     PrioritySubsetImpl(const SubsetLoadBalancer& subset_lb, HostPredicate predicate,
-                       bool locality_weight_aware, bool scale_locality_weight);
+                       bool locality_weight_aware, bool scale_locality_weight, uint64_t key,
+                       absl::optional<SubsetMetadata> metadata);
 
     void update(uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed);
 
@@ -102,14 +161,15 @@ private:
     const HostPredicate predicate_;
     const bool locality_weight_aware_;
     const bool scale_locality_weight_;
+    SubsetHostsCache* const hosts_cache_;
+    const uint64_t key_;
+    const absl::optional<SubsetMetadata> metadata_;
     bool empty_ = true;
   };
 
   typedef std::shared_ptr<HostSubsetImpl> HostSubsetImplPtr;
   typedef std::shared_ptr<PrioritySubsetImpl> PrioritySubsetImplPtr;
 
-  typedef std::vector<std::pair<std::string, ProtobufWkt::Value>> SubsetMetadata;
-
   class LbSubsetEntry;
   typedef std::shared_ptr<LbSubsetEntry> LbSubsetEntryPtr;
   typedef std::unordered_map<HashedValue, LbSubsetEntryPtr> ValueSubsetMap;
@@ -119,12 +179,21 @@ private:
   class LbSubsetEntry {
   public:
     LbSubsetEntry() {}
+    LbSubsetEntry(uint64_t key, SubsetMetadata&& metadata)
+        : key_(key), metadata_(std::move(metadata)) {}
 
     bool initialized() const { return priority_subset_ != nullptr; }
     bool active() const { return initialized() && !priority_subset_->empty(); }
+    bool matches(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& criteria) const;
 
     LbSubsetMap children_;
 
+    // The key of the metadata, see subsetKey().
+    const uint64_t key_{};
+    // The metadata of the hosts of the subset, i.e. the metadata of the parent entries followed by
+    // that of this entry.
+    const SubsetMetadata metadata_;
+
     // Only initialized if a match exists at this level.
     PrioritySubsetImplPtr priority_subset_;
   };
@@ -151,7 +220,7 @@ private:
   findSubset(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& matches);
 
   LbSubsetEntryPtr findOrCreateSubset(LbSubsetMap& subsets, const SubsetMetadata& kvs,
-                                      uint32_t idx);
+                                      uint32_t idx, uint64_t key);
   void forEachSubset(LbSubsetMap& subsets, std::function<void(LbSubsetEntryPtr)> cb);
 
   SubsetMetadata extractSubsetMetadata(const std::set<std::string>& subset_keys, const Host& host);
@@ -165,6 +234,7 @@ private:
   Stats::Scope& scope_;
   Runtime::Loader& runtime_;
   Runtime::RandomGenerator& random_;
+  TimeSource& time_source_;
 
   const envoy::api::v2::Cluster::LbSubsetConfig::LbSubsetFallbackPolicy fallback_policy_;
   const SubsetMetadata default_subset_metadata_;
@@ -179,6 +249,10 @@ private:
 
   // Forms a trie-like structure. Requires lexically sorted Host and Route metadata.
   LbSubsetMap subsets_;
+  // All the entries of subsets_ by their key, to find the entry of metadata match criteria with a
+  // single lookup.
+  absl::flat_hash_map<uint64_t, std::vector<LbSubsetEntryPtr>> subset_index_;
+  const SubsetHostsCacheSharedPtr hosts_cache_;
 
   const bool locality_weight_aware_;
   const bool scale_locality_weight_;
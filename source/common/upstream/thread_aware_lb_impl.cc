@@ -107,9 +107,25 @@ void ThreadAwareLoadBalancerBase::refresh() {
     double max_normalized_weight = 0.0;
     normalizeWeights(*host_set, per_priority_state->global_panic_, normalized_host_weights,
                      min_normalized_weight, max_normalized_weight);
-    per_priority_state->current_lb_ =
-        createLoadBalancer(normalized_host_weights, min_normalized_weight, max_normalized_weight);
+
+    // A priority update rebuilds every priority, but often only one priority changed, or nothing
+    // relevant to the hashing load balancer did (e.g. a metadata only update). The hashing load
+    // balancers are a pure function of the normalized weights, so an unchanged priority reuses the
+    // previous one instead of rebuilding it.
+    const PerPriorityState* previous_state =
+        per_priority_state_ != nullptr && priority < per_priority_state_->size()
+            ? (*per_priority_state_)[priority].get()
+            : nullptr;
+    if (previous_state != nullptr &&
+        previous_state->normalized_host_weights_ == normalized_host_weights) {
+      per_priority_state->current_lb_ = previous_state->current_lb_;
+    } else {
+      per_priority_state->current_lb_ =
+          createLoadBalancer(normalized_host_weights, min_normalized_weight, max_normalized_weight);
+    }
+    per_priority_state->normalized_host_weights_ = std::move(normalized_host_weights);
   }
+  per_priority_state_ = per_priority_state_vector;
 
   {
     absl::WriterMutexLock lock(&factory_->mutex_);
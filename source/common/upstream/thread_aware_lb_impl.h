@@ -46,6 +46,9 @@ private:
   struct PerPriorityState {
     std::shared_ptr<HashingLoadBalancer> current_lb_;
     bool global_panic_{};
+    // The weights current_lb_ was built from. These are only used on the main thread, to reuse
+    // current_lb_ when a refresh finds the same hosts with the same weights.
+    NormalizedHostWeightVector normalized_host_weights_;
   };
   typedef std::unique_ptr<PerPriorityState> PerPriorityStatePtr;
 
@@ -85,6 +88,8 @@ private:
   void refresh();
 
   std::shared_ptr<LoadBalancerFactoryImpl> factory_;
+  // The state of the last refresh, only accessed on the main thread.
+  std::shared_ptr<std::vector<PerPriorityStatePtr>> per_priority_state_;
 };
 
 } // namespace Upstream
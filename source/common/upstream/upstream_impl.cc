@@ -1,5 +1,6 @@
 #include "common/upstream/upstream_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <limits>
@@ -242,6 +243,10 @@ HostImpl::createHealthCheckConnection(Event::Dispatcher& dispatcher) const {
           shared_from_this()};
 }
 
+bool HostImpl::canCreateConnection(ResourcePriority priority) const {
+  return stats().cx_active_.value() < cluster_->resourceManager(priority).maxConnectionsPerHost();
+}
+
 Network::ClientConnectionPtr
 HostImpl::createConnection(Event::Dispatcher& dispatcher, const ClusterInfo& cluster,
                            Network::Address::InstanceConstSharedPtr address,
@@ -519,6 +524,28 @@ ClusterLoadReportStats ClusterInfoImpl::generateLoadReportStats(Stats::Scope& sc
   return {ALL_CLUSTER_LOAD_REPORT_STATS(POOL_COUNTER(scope))};
 }
 
+void LatencyEstimatorImpl::recordLatency(std::chrono::milliseconds latency) {
+  // The steps are relative so that the estimate converges at the same rate at any scale. Steps of
+  // 5% up and 0.25% down balance when about 5% of the latencies are higher than the estimate.
+  const double sample = std::max<double>(latency.count(), 1);
+  const double estimate = estimate_.load(std::memory_order_relaxed);
+  if (estimate == 0) {
+    estimate_.store(sample, std::memory_order_relaxed);
+  } else if (sample > estimate) {
+    estimate_.store(estimate * 1.05, std::memory_order_relaxed);
+  } else {
+    estimate_.store(std::max(estimate * 0.9975, 1.0), std::memory_order_relaxed);
+  }
+}
+
+absl::optional<std::chrono::milliseconds> LatencyEstimatorImpl::latencyP95() const {
+  const double estimate = estimate_.load(std::memory_order_relaxed);
+  if (estimate == 0) {
+    return absl::nullopt;
+  }
+  return std::chrono::milliseconds(static_cast<int64_t>(estimate));
+}
+
 ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
                                  const envoy::api::v2::core::BindConfig& bind_config,
                                  Runtime::Loader& runtime,
@@ -532,12 +559,15 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
       per_connection_buffer_limit_bytes_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
       transport_socket_factory_(std::move(socket_factory)), stats_scope_(std::move(stats_scope)),
-      stats_(generateStats(*stats_scope_)),
+      lazy_stats_scope_(config.lazy_stats() ? std::make_unique<Stats::LazyScopeImpl>(*stats_scope_)
+                                            : nullptr),
+      stats_(generateStats(statsStructScope())),
       load_report_stats_(generateLoadReportStats(load_report_stats_store_)),
       features_(parseFeatures(config)),
+      http1_settings_(Http::Utility::parseHttp1Settings(config.http_protocol_options())),
       http2_settings_(Http::Utility::parseHttp2Settings(config.http2_protocol_options())),
       extension_protocol_options_(parseExtensionProtocolOptions(config)),
-      resource_managers_(config, runtime, name_, *stats_scope_),
+      resource_managers_(config, runtime, name_, statsStructScope()),
       maintenance_mode_runtime_key_(fmt::format("upstream.maintenance_mode.{}", name_)),
       source_address_(getSourceAddress(config, bind_config)),
       lb_least_request_config_(config.least_request_lb_config()),
@@ -547,7 +577,10 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
       metadata_(config.metadata()), typed_metadata_(config.metadata()),
       common_lb_config_(config.common_lb_config()),
       cluster_socket_options_(parseClusterSocketOptions(config, bind_config)),
-      drain_connections_on_host_removal_(config.drain_connections_on_host_removal()) {
+      drain_connections_on_host_removal_(config.drain_connections_on_host_removal()),
+      per_upstream_prefetch_ratio_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          config.prefetch_policy(), per_upstream_prefetch_ratio, 1.0)),
+      prefetch_on_host_add_(config.prefetch_policy().prefetch_on_host_add()) {
   switch (config.lb_policy()) {
   case envoy::api::v2::Cluster::ROUND_ROBIN:
     lb_type_ = LoadBalancerType::RoundRobin;
@@ -571,6 +604,13 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
   case envoy::api::v2::Cluster::MAGLEV:
     lb_type_ = LoadBalancerType::Maglev;
     break;
+  case envoy::api::v2::Cluster::CLUSTER_PROVIDED:
+    if (config.has_lb_subset_config() && config.lb_subset_config().subset_selectors_size() != 0) {
+      throw EnvoyException(
+          fmt::format("cluster: LB type 'cluster_provided' may not be used with lb_subset_config"));
+    }
+    lb_type_ = LoadBalancerType::ClusterProvided;
+    break;
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
@@ -849,6 +889,9 @@ ClusterInfoImpl::ResourceManagers::load(const envoy::api::v2::Cluster& config,
   uint64_t max_requests = 1024;
   uint64_t max_retries = 3;
   uint64_t max_connection_pools = std::numeric_limits<uint64_t>::max();
+  uint64_t max_connections_per_host = std::numeric_limits<uint64_t>::max();
+  absl::optional<double> retry_budget_percent;
+  absl::optional<uint32_t> min_retry_concurrency;
 
   bool track_remaining = false;
 
@@ -882,11 +925,31 @@ ClusterInfoImpl::ResourceManagers::load(const envoy::api::v2::Cluster& config,
     track_remaining = it->track_remaining();
     max_connection_pools =
         PROTOBUF_GET_WRAPPED_OR_DEFAULT(*it, max_connection_pools, max_connection_pools);
+    if (it->has_retry_budget()) {
+      const auto& retry_budget = it->retry_budget();
+      retry_budget_percent =
+          retry_budget.has_budget_percent() ? retry_budget.budget_percent().value() : 20.0;
+      min_retry_concurrency =
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(retry_budget, min_retry_concurrency, 3);
+    }
   }
+
+  const auto& per_host_thresholds = config.circuit_breakers().per_host_thresholds();
+  const auto per_host_it = std::find_if(
+      per_host_thresholds.cbegin(), per_host_thresholds.cend(),
+      [priority](const envoy::api::v2::cluster::CircuitBreakers::Thresholds& threshold) {
+        return threshold.priority() == priority;
+      });
+  if (per_host_it != per_host_thresholds.cend()) {
+    max_connections_per_host =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(*per_host_it, max_connections, max_connections_per_host);
+  }
+
   return std::make_unique<ResourceManagerImpl>(
       runtime, runtime_prefix, max_connections, max_pending_requests, max_requests, max_retries,
-      max_connection_pools,
-      ClusterInfoImpl::generateCircuitBreakersStats(stats_scope, priority_name, track_remaining));
+      max_connection_pools, max_connections_per_host,
+      ClusterInfoImpl::generateCircuitBreakersStats(stats_scope, priority_name, track_remaining),
+      retry_budget_percent, min_retry_concurrency);
 }
 
 PriorityStateManager::PriorityStateManager(ClusterImplBase& cluster,
@@ -1081,8 +1144,8 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(const HostVector& new_hosts,
   bool hosts_changed = false;
 
   // Go through and see if the list we have is different from what we just got. If it is, we make a
-  // new host list and raise a change notification. This uses an N^2 search given that this does not
-  // happen very often and the list sizes should be small (see
+  // new host list and raise a change notification. Hosts are matched by address through hash maps,
+  // so this is linear in the size of the lists (see
   // https://github.com/envoyproxy/envoy/issues/2874). We also check for duplicates here. It's
   // possible for DNS to return the same address multiple times, and a bad EDS implementation could
   // do the same thing.
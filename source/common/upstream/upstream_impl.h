@@ -37,6 +37,7 @@
 #include "common/init/manager_impl.h"
 #include "common/network/utility.h"
 #include "common/stats/isolated_store_impl.h"
+#include "common/stats/lazy_scope_impl.h"
 #include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/outlier_detection_impl.h"
 #include "common/upstream/resource_manager_impl.h"
@@ -183,6 +184,7 @@ public:
       Event::Dispatcher& dispatcher, const Network::ConnectionSocket::OptionsSharedPtr& options,
       Network::TransportSocketOptionsSharedPtr transport_socket_options) const override;
   CreateConnectionData createHealthCheckConnection(Event::Dispatcher& dispatcher) const override;
+  bool canCreateConnection(ResourcePriority priority) const override;
   std::vector<Stats::GaugeSharedPtr> gauges() const override { return stats_store_.gauges(); }
   void healthFlagClear(HealthFlag flag) override { health_flags_ &= ~enumToInt(flag); }
   bool healthFlagGet(HealthFlag flag) const override { return health_flags_ & enumToInt(flag); }
@@ -235,7 +237,8 @@ private:
   void setEdsHealthFlag(envoy::api::v2::core::HealthStatus health_status);
 
   std::atomic<uint64_t> health_flags_{};
-  ActiveHealthFailureType active_health_failure_type_{};
+  // Written by health check sessions, which may run on a health check thread.
+  std::atomic<ActiveHealthFailureType> active_health_failure_type_{};
   std::atomic<uint32_t> weight_;
   std::atomic<bool> used_;
 };
@@ -302,6 +305,18 @@ public:
   const HostsPerLocality& degradedHostsPerLocality() const override {
     return *degraded_hosts_per_locality_;
   }
+  HostVectorConstSharedPtr hostsPtr() const override { return hosts_; }
+  HostVectorConstSharedPtr healthyHostsPtr() const override { return healthy_hosts_; }
+  HostVectorConstSharedPtr degradedHostsPtr() const override { return degraded_hosts_; }
+  HostsPerLocalityConstSharedPtr hostsPerLocalityPtr() const override {
+    return hosts_per_locality_;
+  }
+  HostsPerLocalityConstSharedPtr healthyHostsPerLocalityPtr() const override {
+    return healthy_hosts_per_locality_;
+  }
+  HostsPerLocalityConstSharedPtr degradedHostsPerLocalityPtr() const override {
+    return degraded_hosts_per_locality_;
+  }
   LocalityWeightsConstSharedPtr localityWeights() const override { return locality_weights_; }
   absl::optional<uint32_t> chooseHealthyLocality() override;
   absl::optional<uint32_t> chooseDegradedLocality() override;
@@ -479,6 +494,23 @@ private:
   };
 };
 
+/**
+ * A LatencyEstimator that moves the estimate with every latency, up by a fraction of itself for the
+ * latencies above it and down by a smaller fraction for the others. The steps balance when 5% of
+ * the latencies are above the estimate. Concurrent updates may overwrite each other, which only
+ * loses some of the latencies.
+ */
+class LatencyEstimatorImpl : public LatencyEstimator {
+public:
+  // Upstream::LatencyEstimator
+  void recordLatency(std::chrono::milliseconds latency) override;
+  absl::optional<std::chrono::milliseconds> latencyP95() const override;
+
+private:
+  // The estimate in milliseconds, or 0 if no latency was recorded.
+  std::atomic<double> estimate_{0};
+};
+
 /**
  * Implementation of ClusterInfo that reads from JSON.
  */
@@ -508,6 +540,7 @@ public:
     return per_connection_buffer_limit_bytes_;
   }
   uint64_t features() const override { return features_; }
+  const Http::Http1Settings& http1Settings() const override { return http1_settings_; }
   const Http::Http2Settings& http2Settings() const override { return http2_settings_; }
   ProtocolOptionsConfigConstSharedPtr
   extensionProtocolOptions(const std::string& name) const override;
@@ -548,9 +581,19 @@ public:
 
   bool drainConnectionsOnHostRemoval() const override { return drain_connections_on_host_removal_; }
 
+  float perUpstreamPrefetchRatio() const override { return per_upstream_prefetch_ratio_; }
+  bool prefetchOnHostAdd() const override { return prefetch_on_host_add_; }
+
   absl::optional<std::string> eds_service_name() const override { return eds_service_name_; }
 
+  LatencyEstimator& latencyEstimator() const override { return latency_estimator_; }
+
 private:
+  // The scope the strongly named stats structs are built from.
+  Stats::Scope& statsStructScope() const {
+    return lazy_stats_scope_ != nullptr ? *lazy_stats_scope_ : *stats_scope_;
+  }
+
   struct ResourceManagers {
     ResourceManagers(const envoy::api::v2::Cluster& config, Runtime::Loader& runtime,
                      const std::string& cluster_name, Stats::Scope& stats_scope);
@@ -572,10 +615,14 @@ private:
   const uint32_t per_connection_buffer_limit_bytes_;
   Network::TransportSocketFactoryPtr transport_socket_factory_;
   Stats::ScopePtr stats_scope_;
+  // Set when the cluster is configured with lazy_stats, in which case the stats structs are built
+  // from it rather than from stats_scope_.
+  std::unique_ptr<Stats::LazyScopeImpl> lazy_stats_scope_;
   mutable ClusterStats stats_;
   Stats::IsolatedStoreImpl load_report_stats_store_;
   mutable ClusterLoadReportStats load_report_stats_;
   const uint64_t features_;
+  const Http::Http1Settings http1_settings_;
   const Http::Http2Settings http2_settings_;
   const std::map<std::string, ProtocolOptionsConfigConstSharedPtr> extension_protocol_options_;
   mutable ResourceManagers resource_managers_;
@@ -592,7 +639,10 @@ private:
   const envoy::api::v2::Cluster::CommonLbConfig common_lb_config_;
   const Network::ConnectionSocket::OptionsSharedPtr cluster_socket_options_;
   const bool drain_connections_on_host_removal_;
+  const float per_upstream_prefetch_ratio_;
+  const bool prefetch_on_host_add_;
   absl::optional<std::string> eds_service_name_;
+  mutable LatencyEstimatorImpl latency_estimator_;
 };
 
 /**
@@ -646,6 +696,7 @@ public:
   Outlier::Detector* outlierDetector() override { return outlier_detector_.get(); }
   const Outlier::Detector* outlierDetector() const override { return outlier_detector_.get(); }
   void initialize(std::function<void()> callback) override;
+  ThreadAwareLoadBalancerPtr createThreadAwareLoadBalancer() override { return nullptr; }
 
 protected:
   ClusterImplBase(const envoy::api::v2::Cluster& cluster, Runtime::Loader& runtime,
@@ -147,13 +147,16 @@ MainCommon::MainCommon(int argc, const char* const* argv)
             platform_impl_.fileSystem()) {}
 
 std::string MainCommon::hotRestartVersion(uint64_t max_num_stats, uint64_t max_stat_name_len,
-                                          bool hot_restart_enabled) {
+                                          bool hot_restart_enabled,
+                                          bool hot_restart_stats_transfer) {
 #ifdef ENVOY_HOT_RESTART
   if (hot_restart_enabled) {
-    return Server::HotRestartImpl::hotRestartVersion(max_num_stats, max_stat_name_len);
+    return Server::HotRestartImpl::hotRestartVersion(max_num_stats, max_stat_name_len,
+                                                     hot_restart_stats_transfer);
   }
 #else
   UNREFERENCED_PARAMETER(hot_restart_enabled);
+  UNREFERENCED_PARAMETER(hot_restart_stats_transfer);
   UNREFERENCED_PARAMETER(max_num_stats);
   UNREFERENCED_PARAMETER(max_stat_name_len);
 #endif
@@ -5,7 +5,7 @@
 
 #include "common/common/thread.h"
 #include "common/event/real_time_system.h"
-#include "common/stats/fake_symbol_table_impl.h"
+#include "common/stats/symbol_table_impl.h"
 #include "common/stats/thread_local_store.h"
 #include "common/thread_local/thread_local_impl.h"
 
@@ -65,7 +65,7 @@ public:
 
 protected:
   const Envoy::OptionsImpl& options_;
-  Stats::FakeSymbolTableImpl symbol_table_;
+  Stats::SymbolTableImpl symbol_table_;
   Server::ComponentFactory& component_factory_;
   Thread::ThreadFactory& thread_factory_;
   Filesystem::Instance& file_system_;
@@ -104,7 +104,7 @@ public:
   }
 
   static std::string hotRestartVersion(uint64_t max_num_stats, uint64_t max_stat_name_len,
-                                       bool hot_restart_enabled);
+                                       bool hot_restart_enabled, bool hot_restart_stats_transfer);
 
 private:
 #ifdef ENVOY_HANDLE_SIGNALS
@@ -0,0 +1,309 @@
+#include "extensions/access_loggers/common/http_access_log_entry_builder.h"
+
+#include "envoy/upstream/upstream.h"
+
+#include "common/network/utility.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Common {
+
+HttpAccessLogEntryBuilder::HttpAccessLogEntryBuilder(
+    const Protobuf::RepeatedPtrField<ProtobufTypes::String>& request_headers_to_log,
+    const Protobuf::RepeatedPtrField<ProtobufTypes::String>& response_headers_to_log,
+    const Protobuf::RepeatedPtrField<ProtobufTypes::String>& response_trailers_to_log) {
+  for (const auto& header : request_headers_to_log) {
+    request_headers_to_log_.emplace_back(header);
+  }
+
+  for (const auto& header : response_headers_to_log) {
+    response_headers_to_log_.emplace_back(header);
+  }
+
+  for (const auto& header : response_trailers_to_log) {
+    response_trailers_to_log_.emplace_back(header);
+  }
+}
+
+void HttpAccessLogEntryBuilder::responseFlagsToAccessLogResponseFlags(
+    envoy::data::accesslog::v2::AccessLogCommon& common_access_log,
+    const StreamInfo::StreamInfo& stream_info) {
+
+  static_assert(StreamInfo::ResponseFlag::LastFlag == 0x10000,
+                "A flag has been added. Fix this code.");
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::FailedLocalHealthCheck)) {
+    common_access_log.mutable_response_flags()->set_failed_local_healthcheck(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::NoHealthyUpstream)) {
+    common_access_log.mutable_response_flags()->set_no_healthy_upstream(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::UpstreamRequestTimeout)) {
+    common_access_log.mutable_response_flags()->set_upstream_request_timeout(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::LocalReset)) {
+    common_access_log.mutable_response_flags()->set_local_reset(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::UpstreamRemoteReset)) {
+    common_access_log.mutable_response_flags()->set_upstream_remote_reset(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::UpstreamConnectionFailure)) {
+    common_access_log.mutable_response_flags()->set_upstream_connection_failure(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::UpstreamConnectionTermination)) {
+    common_access_log.mutable_response_flags()->set_upstream_connection_termination(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::UpstreamOverflow)) {
+    common_access_log.mutable_response_flags()->set_upstream_overflow(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::NoRouteFound)) {
+    common_access_log.mutable_response_flags()->set_no_route_found(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::DelayInjected)) {
+    common_access_log.mutable_response_flags()->set_delay_injected(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::FaultInjected)) {
+    common_access_log.mutable_response_flags()->set_fault_injected(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::RateLimited)) {
+    common_access_log.mutable_response_flags()->set_rate_limited(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::UnauthorizedExternalService)) {
+    common_access_log.mutable_response_flags()->mutable_unauthorized_details()->set_reason(
+        envoy::data::accesslog::v2::ResponseFlags_Unauthorized_Reason::
+            ResponseFlags_Unauthorized_Reason_EXTERNAL_SERVICE);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::RateLimitServiceError)) {
+    common_access_log.mutable_response_flags()->set_rate_limit_service_error(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::DownstreamConnectionTermination)) {
+    common_access_log.mutable_response_flags()->set_downstream_connection_termination(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::UpstreamRetryLimitExceeded)) {
+    common_access_log.mutable_response_flags()->set_upstream_retry_limit_exceeded(true);
+  }
+
+  if (stream_info.hasResponseFlag(StreamInfo::ResponseFlag::StreamIdleTimeout)) {
+    common_access_log.mutable_response_flags()->set_stream_idle_timeout(true);
+  }
+}
+
+void HttpAccessLogEntryBuilder::build(
+    const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+    const Http::HeaderMap& response_trailers, const StreamInfo::StreamInfo& stream_info,
+    envoy::data::accesslog::v2::HTTPAccessLogEntry& log_entry) const {
+  // Common log properties.
+  // TODO(mattklein123): Populate sample_rate field.
+  auto* common_properties = log_entry.mutable_common_properties();
+
+  if (stream_info.downstreamRemoteAddress() != nullptr) {
+    Network::Utility::addressToProtobufAddress(
+        *stream_info.downstreamRemoteAddress(),
+        *common_properties->mutable_downstream_remote_address());
+  }
+  if (stream_info.downstreamLocalAddress() != nullptr) {
+    Network::Utility::addressToProtobufAddress(
+        *stream_info.downstreamLocalAddress(),
+        *common_properties->mutable_downstream_local_address());
+  }
+  if (stream_info.downstreamSslConnection() != nullptr) {
+    auto* tls_properties = common_properties->mutable_tls_properties();
+
+    tls_properties->set_tls_sni_hostname(stream_info.requestedServerName());
+
+    auto* local_properties = tls_properties->mutable_local_certificate_properties();
+    for (const auto& uri_san : stream_info.downstreamSslConnection()->uriSanLocalCertificate()) {
+      auto* local_san = local_properties->add_subject_alt_name();
+      local_san->set_uri(uri_san);
+    }
+    local_properties->set_subject(stream_info.downstreamSslConnection()->subjectLocalCertificate());
+
+    auto* peer_properties = tls_properties->mutable_peer_certificate_properties();
+    for (const auto& uri_san : stream_info.downstreamSslConnection()->uriSanPeerCertificate()) {
+      auto* peer_san = peer_properties->add_subject_alt_name();
+      peer_san->set_uri(uri_san);
+    }
+
+    peer_properties->set_subject(stream_info.downstreamSslConnection()->subjectPeerCertificate());
+
+    // TODO(snowp): Populate remaining tls_properties fields.
+  }
+  common_properties->mutable_start_time()->MergeFrom(
+      Protobuf::util::TimeUtil::NanosecondsToTimestamp(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              stream_info.startTime().time_since_epoch())
+              .count()));
+
+  absl::optional<std::chrono::nanoseconds> dur = stream_info.lastDownstreamRxByteReceived();
+  if (dur) {
+    common_properties->mutable_time_to_last_rx_byte()->MergeFrom(
+        Protobuf::util::TimeUtil::NanosecondsToDuration(dur.value().count()));
+  }
+
+  dur = stream_info.firstUpstreamTxByteSent();
+  if (dur) {
+    common_properties->mutable_time_to_first_upstream_tx_byte()->MergeFrom(
+        Protobuf::util::TimeUtil::NanosecondsToDuration(dur.value().count()));
+  }
+
+  dur = stream_info.lastUpstreamTxByteSent();
+  if (dur) {
+    common_properties->mutable_time_to_last_upstream_tx_byte()->MergeFrom(
+        Protobuf::util::TimeUtil::NanosecondsToDuration(dur.value().count()));
+  }
+
+  dur = stream_info.firstUpstreamRxByteReceived();
+  if (dur) {
+    common_properties->mutable_time_to_first_upstream_rx_byte()->MergeFrom(
+        Protobuf::util::TimeUtil::NanosecondsToDuration(dur.value().count()));
+  }
+
+  dur = stream_info.lastUpstreamRxByteReceived();
+  if (dur) {
+    common_properties->mutable_time_to_last_upstream_rx_byte()->MergeFrom(
+        Protobuf::util::TimeUtil::NanosecondsToDuration(dur.value().count()));
+  }
+
+  dur = stream_info.firstDownstreamTxByteSent();
+  if (dur) {
+    common_properties->mutable_time_to_first_downstream_tx_byte()->MergeFrom(
+        Protobuf::util::TimeUtil::NanosecondsToDuration(dur.value().count()));
+  }
+
+  dur = stream_info.lastDownstreamTxByteSent();
+  if (dur) {
+    common_properties->mutable_time_to_last_downstream_tx_byte()->MergeFrom(
+        Protobuf::util::TimeUtil::NanosecondsToDuration(dur.value().count()));
+  }
+
+  if (stream_info.upstreamHost() != nullptr) {
+    Network::Utility::addressToProtobufAddress(
+        *stream_info.upstreamHost()->address(),
+        *common_properties->mutable_upstream_remote_address());
+    common_properties->set_upstream_cluster(stream_info.upstreamHost()->cluster().name());
+  }
+  if (stream_info.upstreamLocalAddress() != nullptr) {
+    Network::Utility::addressToProtobufAddress(
+        *stream_info.upstreamLocalAddress(), *common_properties->mutable_upstream_local_address());
+  }
+  responseFlagsToAccessLogResponseFlags(*common_properties, stream_info);
+  if (!stream_info.upstreamTransportFailureReason().empty()) {
+    common_properties->set_upstream_transport_failure_reason(
+        stream_info.upstreamTransportFailureReason());
+  }
+  if (stream_info.dynamicMetadata().filter_metadata_size() > 0) {
+    common_properties->mutable_metadata()->MergeFrom(stream_info.dynamicMetadata());
+  }
+
+  if (stream_info.protocol()) {
+    switch (stream_info.protocol().value()) {
+    case Http::Protocol::Http10:
+      log_entry.set_protocol_version(envoy::data::accesslog::v2::HTTPAccessLogEntry::HTTP10);
+      break;
+    case Http::Protocol::Http11:
+      log_entry.set_protocol_version(envoy::data::accesslog::v2::HTTPAccessLogEntry::HTTP11);
+      break;
+    case Http::Protocol::Http2:
+      log_entry.set_protocol_version(envoy::data::accesslog::v2::HTTPAccessLogEntry::HTTP2);
+      break;
+    }
+  }
+
+  // HTTP request properties.
+  // TODO(mattklein123): Populate port field.
+  auto* request_properties = log_entry.mutable_request();
+  if (request_headers.Scheme() != nullptr) {
+    request_properties->set_scheme(request_headers.Scheme()->value().c_str());
+  }
+  if (request_headers.Host() != nullptr) {
+    request_properties->set_authority(request_headers.Host()->value().c_str());
+  }
+  if (request_headers.Path() != nullptr) {
+    request_properties->set_path(request_headers.Path()->value().c_str());
+  }
+  if (request_headers.UserAgent() != nullptr) {
+    request_properties->set_user_agent(request_headers.UserAgent()->value().c_str());
+  }
+  if (request_headers.Referer() != nullptr) {
+    request_properties->set_referer(request_headers.Referer()->value().c_str());
+  }
+  if (request_headers.ForwardedFor() != nullptr) {
+    request_properties->set_forwarded_for(request_headers.ForwardedFor()->value().c_str());
+  }
+  if (request_headers.RequestId() != nullptr) {
+    request_properties->set_request_id(request_headers.RequestId()->value().c_str());
+  }
+  if (request_headers.EnvoyOriginalPath() != nullptr) {
+    request_properties->set_original_path(request_headers.EnvoyOriginalPath()->value().c_str());
+  }
+  request_properties->set_request_headers_bytes(request_headers.byteSize());
+  request_properties->set_request_body_bytes(stream_info.bytesReceived());
+  if (request_headers.Method() != nullptr) {
+    envoy::api::v2::core::RequestMethod method =
+        envoy::api::v2::core::RequestMethod::METHOD_UNSPECIFIED;
+    envoy::api::v2::core::RequestMethod_Parse(
+        std::string(request_headers.Method()->value().c_str()), &method);
+    request_properties->set_request_method(method);
+  }
+  if (!request_headers_to_log_.empty()) {
+    auto* logged_headers = request_properties->mutable_request_headers();
+
+    for (const auto& header : request_headers_to_log_) {
+      const Http::HeaderEntry* entry = request_headers.get(header);
+      if (entry != nullptr) {
+        logged_headers->insert({header.get(), ProtobufTypes::String(entry->value().c_str())});
+      }
+    }
+  }
+
+  // HTTP response properties.
+  auto* response_properties = log_entry.mutable_response();
+  if (stream_info.responseCode()) {
+    response_properties->mutable_response_code()->set_value(stream_info.responseCode().value());
+  }
+  response_properties->set_response_headers_bytes(response_headers.byteSize());
+  response_properties->set_response_body_bytes(stream_info.bytesSent());
+  if (!response_headers_to_log_.empty()) {
+    auto* logged_headers = response_properties->mutable_response_headers();
+
+    for (const auto& header : response_headers_to_log_) {
+      const Http::HeaderEntry* entry = response_headers.get(header);
+      if (entry != nullptr) {
+        logged_headers->insert({header.get(), ProtobufTypes::String(entry->value().c_str())});
+      }
+    }
+  }
+
+  if (!response_trailers_to_log_.empty()) {
+    auto* logged_headers = response_properties->mutable_response_trailers();
+
+    for (const auto& header : response_trailers_to_log_) {
+      const Http::HeaderEntry* entry = response_trailers.get(header);
+      if (entry != nullptr) {
+        logged_headers->insert({header.get(), ProtobufTypes::String(entry->value().c_str())});
+      }
+    }
+  }
+}
+
+} // namespace Common
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
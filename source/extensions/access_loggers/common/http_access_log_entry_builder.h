@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "envoy/data/accesslog/v2/accesslog.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/stream_info/stream_info.h"
+
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Common {
+
+/**
+ * Builds the structured HTTPAccessLogEntry of a request, for the access logs that log structured
+ * entries rather than formatted lines.
+ */
+class HttpAccessLogEntryBuilder {
+public:
+  HttpAccessLogEntryBuilder(
+      const Protobuf::RepeatedPtrField<ProtobufTypes::String>& request_headers_to_log,
+      const Protobuf::RepeatedPtrField<ProtobufTypes::String>& response_headers_to_log,
+      const Protobuf::RepeatedPtrField<ProtobufTypes::String>& response_trailers_to_log);
+
+  /**
+   * Fill the log entry of a request.
+   * @param request_headers supplies the request headers.
+   * @param response_headers supplies the response headers.
+   * @param response_trailers supplies the response trailers.
+   * @param stream_info supplies the stream info of the request.
+   * @param log_entry supplies the log entry to fill.
+   */
+  void build(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+             const Http::HeaderMap& response_trailers, const StreamInfo::StreamInfo& stream_info,
+             envoy::data::accesslog::v2::HTTPAccessLogEntry& log_entry) const;
+
+  static void responseFlagsToAccessLogResponseFlags(
+      envoy::data::accesslog::v2::AccessLogCommon& common_access_log,
+      const StreamInfo::StreamInfo& stream_info);
+
+private:
+  std::vector<Http::LowerCaseString> request_headers_to_log_;
+  std::vector<Http::LowerCaseString> response_headers_to_log_;
+  std::vector<Http::LowerCaseString> response_trailers_to_log_;
+};
+
+} // namespace Common
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
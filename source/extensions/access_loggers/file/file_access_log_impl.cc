@@ -1,12 +1,46 @@
 #include "extensions/access_loggers/file/file_access_log_impl.h"
 
 #include "common/http/header_map_impl.h"
+#include "common/protobuf/protobuf.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace AccessLoggers {
 namespace File {
 
+ProtoFormatter::ProtoFormatter(
+    const envoy::config::accesslog::v2::FileAccessLog::ProtoFormat& config)
+    : entry_builder_(config.additional_request_headers_to_log(),
+                     config.additional_response_headers_to_log(),
+                     config.additional_response_trailers_to_log()) {}
+
+std::string ProtoFormatter::format(const Http::HeaderMap& request_headers,
+                                   const Http::HeaderMap& response_headers,
+                                   const Http::HeaderMap& response_trailers,
+                                   const StreamInfo::StreamInfo& stream_info) const {
+  std::string output;
+  formatTo(request_headers, response_headers, response_trailers, stream_info, output);
+  return output;
+}
+
+void ProtoFormatter::formatTo(const Http::HeaderMap& request_headers,
+                              const Http::HeaderMap& response_headers,
+                              const Http::HeaderMap& response_trailers,
+                              const StreamInfo::StreamInfo& stream_info,
+                              std::string& output) const {
+  envoy::data::accesslog::v2::HTTPAccessLogEntry log_entry;
+  entry_builder_.build(request_headers, response_headers, response_trailers, stream_info,
+                       log_entry);
+
+  // The entry is serialized right after its size, directly into the output.
+  const uint32_t entry_size = log_entry.ByteSizeLong();
+  const size_t offset = output.size();
+  output.resize(offset + Protobuf::io::CodedOutputStream::VarintSize32(entry_size) + entry_size);
+  uint8_t* target = reinterpret_cast<uint8_t*>(&output[offset]);
+  target = Protobuf::io::CodedOutputStream::WriteVarint32ToArray(entry_size, target);
+  log_entry.SerializeWithCachedSizesToArray(target);
+}
+
 FileAccessLog::FileAccessLog(const std::string& access_log_path, AccessLog::FilterPtr&& filter,
                              AccessLog::FormatterPtr&& formatter,
                              AccessLog::AccessLogManager& log_manager)
@@ -1,12 +1,35 @@
 #pragma once
 
 #include "envoy/access_log/access_log.h"
+#include "envoy/config/accesslog/v2/file.pb.h"
+
+#include "extensions/access_loggers/common/http_access_log_entry_builder.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace AccessLoggers {
 namespace File {
 
+/**
+ * Formatter that formats a request as a length-delimited HTTPAccessLogEntry record.
+ */
+class ProtoFormatter : public AccessLog::Formatter {
+public:
+  ProtoFormatter(const envoy::config::accesslog::v2::FileAccessLog::ProtoFormat& config);
+
+  // AccessLog::Formatter
+  std::string format(const Http::HeaderMap& request_headers,
+                     const Http::HeaderMap& response_headers,
+                     const Http::HeaderMap& response_trailers,
+                     const StreamInfo::StreamInfo& stream_info) const override;
+  void formatTo(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+                const Http::HeaderMap& response_trailers, const StreamInfo::StreamInfo& stream_info,
+                std::string& output) const override;
+
+private:
+  const Common::HttpAccessLogEntryBuilder entry_builder_;
+};
+
 /**
  * Access log Instance that writes logs to a file.
  */
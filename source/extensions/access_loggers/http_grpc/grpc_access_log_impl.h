@@ -1,24 +1,45 @@
 #pragma once
 
+#include <chrono>
 #include <unordered_map>
-#include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/config/accesslog/v2/als.pb.h"
 #include "envoy/config/filter/accesslog/v2/accesslog.pb.h"
+#include "envoy/event/timer.h"
 #include "envoy/grpc/async_client.h"
 #include "envoy/grpc/async_client_manager.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/service/accesslog/v2/als.pb.h"
 #include "envoy/singleton/instance.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/thread_local/thread_local.h"
 
+#include "extensions/access_loggers/common/http_access_log_entry_builder.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace AccessLoggers {
 namespace HttpGrpc {
 
-// TODO(mattklein123): Stats
+/**
+ * All stats for the HTTP gRPC access log. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_GRPC_ACCESS_LOG_STATS(COUNTER)                                                         \
+  COUNTER(logs_written)                                                                            \
+  COUNTER(logs_dropped)                                                                            \
+  COUNTER(messages_failed)                                                                         \
+  COUNTER(messages_sent)
+// clang-format on
+
+/**
+ * Struct definition for all HTTP gRPC access log stats. @see stats_macros.h
+ */
+struct GrpcAccessLogStats {
+  ALL_GRPC_ACCESS_LOG_STATS(GENERATE_COUNTER_STRUCT)
+};
 
 /**
  * Interface for an access log streamer. The streamer deals with threading and sends access logs
@@ -32,8 +53,9 @@ public:
    * Send an access log.
    * @param message supplies the access log to send.
    * @param log_name supplies the name of the log stream to send on.
+   * @return bool whether the message was sent, which fails if the stream could not be started.
    */
-  virtual void send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
+  virtual bool send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
                     const std::string& log_name) PURE;
 };
 
@@ -49,9 +71,9 @@ public:
                             const LocalInfo::LocalInfo& local_info);
 
   // GrpcAccessLogStreamer
-  void send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
+  bool send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
             const std::string& log_name) override {
-    tls_slot_->getTyped<ThreadLocalStreamer>().send(message, log_name);
+    return tls_slot_->getTyped<ThreadLocalStreamer>().send(message, log_name);
   }
 
 private:
@@ -97,7 +119,7 @@ private:
    */
   struct ThreadLocalStreamer : public ThreadLocal::ThreadLocalObject {
     ThreadLocalStreamer(const SharedStateSharedPtr& shared_state);
-    void send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
+    bool send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
               const std::string& log_name);
 
     Grpc::AsyncClientPtr client_;
@@ -109,17 +131,15 @@ private:
 };
 
 /**
- * Access log Instance that streams HTTP logs over gRPC.
+ * Access log Instance that streams HTTP logs over gRPC. Each worker batches its log entries into a
+ * single message, which is sent once it is large enough or its flush interval elapsed.
  */
 class HttpGrpcAccessLog : public AccessLog::Instance {
 public:
   HttpGrpcAccessLog(AccessLog::FilterPtr&& filter,
                     const envoy::config::accesslog::v2::HttpGrpcAccessLogConfig& config,
-                    GrpcAccessLogStreamerSharedPtr grpc_access_log_streamer);
-
-  static void responseFlagsToAccessLogResponseFlags(
-      envoy::data::accesslog::v2::AccessLogCommon& common_access_log,
-      const StreamInfo::StreamInfo& stream_info);
+                    GrpcAccessLogStreamerSharedPtr grpc_access_log_streamer,
+                    ThreadLocal::SlotAllocator& tls, Stats::Scope& scope);
 
   // AccessLog::Instance
   void log(const Http::HeaderMap* request_headers, const Http::HeaderMap* response_headers,
@@ -127,12 +147,45 @@ public:
            const StreamInfo::StreamInfo& stream_info) override;
 
 private:
+  /**
+   * Shared state that is owned by the per-thread loggers, which may outlive the access log.
+   */
+  struct SharedState {
+    SharedState(const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config,
+                GrpcAccessLogStreamerSharedPtr grpc_access_log_streamer, Stats::Scope& scope);
+
+    GrpcAccessLogStreamerSharedPtr grpc_access_log_streamer_;
+    const std::string log_name_;
+    const std::chrono::milliseconds buffer_flush_interval_;
+    const uint64_t buffer_size_bytes_;
+    // Zero if the number of entries doesn't limit the batches.
+    const uint64_t buffer_size_entries_;
+    const uint64_t max_buffered_bytes_;
+    GrpcAccessLogStats stats_;
+  };
+
+  typedef std::shared_ptr<SharedState> SharedStateSharedPtr;
+
+  /**
+   * Per-thread batch of log entries.
+   */
+  struct ThreadLocalLogger : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalLogger(const SharedStateSharedPtr& shared_state, Event::Dispatcher& dispatcher);
+
+    void log(envoy::data::accesslog::v2::HTTPAccessLogEntry&& entry);
+    void flush();
+
+    SharedStateSharedPtr shared_state_;
+    envoy::service::accesslog::v2::StreamAccessLogsMessage message_;
+    // The size of the entries of message_, without their framing.
+    uint64_t message_bytes_{};
+    Event::TimerPtr flush_timer_;
+  };
+
   AccessLog::FilterPtr filter_;
   const envoy::config::accesslog::v2::HttpGrpcAccessLogConfig config_;
-  GrpcAccessLogStreamerSharedPtr grpc_access_log_streamer_;
-  std::vector<Http::LowerCaseString> request_headers_to_log_;
-  std::vector<Http::LowerCaseString> response_headers_to_log_;
-  std::vector<Http::LowerCaseString> response_trailers_to_log_;
+  const Common::HttpAccessLogEntryBuilder entry_builder_;
+  ThreadLocal::SlotPtr tls_slot_;
 };
 
 } // namespace HttpGrpc
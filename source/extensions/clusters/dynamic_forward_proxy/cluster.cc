@@ -0,0 +1,147 @@
+#include "extensions/clusters/dynamic_forward_proxy/cluster.h"
+
+#include "envoy/registry/registry.h"
+
+#include "extensions/common/dynamic_forward_proxy/dns_cache_manager_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Clusters {
+namespace DynamicForwardProxy {
+
+Cluster::Cluster(
+    const envoy::api::v2::Cluster& cluster,
+    const envoy::config::cluster::dynamic_forward_proxy::v2alpha::ClusterConfig& config,
+    Runtime::Loader& runtime,
+    Extensions::Common::DynamicForwardProxy::DnsCacheManagerFactory& cache_manager_factory,
+    Server::Configuration::TransportSocketFactoryContext& factory_context,
+    Stats::ScopePtr&& stats_scope, bool added_via_api)
+    : Upstream::ClusterImplBase(cluster, runtime, factory_context, std::move(stats_scope),
+                                added_via_api),
+      dns_cache_manager_(cache_manager_factory.get()),
+      dns_cache_(dns_cache_manager_->getCache(config.dns_cache_config())) {}
+
+void Cluster::startPreInit() {
+  // Attaching to the cache adds the hosts that it already resolved, e.g. for another cluster or
+  // for a previous version of this one.
+  update_callbacks_handle_ = dns_cache_->addUpdateCallbacks(*this);
+  onPreInitComplete();
+}
+
+Upstream::ThreadAwareLoadBalancerPtr Cluster::createThreadAwareLoadBalancer() {
+  return std::make_unique<ThreadAwareLoadBalancer>(host_map_);
+}
+
+void Cluster::onDnsHostAddOrUpdate(
+    const std::string& host,
+    const Extensions::Common::DynamicForwardProxy::DnsHostInfoSharedPtr& host_info) {
+  const Network::Address::InstanceConstSharedPtr address = host_info->address();
+  ASSERT(address != nullptr);
+  const HostInfoMapConstSharedPtr current_map = host_map_->get();
+  Upstream::HostVector hosts_removed;
+  const auto host_map_it = current_map->find(host);
+  if (host_map_it != current_map->end()) {
+    if (*host_map_it->second.host_->address() == *address) {
+      return;
+    }
+    // A host's address is fixed, so a new address replaces the host, along with its connection
+    // pools.
+    ENVOY_LOG(debug, "updating dynamic forward proxy cluster host '{}' to address {}", host,
+              address->asString());
+    hosts_removed.emplace_back(host_map_it->second.host_);
+  } else {
+    ENVOY_LOG(debug, "adding dynamic forward proxy cluster host '{}' with address {}", host,
+              address->asString());
+  }
+
+  const Upstream::HostSharedPtr new_host = std::make_shared<Upstream::HostImpl>(
+      info(), host, address, envoy::api::v2::core::Metadata::default_instance(), 1,
+      envoy::api::v2::core::Locality().default_instance(),
+      envoy::api::v2::endpoint::Endpoint::HealthCheckConfig().default_instance(), 0,
+      envoy::api::v2::core::HealthStatus::UNKNOWN);
+  std::shared_ptr<HostInfoMap> new_map = std::make_shared<HostInfoMap>(*current_map);
+  new_map->erase(host);
+  new_map->emplace(host, HostInfo{host_info, new_host});
+  host_map_->set(std::move(new_map));
+
+  updatePriorityState({new_host}, hosts_removed);
+}
+
+void Cluster::onDnsHostRemove(const std::string& host) {
+  const HostInfoMapConstSharedPtr current_map = host_map_->get();
+  const auto host_map_it = current_map->find(host);
+  if (host_map_it == current_map->end()) {
+    // The host never resolved, so it was never part of the cluster.
+    return;
+  }
+
+  ENVOY_LOG(debug, "removing dynamic forward proxy cluster host '{}'", host);
+  const Upstream::HostVector hosts_removed{host_map_it->second.host_};
+  std::shared_ptr<HostInfoMap> new_map = std::make_shared<HostInfoMap>(*current_map);
+  new_map->erase(host);
+  host_map_->set(std::move(new_map));
+
+  updatePriorityState({}, hosts_removed);
+}
+
+void Cluster::updatePriorityState(const Upstream::HostVector& hosts_added,
+                                  const Upstream::HostVector& hosts_removed) {
+  Upstream::HostVectorSharedPtr new_hosts(new Upstream::HostVector());
+  for (const auto& host : *host_map_->get()) {
+    new_hosts->emplace_back(host.second.host_);
+  }
+
+  // The membership update re-creates the load balancers on the workers, which picks up the new
+  // host map.
+  priority_set_.updateHosts(0,
+                            Upstream::HostSetImpl::partitionHosts(
+                                new_hosts, Upstream::HostsPerLocalityImpl::empty()),
+                            {}, hosts_added, hosts_removed, absl::nullopt);
+}
+
+Upstream::HostConstSharedPtr
+Cluster::LoadBalancer::chooseHost(Upstream::LoadBalancerContext* context) {
+  if (context == nullptr || context->downstreamHeaders() == nullptr ||
+      context->downstreamHeaders()->Host() == nullptr) {
+    return nullptr;
+  }
+
+  const std::string host(context->downstreamHeaders()->Host()->value().getStringView());
+  const auto host_it = host_map_->find(host);
+  if (host_it == host_map_->end()) {
+    ENVOY_LOG(debug, "no dynamic forward proxy cluster host for '{}'", host);
+    return nullptr;
+  }
+
+  host_it->second.shared_host_info_->touch();
+  return host_it->second.host_;
+}
+
+Upstream::ClusterImplBaseSharedPtr ClusterFactory::createClusterWithConfig(
+    const envoy::api::v2::Cluster& cluster,
+    const envoy::config::cluster::dynamic_forward_proxy::v2alpha::ClusterConfig& proto_config,
+    Upstream::ClusterFactoryContext& context,
+    Server::Configuration::TransportSocketFactoryContext& socket_factory_context,
+    Stats::ScopePtr&& stats_scope) {
+  if (cluster.lb_policy() != envoy::api::v2::Cluster::CLUSTER_PROVIDED) {
+    throw EnvoyException(fmt::format(
+        "cluster: cluster type '{}' may only be used with LB type 'cluster_provided'",
+        Extensions::Clusters::ClusterTypes::get().DynamicForwardProxy));
+  }
+
+  Extensions::Common::DynamicForwardProxy::DnsCacheManagerFactoryImpl cache_manager_factory(
+      context.singletonManager(), context.dispatcher(), context.tls(), context.stats());
+  return std::make_shared<Cluster>(cluster, proto_config, context.runtime(),
+                                   cache_manager_factory, socket_factory_context,
+                                   std::move(stats_scope), context.addedViaApi());
+}
+
+/**
+ * Static registration for the dynamic forward proxy cluster factory. @see RegisterFactory.
+ */
+REGISTER_FACTORY(ClusterFactory, Upstream::ClusterFactory);
+
+} // namespace DynamicForwardProxy
+} // namespace Clusters
+} // namespace Extensions
+} // namespace Envoy
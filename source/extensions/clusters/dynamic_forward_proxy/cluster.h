@@ -0,0 +1,157 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/config/cluster/dynamic_forward_proxy/v2alpha/cluster.pb.h"
+#include "envoy/config/cluster/dynamic_forward_proxy/v2alpha/cluster.pb.validate.h"
+
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+#include "common/upstream/cluster_factory_impl.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "extensions/clusters/well_known_names.h"
+#include "extensions/common/dynamic_forward_proxy/dns_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Clusters {
+namespace DynamicForwardProxy {
+
+/**
+ * A cluster whose hosts are the hosts of a dynamic forward proxy DNS cache. Hosts are added when
+ * the cache resolves them, which the dynamic forward proxy HTTP filter triggers for the Host header
+ * of each request, and removed when the cache purges or evicts them. Requests are routed to the
+ * host matching their Host header, each with its own connection pools.
+ */
+class Cluster : public Upstream::ClusterImplBase,
+                public Extensions::Common::DynamicForwardProxy::DnsCache::UpdateCallbacks {
+public:
+  Cluster(const envoy::api::v2::Cluster& cluster,
+          const envoy::config::cluster::dynamic_forward_proxy::v2alpha::ClusterConfig& config,
+          Runtime::Loader& runtime,
+          Extensions::Common::DynamicForwardProxy::DnsCacheManagerFactory& cache_manager_factory,
+          Server::Configuration::TransportSocketFactoryContext& factory_context,
+          Stats::ScopePtr&& stats_scope, bool added_via_api);
+
+  // Upstream::Cluster
+  Upstream::Cluster::InitializePhase initializePhase() const override {
+    return Upstream::Cluster::InitializePhase::Primary;
+  }
+  Upstream::ThreadAwareLoadBalancerPtr createThreadAwareLoadBalancer() override;
+
+  // Extensions::Common::DynamicForwardProxy::DnsCache::UpdateCallbacks
+  void onDnsHostAddOrUpdate(
+      const std::string& host,
+      const Extensions::Common::DynamicForwardProxy::DnsHostInfoSharedPtr& host_info) override;
+  void onDnsHostRemove(const std::string& host) override;
+
+private:
+  struct HostInfo {
+    HostInfo(const Extensions::Common::DynamicForwardProxy::DnsHostInfoSharedPtr& shared_host_info,
+             const Upstream::HostSharedPtr& host)
+        : shared_host_info_(shared_host_info), host_(host) {}
+
+    const Extensions::Common::DynamicForwardProxy::DnsHostInfoSharedPtr shared_host_info_;
+    const Upstream::HostSharedPtr host_;
+  };
+
+  typedef std::unordered_map<std::string, HostInfo> HostInfoMap;
+  typedef std::shared_ptr<const HostInfoMap> HostInfoMapConstSharedPtr;
+
+  // The current host map, which the main thread replaces on every change. It is shared with the
+  // load balancer factory, which may outlive the cluster on the workers.
+  class SharedHostMap {
+  public:
+    HostInfoMapConstSharedPtr get() {
+      Thread::LockGuard lock(lock_);
+      return host_map_;
+    }
+    void set(HostInfoMapConstSharedPtr host_map) {
+      Thread::LockGuard lock(lock_);
+      host_map_ = std::move(host_map);
+    }
+
+  private:
+    Thread::MutexBasicLockable lock_;
+    HostInfoMapConstSharedPtr host_map_ GUARDED_BY(lock_){std::make_shared<const HostInfoMap>()};
+  };
+
+  typedef std::shared_ptr<SharedHostMap> SharedHostMapSharedPtr;
+
+  // A worker local load balancer that picks the host matching the request's Host header. It works
+  // on a snapshot of the host map taken when it is created, which happens on every membership
+  // update of the worker's copy of the cluster, so that choosing a host never takes a lock.
+  class LoadBalancer : public Upstream::LoadBalancer {
+  public:
+    LoadBalancer(HostInfoMapConstSharedPtr host_map) : host_map_(std::move(host_map)) {}
+
+    // Upstream::LoadBalancer
+    Upstream::HostConstSharedPtr chooseHost(Upstream::LoadBalancerContext* context) override;
+
+  private:
+    const HostInfoMapConstSharedPtr host_map_;
+  };
+
+  class LoadBalancerFactory : public Upstream::LoadBalancerFactory {
+  public:
+    LoadBalancerFactory(SharedHostMapSharedPtr host_map) : host_map_(std::move(host_map)) {}
+
+    // Upstream::LoadBalancerFactory
+    Upstream::LoadBalancerPtr create() override {
+      return std::make_unique<LoadBalancer>(host_map_->get());
+    }
+
+  private:
+    const SharedHostMapSharedPtr host_map_;
+  };
+
+  class ThreadAwareLoadBalancer : public Upstream::ThreadAwareLoadBalancer {
+  public:
+    ThreadAwareLoadBalancer(SharedHostMapSharedPtr host_map)
+        : factory_(std::make_shared<LoadBalancerFactory>(std::move(host_map))) {}
+
+    // Upstream::ThreadAwareLoadBalancer
+    Upstream::LoadBalancerFactorySharedPtr factory() override { return factory_; }
+    void initialize() override {}
+
+  private:
+    const Upstream::LoadBalancerFactorySharedPtr factory_;
+  };
+
+  // Upstream::ClusterImplBase
+  void startPreInit() override;
+
+  void updatePriorityState(const Upstream::HostVector& hosts_added,
+                           const Upstream::HostVector& hosts_removed);
+
+  const Extensions::Common::DynamicForwardProxy::DnsCacheManagerSharedPtr dns_cache_manager_;
+  const Extensions::Common::DynamicForwardProxy::DnsCacheSharedPtr dns_cache_;
+  Extensions::Common::DynamicForwardProxy::DnsCache::AddUpdateCallbacksHandlePtr
+      update_callbacks_handle_;
+  const SharedHostMapSharedPtr host_map_{std::make_shared<SharedHostMap>()};
+};
+
+class ClusterFactory : public Upstream::ConfigurableClusterFactoryBase<
+                           envoy::config::cluster::dynamic_forward_proxy::v2alpha::ClusterConfig> {
+public:
+  ClusterFactory()
+      : ConfigurableClusterFactoryBase(
+            Extensions::Clusters::ClusterTypes::get().DynamicForwardProxy) {}
+
+private:
+  Upstream::ClusterImplBaseSharedPtr createClusterWithConfig(
+      const envoy::api::v2::Cluster& cluster,
+      const envoy::config::cluster::dynamic_forward_proxy::v2alpha::ClusterConfig& proto_config,
+      Upstream::ClusterFactoryContext& context,
+      Server::Configuration::TransportSocketFactoryContext& socket_factory_context,
+      Stats::ScopePtr&& stats_scope) override;
+};
+
+} // namespace DynamicForwardProxy
+} // namespace Clusters
+} // namespace Extensions
+} // namespace Envoy
@@ -28,6 +28,10 @@ public:
   // Original destination (dynamic cluster that automatically adds hosts as needed based on the
   // original destination address of the downstream connection).
   const std::string OriginalDst = "envoy.cluster.original_dst";
+
+  // Dynamic forward proxy (dynamic cluster whose hosts are resolved on demand from the Host header
+  // of the requests through a shared DNS cache).
+  const std::string DynamicForwardProxy = "envoy.clusters.dynamic_forward_proxy";
 };
 
 using ClusterTypes = ConstSingleton<ClusterTypeValues>;
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "envoy/config/common/dynamic_forward_proxy/v2alpha/dns_cache.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/network/address.h"
+#include "envoy/singleton/manager.h"
+#include "envoy/stats/scope.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace DynamicForwardProxy {
+
+/**
+ * A cached DNS host.
+ */
+class DnsHostInfo {
+public:
+  virtual ~DnsHostInfo() {}
+
+  /**
+   * Returns the host's currently resolved address. This address may change periodically due to
+   * async re-resolution.
+   * @return Network::Address::InstanceConstSharedPtr the address, or nullptr if the last
+   *         resolution of the host failed.
+   */
+  virtual Network::Address::InstanceConstSharedPtr address() PURE;
+
+  /**
+   * Returns the host that was actually resolved via DNS. If port was originally specified it will
+   * be stripped from this return value.
+   */
+  virtual const std::string& resolvedHost() PURE;
+
+  /**
+   * Indicates that the host has been used and should not be purged depending on any configured
+   * TTL policy, or evicted as the least recently used host.
+   */
+  virtual void touch() PURE;
+};
+
+typedef std::shared_ptr<DnsHostInfo> DnsHostInfoSharedPtr;
+
+/**
+ * A DNS cache that persists resolved hosts for the lifetime of the configured host TTL and resolves
+ * them again periodically. The cache is shared by all the workers, and is safe to use from any
+ * worker, while resolution happens on the main thread.
+ */
+class DnsCache {
+public:
+  /**
+   * Callbacks used in the loadDnsCacheEntry() method.
+   */
+  class LoadDnsCacheEntryCallbacks {
+  public:
+    virtual ~LoadDnsCacheEntryCallbacks() {}
+
+    /**
+     * Called when the DNS cache load is complete, whether the host could be resolved or not. The
+     * callback is invoked on the worker that called loadDnsCacheEntry().
+     */
+    virtual void onLoadDnsCacheComplete() PURE;
+  };
+
+  /**
+   * Handle returned from loadDnsCacheEntry(). Destruction of the handle will cancel any future
+   * callback.
+   */
+  class LoadDnsCacheEntryHandle {
+  public:
+    virtual ~LoadDnsCacheEntryHandle() {}
+  };
+
+  typedef std::unique_ptr<LoadDnsCacheEntryHandle> LoadDnsCacheEntryHandlePtr;
+
+  /**
+   * Update callbacks that can be registered in the addUpdateCallbacks() method. These callbacks
+   * are invoked on the main thread.
+   */
+  class UpdateCallbacks {
+  public:
+    virtual ~UpdateCallbacks() {}
+
+    /**
+     * Called when a host has been added or has had its address updated.
+     * @param host supplies the added/updated host.
+     * @param host_info supplies the associated host info.
+     */
+    virtual void onDnsHostAddOrUpdate(const std::string& host,
+                                      const DnsHostInfoSharedPtr& host_info) PURE;
+
+    /**
+     * Called when a host has been removed, either because it expired or because it was the least
+     * recently used host when the cache was full.
+     * @param host supplies the removed host.
+     */
+    virtual void onDnsHostRemove(const std::string& host) PURE;
+  };
+
+  /**
+   * Handle returned from addUpdateCallbacks(). Destruction of the handle will remove the
+   * registered callbacks.
+   */
+  class AddUpdateCallbacksHandle {
+  public:
+    virtual ~AddUpdateCallbacksHandle() {}
+  };
+
+  typedef std::unique_ptr<AddUpdateCallbacksHandle> AddUpdateCallbacksHandlePtr;
+
+  virtual ~DnsCache() {}
+
+  /**
+   * The status of a loadDnsCacheEntry() call.
+   */
+  enum class LoadDnsCacheEntryStatus {
+    // The cache entry is already loaded. There will be no callback invoked.
+    InCache,
+    // The cache entry is loading. A callback will be invoked when loading is complete.
+    Loading
+  };
+
+  /**
+   * The result of a loadDnsCacheEntry() call.
+   * @param status supplies the cache status.
+   * @param handle supplies the cancel handle. If status is InCache this will be nullptr and the
+   *        callback will not be called.
+   */
+  struct LoadDnsCacheEntryResult {
+    LoadDnsCacheEntryStatus status_;
+    LoadDnsCacheEntryHandlePtr handle_;
+  };
+
+  /**
+   * Attempt to load a DNS cache entry. This must be called from a worker thread.
+   * @param host supplies the host to load. Hosts are cached inclusive of port, even though the
+   *        port will be stripped during resolution. This means that 'a.b.c' and 'a.b.c:9001' will
+   *        both resolve 'a.b.c' but will generate different host entries with different target
+   *        ports.
+   * @param default_port supplies the port to use if the host does not have a port embedded in it.
+   * @param callbacks supplies the cache load callbacks to invoke if async processing is needed.
+   * @return a cache load result which includes both a status and handle. If the handle is non-null
+   *         the callbacks will be invoked at a later time, otherwise consult the status for the
+   *         reason the cache is not loading.
+   */
+  virtual LoadDnsCacheEntryResult loadDnsCacheEntry(absl::string_view host, uint16_t default_port,
+                                                    LoadDnsCacheEntryCallbacks& callbacks) PURE;
+
+  /**
+   * Add update callbacks to the cache. The callbacks are invoked right away for the hosts that are
+   * already in the cache. This must be called from the main thread.
+   * @param callbacks supplies the callbacks to add.
+   * @return a handle that on destruction will de-register the callbacks.
+   */
+  virtual AddUpdateCallbacksHandlePtr addUpdateCallbacks(UpdateCallbacks& callbacks) PURE;
+};
+
+typedef std::shared_ptr<DnsCache> DnsCacheSharedPtr;
+
+/**
+ * A manager for multiple independent DNS caches.
+ */
+class DnsCacheManager {
+public:
+  virtual ~DnsCacheManager() {}
+
+  /**
+   * Get a DNS cache.
+   * @param config supplies the cache parameters. If a cache exists with the same parameters it
+   *               will be returned, otherwise a new one will be created.
+   * @return DnsCacheSharedPtr the cache.
+   * @throw EnvoyException if a cache with the same name but different parameters exists.
+   */
+  virtual DnsCacheSharedPtr getCache(
+      const envoy::config::common::dynamic_forward_proxy::v2alpha::DnsCacheConfig& config) PURE;
+};
+
+typedef std::shared_ptr<DnsCacheManager> DnsCacheManagerSharedPtr;
+
+/**
+ * Factory for getting a DNS cache manager.
+ */
+class DnsCacheManagerFactory {
+public:
+  virtual ~DnsCacheManagerFactory() {}
+
+  /**
+   * Get a DNS cache manager.
+   * @return the manager.
+   */
+  virtual DnsCacheManagerSharedPtr get() PURE;
+};
+
+} // namespace DynamicForwardProxy
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
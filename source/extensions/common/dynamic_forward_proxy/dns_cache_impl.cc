@@ -0,0 +1,323 @@
+#include "extensions/common/dynamic_forward_proxy/dns_cache_impl.h"
+
+#include "common/common/assert.h"
+#include "common/common/utility.h"
+#include "common/network/utility.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace DynamicForwardProxy {
+
+namespace {
+
+Network::DnsLookupFamily
+getDnsLookupFamily(envoy::api::v2::Cluster::DnsLookupFamily dns_lookup_family) {
+  switch (dns_lookup_family) {
+  case envoy::api::v2::Cluster::V6_ONLY:
+    return Network::DnsLookupFamily::V6Only;
+  case envoy::api::v2::Cluster::V4_ONLY:
+    return Network::DnsLookupFamily::V4Only;
+  case envoy::api::v2::Cluster::AUTO:
+    return Network::DnsLookupFamily::Auto;
+  default:
+    NOT_REACHED_GCOVR_EXCL_LINE;
+  }
+}
+
+// Split a host into the name to resolve and the port to connect to. Hosts without a valid port
+// use the default port, and IPv6 literals are expected in brackets, e.g. "[::1]:80".
+std::pair<absl::string_view, uint16_t> splitHostAndPort(absl::string_view host,
+                                                        uint16_t default_port) {
+  absl::string_view host_to_resolve = host;
+  absl::string_view port_str;
+  if (!host.empty() && host.front() == '[') {
+    const size_t close_pos = host.find(']');
+    if (close_pos != absl::string_view::npos) {
+      host_to_resolve = host.substr(1, close_pos - 1);
+      if (close_pos + 1 < host.size() && host[close_pos + 1] == ':') {
+        port_str = host.substr(close_pos + 2);
+      }
+    }
+  } else {
+    const size_t colon_pos = host.rfind(':');
+    if (colon_pos != absl::string_view::npos) {
+      host_to_resolve = host.substr(0, colon_pos);
+      port_str = host.substr(colon_pos + 1);
+    }
+  }
+
+  uint64_t port = default_port;
+  if (!port_str.empty() && (!StringUtil::atoull(std::string(port_str).c_str(), port) ||
+                            port == 0 || port > 65535)) {
+    // Just attempt to resolve whatever we were given. This will very likely fail.
+    return {host, default_port};
+  }
+  return {host_to_resolve, static_cast<uint16_t>(port)};
+}
+
+} // namespace
+
+DnsCacheImpl::DnsCacheImpl(
+    Event::Dispatcher& main_thread_dispatcher, ThreadLocal::SlotAllocator& tls,
+    Stats::Scope& root_scope,
+    const envoy::config::common::dynamic_forward_proxy::v2alpha::DnsCacheConfig& config)
+    : main_thread_dispatcher_(main_thread_dispatcher),
+      dns_lookup_family_(getDnsLookupFamily(config.dns_lookup_family())),
+      resolver_(main_thread_dispatcher.createDnsResolver({})), tls_slot_(tls.allocateSlot()),
+      scope_(root_scope.createScope(
+          fmt::format("dynamic_forward_proxy.dns_cache.{}.", config.name()))),
+      stats_{ALL_DNS_CACHE_STATS(POOL_COUNTER(*scope_), POOL_GAUGE(*scope_))},
+      refresh_interval_(
+          PROTOBUF_GET_MS_OR_DEFAULT(config, dns_refresh_rate, DefaultRefreshIntervalMs)),
+      host_ttl_(PROTOBUF_GET_MS_OR_DEFAULT(config, host_ttl, DefaultHostTtlMs)),
+      max_hosts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_hosts, DefaultMaxHosts)) {
+  tls_slot_->set([](Event::Dispatcher&) { return std::make_shared<ThreadLocalHostInfo>(); });
+}
+
+DnsCacheImpl::~DnsCacheImpl() {
+  // The hosts cancel their queries in flight when destroyed.
+  stats_.num_hosts_.sub(primary_hosts_.size());
+}
+
+DnsCacheImpl::LoadDnsCacheEntryResult
+DnsCacheImpl::loadDnsCacheEntry(absl::string_view host, uint16_t default_port,
+                                LoadDnsCacheEntryCallbacks& callbacks) {
+  ENVOY_LOG(debug, "thread local lookup for host '{}'", host);
+  ThreadLocalHostInfo& tls_host_info = tls_slot_->getTyped<ThreadLocalHostInfo>();
+  auto tls_host = tls_host_info.host_map_->find(std::string(host));
+  if (tls_host != tls_host_info.host_map_->end()) {
+    ENVOY_LOG(debug, "thread local hit for host '{}'", host);
+    tls_host->second->touch();
+    return {LoadDnsCacheEntryStatus::InCache, nullptr};
+  }
+
+  ENVOY_LOG(debug, "thread local miss for host '{}', posting to main thread", host);
+  // The cache may be gone by the time the main thread runs the load.
+  std::weak_ptr<DnsCacheImpl> weak_this = shared_from_this();
+  main_thread_dispatcher_.post([weak_this, host = std::string(host), default_port]() {
+    if (std::shared_ptr<DnsCacheImpl> cache = weak_this.lock()) {
+      cache->startCacheLoad(host, default_port);
+    }
+  });
+  return {LoadDnsCacheEntryStatus::Loading, std::make_unique<LoadDnsCacheEntryHandleImpl>(
+                                                tls_host_info.pending_resolutions_, host,
+                                                callbacks)};
+}
+
+DnsCacheImpl::AddUpdateCallbacksHandlePtr
+DnsCacheImpl::addUpdateCallbacks(UpdateCallbacks& callbacks) {
+  for (const auto& primary_host : primary_hosts_) {
+    const Network::Address::InstanceConstSharedPtr address =
+        primary_host.second->host_info_->address();
+    if (address != nullptr) {
+      callbacks.onDnsHostAddOrUpdate(primary_host.first, primary_host.second->host_info_);
+    }
+  }
+  return std::make_unique<AddUpdateCallbacksHandleImpl>(update_callbacks_, callbacks);
+}
+
+void DnsCacheImpl::startCacheLoad(const std::string& host, uint16_t default_port) {
+  // It's possible for multiple requests to race trying to start a resolution. If a host is
+  // already in the map it's either in the process of being resolved or the resolution is already
+  // heading out to the worker threads. Either way the pending resolution will be completed.
+  if (primary_hosts_.find(host) != primary_hosts_.end()) {
+    ENVOY_LOG(debug, "main thread resolve for host '{}' skipped. Entry present", host);
+    return;
+  }
+
+  if (primary_hosts_.size() >= max_hosts_) {
+    evictLeastRecentlyUsedHost();
+  }
+
+  const auto host_and_port = splitHostAndPort(host, default_port);
+  // The same name with different ports becomes independent primary hosts, each with its own DNS
+  // resolution.
+  PrimaryHostInfo& primary_host =
+      *primary_hosts_
+           .emplace(host, std::make_unique<PrimaryHostInfo>(
+                              *this, host_and_port.first, host_and_port.second,
+                              [this, host]() -> void { onReResolve(host); }))
+           .first->second;
+  stats_.host_added_.inc();
+  stats_.num_hosts_.inc();
+  startResolve(host, primary_host);
+}
+
+void DnsCacheImpl::evictLeastRecentlyUsedHost() {
+  // The hosts being resolved have requests waiting on them, so they are never evicted. The scan
+  // only happens when the cache is full and a new host comes in, and is bounded by the cache size.
+  auto least_recently_used = primary_hosts_.end();
+  for (auto it = primary_hosts_.begin(); it != primary_hosts_.end(); ++it) {
+    if (it->second->active_query_ == nullptr &&
+        (least_recently_used == primary_hosts_.end() ||
+         it->second->host_info_->lastUsedTime() <
+             least_recently_used->second->host_info_->lastUsedTime())) {
+      least_recently_used = it;
+    }
+  }
+
+  if (least_recently_used == primary_hosts_.end()) {
+    ENVOY_LOG(debug, "DNS cache full with all hosts being resolved, exceeding max hosts {}",
+              max_hosts_);
+    stats_.host_overflow_.inc();
+    return;
+  }
+
+  ENVOY_LOG(debug, "evicting least recently used host '{}'", least_recently_used->first);
+  stats_.host_evicted_.inc();
+  // Copy the host, as removing it destroys the map entry.
+  removeHost(std::string(least_recently_used->first));
+}
+
+void DnsCacheImpl::startResolve(const std::string& host, PrimaryHostInfo& host_info) {
+  ENVOY_LOG(debug, "starting main thread resolve for host='{}' dns='{}' port='{}'", host,
+            host_info.host_info_->resolvedHost(), host_info.port_);
+  ASSERT(host_info.active_query_ == nullptr);
+
+  stats_.dns_query_attempt_.inc();
+  host_info.active_query_ =
+      resolver_->resolve(host_info.host_info_->resolvedHost(), dns_lookup_family_,
+                         [this, host](const std::list<Network::Address::InstanceConstSharedPtr>&&
+                                          address_list) { finishResolve(host, address_list); });
+}
+
+void DnsCacheImpl::finishResolve(
+    const std::string& host,
+    const std::list<Network::Address::InstanceConstSharedPtr>& address_list) {
+  ENVOY_LOG(debug, "main thread resolve complete for host '{}'. {} results", host,
+            address_list.size());
+  const auto primary_host_it = primary_hosts_.find(host);
+  ASSERT(primary_host_it != primary_hosts_.end());
+
+  PrimaryHostInfo& primary_host_info = *primary_host_it->second;
+  primary_host_info.active_query_ = nullptr;
+  const bool first_resolve = !primary_host_info.host_info_->first_resolve_complete_;
+  primary_host_info.host_info_->first_resolve_complete_ = true;
+
+  const Network::Address::InstanceConstSharedPtr new_address =
+      !address_list.empty()
+          ? Network::Utility::getAddressWithPort(*address_list.front(), primary_host_info.port_)
+          : nullptr;
+  if (new_address == nullptr) {
+    stats_.dns_query_failure_.inc();
+  } else {
+    stats_.dns_query_success_.inc();
+  }
+
+  // A failed re-resolution keeps the last known address.
+  const Network::Address::InstanceConstSharedPtr current_address =
+      primary_host_info.host_info_->address();
+  bool address_changed = false;
+  if (new_address != nullptr && (current_address == nullptr || *current_address != *new_address)) {
+    ENVOY_LOG(debug, "host '{}' address has changed to {}", host, new_address->asString());
+    primary_host_info.host_info_->setAddress(new_address);
+    stats_.host_address_changed_.inc();
+    address_changed = true;
+    for (UpdateCallbacks* callbacks : update_callbacks_) {
+      callbacks->onDnsHostAddOrUpdate(host, primary_host_info.host_info_);
+    }
+  }
+
+  // The first resolution completes the loads waiting on the workers, even if it failed, so that
+  // the requests fail instead of waiting until the next resolution.
+  if (first_resolve || address_changed) {
+    updateTlsHostsMap();
+  }
+
+  primary_host_info.refresh_timer_->enableTimer(refresh_interval_);
+}
+
+void DnsCacheImpl::onReResolve(const std::string host) {
+  const auto primary_host_it = primary_hosts_.find(host);
+  ASSERT(primary_host_it != primary_hosts_.end());
+
+  const MonotonicTime::duration now_duration =
+      main_thread_dispatcher_.timeSource().monotonicTime().time_since_epoch();
+  ENVOY_LOG(debug, "host='{}' TTL check: now={} last_used={}", host, now_duration.count(),
+            primary_host_it->second->host_info_->lastUsedTime().count());
+  if (now_duration - primary_host_it->second->host_info_->lastUsedTime() > host_ttl_) {
+    ENVOY_LOG(debug, "host='{}' TTL expired, removing", host);
+    removeHost(host);
+  } else {
+    startResolve(host, *primary_host_it->second);
+  }
+}
+
+void DnsCacheImpl::removeHost(const std::string& host) {
+  ASSERT(primary_hosts_.find(host) != primary_hosts_.end());
+  primary_hosts_.erase(host);
+  stats_.host_removed_.inc();
+  stats_.num_hosts_.dec();
+  for (UpdateCallbacks* callbacks : update_callbacks_) {
+    callbacks->onDnsHostRemove(host);
+  }
+  updateTlsHostsMap();
+}
+
+void DnsCacheImpl::updateTlsHostsMap() {
+  std::shared_ptr<TlsHostMap> new_host_map = std::make_shared<TlsHostMap>();
+  for (const auto& primary_host : primary_hosts_) {
+    // Do not include hosts that have not resolved at least once.
+    if (primary_host.second->host_info_->first_resolve_complete_) {
+      new_host_map->emplace(primary_host.first, primary_host.second->host_info_);
+    }
+  }
+
+  TlsHostMapConstSharedPtr const_host_map = std::move(new_host_map);
+  tls_slot_->runOnAllThreads([this, const_host_map]() -> void {
+    tls_slot_->getTyped<ThreadLocalHostInfo>().updateHostMap(const_host_map);
+  });
+}
+
+DnsCacheImpl::ThreadLocalHostInfo::~ThreadLocalHostInfo() {
+  // Handles may outlive the worker's copy of the cache during shutdown. Detach them so that they
+  // do not touch the list when destroyed.
+  for (LoadDnsCacheEntryHandleImpl* pending_resolution : pending_resolutions_) {
+    pending_resolution->list_ = nullptr;
+  }
+}
+
+void DnsCacheImpl::ThreadLocalHostInfo::updateHostMap(
+    const TlsHostMapConstSharedPtr& new_host_map) {
+  host_map_ = new_host_map;
+
+  // Move the loads whose host is now present to a local list before invoking any callback, since
+  // the callbacks may destroy other handles, e.g. by resetting other streams.
+  PendingResolutionList ready;
+  for (auto it = pending_resolutions_.begin(); it != pending_resolutions_.end();) {
+    auto next = std::next(it);
+    if (host_map_->count((*it)->host_) != 0) {
+      (*it)->list_ = &ready;
+      ready.splice(ready.end(), pending_resolutions_, it);
+    }
+    it = next;
+  }
+
+  while (!ready.empty()) {
+    LoadDnsCacheEntryHandleImpl* handle = ready.front();
+    ready.pop_front();
+    handle->list_ = nullptr;
+    handle->callbacks_.onLoadDnsCacheComplete();
+  }
+}
+
+DnsCacheImpl::PrimaryHostInfo::PrimaryHostInfo(DnsCacheImpl& parent,
+                                               absl::string_view host_to_resolve, uint16_t port,
+                                               const Event::TimerCb& timer_cb)
+    : port_(port),
+      refresh_timer_(parent.main_thread_dispatcher_.createTimer(timer_cb)),
+      host_info_(std::make_shared<DnsHostInfoImpl>(parent.main_thread_dispatcher_.timeSource(),
+                                                   host_to_resolve)) {}
+
+DnsCacheImpl::PrimaryHostInfo::~PrimaryHostInfo() {
+  if (active_query_ != nullptr) {
+    active_query_->cancel();
+  }
+}
+
+} // namespace DynamicForwardProxy
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
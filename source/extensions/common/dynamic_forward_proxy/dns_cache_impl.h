@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/common/time.h"
+#include "envoy/network/dns.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/lock_guard.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "extensions/common/dynamic_forward_proxy/dns_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace DynamicForwardProxy {
+
+/**
+ * All DNS cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_DNS_CACHE_STATS(COUNTER, GAUGE)                                                        \
+  COUNTER(dns_query_attempt)                                                                       \
+  COUNTER(dns_query_failure)                                                                       \
+  COUNTER(dns_query_success)                                                                       \
+  COUNTER(host_added)                                                                              \
+  COUNTER(host_address_changed)                                                                    \
+  COUNTER(host_evicted)                                                                            \
+  COUNTER(host_overflow)                                                                           \
+  COUNTER(host_removed)                                                                            \
+  GAUGE  (num_hosts)
+// clang-format on
+
+/**
+ * Struct definition for all DNS cache stats. @see stats_macros.h
+ */
+struct DnsCacheStats {
+  ALL_DNS_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * The DNS cache of the dynamic forward proxy. The primary copy of the hosts, their resolution and
+ * their eviction live on the main thread. Each worker has a read-only copy of the map of the hosts
+ * that resolved at least once, which is replaced by the main thread on every change, so that
+ * lookups on the workers never block. Cache misses are posted to the main thread, and the workers
+ * complete the loads waiting on a host when the host shows up in their copy of the map.
+ */
+class DnsCacheImpl : public DnsCache,
+                     public std::enable_shared_from_this<DnsCacheImpl>,
+                     Logger::Loggable<Logger::Id::forward_proxy> {
+public:
+  DnsCacheImpl(Event::Dispatcher& main_thread_dispatcher, ThreadLocal::SlotAllocator& tls,
+               Stats::Scope& root_scope,
+               const envoy::config::common::dynamic_forward_proxy::v2alpha::DnsCacheConfig& config);
+  ~DnsCacheImpl();
+
+  static constexpr uint64_t DefaultRefreshIntervalMs = 60000;
+  static constexpr uint64_t DefaultHostTtlMs = 300000;
+  static constexpr uint32_t DefaultMaxHosts = 1024;
+
+  // DnsCache
+  LoadDnsCacheEntryResult loadDnsCacheEntry(absl::string_view host, uint16_t default_port,
+                                            LoadDnsCacheEntryCallbacks& callbacks) override;
+  AddUpdateCallbacksHandlePtr addUpdateCallbacks(UpdateCallbacks& callbacks) override;
+
+private:
+  typedef std::unordered_map<std::string, DnsHostInfoSharedPtr> TlsHostMap;
+  typedef std::shared_ptr<const TlsHostMap> TlsHostMapConstSharedPtr;
+
+  struct LoadDnsCacheEntryHandleImpl;
+  typedef std::list<LoadDnsCacheEntryHandleImpl*> PendingResolutionList;
+
+  // A load waiting on a worker for its host to show up in the worker's host map. The handle
+  // removes itself from the list it is in when destroyed.
+  struct LoadDnsCacheEntryHandleImpl : public LoadDnsCacheEntryHandle {
+    LoadDnsCacheEntryHandleImpl(PendingResolutionList& list, absl::string_view host,
+                                LoadDnsCacheEntryCallbacks& callbacks)
+        : list_(&list), iterator_(list.insert(list.end(), this)), host_(host),
+          callbacks_(callbacks) {}
+    ~LoadDnsCacheEntryHandleImpl() {
+      if (list_ != nullptr) {
+        list_->erase(iterator_);
+      }
+    }
+
+    // The list the handle is in, or nullptr once its callback was invoked.
+    PendingResolutionList* list_;
+    PendingResolutionList::iterator iterator_;
+    const std::string host_;
+    LoadDnsCacheEntryCallbacks& callbacks_;
+  };
+
+  struct ThreadLocalHostInfo : public ThreadLocal::ThreadLocalObject {
+    ~ThreadLocalHostInfo();
+    void updateHostMap(const TlsHostMapConstSharedPtr& new_host_map);
+
+    TlsHostMapConstSharedPtr host_map_{std::make_shared<const TlsHostMap>()};
+    PendingResolutionList pending_resolutions_;
+  };
+
+  struct AddUpdateCallbacksHandleImpl : public AddUpdateCallbacksHandle {
+    AddUpdateCallbacksHandleImpl(std::list<UpdateCallbacks*>& list, UpdateCallbacks& callbacks)
+        : list_(list), iterator_(list.insert(list.end(), &callbacks)) {}
+    ~AddUpdateCallbacksHandleImpl() { list_.erase(iterator_); }
+
+    std::list<UpdateCallbacks*>& list_;
+    const std::list<UpdateCallbacks*>::iterator iterator_;
+  };
+
+  class DnsHostInfoImpl : public DnsHostInfo {
+  public:
+    DnsHostInfoImpl(TimeSource& time_source, absl::string_view resolved_host)
+        : time_source_(time_source), resolved_host_(resolved_host) {
+      touch();
+    }
+
+    // DnsHostInfo
+    Network::Address::InstanceConstSharedPtr address() override {
+      Thread::LockGuard lock(address_lock_);
+      return address_;
+    }
+    const std::string& resolvedHost() override { return resolved_host_; }
+    void touch() override { last_used_time_ = time_source_.monotonicTime().time_since_epoch(); }
+
+    void setAddress(Network::Address::InstanceConstSharedPtr address) {
+      Thread::LockGuard lock(address_lock_);
+      address_ = std::move(address);
+    }
+    MonotonicTime::duration lastUsedTime() const { return last_used_time_.load(); }
+
+    // Main thread only.
+    bool first_resolve_complete_{};
+
+  private:
+    TimeSource& time_source_;
+    const std::string resolved_host_;
+    Thread::MutexBasicLockable address_lock_;
+    Network::Address::InstanceConstSharedPtr address_ GUARDED_BY(address_lock_);
+    // Touched by the workers, read by the main thread for expiry and eviction.
+    std::atomic<MonotonicTime::duration> last_used_time_;
+  };
+
+  typedef std::shared_ptr<DnsHostInfoImpl> DnsHostInfoImplSharedPtr;
+
+  // Primary host information that accounts for TTL, re-resolution, etc.
+  struct PrimaryHostInfo {
+    PrimaryHostInfo(DnsCacheImpl& parent, absl::string_view host_to_resolve, uint16_t port,
+                    const Event::TimerCb& timer_cb);
+    ~PrimaryHostInfo();
+
+    const uint16_t port_;
+    const Event::TimerPtr refresh_timer_;
+    const DnsHostInfoImplSharedPtr host_info_;
+    Network::ActiveDnsQuery* active_query_{};
+  };
+
+  typedef std::unique_ptr<PrimaryHostInfo> PrimaryHostInfoPtr;
+
+  void startCacheLoad(const std::string& host, uint16_t default_port);
+  void startResolve(const std::string& host, PrimaryHostInfo& host_info);
+  void finishResolve(const std::string& host,
+                     const std::list<Network::Address::InstanceConstSharedPtr>& address_list);
+  // Takes the host by value, since removing the host destroys the timer callback that owns it.
+  void onReResolve(const std::string host);
+  void evictLeastRecentlyUsedHost();
+  void removeHost(const std::string& host);
+  void updateTlsHostsMap();
+
+  Event::Dispatcher& main_thread_dispatcher_;
+  const Network::DnsLookupFamily dns_lookup_family_;
+  const Network::DnsResolverSharedPtr resolver_;
+  const ThreadLocal::SlotPtr tls_slot_;
+  Stats::ScopePtr scope_;
+  DnsCacheStats stats_;
+  std::list<UpdateCallbacks*> update_callbacks_;
+  std::unordered_map<std::string, PrimaryHostInfoPtr> primary_hosts_;
+  const std::chrono::milliseconds refresh_interval_;
+  const std::chrono::milliseconds host_ttl_;
+  const uint32_t max_hosts_;
+};
+
+} // namespace DynamicForwardProxy
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
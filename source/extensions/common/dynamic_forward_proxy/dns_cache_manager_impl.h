@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "envoy/config/common/dynamic_forward_proxy/v2alpha/dns_cache.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/singleton/manager.h"
+#include "envoy/stats/scope.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "extensions/common/dynamic_forward_proxy/dns_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace DynamicForwardProxy {
+
+/**
+ * Singleton that owns the named DNS caches, so that the dynamic forward proxy filters and clusters
+ * configured with the same cache name share a single cache.
+ */
+class DnsCacheManagerImpl : public DnsCacheManager, public Singleton::Instance {
+public:
+  DnsCacheManagerImpl(Event::Dispatcher& main_thread_dispatcher, ThreadLocal::SlotAllocator& tls,
+                      Stats::Scope& root_scope)
+      : main_thread_dispatcher_(main_thread_dispatcher), tls_(tls), root_scope_(root_scope) {}
+
+  // DnsCacheManager
+  DnsCacheSharedPtr getCache(
+      const envoy::config::common::dynamic_forward_proxy::v2alpha::DnsCacheConfig& config) override;
+
+private:
+  struct ActiveCache {
+    ActiveCache(const envoy::config::common::dynamic_forward_proxy::v2alpha::DnsCacheConfig& config,
+                DnsCacheSharedPtr cache)
+        : config_(config), cache_(cache) {}
+
+    const envoy::config::common::dynamic_forward_proxy::v2alpha::DnsCacheConfig config_;
+    const DnsCacheSharedPtr cache_;
+  };
+
+  Event::Dispatcher& main_thread_dispatcher_;
+  ThreadLocal::SlotAllocator& tls_;
+  Stats::Scope& root_scope_;
+  std::unordered_map<std::string, ActiveCache> caches_;
+};
+
+class DnsCacheManagerFactoryImpl : public DnsCacheManagerFactory {
+public:
+  DnsCacheManagerFactoryImpl(Singleton::Manager& singleton_manager, Event::Dispatcher& dispatcher,
+                             ThreadLocal::SlotAllocator& tls, Stats::Scope& root_scope)
+      : singleton_manager_(singleton_manager), dispatcher_(dispatcher), tls_(tls),
+        root_scope_(root_scope) {}
+
+  // DnsCacheManagerFactory
+  DnsCacheManagerSharedPtr get() override;
+
+private:
+  Singleton::Manager& singleton_manager_;
+  Event::Dispatcher& dispatcher_;
+  ThreadLocal::SlotAllocator& tls_;
+  Stats::Scope& root_scope_;
+};
+
+} // namespace DynamicForwardProxy
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
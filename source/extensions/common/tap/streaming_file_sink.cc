@@ -0,0 +1,181 @@
+#include "extensions/common/tap/streaming_file_sink.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/logger.h"
+#include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace Tap {
+
+RingBuffer::RingBuffer(uint32_t capacity) : capacity_(capacity), storage_(new char[capacity]) {}
+
+bool RingBuffer::push(absl::string_view record) {
+  const uint64_t head = head_.load(std::memory_order_relaxed);
+  const uint64_t tail = tail_.load(std::memory_order_acquire);
+  if (record.size() > capacity_ - (head - tail)) {
+    dropped_++;
+    return false;
+  }
+
+  const uint32_t offset = head % capacity_;
+  const uint32_t first_length = std::min<uint64_t>(record.size(), capacity_ - offset);
+  memcpy(storage_.get() + offset, record.data(), first_length);
+  memcpy(storage_.get(), record.data() + first_length, record.size() - first_length);
+  head_.store(head + record.size(), std::memory_order_release);
+  return true;
+}
+
+void RingBuffer::drain(std::string& output) {
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  const uint64_t tail = tail_.load(std::memory_order_relaxed);
+  const uint64_t length = head - tail;
+  if (length == 0) {
+    return;
+  }
+
+  const uint32_t offset = tail % capacity_;
+  const uint32_t first_length = std::min<uint64_t>(length, capacity_ - offset);
+  output.append(storage_.get() + offset, first_length);
+  output.append(storage_.get(), length - first_length);
+  tail_.store(head, std::memory_order_release);
+}
+
+constexpr std::chrono::milliseconds StreamingFileSink::DrainInterval;
+
+StreamingFileSink::StreamingFileSink(
+    const envoy::service::tap::v2alpha::StreamingFileSink& config,
+    envoy::service::tap::v2alpha::OutputSink::Format format, Thread::ThreadFactory& thread_factory)
+    : ring_buffer_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, ring_buffer_bytes, 1024 * 1024)),
+      thread_factory_(thread_factory) {
+  if (format == envoy::service::tap::v2alpha::OutputSink::PROTO_BINARY) {
+    throw EnvoyException("streaming file tap sink does not support the PROTO_BINARY format");
+  }
+
+  output_file_.open(config.path(), std::ios::out | std::ios::app | std::ios::binary);
+  if (!output_file_.is_open()) {
+    throw EnvoyException(fmt::format("unable to open tap output file {}", config.path()));
+  }
+  drain_thread_ = thread_factory_.createThread([this]() -> void { drainLoop(); });
+}
+
+StreamingFileSink::~StreamingFileSink() {
+  {
+    Thread::LockGuard lock(lock_);
+    shutdown_ = true;
+    drain_cond_.notifyOne();
+  }
+  drain_thread_->join();
+}
+
+PerTapSinkHandlePtr StreamingFileSink::createPerTapSinkHandle(uint64_t) {
+  return std::make_unique<StreamingFileSinkHandle>(ringBufferForCurrentThread());
+}
+
+uint64_t StreamingFileSink::droppedTraces() {
+  Thread::LockGuard lock(lock_);
+  uint64_t dropped = 0;
+  for (const auto& ring_buffer : ring_buffers_) {
+    dropped += ring_buffer.second->dropped();
+  }
+  return dropped;
+}
+
+RingBuffer& StreamingFileSink::ringBufferForCurrentThread() {
+  // The lock is taken once per tap session, while the traces are pushed without locking.
+  const std::string thread_id = thread_factory_.currentThreadId()->debugString();
+  Thread::LockGuard lock(lock_);
+  std::unique_ptr<RingBuffer>& ring_buffer = ring_buffers_[thread_id];
+  if (ring_buffer == nullptr) {
+    ring_buffer = std::make_unique<RingBuffer>(ring_buffer_bytes_);
+  }
+  return *ring_buffer;
+}
+
+void StreamingFileSink::drainLoop() {
+  while (true) {
+    bool shutdown;
+    {
+      Thread::LockGuard lock(lock_);
+      if (!shutdown_) {
+        drain_cond_.waitFor(lock_, DrainInterval);
+      }
+      shutdown = shutdown_;
+    }
+
+    // The traces pushed before the shutdown are written on the last iteration.
+    drainRingBuffers();
+    if (shutdown) {
+      return;
+    }
+  }
+}
+
+void StreamingFileSink::drainRingBuffers() {
+  std::vector<RingBuffer*> ring_buffers;
+  {
+    Thread::LockGuard lock(lock_);
+    ring_buffers.reserve(ring_buffers_.size());
+    for (const auto& ring_buffer : ring_buffers_) {
+      ring_buffers.push_back(ring_buffer.second.get());
+    }
+  }
+
+  std::string output;
+  uint64_t dropped = 0;
+  for (RingBuffer* ring_buffer : ring_buffers) {
+    ring_buffer->drain(output);
+    dropped += ring_buffer->dropped();
+  }
+
+  if (!output.empty()) {
+    output_file_.write(output.data(), output.size());
+    output_file_.flush();
+  }
+  if (dropped > reported_dropped_) {
+    ENVOY_LOG_MISC(warn, "streaming file tap sink dropped {} traces with full ring buffers",
+                   dropped - reported_dropped_);
+    reported_dropped_ = dropped;
+  }
+}
+
+void StreamingFileSink::StreamingFileSinkHandle::submitTrace(
+    const TraceWrapperSharedPtr& trace, envoy::service::tap::v2alpha::OutputSink::Format format) {
+  std::string record;
+  switch (format) {
+  case envoy::service::tap::v2alpha::OutputSink::PROTO_BINARY_LENGTH_DELIMITED: {
+    Protobuf::io::StringOutputStream stream(&record);
+    Protobuf::io::CodedOutputStream coded_stream(&stream);
+    coded_stream.WriteVarint32(trace->ByteSize());
+    trace->SerializeWithCachedSizes(&coded_stream);
+    break;
+  }
+  case envoy::service::tap::v2alpha::OutputSink::PROTO_TEXT:
+    record = trace->DebugString();
+    break;
+  case envoy::service::tap::v2alpha::OutputSink::JSON_BODY_AS_BYTES:
+  case envoy::service::tap::v2alpha::OutputSink::JSON_BODY_AS_STRING:
+    // One trace per line, so that the file can be consumed as newline delimited JSON.
+    record = MessageUtil::getJsonStringFromMessage(*trace, false, true);
+    record.push_back('\n');
+    break;
+  default:
+    NOT_REACHED_GCOVR_EXCL_LINE;
+  }
+
+  ring_buffer_.push(record);
+}
+
+} // namespace Tap
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/service/tap/v2alpha/common.pb.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "extensions/common/tap/tap.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace Tap {
+
+/**
+ * A bounded byte ring buffer with a single producer and a single consumer, which only synchronize
+ * through atomics. The records are pushed whole or not at all.
+ */
+class RingBuffer {
+public:
+  explicit RingBuffer(uint32_t capacity);
+
+  /**
+   * Copy a record into the ring buffer. Must only be called by the producer.
+   * @param record supplies the bytes to copy.
+   * @return whether the record fit in the free space of the ring buffer. A record that doesn't
+   *         fit is dropped and counted.
+   */
+  bool push(absl::string_view record);
+
+  /**
+   * Move all the pushed records out of the ring buffer. Must only be called by the consumer.
+   * @param output supplies the string to append the records to.
+   */
+  void drain(std::string& output);
+
+  /**
+   * @return the number of records dropped since the ring buffer was created.
+   */
+  uint64_t dropped() const { return dropped_.load(); }
+
+private:
+  const uint32_t capacity_;
+  std::unique_ptr<char[]> storage_;
+  // The total bytes pushed and drained. Their difference is the number of bytes in the ring.
+  std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> tail_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * A tap sink that serializes the traces into a ring buffer per worker, which a background thread
+ * drains into a single output file. The workers never wait for the file, and drop the traces that
+ * don't fit in their ring buffer.
+ */
+class StreamingFileSink : public Sink {
+public:
+  StreamingFileSink(const envoy::service::tap::v2alpha::StreamingFileSink& config,
+                    envoy::service::tap::v2alpha::OutputSink::Format format,
+                    Thread::ThreadFactory& thread_factory);
+  ~StreamingFileSink();
+
+  // Sink
+  PerTapSinkHandlePtr createPerTapSinkHandle(uint64_t trace_id) override;
+
+  /**
+   * @return the number of traces dropped by all the ring buffers.
+   */
+  uint64_t droppedTraces();
+
+  // The interval at which the background thread drains the ring buffers.
+  static constexpr std::chrono::milliseconds DrainInterval{100};
+
+private:
+  struct StreamingFileSinkHandle : public PerTapSinkHandle {
+    StreamingFileSinkHandle(RingBuffer& ring_buffer) : ring_buffer_(ring_buffer) {}
+
+    // PerTapSinkHandle
+    void submitTrace(const TraceWrapperSharedPtr& trace,
+                     envoy::service::tap::v2alpha::OutputSink::Format format) override;
+
+    RingBuffer& ring_buffer_;
+  };
+
+  RingBuffer& ringBufferForCurrentThread();
+  void drainLoop();
+  void drainRingBuffers();
+
+  const uint32_t ring_buffer_bytes_;
+  Thread::ThreadFactory& thread_factory_;
+  std::ofstream output_file_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar drain_cond_;
+  bool shutdown_ GUARDED_BY(lock_){};
+  // The ring buffers are keyed by the thread that produces into them, and live as long as the
+  // sink, which outlives the handles.
+  std::unordered_map<std::string, std::unique_ptr<RingBuffer>> ring_buffers_ GUARDED_BY(lock_);
+  uint64_t reported_dropped_{};
+  Thread::ThreadPtr drain_thread_;
+};
+
+} // namespace Tap
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
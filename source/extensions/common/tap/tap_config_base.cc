@@ -4,6 +4,7 @@
 #include "common/common/stack_array.h"
 #include "common/protobuf/utility.h"
 
+#include "extensions/common/tap/streaming_file_sink.h"
 #include "extensions/common/tap/tap_matcher.h"
 
 namespace Envoy {
@@ -45,7 +46,10 @@ TapConfigBaseImpl::TapConfigBaseImpl(envoy::service::tap::v2alpha::TapConfig&& p
           proto_config.output_config(), max_buffered_rx_bytes, DefaultMaxBufferedBytes)),
       max_buffered_tx_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
           proto_config.output_config(), max_buffered_tx_bytes, DefaultMaxBufferedBytes)),
-      streaming_(proto_config.output_config().streaming()) {
+      streaming_(proto_config.output_config().streaming()),
+      sampling_(proto_config.has_sampling()
+                    ? absl::make_optional<envoy::type::FractionalPercent>(proto_config.sampling())
+                    : absl::nullopt) {
   ASSERT(proto_config.output_config().sinks().size() == 1);
   // TODO(mattklein123): Add per-sink checks to make sure format makes sense. I.e., when using
   // streaming, we should require the length delimited version of binary proto, etc.
@@ -66,6 +70,12 @@ TapConfigBaseImpl::TapConfigBaseImpl(envoy::service::tap::v2alpha::TapConfig&& p
         std::make_unique<FilePerTapSink>(proto_config.output_config().sinks()[0].file_per_tap());
     sink_to_use_ = sink_.get();
     break;
+  case envoy::service::tap::v2alpha::OutputSink::kStreamingFile:
+    sink_ = std::make_unique<StreamingFileSink>(
+        proto_config.output_config().sinks()[0].streaming_file(), sink_format_,
+        Thread::ThreadFactorySingleton::get());
+    sink_to_use_ = sink_.get();
+    break;
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
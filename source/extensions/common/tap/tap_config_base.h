@@ -4,10 +4,15 @@
 
 #include "envoy/buffer/buffer.h"
 #include "envoy/service/tap/v2alpha/common.pb.h"
+#include "envoy/type/percent.pb.h"
+
+#include "common/protobuf/utility.h"
 
 #include "extensions/common/tap/tap.h"
 #include "extensions/common/tap/tap_matcher.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Common {
@@ -93,6 +98,16 @@ public:
   const Matcher& rootMatcher() const override;
   bool streaming() const override { return streaming_; }
 
+  /**
+   * @return whether the data source of a trace is sampled for tapping. The data sources that are
+   *         not sampled must not be tapped at all.
+   * @param trace_id supplies the locally unique trace ID of the data source.
+   */
+  bool sampled(uint64_t trace_id) const {
+    return !sampling_.has_value() ||
+           ProtobufPercentHelper::evaluateFractionalPercent(sampling_.value(), trace_id);
+  }
+
 protected:
   TapConfigBaseImpl(envoy::service::tap::v2alpha::TapConfig&& proto_config,
                     Common::Tap::Sink* admin_streamer);
@@ -105,6 +120,7 @@ private:
   const uint32_t max_buffered_rx_bytes_;
   const uint32_t max_buffered_tx_bytes_;
   const bool streaming_;
+  const absl::optional<envoy::type::FractionalPercent> sampling_;
   Sink* sink_to_use_;
   SinkPtr sink_;
   envoy::service::tap::v2alpha::OutputSink::Format sink_format_;
@@ -0,0 +1,97 @@
+#include "extensions/compressors/gzip/config.h"
+
+#include "envoy/config/compressor/gzip/v2alpha/gzip.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "common/http/headers.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/compressors/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compressors {
+namespace Gzip {
+
+namespace {
+// Default zlib memory level.
+const uint64_t DefaultMemoryLevel = 5;
+
+// Default and maximum compression window size.
+const uint64_t DefaultWindowBits = 12;
+
+// When summed to window bits, this sets a gzip header and trailer around the compressed data.
+const uint64_t GzipHeaderValue = 16;
+} // namespace
+
+GzipCompressorFactory::GzipCompressorFactory(
+    const envoy::config::compressor::gzip::v2alpha::Gzip& gzip)
+    : compression_level_(compressionLevelEnum(gzip.compression_level())),
+      compression_strategy_(compressionStrategyEnum(gzip.compression_strategy())),
+      memory_level_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, memory_level, DefaultMemoryLevel)),
+      window_bits_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, window_bits, DefaultWindowBits) |
+                   GzipHeaderValue) {}
+
+Compressor::CompressorPtr GzipCompressorFactory::createCompressor() {
+  auto compressor = std::make_unique<Compressor::ZlibCompressorImpl>();
+  compressor->init(compression_level_, compression_strategy_, window_bits_, memory_level_);
+  return std::move(compressor);
+}
+
+const std::string& GzipCompressorFactory::contentEncoding() const {
+  return Http::Headers::get().ContentEncodingValues.Gzip;
+}
+
+Compressor::ZlibCompressorImpl::CompressionLevel GzipCompressorFactory::compressionLevelEnum(
+    envoy::config::compressor::gzip::v2alpha::Gzip_CompressionLevel_Enum compression_level) {
+  switch (compression_level) {
+  case envoy::config::compressor::gzip::v2alpha::Gzip_CompressionLevel_Enum::
+      Gzip_CompressionLevel_Enum_BEST:
+    return Compressor::ZlibCompressorImpl::CompressionLevel::Best;
+  case envoy::config::compressor::gzip::v2alpha::Gzip_CompressionLevel_Enum::
+      Gzip_CompressionLevel_Enum_SPEED:
+    return Compressor::ZlibCompressorImpl::CompressionLevel::Speed;
+  default:
+    return Compressor::ZlibCompressorImpl::CompressionLevel::Standard;
+  }
+}
+
+Compressor::ZlibCompressorImpl::CompressionStrategy GzipCompressorFactory::compressionStrategyEnum(
+    envoy::config::compressor::gzip::v2alpha::Gzip_CompressionStrategy compression_strategy) {
+  switch (compression_strategy) {
+  case envoy::config::compressor::gzip::v2alpha::Gzip_CompressionStrategy::
+      Gzip_CompressionStrategy_RLE:
+    return Compressor::ZlibCompressorImpl::CompressionStrategy::Rle;
+  case envoy::config::compressor::gzip::v2alpha::Gzip_CompressionStrategy::
+      Gzip_CompressionStrategy_FILTERED:
+    return Compressor::ZlibCompressorImpl::CompressionStrategy::Filtered;
+  case envoy::config::compressor::gzip::v2alpha::Gzip_CompressionStrategy::
+      Gzip_CompressionStrategy_HUFFMAN:
+    return Compressor::ZlibCompressorImpl::CompressionStrategy::Huffman;
+  default:
+    return Compressor::ZlibCompressorImpl::CompressionStrategy::Standard;
+  }
+}
+
+Compressor::CompressorFactoryPtr GzipCompressorLibraryFactory::createCompressorFactoryFromProto(
+    const Protobuf::Message& config, Server::Configuration::FactoryContext&) {
+  return std::make_unique<GzipCompressorFactory>(
+      MessageUtil::downcastAndValidate<const envoy::config::compressor::gzip::v2alpha::Gzip&>(
+          config));
+}
+
+ProtobufTypes::MessagePtr GzipCompressorLibraryFactory::createEmptyConfigProto() {
+  return std::make_unique<envoy::config::compressor::gzip::v2alpha::Gzip>();
+}
+
+std::string GzipCompressorLibraryFactory::name() const { return CompressorNames::get().Gzip; }
+
+/**
+ * Static registration for the gzip compressor library. @see NamedCompressorLibraryConfigFactory.
+ */
+REGISTER_FACTORY(GzipCompressorLibraryFactory, Compressor::NamedCompressorLibraryConfigFactory);
+
+} // namespace Gzip
+} // namespace Compressors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "envoy/compressor/compressor_config.h"
+#include "envoy/config/compressor/gzip/v2alpha/gzip.pb.h"
+
+#include "common/compressor/zlib_compressor_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compressors {
+namespace Gzip {
+
+/**
+ * Creates the zlib compressors of the gzip compressor library.
+ */
+class GzipCompressorFactory : public Compressor::CompressorFactory {
+public:
+  GzipCompressorFactory(const envoy::config::compressor::gzip::v2alpha::Gzip& gzip);
+
+  // Compressor::CompressorFactory
+  Compressor::CompressorPtr createCompressor() override;
+  const std::string& contentEncoding() const override;
+
+private:
+  static Compressor::ZlibCompressorImpl::CompressionLevel compressionLevelEnum(
+      envoy::config::compressor::gzip::v2alpha::Gzip_CompressionLevel_Enum compression_level);
+  static Compressor::ZlibCompressorImpl::CompressionStrategy compressionStrategyEnum(
+      envoy::config::compressor::gzip::v2alpha::Gzip_CompressionStrategy compression_strategy);
+
+  const Compressor::ZlibCompressorImpl::CompressionLevel compression_level_;
+  const Compressor::ZlibCompressorImpl::CompressionStrategy compression_strategy_;
+  const uint64_t memory_level_;
+  const uint64_t window_bits_;
+};
+
+/**
+ * Config registration for the gzip compressor library. @see NamedCompressorLibraryConfigFactory.
+ */
+class GzipCompressorLibraryFactory : public Compressor::NamedCompressorLibraryConfigFactory {
+public:
+  // Compressor::NamedCompressorLibraryConfigFactory
+  Compressor::CompressorFactoryPtr
+  createCompressorFactoryFromProto(const Protobuf::Message& config,
+                                   Server::Configuration::FactoryContext& context) override;
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+  std::string name() const override;
+};
+
+} // namespace Gzip
+} // namespace Compressors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+#include "common/singleton/const_singleton.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compressors {
+
+/**
+ * Well-known compressor library names.
+ * NOTE: New compressor libraries should use the well known name: envoy.compressors.name.
+ */
+class CompressorNameValues {
+public:
+  // Compressor library encoding with the gzip content coding.
+  const std::string Gzip = "envoy.compressors.gzip";
+};
+
+typedef ConstSingleton<CompressorNameValues> CompressorNames;
+
+} // namespace Compressors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,70 @@
+#include "extensions/decompressors/gzip/config.h"
+
+#include "envoy/config/decompressor/gzip/v2alpha/gzip.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "common/decompressor/zlib_decompressor_impl.h"
+#include "common/http/headers.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/decompressors/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Decompressors {
+namespace Gzip {
+
+namespace {
+// Default decompression window size, which accepts the data of any compression window size.
+const uint64_t DefaultWindowBits = 15;
+
+// Default size of the chunks of decompressed data.
+const uint64_t DefaultChunkSize = 4096;
+
+// When summed to window bits, this expects a gzip header and trailer around the compressed data.
+const uint64_t GzipHeaderValue = 16;
+} // namespace
+
+GzipDecompressorFactory::GzipDecompressorFactory(
+    const envoy::config::decompressor::gzip::v2alpha::Gzip& gzip)
+    : window_bits_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, window_bits, DefaultWindowBits) |
+                   GzipHeaderValue),
+      chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, chunk_size, DefaultChunkSize)) {}
+
+Decompressor::DecompressorPtr GzipDecompressorFactory::createDecompressor() {
+  auto decompressor = std::make_unique<Decompressor::ZlibDecompressorImpl>(chunk_size_);
+  decompressor->init(window_bits_);
+  return std::move(decompressor);
+}
+
+const std::string& GzipDecompressorFactory::contentEncoding() const {
+  return Http::Headers::get().ContentEncodingValues.Gzip;
+}
+
+Decompressor::DecompressorFactoryPtr
+GzipDecompressorLibraryFactory::createDecompressorFactoryFromProto(
+    const Protobuf::Message& config, Server::Configuration::FactoryContext&) {
+  return std::make_unique<GzipDecompressorFactory>(
+      MessageUtil::downcastAndValidate<const envoy::config::decompressor::gzip::v2alpha::Gzip&>(
+          config));
+}
+
+ProtobufTypes::MessagePtr GzipDecompressorLibraryFactory::createEmptyConfigProto() {
+  return std::make_unique<envoy::config::decompressor::gzip::v2alpha::Gzip>();
+}
+
+std::string GzipDecompressorLibraryFactory::name() const {
+  return DecompressorNames::get().Gzip;
+}
+
+/**
+ * Static registration for the gzip decompressor library. @see
+ * NamedDecompressorLibraryConfigFactory.
+ */
+REGISTER_FACTORY(GzipDecompressorLibraryFactory,
+                 Decompressor::NamedDecompressorLibraryConfigFactory);
+
+} // namespace Gzip
+} // namespace Decompressors
+} // namespace Extensions
+} // namespace Envoy
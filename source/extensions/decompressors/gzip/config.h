@@ -0,0 +1,44 @@
+#pragma once
+
+#include "envoy/config/decompressor/gzip/v2alpha/gzip.pb.h"
+#include "envoy/decompressor/decompressor_config.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Decompressors {
+namespace Gzip {
+
+/**
+ * Creates the zlib decompressors of the gzip decompressor library.
+ */
+class GzipDecompressorFactory : public Decompressor::DecompressorFactory {
+public:
+  GzipDecompressorFactory(const envoy::config::decompressor::gzip::v2alpha::Gzip& gzip);
+
+  // Decompressor::DecompressorFactory
+  Decompressor::DecompressorPtr createDecompressor() override;
+  const std::string& contentEncoding() const override;
+
+private:
+  const uint64_t window_bits_;
+  const uint64_t chunk_size_;
+};
+
+/**
+ * Config registration for the gzip decompressor library. @see
+ * NamedDecompressorLibraryConfigFactory.
+ */
+class GzipDecompressorLibraryFactory : public Decompressor::NamedDecompressorLibraryConfigFactory {
+public:
+  // Decompressor::NamedDecompressorLibraryConfigFactory
+  Decompressor::DecompressorFactoryPtr
+  createDecompressorFactoryFromProto(const Protobuf::Message& config,
+                                     Server::Configuration::FactoryContext& context) override;
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+  std::string name() const override;
+};
+
+} // namespace Gzip
+} // namespace Decompressors
+} // namespace Extensions
+} // namespace Envoy
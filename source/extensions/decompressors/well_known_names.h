@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+#include "common/singleton/const_singleton.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Decompressors {
+
+/**
+ * Well-known decompressor library names.
+ * NOTE: New decompressor libraries should use the well known name: envoy.decompressors.name.
+ */
+class DecompressorNameValues {
+public:
+  // Decompressor library decoding the gzip content coding.
+  const std::string Gzip = "envoy.decompressors.gzip";
+};
+
+typedef ConstSingleton<DecompressorNameValues> DecompressorNames;
+
+} // namespace Decompressors
+} // namespace Extensions
+} // namespace Envoy
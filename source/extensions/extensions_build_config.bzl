@@ -7,6 +7,24 @@ EXTENSIONS = {
     "envoy.access_loggers.file":                        "//source/extensions/access_loggers/file:config",
     "envoy.access_loggers.http_grpc":                   "//source/extensions/access_loggers/http_grpc:config",
 
+    #
+    # Clusters
+    #
+
+    "envoy.clusters.dynamic_forward_proxy":             "//source/extensions/clusters/dynamic_forward_proxy:cluster",
+
+    #
+    # Compressor libraries
+    #
+
+    "envoy.compressors.gzip":                           "//source/extensions/compressors/gzip:config",
+
+    #
+    # Decompressor libraries
+    #
+
+    "envoy.decompressors.gzip":                         "//source/extensions/decompressors/gzip:config",
+
     #
     # gRPC Credentials Plugins
     #
@@ -19,12 +37,23 @@ EXTENSIONS = {
 
     "envoy.health_checkers.redis":                      "//source/extensions/health_checkers/redis:config",
 
+    #
+    # HTTP caches
+    #
+
+    "envoy.http_caches.in_memory":                      "//source/extensions/http_caches/in_memory:config",
+
     #
     # HTTP filters
     #
 
+    "envoy.filters.http.adaptive_concurrency":          "//source/extensions/filters/http/adaptive_concurrency:config",
     "envoy.filters.http.buffer":                        "//source/extensions/filters/http/buffer:config",
+    "envoy.filters.http.cache":                         "//source/extensions/filters/http/cache:config",
+    "envoy.filters.http.compressor":                    "//source/extensions/filters/http/compressor:config",
     "envoy.filters.http.cors":                          "//source/extensions/filters/http/cors:config",
+    "envoy.filters.http.decompressor":                  "//source/extensions/filters/http/decompressor:config",
+    "envoy.filters.http.dynamic_forward_proxy":         "//source/extensions/filters/http/dynamic_forward_proxy:config",
     "envoy.filters.http.dynamo":                        "//source/extensions/filters/http/dynamo:config",
     "envoy.filters.http.ext_authz":                     "//source/extensions/filters/http/ext_authz:config",
     "envoy.filters.http.fault":                         "//source/extensions/filters/http/fault:config",
@@ -38,6 +67,7 @@ EXTENSIONS = {
     "envoy.filters.http.ip_tagging":                    "//source/extensions/filters/http/ip_tagging:config",
     "envoy.filters.http.jwt_authn":                     "//source/extensions/filters/http/jwt_authn:config",
     "envoy.filters.http.lua":                           "//source/extensions/filters/http/lua:config",
+    "envoy.filters.http.on_demand_cluster":             "//source/extensions/filters/http/on_demand_cluster:config",
     "envoy.filters.http.ratelimit":                     "//source/extensions/filters/http/ratelimit:config",
     "envoy.filters.http.rbac":                          "//source/extensions/filters/http/rbac:config",
     "envoy.filters.http.router":                        "//source/extensions/filters/http/router:config",
@@ -79,12 +109,20 @@ EXTENSIONS = {
     "envoy.filters.network.sni_cluster":                "//source/extensions/filters/network/sni_cluster:config",
     "envoy.filters.network.zookeeper_proxy":            "//source/extensions/filters/network/zookeeper_proxy:config",
 
+    #
+    # Private key providers
+    #
+
+    "envoy.private_key_providers.thread_pool":          "//source/extensions/private_key_providers/thread_pool:config",
+
     #
     # Resource monitors
     #
 
+    "envoy.resource_monitors.event_loop_lag":           "//source/extensions/resource_monitors/event_loop_lag:config",
     "envoy.resource_monitors.fixed_heap":               "//source/extensions/resource_monitors/fixed_heap:config",
     "envoy.resource_monitors.injected_resource":        "//source/extensions/resource_monitors/injected_resource:config",
+    "envoy.resource_monitors.process_cpu":              "//source/extensions/resource_monitors/process_cpu:config",
 
     #
     # Stat sinks
@@ -93,6 +131,7 @@ EXTENSIONS = {
     "envoy.stat_sinks.dog_statsd":                      "//source/extensions/stat_sinks/dog_statsd:config",
     "envoy.stat_sinks.hystrix":                         "//source/extensions/stat_sinks/hystrix:config",
     "envoy.stat_sinks.metrics_service":                 "//source/extensions/stat_sinks/metrics_service:config",
+    "envoy.stat_sinks.shared_memory":                   "//source/extensions/stat_sinks/shared_memory:config",
     "envoy.stat_sinks.statsd":                          "//source/extensions/stat_sinks/statsd:config",
 
     #
@@ -118,6 +157,12 @@ EXTENSIONS = {
     "envoy.transport_sockets.alts":                     "//source/extensions/transport_sockets/alts:config",
     "envoy.transport_sockets.tap":                      "//source/extensions/transport_sockets/tap:config",
 
+    #
+    # UDP listener filters
+    #
+
+    "envoy.filters.udp_listener.udp_proxy":             "//source/extensions/filters/udp/udp_proxy:config",
+
     # Retry host predicates
     "envoy.retry_host_predicates.previous_hosts":          "//source/extensions/retry/host/previous_hosts:config",
 
@@ -151,6 +196,7 @@ WINDOWS_EXTENSIONS = {
 
     #"envoy.filters.http.buffer":                        "//source/extensions/filters/http/buffer:config",
     #"envoy.filters.http.cors":                          "//source/extensions/filters/http/cors:config",
+    #"envoy.filters.http.dynamic_forward_proxy":         "//source/extensions/filters/http/dynamic_forward_proxy:config",
     #"envoy.filters.http.dynamo":                        "//source/extensions/filters/http/dynamo:config",
     #"envoy.filters.http.ext_authz":                     "//source/extensions/filters/http/ext_authz:config",
     #"envoy.filters.http.fault":                         "//source/extensions/filters/http/fault:config",
@@ -161,6 +207,7 @@ WINDOWS_EXTENSIONS = {
     #"envoy.filters.http.health_check":                  "//source/extensions/filters/http/health_check:config",
     #"envoy.filters.http.ip_tagging":                    "//source/extensions/filters/http/ip_tagging:config",
     #"envoy.filters.http.lua":                           "//source/extensions/filters/http/lua:config",
+    #"envoy.filters.http.on_demand_cluster":             "//source/extensions/filters/http/on_demand_cluster:config",
     #"envoy.filters.http.ratelimit":                     "//source/extensions/filters/http/ratelimit:config",
     #"envoy.filters.http.rbac":                          "//source/extensions/filters/http/rbac:config",
     #"envoy.filters.http.router":                        "//source/extensions/filters/http/router:config",
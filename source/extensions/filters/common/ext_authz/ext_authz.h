@@ -10,6 +10,8 @@
 #include "envoy/service/auth/v2/external_auth.pb.h"
 #include "envoy/tracing/http_tracer.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
@@ -42,6 +44,8 @@ struct Response {
   std::string body;
   // Optional http status used only on denied response.
   Http::Code status_code{};
+  // Optional duration for which an ok response may be cached, set by the authorization service.
+  absl::optional<std::chrono::milliseconds> cache_ttl;
 };
 
 typedef std::unique_ptr<Response> ResponsePtr;
@@ -6,6 +6,7 @@
 #include "common/http/utility.h"
 #include "common/network/utility.h"
 #include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -52,6 +53,10 @@ void GrpcClientImpl::onSuccess(std::unique_ptr<envoy::service::auth::v2::CheckRe
     if (response->has_ok_response()) {
       toAuthzResponseHeader(authz_response, response->ok_response().headers());
     }
+    if (response->has_cache_ttl()) {
+      authz_response->cache_ttl =
+          std::chrono::milliseconds(DurationUtil::durationToMilliseconds(response->cache_ttl()));
+    }
   } else {
     span.setTag(Constants::get().TraceStatus, Constants::get().TraceUnauthz);
     authz_response->status = CheckStatus::Denied;
@@ -1,9 +1,13 @@
 #include "extensions/filters/common/ext_authz/ext_authz_http_impl.h"
 
 #include "common/common/enum_to_int.h"
+#include "common/common/utility.h"
 #include "common/http/async_client_impl.h"
 #include "common/http/codes.h"
+#include "common/http/headers.h"
 
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 
 namespace Envoy {
@@ -24,7 +28,7 @@ const Http::HeaderMap& lengthZeroHeader() {
 const Response& errorResponse() {
   CONSTRUCT_ON_FIRST_USE(Response,
                          Response{CheckStatus::Error, Http::HeaderVector{}, Http::HeaderVector{},
-                                  EMPTY_STRING, Http::Code::Forbidden});
+                                  EMPTY_STRING, Http::Code::Forbidden, absl::nullopt});
 }
 
 // SuccessResponse used for creating either DENIED or OK authorization responses.
@@ -49,6 +53,32 @@ struct SuccessResponse {
   const MatcherSharedPtr& matchers_;
   ResponsePtr response_;
 };
+
+constexpr absl::string_view MaxAgeDirective{"max-age="};
+
+// Returns the duration for which an ok response may be cached according to its Cache-Control
+// header: zero for no-cache and no-store, its max-age otherwise, if any.
+absl::optional<std::chrono::milliseconds> cacheTtl(const Http::HeaderMap& headers) {
+  const Http::HeaderEntry* cache_control = headers.get(Http::Headers::get().CacheControl);
+  if (cache_control == nullptr) {
+    return absl::nullopt;
+  }
+  absl::optional<std::chrono::milliseconds> ttl;
+  for (absl::string_view directive :
+       StringUtil::splitToken(cache_control->value().getStringView(), ",")) {
+    directive = StringUtil::trim(directive);
+    if (absl::EqualsIgnoreCase(directive, Http::Headers::get().CacheControlValues.NoCache) ||
+        absl::EqualsIgnoreCase(directive, Http::Headers::get().CacheControlValues.NoStore)) {
+      return std::chrono::milliseconds(0);
+    }
+    uint64_t seconds;
+    if (absl::StartsWithIgnoreCase(directive, MaxAgeDirective) &&
+        absl::SimpleAtoi(directive.substr(MaxAgeDirective.size()), &seconds)) {
+      ttl = std::chrono::seconds(seconds);
+    }
+  }
+  return ttl;
+}
 } // namespace
 
 // Matchers
@@ -215,14 +245,16 @@ ResponsePtr RawHttpClientImpl::toResponse(Http::MessagePtr message) {
   if (status_code == enumToInt(Http::Code::OK)) {
     SuccessResponse ok{message->headers(), config_->upstreamHeaderMatchers(),
                        Response{CheckStatus::OK, Http::HeaderVector{}, Http::HeaderVector{},
-                                EMPTY_STRING, Http::Code::OK}};
+                                EMPTY_STRING, Http::Code::OK, absl::nullopt}};
+    ok.response_->cache_ttl = cacheTtl(message->headers());
     return std::move(ok.response_);
   }
 
   // Create a Denied authorization response.
   SuccessResponse denied{message->headers(), config_->clientHeaderMatchers(),
                          Response{CheckStatus::Denied, Http::HeaderVector{}, Http::HeaderVector{},
-                                  message->bodyAsString(), static_cast<Http::Code>(status_code)}};
+                                  message->bodyAsString(), static_cast<Http::Code>(status_code),
+                                  absl::nullopt}};
   return std::move(denied.response_);
 }
 
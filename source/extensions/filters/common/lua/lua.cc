@@ -1,6 +1,8 @@
 #include "extensions/filters/common/lua/lua.h"
 
+#include <chrono>
 #include <memory>
+#include <string>
 
 #include "envoy/common/exception.h"
 
@@ -46,20 +48,42 @@ void Coroutine::resume(int num_args, const std::function<void()>& yield_callback
   }
 }
 
-ThreadLocalState::ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls)
+namespace {
+
+int writeBytecode(lua_State*, const void* data, size_t size, void* bytecode) {
+  static_cast<std::string*>(bytecode)->append(static_cast<const char*>(data), size);
+  return 0;
+}
+
+void throwLoadError(lua_State* state) {
+  throw LuaException(fmt::format("script load error: {}", lua_tostring(state, -1)));
+}
+
+} // namespace
+
+ThreadLocalState::ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls,
+                                   uint32_t gc_step_kb)
     : tls_slot_(tls.allocateSlot()) {
 
-  // First verify that the supplied code can be parsed.
+  // First verify that the supplied code can be parsed and run, and compile it once for all the
+  // workers.
   CSmartPtr<lua_State, lua_close> state(lua_open());
   luaL_openlibs(state.get());
 
-  if (0 != luaL_dostring(state.get(), code.c_str())) {
-    throw LuaException(fmt::format("script load error: {}", lua_tostring(state.get(), -1)));
+  if (0 != luaL_loadstring(state.get(), code.c_str())) {
+    throwLoadError(state.get());
+  }
+  auto bytecode = std::make_shared<std::string>();
+  lua_dump(state.get(), writeBytecode, bytecode.get());
+  if (0 != lua_pcall(state.get(), 0, LUA_MULTRET, 0)) {
+    throwLoadError(state.get());
   }
 
   // Now initialize on all threads.
-  tls_slot_->set([code](Event::Dispatcher&) {
-    return ThreadLocal::ThreadLocalObjectSharedPtr{new LuaThreadLocal(code)};
+  const std::shared_ptr<const std::string> shared_bytecode = std::move(bytecode);
+  tls_slot_->set([shared_bytecode, gc_step_kb](Event::Dispatcher& dispatcher) {
+    return ThreadLocal::ThreadLocalObjectSharedPtr{
+        new LuaThreadLocal(*shared_bytecode, dispatcher, gc_step_kb)};
   });
 }
 
@@ -90,10 +114,28 @@ CoroutinePtr ThreadLocalState::createCoroutine() {
   return std::make_unique<Coroutine>(std::make_pair(lua_newthread(state), state));
 }
 
-ThreadLocalState::LuaThreadLocal::LuaThreadLocal(const std::string& code) : state_(lua_open()) {
+void ThreadLocalState::scheduleGCStep() {
+  LuaThreadLocal& tls = tls_slot_->getTyped<LuaThreadLocal>();
+  if (tls.gc_step_timer_ != nullptr && !tls.gc_step_timer_->enabled()) {
+    tls.gc_step_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
+ThreadLocalState::LuaThreadLocal::LuaThreadLocal(const std::string& bytecode,
+                                                 Event::Dispatcher& dispatcher,
+                                                 uint32_t gc_step_kb)
+    : state_(lua_open()), gc_step_kb_(gc_step_kb) {
   luaL_openlibs(state_.get());
-  int rc = luaL_dostring(state_.get(), code.c_str());
+  // The bytecode keeps the name of the code chunk, so that errors read as if the code was loaded.
+  int rc = luaL_loadbuffer(state_.get(), bytecode.data(), bytecode.size(), nullptr);
   ASSERT(rc == 0);
+  rc = lua_pcall(state_.get(), 0, LUA_MULTRET, 0);
+  ASSERT(rc == 0);
+
+  if (gc_step_kb_ > 0) {
+    gc_step_timer_ =
+        dispatcher.createTimer([this]() -> void { lua_gc(state_.get(), LUA_GCSTEP, gc_step_kb_); });
+  }
 }
 
 } // namespace Lua
@@ -5,6 +5,8 @@
 #include <vector>
 
 #include "envoy/common/exception.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
 #include "envoy/thread_local/thread_local.h"
 
 #include "common/common/assert.h"
@@ -334,11 +336,18 @@ typedef std::unique_ptr<Coroutine> CoroutinePtr;
 /**
  * This class wraps a Lua state that can be used safely across threads. The model is that every
  * worker gets its own independent state. There is no truly global state that a script can access.
- * This is something that might be provided in the future via an API (not via Lua itself).
+ * This is something that might be provided in the future via an API (not via Lua itself). The
+ * code is compiled once, and every worker loads the shared bytecode into its state.
  */
 class ThreadLocalState : Logger::Loggable<Logger::Id::lua> {
 public:
-  ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls);
+  /**
+   * @param code supplies the Lua code to load on all workers.
+   * @param tls supplies the slot allocator for the worker states.
+   * @param gc_step_kb supplies the size of the garbage collection steps scheduled with
+   *        scheduleGCStep(), in kilobytes. 0 disables them.
+   */
+  ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls, uint32_t gc_step_kb);
 
   /**
    * @return CoroutinePtr a new coroutine.
@@ -383,12 +392,22 @@ public:
    */
   void runtimeGC() { lua_gc(tls_slot_->getTyped<LuaThreadLocal>().state_.get(), LUA_GCCOLLECT, 0); }
 
+  /**
+   * Schedule an incremental runtime GC step on the dispatcher of this worker, so that it runs
+   * between the events being processed. The steps scheduled before it runs are coalesced. This is
+   * a no-op if the steps are disabled.
+   */
+  void scheduleGCStep();
+
 private:
   struct LuaThreadLocal : public ThreadLocal::ThreadLocalObject {
-    LuaThreadLocal(const std::string& code);
+    LuaThreadLocal(const std::string& bytecode, Event::Dispatcher& dispatcher,
+                   uint32_t gc_step_kb);
 
     CSmartPtr<lua_State, lua_close> state_;
     std::vector<int> global_slots_;
+    const uint32_t gc_step_kb_;
+    Event::TimerPtr gc_step_timer_;
   };
 
   ThreadLocal::SlotPtr tls_slot_;
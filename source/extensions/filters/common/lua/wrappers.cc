@@ -1,5 +1,7 @@
 #include "extensions/filters/common/lua/wrappers.h"
 
+#include "common/common/stack_array.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
@@ -19,7 +21,23 @@ int BufferWrapper::luaGetBytes(lua_State* state) {
     luaL_error(state, "index/length must be >= 0 and (index + length) must be <= buffer size");
   }
 
-  // TODO(mattklein123): Reduce copies here by using Lua direct buffer builds.
+  // Bytes within a single slice, like the prefix of a body frame, are pushed straight from the
+  // slice. Otherwise they are gathered first.
+  const uint64_t num_slices = data_.getRawSlices(nullptr, 0);
+  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
+  data_.getRawSlices(slices.begin(), num_slices);
+  uint64_t offset = index;
+  for (const Buffer::RawSlice& slice : slices) {
+    if (offset < slice.len_) {
+      if (offset + length <= slice.len_) {
+        lua_pushlstring(state, static_cast<const char*>(slice.mem_) + offset, length);
+        return 1;
+      }
+      break;
+    }
+    offset -= slice.len_;
+  }
+
   std::unique_ptr<char[]> data(new char[length]);
   data_.copyOut(index, length, data.get());
   lua_pushlstring(state, data.get(), length);
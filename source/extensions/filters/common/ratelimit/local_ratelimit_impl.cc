@@ -0,0 +1,132 @@
+#include "extensions/filters/common/ratelimit/local_ratelimit_impl.h"
+
+#include <chrono>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/http/header_map_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+
+LocalRateLimiter::LocalRateLimiter(
+    const envoy::config::common::ratelimit::v2alpha::LocalRateLimit& config,
+    TimeSource& time_source, const std::string& stats_prefix, Stats::Scope& scope)
+    : max_buckets_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_buckets, DefaultMaxBuckets)),
+      time_source_(time_source),
+      stats_{ALL_LOCAL_RATE_LIMIT_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix))} {
+  for (const auto& limit : config.limits()) {
+    Limit new_limit;
+    for (const auto& entry : limit.entries()) {
+      new_limit.entries_.push_back({entry.key(), entry.value()});
+    }
+    new_limit.max_tokens_ = limit.max_tokens();
+    const std::chrono::duration<double> fill_interval =
+        std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(limit, fill_interval));
+    new_limit.fill_rate_ =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(limit, tokens_per_fill, limit.max_tokens()) /
+        fill_interval.count();
+    limits_.push_back(std::move(new_limit));
+  }
+}
+
+LocalLimitStatus
+LocalRateLimiter::consume(const std::vector<Envoy::RateLimit::Descriptor>& descriptors) {
+  bool matched = false;
+  bool over_limit = false;
+  Thread::LockGuard lock(lock_);
+  for (const auto& descriptor : descriptors) {
+    const size_t limit = match(descriptor);
+    if (limit == limits_.size()) {
+      continue;
+    }
+    matched = true;
+    // Every matching bucket is charged, like the rate limit service charges every descriptor.
+    if (bucket(limit, descriptor).consume(1, false) == 0) {
+      over_limit = true;
+    }
+  }
+  if (over_limit) {
+    return LocalLimitStatus::OverLimit;
+  }
+  return matched ? LocalLimitStatus::OK : LocalLimitStatus::NoMatch;
+}
+
+size_t LocalRateLimiter::match(const Envoy::RateLimit::Descriptor& descriptor) const {
+  for (size_t i = 0; i < limits_.size(); i++) {
+    const auto& entries = limits_[i].entries_;
+    if (entries.size() != descriptor.entries_.size()) {
+      continue;
+    }
+    bool matches = true;
+    for (size_t j = 0; j < entries.size() && matches; j++) {
+      matches = entries[j].key_ == descriptor.entries_[j].key_ &&
+                (entries[j].value_.empty() || entries[j].value_ == descriptor.entries_[j].value_);
+    }
+    if (matches) {
+      return i;
+    }
+  }
+  return limits_.size();
+}
+
+TokenBucketImpl& LocalRateLimiter::bucket(size_t limit,
+                                          const Envoy::RateLimit::Descriptor& descriptor) {
+  // The lengths of the values are part of the key, so that no values key like others.
+  std::string key = std::to_string(limit);
+  for (const auto& entry : descriptor.entries_) {
+    key += fmt::format("\n{}:{}", entry.value_.size(), entry.value_);
+  }
+
+  auto it = bucket_index_.find(key);
+  if (it != bucket_index_.end()) {
+    buckets_.splice(buckets_.begin(), buckets_, it->second);
+    return it->second->token_bucket_;
+  }
+
+  if (buckets_.size() >= max_buckets_) {
+    bucket_index_.erase(buckets_.back().key_);
+    buckets_.pop_back();
+  }
+  buckets_.push_front(
+      {key, TokenBucketImpl(limits_[limit].max_tokens_, time_source_, limits_[limit].fill_rate_)});
+  bucket_index_.emplace(std::move(key), buckets_.begin());
+  return buckets_.front().token_bucket_;
+}
+
+void LocalClientImpl::cancel() {
+  // Local decisions complete inline, so that only forwarded requests can be cancelled.
+  ASSERT(global_client_ != nullptr);
+  global_client_->cancel();
+}
+
+void LocalClientImpl::limit(RequestCallbacks& callbacks, const std::string& domain,
+                            const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+                            Tracing::Span& parent_span) {
+  const LocalLimitStatus status = limiter_->consume(descriptors);
+  if (global_client_ != nullptr && status != LocalLimitStatus::OK) {
+    limiter_->stats().forwarded_.inc();
+    global_client_->limit(callbacks, domain, descriptors, parent_span);
+    return;
+  }
+
+  if (status == LocalLimitStatus::OverLimit) {
+    limiter_->stats().over_limit_.inc();
+    callbacks.complete(LimitStatus::OverLimit, std::make_unique<Http::HeaderMapImpl>());
+  } else {
+    limiter_->stats().ok_.inc();
+    callbacks.complete(LimitStatus::OK, std::make_unique<Http::HeaderMapImpl>());
+  }
+}
+
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
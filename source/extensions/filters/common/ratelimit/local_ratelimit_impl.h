@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/config/common/ratelimit/v2alpha/local_rate_limit.pb.h"
+#include "envoy/ratelimit/ratelimit.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+#include "common/common/token_bucket_impl.h"
+
+#include "extensions/filters/common/ratelimit/ratelimit.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+
+/**
+ * All local rate limit stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_LOCAL_RATE_LIMIT_STATS(COUNTER)                                                        \
+  COUNTER(ok)                                                                                      \
+  COUNTER(over_limit)                                                                              \
+  COUNTER(forwarded)
+// clang-format on
+
+/**
+ * Struct definition for all local rate limit stats. @see stats_macros.h
+ */
+struct LocalRateLimitStats {
+  ALL_LOCAL_RATE_LIMIT_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Possible results of a local rate limit check.
+ */
+enum class LocalLimitStatus {
+  // All the descriptors matching a limit got a token, and at least one descriptor matched.
+  OK,
+  // A descriptor matching a limit found its bucket empty.
+  OverLimit,
+  // None of the descriptors matched a limit.
+  NoMatch
+};
+
+/**
+ * Token buckets limiting the rate of the descriptors that match local limits. The buckets are
+ * shared by the clients of all workers, so that the limits apply to the whole Envoy.
+ */
+class LocalRateLimiter {
+public:
+  LocalRateLimiter(const envoy::config::common::ratelimit::v2alpha::LocalRateLimit& config,
+                   TimeSource& time_source, const std::string& stats_prefix, Stats::Scope& scope);
+
+  /**
+   * Take a token from the bucket of each descriptor matching a limit.
+   * @param descriptors supplies the descriptors of a request.
+   * @return LocalLimitStatus the result of the check.
+   */
+  LocalLimitStatus consume(const std::vector<Envoy::RateLimit::Descriptor>& descriptors);
+
+  LocalRateLimitStats& stats() { return stats_; }
+
+  static constexpr uint32_t DefaultMaxBuckets = 1024;
+
+private:
+  struct Limit {
+    std::vector<Envoy::RateLimit::DescriptorEntry> entries_;
+    uint64_t max_tokens_;
+    double fill_rate_;
+  };
+
+  struct Bucket {
+    std::string key_;
+    TokenBucketImpl token_bucket_;
+  };
+
+  /**
+   * @return the index of the first limit matching the descriptor, or limits_.size() if none does.
+   */
+  size_t match(const Envoy::RateLimit::Descriptor& descriptor) const;
+  TokenBucketImpl& bucket(size_t limit, const Envoy::RateLimit::Descriptor& descriptor)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  std::vector<Limit> limits_;
+  const uint32_t max_buckets_;
+  TimeSource& time_source_;
+  LocalRateLimitStats stats_;
+  Thread::MutexBasicLockable lock_;
+  // Most recently used first.
+  std::list<Bucket> buckets_ GUARDED_BY(lock_);
+  std::unordered_map<std::string, std::list<Bucket>::iterator> bucket_index_ GUARDED_BY(lock_);
+};
+
+typedef std::shared_ptr<LocalRateLimiter> LocalRateLimiterSharedPtr;
+
+/**
+ * A rate limit client deciding locally with a LocalRateLimiter. If it has a global client, the
+ * requests that the local limits don't allow are forwarded to it instead of being over limit.
+ */
+class LocalClientImpl : public Client {
+public:
+  LocalClientImpl(LocalRateLimiterSharedPtr limiter, ClientPtr&& global_client)
+      : limiter_(std::move(limiter)), global_client_(std::move(global_client)) {}
+
+  // Filters::Common::RateLimit::Client
+  void cancel() override;
+  void limit(RequestCallbacks& callbacks, const std::string& domain,
+             const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+             Tracing::Span& parent_span) override;
+
+private:
+  const LocalRateLimiterSharedPtr limiter_;
+  const ClientPtr global_client_;
+};
+
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -11,6 +11,10 @@
 #include "common/common/assert.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
+#include "common/protobuf/utility.h"
+#include "common/tracing/http_tracer_impl.h"
+
+#include "fmt/format.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -18,11 +22,28 @@ namespace Filters {
 namespace Common {
 namespace RateLimit {
 
+namespace {
+
+const Protobuf::MethodDescriptor& shouldRateLimitMethod() {
+  return *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+      "envoy.service.ratelimit.v2.RateLimitService.ShouldRateLimit");
+}
+
+Http::HeaderMapPtr
+responseHeaders(const envoy::service::ratelimit::v2::RateLimitResponse& response) {
+  Http::HeaderMapPtr headers = std::make_unique<Http::HeaderMapImpl>();
+  for (const auto& h : response.headers()) {
+    headers->addCopy(Http::LowerCaseString(h.key()), h.value());
+  }
+  return headers;
+}
+
+} // namespace
+
 GrpcClientImpl::GrpcClientImpl(Grpc::AsyncClientPtr&& async_client,
                                const absl::optional<std::chrono::milliseconds>& timeout)
-    : service_method_(*Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
-          "envoy.service.ratelimit.v2.RateLimitService.ShouldRateLimit")),
-      async_client_(std::move(async_client)), timeout_(timeout) {}
+    : service_method_(shouldRateLimitMethod()), async_client_(std::move(async_client)),
+      timeout_(timeout) {}
 
 GrpcClientImpl::~GrpcClientImpl() { ASSERT(!callbacks_); }
 
@@ -72,13 +93,7 @@ void GrpcClientImpl::onSuccess(
     span.setTag(Constants::get().TraceStatus, Constants::get().TraceOk);
   }
 
-  Http::HeaderMapPtr headers = std::make_unique<Http::HeaderMapImpl>();
-  if (response->headers_size()) {
-    for (const auto& h : response->headers()) {
-      headers->addCopy(Http::LowerCaseString(h.key()), h.value());
-    }
-  }
-  callbacks_->complete(status, std::move(headers));
+  callbacks_->complete(status, responseHeaders(*response));
   callbacks_ = nullptr;
 }
 
@@ -89,6 +104,157 @@ void GrpcClientImpl::onFailure(Grpc::Status::GrpcStatus status, const std::strin
   callbacks_ = nullptr;
 }
 
+Aggregator::Aggregator(Grpc::AsyncClientFactoryPtr&& async_client_factory,
+                       std::chrono::milliseconds window, std::chrono::milliseconds timeout,
+                       ThreadLocal::SlotAllocator& tls, const std::string& stats_prefix,
+                       Stats::Scope& scope)
+    : tls_(tls.allocateSlot()) {
+  // The workers create their clients from the factory after the config may be gone.
+  const std::shared_ptr<Grpc::AsyncClientFactory> factory = std::move(async_client_factory);
+  const RateLimitAggregationStats stats{
+      ALL_RATE_LIMIT_AGGREGATION_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix))};
+  tls_->set([factory, window, timeout,
+             stats](Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalAggregation>(factory->create(), dispatcher, window, timeout,
+                                                    stats);
+  });
+}
+
+bool Aggregator::aggregate(RequestCallbacks& callbacks, const std::string& domain,
+                           const std::vector<Envoy::RateLimit::Descriptor>& descriptors) {
+  auto& aggregation = tls_->getTyped<ThreadLocalAggregation>();
+  const auto it = aggregation.entries_.find(key(domain, descriptors));
+  if (it == aggregation.entries_.end() || !it->second->known_) {
+    return false;
+  }
+  Entry& entry = *it->second;
+  entry.pending_hits_++;
+  aggregation.stats_.aggregated_.inc();
+  callbacks.complete(entry.status_, std::make_unique<Http::HeaderMapImpl>(*entry.headers_));
+  return true;
+}
+
+void Aggregator::update(const std::string& domain,
+                        const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+                        LimitStatus status, const Http::HeaderMap& headers) {
+  ASSERT(status != LimitStatus::Error);
+  auto& aggregation = tls_->getTyped<ThreadLocalAggregation>();
+  EntryPtr& entry = aggregation.entries_[key(domain, descriptors)];
+  if (entry == nullptr) {
+    entry = std::make_unique<Entry>(aggregation, domain, descriptors);
+    if (!aggregation.flush_timer_->enabled()) {
+      aggregation.flush_timer_->enableTimer(aggregation.window_);
+    }
+  }
+  entry->known_ = true;
+  entry->status_ = status;
+  entry->headers_ = std::make_unique<Http::HeaderMapImpl>(headers);
+}
+
+std::string Aggregator::key(const std::string& domain,
+                            const std::vector<Envoy::RateLimit::Descriptor>& descriptors) {
+  // The lengths of the strings are part of the key, so that no descriptors key like others.
+  std::string key = fmt::format("{}:{}", domain.size(), domain);
+  for (const Envoy::RateLimit::Descriptor& descriptor : descriptors) {
+    key += '\n';
+    for (const Envoy::RateLimit::DescriptorEntry& entry : descriptor.entries_) {
+      key += fmt::format("{}:{}{}:{}", entry.key_.size(), entry.key_, entry.value_.size(),
+                         entry.value_);
+    }
+  }
+  return key;
+}
+
+void Aggregator::Entry::onSuccess(
+    std::unique_ptr<envoy::service::ratelimit::v2::RateLimitResponse>&& response,
+    Tracing::Span&) {
+  request_ = nullptr;
+  parent_.stats_.flushed_.inc();
+  status_ = response->overall_code() ==
+                    envoy::service::ratelimit::v2::RateLimitResponse_Code_OVER_LIMIT
+                ? LimitStatus::OverLimit
+                : LimitStatus::OK;
+  headers_ = responseHeaders(*response);
+}
+
+void Aggregator::Entry::onFailure(Grpc::Status::GrpcStatus, const std::string&, Tracing::Span&) {
+  request_ = nullptr;
+  parent_.stats_.flush_error_.inc();
+  // The next requests are sent to the service again, so that its failures reach the filters.
+  known_ = false;
+}
+
+Aggregator::ThreadLocalAggregation::ThreadLocalAggregation(
+    Grpc::AsyncClientPtr&& async_client, Event::Dispatcher& dispatcher,
+    std::chrono::milliseconds window, std::chrono::milliseconds timeout,
+    const RateLimitAggregationStats& stats)
+    : service_method_(shouldRateLimitMethod()), async_client_(std::move(async_client)),
+      window_(window), timeout_(timeout), stats_(stats),
+      flush_timer_(dispatcher.createTimer([this]() -> void { flush(); })) {}
+
+Aggregator::ThreadLocalAggregation::~ThreadLocalAggregation() {
+  for (const auto& entry : entries_) {
+    if (entry.second->request_ != nullptr) {
+      entry.second->request_->cancel();
+    }
+  }
+}
+
+void Aggregator::ThreadLocalAggregation::flush() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    Entry& entry = *it->second;
+    if (entry.request_ != nullptr) {
+      // The previous report is still in flight, so that these hits wait for the next one.
+      ++it;
+    } else if (!entry.known_ || entry.pending_hits_ == 0) {
+      // Without hits for a whole window the status may be stale, so that it is forgotten.
+      it = entries_.erase(it);
+    } else {
+      envoy::service::ratelimit::v2::RateLimitRequest request;
+      GrpcClientImpl::createRequest(request, entry.domain_, entry.descriptors_);
+      request.set_hits_addend(entry.pending_hits_);
+      entry.pending_hits_ = 0;
+      // A failed send calls onFailure() inline, which only marks the entry.
+      entry.request_ = async_client_->send(service_method_, request, entry,
+                                           Tracing::NullSpan::instance(), timeout_);
+      ++it;
+    }
+  }
+  if (!entries_.empty()) {
+    flush_timer_->enableTimer(window_);
+  }
+}
+
+void AggregatingClientImpl::cancel() {
+  // Aggregated requests complete inline, so that only the requests sent by the client can be
+  // cancelled.
+  ASSERT(callbacks_ != nullptr);
+  client_->cancel();
+  callbacks_ = nullptr;
+}
+
+void AggregatingClientImpl::limit(RequestCallbacks& callbacks, const std::string& domain,
+                                  const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+                                  Tracing::Span& parent_span) {
+  ASSERT(callbacks_ == nullptr);
+  if (aggregator_->aggregate(callbacks, domain, descriptors)) {
+    return;
+  }
+  callbacks_ = &callbacks;
+  domain_ = domain;
+  descriptors_ = descriptors;
+  client_->limit(*this, domain, descriptors, parent_span);
+}
+
+void AggregatingClientImpl::complete(LimitStatus status, Http::HeaderMapPtr&& headers) {
+  if (status != LimitStatus::Error) {
+    aggregator_->update(domain_, descriptors_, status, *headers);
+  }
+  RequestCallbacks* callbacks = callbacks_;
+  callbacks_ = nullptr;
+  callbacks->complete(status, std::move(headers));
+}
+
 ClientPtr rateLimitClient(Server::Configuration::FactoryContext& context,
                           const envoy::api::v2::core::GrpcService& grpc_service,
                           const std::chrono::milliseconds timeout) {
@@ -101,6 +267,20 @@ ClientPtr rateLimitClient(Server::Configuration::FactoryContext& context,
       async_client_factory->create(), timeout);
 }
 
+AggregatorSharedPtr
+rateLimitAggregator(Server::Configuration::FactoryContext& context,
+                    const envoy::config::ratelimit::v2::RateLimitServiceConfig& config,
+                    const std::chrono::milliseconds timeout, const std::string& stats_prefix) {
+  if (!config.has_aggregation_window()) {
+    return nullptr;
+  }
+  return std::make_shared<Aggregator>(
+      context.clusterManager().grpcAsyncClientManager().factoryForGrpcService(
+          config.grpc_service(), context.scope(), true),
+      std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(config, aggregation_window)), timeout,
+      context.threadLocal(), stats_prefix, context.scope());
+}
+
 } // namespace RateLimit
 } // namespace Common
 } // namespace Filters
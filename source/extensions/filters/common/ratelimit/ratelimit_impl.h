@@ -2,16 +2,22 @@
 
 #include <chrono>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "envoy/config/bootstrap/v2/bootstrap.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
 #include "envoy/grpc/async_client.h"
 #include "envoy/grpc/async_client_manager.h"
 #include "envoy/ratelimit/ratelimit.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/service/ratelimit/v2/rls.pb.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 #include "envoy/tracing/http_tracer.h"
 #include "envoy/upstream/cluster_manager.h"
 
@@ -73,6 +79,138 @@ private:
   RequestCallbacks* callbacks_{};
 };
 
+/**
+ * All rate limit aggregation stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_RATE_LIMIT_AGGREGATION_STATS(COUNTER)                                                  \
+  COUNTER(aggregated)                                                                              \
+  COUNTER(flushed)                                                                                 \
+  COUNTER(flush_error)
+// clang-format on
+
+/**
+ * Struct definition for all rate limit aggregation stats. @see stats_macros.h
+ */
+struct RateLimitAggregationStats {
+  ALL_RATE_LIMIT_AGGREGATION_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Aggregates the hits of descriptor sets on each worker. Once a worker knows the status of a set
+ * of descriptors, it decides its requests on that status and reports their hits to the rate limit
+ * service with one request per aggregation window, using hits_addend.
+ */
+class Aggregator {
+public:
+  Aggregator(Grpc::AsyncClientFactoryPtr&& async_client_factory,
+             std::chrono::milliseconds window, std::chrono::milliseconds timeout,
+             ThreadLocal::SlotAllocator& tls, const std::string& stats_prefix, Stats::Scope& scope);
+
+  /**
+   * Decide a request on the last status that this worker knows for its descriptors, and count its
+   * hit for the next report.
+   * @param callbacks supplies the callbacks completed inline if the status is known.
+   * @param domain supplies the rate limit domain.
+   * @param descriptors supplies the descriptors of the request.
+   * @return bool whether the status was known and the callbacks were completed.
+   */
+  bool aggregate(RequestCallbacks& callbacks, const std::string& domain,
+                 const std::vector<Envoy::RateLimit::Descriptor>& descriptors);
+
+  /**
+   * Record the status that the rate limit service returned for a request of this worker.
+   * @param domain supplies the rate limit domain.
+   * @param descriptors supplies the descriptors of the request.
+   * @param status supplies the status of the request, which must not be an error.
+   * @param headers supplies the headers returned with the status.
+   */
+  void update(const std::string& domain,
+              const std::vector<Envoy::RateLimit::Descriptor>& descriptors, LimitStatus status,
+              const Http::HeaderMap& headers);
+
+private:
+  struct ThreadLocalAggregation;
+
+  /**
+   * A descriptor set whose status a worker knows, with the hits it hasn't reported yet.
+   */
+  struct Entry : public RateLimitAsyncCallbacks {
+    Entry(ThreadLocalAggregation& parent, const std::string& domain,
+          const std::vector<Envoy::RateLimit::Descriptor>& descriptors)
+        : parent_(parent), domain_(domain), descriptors_(descriptors) {}
+
+    // Grpc::AsyncRequestCallbacks
+    void onCreateInitialMetadata(Http::HeaderMap&) override {}
+    void onSuccess(std::unique_ptr<envoy::service::ratelimit::v2::RateLimitResponse>&& response,
+                   Tracing::Span& span) override;
+    void onFailure(Grpc::Status::GrpcStatus status, const std::string& message,
+                   Tracing::Span& span) override;
+
+    ThreadLocalAggregation& parent_;
+    const std::string domain_;
+    const std::vector<Envoy::RateLimit::Descriptor> descriptors_;
+    // Whether the status is known. It isn't after a report failed, until the next update.
+    bool known_{};
+    LimitStatus status_{LimitStatus::OK};
+    Http::HeaderMapPtr headers_;
+    uint32_t pending_hits_{};
+    Grpc::AsyncRequest* request_{};
+  };
+
+  typedef std::unique_ptr<Entry> EntryPtr;
+
+  struct ThreadLocalAggregation : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalAggregation(Grpc::AsyncClientPtr&& async_client, Event::Dispatcher& dispatcher,
+                           std::chrono::milliseconds window, std::chrono::milliseconds timeout,
+                           const RateLimitAggregationStats& stats);
+    ~ThreadLocalAggregation();
+
+    void flush();
+
+    const Protobuf::MethodDescriptor& service_method_;
+    Grpc::AsyncClientPtr async_client_;
+    const std::chrono::milliseconds window_;
+    const std::chrono::milliseconds timeout_;
+    RateLimitAggregationStats stats_;
+    Event::TimerPtr flush_timer_;
+    std::unordered_map<std::string, EntryPtr> entries_;
+  };
+
+  static std::string key(const std::string& domain,
+                         const std::vector<Envoy::RateLimit::Descriptor>& descriptors);
+
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<Aggregator> AggregatorSharedPtr;
+
+/**
+ * A rate limit client deciding the requests whose descriptors have a known status with an
+ * Aggregator, and sending the others to the rate limit service with its own client.
+ */
+class AggregatingClientImpl : public Client, public RequestCallbacks {
+public:
+  AggregatingClientImpl(AggregatorSharedPtr aggregator, ClientPtr&& client)
+      : aggregator_(std::move(aggregator)), client_(std::move(client)) {}
+
+  // Filters::Common::RateLimit::Client
+  void cancel() override;
+  void limit(RequestCallbacks& callbacks, const std::string& domain,
+             const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+             Tracing::Span& parent_span) override;
+
+  // Filters::Common::RateLimit::RequestCallbacks
+  void complete(LimitStatus status, Http::HeaderMapPtr&& headers) override;
+
+private:
+  const AggregatorSharedPtr aggregator_;
+  const ClientPtr client_;
+  RequestCallbacks* callbacks_{};
+  std::string domain_;
+  std::vector<Envoy::RateLimit::Descriptor> descriptors_;
+};
+
 /**
  * Builds the rate limit client.
  */
@@ -80,6 +218,16 @@ ClientPtr rateLimitClient(Server::Configuration::FactoryContext& context,
                           const envoy::api::v2::core::GrpcService& grpc_service,
                           const std::chrono::milliseconds timeout);
 
+/**
+ * Builds the aggregator of the rate limit requests of a filter.
+ * @return AggregatorSharedPtr the aggregator, nullptr if the config doesn't set an aggregation
+ *         window.
+ */
+AggregatorSharedPtr
+rateLimitAggregator(Server::Configuration::FactoryContext& context,
+                    const envoy::config::ratelimit::v2::RateLimitServiceConfig& config,
+                    const std::chrono::milliseconds timeout, const std::string& stats_prefix);
+
 } // namespace RateLimit
 } // namespace Common
 } // namespace Filters
@@ -1,5 +1,8 @@
 #include "extensions/filters/common/rbac/engine_impl.h"
 
+#include <algorithm>
+#include <map>
+
 #include "common/http/header_map_impl.h"
 
 namespace Envoy {
@@ -8,13 +11,220 @@ namespace Filters {
 namespace Common {
 namespace RBAC {
 
+namespace {
+
+// The conditions of which at least one holds whenever a rule matches.
+struct Preconditions {
+  void add(Preconditions&& other) {
+    source_ips_.insert(source_ips_.end(), other.source_ips_.begin(), other.source_ips_.end());
+    destination_ips_.insert(destination_ips_.end(), other.destination_ips_.begin(),
+                            other.destination_ips_.end());
+    header_values_.insert(header_values_.end(), other.header_values_.begin(),
+                          other.header_values_.end());
+  }
+
+  std::vector<Network::Address::CidrRange> source_ips_;
+  std::vector<Network::Address::CidrRange> destination_ips_;
+  // Pairs of a lower case header name and an exact value.
+  std::vector<std::pair<std::string, std::string>> header_values_;
+};
+
+// Each of the following returns false if the rule may match regardless of the conditions that are
+// indexed, in which case it adds nothing to the preconditions.
+bool collectPreconditions(const envoy::config::rbac::v2alpha::Permission& permission,
+                          Preconditions& preconditions);
+bool collectPreconditions(const envoy::config::rbac::v2alpha::Principal& principal,
+                          Preconditions& preconditions);
+
+// Whenever any of the rules match, the conditions of the one that matches hold.
+template <class Rule>
+bool collectAnyOfPreconditions(const Protobuf::RepeatedPtrField<Rule>& rules,
+                               Preconditions& preconditions) {
+  Preconditions collected;
+  for (const auto& rule : rules) {
+    if (!collectPreconditions(rule, collected)) {
+      return false;
+    }
+  }
+  preconditions.add(std::move(collected));
+  return true;
+}
+
+// Whenever all of the rules match, the conditions of each of them hold, so those of the first rule
+// that has any suffice.
+template <class Rule>
+bool collectAllOfPreconditions(const Protobuf::RepeatedPtrField<Rule>& rules,
+                               Preconditions& preconditions) {
+  for (const auto& rule : rules) {
+    Preconditions collected;
+    if (collectPreconditions(rule, collected)) {
+      preconditions.add(std::move(collected));
+      return true;
+    }
+  }
+  return false;
+}
+
+bool collectIpPreconditions(const envoy::api::v2::core::CidrRange& cidr,
+                            std::vector<Network::Address::CidrRange>& ranges) {
+  const auto range = Network::Address::CidrRange::create(cidr);
+  // An invalid range never matches, so it adds no condition.
+  if (range.isValid()) {
+    ranges.push_back(range);
+  }
+  return true;
+}
+
+bool collectHeaderPreconditions(const envoy::api::v2::route::HeaderMatcher& header,
+                                Preconditions& preconditions) {
+  // An empty exact value matches any value.
+  if (header.header_match_specifier_case() != envoy::api::v2::route::HeaderMatcher::kExactMatch ||
+      header.exact_match().empty() || header.invert_match()) {
+    return false;
+  }
+  preconditions.header_values_.emplace_back(Envoy::Http::LowerCaseString(header.name()).get(),
+                                            header.exact_match());
+  return true;
+}
+
+bool collectPreconditions(const envoy::config::rbac::v2alpha::Permission& permission,
+                          Preconditions& preconditions) {
+  switch (permission.rule_case()) {
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kAndRules:
+    return collectAllOfPreconditions(permission.and_rules().rules(), preconditions);
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kOrRules:
+    return collectAnyOfPreconditions(permission.or_rules().rules(), preconditions);
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kHeader:
+    return collectHeaderPreconditions(permission.header(), preconditions);
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kDestinationIp:
+    return collectIpPreconditions(permission.destination_ip(), preconditions.destination_ips_);
+  default:
+    return false;
+  }
+}
+
+bool collectPreconditions(const envoy::config::rbac::v2alpha::Principal& principal,
+                          Preconditions& preconditions) {
+  switch (principal.identifier_case()) {
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kAndIds:
+    return collectAllOfPreconditions(principal.and_ids().ids(), preconditions);
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kOrIds:
+    return collectAnyOfPreconditions(principal.or_ids().ids(), preconditions);
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kHeader:
+    return collectHeaderPreconditions(principal.header(), preconditions);
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kSourceIp:
+    return collectIpPreconditions(principal.source_ip(), preconditions.source_ips_);
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
 RoleBasedAccessControlEngineImpl::RoleBasedAccessControlEngineImpl(
     const envoy::config::rbac::v2alpha::RBAC& rules)
     : allowed_if_matched_(rules.action() ==
                           envoy::config::rbac::v2alpha::RBAC_Action::RBAC_Action_ALLOW) {
+  // The policies are evaluated in the order of their names, unlike that of the proto map.
+  std::map<std::string, const envoy::config::rbac::v2alpha::Policy*> sorted_policies;
   for (const auto& policy : rules.policies()) {
-    policies_.insert(std::make_pair(policy.first, policy.second));
+    sorted_policies.emplace(policy.first, &policy.second);
+  }
+
+  std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>> source_ips;
+  std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>> destination_ips;
+  size_t source_ranges = 0;
+  size_t destination_ranges = 0;
+  std::map<std::string, PolicyHeaderValues> header_values;
+  for (const auto& policy : sorted_policies) {
+    const uint32_t index = policies_.size();
+    policies_.emplace_back(policy.first, PolicyMatcher(*policy.second));
+
+    // A policy matches only if both a permission and a principal match, so the conditions of
+    // either suffice.
+    Preconditions preconditions;
+    if (!collectPreconditions(policy.second->principals(), preconditions) &&
+        !collectPreconditions(policy.second->permissions(), preconditions)) {
+      unindexed_policies_.push_back(index);
+      continue;
+    }
+    if (!preconditions.source_ips_.empty()) {
+      source_ranges += preconditions.source_ips_.size();
+      source_ips.emplace_back(index, std::move(preconditions.source_ips_));
+    }
+    if (!preconditions.destination_ips_.empty()) {
+      destination_ranges += preconditions.destination_ips_.size();
+      destination_ips.emplace_back(index, std::move(preconditions.destination_ips_));
+    }
+    for (const auto& header_value : preconditions.header_values_) {
+      auto& policies = header_values[header_value.first][header_value.second];
+      if (policies.empty() || policies.back() != index) {
+        policies.push_back(index);
+      }
+    }
+  }
+
+  // The policies whose ranges do not fit into a trie of the default fill factor are not indexed
+  // by them.
+  const auto build_trie =
+      [this](std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>>& data,
+             size_t ranges) -> std::unique_ptr<const PolicyIpTrie> {
+    if (data.empty()) {
+      return nullptr;
+    }
+    if (ranges > Network::LcTrie::MaxLcTrieNodes / 4) {
+      for (const auto& policy : data) {
+        unindexed_policies_.push_back(policy.first);
+      }
+      return nullptr;
+    }
+    return std::make_unique<const PolicyIpTrie>(data);
+  };
+  source_ip_policies_ = build_trie(source_ips, source_ranges);
+  destination_ip_policies_ = build_trie(destination_ips, destination_ranges);
+  std::sort(unindexed_policies_.begin(), unindexed_policies_.end());
+
+  for (auto& header : header_values) {
+    header_policies_.emplace_back(Envoy::Http::LowerCaseString(header.first),
+                                  std::move(header.second));
+  }
+  indexed_ = source_ip_policies_ != nullptr || destination_ip_policies_ != nullptr ||
+             !header_policies_.empty();
+}
+
+std::vector<uint32_t>
+RoleBasedAccessControlEngineImpl::candidatePolicies(const Network::Connection& connection,
+                                                    const Envoy::Http::HeaderMap& headers) const {
+  std::vector<uint32_t> candidates(unindexed_policies_);
+  const auto add = [&candidates](const std::vector<uint32_t>& policies) {
+    candidates.insert(candidates.end(), policies.begin(), policies.end());
+  };
+
+  if (source_ip_policies_ != nullptr) {
+    const auto& address = connection.remoteAddress();
+    if (address->type() == Network::Address::Type::Ip) {
+      add(source_ip_policies_->getData(address));
+    }
+  }
+  if (destination_ip_policies_ != nullptr) {
+    const auto& address = connection.localAddress();
+    if (address->type() == Network::Address::Type::Ip) {
+      add(destination_ip_policies_->getData(address));
+    }
+  }
+  for (const auto& header : header_policies_) {
+    const Envoy::Http::HeaderEntry* entry = headers.get(header.first);
+    if (entry != nullptr) {
+      const auto policies = header.second.find(entry->value().getStringView());
+      if (policies != header.second.end()) {
+        add(policies->second);
+      }
+    }
   }
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  return candidates;
 }
 
 bool RoleBasedAccessControlEngineImpl::allowed(const Network::Connection& connection,
@@ -22,14 +232,28 @@ bool RoleBasedAccessControlEngineImpl::allowed(const Network::Connection& connec
                                                const envoy::api::v2::core::Metadata& metadata,
                                                std::string* effective_policy_id) const {
   bool matched = false;
+  const auto matches = [&](const std::pair<std::string, PolicyMatcher>& policy) {
+    if (!policy.second.matches(connection, headers, metadata)) {
+      return false;
+    }
+    matched = true;
+    if (effective_policy_id != nullptr) {
+      *effective_policy_id = policy.first;
+    }
+    return true;
+  };
 
-  for (auto it = policies_.begin(); it != policies_.end(); it++) {
-    if (it->second.matches(connection, headers, metadata)) {
-      matched = true;
-      if (effective_policy_id != nullptr) {
-        *effective_policy_id = it->first;
+  if (indexed_) {
+    for (const uint32_t index : candidatePolicies(connection, headers)) {
+      if (matches(policies_[index])) {
+        break;
+      }
+    }
+  } else {
+    for (const auto& policy : policies_) {
+      if (matches(policy)) {
+        break;
       }
-      break;
     }
   }
 
@@ -1,16 +1,31 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "envoy/config/filter/http/rbac/v2/rbac.pb.h"
 
+#include "common/network/lc_trie.h"
+
 #include "extensions/filters/common/rbac/engine.h"
 #include "extensions/filters/common/rbac/matchers.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
 namespace Common {
 namespace RBAC {
 
+/**
+ * Evaluates the policies in the order of their names. The policies are indexed by a condition that
+ * holds whenever they match, i.e. by the source or destination IP ranges or the exact header
+ * values of their principals or permissions, so that only the policies whose condition holds for
+ * a request, or that have no such condition, are evaluated.
+ */
 class RoleBasedAccessControlEngineImpl : public RoleBasedAccessControlEngine {
 public:
   RoleBasedAccessControlEngineImpl(const envoy::config::rbac::v2alpha::RBAC& rules);
@@ -24,9 +39,28 @@ public:
                std::string* effective_policy_id) const override;
 
 private:
+  using PolicyIpTrie = Network::LcTrie::LcTrie<uint32_t>;
+  // Maps the exact values of a header to the indexes of the policies that require one of them.
+  using PolicyHeaderValues = absl::flat_hash_map<std::string, std::vector<uint32_t>>;
+
+  /**
+   * @return the indexes into policies_ of the policies that may match, in ascending order.
+   */
+  std::vector<uint32_t> candidatePolicies(const Network::Connection& connection,
+                                          const Envoy::Http::HeaderMap& headers) const;
+
   const bool allowed_if_matched_;
+  // Whether any policy is indexed.
+  bool indexed_{};
 
-  std::map<std::string, PolicyMatcher> policies_;
+  // Ordered by name.
+  std::vector<std::pair<std::string, PolicyMatcher>> policies_;
+  // The policies that are not indexed, in ascending order.
+  std::vector<uint32_t> unindexed_policies_;
+  // Null if no policy is indexed by the respective address.
+  std::unique_ptr<const PolicyIpTrie> source_ip_policies_;
+  std::unique_ptr<const PolicyIpTrie> destination_ip_policies_;
+  std::vector<std::pair<Envoy::Http::LowerCaseString, PolicyHeaderValues>> header_policies_;
 };
 
 } // namespace RBAC
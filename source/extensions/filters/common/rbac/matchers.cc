@@ -1,5 +1,7 @@
 #include "extensions/filters/common/rbac/matchers.h"
 
+#include <algorithm>
+
 #include "common/common/assert.h"
 
 namespace Envoy {
@@ -8,6 +10,25 @@ namespace Filters {
 namespace Common {
 namespace RBAC {
 
+namespace {
+
+// Orders the sub-matchers of a composite matcher by cost, and returns their total cost. The
+// sub-matchers have no side effects, so the order only changes how soon the evaluation
+// short-circuits.
+uint32_t sortByCost(std::vector<MatcherConstSharedPtr>& matchers) {
+  std::stable_sort(matchers.begin(), matchers.end(),
+                   [](const MatcherConstSharedPtr& lhs, const MatcherConstSharedPtr& rhs) {
+                     return lhs->cost() < rhs->cost();
+                   });
+  uint32_t cost = 0;
+  for (const auto& matcher : matchers) {
+    cost += matcher->cost();
+  }
+  return cost;
+}
+
+} // namespace
+
 MatcherConstSharedPtr Matcher::create(const envoy::config::rbac::v2alpha::Permission& permission) {
   switch (permission.rule_case()) {
   case envoy::config::rbac::v2alpha::Permission::RuleCase::kAndRules:
@@ -60,12 +81,14 @@ AndMatcher::AndMatcher(const envoy::config::rbac::v2alpha::Permission_Set& set)
   for (const auto& rule : set.rules()) {
     matchers_.push_back(Matcher::create(rule));
   }
+  cost_ = sortByCost(matchers_);
 }
 
 AndMatcher::AndMatcher(const envoy::config::rbac::v2alpha::Principal_Set& set) {
   for (const auto& id : set.ids()) {
     matchers_.push_back(Matcher::create(id));
   }
+  cost_ = sortByCost(matchers_);
 }
 
 bool AndMatcher::matches(const Network::Connection& connection,
@@ -85,6 +108,7 @@ OrMatcher::OrMatcher(
   for (const auto& rule : rules) {
     matchers_.push_back(Matcher::create(rule));
   }
+  cost_ = sortByCost(matchers_);
 }
 
 OrMatcher::OrMatcher(
@@ -92,6 +116,7 @@ OrMatcher::OrMatcher(
   for (const auto& id : ids) {
     matchers_.push_back(Matcher::create(id));
   }
+  cost_ = sortByCost(matchers_);
 }
 
 bool OrMatcher::matches(const Network::Connection& connection,
@@ -160,6 +185,10 @@ bool MetadataMatcher::matches(const Network::Connection&, const Envoy::Http::Hea
 bool PolicyMatcher::matches(const Network::Connection& connection,
                             const Envoy::Http::HeaderMap& headers,
                             const envoy::api::v2::core::Metadata& metadata) const {
+  if (principals_first_) {
+    return principals_.matches(connection, headers, metadata) &&
+           permissions_.matches(connection, headers, metadata);
+  }
   return permissions_.matches(connection, headers, metadata) &&
          principals_.matches(connection, headers, metadata);
 }
@@ -38,6 +38,12 @@ public:
   virtual bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                        const envoy::api::v2::core::Metadata& metadata) const PURE;
 
+  /**
+   * Returns a relative estimate of the cost of matches(). Composite matchers evaluate their
+   * cheapest sub-matchers first, so that these short-circuit the expensive ones.
+   */
+  virtual uint32_t cost() const PURE;
+
   /**
    * Creates a shared instance of a matcher based off the rules defined in the Permission config
    * proto message.
@@ -60,6 +66,7 @@ public:
                const envoy::api::v2::core::Metadata&) const override {
     return true;
   }
+  uint32_t cost() const override { return 0; }
 };
 
 /**
@@ -73,9 +80,12 @@ public:
 
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata&) const override;
+  uint32_t cost() const override { return cost_; }
 
 private:
+  // Ordered by cost.
   std::vector<MatcherConstSharedPtr> matchers_;
+  uint32_t cost_{};
 };
 
 /**
@@ -91,9 +101,12 @@ public:
 
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata&) const override;
+  uint32_t cost() const override { return cost_; }
 
 private:
+  // Ordered by cost.
   std::vector<MatcherConstSharedPtr> matchers_;
+  uint32_t cost_{};
 };
 
 class NotMatcher : public Matcher {
@@ -106,6 +119,8 @@ public:
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata&) const override;
 
+  uint32_t cost() const override { return matcher_->cost(); }
+
 private:
   MatcherConstSharedPtr matcher_;
 };
@@ -121,6 +136,10 @@ public:
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata&) const override;
 
+  uint32_t cost() const override {
+    return header_.header_match_type_ == Envoy::Http::HeaderUtility::HeaderMatchType::Regex ? 8 : 2;
+  }
+
 private:
   const Envoy::Http::HeaderUtility::HeaderData header_;
 };
@@ -137,6 +156,8 @@ public:
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata&) const override;
 
+  uint32_t cost() const override { return 1; }
+
 private:
   const Network::Address::CidrRange range_;
   const bool destination_;
@@ -152,6 +173,8 @@ public:
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata&) const override;
 
+  uint32_t cost() const override { return 1; }
+
 private:
   const uint32_t port_;
 };
@@ -170,25 +193,32 @@ public:
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata&) const override;
 
+  // Copies the subject alt names of the peer certificate.
+  uint32_t cost() const override { return 4; }
+
 private:
   const absl::optional<Matchers::StringMatcher> matcher_;
 };
 
 /**
  * Matches a Policy which is a collection of permission and principal matchers. If any action
- * matches a permission, the principals are then checked for a match.
+ * matches a permission, the principals are then checked for a match. The principals are checked
+ * first if they are cheaper to match.
  */
 class PolicyMatcher : public Matcher {
 public:
   PolicyMatcher(const envoy::config::rbac::v2alpha::Policy& policy)
-      : permissions_(policy.permissions()), principals_(policy.principals()) {}
+      : permissions_(policy.permissions()), principals_(policy.principals()),
+        principals_first_(principals_.cost() < permissions_.cost()) {}
 
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata&) const override;
+  uint32_t cost() const override { return permissions_.cost() + principals_.cost(); }
 
 private:
   const OrMatcher permissions_;
   const OrMatcher principals_;
+  const bool principals_first_;
 };
 
 class MetadataMatcher : public Matcher {
@@ -198,6 +228,8 @@ public:
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata& metadata) const override;
 
+  uint32_t cost() const override { return 4; }
+
 private:
   const Envoy::Matchers::MetadataMatcher matcher_;
 };
@@ -213,6 +245,7 @@ public:
 
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata&) const override;
+  uint32_t cost() const override { return 2; }
 };
 
 } // namespace RBAC
@@ -0,0 +1,104 @@
+#include "extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
+
+#include <chrono>
+
+#include "envoy/http/codes.h"
+
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+AdaptiveConcurrencyFilterConfig::AdaptiveConcurrencyFilterConfig(
+    const envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency& config,
+    const std::string& stats_prefix, Stats::Scope& scope, TimeSource& time_source,
+    ThreadLocal::SlotAllocator& tls)
+    : controller_config_(config.gradient_controller_config()),
+      stats_prefix_(stats_prefix + "adaptive_concurrency."), scope_(scope),
+      time_source_(time_source), tls_(tls.allocateSlot()) {
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalControllers>();
+  });
+}
+
+GradientController& AdaptiveConcurrencyFilterConfig::controller(const std::string& cluster_name) {
+  auto& local = tls_->getTyped<ThreadLocalControllers>();
+  auto it = local.controllers_.find(cluster_name);
+  if (it != local.controllers_.end()) {
+    return *it->second;
+  }
+
+  GradientControllerSharedPtr controller;
+  {
+    Thread::LockGuard lock(lock_);
+    GradientControllerSharedPtr& shared = controllers_[cluster_name];
+    if (shared == nullptr) {
+      shared = std::make_shared<GradientController>(controller_config_, time_source_, scope_,
+                                                    stats_prefix_ + cluster_name + ".");
+    }
+    controller = shared;
+  }
+  return *local.controllers_.emplace(cluster_name, std::move(controller)).first->second;
+}
+
+Http::FilterHeadersStatus AdaptiveConcurrencyFilter::decodeHeaders(Http::HeaderMap&, bool) {
+  Router::RouteConstSharedPtr route = decoder_callbacks_->route();
+  if (route == nullptr || route->routeEntry() == nullptr) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  GradientController& controller = config_->controller(route->routeEntry()->clusterName());
+  if (controller.forwardingDecision() == RequestForwardingAction::Block) {
+    decoder_callbacks_->sendLocalReply(Http::Code::ServiceUnavailable, "reached concurrency limit",
+                                       nullptr, absl::nullopt);
+    return Http::FilterHeadersStatus::StopIteration;
+  }
+
+  controller_ = &controller;
+  start_time_ = config_->timeSource().monotonicTime();
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterHeadersStatus AdaptiveConcurrencyFilter::encodeHeaders(Http::HeaderMap&,
+                                                                   bool end_stream) {
+  if (end_stream) {
+    onResponseComplete();
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus AdaptiveConcurrencyFilter::encodeData(Buffer::Instance&, bool end_stream) {
+  if (end_stream) {
+    onResponseComplete();
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus AdaptiveConcurrencyFilter::encodeTrailers(Http::HeaderMap&) {
+  onResponseComplete();
+  return Http::FilterTrailersStatus::Continue;
+}
+
+void AdaptiveConcurrencyFilter::onDestroy() {
+  // A reset request is not a latency sample, but no longer counts against the limit.
+  if (controller_ != nullptr) {
+    controller_->cancelLatencySample();
+    controller_ = nullptr;
+  }
+}
+
+void AdaptiveConcurrencyFilter::onResponseComplete() {
+  if (controller_ == nullptr) {
+    return;
+  }
+  controller_->recordLatencySample(std::chrono::duration_cast<std::chrono::microseconds>(
+      config_->timeSource().monotonicTime() - start_time_));
+  controller_ = nullptr;
+}
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
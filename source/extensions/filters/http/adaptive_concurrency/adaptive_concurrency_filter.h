@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/common/time.h"
+#include "envoy/config/filter/http/adaptive_concurrency/v2alpha/adaptive_concurrency.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/stats/scope.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "extensions/filters/http/adaptive_concurrency/gradient_controller.h"
+#include "extensions/filters/http/common/pass_through_filter.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+/**
+ * Configuration for the adaptive concurrency filter, which owns a gradient controller per upstream
+ * cluster. The controllers are shared by the workers, and cached by each of them so that the
+ * requests don't contend on the lock of the controllers.
+ */
+class AdaptiveConcurrencyFilterConfig {
+public:
+  AdaptiveConcurrencyFilterConfig(
+      const envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency&
+          config,
+      const std::string& stats_prefix, Stats::Scope& scope, TimeSource& time_source,
+      ThreadLocal::SlotAllocator& tls);
+
+  /**
+   * @param cluster_name supplies the name of an upstream cluster.
+   * @return GradientController& the controller of the cluster, which is created on first use.
+   */
+  GradientController& controller(const std::string& cluster_name);
+
+  TimeSource& timeSource() { return time_source_; }
+
+private:
+  struct ThreadLocalControllers : public ThreadLocal::ThreadLocalObject {
+    std::unordered_map<std::string, GradientControllerSharedPtr> controllers_;
+  };
+
+  const GradientControllerConfig controller_config_;
+  const std::string stats_prefix_;
+  Stats::Scope& scope_;
+  TimeSource& time_source_;
+  Thread::MutexBasicLockable lock_;
+  std::unordered_map<std::string, GradientControllerSharedPtr> controllers_ GUARDED_BY(lock_);
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<AdaptiveConcurrencyFilterConfig> AdaptiveConcurrencyFilterConfigSharedPtr;
+
+/**
+ * A filter that limits the concurrent requests to the upstream cluster of their route, and
+ * samples the latencies of the forwarded requests to adapt the limit.
+ */
+class AdaptiveConcurrencyFilter : public Http::PassThroughFilter {
+public:
+  AdaptiveConcurrencyFilter(AdaptiveConcurrencyFilterConfigSharedPtr config)
+      : config_(std::move(config)) {}
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap& trailers) override;
+
+private:
+  void onResponseComplete();
+
+  const AdaptiveConcurrencyFilterConfigSharedPtr config_;
+  // The controller of a forwarded request, until its response completes.
+  GradientController* controller_{};
+  MonotonicTime start_time_;
+};
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,33 @@
+#include "extensions/filters/http/adaptive_concurrency/config.h"
+
+#include "envoy/registry/registry.h"
+
+#include "extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+Http::FilterFactoryCb AdaptiveConcurrencyFilterFactory::createFilterFactoryFromProtoTyped(
+    const envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency&
+        proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
+  AdaptiveConcurrencyFilterConfigSharedPtr config =
+      std::make_shared<AdaptiveConcurrencyFilterConfig>(
+          proto_config, stats_prefix, context.scope(), context.timeSource(), context.threadLocal());
+  return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamFilter(std::make_shared<AdaptiveConcurrencyFilter>(config));
+  };
+}
+
+/**
+ * Static registration for the adaptive concurrency filter. @see NamedHttpFilterConfigFactory.
+ */
+REGISTER_FACTORY(AdaptiveConcurrencyFilterFactory,
+                 Server::Configuration::NamedHttpFilterConfigFactory);
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
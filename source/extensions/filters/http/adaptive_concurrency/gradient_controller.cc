@@ -0,0 +1,139 @@
+#include "extensions/filters/http/adaptive_concurrency/gradient_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/common/lock_guard.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+constexpr uint32_t GradientController::MaxSamplesPerInterval;
+
+GradientControllerConfig::GradientControllerConfig(
+    const envoy::config::filter::http::adaptive_concurrency::v2alpha::GradientControllerConfig&
+        config)
+    : sample_aggregate_percentile_(
+          (config.has_sample_aggregate_percentile() ? config.sample_aggregate_percentile().value()
+                                                    : 50.0) /
+          100.0),
+      max_concurrency_limit_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.concurrency_limit_params(),
+                                                             max_concurrency_limit, 1000)),
+      concurrency_update_interval_(PROTOBUF_GET_MS_REQUIRED(config.concurrency_limit_params(),
+                                                            concurrency_update_interval)),
+      min_rtt_calc_interval_(PROTOBUF_GET_MS_REQUIRED(config.min_rtt_calc_params(), interval)),
+      min_rtt_request_count_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.min_rtt_calc_params(), request_count, 50)),
+      min_concurrency_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.min_rtt_calc_params(), min_concurrency, 3)) {}
+
+GradientController::GradientController(const GradientControllerConfig& config,
+                                       TimeSource& time_source, Stats::Scope& scope,
+                                       const std::string& stats_prefix)
+    : config_(config), time_source_(time_source),
+      stats_{ALL_GRADIENT_CONTROLLER_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix),
+                                           POOL_GAUGE_PREFIX(scope, stats_prefix))},
+      concurrency_limit_(config_.minConcurrency()) {
+  Thread::LockGuard lock(lock_);
+  samples_.reserve(config_.minRttRequestCount());
+  next_limit_update_ = time_source_.monotonicTime();
+  startMinRttCalculation();
+}
+
+RequestForwardingAction GradientController::forwardingDecision() {
+  // The request is counted before the comparison, so that concurrent decisions can't all take the
+  // last slot.
+  if (num_rq_outstanding_.fetch_add(1) >= concurrency_limit_.load()) {
+    num_rq_outstanding_--;
+    stats_.rq_blocked_.inc();
+    return RequestForwardingAction::Block;
+  }
+  return RequestForwardingAction::Forward;
+}
+
+void GradientController::cancelLatencySample() { num_rq_outstanding_--; }
+
+void GradientController::recordLatencySample(std::chrono::microseconds rq_latency) {
+  num_rq_outstanding_--;
+  const MonotonicTime now = time_source_.monotonicTime();
+
+  Thread::LockGuard lock(lock_);
+  if (samples_.size() < MaxSamplesPerInterval) {
+    samples_.push_back(rq_latency);
+  }
+
+  if (min_rtt_calculation_active_) {
+    if (samples_.size() < config_.minRttRequestCount()) {
+      return;
+    }
+    min_rtt_ = sampleAggregate();
+    stats_.min_rtt_msecs_.set(
+        std::chrono::duration_cast<std::chrono::milliseconds>(min_rtt_).count());
+    min_rtt_calculation_active_ = false;
+    stats_.min_rtt_calculation_active_.set(0);
+    setConcurrencyLimit(deferred_limit_);
+    samples_.clear();
+    next_min_rtt_calculation_ = now + config_.minRttCalcInterval();
+    next_limit_update_ = now + config_.concurrencyUpdateInterval();
+    return;
+  }
+
+  if (now >= next_min_rtt_calculation_) {
+    startMinRttCalculation();
+    return;
+  }
+
+  if (now >= next_limit_update_) {
+    const std::chrono::microseconds sample_rtt = sampleAggregate();
+    stats_.sample_rtt_msecs_.set(
+        std::chrono::duration_cast<std::chrono::milliseconds>(sample_rtt).count());
+    setConcurrencyLimit(calculateNewLimit(sample_rtt));
+    samples_.clear();
+    next_limit_update_ = now + config_.concurrencyUpdateInterval();
+  }
+}
+
+std::chrono::microseconds GradientController::sampleAggregate() {
+  ASSERT(!samples_.empty());
+  const size_t index =
+      std::min<size_t>(samples_.size() - 1,
+                       static_cast<size_t>(samples_.size() * config_.sampleAggregatePercentile()));
+  std::nth_element(samples_.begin(), samples_.begin() + index, samples_.end());
+  return samples_[index];
+}
+
+uint32_t GradientController::calculateNewLimit(std::chrono::microseconds sample_rtt) {
+  // A gradient under 1 means that the requests queue upstream, and lowers the limit. The gradient
+  // is bounded so that a single interval at most halves or doubles the limit.
+  const double gradient =
+      std::min(2.0, std::max(0.5, static_cast<double>(min_rtt_.count()) /
+                                      std::max<int64_t>(1, sample_rtt.count())));
+  const double limit = concurrency_limit_.load() * gradient;
+  // The headroom lets the limit grow while the latencies are at the minimum round-trip time.
+  const double new_limit = limit + std::sqrt(limit);
+  return static_cast<uint32_t>(
+      std::min<double>(config_.maxConcurrencyLimit(),
+                       std::max<double>(config_.minConcurrency(), std::round(new_limit))));
+}
+
+void GradientController::setConcurrencyLimit(uint32_t limit) {
+  concurrency_limit_ = limit;
+  stats_.concurrency_limit_.set(limit);
+}
+
+void GradientController::startMinRttCalculation() {
+  min_rtt_calculation_active_ = true;
+  stats_.min_rtt_calculation_active_.set(1);
+  stats_.min_rtt_calculations_.inc();
+  deferred_limit_ = concurrency_limit_.load();
+  samples_.clear();
+  setConcurrencyLimit(config_.minConcurrency());
+}
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/config/filter/http/adaptive_concurrency/v2alpha/adaptive_concurrency.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+/**
+ * All gradient controller stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_GRADIENT_CONTROLLER_STATS(COUNTER, GAUGE)                                              \
+  COUNTER(rq_blocked)                                                                              \
+  COUNTER(min_rtt_calculations)                                                                    \
+  GAUGE(concurrency_limit)                                                                         \
+  GAUGE(min_rtt_msecs)                                                                             \
+  GAUGE(sample_rtt_msecs)                                                                          \
+  GAUGE(min_rtt_calculation_active)
+// clang-format on
+
+/**
+ * Struct definition for all gradient controller stats. @see stats_macros.h
+ */
+struct GradientControllerStats {
+  ALL_GRADIENT_CONTROLLER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * The parameters of the gradient controllers.
+ */
+class GradientControllerConfig {
+public:
+  GradientControllerConfig(
+      const envoy::config::filter::http::adaptive_concurrency::v2alpha::GradientControllerConfig&
+          config);
+
+  // The percentile of the sampled latencies compared with the minimum RTT, in [0, 1].
+  double sampleAggregatePercentile() const { return sample_aggregate_percentile_; }
+  uint32_t maxConcurrencyLimit() const { return max_concurrency_limit_; }
+  std::chrono::milliseconds concurrencyUpdateInterval() const {
+    return concurrency_update_interval_;
+  }
+  std::chrono::milliseconds minRttCalcInterval() const { return min_rtt_calc_interval_; }
+  uint32_t minRttRequestCount() const { return min_rtt_request_count_; }
+  uint32_t minConcurrency() const { return min_concurrency_; }
+
+private:
+  const double sample_aggregate_percentile_;
+  const uint32_t max_concurrency_limit_;
+  const std::chrono::milliseconds concurrency_update_interval_;
+  const std::chrono::milliseconds min_rtt_calc_interval_;
+  const uint32_t min_rtt_request_count_;
+  const uint32_t min_concurrency_;
+};
+
+/**
+ * Possible decisions of a concurrency controller on a request.
+ */
+enum class RequestForwardingAction {
+  // The request is under the concurrency limit.
+  Forward,
+  // The request is over the concurrency limit, and must not be forwarded.
+  Block
+};
+
+/**
+ * A concurrency limit following the gradient algorithm of Netflix's concurrency-limits library.
+ * At every update interval, the limit is multiplied by the ratio of the minimum round-trip time to
+ * a percentile of the latencies sampled in the interval, and a headroom of its square root is
+ * added. The minimum round-trip time is measured periodically, with the limit lowered to the
+ * minimum concurrency so that the requests don't queue.
+ *
+ * The limits are recalculated by the requests that complete, rather than by a timer, so that a
+ * controller can be created by any worker. The samples are guarded by a lock, while the
+ * forwarding decisions only use atomics.
+ */
+class GradientController {
+public:
+  GradientController(const GradientControllerConfig& config, TimeSource& time_source,
+                     Stats::Scope& scope, const std::string& stats_prefix);
+
+  /**
+   * Decide whether a request is forwarded. A forwarded request must be completed with
+   * recordLatencySample() or cancelLatencySample().
+   * @return RequestForwardingAction the decision.
+   */
+  RequestForwardingAction forwardingDecision();
+
+  /**
+   * Complete a forwarded request that received its response.
+   * @param rq_latency supplies the time from the request to the end of the response.
+   */
+  void recordLatencySample(std::chrono::microseconds rq_latency);
+
+  /**
+   * Complete a forwarded request that didn't receive its response, without sampling it.
+   */
+  void cancelLatencySample();
+
+  uint32_t concurrencyLimit() const { return concurrency_limit_.load(); }
+
+  // An interval keeps at most this many samples, which are plenty for its percentile.
+  static constexpr uint32_t MaxSamplesPerInterval = 10000;
+
+private:
+  std::chrono::microseconds sampleAggregate() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  uint32_t calculateNewLimit(std::chrono::microseconds sample_rtt) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void setConcurrencyLimit(uint32_t limit);
+  void startMinRttCalculation() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const GradientControllerConfig config_;
+  TimeSource& time_source_;
+  GradientControllerStats stats_;
+  std::atomic<uint32_t> num_rq_outstanding_{0};
+  std::atomic<uint32_t> concurrency_limit_;
+  Thread::MutexBasicLockable lock_;
+  std::vector<std::chrono::microseconds> samples_ GUARDED_BY(lock_);
+  bool min_rtt_calculation_active_ GUARDED_BY(lock_){};
+  // The limit to restore when the minimum round-trip time is measured.
+  uint32_t deferred_limit_ GUARDED_BY(lock_);
+  std::chrono::microseconds min_rtt_ GUARDED_BY(lock_){};
+  MonotonicTime next_min_rtt_calculation_ GUARDED_BY(lock_);
+  MonotonicTime next_limit_update_ GUARDED_BY(lock_);
+};
+
+typedef std::shared_ptr<GradientController> GradientControllerSharedPtr;
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
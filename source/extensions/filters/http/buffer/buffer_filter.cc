@@ -20,7 +20,9 @@ namespace BufferFilter {
 BufferFilterSettings::BufferFilterSettings(
     const envoy::config::filter::http::buffer::v2::Buffer& proto_config)
     : disabled_(false),
-      max_request_bytes_(static_cast<uint64_t>(proto_config.max_request_bytes().value())) {}
+      max_request_bytes_(static_cast<uint64_t>(proto_config.max_request_bytes().value())) {
+  initSpill(proto_config);
+}
 
 BufferFilterSettings::BufferFilterSettings(
     const envoy::config::filter::http::buffer::v2::BufferPerRoute& proto_config)
@@ -28,11 +30,29 @@ BufferFilterSettings::BufferFilterSettings(
       max_request_bytes_(
           proto_config.has_buffer()
               ? static_cast<uint64_t>(proto_config.buffer().max_request_bytes().value())
-              : 0) {}
+              : 0) {
+  if (proto_config.has_buffer()) {
+    initSpill(proto_config.buffer());
+  }
+}
+
+void BufferFilterSettings::initSpill(
+    const envoy::config::filter::http::buffer::v2::Buffer& proto_config) {
+  if (!proto_config.has_spill()) {
+    return;
+  }
+  spill_ = true;
+  max_spilled_request_bytes_ = proto_config.spill().max_request_bytes().value();
+  spill_directory_ =
+      proto_config.spill().directory().empty() ? "/tmp" : proto_config.spill().directory();
+}
 
 BufferFilterConfig::BufferFilterConfig(
-    const envoy::config::filter::http::buffer::v2::Buffer& proto_config)
-    : settings_(proto_config) {}
+    const envoy::config::filter::http::buffer::v2::Buffer& proto_config,
+    const std::string& stats_prefix, Stats::Scope& scope, Api::OsSysCalls& os_sys_calls)
+    : settings_(proto_config),
+      stats_{ALL_BUFFER_FILTER_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix + "buffer."))},
+      os_sys_calls_(os_sys_calls) {}
 
 BufferFilter::BufferFilter(BufferFilterConfigSharedPtr config)
     : config_(config), settings_(config->settings()) {}
@@ -69,24 +89,104 @@ Http::FilterHeadersStatus BufferFilter::decodeHeaders(Http::HeaderMap&, bool end
     return Http::FilterHeadersStatus::Continue;
   }
 
-  callbacks_->setDecoderBufferLimit(settings_->maxRequestBytes());
+  if (!settings_->spill()) {
+    callbacks_->setDecoderBufferLimit(settings_->maxRequestBytes());
+  }
 
   return Http::FilterHeadersStatus::StopIteration;
 }
 
-Http::FilterDataStatus BufferFilter::decodeData(Buffer::Instance&, bool end_stream) {
-  if (end_stream || settings_->disabled()) {
+Http::FilterDataStatus BufferFilter::decodeData(Buffer::Instance& data, bool end_stream) {
+  if (settings_->disabled()) {
     return Http::FilterDataStatus::Continue;
   }
 
-  // Buffer until the complete request has been processed or the ConnectionManagerImpl sends a 413.
-  return Http::FilterDataStatus::StopIterationAndBuffer;
+  if (!settings_->spill()) {
+    if (end_stream) {
+      return Http::FilterDataStatus::Continue;
+    }
+    // Buffer until the complete request has been processed or the ConnectionManagerImpl sends a
+    // 413.
+    return Http::FilterDataStatus::StopIterationAndBuffer;
+  }
+
+  if (local_reply_sent_) {
+    data.drain(data.length());
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+
+  request_bytes_ += data.length();
+  if (request_bytes_ > settings_->maxSpilledRequestBytes()) {
+    config_->stats().rq_too_large_.inc();
+    sendLocalReply(Http::Code::PayloadTooLarge);
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+
+  if (!spill(data) || (end_stream && !releaseBody(data))) {
+    config_->stats().spill_failed_.inc();
+    sendLocalReply(Http::Code::InternalServerError);
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+  return end_stream ? Http::FilterDataStatus::Continue
+                    : Http::FilterDataStatus::StopIterationNoBuffer;
 }
 
 Http::FilterTrailersStatus BufferFilter::decodeTrailers(Http::HeaderMap&) {
+  if (settings_->disabled() || !settings_->spill() || local_reply_sent_) {
+    return Http::FilterTrailersStatus::Continue;
+  }
+
+  Buffer::OwnedImpl body;
+  if (!releaseBody(body)) {
+    config_->stats().spill_failed_.inc();
+    sendLocalReply(Http::Code::InternalServerError);
+    return Http::FilterTrailersStatus::StopIteration;
+  }
+  if (body.length() > 0) {
+    callbacks_->addDecodedData(body, false);
+  }
   return Http::FilterTrailersStatus::Continue;
 }
 
+bool BufferFilter::spill(Buffer::Instance& data) {
+  if (spill_file_ == nullptr &&
+      buffered_.length() + data.length() <= settings_->maxRequestBytes()) {
+    buffered_.move(data);
+    return true;
+  }
+
+  if (spill_file_ == nullptr) {
+    spill_file_ = SpillFile::create(settings_->spillDirectory(), config_->osSysCalls());
+    if (spill_file_ == nullptr) {
+      return false;
+    }
+    config_->stats().rq_spilled_.inc();
+  }
+  const uint64_t length = data.length();
+  if (!spill_file_->append(data)) {
+    return false;
+  }
+  config_->stats().spilled_bytes_.add(length);
+  return true;
+}
+
+bool BufferFilter::releaseBody(Buffer::Instance& data) {
+  data.move(buffered_);
+  if (spill_file_ == nullptr) {
+    return true;
+  }
+  const bool mapped = spill_file_->moveTo(data);
+  spill_file_.reset();
+  return mapped;
+}
+
+void BufferFilter::sendLocalReply(Http::Code code) {
+  local_reply_sent_ = true;
+  buffered_.drain(buffered_.length());
+  spill_file_.reset();
+  callbacks_->sendLocalReply(code, Http::CodeUtility::toString(code), nullptr, absl::nullopt);
+}
+
 void BufferFilter::setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) {
   callbacks_ = &callbacks;
 }
@@ -5,16 +5,40 @@
 #include <memory>
 #include <string>
 
+#include "envoy/api/os_sys_calls.h"
 #include "envoy/config/filter/http/buffer/v2/buffer.pb.h"
+#include "envoy/http/codes.h"
 #include "envoy/http/filter.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 
 #include "common/buffer/buffer_impl.h"
 
+#include "extensions/filters/http/buffer/spill_file.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
 namespace BufferFilter {
 
+/**
+ * All buffer filter stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_BUFFER_FILTER_STATS(COUNTER)                                                           \
+  COUNTER(rq_spilled)                                                                              \
+  COUNTER(spilled_bytes)                                                                           \
+  COUNTER(spill_failed)                                                                            \
+  COUNTER(rq_too_large)
+// clang-format on
+
+/**
+ * Struct definition for all buffer filter stats. @see stats_macros.h
+ */
+struct BufferFilterStats {
+  ALL_BUFFER_FILTER_STATS(GENERATE_COUNTER_STRUCT)
+};
+
 class BufferFilterSettings : public Router::RouteSpecificFilterConfig {
 public:
   BufferFilterSettings(const envoy::config::filter::http::buffer::v2::Buffer&);
@@ -22,10 +46,19 @@ public:
 
   bool disabled() const { return disabled_; }
   uint64_t maxRequestBytes() const { return max_request_bytes_; }
+  // Whether the bytes beyond maxRequestBytes() are written to a temporary file.
+  bool spill() const { return spill_; }
+  uint64_t maxSpilledRequestBytes() const { return max_spilled_request_bytes_; }
+  const std::string& spillDirectory() const { return spill_directory_; }
 
 private:
+  void initSpill(const envoy::config::filter::http::buffer::v2::Buffer& proto_config);
+
   bool disabled_;
   uint64_t max_request_bytes_;
+  bool spill_{};
+  uint64_t max_spilled_request_bytes_{};
+  std::string spill_directory_;
 };
 
 /**
@@ -33,18 +66,26 @@ private:
  */
 class BufferFilterConfig {
 public:
-  BufferFilterConfig(const envoy::config::filter::http::buffer::v2::Buffer& proto_config);
+  BufferFilterConfig(const envoy::config::filter::http::buffer::v2::Buffer& proto_config,
+                     const std::string& stats_prefix, Stats::Scope& scope,
+                     Api::OsSysCalls& os_sys_calls);
 
   const BufferFilterSettings* settings() const { return &settings_; }
+  BufferFilterStats& stats() { return stats_; }
+  Api::OsSysCalls& osSysCalls() { return os_sys_calls_; }
 
 private:
   const BufferFilterSettings settings_;
+  BufferFilterStats stats_;
+  Api::OsSysCalls& os_sys_calls_;
 };
 
 typedef std::shared_ptr<BufferFilterConfig> BufferFilterConfigSharedPtr;
 
 /**
- * A filter that is capable of buffering an entire request before dispatching it upstream.
+ * A filter that is capable of buffering an entire request before dispatching it upstream. When
+ * spilling, the filter buffers the request itself rather than in the connection manager, so that
+ * the bytes beyond the memory limit can be written to a temporary file.
  */
 class BufferFilter : public Http::StreamDecoderFilter {
 public:
@@ -61,11 +102,20 @@ public:
 
 private:
   void initConfig();
+  // Buffers data in memory, or in the spill file once the memory limit is reached.
+  bool spill(Buffer::Instance& data);
+  // Moves the buffered request body to data.
+  bool releaseBody(Buffer::Instance& data);
+  void sendLocalReply(Http::Code code);
 
   BufferFilterConfigSharedPtr config_;
   const BufferFilterSettings* settings_;
   Http::StreamDecoderFilterCallbacks* callbacks_{};
   bool config_initialized_{};
+  Buffer::OwnedImpl buffered_;
+  SpillFilePtr spill_file_;
+  uint64_t request_bytes_{};
+  bool local_reply_sent_{};
 };
 
 } // namespace BufferFilter
@@ -7,6 +7,7 @@
 #include "envoy/config/filter/http/buffer/v2/buffer.pb.validate.h"
 #include "envoy/registry/registry.h"
 
+#include "common/api/os_sys_calls_impl.h"
 #include "common/config/filter_json.h"
 
 #include "extensions/filters/http/buffer/buffer_filter.h"
@@ -17,11 +18,12 @@ namespace HttpFilters {
 namespace BufferFilter {
 
 Http::FilterFactoryCb BufferFilterFactory::createFilterFactoryFromProtoTyped(
-    const envoy::config::filter::http::buffer::v2::Buffer& proto_config, const std::string&,
-    Server::Configuration::FactoryContext&) {
+    const envoy::config::filter::http::buffer::v2::Buffer& proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
   ASSERT(proto_config.has_max_request_bytes());
 
-  BufferFilterConfigSharedPtr filter_config(new BufferFilterConfig(proto_config));
+  BufferFilterConfigSharedPtr filter_config(new BufferFilterConfig(
+      proto_config, stats_prefix, context.scope(), Api::OsSysCallsSingleton::get()));
   return [filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamDecoderFilter(std::make_shared<BufferFilter>(filter_config));
   };
@@ -0,0 +1,98 @@
+#include "extensions/filters/http/buffer/spill_file.h"
+
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace BufferFilter {
+
+namespace {
+// The slices written by a single writev().
+constexpr uint64_t MaxSlicesPerWrite = 16;
+} // namespace
+
+SpillFilePtr SpillFile::create(const std::string& directory, Api::OsSysCalls& os_sys_calls) {
+  std::string path = directory + "/envoy_buffer_XXXXXX";
+  const int fd = ::mkstemp(&path[0]);
+  if (fd < 0) {
+    ENVOY_LOG(warn, "buffer: unable to create a spill file in {}: {}", directory, strerror(errno));
+    return nullptr;
+  }
+  ::unlink(path.c_str());
+  return SpillFilePtr{new SpillFile(fd, os_sys_calls)};
+}
+
+SpillFile::~SpillFile() {
+  if (fd_ >= 0) {
+    os_sys_calls_.close(fd_);
+  }
+}
+
+bool SpillFile::append(Buffer::Instance& data) {
+  ASSERT(fd_ >= 0);
+  Buffer::RawSlice slices[MaxSlicesPerWrite];
+  iovec iov[MaxSlicesPerWrite];
+  while (data.length() > 0) {
+    const uint64_t num_slices =
+        std::min(data.getRawSlices(slices, MaxSlicesPerWrite), MaxSlicesPerWrite);
+    for (uint64_t i = 0; i < num_slices; i++) {
+      iov[i].iov_base = slices[i].mem_;
+      iov[i].iov_len = slices[i].len_;
+    }
+    const Api::SysCallSizeResult result = os_sys_calls_.writev(fd_, iov, num_slices);
+    if (result.rc_ < 0) {
+      if (result.errno_ == EINTR) {
+        continue;
+      }
+      ENVOY_LOG(warn, "buffer: unable to write to a spill file: {}", strerror(result.errno_));
+      return false;
+    }
+    size_ += result.rc_;
+    data.drain(result.rc_);
+  }
+  return true;
+}
+
+bool SpillFile::moveTo(Buffer::Instance& data) {
+  ASSERT(fd_ >= 0);
+  if (size_ == 0) {
+    os_sys_calls_.close(fd_);
+    fd_ = -1;
+    return true;
+  }
+
+  const Api::SysCallPtrResult result =
+      os_sys_calls_.mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  // The mapping outlives the descriptor.
+  os_sys_calls_.close(fd_);
+  fd_ = -1;
+  if (result.rc_ == MAP_FAILED) {
+    ENVOY_LOG(warn, "buffer: unable to map a spill file: {}", strerror(result.errno_));
+    return false;
+  }
+
+  Api::OsSysCalls& os_sys_calls = os_sys_calls_;
+  data.addBufferFragment(*new Buffer::BufferFragmentImpl(
+      result.rc_, size_,
+      [&os_sys_calls](const void* mapping, size_t size, const Buffer::BufferFragmentImpl* self) {
+        os_sys_calls.munmap(const_cast<void*>(mapping), size);
+        delete self;
+      }));
+  return true;
+}
+
+} // namespace BufferFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/buffer/buffer.h"
+
+#include "common/common/logger.h"
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace BufferFilter {
+
+class SpillFile;
+typedef std::unique_ptr<SpillFile> SpillFilePtr;
+
+/**
+ * A temporary file holding the part of a request body that doesn't fit in memory. The file is
+ * removed from its directory when it is created, so that it is reclaimed once closed, even if
+ * Envoy exits.
+ */
+class SpillFile : NonCopyable, Logger::Loggable<Logger::Id::filter> {
+public:
+  ~SpillFile();
+
+  /**
+   * Create a temporary file.
+   * @param directory supplies the directory of the file.
+   * @param os_sys_calls supplies the system calls writing and mapping the file.
+   * @return SpillFilePtr the file, or nullptr if it can't be created.
+   */
+  static SpillFilePtr create(const std::string& directory, Api::OsSysCalls& os_sys_calls);
+
+  /**
+   * Write data at the end of the file.
+   * @param data supplies the data, which is drained as it is written.
+   * @return bool whether all the data was written.
+   */
+  bool append(Buffer::Instance& data);
+
+  /**
+   * Map the content of the file, and add it to a buffer as a fragment that unmaps it once
+   * released. The file is closed, and can't be appended to anymore.
+   * @param data supplies the buffer.
+   * @return bool whether the file could be mapped.
+   */
+  bool moveTo(Buffer::Instance& data);
+
+  /**
+   * @return uint64_t the number of bytes written to the file.
+   */
+  uint64_t size() const { return size_; }
+
+private:
+  SpillFile(int fd, Api::OsSysCalls& os_sys_calls) : fd_(fd), os_sys_calls_(os_sys_calls) {}
+
+  int fd_;
+  Api::OsSysCalls& os_sys_calls_;
+  uint64_t size_{};
+};
+
+} // namespace BufferFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,362 @@
+#include "extensions/filters/http/cache/cache_filter.h"
+
+#include "envoy/http/codes.h"
+#include "envoy/http_cache/http_cache_config.h"
+
+#include "common/config/utility.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/http/utility.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/cache/cache_policy.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+// Default maximum size of a cached body.
+const uint64_t DefaultMaxBodyBytes = 1024 * 1024;
+
+// Default time a collapsed request waits for the response of its leader.
+const uint64_t DefaultCoalescingTimeoutMs = 5000;
+
+// Returns whether a method is safe, so that its requests don't invalidate the stored responses.
+// @see RFC 7231 section 4.2.1.
+bool safeMethod(const Http::HeaderString& method) {
+  return method == Http::Headers::get().MethodValues.Get.c_str() ||
+         method == Http::Headers::get().MethodValues.Head.c_str() ||
+         method == Http::Headers::get().MethodValues.Options.c_str() || method == "TRACE";
+}
+} // namespace
+
+CacheFilterConfig::CacheFilterConfig(
+    const envoy::config::filter::http::cache::v2alpha::Cache& config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context)
+    : cache_(createCache(config.storage(), stats_prefix + "cache.", context)),
+      max_body_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_body_bytes, DefaultMaxBodyBytes)),
+      time_source_(context.timeSource()),
+      coalescer_(config.has_coalescing() ? std::make_unique<RequestCoalescer>() : nullptr),
+      coalescing_timeout_(
+          PROTOBUF_GET_MS_OR_DEFAULT(config.coalescing(), timeout, DefaultCoalescingTimeoutMs)),
+      stats_{ALL_CACHE_STATS(POOL_COUNTER_PREFIX(context.scope(), stats_prefix + "cache."))} {}
+
+Envoy::HttpCache::HttpCacheSharedPtr CacheFilterConfig::createCache(
+    const envoy::config::filter::http::cache::v2alpha::Cache::Storage& storage,
+    const std::string& prefix, Server::Configuration::FactoryContext& context) {
+  auto& factory =
+      Config::Utility::getAndCheckFactory<Envoy::HttpCache::NamedHttpCacheConfigFactory>(
+          storage.name());
+  ProtobufTypes::MessagePtr message = Config::Utility::translateToFactoryConfig(storage, factory);
+  return factory.createHttpCacheFromProto(*message, prefix, context);
+}
+
+void CacheFilter::onDestroy() {
+  destroyed_ = true;
+  stopWaiting();
+  release(false);
+}
+
+Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
+  if (!CachePolicy::requestCacheable(headers)) {
+    if (headers.Method() != nullptr && !safeMethod(headers.Method()->value()) &&
+        headers.Path() != nullptr && headers.Host() != nullptr) {
+      invalidated_key_ = urlKey(headers);
+    }
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  key_ = urlKey(headers);
+  request_headers_ = &headers;
+  if (lookupAndServe(headers) || !lead()) {
+    return Http::FilterHeadersStatus::StopIteration;
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+bool CacheFilter::lookupAndServe(Http::HeaderMap& headers) {
+  Envoy::HttpCache::CacheEntryConstSharedPtr entry = lookup(headers);
+  if (entry == nullptr) {
+    return false;
+  }
+  if (CachePolicy::fresh(*entry, headers, config_->timeSource().systemTime())) {
+    config_->stats().hit_.inc();
+    serve(*entry, headers);
+    return true;
+  }
+
+  // A stale response with a validator is validated with a conditional request, unless the client
+  // validates its own copy.
+  const Http::HeaderEntry* etag = entry->headers_->get(Http::Headers::get().Etag);
+  const Http::HeaderEntry* last_modified =
+      entry->headers_->get(Http::Headers::get().LastModified);
+  if ((etag == nullptr && last_modified == nullptr) ||
+      headers.get(CacheHeaders::get().IfNoneMatch) != nullptr ||
+      headers.get(CacheHeaders::get().IfModifiedSince) != nullptr) {
+    return false;
+  }
+  if (etag != nullptr) {
+    headers.addCopy(CacheHeaders::get().IfNoneMatch, etag->value().getStringView());
+  }
+  if (last_modified != nullptr) {
+    headers.addCopy(CacheHeaders::get().IfModifiedSince, last_modified->value().getStringView());
+  }
+  validated_entry_ = std::move(entry);
+  return false;
+}
+
+bool CacheFilter::lead() {
+  RequestCoalescer* coalescer = config_->coalescer();
+  if (coalescer == nullptr) {
+    return true;
+  }
+  auto waiter = std::make_shared<RequestCoalescer::Waiter>(
+      decoder_callbacks_->dispatcher(), [this](bool stored) -> void { onRelease(stored); });
+  if (coalescer->join(entry_key_, waiter)) {
+    led_key_ = entry_key_;
+    return true;
+  }
+
+  config_->stats().coalesced_.inc();
+  waiter_ = std::move(waiter);
+  if (coalescing_timer_ == nullptr) {
+    coalescing_timer_ =
+        decoder_callbacks_->dispatcher().createTimer([this]() -> void { onCoalescingTimeout(); });
+  }
+  coalescing_timer_->enableTimer(config_->coalescingTimeout());
+  return false;
+}
+
+void CacheFilter::onRelease(bool stored) {
+  stopWaiting();
+  // Once the response of the leader is stored, the request is served from the cache, unless it
+  // selects another variant, which it then leads or waits for.
+  if (stored && (lookupAndServe(*request_headers_) || !lead())) {
+    return;
+  }
+  decoder_callbacks_->continueDecoding();
+}
+
+void CacheFilter::onCoalescingTimeout() {
+  config_->stats().coalescing_timeout_.inc();
+  stopWaiting();
+  decoder_callbacks_->continueDecoding();
+}
+
+void CacheFilter::stopWaiting() {
+  if (waiter_ != nullptr) {
+    waiter_->wake_ = nullptr;
+    waiter_ = nullptr;
+  }
+  if (coalescing_timer_ != nullptr) {
+    coalescing_timer_->disableTimer();
+  }
+}
+
+void CacheFilter::release(bool stored) {
+  if (!led_key_.empty()) {
+    config_->coalescer()->release(led_key_, stored);
+    led_key_.clear();
+  }
+}
+
+Http::FilterHeadersStatus CacheFilter::encodeHeaders(Http::HeaderMap& headers, bool end_stream) {
+  if (serving_) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  const uint64_t status = Http::Utility::getResponseStatus(headers);
+  if (!invalidated_key_.empty()) {
+    // Removing the key of the URL also removes the way to the variants of its responses.
+    if (status >= 200 && status < 400) {
+      config_->stats().invalidated_.inc();
+      config_->cache().remove(invalidated_key_);
+    }
+    return Http::FilterHeadersStatus::Continue;
+  }
+  if (key_.empty()) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  if (validated_entry_ != nullptr &&
+      status == static_cast<uint64_t>(Http::Code::NotModified)) {
+    config_->stats().validated_.inc();
+    updateValidatedEntry(headers);
+    release(true);
+    const std::shared_ptr<const std::string>& body = validated_entry_->body_;
+    if (end_stream) {
+      if (body != nullptr && !body->empty()) {
+        // The body is encoded inline after the headers.
+        encoder_callbacks_->addEncodedData(*bodyBuffer(body), false);
+      }
+    } else {
+      replace_body_ = true;
+    }
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  config_->stats().miss_.inc();
+  if (!CachePolicy::responseStorable(headers)) {
+    release(false);
+    return Http::FilterHeadersStatus::Continue;
+  }
+  response_headers_ = std::make_unique<Http::HeaderMapImpl>(headers);
+  if (end_stream) {
+    store();
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus CacheFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (serving_) {
+    return Http::FilterDataStatus::Continue;
+  }
+  if (replace_body_) {
+    data.drain(data.length());
+    const std::shared_ptr<const std::string>& body = validated_entry_->body_;
+    if (end_stream && body != nullptr && !body->empty()) {
+      data.move(*bodyBuffer(body));
+    }
+    return Http::FilterDataStatus::Continue;
+  }
+  if (response_headers_ == nullptr) {
+    return Http::FilterDataStatus::Continue;
+  }
+
+  if (body_.length() + data.length() > config_->maxBodyBytes()) {
+    response_headers_ = nullptr;
+    body_.drain(body_.length());
+    release(false);
+    return Http::FilterDataStatus::Continue;
+  }
+  body_.add(data);
+  if (end_stream) {
+    store();
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus CacheFilter::encodeTrailers(Http::HeaderMap&) {
+  if (serving_) {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  if (replace_body_) {
+    const std::shared_ptr<const std::string>& body = validated_entry_->body_;
+    if (body != nullptr && !body->empty()) {
+      encoder_callbacks_->addEncodedData(*bodyBuffer(body), false);
+    }
+  }
+  // The stored responses don't have trailers, so that the responses with trailers aren't stored.
+  response_headers_ = nullptr;
+  body_.drain(body_.length());
+  release(false);
+  return Http::FilterTrailersStatus::Continue;
+}
+
+std::string CacheFilter::urlKey(const Http::HeaderMap& request_headers) {
+  return absl::StrCat(request_headers.Host()->value().getStringView(), "\n",
+                      request_headers.Path()->value().getStringView());
+}
+
+Envoy::HttpCache::CacheEntryConstSharedPtr
+CacheFilter::lookup(const Http::HeaderMap& request_headers) {
+  Envoy::HttpCache::CacheEntryConstSharedPtr entry = config_->cache().lookup(key_);
+  entry_key_ = key_;
+  if (entry != nullptr && entry->headers_ == nullptr) {
+    // The responses of the URL vary, the entry of the URL only lists the headers they vary on.
+    entry_key_ = CachePolicy::variantKey(key_, entry->vary_, request_headers);
+    entry = config_->cache().lookup(entry_key_);
+  }
+  return entry;
+}
+
+void CacheFilter::serve(const Envoy::HttpCache::CacheEntry& entry,
+                        const Http::HeaderMap& request_headers) {
+  Http::HeaderMapPtr headers = std::make_unique<Http::HeaderMapImpl>(*entry.headers_);
+  headers->remove(CacheHeaders::get().Age);
+  headers->addReferenceKey(
+      CacheHeaders::get().Age,
+      CachePolicy::currentAge(entry, config_->timeSource().systemTime()).count());
+  serving_ = true;
+
+  if (CachePolicy::notModified(entry, request_headers)) {
+    headers->insertStatus().value(static_cast<uint64_t>(Http::Code::NotModified));
+    headers->removeContentLength();
+    decoder_callbacks_->encodeHeaders(std::move(headers), true);
+    return;
+  }
+
+  const bool end_stream = entry.body_ == nullptr || entry.body_->empty();
+  decoder_callbacks_->encodeHeaders(std::move(headers), end_stream);
+  if (!end_stream && !destroyed_) {
+    decoder_callbacks_->encodeData(*bodyBuffer(entry.body_), true);
+  }
+}
+
+void CacheFilter::updateValidatedEntry(Http::HeaderMap& headers) {
+  // The headers of the 304 replace the stored ones, and the stored ones complete them. The
+  // content-length of the stored response describes its body.
+  headers.removeContentLength();
+  validated_entry_->headers_->iterate(
+      [](const Http::HeaderEntry& header, void* context) -> Http::HeaderMap::Iterate {
+        auto* headers = static_cast<Http::HeaderMap*>(context);
+        const Http::LowerCaseString key(std::string(header.key().getStringView()));
+        if (headers->get(key) == nullptr) {
+          headers->addCopy(key, header.value().getStringView());
+        }
+        return Http::HeaderMap::Iterate::Continue;
+      },
+      &headers);
+  headers.insertStatus().value(Http::Utility::getResponseStatus(*validated_entry_->headers_));
+
+  auto entry = std::make_shared<Envoy::HttpCache::CacheEntry>();
+  entry->headers_ = std::make_unique<Http::HeaderMapImpl>(headers);
+  entry->body_ = validated_entry_->body_;
+  entry->response_time_ = config_->timeSource().systemTime();
+  entry->vary_ = validated_entry_->vary_;
+  config_->cache().insert(entry_key_, std::move(entry));
+}
+
+void CacheFilter::store() {
+  auto entry = std::make_shared<Envoy::HttpCache::CacheEntry>();
+  entry->vary_ = CachePolicy::varyHeaders(*response_headers_);
+  entry->headers_ = std::move(response_headers_);
+  entry->body_ = std::make_shared<const std::string>(body_.toString());
+  body_.drain(body_.length());
+  entry->response_time_ = config_->timeSource().systemTime();
+
+  if (entry->vary_.empty()) {
+    config_->cache().insert(key_, std::move(entry));
+  } else {
+    // The entry of the URL lists the headers the responses vary on, so that lookups find the
+    // variant of their request headers.
+    auto vary_entry = std::make_shared<Envoy::HttpCache::CacheEntry>();
+    vary_entry->vary_ = entry->vary_;
+    vary_entry->response_time_ = entry->response_time_;
+    const std::string variant_key = CachePolicy::variantKey(key_, entry->vary_, *request_headers_);
+    config_->cache().insert(key_, std::move(vary_entry));
+    config_->cache().insert(variant_key, std::move(entry));
+  }
+  config_->stats().stored_.inc();
+  release(true);
+}
+
+Buffer::InstancePtr CacheFilter::bodyBuffer(const std::shared_ptr<const std::string>& body) {
+  // The fragment holds a reference to the body, which outlives the stored entry if it is evicted.
+  auto* fragment = new Buffer::BufferFragmentImpl(
+      body->data(), body->size(),
+      [body](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+        delete fragment;
+      });
+  Buffer::InstancePtr buffer = std::make_unique<Buffer::OwnedImpl>();
+  buffer->addBufferFragment(*fragment);
+  return buffer;
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/event/timer.h"
+#include "envoy/config/filter/http/cache/v2alpha/cache.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/http/header_map.h"
+#include "envoy/http_cache/http_cache.h"
+#include "envoy/server/filter_config.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/buffer/buffer_impl.h"
+
+#include "extensions/filters/http/cache/request_coalescer.h"
+#include "extensions/filters/http/common/pass_through_filter.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * All cache filter stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_CACHE_STATS(COUNTER)                                                                   \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(validated)                                                                               \
+  COUNTER(stored)                                                                                  \
+  COUNTER(invalidated)                                                                             \
+  COUNTER(coalesced)                                                                               \
+  COUNTER(coalescing_timeout)
+// clang-format on
+
+/**
+ * Struct definition for all cache filter stats. @see stats_macros.h
+ */
+struct CacheStats {
+  ALL_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration for the cache filter.
+ */
+class CacheFilterConfig {
+public:
+  CacheFilterConfig(const envoy::config::filter::http::cache::v2alpha::Cache& config,
+                    const std::string& stats_prefix,
+                    Server::Configuration::FactoryContext& context);
+
+  Envoy::HttpCache::HttpCache& cache() { return *cache_; }
+  uint64_t maxBodyBytes() const { return max_body_bytes_; }
+  TimeSource& timeSource() { return time_source_; }
+  // nullptr when the requests aren't coalesced.
+  RequestCoalescer* coalescer() const { return coalescer_.get(); }
+  std::chrono::milliseconds coalescingTimeout() const { return coalescing_timeout_; }
+  CacheStats& stats() { return stats_; }
+
+private:
+  static Envoy::HttpCache::HttpCacheSharedPtr
+  createCache(const envoy::config::filter::http::cache::v2alpha::Cache::Storage& storage,
+              const std::string& prefix, Server::Configuration::FactoryContext& context);
+
+  const Envoy::HttpCache::HttpCacheSharedPtr cache_;
+  const uint64_t max_body_bytes_;
+  TimeSource& time_source_;
+  const RequestCoalescerPtr coalescer_;
+  const std::chrono::milliseconds coalescing_timeout_;
+  CacheStats stats_;
+};
+
+typedef std::shared_ptr<CacheFilterConfig> CacheFilterConfigSharedPtr;
+
+/**
+ * A filter serving GET requests from the responses stored by earlier requests, as a shared cache
+ * following RFC 7234. Stale responses with a validator are validated with conditional requests.
+ * Unsafe requests that succeed invalidate the stored response of their URL. The concurrent requests
+ * missing the same response may be collapsed into one.
+ */
+class CacheFilter : public Http::PassThroughFilter {
+public:
+  CacheFilter(const CacheFilterConfigSharedPtr& config) : config_(config) {}
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap& trailers) override;
+
+private:
+  /**
+   * @return the key of the URL of a request.
+   */
+  static std::string urlKey(const Http::HeaderMap& request_headers);
+
+  /**
+   * Look up the response stored for a request, selecting the variant of the request headers if
+   * the responses of the URL vary. Sets entry_key_ to the key of the variant.
+   */
+  Envoy::HttpCache::CacheEntryConstSharedPtr lookup(const Http::HeaderMap& request_headers);
+
+  /**
+   * Serve the request from the cache if it has a fresh response for it, or else prepare the
+   * validation of a stale response.
+   * @return bool whether the request was served.
+   */
+  bool lookupAndServe(Http::HeaderMap& request_headers);
+
+  /**
+   * Lead the key of the missed response if the requests are coalesced, or else wait for it.
+   * @return bool whether the request is to be forwarded now.
+   */
+  bool lead();
+  void onRelease(bool stored);
+  void onCoalescingTimeout();
+  void stopWaiting();
+
+  /**
+   * Release the key led by the request, if any, waking the requests waiting for it.
+   */
+  void release(bool stored);
+
+  /**
+   * Answer the request with a fresh stored response, without forwarding the request.
+   */
+  void serve(const Envoy::HttpCache::CacheEntry& entry, const Http::HeaderMap& request_headers);
+
+  /**
+   * Turn the 304 answering a validation into the stored response, with the headers of the 304
+   * (RFC 7234 section 4.3.4), and store it again as fresh.
+   */
+  void updateValidatedEntry(Http::HeaderMap& headers);
+
+  /**
+   * Store the response with the body buffered so far.
+   */
+  void store();
+
+  /**
+   * @return Buffer::InstancePtr a buffer referencing the body of a stored response, without
+   *         copying it.
+   */
+  static Buffer::InstancePtr bodyBuffer(const std::shared_ptr<const std::string>& body);
+
+  const CacheFilterConfigSharedPtr config_;
+  // The key of the URL of a cacheable request, empty if the request doesn't use the cache.
+  std::string key_;
+  // The key of the URL of an unsafe request, invalidated if it succeeds.
+  std::string invalidated_key_;
+  // The key of the variant of the stored response of the request.
+  std::string entry_key_;
+  Http::HeaderMap* request_headers_{};
+  // The key led by the request, and the wait of the request for the key led by another one.
+  std::string led_key_;
+  RequestCoalescer::WaiterSharedPtr waiter_;
+  Event::TimerPtr coalescing_timer_;
+  // The stale response validated by a conditional request.
+  Envoy::HttpCache::CacheEntryConstSharedPtr validated_entry_;
+  // The response being stored, and its body buffered so far.
+  Http::HeaderMapPtr response_headers_;
+  Buffer::OwnedImpl body_;
+  // Whether the body of the validated response replaces the body of the 304.
+  bool replace_body_{};
+  // Whether the filter is encoding the response it serves.
+  bool serving_{};
+  bool destroyed_{};
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,297 @@
+#include "extensions/filters/http/cache/cache_policy.h"
+
+#include <algorithm>
+
+#include "common/common/utility.h"
+#include "common/http/headers.h"
+#include "common/http/utility.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/time/time.h"
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+// Delta-seconds bigger than this are taken as this. @see RFC 7234 section 1.2.1.
+const uint64_t MaxDeltaSeconds = 2147483648;
+
+// Returns the delta-seconds of a directive value, 0 if it is malformed so that the response is
+// stale.
+std::chrono::seconds deltaSeconds(absl::string_view value) {
+  uint64_t seconds;
+  if (!absl::SimpleAtoi(value, &seconds)) {
+    return std::chrono::seconds(0);
+  }
+  return std::chrono::seconds(std::min(seconds, MaxDeltaSeconds));
+}
+
+// Returns an entity tag without its weakness indicator, for the weak comparison of RFC 7232
+// section 2.3.2.
+absl::string_view opaqueTag(absl::string_view entity_tag) {
+  entity_tag = StringUtil::trim(entity_tag);
+  if (entity_tag.size() >= 2 && entity_tag.substr(0, 2) == "W/") {
+    entity_tag.remove_prefix(2);
+  }
+  return entity_tag;
+}
+} // namespace
+
+CacheControl CachePolicy::cacheControl(const Http::HeaderMap& headers) {
+  CacheControl cache_control;
+  const Http::HeaderEntry* header = headers.CacheControl();
+  if (header == nullptr) {
+    return cache_control;
+  }
+  for (const absl::string_view directive :
+       StringUtil::splitToken(header->value().getStringView(), ",")) {
+    const absl::string_view::size_type equals = directive.find('=');
+    const absl::string_view name = StringUtil::trim(directive.substr(0, equals));
+    absl::string_view value;
+    if (equals != absl::string_view::npos) {
+      value = StringUtil::trim(directive.substr(equals + 1));
+      if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        value = value.substr(1, value.size() - 2);
+      }
+    }
+
+    // The field names of no-cache and private aren't honored, the whole response is affected.
+    if (StringUtil::caseCompare(name, "no-cache")) {
+      cache_control.no_cache_ = true;
+    } else if (StringUtil::caseCompare(name, "no-store")) {
+      cache_control.no_store_ = true;
+    } else if (StringUtil::caseCompare(name, "private")) {
+      cache_control.private_ = true;
+    } else if (StringUtil::caseCompare(name, "public")) {
+      cache_control.public_ = true;
+    } else if (StringUtil::caseCompare(name, "must-revalidate") ||
+               StringUtil::caseCompare(name, "proxy-revalidate")) {
+      cache_control.must_revalidate_ = true;
+    } else if (StringUtil::caseCompare(name, "max-age")) {
+      cache_control.max_age_ = deltaSeconds(value);
+    } else if (StringUtil::caseCompare(name, "s-maxage")) {
+      cache_control.s_maxage_ = deltaSeconds(value);
+    } else if (StringUtil::caseCompare(name, "min-fresh")) {
+      cache_control.min_fresh_ = deltaSeconds(value);
+    } else if (StringUtil::caseCompare(name, "max-stale")) {
+      cache_control.max_stale_ =
+          value.empty() ? std::chrono::seconds(MaxDeltaSeconds) : deltaSeconds(value);
+    }
+  }
+  return cache_control;
+}
+
+absl::optional<SystemTime> CachePolicy::httpDate(absl::string_view value) {
+  absl::Time time;
+  std::string error;
+  if (!absl::ParseTime("%a, %d %b %Y %H:%M:%S GMT", value, &time, &error)) {
+    return absl::nullopt;
+  }
+  return absl::ToChronoTime(time);
+}
+
+bool CachePolicy::requestCacheable(const Http::HeaderMap& request_headers) {
+  return request_headers.Method() != nullptr &&
+         request_headers.Method()->value() == Http::Headers::get().MethodValues.Get.c_str() &&
+         request_headers.Path() != nullptr && request_headers.Host() != nullptr &&
+         request_headers.Authorization() == nullptr && !cacheControl(request_headers).no_store_;
+}
+
+bool CachePolicy::responseStorable(const Http::HeaderMap& response_headers) {
+  // The status codes that are cacheable by default. @see RFC 7231 section 6.1.
+  switch (Http::Utility::getResponseStatus(response_headers)) {
+  case 200:
+  case 203:
+  case 204:
+  case 300:
+  case 301:
+  case 404:
+  case 405:
+  case 410:
+  case 414:
+  case 501:
+    break;
+  default:
+    return false;
+  }
+
+  const CacheControl cache_control = cacheControl(response_headers);
+  if (cache_control.no_store_ || cache_control.private_ ||
+      response_headers.get(Http::Headers::get().SetCookie) != nullptr) {
+    return false;
+  }
+  const std::vector<std::string> vary = varyHeaders(response_headers);
+  if (std::find(vary.begin(), vary.end(), Http::Headers::get().VaryValues.Wildcard) != vary.end()) {
+    return false;
+  }
+
+  // Heuristic freshness isn't supported, so that a response is only stored with an explicit
+  // lifetime or with a validator.
+  return cache_control.s_maxage_ || cache_control.max_age_ ||
+         response_headers.get(CacheHeaders::get().Expires) != nullptr ||
+         response_headers.get(Http::Headers::get().Etag) != nullptr ||
+         response_headers.get(Http::Headers::get().LastModified) != nullptr;
+}
+
+std::chrono::seconds CachePolicy::freshnessLifetime(const Envoy::HttpCache::CacheEntry& entry) {
+  const CacheControl cache_control = cacheControl(*entry.headers_);
+  if (cache_control.no_cache_) {
+    return std::chrono::seconds(0);
+  }
+  if (cache_control.s_maxage_) {
+    return cache_control.s_maxage_.value();
+  }
+  if (cache_control.max_age_) {
+    return cache_control.max_age_.value();
+  }
+
+  const Http::HeaderEntry* expires_header = entry.headers_->get(CacheHeaders::get().Expires);
+  if (expires_header == nullptr) {
+    return std::chrono::seconds(0);
+  }
+  // A malformed expires header means that the response is already expired.
+  const absl::optional<SystemTime> expires = httpDate(expires_header->value().getStringView());
+  if (!expires) {
+    return std::chrono::seconds(0);
+  }
+  absl::optional<SystemTime> date;
+  if (entry.headers_->Date() != nullptr) {
+    date = httpDate(entry.headers_->Date()->value().getStringView());
+  }
+  return std::max(std::chrono::seconds(0), std::chrono::duration_cast<std::chrono::seconds>(
+                                               expires.value() -
+                                               date.value_or(entry.response_time_)));
+}
+
+std::chrono::seconds CachePolicy::currentAge(const Envoy::HttpCache::CacheEntry& entry,
+                                             SystemTime now) {
+  std::chrono::seconds apparent_age(0);
+  if (entry.headers_->Date() != nullptr) {
+    const absl::optional<SystemTime> date =
+        httpDate(entry.headers_->Date()->value().getStringView());
+    if (date) {
+      apparent_age = std::max(apparent_age, std::chrono::duration_cast<std::chrono::seconds>(
+                                                entry.response_time_ - date.value()));
+    }
+  }
+  std::chrono::seconds age_value(0);
+  const Http::HeaderEntry* age_header = entry.headers_->get(CacheHeaders::get().Age);
+  if (age_header != nullptr) {
+    age_value = deltaSeconds(age_header->value().getStringView());
+  }
+  // The delay of the response isn't known, so that the corrected age value is the age value.
+  const std::chrono::seconds corrected_initial_age = std::max(apparent_age, age_value);
+  const std::chrono::seconds resident_time = std::max(
+      std::chrono::seconds(0),
+      std::chrono::duration_cast<std::chrono::seconds>(now - entry.response_time_));
+  return corrected_initial_age + resident_time;
+}
+
+bool CachePolicy::fresh(const Envoy::HttpCache::CacheEntry& entry,
+                        const Http::HeaderMap& request_headers, SystemTime now) {
+  const CacheControl request_cache_control = cacheControl(request_headers);
+  if (request_cache_control.no_cache_) {
+    return false;
+  }
+  // Pragma: no-cache only counts without a cache-control header. @see RFC 7234 section 5.4.
+  const Http::HeaderEntry* pragma = request_headers.get(CacheHeaders::get().Pragma);
+  if (request_headers.CacheControl() == nullptr && pragma != nullptr &&
+      StringUtil::caseFindToken(pragma->value().getStringView(), ",", "no-cache")) {
+    return false;
+  }
+
+  const std::chrono::seconds lifetime = freshnessLifetime(entry);
+  const std::chrono::seconds age = currentAge(entry, now);
+  if (request_cache_control.max_age_ && age > request_cache_control.max_age_.value()) {
+    return false;
+  }
+  if (request_cache_control.min_fresh_ &&
+      age + request_cache_control.min_fresh_.value() > lifetime) {
+    return false;
+  }
+  if (age < lifetime) {
+    return true;
+  }
+
+  // A stale response may only be served if the client accepts it and the origin allows it. The
+  // s-maxage directive implies proxy-revalidate. @see RFC 7234 section 5.2.2.9.
+  const CacheControl response_cache_control = cacheControl(*entry.headers_);
+  if (response_cache_control.must_revalidate_ || response_cache_control.no_cache_ ||
+      response_cache_control.s_maxage_) {
+    return false;
+  }
+  return request_cache_control.max_stale_ &&
+         age - lifetime <= request_cache_control.max_stale_.value();
+}
+
+std::vector<std::string> CachePolicy::varyHeaders(const Http::HeaderMap& response_headers) {
+  std::vector<std::string> vary;
+  const Http::HeaderEntry* header = response_headers.get(Http::Headers::get().Vary);
+  if (header == nullptr) {
+    return vary;
+  }
+  for (const absl::string_view name :
+       StringUtil::splitToken(header->value().getStringView(), ",")) {
+    vary.push_back(absl::AsciiStrToLower(StringUtil::trim(name)));
+  }
+  return vary;
+}
+
+std::string CachePolicy::variantKey(const std::string& key, const std::vector<std::string>& vary,
+                                    const Http::HeaderMap& request_headers) {
+  // The lengths of the values are part of the key, so that no values key like others, and missing
+  // headers key unlike empty ones.
+  std::string variant_key = key;
+  for (const std::string& name : vary) {
+    const Http::HeaderEntry* header = request_headers.get(Http::LowerCaseString(name));
+    if (header == nullptr) {
+      variant_key += "\n-";
+    } else {
+      const absl::string_view value = header->value().getStringView();
+      variant_key += fmt::format("\n{}:{}", value.size(), value);
+    }
+  }
+  return variant_key;
+}
+
+bool CachePolicy::notModified(const Envoy::HttpCache::CacheEntry& entry,
+                              const Http::HeaderMap& request_headers) {
+  const Http::HeaderEntry* if_none_match = request_headers.get(CacheHeaders::get().IfNoneMatch);
+  if (if_none_match == nullptr) {
+    // if-modified-since is only evaluated without if-none-match. @see RFC 7232 section 3.3.
+    const Http::HeaderEntry* if_modified_since =
+        request_headers.get(CacheHeaders::get().IfModifiedSince);
+    const Http::HeaderEntry* last_modified =
+        entry.headers_->get(Http::Headers::get().LastModified);
+    if (if_modified_since == nullptr || last_modified == nullptr) {
+      return false;
+    }
+    const absl::optional<SystemTime> since = httpDate(if_modified_since->value().getStringView());
+    const absl::optional<SystemTime> modified = httpDate(last_modified->value().getStringView());
+    return since && modified && modified.value() <= since.value();
+  }
+  const Http::HeaderEntry* etag = entry.headers_->get(Http::Headers::get().Etag);
+  if (etag == nullptr) {
+    return false;
+  }
+  const absl::string_view value = StringUtil::trim(if_none_match->value().getStringView());
+  if (value == "*") {
+    return true;
+  }
+  const absl::string_view opaque_etag = opaqueTag(etag->value().getStringView());
+  for (const absl::string_view entity_tag : StringUtil::splitToken(value, ",")) {
+    if (opaqueTag(entity_tag) == opaque_etag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
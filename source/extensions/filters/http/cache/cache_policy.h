@@ -0,0 +1,137 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/http/header_map.h"
+#include "envoy/http_cache/http_cache.h"
+
+#include "common/singleton/const_singleton.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * The caching headers that aren't among the well-known Envoy headers.
+ */
+class CacheHeaderValues {
+public:
+  const Http::LowerCaseString Age{"age"};
+  const Http::LowerCaseString Expires{"expires"};
+  const Http::LowerCaseString IfModifiedSince{"if-modified-since"};
+  const Http::LowerCaseString IfNoneMatch{"if-none-match"};
+  const Http::LowerCaseString Pragma{"pragma"};
+};
+
+typedef ConstSingleton<CacheHeaderValues> CacheHeaders;
+
+/**
+ * The directives of a cache-control header. @see RFC 7234 section 5.2.
+ */
+struct CacheControl {
+  bool no_cache_{};
+  bool no_store_{};
+  bool private_{};
+  bool public_{};
+  bool must_revalidate_{};
+  absl::optional<std::chrono::seconds> max_age_;
+  absl::optional<std::chrono::seconds> s_maxage_;
+  absl::optional<std::chrono::seconds> min_fresh_;
+  // Set to the maximum duration when max-stale has no value.
+  absl::optional<std::chrono::seconds> max_stale_;
+};
+
+/**
+ * The rules of RFC 7234 deciding which responses a shared cache may store, and for how long it may
+ * serve them without validating them with the origin.
+ */
+class CachePolicy {
+public:
+  /**
+   * @param headers supplies the headers of a request or of a response.
+   * @return CacheControl the directives of the cache-control header of the headers.
+   */
+  static CacheControl cacheControl(const Http::HeaderMap& headers);
+
+  /**
+   * @param value supplies an IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+   * @return the time of the date, or absl::nullopt if it isn't an IMF-fixdate.
+   */
+  static absl::optional<SystemTime> httpDate(absl::string_view value);
+
+  /**
+   * @param request_headers supplies the headers of a request.
+   * @return bool whether the response of the request may be looked up and stored. Only the GET
+   *         requests without credentials or a no-store directive can use the cache.
+   */
+  static bool requestCacheable(const Http::HeaderMap& request_headers);
+
+  /**
+   * @param response_headers supplies the headers of the response of a cacheable request.
+   * @return bool whether a shared cache may store the response. @see RFC 7234 section 3.
+   */
+  static bool responseStorable(const Http::HeaderMap& response_headers);
+
+  /**
+   * @param entry supplies a stored response.
+   * @return std::chrono::seconds how long the response is fresh after it was generated.
+   *         @see RFC 7234 section 4.2.1.
+   */
+  static std::chrono::seconds freshnessLifetime(const Envoy::HttpCache::CacheEntry& entry);
+
+  /**
+   * @param entry supplies a stored response.
+   * @param now supplies the current time.
+   * @return std::chrono::seconds the current age of the response. @see RFC 7234 section 4.2.3.
+   */
+  static std::chrono::seconds currentAge(const Envoy::HttpCache::CacheEntry& entry, SystemTime now);
+
+  /**
+   * @param entry supplies a stored response.
+   * @param request_headers supplies the headers of a request the response is selected for.
+   * @param now supplies the current time.
+   * @return bool whether the response may be served to the request without validating it.
+   *         @see RFC 7234 section 4.2.
+   */
+  static bool fresh(const Envoy::HttpCache::CacheEntry& entry,
+                    const Http::HeaderMap& request_headers, SystemTime now);
+
+  /**
+   * @param response_headers supplies the headers of a response.
+   * @return std::vector<std::string> the lowercase names of the request headers listed by the vary
+   *         header of the response, in the order they are listed.
+   */
+  static std::vector<std::string> varyHeaders(const Http::HeaderMap& response_headers);
+
+  /**
+   * @param key supplies the key of a request.
+   * @param vary supplies the lowercase names of the request headers the response varies on.
+   * @param request_headers supplies the headers of the request.
+   * @return std::string the key of the variant of the response selected by the request headers.
+   */
+  static std::string variantKey(const std::string& key, const std::vector<std::string>& vary,
+                                const Http::HeaderMap& request_headers);
+
+  /**
+   * @param entry supplies a stored response.
+   * @param request_headers supplies the headers of a conditional request.
+   * @return bool whether the if-none-match header of the request matches the entity tag of the
+   *         response, or else whether its if-modified-since header isn't older than the
+   *         last-modified header of the response, so that the request can be answered with a 304.
+   *         @see RFC 7232 section 3.
+   */
+  static bool notModified(const Envoy::HttpCache::CacheEntry& entry,
+                          const Http::HeaderMap& request_headers);
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
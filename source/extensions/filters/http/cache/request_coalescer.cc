@@ -0,0 +1,48 @@
+#include "extensions/filters/http/cache/request_coalescer.h"
+
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+bool RequestCoalescer::join(const std::string& key, const WaiterSharedPtr& waiter) {
+  Thread::LockGuard lock(lock_);
+  auto it = keys_.find(key);
+  if (it == keys_.end()) {
+    keys_.emplace(key, std::vector<WaiterSharedPtr>());
+    return true;
+  }
+  it->second.push_back(waiter);
+  return false;
+}
+
+void RequestCoalescer::release(const std::string& key, bool stored) {
+  std::vector<WaiterSharedPtr> waiters;
+  {
+    Thread::LockGuard lock(lock_);
+    auto it = keys_.find(key);
+    if (it == keys_.end()) {
+      return;
+    }
+    waiters = std::move(it->second);
+    keys_.erase(it);
+  }
+
+  // The waiters are woken on their own thread, where they may have stopped waiting.
+  for (const WaiterSharedPtr& waiter : waiters) {
+    waiter->dispatcher_.post([waiter, stored]() -> void {
+      if (waiter->wake_ != nullptr) {
+        auto wake = std::move(waiter->wake_);
+        waiter->wake_ = nullptr;
+        wake(stored);
+      }
+    });
+  }
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
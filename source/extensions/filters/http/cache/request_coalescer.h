@@ -0,0 +1,68 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * Collapses the concurrent requests missing the same response, on all the workers, into the
+ * first one. The first request of a key leads it until it releases the key, meanwhile the other
+ * requests of the key wait. Released waiters are woken on the dispatcher of their stream.
+ */
+class RequestCoalescer {
+public:
+  /**
+   * A request waiting for the release of a key. The waiter is only accessed on the thread of its
+   * dispatcher once it is queued.
+   */
+  struct Waiter {
+    Waiter(Event::Dispatcher& dispatcher, std::function<void(bool stored)> wake)
+        : dispatcher_(dispatcher), wake_(std::move(wake)) {}
+
+    Event::Dispatcher& dispatcher_;
+    // Called with whether the response of the leader was stored. Reset when the request stops
+    // waiting, e.g. when its stream is destroyed.
+    std::function<void(bool stored)> wake_;
+  };
+
+  typedef std::shared_ptr<Waiter> WaiterSharedPtr;
+
+  /**
+   * Lead a key, or wait for its release if another request leads it.
+   * @param key supplies the key of the response the request misses.
+   * @param waiter supplies the waiter of the request, queued if the key is led.
+   * @return bool true if the request leads the key, false if it waits.
+   */
+  bool join(const std::string& key, const WaiterSharedPtr& waiter);
+
+  /**
+   * Release a key led by a request, waking the requests waiting for it.
+   * @param key supplies the key.
+   * @param stored supplies whether the response of the leader was stored.
+   */
+  void release(const std::string& key, bool stored);
+
+private:
+  Thread::MutexBasicLockable lock_;
+  // The waiters of the keys that are led.
+  std::unordered_map<std::string, std::vector<WaiterSharedPtr>> keys_ GUARDED_BY(lock_);
+};
+
+typedef std::unique_ptr<RequestCoalescer> RequestCoalescerPtr;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
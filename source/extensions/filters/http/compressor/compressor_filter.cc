@@ -0,0 +1,476 @@
+#include "extensions/filters/http/compressor/compressor_filter.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/macros.h"
+#include "common/config/utility.h"
+#include "common/http/headers.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+namespace {
+// Minimum length of an upstream response that allows compression.
+const uint64_t MinimumContentLength = 30;
+
+// Default maximum size of a cached compressed body.
+const uint64_t DefaultMaxEntryBytes = 1024 * 1024;
+
+// Defaults of the compression of large responses on a thread pool.
+const uint64_t DefaultMinOffloadedResponseBytes = 1024 * 1024;
+const uint32_t DefaultOffloadThreads = 2;
+const uint32_t DefaultMaxQueuedOffloads = 1024;
+
+// Default content types will be used if any is provided by the user.
+const std::vector<std::string>& defaultContentEncoding() {
+  CONSTRUCT_ON_FIRST_USE(std::vector<std::string>,
+                         {"text/html", "text/plain", "text/css", "application/javascript",
+                          "application/json", "image/svg+xml", "text/xml",
+                          "application/xhtml+xml"});
+}
+
+// Returns the weight of a coding of an accept-encoding header, e.g. 0.5 for "gzip;q=0.5". Codings
+// without a weight have a weight of 1, malformed weights make them unacceptable.
+double codingWeight(absl::string_view coding) {
+  const absl::string_view::size_type parameters = coding.find(';');
+  if (parameters == absl::string_view::npos) {
+    return 1;
+  }
+  for (const absl::string_view parameter :
+       StringUtil::splitToken(coding.substr(parameters + 1), ";", false)) {
+    const absl::string_view name = StringUtil::trim(StringUtil::cropRight(parameter, "="));
+    if (name != "q" && name != "Q") {
+      continue;
+    }
+    double weight;
+    if (!absl::SimpleAtod(StringUtil::trim(StringUtil::cropLeft(parameter, "=")), &weight) ||
+        !(weight >= 0 && weight <= 1)) {
+      return 0;
+    }
+    return weight;
+  }
+  return 1;
+}
+
+ResponseCachePtr createResponseCache(
+    const envoy::config::filter::http::compressor::v2alpha::Compressor& config) {
+  if (!config.has_response_cache()) {
+    return nullptr;
+  }
+  return std::make_unique<ResponseCache>(
+      config.response_cache().max_bytes(),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.response_cache(), max_entry_bytes,
+                                      DefaultMaxEntryBytes));
+}
+
+CompressorThreadPoolPtr
+createThreadPool(const envoy::config::filter::http::compressor::v2alpha::Compressor& config,
+                 Server::Configuration::FactoryContext& context) {
+  if (!config.has_offload()) {
+    return nullptr;
+  }
+  return std::make_unique<CompressorThreadPool>(
+      context.api().threadFactory(),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.offload(), threads, DefaultOffloadThreads),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.offload(), max_queued, DefaultMaxQueuedOffloads));
+}
+
+} // namespace
+
+CompressorFilterConfig::CompressorFilterConfig(
+    const envoy::config::filter::http::compressor::v2alpha::Compressor& config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context)
+    : libraries_(compressorLibraries(config.compressor_libraries(), stats_prefix + "compressor.",
+                                     context)),
+      content_length_(std::max<uint64_t>(config.content_length().value(), MinimumContentLength)),
+      content_type_values_(contentTypeSet(config.content_type())),
+      disable_on_etag_header_(config.disable_on_etag_header()),
+      remove_accept_encoding_header_(config.remove_accept_encoding_header()),
+      response_cache_(createResponseCache(config)), thread_pool_(createThreadPool(config, context)),
+      min_offloaded_response_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          config.offload(), min_response_bytes, DefaultMinOffloadedResponseBytes)),
+      stats_(generateStats(stats_prefix + "compressor.", context.scope())),
+      runtime_(context.runtime()) {}
+
+std::vector<CompressorFilterConfig::CompressorLibrary> CompressorFilterConfig::compressorLibraries(
+    const Protobuf::RepeatedPtrField<
+        envoy::config::filter::http::compressor::v2alpha::Compressor::CompressorLibrary>&
+        libraries,
+    const std::string& prefix, Server::Configuration::FactoryContext& context) {
+  std::vector<CompressorLibrary> compressor_libraries;
+  StringUtil::CaseUnorderedSet content_encodings;
+  for (const auto& library : libraries) {
+    auto& factory =
+        Config::Utility::getAndCheckFactory<Envoy::Compressor::NamedCompressorLibraryConfigFactory>(
+            library.name());
+    ProtobufTypes::MessagePtr message = Config::Utility::translateToFactoryConfig(library, factory);
+    Envoy::Compressor::CompressorFactoryPtr compressor_factory =
+        factory.createCompressorFactoryFromProto(*message, context);
+    const std::string& content_encoding = compressor_factory->contentEncoding();
+    if (!content_encodings.insert(content_encoding).second) {
+      throw EnvoyException(fmt::format(
+          "compressor filter: more than one compressor library encodes with '{}'",
+          content_encoding));
+    }
+    const std::string library_prefix = absl::StrCat(prefix, content_encoding, ".");
+    compressor_libraries.push_back({std::move(compressor_factory),
+                                    CompressorLibraryStats{ALL_COMPRESSOR_LIBRARY_STATS(
+                                        POOL_COUNTER_PREFIX(context.scope(), library_prefix))}});
+  }
+  return compressor_libraries;
+}
+
+StringUtil::CaseUnorderedSet CompressorFilterConfig::contentTypeSet(
+    const Protobuf::RepeatedPtrField<Envoy::ProtobufTypes::String>& types) {
+  return types.empty() ? StringUtil::CaseUnorderedSet(defaultContentEncoding().begin(),
+                                                      defaultContentEncoding().end())
+                       : StringUtil::CaseUnorderedSet(types.cbegin(), types.cend());
+}
+
+CompressorFilterConfig::CompressorLibrary*
+CompressorFilterConfig::chooseCompressorLibrary(absl::string_view accept_encoding) {
+  const std::vector<absl::string_view> codings =
+      StringUtil::splitToken(accept_encoding, ",", false /* keep_empty */);
+
+  // A negative weight stands for a coding that isn't listed.
+  double wildcard_weight = -1;
+  double identity_weight = -1;
+  for (const absl::string_view coding : codings) {
+    const absl::string_view name = StringUtil::trim(StringUtil::cropRight(coding, ";"));
+    if (name == Http::Headers::get().AcceptEncodingValues.Wildcard) {
+      wildcard_weight = codingWeight(coding);
+    } else if (StringUtil::caseCompare(name, Http::Headers::get().AcceptEncodingValues.Identity)) {
+      identity_weight = codingWeight(coding);
+    }
+  }
+
+  CompressorLibrary* chosen = nullptr;
+  double chosen_weight = 0;
+  for (CompressorLibrary& library : libraries_) {
+    double weight = wildcard_weight;
+    for (const absl::string_view coding : codings) {
+      if (StringUtil::caseCompare(StringUtil::trim(StringUtil::cropRight(coding, ";")),
+                                  library.factory_->contentEncoding())) {
+        weight = codingWeight(coding);
+        break;
+      }
+    }
+    if (weight > chosen_weight) {
+      chosen = &library;
+      chosen_weight = weight;
+    }
+  }
+
+  if (chosen == nullptr) {
+    stats_.header_not_valid_.inc();
+    return nullptr;
+  }
+  if (identity_weight > chosen_weight) {
+    stats_.header_identity_.inc();
+    return nullptr;
+  }
+  chosen->stats_.header_accepted_.inc();
+  return chosen;
+}
+
+Http::FilterHeadersStatus CompressorFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
+  const Http::HeaderEntry* accept_encoding = headers.AcceptEncoding();
+  if (!config_->runtime().snapshot().featureEnabled("compressor.filter_enabled", 100)) {
+    config_->stats().not_compressed_.inc();
+  } else if (accept_encoding == nullptr) {
+    config_->stats().no_accept_header_.inc();
+    config_->stats().not_compressed_.inc();
+  } else {
+    library_ = config_->chooseCompressorLibrary(accept_encoding->value().getStringView());
+    if (library_ == nullptr) {
+      config_->stats().not_compressed_.inc();
+    } else {
+      if (config_->responseCache() != nullptr && headers.Host() && headers.Path()) {
+        cache_key_ = absl::StrCat(headers.Host()->value().getStringView(), "\n",
+                                  headers.Path()->value().getStringView());
+      }
+      if (config_->removeAcceptEncodingHeader()) {
+        headers.removeAcceptEncoding();
+      }
+    }
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::HeaderMap& headers,
+                                                          bool end_stream) {
+  if (library_ == nullptr) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  if (!end_stream && isMinimumContentLength(headers) && isContentTypeAllowed(headers) &&
+      !hasCacheControlNoTransform(headers) && isEtagAllowed(headers) &&
+      isTransferEncodingAllowed(headers) && !headers.ContentEncoding()) {
+    lookupResponseCache(headers);
+    uint64_t content_length;
+    offloading_ = config_->threadPool() != nullptr && headers.ContentLength() &&
+                  StringUtil::atoull(headers.ContentLength()->value().c_str(), content_length) &&
+                  content_length >= config_->minOffloadedResponseBytes();
+    sanitizeEtagHeader(headers);
+    insertVaryHeader(headers);
+    headers.removeContentLength();
+    headers.insertContentEncoding().value(library_->factory_->contentEncoding());
+    if (cached_body_ == nullptr) {
+      compressor_ = library_->factory_->createCompressor();
+    }
+    library_->stats_.compressed_.inc();
+  } else {
+    library_ = nullptr;
+    config_->stats().not_compressed_.inc();
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (cached_body_ != nullptr) {
+    library_->stats_.total_uncompressed_bytes_.add(data.length());
+    data.drain(data.length());
+    if (end_stream) {
+      data.add(*cached_body_);
+      library_->stats_.total_compressed_bytes_.add(data.length());
+      cached_body_ = nullptr;
+    }
+  } else if (offloaded_ != nullptr) {
+    // The data is compressed after the chunk being compressed on the thread pool.
+    queued_data_.move(data);
+    queued_end_stream_ = end_stream;
+    return Http::FilterDataStatus::StopIterationAndBuffer;
+  } else if (compressor_ != nullptr) {
+    response_bytes_ += data.length();
+    offloading_ = offloading_ || (config_->threadPool() != nullptr &&
+                                  response_bytes_ >= config_->minOffloadedResponseBytes());
+    if (offloading_ && offload(data, end_stream)) {
+      return Http::FilterDataStatus::StopIterationAndBuffer;
+    }
+    compress(data, end_stream);
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::HeaderMap&) {
+  // The compressed stream isn't finished when the response ends with trailers.
+  caching_ = false;
+  if (offloaded_ != nullptr) {
+    // The trailers follow the compressed data once the filter chain is resumed.
+    return Http::FilterTrailersStatus::StopIteration;
+  }
+  if (cached_body_ != nullptr) {
+    Buffer::OwnedImpl body(*cached_body_);
+    library_->stats_.total_compressed_bytes_.add(body.length());
+    cached_body_ = nullptr;
+    encoder_callbacks_->addEncodedData(body, false);
+  }
+  return Http::FilterTrailersStatus::Continue;
+}
+
+void CompressorFilter::onDestroy() {
+  if (offloaded_ != nullptr) {
+    offloaded_->filter_ = nullptr;
+    offloaded_ = nullptr;
+  }
+}
+
+void CompressorFilter::compress(Buffer::Instance& data, bool end_stream) {
+  library_->stats_.total_uncompressed_bytes_.add(data.length());
+  compressor_->compress(data, end_stream ? Envoy::Compressor::State::Finish
+                                         : Envoy::Compressor::State::Flush);
+  library_->stats_.total_compressed_bytes_.add(data.length());
+  collectCacheBody(data, end_stream);
+}
+
+// Moves the compressor of the response and a copy of the data to the thread pool, so that the
+// fragments of the data are still released on the thread of the stream.
+bool CompressorFilter::offload(Buffer::Instance& data, bool end_stream) {
+  auto compression = std::make_shared<OffloadedCompression>();
+  compression->filter_ = this;
+  compression->compressor_ = std::move(compressor_);
+  compression->data_.add(data);
+  compression->end_stream_ = end_stream;
+  Event::Dispatcher& dispatcher = encoder_callbacks_->dispatcher();
+  const bool posted = config_->threadPool()->tryPost([compression, &dispatcher]() -> void {
+    compression->compressor_->compress(compression->data_,
+                                       compression->end_stream_ ? Envoy::Compressor::State::Finish
+                                                                : Envoy::Compressor::State::Flush);
+    dispatcher.post([compression]() -> void {
+      if (compression->filter_ != nullptr) {
+        compression->filter_->onOffloadedCompression(*compression);
+      }
+    });
+  });
+  if (!posted) {
+    compressor_ = std::move(compression->compressor_);
+    config_->stats().offload_rejected_.inc();
+    return false;
+  }
+  config_->stats().offloaded_.inc();
+  library_->stats_.total_uncompressed_bytes_.add(data.length());
+  data.drain(data.length());
+  offloaded_ = std::move(compression);
+  return true;
+}
+
+void CompressorFilter::onOffloadedCompression(OffloadedCompression& compression) {
+  // The compression may be destroyed with offloaded_.
+  OffloadedCompressionSharedPtr hold = std::move(offloaded_);
+  compressor_ = std::move(compression.compressor_);
+  library_->stats_.total_compressed_bytes_.add(compression.data_.length());
+  collectCacheBody(compression.data_, compression.end_stream_);
+  encoder_callbacks_->addEncodedData(compression.data_, false);
+
+  if (queued_data_.length() > 0 || queued_end_stream_) {
+    Buffer::OwnedImpl data;
+    data.move(queued_data_);
+    const bool end_stream = queued_end_stream_;
+    queued_end_stream_ = false;
+    response_bytes_ += data.length();
+    if (offload(data, end_stream)) {
+      return;
+    }
+    compress(data, end_stream);
+    encoder_callbacks_->addEncodedData(data, false);
+  }
+  encoder_callbacks_->continueEncoding();
+}
+
+void CompressorFilter::collectCacheBody(const Buffer::Instance& data, bool end_stream) {
+  if (!caching_) {
+    return;
+  }
+  if (cache_body_.size() + data.length() > config_->responseCache()->maxEntryBytes()) {
+    caching_ = false;
+    std::string().swap(cache_body_);
+    return;
+  }
+  cache_body_.append(data.toString());
+  if (end_stream) {
+    caching_ = false;
+    config_->stats().response_cache_evicted_.add(
+        config_->responseCache()->insert(cache_key_, std::move(cache_body_)));
+  }
+}
+
+bool CompressorFilter::hasCacheControlNoTransform(Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* cache_control = headers.CacheControl();
+  if (cache_control) {
+    return StringUtil::caseFindToken(cache_control->value().c_str(), ",",
+                                     Http::Headers::get().CacheControlValues.NoTransform.c_str());
+  }
+
+  return false;
+}
+
+bool CompressorFilter::isContentTypeAllowed(Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* content_type = headers.ContentType();
+  if (content_type && !config_->contentTypeValues().empty()) {
+    std::string value{StringUtil::trim(StringUtil::cropRight(content_type->value().c_str(), ";"))};
+    return config_->contentTypeValues().find(value) != config_->contentTypeValues().end();
+  }
+
+  return true;
+}
+
+bool CompressorFilter::isEtagAllowed(Http::HeaderMap& headers) const {
+  const bool is_etag_allowed = !(config_->disableOnEtagHeader() && headers.Etag());
+  if (!is_etag_allowed) {
+    config_->stats().not_compressed_etag_.inc();
+  }
+  return is_etag_allowed;
+}
+
+bool CompressorFilter::isMinimumContentLength(Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* content_length = headers.ContentLength();
+  if (content_length) {
+    uint64_t length;
+    const bool is_minimum_content_length =
+        StringUtil::atoull(content_length->value().c_str(), length) &&
+        length >= config_->minimumLength();
+    if (!is_minimum_content_length) {
+      config_->stats().content_length_too_small_.inc();
+    }
+    return is_minimum_content_length;
+  }
+
+  const Http::HeaderEntry* transfer_encoding = headers.TransferEncoding();
+  return (transfer_encoding &&
+          StringUtil::caseFindToken(transfer_encoding->value().c_str(), ",",
+                                    Http::Headers::get().TransferEncodingValues.Chunked.c_str()));
+}
+
+bool CompressorFilter::isTransferEncodingAllowed(Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* transfer_encoding = headers.TransferEncoding();
+  if (transfer_encoding) {
+    for (auto header_value :
+         StringUtil::splitToken(transfer_encoding->value().getStringView(), ",", true)) {
+      const auto trimmed_value = StringUtil::trim(header_value);
+      if (StringUtil::caseCompare(trimmed_value,
+                                  Http::Headers::get().TransferEncodingValues.Gzip) ||
+          StringUtil::caseCompare(trimmed_value,
+                                  Http::Headers::get().TransferEncodingValues.Deflate)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void CompressorFilter::insertVaryHeader(Http::HeaderMap& headers) {
+  const Http::HeaderEntry* vary = headers.Vary();
+  if (vary) {
+    if (!StringUtil::findToken(vary->value().c_str(), ",",
+                               Http::Headers::get().VaryValues.AcceptEncoding, true)) {
+      std::string new_header;
+      absl::StrAppend(&new_header, vary->value().c_str(), ", ",
+                      Http::Headers::get().VaryValues.AcceptEncoding);
+      headers.insertVary().value(new_header);
+    }
+  } else {
+    headers.insertVary().value(Http::Headers::get().VaryValues.AcceptEncoding);
+  }
+}
+
+// Looks the compressed body of a response up, or prepares to cache it, for the 200 responses with
+// a strong etag. The etag identifies the body, which saves buffering the whole body to hash it.
+void CompressorFilter::lookupResponseCache(Http::HeaderMap& headers) {
+  const Http::HeaderEntry* etag = headers.Etag();
+  if (cache_key_.empty() || etag == nullptr || etag->value().empty() ||
+      absl::StartsWithIgnoreCase(etag->value().getStringView(), "W/") || !headers.Status() ||
+      headers.Status()->value().getStringView() != "200") {
+    return;
+  }
+  absl::StrAppend(&cache_key_, "\n", etag->value().getStringView(), "\n",
+                  library_->factory_->contentEncoding());
+  cached_body_ = config_->responseCache()->lookup(cache_key_);
+  if (cached_body_ != nullptr) {
+    config_->stats().response_cache_hit_.inc();
+  } else {
+    config_->stats().response_cache_miss_.inc();
+    caching_ = true;
+  }
+}
+
+// Weak etags are preserved and strong ones removed, as by the gzip filter.
+void CompressorFilter::sanitizeEtagHeader(Http::HeaderMap& headers) {
+  const Http::HeaderEntry* etag = headers.Etag();
+  if (etag) {
+    absl::string_view value(etag->value().getStringView());
+    if (value.length() > 2 && !((value[0] == 'w' || value[0] == 'W') && value[1] == '/')) {
+      headers.removeEtag();
+    }
+  }
+}
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
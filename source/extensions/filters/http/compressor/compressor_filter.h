@@ -0,0 +1,213 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "envoy/compressor/compressor_config.h"
+#include "envoy/config/filter/http/compressor/v2alpha/compressor.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/http/header_map.h"
+#include "envoy/runtime/runtime.h"
+#include "envoy/server/filter_config.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/utility.h"
+#include "common/protobuf/protobuf.h"
+
+#include "extensions/filters/http/common/pass_through_filter.h"
+#include "extensions/filters/http/compressor/compressor_thread_pool.h"
+#include "extensions/filters/http/compressor/response_cache.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+/**
+ * All compressor filter stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_COMPRESSOR_STATS(COUNTER)  \
+  COUNTER(not_compressed)              \
+  COUNTER(no_accept_header)            \
+  COUNTER(header_identity)             \
+  COUNTER(header_not_valid)            \
+  COUNTER(content_length_too_small)    \
+  COUNTER(not_compressed_etag)         \
+  COUNTER(response_cache_hit)          \
+  COUNTER(response_cache_miss)         \
+  COUNTER(response_cache_evicted)      \
+  COUNTER(offloaded)                   \
+  COUNTER(offload_rejected)            \
+// clang-format on
+
+/**
+ * Struct definition for compressor stats. @see stats_macros.h
+ */
+struct CompressorStats {
+  ALL_COMPRESSOR_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Stats of each compressor library of the compressor filter. "header_accepted" counts the requests
+ * whose accept-encoding header selected the library, "compressed" the responses it encoded.
+ * "total_uncompressed_bytes" only includes bytes from responses that were compressed.
+ * @see stats_macros.h
+ */
+// clang-format off
+#define ALL_COMPRESSOR_LIBRARY_STATS(COUNTER) \
+  COUNTER(header_accepted)                    \
+  COUNTER(compressed)                         \
+  COUNTER(total_uncompressed_bytes)           \
+  COUNTER(total_compressed_bytes)             \
+// clang-format on
+
+/**
+ * Struct definition for compressor library stats. @see stats_macros.h
+ */
+struct CompressorLibraryStats {
+  ALL_COMPRESSOR_LIBRARY_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration for the compressor filter.
+ */
+class CompressorFilterConfig {
+public:
+  /**
+   * A compressor library of the filter, with the stats of its content coding.
+   */
+  struct CompressorLibrary {
+    Envoy::Compressor::CompressorFactoryPtr factory_;
+    CompressorLibraryStats stats_;
+  };
+
+  CompressorFilterConfig(const envoy::config::filter::http::compressor::v2alpha::Compressor& config,
+                         const std::string& stats_prefix,
+                         Server::Configuration::FactoryContext& context);
+
+  /**
+   * Choose the compressor library of a request, by the weights its accept-encoding header gives
+   * the content codings of the libraries (RFC7231-5.3.4). The library with the highest non-zero
+   * weight is chosen, the first configured one on ties. Codings that aren't listed have the weight
+   * of "*", if listed. Nothing is chosen if "identity" is explicitly weighted higher.
+   * @param accept_encoding supplies the accept-encoding header of the request.
+   * @return CompressorLibrary* the chosen library, nullptr if the response shouldn't be
+   *         compressed.
+   */
+  CompressorLibrary* chooseCompressorLibrary(absl::string_view accept_encoding);
+
+  Runtime::Loader& runtime() { return runtime_; }
+  CompressorStats& stats() { return stats_; }
+  const StringUtil::CaseUnorderedSet& contentTypeValues() const { return content_type_values_; }
+  bool disableOnEtagHeader() const { return disable_on_etag_header_; }
+  bool removeAcceptEncodingHeader() const { return remove_accept_encoding_header_; }
+  uint64_t minimumLength() const { return content_length_; }
+  ResponseCache* responseCache() const { return response_cache_.get(); }
+  CompressorThreadPool* threadPool() const { return thread_pool_.get(); }
+  uint64_t minOffloadedResponseBytes() const { return min_offloaded_response_bytes_; }
+
+private:
+  static std::vector<CompressorLibrary> compressorLibraries(
+      const Protobuf::RepeatedPtrField<
+          envoy::config::filter::http::compressor::v2alpha::Compressor::CompressorLibrary>&
+          libraries,
+      const std::string& prefix, Server::Configuration::FactoryContext& context);
+  static StringUtil::CaseUnorderedSet
+  contentTypeSet(const Protobuf::RepeatedPtrField<Envoy::ProtobufTypes::String>& types);
+
+  static CompressorStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return CompressorStats{ALL_COMPRESSOR_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  std::vector<CompressorLibrary> libraries_;
+  const uint64_t content_length_;
+  const StringUtil::CaseUnorderedSet content_type_values_;
+  const bool disable_on_etag_header_;
+  const bool remove_accept_encoding_header_;
+  const ResponseCachePtr response_cache_;
+  const CompressorThreadPoolPtr thread_pool_;
+  const uint64_t min_offloaded_response_bytes_;
+  CompressorStats stats_;
+  Runtime::Loader& runtime_;
+};
+typedef std::shared_ptr<CompressorFilterConfig> CompressorFilterConfigSharedPtr;
+
+/**
+ * A filter that compresses data dispatched from the upstream upon client request, with the
+ * compressor library that the client prefers.
+ */
+class CompressorFilter : public Http::PassThroughFilter {
+public:
+  CompressorFilter(const CompressorFilterConfigSharedPtr& config) : config_(config) {}
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& buffer, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap& trailers) override;
+
+private:
+  /**
+   * A chunk of a response compressed on the thread pool, which owns the compressor of the
+   * response meanwhile.
+   */
+  struct OffloadedCompression {
+    // Reset when the stream is destroyed. Only accessed on the thread of the stream.
+    CompressorFilter* filter_;
+    Envoy::Compressor::CompressorPtr compressor_;
+    Buffer::OwnedImpl data_;
+    bool end_stream_;
+  };
+  typedef std::shared_ptr<OffloadedCompression> OffloadedCompressionSharedPtr;
+
+  void compress(Buffer::Instance& data, bool end_stream);
+  bool offload(Buffer::Instance& data, bool end_stream);
+  void onOffloadedCompression(OffloadedCompression& compression);
+  void collectCacheBody(const Buffer::Instance& data, bool end_stream);
+
+  bool hasCacheControlNoTransform(Http::HeaderMap& headers) const;
+  bool isContentTypeAllowed(Http::HeaderMap& headers) const;
+  bool isEtagAllowed(Http::HeaderMap& headers) const;
+  bool isMinimumContentLength(Http::HeaderMap& headers) const;
+  bool isTransferEncodingAllowed(Http::HeaderMap& headers) const;
+
+  void sanitizeEtagHeader(Http::HeaderMap& headers);
+  void insertVaryHeader(Http::HeaderMap& headers);
+  void lookupResponseCache(Http::HeaderMap& headers);
+
+  const CompressorFilterConfigSharedPtr config_;
+  // The library chosen by the request, until the response headers skip compression.
+  CompressorFilterConfig::CompressorLibrary* library_{};
+  Envoy::Compressor::CompressorPtr compressor_;
+  // The :authority and :path of the request while the response may be cached, then the cache key
+  // of the response while its compressed body is collected.
+  std::string cache_key_;
+  // The compressed body of the response, collected to be cached.
+  std::string cache_body_;
+  bool caching_{};
+  // The cached compressed body of the response, which replaces the body of the upstream.
+  ResponseCache::BodyConstSharedPtr cached_body_;
+  // Set once the response is big enough to be compressed on the thread pool.
+  bool offloading_{};
+  uint64_t response_bytes_{};
+  // The chunk being compressed on the thread pool, during which the data of the response is queued
+  // and the filter chain stopped.
+  OffloadedCompressionSharedPtr offloaded_;
+  Buffer::OwnedImpl queued_data_;
+  bool queued_end_stream_{};
+};
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,62 @@
+#include "extensions/filters/http/compressor/compressor_thread_pool.h"
+
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+CompressorThreadPool::CompressorThreadPool(Thread::ThreadFactory& thread_factory, uint32_t threads,
+                                           uint32_t max_queued)
+    : max_queued_(max_queued) {
+  for (uint32_t i = 0; i < threads; i++) {
+    threads_.push_back(thread_factory.createThread([this]() -> void { run(); }));
+  }
+}
+
+CompressorThreadPool::~CompressorThreadPool() {
+  {
+    Thread::LockGuard lock(lock_);
+    shutdown_ = true;
+  }
+  compression_queued_.notifyAll();
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+bool CompressorThreadPool::tryPost(std::function<void()> compression) {
+  {
+    Thread::LockGuard lock(lock_);
+    if (compressions_.size() >= max_queued_) {
+      return false;
+    }
+    compressions_.push_back(std::move(compression));
+  }
+  compression_queued_.notifyOne();
+  return true;
+}
+
+void CompressorThreadPool::run() {
+  while (true) {
+    std::function<void()> compression;
+    {
+      Thread::LockGuard lock(lock_);
+      while (!shutdown_ && compressions_.empty()) {
+        compression_queued_.wait(lock_);
+      }
+      if (shutdown_) {
+        return;
+      }
+      compression = std::move(compressions_.front());
+      compressions_.pop_front();
+    }
+    compression();
+  }
+}
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
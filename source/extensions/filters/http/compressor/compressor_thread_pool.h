@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "envoy/thread/thread.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+/**
+ * A pool of threads compressing the large responses of a compressor filter, so that their
+ * compression doesn't block the event loops of the workers.
+ */
+class CompressorThreadPool {
+public:
+  CompressorThreadPool(Thread::ThreadFactory& thread_factory, uint32_t threads,
+                       uint32_t max_queued);
+
+  /**
+   * Stops the threads once they finish their current compression, the queued ones are dropped.
+   */
+  ~CompressorThreadPool();
+
+  /**
+   * Queue a compression, which runs on one of the threads.
+   * @param compression supplies the compression.
+   * @return bool false if max_queued compressions are already queued, in which case the
+   *         compression isn't queued.
+   */
+  bool tryPost(std::function<void()> compression);
+
+private:
+  void run();
+
+  const uint32_t max_queued_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar compression_queued_;
+  std::deque<std::function<void()>> compressions_ GUARDED_BY(lock_);
+  bool shutdown_ GUARDED_BY(lock_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+typedef std::unique_ptr<CompressorThreadPool> CompressorThreadPoolPtr;
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
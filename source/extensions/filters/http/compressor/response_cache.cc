@@ -0,0 +1,57 @@
+#include "extensions/filters/http/compressor/response_cache.h"
+
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+ResponseCache::BodyConstSharedPtr ResponseCache::lookup(const std::string& key) {
+  Thread::LockGuard lock(lock_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->body_;
+}
+
+uint64_t ResponseCache::insert(const std::string& key, std::string&& body) {
+  const uint64_t entry_bytes = key.size() + body.size();
+  if (body.size() > max_entry_bytes_ || entry_bytes > max_bytes_) {
+    return 0;
+  }
+  auto shared_body = std::make_shared<const std::string>(std::move(body));
+
+  Thread::LockGuard lock(lock_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // Another stream compressed the same response in the meantime.
+    bytes_ -= it->second->key_.size() + it->second->body_->size();
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  uint64_t evicted = 0;
+  while (bytes_ + entry_bytes > max_bytes_) {
+    const Entry& last = entries_.back();
+    bytes_ -= last.key_.size() + last.body_->size();
+    index_.erase(last.key_);
+    entries_.pop_back();
+    evicted++;
+  }
+  entries_.push_front({key, std::move(shared_body)});
+  index_.emplace(key, entries_.begin());
+  bytes_ += entry_bytes;
+  return evicted;
+}
+
+uint64_t ResponseCache::bytes() {
+  Thread::LockGuard lock(lock_);
+  return bytes_;
+}
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+/**
+ * Bounded cache of compressed response bodies, shared by the streams of the workers so that
+ * identical responses are only compressed once. The least recently used bodies are evicted once
+ * the bodies and their keys take more than the maximum bytes.
+ */
+class ResponseCache {
+public:
+  typedef std::shared_ptr<const std::string> BodyConstSharedPtr;
+
+  ResponseCache(uint64_t max_bytes, uint64_t max_entry_bytes)
+      : max_bytes_(max_bytes), max_entry_bytes_(max_entry_bytes) {}
+
+  /**
+   * @param key supplies the key of a response.
+   * @return BodyConstSharedPtr the compressed body of the response, nullptr if it isn't cached.
+   */
+  BodyConstSharedPtr lookup(const std::string& key);
+
+  /**
+   * Cache a compressed body, unless it is bigger than the maximum entry bytes.
+   * @param key supplies the key of the response.
+   * @param body supplies the compressed body.
+   * @return uint64_t the number of bodies evicted to make room for the body.
+   */
+  uint64_t insert(const std::string& key, std::string&& body);
+
+  /**
+   * @return uint64_t the size of the biggest bodies that are cached.
+   */
+  uint64_t maxEntryBytes() const { return max_entry_bytes_; }
+
+  /**
+   * @return uint64_t the bytes taken by the cached bodies and their keys.
+   */
+  uint64_t bytes();
+
+private:
+  struct Entry {
+    std::string key_;
+    BodyConstSharedPtr body_;
+  };
+
+  const uint64_t max_bytes_;
+  const uint64_t max_entry_bytes_;
+  Thread::MutexBasicLockable lock_;
+  // Most recently used first.
+  std::list<Entry> entries_ GUARDED_BY(lock_);
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_ GUARDED_BY(lock_);
+  uint64_t bytes_ GUARDED_BY(lock_){};
+};
+
+typedef std::unique_ptr<ResponseCache> ResponseCachePtr;
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -73,16 +73,20 @@ Http::FilterHeadersStatus CorsFilter::decodeHeaders(Http::HeaderMap& headers, bo
         Http::Headers::get().CORSValues.True);
   }
 
-  if (!allowMethods().empty()) {
-    response_headers->insertAccessControlAllowMethods().value(allowMethods());
+  // Each value is looked up in the policies once, instead of once to check it and once to copy it.
+  const std::string& allow_methods = allowMethods();
+  if (!allow_methods.empty()) {
+    response_headers->insertAccessControlAllowMethods().value(allow_methods);
   }
 
-  if (!allowHeaders().empty()) {
-    response_headers->insertAccessControlAllowHeaders().value(allowHeaders());
+  const std::string& allow_headers = allowHeaders();
+  if (!allow_headers.empty()) {
+    response_headers->insertAccessControlAllowHeaders().value(allow_headers);
   }
 
-  if (!maxAge().empty()) {
-    response_headers->insertAccessControlMaxAge().value(maxAge());
+  const std::string& max_age = maxAge();
+  if (!max_age.empty()) {
+    response_headers->insertAccessControlMaxAge().value(max_age);
   }
 
   decoder_callbacks_->encodeHeaders(std::move(response_headers), true);
@@ -102,8 +106,9 @@ Http::FilterHeadersStatus CorsFilter::encodeHeaders(Http::HeaderMap& headers, bo
     headers.insertAccessControlAllowCredentials().value(Http::Headers::get().CORSValues.True);
   }
 
-  if (!exposeHeaders().empty()) {
-    headers.insertAccessControlExposeHeaders().value(exposeHeaders());
+  const std::string& expose_headers = exposeHeaders();
+  if (!expose_headers.empty()) {
+    headers.insertAccessControlExposeHeaders().value(expose_headers);
   }
 
   return Http::FilterHeadersStatus::Continue;
@@ -117,46 +122,24 @@ bool CorsFilter::isOriginAllowed(const Http::HeaderString& origin) {
   return isOriginAllowedString(origin) || isOriginAllowedRegex(origin);
 }
 
+// The origins are checked against the first policy that has any, with the lookups the policy
+// precompiled, rather than by comparing them one by one.
 bool CorsFilter::isOriginAllowedString(const Http::HeaderString& origin) {
-  if (allowOrigins() == nullptr) {
-    return false;
-  }
-  for (const auto& o : *allowOrigins()) {
-    if (o == "*" || origin == o.c_str()) {
-      return true;
-    }
-  }
-  return false;
-}
-
-bool CorsFilter::isOriginAllowedRegex(const Http::HeaderString& origin) {
-  if (allowOriginRegexes() == nullptr) {
-    return false;
-  }
-  for (const auto& regex : *allowOriginRegexes()) {
-    if (std::regex_match(origin.c_str(), regex)) {
-      return true;
-    }
-  }
-  return false;
-}
-
-const std::list<std::string>* CorsFilter::allowOrigins() {
   for (const auto policy : policies_) {
     if (policy && !policy->allowOrigins().empty()) {
-      return &policy->allowOrigins();
+      return policy->allowsOrigin(origin.getStringView());
     }
   }
-  return nullptr;
+  return false;
 }
 
-const std::list<std::regex>* CorsFilter::allowOriginRegexes() {
+bool CorsFilter::isOriginAllowedRegex(const Http::HeaderString& origin) {
   for (const auto policy : policies_) {
     if (policy && !policy->allowOriginRegexes().empty()) {
-      return &policy->allowOriginRegexes();
+      return policy->allowsOriginRegex(origin.getStringView());
     }
   }
-  return nullptr;
+  return false;
 }
 
 const std::string& CorsFilter::allowMethods() {
@@ -0,0 +1,269 @@
+#include "extensions/filters/http/decompressor/decompressor_filter.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/utility.h"
+#include "common/config/utility.h"
+#include "common/http/headers.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Decompressor {
+
+namespace {
+// Default maximum size of a decompressed body.
+const uint64_t DefaultMaxDecompressedBytes = 64 * 1024 * 1024;
+
+// Returns the coding applied last to a body, i.e. the last coding of its content-encoding header.
+absl::string_view outermostCoding(absl::string_view content_encoding) {
+  const absl::string_view::size_type comma = content_encoding.rfind(',');
+  return StringUtil::trim(comma == absl::string_view::npos ? content_encoding
+                                                           : content_encoding.substr(comma + 1));
+}
+
+// Removes the coding applied last to a body from its content-encoding header, and the header once
+// no coding is left.
+void removeOutermostCoding(Http::HeaderMap& headers) {
+  const absl::string_view content_encoding = headers.ContentEncoding()->value().getStringView();
+  const absl::string_view::size_type comma = content_encoding.rfind(',');
+  const std::string remaining_codings{
+      comma == absl::string_view::npos ? "" : StringUtil::trim(content_encoding.substr(0, comma))};
+  if (remaining_codings.empty()) {
+    headers.removeContentEncoding();
+  } else {
+    headers.ContentEncoding()->value(remaining_codings);
+  }
+}
+
+bool hasCacheControlNoTransform(const Http::HeaderMap& headers) {
+  const Http::HeaderEntry* cache_control = headers.CacheControl();
+  return cache_control &&
+         StringUtil::caseFindToken(cache_control->value().getStringView(), ",",
+                                   Http::Headers::get().CacheControlValues.NoTransform);
+}
+
+// Returns the weight of a coding of an accept-encoding header, e.g. 0.5 for "gzip;q=0.5". Codings
+// without a weight have a weight of 1, malformed weights make them unacceptable.
+double codingWeight(absl::string_view coding) {
+  const absl::string_view::size_type parameters = coding.find(';');
+  if (parameters == absl::string_view::npos) {
+    return 1;
+  }
+  for (const absl::string_view parameter :
+       StringUtil::splitToken(coding.substr(parameters + 1), ";", false)) {
+    const absl::string_view name = StringUtil::trim(StringUtil::cropRight(parameter, "="));
+    if (name != "q" && name != "Q") {
+      continue;
+    }
+    double weight;
+    if (!absl::SimpleAtod(StringUtil::trim(StringUtil::cropLeft(parameter, "=")), &weight) ||
+        !(weight >= 0 && weight <= 1)) {
+      return 0;
+    }
+    return weight;
+  }
+  return 1;
+}
+
+} // namespace
+
+DecompressorFilterConfig::DecompressorFilterConfig(
+    const envoy::config::filter::http::decompressor::v2alpha::Decompressor& config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context)
+    : libraries_(decompressorLibraries(config.decompressor_libraries(),
+                                       stats_prefix + "decompressor.", context)),
+      request_decompression_enabled_(!config.disable_request_decompression()),
+      response_decompression_enabled_(!config.disable_response_decompression()),
+      max_decompressed_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_decompressed_bytes,
+                                                              DefaultMaxDecompressedBytes)) {}
+
+std::vector<DecompressorFilterConfig::DecompressorLibrary>
+DecompressorFilterConfig::decompressorLibraries(
+    const Protobuf::RepeatedPtrField<
+        envoy::config::filter::http::decompressor::v2alpha::Decompressor::DecompressorLibrary>&
+        libraries,
+    const std::string& prefix, Server::Configuration::FactoryContext& context) {
+  std::vector<DecompressorLibrary> decompressor_libraries;
+  StringUtil::CaseUnorderedSet content_encodings;
+  for (const auto& library : libraries) {
+    auto& factory = Config::Utility::getAndCheckFactory<
+        Envoy::Decompressor::NamedDecompressorLibraryConfigFactory>(library.name());
+    ProtobufTypes::MessagePtr message = Config::Utility::translateToFactoryConfig(library, factory);
+    Envoy::Decompressor::DecompressorFactoryPtr decompressor_factory =
+        factory.createDecompressorFactoryFromProto(*message, context);
+    const std::string& content_encoding = decompressor_factory->contentEncoding();
+    if (!content_encodings.insert(content_encoding).second) {
+      throw EnvoyException(fmt::format(
+          "decompressor filter: more than one decompressor library decodes '{}'",
+          content_encoding));
+    }
+    const std::string library_prefix = absl::StrCat(prefix, content_encoding, ".");
+    decompressor_libraries.push_back(
+        {std::move(decompressor_factory),
+         DecompressorLibraryStats{ALL_DECOMPRESSOR_LIBRARY_STATS(
+             POOL_COUNTER_PREFIX(context.scope(), library_prefix + "request."))},
+         DecompressorLibraryStats{ALL_DECOMPRESSOR_LIBRARY_STATS(
+             POOL_COUNTER_PREFIX(context.scope(), library_prefix + "response."))}});
+  }
+  return decompressor_libraries;
+}
+
+DecompressorFilterConfig::DecompressorLibrary*
+DecompressorFilterConfig::findDecompressorLibrary(absl::string_view content_coding) {
+  for (DecompressorLibrary& library : libraries_) {
+    if (absl::EqualsIgnoreCase(content_coding, library.factory_->contentEncoding())) {
+      return &library;
+    }
+  }
+  return nullptr;
+}
+
+Http::FilterHeadersStatus DecompressorFilter::decodeHeaders(Http::HeaderMap& headers,
+                                                            bool end_stream) {
+  request_headers_ = &headers;
+  if (!config_->requestDecompressionEnabled() || end_stream) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  DecompressorFilterConfig::DecompressorLibrary* library = findLibrary(headers);
+  if (library != nullptr) {
+    startDecompression(request_, library->request_stats_, *library->factory_, headers);
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus DecompressorFilter::decodeData(Buffer::Instance& data, bool) {
+  if (request_.failed_) {
+    data.drain(data.length());
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+  if (request_.decompressor_ == nullptr) {
+    return Http::FilterDataStatus::Continue;
+  }
+  switch (decompress(request_, data)) {
+  case Result::Decompressed:
+    return Http::FilterDataStatus::Continue;
+  case Result::Malformed:
+    decoder_callbacks_->sendLocalReply(Http::Code::BadRequest, "malformed compressed body",
+                                       nullptr, absl::nullopt);
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  case Result::TooLarge:
+    decoder_callbacks_->sendLocalReply(Http::Code::PayloadTooLarge, "decompressed body too large",
+                                       nullptr, absl::nullopt);
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+Http::FilterHeadersStatus DecompressorFilter::encodeHeaders(Http::HeaderMap& headers,
+                                                            bool end_stream) {
+  if (!config_->responseDecompressionEnabled() || end_stream) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  // The responses are only decompressed for the clients that don't accept their content coding.
+  DecompressorFilterConfig::DecompressorLibrary* library = findLibrary(headers);
+  if (library != nullptr && !isContentCodingAccepted(library->factory_->contentEncoding())) {
+    startDecompression(response_, library->response_stats_, *library->factory_, headers);
+    // The decompressed body is another representation, which a strong etag doesn't validate.
+    const Http::HeaderEntry* etag = headers.Etag();
+    if (etag != nullptr && !absl::StartsWithIgnoreCase(etag->value().getStringView(), "W/")) {
+      headers.removeEtag();
+    }
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus DecompressorFilter::encodeData(Buffer::Instance& data, bool) {
+  if (response_.failed_) {
+    data.drain(data.length());
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+  if (response_.decompressor_ == nullptr) {
+    return Http::FilterDataStatus::Continue;
+  }
+  if (decompress(response_, data) != Result::Decompressed) {
+    // The headers of the response are already on their way to the client.
+    encoder_callbacks_->resetStream();
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+DecompressorFilterConfig::DecompressorLibrary*
+DecompressorFilter::findLibrary(const Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* content_encoding = headers.ContentEncoding();
+  if (content_encoding == nullptr || hasCacheControlNoTransform(headers)) {
+    return nullptr;
+  }
+  return config_->findDecompressorLibrary(
+      outermostCoding(content_encoding->value().getStringView()));
+}
+
+void DecompressorFilter::startDecompression(Decompression& decompression,
+                                            DecompressorLibraryStats& stats,
+                                            Envoy::Decompressor::DecompressorFactory& factory,
+                                            Http::HeaderMap& headers) {
+  decompression.decompressor_ = factory.createDecompressor();
+  decompression.stats_ = &stats;
+  stats.decompressed_.inc();
+  removeOutermostCoding(headers);
+  headers.removeContentLength();
+}
+
+DecompressorFilter::Result DecompressorFilter::decompress(Decompression& decompression,
+                                                          Buffer::Instance& data) {
+  // The output is bounded by what is left of the maximum, so that a bomb is stopped within a chunk
+  // of the decompressor instead of once it has been fully inflated.
+  const uint64_t max_output_bytes =
+      config_->maxDecompressedBytes() - decompression.decompressed_bytes_;
+  Buffer::OwnedImpl output;
+  const bool decompressed = decompression.decompressor_->decompress(data, output, max_output_bytes);
+  decompression.stats_->total_compressed_bytes_.add(data.length());
+  data.drain(data.length());
+  if (!decompressed) {
+    decompression.decompressor_.reset();
+    decompression.failed_ = true;
+    if (output.length() > max_output_bytes) {
+      decompression.stats_->decompressed_too_large_.inc();
+      return Result::TooLarge;
+    }
+    decompression.stats_->decompression_error_.inc();
+    return Result::Malformed;
+  }
+  decompression.decompressed_bytes_ += output.length();
+  decompression.stats_->total_uncompressed_bytes_.add(output.length());
+  // The decompressed slices replace the compressed ones without being copied.
+  data.move(output);
+  return Result::Decompressed;
+}
+
+bool DecompressorFilter::isContentCodingAccepted(absl::string_view content_coding) const {
+  const Http::HeaderEntry* accept_encoding =
+      request_headers_ != nullptr ? request_headers_->AcceptEncoding() : nullptr;
+  if (accept_encoding == nullptr) {
+    return false;
+  }
+  // Codings that aren't listed have the weight of "*", if listed (RFC7231-5.3.4).
+  double wildcard_weight = 0;
+  for (const absl::string_view coding :
+       StringUtil::splitToken(accept_encoding->value().getStringView(), ",", false)) {
+    const absl::string_view name = StringUtil::trim(StringUtil::cropRight(coding, ";"));
+    if (absl::EqualsIgnoreCase(name, content_coding)) {
+      return codingWeight(coding) > 0;
+    }
+    if (name == "*") {
+      wildcard_weight = codingWeight(coding);
+    }
+  }
+  return wildcard_weight > 0;
+}
+
+} // namespace Decompressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
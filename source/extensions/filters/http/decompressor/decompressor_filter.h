@@ -0,0 +1,138 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "envoy/config/filter/http/decompressor/v2alpha/decompressor.pb.h"
+#include "envoy/decompressor/decompressor_config.h"
+#include "envoy/http/filter.h"
+#include "envoy/http/header_map.h"
+#include "envoy/server/filter_config.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/protobuf/protobuf.h"
+
+#include "extensions/filters/http/common/pass_through_filter.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Decompressor {
+
+/**
+ * Stats of each direction of each decompressor library of the decompressor filter. "decompressed"
+ * counts the bodies the library decoded, "decompression_error" the malformed ones and
+ * "decompressed_too_large" the ones that decompressed to more than the configured maximum.
+ * @see stats_macros.h
+ */
+// clang-format off
+#define ALL_DECOMPRESSOR_LIBRARY_STATS(COUNTER) \
+  COUNTER(decompressed)                         \
+  COUNTER(decompression_error)                  \
+  COUNTER(decompressed_too_large)               \
+  COUNTER(total_compressed_bytes)               \
+  COUNTER(total_uncompressed_bytes)             \
+// clang-format on
+
+/**
+ * Struct definition for decompressor library stats. @see stats_macros.h
+ */
+struct DecompressorLibraryStats {
+  ALL_DECOMPRESSOR_LIBRARY_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration for the decompressor filter.
+ */
+class DecompressorFilterConfig {
+public:
+  /**
+   * A decompressor library of the filter, with the stats of its content coding.
+   */
+  struct DecompressorLibrary {
+    Envoy::Decompressor::DecompressorFactoryPtr factory_;
+    DecompressorLibraryStats request_stats_;
+    DecompressorLibraryStats response_stats_;
+  };
+
+  DecompressorFilterConfig(
+      const envoy::config::filter::http::decompressor::v2alpha::Decompressor& config,
+      const std::string& stats_prefix, Server::Configuration::FactoryContext& context);
+
+  /**
+   * @param content_coding supplies a content coding, e.g. "gzip".
+   * @return DecompressorLibrary* the library that decodes the content coding, nullptr if none
+   *         does.
+   */
+  DecompressorLibrary* findDecompressorLibrary(absl::string_view content_coding);
+
+  bool requestDecompressionEnabled() const { return request_decompression_enabled_; }
+  bool responseDecompressionEnabled() const { return response_decompression_enabled_; }
+  uint64_t maxDecompressedBytes() const { return max_decompressed_bytes_; }
+
+private:
+  static std::vector<DecompressorLibrary> decompressorLibraries(
+      const Protobuf::RepeatedPtrField<
+          envoy::config::filter::http::decompressor::v2alpha::Decompressor::DecompressorLibrary>&
+          libraries,
+      const std::string& prefix, Server::Configuration::FactoryContext& context);
+
+  std::vector<DecompressorLibrary> libraries_;
+  const bool request_decompression_enabled_;
+  const bool response_decompression_enabled_;
+  const uint64_t max_decompressed_bytes_;
+};
+typedef std::shared_ptr<DecompressorFilterConfig> DecompressorFilterConfigSharedPtr;
+
+/**
+ * A filter that decompresses the bodies of the requests, and of the responses whose content coding
+ * the client doesn't accept, with the decompressor library of their outermost content coding.
+ */
+class DecompressorFilter : public Http::PassThroughFilter {
+public:
+  DecompressorFilter(const DecompressorFilterConfigSharedPtr& config) : config_(config) {}
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance& data, bool end_stream) override;
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+
+private:
+  /**
+   * The decompression of the body of a direction of the stream.
+   */
+  struct Decompression {
+    Envoy::Decompressor::DecompressorPtr decompressor_;
+    DecompressorLibraryStats* stats_{};
+    uint64_t decompressed_bytes_{};
+    // Set once the body failed to decompress, after which the rest of it is dropped.
+    bool failed_{};
+  };
+
+  enum class Result { Decompressed, Malformed, TooLarge };
+
+  DecompressorFilterConfig::DecompressorLibrary* findLibrary(const Http::HeaderMap& headers) const;
+  void startDecompression(Decompression& decompression, DecompressorLibraryStats& stats,
+                          Envoy::Decompressor::DecompressorFactory& factory,
+                          Http::HeaderMap& headers);
+  Result decompress(Decompression& decompression, Buffer::Instance& data);
+  bool isContentCodingAccepted(absl::string_view content_coding) const;
+
+  const DecompressorFilterConfigSharedPtr config_;
+  // The headers of the request, which live as long as the stream, for the accept-encoding header
+  // the response is checked against.
+  const Http::HeaderMap* request_headers_{};
+  Decompression request_;
+  Decompression response_;
+};
+
+} // namespace Decompressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,75 @@
+#include "extensions/filters/http/dynamic_forward_proxy/proxy_filter.h"
+
+#include "envoy/router/router.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace DynamicForwardProxy {
+
+ProxyFilterConfig::ProxyFilterConfig(
+    const envoy::config::filter::http::dynamic_forward_proxy::v2alpha::FilterConfig& proto_config,
+    Extensions::Common::DynamicForwardProxy::DnsCacheManagerFactory& cache_manager_factory,
+    Upstream::ClusterManager& cluster_manager)
+    : dns_cache_manager_(cache_manager_factory.get()),
+      dns_cache_(dns_cache_manager_->getCache(proto_config.dns_cache_config())),
+      cluster_manager_(cluster_manager) {}
+
+Http::FilterHeadersStatus ProxyFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
+  Router::RouteConstSharedPtr route = callbacks_->route();
+  if (route == nullptr || route->routeEntry() == nullptr || headers.Host() == nullptr) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  Upstream::ThreadLocalCluster* cluster =
+      config_->clusterManager().get(route->routeEntry()->clusterName());
+  if (cluster == nullptr) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  // Hosts without a port use the default port of the cluster's transport.
+  const uint16_t default_port =
+      cluster->info()->transportSocketFactory().implementsSecureTransport() ? 443 : 80;
+  auto result = config_->cache().loadDnsCacheEntry(headers.Host()->value().getStringView(),
+                                                   default_port, *this);
+  switch (result.status_) {
+  case Extensions::Common::DynamicForwardProxy::DnsCache::LoadDnsCacheEntryStatus::InCache:
+    ASSERT(result.handle_ == nullptr);
+    ENVOY_STREAM_LOG(debug, "DNS cache entry already loaded, continuing", *callbacks_);
+    return Http::FilterHeadersStatus::Continue;
+  case Extensions::Common::DynamicForwardProxy::DnsCache::LoadDnsCacheEntryStatus::Loading:
+    ASSERT(result.handle_ != nullptr);
+    ENVOY_STREAM_LOG(debug, "waiting to load DNS cache entry", *callbacks_);
+    cache_load_handle_ = std::move(result.handle_);
+    return Http::FilterHeadersStatus::StopIteration;
+  }
+
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+Http::FilterDataStatus ProxyFilter::decodeData(Buffer::Instance&, bool) {
+  return cache_load_handle_ == nullptr ? Http::FilterDataStatus::Continue
+                                       : Http::FilterDataStatus::StopIterationAndWatermark;
+}
+
+Http::FilterTrailersStatus ProxyFilter::decodeTrailers(Http::HeaderMap&) {
+  return cache_load_handle_ == nullptr ? Http::FilterTrailersStatus::Continue
+                                       : Http::FilterTrailersStatus::StopIteration;
+}
+
+void ProxyFilter::onDestroy() {
+  // Dropping the handle cancels the callback if it is still pending.
+  cache_load_handle_.reset();
+}
+
+void ProxyFilter::onLoadDnsCacheComplete() {
+  ENVOY_STREAM_LOG(debug, "load DNS cache complete, continuing", *callbacks_);
+  ASSERT(cache_load_handle_ != nullptr);
+  cache_load_handle_.reset();
+  callbacks_->continueDecoding();
+}
+
+} // namespace DynamicForwardProxy
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
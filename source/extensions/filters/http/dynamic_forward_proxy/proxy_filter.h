@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/config/filter/http/dynamic_forward_proxy/v2alpha/dynamic_forward_proxy.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/upstream/cluster_manager.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/common/dynamic_forward_proxy/dns_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace DynamicForwardProxy {
+
+/**
+ * Configuration for the dynamic forward proxy filter.
+ */
+class ProxyFilterConfig {
+public:
+  ProxyFilterConfig(
+      const envoy::config::filter::http::dynamic_forward_proxy::v2alpha::FilterConfig& proto_config,
+      Extensions::Common::DynamicForwardProxy::DnsCacheManagerFactory& cache_manager_factory,
+      Upstream::ClusterManager& cluster_manager);
+
+  Extensions::Common::DynamicForwardProxy::DnsCache& cache() { return *dns_cache_; }
+  Upstream::ClusterManager& clusterManager() { return cluster_manager_; }
+
+private:
+  const Extensions::Common::DynamicForwardProxy::DnsCacheManagerSharedPtr dns_cache_manager_;
+  const Extensions::Common::DynamicForwardProxy::DnsCacheSharedPtr dns_cache_;
+  Upstream::ClusterManager& cluster_manager_;
+};
+
+typedef std::shared_ptr<ProxyFilterConfig> ProxyFilterConfigSharedPtr;
+
+/**
+ * A filter that holds requests until the host in their Host header is in the DNS cache, so that
+ * the dynamic forward proxy cluster they are routed to has a host for them. Hosts that are already
+ * cached do not hold the request.
+ */
+class ProxyFilter
+    : public Http::StreamDecoderFilter,
+      public Extensions::Common::DynamicForwardProxy::DnsCache::LoadDnsCacheEntryCallbacks,
+      Logger::Loggable<Logger::Id::forward_proxy> {
+public:
+  ProxyFilter(const ProxyFilterConfigSharedPtr& config) : config_(config) {}
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap& trailers) override;
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override {
+    callbacks_ = &callbacks;
+  }
+
+  // Extensions::Common::DynamicForwardProxy::DnsCache::LoadDnsCacheEntryCallbacks
+  void onLoadDnsCacheComplete() override;
+
+private:
+  const ProxyFilterConfigSharedPtr config_;
+  Http::StreamDecoderFilterCallbacks* callbacks_{};
+  // Set while the request is held.
+  Extensions::Common::DynamicForwardProxy::DnsCache::LoadDnsCacheEntryHandlePtr cache_load_handle_;
+};
+
+} // namespace DynamicForwardProxy
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -21,7 +21,8 @@ Http::FilterFactoryCb ExtAuthzFilterConfig::createFilterFactoryFromProtoTyped(
     const envoy::config::filter::http::ext_authz::v2::ExtAuthz& proto_config, const std::string&,
     Server::Configuration::FactoryContext& context) {
   const auto filter_config = std::make_shared<FilterConfig>(
-      proto_config, context.localInfo(), context.scope(), context.runtime(), context.httpContext());
+      proto_config, context.localInfo(), context.scope(), context.runtime(), context.httpContext(),
+      context.threadLocal(), context.timeSource());
   Http::FilterFactoryCb callback;
 
   if (proto_config.has_http_service()) {
@@ -0,0 +1,111 @@
+#include "extensions/filters/http/ext_authz/decision_cache.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/crypto/utility.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+
+namespace {
+
+std::vector<Http::LowerCaseString>
+toLowerCaseStrings(const Protobuf::RepeatedPtrField<ProtobufTypes::String>& strings) {
+  std::vector<Http::LowerCaseString> lower_case_strings;
+  for (const auto& string : strings) {
+    lower_case_strings.emplace_back(string);
+  }
+  return lower_case_strings;
+}
+
+} // namespace
+
+DecisionCache::DecisionCache(
+    const envoy::config::filter::http::ext_authz::v2::DecisionCache& config,
+    ThreadLocal::SlotAllocator& tls, TimeSource& time_source)
+    : key_headers_(toLowerCaseStrings(config.key_headers())),
+      path_segments_(config.path_segments()),
+      default_ttl_(PROTOBUF_GET_MS_REQUIRED(config, default_ttl)),
+      max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, DefaultMaxEntries)),
+      time_source_(time_source), tls_(tls.allocateSlot()) {
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalDecisions>();
+  });
+}
+
+absl::optional<std::string> DecisionCache::key(const Http::HeaderMap& headers) const {
+  // The lengths of the values are hashed too, so that no values digest like others.
+  Buffer::OwnedImpl values;
+  for (const Http::LowerCaseString& key_header : key_headers_) {
+    const Http::HeaderEntry* entry = headers.get(key_header);
+    if (entry == nullptr) {
+      return absl::nullopt;
+    }
+    const uint64_t length = entry->value().size();
+    values.add(&length, sizeof(length));
+    values.add(entry->value().getStringView());
+  }
+  const std::vector<uint8_t> digest = Envoy::Common::Crypto::Utility::getSha256Digest(values);
+  std::string key(digest.begin(), digest.end());
+
+  // The digest has a fixed size, so that the path prefix can follow it.
+  if (path_segments_ > 0 && headers.Path() != nullptr) {
+    absl::string_view path = headers.Path()->value().getStringView();
+    path = path.substr(0, path.find('?'));
+    size_t end = 0;
+    for (uint32_t i = 0; i < path_segments_ && end != absl::string_view::npos; i++) {
+      end = path.find('/', end + 1);
+    }
+    const absl::string_view prefix = path.substr(0, end);
+    key.append(prefix.data(), prefix.size());
+  }
+  return key;
+}
+
+ResponseConstSharedPtr DecisionCache::lookup(const std::string& key) {
+  auto& decisions = tls_->getTyped<ThreadLocalDecisions>();
+  const auto it = decisions.index_.find(key);
+  if (it == decisions.index_.end()) {
+    return nullptr;
+  }
+  if (it->second->expiry_ <= time_source_.monotonicTime()) {
+    decisions.entries_.erase(it->second);
+    decisions.index_.erase(it);
+    return nullptr;
+  }
+  decisions.entries_.splice(decisions.entries_.begin(), decisions.entries_, it->second);
+  return it->second->response_;
+}
+
+void DecisionCache::insert(const std::string& key,
+                           const Filters::Common::ExtAuthz::Response& response) {
+  ASSERT(response.status == Filters::Common::ExtAuthz::CheckStatus::OK);
+  const std::chrono::milliseconds ttl = response.cache_ttl.value_or(default_ttl_);
+  if (ttl.count() <= 0) {
+    return;
+  }
+
+  auto& decisions = tls_->getTyped<ThreadLocalDecisions>();
+  const auto it = decisions.index_.find(key);
+  if (it != decisions.index_.end()) {
+    decisions.entries_.erase(it->second);
+    decisions.index_.erase(it);
+  }
+  decisions.entries_.push_front(
+      {key, std::make_shared<const Filters::Common::ExtAuthz::Response>(response),
+       time_source_.monotonicTime() + ttl});
+  decisions.index_.emplace(key, decisions.entries_.begin());
+
+  while (decisions.entries_.size() > max_entries_) {
+    decisions.index_.erase(decisions.entries_.back().key_);
+    decisions.entries_.pop_back();
+  }
+}
+
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
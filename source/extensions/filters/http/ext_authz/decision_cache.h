@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/config/filter/http/ext_authz/v2/ext_authz.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "extensions/filters/common/ext_authz/ext_authz.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+
+typedef std::shared_ptr<const Filters::Common::ExtAuthz::Response> ResponseConstSharedPtr;
+
+/**
+ * Cache of the OK decisions of the authorization service. Each worker thread has its own LRU
+ * cache, so that lookups and insertions don't need locking.
+ */
+class DecisionCache {
+public:
+  DecisionCache(const envoy::config::filter::http::ext_authz::v2::DecisionCache& config,
+                ThreadLocal::SlotAllocator& tls, TimeSource& time_source);
+
+  /**
+   * @param headers supplies the request headers.
+   * @return the cache key of the request, nullopt if it lacks one of the key headers.
+   */
+  absl::optional<std::string> key(const Http::HeaderMap& headers) const;
+
+  /**
+   * @param key supplies a cache key.
+   * @return the unexpired decision cached for the key by this worker, nullptr if there is none.
+   */
+  ResponseConstSharedPtr lookup(const std::string& key);
+
+  /**
+   * Cache an OK decision on this worker for its TTL, or for the default TTL if it doesn't set one.
+   * @param key supplies the cache key of the request.
+   * @param response supplies the decision.
+   */
+  void insert(const std::string& key, const Filters::Common::ExtAuthz::Response& response);
+
+  static constexpr uint32_t DefaultMaxEntries = 1024;
+
+private:
+  struct Entry {
+    std::string key_;
+    ResponseConstSharedPtr response_;
+    MonotonicTime expiry_;
+  };
+
+  struct ThreadLocalDecisions : public ThreadLocal::ThreadLocalObject {
+    // Most recently used first.
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  };
+
+  const std::vector<Http::LowerCaseString> key_headers_;
+  const uint32_t path_segments_;
+  const std::chrono::milliseconds default_ttl_;
+  const uint32_t max_entries_;
+  TimeSource& time_source_;
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::unique_ptr<DecisionCache> DecisionCachePtr;
+
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
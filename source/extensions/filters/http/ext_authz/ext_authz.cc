@@ -41,6 +41,23 @@ void Filter::initiateCall(const Http::HeaderMap& headers) {
     }
   }
 
+  DecisionCache* decision_cache = config_->decisionCache();
+  if (decision_cache != nullptr) {
+    decision_cache_key_ = decision_cache->key(headers);
+    if (decision_cache_key_) {
+      const ResponseConstSharedPtr decision = decision_cache->lookup(decision_cache_key_.value());
+      if (decision != nullptr) {
+        cluster_->statsScope().counter("ext_authz.decision_cache_hit").inc();
+        ENVOY_STREAM_LOG(debug, "ext_authz accepted the request with a cached decision",
+                         *callbacks_);
+        state_ = State::Complete;
+        addRequestHeaders(*decision);
+        return;
+      }
+      cluster_->statsScope().counter("ext_authz.decision_cache_miss").inc();
+    }
+  }
+
   // We are not disabled - get a merged view of the config:
   auto&& maybe_merged_per_route_config =
       Http::Utility::getMergedPerFilterConfig<FilterConfigPerRoute>(
@@ -94,6 +111,26 @@ void Filter::onDestroy() {
   }
 }
 
+void Filter::addRequestHeaders(const Filters::Common::ExtAuthz::Response& response) {
+  ENVOY_STREAM_LOG(trace, "ext_authz upstream header(s):", *callbacks_);
+  for (const auto& header : response.headers_to_add) {
+    Http::HeaderEntry* header_to_modify = request_headers_->get(header.first);
+    if (header_to_modify) {
+      header_to_modify->value(header.second.c_str(), header.second.size());
+    } else {
+      request_headers_->addCopy(header.first, header.second);
+    }
+    ENVOY_STREAM_LOG(trace, " '{}':'{}'", *callbacks_, header.first.get(), header.second);
+  }
+  for (const auto& header : response.headers_to_append) {
+    Http::HeaderEntry* header_to_modify = request_headers_->get(header.first);
+    if (header_to_modify) {
+      Http::HeaderMapImpl::appendToHeader(header_to_modify->value(), header.second);
+      ENVOY_STREAM_LOG(trace, " '{}':'{}'", *callbacks_, header.first.get(), header.second);
+    }
+  }
+}
+
 void Filter::onComplete(Filters::Common::ExtAuthz::ResponsePtr&& response) {
   ASSERT(cluster_);
   state_ = State::Complete;
@@ -153,22 +190,9 @@ void Filter::onComplete(Filters::Common::ExtAuthz::ResponsePtr&& response) {
     }
     // Only send headers if the response is ok.
     if (response->status == CheckStatus::OK) {
-      ENVOY_STREAM_LOG(trace, "ext_authz upstream header(s):", *callbacks_);
-      for (const auto& header : response->headers_to_add) {
-        Http::HeaderEntry* header_to_modify = request_headers_->get(header.first);
-        if (header_to_modify) {
-          header_to_modify->value(header.second.c_str(), header.second.size());
-        } else {
-          request_headers_->addCopy(header.first, header.second);
-        }
-        ENVOY_STREAM_LOG(trace, " '{}':'{}'", *callbacks_, header.first.get(), header.second);
-      }
-      for (const auto& header : response->headers_to_append) {
-        Http::HeaderEntry* header_to_modify = request_headers_->get(header.first);
-        if (header_to_modify) {
-          Http::HeaderMapImpl::appendToHeader(header_to_modify->value(), header.second);
-          ENVOY_STREAM_LOG(trace, " '{}':'{}'", *callbacks_, header.first.get(), header.second);
-        }
+      addRequestHeaders(*response);
+      if (decision_cache_key_) {
+        config_->decisionCache()->insert(decision_cache_key_.value(), *response);
       }
     }
 
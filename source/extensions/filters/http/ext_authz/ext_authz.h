@@ -10,6 +10,7 @@
 #include "envoy/local_info/local_info.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
+#include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/common/assert.h"
@@ -20,6 +21,7 @@
 #include "extensions/filters/common/ext_authz/ext_authz.h"
 #include "extensions/filters/common/ext_authz/ext_authz_grpc_impl.h"
 #include "extensions/filters/common/ext_authz/ext_authz_http_impl.h"
+#include "extensions/filters/http/ext_authz/decision_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -38,9 +40,14 @@ class FilterConfig {
 public:
   FilterConfig(const envoy::config::filter::http::ext_authz::v2::ExtAuthz& config,
                const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
-               Runtime::Loader& runtime, Http::Context& http_context)
+               Runtime::Loader& runtime, Http::Context& http_context,
+               ThreadLocal::SlotAllocator& tls, TimeSource& time_source)
       : failure_mode_allow_(config.failure_mode_allow()), local_info_(local_info), scope_(scope),
-        runtime_(runtime), http_context_(http_context) {}
+        runtime_(runtime), http_context_(http_context),
+        decision_cache_(config.has_decision_cache()
+                            ? std::make_unique<DecisionCache>(config.decision_cache(), tls,
+                                                              time_source)
+                            : nullptr) {}
 
   bool failureModeAllow() const { return failure_mode_allow_; }
   const LocalInfo::LocalInfo& localInfo() const { return local_info_; }
@@ -49,12 +56,18 @@ public:
 
   Http::Context& httpContext() { return http_context_; }
 
+  /**
+   * @return the cache of the OK decisions, nullptr if decisions aren't cached.
+   */
+  DecisionCache* decisionCache() { return decision_cache_.get(); }
+
 private:
   bool failure_mode_allow_{};
   const LocalInfo::LocalInfo& local_info_;
   Stats::Scope& scope_;
   Runtime::Loader& runtime_;
   Http::Context& http_context_;
+  const DecisionCachePtr decision_cache_;
 };
 
 typedef std::shared_ptr<FilterConfig> FilterConfigSharedPtr;
@@ -116,6 +129,7 @@ public:
 
 private:
   void addResponseHeaders(Http::HeaderMap& header_map, const Http::HeaderVector& headers);
+  void addRequestHeaders(const Filters::Common::ExtAuthz::Response& response);
 
   // State of this filter's communication with the external authorization service.
   // The filter has either not started calling the external service, in the middle of calling
@@ -139,6 +153,8 @@ private:
 
   // Used to identify if the callback to onComplete() is synchronous (on the stack) or asynchronous.
   bool initiating_call_{};
+  // The key of the decision in the decision cache, if the request can be cached.
+  absl::optional<std::string> decision_cache_key_;
   envoy::service::auth::v2::CheckRequest check_request_{};
 };
 
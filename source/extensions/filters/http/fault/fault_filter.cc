@@ -107,15 +107,15 @@ Http::FilterHeadersStatus FaultFilter::decodeHeaders(Http::HeaderMap& headers, b
 
   if (headers.EnvoyDownstreamServiceCluster()) {
     downstream_cluster_ = headers.EnvoyDownstreamServiceCluster()->value().c_str();
-
-    downstream_cluster_delay_percent_key_ =
-        fmt::format("fault.http.{}.delay.fixed_delay_percent", downstream_cluster_);
+  }
+  if (!downstream_cluster_.empty()) {
+    // The delay percentage is only looked up when a delay is configured.
+    if (fault_settings_->requestDelay() != nullptr) {
+      downstream_cluster_delay_percent_key_ =
+          fmt::format("fault.http.{}.delay.fixed_delay_percent", downstream_cluster_);
+    }
     downstream_cluster_abort_percent_key_ =
         fmt::format("fault.http.{}.abort.abort_percent", downstream_cluster_);
-    downstream_cluster_delay_duration_key_ =
-        fmt::format("fault.http.{}.delay.fixed_duration_ms", downstream_cluster_);
-    downstream_cluster_abort_http_status_key_ =
-        fmt::format("fault.http.{}.abort.http_status", downstream_cluster_);
   }
 
   maybeSetupResponseRateLimit(headers);
@@ -177,6 +177,11 @@ bool FaultFilter::faultOverflow() {
       RuntimeKeys::get().MaxActiveFaultsKey, fault_settings_->maxActiveFaults().has_value()
                                                  ? fault_settings_->maxActiveFaults().value()
                                                  : std::numeric_limits<uint64_t>::max());
+  // Without a limit, the gauge shared by the workers is not read.
+  if (max_faults == std::numeric_limits<uint64_t>::max()) {
+    return false;
+  }
+
   // Note: Since we don't compare/swap here this is a fuzzy limit which is similar to how the
   // other circuit breakers work.
   if (config_->stats().active_faults_.value() >= max_faults) {
@@ -230,9 +235,10 @@ FaultFilter::delayDuration(const Http::HeaderMap& request_headers) {
   std::chrono::milliseconds duration =
       std::chrono::milliseconds(config_->runtime().snapshot().getInteger(
           RuntimeKeys::get().DelayDurationKey, config_duration.value().count()));
-  if (!downstream_cluster_delay_duration_key_.empty()) {
+  if (!downstream_cluster_.empty()) {
     duration = std::chrono::milliseconds(config_->runtime().snapshot().getInteger(
-        downstream_cluster_delay_duration_key_, duration.count()));
+        fmt::format("fault.http.{}.delay.fixed_duration_ms", downstream_cluster_),
+        duration.count()));
   }
 
   // Delay only if the duration is >0ms
@@ -248,9 +254,9 @@ uint64_t FaultFilter::abortHttpStatus() {
   uint64_t http_status = config_->runtime().snapshot().getInteger(
       RuntimeKeys::get().AbortHttpStatusKey, fault_settings_->abortCode());
 
-  if (!downstream_cluster_abort_http_status_key_.empty()) {
+  if (!downstream_cluster_.empty()) {
     http_status = config_->runtime().snapshot().getInteger(
-        downstream_cluster_abort_http_status_key_, http_status);
+        fmt::format("fault.http.{}.abort.http_status", downstream_cluster_), http_status);
   }
 
   return http_status;
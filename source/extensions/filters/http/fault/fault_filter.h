@@ -16,6 +16,7 @@
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/token_bucket_impl.h"
 #include "common/http/header_utility.h"
+#include "common/runtime/runtime_impl.h"
 
 #include "extensions/filters/common/fault/fault_config.h"
 
@@ -53,7 +54,7 @@ public:
   const std::vector<Http::HeaderUtility::HeaderData>& filterHeaders() const {
     return fault_filter_headers_;
   }
-  envoy::type::FractionalPercent abortPercentage() const { return abort_percentage_; }
+  const envoy::type::FractionalPercent& abortPercentage() const { return abort_percentage_; }
   uint64_t abortCode() const { return http_status_; }
   const Filters::Common::Fault::FaultDelayConfig* requestDelay() const {
     return request_delay_config_.get();
@@ -192,14 +193,16 @@ public:
   }
 
 private:
+  // The keys that do not depend on the downstream cluster are looked up by handle.
   class RuntimeKeyValues {
   public:
-    const std::string DelayPercentKey = "fault.http.delay.fixed_delay_percent";
-    const std::string AbortPercentKey = "fault.http.abort.abort_percent";
-    const std::string DelayDurationKey = "fault.http.delay.fixed_duration_ms";
-    const std::string AbortHttpStatusKey = "fault.http.abort.http_status";
-    const std::string MaxActiveFaultsKey = "fault.http.max_active_faults";
-    const std::string ResponseRateLimitPercentKey = "fault.http.rate_limit.response_percent";
+    const Runtime::FeatureHandleImpl DelayPercentKey{"fault.http.delay.fixed_delay_percent"};
+    const Runtime::FeatureHandleImpl AbortPercentKey{"fault.http.abort.abort_percent"};
+    const Runtime::FeatureHandleImpl DelayDurationKey{"fault.http.delay.fixed_duration_ms"};
+    const Runtime::FeatureHandleImpl AbortHttpStatusKey{"fault.http.abort.http_status"};
+    const Runtime::FeatureHandleImpl MaxActiveFaultsKey{"fault.http.max_active_faults"};
+    const Runtime::FeatureHandleImpl ResponseRateLimitPercentKey{
+        "fault.http.rate_limit.response_percent"};
   };
 
   using RuntimeKeys = ConstSingleton<RuntimeKeyValues>;
@@ -227,10 +230,10 @@ private:
   const FaultSettings* fault_settings_;
   bool fault_active_{};
   std::unique_ptr<StreamRateLimiter> response_limiter_;
+  // The keys of the duration of a delay and of the status of an abort are only formatted when the
+  // fault is injected.
   std::string downstream_cluster_delay_percent_key_{};
   std::string downstream_cluster_abort_percent_key_{};
-  std::string downstream_cluster_delay_duration_key_{};
-  std::string downstream_cluster_abort_http_status_key_{};
 };
 
 } // namespace Fault
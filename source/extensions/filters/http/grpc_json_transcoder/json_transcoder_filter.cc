@@ -232,7 +232,7 @@ Http::FilterHeadersStatus JsonTranscoderFilter::decodeHeaders(Http::HeaderMap& h
     // just pass-through the request to upstream.
     return Http::FilterHeadersStatus::Continue;
   }
-  has_http_body_output_ = !method_->server_streaming() && hasHttpBodyAsOutputType();
+  has_http_body_output_ = hasHttpBodyAsOutputType();
 
   headers.removeContentLength();
   headers.insertContentType().value().setReference(Http::Headers::get().ContentTypeValues.Grpc);
@@ -343,7 +343,8 @@ Http::FilterHeadersStatus JsonTranscoderFilter::encodeHeaders(Http::HeaderMap& h
   }
 
   headers.insertContentType().value().setReference(Http::Headers::get().ContentTypeValues.Json);
-  if (!method_->server_streaming()) {
+  // The content type of an HttpBody output is known once its first message arrives.
+  if (!method_->server_streaming() || has_http_body_output_) {
     return Http::FilterHeadersStatus::StopIteration;
   }
 
@@ -355,8 +356,10 @@ Http::FilterDataStatus JsonTranscoderFilter::encodeData(Buffer::Instance& data,
     return Http::FilterDataStatus::Continue;
   }
 
-  // TODO(dio): Add support for streaming case.
   if (has_http_body_output_) {
+    if (method_->server_streaming()) {
+      return encodeStreamingHttpBodyOutput(data, end_stream);
+    }
     buildResponseFromHttpBodyOutput(*response_headers_, data);
     return Http::FilterDataStatus::StopIterationAndBuffer;
   }
@@ -385,11 +388,14 @@ Http::FilterTrailersStatus JsonTranscoderFilter::encodeTrailers(Http::HeaderMap&
 
   response_in_.finish();
 
-  Buffer::OwnedImpl data;
-  readToBuffer(*transcoder_->ResponseOutput(), data);
+  // HttpBody outputs are not transcoded to JSON, so the transcoder has nothing to output.
+  if (!has_http_body_output_) {
+    Buffer::OwnedImpl data;
+    readToBuffer(*transcoder_->ResponseOutput(), data);
 
-  if (data.length()) {
-    encoder_callbacks_->addEncodedData(data, true);
+    if (data.length()) {
+      encoder_callbacks_->addEncodedData(data, true);
+    }
   }
 
   if (method_->server_streaming()) {
@@ -468,6 +474,32 @@ void JsonTranscoderFilter::buildResponseFromHttpBodyOutput(Http::HeaderMap& resp
   }
 }
 
+Http::FilterDataStatus JsonTranscoderFilter::encodeStreamingHttpBodyOutput(Buffer::Instance& data,
+                                                                           bool end_stream) {
+  // Each HttpBody is emitted as soon as its frame is complete, so that the response is streamed
+  // instead of buffered.
+  std::vector<Grpc::Frame> frames;
+  decoder_.decode(data, frames);
+
+  google::api::HttpBody http_body;
+  for (auto& frame : frames) {
+    if (frame.length_ == 0) {
+      continue;
+    }
+    Buffer::ZeroCopyInputStreamImpl stream(std::move(frame.data_));
+    http_body.ParseFromZeroCopyStream(&stream);
+    if (!http_body_output_started_) {
+      response_headers_->insertContentType().value(http_body.content_type());
+      http_body_output_started_ = true;
+    }
+    data.add(ProtobufTypes::String(http_body.data()));
+  }
+
+  // The headers wait for the first message, which the decoder holds until its frame is complete.
+  return http_body_output_started_ || end_stream ? Http::FilterDataStatus::Continue
+                                                 : Http::FilterDataStatus::StopIterationNoBuffer;
+}
+
 bool JsonTranscoderFilter::hasHttpBodyAsOutputType() {
   return method_->output_type()->full_name() == google::api::HttpBody::descriptor()->full_name();
 }
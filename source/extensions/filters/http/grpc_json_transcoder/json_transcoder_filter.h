@@ -124,6 +124,7 @@ public:
 private:
   bool readToBuffer(Protobuf::io::ZeroCopyInputStream& stream, Buffer::Instance& data);
   void buildResponseFromHttpBodyOutput(Http::HeaderMap& response_headers, Buffer::Instance& data);
+  Http::FilterDataStatus encodeStreamingHttpBodyOutput(Buffer::Instance& data, bool end_stream);
   bool hasHttpBodyAsOutputType();
 
   JsonTranscoderConfig& config_;
@@ -138,6 +139,7 @@ private:
 
   bool error_{false};
   bool has_http_body_output_{false};
+  bool http_body_output_started_{false};
 };
 
 } // namespace GrpcJsonTranscoder
@@ -85,30 +85,22 @@ Http::FilterDataStatus GrpcWebFilter::decodeData(Buffer::Instance& data, bool en
     return Http::FilterDataStatus::Continue;
   }
 
-  // Parse application/grpc-web-text format.
-  const uint64_t available = data.length() + decoding_buffer_.length();
+  // Parse application/grpc-web-text format. The data is decoded from its slices, behind the partial
+  // quad carried over from the previous data, if any.
+  decoding_buffer_.move(data);
   if (end_stream) {
-    if (available == 0) {
-      return Http::FilterDataStatus::Continue;
-    }
-    if (available % 4 != 0) {
+    if (decoding_buffer_.length() % 4 != 0) {
       // Client end stream with invalid base64. Note, base64 padding is mandatory.
       decoder_callbacks_->sendLocalReply(Http::Code::BadRequest,
                                          "Bad gRPC-web request, invalid base64 data.", nullptr,
                                          absl::nullopt);
       return Http::FilterDataStatus::StopIterationNoBuffer;
     }
-  } else if (available < 4) {
-    decoding_buffer_.move(data);
+  } else if (decoding_buffer_.length() < 4) {
     return Http::FilterDataStatus::StopIterationNoBuffer;
   }
 
-  const uint64_t needed = available / 4 * 4 - decoding_buffer_.length();
-  decoding_buffer_.move(data, needed);
-  const std::string decoded = Base64::decode(
-      std::string(static_cast<const char*>(decoding_buffer_.linearize(decoding_buffer_.length())),
-                  decoding_buffer_.length()));
-  if (decoded.empty()) {
+  if (!Base64::decode(decoding_buffer_, data)) {
     // Error happened when decoding base64.
     decoder_callbacks_->sendLocalReply(Http::Code::BadRequest,
                                        "Bad gRPC-web request, invalid base64 data.", nullptr,
@@ -116,9 +108,6 @@ Http::FilterDataStatus GrpcWebFilter::decodeData(Buffer::Instance& data, bool en
     return Http::FilterDataStatus::StopIterationNoBuffer;
   }
 
-  decoding_buffer_.drain(decoding_buffer_.length());
-  decoding_buffer_.move(data);
-  data.add(decoded);
   // Any block of 4 bytes or more should have been decoded and passed through.
   ASSERT(decoding_buffer_.length() < 4);
   return Http::FilterDataStatus::Continue;
@@ -170,9 +159,9 @@ Http::FilterDataStatus GrpcWebFilter::encodeData(Buffer::Instance& data, bool) {
     const uint32_t length = htonl(frame.length_);
     temp.add(&length, 4);
     if (frame.length_ > 0) {
-      temp.add(*frame.data_);
+      temp.move(*frame.data_);
     }
-    data.add(Base64::encode(temp, temp.length()));
+    Base64::encode(temp, data);
   }
   return Http::FilterDataStatus::Continue;
 }
@@ -207,7 +196,8 @@ Http::FilterTrailersStatus GrpcWebFilter::encodeTrailers(Http::HeaderMap& traile
   buffer.add(&length, 4);
   buffer.move(temp);
   if (is_text_response_) {
-    Buffer::OwnedImpl encoded(Base64::encode(buffer, buffer.length()));
+    Buffer::OwnedImpl encoded;
+    Base64::encode(buffer, encoded);
     encoder_callbacks_->addEncodedData(encoded, true);
   } else {
     encoder_callbacks_->addEncodedData(buffer, true);
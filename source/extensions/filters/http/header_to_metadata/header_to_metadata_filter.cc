@@ -5,6 +5,7 @@
 
 #include "extensions/filters/http/well_known_names.h"
 
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/string_view.h"
 
@@ -16,11 +17,21 @@ namespace {
 
 const uint32_t MAX_HEADER_VALUE_LEN = 100;
 
+// The headers found for each rule while iterating the header map.
+typedef absl::InlinedVector<const Http::HeaderEntry*, 16> RuleHeaderEntries;
+
+struct MatchContext {
+  const HeaderToMetadataRuleIndex& rule_index_;
+  RuleHeaderEntries& header_entries_;
+};
+
 } // namespace
 
 Config::Config(const envoy::config::filter::http::header_to_metadata::v2::Config config) {
-  request_set_ = Config::configToVector(config.request_rules(), request_rules_);
-  response_set_ = Config::configToVector(config.response_rules(), response_rules_);
+  request_set_ =
+      Config::configToVector(config.request_rules(), request_rules_, request_rule_index_);
+  response_set_ =
+      Config::configToVector(config.response_rules(), response_rules_, response_rule_index_);
 
   // don't allow an empty configuration
   if (!response_set_ && !request_set_) {
@@ -29,7 +40,7 @@ Config::Config(const envoy::config::filter::http::header_to_metadata::v2::Config
 }
 
 bool Config::configToVector(const ProtobufRepeatedRule& proto_rules,
-                            HeaderToMetadataRules& vector) {
+                            HeaderToMetadataRules& vector, HeaderToMetadataRuleIndex& index) {
   if (proto_rules.size() == 0) {
     ENVOY_LOG(debug, "no rules provided");
     return false;
@@ -46,6 +57,7 @@ bool Config::configToVector(const ProtobufRepeatedRule& proto_rules,
       throw EnvoyException(error);
     }
 
+    index[rule.first.get()].push_back(vector.size());
     vector.push_back(rule);
   }
 
@@ -58,7 +70,8 @@ HeaderToMetadataFilter::~HeaderToMetadataFilter() {}
 
 Http::FilterHeadersStatus HeaderToMetadataFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
   if (config_->doRequest()) {
-    writeHeaderToMetadata(headers, config_->requestRules(), *decoder_callbacks_);
+    writeHeaderToMetadata(headers, config_->requestRules(), config_->requestRuleIndex(),
+                          *decoder_callbacks_);
   }
 
   return Http::FilterHeadersStatus::Continue;
@@ -71,7 +84,8 @@ void HeaderToMetadataFilter::setDecoderFilterCallbacks(
 
 Http::FilterHeadersStatus HeaderToMetadataFilter::encodeHeaders(Http::HeaderMap& headers, bool) {
   if (config_->doResponse()) {
-    writeHeaderToMetadata(headers, config_->responseRules(), *encoder_callbacks_);
+    writeHeaderToMetadata(headers, config_->responseRules(), config_->responseRuleIndex(),
+                          *encoder_callbacks_);
   }
   return Http::FilterHeadersStatus::Continue;
 }
@@ -81,11 +95,10 @@ void HeaderToMetadataFilter::setEncoderFilterCallbacks(
   encoder_callbacks_ = &callbacks;
 }
 
-bool HeaderToMetadataFilter::addMetadata(StructMap& map, const std::string& meta_namespace,
+bool HeaderToMetadataFilter::addMetadata(envoy::api::v2::core::Metadata& metadata,
+                                         const std::string& meta_namespace,
                                          const std::string& key, absl::string_view value,
                                          ValueType type) const {
-  ProtobufWkt::Value val;
-
   if (value.empty()) {
     // No value, skip. we could allow this though.
     ENVOY_LOG(debug, "no metadata value provided");
@@ -98,36 +111,31 @@ bool HeaderToMetadataFilter::addMetadata(StructMap& map, const std::string& meta
     return false;
   }
 
-  // Sane enough, add the key/value.
+  double dval = 0;
   switch (type) {
   case envoy::config::filter::http::header_to_metadata::v2::Config_ValueType_STRING:
-    val.set_string_value(ProtobufTypes::String(value));
     break;
-  case envoy::config::filter::http::header_to_metadata::v2::Config_ValueType_NUMBER: {
-    double dval;
-    if (absl::SimpleAtod(StringUtil::trim(value), &dval)) {
-      val.set_number_value(dval);
-    } else {
+  case envoy::config::filter::http::header_to_metadata::v2::Config_ValueType_NUMBER:
+    if (!absl::SimpleAtod(StringUtil::trim(value), &dval)) {
       ENVOY_LOG(debug, "value to number conversion failed");
       return false;
     }
     break;
-  }
   default:
     ENVOY_LOG(debug, "unknown value type");
     return false;
   }
 
-  // Have we seen this namespace before?
-  auto namespace_iter = map.find(meta_namespace);
-  if (namespace_iter == map.end()) {
-    map[meta_namespace] = ProtobufWkt::Struct();
-    namespace_iter = map.find(meta_namespace);
+  // Sane enough, write the key/value straight into the metadata of the stream, in place of
+  // building a struct per namespace to merge into it.
+  ProtobufWkt::Value& val =
+      (*(*metadata.mutable_filter_metadata())[meta_namespace].mutable_fields())[key];
+  if (type == envoy::config::filter::http::header_to_metadata::v2::Config_ValueType_STRING) {
+    val.set_string_value(ProtobufTypes::String(value));
+  } else {
+    val.set_number_value(dval);
   }
 
-  auto& keyval = namespace_iter->second;
-  (*keyval.mutable_fields())[key] = val;
-
   return true;
 }
 
@@ -137,13 +145,32 @@ const std::string& HeaderToMetadataFilter::decideNamespace(const std::string& ns
 
 void HeaderToMetadataFilter::writeHeaderToMetadata(Http::HeaderMap& headers,
                                                    const HeaderToMetadataRules& rules,
+                                                   const HeaderToMetadataRuleIndex& rule_index,
                                                    Http::StreamFilterCallbacks& callbacks) {
-  StructMap structs_by_namespace;
-
-  for (const auto& rulePair : rules) {
-    const auto& header = rulePair.first;
-    const auto& rule = rulePair.second;
-    const Http::HeaderEntry* header_entry = headers.get(header);
+  // Find the header of every rule in a single iteration, instead of looking each one up in turn.
+  // Like HeaderMap::get(), the first header with the name of a rule is the one it applies to.
+  RuleHeaderEntries header_entries(rules.size(), nullptr);
+  MatchContext context{rule_index, header_entries};
+  headers.iterate(
+      [](const Http::HeaderEntry& header, void* context) -> Http::HeaderMap::Iterate {
+        MatchContext* match_context = static_cast<MatchContext*>(context);
+        const auto it = match_context->rule_index_.find(header.key().getStringView());
+        if (it != match_context->rule_index_.end()) {
+          for (const size_t rule : it->second) {
+            if (match_context->header_entries_[rule] == nullptr) {
+              match_context->header_entries_[rule] = &header;
+            }
+          }
+        }
+        return Http::HeaderMap::Iterate::Continue;
+      },
+      &context);
+
+  envoy::api::v2::core::Metadata& metadata = callbacks.streamInfo().dynamicMetadata();
+  for (size_t i = 0; i < rules.size(); ++i) {
+    const auto& header = rules[i].first;
+    const auto& rule = rules[i].second;
+    const Http::HeaderEntry* header_entry = header_entries[i];
 
     if (header_entry != nullptr && rule.has_on_header_present()) {
       const auto& keyval = rule.on_header_present();
@@ -152,13 +179,17 @@ void HeaderToMetadataFilter::writeHeaderToMetadata(Http::HeaderMap& headers,
 
       if (!value.empty()) {
         const auto& nspace = decideNamespace(keyval.metadata_namespace());
-        addMetadata(structs_by_namespace, nspace, keyval.key(), value, keyval.type());
+        addMetadata(metadata, nspace, keyval.key(), value, keyval.type());
       } else {
         ENVOY_LOG(debug, "value is empty, not adding metadata");
       }
 
       if (rule.remove()) {
         headers.remove(header);
+        // The later rules of the header find it missing.
+        for (const size_t header_rule : rule_index.find(header.get())->second) {
+          header_entries[header_rule] = nullptr;
+        }
       }
     } else if (rule.has_on_header_missing()) {
       // Add metadata for the header missing case.
@@ -166,19 +197,12 @@ void HeaderToMetadataFilter::writeHeaderToMetadata(Http::HeaderMap& headers,
 
       if (!keyval.value().empty()) {
         const auto& nspace = decideNamespace(keyval.metadata_namespace());
-        addMetadata(structs_by_namespace, nspace, keyval.key(), keyval.value(), keyval.type());
+        addMetadata(metadata, nspace, keyval.key(), keyval.value(), keyval.type());
       } else {
         ENVOY_LOG(debug, "value is empty, not adding metadata");
       }
     }
   }
-
-  // Any matching rules?
-  if (structs_by_namespace.size() > 0) {
-    for (auto const& entry : structs_by_namespace) {
-      callbacks.streamInfo().setDynamicMetadata(entry.first, entry.second);
-    }
-  }
 }
 
 } // namespace HeaderToMetadataFilter
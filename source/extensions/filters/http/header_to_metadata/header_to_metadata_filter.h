@@ -4,11 +4,13 @@
 #include <tuple>
 #include <vector>
 
+#include "envoy/api/v2/core/base.pb.h"
 #include "envoy/config/filter/http/header_to_metadata/v2/header_to_metadata.pb.h"
 #include "envoy/server/filter_config.h"
 
 #include "common/common/logger.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
@@ -19,6 +21,9 @@ namespace HeaderToMetadataFilter {
 typedef envoy::config::filter::http::header_to_metadata::v2::Config::Rule Rule;
 typedef envoy::config::filter::http::header_to_metadata::v2::Config::ValueType ValueType;
 typedef std::vector<std::pair<Http::LowerCaseString, Rule>> HeaderToMetadataRules;
+// The indices of the rules of each header, so that the headers are matched against all the rules
+// in a single iteration of the header map.
+typedef absl::flat_hash_map<std::string, std::vector<size_t>> HeaderToMetadataRuleIndex;
 
 /**
  *  Encapsulates the filter configuration with STL containers and provides an area for any custom
@@ -28,8 +33,10 @@ class Config : public Logger::Loggable<Logger::Id::config> {
 public:
   Config(const envoy::config::filter::http::header_to_metadata::v2::Config config);
 
-  HeaderToMetadataRules requestRules() const { return request_rules_; }
-  HeaderToMetadataRules responseRules() const { return response_rules_; }
+  const HeaderToMetadataRules& requestRules() const { return request_rules_; }
+  const HeaderToMetadataRules& responseRules() const { return response_rules_; }
+  const HeaderToMetadataRuleIndex& requestRuleIndex() const { return request_rule_index_; }
+  const HeaderToMetadataRuleIndex& responseRuleIndex() const { return response_rule_index_; }
   bool doResponse() const { return response_set_; }
   bool doRequest() const { return request_set_; }
 
@@ -38,6 +45,8 @@ private:
 
   HeaderToMetadataRules request_rules_;
   HeaderToMetadataRules response_rules_;
+  HeaderToMetadataRuleIndex request_rule_index_;
+  HeaderToMetadataRuleIndex response_rule_index_;
   bool response_set_;
   bool request_set_;
 
@@ -48,10 +57,13 @@ private:
    *  @param config A protobuf repeated field of metadata that specifies what headers to convert to
    *         metadata
    *  @param vector A vector that will be populated with the configuration data from config
+   *  @param index An index that will be populated with the indices in vector of the rules of each
+   *         header
    *  @return true if any configuration data was added to the vector, false otherwise. Can be used
    *          to validate whether the configuration was empty.
    */
-  static bool configToVector(const ProtobufRepeatedRule&, HeaderToMetadataRules&);
+  static bool configToVector(const ProtobufRepeatedRule&, HeaderToMetadataRules&,
+                             HeaderToMetadataRuleIndex&);
 
   const std::string& decideNamespace(const std::string& nspace) const;
 };
@@ -98,26 +110,26 @@ public:
   void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override;
 
 private:
-  typedef std::map<std::string, ProtobufWkt::Struct> StructMap;
-
   const ConfigSharedPtr config_;
   Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
   Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
 
   /**
-   *  writeHeaderToMetadata encapsulates (1) searching for the header and (2) writing it to the
+   *  writeHeaderToMetadata encapsulates (1) searching for the headers and (2) writing them to the
    *  request metadata.
    *  @param headers the map of key-value headers to look through. These could be response or
    *                 request headers depending on whether this is called from the encode state or
    *                 decode state.
    *  @param rules the header-to-metadata mapping set in configuration.
+   *  @param rule_index the indices of the rules of each header.
    *  @param callbacks the callback used to fetch the StreamInfo (which is then used to get
    *                   metadata). Callable with both encoder_callbacks_ and decoder_callbacks_.
    */
   void writeHeaderToMetadata(Http::HeaderMap& headers, const HeaderToMetadataRules& rules,
+                             const HeaderToMetadataRuleIndex& rule_index,
                              Http::StreamFilterCallbacks& callbacks);
-  bool addMetadata(StructMap&, const std::string&, const std::string&, absl::string_view,
-                   ValueType) const;
+  bool addMetadata(envoy::api::v2::core::Metadata&, const std::string&, const std::string&,
+                   absl::string_view, ValueType) const;
   const std::string& decideNamespace(const std::string& nspace) const;
 };
 
@@ -47,11 +47,22 @@ Http::FilterFactoryCb HealthCheckFilterConfig::createFilterFactoryFromProtoTyped
     cluster_min_healthy_percentages = std::move(cluster_to_percentage);
   }
 
+  ClusterHealthCacheManagerSharedPtr cluster_health_cache_manager;
+  if (proto_config.cache_cluster_health()) {
+    if (cluster_min_healthy_percentages == nullptr) {
+      throw EnvoyException("cache_cluster_health requires cluster_min_healthy_percentages and "
+                           "pass_through_mode to be disabled");
+    }
+    cluster_health_cache_manager = std::make_shared<ClusterHealthCacheManager>(
+        context.clusterManager(), context.threadLocal(), cluster_min_healthy_percentages);
+  }
+
   return [&context, pass_through_mode, cache_manager, header_match_data,
-          cluster_min_healthy_percentages](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamFilter(std::make_shared<HealthCheckFilter>(context, pass_through_mode,
-                                                                  cache_manager, header_match_data,
-                                                                  cluster_min_healthy_percentages));
+          cluster_min_healthy_percentages,
+          cluster_health_cache_manager](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamFilter(std::make_shared<HealthCheckFilter>(
+        context, pass_through_mode, cache_manager, header_match_data,
+        cluster_min_healthy_percentages, cluster_health_cache_manager));
   };
 }
 
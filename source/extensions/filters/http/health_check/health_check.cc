@@ -32,6 +32,96 @@ void HealthCheckCacheManager::onTimer() {
   clear_cache_timer_->enableTimer(timeout_);
 }
 
+Http::Code clusterHealthResponseCode(Upstream::ClusterManager& cluster_manager,
+                                     const ClusterMinHealthyPercentages& percentages) {
+  for (const auto& item : percentages) {
+    const std::string& cluster_name = item.first;
+    const double min_healthy_percentage = item.second;
+    auto* cluster = cluster_manager.get(cluster_name);
+    if (cluster == nullptr) {
+      // If the cluster does not exist at all, consider the service unhealthy.
+      return Http::Code::ServiceUnavailable;
+    }
+    const auto& stats = cluster->info()->stats();
+    const uint64_t membership_total = stats.membership_total_.value();
+    if (membership_total == 0) {
+      // If the cluster exists but is empty, consider the service unhealthy unless
+      // the specified minimum percent healthy for the cluster happens to be zero.
+      if (min_healthy_percentage == 0.0) {
+        continue;
+      } else {
+        return Http::Code::ServiceUnavailable;
+      }
+    }
+    // In the general case, consider the service unhealthy if fewer than the
+    // specified percentage of the servers in the cluster are available (healthy + degraded).
+    // TODO(brian-pane) switch to purely integer-based math here, because the
+    //                  int-to-float conversions and floating point division are slow.
+    if ((stats.membership_healthy_.value() + stats.membership_degraded_.value()) <
+        membership_total * min_healthy_percentage / 100.0) {
+      return Http::Code::ServiceUnavailable;
+    }
+  }
+  return Http::Code::OK;
+}
+
+ClusterHealthCacheManager::ClusterHealthCacheManager(
+    Upstream::ClusterManager& cluster_manager, ThreadLocal::SlotAllocator& tls,
+    ClusterMinHealthyPercentagesConstSharedPtr percentages)
+    : cluster_manager_(cluster_manager), percentages_(std::move(percentages)),
+      tls_(tls.allocateSlot()), code_(clusterHealthResponseCode(cluster_manager_, *percentages_)) {
+  const Http::Code code = code_;
+  tls_->set([code](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalResponse>(code);
+  });
+
+  for (const auto& item : *percentages_) {
+    Upstream::ThreadLocalCluster* cluster = cluster_manager_.get(item.first);
+    if (cluster != nullptr) {
+      watchCluster(*cluster);
+    }
+  }
+  cluster_update_callbacks_handle_ = cluster_manager_.addThreadLocalClusterUpdateCallbacks(*this);
+}
+
+ClusterHealthCacheManager::~ClusterHealthCacheManager() {
+  for (const auto& priority_update_cb : priority_update_cbs_) {
+    priority_update_cb.second->remove();
+  }
+}
+
+void ClusterHealthCacheManager::onClusterAddOrUpdate(Upstream::ThreadLocalCluster& cluster) {
+  if (percentages_->count(cluster.info()->name()) == 0) {
+    return;
+  }
+  // The callback of an updated cluster was owned by the priority set that it replaces.
+  watchCluster(cluster);
+  updateCachedResponse();
+}
+
+void ClusterHealthCacheManager::onClusterRemoval(const std::string& cluster_name) {
+  if (priority_update_cbs_.erase(cluster_name) > 0) {
+    updateCachedResponse();
+  }
+}
+
+void ClusterHealthCacheManager::watchCluster(Upstream::ThreadLocalCluster& cluster) {
+  priority_update_cbs_[cluster.info()->name()] = cluster.prioritySet().addPriorityUpdateCb(
+      [this](uint32_t, const Upstream::HostVector&, const Upstream::HostVector&) -> void {
+        updateCachedResponse();
+      });
+}
+
+void ClusterHealthCacheManager::updateCachedResponse() {
+  const Http::Code code = clusterHealthResponseCode(cluster_manager_, *percentages_);
+  if (code == code_) {
+    return;
+  }
+  code_ = code;
+  tls_->runOnAllThreads(
+      [this, code]() -> void { tls_->getTyped<ThreadLocalResponse>().code_ = code; });
+}
+
 Http::FilterHeadersStatus HealthCheckFilter::decodeHeaders(Http::HeaderMap& headers,
                                                            bool end_stream) {
   if (Http::HeaderUtility::matchHeaders(headers, *header_match_data_)) {
@@ -106,41 +196,13 @@ void HealthCheckFilter::onComplete() {
       const auto status_and_degraded = cache_manager_->getCachedResponse();
       final_status = status_and_degraded.first;
       degraded = status_and_degraded.second;
+    } else if (cluster_health_cache_manager_) {
+      final_status = cluster_health_cache_manager_->getCachedResponse();
     } else if (cluster_min_healthy_percentages_ != nullptr &&
                !cluster_min_healthy_percentages_->empty()) {
       // Check the status of the specified upstream cluster(s) to determine the right response.
-      auto& clusterManager = context_.clusterManager();
-      for (const auto& item : *cluster_min_healthy_percentages_) {
-        const std::string& cluster_name = item.first;
-        const double min_healthy_percentage = item.second;
-        auto* cluster = clusterManager.get(cluster_name);
-        if (cluster == nullptr) {
-          // If the cluster does not exist at all, consider the service unhealthy.
-          final_status = Http::Code::ServiceUnavailable;
-          break;
-        }
-        const auto& stats = cluster->info()->stats();
-        const uint64_t membership_total = stats.membership_total_.value();
-        if (membership_total == 0) {
-          // If the cluster exists but is empty, consider the service unhealthy unless
-          // the specified minimum percent healthy for the cluster happens to be zero.
-          if (min_healthy_percentage == 0.0) {
-            continue;
-          } else {
-            final_status = Http::Code::ServiceUnavailable;
-            break;
-          }
-        }
-        // In the general case, consider the service unhealthy if fewer than the
-        // specified percentage of the servers in the cluster are available (healthy + degraded).
-        // TODO(brian-pane) switch to purely integer-based math here, because the
-        //                  int-to-float conversions and floating point division are slow.
-        if ((stats.membership_healthy_.value() + stats.membership_degraded_.value()) <
-            membership_total * min_healthy_percentage / 100.0) {
-          final_status = Http::Code::ServiceUnavailable;
-          break;
-        }
-      }
+      final_status =
+          clusterHealthResponseCode(context_.clusterManager(), *cluster_min_healthy_percentages_);
     }
 
     if (!Http::CodeUtility::is2xx(enumToInt(final_status))) {
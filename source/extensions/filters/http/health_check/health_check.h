@@ -4,10 +4,14 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
+#include "envoy/common/callback.h"
 #include "envoy/http/codes.h"
 #include "envoy/http/filter.h"
 #include "envoy/server/filter_config.h"
+#include "envoy/thread_local/thread_local.h"
+#include "envoy/upstream/cluster_manager.h"
 
 #include "common/http/header_utility.h"
 
@@ -53,6 +57,57 @@ typedef std::map<std::string, double> ClusterMinHealthyPercentages;
 typedef std::shared_ptr<const ClusterMinHealthyPercentages>
     ClusterMinHealthyPercentagesConstSharedPtr;
 
+/**
+ * @return the response code of a health check given the minimum healthy percentages of upstream
+ *         clusters: a 503 if any of the clusters is missing or has too few healthy and degraded
+ *         hosts, and a 200 otherwise.
+ */
+Http::Code clusterHealthResponseCode(Upstream::ClusterManager& cluster_manager,
+                                     const ClusterMinHealthyPercentages& percentages);
+
+/**
+ * Cache manager of the health check responses derived from the health of upstream clusters. The
+ * response code is recalculated on the main thread when the hosts of the clusters are updated,
+ * and copied to each worker, so that the health check requests neither read the cluster stats
+ * nor share any state across threads.
+ */
+class ClusterHealthCacheManager : public Upstream::ClusterUpdateCallbacks {
+public:
+  ClusterHealthCacheManager(Upstream::ClusterManager& cluster_manager,
+                            ThreadLocal::SlotAllocator& tls,
+                            ClusterMinHealthyPercentagesConstSharedPtr percentages);
+  ~ClusterHealthCacheManager();
+
+  /**
+   * @return Http::Code the response code cached by the current thread.
+   */
+  Http::Code getCachedResponse() { return tls_->getTyped<ThreadLocalResponse>().code_; }
+
+  // Upstream::ClusterUpdateCallbacks
+  void onClusterAddOrUpdate(Upstream::ThreadLocalCluster& cluster) override;
+  void onClusterRemoval(const std::string& cluster_name) override;
+
+private:
+  struct ThreadLocalResponse : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalResponse(Http::Code code) : code_(code) {}
+
+    Http::Code code_;
+  };
+
+  void watchCluster(Upstream::ThreadLocalCluster& cluster);
+  void updateCachedResponse();
+
+  Upstream::ClusterManager& cluster_manager_;
+  const ClusterMinHealthyPercentagesConstSharedPtr percentages_;
+  ThreadLocal::SlotPtr tls_;
+  Http::Code code_;
+  // The host update callbacks of the watched clusters, which are owned by their priority sets.
+  std::unordered_map<std::string, Common::CallbackHandle*> priority_update_cbs_;
+  Upstream::ClusterUpdateCallbacksHandlePtr cluster_update_callbacks_handle_;
+};
+
+typedef std::shared_ptr<ClusterHealthCacheManager> ClusterHealthCacheManagerSharedPtr;
+
 typedef std::shared_ptr<std::vector<Http::HeaderUtility::HeaderData>> HeaderDataVectorSharedPtr;
 
 /**
@@ -63,10 +118,12 @@ public:
   HealthCheckFilter(Server::Configuration::FactoryContext& context, bool pass_through_mode,
                     HealthCheckCacheManagerSharedPtr cache_manager,
                     HeaderDataVectorSharedPtr header_match_data,
-                    ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages)
+                    ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages,
+                    ClusterHealthCacheManagerSharedPtr cluster_health_cache_manager)
       : context_(context), pass_through_mode_(pass_through_mode), cache_manager_(cache_manager),
         header_match_data_(std::move(header_match_data)),
-        cluster_min_healthy_percentages_(cluster_min_healthy_percentages) {}
+        cluster_min_healthy_percentages_(cluster_min_healthy_percentages),
+        cluster_health_cache_manager_(std::move(cluster_health_cache_manager)) {}
 
   // Http::StreamFilterBase
   void onDestroy() override {}
@@ -106,6 +163,7 @@ private:
   HealthCheckCacheManagerSharedPtr cache_manager_;
   const HeaderDataVectorSharedPtr header_match_data_;
   ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages_;
+  const ClusterHealthCacheManagerSharedPtr cluster_health_cache_manager_;
 };
 
 } // namespace HealthCheck
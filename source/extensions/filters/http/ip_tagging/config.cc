@@ -2,6 +2,7 @@
 
 #include "envoy/config/filter/http/ip_tagging/v2/ip_tagging.pb.validate.h"
 #include "envoy/registry/registry.h"
+#include "envoy/singleton/manager.h"
 
 #include "common/protobuf/utility.h"
 
@@ -12,14 +13,25 @@ namespace Extensions {
 namespace HttpFilters {
 namespace IpTagging {
 
+// Singleton registration via macro defined in envoy/singleton/manager.h
+SINGLETON_MANAGER_REGISTRATION(ip_tags_provider_manager);
+
 Http::FilterFactoryCb IpTaggingFilterFactory::createFilterFactoryFromProtoTyped(
     const envoy::config::filter::http::ip_tagging::v2::IPTagging& proto_config,
     const std::string& stat_prefix, Server::Configuration::FactoryContext& context) {
 
-  IpTaggingFilterConfigSharedPtr config(
-      new IpTaggingFilterConfig(proto_config, stat_prefix, context.scope(), context.runtime()));
-
-  return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+  IpTagsProviderManagerSharedPtr provider_manager =
+      context.singletonManager().getTyped<IpTagsProviderManager>(
+          SINGLETON_MANAGER_REGISTERED_NAME(ip_tags_provider_manager), [&context] {
+            return std::make_shared<IpTagsProviderManager>(context.dispatcher(),
+                                                           context.threadLocal(), context.api());
+          });
+  IpTaggingFilterConfigSharedPtr config(new IpTaggingFilterConfig(
+      proto_config, stat_prefix, context.scope(), context.runtime(), *provider_manager));
+
+  // The manager is kept alive by the filters, so that the filters that are created later share
+  // the providers of the existing ones.
+  return [config, provider_manager](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamDecoderFilter(std::make_shared<IpTaggingFilter>(config));
   };
 }
@@ -1,5 +1,7 @@
 #include "extensions/filters/http/ip_tagging/ip_tagging_filter.h"
 
+#include "envoy/common/exception.h"
+
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
 
@@ -10,6 +12,24 @@ namespace Extensions {
 namespace HttpFilters {
 namespace IpTagging {
 
+IpTaggingFilterConfig::IpTaggingFilterConfig(
+    const envoy::config::filter::http::ip_tagging::v2::IPTagging& config,
+    const std::string& stat_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
+    IpTagsProviderManager& provider_manager)
+    : request_type_(requestTypeEnum(config.request_type())), scope_(scope), runtime_(runtime),
+      stats_prefix_(stat_prefix + "ip_tagging.") {
+  if (config.ip_tags().empty() == config.ip_tags_path().empty()) {
+    throw EnvoyException(
+        "HTTP IP Tagging Filter requires either ip_tags or ip_tags_path to be specified.");
+  }
+
+  if (config.ip_tags_path().empty()) {
+    trie_ = IpTagsProvider::createTrie(config.ip_tags());
+  } else {
+    provider_ = provider_manager.getProvider(config.ip_tags_path());
+  }
+}
+
 IpTaggingFilter::IpTaggingFilter(IpTaggingFilterConfigSharedPtr config) : config_(config) {}
 
 IpTaggingFilter::~IpTaggingFilter() {}
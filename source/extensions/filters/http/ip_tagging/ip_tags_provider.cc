@@ -0,0 +1,132 @@
+#include "extensions/filters/http/ip_tagging/ip_tags_provider.h"
+
+#include <utility>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/network/cidr_range.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace IpTagging {
+
+IpTagsProvider::IpTagsProvider(const std::string& path, Event::Dispatcher& main_thread_dispatcher,
+                               ThreadLocal::SlotAllocator& tls, Api::Api& api)
+    : path_(path), main_thread_dispatcher_(main_thread_dispatcher), api_(api),
+      tls_(tls.allocateSlot()), watcher_(main_thread_dispatcher.createFilesystemWatcher()) {
+  IpTagTrieConstSharedPtr trie = loadTrie(path_, api_);
+  tls_->set([trie](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalTrie>(trie);
+  });
+  watcher_->addWatch(path_, Filesystem::Watcher::Events::MovedTo,
+                     [this](uint32_t) { onFileChanged(); });
+}
+
+IpTagsProvider::~IpTagsProvider() {
+  // A running build is waited for and its trie dropped, since its completion only holds a weak
+  // reference to the provider.
+  if (build_thread_ != nullptr) {
+    build_thread_->join();
+  }
+}
+
+const IpTagTrie& IpTagsProvider::trie() const { return *tls_->getTyped<ThreadLocalTrie>().trie_; }
+
+IpTagTrieConstSharedPtr IpTagsProvider::createTrie(
+    const Protobuf::RepeatedPtrField<envoy::config::filter::http::ip_tagging::v2::IPTagging::IPTag>&
+        ip_tags) {
+  std::vector<std::pair<std::string, std::vector<Network::Address::CidrRange>>> tag_data;
+  tag_data.reserve(ip_tags.size());
+  for (const auto& ip_tag : ip_tags) {
+    std::vector<Network::Address::CidrRange> cidr_set;
+    cidr_set.reserve(ip_tag.ip_list().size());
+    for (const envoy::api::v2::core::CidrRange& entry : ip_tag.ip_list()) {
+
+      // Currently, CidrRange::create doesn't guarantee that the CidrRanges are valid.
+      Network::Address::CidrRange cidr_entry = Network::Address::CidrRange::create(entry);
+      if (cidr_entry.isValid()) {
+        cidr_set.emplace_back(std::move(cidr_entry));
+      } else {
+        throw EnvoyException(
+            fmt::format("invalid ip/mask combo '{}/{}' (format is <ip>/<# mask bits>)",
+                        entry.address_prefix(), entry.prefix_len().value()));
+      }
+    }
+    tag_data.emplace_back(ip_tag.ip_tag_name(), std::move(cidr_set));
+  }
+  return std::make_shared<IpTagTrie>(tag_data);
+}
+
+IpTagTrieConstSharedPtr IpTagsProvider::loadTrie(const std::string& path, Api::Api& api) {
+  envoy::config::filter::http::ip_tagging::v2::IPTags ip_tags;
+  MessageUtil::loadFromFile(path, ip_tags, api);
+  return createTrie(ip_tags.ip_tags());
+}
+
+void IpTagsProvider::onFileChanged() {
+  if (build_thread_ != nullptr) {
+    reload_pending_ = true;
+    return;
+  }
+  startBuild();
+}
+
+void IpTagsProvider::startBuild() {
+  ASSERT(build_thread_ == nullptr);
+  std::weak_ptr<IpTagsProvider> weak_this = shared_from_this();
+  build_thread_ = api_.threadFactory().createThread([this, weak_this]() -> void {
+    IpTagTrieConstSharedPtr trie;
+    try {
+      trie = loadTrie(path_, api_);
+    } catch (const EnvoyException& e) {
+      ENVOY_LOG(warn, "failed to reload the IP tags of {}: {}", path_, e.what());
+    }
+    main_thread_dispatcher_.post([weak_this, trie]() -> void {
+      IpTagsProviderSharedPtr provider = weak_this.lock();
+      if (provider != nullptr) {
+        provider->onTrieBuilt(trie);
+      }
+    });
+  });
+}
+
+void IpTagsProvider::onTrieBuilt(IpTagTrieConstSharedPtr trie) {
+  build_thread_->join();
+  build_thread_.reset();
+
+  // A file that fails to load keeps the workers on the previous trie.
+  if (trie != nullptr) {
+    ENVOY_LOG(info, "reloaded the IP tags of {}", path_);
+    tls_->runOnAllThreads(
+        [this, trie]() -> void { tls_->getTyped<ThreadLocalTrie>().trie_ = trie; });
+  }
+
+  if (reload_pending_) {
+    reload_pending_ = false;
+    startBuild();
+  }
+}
+
+IpTagsProviderSharedPtr IpTagsProviderManager::getProvider(const std::string& path) {
+  auto it = providers_.find(path);
+  if (it != providers_.end()) {
+    IpTagsProviderSharedPtr provider = it->second.lock();
+    if (provider != nullptr) {
+      return provider;
+    }
+  }
+
+  IpTagsProviderSharedPtr provider =
+      std::make_shared<IpTagsProvider>(path, main_thread_dispatcher_, tls_, api_);
+  providers_[path] = provider;
+  return provider;
+}
+
+} // namespace IpTagging
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/api/api.h"
+#include "envoy/config/filter/http/ip_tagging/v2/ip_tagging.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/filesystem/watcher.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/thread/thread.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/logger.h"
+#include "common/network/lc_trie.h"
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace IpTagging {
+
+typedef Network::LcTrie::LcTrie<std::string> IpTagTrie;
+typedef std::shared_ptr<const IpTagTrie> IpTagTrieConstSharedPtr;
+
+/**
+ * Supplies the IP tags of a file to the workers. The trie of the tags is loaded when the provider
+ * is created, and rebuilt on a thread of its own whenever a new version of the file is moved into
+ * place, so that the main thread is not blocked by the build of a large trie. Once built, the new
+ * trie replaces the previous one on every worker, and the previous one is released once the last
+ * worker is done with it.
+ */
+class IpTagsProvider : public std::enable_shared_from_this<IpTagsProvider>,
+                       Logger::Loggable<Logger::Id::filter> {
+public:
+  /**
+   * @throw EnvoyException if the file cannot be loaded.
+   */
+  IpTagsProvider(const std::string& path, Event::Dispatcher& main_thread_dispatcher,
+                 ThreadLocal::SlotAllocator& tls, Api::Api& api);
+  ~IpTagsProvider();
+
+  /**
+   * @return const IpTagTrie& the trie of the current IP tags of the calling thread, which stays
+   *         valid until the thread returns to its event loop.
+   */
+  const IpTagTrie& trie() const;
+
+  /**
+   * Build the trie of a set of IP tags.
+   * @param ip_tags supplies the IP tags.
+   * @return IpTagTrieConstSharedPtr the trie.
+   * @throw EnvoyException if a CIDR range of the IP tags is invalid.
+   */
+  static IpTagTrieConstSharedPtr
+  createTrie(const Protobuf::RepeatedPtrField<
+             envoy::config::filter::http::ip_tagging::v2::IPTagging::IPTag>& ip_tags);
+
+private:
+  struct ThreadLocalTrie : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalTrie(IpTagTrieConstSharedPtr trie) : trie_(trie) {}
+
+    IpTagTrieConstSharedPtr trie_;
+  };
+
+  static IpTagTrieConstSharedPtr loadTrie(const std::string& path, Api::Api& api);
+  void onFileChanged();
+  void startBuild();
+  void onTrieBuilt(IpTagTrieConstSharedPtr trie);
+
+  const std::string path_;
+  Event::Dispatcher& main_thread_dispatcher_;
+  Api::Api& api_;
+  ThreadLocal::SlotPtr tls_;
+  Filesystem::WatcherPtr watcher_;
+  // Only a single build runs at a time. A change of the file during a build is picked up by
+  // another build once the running one completes.
+  Thread::ThreadPtr build_thread_;
+  bool reload_pending_{};
+};
+
+typedef std::shared_ptr<IpTagsProvider> IpTagsProviderSharedPtr;
+
+/**
+ * Singleton that owns the IP tags providers, so that the filters that load their IP tags from the
+ * same file share a single provider, and a single copy of its trie.
+ */
+class IpTagsProviderManager : public Singleton::Instance {
+public:
+  IpTagsProviderManager(Event::Dispatcher& main_thread_dispatcher, ThreadLocal::SlotAllocator& tls,
+                        Api::Api& api)
+      : main_thread_dispatcher_(main_thread_dispatcher), tls_(tls), api_(api) {}
+
+  /**
+   * @param path supplies the path of the file of the IP tags.
+   * @return IpTagsProviderSharedPtr the provider of the IP tags of the file, which is created if no
+   *         filter uses it yet.
+   * @throw EnvoyException if the file cannot be loaded.
+   */
+  IpTagsProviderSharedPtr getProvider(const std::string& path);
+
+private:
+  Event::Dispatcher& main_thread_dispatcher_;
+  ThreadLocal::SlotAllocator& tls_;
+  Api::Api& api_;
+  std::unordered_map<std::string, std::weak_ptr<IpTagsProvider>> providers_;
+};
+
+typedef std::shared_ptr<IpTagsProviderManager> IpTagsProviderManagerSharedPtr;
+
+} // namespace IpTagging
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
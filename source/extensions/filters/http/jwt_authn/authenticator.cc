@@ -31,9 +31,10 @@ class AuthenticatorImpl : public Logger::Loggable<Logger::Id::filter>,
 public:
   AuthenticatorImpl(const CheckAudience* check_audience,
                     const absl::optional<std::string>& provider, bool allow_failed,
-                    JwksCache& jwks_cache, Upstream::ClusterManager& cluster_manager,
+                    JwksCache& jwks_cache, TokenCache& token_cache,
+                    Upstream::ClusterManager& cluster_manager,
                     CreateJwksFetcherCb create_jwks_fetcher_cb, TimeSource& time_source)
-      : jwks_cache_(jwks_cache), cm_(cluster_manager),
+      : jwks_cache_(jwks_cache), token_cache_(token_cache), cm_(cluster_manager),
         create_jwks_fetcher_cb_(create_jwks_fetcher_cb), check_audience_(check_audience),
         provider_(provider), is_allow_failed_(allow_failed), time_source_(time_source) {}
 
@@ -60,6 +61,8 @@ private:
 
   // The jwks cache object.
   JwksCache& jwks_cache_;
+  // The cache of verified tokens.
+  TokenCache& token_cache_;
   // the cluster manager object.
   Upstream::ClusterManager& cm_;
 
@@ -73,9 +76,11 @@ private:
   std::vector<JwtLocationConstPtr> tokens_;
   JwtLocationConstPtr curr_token_;
   // The JWT object.
-  std::unique_ptr<::google::jwt_verify::Jwt> jwt_;
+  JwtConstSharedPtr jwt_;
   // The JWKS data object
   JwksCache::JwksData* jwks_data_{};
+  // The JWKS data object that verified the cached token, nullptr if it isn't cached.
+  const JwksCache::JwksData* verified_by_{};
 
   // The HTTP request headers
   Http::HeaderMap* headers_{};
@@ -112,11 +117,19 @@ void AuthenticatorImpl::startVerify() {
   ASSERT(!tokens_.empty());
   curr_token_ = std::move(tokens_.back());
   tokens_.pop_back();
-  jwt_ = std::make_unique<::google::jwt_verify::Jwt>();
-  const Status status = jwt_->parseFromString(curr_token_->token());
-  if (status != Status::Ok) {
-    doneWithStatus(status);
-    return;
+  const TokenCache::Entry* cached = token_cache_.lookup(curr_token_->token());
+  if (cached != nullptr) {
+    jwt_ = cached->jwt_;
+    verified_by_ = cached->jwks_data_;
+  } else {
+    auto jwt = std::make_shared<::google::jwt_verify::Jwt>();
+    const Status status = jwt->parseFromString(curr_token_->token());
+    if (status != Status::Ok) {
+      doneWithStatus(status);
+      return;
+    }
+    jwt_ = std::move(jwt);
+    verified_by_ = nullptr;
   }
 
   // Check if token extracted from the location contains the issuer specified by config.
@@ -192,6 +205,9 @@ void AuthenticatorImpl::startVerify() {
 }
 
 void AuthenticatorImpl::onJwksSuccess(google::jwt_verify::JwksPtr&& jwks) {
+  // The tokens verified by the previous keys must be verified again.
+  token_cache_.clear();
+  verified_by_ = nullptr;
   const Status status = jwks_data_->setRemoteJwks(std::move(jwks))->getStatus();
   if (status != Status::Ok) {
     doneWithStatus(status);
@@ -210,10 +226,14 @@ void AuthenticatorImpl::onDestroy() {
 
 // Verify with a specific public key.
 void AuthenticatorImpl::verifyKey() {
-  const Status status = ::google::jwt_verify::verifyJwt(*jwt_, *jwks_data_->getJwksObj());
-  if (status != Status::Ok) {
-    doneWithStatus(status);
-    return;
+  // A cached token was already verified if the same keys verified it.
+  if (verified_by_ != jwks_data_) {
+    const Status status = ::google::jwt_verify::verifyJwt(*jwt_, *jwks_data_->getJwksObj());
+    if (status != Status::Ok) {
+      doneWithStatus(status);
+      return;
+    }
+    token_cache_.insert(curr_token_->token(), jwt_, *jwks_data_);
   }
 
   // Forward the payload
@@ -253,11 +273,13 @@ void AuthenticatorImpl::doneWithStatus(const Status& status) {
 AuthenticatorPtr Authenticator::create(const CheckAudience* check_audience,
                                        const absl::optional<std::string>& provider,
                                        bool allow_failed, JwksCache& jwks_cache,
+                                       TokenCache& token_cache,
                                        Upstream::ClusterManager& cluster_manager,
                                        CreateJwksFetcherCb create_jwks_fetcher_cb,
                                        TimeSource& time_source) {
   return std::make_unique<AuthenticatorImpl>(check_audience, provider, allow_failed, jwks_cache,
-                                             cluster_manager, create_jwks_fetcher_cb, time_source);
+                                             token_cache, cluster_manager, create_jwks_fetcher_cb,
+                                             time_source);
 }
 
 } // namespace JwtAuthn
@@ -7,6 +7,7 @@
 #include "envoy/thread_local/thread_local.h"
 
 #include "extensions/filters/http/jwt_authn/matcher.h"
+#include "extensions/filters/http/jwt_authn/token_cache.h"
 #include "extensions/filters/http/jwt_authn/verifier.h"
 
 namespace Envoy {
@@ -16,8 +17,7 @@ namespace JwtAuthn {
 
 /**
  * Making cache as a thread local object, its read/write operations don't need to be protected.
- * Now it only has jwks_cache, but in the future, it will have token cache: to cache the tokens
- * with their verification results.
+ * It has the jwks_cache, and the token_cache to cache the tokens with their verification results.
  */
 class ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
 public:
@@ -26,14 +26,20 @@ public:
       const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config,
       TimeSource& time_source, Api::Api& api) {
     jwks_cache_ = JwksCache::create(config, time_source, api);
+    token_cache_ = TokenCache::create(config);
   }
 
   // Get the JwksCache object.
   JwksCache& getJwksCache() { return *jwks_cache_; }
 
+  // Get the TokenCache object.
+  TokenCache& getTokenCache() { return *token_cache_; }
+
 private:
   // The JwksCache object.
   JwksCachePtr jwks_cache_;
+  // The TokenCache object.
+  TokenCachePtr token_cache_;
 };
 
 /**
@@ -111,7 +117,8 @@ public:
                           const absl::optional<std::string>& provider,
                           bool allow_failed) const override {
     return Authenticator::create(check_audience, provider, allow_failed, getCache().getJwksCache(),
-                                 cm(), Common::JwksFetcher::create, timeSource());
+                                 getCache().getTokenCache(), cm(), Common::JwksFetcher::create,
+                                 timeSource());
   }
 
 private:
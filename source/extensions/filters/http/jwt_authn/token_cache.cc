@@ -0,0 +1,86 @@
+#include "extensions/filters/http/jwt_authn/token_cache.h"
+
+#include <list>
+#include <unordered_map>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/crypto/utility.h"
+#include "common/protobuf/utility.h"
+
+using ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+namespace {
+
+class TokenCacheImpl : public TokenCache {
+public:
+  TokenCacheImpl(uint32_t max_size) : max_size_(max_size) {}
+
+  const Entry* lookup(const std::string& token) override {
+    if (max_size_ == 0) {
+      return nullptr;
+    }
+    const auto it = index_.find(digest(token));
+    if (it == index_.end()) {
+      return nullptr;
+    }
+    tokens_.splice(tokens_.begin(), tokens_, it->second);
+    return &it->second->entry_;
+  }
+
+  void insert(const std::string& token, JwtConstSharedPtr jwt,
+              const JwksCache::JwksData& jwks_data) override {
+    if (max_size_ == 0) {
+      return;
+    }
+    std::string key = digest(token);
+    const auto it = index_.find(key);
+    if (it != index_.end()) {
+      tokens_.erase(it->second);
+      index_.erase(it);
+    } else if (tokens_.size() >= max_size_) {
+      index_.erase(tokens_.back().key_);
+      tokens_.pop_back();
+    }
+    tokens_.push_front({key, {std::move(jwt), &jwks_data}});
+    index_.emplace(std::move(key), tokens_.begin());
+  }
+
+  void clear() override {
+    index_.clear();
+    tokens_.clear();
+  }
+
+private:
+  struct Token {
+    std::string key_;
+    Entry entry_;
+  };
+
+  // The tokens are keyed by their digests, so that the size of the keys doesn't depend on them.
+  static std::string digest(const std::string& token) {
+    Buffer::OwnedImpl buffer(token);
+    const std::vector<uint8_t> digest = Envoy::Common::Crypto::Utility::getSha256Digest(buffer);
+    return std::string(digest.begin(), digest.end());
+  }
+
+  const uint32_t max_size_;
+  // Most recently used first.
+  std::list<Token> tokens_;
+  std::unordered_map<std::string, std::list<Token>::iterator> index_;
+};
+
+} // namespace
+
+TokenCachePtr TokenCache::create(const JwtAuthentication& config) {
+  return std::make_unique<TokenCacheImpl>(
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, jwt_cache_size, 0));
+}
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/common/pure.h"
+#include "envoy/config/filter/http/jwt_authn/v2alpha/config.pb.h"
+
+#include "extensions/filters/http/jwt_authn/jwks_cache.h"
+
+#include "jwt_verify_lib/jwt.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+class TokenCache;
+typedef std::unique_ptr<TokenCache> TokenCachePtr;
+
+typedef std::shared_ptr<const ::google::jwt_verify::Jwt> JwtConstSharedPtr;
+
+/**
+ * Interface to cache the verified JWTs of a worker, so that repeated tokens skip their parsing and
+ * signature verification. The cache is bounded, evicting the least recently used tokens.
+ * Its usage:
+ *     auto entry = token_cache->lookup(token);
+ *     if (entry == nullptr || entry->jwks_data_ != jwks_data) {
+ *        verifyJwt(jwt, jwks_data->getJwksObj());
+ *        token_cache->insert(token, jwt, *jwks_data);
+ *     }
+ *
+ *     // When a Jwks is fetched again.
+ *     token_cache->clear();
+ */
+class TokenCache {
+public:
+  virtual ~TokenCache() {}
+
+  // A parsed JWT and the Jwks data object whose keys verified its signature.
+  struct Entry {
+    JwtConstSharedPtr jwt_;
+    const JwksCache::JwksData* jwks_data_;
+  };
+
+  // Lookup the entry of a token, nullptr if it isn't cached. The entry is only valid until the
+  // next insert() or clear().
+  virtual const Entry* lookup(const std::string& token) PURE;
+
+  // Cache a token whose signature the keys of a Jwks data object verified.
+  virtual void insert(const std::string& token, JwtConstSharedPtr jwt,
+                      const JwksCache::JwksData& jwks_data) PURE;
+
+  // Remove all the tokens. Called when a Jwks changes, so that no token stays verified by keys
+  // that may have been revoked.
+  virtual void clear() PURE;
+
+  // Factory function to create an instance.
+  static TokenCachePtr
+  create(const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config);
+};
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -13,10 +13,11 @@ namespace HttpFilters {
 namespace Lua {
 
 Http::FilterFactoryCb LuaFilterConfig::createFilterFactoryFromProtoTyped(
-    const envoy::config::filter::http::lua::v2::Lua& proto_config, const std::string&,
-    Server::Configuration::FactoryContext& context) {
+    const envoy::config::filter::http::lua::v2::Lua& proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
   FilterConfigConstSharedPtr filter_config(new FilterConfig{
-      proto_config.inline_code(), context.threadLocal(), context.clusterManager()});
+      proto_config, context.threadLocal(), context.clusterManager(), stats_prefix,
+      context.scope()});
   return [filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(std::make_shared<Filter>(filter_config));
   };
@@ -8,6 +8,7 @@
 #include "common/common/assert.h"
 #include "common/common/enum_to_int.h"
 #include "common/http/message_impl.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -28,7 +29,8 @@ Http::FilterHeadersStatus StreamHandleWrapper::start(int function_ref) {
   // We are on the top of the stack.
   coroutine_.start(function_ref, 1, yield_callback_);
   Http::FilterHeadersStatus status =
-      (state_ == State::WaitForBody || state_ == State::HttpCall || state_ == State::Responded)
+      (state_ == State::WaitForBody || state_ == State::WaitForBodyPrefix ||
+       state_ == State::HttpCall || state_ == State::Responded)
           ? Http::FilterHeadersStatus::StopIteration
           : Http::FilterHeadersStatus::Continue;
 
@@ -55,13 +57,23 @@ Http::FilterDataStatus StreamHandleWrapper::onData(Buffer::Instance& data, bool
     callbacks_.addData(data);
     state_ = State::Running;
     coroutine_.resume(luaBody(coroutine_.luaState()), yield_callback_);
+  } else if (state_ == State::WaitForBodyPrefix) {
+    const Buffer::Instance* buffered_body = callbacks_.bufferedBody();
+    const uint64_t received =
+        (buffered_body != nullptr ? buffered_body->length() : 0) + data.length();
+    if (end_stream_ || received >= body_prefix_length_) {
+      ENVOY_LOG(debug, "resuming body prefix");
+      callbacks_.addData(data);
+      resumeBodyPrefix();
+    }
   } else if (state_ == State::WaitForTrailers && end_stream_) {
     ENVOY_LOG(debug, "resuming nil trailers due to end stream");
     state_ = State::Running;
     coroutine_.resume(0, yield_callback_);
   }
 
-  if (state_ == State::HttpCall || state_ == State::WaitForBody) {
+  if (state_ == State::HttpCall || state_ == State::WaitForBody ||
+      state_ == State::WaitForBodyPrefix) {
     ENVOY_LOG(trace, "buffering body");
     return Http::FilterDataStatus::StopIterationAndBuffer;
   } else if (state_ == State::Responded) {
@@ -85,6 +97,9 @@ Http::FilterTrailersStatus StreamHandleWrapper::onTrailers(Http::HeaderMap& trai
     ENVOY_LOG(debug, "resuming body due to trailers");
     state_ = State::Running;
     coroutine_.resume(luaBody(coroutine_.luaState()), yield_callback_);
+  } else if (state_ == State::WaitForBodyPrefix) {
+    ENVOY_LOG(debug, "resuming body prefix due to trailers");
+    resumeBodyPrefix();
   }
 
   if (state_ == State::WaitForTrailers) {
@@ -290,17 +305,8 @@ int StreamHandleWrapper::luaBody(lua_State* state) {
   if (end_stream_) {
     if (!buffered_body_ && saw_body_) {
       return luaL_error(state, "cannot call body() after body has been streamed");
-    } else if (callbacks_.bufferedBody() == nullptr) {
-      ENVOY_LOG(debug, "end stream. no body");
-      return 0;
     } else {
-      if (body_wrapper_.get() != nullptr) {
-        body_wrapper_.pushStack();
-      } else {
-        body_wrapper_.reset(
-            Filters::Common::Lua::BufferWrapper::create(state, *callbacks_.bufferedBody()), true);
-      }
-      return 1;
+      return pushBufferedBody(state);
     }
   } else if (saw_body_) {
     return luaL_error(state, "cannot call body() after body streaming has started");
@@ -312,6 +318,52 @@ int StreamHandleWrapper::luaBody(lua_State* state) {
   }
 }
 
+int StreamHandleWrapper::luaBodyPrefix(lua_State* state) {
+  ASSERT(state_ == State::Running);
+
+  const int length = luaL_checkint(state, 2);
+  if (length <= 0) {
+    return luaL_error(state, "length must be > 0");
+  }
+
+  if (end_stream_) {
+    if (!buffered_body_ && saw_body_) {
+      return luaL_error(state, "cannot call bodyPrefix() after body has been streamed");
+    }
+    return pushBufferedBody(state);
+  } else if (saw_body_) {
+    return luaL_error(state, "cannot call bodyPrefix() after body streaming has started");
+  } else {
+    ENVOY_LOG(debug, "yielding for body prefix");
+    state_ = State::WaitForBodyPrefix;
+    body_prefix_length_ = length;
+    buffered_body_ = true;
+    return lua_yield(state, 0);
+  }
+}
+
+void StreamHandleWrapper::resumeBodyPrefix() {
+  // The rest of the body is streamed after the prefix.
+  buffered_body_ = false;
+  state_ = State::Running;
+  coroutine_.resume(pushBufferedBody(coroutine_.luaState()), yield_callback_);
+}
+
+int StreamHandleWrapper::pushBufferedBody(lua_State* state) {
+  if (callbacks_.bufferedBody() == nullptr) {
+    ENVOY_LOG(debug, "no body");
+    return 0;
+  }
+
+  if (body_wrapper_.get() != nullptr) {
+    body_wrapper_.pushStack();
+  } else {
+    body_wrapper_.reset(
+        Filters::Common::Lua::BufferWrapper::create(state, *callbacks_.bufferedBody()), true);
+  }
+  return 1;
+}
+
 int StreamHandleWrapper::luaBodyChunks(lua_State* state) {
   ASSERT(state_ == State::Running);
 
@@ -426,9 +478,15 @@ int StreamHandleWrapper::luaLogCritical(lua_State* state) {
   return 0;
 }
 
-FilterConfig::FilterConfig(const std::string& lua_code, ThreadLocal::SlotAllocator& tls,
-                           Upstream::ClusterManager& cluster_manager)
-    : cluster_manager_(cluster_manager), lua_state_(lua_code, tls) {
+FilterConfig::FilterConfig(const envoy::config::filter::http::lua::v2::Lua& proto_config,
+                           ThreadLocal::SlotAllocator& tls,
+                           Upstream::ClusterManager& cluster_manager,
+                           const std::string& stats_prefix, Stats::Scope& scope)
+    : cluster_manager_(cluster_manager),
+      lua_state_(proto_config.inline_code(), tls,
+                 PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, gc_step_kb, 0)),
+      max_memory_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, max_memory_bytes, 0)),
+      stats_{ALL_LUA_FILTER_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix + "lua."))} {
   lua_state_.registerType<Filters::Common::Lua::BufferWrapper>();
   lua_state_.registerType<Filters::Common::Lua::MetadataMapWrapper>();
   lua_state_.registerType<Filters::Common::Lua::MetadataMapIterator>();
@@ -452,6 +510,19 @@ FilterConfig::FilterConfig(const std::string& lua_code, ThreadLocal::SlotAllocat
   }
 }
 
+bool FilterConfig::checkMemoryLimit() {
+  if (max_memory_bytes_ == 0 || lua_state_.runtimeBytesUsed() <= max_memory_bytes_) {
+    return true;
+  }
+  stats_.memory_limit_gc_.inc();
+  lua_state_.runtimeGC();
+  if (lua_state_.runtimeBytesUsed() <= max_memory_bytes_) {
+    return true;
+  }
+  stats_.memory_limit_exceeded_.inc();
+  return false;
+}
+
 void Filter::onDestroy() {
   destroyed_ = true;
   if (request_stream_wrapper_.get()) {
@@ -460,6 +531,8 @@ void Filter::onDestroy() {
   if (response_stream_wrapper_.get()) {
     response_stream_wrapper_.get()->onReset();
   }
+  // The garbage of the stream is collected after it ends, instead of while other scripts run.
+  config_->scheduleGCStep();
 }
 
 Http::FilterHeadersStatus Filter::doHeaders(StreamHandleRef& handle,
@@ -469,6 +542,10 @@ Http::FilterHeadersStatus Filter::doHeaders(StreamHandleRef& handle,
   if (function_ref == LUA_REFNIL) {
     return Http::FilterHeadersStatus::Continue;
   }
+  if (!config_->checkMemoryLimit()) {
+    scriptLog(spdlog::level::err, "script not run: memory limit exceeded");
+    return Http::FilterHeadersStatus::Continue;
+  }
 
   coroutine = config_->createCoroutine();
   handle.reset(StreamHandleWrapper::create(coroutine->luaState(), *coroutine, headers, end_stream,
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "envoy/config/filter/http/lua/v2/lua.pb.h"
 #include "envoy/http/filter.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "extensions/filters/common/lua/wrappers.h"
@@ -104,6 +107,8 @@ public:
     WaitForBodyChunk,
     // Lua script is blocked waiting for the full body.
     WaitForBody,
+    // Lua script is blocked waiting for a prefix of the body.
+    WaitForBodyPrefix,
     // Lua script is blocked waiting for trailers.
     WaitForTrailers,
     // Lua script is blocked waiting for the result of an HTTP call.
@@ -127,14 +132,14 @@ public:
   }
 
   static ExportedFunctions exportedFunctions() {
-    return {{"headers", static_luaHeaders},         {"body", static_luaBody},
-            {"bodyChunks", static_luaBodyChunks},   {"trailers", static_luaTrailers},
-            {"metadata", static_luaMetadata},       {"logTrace", static_luaLogTrace},
-            {"logDebug", static_luaLogDebug},       {"logInfo", static_luaLogInfo},
-            {"logWarn", static_luaLogWarn},         {"logErr", static_luaLogErr},
-            {"logCritical", static_luaLogCritical}, {"httpCall", static_luaHttpCall},
-            {"respond", static_luaRespond},         {"streamInfo", static_luaStreamInfo},
-            {"connection", static_luaConnection}};
+    return {{"headers", static_luaHeaders},       {"body", static_luaBody},
+            {"bodyChunks", static_luaBodyChunks}, {"bodyPrefix", static_luaBodyPrefix},
+            {"trailers", static_luaTrailers},     {"metadata", static_luaMetadata},
+            {"logTrace", static_luaLogTrace},     {"logDebug", static_luaLogDebug},
+            {"logInfo", static_luaLogInfo},       {"logWarn", static_luaLogWarn},
+            {"logErr", static_luaLogErr},         {"logCritical", static_luaLogCritical},
+            {"httpCall", static_luaHttpCall},     {"respond", static_luaRespond},
+            {"streamInfo", static_luaStreamInfo}, {"connection", static_luaConnection}};
   }
 
 private:
@@ -177,6 +182,17 @@ private:
    */
   DECLARE_LUA_FUNCTION(StreamHandleWrapper, luaBodyChunks);
 
+  /**
+   * @param 1 (int) the length of the prefix.
+   * @return a handle to the body received so far or nil if there is no body. This call will cause
+   *         the script to yield until at least the given length of the body is received, or until
+   *         the end of the stream if it is shorter.
+   *         NOTE: This call causes Envoy to buffer the body only until the prefix is received,
+   *         along with the rest of the frame completing it. The body is then streamed, so that
+   *         body() and bodyChunks() can't be called afterwards.
+   */
+  DECLARE_LUA_FUNCTION(StreamHandleWrapper, luaBodyPrefix);
+
   /**
    * @return a handle to the trailers or nil if there are no trailers. This call will cause the
    *         script to yield if Envoy does not yet know if there are trailers or not.
@@ -214,6 +230,17 @@ private:
    */
   DECLARE_LUA_CLOSURE(StreamHandleWrapper, luaBodyIterator);
 
+  /**
+   * Push a handle to the buffered body onto the stack.
+   * @return int 1 if there is a buffered body, 0 otherwise.
+   */
+  int pushBufferedBody(lua_State* state);
+
+  /**
+   * Resume the script blocked in bodyPrefix() with the buffered body.
+   */
+  void resumeBodyPrefix();
+
   static Http::HeaderMapPtr buildHeadersFromTable(lua_State* state, int table_index);
 
   // Filters::Common::Lua::BaseLuaObject
@@ -248,22 +275,48 @@ private:
   Filters::Common::Lua::LuaDeathRef<StreamInfoWrapper> stream_info_wrapper_;
   Filters::Common::Lua::LuaDeathRef<Filters::Common::Lua::ConnectionWrapper> connection_wrapper_;
   State state_{State::Running};
+  uint64_t body_prefix_length_{};
   std::function<void()> yield_callback_;
   Http::AsyncClient::Request* http_request_{};
 };
 
+/**
+ * All Lua filter stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_LUA_FILTER_STATS(COUNTER)                                                              \
+  COUNTER(memory_limit_gc)                                                                         \
+  COUNTER(memory_limit_exceeded)
+// clang-format on
+
+/**
+ * Struct definition for all Lua filter stats. @see stats_macros.h
+ */
+struct LuaFilterStats {
+  ALL_LUA_FILTER_STATS(GENERATE_COUNTER_STRUCT)
+};
+
 /**
  * Global configuration for the filter.
  */
 class FilterConfig : Logger::Loggable<Logger::Id::lua> {
 public:
-  FilterConfig(const std::string& lua_code, ThreadLocal::SlotAllocator& tls,
-               Upstream::ClusterManager& cluster_manager);
+  FilterConfig(const envoy::config::filter::http::lua::v2::Lua& proto_config,
+               ThreadLocal::SlotAllocator& tls, Upstream::ClusterManager& cluster_manager,
+               const std::string& stats_prefix, Stats::Scope& scope);
   Filters::Common::Lua::CoroutinePtr createCoroutine() { return lua_state_.createCoroutine(); }
   int requestFunctionRef() { return lua_state_.getGlobalRef(request_function_slot_); }
   int responseFunctionRef() { return lua_state_.getGlobalRef(response_function_slot_); }
   uint64_t runtimeBytesUsed() { return lua_state_.runtimeBytesUsed(); }
   void runtimeGC() { return lua_state_.runtimeGC(); }
+  void scheduleGCStep() { lua_state_.scheduleGCStep(); }
+
+  /**
+   * Check the memory used by the Lua state of this worker before a script starts. A full GC runs
+   * if the state uses more memory than the limit.
+   * @return bool whether the state uses less memory than the limit, or there is no limit.
+   */
+  bool checkMemoryLimit();
 
   Upstream::ClusterManager& cluster_manager_;
 
@@ -271,12 +324,12 @@ private:
   Filters::Common::Lua::ThreadLocalState lua_state_;
   uint64_t request_function_slot_;
   uint64_t response_function_slot_;
+  const uint64_t max_memory_bytes_;
+  LuaFilterStats stats_;
 };
 
 typedef std::shared_ptr<FilterConfig> FilterConfigConstSharedPtr;
 
-// TODO(mattklein123): Filter stats.
-
 /**
  * The HTTP Lua filter. Allows scripts to run in both the request an response flow.
  */
@@ -0,0 +1,32 @@
+#include "extensions/filters/http/on_demand_cluster/config.h"
+
+#include "envoy/config/filter/http/on_demand_cluster/v2/on_demand_cluster.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/filters/http/on_demand_cluster/on_demand_cluster_filter.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace OnDemandCluster {
+
+Http::FilterFactoryCb OnDemandClusterFilterFactory::createFilterFactoryFromProtoTyped(
+    const envoy::config::filter::http::on_demand_cluster::v2::OnDemandCluster& proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
+  OnDemandClusterFilterConfigSharedPtr config = std::make_shared<OnDemandClusterFilterConfig>(
+      proto_config, stats_prefix, context.scope(), context.clusterManager());
+  return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamDecoderFilter(std::make_shared<OnDemandClusterFilter>(config));
+  };
+}
+
+/**
+ * Static registration for the on-demand cluster filter. @see NamedHttpFilterConfigFactory.
+ */
+REGISTER_FACTORY(OnDemandClusterFilterFactory,
+                 Server::Configuration::NamedHttpFilterConfigFactory);
+
+} // namespace OnDemandCluster
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
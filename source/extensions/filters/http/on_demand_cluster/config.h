@@ -0,0 +1,32 @@
+#pragma once
+
+#include "envoy/config/filter/http/on_demand_cluster/v2/on_demand_cluster.pb.h"
+#include "envoy/config/filter/http/on_demand_cluster/v2/on_demand_cluster.pb.validate.h"
+
+#include "extensions/filters/http/common/factory_base.h"
+#include "extensions/filters/http/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace OnDemandCluster {
+
+/**
+ * Config registration for the on-demand cluster filter. @see NamedHttpFilterConfigFactory.
+ */
+class OnDemandClusterFilterFactory
+    : public Common::FactoryBase<
+          envoy::config::filter::http::on_demand_cluster::v2::OnDemandCluster> {
+public:
+  OnDemandClusterFilterFactory() : FactoryBase(HttpFilterNames::get().OnDemandCluster) {}
+
+private:
+  Http::FilterFactoryCb createFilterFactoryFromProtoTyped(
+      const envoy::config::filter::http::on_demand_cluster::v2::OnDemandCluster& proto_config,
+      const std::string& stats_prefix, Server::Configuration::FactoryContext& context) override;
+};
+
+} // namespace OnDemandCluster
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,80 @@
+#include "extensions/filters/http/on_demand_cluster/on_demand_cluster_filter.h"
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/router/router.h"
+
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace OnDemandCluster {
+
+OnDemandClusterFilterConfig::OnDemandClusterFilterConfig(
+    const envoy::config::filter::http::on_demand_cluster::v2::OnDemandCluster& proto_config,
+    const std::string& stats_prefix, Stats::Scope& scope, Upstream::ClusterManager& cm)
+    : cm_(cm), timeout_(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, timeout, 5000)),
+      stats_(generateStats(stats_prefix + "on_demand_cluster.", scope)) {}
+
+Http::FilterHeadersStatus OnDemandClusterFilter::decodeHeaders(Http::HeaderMap&, bool) {
+  Router::RouteConstSharedPtr route = callbacks_->route();
+  if (route == nullptr || route->routeEntry() == nullptr) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  const std::string& cluster_name = route->routeEntry()->clusterName();
+  if (config_->clusterManager().get(cluster_name) != nullptr) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  handle_ = config_->clusterManager().requestOnDemandCluster(
+      cluster_name, callbacks_->dispatcher(),
+      [this](bool available) -> void { onClusterAvailable(available); });
+  if (handle_ == nullptr) {
+    // Not an on-demand cluster, the router responds as for any unknown cluster.
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  config_->stats().rq_held_.inc();
+  timeout_timer_ = callbacks_->dispatcher().createTimer([this]() -> void { onTimeout(); });
+  timeout_timer_->enableTimer(config_->timeout());
+  return Http::FilterHeadersStatus::StopIteration;
+}
+
+Http::FilterDataStatus OnDemandClusterFilter::decodeData(Buffer::Instance&, bool) {
+  return handle_ == nullptr ? Http::FilterDataStatus::Continue
+                            : Http::FilterDataStatus::StopIterationAndWatermark;
+}
+
+Http::FilterTrailersStatus OnDemandClusterFilter::decodeTrailers(Http::HeaderMap&) {
+  return handle_ == nullptr ? Http::FilterTrailersStatus::Continue
+                            : Http::FilterTrailersStatus::StopIteration;
+}
+
+void OnDemandClusterFilter::onDestroy() {
+  handle_.reset();
+  timeout_timer_.reset();
+}
+
+void OnDemandClusterFilter::onClusterAvailable(bool available) {
+  if (!available) {
+    config_->stats().rq_unavailable_.inc();
+  }
+  resume();
+}
+
+void OnDemandClusterFilter::onTimeout() {
+  config_->stats().rq_timeout_.inc();
+  resume();
+}
+
+void OnDemandClusterFilter::resume() {
+  // Dropping the handle cancels the callback if it is still pending.
+  handle_.reset();
+  timeout_timer_->disableTimer();
+  callbacks_->continueDecoding();
+}
+
+} // namespace OnDemandCluster
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
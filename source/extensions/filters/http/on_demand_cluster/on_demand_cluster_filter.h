@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "envoy/config/filter/http/on_demand_cluster/v2/on_demand_cluster.pb.h"
+#include "envoy/event/timer.h"
+#include "envoy/http/filter.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/upstream/cluster_manager.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace OnDemandCluster {
+
+/**
+ * All on-demand cluster filter stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_ON_DEMAND_CLUSTER_STATS(COUNTER)                                                       \
+  COUNTER(rq_held)                                                                                 \
+  COUNTER(rq_timeout)                                                                              \
+  COUNTER(rq_unavailable)
+// clang-format on
+
+/**
+ * Struct definition for on-demand cluster filter stats. @see stats_macros.h
+ */
+struct OnDemandClusterStats {
+  ALL_ON_DEMAND_CLUSTER_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration for the on-demand cluster filter.
+ */
+class OnDemandClusterFilterConfig {
+public:
+  OnDemandClusterFilterConfig(
+      const envoy::config::filter::http::on_demand_cluster::v2::OnDemandCluster& proto_config,
+      const std::string& stats_prefix, Stats::Scope& scope, Upstream::ClusterManager& cm);
+
+  Upstream::ClusterManager& clusterManager() { return cm_; }
+  const std::chrono::milliseconds& timeout() const { return timeout_; }
+  OnDemandClusterStats& stats() { return stats_; }
+
+private:
+  static OnDemandClusterStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return OnDemandClusterStats{ALL_ON_DEMAND_CLUSTER_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  Upstream::ClusterManager& cm_;
+  const std::chrono::milliseconds timeout_;
+  OnDemandClusterStats stats_;
+};
+
+typedef std::shared_ptr<OnDemandClusterFilterConfig> OnDemandClusterFilterConfigSharedPtr;
+
+/**
+ * A filter that holds requests routed to an on-demand cluster that is not instantiated yet, until
+ * the cluster manager has instantiated the cluster and it finished warming, or until the
+ * configured timeout.
+ */
+class OnDemandClusterFilter : public Http::StreamDecoderFilter {
+public:
+  OnDemandClusterFilter(OnDemandClusterFilterConfigSharedPtr config) : config_(config) {}
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap& trailers) override;
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override {
+    callbacks_ = &callbacks;
+  }
+
+private:
+  void onClusterAvailable(bool available);
+  void onTimeout();
+  void resume();
+
+  OnDemandClusterFilterConfigSharedPtr config_;
+  Http::StreamDecoderFilterCallbacks* callbacks_{};
+  // Set while the request is held.
+  Upstream::OnDemandClusterHandlePtr handle_;
+  Event::TimerPtr timeout_timer_;
+};
+
+} // namespace OnDemandCluster
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -9,6 +9,7 @@
 #include "common/config/filter_json.h"
 #include "common/protobuf/utility.h"
 
+#include "extensions/filters/common/ratelimit/local_ratelimit_impl.h"
 #include "extensions/filters/common/ratelimit/ratelimit_impl.h"
 #include "extensions/filters/http/ratelimit/ratelimit.h"
 
@@ -18,20 +19,44 @@ namespace HttpFilters {
 namespace RateLimitFilter {
 
 Http::FilterFactoryCb RateLimitFilterConfig::createFilterFactoryFromProtoTyped(
-    const envoy::config::filter::http::rate_limit::v2::RateLimit& proto_config, const std::string&,
-    Server::Configuration::FactoryContext& context) {
+    const envoy::config::filter::http::rate_limit::v2::RateLimit& proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
   ASSERT(!proto_config.domain().empty());
+  if (!proto_config.has_rate_limit_service() && !proto_config.has_local_rate_limit()) {
+    throw EnvoyException("rate limit filter: rate_limit_service or local_rate_limit must be set");
+  }
   FilterConfigSharedPtr filter_config(new FilterConfig(proto_config, context.localInfo(),
                                                        context.scope(), context.runtime(),
                                                        context.httpContext()));
   const std::chrono::milliseconds timeout =
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, timeout, 20));
+  Filters::Common::RateLimit::LocalRateLimiterSharedPtr local_limiter;
+  if (proto_config.has_local_rate_limit()) {
+    local_limiter = std::make_shared<Filters::Common::RateLimit::LocalRateLimiter>(
+        proto_config.local_rate_limit(), context.timeSource(), stats_prefix + "local_ratelimit.",
+        context.scope());
+  }
+  const Filters::Common::RateLimit::AggregatorSharedPtr aggregator =
+      Filters::Common::RateLimit::rateLimitAggregator(context, proto_config.rate_limit_service(),
+                                                      timeout,
+                                                      stats_prefix + "ratelimit_aggregation.");
 
-  return [proto_config, &context, timeout,
-          filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamFilter(std::make_shared<Filter>(
-        filter_config, Filters::Common::RateLimit::rateLimitClient(
-                           context, proto_config.rate_limit_service().grpc_service(), timeout)));
+  return [proto_config, &context, timeout, filter_config, local_limiter,
+          aggregator](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    Filters::Common::RateLimit::ClientPtr client;
+    if (proto_config.has_rate_limit_service()) {
+      client = Filters::Common::RateLimit::rateLimitClient(
+          context, proto_config.rate_limit_service().grpc_service(), timeout);
+    }
+    if (aggregator != nullptr) {
+      client = std::make_unique<Filters::Common::RateLimit::AggregatingClientImpl>(
+          aggregator, std::move(client));
+    }
+    if (local_limiter != nullptr) {
+      client = std::make_unique<Filters::Common::RateLimit::LocalClientImpl>(local_limiter,
+                                                                            std::move(client));
+    }
+    callbacks.addStreamFilter(std::make_shared<Filter>(filter_config, std::move(client)));
   };
 }
 
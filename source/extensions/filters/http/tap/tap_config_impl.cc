@@ -28,6 +28,9 @@ HttpTapConfigImpl::HttpTapConfigImpl(envoy::service::tap::v2alpha::TapConfig&& p
     : TapCommon::TapConfigBaseImpl(std::move(proto_config), admin_streamer) {}
 
 HttpPerRequestTapperPtr HttpTapConfigImpl::createPerRequestTapper(uint64_t stream_id) {
+  if (!sampled(stream_id)) {
+    return nullptr;
+  }
   return std::make_unique<HttpPerRequestTapperImpl>(shared_from_this(), stream_id);
 }
 
@@ -52,6 +52,18 @@ public:
   const std::string HeaderToMetadata = "envoy.filters.http.header_to_metadata";
   // Tap filter
   const std::string Tap = "envoy.filters.http.tap";
+  // On-demand cluster filter
+  const std::string OnDemandCluster = "envoy.filters.http.on_demand_cluster";
+  // Dynamic forward proxy filter
+  const std::string DynamicForwardProxy = "envoy.filters.http.dynamic_forward_proxy";
+  // Compressor filter
+  const std::string Compressor = "envoy.filters.http.compressor";
+  // Cache filter
+  const std::string Cache = "envoy.filters.http.cache";
+  // Adaptive concurrency filter
+  const std::string AdaptiveConcurrency = "envoy.filters.http.adaptive_concurrency";
+  // Decompressor filter
+  const std::string Decompressor = "envoy.filters.http.decompressor";
 
   // Converts names from v1 to v2
   const Config::V1Converter v1_converter_;
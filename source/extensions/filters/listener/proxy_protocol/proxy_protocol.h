@@ -41,8 +41,6 @@ public:
 
 typedef std::shared_ptr<Config> ConfigSharedPtr;
 
-enum ProxyProtocolVersion { Unknown = -1, InProgress = -2, V1 = 1, V2 = 2 };
-
 /**
  * Implementation the PROXY Protocol listener filter
  * (https://github.com/haproxy/haproxy/blob/master/doc/proxy-protocol.txt)
@@ -71,6 +69,7 @@ private:
   /**
    * Helper function that attempts to read the proxy header
    * (delimited by \r\n if V1 format, or with length if V2)
+   * The header is peeked at and only consumed once it is complete.
    * throws EnvoyException on any socket errors.
    * @return bool true valid header, false if more data is needed.
    */
@@ -91,15 +90,7 @@ private:
   Network::ListenerFilterCallbacks* cb_{};
   Event::FileEventPtr file_event_;
 
-  // The offset in buf_ that has been fully read
-  size_t buf_off_{};
-
-  // The index in buf_ where the search for '\r\n' should continue from
-  size_t search_index_{1};
-
-  ProxyProtocolVersion header_version_{Unknown};
-
-  // Stores the portion of the first line that has been read so far.
+  // Stores the header peeked from the socket, then the bytes consumed from it.
   char buf_[MAX_PROXY_PROTO_LEN_V2];
 
   ConfigSharedPtr config_;
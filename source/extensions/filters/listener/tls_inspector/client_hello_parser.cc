@@ -0,0 +1,181 @@
+#include "extensions/filters/listener/tls_inspector/client_hello_parser.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ListenerFilters {
+namespace TlsInspector {
+
+namespace {
+
+// BoringSSL's limit on the length of the handshake messages a server reads before the handshake
+// completes, see ssl_max_handshake_message_len().
+constexpr uint32_t MaxClientHelloLength = 16384;
+
+absl::string_view toStringView(const CBS& cbs) {
+  return absl::string_view(reinterpret_cast<const char*>(CBS_data(&cbs)), CBS_len(&cbs));
+}
+
+} // namespace
+
+ClientHelloParser::Result ClientHelloParser::parse(const uint8_t* data, size_t len) {
+  server_name_ = absl::string_view();
+  application_protocols_ = absl::nullopt;
+  fragments_.clear();
+
+  CBS records;
+  CBS_init(&records, data, len);
+  // The handshake bytes of the records read so far.
+  CBS handshake;
+  CBS_init(&handshake, nullptr, 0);
+  bool first_record = true;
+  while (true) {
+    // Each field of the record header is checked as soon as it's read, so that other protocols
+    // are told apart without waiting for more bytes than needed.
+    uint8_t type;
+    uint8_t major_version;
+    uint16_t length;
+    CBS fragment;
+    if (!CBS_get_u8(&records, &type)) {
+      return Result::NeedMoreData;
+    }
+    if (type != SSL3_RT_HANDSHAKE) {
+      return Result::NotClientHello;
+    }
+    if (!CBS_get_u8(&records, &major_version)) {
+      return Result::NeedMoreData;
+    }
+    if (major_version != SSL3_VERSION_MAJOR) {
+      return Result::NotClientHello;
+    }
+    if (!CBS_skip(&records, 1) || !CBS_get_u16(&records, &length)) {
+      return Result::NeedMoreData;
+    }
+    if (length > SSL3_RT_MAX_PLAIN_LENGTH) {
+      return Result::NotClientHello;
+    }
+    if (!CBS_get_bytes(&records, &fragment, length)) {
+      return Result::NeedMoreData;
+    }
+
+    if (first_record) {
+      // ClientHellos usually fit in their first record, so that they are parsed in place.
+      handshake = fragment;
+      first_record = false;
+    } else {
+      if (fragments_.empty()) {
+        fragments_.assign(CBS_data(&handshake), CBS_data(&handshake) + CBS_len(&handshake));
+      }
+      fragments_.insert(fragments_.end(), CBS_data(&fragment),
+                        CBS_data(&fragment) + CBS_len(&fragment));
+      CBS_init(&handshake, fragments_.data(), fragments_.size());
+    }
+
+    CBS message = handshake;
+    uint8_t message_type;
+    uint32_t message_length;
+    if (!CBS_get_u8(&message, &message_type)) {
+      continue;
+    }
+    if (message_type != SSL3_MT_CLIENT_HELLO) {
+      return Result::NotClientHello;
+    }
+    if (!CBS_get_u24(&message, &message_length)) {
+      continue;
+    }
+    if (message_length > MaxClientHelloLength) {
+      return Result::NotClientHello;
+    }
+    CBS client_hello;
+    if (!CBS_get_bytes(&message, &client_hello, message_length)) {
+      continue;
+    }
+    if (!parseClientHello(client_hello)) {
+      server_name_ = absl::string_view();
+      application_protocols_ = absl::nullopt;
+      return Result::NotClientHello;
+    }
+    return Result::ClientHello;
+  }
+}
+
+bool ClientHelloParser::parseClientHello(CBS& client_hello) {
+  // Based on BoringSSL's ssl_client_hello_init().
+  uint16_t client_version;
+  CBS random, session_id, cipher_suites, compression_methods;
+  if (!CBS_get_u16(&client_hello, &client_version) ||
+      !CBS_get_bytes(&client_hello, &random, SSL3_RANDOM_SIZE) ||
+      !CBS_get_u8_length_prefixed(&client_hello, &session_id) ||
+      CBS_len(&session_id) > SSL_MAX_SSL_SESSION_ID_LENGTH ||
+      !CBS_get_u16_length_prefixed(&client_hello, &cipher_suites) ||
+      CBS_len(&cipher_suites) < 2 || (CBS_len(&cipher_suites) & 1) != 0 ||
+      !CBS_get_u8_length_prefixed(&client_hello, &compression_methods) ||
+      CBS_len(&compression_methods) < 1) {
+    return false;
+  }
+  // TLS 1.3 clients send TLS 1.2 here and their versions in an extension. SSL 3 isn't supported.
+  if (client_version < TLS1_VERSION) {
+    return false;
+  }
+
+  // Extensions are optional.
+  if (CBS_len(&client_hello) == 0) {
+    return true;
+  }
+  CBS extensions;
+  if (!CBS_get_u16_length_prefixed(&client_hello, &extensions) || CBS_len(&client_hello) != 0) {
+    return false;
+  }
+  bool server_name_found = false;
+  while (CBS_len(&extensions) > 0) {
+    uint16_t type;
+    CBS extension;
+    if (!CBS_get_u16(&extensions, &type) ||
+        !CBS_get_u16_length_prefixed(&extensions, &extension)) {
+      return false;
+    }
+    switch (type) {
+    case TLSEXT_TYPE_server_name:
+      if (server_name_found || !parseServerName(extension)) {
+        return false;
+      }
+      server_name_found = true;
+      break;
+    case TLSEXT_TYPE_application_layer_protocol_negotiation:
+      if (application_protocols_.has_value()) {
+        return false;
+      }
+      // The protocols are parsed by the filter, which ignores malformed lists like the TLS
+      // inspector always did.
+      application_protocols_ = toStringView(extension);
+      break;
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+bool ClientHelloParser::parseServerName(CBS& extension) {
+  // Based on BoringSSL's ext_sni_parse_clienthello(), which only accepts a single host name.
+  CBS server_name_list, host_name;
+  uint8_t name_type;
+  if (!CBS_get_u16_length_prefixed(&extension, &server_name_list) ||
+      !CBS_get_u8(&server_name_list, &name_type) ||
+      !CBS_get_u16_length_prefixed(&server_name_list, &host_name) ||
+      CBS_len(&server_name_list) != 0 || CBS_len(&extension) != 0) {
+    return false;
+  }
+  if (name_type != TLSEXT_NAMETYPE_host_name || CBS_len(&host_name) == 0 ||
+      CBS_len(&host_name) > TLSEXT_MAXLEN_host_name || CBS_contains_zero_byte(&host_name)) {
+    return false;
+  }
+  server_name_ = toStringView(host_name);
+  return true;
+}
+
+} // namespace TlsInspector
+} // namespace ListenerFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "openssl/bytestring.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ListenerFilters {
+namespace TlsInspector {
+
+/**
+ * Parser of the TLS ClientHello at the start of the bytes peeked from a connection, which extracts
+ * its server name and application protocols without creating any SSL state. The ClientHello is
+ * parsed in place, unless it spans several TLS records. The checks follow BoringSSL's, so that the
+ * ClientHellos BoringSSL rejects before its server name callback are not ClientHellos here either.
+ */
+class ClientHelloParser {
+public:
+  enum class Result {
+    // The bytes are a prefix of a ClientHello.
+    NeedMoreData,
+    // The bytes start with a well-formed ClientHello.
+    ClientHello,
+    // The bytes don't start with a well-formed ClientHello.
+    NotClientHello,
+  };
+
+  /**
+   * Parse the ClientHello at the start of some bytes, from scratch.
+   * @param data supplies the bytes read from the connection so far.
+   * @param len supplies the number of bytes.
+   * @return Result whether the bytes start with a ClientHello. The server name and the application
+   *         protocols are only set for Result::ClientHello, and they point into the data or the
+   *         parser until the next parse.
+   */
+  Result parse(const uint8_t* data, size_t len);
+
+  /**
+   * @return absl::string_view the host name of the server_name extension, empty if there is none.
+   */
+  absl::string_view serverName() const { return server_name_; }
+
+  /**
+   * @return the body of the application_layer_protocol_negotiation extension, if there is one.
+   */
+  const absl::optional<absl::string_view>& applicationProtocols() const {
+    return application_protocols_;
+  }
+
+private:
+  bool parseClientHello(CBS& client_hello);
+  bool parseServerName(CBS& extension);
+
+  absl::string_view server_name_;
+  absl::optional<absl::string_view> application_protocols_;
+  // The handshake fragments of a ClientHello that spans several records.
+  std::vector<uint8_t> fragments_;
+};
+
+} // namespace TlsInspector
+} // namespace ListenerFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -16,7 +16,7 @@
 
 #include "extensions/transport_sockets/well_known_names.h"
 
-#include "openssl/ssl.h"
+#include "openssl/bytestring.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -25,47 +25,18 @@ namespace TlsInspector {
 
 Config::Config(Stats::Scope& scope, uint32_t max_client_hello_size)
     : stats_{ALL_TLS_INSPECTOR_STATS(POOL_COUNTER_PREFIX(scope, "tls_inspector."))},
-      ssl_ctx_(SSL_CTX_new(TLS_with_buffers_method())),
       max_client_hello_size_(max_client_hello_size) {
 
   if (max_client_hello_size_ > TLS_MAX_CLIENT_HELLO) {
     throw EnvoyException(fmt::format("max_client_hello_size of {} is greater than maximum of {}.",
                                      max_client_hello_size_, size_t(TLS_MAX_CLIENT_HELLO)));
   }
-
-  SSL_CTX_set_options(ssl_ctx_.get(), SSL_OP_NO_TICKET);
-  SSL_CTX_set_session_cache_mode(ssl_ctx_.get(), SSL_SESS_CACHE_OFF);
-  SSL_CTX_set_select_certificate_cb(
-      ssl_ctx_.get(), [](const SSL_CLIENT_HELLO* client_hello) -> ssl_select_cert_result_t {
-        const uint8_t* data;
-        size_t len;
-        if (SSL_early_callback_ctx_extension_get(
-                client_hello, TLSEXT_TYPE_application_layer_protocol_negotiation, &data, &len)) {
-          Filter* filter = static_cast<Filter*>(SSL_get_app_data(client_hello->ssl));
-          filter->onALPN(data, len);
-        }
-        return ssl_select_cert_success;
-      });
-  SSL_CTX_set_tlsext_servername_callback(
-      ssl_ctx_.get(), [](SSL* ssl, int* out_alert, void*) -> int {
-        Filter* filter = static_cast<Filter*>(SSL_get_app_data(ssl));
-        filter->onServername(SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name));
-
-        // Return an error to stop the handshake; we have what we wanted already.
-        *out_alert = SSL_AD_USER_CANCELLED;
-        return SSL_TLSEXT_ERR_ALERT_FATAL;
-      });
 }
 
-bssl::UniquePtr<SSL> Config::newSsl() { return bssl::UniquePtr<SSL>{SSL_new(ssl_ctx_.get())}; }
-
 thread_local uint8_t Filter::buf_[Config::TLS_MAX_CLIENT_HELLO];
 
-Filter::Filter(const ConfigSharedPtr config) : config_(config), ssl_(config_->newSsl()) {
+Filter::Filter(const ConfigSharedPtr config) : config_(config) {
   RELEASE_ASSERT(sizeof(buf_) >= config_->maxClientHelloSize(), "");
-
-  SSL_set_app_data(ssl_.get(), this);
-  SSL_set_accept_state(ssl_.get());
 }
 
 Network::FilterStatus Filter::onAccept(Network::ListenerFilterCallbacks& cb) {
@@ -119,7 +90,6 @@ void Filter::onServername(absl::string_view name) {
   } else {
     config_->stats().sni_not_found_.inc();
   }
-  clienthello_success_ = true;
 }
 
 void Filter::onRead() {
@@ -148,13 +118,12 @@ void Filter::onRead() {
     return;
   }
 
-  // Because we're doing a MSG_PEEK, data we've seen before gets returned every time, so
-  // skip over what we've already processed.
+  // Because we're doing a MSG_PEEK, data we've seen before gets returned every time. The
+  // ClientHello is parsed again from the start once there is more of it, which costs less than
+  // keeping the state of a partial ClientHello.
   if (static_cast<uint64_t>(result.rc_) > read_) {
-    const uint8_t* data = buf_ + read_;
-    const size_t len = result.rc_ - read_;
     read_ = result.rc_;
-    parseClientHello(data, len);
+    parseClientHello(buf_, read_);
   }
 }
 
@@ -164,23 +133,9 @@ void Filter::done(bool success) {
   cb_->continueFilterChain(success);
 }
 
-void Filter::parseClientHello(const void* data, size_t len) {
-  // Ownership is passed to ssl_ in SSL_set_bio()
-  bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(data, len));
-
-  // Make the mem-BIO return that there is more data
-  // available beyond it's end
-  BIO_set_mem_eof_return(bio.get(), -1);
-
-  SSL_set_bio(ssl_.get(), bio.get(), bio.get());
-  bio.release();
-
-  int ret = SSL_do_handshake(ssl_.get());
-
-  // This should never succeed because an error is always returned from the SNI callback.
-  ASSERT(ret <= 0);
-  switch (SSL_get_error(ssl_.get(), ret)) {
-  case SSL_ERROR_WANT_READ:
+void Filter::parseClientHello(const uint8_t* data, size_t len) {
+  switch (parser_.parse(data, len)) {
+  case ClientHelloParser::Result::NeedMoreData:
     if (read_ == config_->maxClientHelloSize()) {
       // We've hit the specified size limit. This is an unreasonably large ClientHello;
       // indicate failure.
@@ -188,22 +143,27 @@ void Filter::parseClientHello(const void* data, size_t len) {
       done(false);
     }
     break;
-  case SSL_ERROR_SSL:
-    if (clienthello_success_) {
-      config_->stats().tls_found_.inc();
-      if (alpn_found_) {
-        config_->stats().alpn_found_.inc();
-      } else {
-        config_->stats().alpn_not_found_.inc();
-      }
-      cb_->socket().setDetectedTransportProtocol(TransportSockets::TransportSocketNames::get().Tls);
+  case ClientHelloParser::Result::ClientHello: {
+    const absl::optional<absl::string_view>& application_protocols =
+        parser_.applicationProtocols();
+    if (application_protocols.has_value()) {
+      onALPN(reinterpret_cast<const unsigned char*>(application_protocols->data()),
+             application_protocols->size());
+    }
+    onServername(parser_.serverName());
+    config_->stats().tls_found_.inc();
+    if (alpn_found_) {
+      config_->stats().alpn_found_.inc();
     } else {
-      config_->stats().tls_not_found_.inc();
+      config_->stats().alpn_not_found_.inc();
     }
+    cb_->socket().setDetectedTransportProtocol(TransportSockets::TransportSocketNames::get().Tls);
     done(true);
     break;
-  default:
-    done(false);
+  }
+  case ClientHelloParser::Result::NotClientHello:
+    config_->stats().tls_not_found_.inc();
+    done(true);
     break;
   }
 }
@@ -97,6 +97,18 @@ public:
    * same hash tag will be forwarded to the same upstream.
    */
   virtual bool enableHashtagging() const PURE;
+
+  /**
+   * @return uint32_t the number of bytes of encoded requests that are buffered before they are
+   *         written to the connection. 0 writes every request as soon as it is encoded.
+   */
+  virtual uint32_t maxBufferSizeBeforeFlush() const PURE;
+
+  /**
+   * @return std::chrono::milliseconds the longest time that encoded requests are buffered before
+   *         they are written, while fewer than maxBufferSizeBeforeFlush() bytes are buffered.
+   */
+  virtual std::chrono::milliseconds bufferFlushTimeoutInMs() const PURE;
 };
 
 /**
@@ -32,10 +32,16 @@ public:
   bool disableOutlierEvents() const override { return false; }
   std::chrono::milliseconds opTimeout() const override { return op_timeout_; }
   bool enableHashtagging() const override { return enable_hashtagging_; }
+  uint32_t maxBufferSizeBeforeFlush() const override { return max_buffer_size_before_flush_; }
+  std::chrono::milliseconds bufferFlushTimeoutInMs() const override {
+    return buffer_flush_timeout_;
+  }
 
 private:
   const std::chrono::milliseconds op_timeout_;
   const bool enable_hashtagging_;
+  const uint32_t max_buffer_size_before_flush_;
+  const std::chrono::milliseconds buffer_flush_timeout_;
 };
 
 class ClientImpl : public Client, public DecoderCallbacks, public Network::ConnectionCallbacks {
@@ -82,6 +88,7 @@ private:
              DecoderFactory& decoder_factory, const Config& config);
   void onConnectOrOpTimeout();
   void onData(Buffer::Instance& data);
+  void flushBufferAndResetTimer();
   void putOutlierEvent(Upstream::Outlier::Result result);
 
   // DecoderCallbacks
@@ -93,6 +100,7 @@ private:
   void onBelowWriteBufferLowWatermark() override {}
 
   Upstream::HostConstSharedPtr host_;
+  Event::Dispatcher& dispatcher_;
   Network::ClientConnectionPtr connection_;
   EncoderPtr encoder_;
   Buffer::OwnedImpl encoder_buffer_;
@@ -100,6 +108,8 @@ private:
   const Config& config_;
   std::list<PendingRequest> pending_requests_;
   Event::TimerPtr connect_or_op_timer_;
+  // Created by the first request that is buffered before it is written.
+  Event::TimerPtr flush_timer_;
   bool connected_{};
 };
 
@@ -25,8 +25,11 @@ enum class RespType { Null, SimpleString, BulkString, Integer, Error, Array };
 class RespValue {
 public:
   RespValue() : type_(RespType::Null) {}
+  RespValue(const RespValue& other);
   ~RespValue() { cleanup(); }
 
+  RespValue& operator=(const RespValue& other);
+
   /**
    * Convert a RESP value to a string for debugging purposes.
    */
@@ -122,6 +125,14 @@ public:
    * @param out supplies the buffer to encode to.
    */
   virtual void encode(const RespValue& value, Buffer::Instance& out) PURE;
+
+  /**
+   * Encode a RESP value that is no longer needed to a buffer. Like Buffer::Instance::move(), the
+   * large bulk strings are moved into the buffer instead of being copied.
+   * @param value supplies the value to encode, which is left in an unspecified state.
+   * @param out supplies the buffer to encode to.
+   */
+  virtual void move(RespValue& value, Buffer::Instance& out) PURE;
 };
 
 typedef std::unique_ptr<Encoder> EncoderPtr;
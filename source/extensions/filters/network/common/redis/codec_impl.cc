@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
 #include "common/common/stack_array.h"
@@ -16,6 +17,35 @@ namespace NetworkFilters {
 namespace Common {
 namespace Redis {
 
+RespValue::RespValue(const RespValue& other) : type_(RespType::Null) { *this = other; }
+
+RespValue& RespValue::operator=(const RespValue& other) {
+  if (&other == this) {
+    return *this;
+  }
+
+  type(other.type());
+  switch (type_) {
+  case RespType::Array: {
+    array_ = other.array_;
+    break;
+  }
+  case RespType::SimpleString:
+  case RespType::BulkString:
+  case RespType::Error: {
+    string_ = other.string_;
+    break;
+  }
+  case RespType::Integer: {
+    integer_ = other.integer_;
+    break;
+  }
+  case RespType::Null:
+    break;
+  }
+  return *this;
+}
+
 std::string RespValue::toString() const {
   switch (type_) {
   case RespType::Array: {
@@ -120,7 +150,9 @@ void DecoderImpl::decode(Buffer::Instance& data) {
   uint64_t num_slices = data.getRawSlices(nullptr, 0);
   STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
   data.getRawSlices(slices.begin(), num_slices);
+  unparsed_bytes_ = data.length();
   for (const Buffer::RawSlice& slice : slices) {
+    unparsed_bytes_ -= slice.len_;
     parseSlice(slice);
   }
 
@@ -246,7 +278,10 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
       } else {
         ASSERT(current_value.value_->type() == RespType::BulkString);
         if (!pending_integer_.negative_) {
-          // TODO(mattklein123): reserve and define max length since we don't stream currently.
+          // Reserve the part of the body that was already received, so that large values are
+          // copied once without allocating the announced length before it arrives.
+          current_value.value_->asString().reserve(
+              std::min(pending_integer_.integer_, remaining + unparsed_bytes_));
           state_ = State::BulkStringBody;
         } else {
           // Null bulk string. Switch type to null and move to value complete.
@@ -365,29 +400,77 @@ void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
   }
 }
 
+constexpr uint64_t EncoderImpl::MoveBulkStringThreshold;
+
+void EncoderImpl::move(RespValue& value, Buffer::Instance& out) {
+  switch (value.type()) {
+  case RespType::Array: {
+    encodeArrayHeader(value.asArray().size(), out);
+    for (RespValue& element : value.asArray()) {
+      move(element, out);
+    }
+    break;
+  }
+  case RespType::BulkString: {
+    moveBulkString(value.asString(), out);
+    break;
+  }
+  default:
+    encode(value, out);
+    break;
+  }
+}
+
 void EncoderImpl::encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out) {
+  encodeArrayHeader(array.size(), out);
+  for (const RespValue& value : array) {
+    encode(value, out);
+  }
+}
+
+void EncoderImpl::encodeArrayHeader(uint64_t size, Buffer::Instance& out) {
   char buffer[32];
   char* current = buffer;
   *current++ = '*';
-  current += StringUtil::itoa(current, 31, array.size());
+  current += StringUtil::itoa(current, 31, size);
   *current++ = '\r';
   *current++ = '\n';
   out.add(buffer, current - buffer);
-
-  for (const RespValue& value : array) {
-    encode(value, out);
-  }
 }
 
 void EncoderImpl::encodeBulkString(const std::string& string, Buffer::Instance& out) {
+  encodeBulkStringHeader(string.size(), out);
+  out.add(string);
+  out.add("\r\n", 2);
+}
+
+void EncoderImpl::encodeBulkStringHeader(uint64_t size, Buffer::Instance& out) {
   char buffer[32];
   char* current = buffer;
   *current++ = '$';
-  current += StringUtil::itoa(current, 31, string.size());
+  current += StringUtil::itoa(current, 31, size);
   *current++ = '\r';
   *current++ = '\n';
   out.add(buffer, current - buffer);
-  out.add(string);
+}
+
+void EncoderImpl::moveBulkString(std::string& string, Buffer::Instance& out) {
+  if (string.size() < MoveBulkStringThreshold) {
+    encodeBulkString(string, out);
+    return;
+  }
+
+  encodeBulkStringHeader(string.size(), out);
+  // The fragment owns the string, whose storage is kept by the move, until the buffer it ends up
+  // in is drained.
+  auto* body = new std::string(std::move(string));
+  auto* fragment = new Buffer::BufferFragmentImpl(
+      body->data(), body->size(),
+      [body](const void*, size_t, const Buffer::BufferFragmentImpl* self) {
+        delete body;
+        delete self;
+      });
+  out.addBufferFragment(*fragment);
   out.add("\r\n", 2);
 }
 
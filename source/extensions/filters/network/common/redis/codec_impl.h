@@ -59,6 +59,8 @@ private:
   void parseSlice(const Buffer::RawSlice& slice);
 
   DecoderCallbacks& callbacks_;
+  // The bytes of the input that follow the slice being parsed.
+  uint64_t unparsed_bytes_{};
   State state_{State::ValueRootStart};
   PendingInteger pending_integer_;
   RespValuePtr pending_value_root_;
@@ -83,10 +85,18 @@ class EncoderImpl : public Encoder {
 public:
   // RedisProxy::Encoder
   void encode(const RespValue& value, Buffer::Instance& out) override;
+  void move(RespValue& value, Buffer::Instance& out) override;
+
+  // The bulk strings from this size are moved by move(), since the slice that references them
+  // costs more than copying smaller strings.
+  static constexpr uint64_t MoveBulkStringThreshold = 16384;
 
 private:
   void encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out);
+  void encodeArrayHeader(uint64_t size, Buffer::Instance& out);
   void encodeBulkString(const std::string& string, Buffer::Instance& out);
+  void encodeBulkStringHeader(uint64_t size, Buffer::Instance& out);
+  void moveBulkString(std::string& string, Buffer::Instance& out);
   void encodeError(const std::string& string, Buffer::Instance& out);
   void encodeInteger(int64_t integer, Buffer::Instance& out);
   void encodeSimpleString(const std::string& string, Buffer::Instance& out);
@@ -45,6 +45,24 @@ struct SupportedCommands {
     CONSTRUCT_ON_FIRST_USE(std::vector<std::string>, "del", "exists", "touch", "unlink");
   }
 
+  /**
+   * @return commands which only read, and can be served by the replicas of a Redis Cluster
+   */
+  static const std::vector<std::string>& readOnlyCommands() {
+    CONSTRUCT_ON_FIRST_USE(
+        std::vector<std::string>, "bitcount", "bitpos", "dump", "exists", "geodist", "geohash",
+        "geopos", "georadius_ro", "georadiusbymember_ro", "get", "getbit", "getrange", "hexists",
+        "hget", "hgetall", "hkeys", "hlen", "hmget", "hscan", "hstrlen", "hvals", "lindex", "llen",
+        "lrange", "pttl", "scard", "sismember", "smembers", "srandmember", "sscan", "strlen", "ttl",
+        "type", "zcard", "zcount", "zlexcount", "zrange", "zrangebylex", "zrangebyscore", "zrank",
+        "zrevrange", "zrevrangebylex", "zrevrangebyscore", "zrevrank", "zscan", "zscore");
+  }
+
+  /**
+   * @return get command
+   */
+  static const std::string& get() { CONSTRUCT_ON_FIRST_USE(std::string, "get"); }
+
   /**
    * @return mget command
    */
@@ -11,10 +11,17 @@ namespace DubboProxy {
 namespace Router {
 
 DubboFilters::FilterFactoryCb RouterFilterConfig::createFilterFactoryFromProtoTyped(
-    const envoy::config::filter::dubbo::router::v2alpha1::Router&, const std::string&,
+    const envoy::config::filter::dubbo::router::v2alpha1::Router& proto_config, const std::string&,
     Server::Configuration::FactoryContext& context) {
-  return [&context](DubboFilters::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addDecoderFilter(std::make_shared<Router>(context.clusterManager()));
+  ConnectionMultiplexerSharedPtr multiplexer;
+  if (proto_config.has_max_concurrent_requests_per_connection()) {
+    multiplexer = std::make_shared<ConnectionMultiplexer>(
+        context.threadLocal(), proto_config.max_concurrent_requests_per_connection().value());
+  }
+
+  return [&context, multiplexer](DubboFilters::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addDecoderFilter(
+        std::make_shared<Router>(context.clusterManager(), multiplexer.get()));
   };
 }
 
@@ -0,0 +1,192 @@
+#include "extensions/filters/network/dubbo_proxy/router/connection_multiplexer.h"
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/assert.h"
+
+#include "extensions/filters/network/dubbo_proxy/dubbo_protocol_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace DubboProxy {
+namespace Router {
+namespace {
+
+constexpr uint8_t MessageTypeMask = 0x80;
+constexpr uint64_t FlagOffset = 2;
+constexpr uint64_t RequestIDOffset = 4;
+constexpr uint64_t BodySizeOffset = 12;
+
+} // namespace
+
+MultiplexedConnection::MultiplexedConnection(MultiplexedConnectionList& connections,
+                                             Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                                             Upstream::HostDescriptionConstSharedPtr host)
+    : connections_(connections), conn_data_(std::move(conn_data)), host_(host) {
+  conn_data_->addUpstreamCallbacks(*this);
+}
+
+int64_t MultiplexedConnection::addRequest(Tcp::ConnectionPool::UpstreamCallbacks& callbacks,
+                                          int64_t request_id) {
+  ASSERT(!released_);
+
+  const int64_t upstream_request_id = next_request_id_++;
+  requests_.emplace(upstream_request_id, ActiveRequest{&callbacks, request_id, false});
+  return upstream_request_id;
+}
+
+void MultiplexedConnection::removeRequest(int64_t request_id) {
+  if (released_) {
+    return;
+  }
+
+  auto it = requests_.find(request_id);
+  if (it == requests_.end()) {
+    return;
+  }
+
+  if (!it->second.response_received_) {
+    reusable_ = false;
+  }
+  requests_.erase(it);
+
+  if (requests_.empty() && !dispatching_) {
+    release();
+  }
+}
+
+void MultiplexedConnection::setRequestId(Buffer::Instance& message, int64_t request_id) {
+  ASSERT(message.length() >= DubboProtocolImpl::MessageSize);
+
+  uint8_t header[DubboProtocolImpl::MessageSize];
+  message.copyOut(0, sizeof(header), header);
+  message.drain(sizeof(header));
+  for (uint64_t i = 0; i < sizeof(int64_t); i++) {
+    header[RequestIDOffset + i] = static_cast<uint8_t>(request_id >> (8 * (7 - i)));
+  }
+  message.prepend(absl::string_view(reinterpret_cast<const char*>(header), sizeof(header)));
+}
+
+void MultiplexedConnection::onUpstreamData(Buffer::Instance& data, bool) {
+  ASSERT(!released_);
+  response_buffer_.move(data);
+
+  dispatching_ = true;
+  while (response_buffer_.length() >= DubboProtocolImpl::MessageSize) {
+    const int32_t body_size = response_buffer_.peekBEInt<int32_t>(BodySizeOffset);
+    if (body_size <= 0 || body_size > DubboProtocolImpl::MaxBodySize) {
+      ENVOY_LOG(debug, "dubbo: invalid upstream message size {}", body_size);
+      dispatching_ = false;
+      connection().close(Network::ConnectionCloseType::NoFlush);
+      return;
+    }
+
+    const uint64_t message_size = DubboProtocolImpl::MessageSize + body_size;
+    if (response_buffer_.length() < message_size) {
+      break;
+    }
+
+    Buffer::OwnedImpl message;
+    message.move(response_buffer_, message_size);
+
+    const int64_t request_id = message.peekBEInt<int64_t>(RequestIDOffset);
+    auto it = requests_.find(request_id);
+    if ((message.peekInt<uint8_t>(FlagOffset) & MessageTypeMask) == MessageTypeMask ||
+        it == requests_.end() || it->second.response_received_) {
+      // Either a request of the upstream, such as a heartbeat, or the response of a request that
+      // was reset before its response arrived.
+      ENVOY_LOG(debug, "dubbo: dropping upstream message with request id {}", request_id);
+      continue;
+    }
+
+    it->second.response_received_ = true;
+    setRequestId(message, it->second.request_id_);
+    it->second.callbacks_->onUpstreamData(message, false);
+    if (released_) {
+      // The request closed the connection.
+      return;
+    }
+  }
+  dispatching_ = false;
+
+  // The end of the stream is followed by the close event of the connection.
+  if (requests_.empty()) {
+    release();
+  }
+}
+
+void MultiplexedConnection::onEvent(Network::ConnectionEvent event) {
+  if (released_ || event == Network::ConnectionEvent::Connected) {
+    return;
+  }
+
+  // The connection leaves its list first, so that the requests reset by the event can't be
+  // retried over it.
+  released_ = true;
+  connection().dispatcher().deferredDelete(removeFromList(connections_));
+
+  std::unordered_map<int64_t, ActiveRequest> requests;
+  requests.swap(requests_);
+  for (auto& request : requests) {
+    request.second.callbacks_->onEvent(event);
+  }
+
+  conn_data_.reset();
+}
+
+void MultiplexedConnection::release() {
+  ASSERT(requests_.empty());
+  released_ = true;
+
+  // A connection may receive a response for a reset request, or has part of one buffered, so it
+  // can only go back to its pool if all of its responses were read.
+  if (!reusable_ || response_buffer_.length() > 0) {
+    connection().close(Network::ConnectionCloseType::NoFlush);
+  }
+
+  Event::Dispatcher& dispatcher = connection().dispatcher();
+  conn_data_.reset();
+  dispatcher.deferredDelete(removeFromList(connections_));
+}
+
+ConnectionMultiplexer::ConnectionMultiplexer(ThreadLocal::SlotAllocator& tls,
+                                             uint32_t max_requests)
+    : tls_(tls.allocateSlot()), max_requests_(max_requests) {
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalConnections>();
+  });
+}
+
+MultiplexedConnection* ConnectionMultiplexer::connection(const std::string& cluster_name) {
+  auto& local = tls_->getTyped<ThreadLocalConnections>();
+  auto it = local.connections_.find(cluster_name);
+  if (it == local.connections_.end()) {
+    return nullptr;
+  }
+
+  // Fill the oldest connections first, so that the others are released when the load drops.
+  for (auto& connection : it->second) {
+    if (connection->activeRequests() < max_requests_) {
+      return connection.get();
+    }
+  }
+  return nullptr;
+}
+
+MultiplexedConnection&
+ConnectionMultiplexer::addConnection(const std::string& cluster_name,
+                                     Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                                     Upstream::HostDescriptionConstSharedPtr host) {
+  auto& connections = tls_->getTyped<ThreadLocalConnections>().connections_[cluster_name];
+  MultiplexedConnectionPtr connection =
+      std::make_unique<MultiplexedConnection>(connections, std::move(conn_data), host);
+  connection->moveIntoListBack(std::move(connection), connections);
+  return *connections.back();
+}
+
+} // namespace Router
+} // namespace DubboProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/tcp/conn_pool.h"
+#include "envoy/thread_local/thread_local.h"
+#include "envoy/upstream/host_description.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/linked_object.h"
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace DubboProxy {
+namespace Router {
+
+class MultiplexedConnection;
+typedef std::unique_ptr<MultiplexedConnection> MultiplexedConnectionPtr;
+typedef std::list<MultiplexedConnectionPtr> MultiplexedConnectionList;
+
+/**
+ * MultiplexedConnection carries the requests of many routers over a single upstream connection.
+ * Each request gets a request id that is unique on the connection, and each response is handed to
+ * the request with the response's request id, after the original request id of the request is
+ * restored in the response.
+ */
+class MultiplexedConnection : public Tcp::ConnectionPool::UpstreamCallbacks,
+                              public Event::DeferredDeletable,
+                              public LinkedObject<MultiplexedConnection>,
+                              Logger::Loggable<Logger::Id::dubbo> {
+public:
+  MultiplexedConnection(MultiplexedConnectionList& connections,
+                        Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                        Upstream::HostDescriptionConstSharedPtr host);
+
+  /**
+   * Add a request to the connection.
+   * @param callbacks supplies the callbacks receiving the response of the request, or the event
+   *        that closed the connection before the request was removed.
+   * @param request_id supplies the original request id of the request.
+   * @return int64_t the request id of the request on the connection.
+   */
+  int64_t addRequest(Tcp::ConnectionPool::UpstreamCallbacks& callbacks, int64_t request_id);
+
+  /**
+   * Remove a request from the connection, once its response is complete or when it is reset. The
+   * connection is released to its pool once it carries no request. A request whose response
+   * wasn't received closes the connection on release, since the response may still arrive.
+   * @param request_id supplies the request id of the request on the connection.
+   */
+  void removeRequest(int64_t request_id);
+
+  /**
+   * @return uint32_t the number of requests carried by the connection.
+   */
+  uint32_t activeRequests() const { return requests_.size(); }
+
+  Network::ClientConnection& connection() { return conn_data_->connection(); }
+  const Upstream::HostDescriptionConstSharedPtr& host() const { return host_; }
+
+  /**
+   * Rewrite the request id of a message.
+   * @param message supplies a buffer starting with the header of a Dubbo message.
+   * @param request_id supplies the new request id of the message.
+   */
+  static void setRequestId(Buffer::Instance& message, int64_t request_id);
+
+  // Tcp::ConnectionPool::UpstreamCallbacks
+  void onUpstreamData(Buffer::Instance& data, bool end_stream) override;
+  void onEvent(Network::ConnectionEvent event) override;
+  void onAboveWriteBufferHighWatermark() override {}
+  void onBelowWriteBufferLowWatermark() override {}
+
+private:
+  struct ActiveRequest {
+    Tcp::ConnectionPool::UpstreamCallbacks* callbacks_;
+    int64_t request_id_;
+    bool response_received_;
+  };
+
+  void release();
+
+  MultiplexedConnectionList& connections_;
+  Tcp::ConnectionPool::ConnectionDataPtr conn_data_;
+  Upstream::HostDescriptionConstSharedPtr host_;
+  std::unordered_map<int64_t, ActiveRequest> requests_;
+  int64_t next_request_id_{};
+  Buffer::OwnedImpl response_buffer_;
+  bool dispatching_{};
+  bool reusable_{true};
+  bool released_{};
+};
+
+/**
+ * ConnectionMultiplexer tracks the multiplexed upstream connections of each worker, by cluster.
+ */
+class ConnectionMultiplexer {
+public:
+  ConnectionMultiplexer(ThreadLocal::SlotAllocator& tls, uint32_t max_requests);
+
+  /**
+   * @param cluster_name supplies the cluster of the request.
+   * @return MultiplexedConnection* a connection of this worker to the cluster that carries fewer
+   *         than the maximum number of concurrent requests, or nullptr if there is none.
+   */
+  MultiplexedConnection* connection(const std::string& cluster_name);
+
+  /**
+   * Start multiplexing requests over a new upstream connection of this worker.
+   * @param cluster_name supplies the cluster of the connection.
+   * @param conn_data supplies the upstream connection.
+   * @param host supplies the upstream host of the connection.
+   * @return MultiplexedConnection& the connection, which is destroyed once released.
+   */
+  MultiplexedConnection& addConnection(const std::string& cluster_name,
+                                       Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                                       Upstream::HostDescriptionConstSharedPtr host);
+
+private:
+  struct ThreadLocalConnections : public ThreadLocal::ThreadLocalObject {
+    std::unordered_map<std::string, MultiplexedConnectionList> connections_;
+  };
+
+  ThreadLocal::SlotPtr tls_;
+  const uint32_t max_requests_;
+};
+
+typedef std::shared_ptr<ConnectionMultiplexer> ConnectionMultiplexerSharedPtr;
+
+} // namespace Router
+} // namespace DubboProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
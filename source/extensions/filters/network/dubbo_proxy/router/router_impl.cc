@@ -34,7 +34,7 @@ Network::FilterStatus Router::transportEnd() {
   // so it is impossible to call the transportEnd interface.
   // the encodeData function will be called only if the connection is successful.
   ASSERT(upstream_request_);
-  ASSERT(upstream_request_->conn_data_);
+  ASSERT(upstream_request_->conn_data_ || upstream_request_->multiplexed_conn_);
 
   upstream_request_->encodeData(upstream_request_buffer_);
 
@@ -105,9 +105,14 @@ Network::FilterStatus Router::messageEnd(MessageMetadataSharedPtr metadata) {
 
   ENVOY_STREAM_LOG(debug, "dubbo router: decoding request", *callbacks_);
 
-  upstream_request_ = std::make_unique<UpstreamRequest>(*this, *conn_pool, metadata,
-                                                        callbacks_->downstreamSerializationType(),
-                                                        callbacks_->downstreamProtocolType());
+  // Oneway requests keep exclusive connections, as there is no response to release the connection
+  // with.
+  const bool multiplexed =
+      multiplexer_ != nullptr && metadata->message_type() == MessageType::Request;
+
+  upstream_request_ = std::make_unique<UpstreamRequest>(
+      *this, *conn_pool, metadata, callbacks_->downstreamSerializationType(),
+      callbacks_->downstreamProtocolType(), multiplexed);
   return upstream_request_->start();
 }
 
@@ -139,7 +144,8 @@ void Router::onUpstreamData(Buffer::Instance& data, bool end_stream) {
     return;
   }
 
-  if (end_stream) {
+  // Multiplexed connections hand over whole responses.
+  if (end_stream || upstream_request_->multiplexed_conn_ != nullptr) {
     // Response is incomplete, but no more data is coming.
     ENVOY_STREAM_LOG(debug, "dubbo router: response underflow", *callbacks_);
     upstream_request_->onResetStream(
@@ -155,6 +161,9 @@ void Router::onEvent(Network::ConnectionEvent event) {
     return;
   }
 
+  // A multiplexed connection forgets its requests when it is closed.
+  upstream_request_->multiplexed_conn_ = nullptr;
+
   switch (event) {
   case Network::ConnectionEvent::RemoteClose:
     upstream_request_->onResetStream(
@@ -183,8 +192,8 @@ void Router::cleanup() {
 Router::UpstreamRequest::UpstreamRequest(Router& parent, Tcp::ConnectionPool::Instance& pool,
                                          MessageMetadataSharedPtr& metadata,
                                          SerializationType serialization_type,
-                                         ProtocolType protocol_type)
-    : parent_(parent), conn_pool_(pool), metadata_(metadata),
+                                         ProtocolType protocol_type, bool multiplexed)
+    : parent_(parent), conn_pool_(pool), metadata_(metadata), multiplexed_(multiplexed),
       deserializer_(
           NamedDeserializerConfigFactory::getFactory(serialization_type).createDeserializer()),
       protocol_(NamedProtocolConfigFactory::getFactory(protocol_type).createProtocol()),
@@ -193,6 +202,15 @@ Router::UpstreamRequest::UpstreamRequest(Router& parent, Tcp::ConnectionPool::In
 Router::UpstreamRequest::~UpstreamRequest() {}
 
 Network::FilterStatus Router::UpstreamRequest::start() {
+  if (multiplexed_) {
+    multiplexed_conn_ = parent_.multiplexer_->connection(parent_.route_entry_->clusterName());
+    if (multiplexed_conn_ != nullptr) {
+      onUpstreamHostSelected(multiplexed_conn_->host());
+      onRequestStart(false);
+      return Network::FilterStatus::Continue;
+    }
+  }
+
   Tcp::ConnectionPool::Cancellable* handle = conn_pool_.newConnection(*this);
   if (handle) {
     // Pause while we wait for a connection.
@@ -211,6 +229,9 @@ void Router::UpstreamRequest::resetStream() {
     ENVOY_LOG(debug, "dubbo upstream request: reset connection pool handler");
   }
 
+  // The connection stays open for its other requests.
+  removeMultiplexedRequest();
+
   if (conn_data_) {
     ASSERT(!conn_pool_handle_);
     conn_data_->connection().close(Network::ConnectionCloseType::NoFlush);
@@ -220,13 +241,26 @@ void Router::UpstreamRequest::resetStream() {
 }
 
 void Router::UpstreamRequest::encodeData(Buffer::Instance& data) {
-  ASSERT(conn_data_);
+  ASSERT(conn_data_ || multiplexed_conn_);
   ASSERT(!conn_pool_handle_);
 
   ENVOY_STREAM_LOG(trace, "proxying {} bytes", *parent_.callbacks_, data.length());
+  if (multiplexed_conn_ != nullptr) {
+    MultiplexedConnection::setRequestId(data, multiplexed_request_id_);
+    multiplexed_conn_->connection().write(data, false);
+    return;
+  }
+
   conn_data_->connection().write(data, false);
 }
 
+void Router::UpstreamRequest::removeMultiplexedRequest() {
+  if (multiplexed_conn_ != nullptr) {
+    multiplexed_conn_->removeRequest(multiplexed_request_id_);
+    multiplexed_conn_ = nullptr;
+  }
+}
+
 void Router::UpstreamRequest::onPoolFailure(Tcp::ConnectionPool::PoolFailureReason reason,
                                             Upstream::HostDescriptionConstSharedPtr host) {
   conn_pool_handle_ = nullptr;
@@ -256,9 +290,17 @@ void Router::UpstreamRequest::onPoolReady(Tcp::ConnectionPool::ConnectionDataPtr
   bool continue_decoding = conn_pool_handle_ != nullptr;
 
   onUpstreamHostSelected(host);
+  conn_pool_handle_ = nullptr;
+
+  if (multiplexed_) {
+    multiplexed_conn_ = &parent_.multiplexer_->addConnection(parent_.route_entry_->clusterName(),
+                                                             std::move(conn_data), host);
+    onRequestStart(continue_decoding);
+    return;
+  }
+
   conn_data_ = std::move(conn_data);
   conn_data_->addUpstreamCallbacks(parent_);
-  conn_pool_handle_ = nullptr;
 
   onRequestStart(continue_decoding);
 }
@@ -267,6 +309,10 @@ void Router::UpstreamRequest::onRequestStart(bool continue_decoding) {
   ENVOY_LOG(debug, "dubbo upstream request: start sending data to the server {}",
             upstream_host_->address()->asString());
 
+  if (multiplexed_conn_ != nullptr) {
+    multiplexed_request_id_ = multiplexed_conn_->addRequest(parent_, metadata_->request_id());
+  }
+
   if (continue_decoding) {
     parent_.callbacks_->continueDecoding();
   }
@@ -277,6 +323,7 @@ void Router::UpstreamRequest::onRequestComplete() { request_complete_ = true; }
 
 void Router::UpstreamRequest::onResponseComplete() {
   response_complete_ = true;
+  removeMultiplexedRequest();
   conn_data_.reset();
 }
 
@@ -10,6 +10,7 @@
 #include "common/upstream/load_balancer_impl.h"
 
 #include "extensions/filters/network/dubbo_proxy/filters/filter.h"
+#include "extensions/filters/network/dubbo_proxy/router/connection_multiplexer.h"
 #include "extensions/filters/network/dubbo_proxy/router/router.h"
 
 namespace Envoy {
@@ -23,7 +24,13 @@ class Router : public Tcp::ConnectionPool::UpstreamCallbacks,
                public DubboFilters::DecoderFilter,
                Logger::Loggable<Logger::Id::dubbo> {
 public:
-  Router(Upstream::ClusterManager& cluster_manager) : cluster_manager_(cluster_manager) {}
+  /**
+   * @param cluster_manager supplies the cluster manager.
+   * @param multiplexer supplies the multiplexer of the upstream connections, or nullptr if each
+   *        request has an exclusive upstream connection.
+   */
+  Router(Upstream::ClusterManager& cluster_manager, ConnectionMultiplexer* multiplexer)
+      : cluster_manager_(cluster_manager), multiplexer_(multiplexer) {}
   ~Router() {}
 
   // DubboFilters::DecoderFilter
@@ -49,12 +56,13 @@ private:
   struct UpstreamRequest : public Tcp::ConnectionPool::Callbacks {
     UpstreamRequest(Router& parent, Tcp::ConnectionPool::Instance& pool,
                     MessageMetadataSharedPtr& metadata, SerializationType serialization_type,
-                    ProtocolType protocol_type);
+                    ProtocolType protocol_type, bool multiplexed);
     ~UpstreamRequest();
 
     Network::FilterStatus start();
     void resetStream();
     void encodeData(Buffer::Instance& data);
+    void removeMultiplexedRequest();
 
     // Tcp::ConnectionPool::Callbacks
     void onPoolFailure(Tcp::ConnectionPool::PoolFailureReason reason,
@@ -71,6 +79,10 @@ private:
     Router& parent_;
     Tcp::ConnectionPool::Instance& conn_pool_;
     MessageMetadataSharedPtr metadata_;
+    // A multiplexed request shares its upstream connection, in which case conn_data_ is unused.
+    const bool multiplexed_;
+    MultiplexedConnection* multiplexed_conn_{};
+    int64_t multiplexed_request_id_{};
 
     Tcp::ConnectionPool::Cancellable* conn_pool_handle_{};
     Tcp::ConnectionPool::ConnectionDataPtr conn_data_;
@@ -86,6 +98,7 @@ private:
   void cleanup();
 
   Upstream::ClusterManager& cluster_manager_;
+  ConnectionMultiplexer* multiplexer_;
 
   DubboFilters::DecoderFilterCallbacks* callbacks_{};
   RouteConstSharedPtr route_{};
@@ -141,6 +141,7 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
       max_request_headers_kb_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
           config, max_request_headers_kb, Http::DEFAULT_MAX_REQUEST_HEADERS_KB)),
       idle_timeout_(PROTOBUF_GET_OPTIONAL_MS(config, idle_timeout)),
+      idle_compaction_timeout_(PROTOBUF_GET_OPTIONAL_MS(config, idle_compaction_timeout)),
       stream_idle_timeout_(
           PROTOBUF_GET_MS_OR_DEFAULT(config, stream_idle_timeout, StreamIdleTimeoutMs)),
       request_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config, request_timeout, RequestTimeoutMs)),
@@ -150,11 +151,20 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
       listener_stats_(Http::ConnectionManagerImpl::generateListenerStats(stats_prefix_,
                                                                          context_.listenerScope())),
       proxy_100_continue_(config.proxy_100_continue()),
-      delayed_close_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config, delayed_close_timeout, 1000)) {
+      delayed_close_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config, delayed_close_timeout, 1000)),
+      filter_timing_stats_(config.filter_timing_stats()) {
 
   route_config_provider_ = Router::RouteConfigProviderUtil::create(config, context_, stats_prefix_,
                                                                    route_config_provider_manager_);
 
+  const uint32_t route_cache_size = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, route_cache_size, 0);
+  if (route_cache_size > 0) {
+    route_cache_slot_ = context_.threadLocal().allocateSlot();
+    route_cache_slot_->set([route_cache_size](Event::Dispatcher&) {
+      return std::make_shared<ThreadLocalRouteCache>(route_cache_size);
+    });
+  }
+
   switch (config.forward_client_cert_details()) {
   case envoy::config::filter::network::http_connection_manager::v2::HttpConnectionManager::SANITIZE:
     forward_client_cert_ = Http::ForwardClientCertType::Sanitize;
@@ -227,10 +237,23 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
     uint64_t overall_sampling{
         PROTOBUF_PERCENT_TO_ROUNDED_INTEGER_OR_DEFAULT(tracing_config, overall_sampling, 100, 100)};
 
+    absl::optional<Http::TracingTailSamplingConfig> tail_sampling;
+    if (tracing_config.has_tail_sampling()) {
+      const auto& tail_sampling_config = tracing_config.tail_sampling();
+      tail_sampling = Http::TracingTailSamplingConfig{{}, tail_sampling_config.errors(), {}};
+      if (tail_sampling_config.has_latency_threshold()) {
+        tail_sampling->latency_threshold_ = std::chrono::milliseconds(
+            DurationUtil::durationToMilliseconds(tail_sampling_config.latency_threshold()));
+      }
+      for (const auto& header : tail_sampling_config.request_headers()) {
+        tail_sampling->request_headers_.emplace_back(header);
+      }
+    }
+
     tracing_config_ =
         std::make_unique<Http::TracingConnectionManagerConfig>(Http::TracingConnectionManagerConfig{
             tracing_operation_name, request_headers_for_tags, client_sampling, random_sampling,
-            overall_sampling, tracing_config.verbose()});
+            overall_sampling, tracing_config.verbose(), std::move(tail_sampling)});
   }
 
   for (const auto& access_log : config.access_log()) {
@@ -312,6 +335,17 @@ void HttpConnectionManagerConfig::processFilter(
         Config::Utility::translateToFactoryConfig(proto_config, factory);
     callback = factory.createFilterFactoryFromProto(*message, stats_prefix_, context_);
   }
+  if (filter_timing_stats_) {
+    // The filters of the same name share their stats, e.g. the ones of an upgrade filter chain.
+    const std::string prefix = stats_prefix_ + "filter." + string_name + ".";
+    std::shared_ptr<Http::FilterTimingStats> stats(new Http::FilterTimingStats{
+        ALL_HTTP_FILTER_TIMING_STATS(POOL_HISTOGRAM_PREFIX(context_.scope(), prefix))});
+    callback = [callback, stats](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+      callbacks.setFilterTimingStats(stats.get());
+      callback(callbacks);
+      callbacks.setFilterTimingStats(nullptr);
+    };
+  }
   filter_factories.push_back(callback);
 }
 
@@ -379,6 +413,13 @@ const Network::Address::Instance& HttpConnectionManagerConfig::localAddress() {
   return *context_.localInfo().address();
 }
 
+Http::RouteCache* HttpConnectionManagerConfig::routeCache() {
+  if (route_cache_slot_ == nullptr) {
+    return nullptr;
+  }
+  return &route_cache_slot_->getTyped<ThreadLocalRouteCache>().cache_;
+}
+
 } // namespace HttpConnectionManager
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -10,6 +10,7 @@
 #include "envoy/config/filter/network/http_connection_manager/v2/http_connection_manager.pb.validate.h"
 #include "envoy/http/filter.h"
 #include "envoy/router/route_config_provider_manager.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "common/common/logger.h"
 #include "common/http/conn_manager_impl.h"
@@ -102,6 +103,9 @@ public:
   bool generateRequestId() override { return generate_request_id_; }
   uint32_t maxRequestHeadersKb() const override { return max_request_headers_kb_; }
   absl::optional<std::chrono::milliseconds> idleTimeout() const override { return idle_timeout_; }
+  absl::optional<std::chrono::milliseconds> idleCompactionTimeout() const override {
+    return idle_compaction_timeout_;
+  }
   std::chrono::milliseconds streamIdleTimeout() const override { return stream_idle_timeout_; }
   std::chrono::milliseconds requestTimeout() const override { return request_timeout_; }
   Router::RouteConfigProvider& routeConfigProvider() override { return *route_config_provider_; }
@@ -128,9 +132,17 @@ public:
   bool proxy100Continue() const override { return proxy_100_continue_; }
   const Http::Http1Settings& http1Settings() const override { return http1_settings_; }
   std::chrono::milliseconds delayedCloseTimeout() const override { return delayed_close_timeout_; }
+  Http::RouteCache* routeCache() override;
 
 private:
   enum class CodecType { HTTP1, HTTP2, AUTO };
+
+  struct ThreadLocalRouteCache : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalRouteCache(uint32_t max_entries) : cache_(max_entries) {}
+
+    Http::RouteCache cache_;
+  };
+
   void processFilter(
       const envoy::config::filter::network::http_connection_manager::v2::HttpFilter& proto_config,
       int i, absl::string_view prefix, FilterFactoriesList& filter_factories);
@@ -158,6 +170,7 @@ private:
   absl::optional<std::string> user_agent_;
   const uint32_t max_request_headers_kb_;
   absl::optional<std::chrono::milliseconds> idle_timeout_;
+  absl::optional<std::chrono::milliseconds> idle_compaction_timeout_;
   std::chrono::milliseconds stream_idle_timeout_;
   std::chrono::milliseconds request_timeout_;
   Router::RouteConfigProviderPtr route_config_provider_;
@@ -167,6 +180,9 @@ private:
   Http::ConnectionManagerListenerStats listener_stats_;
   const bool proxy_100_continue_;
   std::chrono::milliseconds delayed_close_timeout_;
+  const bool filter_timing_stats_;
+  // Only allocated when route caching is enabled.
+  ThreadLocal::SlotPtr route_cache_slot_;
 
   // Default idle timeout is 5 minutes if nothing is specified in the HCM config.
   static const uint64_t StreamIdleTimeoutMs = 5 * 60 * 1000;
@@ -372,7 +372,19 @@ std::string FieldImpl::toString() const {
   NOT_REACHED_GCOVR_EXCL_LINE;
 }
 
-void DocumentImpl::fromBuffer(Buffer::Instance& data) {
+int32_t DocumentImpl::skip(Buffer::Instance& data) {
+  // Minimum size is 5.
+  int32_t document_length = BufferHelper::peekInt32(data);
+  if (document_length < static_cast<int32_t>(sizeof(int32_t) + 1) ||
+      static_cast<uint64_t>(document_length) > data.length()) {
+    throw EnvoyException("invalid BSON message length");
+  }
+
+  data.drain(document_length);
+  return document_length;
+}
+
+void DocumentImpl::fromBuffer(Buffer::Instance& data, bool first_field_only) {
   uint64_t original_buffer_length = data.length();
   int32_t message_length = BufferHelper::removeInt32(data);
   if (static_cast<uint64_t>(message_length) > original_buffer_length) {
@@ -394,6 +406,12 @@ void DocumentImpl::fromBuffer(Buffer::Instance& data) {
       return;
     }
 
+    if (first_field_only && !fields_.empty()) {
+      ENVOY_LOG(trace, "BSON skipping {} bytes", document_bytes_remaining);
+      data.drain(document_bytes_remaining);
+      return;
+    }
+
     uint8_t element_type = BufferHelper::removeByte(data);
     std::string key = BufferHelper::removeCString(data);
     ENVOY_LOG(trace, "BSON element type: {:#x} key: {}", element_type, key);
@@ -421,13 +439,15 @@ void DocumentImpl::fromBuffer(Buffer::Instance& data) {
 
     case Field::Type::DOCUMENT: {
       ENVOY_LOG(trace, "BSON document");
-      addDocument(key, DocumentImpl::create(data));
+      addDocument(key, first_field_only ? DocumentImpl::createFirstField(data)
+                                        : DocumentImpl::create(data));
       break;
     }
 
     case Field::Type::ARRAY: {
       ENVOY_LOG(trace, "BSON array");
-      addArray(key, DocumentImpl::create(data));
+      addArray(key, first_field_only ? DocumentImpl::createFirstField(data)
+                                     : DocumentImpl::create(data));
       break;
     }
 
@@ -184,10 +184,27 @@ public:
   static DocumentSharedPtr create() { return DocumentSharedPtr{new DocumentImpl()}; }
   static DocumentSharedPtr create(Buffer::Instance& data) {
     std::shared_ptr<DocumentImpl> new_doc{new DocumentImpl()};
-    new_doc->fromBuffer(data);
+    new_doc->fromBuffer(data, false);
     return new_doc;
   }
 
+  /**
+   * Decode only the first field of a document, and of the document nested in that field, and skip
+   * the rest of the document. This bounds the allocations of documents that are only decoded to
+   * find their first key, such as the query of a command.
+   */
+  static DocumentSharedPtr createFirstField(Buffer::Instance& data) {
+    std::shared_ptr<DocumentImpl> new_doc{new DocumentImpl()};
+    new_doc->fromBuffer(data, true);
+    return new_doc;
+  }
+
+  /**
+   * Skip a document without decoding it.
+   * @return int32_t the byte size of the skipped document.
+   */
+  static int32_t skip(Buffer::Instance& data);
+
   // Mongo::Document
   DocumentSharedPtr addDouble(const std::string& key, double value) override {
     fields_.emplace_back(new FieldImpl(key, value));
@@ -270,7 +287,7 @@ public:
 private:
   DocumentImpl() {}
 
-  void fromBuffer(Buffer::Instance& data);
+  void fromBuffer(Buffer::Instance& data, bool first_field_only);
 
   std::list<FieldPtr> fields_;
 };
@@ -40,6 +40,13 @@ public:
   virtual int32_t responseTo() const PURE;
   virtual std::string toString(bool full) const PURE;
 
+  /**
+   * @return bool whether the BSON documents of the message were decoded. A message decoded in
+   *         lightweight mode only carries its header, the fixed fields of its operation and the
+   *         first field of the query of an OP_QUERY, which names its command.
+   */
+  virtual bool documentsDecoded() const PURE;
+
   // Define some constants used in mongo messages encoding
   constexpr static uint32_t MessageHeaderSize = 16;
   constexpr static uint32_t Int32Length = 4;
@@ -152,6 +159,12 @@ public:
   virtual void numberReturned(int32_t number_returned) PURE;
   virtual const std::list<Bson::DocumentSharedPtr>& documents() const PURE;
   virtual std::list<Bson::DocumentSharedPtr>& documents() PURE;
+
+  /**
+   * @return uint64_t the total byte size of the documents of the reply, including the ones that
+   *         were skipped by a lightweight decode.
+   */
+  virtual uint64_t documentsByteSize() const PURE;
 };
 
 typedef std::unique_ptr<ReplyMessage> ReplyMessagePtr;
@@ -201,6 +214,13 @@ public:
   virtual void decodeReply(ReplyMessagePtr&& message) PURE;
   virtual void decodeCommand(CommandMessagePtr&& message) PURE;
   virtual void decodeCommandReply(CommandReplyMessagePtr&& message) PURE;
+
+  /**
+   * Called before the body of each message is decoded.
+   * @return bool whether the BSON documents of the message should be decoded. Otherwise the
+   *         message is decoded in lightweight mode. @see Message::documentsDecoded().
+   */
+  virtual bool decodeDocuments() PURE;
 };
 
 /**
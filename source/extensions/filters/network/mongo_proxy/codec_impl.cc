@@ -38,7 +38,19 @@ MessageImpl::documentListToString(const std::list<Bson::DocumentSharedPtr>& docu
   return out.str();
 }
 
-void GetMoreMessageImpl::fromBuffer(uint32_t, Buffer::Instance& data) {
+void MessageImpl::skipDocuments(uint64_t remaining_length, Buffer::Instance& data) {
+  const uint64_t end_length = data.length() - remaining_length;
+  while (data.length() > end_length) {
+    Bson::DocumentImpl::skip(data);
+    skipped_documents_++;
+  }
+
+  if (data.length() < end_length) {
+    throw EnvoyException("invalid message documents");
+  }
+}
+
+void GetMoreMessageImpl::fromBuffer(uint32_t, Buffer::Instance& data, bool) {
   ENVOY_LOG(trace, "decoding get more message");
   Bson::BufferHelper::removeInt32(data); // "zero" (unused)
   full_collection_name_ = Bson::BufferHelper::removeCString(data);
@@ -60,13 +72,21 @@ std::string GetMoreMessageImpl::toString(bool) const {
       request_id_, response_to_, full_collection_name_, number_to_return_, cursor_id_);
 }
 
-void InsertMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data) {
+void InsertMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                                   bool decode_documents) {
   ENVOY_LOG(trace, "decoding insert message");
   uint64_t original_buffer_length = data.length();
   ASSERT(message_length <= original_buffer_length);
 
   flags_ = Bson::BufferHelper::removeInt32(data);
   full_collection_name_ = Bson::BufferHelper::removeCString(data);
+  documents_decoded_ = decode_documents;
+  if (!documents_decoded_) {
+    skipDocuments(data.length() - (original_buffer_length - message_length), data);
+    ENVOY_LOG(trace, "{}", toString(true));
+    return;
+  }
+
   while (data.length() - (original_buffer_length - message_length) > 0) {
     documents_.emplace_back(Bson::DocumentImpl::create(data));
   }
@@ -96,10 +116,11 @@ std::string InsertMessageImpl::toString(bool full) const {
       R"EOF({{"opcode": "OP_INSERT", "id": {}, "response_to": {}, "flags": "{:#x}", "collection": "{}", )EOF"
       R"EOF("documents": {}}})EOF",
       request_id_, response_to_, flags_, full_collection_name_,
-      full ? documentListToString(documents_) : std::to_string(documents_.size()));
+      full && documents_decoded_ ? documentListToString(documents_)
+                                 : std::to_string(documents_.size() + skipped_documents_));
 }
 
-void KillCursorsMessageImpl::fromBuffer(uint32_t, Buffer::Instance& data) {
+void KillCursorsMessageImpl::fromBuffer(uint32_t, Buffer::Instance& data, bool) {
   ENVOY_LOG(trace, "decoding kill cursors message");
   Bson::BufferHelper::removeInt32(data); // zero
   number_of_cursor_ids_ = Bson::BufferHelper::removeInt32(data);
@@ -133,7 +154,8 @@ std::string KillCursorsMessageImpl::toString(bool) const {
       request_id_, response_to_, number_of_cursor_ids_, cursors.str());
 }
 
-void QueryMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data) {
+void QueryMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                                  bool decode_documents) {
   ENVOY_LOG(trace, "decoding query message");
   uint64_t original_buffer_length = data.length();
   ASSERT(message_length <= original_buffer_length);
@@ -142,6 +164,15 @@ void QueryMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& dat
   full_collection_name_ = Bson::BufferHelper::removeCString(data);
   number_to_skip_ = Bson::BufferHelper::removeInt32(data);
   number_to_return_ = Bson::BufferHelper::removeInt32(data);
+  documents_decoded_ = decode_documents;
+  if (!documents_decoded_) {
+    // The first field of the query names its command, if the query is one.
+    query_ = Bson::DocumentImpl::createFirstField(data);
+    skipDocuments(data.length() - (original_buffer_length - message_length), data);
+    ENVOY_LOG(trace, "{}", toString(true));
+    return;
+  }
+
   query_ = Bson::DocumentImpl::create(data);
 
   if (data.length() - (original_buffer_length - message_length) > 0) {
@@ -183,12 +214,25 @@ std::string QueryMessageImpl::toString(bool full) const {
       return_fields_selector_ ? return_fields_selector_->toString() : "{}");
 }
 
-void ReplyMessageImpl::fromBuffer(uint32_t, Buffer::Instance& data) {
+void ReplyMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                                  bool decode_documents) {
   ENVOY_LOG(trace, "decoding reply message");
+  uint64_t original_buffer_length = data.length();
+  ASSERT(message_length <= original_buffer_length);
+
   flags_ = Bson::BufferHelper::removeInt32(data);
   cursor_id_ = Bson::BufferHelper::removeInt64(data);
   starting_from_ = Bson::BufferHelper::removeInt32(data);
   number_returned_ = Bson::BufferHelper::removeInt32(data);
+  documents_decoded_ = decode_documents;
+  if (!documents_decoded_) {
+    // The documents fill the rest of the message, so their size is known without decoding them.
+    skipped_documents_byte_size_ = data.length() - (original_buffer_length - message_length);
+    skipDocuments(skipped_documents_byte_size_, data);
+    ENVOY_LOG(trace, "{}", toString(true));
+    return;
+  }
+
   for (int32_t i = 0; i < number_returned_; i++) {
     documents_.emplace_back(Bson::DocumentImpl::create(data));
   }
@@ -214,24 +258,42 @@ bool ReplyMessageImpl::operator==(const ReplyMessage& rhs) const {
   return true;
 }
 
+uint64_t ReplyMessageImpl::documentsByteSize() const {
+  uint64_t byte_size = skipped_documents_byte_size_;
+  for (const Bson::DocumentSharedPtr& document : documents_) {
+    byte_size += document->byteSize();
+  }
+
+  return byte_size;
+}
+
 std::string ReplyMessageImpl::toString(bool full) const {
   return fmt::format(
       R"EOF({{"opcode": "OP_REPLY", "id": {}, "response_to": {}, "flags": "{:#x}", "cursor": "{}", )EOF"
       R"EOF("from": {}, "returned": {}, "documents": {}}})EOF",
       request_id_, response_to_, flags_, cursor_id_, starting_from_, number_returned_,
-      full ? documentListToString(documents_) : std::to_string(documents_.size()));
+      full && documents_decoded_ ? documentListToString(documents_)
+                                 : std::to_string(documents_.size() + skipped_documents_));
 }
 
 /*
  * OP_COMMAND mongo message implementation.
  */
-void CommandMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data) {
+void CommandMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                                    bool decode_documents) {
   ENVOY_LOG(trace, "decoding COMMAND message");
   const uint64_t original_data_length = data.length();
   ASSERT(data.length() >= message_length); // See comment below about relationship.
 
   database_ = Bson::BufferHelper::removeCString(data);
   command_name_ = Bson::BufferHelper::removeCString(data);
+  documents_decoded_ = decode_documents;
+  if (!documents_decoded_) {
+    skipDocuments(data.length() - (original_data_length - message_length), data);
+    ENVOY_LOG(trace, "{}", toString(true));
+    return;
+  }
+
   metadata_ = Bson::DocumentImpl::create(data);
   command_args_ = Bson::DocumentImpl::create(data);
 
@@ -250,9 +312,11 @@ std::string CommandMessageImpl::toString(bool full) const {
       R"EOF({{"opcode": "OP_COMMAND", "id": {}, "response_to": {}, "database": "{}", )EOF"
       R"EOF("commandName": "{}", "metadata": {}, )EOF"
       R"EOF("commandArgs": {}, "inputDocs": {}}})EOF",
-      request_id_, response_to_, database_.c_str(), command_name_.c_str(), metadata_->toString(),
-      command_args_->toString(),
-      full ? documentListToString(input_docs_) : std::to_string(input_docs_.size()));
+      request_id_, response_to_, database_.c_str(), command_name_.c_str(),
+      metadata_ ? metadata_->toString() : "\"{...}\"",
+      command_args_ ? command_args_->toString() : "\"{...}\"",
+      full && documents_decoded_ ? documentListToString(input_docs_)
+                                 : std::to_string(input_docs_.size() + skipped_documents_));
 }
 
 bool CommandMessageImpl::operator==(const CommandMessage& rhs) const {
@@ -287,11 +351,19 @@ bool CommandMessageImpl::operator==(const CommandMessage& rhs) const {
 }
 
 // OP_COMMANDREPLY implementation.
-void CommandReplyMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data) {
+void CommandReplyMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                                         bool decode_documents) {
   ENVOY_LOG(trace, "decoding COMMAND REPLY message");
   const uint64_t original_data_length = data.length();
   ASSERT(data.length() >= message_length); // See comment below about relationship.
 
+  documents_decoded_ = decode_documents;
+  if (!documents_decoded_) {
+    skipDocuments(message_length, data);
+    ENVOY_LOG(trace, "{}", toString(true));
+    return;
+  }
+
   metadata_ = Bson::DocumentImpl::create(data);
   command_reply_ = Bson::DocumentImpl::create(data);
 
@@ -308,9 +380,11 @@ void CommandReplyMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instan
 std::string CommandReplyMessageImpl::toString(bool full) const {
   return fmt::format(R"EOF({{"opcode": "OP_COMMANDREPLY", "id": {}, "response_to": {}, )EOF"
                      R"EOF("metadata": {}, "commandReply": {}, "outputDocs":{}}} )EOF",
-                     request_id_, response_to_, metadata_->toString(), command_reply_->toString(),
-                     full ? documentListToString(output_docs_)
-                          : std::to_string(output_docs_.size()));
+                     request_id_, response_to_, metadata_ ? metadata_->toString() : "\"{...}\"",
+                     command_reply_ ? command_reply_->toString() : "\"{...}\"",
+                     full && documents_decoded_
+                         ? documentListToString(output_docs_)
+                         : std::to_string(output_docs_.size() + skipped_documents_));
 }
 
 bool CommandReplyMessageImpl::operator==(const CommandReplyMessage& rhs) const {
@@ -364,32 +438,33 @@ bool DecoderImpl::decode(Buffer::Instance& data) {
   // Some messages need to know how long they are to parse. Subtract the header that we have already
   // parsed off before passing the final value.
   message_length -= Message::MessageHeaderSize;
+  const bool decode_documents = callbacks_.decodeDocuments();
 
   switch (op_code) {
   case Message::OpCode::OP_REPLY: {
     std::unique_ptr<ReplyMessageImpl> message(new ReplyMessageImpl(request_id, response_to));
-    message->fromBuffer(message_length, data);
+    message->fromBuffer(message_length, data, decode_documents);
     callbacks_.decodeReply(std::move(message));
     break;
   }
 
   case Message::OpCode::OP_QUERY: {
     std::unique_ptr<QueryMessageImpl> message(new QueryMessageImpl(request_id, response_to));
-    message->fromBuffer(message_length, data);
+    message->fromBuffer(message_length, data, decode_documents);
     callbacks_.decodeQuery(std::move(message));
     break;
   }
 
   case Message::OpCode::OP_GET_MORE: {
     std::unique_ptr<GetMoreMessageImpl> message(new GetMoreMessageImpl(request_id, response_to));
-    message->fromBuffer(message_length, data);
+    message->fromBuffer(message_length, data, decode_documents);
     callbacks_.decodeGetMore(std::move(message));
     break;
   }
 
   case Message::OpCode::OP_INSERT: {
     std::unique_ptr<InsertMessageImpl> message(new InsertMessageImpl(request_id, response_to));
-    message->fromBuffer(message_length, data);
+    message->fromBuffer(message_length, data, decode_documents);
     callbacks_.decodeInsert(std::move(message));
     break;
   }
@@ -397,14 +472,14 @@ bool DecoderImpl::decode(Buffer::Instance& data) {
   case Message::OpCode::OP_KILL_CURSORS: {
     std::unique_ptr<KillCursorsMessageImpl> message(
         new KillCursorsMessageImpl(request_id, response_to));
-    message->fromBuffer(message_length, data);
+    message->fromBuffer(message_length, data, decode_documents);
     callbacks_.decodeKillCursors(std::move(message));
     break;
   }
 
   case Message::OpCode::OP_COMMAND: {
     std::unique_ptr<CommandMessageImpl> message(new CommandMessageImpl(request_id, response_to));
-    message->fromBuffer(message_length, data);
+    message->fromBuffer(message_length, data, decode_documents);
     callbacks_.decodeCommand(std::move(message));
     break;
   }
@@ -412,7 +487,7 @@ bool DecoderImpl::decode(Buffer::Instance& data) {
   case Message::OpCode::OP_COMMANDREPLY: {
     std::unique_ptr<CommandReplyMessageImpl> message(
         new CommandReplyMessageImpl(request_id, response_to));
-    message->fromBuffer(message_length, data);
+    message->fromBuffer(message_length, data, decode_documents);
     callbacks_.decodeCommandReply(std::move(message));
     break;
   }
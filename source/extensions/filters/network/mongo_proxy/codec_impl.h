@@ -19,17 +19,31 @@ public:
   MessageImpl(int32_t request_id, uint32_t response_to)
       : request_id_(request_id), response_to_(response_to) {}
 
-  virtual void fromBuffer(uint32_t message_length, Buffer::Instance& data) PURE;
+  /**
+   * Decode the body of the message.
+   * @param message_length supplies the length of the body.
+   * @param data supplies the buffer starting with the body.
+   * @param decode_documents supplies whether the BSON documents of the message are decoded, or
+   *        skipped by a lightweight decode. @see Message::documentsDecoded().
+   */
+  virtual void fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                          bool decode_documents) PURE;
 
   // Mongo::Message
   int32_t requestId() const override { return request_id_; }
   int32_t responseTo() const override { return response_to_; }
+  bool documentsDecoded() const override { return documents_decoded_; }
 
 protected:
   std::string documentListToString(const std::list<Bson::DocumentSharedPtr>& documents) const;
 
+  // Skip the documents up to the end of a message body of which remaining_length bytes are left.
+  void skipDocuments(uint64_t remaining_length, Buffer::Instance& data);
+
   const int32_t request_id_;
   const int32_t response_to_;
+  bool documents_decoded_{true};
+  uint32_t skipped_documents_{};
 };
 
 class GetMoreMessageImpl : public MessageImpl,
@@ -39,7 +53,8 @@ public:
   using MessageImpl::MessageImpl;
 
   // MessageImpl
-  void fromBuffer(uint32_t message_length, Buffer::Instance& data) override;
+  void fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                  bool decode_documents) override;
 
   // Mongo::Message
   std::string toString(bool full) const override;
@@ -66,7 +81,8 @@ public:
   using MessageImpl::MessageImpl;
 
   // MessageImpl
-  void fromBuffer(uint32_t message_length, Buffer::Instance& data) override;
+  void fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                  bool decode_documents) override;
 
   // Mongo::Message
   std::string toString(bool full) const override;
@@ -93,7 +109,8 @@ public:
   using MessageImpl::MessageImpl;
 
   // MessageImpl
-  void fromBuffer(uint32_t message_length, Buffer::Instance& data) override;
+  void fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                  bool decode_documents) override;
 
   // Mongo::Message
   std::string toString(bool full) const override;
@@ -121,7 +138,8 @@ public:
   using MessageImpl::MessageImpl;
 
   // MessageImpl
-  void fromBuffer(uint32_t message_length, Buffer::Instance& data) override;
+  void fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                  bool decode_documents) override;
 
   // Mongo::Message
   std::string toString(bool full) const override;
@@ -161,7 +179,8 @@ public:
   using MessageImpl::MessageImpl;
 
   // MessageImpl
-  void fromBuffer(uint32_t message_length, Buffer::Instance& data) override;
+  void fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                  bool decode_documents) override;
 
   // Mongo::Message
   std::string toString(bool full) const override;
@@ -178,6 +197,7 @@ public:
   void numberReturned(int32_t number_returned) override { number_returned_ = number_returned; }
   const std::list<Bson::DocumentSharedPtr>& documents() const override { return documents_; }
   std::list<Bson::DocumentSharedPtr>& documents() override { return documents_; }
+  uint64_t documentsByteSize() const override;
 
 private:
   int32_t flags_{};
@@ -185,6 +205,7 @@ private:
   int32_t starting_from_{};
   int32_t number_returned_{};
   std::list<Bson::DocumentSharedPtr> documents_;
+  uint64_t skipped_documents_byte_size_{};
 };
 
 // OP_COMMAND message.
@@ -195,7 +216,8 @@ public:
   using MessageImpl::MessageImpl;
 
   // MessageImpl.
-  void fromBuffer(uint32_t message_length, Buffer::Instance& data) override;
+  void fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                  bool decode_documents) override;
   std::string toString(bool full) const override;
 
   // CommandMessageImpl accessors.
@@ -229,7 +251,8 @@ public:
   using MessageImpl::MessageImpl;
 
   // MessageImpl.
-  void fromBuffer(uint32_t message_length, Buffer::Instance& data) override;
+  void fromBuffer(uint32_t message_length, Buffer::Instance& data,
+                  bool decode_documents) override;
   std::string toString(bool full) const override;
 
   // CommandMessageReplyImpl accessors.
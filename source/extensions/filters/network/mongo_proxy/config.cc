@@ -33,11 +33,23 @@ Network::FilterFactoryCb MongoProxyFilterConfigFactory::createFilterFactoryFromP
   }
 
   const bool emit_dynamic_metadata = proto_config.emit_dynamic_metadata();
-  return [stat_prefix, &context, access_log, fault_config,
-          emit_dynamic_metadata](Network::FilterManager& filter_manager) -> void {
+  const bool lightweight_decode = proto_config.lightweight_decode();
+  const envoy::type::FractionalPercent full_decode_percent = proto_config.full_decode_percent();
+  envoy::type::FractionalPercent query_stats_percent;
+  if (proto_config.has_query_stats_percent()) {
+    query_stats_percent = proto_config.query_stats_percent();
+  } else {
+    query_stats_percent.set_numerator(100);
+    query_stats_percent.set_denominator(envoy::type::FractionalPercent::HUNDRED);
+  }
+
+  return [stat_prefix, &context, access_log, fault_config, emit_dynamic_metadata,
+          lightweight_decode, full_decode_percent,
+          query_stats_percent](Network::FilterManager& filter_manager) -> void {
     filter_manager.addFilter(std::make_shared<ProdProxyFilter>(
         stat_prefix, context.scope(), context.runtime(), access_log, fault_config,
-        context.drainDecision(), context.dispatcher().timeSource(), emit_dynamic_metadata));
+        context.drainDecision(), context.dispatcher().timeSource(), emit_dynamic_metadata,
+        lightweight_decode, full_decode_percent, query_stats_percent));
   };
 }
 
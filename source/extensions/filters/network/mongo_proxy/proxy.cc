@@ -58,11 +58,14 @@ ProxyFilter::ProxyFilter(const std::string& stat_prefix, Stats::Scope& scope,
                          Runtime::Loader& runtime, AccessLogSharedPtr access_log,
                          const Filters::Common::Fault::FaultDelayConfigSharedPtr& fault_config,
                          const Network::DrainDecision& drain_decision, TimeSource& time_source,
-                         bool emit_dynamic_metadata)
+                         bool emit_dynamic_metadata, bool lightweight_decode,
+                         const envoy::type::FractionalPercent& full_decode_percent,
+                         const envoy::type::FractionalPercent& query_stats_percent)
     : stat_prefix_(stat_prefix), scope_(scope), stats_(generateStats(stat_prefix, scope)),
       runtime_(runtime), drain_decision_(drain_decision), access_log_(access_log),
       fault_config_(fault_config), time_source_(time_source),
-      emit_dynamic_metadata_(emit_dynamic_metadata) {
+      emit_dynamic_metadata_(emit_dynamic_metadata), lightweight_decode_(lightweight_decode),
+      full_decode_percent_(full_decode_percent), query_stats_percent_(query_stats_percent) {
   if (!runtime_.snapshot().featureEnabled(MongoRuntimeConfig::get().ConnectionLoggingEnabled,
                                           100)) {
     // If we are not logging at the connection level, just release the shared pointer so that we
@@ -143,33 +146,43 @@ void ProxyFilter::decodeQuery(QueryMessagePtr&& message) {
   }
 
   ActiveQueryPtr active_query(new ActiveQuery(*this, *message));
+  active_query->charge_stats_ = runtime_.snapshot().featureEnabled(
+      MongoRuntimeConfig::get().QueryStatsPercent, query_stats_percent_);
   if (!active_query->query_info_.command().empty()) {
     // First field key is the operation.
-    scope_.counter(fmt::format("{}cmd.{}.total", stat_prefix_, active_query->query_info_.command()))
-        .inc();
+    if (active_query->charge_stats_) {
+      scope_
+          .counter(
+              fmt::format("{}cmd.{}.total", stat_prefix_, active_query->query_info_.command()))
+          .inc();
+    }
   } else {
-    // Normal query, get stats on a per collection basis first.
-    std::string collection_stat_prefix =
-        fmt::format("{}collection.{}", stat_prefix_, active_query->query_info_.collection());
     QueryMessageInfo::QueryType query_type = active_query->query_info_.type();
-    chargeQueryStats(collection_stat_prefix, query_type);
-
-    // Callsite stats if we have it.
-    if (!active_query->query_info_.callsite().empty()) {
-      std::string callsite_stat_prefix =
-          fmt::format("{}collection.{}.callsite.{}", stat_prefix_,
-                      active_query->query_info_.collection(), active_query->query_info_.callsite());
-      chargeQueryStats(callsite_stat_prefix, query_type);
-    }
+    if (active_query->charge_stats_) {
+      // Normal query, get stats on a per collection basis first.
+      std::string collection_stat_prefix =
+          fmt::format("{}collection.{}", stat_prefix_, active_query->query_info_.collection());
+      chargeQueryStats(collection_stat_prefix, query_type, message->documentsDecoded());
 
-    // Global stats.
-    if (active_query->query_info_.max_time() < 1) {
-      stats_.op_query_no_max_time_.inc();
+      // Callsite stats if we have it.
+      if (!active_query->query_info_.callsite().empty()) {
+        std::string callsite_stat_prefix = fmt::format(
+            "{}collection.{}.callsite.{}", stat_prefix_, active_query->query_info_.collection(),
+            active_query->query_info_.callsite());
+        chargeQueryStats(callsite_stat_prefix, query_type, message->documentsDecoded());
+      }
     }
-    if (query_type == QueryMessageInfo::QueryType::ScatterGet) {
-      stats_.op_query_scatter_get_.inc();
-    } else if (query_type == QueryMessageInfo::QueryType::MultiGet) {
-      stats_.op_query_multi_get_.inc();
+
+    // Global stats, which need the query document skipped by a lightweight decode.
+    if (message->documentsDecoded()) {
+      if (active_query->query_info_.max_time() < 1) {
+        stats_.op_query_no_max_time_.inc();
+      }
+      if (query_type == QueryMessageInfo::QueryType::ScatterGet) {
+        stats_.op_query_scatter_get_.inc();
+      } else if (query_type == QueryMessageInfo::QueryType::MultiGet) {
+        stats_.op_query_multi_get_.inc();
+      }
     }
   }
 
@@ -177,8 +190,13 @@ void ProxyFilter::decodeQuery(QueryMessagePtr&& message) {
 }
 
 void ProxyFilter::chargeQueryStats(const std::string& prefix,
-                                   QueryMessageInfo::QueryType query_type) {
+                                   QueryMessageInfo::QueryType query_type,
+                                   bool documents_decoded) {
   scope_.counter(fmt::format("{}.query.total", prefix)).inc();
+  if (!documents_decoded) {
+    return;
+  }
+
   if (query_type == QueryMessageInfo::QueryType::ScatterGet) {
     scope_.counter(fmt::format("{}.query.scatter_get", prefix)).inc();
   } else if (query_type == QueryMessageInfo::QueryType::MultiGet) {
@@ -207,6 +225,12 @@ void ProxyFilter::decodeReply(ReplyMessagePtr&& message) {
       continue;
     }
 
+    if (!active_query.charge_stats_) {
+      // The query wasn't sampled for the per command, collection and callsite stats.
+      active_query_list_.erase(i);
+      break;
+    }
+
     if (!active_query.query_info_.command().empty()) {
       std::string stat_prefix =
           fmt::format("{}cmd.{}", stat_prefix_, active_query.query_info_.command());
@@ -266,20 +290,24 @@ void ProxyFilter::decodeCommandReply(CommandReplyMessagePtr&& message) {
   ENVOY_LOG(debug, "decoded COMMANDREPLY: {}", message->toString(true));
 }
 
+bool ProxyFilter::decodeDocuments() {
+  return !lightweight_decode_ ||
+         runtime_.snapshot().featureEnabled(MongoRuntimeConfig::get().FullDecodePercent,
+                                            full_decode_percent_);
+}
+
 void ProxyFilter::onDrainClose() {
   read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
 }
 
 void ProxyFilter::chargeReplyStats(ActiveQuery& active_query, const std::string& prefix,
                                    const ReplyMessage& message) {
-  uint64_t reply_documents_byte_size = 0;
-  for (const Bson::DocumentSharedPtr& document : message.documents()) {
-    reply_documents_byte_size += document->byteSize();
-  }
+  // A lightweight decode skips the documents, but their number and size are still known.
+  const uint64_t reply_num_docs =
+      message.documentsDecoded() ? message.documents().size() : message.numberReturned();
 
-  scope_.histogram(fmt::format("{}.reply_num_docs", prefix))
-      .recordValue(message.documents().size());
-  scope_.histogram(fmt::format("{}.reply_size", prefix)).recordValue(reply_documents_byte_size);
+  scope_.histogram(fmt::format("{}.reply_num_docs", prefix)).recordValue(reply_num_docs);
+  scope_.histogram(fmt::format("{}.reply_size", prefix)).recordValue(message.documentsByteSize());
   scope_.histogram(fmt::format("{}.reply_time_ms", prefix))
       .recordValue(std::chrono::duration_cast<std::chrono::milliseconds>(
                        time_source_.monotonicTime() - active_query.start_time_)
@@ -16,6 +16,7 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
+#include "envoy/type/percent.pb.h"
 
 #include "common/buffer/buffer_impl.h"
 #include "common/common/logger.h"
@@ -40,6 +41,8 @@ public:
   const std::string ProxyEnabled{"mongo.proxy_enabled"};
   const std::string ConnectionLoggingEnabled{"mongo.connection_logging_enabled"};
   const std::string DrainCloseEnabled{"mongo.drain_close_enabled"};
+  const std::string FullDecodePercent{"mongo.full_decode_percent"};
+  const std::string QueryStatsPercent{"mongo.query_stats_percent"};
 };
 
 typedef ConstSingleton<MongoRuntimeConfigKeys> MongoRuntimeConfig;
@@ -112,7 +115,9 @@ public:
               AccessLogSharedPtr access_log,
               const Filters::Common::Fault::FaultDelayConfigSharedPtr& fault_config,
               const Network::DrainDecision& drain_decision, TimeSource& time_system,
-              bool emit_dynamic_metadata);
+              bool emit_dynamic_metadata, bool lightweight_decode,
+              const envoy::type::FractionalPercent& full_decode_percent,
+              const envoy::type::FractionalPercent& query_stats_percent);
   ~ProxyFilter();
 
   virtual DecoderPtr createDecoder(DecoderCallbacks& callbacks) PURE;
@@ -136,6 +141,7 @@ public:
   void decodeReply(ReplyMessagePtr&& message) override;
   void decodeCommand(CommandMessagePtr&& message) override;
   void decodeCommandReply(CommandReplyMessagePtr&& message) override;
+  bool decodeDocuments() override;
 
   // Network::ConnectionCallbacks
   void onEvent(Network::ConnectionEvent event) override;
@@ -156,6 +162,9 @@ private:
     ProxyFilter& parent_;
     QueryMessageInfo query_info_;
     MonotonicTime start_time_;
+    // Whether the query and its reply are charged to the per command, collection and callsite
+    // stats.
+    bool charge_stats_{true};
   };
 
   typedef std::unique_ptr<ActiveQuery> ActiveQueryPtr;
@@ -166,7 +175,8 @@ private:
                                                  POOL_HISTOGRAM_PREFIX(scope, prefix))};
   }
 
-  void chargeQueryStats(const std::string& prefix, QueryMessageInfo::QueryType query_type);
+  void chargeQueryStats(const std::string& prefix, QueryMessageInfo::QueryType query_type,
+                        bool documents_decoded);
   void chargeReplyStats(ActiveQuery& active_query, const std::string& prefix,
                         const ReplyMessage& message);
   void doDecode(Buffer::Instance& buffer);
@@ -193,6 +203,9 @@ private:
   Event::TimerPtr drain_close_timer_;
   TimeSource& time_source_;
   const bool emit_dynamic_metadata_;
+  const bool lightweight_decode_;
+  const envoy::type::FractionalPercent full_decode_percent_;
+  const envoy::type::FractionalPercent query_stats_percent_;
 };
 
 class ProdProxyFilter : public ProxyFilter {
@@ -29,6 +29,11 @@ QueryMessageInfo::QueryMessageInfo(const QueryMessage& query)
 
   // Standard query.
   collection_ = parseCollection(query.fullCollectionName());
+  if (!query.documentsDecoded()) {
+    // Only the first field of the query was decoded in lightweight mode.
+    return;
+  }
+
   callsite_ = parseCallingFunction(query);
   max_time_ = parseMaxTime(query);
   type_ = parseType(query);
@@ -33,17 +33,19 @@ public:
    *         1) Looking for a top level query field name $comment
    *         2) Parsing $comment as a JSON string
    *         3) Accessing the 'callingFunction' field in the JSON.
-   *         "" is returned if any of the above fails.
+   *         "" is returned if any of the above fails, or if the query was decoded in lightweight
+   *         mode.
    */
   const std::string& callsite() { return callsite_; }
 
   /**
-   * @return the value of maxTimeMS or 0 if not given.
+   * @return the value of maxTimeMS or 0 if not given, or if the query was decoded in lightweight
+   *         mode.
    */
   int32_t max_time() { return max_time_; }
 
   /**
-   * @return the type of a query message.
+   * @return the type of a query message. The type is only known if the query was fully decoded.
    */
   QueryType type() { return type_; }
 
@@ -27,8 +27,16 @@ NetworkFilters::MySQLProxy::MySQLConfigFactory::createFilterFactoryFromProtoType
 
   const std::string stat_prefix = fmt::format("mysql.{}.", proto_config.stat_prefix());
 
-  MySQLFilterConfigSharedPtr filter_config(
-      std::make_shared<MySQLFilterConfig>(stat_prefix, context.scope()));
+  envoy::type::FractionalPercent query_parse_percent;
+  if (proto_config.has_query_parse_percent()) {
+    query_parse_percent = proto_config.query_parse_percent();
+  } else {
+    query_parse_percent.set_numerator(100);
+    query_parse_percent.set_denominator(envoy::type::FractionalPercent::HUNDRED);
+  }
+
+  MySQLFilterConfigSharedPtr filter_config(std::make_shared<MySQLFilterConfig>(
+      stat_prefix, context.scope(), context.runtime(), query_parse_percent));
   return [filter_config](Network::FilterManager& filter_manager) -> void {
     filter_manager.addFilter(std::make_shared<MySQLFilter>(filter_config));
   };
@@ -13,8 +13,11 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace MySQLProxy {
 
-MySQLFilterConfig::MySQLFilterConfig(const std::string& stat_prefix, Stats::Scope& scope)
-    : scope_(scope), stat_prefix_(stat_prefix), stats_(generateStats(stat_prefix, scope)) {}
+MySQLFilterConfig::MySQLFilterConfig(const std::string& stat_prefix, Stats::Scope& scope,
+                                     Runtime::Loader& runtime,
+                                     const envoy::type::FractionalPercent& query_parse_percent)
+    : scope_(scope), stat_prefix_(stat_prefix), stats_(generateStats(stat_prefix, scope)),
+      runtime_(runtime), query_parse_percent_(query_parse_percent) {}
 
 MySQLFilter::MySQLFilter(MySQLFilterConfigSharedPtr config) : config_(std::move(config)) {}
 
@@ -96,6 +99,10 @@ void MySQLFilter::onCommand(Command& command) {
   if (!command.isQuery()) {
     return;
   }
+  if (!config_->shouldParseQuery()) {
+    config_->stats_.queries_parse_skipped_.inc();
+    return;
+  }
 
   // Parse a given query
   hsql::SQLParserResult result;
@@ -110,12 +117,12 @@ void MySQLFilter::onCommand(Command& command) {
   }
   config_->stats_.queries_parsed_.inc();
 
-  // Set dynamic metadata
+  // Set dynamic metadata in place, rather than merging a copy of it back into the stream info.
   envoy::api::v2::core::Metadata& dynamic_metadata =
       read_callbacks_->connection().streamInfo().dynamicMetadata();
-  ProtobufWkt::Struct metadata(
-      (*dynamic_metadata.mutable_filter_metadata())[NetworkFilterNames::get().MySQLProxy]);
-  auto& fields = *metadata.mutable_fields();
+  auto& fields =
+      *(*dynamic_metadata.mutable_filter_metadata())[NetworkFilterNames::get().MySQLProxy]
+           .mutable_fields();
 
   for (auto i = 0u; i < result.size(); ++i) {
     if (result.getStatement(i)->type() == hsql::StatementType::kStmtShow) {
@@ -130,9 +137,6 @@ void MySQLFilter::onCommand(Command& command) {
       }
     }
   }
-
-  read_callbacks_->connection().streamInfo().setDynamicMetadata(
-      NetworkFilterNames::get().MySQLProxy, metadata);
 }
 
 Network::FilterStatus MySQLFilter::onNewConnection() {
@@ -3,11 +3,14 @@
 #include "envoy/access_log/access_log.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/filter.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats.h"
 #include "envoy/stats/stats_macros.h"
+#include "envoy/type/percent.pb.h"
 
 #include "common/common/logger.h"
+#include "common/singleton/const_singleton.h"
 
 #include "extensions/filters/network/mysql_proxy/mysql_codec.h"
 #include "extensions/filters/network/mysql_proxy/mysql_codec_clogin.h"
@@ -23,6 +26,13 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace MySQLProxy {
 
+class MySQLRuntimeConfigKeys {
+public:
+  const std::string QueryParsePercent{"mysql.query_parse_percent"};
+};
+
+typedef ConstSingleton<MySQLRuntimeConfigKeys> MySQLRuntimeConfig;
+
 /**
  * All MySQL proxy stats. @see stats_macros.h
  */
@@ -37,6 +47,7 @@ namespace MySQLProxy {
   COUNTER(auth_switch_request)                                                   \
   COUNTER(queries_parsed)                                                        \
   COUNTER(queries_parse_error)                                                   \
+  COUNTER(queries_parse_skipped)                                                 \
 // clang-format on
 
 /**
@@ -51,13 +62,24 @@ struct MySQLProxyStats {
  */
 class MySQLFilterConfig {
 public:
-  MySQLFilterConfig(const std::string &stat_prefix, Stats::Scope& scope);
+  MySQLFilterConfig(const std::string& stat_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
+                    const envoy::type::FractionalPercent& query_parse_percent);
 
   const MySQLProxyStats& stats() { return stats_; }
 
+  /**
+   * @return bool whether the SQL of a query is parsed, which is sampled by the query parse percent.
+   */
+  bool shouldParseQuery() const {
+    return runtime_.snapshot().featureEnabled(MySQLRuntimeConfig::get().QueryParsePercent,
+                                              query_parse_percent_);
+  }
+
   Stats::Scope& scope_;
   const std::string stat_prefix_;
   MySQLProxyStats stats_;
+  Runtime::Loader& runtime_;
+  const envoy::type::FractionalPercent query_parse_percent_;
 
 private:
   MySQLProxyStats generateStats(const std::string& prefix,
@@ -122,19 +122,20 @@ int BufferHelper::peekString(Buffer::Instance& buffer, uint64_t& offset, std::st
   if (static_cast<int>(buffer.length()) < (index + 1)) {
     return MYSQL_FAILURE;
   }
-  str.assign(std::string(static_cast<char*>(buffer.linearize(index)), index));
-  str = str.substr(offset);
+  // Copy the string out of the slices it spans rather than linearizing the buffer up to it.
+  str.resize(index - offset);
+  buffer.copyOut(offset, index - offset, &str[0]);
   offset = index + 1;
   return MYSQL_SUCCESS;
 }
 
 int BufferHelper::peekStringBySize(Buffer::Instance& buffer, uint64_t& offset, int len,
                                    std::string& str) {
-  if (buffer.length() < (offset + len)) {
+  if (len < 0 || buffer.length() < (offset + len)) {
     return MYSQL_FAILURE;
   }
-  str.assign(std::string(static_cast<char*>(buffer.linearize(len + offset)), len + offset));
-  str = str.substr(offset);
+  str.resize(len);
+  buffer.copyOut(offset, len, &str[0]);
   offset += len;
   return MYSQL_SUCCESS;
 }
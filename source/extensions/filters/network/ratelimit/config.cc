@@ -9,6 +9,7 @@
 #include "common/config/filter_json.h"
 #include "common/protobuf/utility.h"
 
+#include "extensions/filters/common/ratelimit/local_ratelimit_impl.h"
 #include "extensions/filters/common/ratelimit/ratelimit_impl.h"
 #include "extensions/filters/network/ratelimit/ratelimit.h"
 
@@ -25,17 +26,40 @@ Network::FilterFactoryCb RateLimitConfigFactory::createFilterFactoryFromProtoTyp
   ASSERT(!proto_config.domain().empty());
   ASSERT(proto_config.descriptors_size() > 0);
 
+  if (!proto_config.has_rate_limit_service() && !proto_config.has_local_rate_limit()) {
+    throw EnvoyException("rate limit filter: rate_limit_service or local_rate_limit must be set");
+  }
+
   ConfigSharedPtr filter_config(new Config(proto_config, context.scope(), context.runtime()));
   const std::chrono::milliseconds timeout =
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, timeout, 20));
+  Filters::Common::RateLimit::LocalRateLimiterSharedPtr local_limiter;
+  if (proto_config.has_local_rate_limit()) {
+    local_limiter = std::make_shared<Filters::Common::RateLimit::LocalRateLimiter>(
+        proto_config.local_rate_limit(), context.timeSource(),
+        fmt::format("ratelimit.{}.local_ratelimit.", proto_config.stat_prefix()), context.scope());
+  }
+  const Filters::Common::RateLimit::AggregatorSharedPtr aggregator =
+      Filters::Common::RateLimit::rateLimitAggregator(
+          context, proto_config.rate_limit_service(), timeout,
+          fmt::format("ratelimit.{}.aggregation.", proto_config.stat_prefix()));
 
-  return [proto_config, &context, timeout,
-          filter_config](Network::FilterManager& filter_manager) -> void {
-    filter_manager.addReadFilter(std::make_shared<Filter>(
-        filter_config,
-
-        Filters::Common::RateLimit::rateLimitClient(
-            context, proto_config.rate_limit_service().grpc_service(), timeout)));
+  return [proto_config, &context, timeout, filter_config, local_limiter,
+          aggregator](Network::FilterManager& filter_manager) -> void {
+    Filters::Common::RateLimit::ClientPtr client;
+    if (proto_config.has_rate_limit_service()) {
+      client = Filters::Common::RateLimit::rateLimitClient(
+          context, proto_config.rate_limit_service().grpc_service(), timeout);
+    }
+    if (aggregator != nullptr) {
+      client = std::make_unique<Filters::Common::RateLimit::AggregatingClientImpl>(
+          aggregator, std::move(client));
+    }
+    if (local_limiter != nullptr) {
+      client = std::make_unique<Filters::Common::RateLimit::LocalClientImpl>(local_limiter,
+                                                                            std::move(client));
+    }
+    filter_manager.addReadFilter(std::make_shared<Filter>(filter_config, std::move(client)));
   };
 }
 
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "extensions/filters/network/common/redis/codec.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+class ClusterSlotMap;
+typedef std::unique_ptr<ClusterSlotMap> ClusterSlotMapPtr;
+
+/**
+ * The nodes that own the hash slots of a Redis Cluster, as reported by CLUSTER SLOTS. See
+ * https://redis.io/topics/cluster-spec#keys-distribution-model
+ */
+class ClusterSlotMap {
+public:
+  /**
+   * The primary and the replicas serving a range of slots, by "address:port".
+   */
+  struct Shard {
+    std::string primary_;
+    std::vector<std::string> replicas_;
+  };
+
+  static constexpr uint16_t SlotCount = 16384;
+
+  /**
+   * Parse the response of a CLUSTER SLOTS command.
+   * @param response supplies the response.
+   * @return ClusterSlotMapPtr the slot map, or nullptr if the response is malformed.
+   */
+  static ClusterSlotMapPtr create(const Common::Redis::RespValue& response);
+
+  /**
+   * @param key supplies a key.
+   * @return absl::string_view the hash tag of the key if it has one, or the whole key. See
+   *         https://redis.io/topics/cluster-spec#keys-hash-tags
+   */
+  static absl::string_view hashtag(absl::string_view key);
+
+  /**
+   * @param key supplies a key.
+   * @return uint16_t the slot of the key, which is the CRC16 of its hash tag.
+   */
+  static uint16_t keySlot(absl::string_view key);
+
+  /**
+   * @param slot supplies a slot.
+   * @return const Shard* the shard serving the slot, or nullptr if no shard serves it.
+   */
+  const Shard* shard(uint16_t slot) const;
+
+private:
+  ClusterSlotMap() : slot_shards_(SlotCount, NoShard) {}
+
+  static constexpr uint16_t NoShard = SlotCount;
+
+  std::vector<Shard> shards_;
+  // The index in shards_ of the shard serving each slot.
+  std::vector<uint16_t> slot_shards_;
+};
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,8 +1,10 @@
 #include "extensions/filters/network/redis_proxy/command_splitter_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "envoy/stats/scope.h"
@@ -76,6 +78,33 @@ SplitRequestPtr SimpleRequest::create(Router& router,
   return std::move(request_ptr);
 }
 
+SplitRequestPtr CachedGetRequest::create(Router& router,
+                                         const Common::Redis::RespValue& incoming_request,
+                                         SplitCallbacks& callbacks, CommandStats& command_stats,
+                                         TimeSource& time_source, bool latency_in_micros,
+                                         ReadCache& read_cache, uint64_t generation) {
+  const std::string& key = incoming_request.asArray()[1].asString();
+  std::unique_ptr<CachedGetRequest> request_ptr{new CachedGetRequest(
+      callbacks, command_stats, time_source, latency_in_micros, read_cache, key, generation)};
+
+  request_ptr->handle_ = router.makeRequest(key, incoming_request, *request_ptr);
+  if (!request_ptr->handle_) {
+    request_ptr->callbacks_.onResponse(Utility::makeError(Response::get().NoUpstreamHost));
+    return nullptr;
+  }
+
+  return std::move(request_ptr);
+}
+
+void CachedGetRequest::onResponse(Common::Redis::RespValuePtr&& response) {
+  // Errors aren't cached, so that a failure of the upstream doesn't outlive it.
+  if (response->type() == Common::Redis::RespType::BulkString ||
+      response->type() == Common::Redis::RespType::Null) {
+    read_cache_.insert(key_, *response, generation_);
+  }
+  SingleServerRequest::onResponse(std::move(response));
+}
+
 SplitRequestPtr EvalRequest::create(Router& router,
                                     const Common::Redis::RespValue& incoming_request,
                                     SplitCallbacks& callbacks, CommandStats& command_stats,
@@ -123,6 +152,62 @@ void FragmentedRequest::onChildFailure(uint32_t index) {
   onChildResponse(Utility::makeError(Response::get().UpstreamFailure), index);
 }
 
+std::vector<std::vector<uint32_t>>
+FragmentedRequest::groupKeysByShard(Router& router,
+                                    const Common::Redis::RespValue& incoming_request,
+                                    uint32_t step) {
+  std::vector<std::vector<uint32_t>> fragment_keys;
+  std::unordered_map<std::string, uint32_t> shard_fragments;
+  const uint32_t key_count = (incoming_request.asArray().size() - 1) / step;
+  for (uint32_t key = 0; key < key_count; key++) {
+    const std::string shard = router.shard(incoming_request.asArray()[1 + key * step].asString());
+    auto fragment = shard_fragments.emplace(shard, fragment_keys.size());
+    if (fragment.second) {
+      fragment_keys.emplace_back();
+    }
+    fragment_keys[fragment.first->second].push_back(key);
+  }
+  return fragment_keys;
+}
+
+void FragmentedRequest::makeFragmentRequests(Router& router,
+                                             const Common::Redis::RespValue& incoming_request,
+                                             const std::string& single_key_command,
+                                             const std::string& multi_key_command,
+                                             uint32_t step) {
+  fragment_keys_ = groupKeysByShard(router, incoming_request, step);
+  num_pending_responses_ = fragment_keys_.size();
+  pending_requests_.reserve(num_pending_responses_);
+
+  for (uint32_t i = 0; i < fragment_keys_.size(); i++) {
+    const std::vector<uint32_t>& keys = fragment_keys_[i];
+    // A key alone in its shard is sent with the single key command, which all the versions of
+    // Redis support for all the commands.
+    std::vector<Common::Redis::RespValue> values(1 + keys.size() * step);
+    values[0].type(Common::Redis::RespType::BulkString);
+    values[0].asString() = keys.size() == 1 ? single_key_command : multi_key_command;
+    for (uint32_t k = 0; k < keys.size(); k++) {
+      for (uint32_t j = 0; j < step; j++) {
+        values[1 + k * step + j] = incoming_request.asArray()[1 + keys[k] * step + j];
+      }
+    }
+    Common::Redis::RespValue fragment;
+    fragment.type(Common::Redis::RespType::Array);
+    fragment.asArray().swap(values);
+
+    pending_requests_.emplace_back(*this, i);
+    PendingRequest& pending_request = pending_requests_.back();
+
+    ENVOY_LOG(debug, "redis: parallel {}: '{}'", fragment.asArray()[0].asString(),
+              fragment.toString());
+    pending_request.handle_ = router.makeRequest(fragment.asArray()[1].asString(), fragment,
+                                                 pending_request);
+    if (!pending_request.handle_) {
+      pending_request.onResponse(Utility::makeError(Response::get().NoUpstreamHost));
+    }
+  }
+}
+
 SplitRequestPtr MGETRequest::create(Router& router,
                                     const Common::Redis::RespValue& incoming_request,
                                     SplitCallbacks& callbacks, CommandStats& command_stats,
@@ -130,34 +215,14 @@ SplitRequestPtr MGETRequest::create(Router& router,
   std::unique_ptr<MGETRequest> request_ptr{
       new MGETRequest(callbacks, command_stats, time_source, latency_in_micros)};
 
-  request_ptr->num_pending_responses_ = incoming_request.asArray().size() - 1;
-  request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
-
   request_ptr->pending_response_ = std::make_unique<Common::Redis::RespValue>();
   request_ptr->pending_response_->type(Common::Redis::RespType::Array);
-  std::vector<Common::Redis::RespValue> responses(request_ptr->num_pending_responses_);
+  std::vector<Common::Redis::RespValue> responses(incoming_request.asArray().size() - 1);
   request_ptr->pending_response_->asArray().swap(responses);
 
-  std::vector<Common::Redis::RespValue> values(2);
-  values[0].type(Common::Redis::RespType::BulkString);
-  values[0].asString() = "get";
-  values[1].type(Common::Redis::RespType::BulkString);
-  Common::Redis::RespValue single_mget;
-  single_mget.type(Common::Redis::RespType::Array);
-  single_mget.asArray().swap(values);
-
-  for (uint64_t i = 1; i < incoming_request.asArray().size(); i++) {
-    request_ptr->pending_requests_.emplace_back(*request_ptr, i - 1);
-    PendingRequest& pending_request = request_ptr->pending_requests_.back();
-
-    single_mget.asArray()[1].asString() = incoming_request.asArray()[i].asString();
-    ENVOY_LOG(debug, "redis: parallel get: '{}'", single_mget.toString());
-    pending_request.handle_ =
-        router.makeRequest(incoming_request.asArray()[i].asString(), single_mget, pending_request);
-    if (!pending_request.handle_) {
-      pending_request.onResponse(Utility::makeError(Response::get().NoUpstreamHost));
-    }
-  }
+  request_ptr->makeFragmentRequests(router, incoming_request,
+                                    Common::Redis::SupportedCommands::get(),
+                                    Common::Redis::SupportedCommands::mget(), 1);
 
   return request_ptr->num_pending_responses_ > 0 ? std::move(request_ptr) : nullptr;
 }
@@ -165,13 +230,43 @@ SplitRequestPtr MGETRequest::create(Router& router,
 void MGETRequest::onChildResponse(Common::Redis::RespValuePtr&& value, uint32_t index) {
   pending_requests_[index].handle_ = nullptr;
 
-  pending_response_->asArray()[index].type(value->type());
-  switch (value->type()) {
+  const std::vector<uint32_t>& keys = fragment_keys_[index];
+  if (keys.size() == 1) {
+    onKeyResponse(*value, keys[0]);
+  } else if (value->type() == Common::Redis::RespType::Array &&
+             value->asArray().size() == keys.size()) {
+    for (uint32_t i = 0; i < keys.size(); i++) {
+      onKeyResponse(value->asArray()[i], keys[i]);
+    }
+  } else {
+    // The error of a fragment, like a failure of its upstream, is the response of all its keys.
+    for (uint32_t key : keys) {
+      Common::Redis::RespValue& key_response = pending_response_->asArray()[key];
+      key_response.type(Common::Redis::RespType::Error);
+      key_response.asString() = value->type() == Common::Redis::RespType::Error
+                                    ? value->asString()
+                                    : Response::get().UpstreamProtocolError;
+      error_count_++;
+    }
+  }
+
+  ASSERT(num_pending_responses_ > 0);
+  if (--num_pending_responses_ == 0) {
+    updateStats(error_count_ == 0);
+    ENVOY_LOG(debug, "redis: response: '{}'", pending_response_->toString());
+    callbacks_.onResponse(std::move(pending_response_));
+  }
+}
+
+void MGETRequest::onKeyResponse(Common::Redis::RespValue& value, uint32_t key) {
+  Common::Redis::RespValue& key_response = pending_response_->asArray()[key];
+  key_response.type(value.type());
+  switch (value.type()) {
   case Common::Redis::RespType::Array:
   case Common::Redis::RespType::Integer:
   case Common::Redis::RespType::SimpleString: {
-    pending_response_->asArray()[index].type(Common::Redis::RespType::Error);
-    pending_response_->asArray()[index].asString() = Response::get().UpstreamProtocolError;
+    key_response.type(Common::Redis::RespType::Error);
+    key_response.asString() = Response::get().UpstreamProtocolError;
     error_count_++;
     break;
   }
@@ -180,19 +275,12 @@ void MGETRequest::onChildResponse(Common::Redis::RespValuePtr&& value, uint32_t
     FALLTHRU;
   }
   case Common::Redis::RespType::BulkString: {
-    pending_response_->asArray()[index].asString().swap(value->asString());
+    key_response.asString().swap(value.asString());
     break;
   }
   case Common::Redis::RespType::Null:
     break;
   }
-
-  ASSERT(num_pending_responses_ > 0);
-  if (--num_pending_responses_ == 0) {
-    updateStats(error_count_ == 0);
-    ENVOY_LOG(debug, "redis: response: '{}'", pending_response_->toString());
-    callbacks_.onResponse(std::move(pending_response_));
-  }
 }
 
 SplitRequestPtr MSETRequest::create(Router& router,
@@ -207,36 +295,11 @@ SplitRequestPtr MSETRequest::create(Router& router,
   std::unique_ptr<MSETRequest> request_ptr{
       new MSETRequest(callbacks, command_stats, time_source, latency_in_micros)};
 
-  request_ptr->num_pending_responses_ = (incoming_request.asArray().size() - 1) / 2;
-  request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
-
   request_ptr->pending_response_ = std::make_unique<Common::Redis::RespValue>();
   request_ptr->pending_response_->type(Common::Redis::RespType::SimpleString);
 
-  std::vector<Common::Redis::RespValue> values(3);
-  values[0].type(Common::Redis::RespType::BulkString);
-  values[0].asString() = "set";
-  values[1].type(Common::Redis::RespType::BulkString);
-  values[2].type(Common::Redis::RespType::BulkString);
-  Common::Redis::RespValue single_mset;
-  single_mset.type(Common::Redis::RespType::Array);
-  single_mset.asArray().swap(values);
-
-  uint64_t fragment_index = 0;
-  for (uint64_t i = 1; i < incoming_request.asArray().size(); i += 2) {
-    request_ptr->pending_requests_.emplace_back(*request_ptr, fragment_index++);
-    PendingRequest& pending_request = request_ptr->pending_requests_.back();
-
-    single_mset.asArray()[1].asString() = incoming_request.asArray()[i].asString();
-    single_mset.asArray()[2].asString() = incoming_request.asArray()[i + 1].asString();
-
-    ENVOY_LOG(debug, "redis: parallel set: '{}'", single_mset.toString());
-    pending_request.handle_ =
-        router.makeRequest(incoming_request.asArray()[i].asString(), single_mset, pending_request);
-    if (!pending_request.handle_) {
-      pending_request.onResponse(Utility::makeError(Response::get().NoUpstreamHost));
-    }
-  }
+  request_ptr->makeFragmentRequests(router, incoming_request, "set",
+                                    Common::Redis::SupportedCommands::mset(), 2);
 
   return request_ptr->num_pending_responses_ > 0 ? std::move(request_ptr) : nullptr;
 }
@@ -252,7 +315,8 @@ void MSETRequest::onChildResponse(Common::Redis::RespValuePtr&& value, uint32_t
     FALLTHRU;
   }
   default: {
-    error_count_++;
+    // The errors are counted by key, like when each key is sent separately.
+    error_count_ += fragment_keys_[index].size();
     break;
   }
   }
@@ -278,33 +342,12 @@ SplitRequestPtr SplitKeysSumResultRequest::create(Router& router,
   std::unique_ptr<SplitKeysSumResultRequest> request_ptr{
       new SplitKeysSumResultRequest(callbacks, command_stats, time_source, latency_in_micros)};
 
-  request_ptr->num_pending_responses_ = incoming_request.asArray().size() - 1;
-  request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
-
   request_ptr->pending_response_ = std::make_unique<Common::Redis::RespValue>();
   request_ptr->pending_response_->type(Common::Redis::RespType::Integer);
 
-  std::vector<Common::Redis::RespValue> values(2);
-  values[0].type(Common::Redis::RespType::BulkString);
-  values[0].asString() = incoming_request.asArray()[0].asString();
-  values[1].type(Common::Redis::RespType::BulkString);
-  Common::Redis::RespValue single_fragment;
-  single_fragment.type(Common::Redis::RespType::Array);
-  single_fragment.asArray().swap(values);
-
-  for (uint64_t i = 1; i < incoming_request.asArray().size(); i++) {
-    request_ptr->pending_requests_.emplace_back(*request_ptr, i - 1);
-    PendingRequest& pending_request = request_ptr->pending_requests_.back();
-
-    single_fragment.asArray()[1].asString() = incoming_request.asArray()[i].asString();
-    ENVOY_LOG(debug, "redis: parallel {}: '{}'", incoming_request.asArray()[0].asString(),
-              single_fragment.toString());
-    pending_request.handle_ = router.makeRequest(incoming_request.asArray()[i].asString(),
-                                                 single_fragment, pending_request);
-    if (!pending_request.handle_) {
-      pending_request.onResponse(Utility::makeError(Response::get().NoUpstreamHost));
-    }
-  }
+  // The commands that sum their results take any number of keys.
+  const std::string& command = incoming_request.asArray()[0].asString();
+  request_ptr->makeFragmentRequests(router, incoming_request, command, command, 1);
 
   return request_ptr->num_pending_responses_ > 0 ? std::move(request_ptr) : nullptr;
 }
@@ -319,7 +362,7 @@ void SplitKeysSumResultRequest::onChildResponse(Common::Redis::RespValuePtr&& va
     break;
   }
   default: {
-    error_count_++;
+    error_count_ += fragment_keys_[index].size();
     break;
   }
   }
@@ -338,12 +381,14 @@ void SplitKeysSumResultRequest::onChildResponse(Common::Redis::RespValuePtr&& va
 }
 
 InstanceImpl::InstanceImpl(RouterPtr&& router, Stats::Scope& scope, const std::string& stat_prefix,
-                           TimeSource& time_source, bool latency_in_micros)
+                           TimeSource& time_source, bool latency_in_micros,
+                           ReadCachePtr&& read_cache)
     : router_(std::move(router)), simple_command_handler_(*router_),
       eval_command_handler_(*router_), mget_handler_(*router_), mset_handler_(*router_),
       split_keys_sum_result_handler_(*router_),
       stats_{ALL_COMMAND_SPLITTER_STATS(POOL_COUNTER_PREFIX(scope, stat_prefix + "splitter."))},
-      latency_in_micros_(latency_in_micros), time_source_(time_source) {
+      latency_in_micros_(latency_in_micros), time_source_(time_source),
+      read_cache_(std::move(read_cache)) {
   for (const std::string& command : Common::Redis::SupportedCommands::simpleCommands()) {
     addHandler(scope, stat_prefix, command, simple_command_handler_);
   }
@@ -402,6 +447,29 @@ SplitRequestPtr InstanceImpl::makeRequest(const Common::Redis::RespValue& reques
   }
   ENVOY_LOG(debug, "redis: splitting '{}'", request.toString());
   handler->command_stats_.total_.inc();
+
+  if (read_cache_ != nullptr) {
+    if (to_lower_string == Common::Redis::SupportedCommands::get() &&
+        request.asArray().size() == 2) {
+      Common::Redis::RespValuePtr cached_response;
+      uint64_t generation;
+      switch (read_cache_->lookup(request.asArray()[1].asString(), cached_response, generation)) {
+      case ReadCache::LookupStatus::Hit:
+        handler->command_stats_.success_.inc();
+        callbacks.onResponse(std::move(cached_response));
+        return nullptr;
+      case ReadCache::LookupStatus::Miss:
+        return CachedGetRequest::create(*router_, request, callbacks, handler->command_stats_,
+                                        time_source_, latency_in_micros_, *read_cache_,
+                                        generation);
+      case ReadCache::LookupStatus::NotCacheable:
+        break;
+      }
+    } else if (!handler->read_only_) {
+      invalidateWrittenKeys(*handler, request);
+    }
+  }
+
   SplitRequestPtr request_ptr = handler->handler_.get().startRequest(
       request, callbacks, handler->command_stats_, time_source_, latency_in_micros_);
   return request_ptr;
@@ -412,17 +480,43 @@ void InstanceImpl::onInvalidRequest(SplitCallbacks& callbacks) {
   callbacks.onResponse(Utility::makeError(Response::get().InvalidRequest));
 }
 
+void InstanceImpl::invalidateWrittenKeys(const HandlerData& handler,
+                                         const Common::Redis::RespValue& request) {
+  const std::vector<Common::Redis::RespValue>& arguments = request.asArray();
+  const CommandHandler* command_handler = &handler.handler_.get();
+  if (command_handler == &eval_command_handler_) {
+    // The arguments that follow the keys of a script are invalidated too, which is harmless.
+    for (uint64_t i = 3; i < arguments.size(); i++) {
+      read_cache_->invalidate(arguments[i].asString());
+    }
+  } else if (command_handler == &mset_handler_) {
+    for (uint64_t i = 1; i < arguments.size(); i += 2) {
+      read_cache_->invalidate(arguments[i].asString());
+    }
+  } else if (command_handler == &split_keys_sum_result_handler_) {
+    for (uint64_t i = 1; i < arguments.size(); i++) {
+      read_cache_->invalidate(arguments[i].asString());
+    }
+  } else {
+    read_cache_->invalidate(arguments[1].asString());
+  }
+}
+
 void InstanceImpl::addHandler(Stats::Scope& scope, const std::string& stat_prefix,
                               const std::string& name, CommandHandler& handler) {
   std::string to_lower_name(name);
   to_lower_table_.toLowerCase(to_lower_name);
   const std::string command_stat_prefix = fmt::format("{}command.{}.", stat_prefix, to_lower_name);
+  const std::vector<std::string>& read_only_commands =
+      Common::Redis::SupportedCommands::readOnlyCommands();
+  const bool read_only = std::find(read_only_commands.begin(), read_only_commands.end(),
+                                   to_lower_name) != read_only_commands.end();
   handler_lookup_table_.add(
       to_lower_name.c_str(),
       std::make_shared<HandlerData>(HandlerData{
           CommandStats{ALL_COMMAND_STATS(POOL_COUNTER_PREFIX(scope, command_stat_prefix),
                                          POOL_HISTOGRAM_PREFIX(scope, command_stat_prefix))},
-          handler}));
+          handler, read_only}));
 }
 
 } // namespace CommandSplitter
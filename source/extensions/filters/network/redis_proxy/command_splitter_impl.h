@@ -17,6 +17,7 @@
 #include "extensions/filters/network/common/redis/client_impl.h"
 #include "extensions/filters/network/redis_proxy/command_splitter.h"
 #include "extensions/filters/network/redis_proxy/conn_pool.h"
+#include "extensions/filters/network/redis_proxy/read_cache.h"
 #include "extensions/filters/network/redis_proxy/router.h"
 
 namespace Envoy {
@@ -132,6 +133,31 @@ private:
       : SingleServerRequest(callbacks, command_stats, time_source, latency_in_micros) {}
 };
 
+/**
+ * CachedGetRequest is a GET whose response was missing from the read cache, and is inserted in it.
+ */
+class CachedGetRequest : public SingleServerRequest {
+public:
+  static SplitRequestPtr create(Router& router, const Common::Redis::RespValue& incoming_request,
+                                SplitCallbacks& callbacks, CommandStats& command_stats,
+                                TimeSource& time_source, bool latency_in_micros,
+                                ReadCache& read_cache, uint64_t generation);
+
+  // Common::Redis::Client::PoolCallbacks
+  void onResponse(Common::Redis::RespValuePtr&& response) override;
+
+private:
+  CachedGetRequest(SplitCallbacks& callbacks, CommandStats& command_stats,
+                   TimeSource& time_source, bool latency_in_micros, ReadCache& read_cache,
+                   const std::string& key, uint64_t generation)
+      : SingleServerRequest(callbacks, command_stats, time_source, latency_in_micros),
+        read_cache_(read_cache), key_(key), generation_(generation) {}
+
+  ReadCache& read_cache_;
+  const std::string key_;
+  const uint64_t generation_;
+};
+
 /**
  * EvalRequest hashes the fourth argument as the key.
  */
@@ -148,11 +174,12 @@ private:
 };
 
 /**
- * FragmentedRequest is a base class for requests that contains multiple keys. An individual request
- * is sent to the appropriate server for each key. The responses from all servers are combined and
- * returned to the client.
+ * FragmentedRequest is a base class for requests that contains multiple keys. The keys are grouped
+ * by the server they hash to, and an individual request is sent to each server for its keys. The
+ * responses from all servers are combined and returned to the client.
  */
-class FragmentedRequest : public SplitRequestBase {
+class FragmentedRequest : public SplitRequestBase,
+                          protected Logger::Loggable<Logger::Id::redis> {
 public:
   ~FragmentedRequest();
 
@@ -178,21 +205,43 @@ protected:
     Common::Redis::Client::PoolRequest* handle_{};
   };
 
+  /**
+   * Group the keys of a command by the shard that they are routed to.
+   * @param router supplies the router of the keys.
+   * @param incoming_request supplies the command, whose keys start every step arguments.
+   * @param step supplies the number of arguments of each key, including the key.
+   * @return the indices of the keys of each shard, in the order of the first key of each shard.
+   */
+  static std::vector<std::vector<uint32_t>>
+  groupKeysByShard(Router& router, const Common::Redis::RespValue& incoming_request,
+                   uint32_t step);
+
+  /**
+   * Send a request per shard, with the single key command for the shards of a single key and the
+   * multi-key command for the others.
+   */
+  void makeFragmentRequests(Router& router, const Common::Redis::RespValue& incoming_request,
+                            const std::string& single_key_command,
+                            const std::string& multi_key_command, uint32_t step);
+
   virtual void onChildResponse(Common::Redis::RespValuePtr&& value, uint32_t index) PURE;
   void onChildFailure(uint32_t index);
 
   SplitCallbacks& callbacks_;
   Common::Redis::RespValuePtr pending_response_;
   std::vector<PendingRequest> pending_requests_;
+  // The indices of the keys of each pending request.
+  std::vector<std::vector<uint32_t>> fragment_keys_;
   uint32_t num_pending_responses_;
   uint32_t error_count_{0};
 };
 
 /**
- * MGETRequest takes each key from the command and sends a GET for each to the appropriate Redis
- * server. The response contains the result from each command.
+ * MGETRequest takes the keys from the command and sends an MGET of the keys of each Redis server,
+ * or a GET for a single key, to the appropriate Redis server. The response contains the result for
+ * each key, in the order of the command.
  */
-class MGETRequest : public FragmentedRequest, Logger::Loggable<Logger::Id::redis> {
+class MGETRequest : public FragmentedRequest {
 public:
   static SplitRequestPtr create(Router& router, const Common::Redis::RespValue& incoming_request,
                                 SplitCallbacks& callbacks, CommandStats& command_stats,
@@ -205,15 +254,17 @@ private:
 
   // RedisProxy::CommandSplitter::FragmentedRequest
   void onChildResponse(Common::Redis::RespValuePtr&& value, uint32_t index) override;
+
+  void onKeyResponse(Common::Redis::RespValue& value, uint32_t key);
 };
 
 /**
- * SplitKeysSumResultRequest takes each key from the command and sends the same incoming command
- * with each key to the appropriate Redis server. The response from each Redis (which must be an
- * integer) is summed and returned to the user. If there is any error or failure in processing the
- * fragmented commands, an error will be returned.
+ * SplitKeysSumResultRequest takes the keys from the command and sends the same incoming command
+ * with the keys of each Redis server to the appropriate Redis server. The response from each Redis
+ * (which must be an integer) is summed and returned to the user. If there is any error or failure
+ * in processing the fragmented commands, an error will be returned.
  */
-class SplitKeysSumResultRequest : public FragmentedRequest, Logger::Loggable<Logger::Id::redis> {
+class SplitKeysSumResultRequest : public FragmentedRequest {
 public:
   static SplitRequestPtr create(Router& router, const Common::Redis::RespValue& incoming_request,
                                 SplitCallbacks& callbacks, CommandStats& command_stats,
@@ -231,11 +282,11 @@ private:
 };
 
 /**
- * MSETRequest takes each key and value pair from the command and sends a SET for each to the
- * appropriate Redis server. The response is an OK if all commands succeeded or an ERR if any
- * failed.
+ * MSETRequest takes the key and value pairs from the command and sends an MSET of the pairs of each
+ * Redis server, or a SET for a single pair, to the appropriate Redis server. The response is an OK
+ * if all commands succeeded or an ERR if any failed.
  */
-class MSETRequest : public FragmentedRequest, Logger::Loggable<Logger::Id::redis> {
+class MSETRequest : public FragmentedRequest {
 public:
   static SplitRequestPtr create(Router& router, const Common::Redis::RespValue& incoming_request,
                                 SplitCallbacks& callbacks, CommandStats& command_stats,
@@ -285,7 +336,7 @@ struct InstanceStats {
 class InstanceImpl : public Instance, Logger::Loggable<Logger::Id::redis> {
 public:
   InstanceImpl(RouterPtr&& router, Stats::Scope& scope, const std::string& stat_prefix,
-               TimeSource& time_source, bool latency_in_micros);
+               TimeSource& time_source, bool latency_in_micros, ReadCachePtr&& read_cache);
 
   // RedisProxy::CommandSplitter::Instance
   SplitRequestPtr makeRequest(const Common::Redis::RespValue& request,
@@ -295,6 +346,7 @@ private:
   struct HandlerData {
     CommandStats command_stats_;
     std::reference_wrapper<CommandHandler> handler_;
+    const bool read_only_;
   };
 
   typedef std::shared_ptr<HandlerData> HandlerDataPtr;
@@ -302,6 +354,7 @@ private:
   void addHandler(Stats::Scope& scope, const std::string& stat_prefix, const std::string& name,
                   CommandHandler& handler);
   void onInvalidRequest(SplitCallbacks& callbacks);
+  void invalidateWrittenKeys(const HandlerData& handler, const Common::Redis::RespValue& request);
 
   RouterPtr router_;
   CommandHandlerFactory<SimpleRequest> simple_command_handler_;
@@ -314,6 +367,7 @@ private:
   const ToLowerTable to_lower_table_;
   const bool latency_in_micros_;
   TimeSource& time_source_;
+  ReadCachePtr read_cache_;
 };
 
 } // namespace CommandSplitter
@@ -12,6 +12,7 @@
 #include "extensions/filters/network/common/redis/codec_impl.h"
 #include "extensions/filters/network/redis_proxy/command_splitter_impl.h"
 #include "extensions/filters/network/redis_proxy/proxy_filter.h"
+#include "extensions/filters/network/redis_proxy/read_cache.h"
 #include "extensions/filters/network/redis_proxy/router_impl.h"
 
 namespace Envoy {
@@ -57,10 +58,17 @@ Network::FilterFactoryCb RedisProxyFilterConfigFactory::createFilterFactoryFromP
 
   auto router = std::make_unique<PrefixRoutes>(prefix_routes, std::move(upstreams));
 
+  ReadCachePtr read_cache;
+  if (proto_config.has_read_cache()) {
+    read_cache = std::make_unique<ReadCache>(proto_config.read_cache(), context.threadLocal(),
+                                             context.scope(), filter_config->stat_prefix_,
+                                             context.timeSource());
+  }
+
   std::shared_ptr<CommandSplitter::Instance> splitter =
       std::make_shared<CommandSplitter::InstanceImpl>(
           std::move(router), context.scope(), filter_config->stat_prefix_, context.timeSource(),
-          proto_config.latency_in_micros());
+          proto_config.latency_in_micros(), std::move(read_cache));
   return [splitter, filter_config](Network::FilterManager& filter_manager) -> void {
     Common::Redis::DecoderFactoryImpl factory;
     filter_manager.addReadFilter(std::make_shared<ProxyFilter>(
@@ -34,6 +34,15 @@ public:
   virtual Common::Redis::Client::PoolRequest*
   makeRequest(const std::string& hash_key, const Common::Redis::RespValue& request,
               Common::Redis::Client::PoolCallbacks& callbacks) PURE;
+
+  /**
+   * Identifies the shard that the requests of a key are sent to, so that the keys of a multi-key
+   * command can be grouped into one request per shard.
+   * @param hash_key supplies the key to use for consistent hashing.
+   * @return std::string an identifier that is the same for the keys that can be sent in one
+   *         request, or an empty string if the key has no upstream host.
+   */
+  virtual std::string shard(const std::string& hash_key) PURE;
 };
 
 typedef std::shared_ptr<Instance> InstanceSharedPtr;
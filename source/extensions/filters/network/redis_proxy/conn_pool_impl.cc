@@ -3,9 +3,19 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/macros.h"
+#include "common/network/utility.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "extensions/filters/network/common/redis/supported_commands.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -13,11 +23,43 @@ namespace NetworkFilters {
 namespace RedisProxy {
 namespace ConnPool {
 
+namespace {
+
+// The commands that only read, which are sent to the replicas when reading from them is enabled.
+const std::unordered_set<std::string>& readOnlyCommands() {
+  CONSTRUCT_ON_FIRST_USE(std::unordered_set<std::string>,
+                         Common::Redis::SupportedCommands::readOnlyCommands().begin(),
+                         Common::Redis::SupportedCommands::readOnlyCommands().end());
+}
+
+Common::Redis::RespValue makeCommand(const std::vector<std::string>& arguments) {
+  std::vector<Common::Redis::RespValue> values(arguments.size());
+  for (uint64_t i = 0; i < arguments.size(); i++) {
+    values[i].type(Common::Redis::RespType::BulkString);
+    values[i].asString() = arguments[i];
+  }
+
+  Common::Redis::RespValue command;
+  command.type(Common::Redis::RespType::Array);
+  command.asArray().swap(values);
+  return command;
+}
+
+} // namespace
+
+constexpr uint32_t InstanceImpl::MaxRedirections;
+
 InstanceImpl::InstanceImpl(
     const std::string& cluster_name, Upstream::ClusterManager& cm,
     Common::Redis::Client::ClientFactory& client_factory, ThreadLocal::SlotAllocator& tls,
     const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings& config)
-    : cm_(cm), client_factory_(client_factory), tls_(tls.allocateSlot()), config_(config) {
+    : cm_(cm), client_factory_(client_factory), tls_(tls.allocateSlot()), config_(config),
+      redis_cluster_(config.has_redis_cluster()),
+      refresh_interval_(
+          PROTOBUF_GET_MS_OR_DEFAULT(config.redis_cluster(), refresh_interval, 60000)),
+      redirect_refresh_threshold_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.redis_cluster(), redirect_refresh_threshold, 5)),
+      read_from_replicas_(config.redis_cluster().read_from_replicas()) {
   tls_->set([this, cluster_name](
                 Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::make_shared<ThreadLocalPool>(*this, dispatcher, cluster_name);
@@ -30,6 +72,10 @@ InstanceImpl::makeRequest(const std::string& key, const Common::Redis::RespValue
   return tls_->getTyped<ThreadLocalPool>().makeRequest(key, value, callbacks);
 }
 
+std::string InstanceImpl::shard(const std::string& key) {
+  return tls_->getTyped<ThreadLocalPool>().shard(key);
+}
+
 InstanceImpl::ThreadLocalPool::ThreadLocalPool(InstanceImpl& parent, Event::Dispatcher& dispatcher,
                                                std::string cluster_name)
     : parent_(parent), dispatcher_(dispatcher), cluster_name_(std::move(cluster_name)) {
@@ -48,6 +94,7 @@ InstanceImpl::ThreadLocalPool::~ThreadLocalPool() {
   while (!client_map_.empty()) {
     client_map_.begin()->second->redis_client_->close();
   }
+  ASSERT(redirecting_requests_.empty());
 }
 
 void InstanceImpl::ThreadLocalPool::onClusterAddOrUpdateNonVirtual(
@@ -69,6 +116,14 @@ void InstanceImpl::ThreadLocalPool::onClusterAddOrUpdateNonVirtual(
              const std::vector<Upstream::HostSharedPtr>& hosts_removed) -> void {
         onHostsRemoved(hosts_removed);
       });
+
+  if (parent_.redis_cluster_) {
+    updateHostAddressMap();
+    if (refresh_timer_ == nullptr) {
+      refresh_timer_ = dispatcher_.createTimer([this]() -> void { refreshSlotMap(); });
+    }
+    refreshSlotMap();
+  }
 }
 
 void InstanceImpl::ThreadLocalPool::onClusterRemoval(const std::string& cluster_name) {
@@ -84,6 +139,12 @@ void InstanceImpl::ThreadLocalPool::onClusterRemoval(const std::string& cluster_
 
   cluster_ = nullptr;
   host_set_member_update_cb_handle_ = nullptr;
+  slot_map_ = nullptr;
+  host_address_map_.clear();
+  created_hosts_.clear();
+  if (refresh_timer_ != nullptr) {
+    refresh_timer_->disableTimer();
+  }
 }
 
 void InstanceImpl::ThreadLocalPool::onHostsRemoved(
@@ -96,8 +157,116 @@ void InstanceImpl::ThreadLocalPool::onHostsRemoved(
       it->second->redis_client_->close();
     }
   }
+
+  if (parent_.redis_cluster_) {
+    updateHostAddressMap();
+  }
+}
+
+void InstanceImpl::ThreadLocalPool::updateHostAddressMap() {
+  host_address_map_.clear();
+  for (const auto& host_set : cluster_->prioritySet().hostSetsPerPriority()) {
+    for (const Upstream::HostSharedPtr& host : host_set->hosts()) {
+      host_address_map_.emplace(host->address()->asString(), host);
+    }
+  }
+}
+
+Upstream::HostConstSharedPtr
+InstanceImpl::ThreadLocalPool::hostForAddress(const std::string& address) {
+  auto it = host_address_map_.find(address);
+  if (it != host_address_map_.end()) {
+    return it->second;
+  }
+
+  // The nodes of a Redis Cluster which are not hosts of the upstream cluster are created on first
+  // use, and kept until the upstream cluster is removed.
+  Upstream::HostConstSharedPtr& host = created_hosts_[address];
+  if (host == nullptr) {
+    Network::Address::InstanceConstSharedPtr resolved;
+    try {
+      resolved = Network::Utility::parseInternetAddressAndPort(address, false);
+    } catch (const EnvoyException& e) {
+      ENVOY_LOG(debug, "redis: invalid redis cluster node address '{}': {}", address, e.what());
+      created_hosts_.erase(address);
+      return nullptr;
+    }
+    host = std::make_shared<Upstream::HostImpl>(
+        cluster_->info(), "", resolved, envoy::api::v2::core::Metadata::default_instance(), 1,
+        envoy::api::v2::core::Locality::default_instance(),
+        envoy::api::v2::endpoint::Endpoint::HealthCheckConfig::default_instance(), 0,
+        envoy::api::v2::core::HealthStatus::UNKNOWN);
+  }
+  return host;
+}
+
+Upstream::HostConstSharedPtr
+InstanceImpl::ThreadLocalPool::slotHost(const std::string& key,
+                                        const Common::Redis::RespValue& request) {
+  if (slot_map_ == nullptr) {
+    return nullptr;
+  }
+
+  const ClusterSlotMap::Shard* shard = slot_map_->shard(ClusterSlotMap::keySlot(key));
+  if (shard == nullptr) {
+    return nullptr;
+  }
+
+  if (parent_.read_from_replicas_ && !shard->replicas_.empty() &&
+      request.type() == Common::Redis::RespType::Array && !request.asArray().empty() &&
+      request.asArray()[0].type() == Common::Redis::RespType::BulkString &&
+      readOnlyCommands().count(absl::AsciiStrToLower(request.asArray()[0].asString())) > 0) {
+    Upstream::HostConstSharedPtr replica =
+        hostForAddress(shard->replicas_[replica_index_++ % shard->replicas_.size()]);
+    if (replica != nullptr) {
+      return replica;
+    }
+  }
+
+  return hostForAddress(shard->primary_);
 }
 
+void InstanceImpl::ThreadLocalPool::onMovedRedirection() {
+  // A burst of MOVED redirections means that the slot map is stale, so it is refreshed without
+  // waiting for the refresh interval.
+  if (++redirections_since_refresh_ >= parent_.redirect_refresh_threshold_) {
+    refreshSlotMap();
+  }
+}
+
+void InstanceImpl::ThreadLocalPool::refreshSlotMap() {
+  ASSERT(parent_.redis_cluster_);
+  if (cluster_ == nullptr) {
+    return;
+  }
+
+  refresh_timer_->enableTimer(parent_.refresh_interval_);
+  if (refresh_request_ != nullptr) {
+    return;
+  }
+
+  Upstream::HostConstSharedPtr host = cluster_->loadBalancer().chooseHost(nullptr);
+  if (host == nullptr) {
+    return;
+  }
+
+  redirections_since_refresh_ = 0;
+  refresh_request_ = makeRequestToHost(host, makeCommand({"cluster", "slots"}),
+                                       refresh_callbacks_, false);
+}
+
+void InstanceImpl::SlotMapRefreshCallbacks::onResponse(Common::Redis::RespValuePtr&& value) {
+  parent_.refresh_request_ = nullptr;
+  ClusterSlotMapPtr slot_map = ClusterSlotMap::create(*value);
+  if (slot_map == nullptr) {
+    ENVOY_LOG(debug, "redis: invalid CLUSTER SLOTS response: {}", value->toString());
+    return;
+  }
+  parent_.slot_map_ = std::move(slot_map);
+}
+
+void InstanceImpl::SlotMapRefreshCallbacks::onFailure() { parent_.refresh_request_ = nullptr; }
+
 Common::Redis::Client::PoolRequest*
 InstanceImpl::ThreadLocalPool::makeRequest(const std::string& key,
                                            const Common::Redis::RespValue& request,
@@ -108,23 +277,126 @@ InstanceImpl::ThreadLocalPool::makeRequest(const std::string& key,
     return nullptr;
   }
 
+  Upstream::HostConstSharedPtr host;
+  if (parent_.redis_cluster_) {
+    host = slotHost(key, request);
+  }
+  if (!host) {
+    LbContextImpl lb_context(key, parent_.config_.enableHashtagging());
+    host = cluster_->loadBalancer().chooseHost(&lb_context);
+  }
+  if (!host) {
+    return nullptr;
+  }
+
+  if (!parent_.redis_cluster_) {
+    return makeRequestToHost(host, request, callbacks, false);
+  }
+
+  RedirectingRequestPtr redirecting_request =
+      std::make_unique<RedirectingRequest>(*this, request, callbacks);
+  redirecting_request->handle_ =
+      makeRequestToHost(host, redirecting_request->request_, *redirecting_request, false);
+  if (redirecting_request->handle_ == nullptr) {
+    return nullptr;
+  }
+  redirecting_request->moveIntoList(std::move(redirecting_request), redirecting_requests_);
+  return redirecting_requests_.front().get();
+}
+
+std::string InstanceImpl::ThreadLocalPool::shard(const std::string& key) {
+  if (cluster_ == nullptr) {
+    return "";
+  }
+
+  if (parent_.redis_cluster_) {
+    // Redis Cluster rejects the multi-key commands whose keys are in different slots, even when
+    // the slots are served by the same node.
+    return fmt::format("{}/{}", cluster_name_, ClusterSlotMap::keySlot(key));
+  }
+
   LbContextImpl lb_context(key, parent_.config_.enableHashtagging());
   Upstream::HostConstSharedPtr host = cluster_->loadBalancer().chooseHost(&lb_context);
   if (!host) {
-    return nullptr;
+    return "";
   }
+  return fmt::format("{}/{}", cluster_name_, host->address()->asString());
+}
 
+Common::Redis::Client::PoolRequest* InstanceImpl::ThreadLocalPool::makeRequestToHost(
+    const Upstream::HostConstSharedPtr& host, const Common::Redis::RespValue& request,
+    Common::Redis::Client::PoolCallbacks& callbacks, bool asking) {
   ThreadLocalActiveClientPtr& client = client_map_[host];
   if (!client) {
     client = std::make_unique<ThreadLocalActiveClient>(*this);
     client->host_ = host;
     client->redis_client_ = parent_.client_factory_.create(host, dispatcher_, parent_.config_);
     client->redis_client_->addConnectionCallbacks(*client);
+    if (parent_.read_from_replicas_) {
+      // The replicas of a Redis Cluster only serve the reads of the connections in READONLY mode.
+      client->redis_client_->makeRequest(makeCommand({"readonly"}), ignored_callbacks_);
+    }
   }
 
+  if (asking) {
+    // An ASK redirection is only valid for the next command of the connection.
+    client->redis_client_->makeRequest(makeCommand({"asking"}), ignored_callbacks_);
+  }
   return client->redis_client_->makeRequest(request, callbacks);
 }
 
+void InstanceImpl::RedirectingRequest::cancel() {
+  handle_->cancel();
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.redirecting_requests_));
+}
+
+void InstanceImpl::RedirectingRequest::onResponse(Common::Redis::RespValuePtr&& value) {
+  handle_ = nullptr;
+  if (redirect(*value)) {
+    return;
+  }
+
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.redirecting_requests_));
+  callbacks_.onResponse(std::move(value));
+}
+
+void InstanceImpl::RedirectingRequest::onFailure() {
+  handle_ = nullptr;
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.redirecting_requests_));
+  callbacks_.onFailure();
+}
+
+bool InstanceImpl::RedirectingRequest::redirect(const Common::Redis::RespValue& value) {
+  // The redirections are errors of the form "MOVED <slot> <address>:<port>" or
+  // "ASK <slot> <address>:<port>".
+  if (value.type() != Common::Redis::RespType::Error || redirections_ == MaxRedirections) {
+    return false;
+  }
+
+  const std::string& error = value.asString();
+  const bool moved = absl::StartsWith(error, "MOVED ");
+  if (!moved && !absl::StartsWith(error, "ASK ")) {
+    return false;
+  }
+
+  const size_t address_start = error.rfind(' ');
+  ASSERT(address_start != std::string::npos);
+  Upstream::HostConstSharedPtr host = parent_.hostForAddress(error.substr(address_start + 1));
+  if (host == nullptr) {
+    return false;
+  }
+
+  if (moved) {
+    parent_.onMovedRedirection();
+  }
+  handle_ = parent_.makeRequestToHost(host, request_, *this, !moved);
+  if (handle_ == nullptr) {
+    return false;
+  }
+  redirections_++;
+  return true;
+}
+
 void InstanceImpl::ThreadLocalActiveClient::onEvent(Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
@@ -138,21 +410,7 @@ void InstanceImpl::ThreadLocalActiveClient::onEvent(Network::ConnectionEvent eve
 // Inspired by the redis-cluster hashtagging algorithm
 // https://redis.io/topics/cluster-spec#keys-hash-tags
 absl::string_view InstanceImpl::LbContextImpl::hashtag(absl::string_view v, bool enabled) {
-  if (!enabled) {
-    return v;
-  }
-
-  auto start = v.find('{');
-  if (start == std::string::npos) {
-    return v;
-  }
-
-  auto end = v.find('}', start);
-  if (end == std::string::npos || end == start + 1) {
-    return v;
-  }
-
-  return v.substr(start + 1, end - start - 1);
+  return enabled ? ClusterSlotMap::hashtag(v) : v;
 }
 
 } // namespace ConnPool
@@ -9,17 +9,21 @@
 #include <vector>
 
 #include "envoy/config/filter/network/redis_proxy/v2/redis_proxy.pb.h"
+#include "envoy/event/timer.h"
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/buffer/buffer_impl.h"
 #include "common/common/hash.h"
+#include "common/common/linked_object.h"
+#include "common/common/logger.h"
 #include "common/network/filter_impl.h"
 #include "common/protobuf/utility.h"
 #include "common/upstream/load_balancer_impl.h"
 
 #include "extensions/filters/network/common/redis/client_impl.h"
 #include "extensions/filters/network/common/redis/codec_impl.h"
+#include "extensions/filters/network/redis_proxy/cluster_slot_map.h"
 #include "extensions/filters/network/redis_proxy/conn_pool.h"
 
 namespace Envoy {
@@ -41,6 +45,7 @@ public:
   Common::Redis::Client::PoolRequest*
   makeRequest(const std::string& key, const Common::Redis::RespValue& request,
               Common::Redis::Client::PoolCallbacks& callbacks) override;
+  std::string shard(const std::string& key) override;
 
 private:
   struct ThreadLocalPool;
@@ -60,15 +65,80 @@ private:
 
   typedef std::unique_ptr<ThreadLocalActiveClient> ThreadLocalActiveClientPtr;
 
+  /**
+   * A request to a Redis Cluster, which follows the MOVED and ASK redirections of its responses.
+   */
+  struct RedirectingRequest : public Common::Redis::Client::PoolRequest,
+                              public Common::Redis::Client::PoolCallbacks,
+                              public Event::DeferredDeletable,
+                              LinkedObject<RedirectingRequest> {
+    RedirectingRequest(ThreadLocalPool& parent, const Common::Redis::RespValue& request,
+                       Common::Redis::Client::PoolCallbacks& callbacks)
+        : parent_(parent), request_(request), callbacks_(callbacks) {}
+
+    // Common::Redis::Client::PoolRequest
+    void cancel() override;
+
+    // Common::Redis::Client::PoolCallbacks
+    void onResponse(Common::Redis::RespValuePtr&& value) override;
+    void onFailure() override;
+
+    bool redirect(const Common::Redis::RespValue& value);
+
+    ThreadLocalPool& parent_;
+    // The request is copied, since the caller only lends it for the first attempt.
+    const Common::Redis::RespValue request_;
+    Common::Redis::Client::PoolCallbacks& callbacks_;
+    Common::Redis::Client::PoolRequest* handle_{};
+    uint32_t redirections_{};
+  };
+
+  typedef std::unique_ptr<RedirectingRequest> RedirectingRequestPtr;
+
+  /**
+   * Callbacks of the requests whose response is not used, like READONLY and ASKING.
+   */
+  struct IgnoredResponseCallbacks : public Common::Redis::Client::PoolCallbacks {
+    // Common::Redis::Client::PoolCallbacks
+    void onResponse(Common::Redis::RespValuePtr&&) override {}
+    void onFailure() override {}
+  };
+
+  /**
+   * Callbacks of the CLUSTER SLOTS requests that refresh the slot map.
+   */
+  struct SlotMapRefreshCallbacks : public Common::Redis::Client::PoolCallbacks,
+                                   Logger::Loggable<Logger::Id::redis> {
+    SlotMapRefreshCallbacks(ThreadLocalPool& parent) : parent_(parent) {}
+
+    // Common::Redis::Client::PoolCallbacks
+    void onResponse(Common::Redis::RespValuePtr&& value) override;
+    void onFailure() override;
+
+    ThreadLocalPool& parent_;
+  };
+
   struct ThreadLocalPool : public ThreadLocal::ThreadLocalObject,
-                           public Upstream::ClusterUpdateCallbacks {
+                           public Upstream::ClusterUpdateCallbacks,
+                           Logger::Loggable<Logger::Id::redis> {
     ThreadLocalPool(InstanceImpl& parent, Event::Dispatcher& dispatcher, std::string cluster_name);
     ~ThreadLocalPool();
     Common::Redis::Client::PoolRequest*
     makeRequest(const std::string& key, const Common::Redis::RespValue& request,
                 Common::Redis::Client::PoolCallbacks& callbacks);
+    Common::Redis::Client::PoolRequest*
+    makeRequestToHost(const Upstream::HostConstSharedPtr& host,
+                      const Common::Redis::RespValue& request,
+                      Common::Redis::Client::PoolCallbacks& callbacks, bool asking);
+    std::string shard(const std::string& key);
     void onClusterAddOrUpdateNonVirtual(Upstream::ThreadLocalCluster& cluster);
     void onHostsRemoved(const std::vector<Upstream::HostSharedPtr>& hosts_removed);
+    void updateHostAddressMap();
+    Upstream::HostConstSharedPtr hostForAddress(const std::string& address);
+    Upstream::HostConstSharedPtr slotHost(const std::string& key,
+                                          const Common::Redis::RespValue& request);
+    void onMovedRedirection();
+    void refreshSlotMap();
 
     // Upstream::ClusterUpdateCallbacks
     void onClusterAddOrUpdate(Upstream::ThreadLocalCluster& cluster) override {
@@ -83,6 +153,20 @@ private:
     Upstream::ThreadLocalCluster* cluster_{};
     std::unordered_map<Upstream::HostConstSharedPtr, ThreadLocalActiveClientPtr> client_map_;
     Envoy::Common::CallbackHandle* host_set_member_update_cb_handle_{};
+
+    // The following are only used for a Redis Cluster. Each worker discovers the slot map.
+    ClusterSlotMapPtr slot_map_;
+    Event::TimerPtr refresh_timer_;
+    Common::Redis::Client::PoolRequest* refresh_request_{};
+    SlotMapRefreshCallbacks refresh_callbacks_{*this};
+    IgnoredResponseCallbacks ignored_callbacks_;
+    uint32_t redirections_since_refresh_{};
+    uint64_t replica_index_{};
+    // The hosts by "address:port", including the nodes of the slot map that are not hosts of the
+    // upstream cluster.
+    std::unordered_map<std::string, Upstream::HostConstSharedPtr> host_address_map_;
+    std::unordered_map<std::string, Upstream::HostConstSharedPtr> created_hosts_;
+    std::list<RedirectingRequestPtr> redirecting_requests_;
   };
 
   struct LbContextImpl : public Upstream::LoadBalancerContextBase {
@@ -96,10 +180,18 @@ private:
     const absl::optional<uint64_t> hash_key_;
   };
 
+  // The most redirections followed by a request, which prevents redirection loops while the
+  // slots of a Redis Cluster are moved.
+  static constexpr uint32_t MaxRedirections = 3;
+
   Upstream::ClusterManager& cm_;
   Common::Redis::Client::ClientFactory& client_factory_;
   ThreadLocal::SlotPtr tls_;
   Common::Redis::Client::ConfigImpl config_;
+  const bool redis_cluster_;
+  const std::chrono::milliseconds refresh_interval_;
+  const uint32_t redirect_refresh_threshold_;
+  const bool read_from_replicas_;
 };
 
 } // namespace ConnPool
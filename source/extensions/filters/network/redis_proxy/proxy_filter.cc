@@ -79,9 +79,10 @@ void ProxyFilter::onResponse(PendingRequest& request, Common::Redis::RespValuePt
   request.request_handle_ = nullptr;
 
   // The response we got might not be in order, so flush out what we can. (A new response may
-  // unlock several out of order responses).
+  // unlock several out of order responses). The responses are no longer needed once encoded, so
+  // their large bulk strings are moved to the connection instead of being copied.
   while (!pending_requests_.empty() && pending_requests_.front().pending_response_) {
-    encoder_->encode(*pending_requests_.front().pending_response_, encoder_buffer_);
+    encoder_->move(*pending_requests_.front().pending_response_, encoder_buffer_);
     pending_requests_.pop_front();
   }
 
@@ -0,0 +1,122 @@
+#include "extensions/filters/network/redis_proxy/read_cache.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+ReadCache::ReadCache(
+    const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ReadCacheSettings& config,
+    ThreadLocal::SlotAllocator& tls, Stats::Scope& scope, const std::string& stat_prefix,
+    TimeSource& time_source)
+    : ttl_(PROTOBUF_GET_MS_REQUIRED(config, ttl)),
+      max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, 10000)),
+      tls_(tls.allocateSlot()), time_source_(time_source) {
+  for (const std::string& prefix : config.prefixes()) {
+    const std::string prefix_stat_prefix = fmt::format("{}read_cache.{}.", stat_prefix, prefix);
+    auto stats = std::make_shared<ReadCacheStats>(
+        ReadCacheStats{ALL_READ_CACHE_STATS(POOL_COUNTER_PREFIX(scope, prefix_stat_prefix))});
+    if (!prefix_lookup_table_.add(prefix.c_str(), std::move(stats), false)) {
+      throw EnvoyException(fmt::format("read cache prefix `{}` already exists.", prefix));
+    }
+  }
+
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalCache>();
+  });
+}
+
+ReadCache::LookupStatus ReadCache::lookup(const std::string& key,
+                                          Common::Redis::RespValuePtr& response,
+                                          uint64_t& generation) {
+  ReadCacheStatsSharedPtr stats = prefix_lookup_table_.findLongestPrefix(key.c_str());
+  if (stats == nullptr) {
+    return LookupStatus::NotCacheable;
+  }
+
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  auto entry = cache.entries_.find(key);
+  if (entry != cache.entries_.end()) {
+    if (entry->second.expiry_ > time_source_.monotonicTime()) {
+      cache.lru_.splice(cache.lru_.begin(), cache.lru_, entry->second.lru_position_);
+      response = std::make_unique<Common::Redis::RespValue>(entry->second.response_);
+      stats->hit_.inc();
+      return LookupStatus::Hit;
+    }
+    cache.erase(entry);
+  }
+
+  stats->miss_.inc();
+  generation = cache.generation_;
+  return LookupStatus::Miss;
+}
+
+void ReadCache::insert(const std::string& key, const Common::Redis::RespValue& response,
+                       uint64_t generation) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  if (generation != cache.generation_) {
+    return;
+  }
+
+  const MonotonicTime expiry = time_source_.monotonicTime() + ttl_;
+  auto entry = cache.entries_.find(key);
+  if (entry != cache.entries_.end()) {
+    // Another GET of the key missed concurrently.
+    entry->second.response_ = response;
+    entry->second.expiry_ = expiry;
+    cache.lru_.splice(cache.lru_.begin(), cache.lru_, entry->second.lru_position_);
+    return;
+  }
+
+  ReadCacheStatsSharedPtr stats = prefix_lookup_table_.findLongestPrefix(key.c_str());
+  ASSERT(stats != nullptr);
+  if (cache.entries_.size() >= max_entries_) {
+    auto evicted = cache.entries_.find(*cache.lru_.back());
+    evicted->second.stats_.eviction_.inc();
+    cache.erase(evicted);
+  }
+
+  entry = cache.entries_
+              .emplace(key, ThreadLocalCache::Entry{response, expiry, *stats, cache.lru_.end()})
+              .first;
+  cache.lru_.push_front(&entry->first);
+  entry->second.lru_position_ = cache.lru_.begin();
+}
+
+void ReadCache::invalidate(const std::string& key) {
+  ReadCacheStatsSharedPtr stats = prefix_lookup_table_.findLongestPrefix(key.c_str());
+  if (stats == nullptr) {
+    return;
+  }
+
+  stats->invalidation_.inc();
+  // The cache of the current worker is invalidated right away, so that its next GET of the key
+  // doesn't return the value that is being written.
+  invalidateLocal(tls_->getTyped<ThreadLocalCache>(), key);
+  tls_->runOnAllThreads(
+      [this, key]() -> void { invalidateLocal(tls_->getTyped<ThreadLocalCache>(), key); });
+}
+
+void ReadCache::invalidateLocal(ThreadLocalCache& cache, const std::string& key) {
+  cache.generation_++;
+  auto entry = cache.entries_.find(key);
+  if (entry != cache.entries_.end()) {
+    cache.erase(entry);
+  }
+}
+
+void ReadCache::ThreadLocalCache::erase(std::unordered_map<std::string, Entry>::iterator entry) {
+  lru_.erase(entry->second.lru_position_);
+  entries_.erase(entry);
+}
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/common/time.h"
+#include "envoy/config/filter/network/redis_proxy/v2/redis_proxy.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/utility.h"
+
+#include "extensions/filters/network/common/redis/codec.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+/**
+ * All read cache stats of a prefix. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_READ_CACHE_STATS(COUNTER)                                                              \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(invalidation)                                                                            \
+  COUNTER(eviction)
+// clang-format on
+
+/**
+ * Struct definition for all read cache stats of a prefix. @see stats_macros.h
+ */
+struct ReadCacheStats {
+  ALL_READ_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+class ReadCache;
+typedef std::unique_ptr<ReadCache> ReadCachePtr;
+
+/**
+ * A cache of the GET responses of the keys with configured prefixes. Each worker has its own
+ * cache, which evicts its least recently used keys when it is full and expires its responses after
+ * the configured TTL.
+ */
+class ReadCache {
+public:
+  ReadCache(const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ReadCacheSettings&
+                config,
+            ThreadLocal::SlotAllocator& tls, Stats::Scope& scope, const std::string& stat_prefix,
+            TimeSource& time_source);
+
+  enum class LookupStatus {
+    // The key doesn't match any of the cached prefixes.
+    NotCacheable,
+    // The response is cached and fresh.
+    Hit,
+    // The response must be fetched from upstream, and can then be inserted.
+    Miss
+  };
+
+  /**
+   * Look up the response of a key in the cache of the current worker.
+   * @param key supplies the key of a GET command.
+   * @param response receives a copy of the cached response on a hit.
+   * @param generation receives on a miss the generation to insert the fetched response with.
+   * @return LookupStatus the status of the lookup.
+   */
+  LookupStatus lookup(const std::string& key, Common::Redis::RespValuePtr& response,
+                      uint64_t& generation);
+
+  /**
+   * Insert the response of a key in the cache of the current worker, unless a key was invalidated
+   * since the miss, in which case the response may be stale.
+   * @param key supplies the key of a GET command.
+   * @param response supplies the response to copy into the cache.
+   * @param generation supplies the generation returned by the lookup of the key.
+   */
+  void insert(const std::string& key, const Common::Redis::RespValue& response,
+              uint64_t generation);
+
+  /**
+   * Remove a key written by a command from the caches of all the workers.
+   * @param key supplies the key.
+   */
+  void invalidate(const std::string& key);
+
+private:
+  typedef std::shared_ptr<ReadCacheStats> ReadCacheStatsSharedPtr;
+
+  struct ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
+    struct Entry {
+      Common::Redis::RespValue response_;
+      MonotonicTime expiry_;
+      ReadCacheStats& stats_;
+      std::list<const std::string*>::iterator lru_position_;
+    };
+
+    void erase(std::unordered_map<std::string, Entry>::iterator entry);
+
+    std::unordered_map<std::string, Entry> entries_;
+    // The keys of entries_, from the most to the least recently used.
+    std::list<const std::string*> lru_;
+    // Incremented by each invalidation, so that the responses fetched before it aren't inserted.
+    uint64_t generation_{};
+  };
+
+  void invalidateLocal(ThreadLocalCache& cache, const std::string& key);
+
+  TrieLookupTable<ReadCacheStatsSharedPtr> prefix_lookup_table_;
+  const std::chrono::milliseconds ttl_;
+  const uint32_t max_entries_;
+  ThreadLocal::SlotPtr tls_;
+  TimeSource& time_source_;
+};
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -32,6 +32,14 @@ public:
   virtual Common::Redis::Client::PoolRequest*
   makeRequest(const std::string& key, const Common::Redis::RespValue& request,
               Common::Redis::Client::PoolCallbacks& callbacks) PURE;
+
+  /**
+   * Identifies the shard of the connection pool that the requests of a key are routed to.
+   * @param key supplies the key of the current command.
+   * @return std::string an identifier that is the same for the keys that can be sent in one
+   *         request, or an empty string if the key has no upstream.
+   */
+  virtual std::string shard(const std::string& key) PURE;
 };
 
 typedef std::unique_ptr<Router> RouterPtr;
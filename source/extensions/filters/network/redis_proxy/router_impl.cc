@@ -39,15 +39,7 @@ Common::Redis::Client::PoolRequest*
 PrefixRoutes::makeRequest(const std::string& key, const Common::Redis::RespValue& request,
                           Common::Redis::Client::PoolCallbacks& callbacks) {
 
-  PrefixPtr value = nullptr;
-  if (case_insensitive_) {
-    std::string copy(key);
-    to_lower_table_.toLowerCase(copy);
-    value = prefix_lookup_table_.findLongestPrefix(copy.c_str());
-  } else {
-    value = prefix_lookup_table_.findLongestPrefix(key.c_str());
-  }
-
+  PrefixPtr value = findPrefix(key);
   if (value != nullptr) {
     absl::string_view view(key);
     if (value->remove_prefix) {
@@ -62,6 +54,30 @@ PrefixRoutes::makeRequest(const std::string& key, const Common::Redis::RespValue
   return nullptr;
 }
 
+std::string PrefixRoutes::shard(const std::string& key) {
+  PrefixPtr value = findPrefix(key);
+  if (value != nullptr) {
+    absl::string_view view(key);
+    if (value->remove_prefix) {
+      view.remove_prefix(value->prefix.length());
+    }
+    return value->upstream->shard(std::string(view));
+  } else if (catch_all_upstream_ != nullptr) {
+    return catch_all_upstream_.value()->shard(key);
+  }
+
+  return "";
+}
+
+PrefixRoutes::PrefixPtr PrefixRoutes::findPrefix(const std::string& key) const {
+  if (case_insensitive_) {
+    std::string copy(key);
+    to_lower_table_.toLowerCase(copy);
+    return prefix_lookup_table_.findLongestPrefix(copy.c_str());
+  }
+  return prefix_lookup_table_.findLongestPrefix(key.c_str());
+}
+
 } // namespace RedisProxy
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -32,6 +32,7 @@ public:
   Common::Redis::Client::PoolRequest*
   makeRequest(const std::string& hash_key, const Common::Redis::RespValue& request,
               Common::Redis::Client::PoolCallbacks& callbacks) override;
+  std::string shard(const std::string& key) override;
 
 private:
   struct Prefix {
@@ -42,6 +43,8 @@ private:
 
   typedef std::shared_ptr<Prefix> PrefixPtr;
 
+  PrefixPtr findPrefix(const std::string& key) const;
+
   TrieLookupTable<PrefixPtr> prefix_lookup_table_;
   const ToLowerTable to_lower_table_;
   const bool case_insensitive_;
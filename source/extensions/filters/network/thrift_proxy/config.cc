@@ -7,6 +7,7 @@
 #include "envoy/registry/registry.h"
 
 #include "common/config/utility.h"
+#include "common/protobuf/utility.h"
 
 #include "extensions/filters/network/thrift_proxy/auto_protocol_impl.h"
 #include "extensions/filters/network/thrift_proxy/auto_transport_impl.h"
@@ -92,7 +93,9 @@ lookupProtocol(envoy::config::filter::network::thrift_proxy::v2alpha1::ProtocolT
 ProtocolOptionsConfigImpl::ProtocolOptionsConfigImpl(
     const envoy::config::filter::network::thrift_proxy::v2alpha1::ThriftProtocolOptions& config)
     : transport_(lookupTransport(config.transport())),
-      protocol_(lookupProtocol(config.protocol())) {}
+      protocol_(lookupProtocol(config.protocol())),
+      max_concurrent_requests_per_connection_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_concurrent_requests_per_connection, 0)) {}
 
 TransportType ProtocolOptionsConfigImpl::transport(TransportType downstream_transport) const {
   return (transport_ == TransportType::Auto) ? downstream_transport : transport_;
@@ -125,7 +128,8 @@ ConfigImpl::ConfigImpl(
     : context_(context), stats_prefix_(fmt::format("thrift.{}.", config.stat_prefix())),
       stats_(ThriftFilterStats::generateStats(stats_prefix_, context_.scope())),
       transport_(lookupTransport(config.transport())), proto_(lookupProtocol(config.protocol())),
-      route_matcher_(new Router::RouteMatcher(config.route_config())) {
+      route_matcher_(new Router::RouteMatcher(config.route_config())),
+      payload_passthrough_(config.payload_passthrough()) {
 
   if (config.thrift_filters().empty()) {
     ENVOY_LOG(debug, "using default router filter");
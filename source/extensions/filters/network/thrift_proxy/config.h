@@ -29,10 +29,14 @@ public:
   // ProtocolOptionsConfig
   TransportType transport(TransportType downstream_transport) const override;
   ProtocolType protocol(ProtocolType downstream_protocol) const override;
+  uint32_t maxConcurrentRequestsPerConnection() const override {
+    return max_concurrent_requests_per_connection_;
+  }
 
 private:
   const TransportType transport_;
   const ProtocolType protocol_;
+  const uint32_t max_concurrent_requests_per_connection_;
 };
 
 /**
@@ -80,6 +84,7 @@ public:
   TransportPtr createTransport() override;
   ProtocolPtr createProtocol() override;
   Router::Config& routerConfig() override { return *this; }
+  bool payloadPassthrough() const override { return payload_passthrough_; }
 
 private:
   void processFilter(
@@ -91,6 +96,7 @@ private:
   const TransportType transport_;
   const ProtocolType proto_;
   std::unique_ptr<Router::RouteMatcher> route_matcher_;
+  const bool payload_passthrough_;
 
   std::list<ThriftFilters::FilterFactoryCb> filter_factories_;
 };
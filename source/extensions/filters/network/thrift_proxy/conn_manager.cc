@@ -564,6 +564,30 @@ FilterStatus ConnectionManager::ActiveRpc::setEnd() {
   return applyDecoderFilters(nullptr);
 }
 
+bool ConnectionManager::ActiveRpc::passthroughSupported() const {
+  // Protocol upgrade requests are decoded by the protocol's upgrade handler.
+  if (upgrade_handler_) {
+    return false;
+  }
+
+  for (auto& filter : decoder_filters_) {
+    if (!filter->handle_->passthroughSupported()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FilterStatus ConnectionManager::ActiveRpc::passthroughData(Buffer::Instance& data) {
+  filter_context_ = &data;
+  filter_action_ = [this](DecoderEventHandler* filter) -> FilterStatus {
+    Buffer::Instance* data = absl::any_cast<Buffer::Instance*>(filter_context_);
+    return filter->passthroughData(*data);
+  };
+
+  return applyDecoderFilters(nullptr);
+}
+
 void ConnectionManager::ActiveRpc::createFilterChain() {
   parent_.config_.filterFactory().createFilterChain(*this);
 }
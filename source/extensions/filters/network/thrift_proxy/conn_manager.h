@@ -38,6 +38,7 @@ public:
   virtual TransportPtr createTransport() PURE;
   virtual ProtocolPtr createProtocol() PURE;
   virtual Router::Config& routerConfig() PURE;
+  virtual bool payloadPassthrough() const PURE;
 };
 
 /**
@@ -49,6 +50,12 @@ public:
 
   virtual TransportType transport(TransportType downstream_transport) const PURE;
   virtual ProtocolType protocol(ProtocolType downstream_protocol) const PURE;
+
+  /**
+   * @return uint32_t the maximum number of concurrent requests multiplexed over an upstream
+   *         connection, or 0 if the requests to the cluster aren't multiplexed.
+   */
+  virtual uint32_t maxConcurrentRequestsPerConnection() const PURE;
 };
 
 /**
@@ -75,6 +82,7 @@ public:
 
   // DecoderCallbacks
   DecoderEventHandler& newDecoderEventHandler() override;
+  bool passthroughEnabled() const override { return config_.payloadPassthrough(); }
 
 private:
   struct ActiveRpc;
@@ -100,6 +108,7 @@ private:
 
     // DecoderCallbacks
     DecoderEventHandler& newDecoderEventHandler() override { return *this; }
+    bool passthroughEnabled() const override { return false; }
 
     ActiveRpc& parent_;
     DecoderPtr decoder_;
@@ -196,6 +205,8 @@ private:
     FilterStatus listEnd() override;
     FilterStatus setBegin(FieldType& elem_type, uint32_t& size) override;
     FilterStatus setEnd() override;
+    bool passthroughSupported() const override;
+    FilterStatus passthroughData(Buffer::Instance& data) override;
 
     // ThriftFilters::DecoderFilterCallbacks
     uint64_t streamId() const override { return stream_id_; }
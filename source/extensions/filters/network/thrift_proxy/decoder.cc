@@ -14,8 +14,10 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace ThriftProxy {
 
-// MessageBegin -> StructBegin
+// MessageBegin -> StructBegin, or
+// MessageBegin -> PassthroughData (passthrough enabled)
 DecoderStateMachine::DecoderStatus DecoderStateMachine::messageBegin(Buffer::Instance& buffer) {
+  const uint64_t length = buffer.length();
   if (!proto_.readMessageBegin(buffer, *metadata_)) {
     return DecoderStatus(ProtocolState::WaitForData);
   }
@@ -23,18 +25,47 @@ DecoderStateMachine::DecoderStatus DecoderStateMachine::messageBegin(Buffer::Ins
   stack_.clear();
   stack_.emplace_back(Frame(ProtocolState::MessageEnd));
 
+  if (passthrough_frame_size_.has_value()) {
+    const uint64_t header_length = length - buffer.length();
+    if (header_length > passthrough_frame_size_.value()) {
+      throw EnvoyException(fmt::format("message begin of {} bytes exceeds frame size {}",
+                                       header_length, passthrough_frame_size_.value()));
+    }
+
+    passthrough_length_ = passthrough_frame_size_.value() - header_length;
+    return DecoderStatus(ProtocolState::PassthroughData, handler_.messageBegin(metadata_));
+  }
+
   return DecoderStatus(ProtocolState::StructBegin, handler_.messageBegin(metadata_));
 }
 
 // MessageEnd -> Done
 DecoderStateMachine::DecoderStatus DecoderStateMachine::messageEnd(Buffer::Instance& buffer) {
-  if (!proto_.readMessageEnd(buffer)) {
+  // The end of a passed through message was forwarded with the rest of its data.
+  if (!passthrough_ && !proto_.readMessageEnd(buffer)) {
     return DecoderStatus(ProtocolState::WaitForData);
   }
 
   return DecoderStatus(ProtocolState::Done, handler_.messageEnd());
 }
 
+// PassthroughData -> MessageEnd, or
+// PassthroughData -> StructBegin (handler requires the message to be decoded)
+DecoderStateMachine::DecoderStatus DecoderStateMachine::passthroughData(Buffer::Instance& buffer) {
+  if (!handler_.passthroughSupported()) {
+    return DecoderStatus(ProtocolState::StructBegin, FilterStatus::Continue);
+  }
+
+  if (buffer.length() < passthrough_length_) {
+    return DecoderStatus(ProtocolState::WaitForData);
+  }
+
+  passthrough_data_.move(buffer, passthrough_length_);
+  passthrough_ = true;
+
+  return DecoderStatus(ProtocolState::MessageEnd, handler_.passthroughData(passthrough_data_));
+}
+
 // StructBegin -> FieldBegin
 DecoderStateMachine::DecoderStatus DecoderStateMachine::structBegin(Buffer::Instance& buffer) {
   std::string name;
@@ -320,6 +351,8 @@ DecoderStateMachine::DecoderStatus DecoderStateMachine::handleState(Buffer::Inst
     return setEnd(buffer);
   case ProtocolState::MessageEnd:
     return messageEnd(buffer);
+  case ProtocolState::PassthroughData:
+    return passthroughData(buffer);
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
@@ -410,6 +443,9 @@ FilterStatus Decoder::onData(Buffer::Instance& data, bool& buffer_underflow) {
     frame_started_ = true;
     state_machine_ =
         std::make_unique<DecoderStateMachine>(protocol_, metadata_, request_->handler_);
+    if (metadata_->hasFrameSize() && callbacks_.passthroughEnabled()) {
+      state_machine_->enablePassthrough(metadata_->frameSize());
+    }
 
     if (request_->handler_.transportBegin(metadata_) == FilterStatus::StopIteration) {
       return FilterStatus::StopIteration;
@@ -2,6 +2,7 @@
 
 #include "envoy/buffer/buffer.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/logger.h"
 
@@ -19,6 +20,7 @@ namespace ThriftProxy {
   FUNCTION(WaitForData)                                                                            \
   FUNCTION(MessageBegin)                                                                           \
   FUNCTION(MessageEnd)                                                                             \
+  FUNCTION(PassthroughData)                                                                        \
   FUNCTION(StructBegin)                                                                            \
   FUNCTION(StructEnd)                                                                              \
   FUNCTION(FieldBegin)                                                                             \
@@ -79,6 +81,13 @@ public:
    */
   ProtocolState run(Buffer::Instance& buffer);
 
+  /**
+   * Allows the rest of the message to be passed through without being decoded, if the handler
+   * supports it after the message begin is decoded. Must be called before run.
+   * @param frame_size the size of the transport frame's payload, which holds exactly one message
+   */
+  void enablePassthrough(uint32_t frame_size) { passthrough_frame_size_ = frame_size; }
+
   /**
    * @return the current ProtocolState
    */
@@ -131,6 +140,7 @@ private:
   // or ProtocolState::WaitForData if more data is required.
   DecoderStatus messageBegin(Buffer::Instance& buffer);
   DecoderStatus messageEnd(Buffer::Instance& buffer);
+  DecoderStatus passthroughData(Buffer::Instance& buffer);
   DecoderStatus structBegin(Buffer::Instance& buffer);
   DecoderStatus structEnd(Buffer::Instance& buffer);
   DecoderStatus fieldBegin(Buffer::Instance& buffer);
@@ -167,6 +177,12 @@ private:
   DecoderEventHandler& handler_;
   ProtocolState state_;
   std::vector<Frame> stack_;
+  absl::optional<uint32_t> passthrough_frame_size_;
+  // The number of bytes between the end of the message begin and the end of the frame.
+  uint32_t passthrough_length_{};
+  // Holds the passed through bytes until the handler, and its filter chain, are done with them.
+  Buffer::OwnedImpl passthrough_data_;
+  bool passthrough_{};
 };
 
 typedef std::unique_ptr<DecoderStateMachine> DecoderStateMachinePtr;
@@ -179,6 +195,12 @@ public:
    * @return DecoderEventHandler& a new DecoderEventHandler for a message.
    */
   virtual DecoderEventHandler& newDecoderEventHandler() PURE;
+
+  /**
+   * @return bool true if the messages of transport frames of known size may be passed through
+   *         without decoding their bodies, for handlers that support it.
+   */
+  virtual bool passthroughEnabled() const PURE;
 };
 
 /**
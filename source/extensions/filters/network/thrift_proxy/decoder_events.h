@@ -1,5 +1,7 @@
 #pragma once
 
+#include "envoy/buffer/buffer.h"
+
 #include "extensions/filters/network/thrift_proxy/metadata.h"
 #include "extensions/filters/network/thrift_proxy/thrift.h"
 
@@ -132,6 +134,23 @@ public:
    * @return FilterStatus to indicate if filter chain iteration should continue
    */
   virtual FilterStatus setEnd() PURE;
+
+  /**
+   * Indicates whether the handler can process the current message without the events for its
+   * structs, fields and values. Only queried after messageBegin, when the decoder may pass the
+   * rest of the message through.
+   * @return bool true if the rest of the message may be delivered via passthroughData
+   */
+  virtual bool passthroughSupported() const PURE;
+
+  /**
+   * Indicates that the rest of the message, from the end of its message header up to the end of
+   * its transport frame, was read without being decoded. Only invoked if passthroughSupported
+   * returned true. Implementations may drain the data.
+   * @param data the undecoded protocol data of the message
+   * @return FilterStatus to indicate if filter chain iteration should continue
+   */
+  virtual FilterStatus passthroughData(Buffer::Instance& data) PURE;
 };
 
 typedef std::shared_ptr<DecoderEventHandler> DecoderEventHandlerSharedPtr;
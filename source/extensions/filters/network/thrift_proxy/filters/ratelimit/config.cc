@@ -21,18 +21,26 @@ using namespace Envoy::Extensions::NetworkFilters;
 ThriftProxy::ThriftFilters::FilterFactoryCb
 RateLimitFilterConfig::createFilterFactoryFromProtoTyped(
     const envoy::config::filter::thrift::rate_limit::v2alpha1::RateLimit& proto_config,
-    const std::string&, Server::Configuration::FactoryContext& context) {
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
   ASSERT(!proto_config.domain().empty());
   ConfigSharedPtr config(new Config(proto_config, context.localInfo(), context.scope(),
                                     context.runtime(), context.clusterManager()));
   const std::chrono::milliseconds timeout =
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, timeout, 20));
-
-  return [proto_config, &context, timeout,
-          config](ThriftProxy::ThriftFilters::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addDecoderFilter(std::make_shared<Filter>(
-        config, Filters::Common::RateLimit::rateLimitClient(
-                    context, proto_config.rate_limit_service().grpc_service(), timeout)));
+  const Filters::Common::RateLimit::AggregatorSharedPtr aggregator =
+      Filters::Common::RateLimit::rateLimitAggregator(context, proto_config.rate_limit_service(),
+                                                      timeout,
+                                                      stats_prefix + "ratelimit_aggregation.");
+
+  return [proto_config, &context, timeout, config,
+          aggregator](ThriftProxy::ThriftFilters::FilterChainFactoryCallbacks& callbacks) -> void {
+    Filters::Common::RateLimit::ClientPtr client = Filters::Common::RateLimit::rateLimitClient(
+        context, proto_config.rate_limit_service().grpc_service(), timeout);
+    if (aggregator != nullptr) {
+      client = std::make_unique<Filters::Common::RateLimit::AggregatingClientImpl>(
+          aggregator, std::move(client));
+    }
+    callbacks.addDecoderFilter(std::make_shared<Filter>(config, std::move(client)));
   };
 }
 
@@ -136,6 +136,10 @@ public:
   virtual ThriftProxy::FilterStatus setEnd() override {
     return ThriftProxy::FilterStatus::Continue;
   }
+  virtual bool passthroughSupported() const override { return true; }
+  virtual ThriftProxy::FilterStatus passthroughData(Buffer::Instance&) override {
+    return ThriftProxy::FilterStatus::Continue;
+  }
 
   // RateLimit::RequestCallbacks
   void complete(Filters::Common::RateLimit::LimitStatus status,
@@ -122,6 +122,15 @@ public:
     return FilterStatus::Continue;
   }
 
+  // Converting a message requires all of its events. Subclasses that only convert between identical
+  // protocols may support passthrough, in which case the data is copied as is.
+  bool passthroughSupported() const override { return false; }
+
+  FilterStatus passthroughData(Buffer::Instance& data) override {
+    buffer_->move(data);
+    return FilterStatus::Continue;
+  }
+
 protected:
   ProtocolType protocolType() const { return proto_->type(); }
 
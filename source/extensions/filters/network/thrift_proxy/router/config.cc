@@ -16,8 +16,11 @@ ThriftFilters::FilterFactoryCb RouterFilterConfig::createFilterFactoryFromProtoT
   UNREFERENCED_PARAMETER(proto_config);
   UNREFERENCED_PARAMETER(stat_prefix);
 
-  return [&context](ThriftFilters::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addDecoderFilter(std::make_shared<Router>(context.clusterManager()));
+  ConnectionMultiplexerSharedPtr multiplexer =
+      std::make_shared<ConnectionMultiplexer>(context.threadLocal());
+
+  return [&context, multiplexer](ThriftFilters::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addDecoderFilter(std::make_shared<Router>(context.clusterManager(), *multiplexer));
   };
 }
 
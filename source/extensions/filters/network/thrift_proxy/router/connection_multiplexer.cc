@@ -0,0 +1,233 @@
+#include "extensions/filters/network/thrift_proxy/router/connection_multiplexer.h"
+
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace ThriftProxy {
+namespace Router {
+
+constexpr uint64_t MultiplexedConnection::FramePeekLength;
+
+MultiplexedConnection::MultiplexedConnection(MultiplexedConnectionList& connections,
+                                             Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                                             Upstream::HostDescriptionConstSharedPtr host,
+                                             TransportType transport, ProtocolType protocol)
+    : connections_(connections), conn_data_(std::move(conn_data)), host_(host),
+      transport_(NamedTransportConfigFactory::getFactory(transport).createTransport()),
+      protocol_(NamedProtocolConfigFactory::getFactory(protocol).createProtocol()) {
+  ASSERT(transport == TransportType::Framed || transport == TransportType::Header);
+
+  conn_data_->addUpstreamCallbacks(*this);
+  conn_state_ = conn_data_->connectionStateTyped<ThriftConnectionState>();
+  if (conn_state_ == nullptr) {
+    conn_data_->setConnectionState(std::make_unique<ThriftConnectionState>());
+    conn_state_ = conn_data_->connectionStateTyped<ThriftConnectionState>();
+  }
+}
+
+int32_t MultiplexedConnection::addRequest(Tcp::ConnectionPool::UpstreamCallbacks& callbacks) {
+  ASSERT(!released_);
+
+  // Skip the sequence ids of the requests still in flight when the sequence ids wrap around.
+  int32_t sequence_id = conn_state_->nextSequenceId();
+  while (requests_.find(sequence_id) != requests_.end()) {
+    sequence_id = conn_state_->nextSequenceId();
+  }
+
+  requests_.emplace(sequence_id, ActiveRequest{&callbacks, false});
+  return sequence_id;
+}
+
+void MultiplexedConnection::removeRequest(int32_t sequence_id) {
+  if (released_) {
+    return;
+  }
+
+  auto it = requests_.find(sequence_id);
+  if (it == requests_.end()) {
+    return;
+  }
+
+  if (!it->second.response_received_) {
+    reusable_ = false;
+  }
+  requests_.erase(it);
+
+  if (requests_.empty() && !dispatching_) {
+    release();
+  }
+}
+
+void MultiplexedConnection::onUpstreamData(Buffer::Instance& data, bool) {
+  ASSERT(!released_);
+  response_buffer_.move(data);
+
+  // Both the framed and the header transport start their frames with the size of the rest of the
+  // frame.
+  dispatching_ = true;
+  while (response_buffer_.length() >= sizeof(int32_t)) {
+    const int32_t frame_size = response_buffer_.peekBEInt<int32_t>();
+    if (frame_size <= 0) {
+      ENVOY_LOG(debug, "thrift: invalid upstream frame size {}", frame_size);
+      dispatching_ = false;
+      connection().close(Network::ConnectionCloseType::NoFlush);
+      return;
+    }
+
+    const uint64_t frame_length = sizeof(int32_t) + static_cast<uint64_t>(frame_size);
+    if (response_buffer_.length() < frame_length) {
+      break;
+    }
+
+    Buffer::OwnedImpl frame;
+    frame.move(response_buffer_, frame_length);
+
+    const absl::optional<int32_t> sequence_id = sequenceId(frame);
+    if (!sequence_id.has_value()) {
+      ENVOY_LOG(debug, "thrift: unable to decode upstream message begin");
+      dispatching_ = false;
+      connection().close(Network::ConnectionCloseType::NoFlush);
+      return;
+    }
+
+    auto it = requests_.find(sequence_id.value());
+    if (it == requests_.end() || it->second.response_received_) {
+      // The request was reset before its response arrived.
+      ENVOY_LOG(debug, "thrift: dropping upstream response with sequence id {}",
+                sequence_id.value());
+      continue;
+    }
+
+    it->second.response_received_ = true;
+    it->second.callbacks_->onUpstreamData(frame, false);
+    if (released_) {
+      // The request closed the connection.
+      return;
+    }
+  }
+  dispatching_ = false;
+
+  // The end of the stream is followed by the close event of the connection.
+  if (requests_.empty()) {
+    release();
+  }
+}
+
+void MultiplexedConnection::onEvent(Network::ConnectionEvent event) {
+  if (released_ || event == Network::ConnectionEvent::Connected) {
+    return;
+  }
+
+  // The connection leaves its list first, so that the requests reset by the event can't be
+  // retried over it.
+  released_ = true;
+  connection().dispatcher().deferredDelete(removeFromList(connections_));
+
+  std::unordered_map<int32_t, ActiveRequest> requests;
+  requests.swap(requests_);
+  for (auto& request : requests) {
+    request.second.callbacks_->onEvent(event);
+  }
+
+  conn_state_ = nullptr;
+  conn_data_.reset();
+}
+
+absl::optional<int32_t> MultiplexedConnection::sequenceId(const Buffer::Instance& frame) {
+  // Decoding drains its input, so the start of the frame is decoded from a copy. The whole frame is
+  // only copied when the message begin doesn't fit in its start, e.g. with large headers.
+  for (uint64_t length : {std::min(frame.length(), FramePeekLength), frame.length()}) {
+    std::string bytes(length, '\0');
+    frame.copyOut(0, length, &bytes[0]);
+    Buffer::OwnedImpl buffer(bytes);
+
+    MessageMetadata metadata;
+    try {
+      if (transport_->decodeFrameStart(buffer, metadata) &&
+          protocol_->readMessageBegin(buffer, metadata) && metadata.hasSequenceId()) {
+        return metadata.sequenceId();
+      }
+    } catch (const EnvoyException& ex) {
+      ENVOY_LOG(debug, "thrift: upstream response error: {}", ex.what());
+      return absl::nullopt;
+    }
+
+    if (length == frame.length()) {
+      break;
+    }
+  }
+
+  return absl::nullopt;
+}
+
+void MultiplexedConnection::release() {
+  ASSERT(requests_.empty());
+  released_ = true;
+
+  // A connection may receive a response for a reset request, or has part of one buffered, so it
+  // can only go back to its pool if all of its responses were read.
+  if (!reusable_ || response_buffer_.length() > 0) {
+    connection().close(Network::ConnectionCloseType::NoFlush);
+  }
+
+  Event::Dispatcher& dispatcher = connection().dispatcher();
+  conn_state_ = nullptr;
+  conn_data_.reset();
+  dispatcher.deferredDelete(removeFromList(connections_));
+}
+
+ConnectionMultiplexer::ConnectionMultiplexer(ThreadLocal::SlotAllocator& tls)
+    : tls_(tls.allocateSlot()) {
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalConnections>();
+  });
+}
+
+MultiplexedConnection* ConnectionMultiplexer::connection(const std::string& key,
+                                                         uint32_t max_requests) {
+  auto& local = tls_->getTyped<ThreadLocalConnections>();
+  auto it = local.connections_.find(key);
+  if (it == local.connections_.end()) {
+    return nullptr;
+  }
+
+  // Fill the oldest connections first, so that the others are released when the load drops.
+  for (auto& connection : it->second) {
+    if (connection->activeRequests() < max_requests) {
+      return connection.get();
+    }
+  }
+  return nullptr;
+}
+
+MultiplexedConnection&
+ConnectionMultiplexer::addConnection(const std::string& key,
+                                     Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                                     Upstream::HostDescriptionConstSharedPtr host,
+                                     TransportType transport, ProtocolType protocol) {
+  auto& connections = tls_->getTyped<ThreadLocalConnections>().connections_[key];
+  MultiplexedConnectionPtr connection = std::make_unique<MultiplexedConnection>(
+      connections, std::move(conn_data), host, transport, protocol);
+  connection->moveIntoListBack(std::move(connection), connections);
+  return *connections.back();
+}
+
+std::string ConnectionMultiplexer::key(const std::string& cluster_name, TransportType transport,
+                                       ProtocolType protocol) {
+  return fmt::format("{}/{}/{}", cluster_name, TransportNames::get().fromType(transport),
+                     ProtocolNames::get().fromType(protocol));
+}
+
+} // namespace Router
+} // namespace ThriftProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/tcp/conn_pool.h"
+#include "envoy/thread_local/thread_local.h"
+#include "envoy/upstream/host_description.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/linked_object.h"
+#include "common/common/logger.h"
+
+#include "extensions/filters/network/thrift_proxy/conn_state.h"
+#include "extensions/filters/network/thrift_proxy/protocol.h"
+#include "extensions/filters/network/thrift_proxy/transport.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace ThriftProxy {
+namespace Router {
+
+class MultiplexedConnection;
+typedef std::unique_ptr<MultiplexedConnection> MultiplexedConnectionPtr;
+typedef std::list<MultiplexedConnectionPtr> MultiplexedConnectionList;
+
+/**
+ * MultiplexedConnection carries the requests of many routers over a single upstream connection
+ * using the framed or header transport. Each request gets a sequence id that is unique on the
+ * connection, and each response frame is handed to the request with the frame's sequence id.
+ */
+class MultiplexedConnection : public Tcp::ConnectionPool::UpstreamCallbacks,
+                              public Event::DeferredDeletable,
+                              public LinkedObject<MultiplexedConnection>,
+                              Logger::Loggable<Logger::Id::thrift> {
+public:
+  MultiplexedConnection(MultiplexedConnectionList& connections,
+                        Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                        Upstream::HostDescriptionConstSharedPtr host, TransportType transport,
+                        ProtocolType protocol);
+
+  /**
+   * Add a request to the connection.
+   * @param callbacks supplies the callbacks receiving the response frame of the request, or the
+   *        event that closed the connection before the request was removed.
+   * @return int32_t the sequence id of the request on the connection.
+   */
+  int32_t addRequest(Tcp::ConnectionPool::UpstreamCallbacks& callbacks);
+
+  /**
+   * Remove a request from the connection, once its response is complete or when it is reset. The
+   * connection is released to its pool once it carries no request. A request whose response
+   * wasn't received closes the connection on release, since the response may still arrive.
+   * @param sequence_id supplies the sequence id of the request.
+   */
+  void removeRequest(int32_t sequence_id);
+
+  /**
+   * @return uint32_t the number of requests carried by the connection.
+   */
+  uint32_t activeRequests() const { return requests_.size(); }
+
+  Network::ClientConnection& connection() { return conn_data_->connection(); }
+  const Upstream::HostDescriptionConstSharedPtr& host() const { return host_; }
+
+  // Tcp::ConnectionPool::UpstreamCallbacks
+  void onUpstreamData(Buffer::Instance& data, bool end_stream) override;
+  void onEvent(Network::ConnectionEvent event) override;
+  void onAboveWriteBufferHighWatermark() override {}
+  void onBelowWriteBufferLowWatermark() override {}
+
+private:
+  struct ActiveRequest {
+    Tcp::ConnectionPool::UpstreamCallbacks* callbacks_;
+    bool response_received_;
+  };
+
+  // The bytes of the start of a frame that usually hold its message begin.
+  static constexpr uint64_t FramePeekLength = 256;
+
+  absl::optional<int32_t> sequenceId(const Buffer::Instance& frame);
+  void release();
+
+  MultiplexedConnectionList& connections_;
+  Tcp::ConnectionPool::ConnectionDataPtr conn_data_;
+  Upstream::HostDescriptionConstSharedPtr host_;
+  ThriftConnectionState* conn_state_{};
+  TransportPtr transport_;
+  ProtocolPtr protocol_;
+  std::unordered_map<int32_t, ActiveRequest> requests_;
+  Buffer::OwnedImpl response_buffer_;
+  bool dispatching_{};
+  bool reusable_{true};
+  bool released_{};
+};
+
+/**
+ * ConnectionMultiplexer tracks the multiplexed upstream connections of each worker, by cluster and
+ * upstream encoding.
+ */
+class ConnectionMultiplexer {
+public:
+  ConnectionMultiplexer(ThreadLocal::SlotAllocator& tls);
+
+  /**
+   * @param key supplies the cluster and upstream encoding of the request.
+   * @param max_requests supplies the maximum number of requests carried by a connection.
+   * @return MultiplexedConnection* a connection of this worker carrying fewer than max_requests
+   *         requests, or nullptr if there is none.
+   */
+  MultiplexedConnection* connection(const std::string& key, uint32_t max_requests);
+
+  /**
+   * Start multiplexing requests over a new upstream connection of this worker.
+   * @param key supplies the cluster and upstream encoding of the connection's requests.
+   * @param conn_data supplies the upstream connection.
+   * @param host supplies the upstream host of the connection.
+   * @param transport supplies the transport of the connection.
+   * @param protocol supplies the protocol of the connection.
+   * @return MultiplexedConnection& the connection, which is destroyed once released.
+   */
+  MultiplexedConnection& addConnection(const std::string& key,
+                                       Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                                       Upstream::HostDescriptionConstSharedPtr host,
+                                       TransportType transport, ProtocolType protocol);
+
+  /**
+   * @return std::string the key of the connections multiplexing the requests to a cluster that use
+   *         the given upstream encoding.
+   */
+  static std::string key(const std::string& cluster_name, TransportType transport,
+                         ProtocolType protocol);
+
+private:
+  struct ThreadLocalConnections : public ThreadLocal::ThreadLocalObject {
+    std::unordered_map<std::string, MultiplexedConnectionList> connections_;
+  };
+
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<ConnectionMultiplexer> ConnectionMultiplexerSharedPtr;
+
+} // namespace Router
+} // namespace ThriftProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
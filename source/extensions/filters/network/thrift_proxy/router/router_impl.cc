@@ -238,13 +238,14 @@ FilterStatus Router::messageBegin(MessageMetadataSharedPtr metadata) {
       cluster_->extensionProtocolOptionsTyped<ProtocolOptionsConfig>(
           NetworkFilterNames::get().ThriftProxy);
 
-  const TransportType transport = options
-                                      ? options->transport(callbacks_->downstreamTransportType())
-                                      : callbacks_->downstreamTransportType();
+  const TransportType downstream_transport = callbacks_->downstreamTransportType();
+  const TransportType transport =
+      options ? options->transport(downstream_transport) : downstream_transport;
   ASSERT(transport != TransportType::Auto);
 
-  const ProtocolType protocol = options ? options->protocol(callbacks_->downstreamProtocolType())
-                                        : callbacks_->downstreamProtocolType();
+  const ProtocolType downstream_protocol = callbacks_->downstreamProtocolType();
+  const ProtocolType protocol =
+      options ? options->protocol(downstream_protocol) : downstream_protocol;
   ASSERT(protocol != ProtocolType::Auto);
 
   Tcp::ConnectionPool::Instance* conn_pool = cluster_manager_.tcpConnPoolForCluster(
@@ -257,10 +258,26 @@ FilterStatus Router::messageBegin(MessageMetadataSharedPtr metadata) {
     return FilterStatus::StopIteration;
   }
 
+  // The request may only be passed through when it is sent upstream in its original encoding. The
+  // twitter protocol rewrites the request header that precedes each of its messages.
+  passthrough_supported_ = transport == downstream_transport &&
+                           protocol == downstream_protocol && protocol != ProtocolType::Twitter;
+
+  // A request may share an upstream connection with the requests of other downstream connections
+  // if its response frame is told apart by sequence id, and if it doesn't need a specific subset
+  // of the cluster's hosts. Oneway requests keep exclusive connections, as there is no response to
+  // release the connection with.
+  uint32_t max_multiplexed_requests = 0;
+  if (options != nullptr && metadata->messageType() == MessageType::Call &&
+      (transport == TransportType::Framed || transport == TransportType::Header) &&
+      protocol != ProtocolType::Twitter && route_entry_->metadataMatchCriteria() == nullptr) {
+    max_multiplexed_requests = options->maxConcurrentRequestsPerConnection();
+  }
+
   ENVOY_STREAM_LOG(debug, "router decoding request", *callbacks_);
 
-  upstream_request_ =
-      std::make_unique<UpstreamRequest>(*this, *conn_pool, metadata, transport, protocol);
+  upstream_request_ = std::make_unique<UpstreamRequest>(*this, *conn_pool, metadata, transport,
+                                                        protocol, max_multiplexed_requests);
   return upstream_request_->start();
 }
 
@@ -273,7 +290,7 @@ FilterStatus Router::messageEnd() {
 
   upstream_request_->transport_->encodeFrame(transport_buffer, *upstream_request_->metadata_,
                                              upstream_request_buffer_);
-  upstream_request_->conn_data_->connection().write(transport_buffer, false);
+  upstream_request_->connection().write(transport_buffer, false);
   upstream_request_->onRequestComplete();
   return FilterStatus::Continue;
 }
@@ -318,7 +335,8 @@ void Router::onUpstreamData(Buffer::Instance& data, bool end_stream) {
     }
   }
 
-  if (end_stream) {
+  // Multiplexed connections hand over whole response frames.
+  if (end_stream || upstream_request_->multiplexed_conn_ != nullptr) {
     // Response is incomplete, but no more data is coming.
     ENVOY_STREAM_LOG(debug, "response underflow", *callbacks_);
     upstream_request_->onResponseComplete();
@@ -331,6 +349,9 @@ void Router::onUpstreamData(Buffer::Instance& data, bool end_stream) {
 void Router::onEvent(Network::ConnectionEvent event) {
   ASSERT(upstream_request_ && !upstream_request_->response_complete_);
 
+  // A multiplexed connection forgets its requests when it is closed.
+  upstream_request_->multiplexed_conn_ = nullptr;
+
   switch (event) {
   case Network::ConnectionEvent::RemoteClose:
     upstream_request_->onResetStream(
@@ -362,15 +383,31 @@ void Router::cleanup() { upstream_request_.reset(); }
 
 Router::UpstreamRequest::UpstreamRequest(Router& parent, Tcp::ConnectionPool::Instance& pool,
                                          MessageMetadataSharedPtr& metadata,
-                                         TransportType transport_type, ProtocolType protocol_type)
+                                         TransportType transport_type, ProtocolType protocol_type,
+                                         uint32_t max_multiplexed_requests)
     : parent_(parent), conn_pool_(pool), metadata_(metadata),
+      max_multiplexed_requests_(max_multiplexed_requests),
       transport_(NamedTransportConfigFactory::getFactory(transport_type).createTransport()),
       protocol_(NamedProtocolConfigFactory::getFactory(protocol_type).createProtocol()),
-      request_complete_(false), response_started_(false), response_complete_(false) {}
+      request_complete_(false), response_started_(false), response_complete_(false) {
+  if (max_multiplexed_requests_ > 0) {
+    multiplex_key_ = ConnectionMultiplexer::key(parent_.route_entry_->clusterName(),
+                                                transport_type, protocol_type);
+  }
+}
 
 Router::UpstreamRequest::~UpstreamRequest() {}
 
 FilterStatus Router::UpstreamRequest::start() {
+  if (max_multiplexed_requests_ > 0) {
+    multiplexed_conn_ = parent_.multiplexer_.connection(multiplex_key_, max_multiplexed_requests_);
+    if (multiplexed_conn_ != nullptr) {
+      onUpstreamHostSelected(multiplexed_conn_->host());
+      onRequestStart(false);
+      return FilterStatus::Continue;
+    }
+  }
+
   Tcp::ConnectionPool::Cancellable* handle = conn_pool_.newConnection(*this);
   if (handle) {
     // Pause while we wait for a connection.
@@ -391,6 +428,9 @@ void Router::UpstreamRequest::resetStream() {
     conn_pool_handle_->cancel(Tcp::ConnectionPool::CancelPolicy::Default);
   }
 
+  // The connection stays open for its other requests.
+  removeMultiplexedRequest();
+
   if (conn_data_ != nullptr) {
     conn_state_ = nullptr;
     conn_data_->connection().close(Network::ConnectionCloseType::NoFlush);
@@ -413,9 +453,17 @@ void Router::UpstreamRequest::onPoolReady(Tcp::ConnectionPool::ConnectionDataPtr
   bool continue_decoding = conn_pool_handle_ != nullptr;
 
   onUpstreamHostSelected(host);
+  conn_pool_handle_ = nullptr;
+
+  if (max_multiplexed_requests_ > 0) {
+    multiplexed_conn_ = &parent_.multiplexer_.addConnection(
+        multiplex_key_, std::move(conn_data), host, transport_->type(), protocol_->type());
+    onRequestStart(continue_decoding);
+    return;
+  }
+
   conn_data_ = std::move(conn_data);
   conn_data_->addUpstreamCallbacks(parent_);
-  conn_pool_handle_ = nullptr;
 
   conn_state_ = conn_data_->connectionStateTyped<ThriftConnectionState>();
   if (conn_state_ == nullptr) {
@@ -438,7 +486,12 @@ void Router::UpstreamRequest::onPoolReady(Tcp::ConnectionPool::ConnectionDataPtr
 void Router::UpstreamRequest::onRequestStart(bool continue_decoding) {
   parent_.initProtocolConverter(*protocol_, parent_.upstream_request_buffer_);
 
-  metadata_->setSequenceId(conn_state_->nextSequenceId());
+  if (multiplexed_conn_ != nullptr) {
+    multiplexed_sequence_id_ = multiplexed_conn_->addRequest(parent_);
+    metadata_->setSequenceId(multiplexed_sequence_id_);
+  } else {
+    metadata_->setSequenceId(conn_state_->nextSequenceId());
+  }
   parent_.convertMessageBegin(metadata_);
 
   if (continue_decoding) {
@@ -450,10 +503,25 @@ void Router::UpstreamRequest::onRequestComplete() { request_complete_ = true; }
 
 void Router::UpstreamRequest::onResponseComplete() {
   response_complete_ = true;
+  removeMultiplexedRequest();
   conn_state_ = nullptr;
   conn_data_.reset();
 }
 
+Network::ClientConnection& Router::UpstreamRequest::connection() {
+  if (multiplexed_conn_ != nullptr) {
+    return multiplexed_conn_->connection();
+  }
+  return conn_data_->connection();
+}
+
+void Router::UpstreamRequest::removeMultiplexedRequest() {
+  if (multiplexed_conn_ != nullptr) {
+    multiplexed_conn_->removeRequest(multiplexed_sequence_id_);
+    multiplexed_conn_ = nullptr;
+  }
+}
+
 void Router::UpstreamRequest::onUpstreamHostSelected(Upstream::HostDescriptionConstSharedPtr host) {
   upstream_host_ = host;
 }
@@ -15,6 +15,7 @@
 
 #include "extensions/filters/network/thrift_proxy/conn_manager.h"
 #include "extensions/filters/network/thrift_proxy/filters/filter.h"
+#include "extensions/filters/network/thrift_proxy/router/connection_multiplexer.h"
 #include "extensions/filters/network/thrift_proxy/router/router.h"
 #include "extensions/filters/network/thrift_proxy/router/router_ratelimit_impl.h"
 #include "extensions/filters/network/thrift_proxy/thrift_object.h"
@@ -140,7 +141,8 @@ class Router : public Tcp::ConnectionPool::UpstreamCallbacks,
                public ThriftFilters::DecoderFilter,
                Logger::Loggable<Logger::Id::thrift> {
 public:
-  Router(Upstream::ClusterManager& cluster_manager) : cluster_manager_(cluster_manager) {}
+  Router(Upstream::ClusterManager& cluster_manager, ConnectionMultiplexer& multiplexer)
+      : cluster_manager_(cluster_manager), multiplexer_(multiplexer) {}
 
   ~Router() {}
 
@@ -153,6 +155,7 @@ public:
   FilterStatus transportEnd() override;
   FilterStatus messageBegin(MessageMetadataSharedPtr metadata) override;
   FilterStatus messageEnd() override;
+  bool passthroughSupported() const override { return passthrough_supported_; }
 
   // Upstream::LoadBalancerContext
   const Network::Connection* downstreamConnection() const override;
@@ -173,11 +176,12 @@ private:
   struct UpstreamRequest : public Tcp::ConnectionPool::Callbacks {
     UpstreamRequest(Router& parent, Tcp::ConnectionPool::Instance& pool,
                     MessageMetadataSharedPtr& metadata, TransportType transport_type,
-                    ProtocolType protocol_type);
+                    ProtocolType protocol_type, uint32_t max_multiplexed_requests);
     ~UpstreamRequest();
 
     FilterStatus start();
     void resetStream();
+    Network::ClientConnection& connection();
 
     // Tcp::ConnectionPool::Callbacks
     void onPoolFailure(Tcp::ConnectionPool::PoolFailureReason reason,
@@ -190,10 +194,17 @@ private:
     void onResponseComplete();
     void onUpstreamHostSelected(Upstream::HostDescriptionConstSharedPtr host);
     void onResetStream(Tcp::ConnectionPool::PoolFailureReason reason);
+    void removeMultiplexedRequest();
 
     Router& parent_;
     Tcp::ConnectionPool::Instance& conn_pool_;
     MessageMetadataSharedPtr metadata_;
+    // The request is multiplexed over a shared upstream connection if max_multiplexed_requests_ is
+    // not 0, in which case conn_data_ is unused.
+    const uint32_t max_multiplexed_requests_;
+    std::string multiplex_key_;
+    MultiplexedConnection* multiplexed_conn_{};
+    int32_t multiplexed_sequence_id_{};
 
     Tcp::ConnectionPool::Cancellable* conn_pool_handle_{};
     Tcp::ConnectionPool::ConnectionDataPtr conn_data_;
@@ -212,6 +223,7 @@ private:
   void cleanup();
 
   Upstream::ClusterManager& cluster_manager_;
+  ConnectionMultiplexer& multiplexer_;
 
   ThriftFilters::DecoderFilterCallbacks* callbacks_{};
   RouteConstSharedPtr route_{};
@@ -220,6 +232,7 @@ private:
 
   std::unique_ptr<UpstreamRequest> upstream_request_;
   Buffer::OwnedImpl upstream_request_buffer_;
+  bool passthrough_supported_{};
 };
 
 } // namespace Router
@@ -28,9 +28,12 @@ NetworkFilters::ZooKeeperProxy::ZooKeeperConfigFactory::createFilterFactoryFromP
   const std::string stat_prefix = fmt::format("{}.zookeeper.", proto_config.stat_prefix());
   const uint32_t max_packet_bytes =
       PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, max_packet_bytes, 1024 * 1024);
+  const bool emit_dynamic_metadata =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, emit_dynamic_metadata, true);
 
-  ZooKeeperFilterConfigSharedPtr filter_config(
-      std::make_shared<ZooKeeperFilterConfig>(stat_prefix, max_packet_bytes, context.scope()));
+  ZooKeeperFilterConfigSharedPtr filter_config(std::make_shared<ZooKeeperFilterConfig>(
+      stat_prefix, max_packet_bytes, emit_dynamic_metadata, context.scope(),
+      context.dispatcher().timeSource()));
   return [filter_config](Network::FilterManager& filter_manager) -> void {
     filter_manager.addFilter(std::make_shared<ZooKeeperFilter>(filter_config));
   };
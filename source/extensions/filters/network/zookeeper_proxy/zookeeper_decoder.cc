@@ -1,5 +1,10 @@
 #include "extensions/filters/network/zookeeper_proxy/zookeeper_decoder.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "common/common/byte_order.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
@@ -67,17 +72,21 @@ void DecoderImpl::decode(Buffer::Instance& data, uint64_t& offset) {
   switch (static_cast<XidCodes>(xid)) {
   case XidCodes::CONNECT_XID:
     parseConnect(data, offset, len);
+    trackRequest(xid, OpCodes::CONNECT);
     return;
   case XidCodes::PING_XID:
     offset += OPCODE_LENGTH;
     callbacks_.onPing();
+    trackRequest(xid, OpCodes::PING);
     return;
   case XidCodes::AUTH_XID:
     parseAuthRequest(data, offset, len);
+    trackRequest(xid, OpCodes::SETAUTH);
     return;
   case XidCodes::SET_WATCHES_XID:
     offset += OPCODE_LENGTH;
     parseSetWatchesRequest(data, offset, len);
+    trackRequest(xid, OpCodes::SETWATCHES);
     return;
   default:
     // WATCH_XID is generated by the server, so that and everything
@@ -156,6 +165,50 @@ void DecoderImpl::decode(Buffer::Instance& data, uint64_t& offset) {
   default:
     throw EnvoyException(fmt::format("Unknown opcode: {}", opcode));
   }
+
+  trackRequest(xid, static_cast<OpCodes>(opcode));
+}
+
+void DecoderImpl::trackRequest(const int32_t xid, const OpCodes opcode) {
+  // The requests are only timed while their responses can be matched up with them.
+  if (decode_responses_) {
+    requests_by_xid_[xid] = {opcode, time_source_.monotonicTime()};
+  }
+}
+
+void DecoderImpl::decodeResponse() {
+  int32_t len;
+  int32_t xid;
+  memcpy(&len, response_prefix_, sizeof(len));
+  memcpy(&xid, response_prefix_ + INT_LENGTH, sizeof(xid));
+  len = fromEndianness<ByteOrder::BigEndian>(len);
+  xid = fromEndianness<ByteOrder::BigEndian>(xid);
+
+  ensureMinLength(len, XID_LENGTH);
+  ensureMaxLength(len);
+
+  // The rest of the response, i.e. its zxid, error and body, is skipped.
+  response_bytes_to_skip_ = len - XID_LENGTH;
+  callbacks_.onResponseBytes(INT_LENGTH + len);
+
+  if (static_cast<XidCodes>(xid) == XidCodes::WATCH_XID) {
+    callbacks_.onWatchEvent();
+    return;
+  }
+
+  // Connect responses have no xid, but their protocol version takes its place just like it does
+  // in connect requests, so they are matched up with them as CONNECT_XID.
+  const auto it = requests_by_xid_.find(xid);
+  if (it == requests_by_xid_.end()) {
+    // E.g. the response to a request that failed to decode.
+    return;
+  }
+  const std::chrono::milliseconds latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+      time_source_.monotonicTime() - it->second.start_time);
+  const OpCodes opcode = it->second.opcode;
+  requests_by_xid_.erase(it);
+
+  callbacks_.onResponse(opcode, latency);
 }
 
 void DecoderImpl::ensureMinLength(const int32_t len, const int32_t minlen) const {
@@ -193,7 +246,8 @@ void DecoderImpl::parseAuthRequest(Buffer::Instance& data, uint64_t& offset, uin
 
   // Skip opcode + type.
   offset += OPCODE_LENGTH + INT_LENGTH;
-  const std::string scheme = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& scheme = string_;
   // Skip credential.
   skipString(data, offset);
 
@@ -203,7 +257,8 @@ void DecoderImpl::parseAuthRequest(Buffer::Instance& data, uint64_t& offset, uin
 void DecoderImpl::parseGetDataRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len) {
   ensureMinLength(len, XID_LENGTH + OPCODE_LENGTH + INT_LENGTH + BOOL_LENGTH);
 
-  const std::string path = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& path = string_;
   const bool watch = helper_.peekBool(data, offset);
 
   callbacks_.onGetDataRequest(path, watch);
@@ -226,7 +281,8 @@ void DecoderImpl::parseCreateRequest(Buffer::Instance& data, uint64_t& offset, u
                                      OpCodes opcode) {
   ensureMinLength(len, XID_LENGTH + OPCODE_LENGTH + (3 * INT_LENGTH));
 
-  const std::string path = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& path = string_;
 
   // Skip data.
   skipString(data, offset);
@@ -239,7 +295,8 @@ void DecoderImpl::parseCreateRequest(Buffer::Instance& data, uint64_t& offset, u
 void DecoderImpl::parseSetRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len) {
   ensureMinLength(len, XID_LENGTH + OPCODE_LENGTH + (3 * INT_LENGTH));
 
-  const std::string path = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& path = string_;
   // Skip data.
   skipString(data, offset);
   // Ignore version.
@@ -252,7 +309,8 @@ void DecoderImpl::parseGetChildrenRequest(Buffer::Instance& data, uint64_t& offs
                                           const bool two) {
   ensureMinLength(len, XID_LENGTH + OPCODE_LENGTH + INT_LENGTH + BOOL_LENGTH);
 
-  const std::string path = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& path = string_;
   const bool watch = helper_.peekBool(data, offset);
 
   callbacks_.onGetChildrenRequest(path, watch, two);
@@ -261,7 +319,8 @@ void DecoderImpl::parseGetChildrenRequest(Buffer::Instance& data, uint64_t& offs
 void DecoderImpl::parseDeleteRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len) {
   ensureMinLength(len, XID_LENGTH + OPCODE_LENGTH + (2 * INT_LENGTH));
 
-  const std::string path = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& path = string_;
   const int32_t version = helper_.peekInt32(data, offset);
 
   callbacks_.onDeleteRequest(path, version);
@@ -270,7 +329,8 @@ void DecoderImpl::parseDeleteRequest(Buffer::Instance& data, uint64_t& offset, u
 void DecoderImpl::parseExistsRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len) {
   ensureMinLength(len, XID_LENGTH + OPCODE_LENGTH + INT_LENGTH + BOOL_LENGTH);
 
-  const std::string path = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& path = string_;
   const bool watch = helper_.peekBool(data, offset);
 
   callbacks_.onExistsRequest(path, watch);
@@ -279,7 +339,8 @@ void DecoderImpl::parseExistsRequest(Buffer::Instance& data, uint64_t& offset, u
 void DecoderImpl::parseGetAclRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len) {
   ensureMinLength(len, XID_LENGTH + OPCODE_LENGTH + INT_LENGTH);
 
-  const std::string path = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& path = string_;
 
   callbacks_.onGetAclRequest(path);
 }
@@ -287,22 +348,26 @@ void DecoderImpl::parseGetAclRequest(Buffer::Instance& data, uint64_t& offset, u
 void DecoderImpl::parseSetAclRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len) {
   ensureMinLength(len, XID_LENGTH + OPCODE_LENGTH + (2 * INT_LENGTH));
 
-  const std::string path = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& path = string_;
   skipAcls(data, offset);
   const int32_t version = helper_.peekInt32(data, offset);
 
   callbacks_.onSetAclRequest(path, version);
 }
 
-std::string DecoderImpl::pathOnlyRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len) {
+const std::string& DecoderImpl::pathOnlyRequest(Buffer::Instance& data, uint64_t& offset,
+                                                uint32_t len) {
   ensureMinLength(len, XID_LENGTH + OPCODE_LENGTH + INT_LENGTH);
-  return helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  return string_;
 }
 
 void DecoderImpl::parseCheckRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len) {
   ensureMinLength(len, (2 * INT_LENGTH));
 
-  const std::string path = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& path = string_;
   const int32_t version = helper_.peekInt32(data, offset);
 
   callbacks_.onCheckRequest(path, version);
@@ -372,7 +437,8 @@ void DecoderImpl::parseXWatchesRequest(Buffer::Instance& data, uint64_t& offset,
                                        OpCodes opcode) {
   ensureMinLength(len, XID_LENGTH + OPCODE_LENGTH + (2 * INT_LENGTH));
 
-  const std::string path = helper_.peekString(data, offset);
+  helper_.peekString(data, offset, string_);
+  const std::string& path = string_;
   const int32_t type = helper_.peekInt32(data, offset);
 
   if (opcode == OpCodes::CHECKWATCHES) {
@@ -409,6 +475,42 @@ void DecoderImpl::onData(Buffer::Instance& data) {
   }
 }
 
+void DecoderImpl::onWrite(Buffer::Instance& data) {
+  if (!decode_responses_) {
+    return;
+  }
+
+  uint64_t offset = 0;
+  try {
+    while (offset < data.length()) {
+      if (response_bytes_to_skip_ > 0) {
+        const uint64_t skipped = std::min(response_bytes_to_skip_, data.length() - offset);
+        offset += skipped;
+        response_bytes_to_skip_ -= skipped;
+        continue;
+      }
+
+      const uint64_t copied = std::min<uint64_t>(RESPONSE_PREFIX_LENGTH - response_prefix_length_,
+                                                 data.length() - offset);
+      data.copyOut(offset, copied, response_prefix_ + response_prefix_length_);
+      response_prefix_length_ += copied;
+      offset += copied;
+      if (response_prefix_length_ < RESPONSE_PREFIX_LENGTH) {
+        // The rest of the prefix is in the next write.
+        return;
+      }
+
+      response_prefix_length_ = 0;
+      decodeResponse();
+    }
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG(debug, "zookeeper_proxy: response decoding exception {}", e.what());
+    decode_responses_ = false;
+    requests_by_xid_.clear();
+    callbacks_.onDecodeError();
+  }
+}
+
 } // namespace ZooKeeperProxy
 } // namespace NetworkFilters
 } // namespace Extensions
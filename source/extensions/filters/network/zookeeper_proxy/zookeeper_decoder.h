@@ -1,7 +1,11 @@
 #pragma once
+#include <chrono>
 #include <cstdint>
+#include <string>
+#include <unordered_map>
 
 #include "envoy/common/platform.h"
+#include "envoy/common/time.h"
 
 #include "common/buffer/buffer_impl.h"
 #include "common/common/logger.h"
@@ -93,6 +97,9 @@ public:
   virtual void onCheckWatchesRequest(const std::string& path, int32_t type) PURE;
   virtual void onRemoveWatchesRequest(const std::string& path, int32_t type) PURE;
   virtual void onCloseRequest() PURE;
+  virtual void onResponseBytes(uint64_t bytes) PURE;
+  virtual void onResponse(OpCodes opcode, std::chrono::milliseconds latency) PURE;
+  virtual void onWatchEvent() PURE;
 };
 
 /**
@@ -103,20 +110,39 @@ public:
   virtual ~Decoder() {}
 
   virtual void onData(Buffer::Instance& data) PURE;
+
+  /**
+   * Decodes the responses the server writes, which are matched by xid with the requests decoded by
+   * onData() to time them.
+   */
+  virtual void onWrite(Buffer::Instance& data) PURE;
 };
 
 typedef std::unique_ptr<Decoder> DecoderPtr;
 
 class DecoderImpl : public Decoder, Logger::Loggable<Logger::Id::filter> {
 public:
-  explicit DecoderImpl(DecoderCallbacks& callbacks, uint32_t max_packet_bytes)
-      : callbacks_(callbacks), max_packet_bytes_(max_packet_bytes), helper_(max_packet_bytes) {}
+  explicit DecoderImpl(DecoderCallbacks& callbacks, uint32_t max_packet_bytes,
+                       TimeSource& time_source)
+      : callbacks_(callbacks), max_packet_bytes_(max_packet_bytes), helper_(max_packet_bytes),
+        time_source_(time_source) {}
 
   // ZooKeeperProxy::Decoder
   void onData(Buffer::Instance& data) override;
+  void onWrite(Buffer::Instance& data) override;
 
 private:
+  struct RequestBegin {
+    OpCodes opcode;
+    MonotonicTime start_time;
+  };
+
+  // The length and the xid of a response, which is all that is decoded of it.
+  static constexpr uint32_t RESPONSE_PREFIX_LENGTH = 8;
+
   void decode(Buffer::Instance& data, uint64_t& offset);
+  void decodeResponse();
+  void trackRequest(int32_t xid, OpCodes opcode);
   void parseConnect(Buffer::Instance& data, uint64_t& offset, uint32_t len);
   void parseAuthRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len);
   void parseGetDataRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len);
@@ -137,11 +163,23 @@ private:
   void skipStrings(Buffer::Instance& data, uint64_t& offset);
   void ensureMinLength(int32_t len, int32_t minlen) const;
   void ensureMaxLength(int32_t len) const;
-  std::string pathOnlyRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len);
+  const std::string& pathOnlyRequest(Buffer::Instance& data, uint64_t& offset, uint32_t len);
 
   DecoderCallbacks& callbacks_;
   const uint32_t max_packet_bytes_;
   BufferHelper helper_;
+  TimeSource& time_source_;
+  // The paths and the schemes of the requests are copied into this string, whose capacity is
+  // reused from one request to the next.
+  std::string string_;
+  std::unordered_map<int32_t, RequestBegin> requests_by_xid_;
+  // The prefix of the response being decoded, which may span several writes, and the bytes of the
+  // response that are left to skip once it is decoded.
+  char response_prefix_[RESPONSE_PREFIX_LENGTH];
+  uint32_t response_prefix_length_{};
+  uint64_t response_bytes_to_skip_{};
+  // Cleared once a response failed to decode, after which the responses are no longer in sync.
+  bool decode_responses_{true};
 };
 
 } // namespace ZooKeeperProxy
@@ -14,9 +14,12 @@ namespace NetworkFilters {
 namespace ZooKeeperProxy {
 
 ZooKeeperFilterConfig::ZooKeeperFilterConfig(const std::string& stat_prefix,
-                                             const uint32_t max_packet_bytes, Stats::Scope& scope)
-    : scope_(scope), max_packet_bytes_(max_packet_bytes), stat_prefix_(stat_prefix),
-      stats_(generateStats(stat_prefix, scope)) {}
+                                             const uint32_t max_packet_bytes,
+                                             const bool emit_dynamic_metadata, Stats::Scope& scope,
+                                             TimeSource& time_source)
+    : scope_(scope), max_packet_bytes_(max_packet_bytes),
+      emit_dynamic_metadata_(emit_dynamic_metadata), stat_prefix_(stat_prefix),
+      stats_(generateStats(stat_prefix, scope)), time_source_(time_source) {}
 
 ZooKeeperFilter::ZooKeeperFilter(ZooKeeperFilterConfigSharedPtr config)
     : config_(std::move(config)) {}
@@ -30,14 +33,21 @@ Network::FilterStatus ZooKeeperFilter::onData(Buffer::Instance& data, bool) {
   return Network::FilterStatus::Continue;
 }
 
-Network::FilterStatus ZooKeeperFilter::onWrite(Buffer::Instance&, bool) {
+Network::FilterStatus ZooKeeperFilter::onWrite(Buffer::Instance& data, bool) {
+  if (!decoder_) {
+    decoder_ = createDecoder(*this);
+  }
+
+  decoder_->onWrite(data);
   return Network::FilterStatus::Continue;
 }
 
 Network::FilterStatus ZooKeeperFilter::onNewConnection() { return Network::FilterStatus::Continue; }
 
 void ZooKeeperFilter::doDecode(Buffer::Instance& buffer) {
-  clearDynamicMetadata();
+  if (config_->emitDynamicMetadata()) {
+    clearDynamicMetadata();
+  }
 
   if (!decoder_) {
     decoder_ = createDecoder(*this);
@@ -47,10 +57,11 @@ void ZooKeeperFilter::doDecode(Buffer::Instance& buffer) {
 }
 
 DecoderPtr ZooKeeperFilter::createDecoder(DecoderCallbacks& callbacks) {
-  return std::make_unique<DecoderImpl>(callbacks, config_->maxPacketBytes());
+  return std::make_unique<DecoderImpl>(callbacks, config_->maxPacketBytes(),
+                                       config_->time_source_);
 }
 
-void ZooKeeperFilter::setDynamicMetadata(const std::string& key, const std::string& value) {
+void ZooKeeperFilter::setDynamicMetadata(absl::string_view key, absl::string_view value) {
   setDynamicMetadata({{key, value}});
 }
 
@@ -63,7 +74,11 @@ void ZooKeeperFilter::clearDynamicMetadata() {
 }
 
 void ZooKeeperFilter::setDynamicMetadata(
-    const std::vector<std::pair<const std::string, const std::string>>& data) {
+    std::initializer_list<std::pair<absl::string_view, absl::string_view>> data) {
+  if (!config_->emitDynamicMetadata()) {
+    return;
+  }
+
   envoy::api::v2::core::Metadata& dynamic_metadata =
       read_callbacks_->connection().streamInfo().dynamicMetadata();
   ProtobufWkt::Struct metadata(
@@ -72,8 +87,8 @@ void ZooKeeperFilter::setDynamicMetadata(
 
   for (const auto& pair : data) {
     auto val = ProtobufWkt::Value();
-    val.set_string_value(pair.second);
-    fields.insert({pair.first, val});
+    val.set_string_value(std::string(pair.second));
+    fields.insert({std::string(pair.first), val});
   }
 
   read_callbacks_->connection().streamInfo().setDynamicMetadata(
@@ -233,6 +248,77 @@ void ZooKeeperFilter::onCloseRequest() {
   setDynamicMetadata("opname", "close");
 }
 
+void ZooKeeperFilter::onResponseBytes(const uint64_t bytes) {
+  config_->stats_.response_bytes_.add(bytes);
+}
+
+void ZooKeeperFilter::onResponse(const OpCodes opcode, const std::chrono::milliseconds latency) {
+  Stats::Histogram* histogram = responseLatencyHistogram(opcode);
+  if (histogram != nullptr) {
+    histogram->recordValue(latency.count());
+  }
+}
+
+void ZooKeeperFilter::onWatchEvent() { config_->stats_.watch_event_.inc(); }
+
+Stats::Histogram* ZooKeeperFilter::responseLatencyHistogram(const OpCodes opcode) {
+  ZooKeeperProxyStats& stats = config_->stats_;
+  switch (opcode) {
+  case OpCodes::CONNECT:
+    return &stats.connect_response_latency_;
+  case OpCodes::GETDATA:
+    return &stats.getdata_response_latency_;
+  case OpCodes::CREATE:
+    return &stats.create_response_latency_;
+  case OpCodes::CREATE2:
+    return &stats.create2_response_latency_;
+  case OpCodes::CREATECONTAINER:
+    return &stats.createcontainer_response_latency_;
+  case OpCodes::CREATETTL:
+    return &stats.createttl_response_latency_;
+  case OpCodes::SETDATA:
+    return &stats.setdata_response_latency_;
+  case OpCodes::GETCHILDREN:
+    return &stats.getchildren_response_latency_;
+  case OpCodes::GETCHILDREN2:
+    return &stats.getchildren2_response_latency_;
+  case OpCodes::GETEPHEMERALS:
+    return &stats.getephemerals_response_latency_;
+  case OpCodes::GETALLCHILDRENNUMBER:
+    return &stats.getallchildrennumber_response_latency_;
+  case OpCodes::DELETE:
+    return &stats.remove_response_latency_;
+  case OpCodes::EXISTS:
+    return &stats.exists_response_latency_;
+  case OpCodes::GETACL:
+    return &stats.getacl_response_latency_;
+  case OpCodes::SETACL:
+    return &stats.setacl_response_latency_;
+  case OpCodes::SYNC:
+    return &stats.sync_response_latency_;
+  case OpCodes::PING:
+    return &stats.ping_response_latency_;
+  case OpCodes::MULTI:
+    return &stats.multi_response_latency_;
+  case OpCodes::RECONFIG:
+    return &stats.reconfig_response_latency_;
+  case OpCodes::CLOSE:
+    return &stats.close_response_latency_;
+  case OpCodes::SETAUTH:
+    return &stats.setauth_response_latency_;
+  case OpCodes::SETWATCHES:
+    return &stats.setwatches_response_latency_;
+  case OpCodes::CHECKWATCHES:
+    return &stats.checkwatches_response_latency_;
+  case OpCodes::REMOVEWATCHES:
+    return &stats.removewatches_response_latency_;
+  case OpCodes::CHECK:
+    return &stats.check_response_latency_;
+  default:
+    return nullptr;
+  }
+}
+
 } // namespace ZooKeeperProxy
 } // namespace NetworkFilters
 } // namespace Extensions
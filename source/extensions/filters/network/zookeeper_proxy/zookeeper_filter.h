@@ -1,6 +1,7 @@
 #pragma once
 
 #include "envoy/access_log/access_log.h"
+#include "envoy/common/time.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/filter.h"
 #include "envoy/stats/scope.h"
@@ -11,6 +12,8 @@
 
 #include "extensions/filters/network/zookeeper_proxy/zookeeper_decoder.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
@@ -20,7 +23,7 @@ namespace ZooKeeperProxy {
  * All ZooKeeper proxy stats. @see stats_macros.h
  */
 // clang-format off
-#define ALL_ZOOKEEPER_PROXY_STATS(COUNTER)                              \
+#define ALL_ZOOKEEPER_PROXY_STATS(COUNTER, HISTOGRAM)                   \
   COUNTER(decoder_error)                                                \
   COUNTER(request_bytes)                                                \
   COUNTER(connect_rq)                                                   \
@@ -49,13 +52,40 @@ namespace ZooKeeperProxy {
   COUNTER(checkwatches_rq)                                              \
   COUNTER(removewatches_rq)                                             \
   COUNTER(check_rq)                                                     \
+  COUNTER(response_bytes)                                               \
+  COUNTER(watch_event)                                                  \
+  HISTOGRAM(connect_response_latency)                                   \
+  HISTOGRAM(getdata_response_latency)                                   \
+  HISTOGRAM(create_response_latency)                                    \
+  HISTOGRAM(create2_response_latency)                                   \
+  HISTOGRAM(createcontainer_response_latency)                           \
+  HISTOGRAM(createttl_response_latency)                                 \
+  HISTOGRAM(setdata_response_latency)                                   \
+  HISTOGRAM(getchildren_response_latency)                               \
+  HISTOGRAM(getchildren2_response_latency)                              \
+  HISTOGRAM(getephemerals_response_latency)                             \
+  HISTOGRAM(getallchildrennumber_response_latency)                      \
+  HISTOGRAM(remove_response_latency)                                    \
+  HISTOGRAM(exists_response_latency)                                    \
+  HISTOGRAM(getacl_response_latency)                                    \
+  HISTOGRAM(setacl_response_latency)                                    \
+  HISTOGRAM(sync_response_latency)                                      \
+  HISTOGRAM(ping_response_latency)                                      \
+  HISTOGRAM(multi_response_latency)                                     \
+  HISTOGRAM(reconfig_response_latency)                                  \
+  HISTOGRAM(close_response_latency)                                     \
+  HISTOGRAM(setauth_response_latency)                                   \
+  HISTOGRAM(setwatches_response_latency)                                \
+  HISTOGRAM(checkwatches_response_latency)                              \
+  HISTOGRAM(removewatches_response_latency)                             \
+  HISTOGRAM(check_response_latency)                                     \
 // clang-format on
 
 /**
  * Struct definition for all ZooKeeper proxy stats. @see stats_macros.h
  */
 struct ZooKeeperProxyStats {
-  ALL_ZOOKEEPER_PROXY_STATS(GENERATE_COUNTER_STRUCT)
+  ALL_ZOOKEEPER_PROXY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -63,21 +93,24 @@ struct ZooKeeperProxyStats {
  */
 class ZooKeeperFilterConfig {
 public:
-  ZooKeeperFilterConfig(const std::string &stat_prefix, uint32_t max_packet_bytes, Stats::Scope& scope);
+  ZooKeeperFilterConfig(const std::string& stat_prefix, uint32_t max_packet_bytes,
+                        bool emit_dynamic_metadata, Stats::Scope& scope, TimeSource& time_source);
 
   const ZooKeeperProxyStats& stats() { return stats_; }
   uint32_t maxPacketBytes() const { return max_packet_bytes_; }
+  bool emitDynamicMetadata() const { return emit_dynamic_metadata_; }
 
   Stats::Scope& scope_;
   const uint32_t max_packet_bytes_;
+  const bool emit_dynamic_metadata_;
   const std::string stat_prefix_;
   ZooKeeperProxyStats stats_;
+  TimeSource& time_source_;
 
 private:
-  ZooKeeperProxyStats generateStats(const std::string& prefix,
-                                Stats::Scope& scope) {
-    return ZooKeeperProxyStats{
-        ALL_ZOOKEEPER_PROXY_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  ZooKeeperProxyStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return ZooKeeperProxyStats{ALL_ZOOKEEPER_PROXY_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                                         POOL_HISTOGRAM_PREFIX(scope, prefix))};
   }
 };
 
@@ -122,14 +155,20 @@ public:
   void onGetEphemeralsRequest(const std::string& path) override;
   void onGetAllChildrenNumberRequest(const std::string& path) override;
   void onCloseRequest() override;
+  void onResponseBytes(uint64_t bytes) override;
+  void onResponse(OpCodes opcode, std::chrono::milliseconds latency) override;
+  void onWatchEvent() override;
 
   void doDecode(Buffer::Instance& buffer);
   DecoderPtr createDecoder(DecoderCallbacks& callbacks);
-  void setDynamicMetadata(const std::string& key, const std::string& value);
-  void setDynamicMetadata(const std::vector<std::pair<const std::string, const std::string>>& data);
+  void setDynamicMetadata(absl::string_view key, absl::string_view value);
+  void
+  setDynamicMetadata(std::initializer_list<std::pair<absl::string_view, absl::string_view>> data);
   void clearDynamicMetadata();
 
 private:
+  Stats::Histogram* responseLatencyHistogram(OpCodes opcode);
+
   Network::ReadFilterCallbacks* read_callbacks_{};
   ZooKeeperFilterConfigSharedPtr config_;
   std::unique_ptr<Decoder> decoder_;
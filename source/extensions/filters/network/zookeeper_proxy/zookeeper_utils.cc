@@ -30,12 +30,12 @@ bool BufferHelper::peekBool(Buffer::Instance& buffer, uint64_t& offset) {
   return val;
 }
 
-std::string BufferHelper::peekString(Buffer::Instance& buffer, uint64_t& offset) {
-  std::string val;
+void BufferHelper::peekString(Buffer::Instance& buffer, uint64_t& offset, std::string& str) {
+  str.clear();
   uint32_t len = peekInt32(buffer, offset);
 
   if (len == 0) {
-    return val;
+    return;
   }
 
   if (buffer.length() < (offset + len)) {
@@ -44,12 +44,10 @@ std::string BufferHelper::peekString(Buffer::Instance& buffer, uint64_t& offset)
 
   ensureMaxLen(len);
 
-  std::unique_ptr<char[]> data(new char[len]);
-  buffer.copyOut(offset, len, data.get());
-  val.assign(data.get(), len);
+  // The string is copied straight out of the slices it spans.
+  str.resize(len);
+  buffer.copyOut(offset, len, &str[0]);
   offset += len;
-
-  return val;
 }
 
 void BufferHelper::skip(const uint32_t len, uint64_t& offset) {
@@ -27,7 +27,8 @@ public:
 
   int32_t peekInt32(Buffer::Instance& buffer, uint64_t& offset);
   int64_t peekInt64(Buffer::Instance& buffer, uint64_t& offset);
-  std::string peekString(Buffer::Instance& buffer, uint64_t& offset);
+  // Copies the string into str, whose capacity is reused.
+  void peekString(Buffer::Instance& buffer, uint64_t& offset, std::string& str);
   bool peekBool(Buffer::Instance& buffer, uint64_t& offset);
   void skip(uint32_t len, uint64_t& offset);
   void reset() { current_ = 0; }
@@ -0,0 +1,43 @@
+#include "extensions/filters/udp/udp_proxy/config.h"
+
+#include "envoy/config/filter/udp/udp_proxy/v2alpha/udp_proxy.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
+#include "extensions/filters/udp/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+
+Network::UdpListenerFilterFactoryCb UdpProxyFilterConfigFactory::createFilterFactoryFromProto(
+    const Protobuf::Message& config, Server::Configuration::ListenerFactoryContext& context) {
+  const auto& proto_config = MessageUtil::downcastAndValidate<
+      const envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig&>(config);
+  UdpProxyFilterConfigSharedPtr filter_config = std::make_shared<const UdpProxyFilterConfig>(
+      proto_config, context.clusterManager(), context.timeSource(), context.scope());
+  return [filter_config](Network::UdpListenerFilterManager& filter_manager,
+                         Network::UdpReadFilterCallbacks& callbacks) -> void {
+    filter_manager.addReadFilter(std::make_unique<UdpProxyFilter>(callbacks, filter_config));
+  };
+}
+
+ProtobufTypes::MessagePtr UdpProxyFilterConfigFactory::createEmptyConfigProto() {
+  return std::make_unique<envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig>();
+}
+
+std::string UdpProxyFilterConfigFactory::name() { return UdpFilterNames::get().UdpProxy; }
+
+/**
+ * Static registration for the UDP proxy filter. @see RegisterFactory.
+ */
+REGISTER_FACTORY(UdpProxyFilterConfigFactory,
+                 Server::Configuration::NamedUdpListenerFilterConfigFactory);
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,224 @@
+#include "extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/upstream/thread_local_cluster.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+namespace {
+
+constexpr std::chrono::milliseconds DefaultIdleTimeout{60000};
+
+} // namespace
+
+UdpProxyFilterConfig::UdpProxyFilterConfig(
+    const envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig& config,
+    Upstream::ClusterManager& cluster_manager, TimeSource& time_source, Stats::Scope& scope)
+    : cluster_(config.cluster()),
+      idle_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config, idle_timeout, DefaultIdleTimeout.count())),
+      use_gro_(config.use_gro()), cluster_manager_(cluster_manager), time_source_(time_source),
+      stats_(generateStats(fmt::format("udp.{}.", config.stat_prefix()), scope)) {}
+
+UdpProxyStats UdpProxyFilterConfig::generateStats(const std::string& prefix, Stats::Scope& scope) {
+  return {ALL_UDP_PROXY_STATS(POOL_COUNTER_PREFIX(scope, prefix), POOL_GAUGE_PREFIX(scope, prefix),
+                              POOL_HISTOGRAM_PREFIX(scope, prefix))};
+}
+
+UdpProxyFilter::UdpProxyFilter(Network::UdpReadFilterCallbacks& callbacks,
+                               const UdpProxyFilterConfigSharedPtr& config)
+    : read_callbacks_(callbacks), config_(config), upstream_batch_(config->useGro()) {}
+
+void UdpProxyFilter::onData(Network::UdpData& data) {
+  config_->stats().downstream_rx_datagrams_.inc();
+
+  ActiveSession* session;
+  auto it = sessions_.find(data.peer_address_->asString());
+  if (it != sessions_.end()) {
+    session = it->second.get();
+  } else {
+    session = createSession(data.peer_address_);
+    if (session == nullptr) {
+      return;
+    }
+  }
+
+  if (session->write(std::move(data.buffer_))) {
+    pending_sessions_.push_back(session);
+  }
+}
+
+void UdpProxyFilter::onReceiveBatchComplete(uint32_t datagrams) {
+  config_->stats().downstream_rx_datagrams_per_batch_.recordValue(datagrams);
+  for (ActiveSession* session : pending_sessions_) {
+    session->flush();
+  }
+  pending_sessions_.clear();
+}
+
+UdpProxyFilter::ActiveSession*
+UdpProxyFilter::createSession(const Network::Address::InstanceConstSharedPtr& peer) {
+  Upstream::ThreadLocalCluster* cluster = config_->clusterManager().get(config_->cluster());
+  if (cluster == nullptr) {
+    ENVOY_LOG(debug, "udp proxy: unknown cluster '{}'", config_->cluster());
+    config_->stats().downstream_sess_no_route_.inc();
+    return nullptr;
+  }
+
+  Upstream::HostConstSharedPtr host = cluster->loadBalancer().chooseHost(nullptr);
+  if (host == nullptr) {
+    ENVOY_LOG(debug, "udp proxy: no healthy host in cluster '{}'", config_->cluster());
+    config_->stats().upstream_no_healthy_host_.inc();
+    return nullptr;
+  }
+
+  ActiveSessionPtr session = std::make_unique<ActiveSession>(*this, peer, std::move(host));
+  if (!session->connected()) {
+    config_->stats().upstream_connect_errors_.inc();
+    return nullptr;
+  }
+
+  ActiveSession* active_session = session.get();
+  sessions_.emplace(peer->asString(), std::move(session));
+  return active_session;
+}
+
+void UdpProxyFilter::removeSession(ActiveSession& session) {
+  // Sessions are only removed by their idle timer, outside of the batches of the listener.
+  ASSERT(pending_sessions_.empty());
+
+  auto it = sessions_.find(session.key());
+  ASSERT(it != sessions_.end() && it->second.get() == &session);
+  // The session may be removed from its own timer callback, so it is deleted once the callback
+  // has returned.
+  session.close();
+  read_callbacks_.udpListener().dispatcher().deferredDelete(std::move(it->second));
+  sessions_.erase(it);
+}
+
+UdpProxyFilter::ActiveSession::ActiveSession(UdpProxyFilter& parent,
+                                             const Network::Address::InstanceConstSharedPtr& peer,
+                                             Upstream::HostConstSharedPtr&& host)
+    : parent_(parent), config_(parent.config_), peer_(peer), host_(std::move(host)),
+      io_handle_(host_->address()->socket(Network::Address::SocketType::Datagram)),
+      last_activity_(config_->timeSource().monotonicTime()) {
+  const Api::SysCallIntResult result = host_->address()->connect(io_handle_->fd());
+  if (result.rc_ != 0) {
+    ENVOY_LOG(debug, "udp proxy: failed to connect to {}: {}", host_->address()->asString(),
+              result.errno_);
+    return;
+  }
+  connected_ = true;
+  config_->stats().downstream_sess_total_.inc();
+  config_->stats().downstream_sess_active_.inc();
+
+  if (config_->useGro() && !Network::UdpPacketBatch::enableGro(io_handle_->fd())) {
+    ENVOY_LOG(debug, "udp proxy: UDP GRO is not supported for {}", host_->address()->asString());
+  }
+
+  Event::Dispatcher& dispatcher = parent_.read_callbacks_.udpListener().dispatcher();
+  file_event_ = dispatcher.createFileEvent(
+      io_handle_->fd(), [this](uint32_t) { onReadReady(); }, Event::FileTriggerType::Edge,
+      Event::FileReadyType::Read);
+  idle_timer_ = dispatcher.createCoarseTimer([this]() { onIdleTimer(); });
+  idle_timer_->enableTimer(config_->idleTimeout());
+}
+
+UdpProxyFilter::ActiveSession::~ActiveSession() {
+  if (connected_) {
+    config_->stats().downstream_sess_active_.dec();
+  }
+}
+
+bool UdpProxyFilter::ActiveSession::write(Buffer::InstancePtr&& datagram) {
+  last_activity_ = config_->timeSource().monotonicTime();
+  pending_datagrams_.emplace_back(std::move(datagram));
+  return pending_datagrams_.size() == 1;
+}
+
+void UdpProxyFilter::ActiveSession::flush() {
+  const Api::SysCallIntResult result =
+      Network::UdpPacketBatch::send(io_handle_->fd(), pending_datagrams_);
+  const uint64_t sent = result.rc_ > 0 ? result.rc_ : 0;
+  config_->stats().upstream_tx_datagrams_.add(sent);
+  if (sent < pending_datagrams_.size()) {
+    // The datagrams that weren't sent are dropped, as the network would.
+    ENVOY_LOG(trace, "udp proxy: failed to send to {}: {}", host_->address()->asString(),
+              result.errno_);
+    config_->stats().upstream_tx_errors_.add(pending_datagrams_.size() - sent);
+  }
+  pending_datagrams_.clear();
+}
+
+void UdpProxyFilter::ActiveSession::close() {
+  file_event_.reset();
+  io_handle_->close();
+}
+
+void UdpProxyFilter::ActiveSession::onReadReady() {
+  last_activity_ = config_->timeSource().monotonicTime();
+
+  std::vector<Buffer::InstancePtr> datagrams;
+  while (true) {
+    const Api::SysCallIntResult result = parent_.upstream_batch_.receive(
+        io_handle_->fd(), false,
+        [&datagrams](const Network::Address::InstanceConstSharedPtr&,
+                     Buffer::InstancePtr&& buffer) { datagrams.emplace_back(std::move(buffer)); });
+    if (result.rc_ < 0) {
+      if (result.errno_ == EAGAIN) {
+        break;
+      }
+      config_->stats().upstream_rx_errors_.inc();
+      if (result.errno_ == ECONNREFUSED) {
+        // The host has no socket bound to its port. Reading the error clears it, and the
+        // datagrams queued after it must still be read, as the read event is edge-triggered.
+        continue;
+      }
+      break;
+    }
+    config_->stats().upstream_rx_datagrams_per_batch_.recordValue(result.rc_);
+
+    if (!datagrams.empty()) {
+      config_->stats().upstream_rx_datagrams_.add(datagrams.size());
+      std::vector<Network::UdpSendData> send_data;
+      send_data.reserve(datagrams.size());
+      for (const Buffer::InstancePtr& datagram : datagrams) {
+        send_data.push_back({*peer_, *datagram});
+      }
+      const Api::SysCallIntResult send_result =
+          parent_.read_callbacks_.udpListener().send(send_data);
+      const uint64_t sent = send_result.rc_ > 0 ? send_result.rc_ : 0;
+      config_->stats().downstream_tx_datagrams_.add(sent);
+      config_->stats().downstream_tx_errors_.add(datagrams.size() - sent);
+      datagrams.clear();
+    }
+
+    if (static_cast<uint32_t>(result.rc_) < Network::UdpPacketBatch::MaxBatchSize) {
+      // The socket is drained.
+      break;
+    }
+  }
+}
+
+void UdpProxyFilter::ActiveSession::onIdleTimer() {
+  const std::chrono::milliseconds idle = std::chrono::duration_cast<std::chrono::milliseconds>(
+      config_->timeSource().monotonicTime() - last_activity_);
+  if (idle < config_->idleTimeout()) {
+    idle_timer_->enableTimer(config_->idleTimeout() - idle);
+    return;
+  }
+
+  ENVOY_LOG(debug, "udp proxy: session of {} timed out", peer_->asString());
+  config_->stats().idle_timeout_.inc();
+  parent_.removeSession(*this);
+}
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/time.h"
+#include "envoy/config/filter/udp/udp_proxy/v2alpha/udp_proxy.pb.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/file_event.h"
+#include "envoy/event/timer.h"
+#include "envoy/network/filter.h"
+#include "envoy/network/io_handle.h"
+#include "envoy/network/listener.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/upstream/cluster_manager.h"
+
+#include "common/common/logger.h"
+#include "common/network/udp_packet_batch.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+
+/**
+ * All UDP proxy stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_UDP_PROXY_STATS(COUNTER, GAUGE, HISTOGRAM)                                             \
+  COUNTER(downstream_rx_datagrams)                                                                 \
+  COUNTER(downstream_tx_datagrams)                                                                 \
+  COUNTER(downstream_tx_errors)                                                                    \
+  COUNTER(downstream_sess_total)                                                                   \
+  GAUGE  (downstream_sess_active)                                                                  \
+  COUNTER(downstream_sess_no_route)                                                                \
+  COUNTER(idle_timeout)                                                                            \
+  COUNTER(upstream_no_healthy_host)                                                                \
+  COUNTER(upstream_connect_errors)                                                                 \
+  COUNTER(upstream_rx_datagrams)                                                                   \
+  COUNTER(upstream_rx_errors)                                                                      \
+  COUNTER(upstream_tx_datagrams)                                                                   \
+  COUNTER(upstream_tx_errors)                                                                      \
+  HISTOGRAM(downstream_rx_datagrams_per_batch)                                                     \
+  HISTOGRAM(upstream_rx_datagrams_per_batch)
+// clang-format on
+
+/**
+ * Struct definition for all UDP proxy stats. @see stats_macros.h
+ */
+struct UdpProxyStats {
+  ALL_UDP_PROXY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * Configuration shared by the UDP proxy filters of a listener.
+ */
+class UdpProxyFilterConfig {
+public:
+  UdpProxyFilterConfig(const envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig& config,
+                       Upstream::ClusterManager& cluster_manager, TimeSource& time_source,
+                       Stats::Scope& scope);
+
+  const std::string& cluster() const { return cluster_; }
+  std::chrono::milliseconds idleTimeout() const { return idle_timeout_; }
+  bool useGro() const { return use_gro_; }
+  Upstream::ClusterManager& clusterManager() const { return cluster_manager_; }
+  TimeSource& timeSource() const { return time_source_; }
+  UdpProxyStats& stats() const { return stats_; }
+
+private:
+  static UdpProxyStats generateStats(const std::string& prefix, Stats::Scope& scope);
+
+  const std::string cluster_;
+  const std::chrono::milliseconds idle_timeout_;
+  const bool use_gro_;
+  Upstream::ClusterManager& cluster_manager_;
+  TimeSource& time_source_;
+  mutable UdpProxyStats stats_;
+};
+
+typedef std::shared_ptr<const UdpProxyFilterConfig> UdpProxyFilterConfigSharedPtr;
+
+/**
+ * The UDP proxy filter forwards the datagrams of each downstream peer to an upstream host of a
+ * cluster, over a session with a connected upstream socket of its own, and forwards the datagrams
+ * received on that socket back to the peer from the listener's socket. A session is closed once it
+ * has been idle for the idle timeout.
+ *
+ * The datagrams of a batch received by the listener are queued per session and sent upstream once
+ * the batch is complete, so that each session sends them with as few system calls as possible.
+ * The datagrams received from an upstream host are batched in the same way.
+ */
+class UdpProxyFilter : public Network::UdpListenerReadFilter,
+                       Logger::Loggable<Logger::Id::filter> {
+public:
+  UdpProxyFilter(Network::UdpReadFilterCallbacks& callbacks,
+                 const UdpProxyFilterConfigSharedPtr& config);
+
+  // Network::UdpListenerReadFilter
+  void onData(Network::UdpData& data) override;
+  void onReceiveBatchComplete(uint32_t datagrams) override;
+
+  /**
+   * @return size_t the number of active sessions.
+   */
+  size_t sessions() const { return sessions_.size(); }
+
+private:
+  class ActiveSession : public Event::DeferredDeletable, Logger::Loggable<Logger::Id::filter> {
+  public:
+    ActiveSession(UdpProxyFilter& parent, const Network::Address::InstanceConstSharedPtr& peer,
+                  Upstream::HostConstSharedPtr&& host);
+    ~ActiveSession();
+
+    /**
+     * @return bool whether the upstream socket of the session is connected to its host.
+     */
+    bool connected() const { return connected_; }
+
+    /**
+     * Queue a datagram of the downstream peer, to be sent upstream by flush().
+     * @return bool whether the session had no queued datagram.
+     */
+    bool write(Buffer::InstancePtr&& datagram);
+
+    /**
+     * Send the queued datagrams to the upstream host.
+     */
+    void flush();
+
+    /**
+     * Stop receiving from the upstream host, before the session is deleted.
+     */
+    void close();
+
+    const std::string& key() const { return peer_->asString(); }
+
+  private:
+    void onReadReady();
+    void onIdleTimer();
+
+    UdpProxyFilter& parent_;
+    // Keeps the stats alive if the session is deleted after its filter.
+    const UdpProxyFilterConfigSharedPtr config_;
+    const Network::Address::InstanceConstSharedPtr peer_;
+    const Upstream::HostConstSharedPtr host_;
+    Network::IoHandlePtr io_handle_;
+    Event::FileEventPtr file_event_;
+    Event::TimerPtr idle_timer_;
+    MonotonicTime last_activity_;
+    std::vector<Buffer::InstancePtr> pending_datagrams_;
+    bool connected_{};
+  };
+
+  typedef std::unique_ptr<ActiveSession> ActiveSessionPtr;
+
+  ActiveSession* createSession(const Network::Address::InstanceConstSharedPtr& peer);
+  void removeSession(ActiveSession& session);
+
+  Network::UdpReadFilterCallbacks& read_callbacks_;
+  const UdpProxyFilterConfigSharedPtr config_;
+  // Sessions keyed by the address of their downstream peer.
+  std::unordered_map<std::string, ActiveSessionPtr> sessions_;
+  // Sessions with queued datagrams, flushed once the current batch is complete.
+  std::vector<ActiveSession*> pending_sessions_;
+  // Receives from the upstream sockets of all the sessions.
+  Network::UdpPacketBatch upstream_batch_;
+};
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -40,13 +40,13 @@ void RedisHealthChecker::RedisActiveHealthCheckSession::onEvent(Network::Connect
       event == Network::ConnectionEvent::LocalClose) {
     // This should only happen after any active requests have been failed/cancelled.
     ASSERT(!current_request_);
-    parent_.dispatcher_.deferredDelete(std::move(client_));
+    dispatcher_.deferredDelete(std::move(client_));
   }
 }
 
 void RedisHealthChecker::RedisActiveHealthCheckSession::onInterval() {
   if (!client_) {
-    client_ = parent_.client_factory_.create(host_, parent_.dispatcher_, *this);
+    client_ = parent_.client_factory_.create(host_, dispatcher_, *this);
     client_->addConnectionCallbacks(*this);
   }
 
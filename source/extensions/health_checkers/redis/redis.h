@@ -59,6 +59,10 @@ private:
       return parent_.timeout_ * 2;
     }
     bool enableHashtagging() const override { return false; }
+    uint32_t maxBufferSizeBeforeFlush() const override { return 0; }
+    std::chrono::milliseconds bufferFlushTimeoutInMs() const override {
+      return std::chrono::milliseconds(0);
+    }
 
     // Extensions::NetworkFilters::Common::Redis::Client::PoolCallbacks
     void onResponse(NetworkFilters::Common::Redis::RespValuePtr&& value) override;
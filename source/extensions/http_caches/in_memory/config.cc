@@ -0,0 +1,46 @@
+#include "extensions/http_caches/in_memory/config.h"
+
+#include "envoy/config/http_cache/in_memory/v2alpha/in_memory.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/http_caches/in_memory/in_memory_cache.h"
+#include "extensions/http_caches/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpCaches {
+namespace InMemory {
+
+namespace {
+// Default number of shards of the storage.
+const uint32_t DefaultShards = 16;
+} // namespace
+
+Envoy::HttpCache::HttpCacheSharedPtr
+InMemoryCacheFactory::createHttpCacheFromProto(const Protobuf::Message& config,
+                                               const std::string& stats_prefix,
+                                               Server::Configuration::FactoryContext& context) {
+  const auto& in_memory = MessageUtil::downcastAndValidate<
+      const envoy::config::http_cache::in_memory::v2alpha::InMemoryCache&>(config);
+  return std::make_shared<InMemoryCache>(
+      in_memory.max_bytes(), PROTOBUF_GET_WRAPPED_OR_DEFAULT(in_memory, shards, DefaultShards),
+      stats_prefix + "in_memory.", context.scope());
+}
+
+ProtobufTypes::MessagePtr InMemoryCacheFactory::createEmptyConfigProto() {
+  return std::make_unique<envoy::config::http_cache::in_memory::v2alpha::InMemoryCache>();
+}
+
+std::string InMemoryCacheFactory::name() const { return HttpCacheNames::get().InMemory; }
+
+/**
+ * Static registration for the in-memory HTTP cache storage. @see NamedHttpCacheConfigFactory.
+ */
+REGISTER_FACTORY(InMemoryCacheFactory, Envoy::HttpCache::NamedHttpCacheConfigFactory);
+
+} // namespace InMemory
+} // namespace HttpCaches
+} // namespace Extensions
+} // namespace Envoy
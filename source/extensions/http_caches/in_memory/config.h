@@ -0,0 +1,26 @@
+#pragma once
+
+#include "envoy/http_cache/http_cache_config.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpCaches {
+namespace InMemory {
+
+/**
+ * Config registration for the in-memory HTTP cache storage. @see NamedHttpCacheConfigFactory.
+ */
+class InMemoryCacheFactory : public Envoy::HttpCache::NamedHttpCacheConfigFactory {
+public:
+  // HttpCache::NamedHttpCacheConfigFactory
+  Envoy::HttpCache::HttpCacheSharedPtr
+  createHttpCacheFromProto(const Protobuf::Message& config, const std::string& stats_prefix,
+                           Server::Configuration::FactoryContext& context) override;
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+  std::string name() const override;
+};
+
+} // namespace InMemory
+} // namespace HttpCaches
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,98 @@
+#include "extensions/http_caches/in_memory/in_memory_cache.h"
+
+#include <iterator>
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpCaches {
+namespace InMemory {
+
+InMemoryCache::InMemoryCache(uint64_t max_bytes, uint32_t shards, const std::string& stats_prefix,
+                             Stats::Scope& scope)
+    : max_shard_bytes_(max_bytes / shards),
+      stats_{ALL_IN_MEMORY_CACHE_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix),
+                                       POOL_GAUGE_PREFIX(scope, stats_prefix))} {
+  ASSERT(shards > 0);
+  for (uint32_t i = 0; i < shards; i++) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+Envoy::HttpCache::CacheEntryConstSharedPtr InMemoryCache::lookup(const std::string& key) {
+  Shard& key_shard = shard(key);
+  Thread::LockGuard lock(key_shard.lock_);
+  auto it = key_shard.index_.find(key);
+  if (it == key_shard.index_.end()) {
+    return nullptr;
+  }
+  key_shard.entries_.splice(key_shard.entries_.begin(), key_shard.entries_, it->second);
+  return it->second->entry_;
+}
+
+void InMemoryCache::insert(const std::string& key,
+                           Envoy::HttpCache::CacheEntryConstSharedPtr entry) {
+  const uint64_t bytes = entryBytes(key, *entry);
+  Shard& key_shard = shard(key);
+  Thread::LockGuard lock(key_shard.lock_);
+  auto it = key_shard.index_.find(key);
+  if (it != key_shard.index_.end()) {
+    erase(key_shard, it->second);
+  }
+  if (bytes > max_shard_bytes_) {
+    return;
+  }
+  while (key_shard.bytes_ + bytes > max_shard_bytes_) {
+    erase(key_shard, std::prev(key_shard.entries_.end()));
+    stats_.evicted_.inc();
+  }
+  key_shard.entries_.push_front({key, std::move(entry), bytes});
+  key_shard.index_.emplace(key, key_shard.entries_.begin());
+  key_shard.bytes_ += bytes;
+  stats_.entries_.inc();
+  stats_.bytes_.add(bytes);
+}
+
+void InMemoryCache::remove(const std::string& key) {
+  Shard& key_shard = shard(key);
+  Thread::LockGuard lock(key_shard.lock_);
+  auto it = key_shard.index_.find(key);
+  if (it != key_shard.index_.end()) {
+    erase(key_shard, it->second);
+  }
+}
+
+uint64_t InMemoryCache::entryBytes(const std::string& key,
+                                   const Envoy::HttpCache::CacheEntry& entry) {
+  uint64_t bytes = key.size();
+  if (entry.headers_ != nullptr) {
+    bytes += entry.headers_->byteSize();
+  }
+  if (entry.body_ != nullptr) {
+    bytes += entry.body_->size();
+  }
+  for (const std::string& name : entry.vary_) {
+    bytes += name.size();
+  }
+  return bytes;
+}
+
+InMemoryCache::Shard& InMemoryCache::shard(const std::string& key) {
+  return *shards_[HashUtil::xxHash64(key) % shards_.size()];
+}
+
+void InMemoryCache::erase(Shard& shard, std::list<Entry>::iterator it) {
+  shard.bytes_ -= it->bytes_;
+  stats_.entries_.dec();
+  stats_.bytes_.sub(it->bytes_);
+  shard.index_.erase(it->key_);
+  shard.entries_.erase(it);
+}
+
+} // namespace InMemory
+} // namespace HttpCaches
+} // namespace Extensions
+} // namespace Envoy
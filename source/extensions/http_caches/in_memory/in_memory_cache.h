@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/http_cache/http_cache.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpCaches {
+namespace InMemory {
+
+/**
+ * All in-memory cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_IN_MEMORY_CACHE_STATS(COUNTER, GAUGE)                                                  \
+  COUNTER(evicted)                                                                                 \
+  GAUGE  (entries)                                                                                 \
+  GAUGE  (bytes)
+// clang-format on
+
+/**
+ * Struct definition for all in-memory cache stats. @see stats_macros.h
+ */
+struct InMemoryCacheStats {
+  ALL_IN_MEMORY_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * HTTP cache storage keeping the entries in memory. The keys are spread over shards with their own
+ * locks, so that the workers seldom wait for each other. Each shard evicts its least recently used
+ * entries once its entries take more than its share of the maximum bytes.
+ */
+class InMemoryCache : public Envoy::HttpCache::HttpCache {
+public:
+  InMemoryCache(uint64_t max_bytes, uint32_t shards, const std::string& stats_prefix,
+                Stats::Scope& scope);
+
+  // HttpCache::HttpCache
+  Envoy::HttpCache::CacheEntryConstSharedPtr lookup(const std::string& key) override;
+  void insert(const std::string& key, Envoy::HttpCache::CacheEntryConstSharedPtr entry) override;
+  void remove(const std::string& key) override;
+
+  /**
+   * @return uint64_t the bytes accounted to an entry stored under a key.
+   */
+  static uint64_t entryBytes(const std::string& key, const Envoy::HttpCache::CacheEntry& entry);
+
+private:
+  struct Entry {
+    std::string key_;
+    Envoy::HttpCache::CacheEntryConstSharedPtr entry_;
+    uint64_t bytes_;
+  };
+
+  struct Shard {
+    Thread::MutexBasicLockable lock_;
+    // Most recently used first.
+    std::list<Entry> entries_ GUARDED_BY(lock_);
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_ GUARDED_BY(lock_);
+    uint64_t bytes_ GUARDED_BY(lock_){};
+  };
+
+  Shard& shard(const std::string& key);
+  void erase(Shard& shard, std::list<Entry>::iterator it) EXCLUSIVE_LOCKS_REQUIRED(shard.lock_);
+
+  const uint64_t max_shard_bytes_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  InMemoryCacheStats stats_;
+};
+
+} // namespace InMemory
+} // namespace HttpCaches
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+#include "common/singleton/const_singleton.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpCaches {
+
+/**
+ * Well-known HTTP cache storage names.
+ * NOTE: New HTTP cache storages should use the well known name: envoy.http_caches.name.
+ */
+class HttpCacheNameValues {
+public:
+  // HTTP cache storage keeping the responses in memory.
+  const std::string InMemory = "envoy.http_caches.in_memory";
+};
+
+typedef ConstSingleton<HttpCacheNameValues> HttpCacheNames;
+
+} // namespace HttpCaches
+} // namespace Extensions
+} // namespace Envoy
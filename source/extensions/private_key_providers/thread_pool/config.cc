@@ -0,0 +1,42 @@
+#include "extensions/private_key_providers/thread_pool/config.h"
+
+#include "envoy/config/private_key_provider/thread_pool/v2alpha/thread_pool.pb.validate.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/transport_socket_config.h"
+
+#include "common/config/utility.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyProviders {
+namespace ThreadPool {
+
+Ssl::PrivateKeyMethodProviderSharedPtr
+ThreadPoolPrivateKeyMethodFactory::createPrivateKeyMethodProviderInstance(
+    const envoy::api::v2::auth::PrivateKeyProvider& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context) {
+  envoy::config::private_key_provider::thread_pool::v2alpha::ThreadPoolPrivateKeyProviderConfig
+      proto_config;
+  Config::Utility::translateOpaqueConfig(config.typed_config(), config.config(), proto_config);
+  MessageUtil::validate(proto_config);
+
+  const uint32_t threads = PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, threads, 1);
+  PrivateKeyThreadPoolSharedPtr pool = pools_[threads].lock();
+  if (pool == nullptr) {
+    pool = std::make_shared<PrivateKeyThreadPool>(factory_context.api().threadFactory(), threads);
+    pools_[threads] = pool;
+  }
+  return std::make_shared<ThreadPoolPrivateKeyMethodProvider>(proto_config, factory_context.api(),
+                                                              std::move(pool));
+}
+
+/**
+ * Static registration for the thread pool private key method provider. @see RegisterFactory.
+ */
+REGISTER_FACTORY(ThreadPoolPrivateKeyMethodFactory, Ssl::PrivateKeyMethodProviderInstanceFactory);
+
+} // namespace ThreadPool
+} // namespace PrivateKeyProviders
+} // namespace Extensions
+} // namespace Envoy
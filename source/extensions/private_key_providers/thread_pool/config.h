@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/ssl/private_key/private_key_config.h"
+
+#include "extensions/private_key_providers/thread_pool/thread_pool_provider.h"
+#include "extensions/private_key_providers/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyProviders {
+namespace ThreadPool {
+
+class ThreadPoolPrivateKeyMethodFactory : public Ssl::PrivateKeyMethodProviderInstanceFactory {
+public:
+  // Ssl::PrivateKeyMethodProviderInstanceFactory
+  Ssl::PrivateKeyMethodProviderSharedPtr createPrivateKeyMethodProviderInstance(
+      const envoy::api::v2::auth::PrivateKeyProvider& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context) override;
+  std::string name() const override { return PrivateKeyProviderNames::get().ThreadPool; }
+
+private:
+  // The pools of the providers by number of threads, so that providers with the same number of
+  // threads share a pool. Only used on the main thread.
+  std::unordered_map<uint32_t, std::weak_ptr<PrivateKeyThreadPool>> pools_;
+};
+
+} // namespace ThreadPool
+} // namespace PrivateKeyProviders
+} // namespace Extensions
+} // namespace Envoy
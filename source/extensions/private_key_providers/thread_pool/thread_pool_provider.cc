@@ -0,0 +1,315 @@
+#include "extensions/private_key_providers/thread_pool/thread_pool_provider.h"
+
+#include <cstring>
+#include <string>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/lock_guard.h"
+#include "common/config/datasource.h"
+
+#include "openssl/ec_key.h"
+#include "openssl/err.h"
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyProviders {
+namespace ThreadPool {
+
+namespace {
+
+// Based on BoringSSL's ssl_private_key_sign() for keys held by the SSL_CTX.
+bool signWithKey(EVP_PKEY* pkey, uint16_t signature_algorithm, const std::vector<uint8_t>& in,
+                 std::vector<uint8_t>& out) {
+  if (SSL_get_signature_algorithm_key_type(signature_algorithm) != EVP_PKEY_id(pkey)) {
+    return false;
+  }
+  bssl::ScopedEVP_MD_CTX ctx;
+  EVP_PKEY_CTX* pctx;
+  if (!EVP_DigestSignInit(ctx.get(), &pctx, SSL_get_signature_algorithm_digest(signature_algorithm),
+                          nullptr, pkey)) {
+    return false;
+  }
+  if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+      (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+       !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1))) {
+    return false;
+  }
+  size_t out_len = EVP_PKEY_size(pkey);
+  out.resize(out_len);
+  if (!EVP_DigestSign(ctx.get(), out.data(), &out_len, in.data(), in.size())) {
+    return false;
+  }
+  out.resize(out_len);
+  return true;
+}
+
+// Based on BoringSSL's ssl_private_key_decrypt() for keys held by the SSL_CTX.
+bool decryptWithKey(EVP_PKEY* pkey, const std::vector<uint8_t>& in, std::vector<uint8_t>& out) {
+  RSA* rsa = EVP_PKEY_get0_RSA(pkey);
+  if (rsa == nullptr) {
+    return false;
+  }
+  size_t out_len = RSA_size(rsa);
+  out.resize(out_len);
+  if (!RSA_decrypt(rsa, &out_len, out.data(), out.size(), in.data(), in.size(), RSA_NO_PADDING)) {
+    return false;
+  }
+  out.resize(out_len);
+  return true;
+}
+
+PrivateKeyConnection* getConnection(SSL* ssl, int key_type) {
+  if (key_type != EVP_PKEY_RSA && key_type != EVP_PKEY_EC) {
+    return nullptr;
+  }
+  return static_cast<PrivateKeyConnection*>(
+      SSL_get_ex_data(ssl, ThreadPoolPrivateKeyMethodProvider::connectionIndex(key_type)));
+}
+
+enum ssl_private_key_result_t privateKeySign(SSL* ssl, uint8_t*, size_t*, size_t,
+                                             uint16_t signature_algorithm, const uint8_t* in,
+                                             size_t in_len) {
+  PrivateKeyConnection* connection =
+      getConnection(ssl, SSL_get_signature_algorithm_key_type(signature_algorithm));
+  return connection != nullptr ? connection->sign(signature_algorithm, in, in_len)
+                               : ssl_private_key_failure;
+}
+
+enum ssl_private_key_result_t privateKeyDecrypt(SSL* ssl, uint8_t*, size_t*, size_t,
+                                                const uint8_t* in, size_t in_len) {
+  PrivateKeyConnection* connection = getConnection(ssl, EVP_PKEY_RSA);
+  return connection != nullptr ? connection->decrypt(in, in_len) : ssl_private_key_failure;
+}
+
+enum ssl_private_key_result_t privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                                 size_t max_out) {
+  for (int key_type : {EVP_PKEY_RSA, EVP_PKEY_EC}) {
+    PrivateKeyConnection* connection = getConnection(ssl, key_type);
+    if (connection != nullptr && connection->pending()) {
+      return connection->complete(out, out_len, max_out);
+    }
+  }
+  return ssl_private_key_failure;
+}
+
+int newConnectionIndex() {
+  const int index =
+      SSL_get_ex_new_index(0, nullptr, nullptr, nullptr,
+                           [](void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) -> void {
+                             // Connections that didn't unregister are cancelled with their SSL.
+                             delete static_cast<PrivateKeyConnection*>(ptr);
+                           });
+  RELEASE_ASSERT(index >= 0, "");
+  return index;
+}
+
+} // namespace
+
+PrivateKeyThreadPool::PrivateKeyThreadPool(Thread::ThreadFactory& thread_factory,
+                                           uint32_t threads) {
+  for (uint32_t i = 0; i < threads; i++) {
+    threads_.push_back(thread_factory.createThread([this]() -> void { run(); }));
+  }
+}
+
+PrivateKeyThreadPool::~PrivateKeyThreadPool() {
+  {
+    Thread::LockGuard lock(lock_);
+    shutdown_ = true;
+  }
+  operation_queued_.notifyAll();
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+void PrivateKeyThreadPool::post(std::function<void()> operation) {
+  {
+    Thread::LockGuard lock(lock_);
+    operations_.push_back(std::move(operation));
+  }
+  operation_queued_.notifyOne();
+}
+
+void PrivateKeyThreadPool::run() {
+  while (true) {
+    std::function<void()> operation;
+    {
+      Thread::LockGuard lock(lock_);
+      while (!shutdown_ && operations_.empty()) {
+        operation_queued_.wait(lock_);
+      }
+      if (shutdown_) {
+        return;
+      }
+      operation = std::move(operations_.front());
+      operations_.pop_front();
+    }
+    operation();
+  }
+}
+
+void PrivateKeyOperation::complete(bool succeeded, std::vector<uint8_t>&& output) {
+  succeeded_ = succeeded;
+  output_ = std::move(output);
+  done_ = true;
+
+  Thread::LockGuard lock(lock_);
+  if (callbacks_ != nullptr) {
+    // The connection unregisters on its own thread before its dispatcher goes away, which can't
+    // happen while the lock is held.
+    PrivateKeyOperationSharedPtr self = shared_from_this();
+    dispatcher_.post([self]() -> void { self->notify(); });
+  }
+}
+
+void PrivateKeyOperation::cancel() {
+  Thread::LockGuard lock(lock_);
+  callbacks_ = nullptr;
+}
+
+void PrivateKeyOperation::notify() {
+  Ssl::PrivateKeyConnectionCallbacks* callbacks;
+  {
+    Thread::LockGuard lock(lock_);
+    callbacks = callbacks_;
+  }
+  if (callbacks != nullptr) {
+    callbacks->onPrivateKeyMethodComplete();
+  }
+}
+
+PrivateKeyConnection::~PrivateKeyConnection() {
+  if (operation_ != nullptr) {
+    operation_->cancel();
+  }
+}
+
+enum ssl_private_key_result_t PrivateKeyConnection::sign(uint16_t signature_algorithm,
+                                                         const uint8_t* in, size_t in_len) {
+  std::shared_ptr<EVP_PKEY> pkey = pkey_;
+  std::vector<uint8_t> input(in, in + in_len);
+  return start([pkey, signature_algorithm, input](std::vector<uint8_t>& output) -> bool {
+    return signWithKey(pkey.get(), signature_algorithm, input, output);
+  });
+}
+
+enum ssl_private_key_result_t PrivateKeyConnection::decrypt(const uint8_t* in, size_t in_len) {
+  std::shared_ptr<EVP_PKEY> pkey = pkey_;
+  std::vector<uint8_t> input(in, in + in_len);
+  return start([pkey, input](std::vector<uint8_t>& output) -> bool {
+    return decryptWithKey(pkey.get(), input, output);
+  });
+}
+
+enum ssl_private_key_result_t
+PrivateKeyConnection::start(std::function<bool(std::vector<uint8_t>&)> operation) {
+  // BoringSSL runs at most one private key operation of a connection at a time.
+  if (operation_ != nullptr) {
+    return ssl_private_key_failure;
+  }
+  operation_ = std::make_shared<PrivateKeyOperation>(callbacks_, dispatcher_);
+  PrivateKeyOperationSharedPtr pending_operation = operation_;
+  pool_->post([pending_operation, operation]() -> void {
+    std::vector<uint8_t> output;
+    const bool succeeded = operation(output);
+    // The errors are queued on the thread of the pool, where nothing reports them.
+    ERR_clear_error();
+    pending_operation->complete(succeeded, std::move(output));
+  });
+  return ssl_private_key_retry;
+}
+
+enum ssl_private_key_result_t PrivateKeyConnection::complete(uint8_t* out, size_t* out_len,
+                                                             size_t max_out) {
+  if (operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  if (!operation_->done()) {
+    return ssl_private_key_retry;
+  }
+  PrivateKeyOperationSharedPtr operation = std::move(operation_);
+  operation_ = nullptr;
+  const std::vector<uint8_t>& output = operation->output();
+  if (!operation->succeeded() || output.size() > max_out) {
+    return ssl_private_key_failure;
+  }
+  memcpy(out, output.data(), output.size());
+  *out_len = output.size();
+  return ssl_private_key_success;
+}
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(
+    const envoy::config::private_key_provider::thread_pool::v2alpha::
+        ThreadPoolPrivateKeyProviderConfig& config,
+    Api::Api& api, PrivateKeyThreadPoolSharedPtr pool)
+    : pool_(std::move(pool)) {
+  const std::string private_key = Config::DataSource::read(config.private_key(), false, api);
+  const std::string password = Config::DataSource::read(config.password(), true, api);
+  const std::string private_key_path =
+      Config::DataSource::getPath(config.private_key()).value_or("<inline>");
+
+  bssl::UniquePtr<BIO> bio(
+      BIO_new_mem_buf(const_cast<char*>(private_key.data()), private_key.size()));
+  RELEASE_ASSERT(bio != nullptr, "");
+  EVP_PKEY* pkey = PEM_read_bio_PrivateKey(
+      bio.get(), nullptr, nullptr,
+      !password.empty() ? const_cast<char*>(password.c_str()) : nullptr);
+  if (pkey == nullptr) {
+    ERR_clear_error();
+    throw EnvoyException(fmt::format("Failed to load private key from {}", private_key_path));
+  }
+  pkey_.reset(pkey, EVP_PKEY_free);
+  const int key_type = EVP_PKEY_id(pkey);
+  if (key_type != EVP_PKEY_RSA && key_type != EVP_PKEY_EC) {
+    throw EnvoyException(fmt::format(
+        "Failed to load private key from {}, only RSA and ECDSA keys are supported",
+        private_key_path));
+  }
+
+  method_ = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  method_->sign = privateKeySign;
+  method_->decrypt = privateKeyDecrypt;
+  method_->complete = privateKeyComplete;
+}
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher) {
+  const int index = connectionIndex(EVP_PKEY_id(pkey_.get()));
+  delete static_cast<PrivateKeyConnection*>(SSL_get_ex_data(ssl, index));
+  SSL_set_ex_data(ssl, index, new PrivateKeyConnection(cb, dispatcher, pkey_, pool_));
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  const int index = connectionIndex(EVP_PKEY_id(pkey_.get()));
+  delete static_cast<PrivateKeyConnection*>(SSL_get_ex_data(ssl, index));
+  SSL_set_ex_data(ssl, index, nullptr);
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::checkFips() {
+  switch (EVP_PKEY_id(pkey_.get())) {
+  case EVP_PKEY_EC:
+    return EC_KEY_check_fips(EVP_PKEY_get0_EC_KEY(pkey_.get()));
+  case EVP_PKEY_RSA:
+    return RSA_check_fips(EVP_PKEY_get0_RSA(pkey_.get()));
+  }
+  return false;
+}
+
+int ThreadPoolPrivateKeyMethodProvider::connectionIndex(int key_type) {
+  ASSERT(key_type == EVP_PKEY_RSA || key_type == EVP_PKEY_EC);
+  static const int rsa_index = newConnectionIndex();
+  static const int ecdsa_index = newConnectionIndex();
+  return key_type == EVP_PKEY_RSA ? rsa_index : ecdsa_index;
+}
+
+} // namespace ThreadPool
+} // namespace PrivateKeyProviders
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/config/private_key_provider/thread_pool/v2alpha/thread_pool.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/private_key/private_key_callbacks.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyProviders {
+namespace ThreadPool {
+
+/**
+ * A pool of threads running the private key operations of the providers that share it.
+ */
+class PrivateKeyThreadPool {
+public:
+  PrivateKeyThreadPool(Thread::ThreadFactory& thread_factory, uint32_t threads);
+
+  /**
+   * Stops the threads once they finish their current operation, the queued ones are dropped.
+   */
+  ~PrivateKeyThreadPool();
+
+  /**
+   * Queue an operation, which runs on one of the threads.
+   * @param operation supplies the operation.
+   */
+  void post(std::function<void()> operation);
+
+private:
+  void run();
+
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar operation_queued_;
+  std::deque<std::function<void()>> operations_ GUARDED_BY(lock_);
+  bool shutdown_ GUARDED_BY(lock_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+typedef std::shared_ptr<PrivateKeyThreadPool> PrivateKeyThreadPoolSharedPtr;
+
+/**
+ * A signing or decryption of a handshake, which runs on the thread pool.
+ */
+class PrivateKeyOperation : public std::enable_shared_from_this<PrivateKeyOperation> {
+public:
+  PrivateKeyOperation(Ssl::PrivateKeyConnectionCallbacks& callbacks,
+                      Event::Dispatcher& dispatcher)
+      : callbacks_(&callbacks), dispatcher_(dispatcher) {}
+
+  /**
+   * Called on the thread pool once the output is set, notifies the connection on its dispatcher
+   * unless it was cancelled.
+   */
+  void complete(bool succeeded, std::vector<uint8_t>&& output);
+
+  /**
+   * Called on the thread of the connection, so that the connection is never notified.
+   */
+  void cancel();
+
+  /**
+   * @return whether the output is set, so that it can be used on the thread of the connection.
+   */
+  bool done() const { return done_; }
+  bool succeeded() const { return succeeded_; }
+  const std::vector<uint8_t>& output() const { return output_; }
+
+private:
+  void notify();
+
+  Thread::MutexBasicLockable lock_;
+  Ssl::PrivateKeyConnectionCallbacks* callbacks_ GUARDED_BY(lock_);
+  Event::Dispatcher& dispatcher_;
+  // Written by the thread pool before done_ is set.
+  bool succeeded_{};
+  std::vector<uint8_t> output_;
+  std::atomic<bool> done_{};
+};
+
+typedef std::shared_ptr<PrivateKeyOperation> PrivateKeyOperationSharedPtr;
+
+/**
+ * The state of a connection registered with a provider, stored in its SSL instance.
+ */
+class PrivateKeyConnection {
+public:
+  PrivateKeyConnection(Ssl::PrivateKeyConnectionCallbacks& callbacks,
+                       Event::Dispatcher& dispatcher, std::shared_ptr<EVP_PKEY> pkey,
+                       PrivateKeyThreadPoolSharedPtr pool)
+      : callbacks_(callbacks), dispatcher_(dispatcher), pkey_(std::move(pkey)),
+        pool_(std::move(pool)) {}
+  ~PrivateKeyConnection();
+
+  enum ssl_private_key_result_t sign(uint16_t signature_algorithm, const uint8_t* in,
+                                     size_t in_len);
+  enum ssl_private_key_result_t decrypt(const uint8_t* in, size_t in_len);
+  enum ssl_private_key_result_t complete(uint8_t* out, size_t* out_len, size_t max_out);
+
+  /**
+   * @return whether an operation was started and not completed yet.
+   */
+  bool pending() const { return operation_ != nullptr; }
+
+private:
+  enum ssl_private_key_result_t start(std::function<bool(std::vector<uint8_t>&)> operation);
+
+  Ssl::PrivateKeyConnectionCallbacks& callbacks_;
+  Event::Dispatcher& dispatcher_;
+  const std::shared_ptr<EVP_PKEY> pkey_;
+  const PrivateKeyThreadPoolSharedPtr pool_;
+  PrivateKeyOperationSharedPtr operation_;
+};
+
+/**
+ * A private key method provider that signs and decrypts on a thread pool, so that the private key
+ * operations of the handshakes don't block the worker threads.
+ */
+class ThreadPoolPrivateKeyMethodProvider : public Ssl::PrivateKeyMethodProvider {
+public:
+  ThreadPoolPrivateKeyMethodProvider(
+      const envoy::config::private_key_provider::thread_pool::v2alpha::
+          ThreadPoolPrivateKeyProviderConfig& config,
+      Api::Api& api, PrivateKeyThreadPoolSharedPtr pool);
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  bool checkFips() override;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr getBoringSslPrivateKeyMethod() override {
+    return method_;
+  }
+
+  /**
+   * @param key_type supplies the type of a private key, EVP_PKEY_RSA or EVP_PKEY_EC.
+   * @return the SSL-library index of the connections registered with the providers of the keys of
+   *         the type. Contexts have at most one certificate of each type, so that the connections
+   *         of a context register with at most one provider per index.
+   */
+  static int connectionIndex(int key_type);
+
+private:
+  std::shared_ptr<EVP_PKEY> pkey_;
+  const PrivateKeyThreadPoolSharedPtr pool_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+};
+
+} // namespace ThreadPool
+} // namespace PrivateKeyProviders
+} // namespace Extensions
+} // namespace Envoy
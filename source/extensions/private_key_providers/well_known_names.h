@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+#include "common/singleton/const_singleton.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyProviders {
+
+/**
+ * Well-known private key method provider names.
+ * NOTE: New private key method providers should use the well known name:
+ * envoy.private_key_providers.name.
+ */
+class PrivateKeyProviderNameValues {
+public:
+  // Provider signing and decrypting on a pool of threads.
+  const std::string ThreadPool = "envoy.private_key_providers.thread_pool";
+};
+
+typedef ConstSingleton<PrivateKeyProviderNameValues> PrivateKeyProviderNames;
+
+} // namespace PrivateKeyProviders
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,99 @@
+#include "extensions/quic_listeners/quiche/connection_id_routing.h"
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace QuicListeners {
+namespace Quiche {
+
+namespace {
+
+// The high bit of the first byte of a packet tells a long header from a short header.
+constexpr uint8_t LongHeaderBit = 0x80;
+// The first byte and the 32 bit version, which are followed by the length of the destination
+// connection ID.
+constexpr size_t LongHeaderConnectionIdLengthOffset = 5;
+// The first byte, which is followed by the destination connection ID.
+constexpr size_t ShortHeaderConnectionIdOffset = 1;
+// The connection ID bytes that the worker is derived from.
+constexpr size_t RoutingBytes = 4;
+
+uint32_t readRoutingValue(absl::string_view connection_id) {
+  uint32_t value = 0;
+  for (size_t i = 0; i < RoutingBytes; i++) {
+    value = (value << 8) | static_cast<uint8_t>(connection_id[i]);
+  }
+  return value;
+}
+
+} // namespace
+
+constexpr uint32_t ConnectionIdRouting::ServerConnectionIdLength;
+constexpr uint32_t ConnectionIdRouting::MaxConnectionIdLength;
+
+absl::optional<absl::string_view>
+ConnectionIdRouting::destinationConnectionId(absl::string_view packet) {
+  if (packet.empty()) {
+    return absl::nullopt;
+  }
+
+  if ((static_cast<uint8_t>(packet[0]) & LongHeaderBit) == 0) {
+    if (packet.size() < ShortHeaderConnectionIdOffset + ServerConnectionIdLength) {
+      return absl::nullopt;
+    }
+    return packet.substr(ShortHeaderConnectionIdOffset, ServerConnectionIdLength);
+  }
+
+  if (packet.size() <= LongHeaderConnectionIdLengthOffset) {
+    return absl::nullopt;
+  }
+  const size_t length = static_cast<uint8_t>(packet[LongHeaderConnectionIdLengthOffset]);
+  if (packet.size() < LongHeaderConnectionIdLengthOffset + 1 + length) {
+    return absl::nullopt;
+  }
+  return packet.substr(LongHeaderConnectionIdLengthOffset + 1, length);
+}
+
+uint32_t ConnectionIdRouting::workerIndex(absl::string_view connection_id, uint32_t concurrency) {
+  ASSERT(concurrency > 0);
+  // The connection IDs issued by the server carry the worker in their leading bytes, and the
+  // shorter connection IDs chosen by clients are hashed.
+  const uint32_t value = connection_id.size() >= RoutingBytes
+                             ? readRoutingValue(connection_id)
+                             : static_cast<uint32_t>(HashUtil::xxHash64(connection_id));
+  return value % concurrency;
+}
+
+std::string ConnectionIdRouting::generateConnectionId(uint32_t worker_index, uint32_t concurrency,
+                                                      Runtime::RandomGenerator& random) {
+  ASSERT(worker_index < concurrency);
+  std::string connection_id;
+  connection_id.reserve(ServerConnectionIdLength);
+  while (connection_id.size() < ServerConnectionIdLength) {
+    const uint64_t bits = random.random();
+    for (size_t i = 0; i < sizeof(bits) && connection_id.size() < ServerConnectionIdLength; i++) {
+      connection_id.push_back(static_cast<char>(bits >> (8 * i)));
+    }
+  }
+
+  // Replace the remainder of the routing value with the worker, which keeps the rest of it random.
+  // The multiple of the concurrency below is used if the worker does not fit above the last one.
+  const uint32_t random_value = readRoutingValue(connection_id);
+  uint64_t value = random_value - random_value % concurrency;
+  if (value + worker_index > UINT32_MAX) {
+    value -= concurrency;
+  }
+  value += worker_index;
+  for (size_t i = 0; i < RoutingBytes; i++) {
+    connection_id[i] = static_cast<char>(value >> (8 * (RoutingBytes - 1 - i)));
+  }
+  ASSERT(workerIndex(connection_id, concurrency) == worker_index);
+  return connection_id;
+}
+
+} // namespace Quiche
+} // namespace QuicListeners
+} // namespace Extensions
+} // namespace Envoy
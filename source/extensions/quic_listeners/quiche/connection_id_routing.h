@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "envoy/runtime/runtime.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace QuicListeners {
+namespace Quiche {
+
+/**
+ * Routing of QUIC datagrams to workers by destination connection ID. All the workers receive from
+ * the same UDP socket, so the datagrams of a connection may be read by any worker, and must be
+ * handed to the worker that owns the connection. The first datagram of a connection carries a
+ * destination connection ID chosen by the client, which is routed by its value, and the packets
+ * that follow carry the connection IDs issued by the server, which are generated such that they
+ * route to the worker that owns the connection.
+ *
+ * Only the version independent properties of QUIC packets are relied on, so the routing is the same
+ * for all the QUIC versions.
+ */
+class ConnectionIdRouting {
+public:
+  // The length of the connection IDs issued by the server, which is also the length of the
+  // destination connection ID of the packets with a short header, since their header does not
+  // carry it.
+  static constexpr uint32_t ServerConnectionIdLength = 8;
+  // The longest connection ID that the version independent long header can carry.
+  static constexpr uint32_t MaxConnectionIdLength = 255;
+
+  /**
+   * Parse the destination connection ID of a QUIC packet.
+   * @param packet supplies the datagram.
+   * @return the destination connection ID, which refers to the datagram, or absl::nullopt if the
+   *         datagram is too short to be a QUIC packet.
+   */
+  static absl::optional<absl::string_view> destinationConnectionId(absl::string_view packet);
+
+  /**
+   * @param connection_id supplies a destination connection ID.
+   * @param concurrency supplies the number of workers.
+   * @return uint32_t the index of the worker that owns the connection with the connection ID.
+   */
+  static uint32_t workerIndex(absl::string_view connection_id, uint32_t concurrency);
+
+  /**
+   * Generate a random connection ID of ServerConnectionIdLength bytes that routes to a worker.
+   * @param worker_index supplies the index of the worker.
+   * @param concurrency supplies the number of workers.
+   * @param random supplies the random generator.
+   * @return std::string the connection ID, for which workerIndex() returns worker_index.
+   */
+  static std::string generateConnectionId(uint32_t worker_index, uint32_t concurrency,
+                                          Runtime::RandomGenerator& random);
+};
+
+} // namespace Quiche
+} // namespace QuicListeners
+} // namespace Extensions
+} // namespace Envoy
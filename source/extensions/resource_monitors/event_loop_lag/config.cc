@@ -0,0 +1,29 @@
+#include "extensions/resource_monitors/event_loop_lag/config.h"
+
+#include "envoy/registry/registry.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/resource_monitors/event_loop_lag/event_loop_lag_monitor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLagMonitor {
+
+Server::ResourceMonitorPtr EventLoopLagMonitorFactory::createResourceMonitorFromProtoTyped(
+    const envoy::config::resource_monitor::event_loop_lag::v2alpha::EventLoopLagConfig& config,
+    Server::Configuration::ResourceMonitorFactoryContext& context) {
+  return std::make_unique<EventLoopLagMonitor>(config, context.threadLocal(),
+                                               context.api().timeSource());
+}
+
+/**
+ * Static registration for the event loop lag resource monitor factory. @see RegistryFactory.
+ */
+REGISTER_FACTORY(EventLoopLagMonitorFactory, Server::Configuration::ResourceMonitorFactory);
+
+} // namespace EventLoopLagMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
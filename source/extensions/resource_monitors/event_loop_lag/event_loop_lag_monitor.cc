@@ -0,0 +1,71 @@
+#include "extensions/resource_monitors/event_loop_lag/event_loop_lag_monitor.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLagMonitor {
+
+EventLoopLagMonitor::EventLoopLagMonitor(
+    const envoy::config::resource_monitor::event_loop_lag::v2alpha::EventLoopLagConfig& config,
+    ThreadLocal::SlotAllocator& slot_allocator, TimeSource& time_source)
+    : max_lag_(Protobuf::util::TimeUtil::DurationToMicroseconds(config.max_lag())),
+      slot_(slot_allocator.allocateSlot()), time_source_(time_source) {
+  ASSERT(max_lag_.count() > 0);
+}
+
+void EventLoopLagMonitor::updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  std::chrono::microseconds lag = last_lag_;
+  if (probe_ == nullptr) {
+    postProbe(now);
+  } else {
+    // Some thread has not run the previous probe yet, so it lags by at least this much.
+    lag = std::max(lag, std::chrono::duration_cast<std::chrono::microseconds>(
+                            now - probe_->posted_time_));
+  }
+
+  Server::ResourceUsage usage;
+  usage.resource_pressure_ = static_cast<double>(lag.count()) / max_lag_.count();
+  callbacks.onSuccess(usage);
+}
+
+void EventLoopLagMonitor::postProbe(MonotonicTime now) {
+  probe_ = std::make_shared<Probe>(now);
+  std::weak_ptr<Probe> weak_probe = probe_;
+  TimeSource& time_source = time_source_;
+  slot_->runOnAllThreads(
+      [weak_probe, &time_source]() -> void {
+        ProbeSharedPtr probe = weak_probe.lock();
+        if (probe == nullptr) {
+          return;
+        }
+        const int64_t lag_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                   time_source.monotonicTime() - probe->posted_time_)
+                                   .count();
+        int64_t max_lag_us = probe->max_lag_us_.load();
+        while (lag_us > max_lag_us &&
+               !probe->max_lag_us_.compare_exchange_weak(max_lag_us, lag_us)) {
+        }
+      },
+      [this, weak_probe]() -> void {
+        // The probe only survives as long as the monitor, so the monitor is still alive if the
+        // probe is. This runs on the main thread, as does the destruction of the monitor.
+        ProbeSharedPtr probe = weak_probe.lock();
+        if (probe == nullptr) {
+          return;
+        }
+        ASSERT(probe == probe_);
+        last_lag_ = std::chrono::microseconds(probe->max_lag_us_.load());
+        probe_.reset();
+      });
+}
+
+} // namespace EventLoopLagMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
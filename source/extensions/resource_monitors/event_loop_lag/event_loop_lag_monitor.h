@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "envoy/common/time.h"
+#include "envoy/config/resource_monitor/event_loop_lag/v2alpha/event_loop_lag.pb.validate.h"
+#include "envoy/server/resource_monitor.h"
+#include "envoy/thread_local/thread_local.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLagMonitor {
+
+/**
+ * Monitor of the lag of the busiest event loop, measured by posting a probe to every thread.
+ */
+class EventLoopLagMonitor : public Server::ResourceMonitor {
+public:
+  EventLoopLagMonitor(
+      const envoy::config::resource_monitor::event_loop_lag::v2alpha::EventLoopLagConfig& config,
+      ThreadLocal::SlotAllocator& slot_allocator, TimeSource& time_source);
+
+  void updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) override;
+
+private:
+  struct Probe {
+    Probe(MonotonicTime posted_time) : posted_time_(posted_time) {}
+
+    const MonotonicTime posted_time_;
+    // The longest time the probe waited on any thread so far.
+    std::atomic<int64_t> max_lag_us_{0};
+  };
+  typedef std::shared_ptr<Probe> ProbeSharedPtr;
+
+  void postProbe(MonotonicTime now);
+
+  const std::chrono::microseconds max_lag_;
+  ThreadLocal::SlotPtr slot_;
+  TimeSource& time_source_;
+  // The outstanding probe, if any. This is the only owning reference: the per thread callbacks
+  // only hold weak references, so that an outstanding probe never outlives the monitor.
+  ProbeSharedPtr probe_;
+  std::chrono::microseconds last_lag_{};
+};
+
+} // namespace EventLoopLagMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
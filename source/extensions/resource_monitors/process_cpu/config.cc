@@ -0,0 +1,28 @@
+#include "extensions/resource_monitors/process_cpu/config.h"
+
+#include "envoy/registry/registry.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/resource_monitors/process_cpu/process_cpu_monitor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace ProcessCpuMonitor {
+
+Server::ResourceMonitorPtr ProcessCpuMonitorFactory::createResourceMonitorFromProtoTyped(
+    const envoy::config::resource_monitor::process_cpu::v2alpha::ProcessCpuConfig& config,
+    Server::Configuration::ResourceMonitorFactoryContext& context) {
+  return std::make_unique<ProcessCpuMonitor>(config, context.api().timeSource());
+}
+
+/**
+ * Static registration for the process CPU resource monitor factory. @see RegistryFactory.
+ */
+REGISTER_FACTORY(ProcessCpuMonitorFactory, Server::Configuration::ResourceMonitorFactory);
+
+} // namespace ProcessCpuMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "envoy/config/resource_monitor/process_cpu/v2alpha/process_cpu.pb.validate.h"
+#include "envoy/server/resource_monitor_config.h"
+
+#include "extensions/resource_monitors/common/factory_base.h"
+#include "extensions/resource_monitors/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace ProcessCpuMonitor {
+
+class ProcessCpuMonitorFactory
+    : public Common::FactoryBase<
+          envoy::config::resource_monitor::process_cpu::v2alpha::ProcessCpuConfig> {
+public:
+  ProcessCpuMonitorFactory() : FactoryBase(ResourceMonitorNames::get().ProcessCpu) {}
+
+private:
+  Server::ResourceMonitorPtr createResourceMonitorFromProtoTyped(
+      const envoy::config::resource_monitor::process_cpu::v2alpha::ProcessCpuConfig& config,
+      Server::Configuration::ResourceMonitorFactoryContext& context) override;
+};
+
+} // namespace ProcessCpuMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
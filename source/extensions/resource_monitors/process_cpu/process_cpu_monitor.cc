@@ -0,0 +1,69 @@
+#include "extensions/resource_monitors/process_cpu/process_cpu_monitor.h"
+
+#include <sys/resource.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace ProcessCpuMonitor {
+
+namespace {
+
+std::chrono::microseconds toMicroseconds(const timeval& time) {
+  return std::chrono::seconds(time.tv_sec) + std::chrono::microseconds(time.tv_usec);
+}
+
+} // namespace
+
+std::chrono::microseconds CpuTimeReader::processCpuTime() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    throw EnvoyException(fmt::format("unable to read process CPU time: {}", strerror(errno)));
+  }
+  return toMicroseconds(usage.ru_utime) + toMicroseconds(usage.ru_stime);
+}
+
+ProcessCpuMonitor::ProcessCpuMonitor(
+    const envoy::config::resource_monitor::process_cpu::v2alpha::ProcessCpuConfig& config,
+    TimeSource& time_source, std::unique_ptr<CpuTimeReader> reader)
+    : max_cpu_cores_(config.max_cpu_cores()), time_source_(time_source),
+      reader_(std::move(reader)), last_time_(time_source_.monotonicTime()),
+      last_cpu_time_(reader_->processCpuTime()) {
+  ASSERT(max_cpu_cores_ > 0);
+}
+
+void ProcessCpuMonitor::updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) {
+  std::chrono::microseconds cpu_time;
+  try {
+    cpu_time = reader_->processCpuTime();
+  } catch (const EnvoyException& error) {
+    callbacks.onFailure(error);
+    return;
+  }
+
+  const MonotonicTime now = time_source_.monotonicTime();
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time_);
+  // Updates closer together than the clock resolution report the previous pressure again.
+  if (elapsed.count() > 0) {
+    last_pressure_ = (cpu_time - last_cpu_time_).count() / (elapsed.count() * max_cpu_cores_);
+    last_time_ = now;
+    last_cpu_time_ = cpu_time;
+  }
+
+  Server::ResourceUsage usage;
+  usage.resource_pressure_ = last_pressure_;
+  callbacks.onSuccess(usage);
+}
+
+} // namespace ProcessCpuMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+
+#include "envoy/common/time.h"
+#include "envoy/config/resource_monitor/process_cpu/v2alpha/process_cpu.pb.validate.h"
+#include "envoy/server/resource_monitor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace ProcessCpuMonitor {
+
+/**
+ * Helper class for getting the CPU time used by the process.
+ */
+class CpuTimeReader {
+public:
+  CpuTimeReader() {}
+  virtual ~CpuTimeReader() {}
+
+  // User and system CPU time used by all threads of the process.
+  // @throw EnvoyException if the CPU time cannot be read.
+  virtual std::chrono::microseconds processCpuTime();
+};
+
+/**
+ * CPU saturation monitor for the process, relative to a statically configured number of cores.
+ */
+class ProcessCpuMonitor : public Server::ResourceMonitor {
+public:
+  // @throw EnvoyException if the CPU time of the process cannot be read.
+  ProcessCpuMonitor(
+      const envoy::config::resource_monitor::process_cpu::v2alpha::ProcessCpuConfig& config,
+      TimeSource& time_source,
+      std::unique_ptr<CpuTimeReader> reader = std::make_unique<CpuTimeReader>());
+
+  void updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) override;
+
+private:
+  const double max_cpu_cores_;
+  TimeSource& time_source_;
+  std::unique_ptr<CpuTimeReader> reader_;
+  // The sample the next update is computed against.
+  MonotonicTime last_time_;
+  std::chrono::microseconds last_cpu_time_;
+  double last_pressure_{};
+};
+
+} // namespace ProcessCpuMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -18,6 +18,12 @@ public:
 
   // File-based injected resource monitor.
   const std::string InjectedResource = "envoy.resource_monitors.injected_resource";
+
+  // Process CPU saturation monitor with statically configured number of cores.
+  const std::string ProcessCpu = "envoy.resource_monitors.process_cpu";
+
+  // Monitor of the event loop lag of the busiest thread.
+  const std::string EventLoopLag = "envoy.resource_monitors.event_loop_lag";
 };
 
 typedef ConstSingleton<ResourceMonitorNameValues> ResourceMonitorNames;
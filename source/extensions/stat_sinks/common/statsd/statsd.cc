@@ -1,8 +1,14 @@
 #include "extensions/stat_sinks/common/statsd/statsd.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#endif
 
 #include "envoy/common/exception.h"
 #include "envoy/event/dispatcher.h"
@@ -14,6 +20,8 @@
 #include "common/common/utility.h"
 #include "common/config/utility.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace StatSinks {
@@ -38,32 +46,114 @@ void Writer::write(const std::string& message) {
   ::send(io_handle_->fd(), message.c_str(), message.size(), MSG_DONTWAIT);
 }
 
+void Writer::writeDatagrams(const std::vector<std::string>& datagrams) {
+#if defined(__linux__)
+  std::vector<iovec> iovecs(datagrams.size());
+  std::vector<mmsghdr> headers(datagrams.size());
+  for (size_t i = 0; i < datagrams.size(); ++i) {
+    iovecs[i].iov_base = const_cast<char*>(datagrams[i].data());
+    iovecs[i].iov_len = datagrams[i].size();
+    headers[i] = {};
+    headers[i].msg_hdr.msg_iov = &iovecs[i];
+    headers[i].msg_hdr.msg_iovlen = 1;
+  }
+  // The kernel sends at most 1024 (UIO_MAXIOV) messages per call, and may send fewer. Like
+  // write(), this is best effort: if the socket buffer is full the remaining datagrams are dropped.
+  static constexpr size_t MaxMessagesPerCall = 1024;
+  size_t sent = 0;
+  while (sent < headers.size()) {
+    const unsigned int count = std::min(headers.size() - sent, MaxMessagesPerCall);
+    const int rc = ::sendmmsg(io_handle_->fd(), &headers[sent], count, MSG_DONTWAIT);
+    if (rc <= 0) {
+      break;
+    }
+    sent += rc;
+  }
+#else
+  for (const std::string& datagram : datagrams) {
+    write(datagram);
+  }
+#endif
+}
+
 UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
                              Network::Address::InstanceConstSharedPtr address, const bool use_tag,
-                             const std::string& prefix)
+                             const std::string& prefix, const bool flush_changed_only,
+                             const uint64_t max_bytes_per_datagram)
     : tls_(tls.allocateSlot()), server_address_(std::move(address)), use_tag_(use_tag),
-      prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix) {
+      prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix),
+      flush_changed_only_(flush_changed_only), max_bytes_per_datagram_(max_bytes_per_datagram) {
   tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::make_shared<Writer>(this->server_address_);
   });
 }
 
 void UdpStatsdSink::flush(Stats::Source& source) {
+  // Forget the metrics that were removed from the store since the previous flush, which the cache
+  // holds the last reference to.
+  for (auto it = rendered_metrics_.begin(); it != rendered_metrics_.end();) {
+    if (it->second.metric_.use_count() == 1) {
+      it = rendered_metrics_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
   Writer& writer = tls_->getTyped<Writer>();
-  for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
+  std::vector<std::string> datagrams;
+  const std::vector<Stats::CounterSharedPtr>& counters =
+      flush_changed_only_ ? source.cachedChangedCounters() : source.cachedCounters();
+  for (const Stats::CounterSharedPtr& counter : counters) {
     if (counter->used()) {
       uint64_t delta = counter->latch();
-      writer.write(fmt::format("{}.{}:{}|c{}", prefix_, getName(*counter), delta,
-                               buildTagStr(counter->tags())));
+      writeMetric(writer, datagrams, renderedMetric(counter, 'c'), delta);
     }
   }
 
-  for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
+  const std::vector<Stats::GaugeSharedPtr>& gauges =
+      flush_changed_only_ ? source.cachedChangedGauges() : source.cachedGauges();
+  for (const Stats::GaugeSharedPtr& gauge : gauges) {
     if (gauge->used()) {
-      writer.write(fmt::format("{}.{}:{}|g{}", prefix_, getName(*gauge), gauge->value(),
-                               buildTagStr(gauge->tags())));
+      writeMetric(writer, datagrams, renderedMetric(gauge, 'g'), gauge->value());
     }
   }
+
+  if (!datagrams.empty()) {
+    writer.writeDatagrams(datagrams);
+  }
+}
+
+template <class StatType>
+const UdpStatsdSink::RenderedMetric&
+UdpStatsdSink::renderedMetric(const std::shared_ptr<StatType>& metric, char type) {
+  RenderedMetric& rendered = rendered_metrics_[metric.get()];
+  if (rendered.metric_ == nullptr) {
+    rendered.metric_ = metric;
+    rendered.head_ = absl::StrCat(prefix_, ".", getName(*metric), ":");
+    rendered.tail_ = absl::StrCat("|", absl::string_view(&type, 1), buildTagStr(metric->tags()));
+  }
+  return rendered;
+}
+
+void UdpStatsdSink::writeMetric(Writer& writer, std::vector<std::string>& datagrams,
+                                const RenderedMetric& metric, uint64_t value) {
+  char value_str[32];
+  const uint32_t value_size = StringUtil::itoa(value_str, sizeof(value_str), value);
+  const absl::string_view value_view(value_str, value_size);
+  if (max_bytes_per_datagram_ == 0) {
+    writer.write(absl::StrCat(metric.head_, value_view, metric.tail_));
+    return;
+  }
+  // statsd accepts several newline separated metrics per datagram. A metric that doesn't fit in
+  // the current datagram starts a new one, even if it is too big for a datagram by itself.
+  const uint64_t metric_size = metric.head_.size() + value_size + metric.tail_.size();
+  if (datagrams.empty() || datagrams.back().size() + 1 + metric_size > max_bytes_per_datagram_) {
+    datagrams.emplace_back();
+    datagrams.back().reserve(max_bytes_per_datagram_);
+  } else {
+    datagrams.back().push_back('\n');
+  }
+  absl::StrAppend(&datagrams.back(), metric.head_, value_view, metric.tail_);
 }
 
 void UdpStatsdSink::onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) {
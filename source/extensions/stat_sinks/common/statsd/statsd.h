@@ -1,5 +1,10 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "envoy/local_info/local_info.h"
 #include "envoy/network/connection.h"
 #include "envoy/stats/histogram.h"
@@ -34,6 +39,10 @@ public:
   virtual ~Writer();
 
   virtual void write(const std::string& message);
+  /**
+   * Sends each string as its own datagram, using as few syscalls as the platform allows.
+   */
+  virtual void writeDatagrams(const std::vector<std::string>& datagrams);
   // Called in unit test to validate address.
   int getFdForTests() const { return io_handle_->fd(); }
 
@@ -47,12 +56,15 @@ private:
 class UdpStatsdSink : public Stats::Sink {
 public:
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address,
-                const bool use_tag, const std::string& prefix = getDefaultPrefix());
+                const bool use_tag, const std::string& prefix = getDefaultPrefix(),
+                const bool flush_changed_only = false, const uint64_t max_bytes_per_datagram = 0);
   // For testing.
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, const std::shared_ptr<Writer>& writer,
-                const bool use_tag, const std::string& prefix = getDefaultPrefix())
+                const bool use_tag, const std::string& prefix = getDefaultPrefix(),
+                const bool flush_changed_only = false, const uint64_t max_bytes_per_datagram = 0)
       : tls_(tls.allocateSlot()), use_tag_(use_tag),
-        prefix_(prefix.empty() ? getDefaultPrefix() : prefix) {
+        prefix_(prefix.empty() ? getDefaultPrefix() : prefix),
+        flush_changed_only_(flush_changed_only), max_bytes_per_datagram_(max_bytes_per_datagram) {
     tls_->set(
         [writer](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr { return writer; });
   }
@@ -64,17 +76,40 @@ public:
   // Called in unit test to validate writer construction and address.
   int getFdForTests() { return tls_->getTyped<Writer>().getFdForTests(); }
   bool getUseTagForTest() { return use_tag_; }
+  bool getFlushChangedOnlyForTest() { return flush_changed_only_; }
+  uint64_t getMaxBytesPerDatagramForTest() { return max_bytes_per_datagram_; }
+  uint64_t getRenderedMetricsForTest() { return rendered_metrics_.size(); }
   const std::string& getPrefix() { return prefix_; }
 
 private:
+  // The parts of a flushed metric before and after its value, e.g. "envoy.name:" and
+  // "|c|#tag:value", which never change once the metric is created.
+  struct RenderedMetric {
+    // Keeps the address of the metric from being reused while it is cached.
+    std::shared_ptr<const Stats::Metric> metric_;
+    std::string head_;
+    std::string tail_;
+  };
+
   const std::string getName(const Stats::Metric& metric);
   const std::string buildTagStr(const std::vector<Stats::Tag>& tags);
+  template <class StatType>
+  const RenderedMetric& renderedMetric(const std::shared_ptr<StatType>& metric, char type);
+  // Sends metric right away, or appends it to the datagrams being built if batching is on.
+  void writeMetric(Writer& writer, std::vector<std::string>& datagrams,
+                   const RenderedMetric& metric, uint64_t value);
 
   ThreadLocal::SlotPtr tls_;
   Network::Address::InstanceConstSharedPtr server_address_;
   const bool use_tag_;
   // Prefix for all flushed stats.
   const std::string prefix_;
+  // Whether to only flush the counters and gauges that changed since the previous flush.
+  const bool flush_changed_only_;
+  // If non-zero, flushed metrics are packed into newline separated datagrams of up to this size.
+  const uint64_t max_bytes_per_datagram_;
+  // The rendered counters and gauges, by metric. Only accessed by flush(), on the main thread.
+  std::unordered_map<const Stats::Metric*, RenderedMetric> rendered_metrics_;
 };
 
 /**
@@ -25,6 +25,20 @@ const uint64_t HystrixSink::DEFAULT_NUM_BUCKETS;
 ClusterStatsCache::ClusterStatsCache(const std::string& cluster_name)
     : cluster_name_(cluster_name) {}
 
+void ClusterStatsCache::resolveStats(const Upstream::ClusterInfoConstSharedPtr& cluster_info) {
+  if (cluster_info == cluster_info_) {
+    return;
+  }
+  cluster_info_ = cluster_info;
+  Stats::Scope& cluster_stats_scope = cluster_info->statsScope();
+  upstream_rq_2xx_ = &cluster_stats_scope.counter("upstream_rq_2xx");
+  upstream_rq_4xx_ = &cluster_stats_scope.counter("upstream_rq_4xx");
+  retry_upstream_rq_4xx_ = &cluster_stats_scope.counter("retry.upstream_rq_4xx");
+  upstream_rq_5xx_ = &cluster_stats_scope.counter("upstream_rq_5xx");
+  retry_upstream_rq_5xx_ = &cluster_stats_scope.counter("retry.upstream_rq_5xx");
+  membership_total_ = &cluster_stats_scope.gauge("membership_total");
+}
+
 void ClusterStatsCache::printToStream(std::stringstream& out_str) {
   const std::string cluster_name_prefix = absl::StrCat(cluster_name_, ".");
 
@@ -35,7 +49,8 @@ void ClusterStatsCache::printToStream(std::stringstream& out_str) {
   printRollingWindow(absl::StrCat(cluster_name_prefix, "total"), total_, out_str);
 }
 
-void ClusterStatsCache::printRollingWindow(absl::string_view name, RollingWindow rolling_window,
+void ClusterStatsCache::printRollingWindow(absl::string_view name,
+                                           const RollingWindow& rolling_window,
                                            std::stringstream& out_str) {
   out_str << name << " | ";
   for (auto specific_stat_vec_itr = rolling_window.begin();
@@ -67,7 +82,7 @@ void HystrixSink::pushNewValue(RollingWindow& rolling_window, uint64_t value) {
   }
 }
 
-uint64_t HystrixSink::getRollingValue(RollingWindow rolling_window) {
+uint64_t HystrixSink::getRollingValue(const RollingWindow& rolling_window) {
 
   if (rolling_window.empty()) {
     return 0;
@@ -81,11 +96,10 @@ uint64_t HystrixSink::getRollingValue(RollingWindow rolling_window) {
   }
 }
 
-void HystrixSink::updateRollingWindowMap(const Upstream::ClusterInfo& cluster_info,
+void HystrixSink::updateRollingWindowMap(const Upstream::ClusterInfoConstSharedPtr& cluster_info,
                                          ClusterStatsCache& cluster_stats_cache) {
-  const std::string cluster_name = cluster_info.name();
-  Upstream::ClusterStats& cluster_stats = cluster_info.stats();
-  Stats::Scope& cluster_stats_scope = cluster_info.statsScope();
+  cluster_stats_cache.resolveStats(cluster_info);
+  Upstream::ClusterStats& cluster_stats = cluster_info->stats();
 
   // Combining timeouts+retries - retries are counted  as separate requests
   // (alternative: each request including the retries counted as 1).
@@ -98,15 +112,15 @@ void HystrixSink::updateRollingWindowMap(const Upstream::ClusterInfo& cluster_in
   // (alternative: each request including the retries counted as 1)
   // since timeouts are 504 (or 408), deduce them from here ("-" sign).
   // Timeout retries were not counted here anyway.
-  uint64_t errors = cluster_stats_scope.counter("upstream_rq_5xx").value() +
-                    cluster_stats_scope.counter("retry.upstream_rq_5xx").value() +
-                    cluster_stats_scope.counter("upstream_rq_4xx").value() +
-                    cluster_stats_scope.counter("retry.upstream_rq_4xx").value() -
+  uint64_t errors = cluster_stats_cache.upstream_rq_5xx_->value() +
+                    cluster_stats_cache.retry_upstream_rq_5xx_->value() +
+                    cluster_stats_cache.upstream_rq_4xx_->value() +
+                    cluster_stats_cache.retry_upstream_rq_4xx_->value() -
                     cluster_stats.upstream_rq_timeout_.value();
 
   pushNewValue(cluster_stats_cache.errors_, errors);
 
-  uint64_t success = cluster_stats_scope.counter("upstream_rq_2xx").value();
+  uint64_t success = cluster_stats_cache.upstream_rq_2xx_->value();
   pushNewValue(cluster_stats_cache.success_, success);
 
   uint64_t rejected = cluster_stats.upstream_rq_pending_overflow_.value();
@@ -116,21 +130,24 @@ void HystrixSink::updateRollingWindowMap(const Upstream::ClusterInfo& cluster_in
   // leading to wrong results such as error percentage higher than 100%
   uint64_t total = errors + timeouts + success + rejected;
   pushNewValue(cluster_stats_cache.total_, total);
-
-  ENVOY_LOG(trace, "{}", printRollingWindows());
 }
 
 void HystrixSink::resetRollingWindow() { cluster_stats_cache_map_.clear(); }
 
 void HystrixSink::addStringToStream(absl::string_view key, absl::string_view value,
                                     std::stringstream& info, bool is_first) {
-  std::string quoted_value = absl::StrCat("\"", value, "\"");
-  addInfoToStream(key, quoted_value, info, is_first);
+  if (!is_first) {
+    info << ", ";
+  }
+  info << "\"" << key << "\": \"" << value << "\"";
 }
 
 void HystrixSink::addIntToStream(absl::string_view key, uint64_t value, std::stringstream& info,
                                  bool is_first) {
-  addInfoToStream(key, std::to_string(value), info, is_first);
+  if (!is_first) {
+    info << ", ";
+  }
+  info << "\"" << key << "\": " << value;
 }
 
 void HystrixSink::addDoubleToStream(absl::string_view key, double value, std::stringstream& info,
@@ -143,8 +160,7 @@ void HystrixSink::addInfoToStream(absl::string_view key, absl::string_view value
   if (!is_first) {
     info << ", ";
   }
-  std::string added_info = absl::StrCat("\"", key, "\": ", value);
-  info << added_info;
+  info << "\"" << key << "\": " << value;
 }
 
 void HystrixSink::addHystrixCommand(ClusterStatsCache& cluster_stats_cache,
@@ -321,6 +337,7 @@ void HystrixSink::flush(Stats::Source& source) {
     return;
   }
   incCounter();
+  // The event stream is the same for all connections, so it is formatted once per flush.
   std::stringstream ss;
   Upstream::ClusterManager::ClusterInfoMap clusters = server_.clusterManager().clusters();
 
@@ -366,19 +383,21 @@ void HystrixSink::flush(Stats::Source& source) {
     }
 
     // update rolling window with cluster stats
-    updateRollingWindowMap(*cluster_info, *cluster_stats_cache_ptr);
+    updateRollingWindowMap(cluster_info, *cluster_stats_cache_ptr);
 
     // append it to stream to be sent
     addClusterStatsToStream(
         *cluster_stats_cache_ptr, cluster_info->name(),
         cluster_info->resourceManager(Upstream::ResourcePriority::Default).pendingRequests().max(),
-        cluster_info->statsScope().gauge("membership_total").value(), server_.statsFlushInterval(),
+        cluster_stats_cache_ptr->membership_total_->value(), server_.statsFlushInterval(),
         time_histograms[cluster_info->name()], ss);
   }
+  ENVOY_LOG(trace, "{}", printRollingWindows());
 
+  const std::string event_stream = ss.str();
   Buffer::OwnedImpl data;
   for (auto callbacks : callbacks_list_) {
-    data.add(ss.str());
+    data.add(event_stream);
     callbacks->encodeData(data, false);
   }
 
@@ -9,6 +9,8 @@
 #include "envoy/stats/histogram.h"
 #include "envoy/stats/sink.h"
 #include "envoy/stats/source.h"
+#include "envoy/stats/stats.h"
+#include "envoy/upstream/upstream.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -29,11 +31,27 @@ struct {
 struct ClusterStatsCache {
   ClusterStatsCache(const std::string& cluster_name);
 
+  /**
+   * Look up the stats of the cluster that are not part of its ClusterStats, unless they were
+   * already looked up for the given cluster info.
+   */
+  void resolveStats(const Upstream::ClusterInfoConstSharedPtr& cluster_info);
+
   void printToStream(std::stringstream& out_str);
-  void printRollingWindow(absl::string_view name, RollingWindow rolling_window,
+  void printRollingWindow(absl::string_view name, const RollingWindow& rolling_window,
                           std::stringstream& out_str);
   std::string cluster_name_;
 
+  // The cluster info that the stats below were looked up from, which keeps them alive. A cluster
+  // that is updated gets a new cluster info, and its stats are looked up again.
+  Upstream::ClusterInfoConstSharedPtr cluster_info_;
+  Stats::Counter* upstream_rq_2xx_{};
+  Stats::Counter* upstream_rq_4xx_{};
+  Stats::Counter* retry_upstream_rq_4xx_{};
+  Stats::Counter* upstream_rq_5xx_{};
+  Stats::Counter* retry_upstream_rq_5xx_{};
+  Stats::Gauge* membership_total_{};
+
   // Rolling windows
   RollingWindow errors_;
   RollingWindow success_;
@@ -63,7 +81,8 @@ public:
   void unregisterConnection(Http::StreamDecoderFilterCallbacks* callbacks_to_remove);
 
   /**
-   * Add new value to top of rolling window, pushing out the oldest value.
+   * Add new value to top of rolling window, pushing out the oldest value. The window of a cluster
+   * is allocated once, and its values then overwritten in place as the current index advances.
    */
   void pushNewValue(RollingWindow& rolling_window, uint64_t value);
 
@@ -84,7 +103,7 @@ public:
   /**
    * Calculate values needed to create the stream and write into the map.
    */
-  void updateRollingWindowMap(const Upstream::ClusterInfo& cluster_info,
+  void updateRollingWindowMap(const Upstream::ClusterInfoConstSharedPtr& cluster_info,
                               ClusterStatsCache& cluster_stats_cache);
   /**
    * Clear map.
@@ -99,7 +118,7 @@ public:
   /**
    * Get the statistic's value change over the rolling window time frame.
    */
-  uint64_t getRollingValue(RollingWindow rolling_window);
+  uint64_t getRollingValue(const RollingWindow& rolling_window);
 
   /**
    * Format the given key and value to "key"=value, and adding to the stringstream.
@@ -6,6 +6,7 @@
 
 #include "common/grpc/async_client_impl.h"
 #include "common/network/resolver_impl.h"
+#include "common/protobuf/utility.h"
 
 #include "extensions/stat_sinks/metrics_service/grpc_metrics_service_impl.h"
 #include "extensions/stat_sinks/well_known_names.h"
@@ -29,7 +30,9 @@ Stats::SinkPtr MetricsServiceSinkFactory::createStatsSink(const Protobuf::Messag
               grpc_service, server.stats(), false),
           server.localInfo());
 
-  return std::make_unique<MetricsServiceSink>(grpc_metrics_streamer, server.timeSource());
+  return std::make_unique<MetricsServiceSink>(
+      grpc_metrics_streamer, server.timeSource(), sink_config.flush_changed_only(),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(sink_config, max_metrics_per_message, 0));
 }
 
 ProtobufTypes::MessagePtr MetricsServiceSinkFactory::createEmptyConfigProto() {
@@ -1,5 +1,7 @@
 #include "extensions/stat_sinks/metrics_service/grpc_metrics_service_impl.h"
 
+#include <algorithm>
+
 #include "envoy/common/exception.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/stats/histogram.h"
@@ -34,40 +36,39 @@ void GrpcMetricsStreamerImpl::send(envoy::service::metrics::v2::StreamMetricsMes
 }
 
 MetricsServiceSink::MetricsServiceSink(const GrpcMetricsStreamerSharedPtr& grpc_metrics_streamer,
-                                       TimeSource& time_source)
-    : grpc_metrics_streamer_(grpc_metrics_streamer), time_source_(time_source) {}
+                                       TimeSource& time_source, bool flush_changed_only,
+                                       uint32_t max_metrics_per_message)
+    : grpc_metrics_streamer_(grpc_metrics_streamer), time_source_(time_source),
+      flush_changed_only_(flush_changed_only), max_metrics_per_message_(max_metrics_per_message) {}
 
-void MetricsServiceSink::flushCounter(const Stats::Counter& counter) {
+io::prometheus::client::Metric*
+MetricsServiceSink::addMetric(io::prometheus::client::MetricType type, const std::string& name) {
+  if (max_metrics_per_message_ != 0 &&
+      static_cast<uint32_t>(message_.envoy_metrics_size()) >= max_metrics_per_message_) {
+    sendMessage();
+  }
   io::prometheus::client::MetricFamily* metrics_family = message_.add_envoy_metrics();
-  metrics_family->set_type(io::prometheus::client::MetricType::COUNTER);
-  metrics_family->set_name(counter.name());
+  metrics_family->set_type(type);
+  metrics_family->set_name(name);
   auto* metric = metrics_family->add_metric();
-  metric->set_timestamp_ms(std::chrono::duration_cast<std::chrono::milliseconds>(
-                               time_source_.systemTime().time_since_epoch())
-                               .count());
+  metric->set_timestamp_ms(flush_timestamp_ms_);
+  return metric;
+}
+
+void MetricsServiceSink::flushCounter(const Stats::Counter& counter) {
+  auto* metric = addMetric(io::prometheus::client::MetricType::COUNTER, counter.name());
   auto* counter_metric = metric->mutable_counter();
   counter_metric->set_value(counter.value());
 }
 
 void MetricsServiceSink::flushGauge(const Stats::Gauge& gauge) {
-  io::prometheus::client::MetricFamily* metrics_family = message_.add_envoy_metrics();
-  metrics_family->set_type(io::prometheus::client::MetricType::GAUGE);
-  metrics_family->set_name(gauge.name());
-  auto* metric = metrics_family->add_metric();
-  metric->set_timestamp_ms(std::chrono::duration_cast<std::chrono::milliseconds>(
-                               time_source_.systemTime().time_since_epoch())
-                               .count());
+  auto* metric = addMetric(io::prometheus::client::MetricType::GAUGE, gauge.name());
   auto* gauage_metric = metric->mutable_gauge();
   gauage_metric->set_value(gauge.value());
 }
+
 void MetricsServiceSink::flushHistogram(const Stats::ParentHistogram& histogram) {
-  io::prometheus::client::MetricFamily* metrics_family = message_.add_envoy_metrics();
-  metrics_family->set_type(io::prometheus::client::MetricType::SUMMARY);
-  metrics_family->set_name(histogram.name());
-  auto* metric = metrics_family->add_metric();
-  metric->set_timestamp_ms(std::chrono::duration_cast<std::chrono::milliseconds>(
-                               time_source_.systemTime().time_since_epoch())
-                               .count());
+  auto* metric = addMetric(io::prometheus::client::MetricType::SUMMARY, histogram.name());
   auto* summary_metric = metric->mutable_summary();
   const Stats::HistogramStatistics& hist_stats = histogram.intervalStatistics();
   for (size_t i = 0; i < hist_stats.supportedQuantiles().size(); i++) {
@@ -77,15 +78,34 @@ void MetricsServiceSink::flushHistogram(const Stats::ParentHistogram& histogram)
   }
 }
 
+void MetricsServiceSink::sendMessage() {
+  grpc_metrics_streamer_->send(message_);
+  sent_message_ = true;
+  message_.clear_envoy_metrics();
+  // for perf reasons, clear the identifier after the first message.
+  if (message_.has_identifier()) {
+    message_.clear_identifier();
+  }
+}
+
 void MetricsServiceSink::flush(Stats::Source& source) {
   message_.clear_envoy_metrics();
-  const std::vector<Stats::CounterSharedPtr>& counters = source.cachedCounters();
-  const std::vector<Stats::GaugeSharedPtr>& gauges = source.cachedGauges();
-  const std::vector<Stats::ParentHistogramSharedPtr>& histograms = source.cachedHistograms();
-  // TODO(mrice32): there's probably some more sophisticated preallocation we can do here where we
-  // actually preallocate the submessages and then pass ownership to the proto (rather than just
-  // preallocating the pointer array).
-  message_.mutable_envoy_metrics()->Reserve(counters.size() + gauges.size() + histograms.size());
+  sent_message_ = false;
+  // All the metrics of a flush share its timestamp.
+  flush_timestamp_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            time_source_.systemTime().time_since_epoch())
+                            .count();
+  const std::vector<Stats::CounterSharedPtr>& counters =
+      flush_changed_only_ ? source.cachedChangedCounters() : source.cachedCounters();
+  const std::vector<Stats::GaugeSharedPtr>& gauges =
+      flush_changed_only_ ? source.cachedChangedGauges() : source.cachedGauges();
+  const std::vector<Stats::ParentHistogramSharedPtr>& histograms =
+      flush_changed_only_ ? source.cachedChangedHistograms() : source.cachedHistograms();
+  uint64_t metrics = counters.size() + gauges.size() + histograms.size();
+  if (max_metrics_per_message_ != 0) {
+    metrics = std::min<uint64_t>(metrics, max_metrics_per_message_);
+  }
+  message_.mutable_envoy_metrics()->Reserve(metrics);
   for (const Stats::CounterSharedPtr& counter : counters) {
     if (counter->used()) {
       flushCounter(*counter);
@@ -104,10 +124,9 @@ void MetricsServiceSink::flush(Stats::Source& source) {
     }
   }
 
-  grpc_metrics_streamer_->send(message_);
-  // for perf reasons, clear the identifier after the first flush.
-  if (message_.has_identifier()) {
-    message_.clear_identifier();
+  // A flush without any metrics still sends a message, e.g. to open the stream.
+  if (message_.envoy_metrics_size() > 0 || !sent_message_) {
+    sendMessage();
   }
 }
 
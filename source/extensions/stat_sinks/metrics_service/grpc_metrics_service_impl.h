@@ -72,7 +72,8 @@ class MetricsServiceSink : public Stats::Sink {
 public:
   // MetricsService::Sink
   MetricsServiceSink(const GrpcMetricsStreamerSharedPtr& grpc_metrics_streamer,
-                     TimeSource& time_system);
+                     TimeSource& time_system, bool flush_changed_only = false,
+                     uint32_t max_metrics_per_message = 0);
   void flush(Stats::Source& source) override;
   void onHistogramComplete(const Stats::Histogram&, uint64_t) override {}
 
@@ -81,9 +82,24 @@ public:
   void flushHistogram(const Stats::ParentHistogram& histogram);
 
 private:
+  io::prometheus::client::Metric* addMetric(io::prometheus::client::MetricType type,
+                                            const std::string& name);
+  void sendMessage();
+
   GrpcMetricsStreamerSharedPtr grpc_metrics_streamer_;
+  // Reused across flushes and messages. Clearing the metric families keeps them allocated, so that
+  // steady state flushes overwrite the families of the previous flush rather than allocating new
+  // ones.
   envoy::service::metrics::v2::StreamMetricsMessage message_;
   TimeSource& time_source_;
+  // Whether to only stream the metrics that changed since the previous flush.
+  const bool flush_changed_only_;
+  // The maximum number of metrics per message, or 0 to send all metrics of a flush in one message.
+  const uint32_t max_metrics_per_message_;
+  // The timestamp of the metrics of the flush in progress.
+  int64_t flush_timestamp_ms_{};
+  // Whether a message was sent for the flush in progress.
+  bool sent_message_{};
 };
 
 } // namespace MetricsService
@@ -0,0 +1,42 @@
+#include "extensions/stat_sinks/shared_memory/config.h"
+
+#include <memory>
+
+#include "envoy/config/metrics/v2/stats.pb.h"
+#include "envoy/config/metrics/v2/stats.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "common/api/os_sys_calls_impl.h"
+
+#include "extensions/stat_sinks/shared_memory/shared_memory_sink.h"
+#include "extensions/stat_sinks/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace SharedMemory {
+
+Stats::SinkPtr SharedMemorySinkFactory::createStatsSink(const Protobuf::Message& config,
+                                                        Server::Instance& server) {
+  const auto& sink_config =
+      MessageUtil::downcastAndValidate<const envoy::config::metrics::v2::SharedMemorySink&>(
+          config);
+  return std::make_unique<SharedMemorySink>(sink_config.name(), server.timeSource(),
+                                            Api::OsSysCallsSingleton::get());
+}
+
+ProtobufTypes::MessagePtr SharedMemorySinkFactory::createEmptyConfigProto() {
+  return std::make_unique<envoy::config::metrics::v2::SharedMemorySink>();
+}
+
+std::string SharedMemorySinkFactory::name() { return StatsSinkNames::get().SharedMemory; }
+
+/**
+ * Static registration for the shared memory sink factory. @see RegisterFactory.
+ */
+REGISTER_FACTORY(SharedMemorySinkFactory, Server::Configuration::StatsSinkFactory);
+
+} // namespace SharedMemory
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
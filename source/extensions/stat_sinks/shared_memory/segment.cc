@@ -0,0 +1,156 @@
+#include "extensions/stat_sinks/shared_memory/segment.h"
+
+#include <cstring>
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace SharedMemory {
+
+namespace {
+
+/**
+ * Bounds checked cursor over a copy of the segment.
+ */
+class Cursor {
+public:
+  Cursor(const std::vector<uint8_t>& copy, uint64_t offset) : copy_(copy), offset_(offset) {}
+
+  template <class T> bool read(T& out) {
+    if (!has(sizeof(T))) {
+      return false;
+    }
+    memcpy(&out, copy_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool readString(uint64_t size, std::string& out) {
+    if (!has(size)) {
+      return false;
+    }
+    out.assign(reinterpret_cast<const char*>(copy_.data()) + offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool has(uint64_t size) const {
+    return offset_ <= copy_.size() && size <= copy_.size() - offset_;
+  }
+  uint64_t offset() const { return offset_; }
+
+private:
+  const std::vector<uint8_t>& copy_;
+  uint64_t offset_;
+};
+
+} // namespace
+
+bool SegmentReader::read(const void* segment, uint64_t mapping_size, Snapshot& snapshot,
+                         uint32_t max_attempts) {
+  if (mapping_size < sizeof(SegmentHeader)) {
+    return false;
+  }
+  const SegmentHeader* header = static_cast<const SegmentHeader*>(segment);
+  std::vector<uint8_t> copy;
+  for (uint32_t attempt = 0; attempt < max_attempts; ++attempt) {
+    const uint64_t before = header->sequence_.load(std::memory_order_acquire);
+    if (before & 1) {
+      continue;
+    }
+    uint64_t segment_size;
+    memcpy(&segment_size, &header->segment_size_, sizeof(segment_size));
+    const bool fits = segment_size >= sizeof(SegmentHeader) && segment_size <= mapping_size;
+    if (fits) {
+      copy.resize(segment_size);
+      memcpy(copy.data(), segment, segment_size);
+    }
+    // Order the copy before the second read of the sequence, so that a concurrent update is
+    // always detected.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->sequence_.load(std::memory_order_relaxed) != before) {
+      continue;
+    }
+    if (!fits) {
+      snapshot.segment_size_ = segment_size;
+      return false;
+    }
+    return parse(copy, snapshot);
+  }
+  return false;
+}
+
+bool SegmentReader::parse(const std::vector<uint8_t>& copy, Snapshot& snapshot) {
+  SegmentHeader header;
+  memcpy(static_cast<void*>(&header), copy.data(), sizeof(header));
+  if (memcmp(header.magic_, SegmentMagic, sizeof(SegmentMagic)) != 0 ||
+      header.version_ != SegmentVersion || header.header_size_ != sizeof(SegmentHeader)) {
+    return false;
+  }
+  snapshot.flags_ = header.flags_;
+  snapshot.segment_size_ = header.segment_size_;
+  snapshot.layout_generation_ = header.layout_generation_;
+  snapshot.update_time_ms_ = header.update_time_ms_;
+
+  Cursor quantiles(copy, header.quantiles_offset_);
+  snapshot.quantiles_.resize(header.num_quantiles_);
+  for (double& quantile : snapshot.quantiles_) {
+    if (!quantiles.read(quantile)) {
+      return false;
+    }
+  }
+
+  snapshot.records_.clear();
+  snapshot.records_.reserve(header.num_records_);
+  uint64_t record_offset = header.records_offset_;
+  for (uint32_t i = 0; i < header.num_records_; ++i) {
+    Cursor cursor(copy, record_offset);
+    RecordHeader record_header;
+    if (!cursor.read(record_header) || record_header.size_ % 8 != 0 ||
+        !Cursor(copy, record_offset).has(record_header.size_)) {
+      return false;
+    }
+
+    snapshot.records_.emplace_back();
+    Record& record = snapshot.records_.back();
+    record.type_ = record_header.type_;
+    record.used_ = record_header.flags_ & RecordFlags::Used;
+    record.sample_sum_ = 0;
+    if (!cursor.read(record.value_)) {
+      return false;
+    }
+    if (record.type_ == RecordType::Histogram) {
+      record.quantile_values_.resize(header.num_quantiles_);
+      if (!cursor.read(record.sample_sum_)) {
+        return false;
+      }
+      for (double& value : record.quantile_values_) {
+        if (!cursor.read(value)) {
+          return false;
+        }
+      }
+    }
+    if (!cursor.readString(record_header.name_size_, record.name_) ||
+        !cursor.readString(record_header.tag_extracted_name_size_, record.tag_extracted_name_)) {
+      return false;
+    }
+    record.tags_.resize(record_header.num_tags_);
+    for (auto& tag : record.tags_) {
+      TagHeader tag_header;
+      if (!cursor.read(tag_header) || !cursor.readString(tag_header.name_size_, tag.first) ||
+          !cursor.readString(tag_header.value_size_, tag.second)) {
+        return false;
+      }
+    }
+    if (cursor.offset() > record_offset + record_header.size_) {
+      return false;
+    }
+    record_offset += record_header.size_;
+  }
+  return true;
+}
+
+} // namespace SharedMemory
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
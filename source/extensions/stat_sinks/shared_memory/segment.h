@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace SharedMemory {
+
+/**
+ * Layout of the stats segment written by the shared memory stats sink. Everything is laid out in
+ * native byte order and every structure starts on an 8 byte boundary. A reader must check the
+ * magic and the version before interpreting anything else; any change to the layout bumps the
+ * version.
+ *
+ * The segment starts with a SegmentHeader. It is followed by header.num_quantiles_ doubles at
+ * header.quantiles_offset_, which are the quantiles summarized for every histogram, and by
+ * header.num_records_ records starting at header.records_offset_. Each record is a RecordHeader
+ * followed by:
+ *   - the values: a uint64_t for counters and gauges. For histograms, the uint64_t cumulative
+ *     sample count, the double cumulative sample sum and num_quantiles doubles holding the
+ *     cumulative value of each quantile.
+ *   - name_size_ bytes of name and tag_extracted_name_size_ bytes of tag extracted name.
+ *   - num_tags_ tags, each a TagHeader followed by the tag name and the tag value.
+ *   - padding up to size_, which is a multiple of 8.
+ *
+ * The writer wraps every update in a sequence lock: header.sequence_ is odd while an update is in
+ * progress and is bumped once more when it completes. A reader copies the segment, and the copy is
+ * only consistent if sequence_ was even and unchanged across the copy. The writer only rewrites
+ * the record layout when the set of stats changes, which bumps header.layout_generation_; other
+ * updates only change values, the Used record flag and header.update_time_ms_ in place, so a reader
+ * may cache the names of a layout generation and only re-read values.
+ *
+ * The segment grows as stats are added but never shrinks. A reader whose mapping is smaller than
+ * header.segment_size_ must remap the segment. When the writer shuts down it sets the Closed flag,
+ * after which the segment is never updated again.
+ */
+constexpr char SegmentMagic[8] = {'E', 'N', 'V', 'O', 'Y', 'S', 'T', 'S'};
+constexpr uint32_t SegmentVersion = 1;
+
+struct SegmentFlags {
+  static const uint64_t Closed = 0x1;
+};
+
+struct SegmentHeader {
+  char magic_[8];
+  uint32_t version_;
+  uint32_t header_size_;
+  std::atomic<uint64_t> sequence_;
+  uint64_t flags_;
+  uint64_t segment_size_;
+  uint64_t layout_generation_;
+  // Wall clock time of the last flush, in milliseconds since the epoch.
+  uint64_t update_time_ms_;
+  uint64_t quantiles_offset_;
+  uint64_t records_offset_;
+  uint32_t num_quantiles_;
+  uint32_t num_records_;
+};
+
+enum class RecordType : uint8_t { Counter = 1, Gauge = 2, Histogram = 3 };
+
+struct RecordFlags {
+  static const uint8_t Used = 0x1;
+};
+
+struct RecordHeader {
+  uint32_t size_;
+  RecordType type_;
+  uint8_t flags_;
+  uint16_t num_tags_;
+  uint32_t name_size_;
+  uint32_t tag_extracted_name_size_;
+};
+
+struct TagHeader {
+  uint32_t name_size_;
+  uint32_t value_size_;
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the sequence lock must be lock free across processes");
+static_assert(sizeof(SegmentHeader) == 80, "SegmentHeader is part of the segment layout");
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader is part of the segment layout");
+static_assert(sizeof(TagHeader) == 8, "TagHeader is part of the segment layout");
+
+/**
+ * Reference reader for the segment layout above.
+ */
+class SegmentReader {
+public:
+  struct Record {
+    RecordType type_;
+    bool used_;
+    std::string name_;
+    std::string tag_extracted_name_;
+    std::vector<std::pair<std::string, std::string>> tags_;
+    // The value of a counter or gauge, or the sample count of a histogram.
+    uint64_t value_;
+    double sample_sum_;
+    std::vector<double> quantile_values_;
+  };
+
+  struct Snapshot {
+    uint64_t flags_;
+    uint64_t segment_size_;
+    uint64_t layout_generation_;
+    uint64_t update_time_ms_;
+    std::vector<double> quantiles_;
+    std::vector<Record> records_;
+  };
+
+  /**
+   * Read a consistent snapshot of a mapped segment.
+   * @param segment the start of the mapping.
+   * @param mapping_size the size of the mapping.
+   * @param snapshot supplies the snapshot to fill in.
+   * @return bool true if the snapshot was read. False if the segment is not a valid segment of
+   *         this version, if it is larger than the mapping (check snapshot.segment_size_ and remap)
+   *         or if no consistent copy could be made in max_attempts attempts.
+   */
+  static bool read(const void* segment, uint64_t mapping_size, Snapshot& snapshot,
+                   uint32_t max_attempts = 16);
+
+private:
+  static bool parse(const std::vector<uint8_t>& copy, Snapshot& snapshot);
+};
+
+} // namespace SharedMemory
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,301 @@
+#include "extensions/stat_sinks/shared_memory/shared_memory_sink.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace SharedMemory {
+
+namespace {
+
+// The segment is grown in multiples of this, so that a growing set of stats only remaps it
+// occasionally.
+constexpr uint64_t SegmentGrowthBytes = 64 * 1024;
+
+uint64_t valuesSize(RecordType type, uint32_t num_quantiles) {
+  return type == RecordType::Histogram ? 2 * sizeof(uint64_t) + num_quantiles * sizeof(double)
+                                       : sizeof(uint64_t);
+}
+
+uint64_t alignedSize(uint64_t size) { return (size + 7) & ~static_cast<uint64_t>(7); }
+
+} // namespace
+
+SharedMemorySink::SharedMemorySink(const std::string& name, TimeSource& time_source,
+                                   Api::OsSysCalls& os_sys_calls)
+    : name_(name), time_source_(time_source), os_sys_calls_(os_sys_calls) {
+  os_sys_calls_.shmUnlink(name_.c_str());
+  const Api::SysCallIntResult result =
+      os_sys_calls_.shmOpen(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR | S_IRGRP);
+  if (result.rc_ == -1) {
+    throw EnvoyException(fmt::format("cannot create shared memory stats segment {}: {}", name_,
+                                     strerror(result.errno_)));
+  }
+  fd_ = result.rc_;
+  if (!map(SegmentGrowthBytes)) {
+    os_sys_calls_.close(fd_);
+    throw EnvoyException(fmt::format("cannot map shared memory stats segment {}", name_));
+  }
+
+  // The object is zero filled when it is created, so only the non-zero fields need to be set.
+  SegmentHeader& segment_header = header();
+  memcpy(segment_header.magic_, SegmentMagic, sizeof(SegmentMagic));
+  segment_header.version_ = SegmentVersion;
+  segment_header.header_size_ = sizeof(SegmentHeader);
+  segment_header.segment_size_ = sizeof(SegmentHeader);
+  segment_header.quantiles_offset_ = sizeof(SegmentHeader);
+  segment_header.records_offset_ = sizeof(SegmentHeader);
+}
+
+SharedMemorySink::~SharedMemorySink() {
+  beginUpdate();
+  header().flags_ |= SegmentFlags::Closed;
+  endUpdate();
+  os_sys_calls_.munmap(segment_, mapped_size_);
+  os_sys_calls_.close(fd_);
+}
+
+void SharedMemorySink::flush(Stats::Source& source) {
+  const std::vector<Stats::CounterSharedPtr>& counters = source.cachedCounters();
+  const std::vector<Stats::GaugeSharedPtr>& gauges = source.cachedGauges();
+  const std::vector<Stats::ParentHistogramSharedPtr>& histograms = source.cachedHistograms();
+  if (layoutChanged(counters, gauges, histograms)) {
+    counters_ = counters;
+    gauges_ = gauges;
+    histograms_ = histograms;
+    writeLayout();
+  } else {
+    writeValues();
+  }
+}
+
+bool SharedMemorySink::layoutChanged(
+    const std::vector<Stats::CounterSharedPtr>& counters,
+    const std::vector<Stats::GaugeSharedPtr>& gauges,
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms) const {
+  return counters != counters_ || gauges != gauges_ || histograms != histograms_;
+}
+
+void SharedMemorySink::writeLayout() {
+  // All histograms summarize the same quantiles.
+  num_quantiles_ =
+      histograms_.empty() ? 0 : histograms_[0]->cumulativeStatistics().supportedQuantiles().size();
+  const uint64_t quantiles_offset = sizeof(SegmentHeader);
+  const uint64_t records_offset = quantiles_offset + num_quantiles_ * sizeof(double);
+  uint64_t segment_size = records_offset;
+  for (const Stats::CounterSharedPtr& counter : counters_) {
+    segment_size += recordSize(*counter, RecordType::Counter);
+  }
+  for (const Stats::GaugeSharedPtr& gauge : gauges_) {
+    segment_size += recordSize(*gauge, RecordType::Gauge);
+  }
+  for (const Stats::ParentHistogramSharedPtr& histogram : histograms_) {
+    segment_size += recordSize(*histogram, RecordType::Histogram);
+  }
+  if (!reserve(segment_size)) {
+    // Keep the previous layout, and try again on the next flush.
+    counters_.clear();
+    gauges_.clear();
+    histograms_.clear();
+    return;
+  }
+
+  beginUpdate();
+  if (num_quantiles_ > 0) {
+    const std::vector<double>& quantiles =
+        histograms_[0]->cumulativeStatistics().supportedQuantiles();
+    writeBytes(quantiles_offset, quantiles.data(), num_quantiles_ * sizeof(double));
+  }
+  record_offsets_.clear();
+  record_offsets_.reserve(counters_.size() + gauges_.size() + histograms_.size());
+  uint64_t offset = records_offset;
+  for (const Stats::CounterSharedPtr& counter : counters_) {
+    record_offsets_.push_back(offset);
+    offset = writeRecord(offset, *counter, RecordType::Counter);
+    writeValue(record_offsets_.back(), *counter);
+  }
+  for (const Stats::GaugeSharedPtr& gauge : gauges_) {
+    record_offsets_.push_back(offset);
+    offset = writeRecord(offset, *gauge, RecordType::Gauge);
+    writeValue(record_offsets_.back(), *gauge);
+  }
+  for (const Stats::ParentHistogramSharedPtr& histogram : histograms_) {
+    record_offsets_.push_back(offset);
+    offset = writeRecord(offset, *histogram, RecordType::Histogram);
+    writeValue(record_offsets_.back(), *histogram);
+  }
+  ASSERT(offset == segment_size);
+
+  SegmentHeader& segment_header = header();
+  segment_header.segment_size_ = segment_size;
+  segment_header.layout_generation_++;
+  segment_header.quantiles_offset_ = quantiles_offset;
+  segment_header.records_offset_ = records_offset;
+  segment_header.num_quantiles_ = num_quantiles_;
+  segment_header.num_records_ = record_offsets_.size();
+  endUpdate();
+}
+
+void SharedMemorySink::writeValues() {
+  beginUpdate();
+  auto record_offset = record_offsets_.begin();
+  for (const Stats::CounterSharedPtr& counter : counters_) {
+    writeValue(*record_offset++, *counter);
+  }
+  for (const Stats::GaugeSharedPtr& gauge : gauges_) {
+    writeValue(*record_offset++, *gauge);
+  }
+  for (const Stats::ParentHistogramSharedPtr& histogram : histograms_) {
+    writeValue(*record_offset++, *histogram);
+  }
+  endUpdate();
+}
+
+uint64_t SharedMemorySink::recordSize(const Stats::Metric& metric, RecordType type) const {
+  uint64_t size = sizeof(RecordHeader) + valuesSize(type, num_quantiles_) + metric.name().size() +
+                  metric.tagExtractedName().size();
+  for (const Stats::Tag& tag : metric.tags()) {
+    size += sizeof(TagHeader) + tag.name_.size() + tag.value_.size();
+  }
+  return alignedSize(size);
+}
+
+uint64_t SharedMemorySink::writeRecord(uint64_t offset, const Stats::Metric& metric,
+                                       RecordType type) {
+  const std::string name = metric.name();
+  const std::string& tag_extracted_name = metric.tagExtractedName();
+  const std::vector<Stats::Tag>& tags = metric.tags();
+
+  RecordHeader record_header;
+  record_header.size_ = recordSize(metric, type);
+  record_header.type_ = type;
+  record_header.flags_ = 0;
+  record_header.num_tags_ = tags.size();
+  record_header.name_size_ = name.size();
+  record_header.tag_extracted_name_size_ = tag_extracted_name.size();
+  writeBytes(offset, &record_header, sizeof(record_header));
+
+  uint64_t cursor = offset + sizeof(RecordHeader) + valuesSize(type, num_quantiles_);
+  writeBytes(cursor, name.data(), name.size());
+  cursor += name.size();
+  writeBytes(cursor, tag_extracted_name.data(), tag_extracted_name.size());
+  cursor += tag_extracted_name.size();
+  for (const Stats::Tag& tag : tags) {
+    TagHeader tag_header;
+    tag_header.name_size_ = tag.name_.size();
+    tag_header.value_size_ = tag.value_.size();
+    writeBytes(cursor, &tag_header, sizeof(tag_header));
+    cursor += sizeof(tag_header);
+    writeBytes(cursor, tag.name_.data(), tag.name_.size());
+    cursor += tag.name_.size();
+    writeBytes(cursor, tag.value_.data(), tag.value_.size());
+    cursor += tag.value_.size();
+  }
+  return offset + record_header.size_;
+}
+
+void SharedMemorySink::writeValue(uint64_t record_offset, const Stats::Counter& counter) {
+  const uint8_t flags = counter.used() ? RecordFlags::Used : 0;
+  const uint64_t value = counter.value();
+  writeBytes(record_offset + offsetof(RecordHeader, flags_), &flags, sizeof(flags));
+  writeBytes(record_offset + sizeof(RecordHeader), &value, sizeof(value));
+}
+
+void SharedMemorySink::writeValue(uint64_t record_offset, const Stats::Gauge& gauge) {
+  const uint8_t flags = gauge.used() ? RecordFlags::Used : 0;
+  const uint64_t value = gauge.value();
+  writeBytes(record_offset + offsetof(RecordHeader, flags_), &flags, sizeof(flags));
+  writeBytes(record_offset + sizeof(RecordHeader), &value, sizeof(value));
+}
+
+void SharedMemorySink::writeValue(uint64_t record_offset,
+                                  const Stats::ParentHistogram& histogram) {
+  const uint8_t flags = histogram.used() ? RecordFlags::Used : 0;
+  writeBytes(record_offset + offsetof(RecordHeader, flags_), &flags, sizeof(flags));
+
+  const Stats::HistogramStatistics& statistics = histogram.cumulativeStatistics();
+  const uint64_t sample_count = statistics.sampleCount();
+  const double sample_sum = statistics.sampleSum();
+  uint64_t cursor = record_offset + sizeof(RecordHeader);
+  writeBytes(cursor, &sample_count, sizeof(sample_count));
+  cursor += sizeof(sample_count);
+  writeBytes(cursor, &sample_sum, sizeof(sample_sum));
+  cursor += sizeof(sample_sum);
+  const std::vector<double>& computed_quantiles = statistics.computedQuantiles();
+  for (uint32_t i = 0; i < num_quantiles_; ++i) {
+    const double value = i < computed_quantiles.size() ? computed_quantiles[i] : std::nan("");
+    writeBytes(cursor, &value, sizeof(value));
+    cursor += sizeof(value);
+  }
+}
+
+void SharedMemorySink::writeBytes(uint64_t offset, const void* data, uint64_t size) {
+  ASSERT(offset + size <= mapped_size_);
+  memcpy(segment_ + offset, data, size);
+}
+
+bool SharedMemorySink::reserve(uint64_t size) {
+  if (size <= mapped_size_) {
+    return true;
+  }
+  const uint64_t new_size =
+      std::max(2 * mapped_size_, (size / SegmentGrowthBytes + 1) * SegmentGrowthBytes);
+  return map(new_size);
+}
+
+bool SharedMemorySink::map(uint64_t size) {
+  // The object is grown before the old mapping is released, so that the current layout stays
+  // intact if growing fails.
+  const Api::SysCallIntResult truncate_result = os_sys_calls_.ftruncate(fd_, size);
+  if (truncate_result.rc_ == -1) {
+    ENVOY_LOG(warn, "cannot grow shared memory stats segment {} to {} bytes: {}", name_, size,
+              strerror(truncate_result.errno_));
+    return false;
+  }
+  const Api::SysCallPtrResult mmap_result =
+      os_sys_calls_.mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (mmap_result.rc_ == MAP_FAILED) {
+    ENVOY_LOG(warn, "cannot map shared memory stats segment {}: {}", name_,
+              strerror(mmap_result.errno_));
+    return false;
+  }
+  if (segment_ != nullptr) {
+    os_sys_calls_.munmap(segment_, mapped_size_);
+  }
+  segment_ = static_cast<uint8_t*>(mmap_result.rc_);
+  mapped_size_ = size;
+  return true;
+}
+
+void SharedMemorySink::beginUpdate() {
+  std::atomic<uint64_t>& sequence = header().sequence_;
+  sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  // Order the odd sequence before the writes that follow, so readers see the update in progress.
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SharedMemorySink::endUpdate() {
+  header().update_time_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 time_source_.systemTime().time_since_epoch())
+                                 .count();
+  std::atomic<uint64_t>& sequence = header().sequence_;
+  sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+} // namespace SharedMemory
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/common/time.h"
+#include "envoy/stats/histogram.h"
+#include "envoy/stats/sink.h"
+#include "envoy/stats/source.h"
+#include "envoy/stats/stats.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/stat_sinks/shared_memory/segment.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace SharedMemory {
+
+/**
+ * Stats sink that exports all stats through a POSIX shared memory segment, laid out as described
+ * in segment.h. The record layout is only rewritten when the set of stats changes; other flushes
+ * only write values in place.
+ */
+class SharedMemorySink : public Stats::Sink, Logger::Loggable<Logger::Id::stats> {
+public:
+  /**
+   * @param name supplies the name of the shared memory object. Any existing object with this name
+   *        is replaced.
+   * @throw EnvoyException if the object cannot be created.
+   */
+  SharedMemorySink(const std::string& name, TimeSource& time_source,
+                   Api::OsSysCalls& os_sys_calls);
+  ~SharedMemorySink();
+
+  // Stats::Sink
+  void flush(Stats::Source& source) override;
+  void onHistogramComplete(const Stats::Histogram&, uint64_t) override {}
+
+  uint64_t segmentSize() const { return mapped_size_; }
+
+private:
+  bool layoutChanged(const std::vector<Stats::CounterSharedPtr>& counters,
+                     const std::vector<Stats::GaugeSharedPtr>& gauges,
+                     const std::vector<Stats::ParentHistogramSharedPtr>& histograms) const;
+  void writeLayout();
+  void writeValues();
+  uint64_t recordSize(const Stats::Metric& metric, RecordType type) const;
+  uint64_t writeRecord(uint64_t offset, const Stats::Metric& metric, RecordType type);
+  void writeValue(uint64_t record_offset, const Stats::Counter& counter);
+  void writeValue(uint64_t record_offset, const Stats::Gauge& gauge);
+  void writeValue(uint64_t record_offset, const Stats::ParentHistogram& histogram);
+  void writeBytes(uint64_t offset, const void* data, uint64_t size);
+  bool reserve(uint64_t size);
+  bool map(uint64_t size);
+  void beginUpdate();
+  void endUpdate();
+  SegmentHeader& header() { return *reinterpret_cast<SegmentHeader*>(segment_); }
+
+  const std::string name_;
+  TimeSource& time_source_;
+  Api::OsSysCalls& os_sys_calls_;
+  int fd_;
+  uint8_t* segment_{};
+  uint64_t mapped_size_{};
+  // The stats in the current layout, which are held so that a changed set of stats is detected
+  // even if a removed stat's memory is reused.
+  std::vector<Stats::CounterSharedPtr> counters_;
+  std::vector<Stats::GaugeSharedPtr> gauges_;
+  std::vector<Stats::ParentHistogramSharedPtr> histograms_;
+  // Offset of the record of each stat in the current layout, in the order of counters_, gauges_
+  // and histograms_.
+  std::vector<uint64_t> record_offsets_;
+  uint32_t num_quantiles_{};
+};
+
+} // namespace SharedMemory
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
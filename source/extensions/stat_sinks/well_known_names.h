@@ -22,6 +22,8 @@ public:
   const std::string MetricsService = "envoy.metrics_service";
   // Hystrix sink
   const std::string Hystrix = "envoy.stat_sinks.hystrix";
+  // Shared memory sink
+  const std::string SharedMemory = "envoy.stat_sinks.shared_memory";
 };
 
 typedef ConstSingleton<StatsSinkNameValues> StatsSinkNames;
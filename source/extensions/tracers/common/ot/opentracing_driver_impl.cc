@@ -92,8 +92,9 @@ void OpenTracingSpan::setOperation(const std::string& operation) {
   span_->SetOperationName(operation);
 }
 
-void OpenTracingSpan::setTag(const std::string& name, const std::string& value) {
-  span_->SetTag(name, value);
+void OpenTracingSpan::setTag(absl::string_view name, absl::string_view value) {
+  // The value is copied, as tracers may keep it after the call.
+  span_->SetTag(opentracing::string_view{name.data(), name.size()}, std::string(value));
 }
 
 void OpenTracingSpan::log(SystemTime timestamp, const std::string& event) {
@@ -34,7 +34,7 @@ public:
   // Tracing::Span
   void finishSpan() override;
   void setOperation(const std::string& operation) override;
-  void setTag(const std::string& name, const std::string& value) override;
+  void setTag(absl::string_view name, absl::string_view value) override;
   void log(SystemTime timestamp, const std::string& event) override;
   void injectContext(Http::HeaderMap& request_headers) override;
   Tracing::SpanPtr spawnChild(const Tracing::Config& config, const std::string& name,
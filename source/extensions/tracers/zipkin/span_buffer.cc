@@ -1,12 +1,13 @@
 #include "extensions/tracers/zipkin/span_buffer.h"
 
+#include "extensions/tracers/zipkin/util.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Tracers {
 namespace Zipkin {
 
-// TODO(fabolive): Need to avoid the copy to improve performance.
-bool SpanBuffer::addSpan(const Span& span) {
+bool SpanBuffer::addSpan(Span&& span) {
   if (span_buffer_.size() == span_buffer_.capacity()) {
     // Buffer full
     return false;
@@ -32,6 +33,16 @@ std::string SpanBuffer::toStringifiedJsonArray() {
   return stringified_json_array;
 }
 
+std::string SpanBuffer::toProtoListOfSpans() {
+  // The spans are the repeated field 1 of ListOfSpans.
+  std::string list_of_spans;
+  for (const Span& span : span_buffer_) {
+    Util::addProtoBytes(list_of_spans, 1, span.toProto());
+  }
+
+  return list_of_spans;
+}
+
 } // namespace Zipkin
 } // namespace Tracers
 } // namespace Extensions
@@ -34,17 +34,18 @@ public:
   void allocateBuffer(uint64_t size) { span_buffer_.reserve(size); }
 
   /**
-   * Adds the given Zipkin span to the buffer.
+   * Moves the given Zipkin span to the buffer.
    *
    * @param span The span to be added to the buffer.
    *
    * @return true if the span was successfully added, or false if the buffer was full.
    */
-  bool addSpan(const Span& span);
+  bool addSpan(Span&& span);
 
   /**
    * Empties the buffer. This method is supposed to be called when all buffered spans
-   * have been sent to to the Zipkin service.
+   * have been sent to to the Zipkin service. The space allocated for the spans is kept for the
+   * spans added afterwards.
    */
   void clear() { span_buffer_.clear(); }
 
@@ -59,6 +60,11 @@ public:
    */
   std::string toStringifiedJsonArray();
 
+  /**
+   * @return the contents of the buffer as a serialized Zipkin v2 protobuf ListOfSpans message.
+   */
+  std::string toProtoListOfSpans();
+
 private:
   // We use a pre-allocated vector to improve performance
   std::vector<Span> span_buffer_;
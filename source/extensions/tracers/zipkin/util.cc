@@ -47,6 +47,48 @@ void Util::addArrayToJson(std::string& target, const std::vector<std::string>& j
   mergeJsons(target, stringified_json_array, field_name);
 }
 
+namespace {
+
+enum WireType : uint32_t { Varint = 0, Fixed64 = 1, LengthDelimited = 2 };
+
+void appendVarint(std::string& target, uint64_t value) {
+  while (value >= 0x80) {
+    target.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  target.push_back(static_cast<char>(value));
+}
+
+void appendTag(std::string& target, uint32_t field_number, WireType wire_type) {
+  appendVarint(target, (static_cast<uint64_t>(field_number) << 3) | wire_type);
+}
+
+} // namespace
+
+void Util::addProtoBytes(std::string& target, uint32_t field_number, absl::string_view value) {
+  appendTag(target, field_number, LengthDelimited);
+  appendVarint(target, value.size());
+  target.append(value.data(), value.size());
+}
+
+void Util::addProtoVarint(std::string& target, uint32_t field_number, uint64_t value) {
+  appendTag(target, field_number, Varint);
+  appendVarint(target, value);
+}
+
+void Util::addProtoFixed64(std::string& target, uint32_t field_number, uint64_t value) {
+  appendTag(target, field_number, Fixed64);
+  for (int i = 0; i < 8; i++) {
+    target.push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+void Util::appendBigEndian(std::string& target, uint64_t value) {
+  for (int i = 7; i >= 0; i--) {
+    target.push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
 uint64_t Util::generateRandom64(TimeSource& time_source) {
   uint64_t seed = std::chrono::duration_cast<std::chrono::nanoseconds>(
                       time_source.systemTime().time_since_epoch())
@@ -5,6 +5,8 @@
 
 #include "envoy/common/time.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Tracers {
@@ -40,6 +42,46 @@ public:
   static void addArrayToJson(std::string& target, const std::vector<std::string>& json_array,
                              const std::string& field_name);
 
+  // ====
+  // Protobuf wire format
+  // ====
+
+  /**
+   * Appends a length-delimited field (a string, bytes or an embedded message) to a serialized
+   * protobuf message.
+   *
+   * @param target It will contain the resulting serialized message.
+   * @param field_number The number of the field.
+   * @param value The value of the field, e.g. a serialized embedded message.
+   */
+  static void addProtoBytes(std::string& target, uint32_t field_number, absl::string_view value);
+
+  /**
+   * Appends a varint field (e.g. a uint64, a bool or an enum) to a serialized protobuf message.
+   *
+   * @param target It will contain the resulting serialized message.
+   * @param field_number The number of the field.
+   * @param value The value of the field.
+   */
+  static void addProtoVarint(std::string& target, uint32_t field_number, uint64_t value);
+
+  /**
+   * Appends a fixed64 field to a serialized protobuf message.
+   *
+   * @param target It will contain the resulting serialized message.
+   * @param field_number The number of the field.
+   * @param value The value of the field.
+   */
+  static void addProtoFixed64(std::string& target, uint32_t field_number, uint64_t value);
+
+  /**
+   * Appends the 8 bytes of an integer to a string, in network byte order, as Zipkin encodes ids.
+   *
+   * @param target It will contain the resulting bytes.
+   * @param value The integer to append.
+   */
+  static void appendBigEndian(std::string& target, uint64_t value);
+
   // ====
   // Miscellaneous
   // ====
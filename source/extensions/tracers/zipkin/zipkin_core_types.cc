@@ -14,6 +14,41 @@ namespace Envoy {
 namespace Extensions {
 namespace Tracers {
 namespace Zipkin {
+namespace {
+
+// Field numbers of the Zipkin v2 protobuf messages.
+// @see https://github.com/openzipkin/zipkin-api/blob/master/zipkin.proto
+enum EndpointField : uint32_t {
+  EndpointServiceName = 1,
+  EndpointIpv4 = 2,
+  EndpointIpv6 = 3,
+  EndpointPort = 4,
+};
+enum AnnotationField : uint32_t { AnnotationTimestamp = 1, AnnotationValue = 2 };
+enum TagField : uint32_t { TagKey = 1, TagValue = 2 };
+enum SpanField : uint32_t {
+  SpanTraceId = 1,
+  SpanParentId = 2,
+  SpanId = 3,
+  SpanKind = 4,
+  SpanName = 5,
+  SpanTimestamp = 6,
+  SpanDuration = 7,
+  SpanLocalEndpoint = 8,
+  SpanAnnotations = 10,
+  SpanTags = 11,
+  SpanDebug = 12,
+  SpanShared = 13,
+};
+enum SpanKindValue : uint64_t { SpanKindClient = 1, SpanKindServer = 2 };
+
+std::string bigEndianId(uint64_t id) {
+  std::string bytes;
+  Util::appendBigEndian(bytes, id);
+  return bytes;
+}
+
+} // namespace
 
 Endpoint::Endpoint(const Endpoint& ep) {
   service_name_ = ep.serviceName();
@@ -55,6 +90,28 @@ const std::string Endpoint::toJson() {
   return json_string;
 }
 
+const std::string Endpoint::toProto() const {
+  std::string proto;
+  if (!service_name_.empty()) {
+    Util::addProtoBytes(proto, EndpointServiceName, service_name_);
+  }
+  if (address_ && address_->ip()) {
+    if (address_->ip()->version() == Network::Address::IpVersion::v4) {
+      const uint32_t ipv4 = address_->ip()->ipv4()->address();
+      Util::addProtoBytes(proto, EndpointIpv4,
+                          absl::string_view(reinterpret_cast<const char*>(&ipv4), sizeof(ipv4)));
+    } else {
+      const absl::uint128 ipv6 = address_->ip()->ipv6()->address();
+      Util::addProtoBytes(proto, EndpointIpv6,
+                          absl::string_view(reinterpret_cast<const char*>(&ipv6), sizeof(ipv6)));
+    }
+    if (address_->ip()->port() != 0) {
+      Util::addProtoVarint(proto, EndpointPort, address_->ip()->port());
+    }
+  }
+  return proto;
+}
+
 Annotation::Annotation(const Annotation& ann) {
   timestamp_ = ann.timestamp();
   value_ = ann.value();
@@ -219,6 +276,89 @@ const std::string Span::toJson() {
   return json_string;
 }
 
+const std::string Span::toProto() const {
+  std::string proto;
+  std::string trace_id;
+  if (trace_id_high_) {
+    Util::appendBigEndian(trace_id, trace_id_high_.value());
+  }
+  Util::appendBigEndian(trace_id, trace_id_);
+  Util::addProtoBytes(proto, SpanTraceId, trace_id);
+  if (parent_id_ && parent_id_.value()) {
+    Util::addProtoBytes(proto, SpanParentId, bigEndianId(parent_id_.value()));
+  }
+  Util::addProtoBytes(proto, SpanId, bigEndianId(id_));
+
+  // The core annotations of a v1 span give the kind and the timing of the v2 span, and the other
+  // annotations are kept as they are.
+  const Annotation* start = nullptr;
+  const Annotation* stop = nullptr;
+  uint64_t kind = 0;
+  std::vector<const Annotation*> other_annotations;
+  for (const Annotation& annotation : annotations_) {
+    const std::string& value = annotation.value();
+    if (value == ZipkinCoreConstants::get().CLIENT_SEND) {
+      start = &annotation;
+      kind = SpanKindClient;
+    } else if (value == ZipkinCoreConstants::get().SERVER_RECV) {
+      start = &annotation;
+      kind = SpanKindServer;
+    } else if (value == ZipkinCoreConstants::get().CLIENT_RECV ||
+               value == ZipkinCoreConstants::get().SERVER_SEND) {
+      stop = &annotation;
+    } else {
+      other_annotations.push_back(&annotation);
+    }
+  }
+
+  if (kind != 0) {
+    Util::addProtoVarint(proto, SpanKind, kind);
+  }
+  if (!name_.empty()) {
+    Util::addProtoBytes(proto, SpanName, name_);
+  }
+  if (timestamp_) {
+    Util::addProtoFixed64(proto, SpanTimestamp, timestamp_.value());
+  } else if (start != nullptr) {
+    Util::addProtoFixed64(proto, SpanTimestamp, start->timestamp());
+  }
+  if (duration_) {
+    Util::addProtoVarint(proto, SpanDuration, duration_.value());
+  } else if (start != nullptr && stop != nullptr && stop->timestamp() > start->timestamp()) {
+    Util::addProtoVarint(proto, SpanDuration, stop->timestamp() - start->timestamp());
+  }
+  if (start != nullptr && start->isSetEndpoint()) {
+    Util::addProtoBytes(proto, SpanLocalEndpoint, start->endpoint().toProto());
+  }
+
+  for (const Annotation* annotation : other_annotations) {
+    std::string annotation_proto;
+    Util::addProtoFixed64(annotation_proto, AnnotationTimestamp, annotation->timestamp());
+    Util::addProtoBytes(annotation_proto, AnnotationValue, annotation->value());
+    Util::addProtoBytes(proto, SpanAnnotations, annotation_proto);
+  }
+
+  for (const BinaryAnnotation& binary_annotation : binary_annotations_) {
+    if (binary_annotation.annotationType() == STRING) {
+      // Each entry of the tags map is encoded as a message with a key and a value.
+      std::string tag_proto;
+      Util::addProtoBytes(tag_proto, TagKey, binary_annotation.key());
+      Util::addProtoBytes(tag_proto, TagValue, binary_annotation.value());
+      Util::addProtoBytes(proto, SpanTags, tag_proto);
+    }
+  }
+
+  if (debug_) {
+    Util::addProtoVarint(proto, SpanDebug, 1);
+  }
+  // A server span without a timestamp shares its id with the client span of the caller.
+  if (kind == SpanKindServer && !timestamp_) {
+    Util::addProtoVarint(proto, SpanShared, 1);
+  }
+
+  return proto;
+}
+
 void Span::finish() {
   // Assumption: Span will have only one annotation when this method is called
   SpanContext context(*this);
@@ -252,9 +392,9 @@ void Span::finish() {
   }
 }
 
-void Span::setTag(const std::string& name, const std::string& value) {
+void Span::setTag(absl::string_view name, absl::string_view value) {
   if (name.size() > 0 && value.size() > 0) {
-    addBinaryAnnotation(BinaryAnnotation(name, value));
+    addBinaryAnnotation(BinaryAnnotation(std::string(name), std::string(value)));
   }
 }
 
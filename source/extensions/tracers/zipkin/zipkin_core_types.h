@@ -11,6 +11,7 @@
 #include "extensions/tracers/zipkin/tracer_interface.h"
 #include "extensions/tracers/zipkin/util.h"
 
+#include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
@@ -93,6 +94,13 @@ public:
    */
   const std::string toJson() override;
 
+  /**
+   * Serializes the endpoint as a Zipkin v2 protobuf Endpoint message.
+   *
+   * @return the serialized message.
+   */
+  const std::string toProto() const;
+
 private:
   std::string service_name_;
   Network::Address::InstanceConstSharedPtr address_;
@@ -302,6 +310,11 @@ public:
    */
   Span(const Span&);
 
+  /**
+   * Move constructor. Finished spans are moved to their reporter rather than copied.
+   */
+  Span(Span&&) = default;
+
   /**
    * Default constructor. Creates an empty span.
    */
@@ -517,6 +530,15 @@ public:
    */
   const std::string toJson() override;
 
+  /**
+   * Serializes the span as a Zipkin v2 protobuf Span message, which can be sent to Zipkin as part
+   * of a ListOfSpans message. The v2 span kind, timestamp and duration are derived from the "cs",
+   * "sr", "ss" and "cr" annotations, and the string binary annotations become tags.
+   *
+   * @return the serialized message.
+   */
+  const std::string toProto() const;
+
   /**
    * Associates a Tracer object with the span. The tracer's reportSpan() method is invoked
    * by the span's finish() method so that the tracer can decide what to do with the span
@@ -547,7 +569,7 @@ public:
    * @param name The binary annotation's key.
    * @param value The binary annotation's value.
    */
-  void setTag(const std::string& name, const std::string& value);
+  void setTag(absl::string_view name, absl::string_view value);
 
   /**
    * Adds an annotation to the span
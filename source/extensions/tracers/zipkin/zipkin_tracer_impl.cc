@@ -3,6 +3,7 @@
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
 #include "common/common/utility.h"
+#include "common/compressor/zlib_compressor_impl.h"
 #include "common/config/utility.h"
 #include "common/http/headers.h"
 #include "common/http/message_impl.h"
@@ -17,6 +18,13 @@ namespace Envoy {
 namespace Extensions {
 namespace Tracers {
 namespace Zipkin {
+namespace {
+
+// zlib window bits for a gzip stream with the largest history buffer.
+constexpr int64_t GzipWindowBits = 15 | 16;
+constexpr uint64_t GzipMemoryLevel = 8;
+
+} // namespace
 
 ZipkinSpan::ZipkinSpan(Zipkin::Span& span, Zipkin::Tracer& tracer) : span_(span), tracer_(tracer) {}
 
@@ -24,7 +32,7 @@ void ZipkinSpan::finishSpan() { span_.finish(); }
 
 void ZipkinSpan::setOperation(const std::string& operation) { span_.setName(operation); }
 
-void ZipkinSpan::setTag(const std::string& name, const std::string& value) {
+void ZipkinSpan::setTag(absl::string_view name, absl::string_view value) {
   span_.setTag(name, value);
 }
 
@@ -74,22 +82,24 @@ Driver::Driver(const envoy::config::trace::v2::ZipkinConfig& zipkin_config,
   Config::Utility::checkCluster(TracerNames::get().Zipkin, zipkin_config.collector_cluster(), cm_);
   cluster_ = cm_.get(zipkin_config.collector_cluster())->info();
 
-  std::string collector_endpoint = ZipkinCoreConstants::get().DEFAULT_COLLECTOR_ENDPOINT;
+  CollectorInfo collector;
   if (zipkin_config.collector_endpoint().size() > 0) {
-    collector_endpoint = zipkin_config.collector_endpoint();
+    collector.endpoint_ = zipkin_config.collector_endpoint();
   }
+  collector.version_ = zipkin_config.collector_endpoint_version();
+  collector.compress_spans_ = zipkin_config.compress_spans();
 
   const bool trace_id_128bit = zipkin_config.trace_id_128bit();
 
   const bool shared_span_context = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
       zipkin_config, shared_span_context, ZipkinCoreConstants::get().DEFAULT_SHARED_SPAN_CONTEXT);
 
-  tls_->set([this, collector_endpoint, &random_generator, trace_id_128bit, shared_span_context](
+  tls_->set([this, collector, &random_generator, trace_id_128bit, shared_span_context](
                 Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     TracerPtr tracer(new Tracer(local_info_.clusterName(), local_info_.address(), random_generator,
                                 trace_id_128bit, shared_span_context, time_source_));
     tracer->setReporter(
-        ReporterImpl::NewInstance(std::ref(*this), std::ref(dispatcher), collector_endpoint));
+        ReporterImpl::NewInstance(std::ref(*this), std::ref(dispatcher), collector));
     return ThreadLocal::ThreadLocalObjectSharedPtr{new TlsTracer(std::move(tracer), *this)};
   });
 }
@@ -122,8 +132,8 @@ Tracing::SpanPtr Driver::startSpan(const Tracing::Config& config, Http::HeaderMa
 }
 
 ReporterImpl::ReporterImpl(Driver& driver, Event::Dispatcher& dispatcher,
-                           const std::string& collector_endpoint)
-    : driver_(driver), collector_endpoint_(collector_endpoint) {
+                           const CollectorInfo& collector)
+    : driver_(driver), collector_(collector) {
   flush_timer_ = dispatcher.createTimer([this]() -> void {
     driver_.tracerStats().timer_flushed_.inc();
     flushSpans();
@@ -138,13 +148,12 @@ ReporterImpl::ReporterImpl(Driver& driver, Event::Dispatcher& dispatcher,
 }
 
 ReporterPtr ReporterImpl::NewInstance(Driver& driver, Event::Dispatcher& dispatcher,
-                                      const std::string& collector_endpoint) {
-  return ReporterPtr(new ReporterImpl(driver, dispatcher, collector_endpoint));
+                                      const CollectorInfo& collector) {
+  return ReporterPtr(new ReporterImpl(driver, dispatcher, collector));
 }
 
-// TODO(fabolive): Need to avoid the copy to improve performance.
-void ReporterImpl::reportSpan(const Span& span) {
-  span_buffer_.addSpan(span);
+void ReporterImpl::reportSpan(Span&& span) {
+  span_buffer_.addSpan(std::move(span));
 
   const uint64_t min_flush_spans =
       driver_.runtime().snapshot().getInteger("tracing.zipkin.min_flush_spans", 5U);
@@ -164,16 +173,31 @@ void ReporterImpl::flushSpans() {
   if (span_buffer_.pendingSpans()) {
     driver_.tracerStats().spans_sent_.add(span_buffer_.pendingSpans());
 
-    const std::string request_body = span_buffer_.toStringifiedJsonArray();
     Http::MessagePtr message(new Http::RequestMessageImpl());
     message->headers().insertMethod().value().setReference(Http::Headers::get().MethodValues.Post);
-    message->headers().insertPath().value(collector_endpoint_);
+    message->headers().insertPath().value(collector_.endpoint_);
     message->headers().insertHost().value(driver_.cluster()->name());
-    message->headers().insertContentType().value().setReference(
-        Http::Headers::get().ContentTypeValues.Json);
 
     Buffer::InstancePtr body(new Buffer::OwnedImpl());
-    body->add(request_body);
+    if (collector_.version_ == envoy::config::trace::v2::ZipkinConfig::HTTP_PROTO) {
+      message->headers().insertContentType().value().setReference(
+          Http::Headers::get().ContentTypeValues.Protobuf);
+      body->add(span_buffer_.toProtoListOfSpans());
+    } else {
+      message->headers().insertContentType().value().setReference(
+          Http::Headers::get().ContentTypeValues.Json);
+      body->add(span_buffer_.toStringifiedJsonArray());
+    }
+
+    if (collector_.compress_spans_) {
+      Compressor::ZlibCompressorImpl compressor;
+      compressor.init(Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+                      Compressor::ZlibCompressorImpl::CompressionStrategy::Standard,
+                      GzipWindowBits, GzipMemoryLevel);
+      compressor.compress(*body, Compressor::State::Finish);
+      message->headers().insertContentEncoding().value().setReference(
+          Http::Headers::get().ContentEncodingValues.Gzip);
+    }
     message->body() = std::move(body);
 
     const uint64_t timeout =
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "envoy/config/trace/v2/trace.pb.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/thread_local/thread_local.h"
@@ -11,6 +12,7 @@
 
 #include "extensions/tracers/zipkin/span_buffer.h"
 #include "extensions/tracers/zipkin/tracer.h"
+#include "extensions/tracers/zipkin/zipkin_core_constants.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -28,6 +30,21 @@ struct ZipkinTracerStats {
   ZIPKIN_TRACER_STATS(GENERATE_COUNTER_STRUCT)
 };
 
+/**
+ * Information about the Zipkin collector the spans are sent to.
+ */
+struct CollectorInfo {
+  // The path of the collector endpoint on the collector cluster.
+  std::string endpoint_{ZipkinCoreConstants::get().DEFAULT_COLLECTOR_ENDPOINT};
+
+  // The version of the collector endpoint, which determines the encoding of the spans.
+  envoy::config::trace::v2::ZipkinConfig::CollectorEndpointVersion version_{
+      envoy::config::trace::v2::ZipkinConfig::HTTP_JSON_V1};
+
+  // Whether the batches of spans are compressed with gzip.
+  bool compress_spans_{};
+};
+
 /**
  * Class for Zipkin spans, wrapping a Zipkin::Span object.
  */
@@ -60,7 +77,7 @@ public:
    * Note that Tracing::HttpTracerUtility::finalizeSpan() makes several calls to this function,
    * associating several key-value pairs with this span.
    */
-  void setTag(const std::string& name, const std::string& value) override;
+  void setTag(absl::string_view name, absl::string_view value) override;
 
   void log(SystemTime timestamp, const std::string& event) override;
 
@@ -140,7 +157,9 @@ private:
 /**
  * This class derives from the abstract Zipkin::Reporter.
  * It buffers spans and relies on Http::AsyncClient to send spans to
- * Zipkin using JSON over HTTP.
+ * Zipkin over HTTP, either as v1 JSON or as a v2 protobuf message, optionally compressed with
+ * gzip. The buffered spans are moved rather than copied, and the space of the buffer is kept
+ * across flushes.
  *
  * Two runtime parameters control the span buffering/flushing behavior, namely:
  * tracing.zipkin.min_flush_spans and tracing.zipkin.flush_interval_ms.
@@ -158,12 +177,10 @@ public:
    *
    * @param driver ZipkinDriver to be associated with the reporter.
    * @param dispatcher Controls the timer used to flush buffered spans.
-   * @param collector_endpoint String representing the Zipkin endpoint to be used
-   * when making HTTP POST requests carrying spans. This value comes from the
-   * Zipkin-related tracing configuration.
+   * @param collector Information about the Zipkin collector to be used when making HTTP POST
+   * requests carrying spans. This value comes from the Zipkin-related tracing configuration.
    */
-  ReporterImpl(Driver& driver, Event::Dispatcher& dispatcher,
-               const std::string& collector_endpoint);
+  ReporterImpl(Driver& driver, Event::Dispatcher& dispatcher, const CollectorInfo& collector);
 
   /**
    * Implementation of Zipkin::Reporter::reportSpan().
@@ -172,7 +189,7 @@ public:
    *
    * @param span The span to be buffered.
    */
-  void reportSpan(const Span& span) override;
+  void reportSpan(Span&& span) override;
 
   // Http::AsyncClient::Callbacks.
   // The callbacks below record Zipkin-span-related stats.
@@ -184,14 +201,13 @@ public:
    *
    * @param driver ZipkinDriver to be associated with the reporter.
    * @param dispatcher Controls the timer used to flush buffered spans.
-   * @param collector_endpoint String representing the Zipkin endpoint to be used
-   * when making HTTP POST requests carrying spans. This value comes from the
-   * Zipkin-related tracing configuration.
+   * @param collector Information about the Zipkin collector to be used when making HTTP POST
+   * requests carrying spans. This value comes from the Zipkin-related tracing configuration.
    *
    * @return Pointer to the newly-created ZipkinReporter.
    */
   static ReporterPtr NewInstance(Driver& driver, Event::Dispatcher& dispatcher,
-                                 const std::string& collector_endpoint);
+                                 const CollectorInfo& collector);
 
 private:
   /**
@@ -207,7 +223,7 @@ private:
   Driver& driver_;
   Event::TimerPtr flush_timer_;
   SpanBuffer span_buffer_;
-  const std::string collector_endpoint_;
+  const CollectorInfo collector_;
 };
 } // namespace Zipkin
 } // namespace Tracers
@@ -23,9 +23,10 @@ public:
   Network::Connection& connection() override { return parent_.connection(); }
   bool shouldDrainReadBuffer() override { return false; }
   /*
-   * No-op for these two methods to hold back the callbacks.
+   * No-op for these three methods to hold back the callbacks.
    */
   void setReadBufferReady() override {}
+  void flushWriteBuffer() override {}
   void raiseEvent(Network::ConnectionEvent) override {}
 
 private:
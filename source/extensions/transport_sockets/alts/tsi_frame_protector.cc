@@ -1,6 +1,7 @@
 #include "extensions/transport_sockets/alts/tsi_frame_protector.h"
 
 #include "common/common/assert.h"
+#include "common/common/stack_array.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -16,33 +17,50 @@ TsiFrameProtector::TsiFrameProtector(CFrameProtectorPtr&& frame_protector)
 tsi_result TsiFrameProtector::protect(Buffer::Instance& input, Buffer::Instance& output) {
   ASSERT(frame_protector_);
 
-  unsigned char protected_buffer[BUFFER_SIZE];
-  while (input.length() > 0) {
-    auto* message_bytes = reinterpret_cast<unsigned char*>(input.linearize(input.length()));
-    size_t protected_buffer_size = BUFFER_SIZE;
-    size_t processed_message_size = input.length();
-    tsi_result result =
-        tsi_frame_protector_protect(frame_protector_.get(), message_bytes, &processed_message_size,
-                                    protected_buffer, &protected_buffer_size);
-    if (result != TSI_OK) {
-      ASSERT(result != TSI_INVALID_ARGUMENT && result != TSI_UNIMPLEMENTED);
-      return result;
+  // The slices of the input are protected where they are, and the frames are written straight to
+  // space reserved in the output, so that the data isn't copied in and out of scratch buffers.
+  const uint64_t num_slices = input.getRawSlices(nullptr, 0);
+  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
+  input.getRawSlices(slices.begin(), num_slices);
+  uint64_t processed = 0;
+  for (const Buffer::RawSlice& slice : slices) {
+    const auto* message_bytes = static_cast<const unsigned char*>(slice.mem_);
+    size_t remaining = slice.len_;
+    while (remaining > 0) {
+      Buffer::RawSlice protected_slice;
+      output.reserve(BUFFER_SIZE, &protected_slice, 1);
+      size_t protected_buffer_size = protected_slice.len_;
+      size_t processed_message_size = remaining;
+      tsi_result result = tsi_frame_protector_protect(
+          frame_protector_.get(), message_bytes, &processed_message_size,
+          static_cast<unsigned char*>(protected_slice.mem_), &protected_buffer_size);
+      if (result != TSI_OK) {
+        ASSERT(result != TSI_INVALID_ARGUMENT && result != TSI_UNIMPLEMENTED);
+        input.drain(processed);
+        return result;
+      }
+      commit(output, protected_slice, protected_buffer_size);
+      message_bytes += processed_message_size;
+      remaining -= processed_message_size;
+      processed += processed_message_size;
     }
-    output.add(protected_buffer, protected_buffer_size);
-    input.drain(processed_message_size);
   }
+  input.drain(processed);
 
-  // TSI may buffer some of the input internally. Flush its buffer to protected_buffer.
+  // TSI may buffer some of the input internally. Flush its buffer to the output.
   size_t still_pending_size;
   do {
-    size_t protected_buffer_size = BUFFER_SIZE;
+    Buffer::RawSlice protected_slice;
+    output.reserve(BUFFER_SIZE, &protected_slice, 1);
+    size_t protected_buffer_size = protected_slice.len_;
     tsi_result result = tsi_frame_protector_protect_flush(
-        frame_protector_.get(), protected_buffer, &protected_buffer_size, &still_pending_size);
+        frame_protector_.get(), static_cast<unsigned char*>(protected_slice.mem_),
+        &protected_buffer_size, &still_pending_size);
     if (result != TSI_OK) {
       ASSERT(result != TSI_INVALID_ARGUMENT && result != TSI_UNIMPLEMENTED);
       return result;
     }
-    output.add(protected_buffer, protected_buffer_size);
+    commit(output, protected_slice, protected_buffer_size);
   } while (still_pending_size > 0);
 
   return TSI_OK;
@@ -51,26 +69,46 @@ tsi_result TsiFrameProtector::protect(Buffer::Instance& input, Buffer::Instance&
 tsi_result TsiFrameProtector::unprotect(Buffer::Instance& input, Buffer::Instance& output) {
   ASSERT(frame_protector_);
 
-  unsigned char unprotected_buffer[BUFFER_SIZE];
-
-  while (input.length() > 0) {
-    auto* message_bytes = reinterpret_cast<unsigned char*>(input.linearize(input.length()));
-    size_t unprotected_buffer_size = BUFFER_SIZE;
-    size_t processed_message_size = input.length();
-    tsi_result result = tsi_frame_protector_unprotect(frame_protector_.get(), message_bytes,
-                                                      &processed_message_size, unprotected_buffer,
-                                                      &unprotected_buffer_size);
-    if (result != TSI_OK) {
-      ASSERT(result != TSI_INVALID_ARGUMENT && result != TSI_UNIMPLEMENTED);
-      return result;
+  // As in protect(), the frames are unprotected from the input slices into the output.
+  const uint64_t num_slices = input.getRawSlices(nullptr, 0);
+  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
+  input.getRawSlices(slices.begin(), num_slices);
+  uint64_t processed = 0;
+  for (const Buffer::RawSlice& slice : slices) {
+    const auto* message_bytes = static_cast<const unsigned char*>(slice.mem_);
+    size_t remaining = slice.len_;
+    while (remaining > 0) {
+      Buffer::RawSlice unprotected_slice;
+      output.reserve(BUFFER_SIZE, &unprotected_slice, 1);
+      size_t unprotected_buffer_size = unprotected_slice.len_;
+      size_t processed_message_size = remaining;
+      tsi_result result = tsi_frame_protector_unprotect(
+          frame_protector_.get(), message_bytes, &processed_message_size,
+          static_cast<unsigned char*>(unprotected_slice.mem_), &unprotected_buffer_size);
+      if (result != TSI_OK) {
+        ASSERT(result != TSI_INVALID_ARGUMENT && result != TSI_UNIMPLEMENTED);
+        input.drain(processed);
+        return result;
+      }
+      commit(output, unprotected_slice, unprotected_buffer_size);
+      message_bytes += processed_message_size;
+      remaining -= processed_message_size;
+      processed += processed_message_size;
     }
-    output.add(unprotected_buffer, unprotected_buffer_size);
-    input.drain(processed_message_size);
   }
+  input.drain(processed);
 
   return TSI_OK;
 }
 
+void TsiFrameProtector::commit(Buffer::Instance& output, Buffer::RawSlice& slice, size_t size) {
+  // An empty reservation is left uncommitted, the output reuses it for the next one.
+  if (size > 0) {
+    slice.len_ = size;
+    output.commit(&slice, 1);
+  }
+}
+
 } // namespace Alts
 } // namespace TransportSockets
 } // namespace Extensions
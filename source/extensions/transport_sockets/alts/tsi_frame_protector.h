@@ -14,6 +14,9 @@ namespace Alts {
  * For detail of tsi_frame_protector, see
  * https://github.com/grpc/grpc/blob/v1.10.0/src/core/tsi/transport_security_interface.h#L70
  *
+ * The input is read from its slices and the output is written to space reserved in its buffer, so
+ * that the data is only copied by the frame protector itself.
+ *
  * TODO(lizan): migrate to tsi_zero_copy_grpc_protector for further optimization
  */
 class TsiFrameProtector final {
@@ -38,6 +41,8 @@ public:
   tsi_result unprotect(Buffer::Instance& input, Buffer::Instance& output);
 
 private:
+  static void commit(Buffer::Instance& output, Buffer::RawSlice& slice, size_t size);
+
   CFrameProtectorPtr frame_protector_;
 };
 
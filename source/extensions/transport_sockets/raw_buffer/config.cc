@@ -1,27 +1,54 @@
 #include "extensions/transport_sockets/raw_buffer/config.h"
 
+#include "envoy/config/transport_socket/raw_buffer/v2alpha/raw_buffer.pb.h"
+#include "envoy/config/transport_socket/raw_buffer/v2alpha/raw_buffer.pb.validate.h"
 #include "envoy/registry/registry.h"
+#include "envoy/singleton/manager.h"
 
 #include "common/network/raw_buffer_socket.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
 namespace RawBuffer {
 
+// Singleton registration via macro defined in envoy/singleton/manager.h
+SINGLETON_MANAGER_REGISTRATION(io_uring_workers);
+
+Network::TransportSocketFactoryPtr RawBufferSocketFactory::createFactory(
+    const Protobuf::Message& message,
+    Server::Configuration::TransportSocketFactoryContext& context) {
+  const auto& config = MessageUtil::downcastAndValidate<
+      const envoy::config::transport_socket::raw_buffer::v2alpha::RawBuffer&>(message);
+  Network::ThreadLocalIoUringWorkersSharedPtr io_uring;
+  if (config.io_uring()) {
+    io_uring = context.singletonManager().getTyped<Network::ThreadLocalIoUringWorkers>(
+        SINGLETON_MANAGER_REGISTERED_NAME(io_uring_workers), [&context] {
+          return std::make_shared<Network::ThreadLocalIoUringWorkers>(context.threadLocal());
+        });
+  }
+  return std::make_unique<Network::RawBufferSocketFactory>(
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, read_size_bytes,
+                                      Network::RawBufferSocket::DefaultReadSize),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, read_budget_bytes, 0), std::move(io_uring));
+}
+
 Network::TransportSocketFactoryPtr UpstreamRawBufferSocketFactory::createTransportSocketFactory(
-    const Protobuf::Message&, Server::Configuration::TransportSocketFactoryContext&) {
-  return std::make_unique<Network::RawBufferSocketFactory>();
+    const Protobuf::Message& message,
+    Server::Configuration::TransportSocketFactoryContext& context) {
+  return createFactory(message, context);
 }
 
 Network::TransportSocketFactoryPtr DownstreamRawBufferSocketFactory::createTransportSocketFactory(
-    const Protobuf::Message&, Server::Configuration::TransportSocketFactoryContext&,
+    const Protobuf::Message& message,
+    Server::Configuration::TransportSocketFactoryContext& context,
     const std::vector<std::string>&) {
-  return std::make_unique<Network::RawBufferSocketFactory>();
+  return createFactory(message, context);
 }
 
 ProtobufTypes::MessagePtr RawBufferSocketFactory::createEmptyConfigProto() {
-  return std::make_unique<ProtobufWkt::Empty>();
+  return std::make_unique<envoy::config::transport_socket::raw_buffer::v2alpha::RawBuffer>();
 }
 
 REGISTER_FACTORY(UpstreamRawBufferSocketFactory,
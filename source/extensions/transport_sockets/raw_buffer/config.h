@@ -18,6 +18,11 @@ public:
   virtual ~RawBufferSocketFactory() {}
   std::string name() const override { return TransportSocketNames::get().RawBuffer; }
   ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+
+protected:
+  Network::TransportSocketFactoryPtr
+  createFactory(const Protobuf::Message& message,
+                Server::Configuration::TransportSocketFactoryContext& context);
 };
 
 class UpstreamRawBufferSocketFactory
@@ -48,7 +48,8 @@ using PerSocketTapperPtr = std::unique_ptr<PerSocketTapper>;
 class SocketTapConfig : public virtual Extensions::Common::Tap::TapConfig {
 public:
   /**
-   * @return a new per-socket tapper which is used to handle tapping of a discrete socket.
+   * @return a new per-socket tapper which is used to handle tapping of a discrete socket, or
+   *         nullptr if the socket is not sampled.
    * @param connection supplies the underlying network connection.
    */
   virtual PerSocketTapperPtr createPerSocketTapper(const Network::Connection& connection) PURE;
@@ -56,6 +56,9 @@ public:
 
   // SocketTapConfig
   PerSocketTapperPtr createPerSocketTapper(const Network::Connection& connection) override {
+    if (!sampled(connection.id())) {
+      return nullptr;
+    }
     return std::make_unique<PerSocketTapperImpl>(shared_from_this(), connection);
   }
   TimeSource& timeSource() const override { return time_source_; }
@@ -0,0 +1,277 @@
+#include "extensions/transport_sockets/tls/certificate_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/logger.h"
+
+#include "openssl/sha.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+CertificateCache::CertificateChainConstSharedPtr
+CertificateCache::certificateChain(const std::string& pem) {
+  const std::string key = digest(pem, "");
+  {
+    Thread::LockGuard lock(lock_);
+    CertificateChainConstSharedPtr chain = find(certificate_chains_, key);
+    if (chain != nullptr) {
+      return chain;
+    }
+  }
+  CertificateChainConstSharedPtr chain = parseCertificateChain(pem);
+  if (chain == nullptr) {
+    return nullptr;
+  }
+  Thread::LockGuard lock(lock_);
+  return insert(certificate_chains_, key, std::move(chain));
+}
+
+CertificateCache::PrivateKeyConstSharedPtr
+CertificateCache::privateKey(const std::string& pem, const std::string& password) {
+  const std::string key = digest(pem, password);
+  {
+    Thread::LockGuard lock(lock_);
+    PrivateKeyConstSharedPtr private_key = find(private_keys_, key);
+    if (private_key != nullptr) {
+      return private_key;
+    }
+  }
+  PrivateKeyConstSharedPtr private_key = parsePrivateKey(pem, password);
+  if (private_key == nullptr) {
+    return nullptr;
+  }
+  Thread::LockGuard lock(lock_);
+  return insert(private_keys_, key, std::move(private_key));
+}
+
+CertificateCache::TrustedCaConstSharedPtr CertificateCache::trustedCa(const std::string& pem) {
+  const std::string key = digest(pem, "");
+  {
+    Thread::LockGuard lock(lock_);
+    TrustedCaConstSharedPtr trusted_ca = find(trusted_cas_, key);
+    if (trusted_ca != nullptr) {
+      return trusted_ca;
+    }
+  }
+  TrustedCaConstSharedPtr trusted_ca = parseTrustedCa(pem);
+  if (trusted_ca == nullptr) {
+    return nullptr;
+  }
+  Thread::LockGuard lock(lock_);
+  return insert(trusted_cas_, key, std::move(trusted_ca));
+}
+
+Ssl::CertificatePrefetchPtr
+CertificateCache::prefetch(const std::vector<const Ssl::TlsCertificateConfig*>& tls_certificates,
+                           Thread::ThreadFactory& thread_factory, uint32_t threads) {
+  auto prefetch = std::make_unique<PrefetchImpl>();
+
+  // Collect the chains and keys that aren't cached yet, once per digest.
+  struct Job {
+    const Ssl::TlsCertificateConfig* tls_certificate_;
+    bool is_private_key_;
+    std::string digest_;
+    CertificateChainConstSharedPtr chain_;
+    PrivateKeyConstSharedPtr private_key_entry_;
+  };
+  std::vector<Job> jobs;
+  {
+    std::unordered_set<std::string> pending;
+    Thread::LockGuard lock(lock_);
+    for (const Ssl::TlsCertificateConfig* tls_certificate : tls_certificates) {
+      std::string chain_digest = digest(tls_certificate->certificateChain(), "");
+      CertificateChainConstSharedPtr chain = find(certificate_chains_, chain_digest);
+      if (chain != nullptr) {
+        prefetch->entries_.push_back(std::move(chain));
+      } else if (pending.insert(chain_digest).second) {
+        jobs.push_back({tls_certificate, false, std::move(chain_digest), nullptr, nullptr});
+      }
+
+      std::string key_digest = digest(tls_certificate->privateKey(), tls_certificate->password());
+      PrivateKeyConstSharedPtr private_key = find(private_keys_, key_digest);
+      if (private_key != nullptr) {
+        prefetch->entries_.push_back(std::move(private_key));
+      } else if (pending.insert(key_digest).second) {
+        jobs.push_back({tls_certificate, true, std::move(key_digest), nullptr, nullptr});
+      }
+    }
+  }
+
+  // Parses every stride-th job starting at first. This only touches the jobs, so that it can run
+  // on several threads.
+  const auto parse = [&jobs](size_t first, size_t stride) {
+    for (size_t i = first; i < jobs.size(); i += stride) {
+      Job& job = jobs[i];
+      if (job.is_private_key_) {
+        job.private_key_entry_ = parsePrivateKey(job.tls_certificate_->privateKey(),
+                                                 job.tls_certificate_->password());
+      } else {
+        job.chain_ = parseCertificateChain(job.tls_certificate_->certificateChain());
+      }
+    }
+  };
+
+  // Spreading small batches over threads costs more than it saves.
+  const size_t parse_threads =
+      std::min<size_t>(threads, jobs.size() / MinEntriesPerPrefetchThread);
+  if (parse_threads <= 1) {
+    parse(0, 1);
+  } else {
+    std::vector<Thread::ThreadPtr> prefetch_threads;
+    for (size_t i = 0; i < parse_threads; i++) {
+      prefetch_threads.push_back(thread_factory.createThread(
+          [&parse, i, parse_threads]() -> void { parse(i, parse_threads); }));
+    }
+    for (auto& thread : prefetch_threads) {
+      thread->join();
+    }
+  }
+
+  Thread::LockGuard lock(lock_);
+  for (Job& job : jobs) {
+    if (job.chain_ != nullptr) {
+      prefetch->entries_.push_back(insert(certificate_chains_, job.digest_, std::move(job.chain_)));
+    } else if (job.private_key_entry_ != nullptr) {
+      prefetch->entries_.push_back(
+          insert(private_keys_, job.digest_, std::move(job.private_key_entry_)));
+    }
+  }
+  return prefetch;
+}
+
+uint64_t CertificateCache::size() {
+  Thread::LockGuard lock(lock_);
+  uint64_t size = 0;
+  const auto count = [&size](const auto& entries) {
+    for (const auto& entry : entries.map_) {
+      size += entry.second.expired() ? 0 : 1;
+    }
+  };
+  count(certificate_chains_);
+  count(private_keys_);
+  count(trusted_cas_);
+  return size;
+}
+
+std::string CertificateCache::digest(const std::string& pem, const std::string& password) {
+  // The PEM's length is hashed first, so that no PEM and password pair digests like another.
+  const uint64_t pem_length = pem.size();
+  SHA256_CTX ctx;
+  SHA256_Init(&ctx);
+  SHA256_Update(&ctx, &pem_length, sizeof(pem_length));
+  SHA256_Update(&ctx, pem.data(), pem.size());
+  SHA256_Update(&ctx, password.data(), password.size());
+  std::string digest(SHA256_DIGEST_LENGTH, '\0');
+  SHA256_Final(reinterpret_cast<uint8_t*>(&digest[0]), &ctx);
+  return digest;
+}
+
+CertificateCache::CertificateChainConstSharedPtr
+CertificateCache::parseCertificateChain(const std::string& pem) {
+  bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(const_cast<char*>(pem.data()), pem.size()));
+  RELEASE_ASSERT(bio != nullptr, "");
+  auto chain = std::make_shared<CertificateChain>();
+  chain->leaf_.reset(PEM_read_bio_X509_AUX(bio.get(), nullptr, nullptr, nullptr));
+  if (chain->leaf_ == nullptr) {
+    while (uint64_t err = ERR_get_error()) {
+      ENVOY_LOG_MISC(debug, "SSL error: {}:{}:{}:{}", err, ERR_lib_error_string(err),
+                     ERR_func_error_string(err), ERR_GET_REASON(err),
+                     ERR_reason_error_string(err));
+    }
+    return nullptr;
+  }
+  // Read rest of the certificate chain.
+  while (true) {
+    bssl::UniquePtr<X509> cert(PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr));
+    if (cert == nullptr) {
+      break;
+    }
+    chain->intermediates_.push_back(std::move(cert));
+  }
+  // Check for EOF.
+  const uint32_t err = ERR_peek_last_error();
+  ERR_clear_error();
+  if (ERR_GET_LIB(err) != ERR_LIB_PEM || ERR_GET_REASON(err) != PEM_R_NO_START_LINE) {
+    return nullptr;
+  }
+  return chain;
+}
+
+CertificateCache::PrivateKeyConstSharedPtr
+CertificateCache::parsePrivateKey(const std::string& pem, const std::string& password) {
+  bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(const_cast<char*>(pem.data()), pem.size()));
+  RELEASE_ASSERT(bio != nullptr, "");
+  auto private_key = std::make_shared<PrivateKey>();
+  private_key->pkey_.reset(PEM_read_bio_PrivateKey(
+      bio.get(), nullptr, nullptr,
+      !password.empty() ? const_cast<char*>(password.c_str()) : nullptr));
+  if (private_key->pkey_ == nullptr) {
+    ERR_clear_error();
+    return nullptr;
+  }
+  return private_key;
+}
+
+CertificateCache::TrustedCaConstSharedPtr CertificateCache::parseTrustedCa(const std::string& pem) {
+  bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(const_cast<char*>(pem.data()), pem.size()));
+  RELEASE_ASSERT(bio != nullptr, "");
+  // Based on BoringSSL's X509_load_cert_crl_file().
+  bssl::UniquePtr<STACK_OF(X509_INFO)> list(
+      PEM_X509_INFO_read_bio(bio.get(), nullptr, nullptr, nullptr));
+  if (list == nullptr) {
+    ERR_clear_error();
+    return nullptr;
+  }
+  auto trusted_ca = std::make_shared<TrustedCa>();
+  for (X509_INFO* item : list.get()) {
+    if (item->x509) {
+      X509_up_ref(item->x509);
+      trusted_ca->certs_.emplace_back(item->x509);
+    }
+    if (item->crl) {
+      X509_CRL_up_ref(item->crl);
+      trusted_ca->crls_.emplace_back(item->crl);
+    }
+  }
+  return trusted_ca;
+}
+
+template <class T>
+std::shared_ptr<const T> CertificateCache::find(Entries<T>& entries, const std::string& digest) {
+  auto it = entries.map_.find(digest);
+  return it != entries.map_.end() ? it->second.lock() : nullptr;
+}
+
+template <class T>
+std::shared_ptr<const T> CertificateCache::insert(Entries<T>& entries, const std::string& digest,
+                                                  std::shared_ptr<const T> entry) {
+  // Another thread may have parsed the same PEM in the meantime, which is kept so that the contexts
+  // share it.
+  std::weak_ptr<const T>& cached = entries.map_[digest];
+  std::shared_ptr<const T> existing = cached.lock();
+  if (existing != nullptr) {
+    return existing;
+  }
+  cached = entry;
+
+  if (entries.map_.size() >= 2 * std::max<uint64_t>(entries.size_after_purge_, 64)) {
+    for (auto it = entries.map_.begin(); it != entries.map_.end();) {
+      it = it->second.expired() ? entries.map_.erase(it) : std::next(it);
+    }
+    entries.size_after_purge_ = entries.map_.size();
+  }
+  return entry;
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
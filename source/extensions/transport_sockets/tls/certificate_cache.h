@@ -0,0 +1,119 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/ssl/context_manager.h"
+#include "envoy/ssl/tls_certificate_config.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Cache of the parsed certificate material of the contexts of a ContextManagerImpl, so that
+ * identical certificate chains, private keys and trusted CAs used by several filter chains and
+ * clusters are only parsed once. Entries are keyed by a SHA-256 digest of their PEM and stay
+ * cached as long as a context or a prefetch uses them. The parsed objects are never modified and
+ * are reference counted by BoringSSL, so that they can be shared by the SSL_CTXs of several
+ * contexts. The cache can be used from any thread.
+ */
+class CertificateCache {
+public:
+  struct CertificateChain {
+    bssl::UniquePtr<X509> leaf_;
+    std::vector<bssl::UniquePtr<X509>> intermediates_;
+  };
+
+  struct PrivateKey {
+    bssl::UniquePtr<EVP_PKEY> pkey_;
+  };
+
+  struct TrustedCa {
+    std::vector<bssl::UniquePtr<X509>> certs_;
+    std::vector<bssl::UniquePtr<X509_CRL>> crls_;
+  };
+
+  typedef std::shared_ptr<const CertificateChain> CertificateChainConstSharedPtr;
+  typedef std::shared_ptr<const PrivateKey> PrivateKeyConstSharedPtr;
+  typedef std::shared_ptr<const TrustedCa> TrustedCaConstSharedPtr;
+
+  /**
+   * @param pem supplies a PEM encoded certificate chain, leaf first.
+   * @return CertificateChainConstSharedPtr the parsed chain, nullptr if it can't be parsed.
+   */
+  CertificateChainConstSharedPtr certificateChain(const std::string& pem);
+
+  /**
+   * @param pem supplies a PEM encoded private key.
+   * @param password supplies the password of the key, empty if it isn't encrypted.
+   * @return PrivateKeyConstSharedPtr the parsed key, nullptr if it can't be parsed.
+   */
+  PrivateKeyConstSharedPtr privateKey(const std::string& pem, const std::string& password);
+
+  /**
+   * @param pem supplies PEM encoded CA certificates and CRLs.
+   * @return TrustedCaConstSharedPtr the parsed certificates and CRLs, nullptr if they can't be
+   *         parsed.
+   */
+  TrustedCaConstSharedPtr trustedCa(const std::string& pem);
+
+  /**
+   * Parse and cache the certificate chains and private keys that aren't cached yet. Batches of at
+   * least MinEntriesPerPrefetchThread entries per thread are spread over several threads.
+   * @see Ssl::ContextManager::prefetchCertificates().
+   */
+  Ssl::CertificatePrefetchPtr
+  prefetch(const std::vector<const Ssl::TlsCertificateConfig*>& tls_certificates,
+           Thread::ThreadFactory& thread_factory, uint32_t threads);
+
+  /**
+   * @return uint64_t the number of cached entries that are still in use.
+   */
+  uint64_t size();
+
+  static constexpr uint32_t MinEntriesPerPrefetchThread = 16;
+
+private:
+  template <class T> struct Entries {
+    std::unordered_map<std::string, std::weak_ptr<const T>> map_;
+    // The size of the map after expired entries were last removed, so that removing them is
+    // amortized over the insertions.
+    uint64_t size_after_purge_{};
+  };
+
+  class PrefetchImpl : public Ssl::CertificatePrefetch {
+  public:
+    std::vector<std::shared_ptr<const void>> entries_;
+  };
+
+  static std::string digest(const std::string& pem, const std::string& password);
+  static CertificateChainConstSharedPtr parseCertificateChain(const std::string& pem);
+  static PrivateKeyConstSharedPtr parsePrivateKey(const std::string& pem,
+                                                  const std::string& password);
+  static TrustedCaConstSharedPtr parseTrustedCa(const std::string& pem);
+
+  template <class T> std::shared_ptr<const T> find(Entries<T>& entries, const std::string& digest);
+  template <class T>
+  std::shared_ptr<const T> insert(Entries<T>& entries, const std::string& digest,
+                                  std::shared_ptr<const T> entry);
+
+  Thread::MutexBasicLockable lock_;
+  Entries<CertificateChain> certificate_chains_ GUARDED_BY(lock_);
+  Entries<PrivateKey> private_keys_ GUARDED_BY(lock_);
+  Entries<TrustedCa> trusted_cas_ GUARDED_BY(lock_);
+};
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
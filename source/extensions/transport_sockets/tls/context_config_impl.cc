@@ -104,6 +104,30 @@ getCertificateValidationContextConfigProvider(
   }
 }
 
+Secret::TlsSessionTicketKeysConfigProviderSharedPtr getTlsSessionTicketKeysConfigProvider(
+    const envoy::api::v2::auth::DownstreamTlsContext& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context) {
+  if (config.session_ticket_keys_type_case() !=
+      envoy::api::v2::auth::DownstreamTlsContext::kSessionTicketKeysSdsSecretConfig) {
+    return nullptr;
+  }
+  const auto& sds_secret_config = config.session_ticket_keys_sds_secret_config();
+  if (sds_secret_config.has_sds_config()) {
+    // Fetch dynamic secret.
+    return factory_context.secretManager().findOrCreateTlsSessionTicketKeysProvider(
+        sds_secret_config.sds_config(), sds_secret_config.name(), factory_context);
+  }
+  // Load static secret.
+  auto secret_provider =
+      factory_context.secretManager().findStaticTlsSessionTicketKeysProvider(
+          sds_secret_config.name());
+  if (!secret_provider) {
+    throw EnvoyException(
+        fmt::format("Unknown static TLS session ticket keys: {}", sds_secret_config.name()));
+  }
+  return secret_provider;
+}
+
 } // namespace
 
 ContextConfigImpl::ContextConfigImpl(
@@ -111,7 +135,7 @@ ContextConfigImpl::ContextConfigImpl(
     const unsigned default_min_protocol_version, const unsigned default_max_protocol_version,
     const std::string& default_cipher_suites, const std::string& default_curves,
     Server::Configuration::TransportSocketFactoryContext& factory_context)
-    : api_(factory_context.api()),
+    : api_(factory_context.api()), factory_context_(factory_context),
       alpn_protocols_(RepeatedPtrUtil::join(config.alpn_protocols(), ",")),
       cipher_suites_(StringUtil::nonEmptyStringOrDefault(
           RepeatedPtrUtil::join(config.tls_params().cipher_suites(), ":"), default_cipher_suites)),
@@ -123,7 +147,8 @@ ContextConfigImpl::ContextConfigImpl(
       min_protocol_version_(tlsVersionFromProto(config.tls_params().tls_minimum_protocol_version(),
                                                 default_min_protocol_version)),
       max_protocol_version_(tlsVersionFromProto(config.tls_params().tls_maximum_protocol_version(),
-                                                default_max_protocol_version)) {
+                                                default_max_protocol_version)),
+      kernel_tls_offload_(config.kernel_tls_offload()) {
   if (default_cvc_ && certificate_validation_context_provider_ != nullptr) {
     // We need to validate combined certificate validation context.
     // The default certificate validation context and dynamic certificate validation
@@ -144,7 +169,7 @@ ContextConfigImpl::ContextConfigImpl(
   if (!tls_certificate_providers_.empty()) {
     for (auto& provider : tls_certificate_providers_) {
       if (provider->secret() != nullptr) {
-        tls_certificate_configs_.emplace_back(*provider->secret(), api_);
+        tls_certificate_configs_.emplace_back(*provider->secret(), &factory_context_, api_);
       }
     }
   }
@@ -175,7 +200,8 @@ void ContextConfigImpl::setSecretUpdateCallback(std::function<void()> callback)
           // This breaks multiple certificate support, but today SDS is only single cert.
           // TODO(htuch): Fix this when SDS goes multi-cert.
           tls_certificate_configs_.clear();
-          tls_certificate_configs_.emplace_back(*tls_certificate_providers_[0]->secret(), api_);
+          tls_certificate_configs_.emplace_back(*tls_certificate_providers_[0]->secret(),
+                                                &factory_context_, api_);
           callback();
         });
   }
@@ -339,27 +365,24 @@ ServerContextConfigImpl::ServerContextConfigImpl(
                         DEFAULT_CIPHER_SUITES, DEFAULT_CURVES, factory_context),
       require_client_certificate_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, require_client_certificate, false)),
-      session_ticket_keys_([&config, &api = api_] {
-        std::vector<SessionTicketKey> ret;
-
+      session_ticket_keys_provider_(getTlsSessionTicketKeysConfigProvider(config, factory_context)),
+      session_ticket_keys_([&config, this] {
         switch (config.session_ticket_keys_type_case()) {
         case envoy::api::v2::auth::DownstreamTlsContext::kSessionTicketKeys:
-          for (const auto& datasource : config.session_ticket_keys().keys()) {
-            validateAndAppendKey(ret, Config::DataSource::read(datasource, false, api));
-          }
-          break;
+          return getSessionTicketKeys(config.session_ticket_keys());
         case envoy::api::v2::auth::DownstreamTlsContext::kSessionTicketKeysSdsSecretConfig:
-          throw EnvoyException("SDS not supported yet");
-          break;
+          // Dynamic keys are loaded once the first SDS update is accepted.
+          return session_ticket_keys_provider_->secret() != nullptr
+                     ? getSessionTicketKeys(*session_ticket_keys_provider_->secret())
+                     : std::vector<SessionTicketKey>{};
         case envoy::api::v2::auth::DownstreamTlsContext::SESSION_TICKET_KEYS_TYPE_NOT_SET:
-          break;
+          return std::vector<SessionTicketKey>{};
         default:
           throw EnvoyException(fmt::format("Unexpected case for oneof session_ticket_keys: {}",
                                            config.session_ticket_keys_type_case()));
         }
-
-        return ret;
-      }()) {
+      }()),
+      stat_prefix_(config.stat_prefix()) {
   if ((config.common_tls_context().tls_certificates().size() +
        config.common_tls_context().tls_certificate_sds_secret_configs().size()) == 0) {
     throw EnvoyException("No TLS certificates found for server context");
@@ -367,6 +390,56 @@ ServerContextConfigImpl::ServerContextConfigImpl(
              !config.common_tls_context().tls_certificate_sds_secret_configs().empty()) {
     throw EnvoyException("SDS and non-SDS TLS certificates may not be mixed in server contexts");
   }
+  auto* session_ticket_keys_sds_api =
+      dynamic_cast<Secret::TlsSessionTicketKeysSdsApi*>(session_ticket_keys_provider_.get());
+  if (session_ticket_keys_sds_api != nullptr) {
+    // SDS updates with invalid keys are rejected, and the current keys stay in use.
+    stk_validation_callback_handle_ = session_ticket_keys_sds_api->addValidationCallback(
+        [this](const envoy::api::v2::auth::TlsSessionTicketKeys& keys) {
+          getSessionTicketKeys(keys);
+        });
+  }
+}
+
+ServerContextConfigImpl::~ServerContextConfigImpl() {
+  if (stk_update_callback_handle_) {
+    stk_update_callback_handle_->remove();
+  }
+  if (stk_validation_callback_handle_) {
+    stk_validation_callback_handle_->remove();
+  }
+}
+
+bool ServerContextConfigImpl::isReady() const {
+  return ContextConfigImpl::isReady() && (session_ticket_keys_provider_ == nullptr ||
+                                          session_ticket_keys_provider_->secret() != nullptr);
+}
+
+void ServerContextConfigImpl::setSecretUpdateCallback(std::function<void()> callback) {
+  ContextConfigImpl::setSecretUpdateCallback(callback);
+  if (session_ticket_keys_provider_) {
+    if (stk_update_callback_handle_) {
+      stk_update_callback_handle_->remove();
+    }
+    // Once session_ticket_keys_provider_ receives new keys, this callback updates
+    // ServerContextConfigImpl::session_ticket_keys_ with them. The filter chains that share the
+    // provider are all called back from the same update.
+    stk_update_callback_handle_ =
+        session_ticket_keys_provider_->addUpdateCallback([this, callback]() {
+          session_ticket_keys_ = getSessionTicketKeys(*session_ticket_keys_provider_->secret());
+          callback();
+        });
+  }
+}
+
+std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey>
+ServerContextConfigImpl::getSessionTicketKeys(
+    const envoy::api::v2::auth::TlsSessionTicketKeys& keys) {
+  std::vector<SessionTicketKey> result;
+  for (const auto& datasource : keys.keys()) {
+    validateAndAppendKey(result, Config::DataSource::read(datasource, false, api_));
+  }
+  return result;
 }
 
 ServerContextConfigImpl::ServerContextConfigImpl(
@@ -43,6 +43,7 @@ public:
   }
   unsigned minProtocolVersion() const override { return min_protocol_version_; };
   unsigned maxProtocolVersion() const override { return max_protocol_version_; };
+  bool kernelTlsOffload() const override { return kernel_tls_offload_; }
 
   bool isReady() const override {
     const bool tls_is_ready =
@@ -66,6 +67,7 @@ protected:
                     const std::string& default_cipher_suites, const std::string& default_curves,
                     Server::Configuration::TransportSocketFactoryContext& factory_context);
   Api::Api& api_;
+  Server::Configuration::TransportSocketFactoryContext& factory_context_;
 
 private:
   static unsigned
@@ -92,6 +94,7 @@ private:
   Common::CallbackHandle* cvc_validation_callback_handle_{};
   const unsigned min_protocol_version_;
   const unsigned max_protocol_version_;
+  const bool kernel_tls_offload_;
 };
 
 class ClientContextConfigImpl : public ContextConfigImpl, public Envoy::Ssl::ClientContextConfig {
@@ -133,12 +136,18 @@ public:
   ServerContextConfigImpl(
       const Json::Object& config,
       Server::Configuration::TransportSocketFactoryContext& secret_provider_context);
+  ~ServerContextConfigImpl() override;
+
+  // Ssl::ContextConfig
+  bool isReady() const override;
+  void setSecretUpdateCallback(std::function<void()> callback) override;
 
   // Ssl::ServerContextConfig
   bool requireClientCertificate() const override { return require_client_certificate_; }
   const std::vector<SessionTicketKey>& sessionTicketKeys() const override {
     return session_ticket_keys_;
   }
+  const std::string& statPrefix() const override { return stat_prefix_; }
 
 private:
   static const unsigned DEFAULT_MIN_VERSION;
@@ -146,8 +155,16 @@ private:
   static const std::string DEFAULT_CIPHER_SUITES;
   static const std::string DEFAULT_CURVES;
 
+  std::vector<SessionTicketKey>
+  getSessionTicketKeys(const envoy::api::v2::auth::TlsSessionTicketKeys& keys);
+
   const bool require_client_certificate_;
-  const std::vector<SessionTicketKey> session_ticket_keys_;
+  Secret::TlsSessionTicketKeysConfigProviderSharedPtr session_ticket_keys_provider_;
+  std::vector<SessionTicketKey> session_ticket_keys_;
+  const std::string stat_prefix_;
+  // Handles for the session ticket keys dynamic secret callbacks.
+  Common::CallbackHandle* stk_update_callback_handle_{};
+  Common::CallbackHandle* stk_validation_callback_handle_{};
 
   static void validateAndAppendKey(std::vector<ServerContextConfig::SessionTicketKey>& keys,
                                    const std::string& key_data);
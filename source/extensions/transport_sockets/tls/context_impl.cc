@@ -43,12 +43,37 @@ bool cbsContainsU16(CBS& cbs, uint16_t n) {
   return false;
 }
 
+// The type of the key of the server's certificate, which dominates the cost of full handshakes.
+const char* serverKeyType(SSL* ssl) {
+  bssl::UniquePtr<X509> peer_cert;
+  X509* cert;
+  if (SSL_is_server(ssl)) {
+    cert = SSL_get_certificate(ssl);
+  } else {
+    peer_cert.reset(SSL_get_peer_certificate(ssl));
+    cert = peer_cert.get();
+  }
+  if (cert == nullptr) {
+    return "none";
+  }
+  bssl::UniquePtr<EVP_PKEY> public_key(X509_get_pubkey(cert));
+  switch (public_key != nullptr ? EVP_PKEY_id(public_key.get()) : EVP_PKEY_NONE) {
+  case EVP_PKEY_RSA:
+    return "rsa";
+  case EVP_PKEY_EC:
+    return "ecdsa";
+  default:
+    return "other";
+  }
+}
+
 } // namespace
 
 ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& config,
-                         TimeSource& time_source)
+                         TimeSource& time_source, CertificateCache& certificate_cache)
     : scope_(scope), stats_(generateStats(scope)), time_source_(time_source),
-      tls_max_version_(config.maxProtocolVersion()) {
+      tls_max_version_(config.maxProtocolVersion()),
+      kernel_tls_offload_(config.kernelTlsOffload()) {
   const auto tls_certificates = config.tlsCertificates();
   tls_contexts_.resize(std::max(1UL, tls_certificates.size()));
 
@@ -88,38 +113,25 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
   if (config.certificateValidationContext() != nullptr &&
       !config.certificateValidationContext()->caCert().empty()) {
     ca_file_path_ = config.certificateValidationContext()->caCertPath();
-    bssl::UniquePtr<BIO> bio(
-        BIO_new_mem_buf(const_cast<char*>(config.certificateValidationContext()->caCert().data()),
-                        config.certificateValidationContext()->caCert().size()));
-    RELEASE_ASSERT(bio != nullptr, "");
-    // Based on BoringSSL's X509_load_cert_crl_file().
-    bssl::UniquePtr<STACK_OF(X509_INFO)> list(
-        PEM_X509_INFO_read_bio(bio.get(), nullptr, nullptr, nullptr));
-    if (list == nullptr) {
+    CertificateCache::TrustedCaConstSharedPtr trusted_ca =
+        certificate_cache.trustedCa(config.certificateValidationContext()->caCert());
+    if (trusted_ca == nullptr || trusted_ca->certs_.empty()) {
       throw EnvoyException(fmt::format("Failed to load trusted CA certificates from {}",
                                        config.certificateValidationContext()->caCertPath()));
     }
+    certificate_cache_entries_.push_back(trusted_ca);
+    X509_up_ref(trusted_ca->certs_.front().get());
+    ca_cert_.reset(trusted_ca->certs_.front().get());
 
     for (auto& ctx : tls_contexts_) {
       X509_STORE* store = SSL_CTX_get_cert_store(ctx.ssl_ctx_.get());
-      bool has_crl = false;
-      for (const X509_INFO* item : list.get()) {
-        if (item->x509) {
-          X509_STORE_add_cert(store, item->x509);
-          if (ca_cert_ == nullptr) {
-            X509_up_ref(item->x509);
-            ca_cert_.reset(item->x509);
-          }
-        }
-        if (item->crl) {
-          X509_STORE_add_crl(store, item->crl);
-          has_crl = true;
-        }
+      for (const auto& cert : trusted_ca->certs_) {
+        X509_STORE_add_cert(store, cert.get());
       }
-      if (ca_cert_ == nullptr) {
-        throw EnvoyException(fmt::format("Failed to load trusted CA certificates from {}",
-                                         config.certificateValidationContext()->caCertPath()));
+      for (const auto& crl : trusted_ca->crls_) {
+        X509_STORE_add_crl(store, crl.get());
       }
+      const bool has_crl = !trusted_ca->crls_.empty();
       if (has_crl) {
         X509_STORE_set_flags(store, X509_V_FLAG_CRL_CHECK | X509_V_FLAG_CRL_CHECK_ALL);
       }
@@ -214,41 +226,27 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
     // Load certificate chain.
     const auto& tls_certificate = tls_certificates[i].get();
     ctx.cert_chain_file_path_ = tls_certificate.certificateChainPath();
-    bssl::UniquePtr<BIO> bio(
-        BIO_new_mem_buf(const_cast<char*>(tls_certificate.certificateChain().data()),
-                        tls_certificate.certificateChain().size()));
-    RELEASE_ASSERT(bio != nullptr, "");
-    ctx.cert_chain_.reset(PEM_read_bio_X509_AUX(bio.get(), nullptr, nullptr, nullptr));
-    if (ctx.cert_chain_ == nullptr ||
-        !SSL_CTX_use_certificate(ctx.ssl_ctx_.get(), ctx.cert_chain_.get())) {
-      while (uint64_t err = ERR_get_error()) {
-        ENVOY_LOG_MISC(debug, "SSL error: {}:{}:{}:{}", err, ERR_lib_error_string(err),
-                       ERR_func_error_string(err), ERR_GET_REASON(err),
-                       ERR_reason_error_string(err));
-      }
+    CertificateCache::CertificateChainConstSharedPtr chain =
+        certificate_cache.certificateChain(tls_certificate.certificateChain());
+    if (chain == nullptr) {
       throw EnvoyException(
           fmt::format("Failed to load certificate chain from {}", ctx.cert_chain_file_path_));
     }
-    // Read rest of the certificate chain.
-    while (true) {
-      bssl::UniquePtr<X509> cert(PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr));
-      if (cert == nullptr) {
-        break;
-      }
+    certificate_cache_entries_.push_back(chain);
+    X509_up_ref(chain->leaf_.get());
+    ctx.cert_chain_.reset(chain->leaf_.get());
+    if (!SSL_CTX_use_certificate(ctx.ssl_ctx_.get(), ctx.cert_chain_.get())) {
+      throw EnvoyException(
+          fmt::format("Failed to load certificate chain from {}", ctx.cert_chain_file_path_));
+    }
+    for (const auto& cert : chain->intermediates_) {
+      // SSL_CTX_add_extra_chain_cert() takes ownership, the cached certificate is shared.
+      X509_up_ref(cert.get());
       if (!SSL_CTX_add_extra_chain_cert(ctx.ssl_ctx_.get(), cert.get())) {
+        X509_free(cert.get());
         throw EnvoyException(
             fmt::format("Failed to load certificate chain from {}", ctx.cert_chain_file_path_));
       }
-      // SSL_CTX_add_extra_chain_cert() takes ownership.
-      cert.release();
-    }
-    // Check for EOF.
-    uint32_t err = ERR_peek_last_error();
-    if (ERR_GET_LIB(err) == ERR_LIB_PEM && ERR_GET_REASON(err) == PEM_R_NO_START_LINE) {
-      ERR_clear_error();
-    } else {
-      throw EnvoyException(
-          fmt::format("Failed to load certificate chain from {}", ctx.cert_chain_file_path_));
     }
 
     bssl::UniquePtr<EVP_PKEY> public_key(X509_get_pubkey(ctx.cert_chain_.get()));
@@ -302,24 +300,44 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
 #endif
     }
 
+    Envoy::Ssl::PrivateKeyMethodProviderSharedPtr private_key_method_provider =
+        tls_certificate.privateKeyMethod();
+    if (private_key_method_provider != nullptr) {
+      // The private key operations are handed over to the provider.
+#ifdef BORINGSSL_FIPS
+      if (!private_key_method_provider->checkFips()) {
+        throw EnvoyException(
+            fmt::format("Private key method of the certificate {} doesn't support FIPS mode",
+                        ctx.cert_chain_file_path_));
+      }
+#endif
+      Envoy::Ssl::BoringSslPrivateKeyMethodSharedPtr private_key_method =
+          private_key_method_provider->getBoringSslPrivateKeyMethod();
+      if (private_key_method == nullptr) {
+        throw EnvoyException(fmt::format("Failed to get private key method of the certificate {}",
+                                         ctx.cert_chain_file_path_));
+      }
+      SSL_CTX_set_private_key_method(ctx.ssl_ctx_.get(), private_key_method.get());
+      private_key_method_providers_.push_back(private_key_method_provider);
+      private_key_methods_.push_back(private_key_method);
+      continue;
+    }
+
     // Load private key.
-    bio.reset(BIO_new_mem_buf(const_cast<char*>(tls_certificate.privateKey().data()),
-                              tls_certificate.privateKey().size()));
-    RELEASE_ASSERT(bio != nullptr, "");
-    bssl::UniquePtr<EVP_PKEY> pkey(PEM_read_bio_PrivateKey(
-        bio.get(), nullptr, nullptr,
-        !tls_certificate.password().empty() ? const_cast<char*>(tls_certificate.password().c_str())
-                                            : nullptr));
-    if (pkey == nullptr || !SSL_CTX_use_PrivateKey(ctx.ssl_ctx_.get(), pkey.get())) {
+    CertificateCache::PrivateKeyConstSharedPtr private_key =
+        certificate_cache.privateKey(tls_certificate.privateKey(), tls_certificate.password());
+    if (private_key == nullptr ||
+        !SSL_CTX_use_PrivateKey(ctx.ssl_ctx_.get(), private_key->pkey_.get())) {
       throw EnvoyException(
           fmt::format("Failed to load private key from {}", tls_certificate.privateKeyPath()));
     }
+    certificate_cache_entries_.push_back(private_key);
 
 #ifdef BORINGSSL_FIPS
     // Verify that private keys are passing FIPS pairwise consistency tests.
     switch (pkey_id) {
     case EVP_PKEY_EC: {
-      const EC_KEY* ecdsa_private_key = EVP_PKEY_get0_EC_KEY(pkey.get());
+      const EC_KEY* ecdsa_private_key = EVP_PKEY_get0_EC_KEY(private_key->pkey_.get());
       if (!EC_KEY_check_fips(ecdsa_private_key)) {
         throw EnvoyException(fmt::format("Failed to load private key from {}, ECDSA key failed "
                                          "pairwise consistency test required in FIPS mode",
@@ -327,7 +345,7 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
       }
     } break;
     case EVP_PKEY_RSA: {
-      RSA* rsa_private_key = EVP_PKEY_get0_RSA(pkey.get());
+      RSA* rsa_private_key = EVP_PKEY_get0_RSA(private_key->pkey_.get());
       if (!RSA_check_fips(rsa_private_key)) {
         throw EnvoyException(fmt::format("Failed to load private key from {}, RSA key failed "
                                          "pairwise consistency test required in FIPS mode",
@@ -446,13 +464,22 @@ int ContextImpl::verifyCertificate(X509* cert) {
   return 1;
 }
 
-void ContextImpl::logHandshake(SSL* ssl) const {
+void ContextImpl::logHandshake(SSL* ssl, std::chrono::microseconds duration,
+                               std::chrono::microseconds processing_time) const {
   stats_.handshake_.inc();
 
-  if (SSL_session_reused(ssl)) {
+  const bool session_reused = SSL_session_reused(ssl);
+  if (session_reused) {
     stats_.session_reused_.inc();
   }
 
+  const std::string handshake_type =
+      fmt::format("{}.{}", session_reused ? "resumed" : "full", serverKeyType(ssl));
+  scope_.histogram(fmt::format("ssl.handshake_time_us.{}", handshake_type))
+      .recordValue(duration.count());
+  scope_.histogram(fmt::format("ssl.handshake_processing_time_us.{}", handshake_type))
+      .recordValue(processing_time.count());
+
   const char* cipher = SSL_get_cipher_name(ssl);
   scope_.counter(fmt::format("ssl.ciphers.{}", std::string{cipher})).inc();
 
@@ -626,13 +653,17 @@ Envoy::Ssl::CertificateDetailsPtr ContextImpl::certificateDetails(X509* cert,
 
 ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
                                      const Envoy::Ssl::ClientContextConfig& config,
-                                     TimeSource& time_source)
-    : ContextImpl(scope, config, time_source),
+                                     TimeSource& time_source, CertificateCache& certificate_cache)
+    : ContextImpl(scope, config, time_source, certificate_cache),
       server_name_indication_(config.serverNameIndication()),
       allow_renegotiation_(config.allowRenegotiation()),
       max_session_keys_(config.maxSessionKeys()) {
   // This should be guaranteed during configuration ingestion for client contexts.
   ASSERT(tls_contexts_.size() == 1);
+  // Renegotiation handshakes would be written with the keys that were handed over to the kernel.
+  if (allow_renegotiation_) {
+    kernel_tls_offload_ = false;
+  }
   if (!parsed_alpn_protocols_.empty()) {
     for (auto& ctx : tls_contexts_) {
       int rc = SSL_CTX_set_alpn_protos(ctx.ssl_ctx_.get(), &parsed_alpn_protocols_[0],
@@ -659,7 +690,7 @@ ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
               static_cast<ContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
           ClientContextImpl* client_context_impl = dynamic_cast<ClientContextImpl*>(context_impl);
           RELEASE_ASSERT(client_context_impl != nullptr, ""); // for Coverity
-          return client_context_impl->newSessionKey(session);
+          return client_context_impl->newSessionKey(ssl, session);
         });
   }
 }
@@ -679,51 +710,93 @@ bssl::UniquePtr<SSL> ClientContextImpl::newSsl(absl::optional<std::string> overr
     SSL_set_renegotiate_mode(ssl_con.get(), ssl_renegotiate_freely);
   }
 
-  if (max_session_keys_ > 0) {
-    if (session_keys_single_use_) {
-      // Stored single-use session keys, use write/write locks.
-      absl::WriterMutexLock l(&session_keys_mu_);
-      if (!session_keys_.empty()) {
-        // Use the most recently stored session key, since it has the highest
-        // probability of still being recognized/accepted by the server.
-        SSL_SESSION* session = session_keys_.front().get();
-        SSL_set_session(ssl_con.get(), session);
-        // Remove single-use session key (TLS 1.3) after first use.
-        if (SSL_SESSION_should_be_single_use(session)) {
-          session_keys_.pop_front();
-        }
-      }
+  return ssl_con;
+}
+
+void ClientContextImpl::resumeSession(
+    SSL* ssl, const Network::Address::InstanceConstSharedPtr& remote_address) {
+  if (max_session_keys_ == 0) {
+    return;
+  }
+
+  const char* server_name = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+  auto key = std::make_unique<std::string>(
+      fmt::format("{}/{}", server_name != nullptr ? server_name : "",
+                  remote_address != nullptr ? remote_address->asString() : ""));
+  {
+    absl::MutexLock l(&session_keys_mu_);
+    auto it = session_keys_.find(*key);
+    if (it == session_keys_.end()) {
+      stats_.session_cache_miss_.inc();
     } else {
-      // Never stored single-use session keys, use read/write locks.
-      absl::ReaderMutexLock l(&session_keys_mu_);
-      if (!session_keys_.empty()) {
-        // Use the most recently stored session key, since it has the highest
-        // probability of still being recognized/accepted by the server.
-        SSL_SESSION* session = session_keys_.front().get();
-        SSL_set_session(ssl_con.get(), session);
+      stats_.session_cache_hit_.inc();
+      // Use the most recently stored session key, since it has the highest
+      // probability of still being recognized/accepted by the server.
+      SSL_SESSION* session = it->second.sessions_.front().get();
+      SSL_set_session(ssl, session);
+      session_keys_lru_.splice(session_keys_lru_.begin(), session_keys_lru_,
+                               it->second.lru_position_);
+      // Remove single-use session key (TLS 1.3) after first use.
+      if (SSL_SESSION_should_be_single_use(session)) {
+        popSessionKey(it, true);
       }
     }
   }
+  // The key is freed with the SSL instance.
+  SSL_set_ex_data(ssl, sessionCacheKeyIndex(), key.release());
+}
 
-  return ssl_con;
+int ClientContextImpl::sessionCacheKeyIndex() {
+  static const int index =
+      SSL_get_ex_new_index(0, nullptr, nullptr, nullptr,
+                           [](void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) -> void {
+                             delete static_cast<std::string*>(ptr);
+                           });
+  RELEASE_ASSERT(index >= 0, "");
+  return index;
 }
 
-int ClientContextImpl::newSessionKey(SSL_SESSION* session) {
-  // In case we ever store single-use session key (TLS 1.3),
-  // we need to switch to using write/write locks.
-  if (SSL_SESSION_should_be_single_use(session)) {
-    session_keys_single_use_ = true;
+int ClientContextImpl::newSessionKey(SSL* ssl, SSL_SESSION* session) {
+  const std::string* key =
+      static_cast<const std::string*>(SSL_get_ex_data(ssl, sessionCacheKeyIndex()));
+  if (key == nullptr) {
+    // The peer of the connection is unknown, so the session key can't be used by other ones.
+    return 0;
+  }
+
+  absl::MutexLock l(&session_keys_mu_);
+  // Evict the oldest entries of the least recently used upstream hosts.
+  while (session_keys_size_ >= max_session_keys_) {
+    popSessionKey(session_keys_.find(session_keys_lru_.back()), false);
   }
-  absl::WriterMutexLock l(&session_keys_mu_);
-  // Evict oldest entries.
-  while (session_keys_.size() >= max_session_keys_) {
-    session_keys_.pop_back();
+  auto it = session_keys_.find(*key);
+  if (it == session_keys_.end()) {
+    session_keys_lru_.push_front(*key);
+    it = session_keys_.emplace(*key, SessionKeys{{}, session_keys_lru_.begin()}).first;
+  } else {
+    session_keys_lru_.splice(session_keys_lru_.begin(), session_keys_lru_,
+                             it->second.lru_position_);
   }
   // Add new session key at the front of the queue, so that it's used first.
-  session_keys_.push_front(bssl::UniquePtr<SSL_SESSION>(session));
+  it->second.sessions_.push_front(bssl::UniquePtr<SSL_SESSION>(session));
+  session_keys_size_++;
   return 1; // Tell BoringSSL that we took ownership of the session.
 }
 
+void ClientContextImpl::popSessionKey(SessionKeysMap::iterator it, bool most_recent) {
+  ASSERT(it != session_keys_.end());
+  if (most_recent) {
+    it->second.sessions_.pop_front();
+  } else {
+    it->second.sessions_.pop_back();
+  }
+  session_keys_size_--;
+  if (it->second.sessions_.empty()) {
+    session_keys_lru_.erase(it->second.lru_position_);
+    session_keys_.erase(it);
+  }
+}
+
 uint16_t ClientContextImpl::parseSigningAlgorithmsForTest(const std::string& sigalgs) {
   // This is used only when testing RSA/ECDSA certificate selection, so only the signing algorithms
   // used in tests are supported here.
@@ -738,8 +811,9 @@ uint16_t ClientContextImpl::parseSigningAlgorithmsForTest(const std::string& sig
 ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
                                      const Envoy::Ssl::ServerContextConfig& config,
                                      const std::vector<std::string>& server_names,
-                                     TimeSource& time_source)
-    : ContextImpl(scope, config, time_source), session_ticket_keys_(config.sessionTicketKeys()) {
+                                     TimeSource& time_source, CertificateCache& certificate_cache)
+    : ContextImpl(scope, config, time_source, certificate_cache),
+      session_ticket_keys_(config.sessionTicketKeys()) {
   if (config.tlsCertificates().empty()) {
     throw EnvoyException("Server TlsCertificates must have a certificate specified");
   }
@@ -938,12 +1012,17 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
         }
 
         // If our current encryption was not the decryption key, renew
+        if (!is_enc_key) {
+          stats_.session_ticket_renewed_.inc();
+        }
         return is_enc_key ? 1  // success; do not renew
                           : 2; // success: renew key
       }
       is_enc_key = false;
     }
 
+    // The ticket was encrypted with a key that was rotated out, or by another server.
+    stats_.session_ticket_unknown_key_.inc();
     return 0; // decryption failed
   }
 }
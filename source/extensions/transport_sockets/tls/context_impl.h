@@ -1,15 +1,21 @@
 #pragma once
 
+#include <chrono>
 #include <deque>
 #include <functional>
+#include <list>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "envoy/network/address.h"
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
+#include "envoy/ssl/private_key/private_key.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 
+#include "extensions/transport_sockets/tls/certificate_cache.h"
 #include "extensions/transport_sockets/tls/context_manager_impl.h"
 
 #include "absl/synchronization/mutex.h"
@@ -34,7 +40,12 @@ namespace Tls {
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
   COUNTER(fail_verify_san)                                                                         \
-  COUNTER(fail_verify_cert_hash)
+  COUNTER(fail_verify_cert_hash)                                                                   \
+  COUNTER(kernel_tls_tx_offload)                                                                   \
+  COUNTER(session_ticket_renewed)                                                                  \
+  COUNTER(session_ticket_unknown_key)                                                              \
+  COUNTER(session_cache_hit)                                                                       \
+  COUNTER(session_cache_miss)
 // clang-format on
 
 /**
@@ -48,11 +59,22 @@ class ContextImpl : public virtual Envoy::Ssl::Context {
 public:
   virtual bssl::UniquePtr<SSL> newSsl(absl::optional<std::string> override_server_name);
 
+  /**
+   * Sets up the session resumption of a connection created by newSsl() once its peer is known,
+   * before its handshake starts.
+   * @param ssl supplies the connection.
+   * @param remote_address supplies the address of the peer.
+   */
+  virtual void resumeSession(SSL*, const Network::Address::InstanceConstSharedPtr&) {}
+
   /**
    * Logs successful TLS handshake and updates stats.
    * @param ssl the connection to log
+   * @param duration the time from the start of the handshake to its completion.
+   * @param processing_time the time spent in the handshake steps of the connection.
    */
-  void logHandshake(SSL* ssl) const;
+  void logHandshake(SSL* ssl, std::chrono::microseconds duration,
+                    std::chrono::microseconds processing_time) const;
 
   /**
    * Performs subjectAltName verification
@@ -73,6 +95,21 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return the providers of the private key operations of the certificates, which the
+   *         connections register with before their handshake.
+   */
+  const std::vector<Envoy::Ssl::PrivateKeyMethodProviderSharedPtr>&
+  getPrivateKeyMethodProviders() const {
+    return private_key_method_providers_;
+  }
+
+  /**
+   * @return true if the encryption of outgoing records of the connections should be handed over
+   *         to the kernel after the handshake, where the negotiated parameters allow it.
+   */
+  bool kernelTlsOffload() const { return kernel_tls_offload_; }
+
   // Ssl::Context
   size_t daysUntilFirstCertExpires() const override;
   Envoy::Ssl::CertificateDetailsPtr getCaCertInformation() const override;
@@ -80,7 +117,7 @@ public:
 
 protected:
   ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& config,
-              TimeSource& time_source);
+              TimeSource& time_source, CertificateCache& certificate_cache);
 
   /**
    * The global SSL-library index used for storing a pointer to the context
@@ -159,6 +196,12 @@ protected:
   std::string cert_chain_file_path_;
   TimeSource& time_source_;
   const unsigned tls_max_version_;
+  bool kernel_tls_offload_;
+  // The parsed certificates used by the SSL_CTXs, which keep them cached for other contexts.
+  std::vector<std::shared_ptr<const void>> certificate_cache_entries_;
+  std::vector<Envoy::Ssl::PrivateKeyMethodProviderSharedPtr> private_key_method_providers_;
+  // The SSL_CTXs only refer to the private key methods of the providers.
+  std::vector<Envoy::Ssl::BoringSslPrivateKeyMethodSharedPtr> private_key_methods_;
 };
 
 typedef std::shared_ptr<ContextImpl> ContextImplSharedPtr;
@@ -166,26 +209,49 @@ typedef std::shared_ptr<ContextImpl> ContextImplSharedPtr;
 class ClientContextImpl : public ContextImpl, public Envoy::Ssl::ClientContext {
 public:
   ClientContextImpl(Stats::Scope& scope, const Envoy::Ssl::ClientContextConfig& config,
-                    TimeSource& time_source);
+                    TimeSource& time_source, CertificateCache& certificate_cache);
 
   bssl::UniquePtr<SSL> newSsl(absl::optional<std::string> override_server_name) override;
+  void resumeSession(SSL* ssl,
+                     const Network::Address::InstanceConstSharedPtr& remote_address) override;
 
 private:
-  int newSessionKey(SSL_SESSION* session);
+  struct SessionKeys {
+    // The stored session keys of an upstream host, most recently stored first.
+    std::deque<bssl::UniquePtr<SSL_SESSION>> sessions_;
+    std::list<std::string>::iterator lru_position_;
+  };
+  typedef std::unordered_map<std::string, SessionKeys> SessionKeysMap;
+
+  /**
+   * The global SSL-library index used for storing the session cache key of a connection in its
+   * SSL instance, for retrieval when new session keys are received.
+   */
+  static int sessionCacheKeyIndex();
+
+  int newSessionKey(SSL* ssl, SSL_SESSION* session);
+  void popSessionKey(SessionKeysMap::iterator it, bool most_recent)
+      EXCLUSIVE_LOCKS_REQUIRED(session_keys_mu_);
   uint16_t parseSigningAlgorithmsForTest(const std::string& sigalgs);
 
   const std::string server_name_indication_;
   const bool allow_renegotiation_;
   const size_t max_session_keys_;
   absl::Mutex session_keys_mu_;
-  std::deque<bssl::UniquePtr<SSL_SESSION>> session_keys_ GUARDED_BY(session_keys_mu_);
-  bool session_keys_single_use_{false};
+  // The session keys are stored per SNI and upstream host address, since servers behind different
+  // addresses often don't share their session ticket keys.
+  SessionKeysMap session_keys_ GUARDED_BY(session_keys_mu_);
+  // The keys of session_keys_, most recently used first.
+  std::list<std::string> session_keys_lru_ GUARDED_BY(session_keys_mu_);
+  // The number of session keys stored for all the upstream hosts, at most max_session_keys_.
+  size_t session_keys_size_ GUARDED_BY(session_keys_mu_){};
 };
 
 class ServerContextImpl : public ContextImpl, public Envoy::Ssl::ServerContext {
 public:
   ServerContextImpl(Stats::Scope& scope, const Envoy::Ssl::ServerContextConfig& config,
-                    const std::vector<std::string>& server_names, TimeSource& time_source);
+                    const std::vector<std::string>& server_names, TimeSource& time_source,
+                    CertificateCache& certificate_cache);
 
 private:
   int alpnSelectCallback(const unsigned char** out, unsigned char* outlen, const unsigned char* in,
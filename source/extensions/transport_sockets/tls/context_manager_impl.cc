@@ -1,18 +1,33 @@
 #include "extensions/transport_sockets/tls/context_manager_impl.h"
 
 #include <functional>
+#include <string>
 
 #include "envoy/stats/scope.h"
 
 #include "common/common/assert.h"
+#include "common/common/fmt.h"
 
 #include "extensions/transport_sockets/tls/context_impl.h"
 
+#include "openssl/sha.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
 namespace Tls {
 
+ContextManagerImpl::ContextManagerImpl(TimeSource& time_source, Stats::Scope& scope,
+                                       bool share_client_contexts)
+    : time_source_(time_source) {
+  if (share_client_contexts) {
+    scope_ = scope.createScope("ssl_context_manager.");
+    shared_client_scope_ = scope_->createScope("upstream.");
+    stats_ = std::make_unique<ContextManagerStats>(
+        ContextManagerStats{ALL_CONTEXT_MANAGER_STATS(POOL_COUNTER(*scope_))});
+  }
+}
+
 ContextManagerImpl::~ContextManagerImpl() {
   removeEmptyContexts();
   ASSERT(contexts_.empty());
@@ -20,6 +35,9 @@ ContextManagerImpl::~ContextManagerImpl() {
 
 void ContextManagerImpl::removeEmptyContexts() {
   contexts_.remove_if([](const std::weak_ptr<Envoy::Ssl::Context>& n) { return n.expired(); });
+  for (auto it = shared_client_contexts_.begin(); it != shared_client_contexts_.end();) {
+    it = it->second.expired() ? shared_client_contexts_.erase(it) : std::next(it);
+  }
 }
 
 Envoy::Ssl::ClientContextSharedPtr
@@ -29,13 +47,94 @@ ContextManagerImpl::createSslClientContext(Stats::Scope& scope,
     return nullptr;
   }
 
+  if (shared_client_scope_ != nullptr) {
+    return createSharedClientContext(config);
+  }
+
   Envoy::Ssl::ClientContextSharedPtr context =
-      std::make_shared<ClientContextImpl>(scope, config, time_source_);
+      std::make_shared<ClientContextImpl>(scope, config, time_source_, certificate_cache_);
+  removeEmptyContexts();
+  contexts_.emplace_back(context);
+  return context;
+}
+
+Envoy::Ssl::ClientContextSharedPtr
+ContextManagerImpl::createSharedClientContext(const Envoy::Ssl::ClientContextConfig& config) {
+  stats_->client_context_requested_.inc();
+  const std::string digest = clientContextDigest(config);
+  std::weak_ptr<Envoy::Ssl::ClientContext>& shared_context = shared_client_contexts_[digest];
+  Envoy::Ssl::ClientContextSharedPtr context = shared_context.lock();
+  if (context != nullptr) {
+    return context;
+  }
+
+  context = std::make_shared<ClientContextImpl>(*shared_client_scope_, config, time_source_,
+                                                certificate_cache_);
+  stats_->client_context_created_.inc();
+  shared_context = context;
   removeEmptyContexts();
   contexts_.emplace_back(context);
   return context;
 }
 
+std::string ContextManagerImpl::clientContextDigest(const Envoy::Ssl::ClientContextConfig& config) {
+  // Every value is hashed with its length, so that different configs never hash the same values.
+  SHA256_CTX ctx;
+  SHA256_Init(&ctx);
+  const auto add = [&ctx](const std::string& value) {
+    const uint64_t length = value.size();
+    SHA256_Update(&ctx, &length, sizeof(length));
+    SHA256_Update(&ctx, value.data(), value.size());
+  };
+  const auto add_list = [&add](const std::vector<std::string>& values) {
+    add(std::to_string(values.size()));
+    for (const std::string& value : values) {
+      add(value);
+    }
+  };
+
+  add(config.alpnProtocols());
+  add(config.cipherSuites());
+  add(config.ecdhCurves());
+  add(std::to_string(config.minProtocolVersion()));
+  add(std::to_string(config.maxProtocolVersion()));
+  add(config.kernelTlsOffload() ? "1" : "0");
+  const auto tls_certificates = config.tlsCertificates();
+  add(std::to_string(tls_certificates.size()));
+  for (const Envoy::Ssl::TlsCertificateConfig& tls_certificate : tls_certificates) {
+    add(tls_certificate.certificateChain());
+    add(tls_certificate.certificateChainPath());
+    add(tls_certificate.privateKey());
+    add(tls_certificate.privateKeyPath());
+    add(tls_certificate.password());
+    add(tls_certificate.passwordPath());
+    // Private key method providers are compared by instance, since they may hold keys or
+    // hardware sessions that their configs only refer to.
+    add(fmt::format("{}", static_cast<const void*>(tls_certificate.privateKeyMethod().get())));
+  }
+  const Envoy::Ssl::CertificateValidationContextConfig* validation_context =
+      config.certificateValidationContext();
+  add(validation_context != nullptr ? "1" : "0");
+  if (validation_context != nullptr) {
+    add(validation_context->caCert());
+    add(validation_context->caCertPath());
+    add(validation_context->certificateRevocationList());
+    add(validation_context->certificateRevocationListPath());
+    add_list(validation_context->verifySubjectAltNameList());
+    add_list(validation_context->verifyCertificateHashList());
+    add_list(validation_context->verifyCertificateSpkiList());
+    add(validation_context->allowExpiredCertificate() ? "1" : "0");
+  }
+  add(config.serverNameIndication());
+  add(config.allowRenegotiation() ? "1" : "0");
+  add(std::to_string(config.maxSessionKeys()));
+  add(config.signingAlgorithmsForTest());
+
+  std::string digest(SHA256_DIGEST_LENGTH, '\0');
+  SHA256_Final(reinterpret_cast<uint8_t*>(&digest[0]), &ctx);
+  return digest;
+}
+
 Envoy::Ssl::ServerContextSharedPtr
 ContextManagerImpl::createSslServerContext(Stats::Scope& scope,
                                            const Envoy::Ssl::ServerContextConfig& config,
@@ -45,7 +144,8 @@ ContextManagerImpl::createSslServerContext(Stats::Scope& scope,
   }
 
   Envoy::Ssl::ServerContextSharedPtr context =
-      std::make_shared<ServerContextImpl>(scope, config, server_names, time_source_);
+      std::make_shared<ServerContextImpl>(scope, config, server_names, time_source_,
+                                          certificate_cache_);
   removeEmptyContexts();
   contexts_.emplace_back(context);
   return context;
@@ -71,6 +171,12 @@ void ContextManagerImpl::iterateContexts(std::function<void(const Envoy::Ssl::Co
   }
 }
 
+Ssl::CertificatePrefetchPtr ContextManagerImpl::prefetchCertificates(
+    const std::vector<const Ssl::TlsCertificateConfig*>& tls_certificates,
+    Thread::ThreadFactory& thread_factory, uint32_t threads) {
+  return certificate_cache_.prefetch(tls_certificates, thread_factory, threads);
+}
+
 } // namespace Tls
 } // namespace TransportSockets
 } // namespace Extensions
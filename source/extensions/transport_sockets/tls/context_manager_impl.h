@@ -2,26 +2,56 @@
 
 #include <functional>
 #include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
 
 #include "envoy/common/time.h"
 #include "envoy/ssl/context_manager.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "extensions/transport_sockets/tls/certificate_cache.h"
+#include "extensions/transport_sockets/tls/private_key/private_key_manager_impl.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
 namespace Tls {
 
+// clang-format off
+#define ALL_CONTEXT_MANAGER_STATS(COUNTER)                                                         \
+  COUNTER(client_context_requested)                                                                \
+  COUNTER(client_context_created)
+// clang-format on
+
+/**
+ * Struct definition for the stats of sharing client contexts. @see stats_macros.h
+ */
+struct ContextManagerStats {
+  ALL_CONTEXT_MANAGER_STATS(GENERATE_COUNTER_STRUCT)
+};
+
 /**
  * The SSL context manager has the following threading model:
  * Contexts can be allocated via any thread (through in practice they are only allocated on the main
  * thread). They can be released from any thread (and in practice are since cluster information can
  * be released from any thread). Context allocation/free is a very uncommon thing so we just do a
  * global lock to protect it all.
+ *
+ * The contexts share the certificates they parse through a CertificateCache, so that contexts with
+ * the same certificate chains, private keys or trusted CAs only parse them once.
  */
 class ContextManagerImpl final : public Envoy::Ssl::ContextManager {
 public:
   ContextManagerImpl(TimeSource& time_source) : time_source_(time_source) {}
+  /**
+   * @param scope supplies the scope of the context manager's stats.
+   * @param share_client_contexts supplies whether client contexts with identical configs are
+   *        shared. The stats of shared contexts are reported in the ssl_context_manager.upstream.
+   *        tree of the scope, since they outlive the scopes of the clusters that requested them.
+   */
+  ContextManagerImpl(TimeSource& time_source, Stats::Scope& scope, bool share_client_contexts);
   ~ContextManagerImpl();
 
   // Ssl::ContextManager
@@ -33,11 +63,35 @@ public:
                          const std::vector<std::string>& server_names) override;
   size_t daysUntilFirstCertExpires() const override;
   void iterateContexts(std::function<void(const Envoy::Ssl::Context&)> callback) override;
+  Ssl::CertificatePrefetchPtr
+  prefetchCertificates(const std::vector<const Ssl::TlsCertificateConfig*>& tls_certificates,
+                       Thread::ThreadFactory& thread_factory, uint32_t threads) override;
+  Ssl::PrivateKeyMethodManager& privateKeyMethodManager() override {
+    return private_key_method_manager_;
+  }
+
+  CertificateCache& certificateCache() { return certificate_cache_; }
+
+  /**
+   * @return std::string a digest of everything that a client context is built from, so that
+   *         contexts with the same digest are interchangeable.
+   */
+  static std::string clientContextDigest(const Envoy::Ssl::ClientContextConfig& config);
 
 private:
   void removeEmptyContexts();
+  Envoy::Ssl::ClientContextSharedPtr createSharedClientContext(
+      const Envoy::Ssl::ClientContextConfig& config);
   TimeSource& time_source_;
+  CertificateCache certificate_cache_;
+  Stats::ScopePtr scope_;
+  Stats::ScopePtr shared_client_scope_;
+  std::unique_ptr<ContextManagerStats> stats_;
+  // Shared client contexts by clientContextDigest(), only when sharing is enabled.
+  std::unordered_map<std::string, std::weak_ptr<Envoy::Ssl::ClientContext>>
+      shared_client_contexts_;
   std::list<std::weak_ptr<Envoy::Ssl::Context>> contexts_;
+  PrivateKeyMethodManagerImpl private_key_method_manager_{};
 };
 
 } // namespace Tls
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "envoy/api/v2/auth/cert.pb.h"
+#include "envoy/ssl/private_key/private_key.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Creates the private key method providers with the registered
+ * PrivateKeyMethodProviderInstanceFactory of their name.
+ */
+class PrivateKeyMethodManagerImpl : public virtual Ssl::PrivateKeyMethodManager {
+public:
+  // Ssl::PrivateKeyMethodManager
+  Ssl::PrivateKeyMethodProviderSharedPtr createPrivateKeyMethodProvider(
+      const envoy::api::v2::auth::PrivateKeyProvider& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context) override;
+};
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -1,7 +1,18 @@
 #include "extensions/transport_sockets/tls/ssl_socket.h"
 
+#include <sys/socket.h>
+
+#ifdef __linux__
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+#endif
+
+#include <cstring>
+
+#include "envoy/event/dispatcher.h"
 #include "envoy/stats/scope.h"
 
+#include "common/api/os_sys_calls_impl.h"
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/hex.h"
@@ -24,6 +35,123 @@ namespace {
 
 constexpr absl::string_view NotReadyReason{"TLS error: Secret is not supplied by SDS"};
 
+// The most plaintext a TLS record carries, so that every SSL_write() fills a record.
+constexpr uint64_t MaxTlsRecordSize = 16384;
+
+#if defined(__linux__) && defined(TLS_TX)
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+
+// Installs the TLS 1.2 AES-GCM transmit keys on the socket. BoringSSL uses the record sequence
+// number as explicit nonce, which is what the kernel expects as IV.
+template <class CryptoInfo>
+bool setKernelTlsTxKeys(int fd, uint16_t cipher_type, const uint8_t* key, const uint8_t* salt,
+                        uint64_t sequence) {
+  CryptoInfo crypto_info{};
+  static_assert(sizeof(crypto_info.iv) == sizeof(sequence), "");
+  static_assert(sizeof(crypto_info.rec_seq) == sizeof(sequence), "");
+  crypto_info.info.version = TLS_1_2_VERSION;
+  crypto_info.info.cipher_type = cipher_type;
+  memcpy(crypto_info.key, key, sizeof(crypto_info.key));
+  memcpy(crypto_info.salt, salt, sizeof(crypto_info.salt));
+  for (size_t i = 0; i < sizeof(sequence); i++) {
+    crypto_info.iv[i] = crypto_info.rec_seq[i] =
+        static_cast<uint8_t>(sequence >> (8 * (sizeof(sequence) - 1 - i)));
+  }
+  return Api::OsSysCallsSingleton::get()
+             .setsockopt(fd, SOL_TLS, TLS_TX, &crypto_info, sizeof(crypto_info))
+             .rc_ == 0;
+}
+
+// Hands the encryption of the records that are written after the handshake over to the kernel.
+// @return true if the kernel encrypts the records that are written to the socket from now on.
+bool enableKernelTlsTx(SSL* ssl, int fd) {
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  if (SSL_version(ssl) != TLS1_2_VERSION || cipher == nullptr) {
+    return false;
+  }
+  uint16_t cipher_type;
+  size_t key_length;
+  switch (SSL_CIPHER_get_cipher_nid(cipher)) {
+  case NID_aes_128_gcm:
+    cipher_type = TLS_CIPHER_AES_GCM_128;
+    key_length = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+    break;
+#ifdef TLS_CIPHER_AES_GCM_256
+  case NID_aes_256_gcm:
+    cipher_type = TLS_CIPHER_AES_GCM_256;
+    key_length = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+    break;
+#endif
+  default:
+    return false;
+  }
+
+  // The key block of AEAD ciphers is the client key, the server key, the client salt and the
+  // server salt (RFC 5246 section 6.3, RFC 5288 section 3).
+  constexpr size_t salt_length = TLS_CIPHER_AES_GCM_128_SALT_SIZE;
+  std::vector<uint8_t> key_block(SSL_get_key_block_len(ssl));
+  if (key_block.size() != 2 * (key_length + salt_length) ||
+      !SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    return false;
+  }
+  const bool server = SSL_is_server(ssl);
+  const uint8_t* key = &key_block[server ? key_length : 0];
+  const uint8_t* salt = &key_block[2 * key_length + (server ? salt_length : 0)];
+
+  if (Api::OsSysCallsSingleton::get()
+          .setsockopt(fd, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls"))
+          .rc_ != 0) {
+    return false;
+  }
+  // The socket keeps working as a plain TCP socket if the keys can't be installed.
+  if (cipher_type == TLS_CIPHER_AES_GCM_128) {
+    return setKernelTlsTxKeys<tls12_crypto_info_aes_gcm_128>(fd, cipher_type, key, salt,
+                                                            SSL_get_write_sequence(ssl));
+  }
+#ifdef TLS_CIPHER_AES_GCM_256
+  return setKernelTlsTxKeys<tls12_crypto_info_aes_gcm_256>(fd, cipher_type, key, salt,
+                                                          SSL_get_write_sequence(ssl));
+#else
+  return false;
+#endif
+}
+
+// Sends a close_notify alert through the kernel, which encrypts it with the installed keys.
+void sendKernelTlsCloseNotify(int fd) {
+  // TLS alert record type, and warning level close_notify alert.
+  constexpr uint8_t alert_record_type = 21;
+  uint8_t alert[] = {1, 0};
+  iovec iov{alert, sizeof(alert)};
+  uint8_t control[CMSG_SPACE(sizeof(alert_record_type))]{};
+  msghdr message{};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(alert_record_type));
+  *CMSG_DATA(cmsg) = alert_record_type;
+  // Ignore the result, like SSL_shutdown() does when there is no room on the socket.
+  ::sendmsg(fd, &message, MSG_NOSIGNAL);
+}
+
+#else
+
+bool enableKernelTlsTx(SSL*, int) { return false; }
+
+void sendKernelTlsCloseNotify(int) { NOT_REACHED_GCOVR_EXCL_LINE; }
+
+#endif
+
 // This SslSocket will be used when SSL secret is not fetched from SDS server.
 class NotReadySslSocket : public Network::TransportSocket {
 public:
@@ -62,6 +190,10 @@ void SslSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& c
 
   BIO* bio = BIO_new_socket(callbacks_->ioHandle().fd(), 0);
   SSL_set_bio(ssl_.get(), bio, bio);
+  ctx_->resumeSession(ssl_.get(), callbacks_->connection().remoteAddress());
+  for (const auto& provider : ctx_->getPrivateKeyMethodProviders()) {
+    provider->registerPrivateKeyMethod(ssl_.get(), *this, callbacks_->connection().dispatcher());
+  }
 }
 
 Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
@@ -126,11 +258,31 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
 
 PostIoAction SslSocket::doHandshake() {
   ASSERT(!handshake_complete_);
+  TimeSource& time_source = callbacks_->connection().dispatcher().timeSource();
+  const MonotonicTime step_start = time_source.monotonicTime();
+  if (!handshake_start_.has_value()) {
+    handshake_start_ = step_start;
+  }
   int rc = SSL_do_handshake(ssl_.get());
+  const MonotonicTime step_end = time_source.monotonicTime();
+  handshake_processing_time_ +=
+      std::chrono::duration_cast<std::chrono::microseconds>(step_end - step_start);
   if (rc == 1) {
     ENVOY_CONN_LOG(debug, "handshake complete", callbacks_->connection());
     handshake_complete_ = true;
-    ctx_->logHandshake(ssl_.get());
+    ctx_->logHandshake(
+        ssl_.get(),
+        std::chrono::duration_cast<std::chrono::microseconds>(step_end - handshake_start_.value()),
+        handshake_processing_time_);
+    if (!SSL_is_server(ssl_.get())) {
+      callbacks_->connection().streamInfo().upstreamTiming().onUpstreamHandshakeComplete(
+          time_source);
+    }
+    if (ctx_->kernelTlsOffload() && enableKernelTlsTx(ssl_.get(), callbacks_->ioHandle().fd())) {
+      ENVOY_CONN_LOG(debug, "kernel TLS transmit offload enabled", callbacks_->connection());
+      ctx_->stats().kernel_tls_tx_offload_.inc();
+      kernel_tls_tx_ = true;
+    }
     callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 
     // It's possible that we closed during the handshake callback.
@@ -144,6 +296,9 @@ PostIoAction SslSocket::doHandshake() {
     case SSL_ERROR_WANT_READ:
     case SSL_ERROR_WANT_WRITE:
       return PostIoAction::KeepOpen;
+    case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
+      // The handshake is resumed by onPrivateKeyMethodComplete().
+      return PostIoAction::KeepOpen;
     default:
       drainErrorQueue();
       return PostIoAction::Close;
@@ -151,6 +306,18 @@ PostIoAction SslSocket::doHandshake() {
   }
 }
 
+void SslSocket::onPrivateKeyMethodComplete() {
+  if (handshake_complete_) {
+    return;
+  }
+  // Resume the handshake, whose next flight may now be written.
+  PostIoAction action = doHandshake();
+  if (action == PostIoAction::Close) {
+    ENVOY_CONN_LOG(debug, "async handshake completion error", callbacks_->connection());
+    callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
+  }
+}
+
 void SslSocket::drainErrorQueue() {
   bool saw_error = false;
   bool saw_counted_error = false;
@@ -187,14 +354,21 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  if (kernel_tls_tx_) {
+    return doKernelTlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
     bytes_to_retry_ = 0;
   } else {
-    bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+    bytes_to_write = std::min(write_buffer.length(), MaxTlsRecordSize);
   }
 
+  // Records that span several slices are coalesced here rather than by linearizing the buffer,
+  // which would allocate a new slice and rewrite the buffer for every record.
+  uint8_t record[MaxTlsRecordSize];
   uint64_t total_bytes_written = 0;
   while (bytes_to_write > 0) {
     // TODO(mattklein123): As it relates to our fairness efforts, we might want to limit the number
@@ -202,15 +376,24 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
 
     // SSL_write() requires that if a previous call returns SSL_ERROR_WANT_WRITE, we need to call
     // it again with the same parameters. This is done by tracking last write size, but not write
-    // data, since linearize() will return the same undrained data anyway.
+    // data, since the undrained data is the same whether it's written in place or coalesced, and
+    // BoringSSL accepts a retry from a different address.
     ASSERT(bytes_to_write <= write_buffer.length());
-    int rc = SSL_write(ssl_.get(), write_buffer.linearize(bytes_to_write), bytes_to_write);
+    Buffer::RawSlice slice;
+    const void* data;
+    if (write_buffer.getRawSlices(&slice, 1) == 1 && slice.len_ >= bytes_to_write) {
+      data = slice.mem_;
+    } else {
+      write_buffer.copyOut(0, bytes_to_write, record);
+      data = record;
+    }
+    int rc = SSL_write(ssl_.get(), data, bytes_to_write);
     ENVOY_CONN_LOG(trace, "ssl write returns: {}", callbacks_->connection(), rc);
     if (rc > 0) {
       ASSERT(rc == static_cast<int>(bytes_to_write));
       total_bytes_written += rc;
       write_buffer.drain(rc);
-      bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+      bytes_to_write = std::min(write_buffer.length(), MaxTlsRecordSize);
     } else {
       int err = SSL_get_error(ssl_.get(), rc);
       switch (err) {
@@ -235,11 +418,43 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  // The kernel encrypts whatever is written to the socket, so the plaintext is written like
+  // RawBufferSocket does.
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    Api::IoCallUint64Result result = write_buffer.write(callbacks_->ioHandle());
+    if (!result.ok()) {
+      ENVOY_CONN_LOG(trace, "kernel tls write error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        break;
+      }
+      return {PostIoAction::Close, total_bytes_written, false};
+    }
+    ENVOY_CONN_LOG(trace, "kernel tls write returns: {}", callbacks_->connection(), result.rc_);
+    total_bytes_written += result.rc_;
+  }
+
+  if (write_buffer.length() == 0 && end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
 void SslSocket::onConnected() { ASSERT(!handshake_complete_); }
 
 void SslSocket::shutdownSsl() {
   ASSERT(handshake_complete_);
   if (!shutdown_sent_ && callbacks_->connection().state() != Network::Connection::State::Closed) {
+    if (kernel_tls_tx_) {
+      // BoringSSL no longer knows the sequence number of the records written by the kernel.
+      sendKernelTlsCloseNotify(callbacks_->ioHandle().fd());
+      ENVOY_CONN_LOG(debug, "SSL shutdown through the kernel", callbacks_->connection());
+      shutdown_sent_ = true;
+      return;
+    }
     int rc = SSL_shutdown(ssl_.get());
     ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
     drainErrorQueue();
@@ -356,6 +571,11 @@ std::vector<std::string> SslSocket::dnsSansPeerCertificate() const {
 }
 
 void SslSocket::closeSocket(Network::ConnectionEvent) {
+  // Pending private key operations must not resume the handshake of a closed connection.
+  for (const auto& provider : ctx_->getPrivateKeyMethodProviders()) {
+    provider->unregisterPrivateKeyMethod(ssl_.get());
+  }
+
   // Attempt to send a shutdown before closing the socket. It's possible this won't go out if
   // there is no room on the socket. We can extend the state machine to handle this at some point
   // if needed.
@@ -465,8 +685,13 @@ ServerSslSocketFactory::ServerSslSocketFactory(Envoy::Ssl::ServerContextConfigPt
                                                Stats::Scope& stats_scope,
                                                const std::vector<std::string>& server_names)
     : manager_(manager), stats_scope_(stats_scope), stats_(generateStats("server", stats_scope)),
-      config_(std::move(config)), server_names_(server_names),
-      ssl_ctx_(manager_.createSslServerContext(stats_scope_, *config_, server_names_)) {
+      config_(std::move(config)),
+      owned_context_scope_(config_->statPrefix().empty()
+                               ? nullptr
+                               : stats_scope_.createScope(config_->statPrefix() + ".")),
+      context_scope_(owned_context_scope_ != nullptr ? *owned_context_scope_ : stats_scope_),
+      server_names_(server_names),
+      ssl_ctx_(manager_.createSslServerContext(context_scope_, *config_, server_names_)) {
   config_->setSecretUpdateCallback([this]() { onAddOrUpdateSecret(); });
 }
 
@@ -495,7 +720,7 @@ void ServerSslSocketFactory::onAddOrUpdateSecret() {
   ENVOY_LOG(debug, "Secret is updated.");
   {
     absl::WriterMutexLock l(&ssl_ctx_mu_);
-    ssl_ctx_ = manager_.createSslServerContext(stats_scope_, *config_, server_names_);
+    ssl_ctx_ = manager_.createSslServerContext(context_scope_, *config_, server_names_);
   }
   stats_.ssl_context_update_by_sds_.inc();
 }
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <string>
 
+#include "envoy/common/time.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/secret/secret_callbacks.h"
+#include "envoy/ssl/private_key/private_key_callbacks.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 
@@ -41,6 +44,7 @@ enum class InitialState { Client, Server };
 
 class SslSocket : public Network::TransportSocket,
                   public Envoy::Ssl::ConnectionInfo,
+                  public Envoy::Ssl::PrivateKeyConnectionCallbacks,
                   protected Logger::Loggable<Logger::Id::connection> {
 public:
   SslSocket(Envoy::Ssl::ContextSharedPtr ctx, InitialState state,
@@ -72,10 +76,14 @@ public:
   void onConnected() override;
   const Ssl::ConnectionInfo* ssl() const override { return this; }
 
+  // Ssl::PrivateKeyConnectionCallbacks
+  void onPrivateKeyMethodComplete() override;
+
   SSL* rawSslForTest() const { return ssl_.get(); }
 
 private:
   Network::PostIoAction doHandshake();
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
   void drainErrorQueue();
   void shutdownSsl();
 
@@ -83,7 +91,12 @@ private:
   ContextImplSharedPtr ctx_;
   bssl::UniquePtr<SSL> ssl_;
   bool handshake_complete_{};
+  // When the first handshake step ran, and the time spent in the handshake steps so far.
+  absl::optional<MonotonicTime> handshake_start_;
+  std::chrono::microseconds handshake_processing_time_{};
   bool shutdown_sent_{};
+  // True once the kernel encrypts the records written to the socket.
+  bool kernel_tls_tx_{};
   uint64_t bytes_to_retry_{};
   std::string failure_reason_;
   mutable std::string cached_sha_256_peer_certificate_digest_;
@@ -134,6 +147,9 @@ private:
   Stats::Scope& stats_scope_;
   SslSocketFactoryStats stats_;
   Envoy::Ssl::ServerContextConfigPtr config_;
+  // The scope of the stats of the contexts, a child of stats_scope_ if the config has a prefix.
+  Stats::ScopePtr owned_context_scope_;
+  Stats::Scope& context_scope_;
   const std::vector<std::string> server_names_;
   mutable absl::Mutex ssl_ctx_mu_;
   Envoy::Ssl::ServerContextSharedPtr ssl_ctx_ GUARDED_BY(ssl_ctx_mu_);
@@ -14,9 +14,9 @@ ClusterManagerPtr ValidationClusterManagerFactory::clusterManagerFromProto(
 
 CdsApiPtr
 ValidationClusterManagerFactory::createCds(const envoy::api::v2::core::ConfigSource& cds_config,
-                                           ClusterManager& cm) {
+                                           uint32_t config_threads, ClusterManager& cm) {
   // Create the CdsApiImpl...
-  ProdClusterManagerFactory::createCds(cds_config, cm);
+  ProdClusterManagerFactory::createCds(cds_config, config_threads, cm);
   // ... and then throw it away, so that we don't actually connect to it.
   return nullptr;
 }
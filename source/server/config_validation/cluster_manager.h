@@ -39,7 +39,7 @@ public:
   // Delegates to ProdClusterManagerFactory::createCds, but discards the result and returns nullptr
   // unconditionally.
   CdsApiPtr createCds(const envoy::api::v2::core::ConfigSource& cds_config,
-                      ClusterManager& cm) override;
+                      uint32_t config_threads, ClusterManager& cm) override;
 
 private:
   Event::TimeSystem& time_system_;
@@ -46,8 +46,8 @@ ValidationInstance::ValidationInstance(const Options& options, Event::TimeSystem
       api_(new Api::ValidationImpl(thread_factory, store, time_system, file_system)),
       dispatcher_(api_->allocateDispatcher()),
       singleton_manager_(new Singleton::ManagerImpl(api_->threadFactory().currentThreadId())),
-      access_log_manager_(options.fileFlushIntervalMsec(), *api_, *dispatcher_, access_log_lock,
-                          store),
+      access_log_manager_(options.fileFlushIntervalMsec(), options.fileMaxBufferedBytes(), *api_,
+                          *dispatcher_, access_log_lock, store),
       mutex_tracer_(nullptr), time_system_(time_system) {
   try {
     initialize(options, local_address, component_factory);
@@ -86,7 +86,7 @@ void ValidationInstance::initialize(const Options& options,
   Configuration::InitialImpl initial_config(bootstrap);
   overload_manager_ = std::make_unique<OverloadManagerImpl>(dispatcher(), stats(), threadLocal(),
                                                             bootstrap.overload_manager(), *api_);
-  listener_manager_ = std::make_unique<ListenerManagerImpl>(*this, *this, *this);
+  listener_manager_ = std::make_unique<ListenerManagerImpl>(*this, *this, *this, false);
   thread_local_.registerThread(*dispatcher_, true);
   runtime_loader_ = component_factory.createRuntime(*this, initial_config);
   secret_manager_ = std::make_unique<Secret::SecretManagerImpl>();
@@ -43,6 +43,16 @@ bool FilterChainUtility::buildFilterChain(
   return true;
 }
 
+bool FilterChainUtility::buildUdpFilterChain(
+    Network::UdpListenerFilterManager& filter_manager, Network::UdpReadFilterCallbacks& callbacks,
+    const std::vector<Network::UdpListenerFilterFactoryCb>& factories) {
+  for (const Network::UdpListenerFilterFactoryCb& factory : factories) {
+    factory(filter_manager, callbacks);
+  }
+
+  return !factories.empty();
+}
+
 void MainImpl::initialize(const envoy::config::bootstrap::v2::Bootstrap& bootstrap,
                           Instance& server,
                           Upstream::ClusterManagerFactory& cluster_manager_factory) {
@@ -65,6 +75,10 @@ void MainImpl::initialize(const envoy::config::bootstrap::v2::Bootstrap& bootstr
 
   stats_flush_interval_ =
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(bootstrap, stats_flush_interval, 5000));
+  if (bootstrap.has_histogram_merge_interval()) {
+    histogram_merge_interval_ =
+        std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(bootstrap, histogram_merge_interval));
+  }
 
   const auto& watchdog = bootstrap.watchdog();
   watchdog_miss_timeout_ =
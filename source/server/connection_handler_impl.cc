@@ -1,5 +1,7 @@
 #include "server/connection_handler_impl.h"
 
+#include <algorithm>
+
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/timer.h"
 #include "envoy/network/filter.h"
@@ -18,6 +20,20 @@ ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Disp
     : logger_(logger), dispatcher_(dispatcher), disable_listeners_(false) {}
 
 void ConnectionHandlerImpl::addListener(Network::ListenerConfig& config) {
+  if (config.socket().socketType() == Network::Address::SocketType::Datagram) {
+    addUdpListener(config);
+    return;
+  }
+
+  for (auto& listener : listeners_) {
+    if (listener.second->listener_tag_ == config.listenerTag()) {
+      // A filter chain only update of a listener that is already here. The socket, connection
+      // balancer and stats are shared with the previous configuration.
+      listener.second->config_ = &config;
+      return;
+    }
+  }
+
   ActiveListenerPtr l(new ActiveListener(*this, config));
   if (disable_listeners_) {
     l->listener_->disable();
@@ -25,6 +41,21 @@ void ConnectionHandlerImpl::addListener(Network::ListenerConfig& config) {
   listeners_.emplace_back(config.socket().localAddress(), std::move(l));
 }
 
+void ConnectionHandlerImpl::addUdpListener(Network::ListenerConfig& config) {
+  for (auto& listener : udp_listeners_) {
+    if (listener->listener_tag_ == config.listenerTag()) {
+      listener->config_ = &config;
+      return;
+    }
+  }
+
+  ActiveUdpListenerPtr l(new ActiveUdpListener(*this, config));
+  if (disable_listeners_) {
+    l->udp_listener_->disable();
+  }
+  udp_listeners_.emplace_back(std::move(l));
+}
+
 void ConnectionHandlerImpl::removeListeners(uint64_t listener_tag) {
   for (auto listener = listeners_.begin(); listener != listeners_.end();) {
     if (listener->second->listener_tag_ == listener_tag) {
@@ -33,19 +64,55 @@ void ConnectionHandlerImpl::removeListeners(uint64_t listener_tag) {
       ++listener;
     }
   }
+  for (auto listener = udp_listeners_.begin(); listener != udp_listeners_.end();) {
+    if ((*listener)->listener_tag_ == listener_tag) {
+      (*listener)->stopListener();
+      listener = udp_listeners_.erase(listener);
+    } else {
+      ++listener;
+    }
+  }
+}
+
+void ConnectionHandlerImpl::removeFilterChains(
+    uint64_t listener_tag, const std::list<const Network::FilterChain*>& filter_chains) {
+  for (auto& listener : listeners_) {
+    if (listener.second->listener_tag_ != listener_tag) {
+      continue;
+    }
+    auto& connections = listener.second->connections_;
+    for (auto it = connections.begin(); it != connections.end();) {
+      // Closing the connection removes it from the list, so advance first.
+      ActiveConnection& connection = **it;
+      ++it;
+      if (std::find(filter_chains.begin(), filter_chains.end(), connection.filter_chain_) !=
+          filter_chains.end()) {
+        connection.connection_->close(Network::ConnectionCloseType::NoFlush);
+      }
+    }
+  }
+  dispatcher_.clearDeferredDeleteList();
 }
 
 void ConnectionHandlerImpl::stopListeners(uint64_t listener_tag) {
   for (auto& listener : listeners_) {
     if (listener.second->listener_tag_ == listener_tag) {
-      listener.second->listener_.reset();
+      listener.second->stopListener();
+    }
+  }
+  for (auto& listener : udp_listeners_) {
+    if (listener->listener_tag_ == listener_tag) {
+      listener->stopListener();
     }
   }
 }
 
 void ConnectionHandlerImpl::stopListeners() {
   for (auto& listener : listeners_) {
-    listener.second->listener_.reset();
+    listener.second->stopListener();
+  }
+  for (auto& listener : udp_listeners_) {
+    listener->stopListener();
   }
 }
 
@@ -54,6 +121,11 @@ void ConnectionHandlerImpl::disableListeners() {
   for (auto& listener : listeners_) {
     listener.second->listener_->disable();
   }
+  for (auto& listener : udp_listeners_) {
+    if (listener->udp_listener_ != nullptr) {
+      listener->udp_listener_->disable();
+    }
+  }
 }
 
 void ConnectionHandlerImpl::enableListeners() {
@@ -61,6 +133,11 @@ void ConnectionHandlerImpl::enableListeners() {
   for (auto& listener : listeners_) {
     listener.second->listener_->enable();
   }
+  for (auto& listener : udp_listeners_) {
+    if (listener->udp_listener_ != nullptr) {
+      listener->udp_listener_->enable();
+    }
+  }
 }
 
 void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& connection) {
@@ -70,6 +147,8 @@ void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& c
   parent_.dispatcher_.deferredDelete(std::move(removed));
   ASSERT(parent_.num_connections_ > 0);
   parent_.num_connections_--;
+  ASSERT(num_listener_connections_ > 0);
+  num_listener_connections_--;
 }
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
@@ -77,7 +156,8 @@ ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& par
     : ActiveListener(
           parent,
           parent.dispatcher_.createListener(config.socket(), *this, config.bindToPort(),
-                                            config.handOffRestoredDestinationConnections()),
+                                            config.handOffRestoredDestinationConnections(),
+                                            config.maxConnectionsToAcceptPerSocketEvent()),
           config) {}
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
@@ -86,9 +166,16 @@ ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& par
     : parent_(parent), listener_(std::move(listener)),
       stats_(generateStats(config.listenerScope())),
       listener_filters_timeout_(config.listenerFiltersTimeout()),
-      listener_tag_(config.listenerTag()), config_(config) {}
+      listener_tag_(config.listenerTag()), config_(&config) {
+  if (listener_ != nullptr) {
+    config_->connectionBalancer().registerHandler(*this);
+  }
+}
 
 ConnectionHandlerImpl::ActiveListener::~ActiveListener() {
+  // Make sure that no more sockets are handed over before tearing down.
+  stopListener();
+
   // Purge sockets that have not progressed to connections. This should only happen when
   // a listener filter stops iteration and never resumes.
   while (!sockets_.empty()) {
@@ -103,6 +190,13 @@ ConnectionHandlerImpl::ActiveListener::~ActiveListener() {
   parent_.dispatcher_.clearDeferredDeleteList();
 }
 
+void ConnectionHandlerImpl::ActiveListener::stopListener() {
+  if (listener_ != nullptr) {
+    config_->connectionBalancer().unregisterHandler(*this);
+    listener_.reset();
+  }
+}
+
 Network::Listener*
 ConnectionHandlerImpl::findListenerByAddress(const Network::Address::Instance& address) {
   ActiveListener* listener = findActiveListenerByAddress(address);
@@ -188,8 +282,8 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
       // Hands off connections redirected by iptables to the listener associated with the
       // original destination address. Pass 'hand_off_restored_destination_connections' as false to
       // prevent further redirection.
-      new_listener->onAccept(std::move(socket_),
-                             false /* hand_off_restored_destination_connections */);
+      new_listener->onAcceptWorker(std::move(socket_),
+                                   false /* hand_off_restored_destination_connections */);
     } else {
       // Set default transport protocol if none of the listener filters did it.
       if (socket_->detectedTransportProtocol().empty()) {
@@ -209,11 +303,48 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
 
 void ConnectionHandlerImpl::ActiveListener::onAccept(
     Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections) {
+  if (config_->connectionBalancer().balance(*this, socket)) {
+    return;
+  }
+  onAcceptWorker(std::move(socket), hand_off_restored_destination_connections);
+}
+
+void ConnectionHandlerImpl::ActiveListener::onAcceptBatchComplete(
+    std::chrono::microseconds duration, bool limit_reached) {
+  stats_.downstream_cx_accept_latency_us_.recordValue(duration.count());
+  if (limit_reached) {
+    stats_.downstream_cx_accept_backlog_overflow_.inc();
+  }
+}
+
+void ConnectionHandlerImpl::ActiveListener::post(Network::ConnectionSocketPtr&& socket) {
+  // Posted callbacks must be copyable, so the socket is moved into a shared holder.
+  auto socket_to_rebalance = std::make_shared<Network::ConnectionSocketPtr>(std::move(socket));
+  ConnectionHandlerImpl& parent = parent_;
+  const uint64_t listener_tag = listener_tag_;
+  parent_.dispatcher_.post([&parent, listener_tag, socket_to_rebalance]() -> void {
+    // The listener may have been removed while the socket was in flight, in which case the socket
+    // is closed when the holder goes away.
+    for (auto& listener : parent.listeners_) {
+      if (listener.second->listener_tag_ == listener_tag) {
+        ASSERT(listener.second->num_listener_connections_ > 0);
+        listener.second->num_listener_connections_--;
+        listener.second->onAcceptWorker(
+            std::move(*socket_to_rebalance),
+            listener.second->config_->handOffRestoredDestinationConnections());
+        return;
+      }
+    }
+  });
+}
+
+void ConnectionHandlerImpl::ActiveListener::onAcceptWorker(
+    Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections) {
   auto active_socket = std::make_unique<ActiveSocket>(*this, std::move(socket),
                                                       hand_off_restored_destination_connections);
 
   // Create and run the filters
-  config_.filterChainFactory().createListenerFilterChain(*active_socket);
+  config_->filterChainFactory().createListenerFilterChain(*active_socket);
   active_socket->continueFilterChain(true);
 
   // Move active_socket to the sockets_ list if filter iteration needs to continue later.
@@ -226,7 +357,7 @@ void ConnectionHandlerImpl::ActiveListener::onAccept(
 
 void ConnectionHandlerImpl::ActiveListener::newConnection(Network::ConnectionSocketPtr&& socket) {
   // Find matching filter chain.
-  const auto filter_chain = config_.filterChainManager().findFilterChain(*socket);
+  const auto filter_chain = config_->filterChainManager().findFilterChain(*socket);
   if (filter_chain == nullptr) {
     ENVOY_LOG_TO_LOGGER(parent_.logger_, debug,
                         "closing connection: no matching filter chain found");
@@ -238,9 +369,9 @@ void ConnectionHandlerImpl::ActiveListener::newConnection(Network::ConnectionSoc
   auto transport_socket = filter_chain->transportSocketFactory().createTransportSocket(nullptr);
   Network::ConnectionPtr new_connection =
       parent_.dispatcher_.createServerConnection(std::move(socket), std::move(transport_socket));
-  new_connection->setBufferLimits(config_.perConnectionBufferLimitBytes());
+  new_connection->setBufferLimits(config_->perConnectionBufferLimitBytes());
 
-  const bool empty_filter_chain = !config_.filterChainFactory().createNetworkFilterChain(
+  const bool empty_filter_chain = !config_->filterChainFactory().createNetworkFilterChain(
       *new_connection, filter_chain->networkFilterFactories());
   if (empty_filter_chain) {
     ENVOY_CONN_LOG_TO_LOGGER(parent_.logger_, debug, "closing connection: no filters",
@@ -249,26 +380,32 @@ void ConnectionHandlerImpl::ActiveListener::newConnection(Network::ConnectionSoc
     return;
   }
 
-  onNewConnection(std::move(new_connection));
+  addConnection(std::move(new_connection), filter_chain);
 }
 
 void ConnectionHandlerImpl::ActiveListener::onNewConnection(
     Network::ConnectionPtr&& new_connection) {
+  addConnection(std::move(new_connection), nullptr);
+}
+
+void ConnectionHandlerImpl::ActiveListener::addConnection(
+    Network::ConnectionPtr&& new_connection, const Network::FilterChain* filter_chain) {
   ENVOY_CONN_LOG_TO_LOGGER(parent_.logger_, debug, "new connection", *new_connection);
 
   // If the connection is already closed, we can just let this connection immediately die.
   if (new_connection->state() != Network::Connection::State::Closed) {
-    ActiveConnectionPtr active_connection(
-        new ActiveConnection(*this, std::move(new_connection), parent_.dispatcher_.timeSource()));
+    ActiveConnectionPtr active_connection(new ActiveConnection(
+        *this, std::move(new_connection), filter_chain, parent_.dispatcher_.timeSource()));
     active_connection->moveIntoList(std::move(active_connection), connections_);
     parent_.num_connections_++;
+    num_listener_connections_++;
   }
 }
 
-ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listener,
-                                                          Network::ConnectionPtr&& new_connection,
-                                                          TimeSource& time_source)
-    : listener_(listener), connection_(std::move(new_connection)),
+ConnectionHandlerImpl::ActiveConnection::ActiveConnection(
+    ActiveListener& listener, Network::ConnectionPtr&& new_connection,
+    const Network::FilterChain* filter_chain, TimeSource& time_source)
+    : listener_(listener), connection_(std::move(new_connection)), filter_chain_(filter_chain),
       conn_length_(new Stats::Timespan(listener_.stats_.downstream_cx_length_ms_, time_source)) {
   // We just universally set no delay on connections. Theoretically we might at some point want
   // to make this configurable.
@@ -284,6 +421,46 @@ ConnectionHandlerImpl::ActiveConnection::~ActiveConnection() {
   conn_length_->complete();
 }
 
+ConnectionHandlerImpl::ActiveUdpListener::ActiveUdpListener(ConnectionHandlerImpl& parent,
+                                                            Network::ListenerConfig& config)
+    : parent_(parent), udp_listener_(parent.dispatcher_.createUdpListener(config.socket(), *this)),
+      listener_tag_(config.listenerTag()), config_(&config) {
+  if (!config_->filterChainFactory().createUdpListenerFilterChain(*this, *this)) {
+    ENVOY_LOG_TO_LOGGER(parent_.logger_, warn,
+                        "UDP listener {} has no listener filter, datagrams are dropped",
+                        config_->name());
+  }
+}
+
+void ConnectionHandlerImpl::ActiveUdpListener::onData(Network::UdpData& data) {
+  if (read_filter_ != nullptr) {
+    read_filter_->onData(data);
+  }
+}
+
+void ConnectionHandlerImpl::ActiveUdpListener::onReceiveBatchComplete(uint32_t datagrams) {
+  if (read_filter_ != nullptr) {
+    read_filter_->onReceiveBatchComplete(datagrams);
+  }
+}
+
+void ConnectionHandlerImpl::ActiveUdpListener::onError(
+    const Network::UdpListenerCallbacks::ErrorCode&, int error_number) {
+  ENVOY_LOG_TO_LOGGER(parent_.logger_, debug, "UDP listener {} receive error: {}",
+                      config_->name(), error_number);
+}
+
+void ConnectionHandlerImpl::ActiveUdpListener::addReadFilter(
+    Network::UdpListenerReadFilterPtr&& filter) {
+  ASSERT(read_filter_ == nullptr, "a UDP listener has a single read filter");
+  read_filter_ = std::move(filter);
+}
+
+void ConnectionHandlerImpl::ActiveUdpListener::stopListener() {
+  read_filter_.reset();
+  udp_listener_.reset();
+}
+
 ListenerStats ConnectionHandlerImpl::generateStats(Stats::Scope& scope) {
   return {ALL_LISTENER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
@@ -8,6 +8,7 @@
 #include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
@@ -30,6 +31,8 @@ namespace Server {
   COUNTER  (downstream_cx_destroy)                                                                 \
   GAUGE    (downstream_cx_active)                                                                  \
   HISTOGRAM(downstream_cx_length_ms)                                                               \
+  HISTOGRAM(downstream_cx_accept_latency_us)                                                       \
+  COUNTER  (downstream_cx_accept_backlog_overflow)                                                 \
   COUNTER  (downstream_pre_cx_timeout)                                                             \
   GAUGE    (downstream_pre_cx_active)                                                              \
   COUNTER  (no_filter_chain_match)
@@ -54,6 +57,8 @@ public:
   uint64_t numConnections() override { return num_connections_; }
   void addListener(Network::ListenerConfig& config) override;
   void removeListeners(uint64_t listener_tag) override;
+  void removeFilterChains(uint64_t listener_tag,
+                          const std::list<const Network::FilterChain*>& filter_chains) override;
   void stopListeners(uint64_t listener_tag) override;
   void stopListeners() override;
   void disableListeners() override;
@@ -73,7 +78,8 @@ private:
   /**
    * Wrapper for an active listener owned by this handler.
    */
-  struct ActiveListener : public Network::ListenerCallbacks {
+  struct ActiveListener : public Network::ListenerCallbacks,
+                          public Network::BalancedConnectionHandler {
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerConfig& config);
 
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerPtr&& listener,
@@ -85,6 +91,25 @@ private:
     void onAccept(Network::ConnectionSocketPtr&& socket,
                   bool hand_off_restored_destination_connections) override;
     void onNewConnection(Network::ConnectionPtr&& new_connection) override;
+    void onAcceptBatchComplete(std::chrono::microseconds duration, bool limit_reached) override;
+
+    // Network::BalancedConnectionHandler
+    uint64_t numConnections() const override { return num_listener_connections_; }
+    void incNumConnections() override { num_listener_connections_++; }
+    void post(Network::ConnectionSocketPtr&& socket) override;
+
+    /**
+     * Run the listener filters on a socket that is owned by this worker, either because it was
+     * accepted here or because the connection balancer handed it over.
+     */
+    void onAcceptWorker(Network::ConnectionSocketPtr&& socket,
+                        bool hand_off_restored_destination_connections);
+
+    /**
+     * Stop accepting new connections. The connection balancer no longer hands sockets to this
+     * listener either.
+     */
+    void stopListener();
 
     /**
      * Remove and destroy an active connection.
@@ -97,18 +122,70 @@ private:
      */
     void newConnection(Network::ConnectionSocketPtr&& socket);
 
+    /**
+     * Take ownership of a new connection.
+     * @param new_connection supplies the connection.
+     * @param filter_chain supplies the filter chain the connection was created from, if any.
+     */
+    void addConnection(Network::ConnectionPtr&& new_connection,
+                       const Network::FilterChain* filter_chain);
+
     ConnectionHandlerImpl& parent_;
     Network::ListenerPtr listener_;
     ListenerStats stats_;
     std::list<ActiveSocketPtr> sockets_;
     std::list<ActiveConnectionPtr> connections_;
+    // The connections of this listener on this worker plus sockets handed over by the connection
+    // balancer that have not been processed yet. Read by the balancer on other workers.
+    std::atomic<uint64_t> num_listener_connections_{};
     const std::chrono::milliseconds listener_filters_timeout_;
     const uint64_t listener_tag_;
-    Network::ListenerConfig& config_;
+    // Replaced by updates that only change filter chains.
+    Network::ListenerConfig* config_;
   };
 
   typedef std::unique_ptr<ActiveListener> ActiveListenerPtr;
 
+  /**
+   * Wrapper for an active UDP listener owned by this handler. The datagrams received by the
+   * listener are handed to its read filter.
+   */
+  struct ActiveUdpListener : public Network::UdpListenerCallbacks,
+                             public Network::UdpListenerFilterManager,
+                             public Network::UdpReadFilterCallbacks {
+    ActiveUdpListener(ConnectionHandlerImpl& parent, Network::ListenerConfig& config);
+
+    // Network::UdpListenerCallbacks
+    void onData(Network::UdpData& data) override;
+    void onReceiveBatchComplete(uint32_t datagrams) override;
+    void onWriteReady(const Network::Socket&) override {}
+    void onError(const Network::UdpListenerCallbacks::ErrorCode& error_code,
+                 int error_number) override;
+
+    // Network::UdpListenerFilterManager
+    void addReadFilter(Network::UdpListenerReadFilterPtr&& filter) override;
+
+    // Network::UdpReadFilterCallbacks
+    Network::UdpListener& udpListener() override { return *udp_listener_; }
+
+    /**
+     * Stop receiving datagrams. The read filter is destroyed first, since it may send datagrams
+     * from the listener's socket.
+     */
+    void stopListener();
+
+    ConnectionHandlerImpl& parent_;
+    Network::UdpListenerPtr udp_listener_;
+    Network::UdpListenerReadFilterPtr read_filter_;
+    const uint64_t listener_tag_;
+    // Replaced by updates that only change filter chains.
+    Network::ListenerConfig* config_;
+  };
+
+  typedef std::unique_ptr<ActiveUdpListener> ActiveUdpListenerPtr;
+
+  void addUdpListener(Network::ListenerConfig& config);
+
   /**
    * Wrapper for an active connection owned by this handler.
    */
@@ -116,7 +193,7 @@ private:
                             public Event::DeferredDeletable,
                             public Network::ConnectionCallbacks {
     ActiveConnection(ActiveListener& listener, Network::ConnectionPtr&& new_connection,
-                     TimeSource& time_system);
+                     const Network::FilterChain* filter_chain, TimeSource& time_system);
     ~ActiveConnection();
 
     // Network::ConnectionCallbacks
@@ -132,6 +209,7 @@ private:
 
     ActiveListener& listener_;
     Network::ConnectionPtr connection_;
+    const Network::FilterChain* const filter_chain_;
     Stats::TimespanPtr conn_length_;
   };
 
@@ -181,6 +259,7 @@ private:
   spdlog::logger& logger_;
   Event::Dispatcher& dispatcher_;
   std::list<std::pair<Network::Address::InstanceConstSharedPtr, ActiveListenerPtr>> listeners_;
+  std::list<ActiveUdpListenerPtr> udp_listeners_;
   std::atomic<uint64_t> num_connections_{};
   bool disable_listeners_;
 };
@@ -15,7 +15,12 @@ namespace Envoy {
 namespace Server {
 
 DrainManagerImpl::DrainManagerImpl(Instance& server, envoy::api::v2::Listener::DrainType drain_type)
-    : server_(server), drain_type_(drain_type) {}
+    : server_(server), drain_type_(drain_type),
+      drain_closes_per_second_(static_cast<uint64_t>(server.options().drainRatePerWorker()) *
+                               server.options().concurrency()),
+      drain_close_counter_(server.stats().counter("server.drain_close")),
+      drain_close_rate_limited_counter_(
+          server.stats().counter("server.drain_close_rate_limited")) {}
 
 bool DrainManagerImpl::drainClose() const {
   // If we are actively health check failed and the drain type is default, always drain close.
@@ -33,14 +38,38 @@ bool DrainManagerImpl::drainClose() const {
   }
 
   // We use the tick time as in increasing chance that we shutdown connections.
-  return static_cast<uint64_t>(drain_time_completed_.load()) >
-         (server_.random().random() % server_.options().drainTime().count());
+  if (static_cast<uint64_t>(drain_time_completed_.load()) <=
+      (server_.random().random() % server_.options().drainTime().count())) {
+    return false;
+  }
+  if (!takeDrainCloseToken()) {
+    drain_close_rate_limited_counter_.inc();
+    return false;
+  }
+  drain_close_counter_.inc();
+  return true;
+}
+
+bool DrainManagerImpl::takeDrainCloseToken() const {
+  if (drain_closes_per_second_ == 0) {
+    return true;
+  }
+  uint64_t tokens = drain_close_tokens_.load();
+  do {
+    if (tokens == 0) {
+      return false;
+    }
+  } while (!drain_close_tokens_.compare_exchange_weak(tokens, tokens - 1));
+  return true;
 }
 
 void DrainManagerImpl::drainSequenceTick() {
   ENVOY_LOG(trace, "drain tick #{}", drain_time_completed_.load());
   ASSERT(drain_time_completed_.load() < server_.options().drainTime().count());
   ++drain_time_completed_;
+  // The unused drain closes of the previous second aren't carried over, so that the closes are
+  // spread over the drain time instead of bursting after a quiet second.
+  drain_close_tokens_ = drain_closes_per_second_;
 
   if (drain_time_completed_.load() < server_.options().drainTime().count()) {
     drain_tick_timer_->enableTimer(std::chrono::milliseconds(1000));
@@ -5,6 +5,7 @@
 
 #include "envoy/server/drain_manager.h"
 #include "envoy/server/instance.h"
+#include "envoy/stats/stats.h"
 
 #include "common/common/logger.h"
 
@@ -16,6 +17,8 @@ namespace Server {
  * 1) Terminates the parent process after 15 minutes.
  * 2) Drains the parent process over a period of 10 minutes where drain close becomes more
  *    likely each second that passes.
+ * 3) If --drain-rate-per-worker is set, drain closes at most that many connections per worker
+ *    each second, so that the clients don't all reconnect at once.
  */
 class DrainManagerImpl : Logger::Loggable<Logger::Id::main>, public DrainManager {
 public:
@@ -29,11 +32,18 @@ public:
 private:
   bool draining() const { return drain_tick_timer_ != nullptr; }
   void drainSequenceTick();
+  bool takeDrainCloseToken() const;
 
   Instance& server_;
   const envoy::api::v2::Listener::DrainType drain_type_;
+  // The drain closes allowed each second for all the workers, 0 for no limit.
+  const uint64_t drain_closes_per_second_;
+  Stats::Counter& drain_close_counter_;
+  Stats::Counter& drain_close_rate_limited_counter_;
   Event::TimerPtr drain_tick_timer_;
   std::atomic<uint32_t> drain_time_completed_{};
+  // The drain closes left for the current second, refilled on each drain tick.
+  mutable std::atomic<uint64_t> drain_close_tokens_{};
   Event::TimerPtr parent_shutdown_timer_;
   std::function<void()> drain_sequence_completion_;
 };
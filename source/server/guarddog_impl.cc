@@ -52,6 +52,9 @@ void GuardDogImpl::threadRoutine() {
       }
       if (delta > miss_timeout_) {
         if (!watched_dog.miss_alerted_) {
+          ENVOY_LOG(warn, "GuardDog: thread {} has not touched its watchdog for {} ms (miss)",
+                    watched_dog.dog_->threadId().debugString(),
+                    std::chrono::duration_cast<std::chrono::milliseconds>(delta).count());
           watchdog_miss_counter_.inc();
           watched_dog.last_alert_time_ = ltt;
           watched_dog.miss_alerted_ = true;
@@ -59,6 +62,9 @@ void GuardDogImpl::threadRoutine() {
       }
       if (delta > megamiss_timeout_) {
         if (!watched_dog.megamiss_alerted_) {
+          ENVOY_LOG(warn, "GuardDog: thread {} has not touched its watchdog for {} ms (mega miss)",
+                    watched_dog.dog_->threadId().debugString(),
+                    std::chrono::duration_cast<std::chrono::milliseconds>(delta).count());
           watchdog_megamiss_counter_.inc();
           watched_dog.last_alert_time_ = ltt;
           watched_dog.megamiss_alerted_ = true;
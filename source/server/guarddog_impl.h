@@ -30,7 +30,7 @@ namespace Server {
  *
  * Thread lifetime is tied to GuardDog object lifetime (RAII style).
  */
-class GuardDogImpl : public GuardDog {
+class GuardDogImpl : public GuardDog, Logger::Loggable<Logger::Id::main> {
 public:
   /**
    * @param stats_scope Statistics scope to write watchdog_miss and
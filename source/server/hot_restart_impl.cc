@@ -5,6 +5,7 @@
 #include <sys/types.h>
 #include <sys/un.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -13,6 +14,8 @@
 #include "envoy/event/file_event.h"
 #include "envoy/server/instance.h"
 #include "envoy/server/options.h"
+#include "envoy/stats/stats.h"
+#include "envoy/stats/store.h"
 
 #include "common/api/os_sys_calls_impl.h"
 #include "common/common/fmt.h"
@@ -29,7 +32,7 @@ namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t SharedMemory::VERSION = 10;
+const uint64_t SharedMemory::VERSION = 11;
 
 static BlockMemoryHashSetOptions blockMemHashOptions(uint64_t max_stats) {
   BlockMemoryHashSetOptions hash_set_options;
@@ -43,7 +46,12 @@ static BlockMemoryHashSetOptions blockMemHashOptions(uint64_t max_stats) {
 SharedMemory& SharedMemory::initialize(uint64_t stats_set_size, const Options& options) {
   Api::OsSysCalls& os_sys_calls = Api::OsSysCallsSingleton::get();
 
-  const uint64_t entry_size = Stats::RawStatData::structSizeWithOptions(options.statsOptions());
+  // There is no stats set when stats are transferred, which a process that keeps its stats in
+  // shared memory detects through the other fields.
+  const bool stats_transfer = options.hotRestartStatsTransfer();
+  const uint64_t max_stats = stats_transfer ? 0 : options.maxStats();
+  const uint64_t entry_size =
+      stats_transfer ? 0 : Stats::RawStatData::structSizeWithOptions(options.statsOptions());
   const uint64_t total_size = sizeof(SharedMemory) + stats_set_size;
 
   int flags = O_RDWR;
@@ -77,7 +85,7 @@ SharedMemory& SharedMemory::initialize(uint64_t stats_set_size, const Options& o
   if (options.restartEpoch() == 0) {
     shmem->size_ = total_size;
     shmem->version_ = VERSION;
-    shmem->max_stats_ = options.maxStats();
+    shmem->max_stats_ = max_stats;
     shmem->entry_size_ = entry_size;
     shmem->initializeMutex(shmem->log_lock_);
     shmem->initializeMutex(shmem->access_log_lock_);
@@ -86,7 +94,7 @@ SharedMemory& SharedMemory::initialize(uint64_t stats_set_size, const Options& o
   } else {
     RELEASE_ASSERT(shmem->size_ == total_size, "");
     RELEASE_ASSERT(shmem->version_ == VERSION, "");
-    RELEASE_ASSERT(shmem->max_stats_ == options.maxStats(), "");
+    RELEASE_ASSERT(shmem->max_stats_ == max_stats, "");
     RELEASE_ASSERT(shmem->entry_size_ == entry_size, "");
   }
 
@@ -122,22 +130,33 @@ std::string SharedMemory::version(uint64_t max_num_stats,
                      stats_options.maxNameLength());
 }
 
+std::string SharedMemory::statsTransferVersion() {
+  return fmt::format("{}.{}.transfer", VERSION, sizeof(SharedMemory));
+}
+
 HotRestartImpl::HotRestartImpl(const Options& options, Stats::SymbolTable& symbol_table)
     : options_(options), stats_set_options_(blockMemHashOptions(options.maxStats())),
       shmem_(SharedMemory::initialize(
-          Stats::RawStatDataSet::numBytes(stats_set_options_, options_.statsOptions()), options_)),
+          options.hotRestartStatsTransfer()
+              ? 0
+              : Stats::RawStatDataSet::numBytes(stats_set_options_, options_.statsOptions()),
+          options_)),
       log_lock_(shmem_.log_lock_), access_log_lock_(shmem_.access_log_lock_),
       stat_lock_(shmem_.stat_lock_), init_lock_(shmem_.init_lock_) {
-  {
-    // We must hold the stat lock when attaching to an existing memory segment
-    // because it might be actively written to while we sanityCheck it.
-    Thread::LockGuard lock(stat_lock_);
-    stats_set_ =
-        std::make_unique<Stats::RawStatDataSet>(stats_set_options_, options.restartEpoch() == 0,
-                                                shmem_.stats_set_data_, options_.statsOptions());
-  }
-  stats_allocator_ = std::make_unique<Stats::RawStatDataAllocator>(
-      stat_lock_, *stats_set_, options_.statsOptions(), symbol_table);
+  if (options.hotRestartStatsTransfer()) {
+    heap_stats_allocator_ = std::make_unique<Stats::HeapStatDataAllocator>(symbol_table);
+  } else {
+    {
+      // We must hold the stat lock when attaching to an existing memory segment
+      // because it might be actively written to while we sanityCheck it.
+      Thread::LockGuard lock(stat_lock_);
+      stats_set_ =
+          std::make_unique<Stats::RawStatDataSet>(stats_set_options_, options.restartEpoch() == 0,
+                                                  shmem_.stats_set_data_, options_.statsOptions());
+    }
+    raw_stats_allocator_ = std::make_unique<Stats::RawStatDataAllocator>(
+        stat_lock_, *stats_set_, options_.statsOptions(), symbol_table);
+  }
   my_domain_socket_ = bindDomainSocket(options.restartEpoch());
   child_address_ = createDomainSocketAddress((options.restartEpoch() + 1));
   initDomainSocketAddress(&parent_address_);
@@ -199,7 +218,8 @@ void HotRestartImpl::drainParentListeners() {
   shmem_.flags_ &= ~SharedMemory::Flags::INITIALIZING;
 }
 
-int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
+int HotRestartImpl::duplicateParentListenSocket(const std::string& address,
+                                                uint32_t worker_index) {
   if (options_.restartEpoch() == 0 || parent_terminated_) {
     return -1;
   }
@@ -207,6 +227,7 @@ int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
   RpcGetListenSocketRequest rpc;
   ASSERT(address.length() < sizeof(rpc.address_));
   StringUtil::strlcpy(rpc.address_, address.c_str(), sizeof(rpc.address_));
+  rpc.worker_index_ = worker_index;
   sendMessage(parent_address_, rpc);
   RpcGetListenSocketReply* reply =
       receiveTypedRpc<RpcGetListenSocketReply, RpcMessageType::GetListenSocketReply>();
@@ -245,6 +266,90 @@ void HotRestartImpl::getParentStats(GetParentStatsInfo& info) {
   info.num_connections_ = reply->num_connections_;
 }
 
+void HotRestartImpl::mergeParentStats() {
+  // See large comment in getParentStats() on why this operation is locked.
+  Thread::TryLockGuard lock(init_lock_);
+  if (!options_.hotRestartStatsTransfer() || options_.restartEpoch() == 0 || parent_terminated_ ||
+      !lock.tryLock()) {
+    return;
+  }
+
+  receiveParentStats();
+}
+
+void HotRestartImpl::receiveParentStats() {
+  // The parent sends its stats in as many replies as needed, each reply is requested separately so
+  // that the parent never fills up our socket's receive queue.
+  RpcGetStatValuesRequest rpc;
+  while (true) {
+    sendMessage(parent_address_, rpc);
+    RpcBase* base_message = receiveRpc(true);
+    RELEASE_ASSERT(base_message->type_ == RpcMessageType::GetStatValuesReply, "");
+    RELEASE_ASSERT(base_message->length_ >= sizeof(RpcGetStatValuesReply), "");
+    const RpcGetStatValuesReply* reply = reinterpret_cast<RpcGetStatValuesReply*>(base_message);
+
+    const uint8_t* position = reinterpret_cast<const uint8_t*>(reply) + sizeof(*reply);
+    const uint8_t* end = reinterpret_cast<const uint8_t*>(reply) + reply->length_;
+    for (uint32_t i = 0; i < reply->num_values_; i++) {
+      RpcStatValue value;
+      RELEASE_ASSERT(position + sizeof(value) <= end, "");
+      memcpy(&value, position, sizeof(value));
+      position += sizeof(value);
+      RELEASE_ASSERT(position + value.name_length_ <= end, "");
+      mergeParentStat(value.type_,
+                      std::string(reinterpret_cast<const char*>(position), value.name_length_),
+                      value.value_);
+      position += value.name_length_;
+    }
+
+    if (reply->last_) {
+      return;
+    }
+    rpc.offset_ = reply->next_offset_;
+  }
+}
+
+void HotRestartImpl::mergeParentStat(StatType type, const std::string& name, uint64_t value) {
+  Stats::Store& store = server_->stats();
+  if (type == StatType::Counter) {
+    // Counters continue from the parent's value. The increments are latched right away since they
+    // are reported by the parent's sinks. This runs right after our own stats were flushed, so
+    // that this only drops increments of ours that happened since then.
+    uint64_t& last_value = parent_counter_values_[name];
+    const uint64_t delta = value >= last_value ? value - last_value : value;
+    last_value = value;
+    if (delta > 0) {
+      Stats::Counter& counter = store.counter(name);
+      counter.add(delta);
+      counter.latch();
+    }
+    return;
+  }
+
+  // Gauges include the parent's value until the parent is terminated, see removeParentGauges().
+  ASSERT(type == StatType::Gauge);
+  uint64_t& last_value = parent_gauge_values_[name];
+  if (value != last_value) {
+    Stats::Gauge& gauge = store.gauge(name);
+    if (value > last_value) {
+      gauge.add(value - last_value);
+    } else {
+      gauge.sub(std::min(last_value - value, gauge.value()));
+    }
+    last_value = value;
+  }
+}
+
+void HotRestartImpl::removeParentGauges() {
+  Stats::Store& store = server_->stats();
+  for (const auto& parent_gauge : parent_gauge_values_) {
+    Stats::Gauge& gauge = store.gauge(parent_gauge.first);
+    gauge.sub(std::min(parent_gauge.second, gauge.value()));
+  }
+  parent_gauge_values_.clear();
+  parent_counter_values_.clear();
+}
+
 void HotRestartImpl::initialize(Event::Dispatcher& dispatcher, Server::Instance& server) {
   socket_event_ =
       dispatcher.createFileEvent(my_domain_socket_,
@@ -335,11 +440,9 @@ void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
 
   Network::Address::InstanceConstSharedPtr addr =
       Network::Utility::resolveUrl(std::string(rpc.address_));
-  for (const auto& listener : server_->listenerManager().listeners()) {
-    if (*listener.get().socket().localAddress() == *addr) {
-      reply.fd_ = listener.get().socket().ioHandle().fd();
-      break;
-    }
+  Network::Socket* socket = server_->listenerManager().findListenSocket(*addr, rpc.worker_index_);
+  if (socket != nullptr) {
+    reply.fd_ = socket->ioHandle().fd();
   }
 
   if (reply.fd_ == -1) {
@@ -373,6 +476,53 @@ void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
   }
 }
 
+void HotRestartImpl::onGetStatValues(RpcGetStatValuesRequest& rpc) {
+  if (rpc.offset_ == 0) {
+    stat_values_snapshot_.clear();
+    for (const Stats::CounterSharedPtr& counter : server_->stats().counters()) {
+      stat_values_snapshot_.push_back({StatType::Counter, counter->name(), counter->value()});
+    }
+    for (const Stats::GaugeSharedPtr& gauge : server_->stats().gauges()) {
+      stat_values_snapshot_.push_back({StatType::Gauge, gauge->name(), gauge->value()});
+    }
+  }
+
+  // The reply is built in place: the header, followed by as many values as fit into a message.
+  std::array<uint8_t, sizeof(rpc_buffer_)> buffer;
+  RpcGetStatValuesReply reply;
+  uint64_t length = sizeof(reply);
+  uint64_t offset = rpc.offset_;
+  for (; offset < stat_values_snapshot_.size(); offset++) {
+    const StatValue& stat = stat_values_snapshot_[offset];
+    const uint64_t value_length = sizeof(RpcStatValue) + stat.name_.size();
+    if (length + value_length > buffer.size()) {
+      if (reply.num_values_ > 0) {
+        break;
+      }
+      ENVOY_LOG(warn, "not transferring stat {}: the name is too long", stat.name_);
+      continue;
+    }
+
+    RpcStatValue value;
+    value.type_ = stat.type_;
+    value.value_ = stat.value_;
+    value.name_length_ = stat.name_.size();
+    memcpy(&buffer[length], &value, sizeof(value));
+    memcpy(&buffer[length + sizeof(value)], stat.name_.data(), stat.name_.size());
+    length += value_length;
+    reply.num_values_++;
+  }
+
+  reply.next_offset_ = offset;
+  reply.last_ = offset >= stat_values_snapshot_.size();
+  reply.length_ = length;
+  memcpy(&buffer[0], &reply, sizeof(reply));
+  sendMessage(child_address_, *reinterpret_cast<RpcBase*>(&buffer[0]));
+  if (reply.last_) {
+    stat_values_snapshot_.clear();
+  }
+}
+
 void HotRestartImpl::onSocketEvent() {
   while (true) {
     RpcBase* base_message = receiveRpc(false);
@@ -406,6 +556,11 @@ void HotRestartImpl::onSocketEvent() {
       break;
     }
 
+    case RpcMessageType::GetStatValuesRequest: {
+      onGetStatValues(*reinterpret_cast<RpcGetStatValuesRequest*>(base_message));
+      break;
+    }
+
     case RpcMessageType::DrainListenersRequest: {
       server_->drainListeners();
       break;
@@ -445,6 +600,18 @@ void HotRestartImpl::terminateParent() {
     return;
   }
 
+  if (options_.hotRestartStatsTransfer()) {
+    // Pick up the parent's last counter increments. The parent's gauges go away with it.
+    {
+      // See large comment in getParentStats() on why this operation is locked.
+      Thread::TryLockGuard lock(init_lock_);
+      if (lock.tryLock()) {
+        receiveParentStats();
+      }
+    }
+    removeParentGauges();
+  }
+
   RpcBase rpc(RpcMessageType::TerminateRequest);
   sendMessage(parent_address_, rpc);
   parent_terminated_ = true;
@@ -452,14 +619,28 @@ void HotRestartImpl::terminateParent() {
 
 void HotRestartImpl::shutdown() { socket_event_.reset(); }
 
+Stats::StatDataAllocator& HotRestartImpl::statsAllocator() {
+  if (heap_stats_allocator_ != nullptr) {
+    return *heap_stats_allocator_;
+  }
+  return *raw_stats_allocator_;
+}
+
 std::string HotRestartImpl::version() {
+  if (options_.hotRestartStatsTransfer()) {
+    return SharedMemory::statsTransferVersion();
+  }
   Thread::LockGuard lock(stat_lock_);
   return versionHelper(shmem_.maxStats(), options_.statsOptions(), *stats_set_);
 }
 
 // Called from envoy --hot-restart-version -- needs to instantiate a RawStatDataSet so it
 // can generate the version string.
-std::string HotRestartImpl::hotRestartVersion(uint64_t max_num_stats, uint64_t max_stat_name_len) {
+std::string HotRestartImpl::hotRestartVersion(uint64_t max_num_stats, uint64_t max_stat_name_len,
+                                              bool stats_transfer) {
+  if (stats_transfer) {
+    return SharedMemory::statsTransferVersion();
+  }
   Stats::StatsOptionsImpl stats_options;
   stats_options.max_obj_name_length_ = max_stat_name_len - stats_options.maxStatSuffixLength();
 
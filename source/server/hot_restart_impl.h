@@ -7,6 +7,8 @@
 #include <atomic>
 #include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "envoy/common/platform.h"
 #include "envoy/server/hot_restart.h"
@@ -14,6 +16,7 @@
 #include "envoy/stats/stats_options.h"
 
 #include "common/common/assert.h"
+#include "common/stats/heap_stat_data.h"
 #include "common/stats/raw_stat_data.h"
 
 namespace Envoy {
@@ -27,6 +30,7 @@ class SharedMemory {
 public:
   static void configure(uint64_t max_num_stats, uint64_t max_stat_name_len);
   static std::string version(uint64_t max_num_stats, const Stats::StatsOptions& stats_options);
+  static std::string statsTransferVersion();
 
   // Made public for testing.
   static const uint64_t VERSION;
@@ -118,8 +122,9 @@ public:
 
   // Server::HotRestart
   void drainParentListeners() override;
-  int duplicateParentListenSocket(const std::string& address) override;
+  int duplicateParentListenSocket(const std::string& address, uint32_t worker_index) override;
   void getParentStats(GetParentStatsInfo& info) override;
+  void mergeParentStats() override;
   void initialize(Event::Dispatcher& dispatcher, Server::Instance& server) override;
   void shutdownParentAdmin(ShutdownParentAdminInfo& info) override;
   void terminateParent() override;
@@ -127,13 +132,20 @@ public:
   std::string version() override;
   Thread::BasicLockable& logLock() override { return log_lock_; }
   Thread::BasicLockable& accessLogLock() override { return access_log_lock_; }
-  Stats::RawStatDataAllocator& statsAllocator() override { return *stats_allocator_; }
+  Stats::StatDataAllocator& statsAllocator() override;
+
+  /**
+   * @return Stats::RawStatDataAllocator& the allocator of the stats in shared memory. Only valid
+   *         when stats are not transferred, see Options::hotRestartStatsTransfer().
+   */
+  Stats::RawStatDataAllocator& rawStatsAllocator() { return *raw_stats_allocator_; }
 
   /**
    * envoy --hot_restart_version doesn't initialize Envoy, but computes the version string
    * based on the configured options.
    */
-  static std::string hotRestartVersion(uint64_t max_num_stats, uint64_t max_stat_name_len);
+  static std::string hotRestartVersion(uint64_t max_num_stats, uint64_t max_stat_name_len,
+                                       bool stats_transfer);
 
 private:
   enum class RpcMessageType {
@@ -145,9 +157,13 @@ private:
     TerminateRequest = 6,
     UnknownRequestReply = 7,
     GetStatsRequest = 8,
-    GetStatsReply = 9
+    GetStatsReply = 9,
+    GetStatValuesRequest = 10,
+    GetStatValuesReply = 11
   };
 
+  enum class StatType : uint8_t { Counter = 1, Gauge = 2 };
+
   PACKED_STRUCT(struct RpcBase {
     RpcBase(RpcMessageType type, uint64_t length = sizeof(RpcBase))
         : type_(type), length_(length) {}
@@ -162,6 +178,7 @@ private:
                       : RpcBase(RpcMessageType::GetListenSocketRequest, sizeof(*this)) {}
 
                   char address_[256]{0};
+                  uint32_t worker_index_{0};
                 });
 
   PACKED_STRUCT(struct RpcGetListenSocketReply
@@ -189,6 +206,38 @@ private:
                   uint64_t unused_[16]{0};
                 });
 
+  PACKED_STRUCT(struct RpcGetStatValuesRequest
+                : public RpcBase {
+                  RpcGetStatValuesRequest()
+                      : RpcBase(RpcMessageType::GetStatValuesRequest, sizeof(*this)) {}
+
+                  // Index of the first stat to send, 0 takes a new snapshot of the parent's stats.
+                  uint64_t offset_{0};
+                });
+
+  // Followed by num_values_ RpcStatValue entries, each followed by the stat's name.
+  PACKED_STRUCT(struct RpcGetStatValuesReply
+                : public RpcBase {
+                  RpcGetStatValuesReply()
+                      : RpcBase(RpcMessageType::GetStatValuesReply, sizeof(*this)) {}
+
+                  uint64_t next_offset_{0};
+                  uint32_t num_values_{0};
+                  uint8_t last_{0};
+                });
+
+  PACKED_STRUCT(struct RpcStatValue {
+    StatType type_;
+    uint64_t value_;
+    uint16_t name_length_;
+  });
+
+  struct StatValue {
+    StatType type_;
+    std::string name_;
+    uint64_t value_;
+  };
+
   template <class rpc_class, RpcMessageType rpc_type> rpc_class* receiveTypedRpc() {
     RpcBase* base_message = receiveRpc(true);
     RELEASE_ASSERT(base_message->length_ == sizeof(rpc_class), "");
@@ -200,6 +249,10 @@ private:
   void initDomainSocketAddress(sockaddr_un* address);
   sockaddr_un createDomainSocketAddress(uint64_t id);
   void onGetListenSocket(RpcGetListenSocketRequest& rpc);
+  void onGetStatValues(RpcGetStatValuesRequest& rpc);
+  void receiveParentStats();
+  void mergeParentStat(StatType type, const std::string& name, uint64_t value);
+  void removeParentGauges();
   void onSocketEvent();
   RpcBase* receiveRpc(bool block);
   void sendMessage(sockaddr_un& address, RpcBase& rpc);
@@ -210,7 +263,9 @@ private:
   BlockMemoryHashSetOptions stats_set_options_;
   SharedMemory& shmem_;
   std::unique_ptr<Stats::RawStatDataSet> stats_set_ GUARDED_BY(stat_lock_);
-  std::unique_ptr<Stats::RawStatDataAllocator> stats_allocator_;
+  std::unique_ptr<Stats::RawStatDataAllocator> raw_stats_allocator_;
+  // Only used with Options::hotRestartStatsTransfer().
+  std::unique_ptr<Stats::HeapStatDataAllocator> heap_stats_allocator_;
   ProcessSharedMutex log_lock_;
   ProcessSharedMutex access_log_lock_;
   ProcessSharedMutex stat_lock_;
@@ -222,6 +277,11 @@ private:
   std::array<uint8_t, 4096> rpc_buffer_;
   Server::Instance* server_{};
   bool parent_terminated_{};
+  // Parent side of the stats transfer: the snapshot of the stats that are being sent to the child.
+  std::vector<StatValue> stat_values_snapshot_;
+  // Child side of the stats transfer: the last counter and gauge values received from the parent.
+  std::unordered_map<std::string, uint64_t> parent_counter_values_;
+  std::unordered_map<std::string, uint64_t> parent_gauge_values_;
 };
 
 } // namespace Server
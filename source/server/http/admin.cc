@@ -3,6 +3,9 @@
 #include <algorithm>
 #include <cstdint>
 #include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <regex>
 #include <string>
 #include <unordered_map>
@@ -34,6 +37,7 @@
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
 #include "common/common/mutex_tracer_impl.h"
+#include "common/common/perf_annotation.h"
 #include "common/common/utility.h"
 #include "common/common/version.h"
 #include "common/html/utility.h"
@@ -42,19 +46,28 @@
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
 #include "common/json/json_loader.h"
+#include "common/memory/accounting.h"
 #include "common/memory/stats.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/utility.h"
+#include "common/profiler/cpu_sampler.h"
 #include "common/profiler/profiler.h"
 #include "common/router/config_impl.h"
 #include "common/stats/histogram_impl.h"
+#include "common/stats/symbol_table_impl.h"
 #include "common/upstream/host_utility.h"
 
 #include "extensions/access_loggers/file/file_access_log_impl.h"
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 
 // TODO(mattklein123): Switch to JSON interface methods and remove rapidjson dependency.
 #include "rapidjson/document.h"
@@ -137,7 +150,141 @@ const char AdminHtmlEnd[] = R"(
 </body>
 )";
 
-const std::regex PromRegex("[^a-zA-Z0-9_]");
+// How much of a large response is formatted at a time. Responses bigger than this are streamed.
+constexpr uint64_t ResponseChunkBytes = 64 * 1024;
+
+/**
+ * Streams the output that didn't fit in the first chunk, one chunk per dispatcher iteration,
+ * pausing while the downstream is backed up so that the output is never buffered in full.
+ */
+class ResponseStreamer : public Http::DownstreamWatermarkCallbacks,
+                         public std::enable_shared_from_this<ResponseStreamer> {
+public:
+  // Appends the next chunk to the buffer and returns whether it was the last one.
+  typedef std::function<bool(Buffer::Instance&)> NextChunkCb;
+
+  static void start(NextChunkCb next_chunk, AdminStream& admin_stream) {
+    auto streamer = std::make_shared<ResponseStreamer>(std::move(next_chunk),
+                                                       admin_stream.getDecoderFilterCallbacks());
+    admin_stream.addOnDestroyCallback([streamer]() -> void { streamer->onDestroy(); });
+    streamer->callbacks_.addDownstreamWatermarkCallbacks(*streamer);
+    streamer->schedule();
+  }
+
+  ResponseStreamer(NextChunkCb next_chunk, Http::StreamDecoderFilterCallbacks& callbacks)
+      : next_chunk_(std::move(next_chunk)), callbacks_(callbacks) {}
+
+  // Http::DownstreamWatermarkCallbacks
+  void onAboveWriteBufferHighWatermark() override { ++above_high_watermark_; }
+  void onBelowWriteBufferLowWatermark() override {
+    ASSERT(above_high_watermark_ > 0);
+    if (--above_high_watermark_ == 0 && !scheduled_) {
+      schedule();
+    }
+  }
+
+private:
+  void schedule() {
+    scheduled_ = true;
+    std::shared_ptr<ResponseStreamer> self = shared_from_this();
+    callbacks_.dispatcher().post([self]() -> void {
+      self->scheduled_ = false;
+      self->sendChunk();
+    });
+  }
+
+  void sendChunk() {
+    // Once the downstream drains we get rescheduled by onBelowWriteBufferLowWatermark().
+    if (done_ || above_high_watermark_ > 0) {
+      return;
+    }
+    Buffer::OwnedImpl chunk;
+    done_ = next_chunk_(chunk);
+    if (done_) {
+      callbacks_.removeDownstreamWatermarkCallbacks(*this);
+    }
+    callbacks_.encodeData(chunk, done_);
+    if (!done_) {
+      schedule();
+    }
+  }
+
+  void onDestroy() {
+    if (!done_) {
+      callbacks_.removeDownstreamWatermarkCallbacks(*this);
+      done_ = true;
+    }
+  }
+
+  const NextChunkCb next_chunk_;
+  Http::StreamDecoderFilterCallbacks& callbacks_;
+  uint32_t above_high_watermark_{};
+  bool scheduled_{};
+  bool done_{};
+};
+
+/**
+ * Formats the first chunk of a response, and streams the rest if it doesn't fit. Outputs that are
+ * not sent on a stream, i.e. of AdminImpl::request(), are formatted in full.
+ * @param formatter supplies the formatter of the response, with a next(Buffer::Instance&, uint64_t)
+ *        method that returns whether all of the output has been formatted.
+ */
+template <class Formatter>
+void formatOrStream(std::shared_ptr<Formatter> formatter, bool buffer_response,
+                    Buffer::Instance& response, AdminStream& admin_stream) {
+  if (buffer_response) {
+    formatter->next(response, std::numeric_limits<uint64_t>::max());
+  } else if (!formatter->next(response, ResponseChunkBytes)) {
+    // Too much for one chunk, so stream the rest rather than buffering it all.
+    admin_stream.setEndStreamOnComplete(false);
+    ResponseStreamer::start(
+        [formatter](Buffer::Instance& chunk) -> bool {
+          return formatter->next(chunk, ResponseChunkBytes);
+        },
+        admin_stream);
+  }
+}
+
+// Pretty printed JSON of an object with a single repeated field, whose elements are formatted one
+// at a time. The output is the same as when the whole object is pretty printed.
+void addJsonArrayElement(const Protobuf::Message& message, absl::string_view field, bool first,
+                         Buffer::Instance& response) {
+  std::string out = first ? absl::StrCat("{\n \"", field, "\": [\n") : ",\n";
+  const std::string json = MessageUtil::getJsonStringFromMessage(message, true); // pretty-print
+  bool first_line = true;
+  for (absl::string_view line : absl::StrSplit(absl::StripSuffix(json, "\n"), '\n')) {
+    absl::StrAppend(&out, first_line ? "" : "\n", "  ", line);
+    first_line = false;
+  }
+  response.add(out);
+}
+
+void addJsonArrayEnd(bool empty, Buffer::Instance& response) {
+  // Empty repeated fields are not printed.
+  response.add(empty ? "{\n}\n" : "\n ]\n}\n");
+}
+
+// Parses an optional regex query parameter, returning false if it is invalid.
+bool regexParam(const Http::Utility::QueryParams& params, const std::string& name,
+                absl::optional<std::regex>& regex) {
+  const auto it = params.find(name);
+  if (it == params.end()) {
+    return true;
+  }
+  try {
+    regex = std::regex(it->second);
+  } catch (const std::regex_error&) {
+    return false;
+  }
+  return true;
+}
+
+// Parses an optional unsigned integer query parameter, returning false if it is invalid.
+bool uint64Param(const Http::Utility::QueryParams& params, const std::string& name,
+                 uint64_t& value) {
+  const auto it = params.find(name);
+  return it == params.end() || absl::SimpleAtoi(it->second, &value);
+}
 
 void populateFallbackResponseHeaders(Http::Code code, Http::HeaderMap& header_map) {
   header_map.insertStatus().value(std::to_string(enumToInt(code)));
@@ -285,20 +432,65 @@ bool AdminImpl::changeLogLevel(const Http::Utility::QueryParams& params) {
   return true;
 }
 
-void AdminImpl::addOutlierInfo(const std::string& cluster_name,
-                               const Upstream::Outlier::Detector* outlier_detector,
-                               Buffer::Instance& response) {
-  if (outlier_detector) {
-    response.add(fmt::format("{}::outlier::success_rate_average::{}\n", cluster_name,
-                             outlier_detector->successRateAverage()));
-    response.add(fmt::format("{}::outlier::success_rate_ejection_threshold::{}\n", cluster_name,
-                             outlier_detector->successRateEjectionThreshold()));
+ClustersFormatter::ClustersFormatter(const Upstream::ClusterManager::ClusterInfoMap& clusters,
+                                     bool json, const absl::optional<std::regex>& filter,
+                                     uint64_t offset, uint64_t limit)
+    : json_(json) {
+  std::vector<std::pair<absl::string_view, const Upstream::Cluster*>> matching;
+  for (const auto& cluster : clusters) {
+    if (!filter.has_value() || std::regex_search(cluster.first, filter.value())) {
+      matching.emplace_back(cluster.first, &cluster.second.get());
+    }
+  }
+  std::sort(matching.begin(), matching.end());
+
+  const size_t begin = std::min<uint64_t>(offset, matching.size());
+  const size_t end =
+      limit == 0 || limit >= matching.size() - begin ? matching.size() : begin + limit;
+  clusters_.reserve(end - begin);
+  for (size_t i = begin; i < end; ++i) {
+    const Upstream::Cluster& cluster = *matching[i].second;
+    clusters_.emplace_back();
+    ClusterSnapshot& snapshot = clusters_.back();
+    snapshot.info_ = cluster.info();
+    const Upstream::Outlier::Detector* outlier_detector = cluster.outlierDetector();
+    if (outlier_detector != nullptr) {
+      snapshot.has_outlier_detector_ = true;
+      snapshot.success_rate_average_ = outlier_detector->successRateAverage();
+      snapshot.success_rate_ejection_threshold_ = outlier_detector->successRateEjectionThreshold();
+    }
+    for (const auto& host_set : cluster.prioritySet().hostSetsPerPriority()) {
+      snapshot.hosts_.push_back(host_set->hostsPtr());
+    }
+  }
+}
+
+bool ClustersFormatter::next(Buffer::Instance& response, uint64_t min_bytes) {
+  const uint64_t start_length = response.length();
+  while (next_cluster_ < clusters_.size() && response.length() - start_length < min_bytes) {
+    const ClusterSnapshot& cluster = clusters_[next_cluster_];
+    if (json_) {
+      envoy::admin::v2alpha::ClusterStatus cluster_status;
+      formatJson(cluster, cluster_status);
+      addJsonArrayElement(cluster_status, "cluster_statuses", next_cluster_ == 0, response);
+    } else {
+      formatText(cluster, response);
+    }
+    ++next_cluster_;
+  }
+  if (next_cluster_ < clusters_.size()) {
+    return false;
+  }
+  if (json_) {
+    addJsonArrayEnd(clusters_.empty(), response);
   }
+  return true;
 }
 
-void AdminImpl::addCircuitSettings(const std::string& cluster_name, const std::string& priority_str,
-                                   Upstream::ResourceManager& resource_manager,
-                                   Buffer::Instance& response) {
+void ClustersFormatter::addCircuitSettings(const std::string& cluster_name,
+                                           const std::string& priority_str,
+                                           Upstream::ResourceManager& resource_manager,
+                                           Buffer::Instance& response) {
   response.add(fmt::format("{}::{}_priority::max_connections::{}\n", cluster_name, priority_str,
                            resource_manager.connections().max()));
   response.add(fmt::format("{}::{}_priority::max_pending_requests::{}\n", cluster_name,
@@ -309,164 +501,186 @@ void AdminImpl::addCircuitSettings(const std::string& cluster_name, const std::s
                            resource_manager.retries().max()));
 }
 
-void AdminImpl::writeClustersAsJson(Buffer::Instance& response) {
-  envoy::admin::v2alpha::Clusters clusters;
-  for (auto& cluster_pair : server_.clusterManager().clusters()) {
-    const Upstream::Cluster& cluster = cluster_pair.second.get();
-    Upstream::ClusterInfoConstSharedPtr cluster_info = cluster.info();
-
-    envoy::admin::v2alpha::ClusterStatus& cluster_status = *clusters.add_cluster_statuses();
-    cluster_status.set_name(cluster_info->name());
-
-    const Upstream::Outlier::Detector* outlier_detector = cluster.outlierDetector();
-    if (outlier_detector != nullptr && outlier_detector->successRateEjectionThreshold() > 0.0) {
-      cluster_status.mutable_success_rate_ejection_threshold()->set_value(
-          outlier_detector->successRateEjectionThreshold());
-    }
+void ClustersFormatter::formatJson(const ClusterSnapshot& cluster,
+                                   envoy::admin::v2alpha::ClusterStatus& cluster_status) {
+  cluster_status.set_name(cluster.info_->name());
+  if (cluster.has_outlier_detector_ && cluster.success_rate_ejection_threshold_ > 0.0) {
+    cluster_status.mutable_success_rate_ejection_threshold()->set_value(
+        cluster.success_rate_ejection_threshold_);
+  }
 
-    cluster_status.set_added_via_api(cluster_info->addedViaApi());
+  cluster_status.set_added_via_api(cluster.info_->addedViaApi());
 
-    for (auto& host_set : cluster.prioritySet().hostSetsPerPriority()) {
-      for (auto& host : host_set->hosts()) {
-        envoy::admin::v2alpha::HostStatus& host_status = *cluster_status.add_host_statuses();
-        Network::Utility::addressToProtobufAddress(*host->address(),
-                                                   *host_status.mutable_address());
-        std::vector<Stats::CounterSharedPtr> sorted_counters;
-        for (const Stats::CounterSharedPtr& counter : host->counters()) {
-          sorted_counters.push_back(counter);
-        }
-        std::sort(
-            sorted_counters.begin(), sorted_counters.end(),
-            [](const Stats::CounterSharedPtr& counter1, const Stats::CounterSharedPtr& counter2) {
-              return counter1->name() < counter2->name();
-            });
-
-        for (const Stats::CounterSharedPtr& counter : sorted_counters) {
-          auto& metric = *host_status.add_stats();
-          metric.set_name(counter->name());
-          metric.set_value(counter->value());
-          metric.set_type(envoy::admin::v2alpha::SimpleMetric::COUNTER);
-        }
+  for (const Upstream::HostVectorConstSharedPtr& hosts : cluster.hosts_) {
+    for (const Upstream::HostSharedPtr& host : *hosts) {
+      envoy::admin::v2alpha::HostStatus& host_status = *cluster_status.add_host_statuses();
+      Network::Utility::addressToProtobufAddress(*host->address(), *host_status.mutable_address());
+      std::vector<Stats::CounterSharedPtr> sorted_counters;
+      for (const Stats::CounterSharedPtr& counter : host->counters()) {
+        sorted_counters.push_back(counter);
+      }
+      std::sort(
+          sorted_counters.begin(), sorted_counters.end(),
+          [](const Stats::CounterSharedPtr& counter1, const Stats::CounterSharedPtr& counter2) {
+            return counter1->name() < counter2->name();
+          });
+
+      for (const Stats::CounterSharedPtr& counter : sorted_counters) {
+        auto& metric = *host_status.add_stats();
+        metric.set_name(counter->name());
+        metric.set_value(counter->value());
+        metric.set_type(envoy::admin::v2alpha::SimpleMetric::COUNTER);
+      }
 
-        std::vector<Stats::GaugeSharedPtr> sorted_gauges;
-        for (const Stats::GaugeSharedPtr& gauge : host->gauges()) {
-          sorted_gauges.push_back(gauge);
-        }
-        std::sort(sorted_gauges.begin(), sorted_gauges.end(),
-                  [](const Stats::GaugeSharedPtr& gauge1, const Stats::GaugeSharedPtr& gauge2) {
-                    return gauge1->name() < gauge2->name();
-                  });
-
-        for (const Stats::GaugeSharedPtr& gauge : sorted_gauges) {
-          auto& metric = *host_status.add_stats();
-          metric.set_name(gauge->name());
-          metric.set_value(gauge->value());
-          metric.set_type(envoy::admin::v2alpha::SimpleMetric::GAUGE);
-        }
+      std::vector<Stats::GaugeSharedPtr> sorted_gauges;
+      for (const Stats::GaugeSharedPtr& gauge : host->gauges()) {
+        sorted_gauges.push_back(gauge);
+      }
+      std::sort(sorted_gauges.begin(), sorted_gauges.end(),
+                [](const Stats::GaugeSharedPtr& gauge1, const Stats::GaugeSharedPtr& gauge2) {
+                  return gauge1->name() < gauge2->name();
+                });
+
+      for (const Stats::GaugeSharedPtr& gauge : sorted_gauges) {
+        auto& metric = *host_status.add_stats();
+        metric.set_name(gauge->name());
+        metric.set_value(gauge->value());
+        metric.set_type(envoy::admin::v2alpha::SimpleMetric::GAUGE);
+      }
 
-        envoy::admin::v2alpha::HostHealthStatus& health_status =
-            *host_status.mutable_health_status();
+      envoy::admin::v2alpha::HostHealthStatus& health_status = *host_status.mutable_health_status();
 
 // Invokes setHealthFlag for each health flag.
 #define SET_HEALTH_FLAG(name, notused)                                                             \
   setHealthFlag(Upstream::Host::HealthFlag::name, *host, health_status);
-        HEALTH_FLAG_ENUM_VALUES(SET_HEALTH_FLAG)
+      HEALTH_FLAG_ENUM_VALUES(SET_HEALTH_FLAG)
 #undef SET_HEALTH_FLAG
 
-        double success_rate = host->outlierDetector().successRate();
-        if (success_rate >= 0.0) {
-          host_status.mutable_success_rate()->set_value(success_rate);
-        }
-
-        host_status.set_weight(host->weight());
+      double success_rate = host->outlierDetector().successRate();
+      if (success_rate >= 0.0) {
+        host_status.mutable_success_rate()->set_value(success_rate);
       }
+
+      host_status.set_weight(host->weight());
     }
   }
-  response.add(MessageUtil::getJsonStringFromMessage(clusters, true)); // pretty-print
-}
-
-void AdminImpl::writeClustersAsText(Buffer::Instance& response) {
-  for (auto& cluster : server_.clusterManager().clusters()) {
-    addOutlierInfo(cluster.second.get().info()->name(), cluster.second.get().outlierDetector(),
-                   response);
-
-    addCircuitSettings(
-        cluster.second.get().info()->name(), "default",
-        cluster.second.get().info()->resourceManager(Upstream::ResourcePriority::Default),
-        response);
-    addCircuitSettings(
-        cluster.second.get().info()->name(), "high",
-        cluster.second.get().info()->resourceManager(Upstream::ResourcePriority::High), response);
-
-    response.add(fmt::format("{}::added_via_api::{}\n", cluster.second.get().info()->name(),
-                             cluster.second.get().info()->addedViaApi()));
-    for (auto& host_set : cluster.second.get().prioritySet().hostSetsPerPriority()) {
-      for (auto& host : host_set->hosts()) {
-        std::map<std::string, uint64_t> all_stats;
-        for (const Stats::CounterSharedPtr& counter : host->counters()) {
-          all_stats[counter->name()] = counter->value();
-        }
+}
 
-        for (const Stats::GaugeSharedPtr& gauge : host->gauges()) {
-          all_stats[gauge->name()] = gauge->value();
-        }
+void ClustersFormatter::formatText(const ClusterSnapshot& cluster, Buffer::Instance& response) {
+  const std::string& name = cluster.info_->name();
+  if (cluster.has_outlier_detector_) {
+    response.add(fmt::format("{}::outlier::success_rate_average::{}\n", name,
+                             cluster.success_rate_average_));
+    response.add(fmt::format("{}::outlier::success_rate_ejection_threshold::{}\n", name,
+                             cluster.success_rate_ejection_threshold_));
+  }
 
-        for (auto stat : all_stats) {
-          response.add(fmt::format("{}::{}::{}::{}\n", cluster.second.get().info()->name(),
-                                   host->address()->asString(), stat.first, stat.second));
-        }
+  addCircuitSettings(name, "default",
+                     cluster.info_->resourceManager(Upstream::ResourcePriority::Default), response);
+  addCircuitSettings(name, "high", cluster.info_->resourceManager(Upstream::ResourcePriority::High),
+                     response);
+
+  response.add(fmt::format("{}::added_via_api::{}\n", name, cluster.info_->addedViaApi()));
+  for (const Upstream::HostVectorConstSharedPtr& hosts : cluster.hosts_) {
+    for (const Upstream::HostSharedPtr& host : *hosts) {
+      std::map<std::string, uint64_t> all_stats;
+      for (const Stats::CounterSharedPtr& counter : host->counters()) {
+        all_stats[counter->name()] = counter->value();
+      }
+
+      for (const Stats::GaugeSharedPtr& gauge : host->gauges()) {
+        all_stats[gauge->name()] = gauge->value();
+      }
 
-        response.add(fmt::format("{}::{}::health_flags::{}\n", cluster.second.get().info()->name(),
-                                 host->address()->asString(),
-                                 Upstream::HostUtility::healthFlagsToString(*host)));
-        response.add(fmt::format("{}::{}::weight::{}\n", cluster.second.get().info()->name(),
-                                 host->address()->asString(), host->weight()));
-        response.add(fmt::format("{}::{}::region::{}\n", cluster.second.get().info()->name(),
-                                 host->address()->asString(), host->locality().region()));
-        response.add(fmt::format("{}::{}::zone::{}\n", cluster.second.get().info()->name(),
-                                 host->address()->asString(), host->locality().zone()));
-        response.add(fmt::format("{}::{}::sub_zone::{}\n", cluster.second.get().info()->name(),
-                                 host->address()->asString(), host->locality().sub_zone()));
-        response.add(fmt::format("{}::{}::canary::{}\n", cluster.second.get().info()->name(),
-                                 host->address()->asString(), host->canary()));
-        response.add(fmt::format("{}::{}::success_rate::{}\n", cluster.second.get().info()->name(),
-                                 host->address()->asString(),
-                                 host->outlierDetector().successRate()));
+      const std::string address = host->address()->asString();
+      for (auto stat : all_stats) {
+        response.add(fmt::format("{}::{}::{}::{}\n", name, address, stat.first, stat.second));
       }
+
+      response.add(fmt::format("{}::{}::health_flags::{}\n", name, address,
+                               Upstream::HostUtility::healthFlagsToString(*host)));
+      response.add(fmt::format("{}::{}::weight::{}\n", name, address, host->weight()));
+      response.add(
+          fmt::format("{}::{}::region::{}\n", name, address, host->locality().region()));
+      response.add(fmt::format("{}::{}::zone::{}\n", name, address, host->locality().zone()));
+      response.add(
+          fmt::format("{}::{}::sub_zone::{}\n", name, address, host->locality().sub_zone()));
+      response.add(fmt::format("{}::{}::canary::{}\n", name, address, host->canary()));
+      response.add(fmt::format("{}::{}::success_rate::{}\n", name, address,
+                               host->outlierDetector().successRate()));
     }
   }
 }
 
+ConfigDumpFormatter::ConfigDumpFormatter(const ConfigTracker& config_tracker,
+                                         const absl::optional<std::regex>& filter)
+    : config_tracker_(config_tracker) {
+  for (const auto& key_callback_pair : config_tracker_.getCallbacksMap()) {
+    if (!filter.has_value() || std::regex_search(key_callback_pair.first, filter.value())) {
+      keys_.push_back(key_callback_pair.first);
+    }
+  }
+}
+
+bool ConfigDumpFormatter::next(Buffer::Instance& response, uint64_t min_bytes) {
+  const uint64_t start_length = response.length();
+  const ConfigTracker::CbsMap& callbacks = config_tracker_.getCallbacksMap();
+  while (next_key_ < keys_.size() && response.length() - start_length < min_bytes) {
+    const auto callback = callbacks.find(keys_[next_key_++]);
+    if (callback == callbacks.end()) {
+      continue;
+    }
+    ProtobufTypes::MessagePtr message = callback->second();
+    RELEASE_ASSERT(message, "");
+    ProtobufWkt::Any any_message;
+    any_message.PackFrom(*message);
+    addJsonArrayElement(any_message, "configs", !formatted_any_, response);
+    formatted_any_ = true;
+  }
+  if (next_key_ < keys_.size()) {
+    return false;
+  }
+  addJsonArrayEnd(!formatted_any_, response);
+  return true;
+}
+
 Http::Code AdminImpl::handlerClusters(absl::string_view url, Http::HeaderMap& response_headers,
-                                      Buffer::Instance& response, AdminStream&) {
-  Http::Utility::QueryParams query_params = Http::Utility::parseQueryString(url);
-  auto it = query_params.find("format");
+                                      Buffer::Instance& response, AdminStream& admin_stream) {
+  const Http::Utility::QueryParams query_params = Http::Utility::parseQueryString(url);
+  absl::optional<std::regex> filter;
+  uint64_t offset = 0;
+  uint64_t limit = 0;
+  if (!regexParam(query_params, "filter", filter) || !uint64Param(query_params, "offset", offset) ||
+      !uint64Param(query_params, "limit", limit)) {
+    response.add("usage: /clusters?format=json&filter=<regex>&offset=<count>&limit=<count>\n");
+    return Http::Code::BadRequest;
+  }
 
-  if (it != query_params.end() && it->second == "json") {
-    writeClustersAsJson(response);
+  auto it = query_params.find("format");
+  const bool json = it != query_params.end() && it->second == "json";
+  if (json) {
     response_headers.insertContentType().value().setReference(
         Http::Headers::get().ContentTypeValues.Json);
-  } else {
-    writeClustersAsText(response);
   }
-
+  formatOrStream(std::make_shared<ClustersFormatter>(server_.clusterManager().clusters(), json,
+                                                     filter, offset, limit),
+                 buffer_response_, response, admin_stream);
   return Http::Code::OK;
 }
 
-// TODO(jsedgwick) Use query params to list available dumps, selectively dump, etc
-Http::Code AdminImpl::handlerConfigDump(absl::string_view, Http::HeaderMap& response_headers,
-                                        Buffer::Instance& response, AdminStream&) const {
-  envoy::admin::v2alpha::ConfigDump dump;
-  for (const auto& key_callback_pair : config_tracker_.getCallbacksMap()) {
-    ProtobufTypes::MessagePtr message = key_callback_pair.second();
-    RELEASE_ASSERT(message, "");
-    auto& any_message = *(dump.add_configs());
-    any_message.PackFrom(*message);
+Http::Code AdminImpl::handlerConfigDump(absl::string_view url, Http::HeaderMap& response_headers,
+                                        Buffer::Instance& response, AdminStream& admin_stream) {
+  const Http::Utility::QueryParams query_params = Http::Utility::parseQueryString(url);
+  absl::optional<std::regex> filter;
+  if (!regexParam(query_params, "filter", filter)) {
+    response.add("usage: /config_dump?filter=<regex>\n");
+    return Http::Code::BadRequest;
   }
 
   response_headers.insertContentType().value().setReference(
       Http::Headers::get().ContentTypeValues.Json);
-  response.add(MessageUtil::getJsonStringFromMessage(dump, true)); // pretty-print
+  formatOrStream(std::make_shared<ConfigDumpFormatter>(config_tracker_, filter), buffer_response_,
+                 response, admin_stream);
   return Http::Code::OK;
 }
 
@@ -500,6 +714,10 @@ Http::Code AdminImpl::handlerCpuProfiler(absl::string_view url, Http::HeaderMap&
   }
 
   bool enable = query_params.begin()->second == "y";
+  if (enable && Profiler::CpuSampler::running()) {
+    response.add("the CPU profiler cannot run while CPU sampling is enabled\n");
+    return Http::Code::BadRequest;
+  }
   if (enable && !Profiler::Cpu::profilerEnabled()) {
     if (!Profiler::Cpu::startProfiler(profile_path_)) {
       response.add("failure to start the profiler");
@@ -514,6 +732,68 @@ Http::Code AdminImpl::handlerCpuProfiler(absl::string_view url, Http::HeaderMap&
   return Http::Code::OK;
 }
 
+Http::Code AdminImpl::handlerCpuSampler(absl::string_view url, Http::HeaderMap&,
+                                        Buffer::Instance& response, AdminStream&) {
+  Http::Utility::QueryParams query_params = Http::Utility::parseQueryString(url);
+  const auto enable = query_params.find("enable");
+  const auto hz = query_params.find("hz");
+  uint64_t frequency_hz = Profiler::CpuSampler::DefaultFrequencyHz;
+  if (enable == query_params.end() || (enable->second != "y" && enable->second != "n") ||
+      query_params.size() != (hz == query_params.end() ? 1 : 2) ||
+      (hz != query_params.end() &&
+       (!StringUtil::atoull(hz->second.c_str(), frequency_hz) || frequency_hz == 0 ||
+        frequency_hz > Profiler::CpuSampler::MaxFrequencyHz))) {
+    response.add(fmt::format("?enable=<y|n>[&hz=<1-{}>]\n", Profiler::CpuSampler::MaxFrequencyHz));
+    return Http::Code::BadRequest;
+  }
+
+  if (enable->second == "n") {
+    Profiler::CpuSampler::stop();
+  } else if (Profiler::Cpu::profilerEnabled()) {
+    response.add("CPU sampling cannot run while the CPU profiler is enabled\n");
+    return Http::Code::BadRequest;
+  } else if (!Profiler::CpuSampler::start(frequency_hz)) {
+    response.add("failure to start CPU sampling\n");
+    return Http::Code::InternalServerError;
+  }
+
+  response.add("OK\n");
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerCpuSamples(absl::string_view, Http::HeaderMap& response_headers,
+                                        Buffer::Instance& response, AdminStream&) {
+  response_headers.insertContentType().value().setReference(
+      Http::Headers::get().ContentTypeValues.OctetStream);
+  response.add(Profiler::CpuSampler::profile());
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerPerfAnnotation(absl::string_view url, Http::HeaderMap&,
+                                            Buffer::Instance& response, AdminStream&) {
+  Http::Utility::QueryParams query_params = Http::Utility::parseQueryString(url);
+  if (query_params.size() != 1 || query_params.begin()->first != "enable" ||
+      (query_params.begin()->second != "y" && query_params.begin()->second != "n")) {
+    response.add("?enable=<y|n>\n");
+    return Http::Code::BadRequest;
+  }
+
+  const bool enable = query_params.begin()->second == "y";
+  if (enable && !PerfAnnotationContext::enabled()) {
+    // Each enablement starts recording from scratch.
+    PerfAnnotationContext::clear();
+  }
+  PerfAnnotationContext::setEnabled(enable);
+  response.add("OK\n");
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerPerfAnnotationDump(absl::string_view, Http::HeaderMap&,
+                                                Buffer::Instance& response, AdminStream&) {
+  response.add(PerfAnnotationContext::toString());
+  return Http::Code::OK;
+}
+
 Http::Code AdminImpl::handlerHeapProfiler(absl::string_view url, Http::HeaderMap&,
                                           Buffer::Instance& response, AdminStream&) {
   if (!Profiler::Heap::profilerEnabled()) {
@@ -618,6 +898,29 @@ Http::Code AdminImpl::handlerMemory(absl::string_view, Http::HeaderMap& response
   memory.set_total_thread_cache(Memory::Stats::totalThreadCacheBytes());
   memory.set_pageheap_unmapped(Memory::Stats::totalPageHeapUnmapped());
   memory.set_pageheap_free(Memory::Stats::totalPageHeapFree());
+
+  uint64_t num_stats = 0;
+  uint64_t stat_name_bytes = 0;
+  const auto add_stat = [&num_stats, &stat_name_bytes](const Stats::Metric& metric) {
+    ++num_stats;
+    stat_name_bytes += metric.statName().size();
+  };
+  for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
+    add_stat(*counter);
+  }
+  for (const Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
+    add_stat(*gauge);
+  }
+  for (const Stats::ParentHistogramSharedPtr& histogram : server_.stats().histograms()) {
+    add_stat(*histogram);
+  }
+  memory.set_num_stats(num_stats);
+  memory.set_stat_name_bytes(stat_name_bytes);
+  memory.set_num_stat_symbols(server_.stats().symbolTable().numSymbols());
+  memory.set_buffer_bytes(Memory::Accounting::bytes(Memory::AccountingTag::Buffer));
+  memory.set_header_map_bytes(Memory::Accounting::bytes(Memory::AccountingTag::HeaderMap));
+  memory.set_stats_bytes(Memory::Accounting::bytes(Memory::AccountingTag::Stats));
+  memory.set_config_bytes(Memory::Accounting::bytes(Memory::AccountingTag::Config));
   response.add(MessageUtil::getJsonStringFromMessage(memory, true, true)); // pretty-print
   return Http::Code::OK;
 }
@@ -721,23 +1024,32 @@ Http::Code AdminImpl::handlerStats(absl::string_view url, Http::HeaderMap& respo
 }
 
 Http::Code AdminImpl::handlerPrometheusStats(absl::string_view path_and_query, Http::HeaderMap&,
-                                             Buffer::Instance& response, AdminStream&) {
+                                             Buffer::Instance& response,
+                                             AdminStream& admin_stream) {
   const Http::Utility::QueryParams params = Http::Utility::parseQueryString(path_and_query);
   const bool used_only = params.find("usedonly") != params.end();
-  PrometheusStatsFormatter::statsAsPrometheus(server_.stats().counters(), server_.stats().gauges(),
-                                              server_.stats().histograms(), response, used_only);
+  const absl::optional<std::string> prefix =
+      (params.find("prefix") != params.end()) ? absl::optional<std::string>{params.at("prefix")}
+                                              : absl::nullopt;
+  auto generator = std::make_shared<PrometheusStatsFormatter::Generator>(
+      server_.stats().counters(), server_.stats().gauges(), server_.stats().histograms(),
+      used_only, prefix, prometheus_name_cache_);
+  formatOrStream(std::move(generator), buffer_response_, response, admin_stream);
   return Http::Code::OK;
 }
 
 std::string PrometheusStatsFormatter::sanitizeName(const std::string& name) {
   // The name must match the regex [a-zA-Z_][a-zA-Z0-9_]* as required by
   // prometheus. Refer to https://prometheus.io/docs/concepts/data_model/.
-  std::string stats_name = std::regex_replace(name, PromRegex, "_");
-  if (stats_name[0] >= '0' && stats_name[0] <= '9') {
-    return fmt::format("_{}", stats_name);
-  } else {
-    return stats_name;
+  std::string stats_name;
+  stats_name.reserve(name.size() + 1);
+  if (!name.empty() && absl::ascii_isdigit(name[0])) {
+    stats_name.push_back('_');
   }
+  for (const char c : name) {
+    stats_name.push_back(absl::ascii_isalnum(c) || c == '_' ? c : '_');
+  }
+  return stats_name;
 }
 
 std::string PrometheusStatsFormatter::formattedTags(const std::vector<Stats::Tag>& tags) {
@@ -755,76 +1067,149 @@ std::string PrometheusStatsFormatter::metricName(const std::string& extractedNam
   return sanitizeName(fmt::format("envoy_{0}", extractedName));
 }
 
-uint64_t PrometheusStatsFormatter::statsAsPrometheus(
-    const std::vector<Stats::CounterSharedPtr>& counters,
-    const std::vector<Stats::GaugeSharedPtr>& gauges,
-    const std::vector<Stats::ParentHistogramSharedPtr>& histograms, Buffer::Instance& response,
-    const bool used_only) {
-  std::unordered_set<std::string> metric_type_tracker;
-  for (const auto& counter : counters) {
-    if (!shouldShowMetric(counter, used_only)) {
-      continue;
+std::string PrometheusStatsFormatter::NameCache::metricName(const std::string& extracted_name) {
+  auto it = metric_names_.find(extracted_name);
+  if (it == metric_names_.end()) {
+    if (metric_names_.size() >= MaxEntries) {
+      metric_names_.clear();
     }
+    it = metric_names_.emplace(extracted_name, PrometheusStatsFormatter::metricName(extracted_name))
+             .first;
+  }
+  return it->second;
+}
 
-    const std::string tags = formattedTags(counter->tags());
-    const std::string metric_name = metricName(counter->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} counter\n", metric_name));
+void PrometheusStatsFormatter::NameCache::appendTagName(const std::string& tag_name,
+                                                        std::string& out) {
+  auto it = tag_names_.find(tag_name);
+  if (it == tag_names_.end()) {
+    if (tag_names_.size() >= MaxEntries) {
+      tag_names_.clear();
     }
-    response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, counter->value()));
+    it = tag_names_.emplace(tag_name, sanitizeName(tag_name)).first;
   }
+  out.append(it->second);
+}
 
-  for (const auto& gauge : gauges) {
-    if (!shouldShowMetric(gauge, used_only)) {
-      continue;
+PrometheusStatsFormatter::Generator::Generator(
+    std::vector<Stats::CounterSharedPtr>&& counters, std::vector<Stats::GaugeSharedPtr>&& gauges,
+    std::vector<Stats::ParentHistogramSharedPtr>&& histograms, bool used_only,
+    const absl::optional<std::string>& prefix, NameCacheSharedPtr name_cache)
+    : counters_(std::move(counters)), gauges_(std::move(gauges)),
+      histograms_(std::move(histograms)), used_only_(used_only), prefix_(prefix),
+      name_cache_(std::move(name_cache)) {}
+
+bool PrometheusStatsFormatter::Generator::next(Buffer::Instance& response, uint64_t min_bytes) {
+  out_.clear();
+  for (; next_counter_ < counters_.size() && out_.size() < min_bytes; ++next_counter_) {
+    const Stats::Counter& counter = *counters_[next_counter_];
+    if (shouldShow(counter)) {
+      formatCounter(counter);
     }
-
-    const std::string tags = formattedTags(gauge->tags());
-    const std::string metric_name = metricName(gauge->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} gauge\n", metric_name));
+  }
+  for (; next_gauge_ < gauges_.size() && out_.size() < min_bytes; ++next_gauge_) {
+    const Stats::Gauge& gauge = *gauges_[next_gauge_];
+    if (shouldShow(gauge)) {
+      formatGauge(gauge);
     }
-    response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, gauge->value()));
   }
-
-  for (const auto& histogram : histograms) {
-    if (!shouldShowMetric(histogram, used_only)) {
-      continue;
+  for (; next_histogram_ < histograms_.size() && out_.size() < min_bytes; ++next_histogram_) {
+    const Stats::ParentHistogram& histogram = *histograms_[next_histogram_];
+    if (shouldShow(histogram)) {
+      formatHistogram(histogram);
     }
+  }
+  response.add(out_);
+  return next_histogram_ == histograms_.size();
+}
 
-    const std::string tags = formattedTags(histogram->tags());
-    const std::string hist_tags = histogram->tags().empty() ? EMPTY_STRING : (tags + ",");
+bool PrometheusStatsFormatter::Generator::shouldShow(const Stats::Metric& metric) const {
+  // Determine whether a metric has never been emitted and choose to not show it if we only
+  // wanted used metrics.
+  if (used_only_ && !metric.used()) {
+    return false;
+  }
+  return !prefix_ || absl::StartsWith(metric.name(), prefix_.value());
+}
 
-    const std::string metric_name = metricName(histogram->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} histogram\n", metric_name));
+void PrometheusStatsFormatter::Generator::formatTags(const std::vector<Stats::Tag>& tags) {
+  tags_.clear();
+  for (const Stats::Tag& tag : tags) {
+    if (!tags_.empty()) {
+      tags_.push_back(',');
     }
+    name_cache_->appendTagName(tag.name_, tags_);
+    absl::StrAppend(&tags_, "=\"", tag.value_, "\"");
+  }
+}
+
+void PrometheusStatsFormatter::Generator::formatType(const std::string& metric_name,
+                                                     absl::string_view type) {
+  if (metric_type_tracker_.insert(metric_name).second) {
+    absl::StrAppend(&out_, "# TYPE ", metric_name, " ", type, "\n");
+  }
+}
 
-    const Stats::HistogramStatistics& stats = histogram->cumulativeStatistics();
-    const std::vector<double>& supported_buckets = stats.supportedBuckets();
-    const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
-    for (size_t i = 0; i < supported_buckets.size(); ++i) {
-      double bucket = supported_buckets[i];
-      uint64_t value = computed_buckets[i];
+void PrometheusStatsFormatter::Generator::formatCounter(const Stats::Counter& counter) {
+  formatTags(counter.tags());
+  const std::string metric_name = name_cache_->metricName(counter.tagExtractedName());
+  formatType(metric_name, "counter");
+  absl::StrAppend(&out_, metric_name, "{", tags_, "} ", counter.value(), "\n");
+}
+
+void PrometheusStatsFormatter::Generator::formatGauge(const Stats::Gauge& gauge) {
+  formatTags(gauge.tags());
+  const std::string metric_name = name_cache_->metricName(gauge.tagExtractedName());
+  formatType(metric_name, "gauge");
+  absl::StrAppend(&out_, metric_name, "{", tags_, "} ", gauge.value(), "\n");
+}
+
+void PrometheusStatsFormatter::Generator::formatHistogram(
+    const Stats::ParentHistogram& histogram) {
+  formatTags(histogram.tags());
+  const std::string hist_tags = histogram.tags().empty() ? EMPTY_STRING : (tags_ + ",");
+  const std::string metric_name = name_cache_->metricName(histogram.tagExtractedName());
+  formatType(metric_name, "histogram");
+
+  const Stats::HistogramStatistics& stats = histogram.cumulativeStatistics();
+  const std::vector<double>& supported_buckets = stats.supportedBuckets();
+  const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
+  if (formatted_buckets_source_ != &supported_buckets) {
+    formatted_buckets_source_ = &supported_buckets;
+    formatted_buckets_.clear();
+    for (const double bucket : supported_buckets) {
       // We want to print the bucket in a fixed point (non-scientific) format. The fmt library
       // doesn't have a specific modifier to format as a fixed-point value only so we use the
       // 'g' operator which prints the number in general fixed point format or scientific format
       // with precision 50 to round the number up to 32 significant digits in fixed point format
       // which should cover pretty much all cases
-      response.add(fmt::format("{0}_bucket{{{1}le=\"{2:.32g}\"}} {3}\n", metric_name, hist_tags,
-                               bucket, value));
+      formatted_buckets_.push_back(fmt::format("{:.32g}", bucket));
     }
-
-    response.add(fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", metric_name, hist_tags,
-                             stats.sampleCount()));
-    response.add(fmt::format("{0}_sum{{{1}}} {2}\n", metric_name, tags, stats.sampleSum()));
-    response.add(fmt::format("{0}_count{{{1}}} {2}\n", metric_name, tags, stats.sampleCount()));
+  }
+  for (size_t i = 0; i < supported_buckets.size(); ++i) {
+    absl::StrAppend(&out_, metric_name, "_bucket{", hist_tags, "le=\"", formatted_buckets_[i],
+                    "\"} ", computed_buckets[i], "\n");
   }
 
-  return metric_type_tracker.size();
+  absl::StrAppend(&out_, metric_name, "_bucket{", hist_tags, "le=\"+Inf\"} ",
+                  fmt::format("{}", stats.sampleCount()), "\n");
+  absl::StrAppend(&out_, metric_name, "_sum{", tags_, "} ", fmt::format("{}", stats.sampleSum()),
+                  "\n");
+  absl::StrAppend(&out_, metric_name, "_count{", tags_, "} ",
+                  fmt::format("{}", stats.sampleCount()), "\n");
+}
+
+uint64_t PrometheusStatsFormatter::statsAsPrometheus(
+    const std::vector<Stats::CounterSharedPtr>& counters,
+    const std::vector<Stats::GaugeSharedPtr>& gauges,
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms, Buffer::Instance& response,
+    const bool used_only, const absl::optional<std::string>& prefix) {
+  Generator generator(std::vector<Stats::CounterSharedPtr>(counters),
+                      std::vector<Stats::GaugeSharedPtr>(gauges),
+                      std::vector<Stats::ParentHistogramSharedPtr>(histograms), used_only, prefix,
+                      std::make_shared<NameCache>());
+  generator.next(response, std::numeric_limits<uint64_t>::max());
+  return generator.metricTypes();
 }
 
 std::string
@@ -1123,6 +1508,10 @@ AdminImpl::AdminImpl(const std::string& profile_path, Server::Instance& server)
            MAKE_ADMIN_HANDLER(handlerContention), false, false},
           {"/cpuprofiler", "enable/disable the CPU profiler",
            MAKE_ADMIN_HANDLER(handlerCpuProfiler), false, true},
+          {"/cpuprofiler/sampling", "enable/disable continuous CPU sampling",
+           MAKE_ADMIN_HANDLER(handlerCpuSampler), false, true},
+          {"/cpuprofiler/samples", "download the recent CPU samples as a profile for pprof",
+           MAKE_ADMIN_HANDLER(handlerCpuSamples), false, false},
           {"/heapprofiler", "enable/disable the heap profiler",
            MAKE_ADMIN_HANDLER(handlerHeapProfiler), false, true},
           {"/healthcheck/fail", "cause the server to fail health checks",
@@ -1137,6 +1526,10 @@ AdminImpl::AdminImpl(const std::string& profile_path, Server::Instance& server)
            true},
           {"/memory", "print current allocation/heap usage", MAKE_ADMIN_HANDLER(handlerMemory),
            false, false},
+          {"/perf_annotation", "enable/disable the recording of perf annotations",
+           MAKE_ADMIN_HANDLER(handlerPerfAnnotation), false, true},
+          {"/perf_annotation/dump", "print the recorded perf annotations",
+           MAKE_ADMIN_HANDLER(handlerPerfAnnotationDump), false, false},
           {"/quitquitquit", "exit the server", MAKE_ADMIN_HANDLER(handlerQuitQuitQuit), false,
            true},
           {"/reset_counters", "reset all counters to zero",
@@ -1153,7 +1546,8 @@ AdminImpl::AdminImpl(const std::string& profile_path, Server::Instance& server)
            false, true},
       },
       date_provider_(server.dispatcher().timeSource()),
-      admin_filter_chain_(std::make_shared<AdminFilterChain>()) {}
+      admin_filter_chain_(std::make_shared<AdminFilterChain>()),
+      prometheus_name_cache_(std::make_shared<PrometheusStatsFormatter::NameCache>()) {}
 
 Http::ServerConnectionPtr AdminImpl::createCodec(Network::Connection& connection,
                                                  const Buffer::Instance& data,
@@ -1334,7 +1728,9 @@ Http::Code AdminImpl::request(absl::string_view path_and_query, absl::string_vie
   filter.decodeHeaders(request_headers, false);
   Buffer::OwnedImpl response;
 
+  buffer_response_ = true;
   Http::Code code = runCallback(path_and_query, response_headers, response, filter);
+  buffer_response_ = false;
   populateFallbackResponseHeaders(code, response_headers);
   body = response.toString();
   return code;
@@ -2,8 +2,11 @@
 
 #include <chrono>
 #include <list>
+#include <memory>
+#include <regex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -13,9 +16,11 @@
 #include "envoy/network/listen_socket.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/server/admin.h"
+#include "envoy/server/config_tracker.h"
 #include "envoy/server/instance.h"
 #include "envoy/server/listener_manager.h"
 #include "envoy/stats/scope.h"
+#include "envoy/upstream/cluster_manager.h"
 #include "envoy/upstream/outlier_detection.h"
 #include "envoy/upstream/resource_manager.h"
 
@@ -26,12 +31,15 @@
 #include "common/http/date_provider_impl.h"
 #include "common/http/default_server_string.h"
 #include "common/http/utility.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/stats/isolated_store_impl.h"
 
 #include "server/http/config_tracker_impl.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Server {
@@ -40,6 +48,187 @@ class AdminInternalAddressConfig : public Http::InternalAddressConfig {
   bool isInternalAddress(const Network::Address::Instance&) const override { return false; }
 };
 
+/**
+ * Formatter for metric/labels exported to Prometheus.
+ *
+ * See: https://prometheus.io/docs/concepts/data_model
+ */
+class PrometheusStatsFormatter {
+public:
+  /**
+   * Caches the sanitized names of metric families and tags. These are shared by many metrics and
+   * don't change between scrapes, so this saves sanitizing every name on every scrape.
+   */
+  class NameCache {
+  public:
+    /**
+     * @return std::string the Prometheus metric name for a tag extracted stat name.
+     */
+    std::string metricName(const std::string& extracted_name);
+    /**
+     * Appends the sanitized form of a tag name to out.
+     */
+    void appendTagName(const std::string& tag_name, std::string& out);
+
+  private:
+    // Names with no tags extracted can churn with the config, so the caches are bounded by simply
+    // starting over when they get this big.
+    static constexpr size_t MaxEntries = 64 * 1024;
+
+    absl::flat_hash_map<std::string, std::string> metric_names_;
+    absl::flat_hash_map<std::string, std::string> tag_names_;
+  };
+  typedef std::shared_ptr<NameCache> NameCacheSharedPtr;
+
+  /**
+   * Formats a snapshot of stats a chunk at a time, so that large outputs can be streamed.
+   */
+  class Generator {
+  public:
+    Generator(std::vector<Stats::CounterSharedPtr>&& counters,
+              std::vector<Stats::GaugeSharedPtr>&& gauges,
+              std::vector<Stats::ParentHistogramSharedPtr>&& histograms, bool used_only,
+              const absl::optional<std::string>& prefix, NameCacheSharedPtr name_cache);
+
+    /**
+     * Appends the next metrics to response, stopping once at least min_bytes have been added.
+     * @return bool whether all metrics have been formatted.
+     */
+    bool next(Buffer::Instance& response, uint64_t min_bytes);
+
+    /**
+     * @return uint64_t the number of metric types formatted so far.
+     */
+    uint64_t metricTypes() const { return metric_type_tracker_.size(); }
+
+  private:
+    bool shouldShow(const Stats::Metric& metric) const;
+    void formatTags(const std::vector<Stats::Tag>& tags);
+    void formatType(const std::string& metric_name, absl::string_view type);
+    void formatCounter(const Stats::Counter& counter);
+    void formatGauge(const Stats::Gauge& gauge);
+    void formatHistogram(const Stats::ParentHistogram& histogram);
+
+    const std::vector<Stats::CounterSharedPtr> counters_;
+    const std::vector<Stats::GaugeSharedPtr> gauges_;
+    const std::vector<Stats::ParentHistogramSharedPtr> histograms_;
+    const bool used_only_;
+    const absl::optional<std::string> prefix_;
+    NameCacheSharedPtr name_cache_;
+    size_t next_counter_{};
+    size_t next_gauge_{};
+    size_t next_histogram_{};
+    std::unordered_set<std::string> metric_type_tracker_;
+    // The output being built, and the tags of the metric being formatted.
+    std::string out_;
+    std::string tags_;
+    // All histograms share the same bucket bounds, so they are only formatted once.
+    const std::vector<double>* formatted_buckets_source_{};
+    std::vector<std::string> formatted_buckets_;
+  };
+
+  /**
+   * Extracts counters and gauges and relevant tags, appending them to
+   * the response buffer after sanitizing the metric / label names.
+   * @return uint64_t total number of metric types inserted in response.
+   */
+  static uint64_t statsAsPrometheus(const std::vector<Stats::CounterSharedPtr>& counters,
+                                    const std::vector<Stats::GaugeSharedPtr>& gauges,
+                                    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+                                    Buffer::Instance& response, const bool used_only,
+                                    const absl::optional<std::string>& prefix = absl::nullopt);
+  /**
+   * Format the given tags, returning a string as a comma-separated list
+   * of <tag_name>="<tag_value>" pairs.
+   */
+  static std::string formattedTags(const std::vector<Stats::Tag>& tags);
+  /**
+   * Format the given metric name, prefixed with "envoy_".
+   */
+  static std::string metricName(const std::string& extractedName);
+
+private:
+  /**
+   * Take a string and sanitize it according to Prometheus conventions.
+   */
+  static std::string sanitizeName(const std::string& name);
+};
+
+/**
+ * Formats the /clusters output a chunk at a time, so that large outputs can be streamed. The
+ * formatter holds a snapshot of the parts of the clusters that the output needs, so clusters that
+ * are removed while the output is streamed are still formatted.
+ */
+class ClustersFormatter {
+public:
+  /**
+   * @param clusters supplies the clusters to format, in name order.
+   * @param json supplies whether to format as JSON rather than as text.
+   * @param filter supplies the regex that the names of the formatted clusters must contain.
+   * @param offset supplies the number of matching clusters to skip.
+   * @param limit supplies the maximum number of clusters to format, or 0 for all of them.
+   */
+  ClustersFormatter(const Upstream::ClusterManager::ClusterInfoMap& clusters, bool json,
+                    const absl::optional<std::regex>& filter, uint64_t offset, uint64_t limit);
+
+  /**
+   * Appends the next clusters to response, stopping once at least min_bytes have been added.
+   * @return bool whether all clusters have been formatted.
+   */
+  bool next(Buffer::Instance& response, uint64_t min_bytes);
+
+private:
+  struct ClusterSnapshot {
+    Upstream::ClusterInfoConstSharedPtr info_;
+    bool has_outlier_detector_{};
+    double success_rate_average_{};
+    double success_rate_ejection_threshold_{};
+    // The hosts of each priority.
+    std::vector<Upstream::HostVectorConstSharedPtr> hosts_;
+  };
+
+  static void formatJson(const ClusterSnapshot& cluster,
+                         envoy::admin::v2alpha::ClusterStatus& cluster_status);
+  static void formatText(const ClusterSnapshot& cluster, Buffer::Instance& response);
+  static void addCircuitSettings(const std::string& cluster_name, const std::string& priority_str,
+                                 Upstream::ResourceManager& resource_manager,
+                                 Buffer::Instance& response);
+
+  const bool json_;
+  std::vector<ClusterSnapshot> clusters_;
+  size_t next_cluster_{};
+};
+
+/**
+ * Formats the /config_dump output a config at a time, so that large outputs can be streamed. The
+ * dump of each config tracker entry is only taken once the previous ones have been formatted, so
+ * only one of them is held in memory at a time.
+ */
+class ConfigDumpFormatter {
+public:
+  /**
+   * @param config_tracker supplies the tracker of the configs to dump, which must outlive the
+   *        formatter.
+   * @param filter supplies the regex that the keys of the dumped config tracker entries must
+   *        contain.
+   */
+  ConfigDumpFormatter(const ConfigTracker& config_tracker,
+                      const absl::optional<std::regex>& filter);
+
+  /**
+   * Appends the next configs to response, stopping once at least min_bytes have been added.
+   * @return bool whether all configs have been formatted.
+   */
+  bool next(Buffer::Instance& response, uint64_t min_bytes);
+
+private:
+  const ConfigTracker& config_tracker_;
+  // The keys of the entries to dump. Entries that are removed before they are reached are skipped.
+  std::vector<std::string> keys_;
+  size_t next_key_{};
+  bool formatted_any_{};
+};
+
 /**
  * Implementation of Server::Admin.
  */
@@ -81,6 +270,10 @@ public:
   createNetworkFilterChain(Network::Connection& connection,
                            const std::vector<Network::FilterFactoryCb>& filter_factories) override;
   bool createListenerFilterChain(Network::ListenerFilterManager&) override { return true; }
+  bool createUdpListenerFilterChain(Network::UdpListenerFilterManager&,
+                                    Network::UdpReadFilterCallbacks&) override {
+    return true;
+  }
 
   // Http::FilterChainFactory
   void createFilterChain(Http::FilterChainFactoryCallbacks& callbacks) override;
@@ -99,6 +292,7 @@ public:
   Http::FilterChainFactory& filterFactory() override { return *this; }
   bool generateRequestId() override { return false; }
   absl::optional<std::chrono::milliseconds> idleTimeout() const override { return idle_timeout_; }
+  absl::optional<std::chrono::milliseconds> idleCompactionTimeout() const override { return {}; }
   uint32_t maxRequestHeadersKb() const override { return max_request_headers_kb_; }
   std::chrono::milliseconds streamIdleTimeout() const override { return {}; }
   std::chrono::milliseconds requestTimeout() const override { return {}; }
@@ -126,6 +320,7 @@ public:
   Http::ConnectionManagerListenerStats& listenerStats() override { return listener_->stats_; }
   bool proxy100Continue() const override { return false; }
   const Http::Http1Settings& http1Settings() const override { return http1_settings_; }
+  Http::RouteCache* routeCache() override { return nullptr; }
   Http::Code request(absl::string_view path_and_query, absl::string_view method,
                      Http::HeaderMap& response_headers, std::string& body) override;
   void closeSocket();
@@ -167,17 +362,6 @@ private:
    */
   bool changeLogLevel(const Http::Utility::QueryParams& params);
 
-  /**
-   * Helper methods for the /clusters url handler.
-   */
-  void addCircuitSettings(const std::string& cluster_name, const std::string& priority_str,
-                          Upstream::ResourceManager& resource_manager, Buffer::Instance& response);
-  void addOutlierInfo(const std::string& cluster_name,
-                      const Upstream::Outlier::Detector* outlier_detector,
-                      Buffer::Instance& response);
-  void writeClustersAsJson(Buffer::Instance& response);
-  void writeClustersAsText(Buffer::Instance& response);
-
   static bool shouldShowMetric(const std::shared_ptr<Stats::Metric>& metric, const bool used_only,
                                const absl::optional<std::regex>& regex) {
     return ((!used_only || metric->used()) &&
@@ -204,14 +388,24 @@ private:
   Http::Code handlerClusters(absl::string_view path_and_query, Http::HeaderMap& response_headers,
                              Buffer::Instance& response, AdminStream&);
   Http::Code handlerConfigDump(absl::string_view path_and_query, Http::HeaderMap& response_headers,
-                               Buffer::Instance& response, AdminStream&) const;
+                               Buffer::Instance& response, AdminStream&);
   Http::Code handlerContention(absl::string_view path_and_query, Http::HeaderMap& response_headers,
                                Buffer::Instance& response, AdminStream&);
   Http::Code handlerCpuProfiler(absl::string_view path_and_query, Http::HeaderMap& response_headers,
                                 Buffer::Instance& response, AdminStream&);
+  Http::Code handlerCpuSampler(absl::string_view path_and_query, Http::HeaderMap& response_headers,
+                               Buffer::Instance& response, AdminStream&);
+  Http::Code handlerCpuSamples(absl::string_view path_and_query, Http::HeaderMap& response_headers,
+                               Buffer::Instance& response, AdminStream&);
   Http::Code handlerHeapProfiler(absl::string_view path_and_query,
                                  Http::HeaderMap& response_headers, Buffer::Instance& response,
                                  AdminStream&);
+  Http::Code handlerPerfAnnotation(absl::string_view path_and_query,
+                                   Http::HeaderMap& response_headers, Buffer::Instance& response,
+                                   AdminStream&);
+  Http::Code handlerPerfAnnotationDump(absl::string_view path_and_query,
+                                       Http::HeaderMap& response_headers,
+                                       Buffer::Instance& response, AdminStream&);
   Http::Code handlerHealthcheckFail(absl::string_view path_and_query,
                                     Http::HeaderMap& response_headers, Buffer::Instance& response,
                                     AdminStream&);
@@ -270,11 +464,16 @@ private:
     Stats::Scope& listenerScope() override { return *scope_; }
     uint64_t listenerTag() const override { return 0; }
     const std::string& name() const override { return name_; }
+    Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
+    uint32_t maxConnectionsToAcceptPerSocketEvent() const override {
+      return Network::DefaultMaxConnectionsToAcceptPerSocketEvent;
+    }
 
     AdminImpl& parent_;
     const std::string name_;
     Stats::ScopePtr scope_;
     Http::ConnectionManagerListenerStats stats_;
+    Network::NopConnectionBalancerImpl connection_balancer_;
   };
   using AdminListenerPtr = std::unique_ptr<AdminListener>;
 
@@ -317,6 +516,9 @@ private:
   Network::SocketPtr socket_;
   AdminListenerPtr listener_;
   const AdminInternalAddressConfig internal_address_config_;
+  const PrometheusStatsFormatter::NameCacheSharedPtr prometheus_name_cache_;
+  // Set while serving request(), which has no stream to stream a response over.
+  bool buffer_response_{};
 };
 
 /**
@@ -362,46 +564,5 @@ private:
   bool end_stream_on_complete_ = true;
 };
 
-/**
- * Formatter for metric/labels exported to Prometheus.
- *
- * See: https://prometheus.io/docs/concepts/data_model
- */
-class PrometheusStatsFormatter {
-public:
-  /**
-   * Extracts counters and gauges and relevant tags, appending them to
-   * the response buffer after sanitizing the metric / label names.
-   * @return uint64_t total number of metric types inserted in response.
-   */
-  static uint64_t statsAsPrometheus(const std::vector<Stats::CounterSharedPtr>& counters,
-                                    const std::vector<Stats::GaugeSharedPtr>& gauges,
-                                    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
-                                    Buffer::Instance& response, const bool used_only);
-  /**
-   * Format the given tags, returning a string as a comma-separated list
-   * of <tag_name>="<tag_value>" pairs.
-   */
-  static std::string formattedTags(const std::vector<Stats::Tag>& tags);
-  /**
-   * Format the given metric name, prefixed with "envoy_".
-   */
-  static std::string metricName(const std::string& extractedName);
-
-private:
-  /**
-   * Take a string and sanitize it according to Prometheus conventions.
-   */
-  static std::string sanitizeName(const std::string& name);
-
-  /*
-   * Determine whether a metric has never been emitted and choose to
-   * not show it if we only wanted used metrics.
-   */
-  static bool shouldShowMetric(const std::shared_ptr<Stats::Metric>& metric, const bool used_only) {
-    return !used_only || metric->used();
-  }
-};
-
 } // namespace Server
 } // namespace Envoy
@@ -20,7 +20,8 @@ LdsApiImpl::LdsApiImpl(const envoy::api::v2::core::ConfigSource& lds_config,
                        Runtime::RandomGenerator& random, Init::Manager& init_manager,
                        const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
                        ListenerManager& lm, Api::Api& api)
-    : listener_manager_(lm), scope_(scope.createScope("listener_manager.lds.")), cm_(cm),
+    : listener_manager_(lm), scope_(scope.createScope("listener_manager.lds.")),
+      validation_cache_(*scope_, api.timeSource()), cm_(cm),
       init_target_("LDS", [this]() { subscription_->start({}, *this); }) {
   subscription_ =
       Envoy::Config::SubscriptionFactory::subscriptionFromConfigSource<envoy::api::v2::Listener>(
@@ -41,9 +42,8 @@ void LdsApiImpl::onConfigUpdate(const ResourceVector& resources, const std::stri
       throw EnvoyException(fmt::format("duplicate listener {} found", listener.name()));
     }
   }
-  for (const auto& listener : resources) {
-    MessageUtil::validate(listener);
-  }
+  // Management servers usually send every listener with each update, most of them unchanged.
+  validation_cache_.validate(resources);
   // We need to keep track of which listeners we might need to remove.
   std::unordered_map<std::string, std::reference_wrapper<Network::ListenerConfig>>
       listeners_to_remove;
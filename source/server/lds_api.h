@@ -10,6 +10,7 @@
 #include "envoy/stats/scope.h"
 
 #include "common/common/logger.h"
+#include "common/config/validation_cache.h"
 #include "common/init/target_impl.h"
 
 namespace Envoy {
@@ -47,6 +48,7 @@ private:
   std::string version_info_;
   ListenerManager& listener_manager_;
   Stats::ScopePtr scope_;
+  Config::ValidationCache validation_cache_;
   Upstream::ClusterManager& cm_;
   Init::TargetImpl init_target_;
 };
@@ -16,6 +16,7 @@
 #include "common/network/socket_option_factory.h"
 #include "common/network/utility.h"
 #include "common/protobuf/utility.h"
+#include "common/ssl/tls_certificate_config_impl.h"
 
 #include "server/configuration_impl.h"
 #include "server/drain_manager_impl.h"
@@ -98,15 +99,34 @@ ProdListenerComponentFactory::createListenerFilterFactoryList_(
   return ret;
 }
 
+std::vector<Network::UdpListenerFilterFactoryCb>
+ProdListenerComponentFactory::createUdpListenerFilterFactoryList_(
+    const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
+    Configuration::ListenerFactoryContext& context) {
+  std::vector<Network::UdpListenerFilterFactoryCb> ret;
+  for (ssize_t i = 0; i < filters.size(); i++) {
+    const auto& proto_config = filters[i];
+    ENVOY_LOG(debug, "  udp filter #{}:", i);
+    ENVOY_LOG(debug, "    name: {}", proto_config.name());
+
+    auto& factory =
+        Config::Utility::getAndCheckFactory<Configuration::NamedUdpListenerFilterConfigFactory>(
+            proto_config.name());
+    auto message = Config::Utility::translateToFactoryConfig(proto_config, factory);
+    ret.push_back(factory.createFilterFactoryFromProto(*message, context));
+  }
+  return ret;
+}
+
 Network::SocketSharedPtr ProdListenerComponentFactory::createListenSocket(
     Network::Address::InstanceConstSharedPtr address, Network::Address::SocketType socket_type,
-    const Network::Socket::OptionsSharedPtr& options, bool bind_to_port) {
+    const Network::Socket::OptionsSharedPtr& options, bool bind_to_port, uint32_t worker_index) {
   ASSERT(address->type() == Network::Address::Type::Ip ||
          address->type() == Network::Address::Type::Pipe);
   ASSERT(socket_type == Network::Address::SocketType::Stream ||
          socket_type == Network::Address::SocketType::Datagram);
 
-  // For each listener config we share a single socket among all threaded listeners.
+  // Unless the listener uses reuse_port, we share a single socket among all threaded listeners.
   // First we try to get the socket from our parent if applicable.
   if (address->type() == Network::Address::Type::Pipe) {
     if (socket_type != Network::Address::SocketType::Stream) {
@@ -117,7 +137,7 @@ Network::SocketSharedPtr ProdListenerComponentFactory::createListenSocket(
           fmt::format("socket type {} not supported for pipes", toString(socket_type)));
     }
     const std::string addr = fmt::format("unix://{}", address->asString());
-    const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+    const int fd = server_.hotRestart().duplicateParentListenSocket(addr, worker_index);
     Network::IoHandlePtr io_handle = std::make_unique<Network::IoSocketHandleImpl>(fd);
     if (io_handle->isOpen()) {
       ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
@@ -130,7 +150,7 @@ Network::SocketSharedPtr ProdListenerComponentFactory::createListenSocket(
                                  ? Network::Utility::TCP_SCHEME
                                  : Network::Utility::UDP_SCHEME;
   const std::string addr = absl::StrCat(scheme, address->asString());
-  const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+  const int fd = server_.hotRestart().duplicateParentListenSocket(addr, worker_index);
   if (fd != -1) {
     ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
     Network::IoHandlePtr io_handle = std::make_unique<Network::IoSocketHandleImpl>(fd);
@@ -154,19 +174,28 @@ ProdListenerComponentFactory::createDrainManager(envoy::api::v2::Listener::Drain
 
 ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::string& version_info,
                            ListenerManagerImpl& parent, const std::string& name, bool modifiable,
-                           bool workers_started, uint64_t hash)
+                           bool workers_started, uint64_t hash, ListenerImpl* origin)
     : parent_(parent), address_(Network::Address::resolveProtoAddress(config.address())),
       socket_type_(Network::Utility::protobufAddressSocketType(config.address())),
-      global_scope_(parent_.server_.stats().createScope("")),
-      listener_scope_(
-          parent_.server_.stats().createScope(fmt::format("listener.{}.", address_->asString()))),
+      global_scope_(origin != nullptr
+                        ? origin->global_scope_
+                        : Stats::ScopeSharedPtr(parent_.server_.stats().createScope(""))),
+      listener_scope_(origin != nullptr
+                          ? origin->listener_scope_
+                          : Stats::ScopeSharedPtr(parent_.server_.stats().createScope(
+                                fmt::format("listener.{}.", address_->asString())))),
       bind_to_port_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.deprecated_v1(), bind_to_port, true)),
+      reuse_port_(config.reuse_port() && bind_to_port_),
       hand_off_restored_destination_connections_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
       per_connection_buffer_limit_bytes_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
-      listener_tag_(parent_.factory_.nextListenerTag()), name_(name), modifiable_(modifiable),
-      workers_started_(workers_started), hash_(hash),
+      max_connections_to_accept_per_socket_event_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connections_to_accept_per_socket_event,
+                                          Network::DefaultMaxConnectionsToAcceptPerSocketEvent)),
+      listener_tag_(origin != nullptr ? origin->listener_tag_ : parent_.factory_.nextListenerTag()),
+      name_(name), modifiable_(modifiable), workers_started_(workers_started), hash_(hash),
+      filter_chain_only_update_(origin != nullptr),
       dynamic_init_manager_(fmt::format("Listener {}", name)),
       init_watcher_(std::make_unique<Init::WatcherImpl>(
           "ListenerImpl", [this] { parent_.onListenerWarmed(*this); })),
@@ -185,14 +214,61 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
         config.tcp_fast_open_queue_length().value()));
   }
 
+  if (reuse_port_) {
+    if (address_->type() != Network::Address::Type::Ip) {
+      throw EnvoyException(
+          fmt::format("error adding listener '{}': reuse_port is only supported for IP listeners",
+                      address_->asString()));
+    }
+    addListenSocketOptions(Network::SocketOptionFactory::buildReusePortOptions());
+  }
+
+  const auto flow_key = config.reuse_port_steering().flow_key();
+  if (flow_key != envoy::api::v2::Listener::ReusePortSteering::FIVE_TUPLE) {
+    if (!config.reuse_port() || socket_type_ != Network::Address::SocketType::Datagram) {
+      throw EnvoyException(fmt::format("error adding listener '{}': reuse_port_steering is only "
+                                       "supported for UDP listeners that use reuse_port",
+                                       address_->asString()));
+    }
+    // The program belongs to the reuse_port group, to which every worker socket attaches the same
+    // one.
+    if (reuse_port_) {
+      addListenSocketOptions(Network::SocketOptionFactory::buildReusePortSteeringOptions(
+          flow_key == envoy::api::v2::Listener::ReusePortSteering::SOURCE_IP
+              ? Network::ReusePortFlowKey::SourceIp
+              : Network::ReusePortFlowKey::QuicConnectionId,
+          parent_.server_.options().concurrency()));
+    }
+  }
+
+  // The workers' listener stays registered with the balancer of the origin.
+  if (origin != nullptr) {
+    connection_balancer_ = origin->connection_balancer_;
+  } else if (config.connection_balance_config().has_exact_balance()) {
+    connection_balancer_ = std::make_unique<Network::ExactConnectionBalancerImpl>();
+  } else {
+    connection_balancer_ = std::make_unique<Network::NopConnectionBalancerImpl>();
+  }
+
   if (config.socket_options().size() > 0) {
     addListenSocketOptions(
         Network::SocketOptionFactory::buildLiteralOptions(config.socket_options()));
   }
 
   if (!config.listener_filters().empty()) {
-    listener_filter_factories_ =
-        parent_.factory_.createListenerFilterFactoryList(config.listener_filters(), *this);
+    // The listener filter of a UDP listener handles its datagrams, as there are no connections.
+    if (socket_type_ == Network::Address::SocketType::Datagram) {
+      if (config.listener_filters().size() > 1) {
+        throw EnvoyException(fmt::format(
+            "error adding listener '{}': a UDP listener supports a single listener filter",
+            address_->asString()));
+      }
+      udp_listener_filter_factories_ =
+          parent_.factory_.createUdpListenerFilterFactoryList(config.listener_filters(), *this);
+    } else {
+      listener_filter_factories_ =
+          parent_.factory_.createListenerFilterFactoryList(config.listener_filters(), *this);
+    }
   }
   // Add original dst listener filter if 'use_original_dst' flag is set.
   if (PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)) {
@@ -218,7 +294,17 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
   std::unordered_set<envoy::api::v2::listener::FilterChainMatch, MessageUtil, MessageUtil>
       filter_chains;
 
+  std::vector<uint64_t> filter_chain_hashes;
+  filter_chain_hashes.reserve(config.filter_chains().size());
   for (const auto& filter_chain : config.filter_chains()) {
+    filter_chain_hashes.push_back(MessageUtil::hash(filter_chain));
+  }
+  // Keeps the certificates of the new filter chains parsed until their TLS contexts are built.
+  const Ssl::CertificatePrefetchPtr certificate_prefetch =
+      prefetchCertificates(config, filter_chain_hashes, origin);
+
+  for (int i = 0; i < config.filter_chains().size(); i++) {
+    const auto& filter_chain = config.filter_chains()[i];
     const auto& filter_chain_match = filter_chain.filter_chain_match();
     if (filter_chains.find(filter_chain_match) != filter_chains.end()) {
       throw EnvoyException(fmt::format("error adding listener '{}': multiple filter chains with "
@@ -227,25 +313,6 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
     }
     filter_chains.insert(filter_chain_match);
 
-    // If the cluster doesn't have transport socket configured, then use the default "raw_buffer"
-    // transport socket or BoringSSL-based "tls" transport socket if TLS settings are configured.
-    // We copy by value first then override if necessary.
-    auto transport_socket = filter_chain.transport_socket();
-    if (!filter_chain.has_transport_socket()) {
-      if (filter_chain.has_tls_context()) {
-        transport_socket.set_name(Extensions::TransportSockets::TransportSocketNames::get().Tls);
-        MessageUtil::jsonConvert(filter_chain.tls_context(), *transport_socket.mutable_config());
-      } else {
-        transport_socket.set_name(
-            Extensions::TransportSockets::TransportSocketNames::get().RawBuffer);
-      }
-    }
-
-    auto& config_factory = Config::Utility::getAndCheckFactory<
-        Server::Configuration::DownstreamTransportSocketConfigFactory>(transport_socket.name());
-    ProtobufTypes::MessagePtr message =
-        Config::Utility::translateToFactoryConfig(transport_socket, config_factory);
-
     // Validate IP addresses.
     std::vector<std::string> destination_ips;
     for (const auto& destination_ip : filter_chain_match.prefix_ranges()) {
@@ -269,18 +336,25 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
     std::vector<std::string> application_protocols(
         filter_chain_match.application_protocols().begin(),
         filter_chain_match.application_protocols().end());
-    Server::Configuration::TransportSocketFactoryContextImpl factory_context(
-        parent_.server_.admin(), parent_.server_.sslContextManager(), *listener_scope_,
-        parent_.server_.clusterManager(), parent_.server_.localInfo(), parent_.server_.dispatcher(),
-        parent_.server_.random(), parent_.server_.stats(), parent_.server_.singletonManager(),
-        parent_.server_.threadLocal(), parent_.server_.api());
-    factory_context.setInitManager(initManager());
-    addFilterChain(
-        PROTOBUF_GET_WRAPPED_OR_DEFAULT(filter_chain_match, destination_port, 0), destination_ips,
-        server_names, filter_chain_match.transport_protocol(), application_protocols,
-        filter_chain_match.source_type(),
-        config_factory.createTransportSocketFactory(*message, factory_context, server_names),
-        parent_.factory_.createNetworkFilterFactoryList(filter_chain.filters(), *this));
+
+    // Reuse the filter chain of the origin if its config is unchanged, which keeps its transport
+    // socket factory (e.g. TLS contexts), its filter factories and the connections on it.
+    const uint64_t filter_chain_hash = filter_chain_hashes[i];
+    FilterChainImplSharedPtr filter_chain_impl;
+    if (origin != nullptr) {
+      auto existing_filter_chain = origin->filter_chains_by_hash_.find(filter_chain_hash);
+      if (existing_filter_chain != origin->filter_chains_by_hash_.end()) {
+        filter_chain_impl = existing_filter_chain->second;
+      }
+    }
+    if (filter_chain_impl == nullptr) {
+      filter_chain_impl = createFilterChain(filter_chain, server_names);
+    }
+    filter_chains_by_hash_.emplace(filter_chain_hash, filter_chain_impl);
+
+    addFilterChain(PROTOBUF_GET_WRAPPED_OR_DEFAULT(filter_chain_match, destination_port, 0),
+                   destination_ips, server_names, filter_chain_match.transport_protocol(),
+                   application_protocols, filter_chain_match.source_type(), filter_chain_impl);
 
     need_tls_inspector |= filter_chain_match.transport_protocol() == "tls" ||
                           (filter_chain_match.transport_protocol().empty() &&
@@ -329,15 +403,97 @@ bool ListenerImpl::isWildcardServerName(const std::string& name) {
   return absl::StartsWith(name, "*.");
 }
 
+Ssl::CertificatePrefetchPtr
+ListenerImpl::prefetchCertificates(const envoy::api::v2::Listener& config,
+                                   const std::vector<uint64_t>& filter_chain_hashes,
+                                   const ListenerImpl* origin) {
+  // Parsing the certificates takes most of the time of building the TLS contexts of listeners with
+  // many filter chains, so the certificates of the filter chains that aren't reused are parsed
+  // ahead of building their contexts, spread over as many threads as there are workers. Only the
+  // static certificates of the tls_context field are prefetched, the others are parsed when their
+  // contexts are built.
+  std::vector<std::unique_ptr<Ssl::TlsCertificateConfigImpl>> tls_certificates;
+  for (int i = 0; i < config.filter_chains().size(); i++) {
+    const auto& filter_chain = config.filter_chains()[i];
+    if (filter_chain.has_transport_socket() || !filter_chain.has_tls_context() ||
+        (origin != nullptr && origin->filter_chains_by_hash_.count(filter_chain_hashes[i]) > 0)) {
+      continue;
+    }
+    for (const auto& tls_certificate :
+         filter_chain.tls_context().common_tls_context().tls_certificates()) {
+      // Private key method providers are created with the contexts.
+      if (tls_certificate.has_private_key_provider()) {
+        continue;
+      }
+      try {
+        tls_certificates.push_back(std::make_unique<Ssl::TlsCertificateConfigImpl>(
+            tls_certificate, nullptr, parent_.server_.api()));
+      } catch (const EnvoyException&) {
+        // Building the filter chain reports the error.
+      }
+    }
+  }
+  if (tls_certificates.empty()) {
+    return nullptr;
+  }
+
+  std::vector<const Ssl::TlsCertificateConfig*> certificates;
+  certificates.reserve(tls_certificates.size());
+  for (const auto& tls_certificate : tls_certificates) {
+    certificates.push_back(tls_certificate.get());
+  }
+  return parent_.server_.sslContextManager().prefetchCertificates(
+      certificates, parent_.server_.api().threadFactory(), parent_.server_.options().concurrency());
+}
+
+FilterChainImplSharedPtr
+ListenerImpl::createFilterChain(const envoy::api::v2::listener::FilterChain& filter_chain,
+                                const std::vector<std::string>& server_names) {
+  // If the cluster doesn't have transport socket configured, then use the default "raw_buffer"
+  // transport socket or BoringSSL-based "tls" transport socket if TLS settings are configured.
+  // We copy by value first then override if necessary.
+  auto transport_socket = filter_chain.transport_socket();
+  if (!filter_chain.has_transport_socket()) {
+    if (filter_chain.has_tls_context()) {
+      transport_socket.set_name(Extensions::TransportSockets::TransportSocketNames::get().Tls);
+      MessageUtil::jsonConvert(filter_chain.tls_context(), *transport_socket.mutable_config());
+    } else {
+      transport_socket.set_name(
+          Extensions::TransportSockets::TransportSocketNames::get().RawBuffer);
+    }
+  }
+
+  auto& config_factory = Config::Utility::getAndCheckFactory<
+      Server::Configuration::DownstreamTransportSocketConfigFactory>(transport_socket.name());
+  ProtobufTypes::MessagePtr message =
+      Config::Utility::translateToFactoryConfig(transport_socket, config_factory);
+
+  // The filter chain owns the context its filters are created with, so that it can outlive this
+  // listener.
+  auto chain_context = std::make_unique<FilterChainFactoryContextImpl>(
+      parent_.server_, initManager(), global_scope_, listener_scope_, config_.metadata(),
+      local_drain_manager_);
+  Server::Configuration::TransportSocketFactoryContextImpl factory_context(
+      parent_.server_.admin(), parent_.server_.sslContextManager(), *listener_scope_,
+      parent_.server_.clusterManager(), parent_.server_.localInfo(), parent_.server_.dispatcher(),
+      parent_.server_.random(), parent_.server_.stats(), parent_.server_.singletonManager(),
+      parent_.server_.threadLocal(), parent_.server_.api());
+  factory_context.setInitManager(initManager());
+  Network::TransportSocketFactoryPtr transport_socket_factory =
+      config_factory.createTransportSocketFactory(*message, factory_context, server_names);
+  std::vector<Network::FilterFactoryCb> filters_factory =
+      parent_.factory_.createNetworkFilterFactoryList(filter_chain.filters(), *chain_context);
+  return std::make_shared<FilterChainImpl>(std::move(chain_context),
+                                           std::move(transport_socket_factory),
+                                           std::move(filters_factory));
+}
+
 void ListenerImpl::addFilterChain(
     uint16_t destination_port, const std::vector<std::string>& destination_ips,
     const std::vector<std::string>& server_names, const std::string& transport_protocol,
     const std::vector<std::string>& application_protocols,
     const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-    Network::TransportSocketFactoryPtr&& transport_socket_factory,
-    std::vector<Network::FilterFactoryCb> filters_factory) {
-  const auto filter_chain = std::make_shared<FilterChainImpl>(std::move(transport_socket_factory),
-                                                              std::move(filters_factory));
+    const Network::FilterChainSharedPtr& filter_chain) {
   addFilterChainForDestinationPorts(destination_ports_map_, destination_port, destination_ips,
                                     server_names, transport_protocol, application_protocols,
                                     source_type, filter_chain);
@@ -386,16 +542,10 @@ void ListenerImpl::addFilterChainForServerNames(
     addFilterChainForApplicationProtocols(server_names_map[EMPTY_STRING][transport_protocol],
                                           application_protocols, source_type, filter_chain);
   } else {
+    // Wildcard domains, i.e. "*.example.com", are told apart from exact server names by the map.
     for (const auto& server_name : server_names) {
-      if (isWildcardServerName(server_name)) {
-        // Add mapping for the wildcard domain, i.e. ".example.com" for "*.example.com".
-        addFilterChainForApplicationProtocols(
-            server_names_map[server_name.substr(1)][transport_protocol], application_protocols,
-            source_type, filter_chain);
-      } else {
-        addFilterChainForApplicationProtocols(server_names_map[server_name][transport_protocol],
-                                              application_protocols, source_type, filter_chain);
-      }
+      addFilterChainForApplicationProtocols(server_names_map[server_name][transport_protocol],
+                                            application_protocols, source_type, filter_chain);
     }
   }
 }
@@ -503,29 +653,13 @@ ListenerImpl::findFilterChainForDestinationIP(const DestinationIPsTrie& destinat
 const Network::FilterChain*
 ListenerImpl::findFilterChainForServerName(const ServerNamesMap& server_names_map,
                                            const Network::ConnectionSocket& socket) const {
-  const std::string server_name(socket.requestedServerName());
-
-  // Match on exact server name, i.e. "www.example.com" for "www.example.com".
-  const auto server_name_exact_match = server_names_map.find(server_name);
-  if (server_name_exact_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_exact_match->second, socket);
-  }
-
-  // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
-  size_t pos = server_name.find('.', 1);
-  while (pos < server_name.size() - 1 && pos != std::string::npos) {
-    const std::string wildcard = server_name.substr(pos);
-    const auto server_name_wildcard_match = server_names_map.find(wildcard);
-    if (server_name_wildcard_match != server_names_map.end()) {
-      return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
-    }
-    pos = server_name.find('.', pos + 1);
-  }
-
-  // Match on a filter chain without server name requirements.
-  const auto server_name_catchall_match = server_names_map.find(EMPTY_STRING);
-  if (server_name_catchall_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_catchall_match->second, socket);
+  // Match on the exact server name, i.e. "www.example.com" for "www.example.com", else on the
+  // longest wildcard domain, i.e. "*.example.com" and then "*.com" for "www.example.com", else on a
+  // filter chain without server name requirements.
+  const TransportProtocolsMap* server_name_match =
+      server_names_map.find(socket.requestedServerName());
+  if (server_name_match != nullptr) {
+    return findFilterChainForTransportProtocol(*server_name_match, socket);
   }
 
   return nullptr;
@@ -534,10 +668,9 @@ ListenerImpl::findFilterChainForServerName(const ServerNamesMap& server_names_ma
 const Network::FilterChain* ListenerImpl::findFilterChainForTransportProtocol(
     const TransportProtocolsMap& transport_protocols_map,
     const Network::ConnectionSocket& socket) const {
-  const std::string transport_protocol(socket.detectedTransportProtocol());
-
   // Match on exact transport protocol, e.g. "tls".
-  const auto transport_protocol_match = transport_protocols_map.find(transport_protocol);
+  const auto transport_protocol_match =
+      transport_protocols_map.find(socket.detectedTransportProtocol());
   if (transport_protocol_match != transport_protocols_map.end()) {
     return findFilterChainForApplicationProtocols(transport_protocol_match->second, socket);
   }
@@ -615,6 +748,18 @@ bool ListenerImpl::createListenerFilterChain(Network::ListenerFilterManager& man
   return Configuration::FilterChainUtility::buildFilterChain(manager, listener_filter_factories_);
 }
 
+bool ListenerImpl::createUdpListenerFilterChain(Network::UdpListenerFilterManager& udp_listener,
+                                                Network::UdpReadFilterCallbacks& callbacks) {
+  return Configuration::FilterChainUtility::buildUdpFilterChain(udp_listener, callbacks,
+                                                                udp_listener_filter_factories_);
+}
+
+bool FilterChainFactoryContextImpl::drainClose() const {
+  // Same as ListenerImpl::drainClose(), with the drain manager of the listener that currently owns
+  // the filter chain.
+  return drain_manager_.load()->drainClose() || server_.drainManager().drainClose();
+}
+
 bool ListenerImpl::drainClose() const {
   // When a listener is draining, the "drain close" decision is the union of the per-listener drain
   // manager and the server wide drain manager. This allows individual listeners to be drained and
@@ -622,6 +767,32 @@ bool ListenerImpl::drainClose() const {
   return local_drain_manager_->drainClose() || parent_.server_.drainManager().drainClose();
 }
 
+bool ListenerImpl::supportsFilterChainOnlyUpdate(const envoy::api::v2::Listener& config) const {
+  Protobuf::util::MessageDifferencer differencer;
+  differencer.set_message_field_comparison(Protobuf::util::MessageDifferencer::EQUIVALENT);
+  differencer.IgnoreField(envoy::api::v2::Listener::descriptor()->FindFieldByName("filter_chains"));
+  return differencer.Compare(config_, config);
+}
+
+void ListenerImpl::adoptFilterChains() {
+  for (const auto& filter_chain : filter_chains_by_hash_) {
+    filter_chain.second->factoryContext().setDrainManager(local_drain_manager_);
+  }
+}
+
+std::list<const Network::FilterChain*>
+ListenerImpl::filterChainsNotIn(const ListenerImpl& listener) const {
+  std::list<const Network::FilterChain*> filter_chains;
+  for (const auto& filter_chain : filter_chains_by_hash_) {
+    auto other_filter_chain = listener.filter_chains_by_hash_.find(filter_chain.first);
+    if (other_filter_chain == listener.filter_chains_by_hash_.end() ||
+        other_filter_chain->second != filter_chain.second) {
+      filter_chains.push_back(filter_chain.second.get());
+    }
+  }
+  return filter_chains;
+}
+
 void ListenerImpl::debugLog(const std::string& message) {
   UNREFERENCED_PARAMETER(message);
   ENVOY_LOG(debug, "{}: name={}, hash={}, address={}", message, name_, hash_, address_->asString());
@@ -633,6 +804,7 @@ void ListenerImpl::initialize() {
   // per listener init manager. See ~ListenerImpl() for why we gate the onListenerWarmed() call
   // by resetting the watcher.
   if (workers_started_) {
+    warming_start_time_ = timeSource().monotonicTime();
     dynamic_init_manager_.initialize(*init_watcher_);
   }
 }
@@ -650,9 +822,31 @@ void ListenerImpl::setSocket(const Network::SocketSharedPtr& socket) {
   ASSERT(!socket_);
   socket_ = socket;
   // Server config validation sets nullptr sockets.
-  if (socket_ && listen_socket_options_) {
+  if (socket_) {
+    applyListenSocketOptions(*socket_);
+  }
+}
+
+void ListenerImpl::setWorkerSockets(const std::vector<Network::SocketSharedPtr>& sockets) {
+  ASSERT(worker_sockets_.empty());
+  worker_sockets_ = sockets;
+  for (const Network::SocketSharedPtr& socket : worker_sockets_) {
+    applyListenSocketOptions(*socket);
+    worker_configs_.emplace_back(std::make_unique<WorkerListenerConfig>(*this, *socket));
+  }
+}
+
+Network::ListenerConfig& ListenerImpl::workerListenerConfig(uint32_t worker_index) {
+  if (worker_index == 0 || worker_index > worker_configs_.size()) {
+    return *this;
+  }
+  return *worker_configs_[worker_index - 1];
+}
+
+void ListenerImpl::applyListenSocketOptions(Network::Socket& socket) {
+  if (listen_socket_options_) {
     // 'pre_bind = false' as bind() is never done after this.
-    bool ok = Network::Socket::applyOptions(listen_socket_options_, *socket_,
+    bool ok = Network::Socket::applyOptions(listen_socket_options_, socket,
                                             envoy::api::v2::core::SocketOption::STATE_BOUND);
     const std::string message =
         fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
@@ -663,20 +857,25 @@ void ListenerImpl::setSocket(const Network::SocketSharedPtr& socket) {
       ENVOY_LOG(debug, "{}", message);
     }
 
-    // Add the options to the socket_ so that STATE_LISTENING options can be
-    // set in the worker after listen()/evconnlistener_new() is called.
-    socket_->addOptions(listen_socket_options_);
+    // Add the options to the socket so that STATE_LISTENING options can be
+    // set in the worker after listen() is called.
+    socket.addOptions(listen_socket_options_);
   }
 }
 
 ListenerManagerImpl::ListenerManagerImpl(Instance& server,
                                          ListenerComponentFactory& listener_factory,
-                                         WorkerFactory& worker_factory)
+                                         WorkerFactory& worker_factory,
+                                         bool enable_dispatcher_stats)
     : server_(server), factory_(listener_factory), stats_(generateStats(server.stats())),
       config_tracker_entry_(server.admin().getConfigTracker().add(
           "listeners", [this] { return dumpListenerConfigs(); })) {
   for (uint32_t i = 0; i < server.options().concurrency(); i++) {
-    workers_.emplace_back(worker_factory.createWorker(server.overloadManager()));
+    workers_.emplace_back(worker_factory.createWorker(server.overloadManager(), workerCpu(i)));
+    if (enable_dispatcher_stats) {
+      workers_.back()->initializeStats(server.stats(),
+                                       fmt::format("listener_manager.worker_{}.", i));
+    }
   }
 }
 
@@ -720,7 +919,8 @@ ProtobufTypes::MessagePtr ListenerManagerImpl::dumpListenerConfigs() {
 ListenerManagerStats ListenerManagerImpl::generateStats(Stats::Scope& scope) {
   const std::string final_prefix = "listener_manager.";
   return {ALL_LISTENER_MANAGER_STATS(POOL_COUNTER_PREFIX(scope, final_prefix),
-                                     POOL_GAUGE_PREFIX(scope, final_prefix))};
+                                     POOL_GAUGE_PREFIX(scope, final_prefix),
+                                     POOL_HISTOGRAM_PREFIX(scope, final_prefix))};
 }
 
 bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& config,
@@ -747,8 +947,17 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     return false;
   }
 
-  ListenerImplPtr new_listener(
-      new ListenerImpl(config, version_info, *this, name, modifiable, workers_started_, hash));
+  // Once workers have started, an update of an active listener that only changes filter chains is
+  // applied to the workers' listener in place, so that connections on the filter chains that the
+  // update keeps are not drained.
+  ListenerImpl* origin = nullptr;
+  if (workers_started_ && existing_active_listener != active_listeners_.end() &&
+      (*existing_active_listener)->supportsFilterChainOnlyUpdate(config)) {
+    origin = existing_active_listener->get();
+  }
+
+  ListenerImplPtr new_listener(new ListenerImpl(config, version_info, *this, name, modifiable,
+                                                workers_started_, hash, origin));
   ListenerImpl& new_listener_ref = *new_listener;
 
   // We mandate that a listener with the same name must have the same configured address. This
@@ -766,17 +975,32 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     throw EnvoyException(message);
   }
 
+  // The worker sockets of a reuse_port listener are handed over on update in the same way as its
+  // address, so the setting has to stay the same.
+  if ((existing_warming_listener != warming_listeners_.end() &&
+       (*existing_warming_listener)->reusePort() != new_listener->reusePort()) ||
+      (existing_active_listener != active_listeners_.end() &&
+       (*existing_active_listener)->reusePort() != new_listener->reusePort())) {
+    const std::string message = fmt::format(
+        "error updating listener: '{}' has a different reuse_port setting from existing listener",
+        name);
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  }
+
   bool added = false;
   if (existing_warming_listener != warming_listeners_.end()) {
     // In this case we can just replace inline.
     ASSERT(workers_started_);
     new_listener->debugLog("update warming listener");
     new_listener->setSocket((*existing_warming_listener)->getSocket());
+    new_listener->setWorkerSockets((*existing_warming_listener)->getWorkerSockets());
     *existing_warming_listener = std::move(new_listener);
   } else if (existing_active_listener != active_listeners_.end()) {
     // In this case we have no warming listener, so what we do depends on whether workers
     // have been started or not. Either way we get the socket from the existing listener.
     new_listener->setSocket((*existing_active_listener)->getSocket());
+    new_listener->setWorkerSockets((*existing_active_listener)->getWorkerSockets());
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -805,22 +1029,23 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // to see if there is a listener that has a socket bound to the address we are configured for.
     // This is an edge case, but may happen if a listener is removed and then added back with a same
     // or different name and intended to listen on the same address. This should work and not fail.
-    Network::SocketSharedPtr draining_listener_socket;
+    // The draining sockets can only be taken over if they were set up for the same reuse_port
+    // setting.
     auto existing_draining_listener = std::find_if(
         draining_listeners_.cbegin(), draining_listeners_.cend(),
         [&new_listener](const DrainingListener& listener) {
-          return *new_listener->address() == *listener.listener_->socket().localAddress();
+          return *new_listener->address() == *listener.listener_->socket().localAddress() &&
+                 new_listener->reusePort() == listener.listener_->reusePort();
         });
     if (existing_draining_listener != draining_listeners_.cend()) {
-      draining_listener_socket = existing_draining_listener->listener_->getSocket();
+      new_listener->setSocket(existing_draining_listener->listener_->getSocket());
+      new_listener->setWorkerSockets(existing_draining_listener->listener_->getWorkerSockets());
+    } else {
+      new_listener->setSocket(factory_.createListenSocket(
+          new_listener->address(), new_listener->socketType(),
+          workerListenSocketOptions(*new_listener, 0), new_listener->bindToPort(), 0));
+      createWorkerSockets(*new_listener);
     }
-
-    new_listener->setSocket(draining_listener_socket
-                                ? draining_listener_socket
-                                : factory_.createListenSocket(new_listener->address(),
-                                                              new_listener->socketType(),
-                                                              new_listener->listenSocketOptions(),
-                                                              new_listener->bindToPort()));
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -893,6 +1118,57 @@ void ListenerManagerImpl::drainListener(ListenerImplPtr&& listener) {
   updateWarmingActiveGauges();
 }
 
+void ListenerManagerImpl::drainFilterChains(ListenerImplPtr&& listener,
+                                            ListenerImpl& new_listener) {
+  std::list<const Network::FilterChain*> filter_chains = listener->filterChainsNotIn(new_listener);
+  std::list<DrainingFilterChains>::iterator draining_it = draining_filter_chains_.emplace(
+      draining_filter_chains_.begin(), std::move(listener), std::move(filter_chains),
+      workers_.size());
+  updateDrainingFilterChainsGauge();
+  stats_.listener_in_place_updated_.inc();
+
+  // Once the drain time has passed, the workers close the remaining connections on the removed
+  // filter chains. The listener is kept for a worker round trip even if no filter chain was
+  // removed, because workers may use its config until they have switched to the new listener.
+  auto remove_filter_chains = [this, draining_it]() -> void {
+    draining_it->listener_->debugLog("removing filter chains");
+    for (const auto& worker : workers_) {
+      worker->removeFilterChains(
+          draining_it->listener_->listenerTag(), draining_it->filter_chains_,
+          [this, draining_it]() -> void {
+            // The completion is called on the worker thread. We post back to the main thread to
+            // avoid locking, like for draining listeners.
+            server_.dispatcher().post([this, draining_it]() -> void {
+              if (--draining_it->workers_pending_removal_ == 0) {
+                draining_it->listener_->debugLog("filter chain removal complete");
+                draining_filter_chains_.erase(draining_it);
+                updateDrainingFilterChainsGauge();
+              }
+            });
+          });
+    }
+  };
+
+  if (draining_it->filter_chains_.empty()) {
+    remove_filter_chains();
+  } else {
+    // Only the connections on the removed filter chains use the drain manager of the old listener,
+    // the others have been switched to the new listener's.
+    draining_it->listener_->debugLog("draining filter chains");
+    draining_it->listener_->localDrainManager().startDrainSequence(remove_filter_chains);
+  }
+}
+
+void ListenerManagerImpl::updateDrainingFilterChainsGauge() {
+  uint64_t filter_chains = 0;
+  for (const auto& draining : draining_filter_chains_) {
+    filter_chains += draining.filter_chains_.size();
+  }
+  // Using set() avoids a multiple modifiers problem during the multiple processes phase of hot
+  // restart.
+  stats_.total_filter_chains_draining_.set(filter_chains);
+}
+
 ListenerManagerImpl::ListenerList::iterator
 ListenerManagerImpl::getListenerByName(ListenerList& listeners, const std::string& name) {
   auto ret = listeners.end();
@@ -916,8 +1192,66 @@ std::vector<std::reference_wrapper<Network::ListenerConfig>> ListenerManagerImpl
   return ret;
 }
 
-void ListenerManagerImpl::addListenerToWorker(Worker& worker, ListenerImpl& listener) {
-  worker.addListener(listener, [this, &listener](bool success) -> void {
+Network::Socket* ListenerManagerImpl::findListenSocket(const Network::Address::Instance& address,
+                                                       uint32_t worker_index) {
+  for (const auto& listener : active_listeners_) {
+    if (*listener->socket().localAddress() == address) {
+      if (worker_index == 0) {
+        return &listener->socket();
+      }
+      const std::vector<Network::SocketSharedPtr>& worker_sockets = listener->getWorkerSockets();
+      return worker_index <= worker_sockets.size() ? worker_sockets[worker_index - 1].get()
+                                                   : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+void ListenerManagerImpl::createWorkerSockets(ListenerImpl& listener) {
+  // Server config validation sets nullptr sockets.
+  if (!listener.reusePort() || !listener.getSocket()) {
+    return;
+  }
+
+  // Bind to the address the first socket ended up with, so that all workers share the port that
+  // was picked for a listener configured with port 0.
+  std::vector<Network::SocketSharedPtr> sockets;
+  for (uint32_t worker_index = 1; worker_index < workers_.size(); worker_index++) {
+    sockets.push_back(factory_.createListenSocket(listener.getSocket()->localAddress(),
+                                                  listener.socketType(),
+                                                  workerListenSocketOptions(listener, worker_index),
+                                                  true, worker_index));
+  }
+  listener.setWorkerSockets(sockets);
+}
+
+absl::optional<uint32_t> ListenerManagerImpl::workerCpu(uint32_t worker_index) const {
+  const std::vector<uint32_t>& cpus = server_.options().workerCpus();
+  if (cpus.empty()) {
+    return absl::nullopt;
+  }
+  return cpus[worker_index % cpus.size()];
+}
+
+Network::Socket::OptionsSharedPtr
+ListenerManagerImpl::workerListenSocketOptions(ListenerImpl& listener, uint32_t worker_index) {
+  const absl::optional<uint32_t> cpu = workerCpu(worker_index);
+  if (!listener.reusePort() || !cpu.has_value()) {
+    return listener.listenSocketOptions();
+  }
+  // The kernel prefers the socket of the reuse_port group whose CPU received the connection, which
+  // is the one of the worker pinned to that CPU.
+  auto options = std::make_shared<Network::Socket::Options>();
+  Network::Socket::appendOptions(options, listener.listenSocketOptions());
+  Network::Socket::appendOptions(
+      options, Network::SocketOptionFactory::buildIncomingCpuOptions(cpu.value()));
+  return options;
+}
+
+void ListenerManagerImpl::addListenerToWorker(Worker& worker, uint32_t worker_index,
+                                              ListenerImpl& listener) {
+  Network::ListenerConfig& config = listener.workerListenerConfig(worker_index);
+  worker.addListener(config, [this, &listener](bool success) -> void {
     // The add listener completion runs on the worker thread. Post back to the main thread to
     // avoid locking.
     server_.dispatcher().post([this, success, &listener]() -> void {
@@ -943,19 +1277,38 @@ void ListenerManagerImpl::addListenerToWorker(Worker& worker, ListenerImpl& list
 }
 
 void ListenerManagerImpl::onListenerWarmed(ListenerImpl& listener) {
+  stats_.listener_warming_time_ms_.recordValue(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          listener.timeSource().monotonicTime() - listener.warming_start_time_)
+          .count());
+
+  // The filter chains shared with the listener that is updated in place have to stop using its
+  // drain manager before it starts draining.
+  if (listener.filterChainOnlyUpdate()) {
+    listener.adoptFilterChains();
+  }
+
   // The warmed listener should be added first so that the worker will accept new connections
-  // when it stops listening on the old listener.
+  // when it stops listening on the old listener. For a filter chain only update, the workers
+  // switch their listener to the new config instead.
+  uint32_t worker_index = 0;
   for (const auto& worker : workers_) {
-    addListenerToWorker(*worker, listener);
+    addListenerToWorker(*worker, worker_index++, listener);
   }
 
   auto existing_active_listener = getListenerByName(active_listeners_, listener.name());
   auto existing_warming_listener = getListenerByName(warming_listeners_, listener.name());
   (*existing_warming_listener)->debugLog("warm complete. updating active listener");
   if (existing_active_listener != active_listeners_.end()) {
-    drainListener(std::move(*existing_active_listener));
+    if (listener.filterChainOnlyUpdate()) {
+      drainFilterChains(std::move(*existing_active_listener), listener);
+    } else {
+      drainListener(std::move(*existing_active_listener));
+    }
     *existing_active_listener = std::move(*existing_warming_listener);
   } else {
+    // Removing the active listener also removes the warming listener that updates it in place.
+    ASSERT(!listener.filterChainOnlyUpdate());
     active_listeners_.emplace_back(std::move(*existing_warming_listener));
   }
 
@@ -1006,11 +1359,13 @@ void ListenerManagerImpl::startWorkers(GuardDog& guard_dog) {
   ENVOY_LOG(info, "all dependencies initialized. starting workers");
   ASSERT(!workers_started_);
   workers_started_ = true;
+  uint32_t worker_index = 0;
   for (const auto& worker : workers_) {
     ASSERT(warming_listeners_.empty());
     for (const auto& listener : active_listeners_) {
-      addListenerToWorker(*worker, *listener);
+      addListenerToWorker(*worker, worker_index, *listener);
     }
+    worker_index++;
     worker->start(guard_dog);
   }
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <list>
 #include <memory>
 
 #include "envoy/api/v2/listener/listener.pb.h"
@@ -9,14 +11,20 @@
 #include "envoy/server/listener_manager.h"
 #include "envoy/server/transport_socket_config.h"
 #include "envoy/server/worker.h"
+#include "envoy/ssl/context_manager.h"
 #include "envoy/stats/scope.h"
 
 #include "common/common/logger.h"
 #include "common/init/manager_impl.h"
 #include "common/network/cidr_range.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/lc_trie.h"
 
 #include "server/lds_api.h"
+#include "server/server_name_matcher.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Server {
@@ -43,6 +51,12 @@ public:
   static std::vector<Network::ListenerFilterFactoryCb> createListenerFilterFactoryList_(
       const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
       Configuration::ListenerFactoryContext& context);
+  /**
+   * Static worker for createUdpListenerFilterFactoryList() that can be used directly in tests.
+   */
+  static std::vector<Network::UdpListenerFilterFactoryCb> createUdpListenerFilterFactoryList_(
+      const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
+      Configuration::ListenerFactoryContext& context);
 
   // Server::ListenerComponentFactory
   LdsApiPtr createLdsApi(const envoy::api::v2::core::ConfigSource& lds_config) override {
@@ -61,10 +75,15 @@ public:
       Configuration::ListenerFactoryContext& context) override {
     return createListenerFilterFactoryList_(filters, context);
   }
+  std::vector<Network::UdpListenerFilterFactoryCb> createUdpListenerFilterFactoryList(
+      const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
+      Configuration::ListenerFactoryContext& context) override {
+    return createUdpListenerFilterFactoryList_(filters, context);
+  }
   Network::SocketSharedPtr createListenSocket(Network::Address::InstanceConstSharedPtr address,
                                               Network::Address::SocketType socket_type,
                                               const Network::Socket::OptionsSharedPtr& options,
-                                              bool bind_to_port) override;
+                                              bool bind_to_port, uint32_t worker_index) override;
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType drain_type) override;
   uint64_t nextListenerTag() override { return next_listener_tag_++; }
 
@@ -80,22 +99,26 @@ typedef std::unique_ptr<ListenerImpl> ListenerImplPtr;
  * All listener manager stats. @see stats_macros.h
  */
 // clang-format off
-#define ALL_LISTENER_MANAGER_STATS(COUNTER, GAUGE)                                                 \
+#define ALL_LISTENER_MANAGER_STATS(COUNTER, GAUGE, HISTOGRAM)                                      \
   COUNTER(listener_added)                                                                          \
   COUNTER(listener_modified)                                                                       \
   COUNTER(listener_removed)                                                                        \
   COUNTER(listener_create_success)                                                                 \
   COUNTER(listener_create_failure)                                                                 \
+  COUNTER(listener_in_place_updated)                                                               \
   GAUGE  (total_listeners_warming)                                                                 \
   GAUGE  (total_listeners_active)                                                                  \
-  GAUGE  (total_listeners_draining)
+  GAUGE  (total_listeners_draining)                                                                \
+  GAUGE  (total_filter_chains_draining)                                                            \
+  HISTOGRAM(listener_warming_time_ms)
 // clang-format on
 
 /**
  * Struct definition for all listener manager stats. @see stats_macros.h
  */
 struct ListenerManagerStats {
-  ALL_LISTENER_MANAGER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+  ALL_LISTENER_MANAGER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                             GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -104,7 +127,7 @@ struct ListenerManagerStats {
 class ListenerManagerImpl : public ListenerManager, Logger::Loggable<Logger::Id::config> {
 public:
   ListenerManagerImpl(Instance& server, ListenerComponentFactory& listener_factory,
-                      WorkerFactory& worker_factory);
+                      WorkerFactory& worker_factory, bool enable_dispatcher_stats);
 
   void onListenerWarmed(ListenerImpl& listener);
 
@@ -116,6 +139,8 @@ public:
     lds_api_ = factory_.createLdsApi(lds_config);
   }
   std::vector<std::reference_wrapper<Network::ListenerConfig>> listeners() override;
+  Network::Socket* findListenSocket(const Network::Address::Instance& address,
+                                    uint32_t worker_index) override;
   uint64_t numConnections() override;
   bool removeListener(const std::string& listener_name) override;
   void startWorkers(GuardDog& guard_dog) override;
@@ -137,7 +162,39 @@ private:
     uint64_t workers_pending_removal_;
   };
 
-  void addListenerToWorker(Worker& worker, ListenerImpl& listener);
+  struct DrainingFilterChains {
+    DrainingFilterChains(ListenerImplPtr&& listener,
+                         std::list<const Network::FilterChain*>&& filter_chains,
+                         uint64_t workers_pending_removal)
+        : listener_(std::move(listener)), filter_chains_(std::move(filter_chains)),
+          workers_pending_removal_(workers_pending_removal) {}
+
+    // The listener that was updated in place. It owns the filter chains.
+    ListenerImplPtr listener_;
+    std::list<const Network::FilterChain*> filter_chains_;
+    uint64_t workers_pending_removal_;
+  };
+
+  void addListenerToWorker(Worker& worker, uint32_t worker_index, ListenerImpl& listener);
+  /**
+   * Create the sockets of every worker but the first for a listener that uses reuse_port. The
+   * listener's own socket must already be set.
+   * @param listener supplies the listener.
+   */
+  void createWorkerSockets(ListenerImpl& listener);
+  /**
+   * @param worker_index supplies the index of a worker.
+   * @return the CPU the worker is pinned to, if any.
+   */
+  absl::optional<uint32_t> workerCpu(uint32_t worker_index) const;
+  /**
+   * @param listener supplies the listener.
+   * @param worker_index supplies the index of the worker the socket is created for.
+   * @return the options of the socket of a worker, which for a reuse_port listener also steer the
+   *         connections received on the CPU of the worker to it.
+   */
+  Network::Socket::OptionsSharedPtr workerListenSocketOptions(ListenerImpl& listener,
+                                                              uint32_t worker_index);
   ProtobufTypes::MessagePtr dumpListenerConfigs();
   static ListenerManagerStats generateStats(Stats::Scope& scope);
   static bool hasListenerWithAddress(const ListenerList& list,
@@ -156,6 +213,15 @@ private:
    */
   void drainListener(ListenerImplPtr&& listener);
 
+  /**
+   * Drain the filter chains of a listener that was updated in place and that the new listener does
+   * not share. Only the connections on those filter chains are drained and then closed.
+   * @param listener supplies the listener that was updated.
+   * @param new_listener supplies the listener that replaced it.
+   */
+  void drainFilterChains(ListenerImplPtr&& listener, ListenerImpl& new_listener);
+  void updateDrainingFilterChainsGauge();
+
   /**
    * Get a listener by name. This routine is used because listeners have inherent order in static
    * configuration and especially for tests. Thus, we can't use a map.
@@ -175,6 +241,9 @@ private:
   // connections are drained. Then after that time period the listener is removed from all workers
   // and any remaining connections are closed.
   std::list<DrainingListener> draining_listeners_;
+  // Listeners that were updated in place, which are kept until the connections on the filter
+  // chains that the update removed are drained and closed.
+  std::list<DrainingFilterChains> draining_filter_chains_;
   std::list<WorkerPtr> workers_;
   bool workers_started_{};
   ListenerManagerStats stats_;
@@ -182,6 +251,111 @@ private:
   LdsApiPtr lds_api_;
 };
 
+/**
+ * The factory context of the transport socket and network filters of a single filter chain. It is
+ * owned by the filter chain rather than the listener, so that a filter chain that a listener update
+ * does not change can be handed over to the updated listener.
+ */
+class FilterChainFactoryContextImpl : public Configuration::FactoryContext,
+                                      public Network::DrainDecision {
+public:
+  /**
+   * @param server supplies the server.
+   * @param init_manager supplies the init manager of the listener that creates the filter chain.
+   *        It is only handed out while the filter chain is created.
+   * @param global_scope supplies the listener's stats scope with the global name.
+   * @param listener_scope supplies the listener's stats scope with the listener name.
+   * @param listener_metadata supplies the listener's metadata.
+   * @param drain_manager supplies the local drain manager of the listener.
+   */
+  FilterChainFactoryContextImpl(Instance& server, Init::Manager& init_manager,
+                                const Stats::ScopeSharedPtr& global_scope,
+                                const Stats::ScopeSharedPtr& listener_scope,
+                                const envoy::api::v2::core::Metadata& listener_metadata,
+                                const std::shared_ptr<DrainManager>& drain_manager)
+      : server_(server), init_manager_(init_manager), global_scope_(global_scope),
+        listener_scope_(listener_scope), listener_metadata_(listener_metadata),
+        drain_manager_(drain_manager.get()), drain_manager_owner_(drain_manager) {}
+
+  /**
+   * Switch the filter chain to the local drain manager of the listener that now owns it. Workers
+   * may still use the previous drain manager until their next event loop iteration, so the
+   * previous listener has to outlive a worker round trip.
+   * @param drain_manager supplies the drain manager.
+   */
+  void setDrainManager(const std::shared_ptr<DrainManager>& drain_manager) {
+    drain_manager_ = drain_manager.get();
+    drain_manager_owner_ = drain_manager;
+  }
+
+  // Server::Configuration::FactoryContext
+  AccessLog::AccessLogManager& accessLogManager() override { return server_.accessLogManager(); }
+  Upstream::ClusterManager& clusterManager() override { return server_.clusterManager(); }
+  Event::Dispatcher& dispatcher() override { return server_.dispatcher(); }
+  Network::DrainDecision& drainDecision() override { return *this; }
+  bool healthCheckFailed() override { return server_.healthCheckFailed(); }
+  Tracing::HttpTracer& httpTracer() override { return httpContext().tracer(); }
+  Http::Context& httpContext() override { return server_.httpContext(); }
+  Init::Manager& initManager() override { return init_manager_; }
+  const LocalInfo::LocalInfo& localInfo() const override { return server_.localInfo(); }
+  Envoy::Runtime::RandomGenerator& random() override { return server_.random(); }
+  Envoy::Runtime::Loader& runtime() override { return server_.runtime(); }
+  Stats::Scope& scope() override { return *global_scope_; }
+  Singleton::Manager& singletonManager() override { return server_.singletonManager(); }
+  OverloadManager& overloadManager() override { return server_.overloadManager(); }
+  ThreadLocal::Instance& threadLocal() override { return server_.threadLocal(); }
+  Admin& admin() override { return server_.admin(); }
+  Stats::Scope& listenerScope() override { return *listener_scope_; }
+  const envoy::api::v2::core::Metadata& listenerMetadata() const override {
+    return listener_metadata_;
+  }
+  TimeSource& timeSource() override { return api().timeSource(); }
+  Api::Api& api() override { return server_.api(); }
+  ServerLifecycleNotifier& lifecycleNotifier() override { return server_.lifecycleNotifier(); }
+
+  // Network::DrainDecision
+  bool drainClose() const override;
+
+private:
+  Instance& server_;
+  Init::Manager& init_manager_;
+  const Stats::ScopeSharedPtr global_scope_;
+  const Stats::ScopeSharedPtr listener_scope_;
+  const envoy::api::v2::core::Metadata listener_metadata_;
+  // Read by workers, written by the main thread.
+  std::atomic<const DrainManager*> drain_manager_;
+  std::shared_ptr<DrainManager> drain_manager_owner_;
+};
+
+class FilterChainImpl : public Network::FilterChain {
+public:
+  FilterChainImpl(std::unique_ptr<FilterChainFactoryContextImpl>&& factory_context,
+                  Network::TransportSocketFactoryPtr&& transport_socket_factory,
+                  std::vector<Network::FilterFactoryCb> filters_factory)
+      : factory_context_(std::move(factory_context)),
+        transport_socket_factory_(std::move(transport_socket_factory)),
+        filters_factory_(std::move(filters_factory)) {}
+
+  FilterChainFactoryContextImpl& factoryContext() { return *factory_context_; }
+
+  // Network::FilterChain
+  const Network::TransportSocketFactory& transportSocketFactory() const override {
+    return *transport_socket_factory_;
+  }
+
+  const std::vector<Network::FilterFactoryCb>& networkFilterFactories() const override {
+    return filters_factory_;
+  }
+
+private:
+  // Declared first so that the factories, which may reference it, are destroyed before it.
+  const std::unique_ptr<FilterChainFactoryContextImpl> factory_context_;
+  const Network::TransportSocketFactoryPtr transport_socket_factory_;
+  const std::vector<Network::FilterFactoryCb> filters_factory_;
+};
+
+typedef std::shared_ptr<FilterChainImpl> FilterChainImplSharedPtr;
+
 // TODO(mattklein123): Consider getting rid of pre-worker start and post-worker start code by
 //                     initializing all listeners after workers are started.
 
@@ -205,10 +379,14 @@ public:
    * @param workers_started supplies whether the listener is being added before or after workers
    *        have been started. This controls various behavior related to init management.
    * @param hash supplies the hash to use for duplicate checking.
+   * @param origin supplies the active listener that this listener updates in place, or nullptr.
+   *        The origin has to support a filter chain only update to the config, @see
+   *        supportsFilterChainOnlyUpdate(). The listener then shares the origin's tag, stats
+   *        scopes and connection balancer, and reuses its unchanged filter chains.
    */
   ListenerImpl(const envoy::api::v2::Listener& config, const std::string& version_info,
                ListenerManagerImpl& parent, const std::string& name, bool modifiable,
-               bool workers_started, uint64_t hash);
+               bool workers_started, uint64_t hash, ListenerImpl* origin);
   ~ListenerImpl();
 
   /**
@@ -217,6 +395,30 @@ public:
   bool blockUpdate(uint64_t new_hash) { return new_hash == hash_ || !modifiable_; }
   bool blockRemove() { return !modifiable_; }
 
+  /**
+   * @param config supplies the configuration of an update to this listener.
+   * @return TRUE if the update only changes filter chains, so that it can be applied to the
+   *         workers' listener in place. Connections on unchanged filter chains are kept.
+   */
+  bool supportsFilterChainOnlyUpdate(const envoy::api::v2::Listener& config) const;
+
+  /**
+   * @return TRUE if this listener updates its origin in place.
+   */
+  bool filterChainOnlyUpdate() const { return filter_chain_only_update_; }
+
+  /**
+   * Switch the filter chains shared with the origin to this listener's drain manager. Called when
+   * the listener replaces its origin on the workers.
+   */
+  void adoptFilterChains();
+
+  /**
+   * @param listener supplies another listener.
+   * @return the filter chains of this listener that the other listener does not share.
+   */
+  std::list<const Network::FilterChain*> filterChainsNotIn(const ListenerImpl& listener) const;
+
   /**
    * Called when a listener failed to be actually created on a worker.
    * @return TRUE if we have seen more than one worker failure.
@@ -231,11 +433,25 @@ public:
   Network::Address::SocketType socketType() const { return socket_type_; }
   const envoy::api::v2::Listener& config() { return config_; }
   const Network::SocketSharedPtr& getSocket() const { return socket_; }
+  bool reusePort() const { return reuse_port_; }
+  /**
+   * @return the sockets of workers 1 to N-1 of a listener that uses reuse_port. Worker 0 listens on
+   *         socket(). Empty for all other listeners.
+   */
+  const std::vector<Network::SocketSharedPtr>& getWorkerSockets() const { return worker_sockets_; }
   void debugLog(const std::string& message);
   void initialize();
   DrainManager& localDrainManager() const { return *local_drain_manager_; }
+  uint64_t numFilterChains() const { return filter_chains_by_hash_.size(); }
   void setSocket(const Network::SocketSharedPtr& socket);
   void setSocketAndOptions(const Network::SocketSharedPtr& socket);
+  void setWorkerSockets(const std::vector<Network::SocketSharedPtr>& sockets);
+  /**
+   * @param worker_index supplies the index of the worker.
+   * @return Network::ListenerConfig& the config the worker should add. It only differs from this
+   *         listener in the socket for reuse_port listeners.
+   */
+  Network::ListenerConfig& workerListenerConfig(uint32_t worker_index);
   const Network::Socket::OptionsSharedPtr& listenSocketOptions() { return listen_socket_options_; }
   const std::string& versionInfo() { return version_info_; }
 
@@ -257,6 +473,10 @@ public:
   Stats::Scope& listenerScope() override { return *listener_scope_; }
   uint64_t listenerTag() const override { return listener_tag_; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return *connection_balancer_; }
+  uint32_t maxConnectionsToAcceptPerSocketEvent() const override {
+    return max_connections_to_accept_per_socket_event_;
+  }
 
   // Server::Configuration::ListenerFactoryContext
   AccessLog::AccessLogManager& accessLogManager() override {
@@ -312,17 +532,60 @@ public:
   bool createNetworkFilterChain(Network::Connection& connection,
                                 const std::vector<Network::FilterFactoryCb>& factories) override;
   bool createListenerFilterChain(Network::ListenerFilterManager& manager) override;
+  bool createUdpListenerFilterChain(Network::UdpListenerFilterManager& udp_listener,
+                                    Network::UdpReadFilterCallbacks& callbacks) override;
 
   SystemTime last_updated_;
+  // When the listener started warming, for the listener_warming_time_ms histogram.
+  MonotonicTime warming_start_time_;
 
 private:
+  /**
+   * The listener as seen by a worker that has a reuse_port socket of its own. Everything but the
+   * socket is forwarded to the listener.
+   */
+  class WorkerListenerConfig : public Network::ListenerConfig {
+  public:
+    WorkerListenerConfig(ListenerImpl& parent, Network::Socket& socket)
+        : parent_(parent), socket_(socket) {}
+
+    // Network::ListenerConfig
+    Network::FilterChainManager& filterChainManager() override { return parent_; }
+    Network::FilterChainFactory& filterChainFactory() override { return parent_; }
+    Network::Socket& socket() override { return socket_; }
+    const Network::Socket& socket() const override { return socket_; }
+    bool bindToPort() override { return parent_.bindToPort(); }
+    bool handOffRestoredDestinationConnections() const override {
+      return parent_.handOffRestoredDestinationConnections();
+    }
+    uint32_t perConnectionBufferLimitBytes() const override {
+      return parent_.perConnectionBufferLimitBytes();
+    }
+    std::chrono::milliseconds listenerFiltersTimeout() const override {
+      return parent_.listenerFiltersTimeout();
+    }
+    Stats::Scope& listenerScope() override { return parent_.listenerScope(); }
+    uint64_t listenerTag() const override { return parent_.listenerTag(); }
+    const std::string& name() const override { return parent_.name(); }
+    Network::ConnectionBalancer& connectionBalancer() override {
+      return parent_.connectionBalancer();
+    }
+    uint32_t maxConnectionsToAcceptPerSocketEvent() const override {
+      return parent_.maxConnectionsToAcceptPerSocketEvent();
+    }
+
+  private:
+    ListenerImpl& parent_;
+    Network::Socket& socket_;
+  };
+
   typedef std::array<Network::FilterChainSharedPtr, 3> SourceTypesArray;
   typedef std::unordered_map<std::string, SourceTypesArray> ApplicationProtocolsMap;
-  typedef std::unordered_map<std::string, ApplicationProtocolsMap> TransportProtocolsMap;
-  // Both exact server names and wildcard domains are part of the same map, in which wildcard
-  // domains are prefixed with "." (i.e. ".example.com" for "*.example.com") to differentiate
-  // between exact and wildcard entries.
-  typedef std::unordered_map<std::string, TransportProtocolsMap> ServerNamesMap;
+  // Looked up by the transport protocol detected on the socket without copying it.
+  typedef absl::flat_hash_map<std::string, ApplicationProtocolsMap> TransportProtocolsMap;
+  // Exact server names, wildcard domains (e.g. "*.example.com") and the empty name matching any
+  // server name, looked up by the most specific match of the requested server name.
+  typedef ServerNameMatcher<TransportProtocolsMap> ServerNamesMap;
   typedef std::unordered_map<std::string, ServerNamesMap> DestinationIPsMap;
   typedef std::shared_ptr<ServerNamesMap> ServerNamesMapSharedPtr;
   typedef Network::LcTrie::LcTrie<ServerNamesMapSharedPtr> DestinationIPsTrie;
@@ -330,14 +593,19 @@ private:
   typedef std::unordered_map<uint16_t, std::pair<DestinationIPsMap, DestinationIPsTriePtr>>
       DestinationPortsMap;
 
+  Ssl::CertificatePrefetchPtr prefetchCertificates(const envoy::api::v2::Listener& config,
+                                                   const std::vector<uint64_t>& filter_chain_hashes,
+                                                   const ListenerImpl* origin);
+  FilterChainImplSharedPtr
+  createFilterChain(const envoy::api::v2::listener::FilterChain& filter_chain,
+                    const std::vector<std::string>& server_names);
   void
   addFilterChain(uint16_t destination_port, const std::vector<std::string>& destination_ips,
                  const std::vector<std::string>& server_names,
                  const std::string& transport_protocol,
                  const std::vector<std::string>& application_protocols,
                  const envoy::api::v2::listener::FilterChainMatch_ConnectionSourceType source_type,
-                 Network::TransportSocketFactoryPtr&& transport_socket_factory,
-                 std::vector<Network::FilterFactoryCb> filters_factory);
+                 const Network::FilterChainSharedPtr& filter_chain);
   void addFilterChainForDestinationPorts(
       DestinationPortsMap& destination_ports_map, uint16_t destination_port,
       const std::vector<std::string>& destination_ips, const std::vector<std::string>& server_names,
@@ -384,6 +652,7 @@ private:
                                 const Network::ConnectionSocket& socket) const;
 
   static bool isWildcardServerName(const std::string& name);
+  void applyListenSocketOptions(Network::Socket& socket);
 
   // Mapping of FilterChain's configured destination ports, IPs, server names, transport protocols
   // and application protocols, using structures defined above.
@@ -393,16 +662,23 @@ private:
   Network::Address::InstanceConstSharedPtr address_;
   Network::Address::SocketType socket_type_;
   Network::SocketSharedPtr socket_;
-  Stats::ScopePtr global_scope_;   // Stats with global named scope, but needed for LDS cleanup.
-  Stats::ScopePtr listener_scope_; // Stats with listener named scope.
+  std::vector<Network::SocketSharedPtr> worker_sockets_;
+  std::vector<std::unique_ptr<WorkerListenerConfig>> worker_configs_;
+  // Stats with global named scope, but needed for LDS cleanup.
+  const Stats::ScopeSharedPtr global_scope_;
+  // Stats with listener named scope.
+  const Stats::ScopeSharedPtr listener_scope_;
   const bool bind_to_port_;
+  const bool reuse_port_;
   const bool hand_off_restored_destination_connections_;
   const uint32_t per_connection_buffer_limit_bytes_;
+  const uint32_t max_connections_to_accept_per_socket_event_;
   const uint64_t listener_tag_;
   const std::string name_;
   const bool modifiable_;
   const bool workers_started_;
   const uint64_t hash_;
+  const bool filter_chain_only_update_;
 
   // This init manager is populated with targets from the filter chain factories, namely
   // RdsRouteConfigSubscription::init_target_, so the listener can wait for route configs.
@@ -412,33 +688,17 @@ private:
   // initialization is complete. It may be reset to cancel interest.
   std::unique_ptr<Init::WatcherImpl> init_watcher_;
   std::vector<Network::ListenerFilterFactoryCb> listener_filter_factories_;
-  DrainManagerPtr local_drain_manager_;
+  std::vector<Network::UdpListenerFilterFactoryCb> udp_listener_filter_factories_;
+  // Shared with the factory contexts of the filter chains that this listener owns.
+  const std::shared_ptr<DrainManager> local_drain_manager_;
   bool saw_listener_create_failure_{};
   const envoy::api::v2::Listener config_;
   const std::string version_info_;
   Network::Socket::OptionsSharedPtr listen_socket_options_;
   const std::chrono::milliseconds listener_filters_timeout_;
-};
-
-class FilterChainImpl : public Network::FilterChain {
-public:
-  FilterChainImpl(Network::TransportSocketFactoryPtr&& transport_socket_factory,
-                  std::vector<Network::FilterFactoryCb> filters_factory)
-      : transport_socket_factory_(std::move(transport_socket_factory)),
-        filters_factory_(std::move(filters_factory)) {}
-
-  // Network::FilterChain
-  const Network::TransportSocketFactory& transportSocketFactory() const override {
-    return *transport_socket_factory_;
-  }
-
-  const std::vector<Network::FilterFactoryCb>& networkFilterFactories() const override {
-    return filters_factory_;
-  }
-
-private:
-  const Network::TransportSocketFactoryPtr transport_socket_factory_;
-  const std::vector<Network::FilterFactoryCb> filters_factory_;
+  std::shared_ptr<Network::ConnectionBalancer> connection_balancer_;
+  // All filter chains by the hash of their config, including the ones shared with the origin.
+  std::unordered_map<uint64_t, FilterChainImplSharedPtr> filter_chains_by_hash_;
 };
 
 } // namespace Server
@@ -13,6 +13,8 @@
 
 #include "server/options_impl_platform.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "spdlog/spdlog.h"
 #include "tclap/CmdLine.h"
@@ -34,6 +36,12 @@
 #endif
 
 namespace Envoy {
+
+namespace {
+// The number of CPUs a cpu_set_t holds, i.e. CPU_SETSIZE on Linux.
+const uint32_t MaxWorkerCpus = 1024;
+} // namespace
+
 OptionsImpl::OptionsImpl(int argc, const char* const* argv,
                          const HotRestartVersionCb& hot_restart_version_cb,
                          spdlog::level::level_enum default_log_level)
@@ -96,8 +104,21 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   TCLAP::ValueArg<uint32_t> file_flush_interval_msec("", "file-flush-interval-msec",
                                                      "Interval for log flushing in msec", false,
                                                      10000, "uint32_t", cmd);
+  TCLAP::ValueArg<uint64_t> file_max_buffered_bytes(
+      "", "file-max-buffered-bytes",
+      "Maximum number of bytes buffered per log file before writes are dropped (0 for no limit)",
+      false, 0, "uint64_t", cmd);
   TCLAP::ValueArg<uint32_t> drain_time_s("", "drain-time-s", "Hot restart drain time in seconds",
                                          false, 600, "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> drain_rate_per_worker(
+      "", "drain-rate-per-worker",
+      "Maximum number of connections drain closed per second per worker (0 for no limit)", false,
+      0, "uint32_t", cmd);
+  TCLAP::ValueArg<std::string> worker_cpus(
+      "", "worker-cpus",
+      "Comma separated list of CPUs and CPU ranges the worker threads are pinned to, e.g. "
+      "'0-7,16-23'",
+      false, "", "string", cmd);
   TCLAP::ValueArg<uint32_t> parent_shutdown_time_s("", "parent-shutdown-time-s",
                                                    "Hot restart parent shutdown time in seconds",
                                                    false, 900, "uint32_t", cmd);
@@ -117,15 +138,16 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
                                              cmd);
   TCLAP::SwitchArg disable_hot_restart("", "disable-hot-restart",
                                        "Disable hot restart functionality", cmd, false);
+  TCLAP::SwitchArg hot_restart_stats_transfer(
+      "", "hot-restart-stats-transfer",
+      "Keep stats in heap memory and transfer them from the parent on hot restart, instead of "
+      "preallocating them in shared memory",
+      cmd, false);
   TCLAP::SwitchArg enable_mutex_tracing(
       "", "enable-mutex-tracing", "Enable mutex contention tracing functionality", cmd, false);
   TCLAP::SwitchArg cpuset_threads(
       "", "cpuset-threads", "Get the default # of worker threads from cpuset size", cmd, false);
 
-  TCLAP::ValueArg<bool> use_libevent_buffer("", "use-libevent-buffers",
-                                            "Use the original libevent buffer implementation",
-                                            false, true, "bool", cmd);
-
   cmd.setExceptionHandling(false);
   try {
     cmd.parse(argc, argv);
@@ -159,10 +181,10 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   // TODO(jmarantz): should we also multiply these to bound the total amount of memory?
 
   hot_restart_disabled_ = disable_hot_restart.getValue();
+  hot_restart_stats_transfer_ = hot_restart_stats_transfer.getValue();
 
   mutex_tracing_enabled_ = enable_mutex_tracing.getValue();
 
-  libevent_buffer_enabled_ = use_libevent_buffer.getValue();
   cpuset_threads_ = cpuset_threads.getValue();
 
   log_level_ = default_log_level;
@@ -175,6 +197,7 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   log_format_ = log_format.getValue();
 
   parseComponentLogLevels(component_log_level.getValue());
+  parseWorkerCpus(worker_cpus.getValue());
 
   if (mode.getValue() == "serve") {
     mode_ = Server::Mode::Serve;
@@ -226,14 +249,16 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   service_node_ = service_node.getValue();
   service_zone_ = service_zone.getValue();
   file_flush_interval_msec_ = std::chrono::milliseconds(file_flush_interval_msec.getValue());
+  file_max_buffered_bytes_ = file_max_buffered_bytes.getValue();
   drain_time_ = std::chrono::seconds(drain_time_s.getValue());
+  drain_rate_per_worker_ = drain_rate_per_worker.getValue();
   parent_shutdown_time_ = std::chrono::seconds(parent_shutdown_time_s.getValue());
   max_stats_ = max_stats.getValue();
   stats_options_.max_obj_name_length_ = max_obj_name_len.getValue();
 
   if (hot_restart_version_option.getValue()) {
     std::cerr << hot_restart_version_cb(max_stats.getValue(), stats_options_.maxNameLength(),
-                                        !hot_restart_disabled_);
+                                        !hot_restart_disabled_, hot_restart_stats_transfer_);
     throw NoServingException();
   }
 }
@@ -270,6 +295,25 @@ void OptionsImpl::parseComponentLogLevels(const std::string& component_log_level
   }
 }
 
+void OptionsImpl::parseWorkerCpus(const std::string& worker_cpus) {
+  if (worker_cpus.empty()) {
+    return;
+  }
+  for (const absl::string_view cpus : absl::StrSplit(worker_cpus, ',')) {
+    const std::vector<absl::string_view> bounds = absl::StrSplit(cpus, absl::MaxSplits('-', 1));
+    uint32_t first = 0;
+    uint32_t last = 0;
+    if (!absl::SimpleAtoi(bounds[0], &first) ||
+        !absl::SimpleAtoi(bounds.size() == 2 ? bounds[1] : bounds[0], &last) || first > last ||
+        last >= MaxWorkerCpus) {
+      logError(fmt::format("error: invalid worker CPUs specified '{}'", cpus));
+    }
+    for (uint32_t cpu = first; cpu <= last; cpu++) {
+      worker_cpus_.push_back(cpu);
+    }
+  }
+}
+
 uint32_t OptionsImpl::count() const { return count_; }
 
 void OptionsImpl::logError(const std::string& error) const { throw MalformedArgvException(error); }
@@ -307,13 +351,17 @@ Server::CommandLineOptionsPtr OptionsImpl::toCommandLineOptions() const {
   }
   command_line_options->mutable_file_flush_interval()->MergeFrom(
       Protobuf::util::TimeUtil::MillisecondsToDuration(fileFlushIntervalMsec().count()));
+  command_line_options->set_file_max_buffered_bytes(fileMaxBufferedBytes());
   command_line_options->mutable_parent_shutdown_time()->MergeFrom(
       Protobuf::util::TimeUtil::SecondsToDuration(parentShutdownTime().count()));
   command_line_options->mutable_drain_time()->MergeFrom(
       Protobuf::util::TimeUtil::SecondsToDuration(drainTime().count()));
+  command_line_options->set_drain_rate_per_worker(drainRatePerWorker());
+  command_line_options->set_worker_cpus(absl::StrJoin(workerCpus(), ","));
   command_line_options->set_max_stats(maxStats());
   command_line_options->set_max_obj_name_len(statsOptions().maxObjNameLength());
   command_line_options->set_disable_hot_restart(hotRestartDisabled());
+  command_line_options->set_hot_restart_stats_transfer(hotRestartStatsTransfer());
   command_line_options->set_enable_mutex_tracing(mutexTracingEnabled());
   command_line_options->set_cpuset_threads(cpusetThreadsEnabled());
   command_line_options->set_restart_epoch(restartEpoch());
@@ -326,9 +374,9 @@ OptionsImpl::OptionsImpl(const std::string& service_cluster, const std::string&
       local_address_ip_version_(Network::Address::IpVersion::v4), log_level_(log_level),
       log_format_(Logger::Logger::DEFAULT_LOG_FORMAT), restart_epoch_(0u),
       service_cluster_(service_cluster), service_node_(service_node), service_zone_(service_zone),
-      file_flush_interval_msec_(10000), drain_time_(600), parent_shutdown_time_(900),
-      mode_(Server::Mode::Serve), max_stats_(ENVOY_DEFAULT_MAX_STATS), hot_restart_disabled_(false),
-      signal_handling_enabled_(true), mutex_tracing_enabled_(false), cpuset_threads_(false),
-      libevent_buffer_enabled_(false) {}
+      file_flush_interval_msec_(10000), file_max_buffered_bytes_(0), drain_time_(600),
+      drain_rate_per_worker_(0), parent_shutdown_time_(900), mode_(Server::Mode::Serve),
+      max_stats_(ENVOY_DEFAULT_MAX_STATS), hot_restart_disabled_(false),
+      signal_handling_enabled_(true), mutex_tracing_enabled_(false), cpuset_threads_(false) {}
 
 } // namespace Envoy
@@ -20,9 +20,10 @@ namespace Envoy {
 class OptionsImpl : public Server::Options, protected Logger::Loggable<Logger::Id::config> {
 public:
   /**
-   * Parameters are max_num_stats, max_stat_name_len, hot_restart_enabled
+   * Parameters are max_num_stats, max_stat_name_len, hot_restart_enabled,
+   * hot_restart_stats_transfer
    */
-  typedef std::function<std::string(uint64_t, uint64_t, bool)> HotRestartVersionCb;
+  typedef std::function<std::string(uint64_t, uint64_t, bool, bool)> HotRestartVersionCb;
 
   /**
    * @throw NoServingException if Envoy has already done everything specified by the argv (e.g.
@@ -50,6 +51,10 @@ public:
     local_address_ip_version_ = local_address_ip_version;
   }
   void setDrainTime(std::chrono::seconds drain_time) { drain_time_ = drain_time; }
+  void setDrainRatePerWorker(uint32_t drain_rate_per_worker) {
+    drain_rate_per_worker_ = drain_rate_per_worker;
+  }
+  void setWorkerCpus(const std::vector<uint32_t>& worker_cpus) { worker_cpus_ = worker_cpus; }
   void setLogLevel(spdlog::level::level_enum log_level) { log_level_ = log_level; }
   void setLogFormat(const std::string& log_format) { log_format_ = log_format; }
   void setLogPath(const std::string& log_path) { log_path_ = log_path; }
@@ -61,6 +66,9 @@ public:
   void setFileFlushIntervalMsec(std::chrono::milliseconds file_flush_interval_msec) {
     file_flush_interval_msec_ = file_flush_interval_msec;
   }
+  void setFileMaxBufferedBytes(uint64_t file_max_buffered_bytes) {
+    file_max_buffered_bytes_ = file_max_buffered_bytes;
+  }
   void setServiceClusterName(const std::string& service_cluster) {
     service_cluster_ = service_cluster;
   }
@@ -71,6 +79,9 @@ public:
   void setHotRestartDisabled(bool hot_restart_disabled) {
     hot_restart_disabled_ = hot_restart_disabled;
   }
+  void setHotRestartStatsTransfer(bool hot_restart_stats_transfer) {
+    hot_restart_stats_transfer_ = hot_restart_stats_transfer;
+  }
   void setSignalHandling(bool signal_handling_enabled) {
     signal_handling_enabled_ = signal_handling_enabled;
   }
@@ -86,6 +97,8 @@ public:
     return local_address_ip_version_;
   }
   std::chrono::seconds drainTime() const override { return drain_time_; }
+  uint32_t drainRatePerWorker() const override { return drain_rate_per_worker_; }
+  const std::vector<uint32_t>& workerCpus() const override { return worker_cpus_; }
   spdlog::level::level_enum logLevel() const override { return log_level_; }
   const std::vector<std::pair<std::string, spdlog::level::level_enum>>&
   componentLogLevels() const override {
@@ -99,17 +112,19 @@ public:
   std::chrono::milliseconds fileFlushIntervalMsec() const override {
     return file_flush_interval_msec_;
   }
+  uint64_t fileMaxBufferedBytes() const override { return file_max_buffered_bytes_; }
   const std::string& serviceClusterName() const override { return service_cluster_; }
   const std::string& serviceNodeName() const override { return service_node_; }
   const std::string& serviceZone() const override { return service_zone_; }
   uint64_t maxStats() const override { return max_stats_; }
   const Stats::StatsOptions& statsOptions() const override { return stats_options_; }
   bool hotRestartDisabled() const override { return hot_restart_disabled_; }
+  bool hotRestartStatsTransfer() const override { return hot_restart_stats_transfer_; }
   bool signalHandlingEnabled() const override { return signal_handling_enabled_; }
   bool mutexTracingEnabled() const override { return mutex_tracing_enabled_; }
-  bool libeventBufferEnabled() const override { return libevent_buffer_enabled_; }
   virtual Server::CommandLineOptionsPtr toCommandLineOptions() const override;
   void parseComponentLogLevels(const std::string& component_log_levels);
+  void parseWorkerCpus(const std::string& worker_cpus);
   bool cpusetThreadsEnabled() const override { return cpuset_threads_; }
   uint32_t count() const;
 
@@ -133,16 +148,19 @@ private:
   std::string service_node_;
   std::string service_zone_;
   std::chrono::milliseconds file_flush_interval_msec_;
+  uint64_t file_max_buffered_bytes_;
   std::chrono::seconds drain_time_;
+  uint32_t drain_rate_per_worker_;
+  std::vector<uint32_t> worker_cpus_;
   std::chrono::seconds parent_shutdown_time_;
   Server::Mode mode_;
   uint64_t max_stats_;
   Stats::StatsOptionsImpl stats_options_;
   bool hot_restart_disabled_;
+  bool hot_restart_stats_transfer_{false};
   bool signal_handling_enabled_;
   bool mutex_tracing_enabled_;
   bool cpuset_threads_;
-  bool libevent_buffer_enabled_;
   uint32_t count_;
 };
 
@@ -8,16 +8,20 @@ namespace Configuration {
 
 class ResourceMonitorFactoryContextImpl : public ResourceMonitorFactoryContext {
 public:
-  ResourceMonitorFactoryContextImpl(Event::Dispatcher& dispatcher, Api::Api& api)
-      : dispatcher_(dispatcher), api_(api) {}
+  ResourceMonitorFactoryContextImpl(Event::Dispatcher& dispatcher, Api::Api& api,
+                                    ThreadLocal::SlotAllocator& thread_local)
+      : dispatcher_(dispatcher), api_(api), thread_local_(thread_local) {}
 
   Event::Dispatcher& dispatcher() override { return dispatcher_; }
 
   Api::Api& api() override { return api_; }
 
+  ThreadLocal::SlotAllocator& threadLocal() override { return thread_local_; }
+
 private:
   Event::Dispatcher& dispatcher_;
   Api::Api& api_;
+  ThreadLocal::SlotAllocator& thread_local_;
 };
 
 } // namespace Configuration
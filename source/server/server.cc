@@ -23,6 +23,7 @@
 #include "common/api/os_sys_calls_impl.h"
 #include "common/buffer/buffer_impl.h"
 #include "common/common/mutex_tracer_impl.h"
+#include "common/common/object_pool.h"
 #include "common/common/utility.h"
 #include "common/common/version.h"
 #include "common/config/bootstrap_json.h"
@@ -30,8 +31,11 @@
 #include "common/config/utility.h"
 #include "common/http/codes.h"
 #include "common/local_info/local_info_impl.h"
+#include "common/memory/accounting.h"
 #include "common/memory/stats.h"
 #include "common/network/address_impl.h"
+#include "common/network/dns_cache_impl.h"
+#include "common/profiler/cpu_sampler.h"
 #include "common/protobuf/utility.h"
 #include "common/router/rds_impl.h"
 #include "common/runtime/runtime_impl.h"
@@ -65,8 +69,8 @@ InstanceImpl::InstanceImpl(const Options& options, Event::TimeSystem& time_syste
       random_generator_(std::move(random_generator)), listener_component_factory_(*this),
       worker_factory_(thread_local_, *api_, hooks),
       dns_resolver_(dispatcher_->createDnsResolver({})),
-      access_log_manager_(options.fileFlushIntervalMsec(), *api_, *dispatcher_, access_log_lock,
-                          store),
+      access_log_manager_(options.fileFlushIntervalMsec(), options.fileMaxBufferedBytes(), *api_,
+                          *dispatcher_, access_log_lock, store),
       terminated_(false),
       mutex_tracer_(options.mutexTracingEnabled() ? &Envoy::MutexTracerImpl::getOrCreateTracer()
                                                   : nullptr),
@@ -147,25 +151,49 @@ void InstanceImpl::flushStats() {
   ENVOY_LOG(debug, "flushing stats");
   // A shutdown initiated before this callback may prevent this from being called as per
   // the semantics documented in ThreadLocal's runOnAllThreads method.
+  stats_store_.mergeHistograms([this]() -> void { flushStatsInternal(); });
+}
+
+void InstanceImpl::mergeHistograms() {
+  ENVOY_LOG(debug, "merging histograms");
   stats_store_.mergeHistograms([this]() -> void {
-    HotRestart::GetParentStatsInfo info;
-    restarter_.getParentStats(info);
-    server_stats_->uptime_.set(time(nullptr) - original_start_time_);
-    server_stats_->memory_allocated_.set(Memory::Stats::totalCurrentlyAllocated() +
-                                         info.memory_allocated_);
-    server_stats_->memory_heap_size_.set(Memory::Stats::totalCurrentlyReserved());
-    server_stats_->parent_connections_.set(info.num_connections_);
-    server_stats_->total_connections_.set(numConnections() + info.num_connections_);
-    server_stats_->days_until_first_cert_expiring_.set(
-        sslContextManager().daysUntilFirstCertExpires());
-    InstanceUtil::flushMetricsToSinks(config_.statsSinks(), stats_store_.source());
-    // TODO(ramaraochavali): consider adding different flush interval for histograms.
-    if (stat_flush_timer_ != nullptr) {
-      stat_flush_timer_->enableTimer(config_.statsFlushInterval());
+    if (histogram_merge_timer_ != nullptr) {
+      histogram_merge_timer_->enableTimer(config_.histogramMergeInterval().value());
     }
   });
 }
 
+void InstanceImpl::flushStatsInternal() {
+  HotRestart::GetParentStatsInfo info;
+  restarter_.getParentStats(info);
+  server_stats_->uptime_.set(time(nullptr) - original_start_time_);
+  server_stats_->memory_allocated_.set(Memory::Stats::totalCurrentlyAllocated() +
+                                       info.memory_allocated_);
+  server_stats_->memory_heap_size_.set(Memory::Stats::totalCurrentlyReserved());
+  server_stats_->memory_buffer_bytes_.set(Memory::Accounting::bytes(Memory::AccountingTag::Buffer));
+  server_stats_->memory_header_map_bytes_.set(
+      Memory::Accounting::bytes(Memory::AccountingTag::HeaderMap));
+  server_stats_->memory_stats_bytes_.set(Memory::Accounting::bytes(Memory::AccountingTag::Stats));
+  server_stats_->memory_config_bytes_.set(Memory::Accounting::bytes(Memory::AccountingTag::Config));
+  // The pool only exposes running totals, so the counters are advanced by the difference.
+  server_stats_->buffer_slice_pool_hit_.add(Buffer::SlicePool::hits() -
+                                            server_stats_->buffer_slice_pool_hit_.value());
+  server_stats_->buffer_slice_pool_miss_.add(Buffer::SlicePool::misses() -
+                                             server_stats_->buffer_slice_pool_miss_.value());
+  server_stats_->object_pool_hit_.add(ObjectPool::hits() - server_stats_->object_pool_hit_.value());
+  server_stats_->object_pool_miss_.add(ObjectPool::misses() -
+                                       server_stats_->object_pool_miss_.value());
+  server_stats_->parent_connections_.set(info.num_connections_);
+  server_stats_->total_connections_.set(numConnections() + info.num_connections_);
+  server_stats_->days_until_first_cert_expiring_.set(
+      sslContextManager().daysUntilFirstCertExpires());
+  InstanceUtil::flushMetricsToSinks(config_.statsSinks(), stats_store_.source());
+  restarter_.mergeParentStats();
+  if (stat_flush_timer_ != nullptr) {
+    stat_flush_timer_->enableTimer(config_.statsFlushInterval());
+  }
+}
+
 void InstanceImpl::getParentStats(HotRestart::GetParentStatsInfo& info) {
   info.memory_allocated_ = Memory::Stats::totalCurrentlyAllocated();
   info.num_connections_ = numConnections();
@@ -227,12 +255,6 @@ void InstanceImpl::initialize(const Options& options,
             Registry::FactoryRegistry<
                 Configuration::UpstreamTransportSocketConfigFactory>::allFactoryNames());
 
-  // Enable the selected buffer implementation (old libevent evbuffer version or new native
-  // version) early in the initialization, before any buffers can be created.
-  Buffer::OwnedImpl::useOldImpl(options.libeventBufferEnabled());
-  ENVOY_LOG(info, "buffer implementation: {}",
-            Buffer::OwnedImpl().usesOldImpl() ? "old (libevent)" : "new");
-
   // Handle configuration that needs to take place prior to the main configuration load.
   InstanceUtil::loadBootstrapConfig(bootstrap_, options, *api_);
   bootstrap_config_update_time_ = time_source_.systemTime();
@@ -267,6 +289,10 @@ void InstanceImpl::initialize(const Options& options,
       bootstrap_.node(), std::move(local_address), options.serviceZone(),
       options.serviceClusterName(), options.serviceNodeName());
 
+  if (bootstrap_.enable_dispatcher_stats()) {
+    dispatcher_->initializeStats(stats_store_, "server.");
+  }
+
   Configuration::InitialImpl initial_config(bootstrap_);
 
   HotRestart::ShutdownParentAdminInfo info;
@@ -301,8 +327,8 @@ void InstanceImpl::initialize(const Options& options,
       std::make_unique<Memory::HeapShrinker>(*dispatcher_, *overload_manager_, stats_store_);
 
   // Workers get created first so they register for thread local updates.
-  listener_manager_ =
-      std::make_unique<ListenerManagerImpl>(*this, listener_component_factory_, worker_factory_);
+  listener_manager_ = std::make_unique<ListenerManagerImpl>(
+      *this, listener_component_factory_, worker_factory_, bootstrap_.enable_dispatcher_stats());
 
   // The main thread is also registered for thread local updates so that code that does not care
   // whether it runs on the main thread or on workers can still use TLS.
@@ -318,8 +344,18 @@ void InstanceImpl::initialize(const Options& options,
   hooks.onRuntimeCreated();
 
   // Once we have runtime we can initialize the SSL context manager.
-  ssl_context_manager_ =
-      std::make_unique<Extensions::TransportSockets::Tls::ContextManagerImpl>(time_source_);
+  ssl_context_manager_ = std::make_unique<Extensions::TransportSockets::Tls::ContextManagerImpl>(
+      time_source_, stats_store_, bootstrap_.cluster_manager().share_upstream_tls_contexts());
+
+  // The clusters that use the default resolver share its cache. Clusters with resolvers of their
+  // own are not cached, as their resolvers may answer differently.
+  if (bootstrap_.cluster_manager().has_dns_cache_ttl()) {
+    dns_resolver_ = std::make_shared<Network::DnsCacheImpl>(
+        dns_resolver_, *dispatcher_,
+        std::chrono::milliseconds(
+            PROTOBUF_GET_MS_REQUIRED(bootstrap_.cluster_manager(), dns_cache_ttl)),
+        stats_store_);
+  }
 
   cluster_manager_factory_ = std::make_unique<Upstream::ProdClusterManagerFactory>(
       *admin_, Runtime::LoaderSingleton::get(), stats_store_, thread_local_, *random_generator_,
@@ -342,7 +378,8 @@ void InstanceImpl::initialize(const Options& options,
   if (bootstrap_.has_hds_config()) {
     const auto& hds_config = bootstrap_.hds_config();
     async_client_manager_ = std::make_unique<Grpc::AsyncClientManagerImpl>(
-        *config_.clusterManager(), thread_local_, time_source_, *api_);
+        *config_.clusterManager(), thread_local_, time_source_, *api_,
+        bootstrap_.cluster_manager().google_grpc_completion_threads());
     hds_delegate_ = std::make_unique<Upstream::HdsDelegate>(
         stats_store_,
         Config::Utility::factoryForGrpcApiConfigSource(*async_client_manager_, hds_config,
@@ -359,7 +396,15 @@ void InstanceImpl::initialize(const Options& options,
 
   // Some of the stat sinks may need dispatcher support so don't flush until the main loop starts.
   // Just setup the timer.
-  stat_flush_timer_ = dispatcher_->createTimer([this]() -> void { flushStats(); });
+  // When histograms have their own merge interval, the flush timer only flushes counters and
+  // gauges, along with the histograms as of their last merge.
+  if (config_.histogramMergeInterval()) {
+    histogram_merge_timer_ = dispatcher_->createTimer([this]() -> void { mergeHistograms(); });
+    histogram_merge_timer_->enableTimer(config_.histogramMergeInterval().value());
+    stat_flush_timer_ = dispatcher_->createTimer([this]() -> void { flushStatsInternal(); });
+  } else {
+    stat_flush_timer_ = dispatcher_->createTimer([this]() -> void { flushStats(); });
+  }
   stat_flush_timer_->enableTimer(config_.statsFlushInterval());
 
   // GuardDog (deadlock detection) object and thread setup before workers are
@@ -476,6 +521,7 @@ void InstanceImpl::run() {
 
   // Run the main dispatch loop waiting to exit.
   ENVOY_LOG(info, "starting main dispatch loop");
+  Profiler::CpuSampler::ScopedThread sampled_thread;
   auto watchdog = guard_dog_->createWatchDog(api_->threadFactory().currentThreadId());
   watchdog->startWatchdog(*dispatcher_);
   dispatcher_->post([this] { notifyCallbacksForStage(Stage::Startup); });
@@ -538,6 +584,7 @@ void InstanceImpl::shutdownAdmin() {
   //                     histogram flushing. In the future we can consider whether we want to
   //                     somehow keep flushing histograms from the old process.
   stat_flush_timer_.reset();
+  histogram_merge_timer_.reset();
   handler_->stopListeners();
   admin_->closeSocket();
 
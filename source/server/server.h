@@ -46,10 +46,18 @@ namespace Server {
  */
 // clang-format off
 #define ALL_SERVER_STATS(COUNTER, GAUGE)                                                           \
+  COUNTER(buffer_slice_pool_hit)                                                                   \
+  COUNTER(buffer_slice_pool_miss)                                                                  \
+  COUNTER(object_pool_hit)                                                                         \
+  COUNTER(object_pool_miss)                                                                        \
   GAUGE(uptime)                                                                                    \
   GAUGE(concurrency)                                                                               \
   GAUGE(memory_allocated)                                                                          \
   GAUGE(memory_heap_size)                                                                          \
+  GAUGE(memory_buffer_bytes)                                                                       \
+  GAUGE(memory_header_map_bytes)                                                                   \
+  GAUGE(memory_stats_bytes)                                                                        \
+  GAUGE(memory_config_bytes)                                                                       \
   GAUGE(live)                                                                                      \
   GAUGE(parent_connections)                                                                        \
   GAUGE(total_connections)                                                                         \
@@ -200,6 +208,8 @@ public:
 private:
   ProtobufTypes::MessagePtr dumpBootstrapConfig();
   void flushStats();
+  void flushStatsInternal();
+  void mergeHistograms();
   void initialize(const Options& options, Network::Address::InstanceConstSharedPtr local_address,
                   ComponentFactory& component_factory, TestHooks& hooks);
   void loadServerFlags(const absl::optional<std::string>& flags_path);
@@ -242,6 +252,8 @@ private:
   Configuration::MainImpl config_;
   Network::DnsResolverSharedPtr dns_resolver_;
   Event::TimerPtr stat_flush_timer_;
+  // Only set if histograms are merged on their own interval rather than before each flush.
+  Event::TimerPtr histogram_merge_timer_;
   LocalInfo::LocalInfoPtr local_info_;
   DrainManagerPtr drain_manager_;
   AccessLog::AccessLogManagerImpl access_log_manager_;
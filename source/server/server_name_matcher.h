@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Server {
+
+/**
+ * Maps the server names of filter chains to values, and finds the value of the most specific
+ * server name matching the one requested by a connection: the exact name (e.g. "www.example.com"),
+ * else the longest matching wildcard domain (e.g. "*.example.com", then "*.com"), else the empty
+ * name, which matches any server name. Lookups don't allocate, and only the suffixes of the
+ * requested name that are as long as some wildcard domain are looked up, so that lookups in large
+ * maps cost a few hash lookups whatever the number of names.
+ */
+template <class T> class ServerNameMatcher {
+public:
+  /**
+   * @param server_name supplies an exact server name, a wildcard domain starting with "*." or the
+   *        empty name.
+   * @return T& the value of the server name, default constructed if the name is new.
+   */
+  T& operator[](const std::string& server_name) {
+    if (!absl::StartsWith(server_name, "*.")) {
+      return exact_names_[server_name];
+    }
+    // Wildcard domains are stored without the "*", i.e. ".example.com" for "*.example.com", so that
+    // they are looked up by the suffixes of the requested names.
+    const size_t length = server_name.size() - 1;
+    min_wildcard_length_ = std::min(min_wildcard_length_, length);
+    max_wildcard_length_ = std::max(max_wildcard_length_, length);
+    return wildcard_domains_[server_name.substr(1)];
+  }
+
+  /**
+   * @param server_name supplies the server name requested by a connection, empty if none.
+   * @return const T* the value of the most specific matching server name, nullptr if none matches.
+   */
+  const T* find(absl::string_view server_name) const {
+    const auto exact_match = exact_names_.find(server_name);
+    if (exact_match != exact_names_.end()) {
+      return &exact_match->second;
+    }
+
+    // Match on the wildcard domains, longest first, i.e. ".example.com" and then ".com" for
+    // "www.example.com". Neither the whole name nor a trailing "." are wildcard domains.
+    size_t pos = server_name.find('.', 1);
+    while (pos != absl::string_view::npos && pos < server_name.size() - 1) {
+      const size_t length = server_name.size() - pos;
+      if (length < min_wildcard_length_) {
+        break;
+      }
+      if (length <= max_wildcard_length_) {
+        const auto wildcard_match = wildcard_domains_.find(server_name.substr(pos));
+        if (wildcard_match != wildcard_domains_.end()) {
+          return &wildcard_match->second;
+        }
+      }
+      pos = server_name.find('.', pos + 1);
+    }
+
+    const auto catchall_match = exact_names_.find(absl::string_view());
+    return catchall_match != exact_names_.end() ? &catchall_match->second : nullptr;
+  }
+
+private:
+  absl::flat_hash_map<std::string, T> exact_names_;
+  absl::flat_hash_map<std::string, T> wildcard_domains_;
+  // The length bounds of the wildcard domains, i.e. of ".example.com" for "*.example.com".
+  size_t min_wildcard_length_{std::numeric_limits<size_t>::max()};
+  size_t max_wildcard_length_{};
+};
+
+} // namespace Server
+} // namespace Envoy
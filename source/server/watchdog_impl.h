@@ -27,18 +27,21 @@ public:
 
   const Thread::ThreadId& threadId() const override { return *thread_id_; }
   MonotonicTime lastTouchTime() const override {
-    return MonotonicTime(latest_touch_time_since_epoch_.load());
+    return MonotonicTime(latest_touch_time_since_epoch_.load(std::memory_order_relaxed));
   }
 
   // Server::WatchDog
   void startWatchdog(Event::Dispatcher& dispatcher) override;
   void touch() override {
-    latest_touch_time_since_epoch_.store(time_source_.monotonicTime().time_since_epoch());
+    latest_touch_time_since_epoch_.store(time_source_.monotonicTime().time_since_epoch(),
+                                         std::memory_order_relaxed);
   }
 
 private:
   Thread::ThreadIdPtr thread_id_;
   TimeSource& time_source_;
+  // Only the watched thread writes the touch time and the GuardDog doesn't read anything else
+  // through it, so relaxed ordering is enough and touch() is a plain store.
   std::atomic<std::chrono::steady_clock::duration> latest_touch_time_since_epoch_;
   Event::TimerPtr timer_;
   const std::chrono::milliseconds timer_interval_;
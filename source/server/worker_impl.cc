@@ -8,24 +8,29 @@
 #include "envoy/server/configuration.h"
 #include "envoy/thread_local/thread_local.h"
 
+#include "common/profiler/cpu_sampler.h"
+
 #include "server/connection_handler_impl.h"
+#include "server/worker_impl_platform.h"
 
 namespace Envoy {
 namespace Server {
 
-WorkerPtr ProdWorkerFactory::createWorker(OverloadManager& overload_manager) {
+WorkerPtr ProdWorkerFactory::createWorker(OverloadManager& overload_manager,
+                                          absl::optional<uint32_t> cpu) {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher());
   return WorkerPtr{new WorkerImpl(
       tls_, hooks_, std::move(dispatcher),
       Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)},
-      overload_manager, api_)};
+      overload_manager, api_, cpu)};
 }
 
 WorkerImpl::WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks,
                        Event::DispatcherPtr&& dispatcher, Network::ConnectionHandlerPtr handler,
-                       OverloadManager& overload_manager, Api::Api& api)
+                       OverloadManager& overload_manager, Api::Api& api,
+                       absl::optional<uint32_t> cpu)
     : tls_(tls), hooks_(hooks), dispatcher_(std::move(dispatcher)), handler_(std::move(handler)),
-      api_(api) {
+      api_(api), cpu_(cpu) {
   tls_.registerThread(*dispatcher_, false);
   overload_manager.registerForAction(
       OverloadActionNames::get().StopAcceptingConnections, *dispatcher_,
@@ -67,6 +72,16 @@ void WorkerImpl::removeListener(Network::ListenerConfig& listener,
   });
 }
 
+void WorkerImpl::removeFilterChains(uint64_t listener_tag,
+                                    const std::list<const Network::FilterChain*>& filter_chains,
+                                    std::function<void()> completion) {
+  ASSERT(thread_);
+  dispatcher_->post([this, listener_tag, filter_chains, completion]() -> void {
+    handler_->removeFilterChains(listener_tag, filter_chains);
+    completion();
+  });
+}
+
 void WorkerImpl::start(GuardDog& guard_dog) {
   ASSERT(!thread_);
   thread_ =
@@ -94,6 +109,12 @@ void WorkerImpl::stopListeners() {
 }
 
 void WorkerImpl::threadRoutine(GuardDog& guard_dog) {
+  // The thread is pinned before it allocates anything, so that the pages it touches first, and
+  // with them its connections and buffers, are placed on the NUMA node of its CPU.
+  if (cpu_.has_value() && WorkerImplPlatform::pinCurrentThread(cpu_.value())) {
+    ENVOY_LOG(debug, "worker pinned to CPU {}", cpu_.value());
+  }
+  Profiler::CpuSampler::ScopedThread sampled_thread;
   ENVOY_LOG(debug, "worker entering dispatch loop");
   auto watchdog = guard_dog.createWatchDog(api_.threadFactory().currentThreadId());
   watchdog->startWatchdog(*dispatcher_);
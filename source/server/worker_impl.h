@@ -23,7 +23,7 @@ public:
       : tls_(tls), api_(api), hooks_(hooks) {}
 
   // Server::WorkerFactory
-  WorkerPtr createWorker(OverloadManager& overload_manager) override;
+  WorkerPtr createWorker(OverloadManager& overload_manager, absl::optional<uint32_t> cpu) override;
 
 private:
   ThreadLocal::Instance& tls_;
@@ -38,12 +38,18 @@ class WorkerImpl : public Worker, Logger::Loggable<Logger::Id::main> {
 public:
   WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks, Event::DispatcherPtr&& dispatcher,
              Network::ConnectionHandlerPtr handler, OverloadManager& overload_manager,
-             Api::Api& api);
+             Api::Api& api, absl::optional<uint32_t> cpu);
 
   // Server::Worker
   void addListener(Network::ListenerConfig& listener, AddListenerCompletion completion) override;
   uint64_t numConnections() override;
+  void initializeStats(Stats::Scope& scope, const std::string& prefix) override {
+    dispatcher_->initializeStats(scope, prefix);
+  }
   void removeListener(Network::ListenerConfig& listener, std::function<void()> completion) override;
+  void removeFilterChains(uint64_t listener_tag,
+                          const std::list<const Network::FilterChain*>& filter_chains,
+                          std::function<void()> completion) override;
   void start(GuardDog& guard_dog) override;
   void stop() override;
   void stopListener(Network::ListenerConfig& listener) override;
@@ -58,6 +64,8 @@ private:
   Event::DispatcherPtr dispatcher_;
   Network::ConnectionHandlerPtr handler_;
   Api::Api& api_;
+  // The CPU the thread is pinned to, if any.
+  const absl::optional<uint32_t> cpu_;
   Thread::ThreadPtr thread_;
 };
 
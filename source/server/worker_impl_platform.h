@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Server {
+
+class WorkerImplPlatform : protected Logger::Loggable<Logger::Id::main> {
+public:
+  /**
+   * Pin the calling thread to a CPU.
+   * @param cpu supplies the CPU.
+   * @return bool whether the thread was pinned.
+   */
+  static bool pinCurrentThread(uint32_t cpu);
+};
+
+} // namespace Server
+} // namespace Envoy
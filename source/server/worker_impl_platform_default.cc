@@ -0,0 +1,15 @@
+#include "common/common/logger.h"
+
+#include "server/worker_impl_platform.h"
+
+namespace Envoy {
+namespace Server {
+
+bool WorkerImplPlatform::pinCurrentThread(uint32_t cpu) {
+  ENVOY_LOG(warn, "worker not pinned to CPU {}: thread affinity is not supported on this platform",
+            cpu);
+  return false;
+}
+
+} // namespace Server
+} // namespace Envoy
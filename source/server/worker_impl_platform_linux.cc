@@ -0,0 +1,36 @@
+#if !defined(__linux__)
+#error "Linux platform file is part of non-Linux build."
+#endif
+
+#include <sched.h>
+
+#include <cstring>
+
+#include "common/api/os_sys_calls_impl_linux.h"
+
+#include "server/worker_impl_platform.h"
+
+namespace Envoy {
+namespace Server {
+
+bool WorkerImplPlatform::pinCurrentThread(uint32_t cpu) {
+  if (cpu >= CPU_SETSIZE) {
+    ENVOY_LOG(warn, "worker not pinned to CPU {}: greater than the largest CPU {}", cpu,
+              CPU_SETSIZE - 1);
+    return false;
+  }
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  CPU_SET(cpu, &mask);
+  // A pid of 0 is the calling thread.
+  const Api::SysCallIntResult result =
+      Api::LinuxOsSysCallsSingleton::get().sched_setaffinity(0, sizeof(cpu_set_t), &mask);
+  if (result.rc_ == -1) {
+    ENVOY_LOG(warn, "worker not pinned to CPU {}: {}", cpu, strerror(result.errno_));
+    return false;
+  }
+  return true;
+}
+
+} // namespace Server
+} // namespace Envoy
@@ -9,6 +9,7 @@
 namespace {
 
 static std::unique_ptr<Envoy::AccessLog::FormatterImpl> formatter;
+static std::unique_ptr<Envoy::AccessLog::JsonFormatterImpl> json_formatter;
 static std::unique_ptr<Envoy::TestStreamInfo> stream_info;
 
 } // namespace
@@ -29,6 +30,37 @@ static void BM_AccessLogFormatter(benchmark::State& state) {
 }
 BENCHMARK(BM_AccessLogFormatter);
 
+// Appends each line into the same string, as a logger reusing its buffer would.
+static void BM_AccessLogFormatterAppend(benchmark::State& state) {
+  size_t output_bytes = 0;
+  Http::TestHeaderMapImpl request_headers;
+  Http::TestHeaderMapImpl response_headers;
+  Http::TestHeaderMapImpl response_trailers;
+  std::string log_line;
+  for (auto _ : state) {
+    log_line.clear();
+    formatter->formatTo(request_headers, response_headers, response_trailers, *stream_info,
+                        log_line);
+    output_bytes += log_line.length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+}
+BENCHMARK(BM_AccessLogFormatterAppend);
+
+static void BM_JsonAccessLogFormatter(benchmark::State& state) {
+  size_t output_bytes = 0;
+  Http::TestHeaderMapImpl request_headers;
+  Http::TestHeaderMapImpl response_headers;
+  Http::TestHeaderMapImpl response_trailers;
+  for (auto _ : state) {
+    output_bytes +=
+        json_formatter->format(request_headers, response_headers, response_trailers, *stream_info)
+            .length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+}
+BENCHMARK(BM_JsonAccessLogFormatter);
+
 } // namespace Envoy
 
 // Boilerplate main(), which discovers benchmarks in the same file and runs them.
@@ -40,6 +72,18 @@ int main(int argc, char** argv) {
       "s%RESPONSE_CODE% %BYTES_SENT% %DURATION% %REQ(REFERER)% \"%REQ(USER-AGENT)%\" - - -\n";
 
   formatter = std::make_unique<Envoy::AccessLog::FormatterImpl>(LogFormat);
+  std::unordered_map<std::string, std::string> json_log_format = {
+      {"remote_address", "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT%"},
+      {"start_time", "%START_TIME(%Y/%m/%dT%H:%M:%S%z %s)%"},
+      {"method", "%REQ(:METHOD)%"},
+      {"url", "%REQ(X-FORWARDED-PROTO)%://%REQ(:AUTHORITY)%%REQ(X-ENVOY-ORIGINAL-PATH?:PATH)%"},
+      {"protocol", "%PROTOCOL%"},
+      {"response_code", "%RESPONSE_CODE%"},
+      {"bytes_sent", "%BYTES_SENT%"},
+      {"duration", "%DURATION%"},
+      {"referer", "%REQ(REFERER)%"},
+      {"user_agent", "%REQ(USER-AGENT)%"}};
+  json_formatter = std::make_unique<Envoy::AccessLog::JsonFormatterImpl>(json_log_format);
   stream_info = std::make_unique<Envoy::TestStreamInfo>();
   stream_info->setDownstreamRemoteAddress(
       std::make_shared<Envoy::Network::Address::Ipv4Instance>("203.0.113.1"));
@@ -98,6 +98,30 @@ TEST(AccessLogFormatterTest, streamInfoFormatter) {
     EXPECT_EQ("-", ttlb_duration_format.format(header, header, header, stream_info));
   }
 
+  {
+    StreamInfoFormatter filter_duration_format("FILTER_DURATION");
+    StreamInfoFormatter pool_wait_duration_format("UPSTREAM_POOL_WAIT_DURATION");
+    StreamInfoFormatter connect_duration_format("UPSTREAM_CONNECT_DURATION");
+    StreamInfoFormatter handshake_duration_format("UPSTREAM_HANDSHAKE_DURATION");
+    EXPECT_EQ("-", filter_duration_format.format(header, header, header, stream_info));
+    EXPECT_EQ("-", pool_wait_duration_format.format(header, header, header, stream_info));
+    EXPECT_EQ("-", connect_duration_format.format(header, header, header, stream_info));
+    EXPECT_EQ("-", handshake_duration_format.format(header, header, header, stream_info));
+
+    StreamInfo::UpstreamTiming& timing = stream_info.upstream_timing_;
+    const MonotonicTime start = stream_info.start_time_monotonic_;
+    timing.upstream_request_start_ = start + std::chrono::milliseconds(2);
+    timing.upstream_connect_start_ = start + std::chrono::milliseconds(3);
+    timing.upstream_connect_complete_ = start + std::chrono::milliseconds(7);
+    timing.upstream_handshake_complete_ = start + std::chrono::milliseconds(15);
+    timing.first_upstream_tx_byte_sent_ = start + std::chrono::milliseconds(16);
+    EXPECT_EQ("2", filter_duration_format.format(header, header, header, stream_info));
+    EXPECT_EQ("14", pool_wait_duration_format.format(header, header, header, stream_info));
+    EXPECT_EQ("4", connect_duration_format.format(header, header, header, stream_info));
+    EXPECT_EQ("8", handshake_duration_format.format(header, header, header, stream_info));
+    timing = StreamInfo::UpstreamTiming();
+  }
+
   {
     StreamInfoFormatter bytes_received_format("BYTES_RECEIVED");
     EXPECT_CALL(stream_info, bytesReceived()).WillOnce(Return(1));
@@ -691,6 +715,46 @@ TEST(AccessLogFormatterTest, JsonFormatterMultiTokenTest) {
   }
 }
 
+TEST(AccessLogFormatterTest, JsonFormatterEscapeTest) {
+  StreamInfo::MockStreamInfo stream_info;
+  Http::TestHeaderMapImpl request_header{{"key", "a\"b\\c\td\x01" "e"}};
+  Http::TestHeaderMapImpl response_header;
+  Http::TestHeaderMapImpl response_trailer;
+
+  std::unordered_map<std::string, std::string> key_mapping = {{"plain", "plain_value"},
+                                                               {"escaped\"key", "%REQ(key)%"}};
+  JsonFormatterImpl formatter(key_mapping);
+
+  // The fields are in the order of their keys.
+  const std::string log_line =
+      formatter.format(request_header, response_header, response_trailer, stream_info);
+  EXPECT_EQ("{\"escaped\\\"key\":\"a\\\"b\\\\c\\td\\u0001e\",\"plain\":\"plain_value\"}\n",
+            log_line);
+  verifyJsonOutput(log_line, {{"escaped\"key", "a\"b\\c\td\x01" "e"}, {"plain", "plain_value"}});
+}
+
+// formatTo() appends to the output.
+TEST(AccessLogFormatterTest, FormatToAppends) {
+  StreamInfo::MockStreamInfo stream_info;
+  Http::TestHeaderMapImpl request_header{{":method", "GET"}};
+  Http::TestHeaderMapImpl response_header;
+  Http::TestHeaderMapImpl response_trailer;
+  absl::optional<Http::Protocol> protocol = Http::Protocol::Http11;
+  EXPECT_CALL(stream_info, protocol()).WillRepeatedly(Return(protocol));
+
+  FormatterImpl formatter("%REQ(:METHOD)% %PROTOCOL%|");
+  std::string output = "prefix|";
+  formatter.formatTo(request_header, response_header, response_trailer, stream_info, output);
+  formatter.formatTo(request_header, response_header, response_trailer, stream_info, output);
+  EXPECT_EQ("prefix|GET HTTP/1.1|GET HTTP/1.1|", output);
+
+  std::unordered_map<std::string, std::string> key_mapping = {{"method", "%REQ(:METHOD)%"}};
+  JsonFormatterImpl json_formatter(key_mapping);
+  output = "prefix|";
+  json_formatter.formatTo(request_header, response_header, response_trailer, stream_info, output);
+  EXPECT_EQ("prefix|{\"method\":\"GET\"}\n", output);
+}
+
 TEST(AccessLogFormatterTest, CompositeFormatterSuccess) {
   StreamInfo::MockStreamInfo stream_info;
   Http::TestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
@@ -1,4 +1,7 @@
+#include <atomic>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "common/access_log/access_log_manager_impl.h"
 #include "common/filesystem/file_shared_impl.h"
@@ -28,7 +31,7 @@ class AccessLogManagerImplTest : public testing::Test {
 protected:
   AccessLogManagerImplTest()
       : file_(new NiceMock<Filesystem::MockFile>), thread_factory_(Thread::threadFactoryForTest()),
-        access_log_manager_(timeout_40ms_, api_, dispatcher_, lock_, store_) {
+        access_log_manager_(timeout_40ms_, 0, api_, dispatcher_, lock_, store_) {
     EXPECT_CALL(file_system_, createFile("foo"))
         .WillOnce(Return(ByMove(std::unique_ptr<NiceMock<Filesystem::MockFile>>(file_))));
 
@@ -301,6 +304,78 @@ TEST_F(AccessLogManagerImplTest, bigDataChunkShouldBeFlushedWithoutTimer) {
   EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+TEST_F(AccessLogManagerImplTest, writesOverMaxBufferedBytesAreDropped) {
+  AccessLogManagerImpl access_log_manager(timeout_40ms_, 10, api_, dispatcher_, lock_, store_);
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+
+  EXPECT_CALL(*file_, open_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager.createAccessLog("foo");
+
+  std::string written;
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&written](absl::string_view data) -> Api::IoCallSizeResult {
+        written.append(data.data(), data.size());
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  log_file->write("hello");
+  log_file->write("world");
+  log_file->write("!");
+  EXPECT_EQ(2, store_.counter("access_log_file.write_buffered").value());
+  EXPECT_EQ(1, store_.counter("access_log_file.write_dropped").value());
+
+  log_file->flush();
+  EXPECT_EQ("helloworld", written);
+  EXPECT_EQ(0, store_.gauge("access_log_file.write_total_buffered").value());
+
+  // Flushing makes room for new writes.
+  log_file->write("again");
+  log_file->flush();
+  EXPECT_EQ("helloworldagain", written);
+  EXPECT_EQ(1, store_.counter("access_log_file.write_dropped").value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+TEST_F(AccessLogManagerImplTest, concurrentWritesAreAllFlushed) {
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+
+  EXPECT_CALL(*file_, open_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  std::atomic<uint64_t> written_bytes{};
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&written_bytes](absl::string_view data) -> Api::IoCallSizeResult {
+        written_bytes += data.size();
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  const uint32_t num_threads = 8;
+  const uint32_t writes_per_thread = 1000;
+  const std::string line(100, 'a');
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.push_back(thread_factory_.createThread([&log_file, &line]() -> void {
+      for (uint32_t j = 0; j < writes_per_thread; j++) {
+        log_file->write(line);
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+
+  // Some of the data may have been flushed by the flush thread already.
+  log_file->flush();
+  EXPECT_EQ(num_threads * writes_per_thread * line.size(), written_bytes);
+  EXPECT_EQ(num_threads * writes_per_thread,
+            store_.counter("access_log_file.write_buffered").value());
+  EXPECT_EQ(0, store_.counter("access_log_file.write_dropped").value());
+  EXPECT_EQ(0, store_.gauge("access_log_file.write_total_buffered").value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
 TEST_F(AccessLogManagerImplTest, reopenAllFiles) {
   EXPECT_CALL(dispatcher_, createTimer_(_)).WillRepeatedly(ReturnNew<NiceMock<Event::MockTimer>>());
 
@@ -317,6 +317,41 @@ static void BufferSearchPartialMatch(benchmark::State& state) {
 }
 BENCHMARK(BufferSearchPartialMatch)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
 
+// Test the allocation and release of slices when data passes through a short lived buffer, the
+// way a read buffer is filled and drained by the proxy. Slices of up to
+// Buffer::SlicePool::MaxPooledPages pages are recycled through the per-thread slice pool, larger
+// ones come from the heap.
+static void BufferSliceChurn(benchmark::State& state) {
+  const std::string data(state.range(0), 'a');
+  const absl::string_view input(data);
+  uint64_t length = 0;
+  for (auto _ : state) {
+    Buffer::OwnedImpl buffer;
+    buffer.add(input);
+    length += buffer.length();
+    buffer.drain(buffer.length());
+  }
+  benchmark::DoNotOptimize(length);
+}
+BENCHMARK(BufferSliceChurn)->Arg(1)->Arg(4096)->Arg(16000)->Arg(65536);
+
+// Variant of BufferSliceChurn that keeps a window of in-flight slices of mixed sizes, so that
+// several pool size classes stay in use at the same time.
+static void BufferSliceChurnMixedSizes(benchmark::State& state) {
+  const std::string data(3 * 4096, 'a');
+  const uint64_t sizes[] = {1, 5000, 9000, 3 * 4096};
+  Buffer::OwnedImpl buffer;
+  uint64_t i = 0;
+  for (auto _ : state) {
+    buffer.appendSliceForTest(data.data(), sizes[i++ % 4]);
+    if (buffer.length() >= state.range(0)) {
+      buffer.drain(buffer.length());
+    }
+  }
+  benchmark::DoNotOptimize(buffer.length());
+}
+BENCHMARK(BufferSliceChurnMixedSizes)->Arg(65536)->Arg(1024 * 1024);
+
 } // namespace Envoy
 
 // Boilerplate main(), which discovers benchmarks in the same file and runs them.
@@ -1,4 +1,6 @@
 #include <limits>
+#include <thread>
+#include <vector>
 
 #include "envoy/common/exception.h"
 
@@ -192,6 +194,92 @@ TEST_F(OwnedSliceTest, Drain) {
   EXPECT_EQ(original_size, slice->reservableSize());
 }
 
+TEST_F(OwnedSliceTest, SizeFillsPages) {
+  // The slice, its header and its data together occupy whole pages.
+  auto slice = OwnedSlice::create(1);
+  const uint64_t one_page_capacity = slice->reservableSize();
+  EXPECT_GT(SlicePool::PageSize, one_page_capacity);
+  slice = OwnedSlice::create(one_page_capacity);
+  EXPECT_EQ(one_page_capacity, slice->reservableSize());
+  slice = OwnedSlice::create(one_page_capacity + 1);
+  EXPECT_EQ(one_page_capacity + SlicePool::PageSize, slice->reservableSize());
+}
+
+TEST(SlicePoolTest, ReusesFreedBlocks) {
+  void* block = SlicePool::allocate(2 * SlicePool::PageSize);
+  SlicePool::deallocate(block, 2 * SlicePool::PageSize);
+  EXPECT_EQ(block, SlicePool::allocate(2 * SlicePool::PageSize));
+  SlicePool::deallocate(block, 2 * SlicePool::PageSize);
+
+  // Blocks of another size are not handed out for this size.
+  void* other_block = SlicePool::allocate(3 * SlicePool::PageSize);
+  EXPECT_NE(block, other_block);
+  SlicePool::deallocate(other_block, 3 * SlicePool::PageSize);
+}
+
+TEST(SlicePoolTest, OwnedSliceUsesPool) {
+  const void* data;
+  {
+    auto slice = OwnedSlice::create(100);
+    data = slice->data();
+  }
+  SlicePool::flushStatsForTest();
+  const uint64_t hits = SlicePool::hits();
+  auto slice = OwnedSlice::create(100);
+  EXPECT_EQ(data, slice->data());
+  SlicePool::flushStatsForTest();
+  EXPECT_EQ(hits + 1, SlicePool::hits());
+}
+
+TEST(SlicePoolTest, LargeSlicesNotPooled) {
+  SlicePool::flushStatsForTest();
+  const uint64_t hits = SlicePool::hits();
+  const uint64_t misses = SlicePool::misses();
+  for (int i = 0; i < 2; i++) {
+    auto slice = OwnedSlice::create(SlicePool::MaxPooledPages * SlicePool::PageSize);
+  }
+  SlicePool::flushStatsForTest();
+  EXPECT_EQ(hits, SlicePool::hits());
+  EXPECT_EQ(misses, SlicePool::misses());
+}
+
+TEST(SlicePoolTest, FreeListIsBounded) {
+  const uint64_t size = SlicePool::PageSize;
+  const uint64_t count = SlicePool::MaxFreeBlocksPerSize + 8;
+  std::vector<void*> blocks;
+  for (uint64_t i = 0; i < count; i++) {
+    blocks.push_back(SlicePool::allocate(size));
+  }
+  // Only MaxFreeBlocksPerSize of these are kept.
+  for (void* block : blocks) {
+    SlicePool::deallocate(block, size);
+  }
+  blocks.clear();
+
+  SlicePool::flushStatsForTest();
+  const uint64_t hits = SlicePool::hits();
+  const uint64_t misses = SlicePool::misses();
+  for (uint64_t i = 0; i < count; i++) {
+    blocks.push_back(SlicePool::allocate(size));
+  }
+  SlicePool::flushStatsForTest();
+  EXPECT_EQ(hits + SlicePool::MaxFreeBlocksPerSize, SlicePool::hits());
+  EXPECT_EQ(misses + 8, SlicePool::misses());
+  for (void* block : blocks) {
+    SlicePool::deallocate(block, size);
+  }
+}
+
+TEST(SlicePoolTest, CrossThreadRelease) {
+  auto slice = OwnedSlice::create(100);
+  std::thread thread([&slice]() {
+    // The block lands in this thread's pool and is released when the thread exits.
+    slice.reset();
+  });
+  thread.join();
+  EXPECT_EQ(nullptr, slice);
+}
+
 TEST(UnownedSliceTest, CreateDelete) {
   constexpr char input[] = "hello world";
   bool release_callback_called = false;
@@ -268,15 +356,9 @@ TEST(SliceDequeTest, CreateDelete) {
   EXPECT_TRUE(slice3_deleted);
 }
 
-class BufferHelperTest : public BufferImplementationParamTest {};
-
-INSTANTIATE_TEST_CASE_P(BufferHelperTest, BufferHelperTest,
-                        testing::ValuesIn({BufferImplementation::Old, BufferImplementation::New}));
-
-TEST_P(BufferHelperTest, PeekI8) {
+TEST(BufferHelperTest, PeekI8) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 0xFE});
     EXPECT_EQ(buffer.peekInt<int8_t>(), 0);
     EXPECT_EQ(buffer.peekInt<int8_t>(0), 0);
@@ -287,22 +369,19 @@ TEST_P(BufferHelperTest, PeekI8) {
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekInt<int8_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeByte(0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekInt<int8_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekLEI16) {
+TEST(BufferHelperTest, PeekLEI16) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekLEInt<int16_t>(), 0x0100);
     EXPECT_EQ(buffer.peekLEInt<int16_t>(0), 0x0100);
@@ -314,22 +393,19 @@ TEST_P(BufferHelperTest, PeekLEI16) {
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<int16_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 2, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<int16_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekLEI32) {
+TEST(BufferHelperTest, PeekLEI32) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekLEInt<int32_t>(), 0x03020100);
     EXPECT_EQ(buffer.peekLEInt<int32_t>(0), 0x03020100);
@@ -340,22 +416,19 @@ TEST_P(BufferHelperTest, PeekLEI32) {
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<int32_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 4, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<int32_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekLEI64) {
+TEST(BufferHelperTest, PeekLEI64) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekLEInt<int64_t>(), 0x0706050403020100);
     EXPECT_EQ(buffer.peekLEInt<int64_t>(0), 0x0706050403020100);
@@ -375,7 +448,6 @@ TEST_P(BufferHelperTest, PeekLEI64) {
   {
     // signed
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFE, 0xFF, 0xFF});
     EXPECT_EQ((buffer.peekLEInt<int64_t, 2>()), -1);
     EXPECT_EQ((buffer.peekLEInt<int64_t, 2>(2)), 255);  // 0x00FF
@@ -385,7 +457,6 @@ TEST_P(BufferHelperTest, PeekLEI64) {
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 0xFF});
     EXPECT_THROW_WITH_MESSAGE(
         (buffer.peekLEInt<int64_t, sizeof(int64_t)>(buffer.length() - sizeof(int64_t) + 1)),
@@ -394,22 +465,19 @@ TEST_P(BufferHelperTest, PeekLEI64) {
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<int64_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 8, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<int64_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekLEU16) {
+TEST(BufferHelperTest, PeekLEU16) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekLEInt<uint16_t>(), 0x0100);
     EXPECT_EQ(buffer.peekLEInt<uint16_t>(0), 0x0100);
@@ -420,22 +488,19 @@ TEST_P(BufferHelperTest, PeekLEU16) {
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<uint16_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 2, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<uint16_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekLEU32) {
+TEST(BufferHelperTest, PeekLEU32) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekLEInt<uint32_t>(), 0x03020100);
     EXPECT_EQ(buffer.peekLEInt<uint32_t>(0), 0x03020100);
@@ -446,22 +511,19 @@ TEST_P(BufferHelperTest, PeekLEU32) {
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<uint32_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 4, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<uint32_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekLEU64) {
+TEST(BufferHelperTest, PeekLEU64) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekLEInt<uint64_t>(), 0x0706050403020100);
     EXPECT_EQ(buffer.peekLEInt<uint64_t>(0), 0x0706050403020100);
@@ -472,22 +534,19 @@ TEST_P(BufferHelperTest, PeekLEU64) {
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<uint64_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 8, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekLEInt<uint64_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekBEI16) {
+TEST(BufferHelperTest, PeekBEI16) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekBEInt<int16_t>(), 1);
     EXPECT_EQ(buffer.peekBEInt<int16_t>(0), 1);
@@ -499,22 +558,19 @@ TEST_P(BufferHelperTest, PeekBEI16) {
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<int16_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 2, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<int16_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekBEI32) {
+TEST(BufferHelperTest, PeekBEI32) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekBEInt<int32_t>(), 0x00010203);
     EXPECT_EQ(buffer.peekBEInt<int32_t>(0), 0x00010203);
@@ -525,22 +581,19 @@ TEST_P(BufferHelperTest, PeekBEI32) {
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<int32_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 4, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<int32_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekBEI64) {
+TEST(BufferHelperTest, PeekBEI64) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekBEInt<int64_t>(), 0x0001020304050607);
     EXPECT_EQ(buffer.peekBEInt<int64_t>(0), 0x0001020304050607);
@@ -559,7 +612,6 @@ TEST_P(BufferHelperTest, PeekBEI64) {
   {
     // signed
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0xFE});
     EXPECT_EQ((buffer.peekBEInt<int64_t, 2>()), -1);
     EXPECT_EQ((buffer.peekBEInt<int64_t, 2>(2)), -256); // 0xFF00
@@ -569,7 +621,6 @@ TEST_P(BufferHelperTest, PeekBEI64) {
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 0xFF});
     EXPECT_THROW_WITH_MESSAGE(
         (buffer.peekBEInt<int64_t, sizeof(int64_t)>(buffer.length() - sizeof(int64_t) + 1)),
@@ -578,22 +629,19 @@ TEST_P(BufferHelperTest, PeekBEI64) {
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<int64_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 8, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<int64_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekBEU16) {
+TEST(BufferHelperTest, PeekBEU16) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekBEInt<uint16_t>(), 1);
     EXPECT_EQ(buffer.peekBEInt<uint16_t>(0), 1);
@@ -604,22 +652,19 @@ TEST_P(BufferHelperTest, PeekBEU16) {
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<uint16_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 2, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<uint16_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekBEU32) {
+TEST(BufferHelperTest, PeekBEU32) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekBEInt<uint32_t>(), 0x00010203);
     EXPECT_EQ(buffer.peekBEInt<uint32_t>(0), 0x00010203);
@@ -630,22 +675,19 @@ TEST_P(BufferHelperTest, PeekBEU32) {
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<uint32_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 4, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<uint32_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, PeekBEU64) {
+TEST(BufferHelperTest, PeekBEU64) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addSeq(buffer, {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
     EXPECT_EQ(buffer.peekBEInt<uint64_t>(), 0x0001020304050607);
     EXPECT_EQ(buffer.peekBEInt<uint64_t>(0), 0x0001020304050607);
@@ -656,21 +698,18 @@ TEST_P(BufferHelperTest, PeekBEU64) {
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<uint64_t>(0), EnvoyException, "buffer underflow");
   }
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     addRepeated(buffer, 8, 0);
     EXPECT_THROW_WITH_MESSAGE(buffer.peekBEInt<uint64_t>(1), EnvoyException, "buffer underflow");
   }
 }
 
-TEST_P(BufferHelperTest, DrainI8) {
+TEST(BufferHelperTest, DrainI8) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 0xFE});
   EXPECT_EQ(buffer.drainInt<int8_t>(), 0);
   EXPECT_EQ(buffer.drainInt<int8_t>(), 1);
@@ -678,9 +717,8 @@ TEST_P(BufferHelperTest, DrainI8) {
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, DrainLEI16) {
+TEST(BufferHelperTest, DrainLEI16) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF});
   EXPECT_EQ(buffer.drainLEInt<int16_t>(), 0x0100);
   EXPECT_EQ(buffer.drainLEInt<int16_t>(), 0x0302);
@@ -688,45 +726,40 @@ TEST_P(BufferHelperTest, DrainLEI16) {
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, DrainLEI32) {
+TEST(BufferHelperTest, DrainLEI32) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF, 0xFF, 0xFF});
   EXPECT_EQ(buffer.drainLEInt<int32_t>(), 0x03020100);
   EXPECT_EQ(buffer.drainLEInt<int32_t>(), -1);
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, DrainLEI64) {
+TEST(BufferHelperTest, DrainLEI64) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
   EXPECT_EQ(buffer.drainLEInt<int64_t>(), 0x0706050403020100);
   EXPECT_EQ(buffer.drainLEInt<int64_t>(), -1);
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, DrainLEU32) {
+TEST(BufferHelperTest, DrainLEU32) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF, 0xFF, 0xFF});
   EXPECT_EQ(buffer.drainLEInt<uint32_t>(), 0x03020100);
   EXPECT_EQ(buffer.drainLEInt<uint32_t>(), 0xFFFFFFFF);
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, DrainLEU64) {
+TEST(BufferHelperTest, DrainLEU64) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
   EXPECT_EQ(buffer.drainLEInt<uint64_t>(), 0x0706050403020100);
   EXPECT_EQ(buffer.drainLEInt<uint64_t>(), 0xFFFFFFFFFFFFFFFF);
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, DrainBEI16) {
+TEST(BufferHelperTest, DrainBEI16) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF});
   EXPECT_EQ(buffer.drainBEInt<int16_t>(), 1);
   EXPECT_EQ(buffer.drainBEInt<int16_t>(), 0x0203);
@@ -734,45 +767,40 @@ TEST_P(BufferHelperTest, DrainBEI16) {
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, DrainBEI32) {
+TEST(BufferHelperTest, DrainBEI32) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF, 0xFF, 0xFF});
   EXPECT_EQ(buffer.drainBEInt<int32_t>(), 0x00010203);
   EXPECT_EQ(buffer.drainBEInt<int32_t>(), -1);
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, DrainBEI64) {
+TEST(BufferHelperTest, DrainBEI64) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
   EXPECT_EQ(buffer.drainBEInt<int64_t>(), 0x0001020304050607);
   EXPECT_EQ(buffer.drainBEInt<int64_t>(), -1);
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, DrainBEU32) {
+TEST(BufferHelperTest, DrainBEU32) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 2, 3, 0xFF, 0xFF, 0xFF, 0xFF});
   EXPECT_EQ(buffer.drainBEInt<uint32_t>(), 0x00010203);
   EXPECT_EQ(buffer.drainBEInt<uint32_t>(), 0xFFFFFFFF);
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, DrainBEU64) {
+TEST(BufferHelperTest, DrainBEU64) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   addSeq(buffer, {0, 1, 2, 3, 4, 5, 6, 7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
   EXPECT_EQ(buffer.drainBEInt<uint64_t>(), 0x0001020304050607);
   EXPECT_EQ(buffer.drainBEInt<uint64_t>(), 0xFFFFFFFFFFFFFFFF);
   EXPECT_EQ(buffer.length(), 0);
 }
 
-TEST_P(BufferHelperTest, WriteI8) {
+TEST(BufferHelperTest, WriteI8) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   buffer.writeByte(-128);
   buffer.writeByte(-1);
   buffer.writeByte(0);
@@ -782,269 +810,229 @@ TEST_P(BufferHelperTest, WriteI8) {
   EXPECT_EQ(std::string("\x80\xFF\0\x1\x7F", 5), buffer.toString());
 }
 
-TEST_P(BufferHelperTest, WriteLEI16) {
+TEST(BufferHelperTest, WriteLEI16) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int16_t>(std::numeric_limits<int16_t>::min());
     EXPECT_EQ(std::string("\0\x80", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int16_t>(0);
     EXPECT_EQ(std::string("\0\0", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int16_t>(1);
     EXPECT_EQ(std::string("\x1\0", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int16_t>(std::numeric_limits<int16_t>::max());
     EXPECT_EQ("\xFF\x7F", buffer.toString());
   }
 }
 
-TEST_P(BufferHelperTest, WriteLEU16) {
+TEST(BufferHelperTest, WriteLEU16) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<uint16_t>(0);
     EXPECT_EQ(std::string("\0\0", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<uint16_t>(1);
     EXPECT_EQ(std::string("\x1\0", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<uint16_t>(static_cast<uint16_t>(std::numeric_limits<int16_t>::max()) + 1);
     EXPECT_EQ(std::string("\0\x80", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<uint16_t>(std::numeric_limits<uint16_t>::max());
     EXPECT_EQ("\xFF\xFF", buffer.toString());
   }
 }
 
-TEST_P(BufferHelperTest, WriteLEI32) {
+TEST(BufferHelperTest, WriteLEI32) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int32_t>(std::numeric_limits<int32_t>::min());
     EXPECT_EQ(std::string("\0\0\0\x80", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int32_t>(0);
     EXPECT_EQ(std::string("\0\0\0\0", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int32_t>(1);
     EXPECT_EQ(std::string("\x1\0\0\0", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int32_t>(std::numeric_limits<int32_t>::max());
     EXPECT_EQ("\xFF\xFF\xFF\x7F", buffer.toString());
   }
 }
 
-TEST_P(BufferHelperTest, WriteLEU32) {
+TEST(BufferHelperTest, WriteLEU32) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<uint32_t>(0);
     EXPECT_EQ(std::string("\0\0\0\0", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<uint32_t>(1);
     EXPECT_EQ(std::string("\x1\0\0\0", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<uint32_t>(static_cast<uint32_t>(std::numeric_limits<int32_t>::max()) + 1);
     EXPECT_EQ(std::string("\0\0\0\x80", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<uint32_t>(std::numeric_limits<uint32_t>::max());
     EXPECT_EQ("\xFF\xFF\xFF\xFF", buffer.toString());
   }
 }
-TEST_P(BufferHelperTest, WriteLEI64) {
+TEST(BufferHelperTest, WriteLEI64) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int64_t>(std::numeric_limits<int64_t>::min());
     EXPECT_EQ(std::string("\0\0\0\0\0\0\0\x80", 8), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int64_t>(1);
     EXPECT_EQ(std::string("\x1\0\0\0\0\0\0\0", 8), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int64_t>(0);
     EXPECT_EQ(std::string("\0\0\0\0\0\0\0\0", 8), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeLEInt<int64_t>(std::numeric_limits<int64_t>::max());
     EXPECT_EQ("\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x7F", buffer.toString());
   }
 }
 
-TEST_P(BufferHelperTest, WriteBEI16) {
+TEST(BufferHelperTest, WriteBEI16) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int16_t>(std::numeric_limits<int16_t>::min());
     EXPECT_EQ(std::string("\x80\0", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int16_t>(0);
     EXPECT_EQ(std::string("\0\0", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int16_t>(1);
     EXPECT_EQ(std::string("\0\x1", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int16_t>(std::numeric_limits<int16_t>::max());
     EXPECT_EQ("\x7F\xFF", buffer.toString());
   }
 }
 
-TEST_P(BufferHelperTest, WriteBEU16) {
+TEST(BufferHelperTest, WriteBEU16) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<uint16_t>(0);
     EXPECT_EQ(std::string("\0\0", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<uint16_t>(1);
     EXPECT_EQ(std::string("\0\x1", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<uint16_t>(static_cast<uint16_t>(std::numeric_limits<int16_t>::max()) + 1);
     EXPECT_EQ(std::string("\x80\0", 2), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<uint16_t>(std::numeric_limits<uint16_t>::max());
     EXPECT_EQ("\xFF\xFF", buffer.toString());
   }
 }
 
-TEST_P(BufferHelperTest, WriteBEI32) {
+TEST(BufferHelperTest, WriteBEI32) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int32_t>(std::numeric_limits<int32_t>::min());
     EXPECT_EQ(std::string("\x80\0\0\0", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int32_t>(0);
     EXPECT_EQ(std::string("\0\0\0\0", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int32_t>(1);
     EXPECT_EQ(std::string("\0\0\0\x1", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int32_t>(std::numeric_limits<int32_t>::max());
     EXPECT_EQ("\x7F\xFF\xFF\xFF", buffer.toString());
   }
 }
 
-TEST_P(BufferHelperTest, WriteBEU32) {
+TEST(BufferHelperTest, WriteBEU32) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<uint32_t>(0);
     EXPECT_EQ(std::string("\0\0\0\0", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<uint32_t>(1);
     EXPECT_EQ(std::string("\0\0\0\x1", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<uint32_t>(static_cast<uint32_t>(std::numeric_limits<int32_t>::max()) + 1);
     EXPECT_EQ(std::string("\x80\0\0\0", 4), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<uint32_t>(std::numeric_limits<uint32_t>::max());
     EXPECT_EQ("\xFF\xFF\xFF\xFF", buffer.toString());
   }
 }
-TEST_P(BufferHelperTest, WriteBEI64) {
+TEST(BufferHelperTest, WriteBEI64) {
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int64_t>(std::numeric_limits<int64_t>::min());
     EXPECT_EQ(std::string("\x80\0\0\0\0\0\0\0\0", 8), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int64_t>(1);
     EXPECT_EQ(std::string("\0\0\0\0\0\0\0\x1", 8), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int64_t>(0);
     EXPECT_EQ(std::string("\0\0\0\0\0\0\0\0", 8), buffer.toString());
   }
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
     buffer.writeBEInt<int64_t>(std::numeric_limits<int64_t>::max());
     EXPECT_EQ("\x7F\xFF\xFF\xFF\xFF\xFF\xFF\xFF", buffer.toString());
   }
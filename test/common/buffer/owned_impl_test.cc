@@ -19,7 +19,7 @@ namespace Envoy {
 namespace Buffer {
 namespace {
 
-class OwnedImplTest : public BufferImplementationParamTest {
+class OwnedImplTest : public testing::Test {
 public:
   bool release_callback_called_ = false;
 
@@ -36,14 +36,10 @@ protected:
   }
 };
 
-INSTANTIATE_TEST_CASE_P(OwnedImplTest, OwnedImplTest,
-                        testing::ValuesIn({BufferImplementation::Old, BufferImplementation::New}));
-
-TEST_P(OwnedImplTest, AddBufferFragmentNoCleanup) {
+TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, nullptr);
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   buffer.addBufferFragment(frag);
   EXPECT_EQ(11, buffer.length());
 
@@ -51,13 +47,12 @@ TEST_P(OwnedImplTest, AddBufferFragmentNoCleanup) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_P(OwnedImplTest, AddBufferFragmentWithCleanup) {
+TEST_F(OwnedImplTest, AddBufferFragmentWithCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, [this](const void*, size_t, const BufferFragmentImpl*) {
     release_callback_called_ = true;
   });
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   buffer.addBufferFragment(frag);
   EXPECT_EQ(11, buffer.length());
 
@@ -70,7 +65,7 @@ TEST_P(OwnedImplTest, AddBufferFragmentWithCleanup) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_P(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
+TEST_F(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   char input_stack[] = "hello world";
   char* input = new char[11];
   std::copy(input_stack, input_stack + 11, input);
@@ -83,7 +78,6 @@ TEST_P(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
       });
 
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   buffer.addBufferFragment(*frag);
   EXPECT_EQ(11, buffer.length());
 
@@ -96,10 +90,9 @@ TEST_P(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_P(OwnedImplTest, Add) {
+TEST_F(OwnedImplTest, Add) {
   const std::string string1 = "Hello, ", string2 = "World!";
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
 
   buffer.add(string1);
   EXPECT_EQ(string1.size(), buffer.length());
@@ -122,10 +115,9 @@ TEST_P(OwnedImplTest, Add) {
   EXPECT_EQ(string1 + string2 + big_suffix, buffer.toString());
 }
 
-TEST_P(OwnedImplTest, Prepend) {
+TEST_F(OwnedImplTest, Prepend) {
   const std::string suffix = "World!", prefix = "Hello, ";
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   buffer.add(suffix);
   buffer.prepend(prefix);
 
@@ -145,10 +137,9 @@ TEST_P(OwnedImplTest, Prepend) {
   EXPECT_EQ(big_prefix + prefix + suffix, buffer.toString());
 }
 
-TEST_P(OwnedImplTest, PrependToEmptyBuffer) {
+TEST_F(OwnedImplTest, PrependToEmptyBuffer) {
   std::string data = "Hello, World!";
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   buffer.prepend(data);
 
   EXPECT_EQ(data.size(), buffer.length());
@@ -160,13 +151,11 @@ TEST_P(OwnedImplTest, PrependToEmptyBuffer) {
   EXPECT_EQ(data, buffer.toString());
 }
 
-TEST_P(OwnedImplTest, PrependBuffer) {
+TEST_F(OwnedImplTest, PrependBuffer) {
   std::string suffix = "World!", prefix = "Hello, ";
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   buffer.add(suffix);
   Buffer::OwnedImpl prefixBuffer;
-  verifyImplementation(buffer);
   prefixBuffer.add(prefix);
 
   buffer.prepend(prefixBuffer);
@@ -176,12 +165,11 @@ TEST_P(OwnedImplTest, PrependBuffer) {
   EXPECT_EQ(0, prefixBuffer.length());
 }
 
-TEST_P(OwnedImplTest, Write) {
+TEST_F(OwnedImplTest, Write) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   Network::IoSocketHandleImpl io_handle;
   buffer.add("example");
   EXPECT_CALL(os_sys_calls, writev(_, _, _)).WillOnce(Return(Api::SysCallSizeResult{7, 0}));
@@ -227,12 +215,33 @@ TEST_P(OwnedImplTest, Write) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_P(OwnedImplTest, Read) {
+TEST_F(OwnedImplTest, WriteManySlices) {
+  Api::MockOsSysCalls os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  Buffer::OwnedImpl buffer;
+  Network::IoSocketHandleImpl io_handle;
+  for (uint64_t i = 0; i < OwnedImpl::MaxWriteSlices + 10; i++) {
+    buffer.appendSliceForTest("a");
+  }
+  // A single writev() takes as many slices as allowed.
+  EXPECT_CALL(os_sys_calls, writev(_, _, static_cast<int>(OwnedImpl::MaxWriteSlices)))
+      .WillOnce(Return(Api::SysCallSizeResult{static_cast<ssize_t>(OwnedImpl::MaxWriteSlices), 0}));
+  Api::IoCallUint64Result result = buffer.write(io_handle);
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(10, buffer.length());
+
+  EXPECT_CALL(os_sys_calls, writev(_, _, 10)).WillOnce(Return(Api::SysCallSizeResult{10, 0}));
+  result = buffer.write(io_handle);
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(0, buffer.length());
+}
+
+TEST_F(OwnedImplTest, Read) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   Network::IoSocketHandleImpl io_handle;
   EXPECT_CALL(os_sys_calls, readv(_, _, _)).WillOnce(Return(Api::SysCallSizeResult{0, 0}));
   Api::IoCallUint64Result result = buffer.read(io_handle, 100);
@@ -258,7 +267,7 @@ TEST_P(OwnedImplTest, Read) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_P(OwnedImplTest, ReserveCommit) {
+TEST_F(OwnedImplTest, ReserveCommit) {
   // This fragment will later be added to the buffer. It is declared in an enclosing scope to
   // ensure it is not destructed until after the buffer is.
   const std::string input = "Hello, world";
@@ -266,7 +275,8 @@ TEST_P(OwnedImplTest, ReserveCommit) {
 
   {
     Buffer::OwnedImpl buffer;
-    verifyImplementation(buffer);
+    // The capacity of a slice that occupies a single page.
+    const uint64_t page_capacity = OwnedSlice::create(1)->reservableSize();
 
     // A zero-byte reservation should fail.
     static constexpr uint64_t NumIovecs = 16;
@@ -285,12 +295,6 @@ TEST_P(OwnedImplTest, ReserveCommit) {
     commitReservation(iovecs, num_reserved, buffer);
     EXPECT_EQ(1, buffer.length());
 
-    // The remaining tests validate internal optimizations of the new deque-of-slices
-    // implementation, so they're not valid for the old evbuffer implementation.
-    if (buffer.usesOldImpl()) {
-      return;
-    }
-
     // Request a reservation that fits in the remaining space at the end of the last slice.
     num_reserved = buffer.reserve(1, iovecs, NumIovecs);
     EXPECT_EQ(1, num_reserved);
@@ -302,7 +306,7 @@ TEST_P(OwnedImplTest, ReserveCommit) {
     // Request a reservation that is too large to fit in the remaining space at the end of
     // the last slice, and allow the buffer to use only one slice. This should result in the
     // creation of a new slice within the buffer.
-    num_reserved = buffer.reserve(4096 - sizeof(OwnedSlice), iovecs, 1);
+    num_reserved = buffer.reserve(page_capacity, iovecs, 1);
     const void* slice2 = iovecs[0].mem_;
     EXPECT_EQ(1, num_reserved);
     EXPECT_NE(slice1, slice2);
@@ -310,7 +314,7 @@ TEST_P(OwnedImplTest, ReserveCommit) {
 
     // Request the same size reservation, but allow the buffer to use multiple slices. This
     // should result in the buffer splitting the reservation between its last two slices.
-    num_reserved = buffer.reserve(4096 - sizeof(OwnedSlice), iovecs, NumIovecs);
+    num_reserved = buffer.reserve(page_capacity, iovecs, NumIovecs);
     EXPECT_EQ(2, num_reserved);
     EXPECT_EQ(slice1, iovecs[0].mem_);
     EXPECT_EQ(slice2, iovecs[1].mem_);
@@ -340,12 +344,11 @@ TEST_P(OwnedImplTest, ReserveCommit) {
   }
 }
 
-TEST_P(OwnedImplTest, Search) {
+TEST_F(OwnedImplTest, Search) {
   // Populate a buffer with a string split across many small slices, to
   // exercise edge cases in the search implementation.
   static const char* Inputs[] = {"ab", "a", "", "aaa", "b", "a", "aaa", "ab", "a"};
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   for (const auto& input : Inputs) {
     buffer.appendSliceForTest(input);
   }
@@ -368,9 +371,8 @@ TEST_P(OwnedImplTest, Search) {
   EXPECT_EQ(-1, buffer.search("abaaaabaaaaabaa", 15, 0));
 }
 
-TEST_P(OwnedImplTest, ToString) {
+TEST_F(OwnedImplTest, ToString) {
   Buffer::OwnedImpl buffer;
-  verifyImplementation(buffer);
   EXPECT_EQ("", buffer.toString());
   auto append = [&buffer](absl::string_view str) { buffer.add(str.data(), str.size()); };
   append("Hello, ");
@@ -384,7 +386,7 @@ TEST_P(OwnedImplTest, ToString) {
   EXPECT_EQ(absl::StrCat("Hello, world!" + long_string), buffer.toString());
 }
 
-TEST_P(OwnedImplTest, AppendSliceForTest) {
+TEST_F(OwnedImplTest, AppendSliceForTest) {
   static constexpr size_t NumInputs = 3;
   static constexpr const char* Inputs[] = {"one", "2", "", "four", ""};
   Buffer::OwnedImpl buffer;
@@ -410,7 +412,7 @@ TEST_P(OwnedImplTest, AppendSliceForTest) {
 // Regression test for oss-fuzz issue
 // https://bugs.chromium.org/p/oss-fuzz/issues/detail?id=13263, where prepending
 // an empty buffer resulted in a corrupted libevent internal state.
-TEST_P(OwnedImplTest, PrependEmpty) {
+TEST_F(OwnedImplTest, PrependEmpty) {
   Buffer::OwnedImpl buf;
   Buffer::OwnedImpl other_buf;
   char input[] = "foo";
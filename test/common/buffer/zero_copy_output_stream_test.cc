@@ -0,0 +1,71 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/zero_copy_output_stream_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+class ZeroCopyOutputStreamTest : public testing::Test {
+public:
+  OwnedImpl buffer_;
+  ZeroCopyOutputStreamImpl stream_{buffer_, 16};
+
+  void* data_;
+  int size_;
+};
+
+TEST_F(ZeroCopyOutputStreamTest, Next) {
+  EXPECT_TRUE(stream_.Next(&data_, &size_));
+  EXPECT_EQ(16, size_);
+  EXPECT_EQ(16, stream_.ByteCount());
+  memset(data_, 'a', size_);
+  // Nothing is committed until the next slice is requested.
+  EXPECT_EQ(0, buffer_.length());
+
+  EXPECT_TRUE(stream_.Next(&data_, &size_));
+  EXPECT_EQ(16, size_);
+  EXPECT_EQ(32, stream_.ByteCount());
+  EXPECT_EQ(std::string(16, 'a'), buffer_.toString());
+  memset(data_, 'b', size_);
+
+  stream_.finish();
+  EXPECT_EQ(std::string(16, 'a') + std::string(16, 'b'), buffer_.toString());
+}
+
+TEST_F(ZeroCopyOutputStreamTest, BackUp) {
+  EXPECT_TRUE(stream_.Next(&data_, &size_));
+  memcpy(data_, "abcd", 4);
+  stream_.BackUp(size_ - 4);
+  EXPECT_EQ(4, stream_.ByteCount());
+
+  stream_.finish();
+  EXPECT_EQ("abcd", buffer_.toString());
+}
+
+TEST_F(ZeroCopyOutputStreamTest, AppendsToExistingContent) {
+  buffer_.add("abcd");
+  EXPECT_TRUE(stream_.Next(&data_, &size_));
+  memcpy(data_, "efgh", 4);
+  stream_.BackUp(size_ - 4);
+
+  stream_.finish();
+  EXPECT_EQ("abcdefgh", buffer_.toString());
+  EXPECT_EQ(4, stream_.ByteCount());
+}
+
+TEST(ZeroCopyOutputStreamImplTest, CommitsOnDestruction) {
+  OwnedImpl buffer;
+  {
+    ZeroCopyOutputStreamImpl stream(buffer);
+    Protobuf::io::CodedOutputStream codec_stream(&stream);
+    codec_stream.WriteString(std::string(100000, 'a'));
+  }
+  EXPECT_EQ(std::string(100000, 'a'), buffer.toString());
+  EXPECT_LT(1, buffer.getRawSlices(nullptr, 0));
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
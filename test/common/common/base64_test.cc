@@ -112,6 +112,57 @@ TEST(Base64Test, BinaryBufferEncode) {
   EXPECT_EQ("AAECAwgKCQCqvN4=", Base64::encode(buffer, 30));
 }
 
+// Buffers are encoded and decoded across their slices, the long runs included.
+TEST(Base64Test, EncodeDecodeBuffer) {
+  std::string data;
+  for (uint32_t i = 0; i < 1000; i++) {
+    data.push_back(static_cast<char>(i * 131 + 7));
+  }
+  for (const uint64_t slice_size : {1, 2, 3, 5, 16, 17, 100, 1000}) {
+    Buffer::OwnedImpl input;
+    for (uint64_t i = 0; i < data.size(); i += slice_size) {
+      input.appendSliceForTest(data.substr(i, slice_size));
+    }
+    Buffer::OwnedImpl encoded("prefix");
+    Base64::encode(input, encoded);
+    EXPECT_EQ(0U, input.length());
+    EXPECT_EQ("prefix" + Base64::encode(data.data(), data.size()), encoded.toString());
+
+    encoded.drain(6);
+    const std::string text = encoded.toString();
+    encoded.drain(encoded.length());
+    for (uint64_t i = 0; i < text.size(); i += slice_size) {
+      encoded.appendSliceForTest(text.substr(i, slice_size));
+    }
+    // A trailing partial quad is left to decode with the following data.
+    encoded.add("Zm");
+    Buffer::OwnedImpl decoded;
+    EXPECT_TRUE(Base64::decode(encoded, decoded));
+    EXPECT_EQ(data, decoded.toString());
+    EXPECT_EQ("Zm", encoded.toString());
+  }
+}
+
+// Buffers decode the padded quads of concatenated base64 strings, and fail on invalid characters
+// without being changed.
+TEST(Base64Test, DecodeBufferPadding) {
+  {
+    Buffer::OwnedImpl input("Zg==Zm8=Zm9v");
+    Buffer::OwnedImpl output;
+    EXPECT_TRUE(Base64::decode(input, output));
+    EXPECT_EQ("ffofoo", output.toString());
+  }
+
+  for (const std::string invalid :
+       {"Zg=A", "Zh==", "Zm9=", "A===", "Zm9v.m9v", "Zm9vZm9vZm9vZm9vZm9vZm9vZm9.Zm9v"}) {
+    Buffer::OwnedImpl input(invalid);
+    Buffer::OwnedImpl output("output");
+    EXPECT_FALSE(Base64::decode(input, output)) << invalid;
+    EXPECT_EQ(invalid, input.toString());
+    EXPECT_EQ("output", output.toString());
+  }
+}
+
 TEST(Base64UrlTest, EncodeString) {
   EXPECT_EQ("", Base64Url::encode("", 0));
   EXPECT_EQ("AAA", Base64Url::encode("\0\0", 2));
@@ -289,6 +289,29 @@ TEST(LowerCaseStringMatcher, MatchRegexValue) {
   EXPECT_FALSE(Envoy::Matchers::LowerCaseStringMatcher(matcher).match("Foo.Bar"));
 }
 
+TEST(LowerCaseStringMatcher, MatchSafeRegexValue) {
+  envoy::type::matcher::StringMatcher matcher;
+  matcher.mutable_safe_regex()->mutable_google_re2();
+  matcher.mutable_safe_regex()->set_regex("Foo.*");
+
+  EXPECT_TRUE(Envoy::Matchers::LowerCaseStringMatcher(matcher).match("foo.bar"));
+  EXPECT_FALSE(Envoy::Matchers::LowerCaseStringMatcher(matcher).match("Foo.Bar"));
+}
+
+TEST(StringMatcher, SafeRegexValue) {
+  envoy::type::matcher::StringMatcher matcher;
+  matcher.mutable_safe_regex()->mutable_google_re2();
+  matcher.mutable_safe_regex()->set_regex("foo.*");
+  EXPECT_TRUE(Envoy::Matchers::StringMatcher(matcher).match("foo"));
+  EXPECT_TRUE(Envoy::Matchers::StringMatcher(matcher).match("foobar"));
+  EXPECT_FALSE(Envoy::Matchers::StringMatcher(matcher).match("bar"));
+
+  // Copies share the compiled regex.
+  const Envoy::Matchers::StringMatcher original(matcher);
+  const Envoy::Matchers::StringMatcher copy = original;
+  EXPECT_TRUE(copy.match("foobar"));
+}
+
 } // namespace
 } // namespace Matcher
 } // namespace Envoy
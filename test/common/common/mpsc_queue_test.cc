@@ -0,0 +1,81 @@
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "common/common/mpsc_queue.h"
+#include "common/common/thread.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+struct TestNode : public MpscQueue::Node {
+  TestNode(uint32_t producer, uint32_t value) : producer_(producer), value_(value) {}
+
+  const uint32_t producer_;
+  const uint32_t value_;
+};
+
+TEST(MpscQueueTest, Fifo) {
+  MpscQueue queue;
+  EXPECT_EQ(nullptr, queue.pop());
+
+  // Nodes can't be moved, so they are kept in deques.
+  std::deque<TestNode> nodes;
+  for (uint32_t i = 0; i < 3; i++) {
+    nodes.emplace_back(0, i);
+  }
+  queue.push(nodes[0]);
+  queue.push(nodes[1]);
+  EXPECT_EQ(&nodes[0], queue.pop());
+  queue.push(nodes[2]);
+  EXPECT_EQ(&nodes[1], queue.pop());
+  EXPECT_EQ(&nodes[2], queue.pop());
+  EXPECT_EQ(nullptr, queue.pop());
+
+  // Popped nodes can be pushed again.
+  queue.push(nodes[0]);
+  EXPECT_EQ(&nodes[0], queue.pop());
+  EXPECT_EQ(nullptr, queue.pop());
+}
+
+// The nodes of each producer are popped in the order they were pushed, and none is lost.
+TEST(MpscQueueTest, ConcurrentProducers) {
+  constexpr uint32_t Producers = 4;
+  constexpr uint32_t NodesPerProducer = 10000;
+  MpscQueue queue;
+  std::vector<std::deque<TestNode>> nodes(Producers);
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < Producers; i++) {
+    for (uint32_t j = 0; j < NodesPerProducer; j++) {
+      nodes[i].emplace_back(i, j);
+    }
+    threads.emplace_back(Thread::threadFactoryForTest().createThread([&queue, &nodes, i]() -> void {
+      for (TestNode& node : nodes[i]) {
+        queue.push(node);
+      }
+    }));
+  }
+
+  std::vector<uint32_t> next(Producers, 0);
+  uint32_t popped = 0;
+  while (popped < Producers * NodesPerProducer) {
+    const TestNode* node = static_cast<const TestNode*>(queue.pop());
+    if (node == nullptr) {
+      continue;
+    }
+    EXPECT_EQ(next[node->producer_]++, node->value_);
+    popped++;
+  }
+  EXPECT_EQ(nullptr, queue.pop());
+
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+}
+
+} // namespace
+} // namespace Envoy
@@ -0,0 +1,103 @@
+#include <cstdint>
+#include <memory>
+
+#include "common/common/object_pool.h"
+#include "common/common/thread.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+struct Base : public PooledObject {
+  virtual ~Base() {}
+
+  uint64_t value_{};
+};
+
+struct Derived : public Base {
+  uint8_t padding_[200];
+};
+
+class ObjectPoolTest : public testing::Test {
+public:
+  ObjectPoolTest() {
+    ObjectPool::flushStatsForTest();
+    hits_ = ObjectPool::hits();
+    misses_ = ObjectPool::misses();
+  }
+
+  uint64_t hits() {
+    ObjectPool::flushStatsForTest();
+    return ObjectPool::hits() - hits_;
+  }
+
+  uint64_t misses() {
+    ObjectPool::flushStatsForTest();
+    return ObjectPool::misses() - misses_;
+  }
+
+  uint64_t hits_;
+  uint64_t misses_;
+};
+
+// A freed block is reused by the next allocation of its size class.
+TEST_F(ObjectPoolTest, Reuse) {
+  void* block = ObjectPool::allocate(100);
+  ObjectPool::deallocate(block, 100);
+  // 100 and 120 bytes round up to the same size class.
+  void* reused = ObjectPool::allocate(120);
+  EXPECT_EQ(block, reused);
+  ObjectPool::deallocate(reused, 120);
+  EXPECT_GE(hits(), 1);
+}
+
+// Objects deleted through a base class are returned to the free list of their dynamic type's size.
+TEST_F(ObjectPoolTest, PooledObject) {
+  std::unique_ptr<Base> derived = std::make_unique<Derived>();
+  Derived* object = static_cast<Derived*>(derived.get());
+  derived.reset();
+
+  std::unique_ptr<Base> base = std::make_unique<Base>();
+  EXPECT_NE(static_cast<Base*>(object), base.get());
+  derived = std::make_unique<Derived>();
+  EXPECT_EQ(static_cast<Base*>(object), derived.get());
+}
+
+// std::allocate_shared() allocates the object and its control block from the pool.
+TEST_F(ObjectPoolTest, Allocator) {
+  std::shared_ptr<uint64_t> value =
+      std::allocate_shared<uint64_t>(ObjectPool::Allocator<uint64_t>(), 1);
+  value.reset();
+  const uint64_t previous_hits = hits();
+  value = std::allocate_shared<uint64_t>(ObjectPool::Allocator<uint64_t>(), 2);
+  EXPECT_EQ(2, *value);
+  EXPECT_EQ(previous_hits + 1, hits());
+}
+
+// Blocks larger than the largest size class always come from the heap.
+TEST_F(ObjectPoolTest, LargeBlock) {
+  const uint64_t misses_before = misses();
+  void* block = ObjectPool::allocate(ObjectPool::MaxPooledSize + 1);
+  ObjectPool::deallocate(block, ObjectPool::MaxPooledSize + 1);
+  block = ObjectPool::allocate(ObjectPool::MaxPooledSize + 1);
+  ObjectPool::deallocate(block, ObjectPool::MaxPooledSize + 1);
+  EXPECT_EQ(0, hits());
+  EXPECT_EQ(misses_before, misses());
+}
+
+// A block may be freed by a thread other than the one that allocated it.
+TEST_F(ObjectPoolTest, CrossThread) {
+  void* block = ObjectPool::allocate(64);
+  Thread::ThreadPtr thread = Thread::threadFactoryForTest().createThread([block]() -> void {
+    ObjectPool::deallocate(block, 64);
+    EXPECT_EQ(block, ObjectPool::allocate(64));
+    ObjectPool::deallocate(block, 64);
+  });
+  thread->join();
+}
+
+} // namespace
+} // namespace Envoy
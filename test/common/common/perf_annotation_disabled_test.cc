@@ -21,4 +21,36 @@ TEST(PerfAnnotationDisabled, testPerfAnnotation) {
   PERF_CLEAR();
 }
 
+// Without ENVOY_PERF_ANNOTATION, the macros record while annotations are enabled at runtime.
+TEST(PerfAnnotationDisabled, RuntimeEnabled) {
+  PerfAnnotationContext::setEnabled(true);
+  PERF_OPERATION(perf);
+  PERF_RECORD(perf, "alpha", "0");
+  std::string report = PERF_TO_STRING();
+  EXPECT_TRUE(report.find(" alpha ") != std::string::npos) << report;
+
+  // An operation that starts while disabled does not record, even if enabled later.
+  PerfAnnotationContext::setEnabled(false);
+  PERF_CLEAR();
+  PERF_OPERATION(disabled_perf);
+  PERF_RECORD(disabled_perf, "beta", "1");
+  PerfAnnotationContext::setEnabled(true);
+  report = PERF_TO_STRING();
+  EXPECT_TRUE(report.find(" beta ") == std::string::npos) << report;
+  PerfAnnotationContext::setEnabled(false);
+  PERF_CLEAR();
+}
+
+// The arguments of PERF_RECORD are not evaluated while annotations are disabled.
+TEST(PerfAnnotationDisabled, ArgumentsNotEvaluated) {
+  int evaluations = 0;
+  const auto description = [&evaluations]() -> std::string {
+    ++evaluations;
+    return "0";
+  };
+  PERF_OPERATION(perf);
+  PERF_RECORD(perf, "alpha", description());
+  EXPECT_EQ(0, evaluations);
+}
+
 } // namespace Envoy
@@ -0,0 +1,83 @@
+#include "envoy/common/exception.h"
+
+#include "common/common/regex.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Regex {
+namespace {
+
+envoy::type::matcher::RegexMatcher googleRe2(const std::string& regex) {
+  envoy::type::matcher::RegexMatcher matcher;
+  matcher.mutable_google_re2();
+  matcher.set_regex(regex);
+  return matcher;
+}
+
+TEST(Utility, ParseRegex) {
+  {
+    CompiledMatcherPtr matcher = Utility::parseRegex(googleRe2("/asdf/.*"));
+    EXPECT_TRUE(matcher->match("/asdf/1234"));
+    // The full input must match.
+    EXPECT_FALSE(matcher->match("/foo/asdf/1234"));
+    EXPECT_FALSE(matcher->match("/asdf"));
+  }
+
+  // Inputs that cause std::regex to recurse deeply are fine with RE2.
+  {
+    CompiledMatcherPtr matcher = Utility::parseRegex(googleRe2("/(a|b)*"));
+    EXPECT_TRUE(matcher->match("/" + std::string(100000, 'a')));
+  }
+}
+
+TEST(Utility, ParseRegexInvalid) {
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex(googleRe2("(+invalid)")), EnvoyException,
+                          "repetition operator");
+}
+
+TEST(Utility, ParseRegexProgramSize) {
+  // Exceeding the default program size.
+  const std::string long_regex = "/asdf/" + std::string(200, 'a') + ".*";
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex(googleRe2(long_regex)), EnvoyException,
+                          "RE2 program size of [0-9]+ > max program size of 100");
+
+  // Raising the limit allows compilation.
+  envoy::type::matcher::RegexMatcher matcher = googleRe2(long_regex);
+  matcher.mutable_google_re2()->mutable_max_program_size()->set_value(1000);
+  EXPECT_TRUE(Utility::parseRegex(matcher)->match("/asdf/" + std::string(200, 'a') + "xyz"));
+}
+
+TEST(Utility, ParseRegexSet) {
+  Protobuf::RepeatedPtrField<envoy::type::matcher::RegexMatcher> matchers;
+  *matchers.Add() = googleRe2("/asdf/.*");
+  *matchers.Add() = googleRe2("/t[io]c");
+  CompiledMatcherPtr matcher = Utility::parseRegexSet(matchers);
+  EXPECT_TRUE(matcher->match("/asdf/1234"));
+  EXPECT_TRUE(matcher->match("/toc"));
+  // The full input must match one of the regexes.
+  EXPECT_FALSE(matcher->match("/toc/asdf/1234"));
+  EXPECT_FALSE(matcher->match("/foo"));
+
+  *matchers.Add() = googleRe2("(+invalid)");
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegexSet(matchers), EnvoyException,
+                          "repetition operator");
+}
+
+TEST(Utility, ParseStdRegexAsCompiledMatcher) {
+  CompiledMatcherPtr matcher = Utility::parseStdRegexAsCompiledMatcher("/t[io]c");
+  EXPECT_TRUE(matcher->match("/tic"));
+  EXPECT_FALSE(matcher->match("/tic/toc"));
+
+  // ECMAScript only features remain available through the std::regex engine.
+  EXPECT_TRUE(Utility::parseStdRegexAsCompiledMatcher("(?=/)/a")->match("/a"));
+
+  EXPECT_THROW_WITH_REGEX(Utility::parseStdRegexAsCompiledMatcher("/(+invalid)"), EnvoyException,
+                          "Invalid regex '/\\(\\+invalid\\)':");
+}
+
+} // namespace
+} // namespace Regex
+} // namespace Envoy
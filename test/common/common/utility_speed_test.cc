@@ -3,7 +3,9 @@
 
 #include <random>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
+#include "common/common/base64.h"
 #include "common/common/utility.h"
 
 #include "absl/strings/string_view.h"
@@ -252,6 +254,69 @@ static void BM_IntervalSet50ToVector(benchmark::State& state) {
   }
 }
 BENCHMARK(BM_IntervalSet50ToVector);
+
+static std::string base64Input(size_t length) {
+  std::string input(length, 0);
+  for (size_t i = 0; i < length; i++) {
+    input[i] = static_cast<char>(i * 131 + 7);
+  }
+  return input;
+}
+
+// Encodes a body of range(0) bytes in slices of 16KiB, as the gRPC-Web filter does.
+static void BM_Base64EncodeBuffer(benchmark::State& state) {
+  const std::string input = base64Input(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    Buffer::OwnedImpl buffer;
+    for (size_t i = 0; i < input.size(); i += 16384) {
+      buffer.appendSliceForTest(absl::string_view(input).substr(i, 16384));
+    }
+    Buffer::OwnedImpl encoded;
+    state.ResumeTiming();
+    Base64::encode(buffer, encoded);
+    benchmark::DoNotOptimize(encoded.length());
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_Base64EncodeBuffer)->Arg(1024)->Arg(1024 * 1024);
+
+// Decodes the base64 of a body of range(0) bytes in slices of 16KiB, as the gRPC-Web filter does.
+static void BM_Base64DecodeBuffer(benchmark::State& state) {
+  const std::string input = base64Input(state.range(0));
+  const std::string encoded = Base64::encode(input.data(), input.size());
+  for (auto _ : state) {
+    state.PauseTiming();
+    Buffer::OwnedImpl buffer;
+    for (size_t i = 0; i < encoded.size(); i += 16384) {
+      buffer.appendSliceForTest(absl::string_view(encoded).substr(i, 16384));
+    }
+    Buffer::OwnedImpl decoded;
+    state.ResumeTiming();
+    RELEASE_ASSERT(Base64::decode(buffer, decoded), "");
+    benchmark::DoNotOptimize(decoded.length());
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+BENCHMARK(BM_Base64DecodeBuffer)->Arg(1024)->Arg(1024 * 1024);
+
+static void BM_Base64EncodeString(benchmark::State& state) {
+  const std::string input = base64Input(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Base64::encode(input.data(), input.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_Base64EncodeString)->Arg(64)->Arg(1024 * 1024);
+
+static void BM_Base64DecodeString(benchmark::State& state) {
+  const std::string encoded = Base64::encode(base64Input(state.range(0)).data(), state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Base64::decode(encoded));
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+BENCHMARK(BM_Base64DecodeString)->Arg(64)->Arg(1024 * 1024);
 } // namespace Envoy
 
 // Boilerplate main(), which discovers benchmarks in the same file and runs them.
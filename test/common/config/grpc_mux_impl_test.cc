@@ -327,6 +327,39 @@ TEST_F(GrpcMuxImplTest, WatchDemux) {
   expectSendMessage(type_url, {}, "2");
 }
 
+// A watch without resource names gets the whole response even when another watch gets some of
+// its resources.
+TEST_F(GrpcMuxImplTest, WildcardAndNamedWatch) {
+  setup();
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  NiceMock<MockGrpcMuxCallbacks> wildcard_callbacks;
+  auto wildcard_sub = grpc_mux_->subscribe(type_url, {}, wildcard_callbacks);
+  NiceMock<MockGrpcMuxCallbacks> named_callbacks;
+  auto named_sub = grpc_mux_->subscribe(type_url, {"x"}, named_callbacks);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  EXPECT_CALL(async_stream_, sendMessage(_, false)).Times(AtLeast(2));
+  grpc_mux_->start();
+
+  std::unique_ptr<envoy::api::v2::DiscoveryResponse> response(
+      new envoy::api::v2::DiscoveryResponse());
+  response->set_type_url(type_url);
+  response->set_version_info("1");
+  envoy::api::v2::ClusterLoadAssignment load_assignment;
+  load_assignment.set_cluster_name("x");
+  response->add_resources()->PackFrom(load_assignment);
+  const auto check_resources = [&load_assignment](
+                                   const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+                                   const std::string&) {
+    EXPECT_EQ(1, resources.size());
+    envoy::api::v2::ClusterLoadAssignment expected_assignment;
+    resources[0].UnpackTo(&expected_assignment);
+    EXPECT_TRUE(TestUtility::protoEqual(expected_assignment, load_assignment));
+  };
+  EXPECT_CALL(wildcard_callbacks, onConfigUpdate(_, "1")).WillOnce(Invoke(check_resources));
+  EXPECT_CALL(named_callbacks, onConfigUpdate(_, "1")).WillOnce(Invoke(check_resources));
+  grpc_mux_->onReceiveMessage(std::move(response));
+}
+
 // Validate behavior when we have multiple watchers that send empty updates.
 TEST_F(GrpcMuxImplTest, MultipleWatcherWithEmptyUpdates) {
   setup();
@@ -2,6 +2,7 @@
 
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::InSequence;
 
 namespace Envoy {
@@ -75,6 +76,33 @@ TEST_F(GrpcSubscriptionImplTest, RepeatedNonce) {
   verifyStats(7, 2, 2, 0, 13237225503670494420U);
 }
 
+// Validate that a response identical to the last accepted one is acknowledged without decoding it
+// or calling the callbacks again.
+TEST_F(GrpcSubscriptionImplTest, UnchangedUpdate) {
+  InSequence s;
+  startSubscription({"cluster0", "cluster1"});
+  deliverConfigUpdate({"cluster0", "cluster1"}, "0", true);
+  verifyStats(2, 1, 0, 0, 7148434200721666028);
+
+  auto response = std::make_unique<envoy::api::v2::DiscoveryResponse>();
+  response->set_version_info("0");
+  response->set_nonce(last_response_nonce_);
+  response->set_type_url(Config::TypeUrl::get().ClusterLoadAssignment);
+  for (const auto& cluster : last_cluster_names_) {
+    envoy::api::v2::ClusterLoadAssignment load_assignment;
+    load_assignment.set_cluster_name(cluster);
+    response->add_resources()->PackFrom(load_assignment);
+  }
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _)).Times(0);
+  expectSendMessage(last_cluster_names_, "0");
+  subscription_->grpcMux().onReceiveMessage(std::move(response));
+  verifyStats(3, 2, 0, 0, 7148434200721666028);
+
+  // A changed response is delivered again.
+  deliverConfigUpdate({"cluster0"}, "0", true);
+  verifyStats(4, 3, 0, 0, 7148434200721666028);
+}
+
 } // namespace
 } // namespace Config
 } // namespace Envoy
@@ -0,0 +1,129 @@
+#include <memory>
+#include <string>
+
+#include "envoy/api/v2/eds.pb.h"
+
+#include "common/config/snapshot_subscription_impl.h"
+
+#include "test/mocks/config/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Ref;
+using testing::Throw;
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+typedef SnapshotSubscriptionImpl<envoy::api::v2::ClusterLoadAssignment> SnapshotSubscription;
+
+class SnapshotSubscriptionImplTest : public testing::Test {
+protected:
+  SnapshotSubscriptionImplTest()
+      : api_(Api::createApiForTest()), path_prefix_(TestEnvironment::temporaryPath("snapshot.")),
+        path_(SnapshotSubscription::snapshotPath(path_prefix_, {"foo"})) {
+    TestEnvironment::removePath(path_);
+  }
+
+  // Create a snapshot subscription and start it, which applies the snapshot if there is one.
+  std::unique_ptr<SnapshotSubscription> start() {
+    auto* subscription = new MockSubscription<envoy::api::v2::ClusterLoadAssignment>();
+    subscription_ = subscription;
+    auto snapshot_subscription = std::make_unique<SnapshotSubscription>(
+        std::unique_ptr<Subscription<envoy::api::v2::ClusterLoadAssignment>>(subscription),
+        path_prefix_, *api_);
+    EXPECT_CALL(*subscription, start(std::vector<std::string>{"foo"},
+                                     Ref(*snapshot_subscription)));
+    snapshot_subscription->start({"foo"}, callbacks_);
+    return snapshot_subscription;
+  }
+
+  Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources() {
+    Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources;
+    resources.Add()->set_cluster_name("foo");
+    return resources;
+  }
+
+  Api::ApiPtr api_;
+  const std::string path_prefix_;
+  const std::string path_;
+  MockSubscription<envoy::api::v2::ClusterLoadAssignment>* subscription_{};
+  MockSubscriptionCallbacks<envoy::api::v2::ClusterLoadAssignment> callbacks_;
+};
+
+// Accepted updates are written to the snapshot, and a subscription started later applies them
+// before the management server delivers anything.
+TEST_F(SnapshotSubscriptionImplTest, WriteAndApplySnapshot) {
+  auto subscription = start();
+  EXPECT_FALSE(api_->fileSystem().fileExists(path_));
+  EXPECT_CALL(callbacks_, onConfigUpdate(RepeatedProtoEq(resources()), "1"));
+  subscription->onConfigUpdate(resources(), "1");
+  EXPECT_TRUE(api_->fileSystem().fileExists(path_));
+
+  EXPECT_CALL(callbacks_, onConfigUpdate(RepeatedProtoEq(resources()), "1"));
+  subscription = start();
+}
+
+// Rejected updates do not replace the snapshot.
+TEST_F(SnapshotSubscriptionImplTest, RejectedUpdate) {
+  auto subscription = start();
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "1"));
+  subscription->onConfigUpdate(resources(), "1");
+
+  auto rejected = resources();
+  rejected.Add()->set_cluster_name("bar");
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "2")).WillOnce(Throw(EnvoyException("rejected")));
+  EXPECT_THROW(subscription->onConfigUpdate(rejected, "2"), EnvoyException);
+
+  EXPECT_CALL(callbacks_, onConfigUpdate(RepeatedProtoEq(resources()), "1"));
+  subscription = start();
+}
+
+// Snapshots that cannot be parsed or that are rejected are ignored.
+TEST_F(SnapshotSubscriptionImplTest, IgnoresBadSnapshots) {
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _)).Times(0);
+  TestEnvironment::writeStringToFileForTest(path_.substr(path_.rfind('/') + 1), "garbage");
+  start();
+
+  {
+    auto subscription = start();
+    EXPECT_CALL(callbacks_, onConfigUpdate(_, "1"));
+    subscription->onConfigUpdate(resources(), "1");
+  }
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "1")).WillOnce(Throw(EnvoyException("rejected")));
+  start();
+}
+
+// Subscriptions to different resources have different snapshots.
+TEST_F(SnapshotSubscriptionImplTest, SnapshotPath) {
+  EXPECT_EQ(path_prefix_ + "envoy.api.v2.ClusterLoadAssignment.pb",
+            SnapshotSubscription::snapshotPath(path_prefix_, {}));
+  EXPECT_EQ(SnapshotSubscription::snapshotPath(path_prefix_, {"foo", "bar"}),
+            SnapshotSubscription::snapshotPath(path_prefix_, {"bar", "foo"}));
+  EXPECT_NE(SnapshotSubscription::snapshotPath(path_prefix_, {"foo", "bar"}), path_);
+}
+
+// Other callbacks are passed through to the subscriber.
+TEST_F(SnapshotSubscriptionImplTest, PassThrough) {
+  auto subscription = start();
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(nullptr));
+  subscription->onConfigUpdateFailed(nullptr);
+
+  envoy::api::v2::ClusterLoadAssignment resource;
+  resource.set_cluster_name("foo");
+  ProtobufWkt::Any any;
+  any.PackFrom(resource);
+  EXPECT_EQ("foo", subscription->resourceName(any));
+
+  EXPECT_CALL(*subscription_, updateResources(std::vector<std::string>{"bar"}));
+  subscription->updateResources({"bar"});
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
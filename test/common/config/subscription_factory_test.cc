@@ -197,6 +197,30 @@ TEST_F(SubscriptionFactoryTest, FilesystemSubscriptionNonExistentFile) {
                             "'/blahblah' does not exist")
 }
 
+TEST_F(SubscriptionFactoryTest, SnapshotFilesystemSubscription) {
+  envoy::api::v2::core::ConfigSource config;
+  std::string test_path = TestEnvironment::temporaryDirectory();
+  config.set_path(test_path);
+  config.set_snapshot_path_prefix(TestEnvironment::temporaryPath("snapshot_factory_test."));
+  auto* watcher = new Filesystem::MockWatcher();
+  EXPECT_CALL(dispatcher_, createFilesystemWatcher_()).WillOnce(Return(watcher));
+  EXPECT_CALL(*watcher, addWatch(test_path, _, _));
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(_));
+  auto subscription = subscriptionFromConfigSource(config);
+  EXPECT_NE(nullptr, dynamic_cast<SnapshotSubscriptionImpl<envoy::api::v2::ClusterLoadAssignment>*>(
+                         subscription.get()));
+  subscription->start({"foo"}, callbacks_);
+}
+
+TEST_F(SubscriptionFactoryTest, SnapshotDeltaGrpcSubscription) {
+  envoy::api::v2::core::ConfigSource config;
+  config.mutable_api_config_source()->set_api_type(
+      envoy::api::v2::core::ApiConfigSource::DELTA_GRPC);
+  config.set_snapshot_path_prefix(TestEnvironment::temporaryPath("snapshot_factory_test."));
+  EXPECT_THROW_WITH_MESSAGE(subscriptionFromConfigSource(config), EnvoyException,
+                            "snapshot_path_prefix is not supported with the DELTA_GRPC API type");
+}
+
 TEST_F(SubscriptionFactoryTest, LegacySubscription) {
   envoy::api::v2::core::ConfigSource config;
   auto* api_config_source = config.mutable_api_config_source();
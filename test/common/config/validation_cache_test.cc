@@ -0,0 +1,79 @@
+#include "envoy/api/v2/eds.pb.h"
+#include "envoy/api/v2/eds.pb.validate.h"
+
+#include "common/config/validation_cache.h"
+
+#include "test/mocks/stats/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+using testing::Property;
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+class ValidationCacheTest : public testing::Test {
+protected:
+  ValidationCacheTest() : cache_(store_, time_system_) {}
+
+  envoy::api::v2::ClusterLoadAssignment* addResource(const std::string& cluster_name) {
+    auto* resource = resources_.Add();
+    resource->set_cluster_name(cluster_name);
+    return resource;
+  }
+
+  NiceMock<Stats::MockIsolatedStatsStore> store_;
+  Event::SimulatedTimeSystem time_system_;
+  ValidationCache cache_;
+  Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources_;
+};
+
+TEST_F(ValidationCacheTest, CachesValidatedResources) {
+  addResource("foo");
+  addResource("bar");
+  EXPECT_CALL(store_, deliverHistogramToSinks(
+                          Property(&Stats::Metric::name, "update_validation_time_us"), _));
+  cache_.validate(resources_);
+  EXPECT_EQ(2, cache_.size());
+  EXPECT_TRUE(cache_.contains(MessageUtil::hash(resources_[0])));
+  EXPECT_TRUE(cache_.contains(MessageUtil::hash(resources_[1])));
+
+  // Only the resources of the last update are kept.
+  resources_.RemoveLast();
+  cache_.validate(resources_);
+  EXPECT_EQ(1, cache_.size());
+  EXPECT_TRUE(cache_.contains(MessageUtil::hash(resources_[0])));
+}
+
+// A resource that was validated before is not validated again, a changed one is.
+TEST_F(ValidationCacheTest, SkipsUnchangedResources) {
+  // The empty cluster name fails validation, which shows the cached resource was not validated.
+  auto* resource = addResource("");
+  cache_.replace({MessageUtil::hash(*resource)});
+  cache_.validate(resources_);
+  EXPECT_EQ(1, cache_.size());
+
+  resource->mutable_policy()->mutable_overprovisioning_factor()->set_value(100);
+  EXPECT_THROW(cache_.validate(resources_), ProtoValidationException);
+}
+
+// The cache is left as is when an update fails validation.
+TEST_F(ValidationCacheTest, FailedValidationKeepsCache) {
+  addResource("foo");
+  cache_.validate(resources_);
+  const uint64_t hash = MessageUtil::hash(resources_[0]);
+
+  addResource("");
+  EXPECT_THROW(cache_.validate(resources_), ProtoValidationException);
+  EXPECT_EQ(1, cache_.size());
+  EXPECT_TRUE(cache_.contains(hash));
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
@@ -251,6 +251,47 @@ TEST_F(ZlibDecompressorImplTest, CompressDecompressOfMultipleSlices) {
   EXPECT_EQ(original_text, decompressed_text);
 }
 
+// A stream that decompresses to more than the maximum is stopped within a chunk of it.
+TEST_F(ZlibDecompressorImplTest, DecompressWithMaxOutputBytes) {
+  Buffer::OwnedImpl buffer;
+  buffer.add(std::string(1024 * 1024, 'a'));
+  Envoy::Compressor::ZlibCompressorImpl compressor;
+  compressor.init(Envoy::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+                  Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard,
+                  gzip_window_bits, memory_level);
+  compressor.compress(buffer, Compressor::State::Finish);
+  const std::string compressed = buffer.toString();
+
+  {
+    ZlibDecompressorImpl decompressor;
+    decompressor.init(gzip_window_bits);
+    Buffer::OwnedImpl input(compressed);
+    Buffer::OwnedImpl output;
+    EXPECT_TRUE(decompressor.decompress(input, output, 1024 * 1024));
+    EXPECT_EQ(1024U * 1024, output.length());
+  }
+
+  ZlibDecompressorImpl decompressor;
+  decompressor.init(gzip_window_bits);
+  Buffer::OwnedImpl input(compressed);
+  Buffer::OwnedImpl output;
+  EXPECT_FALSE(decompressor.decompress(input, output, 10000));
+  EXPECT_LT(10000U, output.length());
+  EXPECT_GE(10000U + 4096, output.length());
+  // The decompressor can't be used anymore.
+  EXPECT_FALSE(decompressor.decompress(input, output, 1024 * 1024));
+}
+
+// Malformed data fails to decompress instead of crashing.
+TEST_F(ZlibDecompressorImplTest, DecompressMalformedData) {
+  ZlibDecompressorImpl decompressor;
+  decompressor.init(gzip_window_bits);
+  Buffer::OwnedImpl input("not a gzip stream");
+  Buffer::OwnedImpl output;
+  EXPECT_FALSE(decompressor.decompress(input, output, 1024));
+  EXPECT_EQ(0U, output.length());
+}
+
 } // namespace
 } // namespace Decompressor
 } // namespace Envoy
@@ -1,3 +1,5 @@
+#include <unistd.h>
+
 #include <functional>
 
 #include "envoy/thread/thread.h"
@@ -8,12 +10,16 @@
 #include "common/stats/isolated_store_impl.h"
 
 #include "test/mocks/common.h"
+#include "test/mocks/stats/mocks.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::InSequence;
+using testing::NiceMock;
+using testing::Property;
 
 namespace Envoy {
 namespace Event {
@@ -122,8 +128,8 @@ TEST_F(DispatcherImplTest, RunPostCallbacksLocking) {
     // Block dispatcher first to ensure that both posted events below are handled
     // by a single call to runPostCallbacks().
     //
-    // This also ensures that the post_lock_ is not held while callbacks are called,
-    // or else this would deadlock.
+    // This also ensures that posting from the destructor of a callback's captures,
+    // while the callbacks are being run, doesn't deadlock.
     Thread::LockGuard lock(mu_);
     dispatcher_->post([this]() { Thread::LockGuard lock(mu_); });
 
@@ -183,6 +189,92 @@ TEST(TimerImplTest, TimerEnabledDisabled) {
   EXPECT_FALSE(timer->enabled());
 }
 
+// Coarse timers never fire early, and disabled ones never fire.
+TEST(TimerImplTest, CoarseTimer) {
+  Api::ApiPtr api = Api::createApiForTest();
+  DispatcherPtr dispatcher(api->allocateDispatcher());
+  MonotonicTime fired_time;
+  Event::TimerPtr timer =
+      dispatcher->createCoarseTimer([&]() { fired_time = api->timeSource().monotonicTime(); });
+  Event::TimerPtr disabled = dispatcher->createCoarseTimer([] { FAIL(); });
+  EXPECT_FALSE(timer->enabled());
+
+  const MonotonicTime start = api->timeSource().monotonicTime();
+  timer->enableTimer(std::chrono::milliseconds(5));
+  disabled->enableTimer(std::chrono::milliseconds(1));
+  disabled->disableTimer();
+  EXPECT_TRUE(timer->enabled());
+  EXPECT_FALSE(disabled->enabled());
+  dispatcher->run(Dispatcher::RunType::Block);
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_GE(fired_time - start, std::chrono::milliseconds(5));
+}
+
+class DispatcherStatsTest : public testing::Test {
+protected:
+  DispatcherStatsTest() : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher()) {}
+
+  void expectHistogram(const std::string& name, int times) {
+    EXPECT_CALL(store_, deliverHistogramToSinks(Property(&Stats::Metric::name, name), _))
+        .Times(times);
+  }
+
+  NiceMock<Stats::MockIsolatedStatsStore> store_;
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+};
+
+TEST_F(DispatcherStatsTest, Disabled) {
+  EXPECT_CALL(store_, deliverHistogramToSinks(_, _)).Times(0);
+  dispatcher_->post([]() {});
+  TimerPtr timer = dispatcher_->createTimer([]() {});
+  timer->enableTimer(std::chrono::milliseconds(0));
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(DispatcherStatsTest, PostCallbacks) {
+  // Callbacks posted before stats are enabled have no post time to compute a delay from.
+  dispatcher_->post([]() {});
+  dispatcher_->initializeStats(store_, "test.");
+  dispatcher_->post([]() {});
+
+  expectHistogram("test.dispatcher.post_delay_us", 1);
+  expectHistogram("test.dispatcher.post_callback_duration_us", 2);
+  // Both callbacks run in a single pass.
+  expectHistogram("test.dispatcher.post_queue_depth", 1);
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(DispatcherStatsTest, Timers) {
+  // Timers created before stats are enabled are not timed.
+  TimerPtr untimed = dispatcher_->createTimer([]() {});
+  dispatcher_->initializeStats(store_, "test.");
+  TimerPtr timed = dispatcher_->createTimer([]() {});
+  untimed->enableTimer(std::chrono::milliseconds(0));
+  timed->enableTimer(std::chrono::milliseconds(0));
+
+  expectHistogram("test.dispatcher.timer_duration_us", 1);
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(DispatcherStatsTest, FileEvents) {
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  dispatcher_->initializeStats(store_, "test.");
+
+  // The callback destroys its own event, which must not break the timing around it.
+  FileEventPtr file_event;
+  file_event = dispatcher_->createFileEvent(fds[0], [&file_event](uint32_t) { file_event.reset(); },
+                                            FileTriggerType::Level, FileReadyType::Read);
+  file_event->activate(FileReadyType::Read);
+
+  expectHistogram("test.dispatcher.file_event_duration_us", 1);
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(nullptr, file_event);
+  close(fds[0]);
+  close(fds[1]);
+}
+
 } // namespace
 } // namespace Event
 } // namespace Envoy
@@ -0,0 +1,166 @@
+#include <chrono>
+#include <vector>
+
+#include "common/event/timer_wheel.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+class TimerWheelTest : public testing::Test {
+protected:
+  TimerWheelTest()
+      : tick_timer_(new NiceMock<MockTimer>(&dispatcher_)),
+        wheel_(dispatcher_, std::chrono::milliseconds(10)) {}
+
+  // Move time forward and run the wheel's tick, like the dispatcher would once it is due.
+  void advance(std::chrono::milliseconds duration) {
+    time_system_.sleep(duration);
+    if (tick_timer_->enabled_) {
+      tick_timer_->invokeCallback();
+    }
+  }
+
+  TimerPtr createTimer(uint32_t id) {
+    return wheel_.createTimer([this, id]() -> void { fired_.push_back(id); });
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<MockDispatcher> dispatcher_;
+  MockTimer* tick_timer_;
+  TimerWheel wheel_;
+  std::vector<uint32_t> fired_;
+};
+
+TEST_F(TimerWheelTest, RoundsUpToResolution) {
+  TimerPtr timer = createTimer(1);
+  timer->enableTimer(std::chrono::milliseconds(25));
+  EXPECT_TRUE(timer->enabled());
+  EXPECT_EQ(1, wheel_.armedTimers());
+
+  advance(std::chrono::milliseconds(20));
+  EXPECT_TRUE(fired_.empty());
+  advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(std::vector<uint32_t>({1}), fired_);
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_EQ(0, wheel_.armedTimers());
+  EXPECT_FALSE(tick_timer_->enabled_);
+}
+
+TEST_F(TimerWheelTest, DisableAndReenable) {
+  TimerPtr first = createTimer(1);
+  TimerPtr second = createTimer(2);
+  first->enableTimer(std::chrono::milliseconds(10));
+  second->enableTimer(std::chrono::milliseconds(10));
+  first->disableTimer();
+  EXPECT_FALSE(first->enabled());
+
+  // Enabling an armed timer moves it.
+  second->enableTimer(std::chrono::milliseconds(30));
+  advance(std::chrono::milliseconds(20));
+  EXPECT_TRUE(fired_.empty());
+  advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(std::vector<uint32_t>({2}), fired_);
+
+  // Destroying an armed timer disarms it.
+  first->enableTimer(std::chrono::milliseconds(10));
+  first.reset();
+  EXPECT_EQ(0, wheel_.armedTimers());
+}
+
+// Timers beyond the span of the lowest level fire on time after cascading through the levels.
+TEST_F(TimerWheelTest, Cascades) {
+  const std::vector<uint64_t> delays_ms = {640, 650, 41000, 2700000, 200000000};
+  std::vector<TimerPtr> timers;
+  for (uint32_t i = 0; i < delays_ms.size(); i++) {
+    timers.push_back(createTimer(i));
+    timers.back()->enableTimer(std::chrono::milliseconds(delays_ms[i]));
+  }
+
+  uint64_t now_ms = 0;
+  for (uint32_t i = 0; i < delays_ms.size(); i++) {
+    advance(std::chrono::milliseconds(delays_ms[i] - now_ms - 10));
+    now_ms = delays_ms[i] - 10;
+    EXPECT_EQ(i, fired_.size());
+    advance(std::chrono::milliseconds(10));
+    now_ms += 10;
+    EXPECT_EQ(i + 1, fired_.size());
+    EXPECT_EQ(i, fired_.back());
+  }
+  EXPECT_EQ(0, wheel_.armedTimers());
+}
+
+// A callback can re-arm its own timer and disarm others that expire in the same tick.
+TEST_F(TimerWheelTest, CallbacksModifyTimers) {
+  TimerPtr second;
+  TimerPtr first = wheel_.createTimer([&]() -> void {
+    fired_.push_back(1);
+    second->disableTimer();
+    first->enableTimer(std::chrono::milliseconds(10));
+  });
+  second = createTimer(2);
+  first->enableTimer(std::chrono::milliseconds(10));
+  second->enableTimer(std::chrono::milliseconds(10));
+
+  advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(std::vector<uint32_t>({1}), fired_);
+  EXPECT_TRUE(first->enabled());
+  EXPECT_FALSE(second->enabled());
+  advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(std::vector<uint32_t>({1, 1}), fired_);
+}
+
+// The tick timer skips the ticks that expire no timer, and is moved earlier for earlier timers.
+TEST_F(TimerWheelTest, SkipsEmptyTicks) {
+  TimerPtr first = createTimer(1);
+  TimerPtr second = createTimer(2);
+  EXPECT_CALL(*tick_timer_, enableTimer(std::chrono::milliseconds(30)));
+  first->enableTimer(std::chrono::milliseconds(25));
+  EXPECT_CALL(*tick_timer_, enableTimer(std::chrono::milliseconds(10)));
+  second->enableTimer(std::chrono::milliseconds(10));
+
+  EXPECT_CALL(*tick_timer_, enableTimer(std::chrono::milliseconds(20)));
+  advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(std::vector<uint32_t>({2}), fired_);
+
+  // Timers beyond the current rotation of the lowest level only wake the wheel up at the end of
+  // the rotation, where the higher levels cascade.
+  second->enableTimer(std::chrono::milliseconds(2000));
+  EXPECT_CALL(*tick_timer_, enableTimer(std::chrono::milliseconds(610)));
+  advance(std::chrono::milliseconds(20));
+  EXPECT_EQ(std::vector<uint32_t>({2, 1}), fired_);
+  testing::Mock::VerifyAndClearExpectations(tick_timer_);
+
+  EXPECT_CALL(*tick_timer_, enableTimer(std::chrono::milliseconds(640))).Times(2);
+  EXPECT_CALL(*tick_timer_, enableTimer(std::chrono::milliseconds(90)));
+  advance(std::chrono::milliseconds(610));
+  advance(std::chrono::milliseconds(640));
+  advance(std::chrono::milliseconds(640));
+  EXPECT_EQ(std::vector<uint32_t>({2, 1}), fired_);
+  advance(std::chrono::milliseconds(90));
+  EXPECT_EQ(std::vector<uint32_t>({2, 1, 2}), fired_);
+  EXPECT_FALSE(tick_timer_->enabled_);
+}
+
+// A wheel that was idle skips the ticks that went by, and catches up on ticks that were late.
+TEST_F(TimerWheelTest, IdleAndLateTicks) {
+  advance(std::chrono::milliseconds(100000));
+  TimerPtr first = createTimer(1);
+  TimerPtr second = createTimer(2);
+  first->enableTimer(std::chrono::milliseconds(10));
+  second->enableTimer(std::chrono::milliseconds(50));
+  advance(std::chrono::milliseconds(100));
+  EXPECT_EQ(std::vector<uint32_t>({1, 2}), fired_);
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "common/buffer/buffer_impl.h"
+#include "common/common/fmt.h"
 #include "common/grpc/codec.h"
 
 #include "test/proto/helloworld.pb.h"
@@ -169,6 +170,119 @@ TEST(GrpcCodecTest, decodeMultipleFrame) {
   }
 }
 
+// The frames before an invalid frame are decoded, and the input is left at the invalid frame.
+TEST(GrpcCodecTest, decodeInvalidFrameAfterValidFrame) {
+  Buffer::OwnedImpl buffer(std::string("\x00\x00\x00\x00\x01"
+                                       "a"
+                                       "\x02\x00\x00\x00\x01"
+                                       "b",
+                                       12));
+
+  std::vector<Frame> frames;
+  Decoder decoder;
+  EXPECT_FALSE(decoder.decode(buffer, frames));
+  ASSERT_EQ(1, frames.size());
+  EXPECT_EQ("a", frames[0].data_->toString());
+  EXPECT_EQ(6, buffer.length());
+}
+
+// The slices of the input that hold payload only are moved to the frame instead of copied.
+TEST(GrpcCodecTest, decodeMovesPayloadSlices) {
+  Buffer::OwnedImpl payload(std::string(1024, 'a'));
+  Buffer::RawSlice payload_slice;
+  ASSERT_EQ(1, payload.getRawSlices(&payload_slice, 1));
+
+  Buffer::OwnedImpl buffer;
+  std::array<uint8_t, 5> header;
+  Encoder().newFrame(GRPC_FH_DEFAULT, payload.length(), header);
+  buffer.add(header.data(), header.size());
+  buffer.move(payload);
+
+  std::vector<Frame> frames;
+  Decoder decoder;
+  EXPECT_TRUE(decoder.decode(buffer, frames));
+  ASSERT_EQ(1, frames.size());
+  Buffer::RawSlice frame_slice;
+  ASSERT_EQ(1, frames[0].data_->getRawSlices(&frame_slice, 1));
+  EXPECT_EQ(payload_slice.mem_, frame_slice.mem_);
+  EXPECT_EQ(1024, frame_slice.len_);
+}
+
+// Decodes one byte at a time, including the frame headers.
+TEST(GrpcCodecTest, decodeSplitFrames) {
+  const std::string input("\x00\x00\x00\x00\x03"
+                          "abc"
+                          "\x01\x00\x00\x00\x00"
+                          "\x00\x00\x00\x00\x02"
+                          "de",
+                          20);
+
+  std::vector<Frame> frames;
+  Decoder decoder;
+  for (const char c : input) {
+    Buffer::OwnedImpl buffer(&c, 1);
+    EXPECT_TRUE(decoder.decode(buffer, frames));
+    EXPECT_EQ(0, buffer.length());
+  }
+  ASSERT_EQ(3, frames.size());
+  EXPECT_EQ("abc", frames[0].data_->toString());
+  EXPECT_EQ(GRPC_FH_COMPRESSED, frames[1].flags_);
+  EXPECT_EQ(0, frames[1].length_);
+  EXPECT_EQ(nullptr, frames[1].data_);
+  EXPECT_EQ("de", frames[2].data_->toString());
+  EXPECT_FALSE(decoder.hasBufferedData());
+}
+
+class TestFrameCallbacks : public FrameCallbacks {
+public:
+  // FrameCallbacks
+  void onFrameStart(uint8_t flags, uint32_t length) override {
+    events_.push_back(fmt::format("start {} {}", flags, length));
+  }
+  void onFrameData(Buffer::Instance& data) override {
+    events_.push_back(fmt::format("data {}", data.toString()));
+  }
+  void onFrameEnd() override { events_.push_back("end"); }
+
+  std::vector<std::string> events_;
+};
+
+// The streaming decoder passes the payload on as it arrives instead of buffering the frame.
+TEST(GrpcCodecTest, decodeStreaming) {
+  TestFrameCallbacks callbacks;
+  Decoder decoder;
+
+  Buffer::OwnedImpl buffer(std::string("\x00\x00\x00\x00\x05"
+                                       "ab",
+                                       7));
+  EXPECT_TRUE(decoder.decode(buffer, callbacks));
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_EQ(std::vector<std::string>({"start 0 5", "data ab"}), callbacks.events_);
+  EXPECT_TRUE(decoder.hasBufferedData());
+  EXPECT_EQ(5, decoder.length());
+
+  buffer.add(std::string("cde"
+                         "\x01\x00\x00\x00\x00"
+                         "\x00\x00",
+                         10));
+  EXPECT_TRUE(decoder.decode(buffer, callbacks));
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_EQ(
+      std::vector<std::string>({"start 0 5", "data ab", "data cde", "end", "start 1 0", "end"}),
+      callbacks.events_);
+  EXPECT_TRUE(decoder.hasBufferedData());
+
+  buffer.add(std::string("\x00\x00\x01"
+                         "f"
+                         "\x04",
+                         5));
+  EXPECT_FALSE(decoder.decode(buffer, callbacks));
+  EXPECT_EQ(1, buffer.length());
+  EXPECT_EQ(std::vector<std::string>({"start 0 5", "data ab", "data cde", "end", "start 1 0", "end",
+                                      "start 0 1", "data f", "end"}),
+            callbacks.events_);
+}
+
 } // namespace
 } // namespace Grpc
 } // namespace Envoy
@@ -1,3 +1,5 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/grpc/codec.h"
 #include "common/grpc/common.h"
 #include "common/http/headers.h"
 #include "common/http/message_impl.h"
@@ -349,5 +351,33 @@ TEST(GrpcCommonTest, ValidateResponse) {
   }
 }
 
+// Small messages are serialized in a single slice, larger ones across several, and both decode
+// back to the original message.
+TEST(GrpcCommonTest, SerializeToGrpcFrame) {
+  for (const uint64_t name_size : {0, 10, 100000}) {
+    helloworld::HelloRequest request;
+    request.set_name(std::string(name_size, 'a'));
+
+    Buffer::OwnedImpl buffer;
+    Common::serializeToGrpcFrame(request, buffer);
+    EXPECT_EQ(request.ByteSize() + GRPC_FRAME_HEADER_SIZE, buffer.length());
+    if (name_size <= 10) {
+      EXPECT_EQ(1, buffer.getRawSlices(nullptr, 0));
+    } else {
+      EXPECT_LT(1, buffer.getRawSlices(nullptr, 0));
+    }
+    EXPECT_EQ(buffer.toString(), Common::serializeBody(request)->toString());
+
+    Decoder decoder;
+    std::vector<Frame> frames;
+    EXPECT_TRUE(decoder.decode(buffer, frames));
+    ASSERT_EQ(1, frames.size());
+    EXPECT_EQ(GRPC_FH_DEFAULT, frames[0].flags_);
+    helloworld::HelloRequest decoded;
+    ASSERT_TRUE(decoded.ParseFromString(frames[0].data_->toString()));
+    EXPECT_EQ(request.name(), decoded.name());
+  }
+}
+
 } // namespace Grpc
 } // namespace Envoy
@@ -35,6 +35,42 @@ TEST_P(GrpcClientIntegrationTest, ClientDestruct) {
   grpc_client_.reset();
 }
 
+// Validate that a simple request-reply stream works with a shared completion queue pool.
+TEST_P(GrpcClientIntegrationTest, BasicStreamCompletionQueuePool) {
+  SKIP_IF_GRPC_CLIENT(ClientType::EnvoyGrpc);
+  google_grpc_completion_threads_ = 2;
+  initialize();
+  auto stream = createStream(empty_metadata_);
+  stream->sendRequest();
+  stream->sendServerInitialMetadata(empty_metadata_);
+  stream->sendReply();
+  stream->sendServerTrailers(Status::GrpcStatus::Ok, "", empty_metadata_);
+  dispatcher_helper_.runDispatcher();
+}
+
+// Validate that a client destruction with open streams cleans up appropriately with a shared
+// completion queue pool.
+TEST_P(GrpcClientIntegrationTest, ClientDestructCompletionQueuePool) {
+  SKIP_IF_GRPC_CLIENT(ClientType::EnvoyGrpc);
+  google_grpc_completion_threads_ = 2;
+  initialize();
+  auto stream = createStream(empty_metadata_);
+  stream->sendRequest();
+  grpc_client_.reset();
+}
+
+// Validate that multiple request-reply unary RPCs work with a shared completion queue pool.
+TEST_P(GrpcClientIntegrationTest, MultiRequestCompletionQueuePool) {
+  SKIP_IF_GRPC_CLIENT(ClientType::EnvoyGrpc);
+  google_grpc_completion_threads_ = 2;
+  initialize();
+  auto request_0 = createRequest(empty_metadata_);
+  auto request_1 = createRequest(empty_metadata_);
+  request_1->sendReply();
+  request_0->sendReply();
+  dispatcher_helper_.runDispatcher();
+}
+
 // Validate that a simple request-reply unary RPC works.
 TEST_P(GrpcClientIntegrationTest, BasicRequest) {
   initialize();
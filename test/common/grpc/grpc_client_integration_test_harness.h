@@ -307,7 +307,13 @@ public:
 
   AsyncClientPtr createGoogleAsyncClientImpl() {
 #ifdef ENVOY_GOOGLE_GRPC
-    google_tls_ = std::make_unique<GoogleAsyncClientThreadLocal>(*api_);
+    if (google_grpc_completion_threads_ > 0) {
+      google_tls_ = std::make_unique<GoogleAsyncClientThreadLocal>(
+          *dispatcher_,
+          std::make_shared<GoogleCompletionQueuePool>(*api_, google_grpc_completion_threads_));
+    } else {
+      google_tls_ = std::make_unique<GoogleAsyncClientThreadLocal>(*api_);
+    }
     GoogleGenericStubFactory stub_factory;
     return std::make_unique<GoogleAsyncClientImpl>(*dispatcher_, *google_tls_, stub_factory,
                                                    stats_scope_, createGoogleGrpcConfig(), *api_);
@@ -425,6 +431,9 @@ public:
 #ifdef ENVOY_GOOGLE_GRPC
   std::unique_ptr<GoogleAsyncClientThreadLocal> google_tls_;
 #endif
+  // Whether the Google gRPC client uses a shared completion queue pool of this size instead of a
+  // completion thread of its own.
+  uint32_t google_grpc_completion_threads_{};
   AsyncClientPtr grpc_client_;
   Event::TimerPtr timeout_timer_;
   const TestMetadata empty_metadata_;
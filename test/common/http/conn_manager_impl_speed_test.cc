@@ -0,0 +1,263 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Runs header only requests, answered by a filter with a local reply, through a
+// ConnectionManagerImpl on a real dispatcher, so that the streams are destroyed by deferred
+// deletion as in production. Besides the time per request, it reports how many of the per request
+// objects were allocated from the heap rather than reused from the object pool.
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/common/empty_string.h"
+#include "common/common/object_pool.h"
+#include "common/http/conn_manager_impl.h"
+#include "common/http/context_impl.h"
+#include "common/http/date_provider_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/network/address_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "test/mocks/access_log/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/router/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Http {
+
+// Answers every request with a local reply once its headers are decoded.
+class LocalReplyFilter : public StreamDecoderFilter {
+public:
+  // Http::StreamFilterBase
+  void onDestroy() override {}
+
+  // Http::StreamDecoderFilter
+  FilterHeadersStatus decodeHeaders(HeaderMap&, bool) override {
+    callbacks_->sendLocalReply(Code::OK, EMPTY_STRING, nullptr, absl::nullopt);
+    return FilterHeadersStatus::StopIteration;
+  }
+  FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return FilterDataStatus::Continue;
+  }
+  FilterTrailersStatus decodeTrailers(HeaderMap&) override {
+    return FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(StreamDecoderFilterCallbacks& callbacks) override {
+    callbacks_ = &callbacks;
+  }
+
+private:
+  StreamDecoderFilterCallbacks* callbacks_{};
+};
+
+class LocalReplyFilterFactory : public FilterChainFactory {
+public:
+  // Http::FilterChainFactory
+  void createFilterChain(FilterChainFactoryCallbacks& callbacks) override {
+    callbacks.addStreamDecoderFilter(std::make_shared<LocalReplyFilter>());
+  }
+  bool createUpgradeFilterChain(absl::string_view, const UpgradeMap*,
+                                FilterChainFactoryCallbacks&) override {
+    return false;
+  }
+};
+
+// A codec that decodes a header only request for every dispatch(), and discards the responses.
+class RequestCodec : public ServerConnection, public StreamEncoder, public Stream {
+public:
+  explicit RequestCodec(ServerConnectionCallbacks& callbacks) : callbacks_(callbacks) {}
+
+  // Http::Connection
+  void dispatch(Buffer::Instance&) override {
+    StreamDecoder& decoder = callbacks_.newStream(*this);
+    HeaderMapPtr headers{new HeaderMapImpl{{Headers::get().Method, "GET"},
+                                           {Headers::get().Path, "/"},
+                                           {Headers::get().Host, "host"}}};
+    decoder.decodeHeaders(std::move(headers), true);
+  }
+  void goAway() override {}
+  Protocol protocol() override { return Protocol::Http11; }
+  void shutdownNotice() override {}
+  bool wantsToWrite() override { return false; }
+  void onUnderlyingConnectionAboveWriteBufferHighWatermark() override {}
+  void onUnderlyingConnectionBelowWriteBufferLowWatermark() override {}
+
+  // Http::StreamEncoder
+  void encode100ContinueHeaders(const HeaderMap&) override {}
+  void encodeHeaders(const HeaderMap&, bool) override {}
+  void encodeData(Buffer::Instance&, bool) override {}
+  void encodeTrailers(const HeaderMap&) override {}
+  Stream& getStream() override { return *this; }
+  void encodeMetadata(const MetadataMapVector&) override {}
+
+  // Http::Stream
+  void addCallbacks(StreamCallbacks&) override {}
+  void removeCallbacks(StreamCallbacks&) override {}
+  void resetStream(StreamResetReason) override {}
+  void readDisable(bool) override {}
+  uint32_t bufferLimit() override { return 0; }
+
+private:
+  ServerConnectionCallbacks& callbacks_;
+};
+
+class SpeedTestConfig : public ConnectionManagerConfig {
+public:
+  struct RouteConfigProvider : public Router::RouteConfigProvider {
+    RouteConfigProvider(TimeSource& time_source) : time_source_(time_source) {}
+
+    // Router::RouteConfigProvider
+    Router::ConfigConstSharedPtr config() override { return route_config_; }
+    absl::optional<ConfigInfo> configInfo() const override { return {}; }
+    SystemTime lastUpdated() const override { return time_source_.systemTime(); }
+
+    TimeSource& time_source_;
+    std::shared_ptr<Router::MockConfig> route_config_{new NiceMock<Router::MockConfig>()};
+  };
+
+  SpeedTestConfig(TimeSource& time_source)
+      : date_provider_(time_source), route_config_provider_(time_source),
+        stats_{{ALL_HTTP_CONN_MAN_STATS(POOL_COUNTER(fake_stats_), POOL_GAUGE(fake_stats_),
+                                        POOL_HISTOGRAM(fake_stats_))},
+               "",
+               fake_stats_},
+        tracing_stats_{CONN_MAN_TRACING_STATS(POOL_COUNTER(fake_stats_))},
+        listener_stats_{CONN_MAN_LISTENER_STATS(POOL_COUNTER(fake_stats_))} {}
+
+  // Http::ConnectionManagerConfig
+  const std::list<AccessLog::InstanceSharedPtr>& accessLogs() override { return access_logs_; }
+  ServerConnectionPtr createCodec(Network::Connection&, const Buffer::Instance&,
+                                  ServerConnectionCallbacks& callbacks) override {
+    return std::make_unique<RequestCodec>(callbacks);
+  }
+  DateProvider& dateProvider() override { return date_provider_; }
+  std::chrono::milliseconds drainTimeout() override { return std::chrono::milliseconds(100); }
+  FilterChainFactory& filterFactory() override { return filter_factory_; }
+  bool generateRequestId() override { return false; }
+  uint32_t maxRequestHeadersKb() const override { return Http::DEFAULT_MAX_REQUEST_HEADERS_KB; }
+  absl::optional<std::chrono::milliseconds> idleTimeout() const override { return {}; }
+  absl::optional<std::chrono::milliseconds> idleCompactionTimeout() const override { return {}; }
+  std::chrono::milliseconds streamIdleTimeout() const override { return {}; }
+  std::chrono::milliseconds requestTimeout() const override { return {}; }
+  std::chrono::milliseconds delayedCloseTimeout() const override { return {}; }
+  Router::RouteConfigProvider& routeConfigProvider() override { return route_config_provider_; }
+  const std::string& serverName() override { return server_name_; }
+  ConnectionManagerStats& stats() override { return stats_; }
+  ConnectionManagerTracingStats& tracingStats() override { return tracing_stats_; }
+  bool useRemoteAddress() override { return true; }
+  const Http::InternalAddressConfig& internalAddressConfig() const override {
+    return internal_address_config_;
+  }
+  uint32_t xffNumTrustedHops() const override { return 0; }
+  bool skipXffAppend() const override { return false; }
+  const std::string& via() const override { return EMPTY_STRING; }
+  Http::ForwardClientCertType forwardClientCert() override {
+    return Http::ForwardClientCertType::Sanitize;
+  }
+  const std::vector<Http::ClientCertDetailsType>& setCurrentClientCertDetails() const override {
+    return set_current_client_cert_details_;
+  }
+  const Network::Address::Instance& localAddress() override { return local_address_; }
+  const absl::optional<std::string>& userAgent() override { return user_agent_; }
+  const TracingConnectionManagerConfig* tracingConfig() override { return nullptr; }
+  ConnectionManagerListenerStats& listenerStats() override { return listener_stats_; }
+  bool proxy100Continue() const override { return false; }
+  const Http::Http1Settings& http1Settings() const override { return http1_settings_; }
+  RouteCache* routeCache() override { return nullptr; }
+
+  std::list<AccessLog::InstanceSharedPtr> access_logs_;
+  LocalReplyFilterFactory filter_factory_;
+  SlowDateProviderImpl date_provider_;
+  RouteConfigProvider route_config_provider_;
+  std::string server_name_{"envoy"};
+  Stats::IsolatedStoreImpl fake_stats_;
+  ConnectionManagerStats stats_;
+  ConnectionManagerTracingStats tracing_stats_;
+  ConnectionManagerListenerStats listener_stats_;
+  std::vector<Http::ClientCertDetailsType> set_current_client_cert_details_;
+  Network::Address::Ipv4Instance local_address_{"127.0.0.1"};
+  absl::optional<std::string> user_agent_;
+  Http::Http1Settings http1_settings_;
+  Http::DefaultInternalAddressConfig internal_address_config_;
+};
+
+class ConnManagerSpeedTest {
+public:
+  ConnManagerSpeedTest()
+      : api_(Api::createApiForTest(time_system_)), dispatcher_(api_->allocateDispatcher()),
+        config_(time_system_),
+        conn_manager_(config_, drain_close_, random_, http_context_, runtime_, local_info_,
+                      cluster_manager_, nullptr, time_system_) {
+    ON_CALL(filter_callbacks_.connection_, dispatcher()).WillByDefault(ReturnRef(*dispatcher_));
+    filter_callbacks_.connection_.local_address_ =
+        std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1");
+    filter_callbacks_.connection_.remote_address_ =
+        std::make_shared<Network::Address::Ipv4Instance>("10.0.0.1");
+    conn_manager_.initializeReadFilterCallbacks(filter_callbacks_);
+  }
+
+  // Decode a request, and run the event loop so that its stream is deleted.
+  void request() {
+    Buffer::OwnedImpl data("request");
+    conn_manager_.onData(data, false);
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  SpeedTestConfig config_;
+  NiceMock<Network::MockDrainDecision> drain_close_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  Http::ContextImpl http_context_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<Upstream::MockClusterManager> cluster_manager_;
+  NiceMock<Network::MockReadFilterCallbacks> filter_callbacks_;
+  ConnectionManagerImpl conn_manager_;
+};
+
+} // namespace Http
+} // namespace Envoy
+
+static void BM_LocalReply(benchmark::State& state) {
+  Envoy::Http::ConnManagerSpeedTest context;
+  // Warm up the pool, as a worker that has been serving requests would have.
+  context.request();
+
+  Envoy::ObjectPool::flushStatsForTest();
+  const uint64_t hits = Envoy::ObjectPool::hits();
+  const uint64_t misses = Envoy::ObjectPool::misses();
+  for (auto _ : state) {
+    context.request();
+  }
+  Envoy::ObjectPool::flushStatsForTest();
+
+  const double requests = state.iterations();
+  state.counters["pooled_allocs_per_request"] = (Envoy::ObjectPool::hits() - hits) / requests;
+  state.counters["heap_allocs_per_request"] = (Envoy::ObjectPool::misses() - misses) / requests;
+}
+BENCHMARK(BM_LocalReply);
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -35,6 +35,7 @@
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stats/mocks.h"
 #include "test/mocks/tracing/mocks.h"
 #include "test/mocks/upstream/cluster_info.h"
 #include "test/mocks/upstream/mocks.h"
@@ -233,6 +234,9 @@ public:
   bool generateRequestId() override { return true; }
   uint32_t maxRequestHeadersKb() const override { return max_request_headers_kb_; }
   absl::optional<std::chrono::milliseconds> idleTimeout() const override { return idle_timeout_; }
+  absl::optional<std::chrono::milliseconds> idleCompactionTimeout() const override {
+    return idle_compaction_timeout_;
+  }
   std::chrono::milliseconds streamIdleTimeout() const override { return stream_idle_timeout_; }
   std::chrono::milliseconds requestTimeout() const override { return request_timeout_; }
   std::chrono::milliseconds delayedCloseTimeout() const override { return delayed_close_timeout_; }
@@ -257,6 +261,7 @@ public:
   ConnectionManagerListenerStats& listenerStats() override { return listener_stats_; }
   bool proxy100Continue() const override { return proxy_100_continue_; }
   const Http::Http1Settings& http1Settings() const override { return http1_settings_; }
+  RouteCache* routeCache() override { return route_cache_.get(); }
 
   DangerousDeprecatedTestTime test_time_;
   RouteConfigProvider route_config_provider_;
@@ -283,6 +288,7 @@ public:
   absl::optional<std::string> user_agent_;
   uint32_t max_request_headers_kb_{Http::DEFAULT_MAX_REQUEST_HEADERS_KB};
   absl::optional<std::chrono::milliseconds> idle_timeout_;
+  absl::optional<std::chrono::milliseconds> idle_compaction_timeout_;
   std::chrono::milliseconds stream_idle_timeout_{};
   std::chrono::milliseconds request_timeout_{};
   std::chrono::milliseconds delayed_close_timeout_{};
@@ -302,6 +308,7 @@ public:
   ConnectionManagerListenerStats listener_stats_;
   bool proxy_100_continue_ = false;
   Http::Http1Settings http1_settings_;
+  std::unique_ptr<RouteCache> route_cache_;
   NiceMock<Network::MockClientConnection> upstream_conn_; // for websocket tests
   NiceMock<Tcp::ConnectionPool::MockInstance> conn_pool_; // for websocket tests
 
@@ -376,6 +383,41 @@ TEST_F(HttpConnectionManagerImplTest, HeaderOnlyRequestAndResponse) {
   EXPECT_EQ(1U, listener_stats_.downstream_rq_completed_.value());
 }
 
+TEST_F(HttpConnectionManagerImplTest, PipelinedRequests) {
+  http1_settings_.max_pipelined_requests_ = 2;
+  setup(false, "");
+
+  std::shared_ptr<MockStreamDecoderFilter> filter(new NiceMock<MockStreamDecoderFilter>());
+  EXPECT_CALL(*filter, decodeHeaders(_, true))
+      .Times(2)
+      .WillRepeatedly(Return(FilterHeadersStatus::StopIteration));
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(filter);
+      }));
+
+  // Each dispatch decodes a headers only request, which consumes a byte of the input.
+  NiceMock<MockStreamEncoder> encoder;
+  EXPECT_CALL(*codec_, dispatch(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data) -> void {
+        StreamDecoder* decoder = &conn_manager_->newStream(encoder);
+        HeaderMapPtr headers{
+            new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+        decoder->decodeHeaders(std::move(headers), true);
+        data.drain(1);
+      }));
+
+  // The second request is dispatched while the first one waits for its response, and the third
+  // one is left in the buffer until a response completes.
+  EXPECT_CALL(filter_callbacks_.connection_, readDisable(true));
+  Buffer::OwnedImpl fake_input("123");
+  conn_manager_->onData(fake_input, false);
+  EXPECT_EQ(1U, fake_input.length());
+  EXPECT_EQ(2U, stats_.named_.downstream_rq_active_.value());
+}
+
 TEST_F(HttpConnectionManagerImplTest, 100ContinueResponse) {
   proxy_100_continue_ = true;
   setup(false, "envoy-custom-server", false);
@@ -574,7 +616,7 @@ TEST_F(HttpConnectionManagerImplTest, StartAndFinishSpanNormalFlow) {
 
   // Treat request as internal, otherwise x-request-id header will be overwritten.
   use_remote_address_ = false;
-  EXPECT_CALL(random_, uuid()).Times(0);
+  EXPECT_CALL(random_, uuid(_)).Times(0);
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -639,7 +681,7 @@ TEST_F(HttpConnectionManagerImplTest, StartAndFinishSpanNormalFlowIngressDecorat
 
   // Treat request as internal, otherwise x-request-id header will be overwritten.
   use_remote_address_ = false;
-  EXPECT_CALL(random_, uuid()).Times(0);
+  EXPECT_CALL(random_, uuid(_)).Times(0);
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -701,7 +743,7 @@ TEST_F(HttpConnectionManagerImplTest, StartAndFinishSpanNormalFlowIngressDecorat
 
   // Treat request as internal, otherwise x-request-id header will be overwritten.
   use_remote_address_ = false;
-  EXPECT_CALL(random_, uuid()).Times(0);
+  EXPECT_CALL(random_, uuid(_)).Times(0);
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -734,6 +776,106 @@ TEST_F(HttpConnectionManagerImplTest, StartAndFinishSpanNormalFlowIngressDecorat
   conn_manager_->onData(fake_input, false);
 }
 
+// The span of a request that was not sampled when it started is kept when the request ends with
+// an error.
+TEST_F(HttpConnectionManagerImplTest, TailSampledSpanOnError) {
+  setup(false, "");
+  tracing_config_ = std::make_unique<TracingConnectionManagerConfig>(TracingConnectionManagerConfig{
+      Tracing::OperationName::Ingress, {}, 100, 10000, 100, false,
+      TracingTailSamplingConfig{{}, true, {}}});
+
+  NiceMock<Tracing::MockSpan>* span = new NiceMock<Tracing::MockSpan>();
+  EXPECT_CALL(tracer_, startSpan_(_, _, _, _))
+      .WillOnce(
+          Invoke([&](const Tracing::Config&, const HeaderMap&, const StreamInfo::StreamInfo&,
+                     const Tracing::Decision decision) -> Tracing::Span* {
+            EXPECT_FALSE(decision.traced);
+            return span;
+          }));
+  EXPECT_CALL(*route_config_provider_.route_config_->route_, decorator())
+      .WillRepeatedly(Return(nullptr));
+  {
+    InSequence s;
+    EXPECT_CALL(*span, setSampled(true));
+    EXPECT_CALL(*span, finishSpan());
+  }
+  EXPECT_CALL(runtime_.snapshot_, featureEnabled("tracing.global_enabled", 100, _))
+      .WillOnce(Return(true));
+
+  std::shared_ptr<MockStreamDecoderFilter> filter(new NiceMock<MockStreamDecoderFilter>());
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillRepeatedly(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(filter);
+      }));
+
+  use_remote_address_ = false;
+  NiceMock<MockStreamEncoder> encoder;
+  EXPECT_CALL(*codec_, dispatch(_)).WillRepeatedly(Invoke([&](Buffer::Instance& data) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(encoder);
+    // The request id is not traceable.
+    HeaderMapPtr headers{
+        new TestHeaderMapImpl{{":method", "GET"},
+                              {":authority", "host"},
+                              {":path", "/"},
+                              {"x-request-id", "125a4afb-6f55-44ba-ad80-413f09f48a28"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+
+    HeaderMapPtr response_headers{new TestHeaderMapImpl{{":status", "503"}}};
+    filter->callbacks_->encodeHeaders(std::move(response_headers), true);
+    data.drain(4);
+  }));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  EXPECT_EQ(1UL, tracing_stats_.not_traceable_.value());
+  EXPECT_EQ(1UL, tracing_stats_.tail_sampled_.value());
+}
+
+// The span of a request that does not match the tail sampling rules is not kept.
+TEST_F(HttpConnectionManagerImplTest, TailSamplingKeepsNoSpanWithoutMatch) {
+  setup(false, "");
+  tracing_config_ = std::make_unique<TracingConnectionManagerConfig>(TracingConnectionManagerConfig{
+      Tracing::OperationName::Ingress, {}, 100, 10000, 100, false,
+      TracingTailSamplingConfig{{}, true, {}}});
+
+  NiceMock<Tracing::MockSpan>* span = new NiceMock<Tracing::MockSpan>();
+  EXPECT_CALL(tracer_, startSpan_(_, _, _, _)).WillOnce(Return(span));
+  EXPECT_CALL(*route_config_provider_.route_config_->route_, decorator())
+      .WillRepeatedly(Return(nullptr));
+  EXPECT_CALL(*span, setSampled(_)).Times(0);
+  EXPECT_CALL(*span, finishSpan());
+  EXPECT_CALL(runtime_.snapshot_, featureEnabled("tracing.global_enabled", 100, _))
+      .WillOnce(Return(true));
+
+  std::shared_ptr<MockStreamDecoderFilter> filter(new NiceMock<MockStreamDecoderFilter>());
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillRepeatedly(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(filter);
+      }));
+
+  use_remote_address_ = false;
+  NiceMock<MockStreamEncoder> encoder;
+  EXPECT_CALL(*codec_, dispatch(_)).WillRepeatedly(Invoke([&](Buffer::Instance& data) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(encoder);
+    HeaderMapPtr headers{
+        new TestHeaderMapImpl{{":method", "GET"},
+                              {":authority", "host"},
+                              {":path", "/"},
+                              {"x-request-id", "125a4afb-6f55-44ba-ad80-413f09f48a28"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+
+    HeaderMapPtr response_headers{new TestHeaderMapImpl{{":status", "200"}}};
+    filter->callbacks_->encodeHeaders(std::move(response_headers), true);
+    data.drain(4);
+  }));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  EXPECT_EQ(0UL, tracing_stats_.tail_sampled_.value());
+}
+
 TEST_F(HttpConnectionManagerImplTest, StartAndFinishSpanNormalFlowEgressDecorator) {
   setup(false, "");
   tracing_config_ = std::make_unique<TracingConnectionManagerConfig>(TracingConnectionManagerConfig{
@@ -768,7 +910,7 @@ TEST_F(HttpConnectionManagerImplTest, StartAndFinishSpanNormalFlowEgressDecorato
 
   // Treat request as internal, otherwise x-request-id header will be overwritten.
   use_remote_address_ = false;
-  EXPECT_CALL(random_, uuid()).Times(0);
+  EXPECT_CALL(random_, uuid(_)).Times(0);
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -836,7 +978,7 @@ TEST_F(HttpConnectionManagerImplTest, StartAndFinishSpanNormalFlowEgressDecorato
 
   // Treat request as internal, otherwise x-request-id header will be overwritten.
   use_remote_address_ = false;
-  EXPECT_CALL(random_, uuid()).Times(0);
+  EXPECT_CALL(random_, uuid(_)).Times(0);
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -879,7 +1021,7 @@ TEST_F(HttpConnectionManagerImplTest,
 
   // Treat request as internal, otherwise x-request-id header will be overwritten.
   use_remote_address_ = false;
-  EXPECT_CALL(random_, uuid()).Times(0);
+  EXPECT_CALL(random_, uuid(_)).Times(0);
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -2172,6 +2314,130 @@ TEST_F(HttpConnectionManagerImplTest, IdleTimeout) {
   EXPECT_EQ(1U, stats_.named_.downstream_cx_idle_timeout_.value());
 }
 
+TEST_F(HttpConnectionManagerImplTest, IdleCompactionReleasesHttp1Codec) {
+  idle_compaction_timeout_ = (std::chrono::milliseconds(10));
+  Event::MockTimer* compaction_timer = setUpTimer();
+  EXPECT_CALL(*compaction_timer, enableTimer(_));
+  setup(false, "");
+
+  // The timer does nothing before the codec exists.
+  compaction_timer->callback_();
+  EXPECT_EQ(0U, stats_.named_.downstream_cx_idle_compaction_.value());
+
+  MockStreamDecoderFilter* filter = new NiceMock<MockStreamDecoderFilter>();
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillRepeatedly(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(StreamDecoderFilterSharedPtr{filter});
+      }));
+
+  NiceMock<MockStreamEncoder> encoder;
+  auto dispatch_request = [&](Buffer::Instance&) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(encoder);
+    HeaderMapPtr headers{
+        new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+  };
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke(dispatch_request));
+  EXPECT_CALL(*filter, decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  EXPECT_CALL(*compaction_timer, disableTimer());
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  EXPECT_CALL(*compaction_timer, enableTimer(_));
+  HeaderMapPtr response_headers{new TestHeaderMapImpl{{":status", "200"}}};
+  filter->callbacks_->encodeHeaders(std::move(response_headers), true);
+
+  compaction_timer->callback_();
+  EXPECT_EQ(1U, stats_.named_.downstream_cx_idle_compaction_.value());
+  EXPECT_EQ(1U, stats_.named_.downstream_cx_idle_compacted_active_.value());
+  EXPECT_EQ(1U, stats_.named_.downstream_cx_http1_active_.value());
+
+  // The next request re-creates the codec without counting the connection again.
+  filter = new NiceMock<MockStreamDecoderFilter>();
+  codec_ = new NiceMock<MockServerConnection>();
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke(dispatch_request));
+  EXPECT_CALL(*filter, decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  EXPECT_CALL(*compaction_timer, disableTimer());
+
+  Buffer::OwnedImpl more_input("1234");
+  conn_manager_->onData(more_input, false);
+  EXPECT_EQ(1U, stats_.named_.downstream_cx_http1_total_.value());
+  EXPECT_EQ(1U, stats_.named_.downstream_cx_http1_active_.value());
+  EXPECT_EQ(0U, stats_.named_.downstream_cx_idle_compacted_active_.value());
+
+  EXPECT_CALL(*compaction_timer, disableTimer());
+  filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
+}
+
+TEST_F(HttpConnectionManagerImplTest, IdleCompactionKeepsHttp2Codec) {
+  idle_compaction_timeout_ = (std::chrono::milliseconds(10));
+  Event::MockTimer* compaction_timer = setUpTimer();
+  EXPECT_CALL(*compaction_timer, enableTimer(_));
+  setup(false, "");
+  ON_CALL(*codec_, protocol()).WillByDefault(Return(Protocol::Http2));
+
+  EXPECT_CALL(*codec_, dispatch(_));
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  compaction_timer->callback_();
+  EXPECT_EQ(0U, stats_.named_.downstream_cx_idle_compaction_.value());
+  EXPECT_EQ(1U, stats_.named_.downstream_cx_http2_active_.value());
+}
+
+TEST_F(HttpConnectionManagerImplTest, FilterTimingStats) {
+  setup(false, "");
+
+  NiceMock<Stats::MockStore> timing_store;
+  FilterTimingStats timing_stats{ALL_HTTP_FILTER_TIMING_STATS(POOL_HISTOGRAM(timing_store))};
+  auto& decode_headers_us = dynamic_cast<Stats::MockHistogram&>(timing_stats.decode_headers_us_);
+  auto& decode_stopped_us = dynamic_cast<Stats::MockHistogram&>(timing_stats.decode_stopped_us_);
+  auto& encode_headers_us = dynamic_cast<Stats::MockHistogram&>(timing_stats.encode_headers_us_);
+
+  // Only the filters added while the timing stats are set are timed.
+  MockStreamDecoderFilter* timed_filter = new NiceMock<MockStreamDecoderFilter>();
+  MockStreamEncoderFilter* timed_encoder_filter = new NiceMock<MockStreamEncoderFilter>();
+  MockStreamDecoderFilter* filter = new NiceMock<MockStreamDecoderFilter>();
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.setFilterTimingStats(&timing_stats);
+        callbacks.addStreamDecoderFilter(StreamDecoderFilterSharedPtr{timed_filter});
+        callbacks.addStreamEncoderFilter(StreamEncoderFilterSharedPtr{timed_encoder_filter});
+        callbacks.setFilterTimingStats(nullptr);
+        callbacks.addStreamDecoderFilter(StreamDecoderFilterSharedPtr{filter});
+      }));
+
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance&) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+    HeaderMapPtr headers{
+        new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+  }));
+  EXPECT_CALL(*timed_filter, decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  EXPECT_CALL(decode_headers_us, recordValue(_));
+  EXPECT_CALL(decode_stopped_us, recordValue(_)).Times(0);
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  // The time stopped is recorded once the filter continues.
+  EXPECT_CALL(decode_stopped_us, recordValue(_));
+  EXPECT_CALL(*filter, decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  timed_filter->callbacks_->continueDecoding();
+
+  EXPECT_CALL(*timed_encoder_filter, encodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::Continue));
+  EXPECT_CALL(encode_headers_us, recordValue(_));
+  EXPECT_CALL(response_encoder_, encodeHeaders(_, true));
+  HeaderMapPtr response_headers{new TestHeaderMapImpl{{":status", "200"}}};
+  filter->callbacks_->encodeHeaders(std::move(response_headers), true);
+}
+
 TEST_F(HttpConnectionManagerImplTest, IntermediateBufferingEarlyResponse) {
   InSequence s;
   setup(false, "");
@@ -2740,6 +3006,57 @@ TEST_F(HttpConnectionManagerImplTest, FilterClearRouteCache) {
   conn_manager_->onData(fake_input, false);
 }
 
+TEST_F(HttpConnectionManagerImplTest, RouteCache) {
+  setup(false, "");
+  route_cache_ = std::make_unique<RouteCache>(10);
+
+  std::vector<std::string> paths{"/", "/", "/other"};
+  size_t request = 0;
+  EXPECT_CALL(*codec_, dispatch(_)).Times(3).WillRepeatedly(Invoke([&](Buffer::Instance&) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+    HeaderMapPtr headers{new TestHeaderMapImpl{
+        {":authority", "host"}, {":path", paths[request++]}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+  }));
+
+  // The second request for "/" is served from the cache.
+  ON_CALL(*route_config_provider_.route_config_->route_, cacheable()).WillByDefault(Return(true));
+  EXPECT_CALL(*route_config_provider_.route_config_, route(_, _)).Times(2);
+
+  for (size_t i = 0; i < paths.size(); i++) {
+    Buffer::OwnedImpl fake_input("1234");
+    conn_manager_->onData(fake_input, false);
+  }
+
+  EXPECT_EQ(1U, stats_.named_.route_cache_hit_.value());
+  EXPECT_EQ(2U, stats_.named_.route_cache_miss_.value());
+  EXPECT_EQ(2U, route_cache_->size());
+}
+
+TEST_F(HttpConnectionManagerImplTest, RouteCacheSkipsUncacheableRoutes) {
+  setup(false, "");
+  route_cache_ = std::make_unique<RouteCache>(10);
+
+  EXPECT_CALL(*codec_, dispatch(_)).Times(2).WillRepeatedly(Invoke([&](Buffer::Instance&) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+    HeaderMapPtr headers{
+        new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+  }));
+
+  ON_CALL(*route_config_provider_.route_config_->route_, cacheable()).WillByDefault(Return(false));
+  EXPECT_CALL(*route_config_provider_.route_config_, route(_, _)).Times(2);
+
+  for (size_t i = 0; i < 2; i++) {
+    Buffer::OwnedImpl fake_input("1234");
+    conn_manager_->onData(fake_input, false);
+  }
+
+  EXPECT_EQ(0U, stats_.named_.route_cache_hit_.value());
+  EXPECT_EQ(2U, stats_.named_.route_cache_miss_.value());
+  EXPECT_EQ(0U, route_cache_->size());
+}
+
 TEST_F(HttpConnectionManagerImplTest, UpstreamWatermarkCallbacks) {
   setup(false, "");
   setUpEncoderAndDecoder();
@@ -3861,6 +4178,48 @@ TEST_F(HttpConnectionManagerImplTest, DisableKeepAliveWhenOverloaded) {
   EXPECT_EQ(1U, stats_.named_.downstream_cx_overload_disable_keepalive_.value());
 }
 
+TEST_F(HttpConnectionManagerImplTest, RefuseHttp2StreamsWhenOverloaded) {
+  setup(false, "");
+  ON_CALL(*codec_, protocol()).WillByDefault(Return(Protocol::Http2));
+  ON_CALL(runtime_.snapshot_, getInteger("overload.reduced_http2_max_concurrent_streams", 100))
+      .WillByDefault(Return(1));
+
+  overload_manager_.overload_state_.setState(
+      Server::OverloadActionNames::get().ReduceHttp2MaxConcurrentStreams,
+      Server::OverloadActionState::Active);
+
+  std::shared_ptr<MockStreamDecoderFilter> filter(new NiceMock<MockStreamDecoderFilter>());
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(StreamDecoderFilterSharedPtr{filter});
+      }));
+
+  // The first stream is within the reduced limit and the second one is refused.
+  NiceMock<MockStreamEncoder> refused_encoder;
+  EXPECT_CALL(refused_encoder.stream_, resetStream(StreamResetReason::LocalRefusedStreamReset));
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+    HeaderMapPtr headers{
+        new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+
+    decoder = &conn_manager_->newStream(refused_encoder);
+    headers.reset(
+        new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}});
+    decoder->decodeHeaders(std::move(headers), true);
+    data.drain(4);
+  }));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+  EXPECT_EQ(1U, stats_.named_.downstream_rq_overload_refused_stream_.value());
+  EXPECT_EQ(0U, stats_.named_.downstream_rq_overload_close_.value());
+
+  // The remaining stream is reset when the connection closes.
+  EXPECT_CALL(response_encoder_.stream_, resetStream(_));
+  filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
+}
+
 TEST_F(HttpConnectionManagerImplTest, OverlyLongHeadersRejected) {
   setup(false, "");
 
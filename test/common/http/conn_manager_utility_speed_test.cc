@@ -0,0 +1,159 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures the per request cost of ConnectionManagerUtility::mutateRequestHeaders(), which sets up
+// and sanitizes the headers of every request the connection manager decodes.
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/empty_string.h"
+#include "common/http/conn_manager_utility.h"
+#include "common/http/header_map_impl.h"
+#include "common/network/address_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/router/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Http {
+
+// Only the parts of the config that mutateRequestHeaders() reads are meaningful.
+class UtilitySpeedTestConfig : public ConnectionManagerConfig {
+public:
+  UtilitySpeedTestConfig()
+      : stats_{{ALL_HTTP_CONN_MAN_STATS(POOL_COUNTER(fake_stats_), POOL_GAUGE(fake_stats_),
+                                        POOL_HISTOGRAM(fake_stats_))},
+               "",
+               fake_stats_},
+        tracing_stats_{CONN_MAN_TRACING_STATS(POOL_COUNTER(fake_stats_))},
+        listener_stats_{CONN_MAN_LISTENER_STATS(POOL_COUNTER(fake_stats_))} {}
+
+  // Http::ConnectionManagerConfig
+  const std::list<AccessLog::InstanceSharedPtr>& accessLogs() override { return access_logs_; }
+  ServerConnectionPtr createCodec(Network::Connection&, const Buffer::Instance&,
+                                  ServerConnectionCallbacks&) override {
+    return nullptr;
+  }
+  DateProvider& dateProvider() override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+  std::chrono::milliseconds drainTimeout() override { return std::chrono::milliseconds(100); }
+  FilterChainFactory& filterFactory() override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+  bool generateRequestId() override { return false; }
+  uint32_t maxRequestHeadersKb() const override { return Http::DEFAULT_MAX_REQUEST_HEADERS_KB; }
+  absl::optional<std::chrono::milliseconds> idleTimeout() const override { return {}; }
+  absl::optional<std::chrono::milliseconds> idleCompactionTimeout() const override { return {}; }
+  std::chrono::milliseconds streamIdleTimeout() const override { return {}; }
+  std::chrono::milliseconds requestTimeout() const override { return {}; }
+  std::chrono::milliseconds delayedCloseTimeout() const override { return {}; }
+  Router::RouteConfigProvider& routeConfigProvider() override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+  const std::string& serverName() override { return server_name_; }
+  ConnectionManagerStats& stats() override { return stats_; }
+  ConnectionManagerTracingStats& tracingStats() override { return tracing_stats_; }
+  bool useRemoteAddress() override { return true; }
+  const Http::InternalAddressConfig& internalAddressConfig() const override {
+    return internal_address_config_;
+  }
+  uint32_t xffNumTrustedHops() const override { return 0; }
+  bool skipXffAppend() const override { return false; }
+  const std::string& via() const override { return EMPTY_STRING; }
+  Http::ForwardClientCertType forwardClientCert() override {
+    return Http::ForwardClientCertType::Sanitize;
+  }
+  const std::vector<Http::ClientCertDetailsType>& setCurrentClientCertDetails() const override {
+    return set_current_client_cert_details_;
+  }
+  const Network::Address::Instance& localAddress() override { return local_address_; }
+  const absl::optional<std::string>& userAgent() override { return user_agent_; }
+  const TracingConnectionManagerConfig* tracingConfig() override { return nullptr; }
+  ConnectionManagerListenerStats& listenerStats() override { return listener_stats_; }
+  bool proxy100Continue() const override { return false; }
+  const Http::Http1Settings& http1Settings() const override { return http1_settings_; }
+  RouteCache* routeCache() override { return nullptr; }
+
+  std::list<AccessLog::InstanceSharedPtr> access_logs_;
+  std::string server_name_{"envoy"};
+  Stats::IsolatedStoreImpl fake_stats_;
+  ConnectionManagerStats stats_;
+  ConnectionManagerTracingStats tracing_stats_;
+  ConnectionManagerListenerStats listener_stats_;
+  std::vector<Http::ClientCertDetailsType> set_current_client_cert_details_;
+  Network::Address::Ipv4Instance local_address_{"127.0.0.1"};
+  absl::optional<std::string> user_agent_;
+  Http::Http1Settings http1_settings_;
+  Http::DefaultInternalAddressConfig internal_address_config_;
+};
+
+class ConnManagerUtilitySpeedTest {
+public:
+  // An external request, so that the internal only headers are removed.
+  ConnManagerUtilitySpeedTest(uint32_t internal_only_headers) {
+    connection_.remote_address_ = std::make_shared<Network::Address::Ipv4Instance>("50.0.0.1");
+    for (uint32_t i = 0; i < internal_only_headers; i++) {
+      route_config_.internal_only_headers_.emplace_back("x-internal-only-" + std::to_string(i));
+    }
+  }
+
+  void mutateRequestHeaders(HeaderMap& request_headers) {
+    ConnectionManagerUtility::mutateRequestHeaders(request_headers, connection_, config_,
+                                                   route_config_, random_, runtime_, local_info_);
+  }
+
+  UtilitySpeedTestConfig config_;
+  NiceMock<Network::MockConnection> connection_;
+  NiceMock<Router::MockConfig> route_config_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+};
+
+} // namespace Http
+} // namespace Envoy
+
+// Set up the headers of a typical browser request. The Arg is the number of configured internal
+// only headers, none of which are in the request.
+static void BM_MutateRequestHeaders(benchmark::State& state) {
+  Envoy::Http::ConnManagerUtilitySpeedTest context(state.range(0));
+  const Envoy::Http::TestHeaderMapImpl request{
+      {":method", "GET"},
+      {":scheme", "http"},
+      {":authority", "www.example.com"},
+      {":path", "/index.html"},
+      {"user-agent", "Mozilla/5.0 (X11; Linux x86_64)"},
+      {"accept", "text/html,application/xhtml+xml"},
+      {"accept-language", "en-US,en;q=0.5"},
+      {"accept-encoding", "gzip, deflate"},
+      {"cookie", "session=0123456789abcdef"},
+      {"dnt", "1"},
+      {"upgrade-insecure-requests", "1"},
+      {"cache-control", "max-age=0"},
+      {"x-forwarded-for", "10.0.0.1"},
+      {"x-envoy-retry-on", "5xx"},
+      {"x-request-id", "e8b4b5e5-55d1-4c2e-ae8d-3a0b6f9c1d2e"}};
+  for (auto _ : state) {
+    Envoy::Http::HeaderMapImpl headers(request);
+    context.mutateRequestHeaders(headers);
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(BM_MutateRequestHeaders)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -12,6 +12,7 @@
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
 
@@ -20,6 +21,7 @@
 
 using testing::_;
 using testing::InSequence;
+using testing::Invoke;
 using testing::Matcher;
 using testing::NiceMock;
 using testing::Return;
@@ -52,6 +54,7 @@ public:
   MOCK_METHOD0(generateRequestId, bool());
   MOCK_CONST_METHOD0(maxRequestHeadersKb, uint32_t());
   MOCK_CONST_METHOD0(idleTimeout, absl::optional<std::chrono::milliseconds>());
+  MOCK_CONST_METHOD0(idleCompactionTimeout, absl::optional<std::chrono::milliseconds>());
   MOCK_CONST_METHOD0(streamIdleTimeout, std::chrono::milliseconds());
   MOCK_CONST_METHOD0(requestTimeout, std::chrono::milliseconds());
   MOCK_CONST_METHOD0(delayedCloseTimeout, std::chrono::milliseconds());
@@ -76,6 +79,7 @@ public:
   MOCK_METHOD0(listenerStats, ConnectionManagerListenerStats&());
   MOCK_CONST_METHOD0(proxy100Continue, bool());
   MOCK_CONST_METHOD0(http1Settings, const Http::Http1Settings&());
+  MOCK_METHOD0(routeCache, RouteCache*());
 
   std::unique_ptr<Http::InternalAddressConfig> internal_address_config_ =
       std::make_unique<DefaultInternalAddressConfig>();
@@ -336,7 +340,7 @@ TEST_F(ConnectionManagerUtilityTest, InternalServiceForceTrace) {
     // Internal request, make traceable.
     TestHeaderMapImpl headers{
         {"x-forwarded-for", "10.0.0.1"}, {"x-request-id", uuid}, {"x-envoy-force-trace", "true"}};
-    EXPECT_CALL(random_, uuid()).Times(0);
+    EXPECT_CALL(random_, uuid(_)).Times(0);
     EXPECT_CALL(runtime_.snapshot_, featureEnabled("tracing.global_enabled", 100, _))
         .WillOnce(Return(true));
 
@@ -350,7 +354,7 @@ TEST_F(ConnectionManagerUtilityTest, InternalServiceForceTrace) {
     // Not internal request, force trace header should be cleaned.
     TestHeaderMapImpl headers{
         {"x-forwarded-for", "34.0.0.1"}, {"x-request-id", uuid}, {"x-envoy-force-trace", "true"}};
-    EXPECT_CALL(random_, uuid()).Times(0);
+    EXPECT_CALL(random_, uuid(_)).Times(0);
     EXPECT_CALL(runtime_.snapshot_, featureEnabled("tracing.global_enabled", 100, _))
         .WillOnce(Return(true));
 
@@ -371,7 +375,7 @@ TEST_F(ConnectionManagerUtilityTest, EdgeRequestRegenerateRequestIdAndWipeDownst
   {
     TestHeaderMapImpl headers{{"x-envoy-downstream-service-cluster", "foo"},
                               {"x-request-id", "will_be_regenerated"}};
-    EXPECT_CALL(random_, uuid());
+    EXPECT_CALL(random_, uuid(_));
 
     EXPECT_CALL(runtime_.snapshot_, featureEnabled("tracing.client_enabled", Matcher<uint64_t>(_)))
         .Times(0);
@@ -388,7 +392,7 @@ TEST_F(ConnectionManagerUtilityTest, EdgeRequestRegenerateRequestIdAndWipeDownst
     TestHeaderMapImpl headers{{"x-envoy-downstream-service-cluster", "foo"},
                               {"x-request-id", "will_be_regenerated"},
                               {"x-client-trace-id", "trace-id"}};
-    EXPECT_CALL(random_, uuid());
+    EXPECT_CALL(random_, uuid(_));
     EXPECT_CALL(runtime_.snapshot_, featureEnabled("tracing.client_enabled", 100))
         .WillOnce(Return(false));
 
@@ -403,7 +407,7 @@ TEST_F(ConnectionManagerUtilityTest, EdgeRequestRegenerateRequestIdAndWipeDownst
     TestHeaderMapImpl headers{{"x-envoy-downstream-service-cluster", "foo"},
                               {"x-request-id", "will_be_regenerated"},
                               {"x-client-trace-id", "trace-id"}};
-    EXPECT_CALL(random_, uuid());
+    EXPECT_CALL(random_, uuid(_));
     EXPECT_CALL(runtime_.snapshot_, featureEnabled("tracing.client_enabled", 100))
         .WillOnce(Return(true));
 
@@ -467,18 +471,20 @@ TEST_F(ConnectionManagerUtilityTest, UserAgentSetNoIncomingUserAgent) {
 TEST_F(ConnectionManagerUtilityTest, RequestIdGeneratedWhenItsNotPresent) {
   {
     TestHeaderMapImpl headers{{":authority", "host"}, {":path", "/"}};
-    EXPECT_CALL(random_, uuid()).WillOnce(Return("generated_uuid"));
+    EXPECT_CALL(random_, uuid(_));
 
     EXPECT_EQ((MutateRequestRet{"10.0.0.3:50000", false}),
               callMutateRequestHeaders(headers, Protocol::Http2));
-    EXPECT_EQ("generated_uuid", headers.get_("x-request-id"));
+    EXPECT_EQ(random_.uuid_, headers.get_("x-request-id"));
   }
 
   {
     Runtime::RandomGeneratorImpl rand;
     TestHeaderMapImpl headers{{"x-client-trace-id", "trace-id"}};
     const std::string uuid = rand.uuid();
-    EXPECT_CALL(random_, uuid()).WillOnce(Return(uuid));
+    EXPECT_CALL(random_, uuid(_)).WillOnce(Invoke([&uuid](char* buffer) {
+      memcpy(buffer, uuid.data(), uuid.size());
+    }));
 
     EXPECT_EQ((MutateRequestRet{"10.0.0.3:50000", false}),
               callMutateRequestHeaders(headers, Protocol::Http2));
@@ -492,7 +498,7 @@ TEST_F(ConnectionManagerUtilityTest, DoNotOverrideRequestIdIfPresentWhenInternal
   connection_.remote_address_ = std::make_shared<Network::Address::Ipv4Instance>("10.0.0.1");
   ON_CALL(config_, useRemoteAddress()).WillByDefault(Return(true));
   TestHeaderMapImpl headers{{"x-request-id", "original_request_id"}};
-  EXPECT_CALL(random_, uuid()).Times(0);
+  EXPECT_CALL(random_, uuid(_)).Times(0);
 
   EXPECT_EQ((MutateRequestRet{"10.0.0.1:0", true}),
             callMutateRequestHeaders(headers, Protocol::Http2));
@@ -504,11 +510,11 @@ TEST_F(ConnectionManagerUtilityTest, OverrideRequestIdForExternalRequests) {
   connection_.remote_address_ = std::make_shared<Network::Address::Ipv4Instance>("134.2.2.11");
   ON_CALL(config_, useRemoteAddress()).WillByDefault(Return(true));
   TestHeaderMapImpl headers{{"x-request-id", "original"}};
-  EXPECT_CALL(random_, uuid()).WillOnce(Return("override"));
+  EXPECT_CALL(random_, uuid(_));
 
   EXPECT_EQ((MutateRequestRet{"134.2.2.11:0", false}),
             callMutateRequestHeaders(headers, Protocol::Http2));
-  EXPECT_EQ("override", headers.get_("x-request-id"));
+  EXPECT_EQ(random_.uuid_, headers.get_("x-request-id"));
 }
 
 // A request that uses remote address and is from an external address should be treated as an
@@ -549,6 +555,27 @@ TEST_F(ConnectionManagerUtilityTest, ExternalAddressExternalRequestUseRemote) {
   EXPECT_FALSE(headers.has("custom_header"));
 }
 
+// All the internal only headers, including repeated ones, are removed from an external request.
+TEST_F(ConnectionManagerUtilityTest, ExternalRequestMultipleInternalOnlyHeaders) {
+  connection_.remote_address_ = std::make_shared<Network::Address::Ipv4Instance>("50.0.0.1");
+  ON_CALL(config_, useRemoteAddress()).WillByDefault(Return(true));
+  route_config_.internal_only_headers_.push_back(LowerCaseString("x-internal-1"));
+  route_config_.internal_only_headers_.push_back(LowerCaseString("x-internal-2"));
+  route_config_.internal_only_headers_.push_back(LowerCaseString("content-type"));
+  TestHeaderMapImpl headers{{"x-internal-1", "foo"},
+                            {"x-external", "foo"},
+                            {"x-internal-2", "foo"},
+                            {"content-type", "text/plain"},
+                            {"x-internal-1", "bar"}};
+
+  EXPECT_EQ((MutateRequestRet{"50.0.0.1:0", false}),
+            callMutateRequestHeaders(headers, Protocol::Http2));
+  EXPECT_FALSE(headers.has("x-internal-1"));
+  EXPECT_FALSE(headers.has("x-internal-2"));
+  EXPECT_EQ(nullptr, headers.ContentType());
+  EXPECT_EQ("foo", headers.get_("x-external"));
+}
+
 // A request that is from an external address, but does not use remote address, should pull the
 // address from XFF.
 TEST_F(ConnectionManagerUtilityTest, ExternalAddressExternalRequestDontUseRemote) {
@@ -1054,7 +1081,7 @@ TEST_F(ConnectionManagerUtilityTest, ForcedTracedWhenGlobalSet) {
   TestHeaderMapImpl headers{{"x-forwarded-for", "10.0.0.1"},
                             {"x-request-id", "125a4afb-6f55-44ba-ad80-413f09f48a28"},
                             {"x-envoy-force-trace", "true"}};
-  EXPECT_CALL(random_, uuid()).Times(0);
+  EXPECT_CALL(random_, uuid(_)).Times(0);
   EXPECT_CALL(runtime_.snapshot_, featureEnabled("tracing.global_enabled", 100, _))
       .WillOnce(Return(true));
 
@@ -1070,7 +1097,7 @@ TEST_F(ConnectionManagerUtilityTest, NoTraceWhenForcedTracedButGlobalNotSet) {
   TestHeaderMapImpl headers{{"x-forwarded-for", "10.0.0.1"},
                             {"x-request-id", "125a4afb-6f55-44ba-ad80-413f09f48a28"},
                             {"x-envoy-force-trace", "true"}};
-  EXPECT_CALL(random_, uuid()).Times(0);
+  EXPECT_CALL(random_, uuid(_)).Times(0);
   EXPECT_CALL(runtime_.snapshot_, featureEnabled("tracing.global_enabled", 100, _))
       .WillOnce(Return(false));
 
@@ -1101,5 +1128,48 @@ TEST_F(ConnectionManagerUtilityTest, RemovesProxyResponseHeaders) {
   EXPECT_FALSE(response_headers.has("proxy-connection"));
 }
 
+TEST(ConnectionManagerUtilityTailSamplingTest, Errors) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  const TracingTailSamplingConfig config{{}, true, {}};
+
+  stream_info.response_code_ = 200;
+  EXPECT_FALSE(ConnectionManagerUtility::isTailSampled(config, nullptr, stream_info));
+  stream_info.response_code_ = 503;
+  EXPECT_TRUE(ConnectionManagerUtility::isTailSampled(config, nullptr, stream_info));
+  stream_info.response_code_.reset();
+  EXPECT_TRUE(ConnectionManagerUtility::isTailSampled(config, nullptr, stream_info));
+  EXPECT_FALSE(ConnectionManagerUtility::isTailSampled({{}, false, {}}, nullptr, stream_info));
+}
+
+TEST(ConnectionManagerUtilityTailSamplingTest, LatencyThreshold) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  stream_info.response_code_ = 200;
+  const TracingTailSamplingConfig config{std::chrono::milliseconds(100), false, {}};
+
+  stream_info.end_time_ = std::chrono::milliseconds(100);
+  EXPECT_FALSE(ConnectionManagerUtility::isTailSampled(config, nullptr, stream_info));
+  stream_info.end_time_ = std::chrono::milliseconds(101);
+  EXPECT_TRUE(ConnectionManagerUtility::isTailSampled(config, nullptr, stream_info));
+}
+
+TEST(ConnectionManagerUtilityTailSamplingTest, RequestHeaders) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  stream_info.response_code_ = 200;
+  envoy::api::v2::route::HeaderMatcher matcher;
+  matcher.set_name("x-debug");
+  matcher.set_exact_match("true");
+  const TracingTailSamplingConfig config{{}, false, {HeaderUtility::HeaderData(matcher)}};
+
+  TestHeaderMapImpl debug_headers{{"x-debug", "true"}};
+  TestHeaderMapImpl other_headers{{"x-debug", "false"}};
+  EXPECT_TRUE(ConnectionManagerUtility::isTailSampled(config, &debug_headers, stream_info));
+  EXPECT_FALSE(ConnectionManagerUtility::isTailSampled(config, &other_headers, stream_info));
+  EXPECT_FALSE(ConnectionManagerUtility::isTailSampled(config, nullptr, stream_info));
+
+  // An empty list of matchers keeps no request.
+  EXPECT_FALSE(
+      ConnectionManagerUtility::isTailSampled({{}, false, {}}, &debug_headers, stream_info));
+}
+
 } // namespace Http
 } // namespace Envoy
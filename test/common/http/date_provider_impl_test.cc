@@ -10,6 +10,9 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::AllOf;
+using testing::Gt;
+using testing::Le;
 using testing::NiceMock;
 
 namespace Envoy {
@@ -19,14 +22,17 @@ TEST(DateProviderImplTest, All) {
   Event::MockDispatcher dispatcher;
   NiceMock<ThreadLocal::MockInstance> tls;
   Event::MockTimer* timer = new Event::MockTimer(&dispatcher);
-  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(500)));
+  // The refresh happens once the next second starts.
+  EXPECT_CALL(*timer, enableTimer(AllOf(Gt(std::chrono::milliseconds(0)),
+                                        Le(std::chrono::milliseconds(1000)))));
 
   TlsCachingDateProviderImpl provider(dispatcher, tls);
   HeaderMapImpl headers;
   provider.setDateHeader(headers);
   EXPECT_NE(nullptr, headers.Date());
 
-  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(500)));
+  EXPECT_CALL(*timer, enableTimer(AllOf(Gt(std::chrono::milliseconds(0)),
+                                        Le(std::chrono::milliseconds(1000)))));
   timer->callback_();
 
   headers.removeDate();
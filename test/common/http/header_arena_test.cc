@@ -0,0 +1,78 @@
+#include <cstring>
+#include <vector>
+
+#include "common/http/header_arena.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+bool aligned(void* ptr) { return reinterpret_cast<uintptr_t>(ptr) % HeaderArena::Alignment == 0; }
+
+TEST(HeaderArenaTest, Allocate) {
+  HeaderArena arena;
+  EXPECT_EQ(0, arena.bytesReserved());
+
+  char* first = static_cast<char*>(arena.allocate(1));
+  char* second = static_cast<char*>(arena.allocate(100));
+  EXPECT_TRUE(aligned(first));
+  EXPECT_TRUE(aligned(second));
+  EXPECT_EQ(HeaderArena::Alignment, second - first);
+  EXPECT_EQ(HeaderArena::InitialBlockSize, arena.bytesReserved());
+  memset(second, 'a', 100);
+}
+
+TEST(HeaderArenaTest, BlockGrowth) {
+  HeaderArena arena;
+  for (size_t i = 0; i < HeaderArena::InitialBlockSize / 512 + 1; i++) {
+    EXPECT_TRUE(aligned(arena.allocate(512)));
+  }
+  // The second block is twice the size of the first.
+  EXPECT_EQ(3 * HeaderArena::InitialBlockSize, arena.bytesReserved());
+}
+
+TEST(HeaderArenaTest, LargeAllocation) {
+  HeaderArena arena;
+  arena.allocate(16);
+  void* large = arena.allocate(HeaderArena::InitialBlockSize * 4);
+  EXPECT_TRUE(aligned(large));
+  EXPECT_EQ(HeaderArena::InitialBlockSize * 5, arena.bytesReserved());
+
+  // The rest of the first block is still used.
+  arena.allocate(16);
+  EXPECT_EQ(HeaderArena::InitialBlockSize * 5, arena.bytesReserved());
+}
+
+TEST(HeaderArenaTest, Reuse) {
+  HeaderArena arena;
+  void* first = arena.allocate(100);
+  void* second = arena.allocate(200);
+  arena.deallocate(first, 100);
+  arena.deallocate(second, 200);
+
+  // Sizes are reused after rounding up to the alignment.
+  EXPECT_EQ(first, arena.allocate(99));
+  EXPECT_EQ(second, arena.allocate(200));
+  EXPECT_NE(first, arena.allocate(100));
+}
+
+TEST(HeaderArenaTest, Allocator) {
+  HeaderArena arena;
+  std::vector<uint64_t, HeaderArenaAllocator<uint64_t>> arena_vector{
+      HeaderArenaAllocator<uint64_t>(&arena)};
+  std::vector<uint64_t, HeaderArenaAllocator<uint64_t>> heap_vector{
+      HeaderArenaAllocator<uint64_t>(nullptr)};
+  for (uint64_t i = 0; i < 100; i++) {
+    arena_vector.push_back(i);
+    heap_vector.push_back(i);
+  }
+  EXPECT_EQ(arena_vector[99], heap_vector[99]);
+  EXPECT_NE(0, arena.bytesReserved());
+  EXPECT_TRUE(arena_vector.get_allocator() != heap_vector.get_allocator());
+}
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
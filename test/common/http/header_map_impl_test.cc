@@ -294,6 +294,60 @@ TEST(HeaderMapImplTest, InlineInsert) {
   EXPECT_STREQ("hello", headers.get(Headers::get().Host)->value().c_str());
 }
 
+// Every predefined inline header must be found by the static lookup table, and keys that only
+// share a prefix or suffix with one must not be.
+TEST(HeaderMapImplTest, AllInlineHeadersLookup) {
+  HeaderMapImpl headers;
+  const HeaderEntry* entry;
+#define EXPECT_INLINE_LOOKUP(name)                                                                 \
+  EXPECT_EQ(HeaderMap::Lookup::NotFound, headers.lookup(Headers::get().name, &entry));             \
+  EXPECT_EQ(HeaderMap::Lookup::NotSupported,                                                       \
+            headers.lookup(LowerCaseString(Headers::get().name.get() + "x"), &entry));             \
+  EXPECT_EQ(HeaderMap::Lookup::NotSupported,                                                       \
+            headers.lookup(LowerCaseString(Headers::get().name.get().substr(1)), &entry));
+  ALL_INLINE_HEADERS(EXPECT_INLINE_LOOKUP)
+#undef EXPECT_INLINE_LOOKUP
+
+  EXPECT_EQ(HeaderMap::Lookup::NotSupported, headers.lookup(LowerCaseString(""), &entry));
+
+  // The legacy host header maps to :authority.
+  headers.addCopy(Headers::get().HostLegacy, "foo");
+  ASSERT_NE(nullptr, headers.Host());
+  EXPECT_STREQ(":authority", headers.Host()->key().c_str());
+  EXPECT_EQ(HeaderMap::Lookup::Found, headers.lookup(Headers::get().HostLegacy, &entry));
+}
+
+TEST(HeaderMapImplTest, Arena) {
+  auto arena = std::make_shared<HeaderArena>();
+  auto headers = std::make_unique<HeaderMapImpl>(arena);
+  const std::string long_value(300, 'a');
+  const LowerCaseString foo("foo");
+
+  headers->addCopy(LowerCaseString("hello"), long_value);
+  headers->insertContentType().value(long_value);
+  headers->insertContentType().value().append("b", 1);
+  headers->setReferenceKey(foo, long_value);
+  EXPECT_EQ(long_value, headers->get(LowerCaseString("hello"))->value().getStringView());
+  EXPECT_EQ(long_value + "b", headers->ContentType()->value().getStringView());
+  EXPECT_EQ(long_value, headers->get(foo)->value().getStringView());
+  EXPECT_EQ(HeaderString::Type::Dynamic, headers->ContentType()->value().type());
+
+  // Removing and re-adding headers reuses arena memory.
+  const uint64_t reserved = arena->bytesReserved();
+  EXPECT_NE(0, reserved);
+  for (int i = 0; i < 100; i++) {
+    headers->remove(LowerCaseString("hello"));
+    headers->addCopy(LowerCaseString("hello"), long_value);
+    headers->removeContentType();
+    headers->insertContentType().value(long_value);
+  }
+  EXPECT_EQ(reserved, arena->bytesReserved());
+
+  // The map keeps the arena alive.
+  arena.reset();
+  EXPECT_EQ(long_value, headers->get(LowerCaseString("hello"))->value().getStringView());
+}
+
 TEST(HeaderMapImplTest, MoveIntoInline) {
   HeaderMapImpl headers;
   HeaderString key;
@@ -313,6 +367,17 @@ TEST(HeaderMapImplTest, MoveIntoInline) {
   EXPECT_STREQ("hello,there", headers.CacheControl()->value().c_str());
 }
 
+TEST(HeaderMapImplTest, StaticValues) {
+  EXPECT_EQ(&Headers::get().ContentTypeValues.Grpc, StaticHeaderValues::find("application/grpc"));
+  EXPECT_EQ(&Headers::get().MethodValues.Get, StaticHeaderValues::find("GET"));
+  ASSERT_NE(nullptr, StaticHeaderValues::find("200"));
+  EXPECT_EQ("200", *StaticHeaderValues::find("200"));
+  EXPECT_EQ(nullptr, StaticHeaderValues::find("get"));
+  EXPECT_EQ(nullptr, StaticHeaderValues::find("application/grpcx"));
+  EXPECT_EQ(nullptr, StaticHeaderValues::find(""));
+  EXPECT_EQ(nullptr, StaticHeaderValues::find(std::string(1000, 'a')));
+}
+
 TEST(HeaderMapImplTest, Remove) {
   HeaderMapImpl headers;
 
@@ -381,6 +446,32 @@ TEST(HeaderMapImplTest, RemoveRegex) {
   EXPECT_EQ(nullptr, headers.ContentLength());
 }
 
+TEST(HeaderMapImplTest, RemoveIf) {
+  HeaderMapImpl headers;
+  headers.addCopy(LowerCaseString("x-internal-1"), "value");
+  headers.insertContentLength().value(5);
+  headers.addCopy(LowerCaseString("x-external"), "value");
+  headers.addCopy(LowerCaseString("x-internal-2"), "value");
+  headers.addCopy(LowerCaseString("x-internal-1"), "value");
+
+  uint32_t calls = 0;
+  headers.removeIf([&calls](const HeaderEntry& header) -> bool {
+    calls++;
+    const absl::string_view key = header.key().getStringView();
+    return key == "x-internal-1" || key == "x-internal-2" || key == "content-length";
+  });
+  EXPECT_EQ(5UL, calls);
+  EXPECT_EQ(1UL, headers.size());
+  EXPECT_EQ(nullptr, headers.ContentLength());
+  EXPECT_EQ(nullptr, headers.get(LowerCaseString("x-internal-1")));
+  EXPECT_EQ(nullptr, headers.get(LowerCaseString("x-internal-2")));
+  EXPECT_NE(nullptr, headers.get(LowerCaseString("x-external")));
+
+  // The inline header can be added again after it was removed.
+  headers.insertContentLength().value(6);
+  EXPECT_EQ("6", headers.ContentLength()->value().getStringView());
+}
+
 TEST(HeaderMapImplTest, SetRemovesAllValues) {
   HeaderMapImpl headers;
 
@@ -919,7 +1010,7 @@ TEST(HeaderMapImplTest, TestHeaderMapImplyCopy) {
   TestHeaderMapImpl foo;
   foo.addCopy(LowerCaseString("foo"), "bar");
   auto headers = std::make_unique<TestHeaderMapImpl>(foo);
-  EXPECT_STREQ("bar", headers->get(LowerCaseString("foo"))->value().c_str());
+  EXPECT_STREQ("bar", headers->get(foo)->value().c_str());
   TestHeaderMapImpl baz{{"foo", "baz"}};
   baz = *headers;
   EXPECT_STREQ("bar", baz.get(LowerCaseString("foo"))->value().c_str());
@@ -331,6 +331,30 @@ TEST_F(Http1ServerConnectionImplTest, PostWithContentLength) {
   EXPECT_EQ(0U, buffer.length());
 }
 
+// Common header values reference the static constants rather than being copied.
+TEST_F(Http1ServerConnectionImplTest, StaticHeaderValues) {
+  initialize();
+
+  Http::MockStreamDecoder decoder;
+  EXPECT_CALL(callbacks_, newStream(_, _)).WillOnce(ReturnRef(decoder));
+  EXPECT_CALL(decoder, decodeHeaders_(_, true))
+      .WillOnce(Invoke([](HeaderMapPtr& headers, bool) -> void {
+        EXPECT_EQ(Headers::get().ContentTypeValues.Grpc.c_str(),
+                  headers->ContentType()->value().c_str());
+        EXPECT_EQ(HeaderString::Type::Reference,
+                  headers->get(LowerCaseString("te"))->value().type());
+        EXPECT_EQ("trailers", headers->get(LowerCaseString("te"))->value().getStringView());
+        EXPECT_NE(HeaderString::Type::Reference,
+                  headers->get(LowerCaseString("x-foo"))->value().type());
+        EXPECT_EQ("bar", headers->get(LowerCaseString("x-foo"))->value().getStringView());
+      }));
+
+  Buffer::OwnedImpl buffer(
+      "GET / HTTP/1.1\r\ncontent-type: application/grpc\r\nte: trailers\r\nx-foo: bar\r\n\r\n");
+  codec_->dispatch(buffer);
+  EXPECT_EQ(0U, buffer.length());
+}
+
 TEST_F(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
   initialize();
 
@@ -354,6 +378,44 @@ TEST_F(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 0\r\n\r\n", output);
 }
 
+TEST_F(Http1ServerConnectionImplTest, LargeResponseHeadersInOneSlice) {
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> decoder;
+  Http::StreamEncoder* response_encoder = nullptr;
+  EXPECT_CALL(callbacks_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamEncoder& encoder, bool) -> Http::StreamDecoder& {
+        response_encoder = &encoder;
+        return decoder;
+      }));
+
+  Buffer::OwnedImpl buffer("GET / HTTP/1.1\r\n\r\n");
+  codec_->dispatch(buffer);
+
+  // The status line and headers well past the default 4 KiB reservation are serialized into a
+  // single slice.
+  std::string output;
+  uint64_t num_slices = 0;
+  EXPECT_CALL(connection_, write(_, _))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+        num_slices = data.getRawSlices(nullptr, 0);
+        output = data.toString();
+        data.drain(data.length());
+      }));
+
+  TestHeaderMapImpl headers{{":status", "200"}};
+  std::string expected_headers;
+  for (int i = 0; i < 100; i++) {
+    const std::string key = fmt::format("header-{}", i);
+    const std::string value(100, 'a' + i % 26);
+    headers.addCopy(key, value);
+    expected_headers += key + ": " + value + "\r\n";
+  }
+  response_encoder->encodeHeaders(headers, true);
+  EXPECT_EQ(1, num_slices);
+  EXPECT_EQ("HTTP/1.1 200 OK\r\n" + expected_headers + "content-length: 0\r\n\r\n", output);
+}
+
 TEST_F(Http1ServerConnectionImplTest, HeaderOnlyResponseWith204) {
   initialize();
 
@@ -457,6 +519,39 @@ TEST_F(Http1ServerConnectionImplTest, ChunkedResponse) {
             output);
 }
 
+TEST_F(Http1ServerConnectionImplTest, ChunkedResponseMultipleChunks) {
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> decoder;
+  Http::StreamEncoder* response_encoder = nullptr;
+  EXPECT_CALL(callbacks_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamEncoder& encoder, bool) -> Http::StreamDecoder& {
+        response_encoder = &encoder;
+        return decoder;
+      }));
+
+  Buffer::OwnedImpl buffer("GET / HTTP/1.1\r\n\r\n");
+  codec_->dispatch(buffer);
+  EXPECT_EQ(0U, buffer.length());
+
+  std::string output;
+  ON_CALL(connection_, write(_, _)).WillByDefault(AddBufferToString(&output));
+
+  TestHeaderMapImpl headers{{":status", "200"}};
+  response_encoder->encodeHeaders(headers, false);
+
+  Buffer::OwnedImpl data1("Hello World");
+  response_encoder->encodeData(data1, false);
+  const std::string large_chunk(0x1a2b, 'a');
+  Buffer::OwnedImpl data2(large_chunk);
+  response_encoder->encodeData(data2, false);
+  Buffer::OwnedImpl data3("!");
+  response_encoder->encodeData(data3, true);
+  EXPECT_EQ("HTTP/1.1 200 OK\r\ntransfer-encoding: chunked\r\n\r\nb\r\nHello World\r\n1a2b\r\n" +
+                large_chunk + "\r\n1\r\n!\r\n0\r\n\r\n",
+            output);
+}
+
 TEST_F(Http1ServerConnectionImplTest, ContentLengthResponse) {
   initialize();
 
@@ -554,6 +649,80 @@ TEST_F(Http1ServerConnectionImplTest, DoubleRequest) {
   EXPECT_EQ(0U, buffer.length());
 }
 
+TEST_F(Http1ServerConnectionImplTest, PipelinedRequests) {
+  codec_settings_.max_pipelined_requests_ = 2;
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> decoder;
+  std::vector<Http::StreamEncoder*> response_encoders;
+  EXPECT_CALL(callbacks_, newStream(_, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](Http::StreamEncoder& encoder, bool) -> Http::StreamDecoder& {
+        response_encoders.push_back(&encoder);
+        return decoder;
+      }));
+
+  std::string request("GET / HTTP/1.1\r\n\r\n");
+  Buffer::OwnedImpl buffer(request + request + request);
+
+  // The parser pauses after each request, and the third one is not parsed while two are waiting
+  // for their responses.
+  codec_->dispatch(buffer);
+  codec_->dispatch(buffer);
+  EXPECT_EQ(2U, response_encoders.size());
+  codec_->dispatch(buffer);
+  EXPECT_EQ(2U, response_encoders.size());
+  EXPECT_EQ(request.size(), buffer.length());
+
+  std::string output;
+  ON_CALL(connection_, write(_, _)).WillByDefault(AddBufferToString(&output));
+
+  // The second response is held until the first one is written.
+  TestHeaderMapImpl headers{{":status", "200"}, {"content-length", "1"}};
+  response_encoders[1]->encodeHeaders(headers, false);
+  Buffer::OwnedImpl data2("2");
+  response_encoders[1]->encodeData(data2, true);
+  response_encoders[0]->encodeHeaders(headers, false);
+  EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 1\r\n\r\n", output);
+  Buffer::OwnedImpl data1("1");
+  response_encoders[0]->encodeData(data1, true);
+  EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 1\r\n\r\n1"
+            "HTTP/1.1 200 OK\r\ncontent-length: 1\r\n\r\n2",
+            output);
+
+  // Both responses are complete, so the third request is parsed.
+  codec_->dispatch(buffer);
+  EXPECT_EQ(3U, response_encoders.size());
+  EXPECT_EQ(0U, buffer.length());
+}
+
+TEST_F(Http1ServerConnectionImplTest, PipelinedRequestsReset) {
+  codec_settings_.max_pipelined_requests_ = 2;
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> decoder;
+  std::vector<Http::StreamEncoder*> response_encoders;
+  EXPECT_CALL(callbacks_, newStream(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](Http::StreamEncoder& encoder, bool) -> Http::StreamDecoder& {
+        response_encoders.push_back(&encoder);
+        return decoder;
+      }));
+
+  std::string request("GET / HTTP/1.1\r\n\r\n");
+  Buffer::OwnedImpl buffer(request + request);
+  codec_->dispatch(buffer);
+  codec_->dispatch(buffer);
+
+  Http::MockStreamCallbacks callbacks1;
+  response_encoders[0]->getStream().addCallbacks(callbacks1);
+  Http::MockStreamCallbacks callbacks2;
+  response_encoders[1]->getStream().addCallbacks(callbacks2);
+  EXPECT_CALL(callbacks1, onResetStream(StreamResetReason::LocalReset, _));
+  EXPECT_CALL(callbacks2, onResetStream(StreamResetReason::LocalReset, _));
+  response_encoders[1]->getStream().resetStream(StreamResetReason::LocalReset);
+}
+
 TEST_F(Http1ServerConnectionImplTest, RequestWithTrailers) {
   initialize();
 
@@ -571,6 +740,34 @@ TEST_F(Http1ServerConnectionImplTest, RequestWithTrailers) {
   EXPECT_EQ(0U, buffer.length());
 }
 
+// A chunk that is a whole slice of the dispatched buffer is moved to the decoder, not copied.
+TEST_F(Http1ServerConnectionImplTest, ChunkedRequestMovesSliceAlignedChunk) {
+  initialize();
+
+  InSequence sequence;
+  NiceMock<Http::MockStreamDecoder> decoder;
+  EXPECT_CALL(callbacks_, newStream(_, _)).WillOnce(ReturnRef(decoder));
+
+  Buffer::OwnedImpl buffer("POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\nb\r\n");
+  Buffer::OwnedImpl chunk("Hello World");
+  Buffer::RawSlice chunk_slice;
+  EXPECT_EQ(1U, chunk.getRawSlices(&chunk_slice, 1));
+  buffer.move(chunk);
+  Buffer::OwnedImpl last_chunk("\r\n0\r\n\r\n");
+  buffer.move(last_chunk);
+
+  EXPECT_CALL(decoder, decodeHeaders_(_, false));
+  EXPECT_CALL(decoder, decodeData(_, false)).WillOnce(Invoke([&](Buffer::Instance& data, bool) {
+    EXPECT_EQ("Hello World", data.toString());
+    Buffer::RawSlice data_slice;
+    EXPECT_EQ(1U, data.getRawSlices(&data_slice, 1));
+    EXPECT_EQ(chunk_slice.mem_, data_slice.mem_);
+  }));
+  EXPECT_CALL(decoder, decodeData(BufferStringEqual(""), true));
+  codec_->dispatch(buffer);
+  EXPECT_EQ(0U, buffer.length());
+}
+
 TEST_F(Http1ServerConnectionImplTest, UpgradeRequest) {
   initialize();
 
@@ -741,6 +938,10 @@ TEST_F(Http1ClientConnectionImplTest, MultipleHeaderOnlyThenNoContentLength) {
   EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n", output);
   output.clear();
 
+  EXPECT_CALL(response_decoder, decodeHeaders_(_, true));
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+  codec_->dispatch(response);
+
   // Simulate the underlying connection being backed up. Ensure that it is
   // read-enabled as the new stream is created.
   EXPECT_CALL(connection_, readEnabled())
@@ -757,6 +958,57 @@ TEST_F(Http1ClientConnectionImplTest, MultipleHeaderOnlyThenNoContentLength) {
   EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\ntransfer-encoding: chunked\r\n\r\n0\r\n\r\n", output);
 }
 
+TEST_F(Http1ClientConnectionImplTest, PipelinedResponses) {
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> response_decoder1;
+  Http::StreamEncoder& request_encoder1 = codec_->newStream(response_decoder1);
+  TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  request_encoder1.encodeHeaders(headers, true);
+
+  // A request pipelined behind a pending one leaves unwinding the read disable of the connection
+  // to the pending one.
+  EXPECT_CALL(connection_, readEnabled()).Times(0);
+  NiceMock<Http::MockStreamDecoder> response_decoder2;
+  Http::StreamEncoder& request_encoder2 = codec_->newStream(response_decoder2);
+  request_encoder2.encodeHeaders(headers, true);
+
+  Http::MockStreamCallbacks callbacks1;
+  request_encoder1.getStream().addCallbacks(callbacks1);
+  Http::MockStreamCallbacks callbacks2;
+  request_encoder2.getStream().addCallbacks(callbacks2);
+
+  // The responses are decoded in the order of the requests.
+  InSequence s;
+  EXPECT_CALL(response_decoder1, decodeHeaders_(_, true));
+  EXPECT_CALL(response_decoder2, decodeHeaders_(_, false));
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n"
+                             "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nHel");
+  codec_->dispatch(response);
+
+  // A reset only fails the response that did not complete.
+  EXPECT_CALL(callbacks1, onResetStream(_, _)).Times(0);
+  EXPECT_CALL(callbacks2, onResetStream(StreamResetReason::LocalReset, _));
+  request_encoder2.getStream().resetStream(StreamResetReason::LocalReset);
+}
+
+TEST_F(Http1ClientConnectionImplTest, PipelinedReset) {
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> response_decoder;
+  Http::StreamEncoder& request_encoder1 = codec_->newStream(response_decoder);
+  Http::StreamEncoder& request_encoder2 = codec_->newStream(response_decoder);
+
+  // Resetting either request resets both, since the connection cannot be used any more.
+  Http::MockStreamCallbacks callbacks1;
+  request_encoder1.getStream().addCallbacks(callbacks1);
+  Http::MockStreamCallbacks callbacks2;
+  request_encoder2.getStream().addCallbacks(callbacks2);
+  EXPECT_CALL(callbacks1, onResetStream(StreamResetReason::LocalReset, _));
+  EXPECT_CALL(callbacks2, onResetStream(StreamResetReason::LocalReset, _));
+  request_encoder2.getStream().resetStream(StreamResetReason::LocalReset);
+}
+
 TEST_F(Http1ClientConnectionImplTest, PrematureResponse) {
   initialize();
 
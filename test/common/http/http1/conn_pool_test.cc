@@ -61,6 +61,7 @@ public:
     Network::MockClientConnection* connection_;
     CodecClient* codec_client_;
     Event::MockTimer* connect_timer_;
+    Event::MockTimer* pipeline_timer_{};
     Event::DispatcherPtr client_dispatcher_;
   };
 
@@ -79,6 +80,11 @@ public:
     TestCodecClient& test_client = test_clients_.back();
     test_client.connection_ = new NiceMock<Network::MockClientConnection>();
     test_client.codec_ = new NiceMock<Http::MockClientConnection>();
+    // The connect timer is created before the pipeline timer, and expectations on timer creation
+    // match the most recent one first.
+    if (max_pipelined_requests_ > 1 && pipeline_head_of_line_timeout_) {
+      test_client.pipeline_timer_ = new NiceMock<Event::MockTimer>(&mock_dispatcher_);
+    }
     test_client.connect_timer_ = new NiceMock<Event::MockTimer>(&mock_dispatcher_);
     std::shared_ptr<Upstream::MockClusterInfo> cluster{new NiceMock<Upstream::MockClusterInfo>()};
     test_client.client_dispatcher_ = api_->allocateDispatcher();
@@ -123,16 +129,26 @@ public:
  */
 class Http1ConnPoolImplTest : public testing::Test {
 public:
-  Http1ConnPoolImplTest()
-      : upstream_ready_timer_(new NiceMock<Event::MockTimer>(&dispatcher_)),
+  Http1ConnPoolImplTest() : Http1ConnPoolImplTest(Http1Settings()) {}
+
+  Http1ConnPoolImplTest(const Http1Settings& http1_settings)
+      : cluster_(makeCluster(http1_settings)),
+        upstream_ready_timer_(new NiceMock<Event::MockTimer>(&dispatcher_)),
         conn_pool_(dispatcher_, cluster_, upstream_ready_timer_) {}
 
   ~Http1ConnPoolImplTest() {
     EXPECT_TRUE(TestUtility::gaugesZeroed(cluster_->stats_store_.gauges()));
   }
 
+  static std::shared_ptr<Upstream::MockClusterInfo>
+  makeCluster(const Http1Settings& http1_settings) {
+    std::shared_ptr<Upstream::MockClusterInfo> cluster{new NiceMock<Upstream::MockClusterInfo>()};
+    cluster->http1_settings_ = http1_settings;
+    return cluster;
+  }
+
   NiceMock<Event::MockDispatcher> dispatcher_;
-  std::shared_ptr<Upstream::MockClusterInfo> cluster_{new NiceMock<Upstream::MockClusterInfo>()};
+  std::shared_ptr<Upstream::MockClusterInfo> cluster_;
   NiceMock<Event::MockTimer>* upstream_ready_timer_;
   ConnPoolImplForTest conn_pool_;
   NiceMock<Runtime::MockLoader> runtime_;
@@ -203,6 +219,21 @@ struct ActiveTestRequest {
   ConnPoolCallbacks callbacks_;
 };
 
+/**
+ * Test fixture for a cluster that pipelines up to 2 requests per connection.
+ */
+class Http1ConnPoolImplPipeliningTest : public Http1ConnPoolImplTest {
+public:
+  Http1ConnPoolImplPipeliningTest() : Http1ConnPoolImplTest(pipeliningSettings()) {}
+
+  static Http1Settings pipeliningSettings() {
+    Http1Settings http1_settings;
+    http1_settings.max_pipelined_requests_ = 2;
+    http1_settings.pipeline_head_of_line_timeout_ = std::chrono::milliseconds(1000);
+    return http1_settings;
+  }
+};
+
 /**
  * Verify that connections are drained when requested.
  */
@@ -484,6 +515,34 @@ TEST_F(Http1ConnPoolImplTest, MaxConnections) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that the per host connection limit holds back new connections the same way the cluster
+ * limit does.
+ */
+TEST_F(Http1ConnPoolImplTest, MaxConnectionsPerHost) {
+  cluster_->resetResourceManager(1024, 1024, 1024, 1, 1024, 1);
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+
+  // The host already has its one connection, so request 2 waits for it.
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Pending);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_overflow_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_total_.value());
+
+  conn_pool_.expectEnableUpstreamReady();
+  r2.expectNewStream();
+  r1.completeResponse(false);
+  conn_pool_.expectAndRunUpstreamReady();
+  r2.startRequest();
+  r2.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Test when upstream closes connection without 'connection: close' like
  * https://github.com/envoyproxy/envoy/pull/2715
@@ -644,6 +703,45 @@ TEST_F(Http1ConnPoolImplTest, ConcurrentConnections) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Verify that the most recently used idle connection is reused first, so that the least recently
+ * used ones are left to hit the idle timeout.
+ */
+TEST_F(Http1ConnPoolImplTest, ReuseMostRecentlyUsedConnection) {
+  cluster_->resetResourceManager(2, 1024, 1024, 1, 1);
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::CreateConnection);
+  r2.startRequest();
+
+  r1.completeResponse(false);
+  r2.completeResponse(false);
+
+  // Both connections are idle. The second one was released last and is reused.
+  ActiveTestRequest r3(*this, 1, ActiveTestRequest::Type::Immediate);
+  r3.startRequest();
+  r3.completeResponse(false);
+
+  ActiveTestRequest r4(*this, 1, ActiveTestRequest::Type::Immediate);
+  r4.startRequest();
+
+  // The cold connection going away does not disturb the warm one.
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::LocalClose);
+  dispatcher_.clearDeferredDeleteList();
+
+  r4.completeResponse(false);
+  EXPECT_EQ(4U, cluster_->stats_.upstream_rq_total_.value());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_total_.value());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 TEST_F(Http1ConnPoolImplTest, DrainCallback) {
   InSequence s;
   ReadyWatcher drained;
@@ -766,6 +864,150 @@ TEST_F(Http1ConnPoolImplTest, PendingRequestIsConsideredActive) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that a prefetched connection serves the first request without a handshake.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchConnection) {
+  InSequence s;
+
+  conn_pool_.expectClientCreate();
+  conn_pool_.prefetchConnection();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  // The pool already has a connection.
+  conn_pool_.prefetchConnection();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(*conn_pool_.test_clients_[0].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Immediate);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_prefetched_.value());
+  r1.startRequest();
+  r1.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that the pool keeps the configured ratio of connections to requests.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchRatio) {
+  ON_CALL(*cluster_, perUpstreamPrefetchRatio()).WillByDefault(Return(1.5));
+
+  std::unique_ptr<ActiveTestRequest> r1;
+  {
+    InSequence s;
+
+    // The first request creates a connection for itself and prefetches a second one.
+    conn_pool_.expectClientCreate();
+    conn_pool_.expectClientCreate();
+    r1 = std::make_unique<ActiveTestRequest>(*this, 0, ActiveTestRequest::Type::Pending);
+    EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+    EXPECT_CALL(*conn_pool_.test_clients_[0].connect_timer_, disableTimer());
+    r1->expectNewStream();
+    conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+    r1->startRequest();
+
+    EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+    conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  }
+
+  // The second request uses the prefetched connection, and two requests in flight call for a
+  // third connection.
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_prefetched_.value());
+  EXPECT_EQ(3U, cluster_->stats_.upstream_cx_total_.value());
+
+  r1->completeResponse(false);
+  r2.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(3);
+  conn_pool_.test_clients_[2].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that a request is pipelined behind one that is completely sent, and that the connection is
+ * reused once both responses complete.
+ */
+TEST_F(Http1ConnPoolImplPipeliningTest, PipelinedRequest) {
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+
+  // The second request is sent on the busy connection rather than on a new one, which starts the
+  // head of line timeout of the first response.
+  EXPECT_CALL(*conn_pool_.test_clients_[0].pipeline_timer_, enableTimer(_));
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pipelined_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_total_.value());
+
+  // The depth of the pipeline is limited, so the third request waits for a connection.
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r3(*this, 1, ActiveTestRequest::Type::Pending);
+  r3.handle_->cancel();
+
+  EXPECT_CALL(*conn_pool_.test_clients_[0].pipeline_timer_, disableTimer());
+  r1.completeResponse(false);
+  EXPECT_CALL(*conn_pool_.test_clients_[0].pipeline_timer_, disableTimer());
+  r2.completeResponse(false);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_rq_total_.value());
+
+  // Both clients are idle now.
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that a pending request is pipelined once the request ahead of it is sent, and that the head
+ * of line timeout closes the connection.
+ */
+TEST_F(Http1ConnPoolImplPipeliningTest, PipelinePendingRequestThenHeadOfLineTimeout) {
+  cluster_->resetResourceManager(1, 1024, 1024, 1, 1);
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+
+  // The first request is not sent yet, so the second one waits.
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Pending);
+
+  conn_pool_.expectEnableUpstreamReady();
+  r1.startRequest();
+
+  EXPECT_CALL(*conn_pool_.test_clients_[0].pipeline_timer_, enableTimer(_));
+  r2.expectNewStream();
+  conn_pool_.expectAndRunUpstreamReady();
+  r2.startRequest();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pipelined_.value());
+
+  // Both requests are reset when the first response holds up the second one for too long.
+  Http::MockStreamCallbacks stream_callbacks1;
+  r1.request_encoder_.getStream().addCallbacks(stream_callbacks1);
+  Http::MockStreamCallbacks stream_callbacks2;
+  r2.request_encoder_.getStream().addCallbacks(stream_callbacks2);
+  EXPECT_CALL(stream_callbacks1, onResetStream(StreamResetReason::ConnectionTermination, _));
+  EXPECT_CALL(stream_callbacks2, onResetStream(StreamResetReason::ConnectionTermination, _));
+  conn_pool_.test_clients_[0].pipeline_timer_->callback_();
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_pipeline_timeout_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_destroy_with_active_rq_.value());
+}
+
 } // namespace
 } // namespace Http1
 } // namespace Http
@@ -0,0 +1,335 @@
+#include <string>
+#include <vector>
+
+#include "common/http/http1/fast_parser_impl.h"
+#include "common/http/http1/legacy_parser_impl.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+// Records parser events. Consecutive data events of the same kind are merged so that the parsers
+// can be compared regardless of how they split data.
+class RecordingCallbacks : public ParserCallbacks {
+public:
+  void onMessageBegin() override { record("begin"); }
+  void onUrl(const char* data, size_t length) override { record("url", data, length); }
+  void onHeaderField(const char* data, size_t length) override {
+    record("field", data, length);
+  }
+  void onHeaderValue(const char* data, size_t length) override {
+    record("value", data, length);
+  }
+  int onHeadersComplete() override {
+    record("headers");
+    return headers_complete_rc_;
+  }
+  void onBody(const char* data, size_t length) override { record("body", data, length); }
+  void onMessageComplete() override {
+    record("complete");
+    if (pause_on_message_complete_) {
+      parser_->pause();
+    }
+  }
+
+  void record(const std::string& event) {
+    events_.push_back(event);
+    last_data_event_.clear();
+  }
+  void record(const std::string& event, const char* data, size_t length) {
+    if (length == 0) {
+      return;
+    }
+    if (event == last_data_event_) {
+      events_.back().append(data, length);
+    } else {
+      events_.push_back(event + ":" + std::string(data, length));
+      last_data_event_ = event;
+    }
+  }
+
+  Parser* parser_{};
+  std::vector<std::string> events_;
+  std::string last_data_event_;
+  int headers_complete_rc_{};
+  bool pause_on_message_complete_{};
+};
+
+enum class ParserImpl { Legacy, Fast };
+
+class ParserImplTest : public testing::TestWithParam<ParserImpl> {
+public:
+  void initialize(MessageType type) {
+    if (GetParam() == ParserImpl::Legacy) {
+      parser_ = std::make_unique<LegacyHttpParserImpl>(type, callbacks_);
+    } else {
+      parser_ = std::make_unique<FastHttpParserImpl>(type, callbacks_, 1024);
+    }
+    callbacks_.parser_ = parser_.get();
+  }
+
+  size_t execute(const std::string& data) { return parser_->execute(data.data(), data.size()); }
+
+  // Feeds one byte at a time to exercise lines and bodies that straddle spans.
+  size_t executeBytewise(const std::string& data) {
+    size_t parsed = 0;
+    for (const char c : data) {
+      parsed += parser_->execute(&c, 1);
+    }
+    return parsed;
+  }
+
+  RecordingCallbacks callbacks_;
+  ParserPtr parser_;
+};
+
+INSTANTIATE_TEST_SUITE_P(Parsers, ParserImplTest,
+                         testing::Values(ParserImpl::Legacy, ParserImpl::Fast));
+
+const std::string SimpleRequest = "GET /foo?bar=baz HTTP/1.1\r\nHost: example.com\r\n"
+                                  "x-empty-ows:   value  \r\n\r\n";
+
+TEST_P(ParserImplTest, SimpleRequest) {
+  initialize(MessageType::Request);
+  EXPECT_EQ(SimpleRequest.size(), execute(SimpleRequest));
+  EXPECT_EQ(HPE_OK, parser_->error());
+  EXPECT_EQ(HTTP_GET, parser_->method());
+  EXPECT_TRUE(parser_->isHttp11());
+  EXPECT_FALSE(parser_->isChunked());
+  EXPECT_FALSE(parser_->contentLength().has_value());
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "url:/foo?bar=baz", "field:Host", "value:example.com",
+                          "field:x-empty-ows", "value:value  ", "headers", "complete"));
+}
+
+TEST_P(ParserImplTest, SimpleRequestBytewise) {
+  initialize(MessageType::Request);
+  EXPECT_EQ(SimpleRequest.size(), executeBytewise(SimpleRequest));
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "url:/foo?bar=baz", "field:Host", "value:example.com",
+                          "field:x-empty-ows", "value:value  ", "headers", "complete"));
+}
+
+TEST_P(ParserImplTest, Http10Request) {
+  initialize(MessageType::Request);
+  const std::string request = "\r\nHEAD / HTTP/1.0\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request));
+  EXPECT_EQ(HTTP_HEAD, parser_->method());
+  EXPECT_FALSE(parser_->isHttp11());
+  EXPECT_THAT(callbacks_.events_, ElementsAre("begin", "url:/", "headers", "complete"));
+}
+
+TEST_P(ParserImplTest, ContentLengthBody) {
+  initialize(MessageType::Request);
+  const std::string request = "POST / HTTP/1.1\r\ncontent-length: 5\r\n\r\nhelloGET / HTTP/1.1\r\n";
+  EXPECT_EQ(request.size(), executeBytewise(request));
+  EXPECT_EQ(HPE_OK, parser_->error());
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "url:/", "field:content-length", "value:5", "headers",
+                          "body:hello", "complete", "begin", "url:/"));
+}
+
+TEST_P(ParserImplTest, ChunkedBody) {
+  initialize(MessageType::Request);
+  const std::string request = "POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\n"
+                              "5;ext=1\r\nhello\r\nA\r\n0123456789\r\n0\r\ntrailer: t\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request));
+  EXPECT_EQ(HPE_OK, parser_->error());
+  EXPECT_TRUE(parser_->isChunked());
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "url:/", "field:transfer-encoding", "value:chunked", "headers",
+                          "body:hello0123456789", "field:trailer", "value:t", "complete"));
+}
+
+TEST_P(ParserImplTest, ResponseBodyUntilEof) {
+  initialize(MessageType::Response);
+  const std::string response = "HTTP/1.1 200 OK\r\n\r\nhello";
+  EXPECT_EQ(response.size(), executeBytewise(response));
+  EXPECT_EQ(200, parser_->statusCode());
+  EXPECT_THAT(callbacks_.events_, ElementsAre("begin", "headers", "body:hello"));
+  EXPECT_EQ(0, parser_->execute(nullptr, 0));
+  EXPECT_EQ(HPE_OK, parser_->error());
+  EXPECT_THAT(callbacks_.events_, ElementsAre("begin", "headers", "body:hello", "complete"));
+}
+
+TEST_P(ParserImplTest, ResponsesWithoutBody) {
+  initialize(MessageType::Response);
+  const std::string response = "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 204 No Content\r\n\r\n"
+                               "HTTP/1.1 200 OK\r\ncontent-length: 0\r\n\r\n";
+  EXPECT_EQ(response.size(), execute(response));
+  EXPECT_EQ(HPE_OK, parser_->error());
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "headers", "complete", "begin", "headers", "complete", "begin",
+                          "field:content-length", "value:0", "headers", "complete"));
+}
+
+TEST_P(ParserImplTest, SkipBody) {
+  initialize(MessageType::Response);
+  callbacks_.headers_complete_rc_ = 1;
+  const std::string response = "HTTP/1.1 200 OK\r\ncontent-length: 5\r\n\r\n";
+  EXPECT_EQ(response.size(), execute(response));
+  EXPECT_EQ(HPE_OK, parser_->error());
+  EXPECT_EQ(5, parser_->contentLength().value());
+  EXPECT_THAT(callbacks_.events_, ElementsAre("begin", "field:content-length", "value:5",
+                                              "headers", "complete"));
+}
+
+TEST_P(ParserImplTest, PauseOnMessageComplete) {
+  initialize(MessageType::Request);
+  callbacks_.pause_on_message_complete_ = true;
+  const std::string first = "GET /a HTTP/1.1\r\n\r\n";
+  const std::string second = "GET /b HTTP/1.1\r\n\r\n";
+  EXPECT_EQ(first.size(), execute(first + second));
+  EXPECT_EQ(HPE_PAUSED, parser_->error());
+  EXPECT_EQ(0, execute(second));
+
+  parser_->resume();
+  EXPECT_EQ(HPE_OK, parser_->error());
+  EXPECT_EQ(second.size(), execute(second));
+  EXPECT_THAT(callbacks_.events_, ElementsAre("begin", "url:/a", "headers", "complete", "begin",
+                                              "url:/b", "headers", "complete"));
+}
+
+TEST_P(ParserImplTest, Upgrade) {
+  initialize(MessageType::Request);
+  const std::string request =
+      "GET / HTTP/1.1\r\nconnection: upgrade\r\nupgrade: websocket\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request + "not http"));
+  EXPECT_EQ(HPE_OK, parser_->error());
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "url:/", "field:connection", "value:upgrade", "field:upgrade",
+                          "value:websocket", "headers", "complete"));
+}
+
+TEST_P(ParserImplTest, UpgradeRequestedByCallbacks) {
+  initialize(MessageType::Request);
+  callbacks_.headers_complete_rc_ = 2;
+  const std::string request = "POST / HTTP/1.1\r\ncontent-length: 5\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request + "hello"));
+  EXPECT_EQ(HPE_OK, parser_->error());
+  EXPECT_THAT(callbacks_.events_, ElementsAre("begin", "url:/", "field:content-length", "value:5",
+                                              "headers", "complete"));
+}
+
+TEST_P(ParserImplTest, DataAfterConnectionClose) {
+  initialize(MessageType::Request);
+  execute("GET / HTTP/1.1\r\nconnection: close\r\n\r\n\r\nGET / HTTP/1.1\r\n");
+  EXPECT_EQ(HPE_CLOSED_CONNECTION, parser_->error());
+}
+
+TEST_P(ParserImplTest, InvalidMethod) {
+  initialize(MessageType::Request);
+  execute("FOO / HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(HPE_INVALID_METHOD, parser_->error());
+}
+
+TEST_P(ParserImplTest, InvalidFirstCharacter) {
+  initialize(MessageType::Request);
+  execute("bad");
+  EXPECT_EQ(HPE_INVALID_METHOD, parser_->error());
+  // The message never began.
+  EXPECT_TRUE(callbacks_.events_.empty());
+}
+
+TEST_P(ParserImplTest, InvalidMethodPrefix) {
+  initialize(MessageType::Request);
+  execute("G");
+  EXPECT_EQ(HPE_OK, parser_->error());
+  execute("g");
+  EXPECT_EQ(HPE_INVALID_METHOD, parser_->error());
+}
+
+TEST_P(ParserImplTest, InvalidHeaderName) {
+  initialize(MessageType::Request);
+  execute("GET / HTTP/1.1\r\nbad header: value\r\n\r\n");
+  EXPECT_EQ(HPE_INVALID_HEADER_TOKEN, parser_->error());
+}
+
+TEST_P(ParserImplTest, InvalidHeaderValue) {
+  initialize(MessageType::Request);
+  // Long enough for the invalid character to be found past the first 16 bytes.
+  execute("GET / HTTP/1.1\r\nfoo: " + std::string(20, 'a') + "\x01z\r\n\r\n");
+  EXPECT_EQ(HPE_INVALID_HEADER_TOKEN, parser_->error());
+}
+
+TEST_P(ParserImplTest, InvalidContentLength) {
+  initialize(MessageType::Request);
+  execute("POST / HTTP/1.1\r\ncontent-length: 1x\r\n\r\n");
+  EXPECT_EQ(HPE_INVALID_CONTENT_LENGTH, parser_->error());
+}
+
+TEST_P(ParserImplTest, InvalidChunkSize) {
+  initialize(MessageType::Request);
+  execute("POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\nzz\r\n");
+  EXPECT_EQ(HPE_INVALID_CHUNK_SIZE, parser_->error());
+}
+
+TEST_P(ParserImplTest, InvalidStatus) {
+  initialize(MessageType::Response);
+  execute("HTTP/1.1 2x0 OK\r\n\r\n");
+  EXPECT_EQ(HPE_INVALID_STATUS, parser_->error());
+}
+
+TEST_P(ParserImplTest, EofInsideMessage) {
+  initialize(MessageType::Request);
+  execute("GET / HTTP/1.1\r\nhost: foo\r\n");
+  EXPECT_EQ(HPE_OK, parser_->error());
+  parser_->execute(nullptr, 0);
+  EXPECT_EQ(HPE_INVALID_EOF_STATE, parser_->error());
+}
+
+TEST(FastHttpParserImplTest, LineOverflow) {
+  RecordingCallbacks callbacks;
+  FastHttpParserImpl parser(MessageType::Request, callbacks, 32);
+  const std::string request = "GET / HTTP/1.1\r\nfoo: " + std::string(20, 'a');
+  // The partial line fits.
+  parser.execute(request.data(), request.size());
+  EXPECT_EQ(HPE_OK, parser.error());
+  // A line that completes is handed to the callbacks whatever its length. They apply their own
+  // limits.
+  const std::string line = std::string(40, 'a') + "\r\n";
+  parser.execute(line.data(), line.size());
+  EXPECT_EQ(HPE_OK, parser.error());
+
+  const std::string long_line = "bar: " + std::string(40, 'b');
+  parser.execute(long_line.data(), long_line.size());
+  EXPECT_EQ(HPE_HEADER_OVERFLOW, parser.error());
+}
+
+TEST(FastHttpParserImplTest, ObsFold) {
+  RecordingCallbacks callbacks;
+  FastHttpParserImpl parser(MessageType::Request, callbacks, 1024);
+  const std::string request = "GET / HTTP/1.1\r\nfoo: a\r\n b\r\n\r\n";
+  EXPECT_EQ(request.size(), parser.execute(request.data(), request.size()));
+  EXPECT_THAT(callbacks.events_, ElementsAre("begin", "url:/", "field:foo", "value:a b", "headers",
+                                             "complete"));
+}
+
+TEST(FastHttpParserImplTest, ContentLengthAndChunked) {
+  RecordingCallbacks callbacks;
+  FastHttpParserImpl parser(MessageType::Request, callbacks, 1024);
+  const std::string request =
+      "POST / HTTP/1.1\r\ncontent-length: 5\r\ntransfer-encoding: chunked\r\n\r\n";
+  parser.execute(request.data(), request.size());
+  EXPECT_EQ(HPE_UNEXPECTED_CONTENT_LENGTH, parser.error());
+}
+
+TEST(FastHttpParserImplTest, Http09Request) {
+  RecordingCallbacks callbacks;
+  FastHttpParserImpl parser(MessageType::Request, callbacks, 1024);
+  const std::string request = "GET /\r\n\r\n";
+  EXPECT_EQ(request.size(), parser.execute(request.data(), request.size()));
+  EXPECT_FALSE(parser.isHttp11());
+  EXPECT_THAT(callbacks.events_, ElementsAre("begin", "url:/", "headers", "complete"));
+}
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,91 @@
+#include "common/http/http2/bdp_estimator.h"
+
+#include "test/test_common/simulated_time_system.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+class BdpEstimatorTest : public testing::Test {
+public:
+  // Run a probe that receives the given number of bytes over the given round trip.
+  bool probe(uint64_t bytes, std::chrono::milliseconds rtt) {
+    EXPECT_TRUE(estimator_.onDataReceived(1));
+    EXPECT_TRUE(estimator_.probing());
+    EXPECT_FALSE(estimator_.onDataReceived(bytes));
+    time_system_.sleep(rtt);
+    const bool grew = estimator_.onProbeAcked();
+    EXPECT_FALSE(estimator_.probing());
+    return grew;
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  BdpEstimator estimator_{65535, 1024 * 1024, time_system_};
+};
+
+// A probe that receives close to a window of data grows the estimate.
+TEST_F(BdpEstimatorTest, GrowsWhenWindowLimited) {
+  EXPECT_TRUE(probe(65535, std::chrono::milliseconds(10)));
+  EXPECT_EQ(131070, estimator_.estimate());
+}
+
+// A probe that receives much more than twice the estimate grows it to what was received.
+TEST_F(BdpEstimatorTest, GrowsToReceivedBytes) {
+  EXPECT_TRUE(probe(500000, std::chrono::milliseconds(10)));
+  EXPECT_EQ(500000, estimator_.estimate());
+}
+
+// A probe that receives little data leaves the estimate alone.
+TEST_F(BdpEstimatorTest, StableWhenNotWindowLimited) {
+  EXPECT_FALSE(probe(1000, std::chrono::milliseconds(10)));
+  EXPECT_EQ(65535, estimator_.estimate());
+}
+
+// Receiving a full window more slowly than before means the path, not the window, is the limit.
+TEST_F(BdpEstimatorTest, StableWhenBandwidthDoesNotIncrease) {
+  EXPECT_TRUE(probe(65535, std::chrono::milliseconds(10)));
+  time_system_.sleep(std::chrono::seconds(1));
+  EXPECT_FALSE(probe(131070, std::chrono::milliseconds(40)));
+  EXPECT_EQ(131070, estimator_.estimate());
+}
+
+// The estimate never grows beyond the maximum, and stops probing there.
+TEST_F(BdpEstimatorTest, CappedAtMax) {
+  EXPECT_TRUE(probe(4 * 1024 * 1024, std::chrono::milliseconds(10)));
+  EXPECT_EQ(1024 * 1024, estimator_.estimate());
+  time_system_.sleep(std::chrono::seconds(10));
+  EXPECT_FALSE(estimator_.onDataReceived(1));
+  EXPECT_FALSE(estimator_.probing());
+}
+
+// Probes wait for the probe interval, which halves while the estimate grows and backs off once it
+// is stable.
+TEST_F(BdpEstimatorTest, ProbeInterval) {
+  EXPECT_FALSE(probe(1000, std::chrono::milliseconds(10)));
+  time_system_.sleep(std::chrono::milliseconds(99));
+  EXPECT_FALSE(estimator_.onDataReceived(1));
+  time_system_.sleep(std::chrono::milliseconds(1));
+  EXPECT_TRUE(probe(65535, std::chrono::milliseconds(10)));
+
+  time_system_.sleep(std::chrono::milliseconds(49));
+  EXPECT_FALSE(estimator_.onDataReceived(1));
+  time_system_.sleep(std::chrono::milliseconds(1));
+  EXPECT_FALSE(probe(1000, std::chrono::milliseconds(10)));
+  time_system_.sleep(std::chrono::milliseconds(50));
+  // The second stable probe in a row doubles the interval, to no less than the initial one.
+  EXPECT_FALSE(probe(1000, std::chrono::milliseconds(10)));
+  time_system_.sleep(std::chrono::milliseconds(99));
+  EXPECT_FALSE(estimator_.onDataReceived(1));
+  time_system_.sleep(std::chrono::milliseconds(1));
+  EXPECT_FALSE(probe(1000, std::chrono::milliseconds(10)));
+  time_system_.sleep(std::chrono::milliseconds(199));
+  EXPECT_FALSE(estimator_.onDataReceived(1));
+  time_system_.sleep(std::chrono::milliseconds(1));
+  EXPECT_TRUE(estimator_.onDataReceived(1));
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -709,6 +709,47 @@ TEST_P(Http2CodecImplFlowControlTest, FlowControlPendingRecvData) {
   request_encoder_->encodeData(data, false);
 }
 
+// With adaptive windows, a BDP probe that receives close to a full window grows the receive
+// windows, and a sender that runs out of window counts a stall.
+TEST_P(Http2CodecImplFlowControlTest, AdaptiveWindowGrowsWhenWindowLimited) {
+  server_http2settings_.max_adaptive_window_size_ = 1024 * 1024;
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  const uint32_t initial_window =
+      nghttp2_session_get_stream_effective_local_window_size(server_->session(), 1);
+  ASSERT_EQ(65535, initial_window);
+
+  // Hold back the frames of the server, including its PING, so that the probe spans a full window
+  // of data and the client runs out of window with one byte left to send.
+  Buffer::OwnedImpl server_frames;
+  ON_CALL(server_connection_, write(_, _))
+      .WillByDefault(
+          Invoke([&](Buffer::Instance& data, bool) -> void { server_frames.move(data); }));
+  EXPECT_CALL(request_decoder_, decodeData(_, false)).Times(AnyNumber());
+  Buffer::OwnedImpl long_data(std::string(initial_window + 1, 'a'));
+  request_encoder_->encodeData(long_data, false);
+  EXPECT_EQ(1, client_->getStream(1)->pending_send_data_.length());
+  EXPECT_EQ(1, stats_store_.counter("http2.tx_flow_control_stall").value());
+  EXPECT_EQ(0, stats_store_.counter("http2.rx_window_increase").value());
+
+  // The PING ACK completes the probe, and the client applies the grown windows.
+  setupDefaultConnectionMocks();
+  client_wrapper_.dispatch(server_frames, *client_);
+  EXPECT_EQ(0, client_->getStream(1)->pending_send_data_.length());
+  EXPECT_EQ(1, stats_store_.counter("http2.rx_window_increase").value());
+  EXPECT_EQ(2 * initial_window,
+            nghttp2_session_get_stream_effective_local_window_size(server_->session(), 1));
+  EXPECT_EQ(2 * initial_window,
+            nghttp2_session_get_effective_local_window_size(server_->session()));
+  // The buffer limit of the stream stays at the initial window.
+  EXPECT_EQ(initial_window, server_->getStream(1)->bufferLimit());
+}
+
 TEST_P(Http2CodecImplTest, WatermarkUnderEndStream) {
   initialize();
   MockStreamCallbacks callbacks;
@@ -1011,6 +1052,100 @@ TEST_P(Http2CodecImplTest, TestCodecHeaderCompression) {
   }
 }
 
+TEST_P(Http2CodecImplTest, TestCodecHeaderCompressionStats) {
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  request_headers.addCopy("x-forwarded-for", "10.0.0.1");
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true));
+  request_encoder_->encodeHeaders(request_headers, true);
+
+  const uint64_t header_bytes = stats_store_.counter("http2.tx_header_bytes").value();
+  const uint64_t block_bytes = stats_store_.counter("http2.tx_header_block_bytes").value();
+  EXPECT_EQ(request_headers.byteSize(), header_bytes);
+  EXPECT_NE(0, block_bytes);
+
+  // The same headers on a second stream only cost their table indices when both sides allow a
+  // dynamic table.
+  MockStreamDecoder response_decoder2;
+  StreamEncoder* request_encoder2 = &client_->newStream(response_decoder2);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true));
+  request_encoder2->encodeHeaders(request_headers, true);
+
+  EXPECT_EQ(2 * header_bytes, stats_store_.counter("http2.tx_header_bytes").value());
+  const uint64_t second_block_bytes =
+      stats_store_.counter("http2.tx_header_block_bytes").value() - block_bytes;
+  if (client_http2settings_.hpack_table_size_ && server_http2settings_.hpack_table_size_) {
+    EXPECT_LT(second_block_bytes, block_bytes);
+  } else {
+    EXPECT_LE(second_block_bytes, block_bytes);
+  }
+}
+
+TEST_P(Http2CodecImplTest, TestCodecNeverIndexHeaders) {
+  client_http2settings_.never_index_headers_.emplace_back("x-request-id");
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true));
+  request_encoder_->encodeHeaders(request_headers, true);
+  const size_t table_size = nghttp2_session_get_hd_deflate_dynamic_table_size(client_->session());
+
+  // The default headers are already indexed, and x-request-id must not be added to either table.
+  MockStreamDecoder response_decoder2;
+  StreamEncoder* request_encoder2 = &client_->newStream(response_decoder2);
+  request_headers.addCopy("x-request-id", "3b8e8d6c-2f7a-4bd6-9a57-7c1d2b0e9f41");
+  EXPECT_CALL(request_decoder_, decodeHeaders_(HeaderMapEqual(&request_headers), true));
+  request_encoder2->encodeHeaders(request_headers, true);
+
+  EXPECT_EQ(table_size, nghttp2_session_get_hd_deflate_dynamic_table_size(client_->session()));
+  EXPECT_EQ(table_size, nghttp2_session_get_hd_inflate_dynamic_table_size(server_->session()));
+}
+
+// Common header values reference the static constants rather than being copied.
+TEST_P(Http2CodecImplTest, StaticHeaderValues) {
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  request_headers.setReferenceKey(Headers::get().ContentType,
+                                  Headers::get().ContentTypeValues.Grpc);
+  request_headers.addCopy("x-foo", "bar");
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true))
+      .WillOnce(Invoke([](HeaderMapPtr& headers, bool) -> void {
+        EXPECT_EQ(Headers::get().ContentTypeValues.Grpc.c_str(),
+                  headers->ContentType()->value().c_str());
+        EXPECT_EQ(HeaderString::Type::Reference, headers->Method()->value().type());
+        EXPECT_NE(HeaderString::Type::Reference,
+                  headers->get(LowerCaseString("x-foo"))->value().type());
+        EXPECT_EQ("bar", headers->get(LowerCaseString("x-foo"))->value().getStringView());
+      }));
+  request_encoder_->encodeHeaders(request_headers, true);
+}
+
+TEST_P(Http2CodecImplTest, TestCodecHpackEncoderTableSize) {
+  client_http2settings_.hpack_encoder_table_size_ = 0;
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true));
+  request_encoder_->encodeHeaders(request_headers, true);
+
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"compression", "test"}};
+  EXPECT_CALL(response_decoder_, decodeHeaders_(_, true));
+  response_encoder_->encodeHeaders(response_headers, true);
+
+  // The client encoder never indexes, while the server still may if both sides advertise a table.
+  EXPECT_EQ(0, nghttp2_session_get_hd_deflate_dynamic_table_size(client_->session()));
+  EXPECT_EQ(0, nghttp2_session_get_hd_inflate_dynamic_table_size(server_->session()));
+  if (client_http2settings_.hpack_table_size_ && server_http2settings_.hpack_table_size_) {
+    EXPECT_NE(0, nghttp2_session_get_hd_deflate_dynamic_table_size(server_->session()));
+  }
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
@@ -723,6 +723,124 @@ TEST_F(Http2ConnPoolImplTest, DrainedConnectionsNotActive) {
 
   closeClient(0);
 }
+
+// Verify that with several connections per host, a second connection is established once the
+// first carries streams, and that new streams go to the connection with the fewest streams.
+TEST_F(Http2ConnPoolImplTest, MultipleConnectionsLeastActiveStreams) {
+  InSequence s;
+  cluster_->http2_settings_.max_connections_per_host_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0, false);
+  expectClientConnect(0, r1);
+
+  // The first connection is busy, so the second one is established while r2 still goes to the
+  // first.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 0, true);
+
+  // Only one connection is established at a time.
+  ActiveTestRequest r3(*this, 0, true);
+
+  EXPECT_CALL(*test_clients_[1].connect_timer_, disableTimer());
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The pool is at its limit, and the second connection has no streams yet.
+  ActiveTestRequest r4(*this, 1, true);
+  ActiveTestRequest r5(*this, 1, true);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_total_.value());
+
+  completeRequest(r1);
+  completeRequest(r2);
+  completeRequest(r3);
+  completeRequest(r4);
+  completeRequest(r5);
+  closeClient(0);
+  closeClient(1);
+}
+
+// Verify that pending requests wait for the first connection, and that draining closes every
+// connection once idle.
+TEST_F(Http2ConnPoolImplTest, MultipleConnectionsPendingRequests) {
+  InSequence s;
+  cluster_->http2_settings_.max_connections_per_host_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0, false);
+  ActiveTestRequest r2(*this, 0, false);
+  expectStreamConnect(0, r1);
+  expectStreamConnect(0, r2);
+  EXPECT_CALL(*test_clients_[0].connect_timer_, disableTimer());
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  expectClientCreate();
+  ActiveTestRequest r3(*this, 0, true);
+
+  completeRequest(r1);
+  completeRequest(r2);
+  completeRequest(r3);
+
+  // Both connections are drained together.
+  ReadyWatcher drained;
+  EXPECT_CALL(dispatcher_, deferredDelete_(_)).Times(2);
+  EXPECT_CALL(drained, ready());
+  pool_.addDrainedCallback([&]() -> void { drained.ready(); });
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+// Verify that draining connections are bounded by the number of connections per host.
+TEST_F(Http2ConnPoolImplTest, MultipleConnectionsDrainConnections) {
+  InSequence s;
+  pool_.max_streams_ = 1;
+  cluster_->http2_settings_.max_connections_per_host_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0, false);
+  expectClientConnect(0, r1);
+
+  // The first connection reached its stream limit and drains.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1, false);
+  expectClientConnect(1, r2);
+
+  expectClientCreate();
+  ActiveTestRequest r3(*this, 2, false);
+  expectClientConnect(2, r3);
+
+  // Two connections are draining already, so draining the third closes the oldest one.
+  pool_.drainConnections();
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_TRUE(pool_.hasActiveConnections());
+
+  completeRequest(r2);
+  completeRequest(r3);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_FALSE(pool_.hasActiveConnections());
+}
+// Verify that a prefetched connection serves the first stream without a handshake.
+TEST_F(Http2ConnPoolImplTest, PrefetchConnection) {
+  InSequence s;
+
+  expectClientCreate();
+  pool_.prefetchConnection();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  // The pool already has a connection.
+  pool_.prefetchConnection();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(*test_clients_[0].connect_timer_, disableTimer());
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  ActiveTestRequest r1(*this, 0, true);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_prefetched_.value());
+  completeRequest(r1);
+  closeClient(0);
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
@@ -0,0 +1,106 @@
+#include "common/http/route_cache.h"
+
+#include "test/mocks/router/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+class RouteCacheTest : public testing::Test {
+public:
+  Router::RouteConstSharedPtr cacheableRoute() {
+    auto route = std::make_shared<NiceMock<Router::MockRoute>>();
+    ON_CALL(*route, cacheable()).WillByDefault(Return(true));
+    return route;
+  }
+
+  TestHeaderMapImpl headers(const std::string& path) {
+    return TestHeaderMapImpl{{":authority", "host"}, {":path", path}, {":method", "GET"}};
+  }
+
+  Router::ConfigConstSharedPtr config_{std::make_shared<NiceMock<Router::MockConfig>>()};
+};
+
+TEST_F(RouteCacheTest, FindAndInsert) {
+  RouteCache cache(10);
+  EXPECT_EQ(nullptr, cache.find(config_, headers("/")));
+
+  Router::RouteConstSharedPtr route = cacheableRoute();
+  cache.insert(config_, headers("/"), route);
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(route, cache.find(config_, headers("/")));
+  EXPECT_EQ(nullptr, cache.find(config_, headers("/?query")));
+
+  // Every key header is significant.
+  EXPECT_EQ(nullptr, cache.find(config_, TestHeaderMapImpl{{":authority", "other"},
+                                                           {":path", "/"},
+                                                           {":method", "GET"}}));
+  EXPECT_EQ(nullptr, cache.find(config_, TestHeaderMapImpl{{":authority", "host"},
+                                                           {":path", "/"},
+                                                           {":method", "POST"}}));
+  // Key headers must not run together.
+  EXPECT_EQ(nullptr, cache.find(config_, TestHeaderMapImpl{{":authority", "hos"},
+                                                           {":path", "t/"},
+                                                           {":method", "GET"}}));
+}
+
+TEST_F(RouteCacheTest, UncacheableRoute) {
+  RouteCache cache(10);
+  auto route = std::make_shared<NiceMock<Router::MockRoute>>();
+  ON_CALL(*route, cacheable()).WillByDefault(Return(false));
+  cache.insert(config_, headers("/"), route);
+  cache.insert(config_, headers("/"), nullptr);
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST_F(RouteCacheTest, MissingHeaders) {
+  RouteCache cache(10);
+  cache.insert(config_, TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}},
+               cacheableRoute());
+  EXPECT_EQ(0, cache.size());
+
+  cache.insert(config_, headers("/"), cacheableRoute());
+  EXPECT_EQ(nullptr, cache.find(config_, TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}}));
+}
+
+TEST_F(RouteCacheTest, EvictsLeastRecentlyUsed) {
+  RouteCache cache(2);
+  Router::RouteConstSharedPtr route_a = cacheableRoute();
+  Router::RouteConstSharedPtr route_b = cacheableRoute();
+  Router::RouteConstSharedPtr route_c = cacheableRoute();
+
+  cache.insert(config_, headers("/a"), route_a);
+  cache.insert(config_, headers("/b"), route_b);
+  // Touch /a so that /b becomes the least recently used entry.
+  EXPECT_EQ(route_a, cache.find(config_, headers("/a")));
+  cache.insert(config_, headers("/c"), route_c);
+
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(route_a, cache.find(config_, headers("/a")));
+  EXPECT_EQ(nullptr, cache.find(config_, headers("/b")));
+  EXPECT_EQ(route_c, cache.find(config_, headers("/c")));
+}
+
+TEST_F(RouteCacheTest, ConfigChangeClearsEntries) {
+  RouteCache cache(10);
+  Router::RouteConstSharedPtr route = cacheableRoute();
+  cache.insert(config_, headers("/"), route);
+
+  Router::ConfigConstSharedPtr new_config = std::make_shared<NiceMock<Router::MockConfig>>();
+  EXPECT_EQ(nullptr, cache.find(new_config, headers("/")));
+  EXPECT_EQ(0, cache.size());
+
+  // Entries for the old config are not resurrected.
+  EXPECT_EQ(nullptr, cache.find(config_, headers("/")));
+}
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
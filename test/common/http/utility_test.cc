@@ -264,6 +264,11 @@ TEST(HttpUtility, parseHttp2Settings) {
               http2_settings.initial_stream_window_size_);
     EXPECT_EQ(Http2Settings::DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE,
               http2_settings.initial_connection_window_size_);
+    EXPECT_FALSE(http2_settings.hpack_encoder_table_size_.has_value());
+    EXPECT_FALSE(http2_settings.max_adaptive_window_size_.has_value());
+    EXPECT_TRUE(http2_settings.never_index_headers_.empty());
+    EXPECT_EQ(Http2Settings::DEFAULT_MAX_CONNECTIONS_PER_HOST,
+              http2_settings.max_connections_per_host_);
   }
 
   {
@@ -280,6 +285,25 @@ TEST(HttpUtility, parseHttp2Settings) {
     EXPECT_EQ(3U, http2_settings.initial_stream_window_size_);
     EXPECT_EQ(4U, http2_settings.initial_connection_window_size_);
   }
+
+  {
+    envoy::api::v2::core::Http2ProtocolOptions http2_protocol_options;
+    MessageUtil::loadFromYaml(R"EOF(
+hpack_encoder_table_size: 512
+never_index_headers: ["Authorization", "x-request-id"]
+max_connections_per_host: 4
+max_adaptive_window_size: 16777216
+)EOF",
+                              http2_protocol_options);
+    auto http2_settings = Utility::parseHttp2Settings(http2_protocol_options);
+    EXPECT_EQ(Http2Settings::DEFAULT_HPACK_TABLE_SIZE, http2_settings.hpack_table_size_);
+    EXPECT_EQ(512U, http2_settings.hpack_encoder_table_size_.value());
+    EXPECT_EQ(4U, http2_settings.max_connections_per_host_);
+    EXPECT_EQ(16777216U, http2_settings.max_adaptive_window_size_.value());
+    ASSERT_EQ(2, http2_settings.never_index_headers_.size());
+    EXPECT_EQ("authorization", http2_settings.never_index_headers_[0].get());
+    EXPECT_EQ("x-request-id", http2_settings.never_index_headers_[1].get());
+  }
 }
 
 TEST(HttpUtility, getLastAddressFromXFF) {
@@ -60,6 +60,78 @@ TEST(InitTargetImplTest, ReadyWhenWatcherUnavailable) {
   EXPECT_FALSE(target.ready());
 }
 
+TEST(InitSharedTargetImplTest, Name) {
+  ExpectableSharedTargetImpl target;
+  EXPECT_EQ("shared target test", target.name());
+}
+
+TEST(InitSharedTargetImplTest, InitializeOnceForManyWatchers) {
+  InSequence s;
+
+  ExpectableSharedTargetImpl target;
+  ExpectableWatcherImpl watcher1("watcher1");
+  ExpectableWatcherImpl watcher2("watcher2");
+
+  // only the first handle to be initialized should invoke initialize()...
+  target.expectInitialize();
+  EXPECT_TRUE(target.createHandle("test1")->initialize(watcher1));
+  EXPECT_TRUE(target.createHandle("test2")->initialize(watcher2));
+
+  // calling ready() on the target should invoke both saved watcher handles...
+  watcher1.expectReady();
+  watcher2.expectReady();
+  EXPECT_TRUE(target.ready());
+
+  // calling ready() a second time should have no effect.
+  watcher1.expectReady().Times(0);
+  watcher2.expectReady().Times(0);
+  EXPECT_FALSE(target.ready());
+}
+
+TEST(InitSharedTargetImplTest, InitializeAfterReady) {
+  InSequence s;
+
+  ExpectableSharedTargetImpl target;
+  ExpectableWatcherImpl watcher1("watcher1");
+  ExpectableWatcherImpl watcher2("watcher2");
+
+  target.expectInitialize();
+  EXPECT_TRUE(target.createHandle("test1")->initialize(watcher1));
+  watcher1.expectReady();
+  EXPECT_TRUE(target.ready());
+
+  // initializing the target once it's ready should invoke the watcher without initialize().
+  target.expectInitialize().Times(0);
+  watcher2.expectReady();
+  EXPECT_TRUE(target.createHandle("test2")->initialize(watcher2));
+}
+
+TEST(InitSharedTargetImplTest, ReadyBeforeInitialize) {
+  ExpectableSharedTargetImpl target;
+  ExpectableWatcherImpl watcher;
+
+  // calling ready() before initialization begins should have no effect...
+  EXPECT_FALSE(target.ready());
+
+  // so the target should still be initialized, and only be ready once it says so.
+  target.expectInitialize();
+  watcher.expectReady().Times(0);
+  EXPECT_TRUE(target.createHandle("test")->initialize(watcher));
+}
+
+TEST(InitSharedTargetImplTest, InitializeWhenUnavailable) {
+  ExpectableWatcherImpl watcher;
+  TargetHandlePtr handle;
+  {
+    ExpectableSharedTargetImpl target;
+
+    // initializing the target after it's been destroyed should do nothing.
+    handle = target.createHandle("test");
+    target.expectInitialize().Times(0);
+  }
+  EXPECT_FALSE(handle->initialize(watcher));
+}
+
 } // namespace
 } // namespace Init
 } // namespace Envoy
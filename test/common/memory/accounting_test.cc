@@ -0,0 +1,105 @@
+#include <cstdint>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/thread.h"
+#include "common/http/header_map_impl.h"
+#include "common/memory/accounting.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Memory {
+namespace {
+
+class AccountingTest : public testing::Test {
+public:
+  // Bytes accounted to a tag since the test started.
+  int64_t bytes(AccountingTag tag) {
+    Accounting::flushForTest();
+    return static_cast<int64_t>(Accounting::bytes(tag)) - initial_bytes_[static_cast<size_t>(tag)];
+  }
+
+  void SetUp() override {
+    Accounting::flushForTest();
+    for (size_t i = 0; i < Accounting::NumTags; i++) {
+      initial_bytes_[i] = Accounting::bytes(static_cast<AccountingTag>(i));
+    }
+  }
+
+  int64_t initial_bytes_[Accounting::NumTags];
+};
+
+// Allocations and releases are accounted to their own tag only.
+TEST_F(AccountingTest, Tags) {
+  Accounting::allocated(AccountingTag::Stats, 100);
+  Accounting::allocated(AccountingTag::Config, 10);
+  EXPECT_EQ(100, bytes(AccountingTag::Stats));
+  EXPECT_EQ(10, bytes(AccountingTag::Config));
+  EXPECT_EQ(0, bytes(AccountingTag::Buffer));
+  Accounting::released(AccountingTag::Stats, 100);
+  Accounting::released(AccountingTag::Config, 10);
+  EXPECT_EQ(0, bytes(AccountingTag::Stats));
+  EXPECT_EQ(0, bytes(AccountingTag::Config));
+}
+
+// Changes are published without a flush once they amount to FlushBytes.
+TEST_F(AccountingTest, Batching) {
+  const int64_t before = Accounting::bytes(AccountingTag::Config);
+  Accounting::allocated(AccountingTag::Config, Accounting::FlushBytes - 1);
+  EXPECT_EQ(before, Accounting::bytes(AccountingTag::Config));
+  Accounting::allocated(AccountingTag::Config, 1);
+  EXPECT_EQ(before + Accounting::FlushBytes, Accounting::bytes(AccountingTag::Config));
+  Accounting::released(AccountingTag::Config, Accounting::FlushBytes);
+  EXPECT_EQ(0, bytes(AccountingTag::Config));
+}
+
+// Memory may be released by a thread other than the one that allocated it, and the changes of an
+// exiting thread are published.
+TEST_F(AccountingTest, CrossThread) {
+  Accounting::allocated(AccountingTag::Stats, 100);
+  Thread::ThreadPtr thread = Thread::threadFactoryForTest().createThread([]() -> void {
+    Accounting::released(AccountingTag::Stats, 100);
+    Accounting::allocated(AccountingTag::Stats, 20);
+  });
+  thread->join();
+  EXPECT_EQ(20, bytes(AccountingTag::Stats));
+  Accounting::released(AccountingTag::Stats, 20);
+}
+
+// AccountedBytes accounts the difference on every change, and releases its bytes on destruction.
+TEST_F(AccountingTest, AccountedBytes) {
+  {
+    AccountedBytes accounted(AccountingTag::Config);
+    accounted.set(100);
+    EXPECT_EQ(100, bytes(AccountingTag::Config));
+    accounted.set(40);
+    EXPECT_EQ(40, bytes(AccountingTag::Config));
+    EXPECT_EQ(40, accounted.value());
+  }
+  EXPECT_EQ(0, bytes(AccountingTag::Config));
+}
+
+// Buffer slices are accounted while the buffer holds them.
+TEST_F(AccountingTest, Buffer) {
+  {
+    Buffer::OwnedImpl buffer(std::string(10000, 'a'));
+    EXPECT_GE(bytes(AccountingTag::Buffer), 10000);
+  }
+  EXPECT_EQ(0, bytes(AccountingTag::Buffer));
+}
+
+// Header entries and dynamic values are accounted while the map holds them.
+TEST_F(AccountingTest, HeaderMap) {
+  {
+    Http::HeaderMapImpl headers;
+    headers.addCopy(Http::LowerCaseString("foo"), std::string(1000, 'a'));
+    EXPECT_GE(bytes(AccountingTag::HeaderMap), 1000);
+  }
+  EXPECT_EQ(0, bytes(AccountingTag::HeaderMap));
+}
+
+} // namespace
+} // namespace Memory
+} // namespace Envoy
@@ -0,0 +1,104 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include "test/mocks/network/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class MockBalancedConnectionHandler : public BalancedConnectionHandler {
+public:
+  MOCK_CONST_METHOD0(numConnections, uint64_t());
+  MOCK_METHOD0(incNumConnections, void());
+  MOCK_METHOD1(post, void(ConnectionSocketPtr&&));
+};
+
+TEST(ExactConnectionBalancerImplTest, LeastConnections) {
+  ExactConnectionBalancerImpl balancer;
+  MockBalancedConnectionHandler handler1;
+  MockBalancedConnectionHandler handler2;
+  MockBalancedConnectionHandler handler3;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  balancer.registerHandler(handler3);
+
+  EXPECT_CALL(handler1, numConnections()).WillRepeatedly(Return(2));
+  EXPECT_CALL(handler2, numConnections()).WillRepeatedly(Return(0));
+  EXPECT_CALL(handler3, numConnections()).WillRepeatedly(Return(1));
+
+  auto* raw_socket = new NiceMock<MockConnectionSocket>();
+  ConnectionSocketPtr socket(raw_socket);
+  EXPECT_CALL(handler2, incNumConnections());
+  EXPECT_CALL(handler2, post(_)).WillOnce(Invoke([raw_socket](ConnectionSocketPtr&& posted) {
+    EXPECT_EQ(raw_socket, posted.get());
+  }));
+  EXPECT_TRUE(balancer.balance(handler1, socket));
+  EXPECT_EQ(nullptr, socket);
+
+  balancer.unregisterHandler(handler1);
+  balancer.unregisterHandler(handler2);
+  balancer.unregisterHandler(handler3);
+}
+
+TEST(ExactConnectionBalancerImplTest, CurrentHandlerWinsTies) {
+  ExactConnectionBalancerImpl balancer;
+  MockBalancedConnectionHandler handler1;
+  MockBalancedConnectionHandler handler2;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+
+  EXPECT_CALL(handler1, numConnections()).WillRepeatedly(Return(1));
+  EXPECT_CALL(handler2, numConnections()).WillRepeatedly(Return(1));
+  EXPECT_CALL(handler1, post(_)).Times(0);
+
+  ConnectionSocketPtr socket(new NiceMock<MockConnectionSocket>());
+  EXPECT_FALSE(balancer.balance(handler2, socket));
+  EXPECT_NE(nullptr, socket);
+
+  balancer.unregisterHandler(handler1);
+  balancer.unregisterHandler(handler2);
+}
+
+TEST(ExactConnectionBalancerImplTest, UnregisteredHandlerIsSkipped) {
+  ExactConnectionBalancerImpl balancer;
+  MockBalancedConnectionHandler handler1;
+  MockBalancedConnectionHandler handler2;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  balancer.unregisterHandler(handler2);
+
+  EXPECT_CALL(handler1, numConnections()).WillRepeatedly(Return(5));
+  EXPECT_CALL(handler2, numConnections()).Times(0);
+  EXPECT_CALL(handler2, post(_)).Times(0);
+
+  ConnectionSocketPtr socket(new NiceMock<MockConnectionSocket>());
+  EXPECT_FALSE(balancer.balance(handler1, socket));
+  EXPECT_NE(nullptr, socket);
+
+  balancer.unregisterHandler(handler1);
+}
+
+TEST(NopConnectionBalancerImplTest, NeverBalances) {
+  NopConnectionBalancerImpl balancer;
+  MockBalancedConnectionHandler handler1;
+  MockBalancedConnectionHandler handler2;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+
+  EXPECT_CALL(handler2, post(_)).Times(0);
+  ConnectionSocketPtr socket(new NiceMock<MockConnectionSocket>());
+  EXPECT_FALSE(balancer.balance(handler1, socket));
+  EXPECT_NE(nullptr, socket);
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
@@ -10,9 +10,11 @@
 #include "common/network/connection_impl.h"
 #include "common/network/io_socket_handle_impl.h"
 #include "common/network/listen_socket_impl.h"
+#include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
 #include "common/runtime/runtime_impl.h"
 
+#include "test/mocks/api/mocks.h"
 #include "test/mocks/buffer/mocks.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/network/mocks.h"
@@ -22,6 +24,7 @@
 #include "test/test_common/network_utility.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -34,7 +37,9 @@ using testing::Eq;
 using testing::InSequence;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
+using testing::NiceMock;
 using testing::Return;
+using testing::ReturnRef;
 using testing::SaveArg;
 using testing::Sequence;
 using testing::StrictMock;
@@ -50,6 +55,60 @@ TEST(RawBufferSocket, TestBasics) {
   EXPECT_EQ("", raw_buffer_socket->protocol());
 }
 
+TEST(RawBufferSocket, ReadBudget) {
+  Api::MockOsSysCalls os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  IoSocketHandleImpl io_handle;
+  NiceMock<MockTransportSocketCallbacks> callbacks;
+  ON_CALL(callbacks, ioHandle()).WillByDefault(ReturnRef(io_handle));
+
+  RawBufferSocket socket(RawBufferSocket::DefaultReadSize, 20000);
+  socket.setTransportSocketCallbacks(callbacks);
+
+  auto read_all = [](int, const iovec* iov, int num_iov) {
+    ssize_t length = 0;
+    for (int i = 0; i < num_iov; i++) {
+      length += iov[i].iov_len;
+    }
+    return Api::SysCallSizeResult{length, 0};
+  };
+  // The second read is limited to what is left of the budget, after which the socket yields.
+  EXPECT_CALL(os_sys_calls, readv(_, _, _)).Times(2).WillRepeatedly(Invoke(read_all));
+  EXPECT_CALL(callbacks, setReadBufferReady());
+  Buffer::OwnedImpl buffer;
+  IoResult result = socket.doRead(buffer);
+  EXPECT_EQ(PostIoAction::KeepOpen, result.action_);
+  EXPECT_EQ(20000, result.bytes_processed_);
+  EXPECT_EQ(20000, buffer.length());
+}
+
+TEST(RawBufferSocket, ReadSize) {
+  Api::MockOsSysCalls os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  IoSocketHandleImpl io_handle;
+  NiceMock<MockTransportSocketCallbacks> callbacks;
+  ON_CALL(callbacks, ioHandle()).WillByDefault(ReturnRef(io_handle));
+
+  RawBufferSocket socket(256 * 1024);
+  socket.setTransportSocketCallbacks(callbacks);
+
+  // A single read covers the whole read size.
+  EXPECT_CALL(os_sys_calls, readv(_, _, _))
+      .WillOnce(Invoke([](int, const iovec* iov, int num_iov) {
+        ssize_t length = 0;
+        for (int i = 0; i < num_iov; i++) {
+          length += iov[i].iov_len;
+        }
+        EXPECT_EQ(256 * 1024, length);
+        return Api::SysCallSizeResult{length, 0};
+      }))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, EAGAIN}));
+  Buffer::OwnedImpl buffer;
+  IoResult result = socket.doRead(buffer);
+  EXPECT_EQ(PostIoAction::KeepOpen, result.action_);
+  EXPECT_EQ(256 * 1024, result.bytes_processed_);
+}
+
 TEST(ConnectionImplUtility, updateBufferStats) {
   StrictMock<Stats::MockCounter> counter;
   StrictMock<Stats::MockGauge> gauge;
@@ -97,7 +156,9 @@ protected:
     if (dispatcher_.get() == nullptr) {
       dispatcher_ = api_->allocateDispatcher();
     }
-    listener_ = dispatcher_->createListener(socket_, listener_callbacks_, true, false);
+    listener_ =
+        dispatcher_->createListener(socket_, listener_callbacks_, true, false,
+                                    Network::DefaultMaxConnectionsToAcceptPerSocketEvent);
 
     client_connection_ = dispatcher_->createClientConnection(
         socket_.localAddress(), source_address_, Network::Test::createRawBufferSocket(),
@@ -886,7 +947,9 @@ TEST_P(ConnectionImplTest, BindFailureTest) {
         new Network::Address::Ipv6Instance(address_string, 0)};
   }
   dispatcher_ = api_->allocateDispatcher();
-  listener_ = dispatcher_->createListener(socket_, listener_callbacks_, true, false);
+  listener_ =
+      dispatcher_->createListener(socket_, listener_callbacks_, true, false,
+                                  Network::DefaultMaxConnectionsToAcceptPerSocketEvent);
 
   client_connection_ = dispatcher_->createClientConnection(
       socket_.localAddress(), source_address_, Network::Test::createRawBufferSocket(), nullptr);
@@ -1574,7 +1637,9 @@ public:
   void readBufferLimitTest(uint32_t read_buffer_limit, uint32_t expected_chunk_size) {
     const uint32_t buffer_size = 256 * 1024;
     dispatcher_ = api_->allocateDispatcher();
-    listener_ = dispatcher_->createListener(socket_, listener_callbacks_, true, false);
+    listener_ =
+        dispatcher_->createListener(socket_, listener_callbacks_, true, false,
+                                    Network::DefaultMaxConnectionsToAcceptPerSocketEvent);
 
     client_connection_ = dispatcher_->createClientConnection(
         socket_.localAddress(), Network::Address::InstanceConstSharedPtr(),
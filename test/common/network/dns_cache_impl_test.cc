@@ -0,0 +1,217 @@
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "common/network/address_impl.h"
+#include "common/network/dns_cache_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Assign;
+using testing::DoAll;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class DnsCacheImplTest : public testing::Test {
+public:
+  DnsCacheImplTest()
+      : resolver_(std::make_shared<NiceMock<MockDnsResolver>>()),
+        cache_(resolver_, dispatcher_, std::chrono::milliseconds(1000), stats_store_) {}
+
+  // Expect a query of the resolver, and save its callback.
+  void expectQuery(const std::string& dns_name, DnsResolver::ResolveCb& callback) {
+    EXPECT_CALL(*resolver_, resolve(dns_name, DnsLookupFamily::V4Only, _))
+        .WillOnce(DoAll(SaveArg<2>(&callback), Return(&resolver_->active_query_)));
+  }
+
+  // Resolve a name through the cache, and return the addresses it resolved to, or "pending".
+  std::string resolve(const std::string& dns_name, ActiveDnsQuery** query = nullptr) {
+    const size_t results = results_.size();
+    ActiveDnsQuery* active_query = cache_.resolve(
+        dns_name, DnsLookupFamily::V4Only,
+        [this](const std::list<Address::InstanceConstSharedPtr>&& addresses) -> void {
+          results_.push_back(toString(addresses));
+        });
+    if (query != nullptr) {
+      *query = active_query;
+    }
+    return results_.size() > results ? results_.back() : "pending";
+  }
+
+  static std::string toString(const std::list<Address::InstanceConstSharedPtr>& addresses) {
+    std::string result;
+    for (const auto& address : addresses) {
+      result += (result.empty() ? "" : ",") + address->ip()->addressAsString();
+    }
+    return result;
+  }
+
+  static std::list<Address::InstanceConstSharedPtr> addresses(const std::string& address) {
+    return {std::make_shared<Address::Ipv4Instance>(address)};
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("dns_cache." + name).value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Stats::IsolatedStoreImpl stats_store_;
+  std::shared_ptr<NiceMock<MockDnsResolver>> resolver_;
+  DnsCacheImpl cache_;
+  std::vector<std::string> results_;
+};
+
+// Resolutions of a cached name are answered without a query until its entry expires.
+TEST_F(DnsCacheImplTest, Hit) {
+  Event::MockTimer* refresh_timer = new Event::MockTimer(&dispatcher_);
+  DnsResolver::ResolveCb callback;
+  expectQuery("foo.com", callback);
+  EXPECT_EQ("pending", resolve("foo.com"));
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(900)));
+  callback(addresses("1.2.3.4"));
+  EXPECT_EQ(std::vector<std::string>{"1.2.3.4"}, results_);
+
+  ActiveDnsQuery* query = &resolver_->active_query_;
+  EXPECT_EQ("1.2.3.4", resolve("foo.com", &query));
+  EXPECT_EQ(nullptr, query);
+  EXPECT_EQ(1, counter("hit"));
+  EXPECT_EQ(1, counter("miss"));
+  EXPECT_EQ(1, counter("query"));
+  EXPECT_EQ(1, stats_store_.gauge("dns_cache.entries").value());
+
+  // Once the entry expires, the name is queried again.
+  time_system_.sleep(std::chrono::milliseconds(1000));
+  expectQuery("foo.com", callback);
+  EXPECT_EQ("pending", resolve("foo.com"));
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(900)));
+  callback(addresses("5.6.7.8"));
+  EXPECT_EQ("5.6.7.8", results_.back());
+  EXPECT_EQ(2, counter("miss"));
+}
+
+// Resolutions of a name that is being queried wait for the query in flight.
+TEST_F(DnsCacheImplTest, Coalesce) {
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  DnsResolver::ResolveCb callback;
+  expectQuery("foo.com", callback);
+  EXPECT_EQ("pending", resolve("foo.com"));
+  ActiveDnsQuery* cancelled;
+  EXPECT_EQ("pending", resolve("foo.com", &cancelled));
+  EXPECT_EQ("pending", resolve("foo.com"));
+  cancelled->cancel();
+  callback(addresses("1.2.3.4"));
+  EXPECT_EQ((std::vector<std::string>{"1.2.3.4", "1.2.3.4"}), results_);
+  EXPECT_EQ(2, counter("coalesced"));
+  EXPECT_EQ(1, counter("query"));
+}
+
+// Failures are not cached.
+TEST_F(DnsCacheImplTest, Failure) {
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  DnsResolver::ResolveCb callback;
+  expectQuery("foo.com", callback);
+  EXPECT_EQ("pending", resolve("foo.com"));
+  callback({});
+  EXPECT_EQ(std::vector<std::string>{""}, results_);
+  EXPECT_EQ(1, counter("failure"));
+  EXPECT_EQ(0, cache_.size());
+  EXPECT_EQ(0, stats_store_.gauge("dns_cache.entries").value());
+}
+
+// A name resolved again since its last query is refreshed before its entry expires, while an
+// unused entry is dropped.
+TEST_F(DnsCacheImplTest, Refresh) {
+  Event::MockTimer* refresh_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  DnsResolver::ResolveCb callback;
+  expectQuery("foo.com", callback);
+  resolve("foo.com");
+  callback(addresses("1.2.3.4"));
+
+  EXPECT_EQ("1.2.3.4", resolve("foo.com"));
+  time_system_.sleep(std::chrono::milliseconds(900));
+  expectQuery("foo.com", callback);
+  refresh_timer->invokeCallback();
+  EXPECT_EQ(1, counter("refresh"));
+  // The cached addresses are still served while the refresh is in flight.
+  EXPECT_EQ("1.2.3.4", resolve("foo.com"));
+  callback(addresses("5.6.7.8"));
+  time_system_.sleep(std::chrono::milliseconds(900));
+  EXPECT_EQ("5.6.7.8", resolve("foo.com"));
+
+  // A failed refresh keeps the addresses until they expire.
+  expectQuery("foo.com", callback);
+  refresh_timer->invokeCallback();
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(100)))
+      .WillOnce(Assign(&refresh_timer->enabled_, true));
+  callback({});
+  EXPECT_EQ("5.6.7.8", resolve("foo.com"));
+  EXPECT_EQ(1, counter("failure"));
+
+  // Once they have expired, a failed query drops the entry.
+  time_system_.sleep(std::chrono::milliseconds(100));
+  expectQuery("foo.com", callback);
+  refresh_timer->invokeCallback();
+  callback({});
+  EXPECT_EQ(3, counter("refresh"));
+  EXPECT_EQ(0, cache_.size());
+
+  // A name that is not resolved again before its refresh is dropped.
+  Event::MockTimer* unused_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  expectQuery("bar.com", callback);
+  resolve("bar.com");
+  callback(addresses("1.2.3.4"));
+  EXPECT_EQ(1, cache_.size());
+  unused_timer->invokeCallback();
+  EXPECT_EQ(0, cache_.size());
+  EXPECT_EQ(3, counter("refresh"));
+}
+
+// A query that completes synchronously, e.g. for localhost, leaves no resolution pending.
+TEST_F(DnsCacheImplTest, SynchronousQuery) {
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  EXPECT_CALL(*resolver_, resolve("localhost", DnsLookupFamily::V4Only, _))
+      .WillOnce(Invoke([](const std::string&, DnsLookupFamily,
+                          DnsResolver::ResolveCb callback) -> ActiveDnsQuery* {
+        callback(addresses("127.0.0.1"));
+        return nullptr;
+      }));
+  ActiveDnsQuery* query = &resolver_->active_query_;
+  EXPECT_EQ("127.0.0.1", resolve("localhost", &query));
+  EXPECT_EQ(nullptr, query);
+  EXPECT_EQ("127.0.0.1", resolve("localhost"));
+  EXPECT_EQ(1, counter("query"));
+}
+
+// Destroying the cache cancels the queries in flight.
+TEST_F(DnsCacheImplTest, CancelOnDestruction) {
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  std::shared_ptr<NiceMock<MockDnsResolver>> resolver =
+      std::make_shared<NiceMock<MockDnsResolver>>();
+  auto cache = std::make_unique<DnsCacheImpl>(resolver, dispatcher_,
+                                              std::chrono::milliseconds(1000), stats_store_);
+  EXPECT_CALL(*resolver, resolve("foo.com", DnsLookupFamily::V4Only, _))
+      .WillOnce(Return(&resolver->active_query_));
+  cache->resolve("foo.com", DnsLookupFamily::V4Only,
+                 [](const std::list<Address::InstanceConstSharedPtr>&&) -> void {});
+  EXPECT_CALL(resolver->active_query_, cancel());
+  cache.reset();
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
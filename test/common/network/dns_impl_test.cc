@@ -271,6 +271,8 @@ public:
     queries_.emplace_back(query);
   }
 
+  void onAcceptBatchComplete(std::chrono::microseconds, bool) override {}
+
   void addHosts(const std::string& hostname, const IpList& ip, const record_type& type) {
     if (type == A) {
       hosts_A_[hostname] = ip;
@@ -412,7 +414,8 @@ public:
     server_ = std::make_unique<TestDnsServer>(*dispatcher_);
     socket_ = std::make_unique<Network::TcpListenSocket>(
         Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true);
-    listener_ = dispatcher_->createListener(*socket_, *server_, true, false);
+    listener_ = dispatcher_->createListener(
+        *socket_, *server_, true, false, Network::DefaultMaxConnectionsToAcceptPerSocketEvent);
 
     // Point c-ares at the listener with no search domains and TCP-only.
     peer_ = std::make_unique<DnsResolverImplPeer>(dynamic_cast<DnsResolverImpl*>(resolver_.get()));
@@ -0,0 +1,227 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/network/io_socket_handle_impl.h"
+#include "common/network/io_uring.h"
+#include "common/network/io_uring_worker.h"
+#include "common/network/raw_buffer_socket.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class MockIoUringWriteCallbacks : public IoUringWriteCallbacks {
+public:
+  MOCK_METHOD1(onWriteComplete, void(int32_t result));
+};
+
+class IoUringTestBase : public testing::Test {
+public:
+  IoUringTestBase() {
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds_));
+  }
+
+  ~IoUringTestBase() {
+    for (int fd : fds_) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+  }
+
+  // Read what the peer of the first socket received.
+  std::string receive() {
+    std::string received;
+    char buffer[16384];
+    ssize_t rc;
+    while ((rc = ::read(fds_[1], buffer, sizeof(buffer))) > 0) {
+      received.append(buffer, rc);
+    }
+    return received;
+  }
+
+  int fds_[2];
+};
+
+class IoUringTest : public IoUringTestBase {};
+
+// Operations prepared together are handed to the kernel by a single submit().
+TEST_F(IoUringTest, SubmitsPreparedWrites) {
+  IoUring ring(4);
+  if (!ring.isSupported()) {
+    return;
+  }
+  EXPECT_EQ(4, ring.entries());
+
+  char fixed[8] = "fixed";
+  const struct iovec buffer = {fixed, sizeof(fixed)};
+  const bool fixed_buffers = ring.registerBuffers(&buffer, 1);
+
+  char hello[] = "hello ";
+  char world[] = "world ";
+  const struct iovec iovecs[] = {{hello, 6}, {world, 6}};
+  EXPECT_TRUE(ring.prepareWritev(fds_[0], iovecs, 2, 1));
+  if (fixed_buffers) {
+    EXPECT_TRUE(ring.prepareWriteFixed(fds_[0], fixed, 5, 0, 2));
+  }
+  const uint32_t prepared = fixed_buffers ? 2 : 1;
+  EXPECT_EQ(prepared, ring.pending());
+  EXPECT_EQ(static_cast<int>(prepared), ring.submit());
+  EXPECT_EQ(0, ring.pending());
+
+  uint32_t reaped = 0;
+  for (int i = 0; i < 1000 && reaped < prepared; i++) {
+    reaped += ring.forEachCompletion([](uint64_t user_data, int32_t result) {
+      EXPECT_EQ(user_data == 1 ? 12 : 5, result);
+    });
+    if (reaped < prepared) {
+      usleep(1000);
+    }
+  }
+  EXPECT_EQ(prepared, reaped);
+  EXPECT_EQ(fixed_buffers ? "hello world fixed" : "hello world ", receive());
+}
+
+// A full submission queue refuses further operations until it is submitted.
+TEST_F(IoUringTest, FullSubmissionQueue) {
+  IoUring ring(2);
+  if (!ring.isSupported()) {
+    return;
+  }
+  char data[] = "x";
+  const struct iovec iovec = {data, 1};
+  EXPECT_TRUE(ring.prepareWritev(fds_[0], &iovec, 1, 1));
+  EXPECT_TRUE(ring.prepareWritev(fds_[0], &iovec, 1, 2));
+  EXPECT_FALSE(ring.prepareWritev(fds_[0], &iovec, 1, 3));
+  EXPECT_EQ(2, ring.submit());
+  EXPECT_TRUE(ring.prepareWritev(fds_[0], &iovec, 1, 3));
+}
+
+class IoUringWorkerTest : public IoUringTestBase {
+public:
+  IoUringWorkerTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher()),
+        worker_(*dispatcher_) {}
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  IoUringWorker worker_;
+};
+
+// Writes are copied out of their buffer, and submitted once the event loop iteration is over.
+TEST_F(IoUringWorkerTest, Write) {
+  if (!worker_.isSupported()) {
+    return;
+  }
+  const std::string large(IoUringWorker::FixedBufferSize + 1, 'a');
+  Buffer::OwnedImpl small_buffer("hello");
+  Buffer::OwnedImpl large_buffer(large);
+  MockIoUringWriteCallbacks small_callbacks;
+  MockIoUringWriteCallbacks large_callbacks;
+  EXPECT_NE(nullptr, worker_.write(fds_[0], small_buffer, small_callbacks));
+  EXPECT_NE(nullptr, worker_.write(fds_[0], large_buffer, large_callbacks));
+  EXPECT_EQ(2, worker_.writes());
+  EXPECT_EQ("hello", small_buffer.toString());
+  EXPECT_EQ(large.size(), large_buffer.length());
+
+  uint32_t completed = 0;
+  auto on_complete = [this, &completed](int32_t) {
+    if (++completed == 2) {
+      dispatcher_->exit();
+    }
+  };
+  EXPECT_CALL(small_callbacks, onWriteComplete(5)).WillOnce(Invoke(on_complete));
+  EXPECT_CALL(large_callbacks, onWriteComplete(static_cast<int32_t>(large.size())))
+      .WillOnce(Invoke(on_complete));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(0, worker_.writes());
+  EXPECT_EQ("hello" + large, receive());
+}
+
+// A detached write still goes ahead, even once its socket is closed.
+TEST_F(IoUringWorkerTest, Detach) {
+  if (!worker_.isSupported()) {
+    return;
+  }
+  Buffer::OwnedImpl buffer("hello");
+  MockIoUringWriteCallbacks callbacks;
+  IoUringWrite* write = worker_.write(fds_[0], buffer, callbacks);
+  ASSERT_NE(nullptr, write);
+  write->detach();
+  ::close(fds_[0]);
+  fds_[0] = -1;
+
+  EXPECT_CALL(callbacks, onWriteComplete(_)).Times(0);
+  for (int i = 0; i < 1000 && worker_.writes() > 0; i++) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    if (worker_.writes() > 0) {
+      usleep(1000);
+    }
+  }
+  EXPECT_EQ(0, worker_.writes());
+  EXPECT_EQ("hello", receive());
+}
+
+// A raw buffer socket drains its write buffer as io_uring writes complete, and only shuts down
+// its socket once the write in flight has completed.
+TEST_F(IoUringWorkerTest, RawBufferSocket) {
+  if (!worker_.isSupported()) {
+    return;
+  }
+  IoSocketHandleImpl io_handle(fds_[0]);
+  fds_[0] = -1;
+  NiceMock<MockTransportSocketCallbacks> callbacks;
+  ON_CALL(callbacks, ioHandle()).WillByDefault(ReturnRef(io_handle));
+  RawBufferSocket socket(RawBufferSocket::DefaultReadSize, 0, &worker_);
+  socket.setTransportSocketCallbacks(callbacks);
+
+  Buffer::OwnedImpl buffer("hello");
+  IoResult result = socket.doWrite(buffer, true);
+  EXPECT_EQ(PostIoAction::KeepOpen, result.action_);
+  EXPECT_EQ(0, result.bytes_processed_);
+  EXPECT_EQ(5, buffer.length());
+  // While the write is in flight, the socket writes nothing.
+  buffer.add(" world");
+  result = socket.doWrite(buffer, true);
+  EXPECT_EQ(0, result.bytes_processed_);
+
+  EXPECT_CALL(callbacks, flushWriteBuffer()).WillOnce(Invoke([this]() { dispatcher_->exit(); }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  result = socket.doWrite(buffer, true);
+  EXPECT_EQ(PostIoAction::KeepOpen, result.action_);
+  EXPECT_EQ(5, result.bytes_processed_);
+  EXPECT_EQ(" world", buffer.toString());
+
+  EXPECT_CALL(callbacks, flushWriteBuffer()).WillOnce(Invoke([this]() { dispatcher_->exit(); }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  result = socket.doWrite(buffer, true);
+  EXPECT_EQ(6, result.bytes_processed_);
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_EQ("hello world", receive());
+
+  // The socket was shut down once the buffer was empty.
+  char c;
+  EXPECT_EQ(0, ::read(fds_[1], &c, 1));
+  socket.closeSocket(ConnectionEvent::LocalClose);
+  io_handle.close();
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
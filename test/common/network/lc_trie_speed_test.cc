@@ -21,6 +21,10 @@ std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> lc_trie_nested_pref
 
 std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> lc_trie_minimal;
 
+std::vector<Envoy::Network::Address::InstanceConstSharedPtr> ipv6_addresses;
+
+std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> lc_trie_ipv6;
+
 } // namespace
 
 namespace Envoy {
@@ -56,6 +60,38 @@ static void BM_LcTrieConstructMinimal(benchmark::State& state) {
 
 BENCHMARK(BM_LcTrieConstructMinimal);
 
+// Build the trie of a large reputation list. The Arg is the number of CIDR ranges, a mix of /32
+// addresses and /24 networks spread over the IPv4 address space under 16 tags, up to close to the
+// capacity of the LC trie at the default fill factor.
+static void BM_LcTrieConstructLarge(benchmark::State& state) {
+  const uint32_t num_ranges = state.range(0);
+  std::vector<std::pair<std::string, std::vector<Envoy::Network::Address::CidrRange>>> data(16);
+  for (uint32_t i = 0; i < data.size(); i++) {
+    data[i].first = fmt::format("tag_{}", i);
+  }
+  for (uint32_t i = 0; i < num_ranges; i++) {
+    // Multiplying by an odd constant spreads the addresses without repeating any of them.
+    const uint32_t address = i * 2654435761U;
+    const bool network = i % 4 == 0;
+    data[i % data.size()].second.emplace_back(Envoy::Network::Address::CidrRange::create(
+        fmt::format("{}.{}.{}.{}/{}", address >> 24, (address >> 16) & 0xff, (address >> 8) & 0xff,
+                    network ? 0 : address & 0xff, network ? 24 : 32)));
+  }
+
+  std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> trie;
+  for (auto _ : state) {
+    trie = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(data);
+  }
+  benchmark::DoNotOptimize(trie);
+  state.SetItemsProcessed(state.iterations() * num_ranges);
+}
+
+BENCHMARK(BM_LcTrieConstructLarge)
+    ->Arg(10000)
+    ->Arg(50000)
+    ->Arg(200000)
+    ->Unit(benchmark::kMillisecond);
+
 static void BM_LcTrieLookup(benchmark::State& state) {
   static size_t i = 0;
   size_t output_tags = 0;
@@ -95,6 +131,19 @@ static void BM_LcTrieLookupMinimal(benchmark::State& state) {
 
 BENCHMARK(BM_LcTrieLookupMinimal);
 
+static void BM_LcTrieLookupIpv6(benchmark::State& state) {
+  static size_t i = 0;
+  size_t output_tags = 0;
+  for (auto _ : state) {
+    i++;
+    i %= ipv6_addresses.size();
+    output_tags += lc_trie_ipv6->getData(ipv6_addresses[i]).size();
+  }
+  benchmark::DoNotOptimize(output_tags);
+}
+
+BENCHMARK(BM_LcTrieLookupIpv6);
+
 } // namespace Envoy
 
 // Boilerplate main(), which discovers benchmarks in the same file and runs them.
@@ -132,6 +181,32 @@ int main(int argc, char** argv) {
       std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(tag_data_nested_prefixes);
   lc_trie_minimal = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(tag_data_minimal);
 
+  // Construct a set of nested IPv6 prefixes, with a /32 holding 64 /48 networks, each of which
+  // holds 16 /64 networks with a /128 address of their own, so that lookups walk deep into the
+  // trie. The test addresses are spread over the /128 addresses and the rest of the /64 networks.
+  std::vector<std::pair<std::string, std::vector<Envoy::Network::Address::CidrRange>>>
+      tag_data_ipv6{{"tag_32", {Envoy::Network::Address::CidrRange::create("2001:db8::/32")}},
+                    {"tag_48", {}},
+                    {"tag_64", {}},
+                    {"tag_128", {}}};
+  for (int i = 0; i < 64; i++) {
+    tag_data_ipv6[1].second.emplace_back(
+        Envoy::Network::Address::CidrRange::create(fmt::format("2001:db8:{:x}::/48", i * 1021)));
+    for (int j = 0; j < 16; j++) {
+      tag_data_ipv6[2].second.emplace_back(Envoy::Network::Address::CidrRange::create(
+          fmt::format("2001:db8:{:x}:{:x}::/64", i * 1021, j * 4093)));
+      tag_data_ipv6[3].second.emplace_back(Envoy::Network::Address::CidrRange::create(
+          fmt::format("2001:db8:{:x}:{:x}::{:x}/128", i * 1021, j * 4093, i * 16 + j)));
+      if (j % 4 == 0) {
+        ipv6_addresses.push_back(Envoy::Network::Utility::parseInternetAddress(
+            fmt::format("2001:db8:{:x}:{:x}::{:x}", i * 1021, j * 4093, i * 16 + j)));
+        ipv6_addresses.push_back(Envoy::Network::Utility::parseInternetAddress(
+            fmt::format("2001:db8:{:x}:{:x}::1:0", i * 1021, j * 4093)));
+      }
+    }
+  }
+  lc_trie_ipv6 = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(tag_data_ipv6);
+
   benchmark::Initialize(&argc, argv);
   if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
     return 1;
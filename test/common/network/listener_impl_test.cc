@@ -31,7 +31,8 @@ static void errorCallbackTest(Address::IpVersion version) {
   Network::MockListenerCallbacks listener_callbacks;
   Network::MockConnectionHandler connection_handler;
   Network::ListenerPtr listener =
-      dispatcher->createListener(socket, listener_callbacks, true, false);
+      dispatcher->createListener(socket, listener_callbacks, true, false,
+                                 Network::DefaultMaxConnectionsToAcceptPerSocketEvent);
 
   Network::ClientConnectionPtr client_connection = dispatcher->createClientConnection(
       socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
@@ -65,9 +66,12 @@ TEST_P(ListenerImplDeathTest, ErrorCallback) {
 class TestListenerImpl : public ListenerImpl {
 public:
   TestListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, ListenerCallbacks& cb,
-                   bool bind_to_port, bool hand_off_restored_destination_connections)
+                   bool bind_to_port, bool hand_off_restored_destination_connections,
+                   uint32_t max_connections_to_accept_per_socket_event =
+                       DefaultMaxConnectionsToAcceptPerSocketEvent)
       : ListenerImpl(dispatcher, socket, cb, bind_to_port,
-                     hand_off_restored_destination_connections) {}
+                     hand_off_restored_destination_connections,
+                     max_connections_to_accept_per_socket_event) {}
 
   MOCK_METHOD1(getLocalAddress, Address::InstanceConstSharedPtr(int fd));
 };
@@ -270,6 +274,34 @@ TEST_P(ListenerImplTest, DisableAndEnableListener) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+// With a limit of one connection per socket event, every pending connection takes an event loop
+// iteration of its own and each batch reports that the limit was reached.
+TEST_P(ListenerImplTest, MaxConnectionsToAcceptPerSocketEvent) {
+  TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(version_), nullptr, true);
+  MockListenerCallbacks listener_callbacks;
+  TestListenerImpl listener(dispatcherImpl(), socket, listener_callbacks, true, false, 1);
+
+  ClientConnectionPtr client_connection1 =
+      dispatcher_->createClientConnection(socket.localAddress(), Address::InstanceConstSharedPtr(),
+                                          Network::Test::createRawBufferSocket(), nullptr);
+  client_connection1->connect();
+  ClientConnectionPtr client_connection2 =
+      dispatcher_->createClientConnection(socket.localAddress(), Address::InstanceConstSharedPtr(),
+                                          Network::Test::createRawBufferSocket(), nullptr);
+  client_connection2->connect();
+
+  EXPECT_CALL(listener_callbacks, onAcceptBatchComplete(_, true)).Times(2);
+  EXPECT_CALL(listener_callbacks, onAccept_(_, false))
+      .WillOnce(Return())
+      .WillOnce(Invoke([&](ConnectionSocketPtr&, bool) -> void {
+        client_connection1->close(ConnectionCloseType::NoFlush);
+        client_connection2->close(ConnectionCloseType::NoFlush);
+        dispatcher_->exit();
+      }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+}
+
 } // namespace
 } // namespace Network
 } // namespace Envoy
@@ -0,0 +1,175 @@
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <string>
+#include <vector>
+
+#include "common/common/fmt.h"
+#include "common/network/address_impl.h"
+#include "common/network/listen_socket_impl.h"
+#include "common/network/reuse_port_steering_option_impl.h"
+#include "common/network/socket_option_factory.h"
+#include "common/network/socket_option_impl.h"
+
+#include "test/common/network/socket_option_test.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+#define CHECK_OPTION_SUPPORTED(option)                                                             \
+  if (!option.has_value()) {                                                                       \
+    return;                                                                                        \
+  }
+
+class ReusePortSteeringOptionImplTest : public SocketOptionTest {
+protected:
+  absl::optional<Socket::Option::Details> boundDetails(ReusePortFlowKey flow_key,
+                                                       uint32_t sockets) {
+    return ReusePortSteeringOptionImpl(flow_key, sockets)
+        .getOptionDetails(socket_, envoy::api::v2::core::SocketOption::STATE_BOUND);
+  }
+};
+
+TEST_F(ReusePortSteeringOptionImplTest, SetOptionOnceBound) {
+  ReusePortSteeringOptionImpl socket_option(ReusePortFlowKey::QuicConnectionId, 4);
+  CHECK_OPTION_SUPPORTED(ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF);
+  EXPECT_TRUE(socket_option.isSupported());
+
+  EXPECT_CALL(os_sys_calls_, setsockopt_(_, _, _, _, _)).Times(0);
+  EXPECT_TRUE(socket_option.setOption(socket_, envoy::api::v2::core::SocketOption::STATE_PREBIND));
+  EXPECT_TRUE(
+      socket_option.setOption(socket_, envoy::api::v2::core::SocketOption::STATE_LISTENING));
+
+  const auto option_name = ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF.value();
+  EXPECT_CALL(os_sys_calls_, setsockopt_(_, option_name.first, option_name.second, _, _))
+      .WillOnce(Return(0));
+  EXPECT_TRUE(socket_option.setOption(socket_, envoy::api::v2::core::SocketOption::STATE_BOUND));
+}
+
+TEST_F(ReusePortSteeringOptionImplTest, SetOptionFailure) {
+  ReusePortSteeringOptionImpl socket_option(ReusePortFlowKey::SourceIp, 4);
+  CHECK_OPTION_SUPPORTED(ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF);
+
+  EXPECT_CALL(os_sys_calls_, setsockopt_(_, _, _, _, _)).WillOnce(Return(-1));
+  EXPECT_LOG_CONTAINS(
+      "warning", "Attaching a reuse_port steering program failed",
+      EXPECT_FALSE(
+          socket_option.setOption(socket_, envoy::api::v2::core::SocketOption::STATE_BOUND)));
+}
+
+TEST_F(ReusePortSteeringOptionImplTest, GetOptionDetails) {
+  ReusePortSteeringOptionImpl socket_option(ReusePortFlowKey::SourceIp, 4);
+  CHECK_OPTION_SUPPORTED(ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF);
+
+  EXPECT_FALSE(
+      socket_option.getOptionDetails(socket_, envoy::api::v2::core::SocketOption::STATE_PREBIND)
+          .has_value());
+  const auto details =
+      socket_option.getOptionDetails(socket_, envoy::api::v2::core::SocketOption::STATE_BOUND);
+  ASSERT_TRUE(details.has_value());
+  EXPECT_EQ(ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF, details->name_);
+
+  // The program depends on the flow key and on the number of sockets.
+  EXPECT_EQ(details, boundDetails(ReusePortFlowKey::SourceIp, 4));
+  EXPECT_NE(details, boundDetails(ReusePortFlowKey::SourceIp, 3));
+  EXPECT_NE(details, boundDetails(ReusePortFlowKey::QuicConnectionId, 4));
+}
+
+// Steers datagrams across the real sockets of a reuse_port group.
+class ReusePortSteeringTest : public testing::TestWithParam<Address::IpVersion> {
+protected:
+  void bindSockets(ReusePortFlowKey flow_key) {
+    Socket::OptionsSharedPtr options = SocketOptionFactory::buildReusePortOptions();
+    options->push_back(std::make_shared<ReusePortSteeringOptionImpl>(flow_key, Sockets));
+    Address::InstanceConstSharedPtr address = Test::getCanonicalLoopbackAddress(GetParam());
+    for (uint32_t i = 0; i < Sockets; i++) {
+      sockets_.push_back(std::make_unique<UdpListenSocket>(address, options, true));
+      ASSERT_TRUE(Socket::applyOptions(options, *sockets_.back(),
+                                       envoy::api::v2::core::SocketOption::STATE_BOUND));
+      // The other sockets share the port that the first one was given.
+      address = sockets_.back()->localAddress();
+    }
+  }
+
+  // Sends a datagram from a source address and returns the index of the socket that received it.
+  uint32_t send(const Address::Instance& source, const std::string& datagram) {
+    IoHandlePtr client = source.socket(Address::SocketType::Datagram);
+    EXPECT_EQ(0, source.bind(client->fd()).rc_);
+    EXPECT_EQ(0, sockets_[0]->localAddress()->connect(client->fd()).rc_);
+    EXPECT_EQ(static_cast<ssize_t>(datagram.size()),
+              ::send(client->fd(), datagram.data(), datagram.size(), 0));
+
+    std::vector<pollfd> fds;
+    for (const auto& socket : sockets_) {
+      fds.push_back({socket->ioHandle().fd(), POLLIN, 0});
+    }
+    EXPECT_EQ(1, ::poll(fds.data(), fds.size(), 10000));
+    for (uint32_t i = 0; i < Sockets; i++) {
+      if (fds[i].revents & POLLIN) {
+        char buffer[64];
+        EXPECT_EQ(static_cast<ssize_t>(datagram.size()),
+                  ::recv(fds[i].fd, buffer, sizeof(buffer), 0));
+        return i;
+      }
+    }
+    return Sockets;
+  }
+
+  static constexpr uint32_t Sockets = 3;
+  std::vector<SocketPtr> sockets_;
+};
+
+constexpr uint32_t ReusePortSteeringTest::Sockets;
+
+INSTANTIATE_TEST_CASE_P(IpVersions, ReusePortSteeringTest,
+                        testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                        TestUtility::ipTestParamsToString);
+
+TEST_P(ReusePortSteeringTest, QuicConnectionId) {
+  CHECK_OPTION_SUPPORTED(ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF);
+  bindSockets(ReusePortFlowKey::QuicConnectionId);
+  const Address::InstanceConstSharedPtr source = Test::getCanonicalLoopbackAddress(GetParam());
+
+  for (uint32_t value = 0; value < 2 * Sockets; value++) {
+    const std::string connection_id = std::string("\x00\x00\x00", 3) + static_cast<char>(value) +
+                                      std::string("1234");
+    // Short headers and long headers route by the same connection ID.
+    EXPECT_EQ(value % Sockets, send(*source, "\x40" + connection_id + "payload"));
+    EXPECT_EQ(value % Sockets, send(*source, std::string("\xc0\xff\x00\x00\x17\x08", 6) +
+                                                 connection_id + "payload"));
+  }
+
+  // A datagram that is too short for a connection ID goes to the first socket.
+  EXPECT_EQ(0, send(*source, "\x40"));
+}
+
+TEST_P(ReusePortSteeringTest, SourceIp) {
+  CHECK_OPTION_SUPPORTED(ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF);
+  bindSockets(ReusePortFlowKey::SourceIp);
+
+  if (GetParam() == Address::IpVersion::v6) {
+    // The loopback address is the only source, whose folded words are 1.
+    const Address::Ipv6Instance source("::1", 0);
+    for (uint32_t i = 0; i < Sockets; i++) {
+      EXPECT_EQ(1 % Sockets, send(source, "payload"));
+    }
+    return;
+  }
+
+  // The datagrams of a source address go to the same socket whatever their source port.
+  for (uint32_t host = 1; host <= 2 * Sockets; host++) {
+    const Address::Ipv4Instance source(fmt::format("127.0.0.{}", host), 0);
+    const uint32_t expected = ((127U << 24) + host) % Sockets;
+    EXPECT_EQ(expected, send(source, "payload"));
+    EXPECT_EQ(expected, send(source, "payload"));
+  }
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
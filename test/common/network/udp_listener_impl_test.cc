@@ -29,11 +29,10 @@ public:
   TestUdpListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, UdpListenerCallbacks& cb)
       : UdpListenerImpl(dispatcher, socket, cb) {}
 
-  MOCK_METHOD2(doRecvFrom,
-               UdpListenerImpl::ReceiveResult(sockaddr_storage& peer_addr, socklen_t& addr_len));
+  MOCK_METHOD1(doRecvBatch, Api::SysCallIntResult(const UdpPacketBatch::ReceiveCb& cb));
 
-  UdpListenerImpl::ReceiveResult doRecvFrom_(sockaddr_storage& peer_addr, socklen_t& addr_len) {
-    return UdpListenerImpl::doRecvFrom(peer_addr, addr_len);
+  Api::SysCallIntResult doRecvBatch_(const UdpPacketBatch::ReceiveCb& cb) {
+    return UdpListenerImpl::doRecvBatch(cb);
   }
 };
 
@@ -141,10 +140,9 @@ TEST_P(UdpListenerImplTest, UseActualDstUdp) {
   Network::MockUdpListenerCallbacks listener_callbacks;
   Network::TestUdpListenerImpl listener(dispatcherImpl(), *server_socket.get(), listener_callbacks);
 
-  EXPECT_CALL(listener, doRecvFrom(_, _))
-      .WillRepeatedly(Invoke([&](sockaddr_storage& peer_addr, socklen_t& addr_len) {
-        return listener.doRecvFrom_(peer_addr, addr_len);
-      }));
+  EXPECT_CALL(listener, doRecvBatch(_))
+      .WillRepeatedly(Invoke(
+          [&](const UdpPacketBatch::ReceiveCb& cb) { return listener.doRecvBatch_(cb); }));
 
   // Setup client socket.
   SocketPtr client_socket =
@@ -227,10 +225,9 @@ TEST_P(UdpListenerImplTest, UdpEcho) {
   Network::MockUdpListenerCallbacks listener_callbacks;
   Network::TestUdpListenerImpl listener(dispatcherImpl(), *server_socket.get(), listener_callbacks);
 
-  EXPECT_CALL(listener, doRecvFrom(_, _))
-      .WillRepeatedly(Invoke([&](sockaddr_storage& peer_addr, socklen_t& addr_len) {
-        return listener.doRecvFrom_(peer_addr, addr_len);
-      }));
+  EXPECT_CALL(listener, doRecvBatch(_))
+      .WillRepeatedly(Invoke(
+          [&](const UdpPacketBatch::ReceiveCb& cb) { return listener.doRecvBatch_(cb); }));
 
   // Setup client socket.
   SocketPtr client_socket =
@@ -361,10 +358,9 @@ TEST_P(UdpListenerImplTest, UdpListenerEnableDisable) {
   Network::MockUdpListenerCallbacks listener_callbacks;
   Network::TestUdpListenerImpl listener(dispatcherImpl(), *server_socket.get(), listener_callbacks);
 
-  EXPECT_CALL(listener, doRecvFrom(_, _))
-      .WillRepeatedly(Invoke([&](sockaddr_storage& peer_addr, socklen_t& addr_len) {
-        return listener.doRecvFrom_(peer_addr, addr_len);
-      }));
+  EXPECT_CALL(listener, doRecvBatch(_))
+      .WillRepeatedly(Invoke(
+          [&](const UdpPacketBatch::ReceiveCb& cb) { return listener.doRecvBatch_(cb); }));
 
   // Setup client socket.
   SocketPtr client_socket =
@@ -461,9 +457,10 @@ TEST_P(UdpListenerImplTest, UdpListenerRecvFromError) {
   Network::MockUdpListenerCallbacks listener_callbacks;
   Network::TestUdpListenerImpl listener(dispatcherImpl(), *server_socket.get(), listener_callbacks);
 
-  EXPECT_CALL(listener, doRecvFrom(_, _)).WillRepeatedly(Invoke([&](sockaddr_storage&, socklen_t&) {
-    return UdpListenerImpl::ReceiveResult{{-1, -1}, nullptr};
-  }));
+  EXPECT_CALL(listener, doRecvBatch(_))
+      .WillRepeatedly(Invoke([&](const UdpPacketBatch::ReceiveCb&) {
+        return Api::SysCallIntResult{-1, -1};
+      }));
 
   SocketPtr client_socket =
       getSocket(Address::SocketType::Datagram, Network::Test::getCanonicalLoopbackAddress(version_),
@@ -505,6 +502,71 @@ TEST_P(UdpListenerImplTest, UdpListenerRecvFromError) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+/**
+ * Tests that the datagrams received by a system call are followed by their batch completion, and
+ * that the listener sends a batch of datagrams from its socket.
+ */
+TEST_P(UdpListenerImplTest, UdpBatchReceiveAndSend) {
+  SocketPtr server_socket =
+      getSocket(Address::SocketType::Datagram, Network::Test::getCanonicalLoopbackAddress(version_),
+                nullptr, true);
+  Network::MockUdpListenerCallbacks listener_callbacks;
+  UdpListenerImpl listener(dispatcherImpl(), *server_socket, listener_callbacks);
+  EXPECT_EQ(&dispatcherImpl(), &listener.dispatcher());
+  EXPECT_EQ(server_socket->localAddress(), listener.localAddress());
+
+  SocketPtr client_socket =
+      getSocket(Address::SocketType::Datagram, Network::Test::getCanonicalLoopbackAddress(version_),
+                nullptr, true);
+  sockaddr_storage server_addr;
+  socklen_t addr_len;
+  getSocketAddressInfo(*client_socket, server_socket->localAddress()->ip()->port(), server_addr,
+                       addr_len);
+  ASSERT_GT(addr_len, 0);
+
+  const std::vector<std::string> requests{"first", "second", "third"};
+  for (const std::string& request : requests) {
+    ASSERT_EQ(request.length(),
+              ::sendto(client_socket->ioHandle().fd(), request.c_str(), request.length(), 0,
+                       reinterpret_cast<const struct sockaddr*>(&server_addr), addr_len));
+  }
+
+  std::vector<std::string> received;
+  EXPECT_CALL(listener_callbacks, onData_(_))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](const UdpData& data) -> void {
+        EXPECT_EQ(client_socket->localAddress()->asString(), data.peer_address_->asString());
+        received.push_back(data.buffer_->toString());
+      }));
+
+  uint32_t batched = 0;
+  Buffer::OwnedImpl response1("response1");
+  Buffer::OwnedImpl response2("response2");
+  EXPECT_CALL(listener_callbacks, onReceiveBatchComplete(_))
+      .WillRepeatedly(Invoke([&](uint32_t datagrams) -> void {
+        batched += datagrams;
+        EXPECT_EQ(batched, received.size());
+        if (batched == requests.size()) {
+          const Api::SysCallIntResult result =
+              listener.send({{*client_socket->localAddress(), response1},
+                             {*client_socket->localAddress(), response2}});
+          EXPECT_EQ(2, result.rc_);
+          dispatcher_->exit();
+        }
+      }));
+  EXPECT_CALL(listener_callbacks, onWriteReady_(_)).WillRepeatedly(Return());
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(requests, received);
+
+  for (const char* expected : {"response1", "response2"}) {
+    char buffer[16];
+    const ssize_t rc = ::recv(client_socket->ioHandle().fd(), buffer, sizeof(buffer), 0);
+    ASSERT_GT(rc, 0);
+    EXPECT_EQ(expected, std::string(buffer, rc));
+  }
+}
+
 } // namespace
 } // namespace Network
 } // namespace Envoy
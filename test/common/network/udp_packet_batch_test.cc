@@ -0,0 +1,145 @@
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/network/address_impl.h"
+#include "common/network/listen_socket_impl.h"
+#include "common/network/udp_packet_batch.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class UdpPacketBatchTest : public testing::TestWithParam<Address::IpVersion> {
+public:
+  UdpPacketBatchTest()
+      : server_(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true),
+        client_(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true) {}
+
+  void connectClient() {
+    ASSERT_EQ(0, server_.localAddress()->connect(client_.ioHandle().fd()).rc_);
+  }
+
+  // Receive the datagrams queued on the server socket.
+  std::vector<std::string> receive(UdpPacketBatch& batch, uint32_t& messages) {
+    std::vector<std::string> datagrams;
+    const Api::SysCallIntResult result = batch.receive(
+        server_.ioHandle().fd(), true,
+        [&](const Address::InstanceConstSharedPtr& peer_address, Buffer::InstancePtr&& buffer) {
+          EXPECT_EQ(client_.localAddress()->asString(), peer_address->asString());
+          datagrams.push_back(buffer->toString());
+        });
+    EXPECT_GE(result.rc_, 0);
+    messages = result.rc_;
+    return datagrams;
+  }
+
+  UdpListenSocket server_;
+  UdpListenSocket client_;
+};
+
+INSTANTIATE_TEST_CASE_P(IpVersions, UdpPacketBatchTest,
+                        testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                        TestUtility::ipTestParamsToString);
+
+// Datagrams made of several slices are sent whole, and the queued datagrams are received together
+// where recvmmsg() is available.
+TEST_P(UdpPacketBatchTest, SendAndReceive) {
+  connectClient();
+  std::vector<Buffer::InstancePtr> datagrams;
+  for (const std::string& datagram : {"first", "second", "third"}) {
+    Buffer::InstancePtr buffer = std::make_unique<Buffer::OwnedImpl>(datagram);
+    Buffer::OwnedImpl suffix("!");
+    buffer->move(suffix);
+    datagrams.push_back(std::move(buffer));
+  }
+  EXPECT_EQ(3, UdpPacketBatch::send(client_.ioHandle().fd(), datagrams).rc_);
+
+  UdpPacketBatch batch(false);
+  uint32_t messages;
+  std::vector<std::string> received;
+  while (received.size() < 3) {
+    const std::vector<std::string> batch_received = receive(batch, messages);
+    EXPECT_EQ(batch_received.size(), messages);
+    received.insert(received.end(), batch_received.begin(), batch_received.end());
+    if (UdpPacketBatch::MaxBatchSize > 1) {
+      EXPECT_EQ(3, messages);
+    }
+  }
+  EXPECT_EQ((std::vector<std::string>{"first!", "second!", "third!"}), received);
+
+  // Nothing is left on the socket.
+  const Api::SysCallIntResult result = batch.receive(
+      server_.ioHandle().fd(), true,
+      [](const Address::InstanceConstSharedPtr&, Buffer::InstancePtr&&) { FAIL(); });
+  EXPECT_EQ(-1, result.rc_);
+  EXPECT_EQ(EAGAIN, result.errno_);
+}
+
+TEST_P(UdpPacketBatchTest, SendTo) {
+  Buffer::OwnedImpl first("first");
+  Buffer::OwnedImpl second("second");
+  const Address::Instance& server_address = *server_.localAddress();
+  EXPECT_EQ(2, UdpPacketBatch::sendTo(client_.ioHandle().fd(), *client_.localAddress(),
+                                      {{server_address, first}, {server_address, second}})
+                   .rc_);
+
+  UdpPacketBatch batch(false);
+  uint32_t messages;
+  std::vector<std::string> received = receive(batch, messages);
+  if (received.size() < 2) {
+    const std::vector<std::string> rest = receive(batch, messages);
+    received.insert(received.end(), rest.begin(), rest.end());
+  }
+  EXPECT_EQ((std::vector<std::string>{"first", "second"}), received);
+}
+
+// Datagrams larger than the maximum datagram size are truncated.
+TEST_P(UdpPacketBatchTest, Truncate) {
+  connectClient();
+  std::vector<Buffer::InstancePtr> datagrams;
+  datagrams.push_back(
+      std::make_unique<Buffer::OwnedImpl>(std::string(UdpPacketBatch::MaxDatagramSize + 1, 'a')));
+  EXPECT_EQ(1, UdpPacketBatch::send(client_.ioHandle().fd(), datagrams).rc_);
+
+  UdpPacketBatch batch(false);
+  uint32_t messages;
+  const std::vector<std::string> received = receive(batch, messages);
+  ASSERT_EQ(1, received.size());
+  EXPECT_EQ(UdpPacketBatch::MaxDatagramSize, received[0].size());
+}
+
+TEST(UdpPacketBatchPeerAddressTest, Ipv4MappedAddress) {
+  sockaddr_storage address;
+  memset(&address, 0, sizeof(address));
+  sockaddr_in6* sin6 = reinterpret_cast<sockaddr_in6*>(&address);
+  sin6->sin6_family = AF_INET6;
+  sin6->sin6_port = htons(53);
+  ASSERT_EQ(1, inet_pton(AF_INET6, "::ffff:1.2.3.4", &sin6->sin6_addr));
+
+  EXPECT_EQ("1.2.3.4:53", UdpPacketBatch::peerAddress(address, sizeof(sockaddr_in6))->asString());
+}
+
+TEST(UdpPacketBatchPeerAddressTest, Ipv6Address) {
+  sockaddr_storage address;
+  memset(&address, 0, sizeof(address));
+  sockaddr_in6* sin6 = reinterpret_cast<sockaddr_in6*>(&address);
+  sin6->sin6_family = AF_INET6;
+  sin6->sin6_port = htons(53);
+  ASSERT_EQ(1, inet_pton(AF_INET6, "1::2", &sin6->sin6_addr));
+
+  EXPECT_EQ("[1::2]:53", UdpPacketBatch::peerAddress(address, sizeof(sockaddr_in6))->asString());
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "common/common/thread.h"
+#include "common/profiler/cpu_sampler.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Profiler {
+namespace {
+
+// Burns CPU until the sampler records at least one more sample, or a generous deadline passes.
+void burnUntilSampled() {
+  const uint64_t samples = CpuSampler::samples();
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  volatile uint64_t sink = 0;
+  while (CpuSampler::samples() == samples && std::chrono::steady_clock::now() < deadline) {
+    for (uint64_t i = 0; i < 100000; i++) {
+      sink = sink + i;
+    }
+  }
+}
+
+// Decodes the words of a profile up to the end of its trailer.
+std::vector<uintptr_t> profileWords(const std::string& profile) {
+  std::vector<uintptr_t> words(profile.size() / sizeof(uintptr_t));
+  memcpy(words.data(), profile.data(), words.size() * sizeof(uintptr_t));
+  return words;
+}
+
+TEST(CpuSamplerTest, InvalidFrequency) {
+  EXPECT_FALSE(CpuSampler::start(0));
+  EXPECT_FALSE(CpuSampler::start(CpuSampler::MaxFrequencyHz + 1));
+  EXPECT_FALSE(CpuSampler::running());
+}
+
+// A registered thread records its stacks, which show up in the profile.
+TEST(CpuSamplerTest, Profile) {
+  CpuSampler::ScopedThread sampled_thread;
+  ASSERT_TRUE(CpuSampler::start(1000));
+  EXPECT_TRUE(CpuSampler::running());
+  burnUntilSampled();
+  CpuSampler::stop();
+  EXPECT_FALSE(CpuSampler::running());
+
+  const std::vector<uintptr_t> words = profileWords(CpuSampler::profile());
+  ASSERT_GE(words.size(), 8);
+  EXPECT_EQ((std::vector<uintptr_t>{0, 3, 0, 1000, 0}),
+            std::vector<uintptr_t>(words.begin(), words.begin() + 5));
+  // The first record holds a sample of at least one frame.
+  EXPECT_GE(words[5], 1);
+  EXPECT_GE(words[6], 1);
+  EXPECT_LE(words[6], CpuSampler::MaxStackDepth);
+}
+
+// Threads that register while sampling is started record too, and their samples go away with
+// them.
+TEST(CpuSamplerTest, ThreadRegisteredWhileRunning) {
+  ASSERT_TRUE(CpuSampler::start(1000));
+  uint64_t samples = 0;
+  Thread::ThreadPtr thread =
+      Thread::threadFactoryForTest().createThread([&samples]() -> void {
+        CpuSampler::ScopedThread sampled_thread;
+        burnUntilSampled();
+        samples = CpuSampler::samples();
+      });
+  thread->join();
+  CpuSampler::stop();
+  EXPECT_GT(samples, 0);
+
+  // Only the header and the trailer are left.
+  const std::vector<uintptr_t> words = profileWords(CpuSampler::profile());
+  ASSERT_GE(words.size(), 8);
+  EXPECT_EQ((std::vector<uintptr_t>{0, 3, 0, 1000, 0, 0, 1, 0}),
+            std::vector<uintptr_t>(words.begin(), words.begin() + 8));
+}
+
+} // namespace
+} // namespace Profiler
+} // namespace Envoy
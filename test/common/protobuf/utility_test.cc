@@ -120,6 +120,31 @@ TEST_F(ProtobufUtilityTest, RepeatedPtrUtilDebugString) {
   EXPECT_EQ("[value: 10\n, value: 20\n]", RepeatedPtrUtil::debugString(repeated));
 }
 
+// The streaming hash matches the hash of the deterministic serialization, including for messages
+// that span several buffers of the hashing stream.
+TEST_F(ProtobufUtilityTest, MessageUtilHash) {
+  envoy::config::bootstrap::v2::Bootstrap bootstrap;
+  EXPECT_EQ(HashUtil::xxHash64(""), MessageUtil::hash(bootstrap));
+  for (uint32_t i = 0; i < 200; i++) {
+    bootstrap.mutable_static_resources()->add_clusters()->set_name("cluster_" + std::to_string(i));
+  }
+
+  ProtobufTypes::String text;
+  {
+    Protobuf::io::StringOutputStream string_stream(&text);
+    Protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    bootstrap.SerializeToCodedStream(&coded_stream);
+  }
+  EXPECT_GT(text.size(), 1024);
+  EXPECT_EQ(HashUtil::xxHash64(text), MessageUtil::hash(bootstrap));
+
+  Protobuf::RepeatedPtrField<envoy::config::bootstrap::v2::Bootstrap> repeated;
+  *repeated.Add() = bootstrap;
+  *repeated.Add() = bootstrap;
+  EXPECT_EQ(HashUtil::xxHash64(text + text), RepeatedPtrUtil::hash(repeated));
+}
+
 TEST_F(ProtobufUtilityTest, DowncastAndValidate) {
   envoy::config::bootstrap::v2::Bootstrap bootstrap;
   bootstrap.mutable_runtime();
@@ -333,6 +358,20 @@ TEST_F(ProtobufUtilityTest, AnyConvertWrongFields) {
                             "Protobuf message (type google.protobuf.Timestamp) has unknown fields");
 }
 
+TEST_F(ProtobufUtilityTest, UnpackTo) {
+  ProtobufWkt::Duration source_duration;
+  source_duration.set_seconds(42);
+  ProtobufWkt::Any source_any;
+  source_any.PackFrom(source_duration);
+  ProtobufWkt::Duration dest_duration;
+  MessageUtil::unpackTo(source_any, dest_duration);
+  EXPECT_EQ(42, dest_duration.seconds());
+
+  ProtobufWkt::Timestamp dest_timestamp;
+  EXPECT_THROW_WITH_REGEX(MessageUtil::unpackTo(source_any, dest_timestamp), EnvoyException,
+                          "Unable to unpack .*");
+}
+
 TEST_F(ProtobufUtilityTest, JsonConvertSuccess) {
   ProtobufWkt::Duration source_duration;
   source_duration.set_seconds(42);
@@ -1,5 +1,6 @@
 #include <chrono>
 #include <fstream>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
@@ -569,6 +570,105 @@ virtual_hosts:
             config.route(genHeaders("example.com", "/", "GET"), 0)->routeEntry()->clusterName());
 }
 
+TEST_F(RouteMatcherTest, TestRoutesWithPrefixAndSuffixWildcards) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: suffix
+    domains: ["*.solo.io"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "suffix" }
+  - name: longer_suffix
+    domains: ["*.gloo.solo.io"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "longer_suffix" }
+  - name: prefix
+    domains: ["api.*"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "prefix" }
+  - name: longer_prefix
+    domains: ["api.solo.*", "API-*"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "longer_prefix" }
+  - name: default
+    domains: ["*"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "default" }
+  )EOF";
+
+  const auto proto_config = parseRouteConfigurationFromV2Yaml(yaml);
+  TestConfigImpl config(proto_config, factory_context_, true);
+
+  auto cluster_name = [&config](const std::string& host) -> std::string {
+    return config.route(genHeaders(host, "/", "GET"), 0)->routeEntry()->clusterName();
+  };
+
+  EXPECT_EQ("suffix", cluster_name("www.solo.io"));
+  EXPECT_EQ("longer_suffix", cluster_name("www.gloo.solo.io"));
+  EXPECT_EQ("suffix", cluster_name(".gloo.solo.io"));
+  EXPECT_EQ("prefix", cluster_name("api.example.com"));
+  EXPECT_EQ("longer_prefix", cluster_name("api.solo.com"));
+  EXPECT_EQ("longer_prefix", cluster_name("api-v1.example.com"));
+  // Suffix wildcards are preferred over prefix wildcards.
+  EXPECT_EQ("suffix", cluster_name("api.solo.io"));
+  // The wildcard never matches the empty string.
+  EXPECT_EQ("default", cluster_name("api."));
+  EXPECT_EQ("default", cluster_name("example.com"));
+}
+
+// Validates that indexed (prefix/path) and unindexed (regex, case insensitive, header
+// conditional) routes are still evaluated in configuration order.
+TEST_F(RouteMatcherTest, TestRoutesFirstMatchWithMixedRouteTypes) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: mixed
+    domains: ["*"]
+    routes:
+      - match:
+          prefix: "/api"
+          headers:
+            - name: x-canary
+              exact_match: "true"
+        route: { cluster: "canary" }
+      - match: { regex: "/api/v[0-9]+/special" }
+        route: { cluster: "regex" }
+      - match: { path: "/api/v1/users" }
+        route: { cluster: "users" }
+      - match: { prefix: "/API/V1", case_sensitive: false }
+        route: { cluster: "insensitive" }
+      - match: { prefix: "/api/v1" }
+        route: { cluster: "v1" }
+      - match: { path: "/api/v1/users" }
+        route: { cluster: "shadowed" }
+      - match: { prefix: "/" }
+        route: { cluster: "default" }
+  )EOF";
+
+  const auto proto_config = parseRouteConfigurationFromV2Yaml(yaml);
+  TestConfigImpl config(proto_config, factory_context_, true);
+
+  auto cluster_name = [&config](const Http::TestHeaderMapImpl& headers) -> std::string {
+    return config.route(headers, 0)->routeEntry()->clusterName();
+  };
+
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("example.com", "/api/v1/users", "GET");
+    headers.addCopy("x-canary", "true");
+    EXPECT_EQ("canary", cluster_name(headers));
+  }
+  EXPECT_EQ("regex", cluster_name(genHeaders("example.com", "/api/v2/special", "GET")));
+  EXPECT_EQ("users", cluster_name(genHeaders("example.com", "/api/v1/users", "GET")));
+  EXPECT_EQ("users", cluster_name(genHeaders("example.com", "/api/v1/users?a=b", "GET")));
+  EXPECT_EQ("insensitive", cluster_name(genHeaders("example.com", "/api/v1/groups", "GET")));
+  EXPECT_EQ("insensitive", cluster_name(genHeaders("example.com", "/Api/V1/users/1", "GET")));
+  EXPECT_EQ("default", cluster_name(genHeaders("example.com", "/api/v2/other", "GET")));
+  EXPECT_EQ("default", cluster_name(genHeaders("example.com", "/", "GET")));
+}
+
 TEST_F(RouteMatcherTest, TestRoutesWithInvalidRegex) {
   std::string invalid_route = R"EOF(
 virtual_hosts:
@@ -602,6 +702,178 @@ virtual_hosts:
                           EnvoyException, "Invalid regex '\\^/\\(\\+invalid\\)':");
 }
 
+TEST_F(RouteMatcherTest, TestRoutesWithSafeRegex) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: regex
+    domains: ["*"]
+    routes:
+      - match:
+          safe_regex:
+            google_re2: {}
+            regex: "/api/v[0-9]+/(users|groups)"
+        route: { cluster: "safe_regex" }
+      - match: { prefix: "/" }
+        route: { cluster: "default" }
+  )EOF";
+
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, true);
+
+  auto cluster_name = [&config](const Http::TestHeaderMapImpl& headers) -> std::string {
+    return config.route(headers, 0)->routeEntry()->clusterName();
+  };
+
+  EXPECT_EQ("safe_regex", cluster_name(genHeaders("example.com", "/api/v1/users", "GET")));
+  // The query string is not part of the match.
+  EXPECT_EQ("safe_regex", cluster_name(genHeaders("example.com", "/api/v2/groups?a=b", "GET")));
+  EXPECT_EQ("default", cluster_name(genHeaders("example.com", "/api/v1/users/1", "GET")));
+  EXPECT_EQ("default", cluster_name(genHeaders("example.com", "/api/vx/users", "GET")));
+}
+
+TEST_F(RouteMatcherTest, TestRoutesWithInvalidSafeRegex) {
+  const std::string invalid_route = R"EOF(
+virtual_hosts:
+  - name: regex
+    domains: ["*"]
+    routes:
+      - match:
+          safe_regex:
+            google_re2: {}
+            regex: "/(+invalid)"
+        route: { cluster: "regex" }
+  )EOF";
+
+  EXPECT_THROW_WITH_REGEX(
+      TestConfigImpl(parseRouteConfigurationFromV2Yaml(invalid_route), factory_context_, true),
+      EnvoyException, "repetition operator");
+}
+
+// Validates that unchanged virtual hosts are shared with the previous configuration.
+TEST_F(RouteMatcherTest, TestVirtualHostReuse) {
+  const std::string yaml = R"EOF(
+name: foo
+virtual_hosts:
+  - name: www
+    domains: ["www.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "www" }
+  - name: api
+    domains: ["api.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "api" }
+  )EOF";
+
+  auto virtual_host = [](const Config& config, const std::string& host) -> const VirtualHost* {
+    return &config.route(genHeaders(host, "/", "GET"), 0)->routeEntry()->virtualHost();
+  };
+
+  const auto proto_config = parseRouteConfigurationFromV2Yaml(yaml);
+  ConfigImpl first(proto_config, factory_context_, false);
+  EXPECT_EQ(0, first.virtualHostsReused());
+  EXPECT_EQ(2, first.virtualHostsBuilt());
+
+  // Only the api virtual host changes.
+  auto changed_config = proto_config;
+  changed_config.mutable_virtual_hosts(1)->mutable_routes(0)->mutable_route()->set_cluster("api2");
+  ConfigImpl second(changed_config, factory_context_, false, &first);
+  EXPECT_EQ(1, second.virtualHostsReused());
+  EXPECT_EQ(1, second.virtualHostsBuilt());
+  EXPECT_EQ(virtual_host(first, "www.lyft.com"), virtual_host(second, "www.lyft.com"));
+  EXPECT_NE(virtual_host(first, "api.lyft.com"), virtual_host(second, "api.lyft.com"));
+  EXPECT_EQ("api2", second.route(genHeaders("api.lyft.com", "/", "GET"), 0)
+                        ->routeEntry()
+                        ->clusterName());
+  EXPECT_EQ("foo", virtual_host(second, "www.lyft.com")->routeConfig().name());
+
+  // A change outside of the virtual hosts rebuilds everything.
+  auto common_changed_config = changed_config;
+  common_changed_config.add_internal_only_headers("x-internal");
+  ConfigImpl third(common_changed_config, factory_context_, false, &second);
+  EXPECT_EQ(0, third.virtualHostsReused());
+  EXPECT_EQ(2, third.virtualHostsBuilt());
+  EXPECT_EQ(1, virtual_host(third, "www.lyft.com")->routeConfig().internalOnlyHeaders().size());
+
+  // Nothing is reused when clusters are validated.
+  ConfigImpl validated(changed_config, factory_context_, true, &second);
+  EXPECT_EQ(0, validated.virtualHostsReused());
+  EXPECT_EQ(2, validated.virtualHostsBuilt());
+}
+
+TEST_F(RouteMatcherTest, TestRouteCacheable) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: simple
+    domains: ["simple.lyft.com"]
+    routes:
+      - match:
+          prefix: "/method"
+          headers:
+            - name: ":method"
+              exact_match: "POST"
+        route: { cluster: "method" }
+      - match: { prefix: "/weighted" }
+        route:
+          weighted_clusters:
+            clusters:
+              - name: "a"
+                weight: 50
+              - name: "b"
+                weight: 50
+      - match: { prefix: "/" }
+        route: { cluster: "simple" }
+  - name: headers
+    domains: ["headers.lyft.com"]
+    routes:
+      - match: { prefix: "/before" }
+        route: { cluster: "before" }
+      - match:
+          prefix: "/"
+          headers:
+            - name: "x-foo"
+              exact_match: "bar"
+        route: { cluster: "foo" }
+      - match: { prefix: "/" }
+        route: { cluster: "after" }
+  - name: runtime
+    domains: ["runtime.lyft.com"]
+    routes:
+      - match:
+          prefix: "/"
+          runtime_fraction:
+            default_value: { numerator: 50 }
+            runtime_key: "bogus"
+        route: { cluster: "runtime" }
+      - match: { prefix: "/" }
+        route: { cluster: "fallback" }
+  - name: tls
+    domains: ["tls.lyft.com"]
+    require_tls: ALL
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "tls" }
+  )EOF";
+
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, true);
+
+  auto cacheable = [&config](const std::string& host, const std::string& path) {
+    Http::TestHeaderMapImpl headers = genHeaders(host, path, "GET");
+    headers.addCopy("x-forwarded-proto", "https");
+    return config.route(headers, 0)->cacheable();
+  };
+
+  EXPECT_TRUE(cacheable("simple.lyft.com", "/method"));
+  EXPECT_TRUE(cacheable("simple.lyft.com", "/"));
+  // The cluster is picked per request.
+  EXPECT_FALSE(cacheable("simple.lyft.com", "/weighted"));
+  // Only routes before the first route with a non-key header matcher are cacheable.
+  EXPECT_TRUE(cacheable("headers.lyft.com", "/before"));
+  EXPECT_FALSE(cacheable("headers.lyft.com", "/after"));
+  EXPECT_FALSE(cacheable("runtime.lyft.com", "/"));
+  EXPECT_FALSE(cacheable("tls.lyft.com", "/"));
+}
+
 // Validates behavior of request_headers_to_add at router, vhost, and route action levels.
 TEST_F(RouteMatcherTest, TestAddRemoveRequestHeaders) {
   const std::string yaml = R"EOF(
@@ -2123,6 +2395,7 @@ virtual_hosts:
       request_mirror_policy:
         cluster: some_cluster2
         runtime_key: foo
+        streaming: true
       cluster: www2
   - match:
       prefix: "/baz"
@@ -2149,6 +2422,14 @@ virtual_hosts:
                        ->routeEntry()
                        ->shadowPolicy()
                        .runtimeKey());
+  EXPECT_FALSE(config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)
+                   ->routeEntry()
+                   ->shadowPolicy()
+                   .streaming());
+  EXPECT_TRUE(config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)
+                  ->routeEntry()
+                  ->shadowPolicy()
+                  .streaming());
 
   EXPECT_EQ("", config.route(genHeaders("www.lyft.com", "/baz", "GET"), 0)
                     ->routeEntry()
@@ -2160,6 +2441,35 @@ virtual_hosts:
                     .runtimeKey());
 }
 
+TEST_F(RouteMatcherTest, RetryShadowBufferLimit) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+- name: www2
+  domains:
+  - www.lyft.com
+  routes:
+  - match:
+      prefix: "/foo"
+    per_request_buffer_limit_bytes: 8
+    route:
+      cluster: www2
+  - match:
+      prefix: "/bar"
+    route:
+      cluster: www2
+  )EOF";
+
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, true);
+
+  EXPECT_EQ(8U, config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)
+                    ->routeEntry()
+                    ->retryShadowBufferLimit());
+  EXPECT_EQ(std::numeric_limits<uint32_t>::max(),
+            config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)
+                ->routeEntry()
+                ->retryShadowBufferLimit());
+}
+
 class RouteConfigurationV2 : public testing::Test, public ConfigImplTestBase {};
 
 TEST_F(RouteConfigurationV2, RequestMirrorPolicy) {
@@ -2568,6 +2878,48 @@ virtual_hosts:
   EXPECT_EQ(0, percent.numerator());
 }
 
+TEST_F(RouteMatcherTest, LatencyHedging) {
+  const std::string yaml = R"EOF(
+name: LatencyHedging
+virtual_hosts:
+- domains: [www.lyft.com]
+  name: www
+  routes:
+  - match: {prefix: /foo}
+    route:
+      cluster: www
+      hedge_policy:
+        latency_hedging:
+          min_delay: 0.05s
+          budget: {value: 2.5}
+  - match: {prefix: /bar}
+    route:
+      cluster: www
+      hedge_policy: {latency_hedging: {}}
+  - match: {prefix: /}
+    route: {cluster: www}
+  )EOF";
+
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, true);
+
+  const HedgePolicy& foo_policy =
+      config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)->routeEntry()->hedgePolicy();
+  EXPECT_TRUE(foo_policy.hedgeOnLatency());
+  EXPECT_EQ(std::chrono::milliseconds(50), foo_policy.latencyHedgeMinDelay());
+  EXPECT_EQ(2.5, foo_policy.latencyHedgeBudgetPercent());
+
+  const HedgePolicy& bar_policy =
+      config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)->routeEntry()->hedgePolicy();
+  EXPECT_TRUE(bar_policy.hedgeOnLatency());
+  EXPECT_EQ(std::chrono::milliseconds(10), bar_policy.latencyHedgeMinDelay());
+  EXPECT_EQ(10, bar_policy.latencyHedgeBudgetPercent());
+
+  EXPECT_FALSE(config.route(genHeaders("www.lyft.com", "/", "GET"), 0)
+                   ->routeEntry()
+                   ->hedgePolicy()
+                   .hedgeOnLatency());
+}
+
 TEST_F(RouteMatcherTest, TestBadDefaultConfig) {
   const std::string yaml = R"EOF(
 virtual_hosts:
@@ -3951,6 +4303,9 @@ virtual_hosts:
   EXPECT_EQ(cors_policy->enabled(), false);
   EXPECT_EQ(cors_policy->shadowEnabled(), true);
   EXPECT_THAT(cors_policy->allowOrigins(), ElementsAreArray({"test-origin"}));
+  EXPECT_TRUE(cors_policy->allowsOrigin("test-origin"));
+  EXPECT_FALSE(cors_policy->allowsOrigin("test-origin-2"));
+  EXPECT_FALSE(cors_policy->allowsOrigin("Test-origin"));
   EXPECT_EQ(cors_policy->allowMethods(), "test-methods");
   EXPECT_EQ(cors_policy->allowHeaders(), "test-headers");
   EXPECT_EQ(cors_policy->exposeHeaders(), "test-expose-headers");
@@ -3958,6 +4313,45 @@ virtual_hosts:
   EXPECT_EQ(cors_policy->allowCredentials(), true);
 }
 
+TEST_F(RoutePropertyTest, TestRouteCorsSafeRegexConfig) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: "default"
+    domains: ["*"]
+    routes:
+      - match:
+          prefix: "/api"
+        route:
+          cluster: "ats"
+          cors:
+            allow_origin_regex: ["https://www\\.lyft\\.com"]
+            allow_origin_safe_regex:
+              - google_re2: {}
+                regex: "https://.*\\.envoyproxy\\.io"
+              - google_re2: {}
+                regex: "https://[a-z]+\\.example\\.com"
+)EOF";
+
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, false);
+
+  const Router::CorsPolicy* cors_policy =
+      config.route(genHeaders("api.lyft.com", "/api", "GET"), 0)->routeEntry()->corsPolicy();
+
+  ASSERT_EQ(3, cors_policy->allowOriginRegexes().size());
+  EXPECT_TRUE(cors_policy->allowOriginRegexes()[0]->match("https://www.lyft.com"));
+  EXPECT_FALSE(cors_policy->allowOriginRegexes()[0]->match("https://www.envoyproxy.io"));
+  EXPECT_TRUE(cors_policy->allowOriginRegexes()[1]->match("https://www.envoyproxy.io"));
+  EXPECT_FALSE(cors_policy->allowOriginRegexes()[1]->match("https://www.lyft.com"));
+
+  // The regexes are checked together, the safe ones with a single combined regex.
+  EXPECT_TRUE(cors_policy->allowsOriginRegex("https://www.lyft.com"));
+  EXPECT_TRUE(cors_policy->allowsOriginRegex("https://www.envoyproxy.io"));
+  EXPECT_TRUE(cors_policy->allowsOriginRegex("https://api.example.com"));
+  EXPECT_FALSE(cors_policy->allowsOriginRegex("https://api.example.com.evil"));
+  EXPECT_FALSE(cors_policy->allowsOriginRegex("http://www.lyft.com"));
+  EXPECT_FALSE(cors_policy->allowsOrigin("https://www.lyft.com"));
+}
+
 TEST_F(RoutePropertyTest, TestVHostCorsLegacyConfig) {
   const std::string yaml = R"EOF(
 virtual_hosts:
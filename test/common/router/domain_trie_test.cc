@@ -0,0 +1,90 @@
+#include "common/router/domain_trie.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+typedef DomainTrie<const char*> TestTrie;
+
+const char* find(const TestTrie& trie, absl::string_view host) {
+  const char* const* value = trie.findLongest(host);
+  return value == nullptr ? nullptr : *value;
+}
+
+TEST(DomainTrieTest, Empty) {
+  TestTrie trie(TestTrie::Direction::Forward);
+  EXPECT_TRUE(trie.empty());
+  EXPECT_EQ(nullptr, find(trie, "foo.com"));
+  EXPECT_EQ(nullptr, find(trie, ""));
+}
+
+TEST(DomainTrieTest, Suffix) {
+  TestTrie trie(TestTrie::Direction::Reverse);
+  EXPECT_TRUE(trie.add(".foo.com", "wildcard"));
+  EXPECT_TRUE(trie.add("-bar.foo.com", "bar"));
+  EXPECT_TRUE(trie.add(".baz.foo.com", "baz"));
+  EXPECT_FALSE(trie.add(".foo.com", "duplicate"));
+  EXPECT_FALSE(trie.empty());
+
+  EXPECT_STREQ("wildcard", find(trie, "www.foo.com"));
+  EXPECT_STREQ("bar", find(trie, "baz-bar.foo.com"));
+  EXPECT_STREQ("baz", find(trie, "a.baz.foo.com"));
+  EXPECT_STREQ("wildcard", find(trie, "-bar.foo.com"));
+  // The wildcard never matches the empty string.
+  EXPECT_EQ(nullptr, find(trie, ".foo.com"));
+  EXPECT_EQ(nullptr, find(trie, "foo.com"));
+  EXPECT_EQ(nullptr, find(trie, "www.foo.org"));
+}
+
+TEST(DomainTrieTest, Prefix) {
+  TestTrie trie(TestTrie::Direction::Forward);
+  EXPECT_TRUE(trie.add("foo.", "foo"));
+  EXPECT_TRUE(trie.add("foo.bar.", "foo_bar"));
+  EXPECT_TRUE(trie.add("api-", "api"));
+
+  EXPECT_STREQ("foo", find(trie, "foo.com"));
+  EXPECT_STREQ("foo_bar", find(trie, "foo.bar.com"));
+  EXPECT_STREQ("foo", find(trie, "foo.bar."));
+  EXPECT_STREQ("api", find(trie, "api-v1.example.com"));
+  EXPECT_EQ(nullptr, find(trie, "foo."));
+  EXPECT_EQ(nullptr, find(trie, "fo.com"));
+  EXPECT_EQ(nullptr, find(trie, "bar.foo.com"));
+}
+
+TEST(DomainTrieTest, EdgeSplitting) {
+  TestTrie trie(TestTrie::Direction::Forward);
+  EXPECT_TRUE(trie.add("abcdef", "long"));
+  // Ends inside the existing edge.
+  EXPECT_TRUE(trie.add("abc", "short"));
+  // Diverges inside the existing edge.
+  EXPECT_TRUE(trie.add("abxyz", "other"));
+
+  EXPECT_STREQ("long", find(trie, "abcdefg"));
+  EXPECT_STREQ("short", find(trie, "abcdef"));
+  EXPECT_STREQ("short", find(trie, "abcde"));
+  EXPECT_STREQ("other", find(trie, "abxyz1"));
+  EXPECT_EQ(nullptr, find(trie, "abxy1"));
+  // root, "ab", "c", "def", "xyz"
+  EXPECT_EQ(5, trie.nodeCount());
+}
+
+TEST(DomainTrieTest, ManyDomains) {
+  TestTrie trie(TestTrie::Direction::Reverse);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; i++) {
+    keys.push_back(".tenant" + std::to_string(i) + ".example.com");
+  }
+  for (const std::string& key : keys) {
+    EXPECT_TRUE(trie.add(key, key.c_str()));
+  }
+  for (const std::string& key : keys) {
+    EXPECT_EQ(key.c_str(), find(trie, "www" + key));
+  }
+  EXPECT_EQ(nullptr, find(trie, "www.tenant1000.example.com"));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -802,6 +802,58 @@ response_headers_to_remove: ["x-foo-header"]
   EXPECT_EQ("bar", header_map.get_("x-foo-header"));
 }
 
+// A merged parser applies the removals and additions of each parser in turn, so a later parser
+// may remove the headers an earlier one added.
+TEST(HeaderParserTest, EvaluateMergedHeaders) {
+  const std::string route_yaml = R"EOF(
+match: { prefix: "/new_endpoint" }
+route:
+  cluster: www2
+request_headers_to_add:
+  - header:
+      key: "x-route-header"
+      value: "route"
+  - header:
+      key: "x-removed-header"
+      value: "route"
+  - header:
+      key: "x-protocol"
+      value: "proto-%PROTOCOL%"
+)EOF";
+  const std::string vhost_yaml = R"EOF(
+match: { prefix: "/" }
+route:
+  cluster: www2
+request_headers_to_add:
+  - header:
+      key: "x-route-header"
+      value: "vhost"
+    append: false
+request_headers_to_remove: ["x-removed-header"]
+)EOF";
+
+  const auto route = parseRouteFromV2Yaml(route_yaml);
+  const auto vhost = parseRouteFromV2Yaml(vhost_yaml);
+  HeaderParserPtr route_parser =
+      HeaderParser::configure(route.request_headers_to_add(), route.request_headers_to_remove());
+  HeaderParserPtr vhost_parser =
+      HeaderParser::configure(vhost.request_headers_to_add(), vhost.request_headers_to_remove());
+  HeaderParserPtr merged_parser = HeaderParser::merge({route_parser.get(), vhost_parser.get()});
+  // The merged parser does not depend on the parsers it was merged from.
+  route_parser.reset();
+  vhost_parser.reset();
+
+  Http::TestHeaderMapImpl header_map{{":method", "GET"}, {"x-removed-header", "downstream"}};
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  absl::optional<Envoy::Http::Protocol> protocol = Envoy::Http::Protocol::Http11;
+  ON_CALL(stream_info, protocol()).WillByDefault(ReturnPointee(&protocol));
+
+  merged_parser->evaluateHeaders(header_map, stream_info);
+  EXPECT_EQ("vhost", header_map.get_("x-route-header"));
+  EXPECT_FALSE(header_map.has("x-removed-header"));
+  EXPECT_EQ("proto-HTTP/1.1", header_map.get_("x-protocol"));
+}
+
 } // namespace
 } // namespace Router
 } // namespace Envoy
@@ -9,6 +9,7 @@
 #include "common/config/filter_json.h"
 #include "common/config/utility.h"
 #include "common/http/message_impl.h"
+#include "common/init/manager_impl.h"
 #include "common/json/json_loader.h"
 #include "common/router/rds_impl.h"
 
@@ -267,9 +268,10 @@ TEST_F(RdsImplTest, Basic) {
   expectRequest();
   interval_timer_->callback_();
 
-  // Load the config and verified shared count.
+  // Load the config and verified shared count. The provider keeps a reference to the last config it
+  // built in addition to the thread local one.
   ConfigConstSharedPtr config = rds_->config();
-  EXPECT_EQ(2, config.use_count());
+  EXPECT_EQ(3, config.use_count());
 
   // Third request.
   const std::string response2_json = R"EOF(
@@ -322,6 +324,10 @@ TEST_F(RdsImplTest, Basic) {
   EXPECT_EQ(1, config.use_count());
 
   EXPECT_EQ(2UL, factory_context_.scope_.counter("foo.rds.foo_route_config.config_reload").value());
+  EXPECT_EQ(0UL,
+            factory_context_.scope_.counter("foo.rds.foo_route_config.virtual_host_reused").value());
+  EXPECT_EQ(1UL,
+            factory_context_.scope_.counter("foo.rds.foo_route_config.virtual_host_rebuilt").value());
   EXPECT_EQ(3UL,
             factory_context_.scope_.counter("foo.rds.foo_route_config.update_attempt").value());
   EXPECT_EQ(3UL,
@@ -610,6 +616,31 @@ virtual_hosts:
             route_config_provider_manager_->dumpRouteConfigs()->dynamic_route_configs().size());
 }
 
+// The init managers of all the listeners sharing a subscription wait for its first update.
+TEST_F(RouteConfigProviderManagerImplTest, SharedSubscriptionInitManagers) {
+  Init::ManagerImpl init_manager1("listener1");
+  Init::ManagerImpl init_manager2("listener2");
+  EXPECT_CALL(factory_context_, initManager())
+      .WillOnce(ReturnRef(init_manager1))
+      .WillOnce(ReturnRef(init_manager2));
+  setup();
+  RouteConfigProviderPtr provider2 = route_config_provider_manager_->createRdsRouteConfigProvider(
+      rds_, factory_context_, "foo_prefix.");
+  EXPECT_EQ(&dynamic_cast<RdsRouteConfigProviderImpl&>(*provider_).subscription(),
+            &dynamic_cast<RdsRouteConfigProviderImpl&>(*provider2).subscription());
+
+  // The subscription is only started once, by the first init manager to initialize.
+  Init::ExpectableWatcherImpl init_watcher1("watcher1");
+  Init::ExpectableWatcherImpl init_watcher2("watcher2");
+  expectRequest();
+  init_manager1.initialize(init_watcher1);
+  init_manager2.initialize(init_watcher2);
+
+  init_watcher1.expectReady();
+  init_watcher2.expectReady();
+  dynamic_cast<RdsRouteConfigProviderImpl&>(*provider_).subscription().onConfigUpdate({}, "");
+}
+
 // Negative test for protoc-gen-validate constraints.
 TEST_F(RouteConfigProviderManagerImplTest, ValidateFail) {
   setup();
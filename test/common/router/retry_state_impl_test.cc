@@ -434,6 +434,34 @@ TEST_F(RouterRetryStateImplTest, NoAvailableRetries) {
   EXPECT_EQ(1UL, cluster_.stats().upstream_rq_retry_overflow_.value());
 }
 
+// Test that a retry budget limits the retries to a percentage of the active requests, and that its
+// exhaustion is counted.
+TEST_F(RouterRetryStateImplTest, RetryBudget) {
+  cluster_.resource_manager_ = std::make_unique<Upstream::ResourceManagerImpl>(
+      cluster_.runtime_, "fake_key", 1024, 1024, 1024, 1024, 1024,
+      std::numeric_limits<uint64_t>::max(), cluster_.circuit_breakers_stats_, 20.0, 0);
+
+  Http::TestHeaderMapImpl request_headers{{"x-envoy-retry-on", "connect-failure"},
+                                          {"x-envoy-max-retries", "2"}};
+  setup(request_headers);
+  EXPECT_TRUE(state_->enabled());
+
+  EXPECT_EQ(RetryStatus::NoOverflow, state_->shouldRetryReset(connect_failure_, callback_));
+  EXPECT_EQ(1UL, cluster_.stats().upstream_rq_retry_overflow_.value());
+  EXPECT_EQ(1UL, cluster_.stats().upstream_rq_retry_budget_exceeded_.value());
+
+  // 20% of 5 active requests.
+  for (int i = 0; i < 5; i++) {
+    cluster_.resourceManager(Upstream::ResourcePriority::Default).requests().inc();
+  }
+  expectTimerCreateAndEnable();
+  EXPECT_EQ(RetryStatus::Yes, state_->shouldRetryReset(connect_failure_, callback_));
+  EXPECT_EQ(1UL, cluster_.stats().upstream_rq_retry_budget_exceeded_.value());
+
+  state_.reset();
+  cluster_.resourceManager(Upstream::ResourcePriority::Default).requests().decBy(5);
+}
+
 TEST_F(RouterRetryStateImplTest, MaxRetriesHeader) {
   Http::TestHeaderMapImpl request_headers{{"x-envoy-retry-on", "connect-failure"},
                                           {"x-envoy-retry-grpc-on", "cancelled"},
@@ -0,0 +1,101 @@
+#include "common/router/route_index.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+RouteIndex::Candidates find(const RouteIndex& index, absl::string_view path) {
+  RouteIndex::Candidates candidates;
+  const size_t query_start = path.find('?');
+  index.findCandidates(path, path.substr(0, query_start), candidates);
+  return candidates;
+}
+
+TEST(RouteIndexTest, Empty) {
+  RouteIndex index;
+  EXPECT_THAT(find(index, "/foo"), IsEmpty());
+  EXPECT_THAT(index.unindexed(), IsEmpty());
+}
+
+TEST(RouteIndexTest, ExactPath) {
+  RouteIndex index;
+  index.addExactPath("/foo", 3);
+  index.addExactPath("/foo", 1);
+  index.addExactPath("/bar", 2);
+
+  EXPECT_THAT(find(index, "/foo"), ElementsAre(1, 3));
+  EXPECT_THAT(find(index, "/foo?a=b"), ElementsAre(1, 3));
+  EXPECT_THAT(find(index, "/bar"), ElementsAre(2));
+  EXPECT_THAT(find(index, "/foo/"), IsEmpty());
+  EXPECT_THAT(find(index, "/fo"), IsEmpty());
+}
+
+TEST(RouteIndexTest, Prefix) {
+  RouteIndex index;
+  index.addPrefix("/", 5);
+  index.addPrefix("/api/v1", 1);
+  index.addPrefix("/api/v2", 2);
+  index.addPrefix("/api", 4);
+  index.addPrefix("/apis", 3);
+
+  EXPECT_THAT(find(index, "/"), ElementsAre(5));
+  EXPECT_THAT(find(index, "/ap"), ElementsAre(5));
+  EXPECT_THAT(find(index, "/api"), ElementsAre(4, 5));
+  EXPECT_THAT(find(index, "/api/v1/users"), ElementsAre(1, 4, 5));
+  EXPECT_THAT(find(index, "/api/v2"), ElementsAre(2, 4, 5));
+  EXPECT_THAT(find(index, "/api/v3"), ElementsAre(4, 5));
+  EXPECT_THAT(find(index, "/apis/x"), ElementsAre(3, 4, 5));
+  // Prefix matching applies to the full path, including the query string.
+  EXPECT_THAT(find(index, "/api?v1"), ElementsAre(4, 5));
+  EXPECT_THAT(find(index, "foo"), IsEmpty());
+}
+
+TEST(RouteIndexTest, EmptyPrefixMatchesEverything) {
+  RouteIndex index;
+  index.addPrefix("", 0);
+  index.addPrefix("/a", 1);
+
+  EXPECT_THAT(find(index, ""), ElementsAre(0));
+  EXPECT_THAT(find(index, "/a"), ElementsAre(0, 1));
+  EXPECT_THAT(find(index, "/b"), ElementsAre(0));
+}
+
+TEST(RouteIndexTest, EdgeSplitting) {
+  RouteIndex index;
+  index.addPrefix("/abcdef", 0);
+  // Ends inside the existing edge.
+  index.addPrefix("/abc", 1);
+  // Diverges inside the existing edge.
+  index.addPrefix("/abxyz", 2);
+  // Same prefix twice.
+  index.addPrefix("/abc", 3);
+
+  EXPECT_THAT(find(index, "/abcdefg"), ElementsAre(0, 1, 3));
+  EXPECT_THAT(find(index, "/abcde"), ElementsAre(1, 3));
+  EXPECT_THAT(find(index, "/abxyz"), ElementsAre(2));
+  EXPECT_THAT(find(index, "/abx"), IsEmpty());
+  // root, "/ab", "cdef" -> "c" + "def", "xyz"
+  EXPECT_EQ(5, index.prefixNodeCount());
+}
+
+TEST(RouteIndexTest, MixedOrdering) {
+  RouteIndex index;
+  index.addPrefix("/foo", 4);
+  index.addExactPath("/foo/bar", 2);
+  index.addPrefix("/", 0);
+  index.addUnindexed(3);
+  index.addUnindexed(1);
+
+  EXPECT_THAT(find(index, "/foo/bar"), ElementsAre(0, 2, 4));
+  EXPECT_THAT(index.unindexed(), ElementsAre(1, 3));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -14,12 +14,14 @@
 #include "common/upstream/upstream_impl.h"
 
 #include "test/common/http/common.h"
+#include "test/mocks/buffer/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/router/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
 #include "test/mocks/tracing/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/environment.h"
@@ -34,7 +36,6 @@ using testing::_;
 using testing::AssertionFailure;
 using testing::AssertionResult;
 using testing::AssertionSuccess;
-using testing::AtLeast;
 using testing::InSequence;
 using testing::Invoke;
 using testing::Matcher;
@@ -107,6 +108,16 @@ public:
     EXPECT_CALL(*per_try_timeout_, disableTimer());
   }
 
+  // Enable latency hedging on the route, with a cluster latency estimate of 100ms.
+  void enableLatencyHedging() {
+    TestHedgePolicy& hedge_policy = callbacks_.route_->route_entry_.hedge_policy_;
+    hedge_policy.hedge_on_latency_ = true;
+    hedge_policy.latency_hedge_min_delay_ = std::chrono::milliseconds(10);
+    hedge_policy.latency_hedge_budget_percent_ = 10;
+    cm_.thread_local_cluster_.cluster_.info_->latency_estimator_.recordLatency(
+        std::chrono::milliseconds(100));
+  }
+
   AssertionResult verifyHostUpstreamStats(uint64_t success, uint64_t error) {
     if (success != cm_.conn_pool_.host_->stats_store_.counter("rq_success").value()) {
       return AssertionFailure() << fmt::format(
@@ -196,7 +207,7 @@ public:
             [&](Http::StreamDecoder& decoder,
                 Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
               response_decoder_ = &decoder;
-              callbacks.onPoolReady(original_encoder_, cm_.conn_pool_.host_);
+              callbacks.onPoolReady(original_encoder_, cm_.conn_pool_.host_, upstream_stream_info_);
               return nullptr;
             }));
     HttpTestUtility::addDefaultHeaders(default_request_headers_);
@@ -235,6 +246,7 @@ public:
   Http::HeaderMapPtr redirect_headers_{
       new Http::TestHeaderMapImpl{{":status", "302"}, {"location", "http://www.foo.com"}}};
   NiceMock<Tracing::MockSpan> span_;
+  NiceMock<StreamInfo::MockStreamInfo> upstream_stream_info_;
 };
 
 class RouterTest : public RouterTestBase {
@@ -469,7 +481,7 @@ TEST_F(RouterTest, AddCookie) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return &cancellable_;
       }));
 
@@ -516,7 +528,7 @@ TEST_F(RouterTest, AddCookieNoDuplicate) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return &cancellable_;
       }));
 
@@ -563,7 +575,7 @@ TEST_F(RouterTest, AddMultipleCookies) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return &cancellable_;
       }));
 
@@ -747,7 +759,7 @@ TEST_F(RouterTest, EnvoyUpstreamServiceTime) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -777,7 +789,7 @@ TEST_F(RouterTestSuppressEnvoyHeaders, EnvoyUpstreamServiceTime) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -805,7 +817,7 @@ TEST_F(RouterTest, NoRetriesOverflow) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -828,7 +840,7 @@ TEST_F(RouterTest, NoRetriesOverflow) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   router_.retry_state_->callback_();
@@ -851,7 +863,7 @@ TEST_F(RouterTest, ResetDuringEncodeHeaders) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
@@ -876,7 +888,7 @@ TEST_F(RouterTest, UpstreamTimeout) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   EXPECT_CALL(callbacks_.stream_info_, onUpstreamHostSelected(_))
@@ -918,7 +930,7 @@ TEST_F(RouterTest, GrpcOkTrailersOnly) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -942,7 +954,7 @@ TEST_F(RouterTest, GrpcAlreadyExistsTrailersOnly) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -966,7 +978,7 @@ TEST_F(RouterTest, GrpcInternalTrailersOnly) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -991,7 +1003,7 @@ TEST_F(RouterTest, GrpcDataEndStream) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1018,7 +1030,7 @@ TEST_F(RouterTest, GrpcReset) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1045,7 +1057,7 @@ TEST_F(RouterTest, GrpcOk) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1071,7 +1083,7 @@ TEST_F(RouterTest, GrpcInternal) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1096,7 +1108,7 @@ TEST_F(RouterTest, UpstreamTimeoutWithAltResponse) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   EXPECT_CALL(callbacks_.stream_info_, onUpstreamHostSelected(_))
@@ -1136,7 +1148,7 @@ TEST_F(RouterTest, UpstreamPerTryTimeout) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   EXPECT_CALL(callbacks_.stream_info_, onUpstreamHostSelected(_))
@@ -1204,7 +1216,7 @@ TEST_F(RouterTest, UpstreamPerTryTimeoutExcludesNewStream) {
   per_try_timeout_ = new Event::MockTimer(&callbacks_.dispatcher_);
   EXPECT_CALL(*per_try_timeout_, enableTimer(_));
   // The per try timeout timer should not be started yet.
-  pool_callbacks->onPoolReady(encoder, cm_.conn_pool_.host_);
+  pool_callbacks->onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
 
   EXPECT_CALL(encoder.stream_, resetStream(Http::StreamResetReason::LocalReset));
   EXPECT_CALL(cm_.conn_pool_.host_->outlier_detector_, putHttpResponseCode(504));
@@ -1232,7 +1244,7 @@ TEST_F(RouterTest, RetryRequestNotComplete) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   EXPECT_CALL(callbacks_.stream_info_,
@@ -1259,7 +1271,7 @@ TEST_F(RouterTest, RetryNoneHealthy) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
@@ -1295,7 +1307,7 @@ TEST_F(RouterTest, RetryUpstreamReset) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1314,7 +1326,7 @@ TEST_F(RouterTest, RetryUpstreamReset) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   router_.retry_state_->callback_();
@@ -1338,7 +1350,7 @@ TEST_F(RouterTest, RetryUpstreamPerTryTimeout) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1362,7 +1374,7 @@ TEST_F(RouterTest, RetryUpstreamPerTryTimeout) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectPerTryTimerCreate();
@@ -1407,7 +1419,7 @@ TEST_F(RouterTest, RetryUpstreamConnectionFailure) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   router_.retry_state_->callback_();
@@ -1429,7 +1441,7 @@ TEST_F(RouterTest, DontResetStartedResponseOnUpstreamPerTryTimeout) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1463,7 +1475,7 @@ TEST_F(RouterTest, RetryUpstreamResetResponseStarted) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1492,7 +1504,7 @@ TEST_F(RouterTest, RetryUpstreamReset100ContinueResponseStarted) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1519,7 +1531,7 @@ TEST_F(RouterTest, RetryUpstream5xx) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1542,7 +1554,7 @@ TEST_F(RouterTest, RetryUpstream5xx) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   router_.retry_state_->callback_();
@@ -1563,7 +1575,7 @@ TEST_F(RouterTest, RetryTimeoutDuringRetryDelay) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1599,7 +1611,7 @@ TEST_F(RouterTest, RetryTimeoutDuringRetryDelayWithUpstreamRequestNoHost) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1646,7 +1658,7 @@ TEST_F(RouterTest, RetryTimeoutDuringRetryDelayWithUpstreamRequestNoHostAltRespo
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1692,7 +1704,7 @@ TEST_F(RouterTest, RetryUpstream5xxNotComplete) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1723,12 +1735,12 @@ TEST_F(RouterTest, RetryUpstream5xxNotComplete) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   ON_CALL(callbacks_, decodingBuffer()).WillByDefault(Return(body_data.get()));
   EXPECT_CALL(encoder2, encodeHeaders(_, false));
-  EXPECT_CALL(encoder2, encodeData(_, false));
+  EXPECT_CALL(encoder2, encodeData(BufferStringEqual("hello"), false));
   EXPECT_CALL(encoder2, encodeTrailers(_));
   router_.retry_state_->callback_();
 
@@ -1763,7 +1775,7 @@ TEST_F(RouterTest, RetryUpstreamGrpcCancelled) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1790,7 +1802,7 @@ TEST_F(RouterTest, RetryUpstreamGrpcCancelled) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   router_.retry_state_->callback_();
@@ -1815,7 +1827,7 @@ TEST_F(RouterTest, RetryRespsectsMaxHostSelectionCount) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1850,7 +1862,7 @@ TEST_F(RouterTest, RetryRespsectsMaxHostSelectionCount) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   ON_CALL(callbacks_, decodingBuffer()).WillByDefault(Return(body_data.get()));
@@ -1882,7 +1894,7 @@ TEST_F(RouterTest, RetryRespectsRetryHostPredicate) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -1917,7 +1929,7 @@ TEST_F(RouterTest, RetryRespectsRetryHostPredicate) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   ON_CALL(callbacks_, decodingBuffer()).WillByDefault(Return(body_data.get()));
@@ -2080,7 +2092,7 @@ TEST_F(RouterTest, Shadow) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -2096,13 +2108,10 @@ TEST_F(RouterTest, Shadow) {
   EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, router_.decodeData(*body_data, false));
 
   Http::TestHeaderMapImpl trailers{{"some", "trailer"}};
-  EXPECT_CALL(callbacks_, decodingBuffer())
-      .Times(AtLeast(1))
-      .WillRepeatedly(Return(body_data.get()));
   EXPECT_CALL(*shadow_writer_, shadow_("foo", _, std::chrono::milliseconds(10)))
       .WillOnce(Invoke(
           [](const std::string&, Http::MessagePtr& request, std::chrono::milliseconds) -> void {
-            EXPECT_NE(nullptr, request->body());
+            EXPECT_EQ("hello", request->body()->toString());
             EXPECT_NE(nullptr, request->trailers());
           }));
   router_.decodeTrailers(trailers);
@@ -2112,6 +2121,257 @@ TEST_F(RouterTest, Shadow) {
   EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
 }
 
+// Test that a streaming shadow is sent the body as it streams, without buffering it.
+TEST_F(RouterTest, StreamingShadow) {
+  callbacks_.route_->route_entry_.shadow_policy_.cluster_ = "foo";
+  callbacks_.route_->route_entry_.shadow_policy_.streaming_ = true;
+
+  NiceMock<Http::MockStreamEncoder> encoder;
+  Http::StreamDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  MockShadowStream* shadow_stream = new MockShadowStream();
+  EXPECT_CALL(*shadow_writer_, streamingShadow_("foo", _, std::chrono::milliseconds(10)))
+      .WillOnce(Return(shadow_stream));
+  router_.decodeHeaders(headers, false);
+
+  Buffer::OwnedImpl body_data("hello");
+  EXPECT_CALL(*shadow_stream, sendData(BufferStringEqual("hello"), false));
+  EXPECT_CALL(encoder, encodeData(BufferStringEqual("hello"), false));
+  EXPECT_CALL(callbacks_, addDecodedData(_, _)).Times(0);
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, router_.decodeData(body_data, false));
+
+  Http::TestHeaderMapImpl trailers{{"some", "trailer"}};
+  EXPECT_CALL(*shadow_stream, sendTrailers(_));
+  EXPECT_CALL(*shadow_writer_, shadow_(_, _, _)).Times(0);
+  router_.decodeTrailers(trailers);
+
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
+// Test that a request whose body exceeds the route's buffer limit is not buffered for retries.
+TEST_F(RouterTest, RetryShadowBufferLimitExceeded) {
+  EXPECT_CALL(callbacks_.route_->route_entry_, retryShadowBufferLimit())
+      .WillRepeatedly(Return(4));
+  NiceMock<Http::MockStreamEncoder> encoder;
+  Http::StreamDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers{{"x-envoy-retry-on", "5xx"}, {"x-envoy-internal", "true"}};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, false);
+
+  Buffer::OwnedImpl body_data("hello");
+  EXPECT_CALL(*router_.retry_state_, enabled()).WillOnce(Return(true));
+  EXPECT_CALL(callbacks_, addDecodedData(_, _)).Times(0);
+  EXPECT_CALL(encoder, encodeData(BufferStringEqual("hello"), true));
+  router_.decodeData(body_data, true);
+  EXPECT_EQ(1U, stats_store_.counter("test.rq_retry_shadow_buffer_limit_exceeded").value());
+  EXPECT_EQ(1U, cm_.thread_local_cluster_.cluster_.info_->stats_store_
+                    .counter("retry_or_shadow_abandoned")
+                    .value());
+
+  // The retry state is gone, so that the response is not retried.
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "503"}});
+  EXPECT_CALL(cm_.conn_pool_.host_->outlier_detector_, putHttpResponseCode(503));
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_TRUE(verifyHostUpstreamStats(0, 1));
+}
+
+// Test that a request slower than the cluster's estimated latency is hedged on another host, and
+// that the first response wins while the other request is cancelled.
+TEST_F(RouterTest, LatencyHedgeWins) {
+  enableLatencyHedging();
+  auto first_host = std::make_shared<NiceMock<Upstream::MockHost>>();
+  NiceMock<Http::MockStreamEncoder> encoder1;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder1, first_host, upstream_stream_info_);
+        return nullptr;
+      }));
+  Event::MockTimer* hedge_timer = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer, enableTimer(std::chrono::milliseconds(100)));
+  EXPECT_CALL(*hedge_timer, disableTimer());
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  EXPECT_CALL(cm_, httpConnPoolForCluster(_, _, _, _))
+      .WillOnce(
+          Invoke([&](const std::string&, Upstream::ResourcePriority, Http::Protocol,
+                     Upstream::LoadBalancerContext* context) -> Http::ConnectionPool::Instance* {
+            // The hedged request avoids the host of the first request.
+            EXPECT_TRUE(context->shouldSelectAnotherHost(*first_host));
+            return &cm_.conn_pool_;
+          }));
+  NiceMock<Http::MockStreamEncoder> encoder2;
+  Http::StreamDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
+        return nullptr;
+      }));
+  hedge_timer->callback_();
+  auto& cluster_stats = cm_.thread_local_cluster_.cluster_.info_->stats_store_;
+  EXPECT_EQ(1U, cluster_stats.counter("upstream_rq_hedged").value());
+  EXPECT_EQ(1U, cluster_stats.gauge("upstream_rq_hedge_active").value());
+
+  // The hedged request responds first, so that the first request is cancelled.
+  EXPECT_CALL(encoder1.stream_, resetStream(Http::StreamResetReason::LocalReset));
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_EQ(1U, cluster_stats.counter("upstream_rq_hedge_won").value());
+  EXPECT_EQ(0U, cluster_stats.gauge("upstream_rq_hedge_active").value());
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+
+  // The latency of the response, 0ms here, lowers the estimate.
+  EXPECT_EQ(std::chrono::milliseconds(99),
+            cm_.thread_local_cluster_.cluster_.info_->latency_estimator_.latencyP95().value());
+}
+
+// Test that the hedged request is cancelled when the first request responds first.
+TEST_F(RouterTest, LatencyHedgeLoses) {
+  enableLatencyHedging();
+  NiceMock<Http::MockStreamEncoder> encoder1;
+  Http::StreamDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
+        return nullptr;
+      }));
+  Event::MockTimer* hedge_timer = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer, enableTimer(_));
+  EXPECT_CALL(*hedge_timer, disableTimer());
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  NiceMock<Http::MockStreamEncoder> encoder2;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
+        return nullptr;
+      }));
+  hedge_timer->callback_();
+
+  EXPECT_CALL(encoder2.stream_, resetStream(Http::StreamResetReason::LocalReset));
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  auto& cluster_stats = cm_.thread_local_cluster_.cluster_.info_->stats_store_;
+  EXPECT_EQ(1U, cluster_stats.counter("upstream_rq_hedged").value());
+  EXPECT_EQ(0U, cluster_stats.counter("upstream_rq_hedge_won").value());
+  EXPECT_EQ(0U, cluster_stats.gauge("upstream_rq_hedge_active").value());
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
+// Test that a request failing while its hedge is outstanding is dropped, and that the response is
+// left to the other request instead of a retry or an error.
+TEST_F(RouterTest, LatencyHedgeDropsFailedRequest) {
+  enableLatencyHedging();
+  auto first_host = std::make_shared<NiceMock<Upstream::MockHost>>();
+  NiceMock<Http::MockStreamEncoder> encoder1;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder1, first_host, upstream_stream_info_);
+        return nullptr;
+      }));
+  Event::MockTimer* hedge_timer = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer, enableTimer(_));
+  EXPECT_CALL(*hedge_timer, disableTimer());
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers{{"x-envoy-retry-on", "5xx"}, {"x-envoy-internal", "true"}};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  NiceMock<Http::MockStreamEncoder> encoder2;
+  Http::StreamDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_, upstream_stream_info_);
+        return nullptr;
+      }));
+  hedge_timer->callback_();
+
+  EXPECT_CALL(*router_.retry_state_, shouldRetryReset(_, _)).Times(0);
+  EXPECT_CALL(first_host->outlier_detector_, putHttpResponseCode(503));
+  encoder1.stream_.resetStream(Http::StreamResetReason::RemoteReset);
+  EXPECT_EQ(1U, first_host->stats_.rq_error_.value());
+  EXPECT_EQ(0U, cm_.thread_local_cluster_.cluster_.info_->stats_store_
+                    .gauge("upstream_rq_hedge_active")
+                    .value());
+
+  EXPECT_CALL(*router_.retry_state_, shouldRetryHeaders(_, _)).WillOnce(Return(RetryStatus::No));
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
+// Test that a request isn't hedged when the cluster's hedge budget is exhausted.
+TEST_F(RouterTest, LatencyHedgeBudgetExceeded) {
+  enableLatencyHedging();
+  NiceMock<Http::MockStreamEncoder> encoder;
+  Http::StreamDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
+        return nullptr;
+      }));
+  Event::MockTimer* hedge_timer = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer, enableTimer(_));
+  EXPECT_CALL(*hedge_timer, disableTimer());
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  // Another request of the cluster is hedged, and the budget allows one.
+  auto& cluster_stats = cm_.thread_local_cluster_.cluster_.info_->stats_store_;
+  cluster_stats.gauge("upstream_rq_hedge_active").set(1);
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _)).Times(0);
+  hedge_timer->callback_();
+  EXPECT_EQ(0U, cluster_stats.counter("upstream_rq_hedged").value());
+  EXPECT_EQ(1U, cluster_stats.counter("upstream_rq_hedge_budget_exceeded").value());
+
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
 TEST_F(RouterTest, AltStatName) {
   // Also test no upstream timeout here.
   EXPECT_CALL(callbacks_.route_->route_entry_, timeout())
@@ -2124,7 +2384,7 @@ TEST_F(RouterTest, AltStatName) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
@@ -2237,7 +2497,7 @@ TEST_F(RouterTest, UpstreamTimingSingleRequest) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -2285,6 +2545,87 @@ TEST_F(RouterTest, UpstreamTimingSingleRequest) {
             std::chrono::milliseconds(32));
 }
 
+// Verify that the establishment of the upstream connection is part of the upstream timing of a
+// request that waited for it, along with the time spent waiting on the connection pool.
+TEST_F(RouterTest, UpstreamTimingConnectionEstablishment) {
+  NiceMock<Http::MockStreamEncoder> encoder;
+  Http::StreamDecoder* response_decoder = nullptr;
+  Http::ConnectionPool::Callbacks* pool_callbacks = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        pool_callbacks = &callbacks;
+        return &cancellable_;
+      }));
+  expectResponseTimerCreate();
+
+  StreamInfo::StreamInfoImpl stream_info(test_time_.timeSystem());
+  ON_CALL(callbacks_, streamInfo()).WillByDefault(ReturnRef(stream_info));
+
+  test_time_.sleep(std::chrono::milliseconds(3));
+  Http::TestHeaderMapImpl headers{};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  StreamInfo::UpstreamTiming& connection_timing = upstream_stream_info_.upstream_timing_;
+  connection_timing.onUpstreamConnectStart(test_time_.timeSystem());
+  test_time_.sleep(std::chrono::milliseconds(5));
+  connection_timing.onUpstreamConnectComplete(test_time_.timeSystem());
+  test_time_.sleep(std::chrono::milliseconds(7));
+  connection_timing.onUpstreamHandshakeComplete(test_time_.timeSystem());
+  pool_callbacks->onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
+
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+
+  const StreamInfo::UpstreamTiming& timing = stream_info.upstreamTiming();
+  EXPECT_EQ(std::chrono::milliseconds(3),
+            timing.upstream_request_start_.value() - stream_info.startTimeMonotonic());
+  EXPECT_EQ(std::chrono::milliseconds(12), timing.first_upstream_tx_byte_sent_.value() -
+                                               timing.upstream_request_start_.value());
+  EXPECT_EQ(std::chrono::milliseconds(5), timing.upstream_connect_complete_.value() -
+                                              timing.upstream_connect_start_.value());
+  EXPECT_EQ(std::chrono::milliseconds(7), timing.upstream_handshake_complete_.value() -
+                                              timing.upstream_connect_complete_.value());
+}
+
+// Verify that the establishment of a reused upstream connection is not part of the upstream timing
+// of a request.
+TEST_F(RouterTest, UpstreamTimingReusedConnection) {
+  StreamInfo::UpstreamTiming& connection_timing = upstream_stream_info_.upstream_timing_;
+  connection_timing.onUpstreamConnectStart(test_time_.timeSystem());
+  connection_timing.onUpstreamConnectComplete(test_time_.timeSystem());
+  test_time_.sleep(std::chrono::milliseconds(5));
+
+  NiceMock<Http::MockStreamEncoder> encoder;
+  Http::StreamDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  StreamInfo::StreamInfoImpl stream_info(test_time_.timeSystem());
+  ON_CALL(callbacks_, streamInfo()).WillByDefault(ReturnRef(stream_info));
+
+  Http::TestHeaderMapImpl headers{};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+
+  const StreamInfo::UpstreamTiming& timing = stream_info.upstreamTiming();
+  EXPECT_TRUE(timing.upstream_request_start_.has_value());
+  EXPECT_FALSE(timing.upstream_connect_start_.has_value());
+  EXPECT_FALSE(timing.upstream_connect_complete_.has_value());
+  EXPECT_FALSE(timing.upstream_handshake_complete_.has_value());
+}
+
 // Verify that upstream timing information is set into the StreamInfo when a
 // retry occurs (and not before).
 TEST_F(RouterTest, UpstreamTimingRetry) {
@@ -2294,7 +2635,7 @@ TEST_F(RouterTest, UpstreamTimingRetry) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
   expectResponseTimerCreate();
@@ -2319,7 +2660,7 @@ TEST_F(RouterTest, UpstreamTimingRetry) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
@@ -2374,7 +2715,7 @@ TEST_F(RouterTest, UpstreamTimingTimeout) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
@@ -2724,6 +3065,21 @@ TEST(RouterFilterUtilityTest, ShouldShadow) {
   }
 }
 
+// Test that a shared copy holds the data of the original once it is drained.
+TEST(RouterFilterUtilityTest, ShareData) {
+  Buffer::OwnedImpl data;
+  data.appendSliceForTest("hello ");
+  data.appendSliceForTest("world");
+  Buffer::OwnedImpl copy("copy of ");
+  FilterUtility::shareData(data, copy);
+  EXPECT_EQ("hello world", data.toString());
+  EXPECT_EQ("copy of hello world", copy.toString());
+
+  data.drain(data.length());
+  EXPECT_EQ("copy of hello world", copy.toString());
+  copy.drain(copy.length());
+}
+
 TEST_F(RouterTest, CanaryStatusTrue) {
   EXPECT_CALL(callbacks_.route_->route_entry_, timeout())
       .WillOnce(Return(std::chrono::milliseconds(0)));
@@ -2735,7 +3091,7 @@ TEST_F(RouterTest, CanaryStatusTrue) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
@@ -2768,7 +3124,7 @@ TEST_F(RouterTest, CanaryStatusFalse) {
       .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
@@ -2808,7 +3164,7 @@ TEST_F(RouterTest, AutoHostRewriteEnabled) {
   EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
       .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
@@ -2843,7 +3199,7 @@ TEST_F(RouterTest, AutoHostRewriteDisabled) {
   EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
       .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
                            -> Http::ConnectionPool::Cancellable* {
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
@@ -2880,7 +3236,7 @@ public:
               response_decoder_ = &decoder;
               pool_callbacks_ = &callbacks;
               if (pool_ready) {
-                callbacks.onPoolReady(encoder_, cm_.conn_pool_.host_);
+                callbacks.onPoolReady(encoder_, cm_.conn_pool_.host_, upstream_stream_info_);
               }
               return nullptr;
             }));
@@ -2966,7 +3322,7 @@ TEST_F(WatermarkTest, FilterWatermarks) {
                     .value());
   EXPECT_CALL(encoder_, encodeData(_, true))
       .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void { data.drain(data.length()); }));
-  pool_callbacks_->onPoolReady(encoder_, cm_.conn_pool_.host_);
+  pool_callbacks_->onPoolReady(encoder_, cm_.conn_pool_.host_, upstream_stream_info_);
   EXPECT_EQ(1U, cm_.thread_local_cluster_.cluster_.info_->stats_store_
                     .counter("upstream_flow_control_drained_total")
                     .value());
@@ -2986,7 +3342,7 @@ TEST_F(WatermarkTest, RetryRequestNotComplete) {
           [&](Http::StreamDecoder& decoder,
               Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
             response_decoder = &decoder;
-            callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+            callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_, upstream_stream_info_);
             return nullptr;
           }));
   EXPECT_CALL(callbacks_.stream_info_,
@@ -3030,7 +3386,7 @@ TEST_F(RouterTestChildSpan, BasicFlow) {
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
         EXPECT_CALL(*child_span, injectContext(_));
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
@@ -3061,7 +3417,7 @@ TEST_F(RouterTestChildSpan, ResetFlow) {
                            -> Http::ConnectionPool::Cancellable* {
         response_decoder = &decoder;
         EXPECT_CALL(*child_span, injectContext(_));
-        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_, upstream_stream_info_);
         return nullptr;
       }));
 
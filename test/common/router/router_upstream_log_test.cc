@@ -15,6 +15,7 @@
 #include "test/mocks/router/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/utility.h"
 
@@ -128,7 +129,8 @@ public:
             [&](Http::StreamDecoder& decoder,
                 Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
               response_decoder = &decoder;
-              callbacks.onPoolReady(encoder, context_.cluster_manager_.conn_pool_.host_);
+              callbacks.onPoolReady(encoder, context_.cluster_manager_.conn_pool_.host_,
+                                    upstream_stream_info_);
               return nullptr;
             }));
     expectResponseTimerCreate();
@@ -160,7 +162,8 @@ public:
             [&](Http::StreamDecoder& decoder,
                 Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
               response_decoder = &decoder;
-              callbacks.onPoolReady(encoder1, context_.cluster_manager_.conn_pool_.host_);
+              callbacks.onPoolReady(encoder1, context_.cluster_manager_.conn_pool_.host_,
+                                    upstream_stream_info_);
               return nullptr;
             }));
     expectResponseTimerCreate();
@@ -184,7 +187,8 @@ public:
             [&](Http::StreamDecoder& decoder,
                 Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
               response_decoder = &decoder;
-              callbacks.onPoolReady(encoder2, context_.cluster_manager_.conn_pool_.host_);
+              callbacks.onPoolReady(encoder2, context_.cluster_manager_.conn_pool_.host_,
+                                    upstream_stream_info_);
               return nullptr;
             }));
     expectPerTryTimerCreate();
@@ -211,6 +215,7 @@ public:
   NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks_;
   std::shared_ptr<FilterConfig> config_;
   std::shared_ptr<TestFilter> router_;
+  NiceMock<StreamInfo::MockStreamInfo> upstream_stream_info_;
 };
 
 TEST_F(RouterUpstreamLogTest, NoLogConfigured) {
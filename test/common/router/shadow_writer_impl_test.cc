@@ -1,10 +1,13 @@
 #include <chrono>
 #include <string>
 
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
 #include "common/http/message_impl.h"
 #include "common/router/shadow_writer_impl.h"
 
+#include "test/mocks/buffer/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 
 #include "gmock/gmock.h"
@@ -41,9 +44,38 @@ public:
     writer_.shadow("foo", std::move(message), std::chrono::milliseconds(5));
   }
 
+  ShadowStreamPtr startStreamingShadow() {
+    Http::HeaderMapPtr headers(new Http::HeaderMapImpl());
+    headers->insertHost().value(std::string("cluster1"));
+    EXPECT_CALL(cm_, get("foo"));
+    EXPECT_CALL(cm_, httpAsyncClientForCluster("foo")).WillOnce(ReturnRef(cm_.async_client_));
+    EXPECT_CALL(
+        cm_.async_client_,
+        start(_, Http::AsyncClient::StreamOptions().setTimeout(std::chrono::milliseconds(5))))
+        .WillOnce(Invoke(
+            [&](Http::AsyncClient::StreamCallbacks& callbacks,
+                const Http::AsyncClient::StreamOptions&) -> Http::AsyncClient::Stream* {
+              stream_callbacks_ = &callbacks;
+              return &stream_;
+            }));
+    EXPECT_CALL(stream_, sendHeaders(_, false))
+        .WillOnce(Invoke([](Http::HeaderMap& headers, bool) -> void {
+          EXPECT_STREQ("cluster1-shadow", headers.Host()->value().c_str());
+        }));
+    return writer_.streamingShadow("foo", std::move(headers), std::chrono::milliseconds(5));
+  }
+
+  void expectStreamReset() {
+    EXPECT_CALL(stream_, reset()).WillOnce(Invoke([this]() -> void {
+      stream_callbacks_->onReset();
+    }));
+  }
+
   Upstream::MockClusterManager cm_;
   ShadowWriterImpl writer_{cm_};
   Http::AsyncClient::Callbacks* callback_{};
+  Http::MockAsyncClientStream stream_;
+  Http::AsyncClient::StreamCallbacks* stream_callbacks_{};
 };
 
 TEST_F(ShadowWriterImplTest, Success) {
@@ -70,6 +102,73 @@ TEST_F(ShadowWriterImplTest, NoCluster) {
   writer_.shadow("foo", std::move(message), std::chrono::milliseconds(5));
 }
 
+// Test that a streaming shadow sends the request as it streams, and is left to finish once the
+// request is complete.
+TEST_F(ShadowWriterImplTest, StreamingSuccess) {
+  InSequence s;
+
+  ShadowStreamPtr shadow = startStreamingShadow();
+  ASSERT_NE(nullptr, shadow);
+  Buffer::OwnedImpl data("hello");
+  EXPECT_CALL(stream_, sendData(BufferStringEqual("hello"), false));
+  shadow->sendData(data, false);
+  Http::HeaderMapImpl trailers;
+  EXPECT_CALL(stream_, sendTrailers(_));
+  shadow->sendTrailers(trailers);
+  EXPECT_CALL(stream_, reset()).Times(0);
+  shadow.reset();
+
+  Http::HeaderMapPtr response_headers(new Http::HeaderMapImpl());
+  stream_callbacks_->onHeaders(std::move(response_headers), false);
+  stream_callbacks_->onData(data, true);
+}
+
+// Test that a streaming shadow is reset when it is destroyed before the end of the request.
+TEST_F(ShadowWriterImplTest, StreamingIncomplete) {
+  InSequence s;
+
+  ShadowStreamPtr shadow = startStreamingShadow();
+  expectStreamReset();
+  shadow.reset();
+}
+
+// Test that a streaming shadow is reset when its response completes before the request.
+TEST_F(ShadowWriterImplTest, StreamingEarlyResponse) {
+  InSequence s;
+
+  ShadowStreamPtr shadow = startStreamingShadow();
+  Http::HeaderMapPtr response_headers(new Http::HeaderMapImpl());
+  stream_callbacks_->onHeaders(std::move(response_headers), true);
+  expectStreamReset();
+  EXPECT_CALL(stream_, sendData(_, _)).Times(0);
+  Buffer::OwnedImpl data("hello");
+  shadow->sendData(data, true);
+  shadow.reset();
+}
+
+// Test that nothing more is sent on a streaming shadow that was reset.
+TEST_F(ShadowWriterImplTest, StreamingReset) {
+  InSequence s;
+
+  ShadowStreamPtr shadow = startStreamingShadow();
+  stream_callbacks_->onReset();
+  EXPECT_CALL(stream_, sendData(_, _)).Times(0);
+  EXPECT_CALL(stream_, reset()).Times(0);
+  Buffer::OwnedImpl data("hello");
+  shadow->sendData(data, true);
+  shadow.reset();
+}
+
+TEST_F(ShadowWriterImplTest, StreamingNoCluster) {
+  InSequence s;
+
+  Http::HeaderMapPtr headers(new Http::HeaderMapImpl());
+  EXPECT_CALL(cm_, get("foo")).WillOnce(Return(nullptr));
+  EXPECT_CALL(cm_, httpAsyncClientForCluster("foo")).Times(0);
+  EXPECT_EQ(nullptr,
+            writer_.streamingShadow("foo", std::move(headers), std::chrono::milliseconds(5)));
+}
+
 } // namespace
 } // namespace Router
 } // namespace Envoy
@@ -1,5 +1,8 @@
 #include <memory>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "common/runtime/runtime_impl.h"
 #include "common/stats/isolated_store_impl.h"
@@ -43,6 +46,21 @@ TEST(Random, sanityCheckOfUniquenessRandom) {
   EXPECT_EQ(num_of_results, results.size());
 }
 
+// Each thread has a generator of its own, seeded independently.
+TEST(Random, sanityCheckOfUniquenessAcrossThreads) {
+  Runtime::RandomGeneratorImpl random;
+  std::vector<uint64_t> results(4);
+  std::vector<std::thread> threads;
+  for (uint64_t& result : results) {
+    threads.emplace_back([&random, &result]() { result = random.random(); });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(results.size(), std::set<uint64_t>(results.begin(), results.end()).size());
+}
+
 TEST(UUID, checkLengthOfUUID) {
   RandomGeneratorImpl random;
 
@@ -52,6 +70,26 @@ TEST(UUID, checkLengthOfUUID) {
   EXPECT_EQ(expected_length, result.length());
 }
 
+TEST(UUID, bufferMatchesFormat) {
+  RandomGeneratorImpl random;
+
+  char buffer[RandomGeneratorImpl::UUID_LENGTH + 1];
+  buffer[RandomGeneratorImpl::UUID_LENGTH] = 'x';
+  random.uuid(buffer);
+
+  // Nothing is written past the uuid.
+  EXPECT_EQ('x', buffer[RandomGeneratorImpl::UUID_LENGTH]);
+  const std::string uuid(buffer, RandomGeneratorImpl::UUID_LENGTH);
+  EXPECT_EQ('-', uuid[8]);
+  EXPECT_EQ('-', uuid[13]);
+  EXPECT_EQ('4', uuid[14]);
+  EXPECT_EQ('-', uuid[18]);
+  EXPECT_NE(std::string::npos, std::string("89ab").find(uuid[19]));
+  EXPECT_EQ('-', uuid[23]);
+  EXPECT_EQ(std::string::npos, uuid.find_first_not_of("0123456789abcdef-"));
+  EXPECT_NE(uuid, random.uuid());
+}
+
 TEST(UUID, sanityCheckOfUniqueness) {
   std::set<std::string> uuids;
   const size_t num_of_uuids = 100000;
@@ -326,6 +364,48 @@ TEST(LoaderImplTest, All) {
   testNewOverrides(loader, store);
 }
 
+// Handles find the values of the snapshots created after them by index, and the values of the
+// older snapshots by key.
+TEST(LoaderImplTest, FeatureHandles) {
+  MockRandomGenerator generator;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  Stats::IsolatedStoreImpl store;
+  LoaderImpl loader(generator, store, tls);
+  loader.mergeValues({{"handle.integer", "42"}, {"handle.percent", "0"}});
+
+  const FeatureHandleImpl integer("handle.integer");
+  const FeatureHandleImpl percent("handle.percent");
+  const FeatureHandleImpl missing("handle.missing");
+  EXPECT_EQ(integer.index(), FeatureHandleImpl("handle.integer").index());
+  EXPECT_NE(integer.index(), percent.index());
+  EXPECT_EQ("handle.integer", FeatureHandleImpl::keys()[integer.index()]);
+
+  for (int i = 0; i < 2; i++) {
+    Snapshot& snapshot = loader.snapshot();
+    EXPECT_EQ(42, snapshot.getInteger(integer, 1));
+    EXPECT_EQ(1, snapshot.getInteger(missing, 1));
+    EXPECT_FALSE(snapshot.featureEnabled(percent, 100));
+    EXPECT_TRUE(snapshot.featureEnabled(missing, 100));
+    EXPECT_FALSE(snapshot.featureEnabled(percent, 100, 1));
+    EXPECT_TRUE(snapshot.featureEnabled(integer, 0, 41, 10000));
+    EXPECT_FALSE(snapshot.featureEnabled(integer, 0, 42, 10000));
+    envoy::type::FractionalPercent default_value;
+    default_value.set_numerator(100);
+    EXPECT_FALSE(snapshot.featureEnabled(percent, default_value, 1));
+    EXPECT_TRUE(snapshot.featureEnabled(missing, default_value, 1));
+    // A feature sampled at 0% does not draw a random value.
+    EXPECT_CALL(generator, random()).WillOnce(Return(1));
+    EXPECT_FALSE(snapshot.featureEnabled(percent, default_value));
+    EXPECT_TRUE(snapshot.featureEnabled(missing, default_value));
+
+    // The new snapshot resolves the handles by index.
+    loader.mergeValues({});
+  }
+
+  loader.mergeValues({{"handle.integer", "7"}});
+  EXPECT_EQ(7, loader.snapshot().getInteger(integer, 1));
+}
+
 class DiskLayerTest : public testing::Test {
 protected:
   DiskLayerTest() : api_(Api::createApiForTest()) {}
@@ -15,6 +15,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::Return;
 using testing::ReturnRef;
 
@@ -127,9 +128,9 @@ TEST_F(SecretManagerImplTest, DuplicateStaticCertificateValidationContextSecret)
                             "Duplicate static CertificateValidationContext secret name abc.com");
 }
 
-// Validate that secret manager throws an exception when adding static secret of a type that is not
-// supported.
-TEST_F(SecretManagerImplTest, NotImplementedException) {
+// Validate that secret manager adds static session ticket keys secret successfully, and rejects
+// duplicates.
+TEST_F(SecretManagerImplTest, SessionTicketKeysSecretLoadSuccess) {
   envoy::api::v2::auth::Secret secret_config;
 
   const std::string yaml =
@@ -137,11 +138,30 @@ TEST_F(SecretManagerImplTest, NotImplementedException) {
 name: "abc.com"
 session_ticket_keys:
   keys:
-    - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_cert.pem"
+    - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_a"
 )EOF";
 
   MessageUtil::loadFromYaml(TestEnvironment::substitute(yaml), secret_config);
 
+  std::unique_ptr<SecretManager> secret_manager(new SecretManagerImpl());
+  secret_manager->addStaticSecret(secret_config);
+
+  ASSERT_EQ(secret_manager->findStaticTlsSessionTicketKeysProvider("undefined"), nullptr);
+  ASSERT_NE(secret_manager->findStaticTlsSessionTicketKeysProvider("abc.com"), nullptr);
+  EXPECT_EQ(1, secret_manager->findStaticTlsSessionTicketKeysProvider("abc.com")
+                   ->secret()
+                   ->keys()
+                   .size());
+  EXPECT_THROW_WITH_MESSAGE(secret_manager->addStaticSecret(secret_config), EnvoyException,
+                            "Duplicate static TlsSessionTicketKeys secret name abc.com");
+}
+
+// Validate that secret manager throws an exception when adding static secret of a type that is not
+// supported.
+TEST_F(SecretManagerImplTest, NotImplementedException) {
+  envoy::api::v2::auth::Secret secret_config;
+  secret_config.set_name("abc.com");
+
   std::unique_ptr<SecretManager> secret_manager(new SecretManagerImpl());
 
   EXPECT_THROW_WITH_MESSAGE(secret_manager->addStaticSecret(secret_config), EnvoyException,
@@ -194,6 +214,38 @@ tls_certificate:
             tls_config.privateKey());
 }
 
+// The init managers of all the listeners or clusters sharing a dynamic secret wait for it.
+TEST_F(SecretManagerImplTest, SdsDynamicSecretSharedInitManagers) {
+  std::unique_ptr<SecretManager> secret_manager(std::make_unique<SecretManagerImpl>());
+
+  envoy::api::v2::core::ConfigSource config_source;
+  NiceMock<LocalInfo::MockLocalInfo> local_info;
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<Runtime::MockRandomGenerator> random;
+  Stats::IsolatedStoreImpl stats;
+  NiceMock<Upstream::MockClusterManager> cluster_manager;
+
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> secret_context1;
+  Init::MockManager init_manager1;
+  ON_CALL(secret_context1, localInfo()).WillByDefault(ReturnRef(local_info));
+  ON_CALL(secret_context1, dispatcher()).WillByDefault(ReturnRef(dispatcher));
+  ON_CALL(secret_context1, random()).WillByDefault(ReturnRef(random));
+  ON_CALL(secret_context1, stats()).WillByDefault(ReturnRef(stats));
+  ON_CALL(secret_context1, clusterManager()).WillByDefault(ReturnRef(cluster_manager));
+  ON_CALL(secret_context1, initManager()).WillByDefault(Return(&init_manager1));
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> secret_context2;
+  Init::MockManager init_manager2;
+  ON_CALL(secret_context2, initManager()).WillByDefault(Return(&init_manager2));
+
+  EXPECT_CALL(init_manager1, add(_));
+  auto secret_provider1 =
+      secret_manager->findOrCreateTlsCertificateProvider(config_source, "abc.com", secret_context1);
+  EXPECT_CALL(init_manager2, add(_));
+  auto secret_provider2 =
+      secret_manager->findOrCreateTlsCertificateProvider(config_source, "abc.com", secret_context2);
+  EXPECT_EQ(secret_provider1, secret_provider2);
+}
+
 } // namespace
 } // namespace Secret
 } // namespace Envoy
@@ -28,7 +28,7 @@ TEST_F(HeapStatDataTest, HeapNoTruncate) {
   const std::string long_string(stats_options.maxNameLength() + 1, 'A');
   HeapStatData* stat{};
   EXPECT_NO_LOGS(stat = alloc_.alloc(long_string));
-  EXPECT_EQ(stat->key(), long_string);
+  EXPECT_EQ(symbol_table_.toString(stat->statName()), long_string);
   alloc_.free(*stat);
 }
 
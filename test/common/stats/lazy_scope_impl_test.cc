@@ -0,0 +1,83 @@
+#include <string>
+
+#include "envoy/stats/stats_macros.h"
+
+#include "common/stats/isolated_store_impl.h"
+#include "common/stats/lazy_scope_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+
+class LazyScopeImplTest : public testing::Test {
+public:
+  LazyScopeImplTest() : scope_(store_.createScope("scope.")), lazy_scope_(*scope_) {}
+
+  IsolatedStoreImpl store_;
+  ScopePtr scope_;
+  LazyScopeImpl lazy_scope_;
+};
+
+TEST_F(LazyScopeImplTest, CounterCreatedOnFirstWrite) {
+  Counter& counter = lazy_scope_.counter("c1");
+  EXPECT_TRUE(store_.counters().empty());
+  EXPECT_EQ(0, counter.value());
+  EXPECT_EQ(0, counter.latch());
+  EXPECT_FALSE(counter.used());
+  counter.reset();
+  EXPECT_TRUE(store_.counters().empty());
+
+  counter.inc();
+  ASSERT_EQ(1, store_.counters().size());
+  EXPECT_EQ(&scope_->counter("c1"), store_.counters()[0].get());
+  EXPECT_EQ(1, store_.counters()[0]->value());
+  EXPECT_EQ(1, counter.value());
+  EXPECT_TRUE(counter.used());
+  EXPECT_EQ("scope.c1", counter.name());
+}
+
+TEST_F(LazyScopeImplTest, GaugeCreatedOnFirstWrite) {
+  Gauge& gauge = lazy_scope_.gauge("g1");
+  EXPECT_TRUE(store_.gauges().empty());
+  EXPECT_EQ(0, gauge.value());
+  EXPECT_FALSE(gauge.used());
+
+  gauge.set(5);
+  ASSERT_EQ(1, store_.gauges().size());
+  EXPECT_EQ(5, store_.gauges()[0]->value());
+  gauge.dec();
+  EXPECT_EQ(4, scope_->gauge("g1").value());
+}
+
+TEST_F(LazyScopeImplTest, NameCreatesStat) {
+  Counter& counter = lazy_scope_.counter("c1");
+  EXPECT_EQ("scope.c1", counter.tagExtractedName());
+  EXPECT_EQ(1, store_.counters().size());
+  EXPECT_EQ(0, counter.value());
+}
+
+TEST_F(LazyScopeImplTest, Histogram) {
+  Histogram& histogram = lazy_scope_.histogram("h1");
+  histogram.recordValue(1);
+  EXPECT_EQ("scope.h1", histogram.name());
+}
+
+#define LAZY_TEST_STATS(COUNTER, GAUGE) COUNTER(cold_counter) COUNTER(hot_counter) GAUGE(cold_gauge)
+
+struct LazyTestStats {
+  LAZY_TEST_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+// Only the stats of a struct that are written show up in the store.
+TEST_F(LazyScopeImplTest, StatsStruct) {
+  LazyTestStats stats{LAZY_TEST_STATS(POOL_COUNTER(lazy_scope_), POOL_GAUGE(lazy_scope_))};
+  stats.hot_counter_.inc();
+  ASSERT_EQ(1, store_.counters().size());
+  EXPECT_EQ("scope.hot_counter", store_.counters()[0]->name());
+  EXPECT_TRUE(store_.gauges().empty());
+  EXPECT_EQ(0, stats.cold_counter_.value());
+}
+
+} // namespace Stats
+} // namespace Envoy
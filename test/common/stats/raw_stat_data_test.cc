@@ -2,6 +2,7 @@
 
 #include "common/stats/raw_stat_data.h"
 #include "common/stats/stats_options_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "test/test_common/logging.h"
 #include "test/test_common/utility.h"
@@ -52,6 +53,24 @@ TEST_F(RawStatDataTest, RawAlloc) {
   allocator_.free(*stat_3);
 }
 
+// The shared-memory names are mirrored into the process-local symbol table
+// until the last local reference is dropped.
+TEST(RawStatDataSymbolTableTest, StatName) {
+  StatsOptionsImpl stats_options;
+  SymbolTableImpl symbol_table;
+  {
+    TestAllocator allocator(stats_options, symbol_table);
+    RawStatData* stat_1 = allocator.alloc("ref.name");
+    RawStatData* stat_2 = allocator.alloc("ref.name");
+    ASSERT_EQ(stat_1, stat_2);
+    EXPECT_EQ("ref.name", symbol_table.toString(allocator.statName(*stat_1)));
+    allocator.free(*stat_1);
+    EXPECT_EQ("ref.name", symbol_table.toString(allocator.statName(*stat_2)));
+    allocator.free(*stat_2);
+  }
+  EXPECT_EQ(0, symbol_table.numSymbols());
+}
+
 } // namespace
 } // namespace Stats
 } // namespace Envoy
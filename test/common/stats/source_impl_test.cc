@@ -48,6 +48,55 @@ TEST(SourceImplTest, Caching) {
   EXPECT_EQ(source.cachedHistograms(), stored_histograms);
 }
 
+TEST(SourceImplTest, ChangedStats) {
+  NiceMock<MockStore> store;
+  std::vector<CounterSharedPtr> stored_counters;
+  std::vector<GaugeSharedPtr> stored_gauges;
+
+  ON_CALL(store, counters()).WillByDefault(ReturnPointee(&stored_counters));
+  ON_CALL(store, gauges()).WillByDefault(ReturnPointee(&stored_gauges));
+
+  auto counter1 = std::make_shared<NiceMock<MockCounter>>();
+  auto counter2 = std::make_shared<NiceMock<MockCounter>>();
+  auto unused_counter = std::make_shared<NiceMock<MockCounter>>();
+  counter1->used_ = true;
+  counter1->value_ = 1;
+  counter2->used_ = true;
+  counter2->value_ = 2;
+  unused_counter->used_ = false;
+  stored_counters = {counter1, counter2, unused_counter};
+
+  auto gauge = std::make_shared<NiceMock<MockGauge>>();
+  gauge->used_ = true;
+  gauge->value_ = 5;
+  stored_gauges = {gauge};
+
+  SourceImpl source(store);
+
+  // Everything used is new on the first flush.
+  EXPECT_EQ(source.cachedChangedCounters(), std::vector<CounterSharedPtr>({counter1, counter2}));
+  EXPECT_EQ(source.cachedChangedGauges(), std::vector<GaugeSharedPtr>({gauge}));
+
+  // Nothing changed.
+  source.clearCache();
+  EXPECT_TRUE(source.cachedChangedCounters().empty());
+  EXPECT_TRUE(source.cachedChangedGauges().empty());
+
+  // Only the stats whose value moved show up, and the view is cached until cleared.
+  source.clearCache();
+  counter2->value_ = 3;
+  gauge->value_ = 4;
+  EXPECT_EQ(source.cachedChangedCounters(), std::vector<CounterSharedPtr>({counter2}));
+  EXPECT_EQ(source.cachedChangedGauges(), std::vector<GaugeSharedPtr>({gauge}));
+  counter1->value_ = 7;
+  EXPECT_EQ(source.cachedChangedCounters(), std::vector<CounterSharedPtr>({counter2}));
+
+  // The change to counter1 is picked up by the next flush.
+  source.clearCache();
+  EXPECT_EQ(source.cachedChangedCounters(), std::vector<CounterSharedPtr>({counter1}));
+  EXPECT_TRUE(source.cachedChangedGauges().empty());
+}
+
 } // namespace
 } // namespace Stats
 } // namespace Envoy
@@ -411,23 +411,8 @@ TEST_P(StatNameTest, RacingSymbolCreation) {
   access.setReady();
   accesses.Wait();
 
-  // In a perfect world, we could use reader-locks in the SymbolTable
-  // implementation, and there should be zero additional contentions
-  // after latching 'create_contentions' above. And we can definitely
-  // have this world, but this slows down BM_CreateRace in
-  // symbol_table_speed_test.cc, even on a 72-core machine.
-  //
-  // Thus it is better to avoid symbol-table contention by refactoring
-  // all stat-creation code to symbolize all stat string elements at
-  // construction, as composition does not require a lock.
-  //
-  // See this commit
-  // https://github.com/envoyproxy/envoy/pull/5321/commits/ef712d0f5a11ff49831c1935e8a2ef8a0a935bc9
-  // for a working reader-lock implementation, which would pass this EXPECT:
-  //     EXPECT_EQ(create_contentions, mutex_tracer.numContentions());
-  //
-  // Note also that we cannot guarantee there *will* be contentions
-  // as a machine or OS is free to run all threads serially.
+  // Note that we cannot guarantee there *will* be contentions as a machine
+  // or OS is free to run all threads serially.
 
   wait.setReady();
   for (auto& thread : threads) {
@@ -479,23 +464,13 @@ TEST_P(StatNameTest, MutexContentionOnExistingSymbols) {
   access.setReady();
   accesses.Wait();
 
-  // In a perfect world, we could use reader-locks in the SymbolTable
-  // implementation, and there should be zero additional contentions
-  // after latching 'create_contentions' above. And we can definitely
-  // have this world, but this slows down BM_CreateRace in
-  // symbol_table_speed_test.cc, even on a 72-core machine.
-  //
-  // Thus it is better to avoid symbol-table contention by refactoring
-  // all stat-creation code to symbolize all stat string elements at
-  // construction, as composition does not require a lock.
-  //
-  // See this commit
-  // https://github.com/envoyproxy/envoy/pull/5321/commits/ef712d0f5a11ff49831c1935e8a2ef8a0a935bc9
-  // for a working reader-lock implementation, which would pass this EXPECT:
-  //     EXPECT_EQ(create_contentions, mutex_tracer.numContentions());
-  //
-  // Note also that we cannot guarantee there *will* be contentions
-  // as a machine or OS is free to run all threads serially.
+  // Encoding names whose symbols all exist only takes the symbol table lock
+  // shared, so the symbol table adds no contentions after latching
+  // 'create_contentions' above. This is not asserted because the tracer
+  // counts contentions on every mutex, including the ones that sequence the
+  // threads in this test.
+  ENVOY_LOG_MISC(info, "Number of contentions: {}",
+                 mutex_tracer.numContentions() - create_contentions);
 
   wait.setReady();
   for (auto& thread : threads) {
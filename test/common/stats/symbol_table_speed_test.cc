@@ -9,6 +9,7 @@
 
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "benchmark/benchmark.h"
 
@@ -54,6 +55,81 @@ static void BM_CreateRace(benchmark::State& state) {
 }
 BENCHMARK(BM_CreateRace);
 
+static void BM_DecodeRace(benchmark::State& state) {
+  Envoy::Thread::ThreadFactory& thread_factory = Envoy::Thread::threadFactoryForTest();
+
+  // Make threads that all decode the same stat name, as happens when stats
+  // are rendered for sinks and the admin endpoints while workers run.
+  constexpr int num_threads = 36;
+  std::vector<Envoy::Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  Envoy::ConditionalInitializer access;
+  absl::BlockingCounter accesses(num_threads);
+  Envoy::Stats::SymbolTableImpl table;
+  Envoy::Stats::StatNameStorage initial("here.is.a.stat.name", table);
+  const Envoy::Stats::StatName stat_name = initial.statName();
+
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(
+        thread_factory.createThread([&access, &accesses, &state, &table, stat_name]() {
+          access.wait();
+
+          for (auto _ : state) {
+            benchmark::DoNotOptimize(table.toString(stat_name));
+          }
+          accesses.DecrementCount();
+        }));
+  }
+
+  access.setReady();
+  accesses.Wait();
+
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  initial.free(table);
+}
+BENCHMARK(BM_DecodeRace);
+
+static void BM_CreateNewRace(benchmark::State& state) {
+  Envoy::Thread::ThreadFactory& thread_factory = Envoy::Thread::threadFactoryForTest();
+
+  // Make threads that each encode a name with a token of their own alongside
+  // shared ones, so that every iteration adds and removes a symbol while the
+  // shared tokens are looked up concurrently.
+  constexpr int num_threads = 36;
+  std::vector<Envoy::Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  Envoy::ConditionalInitializer access;
+  absl::BlockingCounter accesses(num_threads);
+  Envoy::Stats::SymbolTableImpl table;
+  Envoy::Stats::StatNameStorage initial("cluster.upstream_rq_total", table);
+
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([&access, &accesses, &state, &table, i]() {
+      const std::string stat_name_string = absl::StrCat("cluster.worker_", i, ".upstream_rq_total");
+      access.wait();
+
+      for (auto _ : state) {
+        Envoy::Stats::StatNameStorage second(stat_name_string, table);
+        second.free(table);
+      }
+      accesses.DecrementCount();
+    }));
+  }
+
+  access.setReady();
+  accesses.Wait();
+
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  initial.free(table);
+}
+BENCHMARK(BM_CreateNewRace);
+
 int main(int argc, char** argv) {
   Envoy::Thread::MutexBasicLockable lock;
   Envoy::Logger::Context logger_context(spdlog::level::warn,
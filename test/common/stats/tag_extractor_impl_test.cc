@@ -41,6 +41,50 @@ TEST(TagExtractorTest, SingleSubexpression) {
   EXPECT_EQ("listner_port", tags.at(0).name_);
 }
 
+TEST(TagExtractorTest, Re2TwoSubexpressions) {
+  TagExtractorPtr tag_extractor = TagExtractorImplBase::createTagExtractor(
+      "cluster_name", "^cluster\\.((.+?)\\.)", "", Regex::Type::Re2);
+  EXPECT_EQ("cluster_name", tag_extractor->name());
+  EXPECT_EQ("cluster", tag_extractor->prefixToken());
+  std::string name = "cluster.test_cluster.upstream_cx_total";
+  std::vector<Tag> tags;
+  IntervalSetImpl<size_t> remove_characters;
+  ASSERT_TRUE(tag_extractor->extractTag(name, tags, remove_characters));
+  std::string tag_extracted_name = StringUtil::removeCharacters(name, remove_characters);
+  EXPECT_EQ("cluster.upstream_cx_total", tag_extracted_name);
+  ASSERT_EQ(1, tags.size());
+  EXPECT_EQ("test_cluster", tags.at(0).value_);
+  EXPECT_EQ("cluster_name", tags.at(0).name_);
+}
+
+TEST(TagExtractorTest, Re2SingleSubexpression) {
+  TagExtractorRe2Impl tag_extractor("listner_port", "^listener\\.(\\d+?\\.)");
+  std::string name = "listener.80.downstream_cx_total";
+  std::vector<Tag> tags;
+  IntervalSetImpl<size_t> remove_characters;
+  ASSERT_TRUE(tag_extractor.extractTag(name, tags, remove_characters));
+  std::string tag_extracted_name = StringUtil::removeCharacters(name, remove_characters);
+  EXPECT_EQ("listener.downstream_cx_total", tag_extracted_name);
+  ASSERT_EQ(1, tags.size());
+  EXPECT_EQ("80.", tags.at(0).value_);
+}
+
+TEST(TagExtractorTest, Re2NoMatch) {
+  TagExtractorRe2Impl tag_extractor("listner_port", "^listener\\.(\\d+?\\.)");
+  std::string name = "cluster.80.downstream_cx_total";
+  std::vector<Tag> tags;
+  IntervalSetImpl<size_t> remove_characters;
+  EXPECT_FALSE(tag_extractor.extractTag(name, tags, remove_characters));
+  EXPECT_TRUE(tags.empty());
+}
+
+TEST(TagExtractorTest, Re2Invalid) {
+  // Lookahead is not supported by RE2.
+  EXPECT_THROW_WITH_REGEX(TagExtractorImplBase::createTagExtractor(
+                              "name", "^http(?=\\.).*?\\.((.+?)\\.)", "", Regex::Type::Re2),
+                          EnvoyException, "Invalid regex");
+}
+
 TEST(TagExtractorTest, substrMismatch) {
   TagExtractorImpl tag_extractor("listner_port", "^listener\\.(\\d+?\\.)\\.foo\\.", ".foo.");
   EXPECT_TRUE(tag_extractor.substrMismatch("listener.80.downstream_cx_total"));
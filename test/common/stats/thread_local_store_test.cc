@@ -19,6 +19,7 @@
 #include "test/test_common/logging.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -1094,6 +1095,42 @@ TEST_F(HistogramTest, BasicHistogramUsed) {
   }
 }
 
+// Histograms are merged in chunks; make sure every histogram in every chunk is merged, and that
+// idle histograms keep their cumulative statistics while their interval statistics are cleared.
+TEST_F(HistogramTest, ManyHistogramsMerge) {
+  const uint64_t num_histograms = 150;
+  for (uint64_t i = 0; i < num_histograms; ++i) {
+    Histogram& histogram = store_->histogram(absl::StrCat("h", i));
+    EXPECT_CALL(sink_, onHistogramComplete(Ref(histogram), i));
+    histogram.recordValue(i);
+  }
+
+  store_->mergeHistograms([]() -> void {});
+  std::vector<ParentHistogramSharedPtr> histogram_list = store_->histograms();
+  EXPECT_EQ(num_histograms, histogram_list.size());
+  for (const ParentHistogramSharedPtr& histogram : histogram_list) {
+    EXPECT_TRUE(histogram->used());
+    EXPECT_EQ(1, histogram->cumulativeStatistics().sampleCount());
+    EXPECT_EQ(1, histogram->intervalStatistics().sampleCount());
+  }
+
+  // Record into a single histogram; the rest are idle for this interval.
+  Histogram& h0 = store_->histogram("h0");
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(h0), 5));
+  h0.recordValue(5);
+
+  store_->mergeHistograms([]() -> void {});
+  for (const ParentHistogramSharedPtr& histogram : store_->histograms()) {
+    if (histogram->name() == "h0") {
+      EXPECT_EQ(2, histogram->cumulativeStatistics().sampleCount());
+      EXPECT_EQ(1, histogram->intervalStatistics().sampleCount());
+    } else {
+      EXPECT_EQ(1, histogram->cumulativeStatistics().sampleCount());
+      EXPECT_EQ(0, histogram->intervalStatistics().sampleCount());
+    }
+  }
+}
+
 class TruncatingAllocTest : public HeapStatsThreadLocalStoreTest {
 protected:
   TruncatingAllocTest()
@@ -1148,5 +1185,41 @@ TEST_F(TruncatingAllocTest, HistogramWithLongNameNotTruncated) {
   });
 }
 
+// Exercises the store with the symbol table used in production, verifying that
+// StatName-keyed lookups find the same stats, and that every symbol is released
+// once the stats are gone.
+TEST(ThreadLocalStoreSymbolTableTest, StatNameKeysReleaseSymbols) {
+  SymbolTableImpl symbol_table;
+  StatsOptionsImpl options;
+  NiceMock<Event::MockDispatcher> main_thread_dispatcher;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  {
+    HeapStatDataAllocator alloc(symbol_table);
+    ThreadLocalStoreImpl store(options, alloc);
+    store.initializeThreading(main_thread_dispatcher, tls);
+
+    ScopePtr scope = store.createScope("scope.");
+    Counter& counter = scope->counter("c1");
+    EXPECT_EQ(&counter, &scope->counter("c1"));
+    EXPECT_EQ("scope.c1", counter.name());
+    EXPECT_EQ("scope.c1", symbol_table.toString(counter.statName()));
+
+    Gauge& gauge = scope->gauge("g1");
+    EXPECT_EQ(&gauge, &scope->gauge("g1"));
+    EXPECT_EQ("scope.g1", gauge.name());
+
+    Histogram& histogram = scope->histogram("h1");
+    EXPECT_EQ(&histogram, &scope->histogram("h1"));
+    EXPECT_EQ("scope.h1", histogram.name());
+    histogram.recordValue(1);
+    EXPECT_LT(0, symbol_table.numSymbols());
+
+    scope.reset();
+    store.shutdownThreading();
+    tls.shutdownThread();
+  }
+  EXPECT_EQ(0, symbol_table.numSymbols());
+}
+
 } // namespace Stats
 } // namespace Envoy
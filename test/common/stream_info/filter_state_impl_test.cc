@@ -1,5 +1,6 @@
 #include "envoy/common/exception.h"
 
+#include "common/protobuf/protobuf.h"
 #include "common/stream_info/filter_state_impl.h"
 
 #include "test/test_common/utility.h"
@@ -239,5 +240,31 @@ TEST_F(FilterStateImplTest, HasData) {
   EXPECT_FALSE(filter_state().hasDataWithName("test_2"));
 }
 
+// The names and the index of the data may be allocated from an arena, while the data itself is
+// still destroyed with the filter state.
+TEST(FilterStateImplArenaTest, Arena) {
+  size_t destruction_count = 0u;
+  Protobuf::Arena arena;
+  {
+    FilterStateImpl filter_state(&arena);
+    const std::string long_name(64, 'a');
+    filter_state.setData(long_name,
+                         std::make_unique<TestStoredTypeTracking>(5, nullptr, &destruction_count),
+                         FilterState::StateType::Mutable);
+    filter_state.setData("short", std::make_unique<SimpleType>(1),
+                         FilterState::StateType::ReadOnly);
+    EXPECT_GT(arena.SpaceUsed(), long_name.size());
+    EXPECT_EQ(5, filter_state.getDataReadOnly<TestStoredTypeTracking>(long_name).access());
+    EXPECT_EQ(1, filter_state.getDataReadOnly<SimpleType>("short").access());
+
+    filter_state.setData(long_name,
+                         std::make_unique<TestStoredTypeTracking>(6, nullptr, &destruction_count),
+                         FilterState::StateType::Mutable);
+    EXPECT_EQ(1u, destruction_count);
+    EXPECT_EQ(6, filter_state.getDataReadOnly<TestStoredTypeTracking>(long_name).access());
+  }
+  EXPECT_EQ(2u, destruction_count);
+}
+
 } // namespace StreamInfo
 } // namespace Envoy
@@ -194,6 +194,10 @@ TEST_F(StreamInfoImplTest, DynamicMetadataTest) {
   // check json contains the key and values we set
   EXPECT_TRUE(json.find("\"test_key\":\"test_value\"") != std::string::npos);
   EXPECT_TRUE(json.find("\"another_key\":\"another_value\"") != std::string::npos);
+  // The metadata is allocated from the arena of the stream.
+  EXPECT_EQ(&stream_info.arena_, stream_info.dynamicMetadata().GetArena());
+  EXPECT_EQ(&stream_info.arena_,
+            stream_info.dynamicMetadata().filter_metadata().at("com.test").GetArena());
 }
 
 } // namespace
@@ -31,10 +31,12 @@
 #include "gtest/gtest.h"
 
 using testing::_;
+using testing::Ge;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
 using testing::MatchesRegex;
 using testing::NiceMock;
+using testing::Property;
 using testing::Return;
 using testing::ReturnPointee;
 using testing::ReturnRef;
@@ -527,6 +529,26 @@ TEST_F(TcpProxyTest, HalfCloseProxy) {
   upstream_callbacks_->onEvent(Network::ConnectionEvent::RemoteClose);
 }
 
+// Tests that the configured buffer limit applies to both proxied connections.
+TEST_F(TcpProxyTest, PerConnectionBufferLimitBytes) {
+  envoy::config::filter::network::tcp_proxy::v2::TcpProxy config = defaultConfig();
+  config.mutable_per_connection_buffer_limit_bytes()->set_value(4096);
+  EXPECT_CALL(filter_callbacks_.connection_, setBufferLimits(4096));
+  setup(1, config);
+
+  EXPECT_CALL(*upstream_connections_.at(0), setBufferLimits(4096));
+  raiseEventUpstreamConnected(0);
+}
+
+// Tests that the buffer limits of the listener and the cluster apply by default.
+TEST_F(TcpProxyTest, DefaultBufferLimits) {
+  EXPECT_CALL(filter_callbacks_.connection_, setBufferLimits(_)).Times(0);
+  setup(1);
+
+  EXPECT_CALL(*upstream_connections_.at(0), setBufferLimits(_)).Times(0);
+  raiseEventUpstreamConnected(0);
+}
+
 // Test that downstream is closed after an upstream LocalClose.
 TEST_F(TcpProxyTest, UpstreamLocalDisconnect) {
   setup(1);
@@ -545,6 +567,18 @@ TEST_F(TcpProxyTest, UpstreamLocalDisconnect) {
   upstream_callbacks_->onEvent(Network::ConnectionEvent::LocalClose);
 }
 
+// Test that the time from the downstream connection to the upstream one being ready is recorded.
+TEST_F(TcpProxyTest, UpstreamConnectionSetupTime) {
+  setup(1);
+
+  timeSystem().sleep(std::chrono::milliseconds(10));
+  EXPECT_CALL(
+      factory_context_.scope_,
+      deliverHistogramToSinks(Property(&Stats::Metric::name, "tcp.name.upstream_cx_setup_ms"),
+                              Ge(10U)));
+  raiseEventUpstreamConnected(0);
+}
+
 // Test that downstream is closed after an upstream RemoteClose.
 TEST_F(TcpProxyTest, UpstreamRemoteDisconnect) {
   setup(1);
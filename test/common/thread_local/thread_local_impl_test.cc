@@ -1,3 +1,6 @@
+#include <string>
+#include <vector>
+
 #include "common/common/thread.h"
 #include "common/event/dispatcher_impl.h"
 #include "common/stats/isolated_store_impl.h"
@@ -11,6 +14,7 @@ using testing::_;
 using testing::InSequence;
 using testing::Ref;
 using testing::ReturnPointee;
+using testing::SaveArg;
 
 namespace Envoy {
 namespace ThreadLocal {
@@ -113,6 +117,53 @@ TEST_F(ThreadLocalInstanceImplTest, RunOnAllThreads) {
   tls_.shutdownThread();
 }
 
+// The worker side of the updates made during a batch is delivered by a single post once the
+// outermost batch ends, while the main thread side runs immediately.
+TEST_F(ThreadLocalInstanceImplTest, UpdateBatch) {
+  SlotPtr slot1 = tls_.allocateSlot();
+  SlotPtr slot2 = tls_.allocateSlot();
+  std::shared_ptr<TestThreadLocalObject> object1(new TestThreadLocalObject());
+  std::shared_ptr<TestThreadLocalObject> object2(new TestThreadLocalObject());
+  std::vector<std::string> calls;
+
+  Event::PostCb batch;
+  EXPECT_CALL(thread_dispatcher_, post(_)).WillOnce(SaveArg<0>(&batch));
+  {
+    UpdateBatchPtr outer = tls_.startUpdateBatch();
+    {
+      UpdateBatchPtr inner = tls_.startUpdateBatch();
+      slot1->set([&](Event::Dispatcher&) -> ThreadLocalObjectSharedPtr {
+        calls.push_back("set1");
+        return object1;
+      });
+      slot1->runOnAllThreads([&]() -> void { calls.push_back("run1"); });
+    }
+    slot2->set([&](Event::Dispatcher&) -> ThreadLocalObjectSharedPtr {
+      calls.push_back("set2");
+      return object2;
+    });
+    EXPECT_EQ((std::vector<std::string>{"set1", "run1", "set2"}), calls);
+    EXPECT_FALSE(batch);
+  }
+
+  ASSERT_TRUE(batch);
+  calls.clear();
+  batch();
+  EXPECT_EQ((std::vector<std::string>{"set1", "run1", "set2"}), calls);
+  EXPECT_EQ(object1, slot1->get());
+  EXPECT_EQ(object2, slot2->get());
+
+  // Empty batches post nothing.
+  {
+    UpdateBatchPtr empty = tls_.startUpdateBatch();
+  }
+
+  tls_.shutdownGlobalThreading();
+  object1.reset();
+  object2.reset();
+  tls_.shutdownThread();
+}
+
 // Validate ThreadLocal::InstanceImpl's dispatcher() behavior.
 TEST(ThreadLocalInstanceImplDispatcherTest, Dispatcher) {
   InstanceImpl tls;
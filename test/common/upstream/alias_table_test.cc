@@ -0,0 +1,76 @@
+#include <cstdint>
+#include <vector>
+
+#include "common/upstream/alias_table.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+// Count the picks of each index over the random numbers of every bucket combined with `steps`
+// evenly spaced values of the high 32 bits, which covers the table's probabilities exactly up to
+// a resolution of 1 / steps.
+std::vector<uint64_t> countPicks(const AliasTable& table, uint64_t steps) {
+  std::vector<uint64_t> counts(table.size());
+  for (uint64_t bucket = 0; bucket < table.size(); ++bucket) {
+    for (uint64_t step = 0; step < steps; ++step) {
+      const uint64_t high = (step << 32) / steps;
+      ++counts[table.pick((high << 32) | bucket)];
+    }
+  }
+  return counts;
+}
+
+TEST(AliasTableTest, Empty) {
+  AliasTable table({});
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(0, table.size());
+}
+
+TEST(AliasTableTest, SingleWeight) {
+  AliasTable table({42});
+  EXPECT_EQ(1, table.size());
+  EXPECT_EQ(0, table.pick(0));
+  EXPECT_EQ(0, table.pick(12345));
+  EXPECT_EQ(0, table.pick(UINT64_MAX));
+}
+
+// Equal weights fill every bucket with its own index, so the low bits pick the index directly.
+TEST(AliasTableTest, Unweighted) {
+  AliasTable table(std::vector<double>(8, 3));
+  for (uint64_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(i, table.pick(i));
+    EXPECT_EQ(i, table.pick((0xFFFFFFFFULL << 32) | i));
+  }
+}
+
+TEST(AliasTableTest, Weighted) {
+  const std::vector<double> weights = {1, 2, 3, 4, 10, 0.5};
+  double total_weight = 0;
+  for (const double weight : weights) {
+    total_weight += weight;
+  }
+
+  AliasTable table(weights);
+  const uint64_t steps = 1000;
+  const std::vector<uint64_t> counts = countPicks(table, steps);
+  for (uint32_t i = 0; i < weights.size(); ++i) {
+    const double expected = weights[i] / total_weight;
+    EXPECT_NEAR(expected, static_cast<double>(counts[i]) / (steps * weights.size()), 0.002);
+  }
+}
+
+TEST(AliasTableTest, ZeroWeight) {
+  AliasTable table({0, 1, 0, 1});
+  const std::vector<uint64_t> counts = countPicks(table, 1000);
+  EXPECT_EQ(0, counts[0]);
+  EXPECT_EQ(2000, counts[1]);
+  EXPECT_EQ(0, counts[2]);
+  EXPECT_EQ(2000, counts[3]);
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
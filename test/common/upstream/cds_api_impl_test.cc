@@ -10,6 +10,7 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/local_info/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
@@ -35,7 +36,7 @@ class CdsApiImplTest : public testing::Test {
 protected:
   CdsApiImplTest() : request_(&cm_.async_client_), api_(Api::createApiForTest(store_)) {}
 
-  void setup() {
+  void setup(uint32_t config_threads = 0) {
     const std::string config_json = R"EOF(
     {
       "cluster": {
@@ -55,7 +56,8 @@ protected:
     EXPECT_CALL(*mock_cluster_.info_, addedViaApi());
     EXPECT_CALL(mock_cluster_, info()).Times(AnyNumber());
     EXPECT_CALL(*mock_cluster_.info_, type());
-    cds_ = CdsApiImpl::create(cds_config, cm_, dispatcher_, random_, local_info_, store_, *api_);
+    cds_ = CdsApiImpl::create(cds_config, cm_, dispatcher_, random_, local_info_, store_, *api_,
+                              tls_, config_threads);
     resetCdsInitializedCb();
 
     expectRequest();
@@ -171,6 +173,7 @@ protected:
   NiceMock<Event::MockDispatcher> dispatcher_;
   NiceMock<Runtime::MockRandomGenerator> random_;
   NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
   Stats::IsolatedStoreImpl store_;
   Http::MockAsyncClientRequest request_;
   CdsApiPtr cds_;
@@ -252,6 +255,29 @@ TEST_F(CdsApiImplTest, ConfigUpdateWith2ValidClusters) {
   dynamic_cast<CdsApiImpl*>(cds_.get())->onConfigUpdate(clusters, "");
 }
 
+// Declared on-demand clusters that are not in the update are removed.
+TEST_F(CdsApiImplTest, ConfigUpdateRemovesDeclaredOnDemandClusters) {
+  {
+    InSequence s;
+    setup();
+  }
+
+  EXPECT_CALL(cm_, clusters()).WillOnce(Return(ClusterManager::ClusterInfoMap{}));
+  EXPECT_CALL(cm_, declaredOnDemandClusters())
+      .WillOnce(Return(std::vector<std::string>{"cluster_1", "cluster_2"}));
+  EXPECT_CALL(initialized_, ready());
+  EXPECT_CALL(request_, cancel());
+
+  Protobuf::RepeatedPtrField<envoy::api::v2::Cluster> clusters;
+  auto* cluster_1 = clusters.Add();
+  cluster_1->set_name("cluster_1");
+  cluster_1->mutable_on_demand();
+  cm_.expectAdd("cluster_1");
+  EXPECT_CALL(cm_, removeCluster("cluster_2"));
+
+  dynamic_cast<CdsApiImpl*>(cds_.get())->onConfigUpdate(clusters, "");
+}
+
 TEST_F(CdsApiImplTest, ConfigUpdateAddsSecondClusterEvenIfFirstThrows) {
   {
     InSequence s;
@@ -280,6 +306,35 @@ TEST_F(CdsApiImplTest, ConfigUpdateAddsSecondClusterEvenIfFirstThrows) {
       "Error adding/updating cluster(s) cluster_1: An exception, cluster_3: Another exception");
 }
 
+// Large updates are decoded and validated on the config threads, and then added in order.
+TEST_F(CdsApiImplTest, ConfigUpdateOnConfigThreads) {
+  {
+    InSequence s;
+    setup(4);
+  }
+
+  EXPECT_CALL(cm_, clusters()).WillOnce(Return(ClusterManager::ClusterInfoMap{}));
+  EXPECT_CALL(initialized_, ready());
+  EXPECT_CALL(request_, cancel());
+
+  Protobuf::RepeatedPtrField<envoy::api::v2::Cluster> clusters;
+  {
+    InSequence s;
+    for (uint32_t i = 0; i < 1000; i++) {
+      auto* cluster = clusters.Add();
+      // Leave one cluster without a name, which fails validation.
+      if (i != 500) {
+        cluster->set_name(fmt::format("cluster_{}", i));
+        cm_.expectAdd(cluster->name());
+      }
+    }
+  }
+
+  EXPECT_THROW_WITH_REGEX(
+      dynamic_cast<CdsApiImpl*>(cds_.get())->onConfigUpdate(clusters, ""), EnvoyException,
+      "Error adding/updating cluster\\(s\\) : Proto constraint validation failed");
+}
+
 TEST_F(CdsApiImplTest, InvalidOptions) {
   const std::string config_json = R"EOF(
   {
@@ -294,9 +349,9 @@ TEST_F(CdsApiImplTest, InvalidOptions) {
   local_info_.node_.set_id("");
   envoy::api::v2::core::ConfigSource cds_config;
   Config::Utility::translateCdsConfig(*config, cds_config);
-  EXPECT_THROW(
-      CdsApiImpl::create(cds_config, cm_, dispatcher_, random_, local_info_, store_, *api_),
-      EnvoyException);
+  EXPECT_THROW(CdsApiImpl::create(cds_config, cm_, dispatcher_, random_, local_info_, store_, *api_,
+                                  tls_, 0),
+               EnvoyException);
 }
 
 TEST_F(CdsApiImplTest, Basic) {
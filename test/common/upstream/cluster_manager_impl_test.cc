@@ -88,7 +88,8 @@ public:
     return clusterFromProto_(cluster, cm, outlier_event_logger, added_via_api);
   }
 
-  CdsApiPtr createCds(const envoy::api::v2::core::ConfigSource&, ClusterManager&) override {
+  CdsApiPtr createCds(const envoy::api::v2::core::ConfigSource&, uint32_t,
+                      ClusterManager&) override {
     return CdsApiPtr{createCds_()};
   }
 
@@ -1224,6 +1225,119 @@ TEST_F(ClusterManagerImplTest, DynamicAddRemove) {
   EXPECT_TRUE(Mock::VerifyAndClearExpectations(callbacks.get()));
 }
 
+// On-demand clusters are only declared until they are requested, and are evicted again once they
+// were idle for an idle_timeout.
+TEST_F(ClusterManagerImplTest, OnDemandCluster) {
+  create(parseBootstrapFromV2Yaml("{}"));
+  auto cluster = defaultStaticCluster("fake_cluster");
+  cluster.mutable_on_demand()->mutable_idle_timeout()->set_seconds(60);
+
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _)).Times(0);
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(cluster, "version1", dummyWarmingCb));
+  EXPECT_FALSE(cluster_manager_->addOrUpdateCluster(cluster, "version1", dummyWarmingCb));
+  EXPECT_EQ(nullptr, cluster_manager_->get("fake_cluster"));
+  EXPECT_EQ(std::vector<std::string>({"fake_cluster"}),
+            cluster_manager_->declaredOnDemandClusters());
+  EXPECT_EQ(1, factory_.stats_.gauge("cluster_manager.declared_on_demand_clusters").value());
+  EXPECT_EQ(nullptr, cluster_manager_->requestOnDemandCluster("foo", factory_.tls_.dispatcher_,
+                                                              [](bool) -> void {}));
+
+  // The first request instantiates the cluster, and its callback runs once the cluster warmed.
+  std::shared_ptr<MockClusterMockPrioritySet> cluster1(new NiceMock<MockClusterMockPrioritySet>());
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _)).WillOnce(Return(cluster1));
+  EXPECT_CALL(*cluster1, initialize(_));
+  Event::MockTimer* idle_timer = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(60000)));
+  ReadyWatcher available;
+  OnDemandClusterHandlePtr handle = cluster_manager_->requestOnDemandCluster(
+      "fake_cluster", factory_.tls_.dispatcher_, [&available](bool is_available) -> void {
+        EXPECT_TRUE(is_available);
+        available.ready();
+      });
+  EXPECT_NE(nullptr, handle);
+  EXPECT_EQ(1UL, factory_.stats_.counter("cluster_manager.cluster_on_demand_instantiated").value());
+  EXPECT_EQ(0, factory_.stats_.gauge("cluster_manager.declared_on_demand_clusters").value());
+  EXPECT_TRUE(cluster_manager_->declaredOnDemandClusters().empty());
+  EXPECT_EQ(nullptr, cluster_manager_->get("fake_cluster"));
+
+  EXPECT_CALL(available, ready());
+  cluster1->initialize_callback_();
+  EXPECT_EQ(cluster1->info_, cluster_manager_->get("fake_cluster")->info());
+
+  // The cluster is kept while it serves requests.
+  cluster1->info_->stats_.upstream_rq_total_.inc();
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(60000)));
+  idle_timer->invokeCallback();
+  EXPECT_NE(nullptr, cluster_manager_->get("fake_cluster"));
+
+  // And evicted once it was idle for an idle_timeout.
+  EXPECT_CALL(*idle_timer, enableTimer(_)).Times(0);
+  idle_timer->invokeCallback();
+  EXPECT_EQ(nullptr, cluster_manager_->get("fake_cluster"));
+  EXPECT_EQ(1UL, factory_.stats_.counter("cluster_manager.cluster_on_demand_evicted").value());
+  EXPECT_EQ(1, factory_.stats_.gauge("cluster_manager.declared_on_demand_clusters").value());
+  EXPECT_EQ(std::vector<std::string>({"fake_cluster"}),
+            cluster_manager_->declaredOnDemandClusters());
+
+  // Removing the declaration removes the cluster.
+  EXPECT_TRUE(cluster_manager_->removeCluster("fake_cluster"));
+  EXPECT_EQ(0, factory_.stats_.gauge("cluster_manager.declared_on_demand_clusters").value());
+  EXPECT_TRUE(cluster_manager_->declaredOnDemandClusters().empty());
+  EXPECT_EQ(nullptr, cluster_manager_->requestOnDemandCluster(
+                         "fake_cluster", factory_.tls_.dispatcher_, [](bool) -> void {}));
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
+}
+
+// Requests that are waiting for an on-demand cluster fail when the cluster is removed while it
+// warms, and cancelled requests are not called back.
+TEST_F(ClusterManagerImplTest, OnDemandClusterRemovedWhileWarming) {
+  create(parseBootstrapFromV2Yaml("{}"));
+  auto cluster = defaultStaticCluster("fake_cluster");
+  cluster.mutable_on_demand();
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(cluster, "version1", dummyWarmingCb));
+
+  std::shared_ptr<MockClusterMockPrioritySet> cluster1(new NiceMock<MockClusterMockPrioritySet>());
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _)).WillOnce(Return(cluster1));
+  EXPECT_CALL(*cluster1, initialize(_));
+  ReadyWatcher unavailable;
+  OnDemandClusterHandlePtr first = cluster_manager_->requestOnDemandCluster(
+      "fake_cluster", factory_.tls_.dispatcher_, [&unavailable](bool is_available) -> void {
+        EXPECT_FALSE(is_available);
+        unavailable.ready();
+      });
+  OnDemandClusterHandlePtr second = cluster_manager_->requestOnDemandCluster(
+      "fake_cluster", factory_.tls_.dispatcher_,
+      [](bool) -> void { FAIL() << "cancelled request was called back"; });
+  EXPECT_EQ(1UL, factory_.stats_.counter("cluster_manager.cluster_on_demand_instantiated").value());
+  second.reset();
+
+  EXPECT_CALL(unavailable, ready());
+  EXPECT_TRUE(cluster_manager_->removeCluster("fake_cluster"));
+  EXPECT_EQ(0, cluster_manager_->warmingClusterCount());
+  EXPECT_TRUE(cluster_manager_->declaredOnDemandClusters().empty());
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
+}
+
+TEST_F(ClusterManagerImplTest, OnDemandStaticCluster) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: fake_cluster
+      connect_timeout: 0.250s
+      on_demand: {}
+      hosts:
+      - socket_address:
+          address: 127.0.0.1
+          port_value: 11001
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(create(parseBootstrapFromV2Yaml(yaml)), EnvoyException,
+                            "cluster manager: on_demand is not supported for static cluster "
+                            "'fake_cluster'");
+}
+
 TEST_F(ClusterManagerImplTest, addOrUpdateClusterStaticExists) {
   const std::string json =
       fmt::sprintf("{%s}", clustersJson({defaultStaticClusterJson("some_cluster")}));
@@ -1593,6 +1707,22 @@ TEST_F(ClusterManagerImplTest, DynamicHostRemove) {
 
   dns_callback(TestUtility::makeDnsResponse({"127.0.0.1", "127.0.0.2"}));
 
+  // The thread local host set shares the primary host set's immutable vectors rather than copies.
+  {
+    const auto& host_set =
+        cluster_manager_->clusters().at("cluster_1").get().prioritySet().hostSetsPerPriority()[0];
+    const auto& tls_host_set =
+        cluster_manager_->get("cluster_1")->prioritySet().hostSetsPerPriority()[0];
+    EXPECT_EQ(2UL, tls_host_set->hosts().size());
+    EXPECT_EQ(host_set->hostsPtr(), tls_host_set->hostsPtr());
+    EXPECT_EQ(host_set->healthyHostsPtr(), tls_host_set->healthyHostsPtr());
+    EXPECT_EQ(host_set->degradedHostsPtr(), tls_host_set->degradedHostsPtr());
+    EXPECT_EQ(host_set->hostsPerLocalityPtr(), tls_host_set->hostsPerLocalityPtr());
+    EXPECT_EQ(host_set->healthyHostsPerLocalityPtr(), tls_host_set->healthyHostsPerLocalityPtr());
+    EXPECT_EQ(host_set->degradedHostsPerLocalityPtr(),
+              tls_host_set->degradedHostsPerLocalityPtr());
+  }
+
   // After we are initialized, we should immediately get called back if someone asks for an
   // initialize callback.
   EXPECT_CALL(initialized, ready());
@@ -1981,6 +2111,49 @@ TEST_F(ClusterManagerImplTest, DynamicHostRemoveDefaultPriority) {
   factory_.tls_.shutdownThread();
 }
 
+// Verify that hosts added to a cluster with prefetch_on_host_add get a warm connection pool,
+// which is then reused for requests.
+TEST_F(ClusterManagerImplTest, DynamicHostAddPrefetch) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      type: STRICT_DNS
+      dns_resolvers:
+      - socket_address:
+          address: 1.2.3.4
+          port_value: 80
+      lb_policy: ROUND_ROBIN
+      hosts:
+      - socket_address:
+          address: localhost
+          port_value: 11001
+      prefetch_policy:
+        prefetch_on_host_add: true
+  )EOF";
+
+  std::shared_ptr<Network::MockDnsResolver> dns_resolver(new Network::MockDnsResolver());
+  EXPECT_CALL(factory_.dispatcher_, createDnsResolver(_)).WillOnce(Return(dns_resolver));
+
+  Network::DnsResolver::ResolveCb dns_callback;
+  new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  Network::MockActiveDnsQuery active_dns_query;
+  EXPECT_CALL(*dns_resolver, resolve(_, _, _))
+      .WillRepeatedly(DoAll(SaveArg<2>(&dns_callback), Return(&active_dns_query)));
+  create(parseBootstrapFromV2Yaml(yaml));
+
+  Http::ConnectionPool::MockInstance* cp = new Http::ConnectionPool::MockInstance();
+  EXPECT_CALL(factory_, allocateConnPool_(_)).WillOnce(Return(cp));
+  EXPECT_CALL(*cp, prefetchConnection());
+  dns_callback(TestUtility::makeDnsResponse({"127.0.0.2"}));
+
+  EXPECT_EQ(cp, cluster_manager_->httpConnPoolForCluster("cluster_1", ResourcePriority::Default,
+                                                         Http::Protocol::Http11, nullptr));
+
+  factory_.tls_.shutdownThread();
+}
+
 class MockConnPoolWithDestroy : public Http::ConnectionPool::MockInstance {
 public:
   ~MockConnPoolWithDestroy() { onDestroy(); }
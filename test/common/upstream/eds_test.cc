@@ -10,6 +10,7 @@
 #include "server/transport_socket_config_impl.h"
 
 #include "test/common/upstream/utility.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
@@ -222,6 +223,132 @@ TEST_F(EdsTest, OnConfigUpdateSuccess) {
   EXPECT_EQ(1UL, stats_.counter("cluster.name.update_no_rebuild").value());
 }
 
+// Validate that resending an unchanged assignment does not rebuild the hosts.
+TEST_F(EdsTest, OnConfigUpdateUnchanged) {
+  Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources;
+  auto* cluster_load_assignment = resources.Add();
+  cluster_load_assignment->set_cluster_name("fare");
+  auto* endpoints = cluster_load_assignment->add_endpoints();
+  endpoints->set_priority(1);
+  auto* socket_address = endpoints->add_lb_endpoints()
+                             ->mutable_endpoint()
+                             ->mutable_address()
+                             ->mutable_socket_address();
+  socket_address->set_address("1.2.3.4");
+  socket_address->set_port_value(80);
+
+  // The local cluster name is only consulted while building the hosts of a non-zero priority.
+  const std::string local_cluster_name = "local";
+  EXPECT_CALL(cm_, localClusterName()).WillOnce(ReturnRef(local_cluster_name));
+  bool initialized = false;
+  cluster_->initialize([&initialized] { initialized = true; });
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources, ""));
+  EXPECT_TRUE(initialized);
+  EXPECT_EQ(0UL, stats_.counter("cluster.name.update_no_rebuild").value());
+  EXPECT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[1]->hosts().size());
+
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources, ""));
+  EXPECT_EQ(1UL, stats_.counter("cluster.name.update_no_rebuild").value());
+  EXPECT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[1]->hosts().size());
+}
+
+// Validate that a delta update applies the assignment it adds and that removing it keeps the
+// previous assignment.
+TEST_F(EdsTest, OnDeltaConfigUpdate) {
+  envoy::api::v2::ClusterLoadAssignment cluster_load_assignment;
+  cluster_load_assignment.set_cluster_name("fare");
+  auto* socket_address = cluster_load_assignment.add_endpoints()
+                             ->add_lb_endpoints()
+                             ->mutable_endpoint()
+                             ->mutable_address()
+                             ->mutable_socket_address();
+  socket_address->set_address("1.2.3.4");
+  socket_address->set_port_value(80);
+
+  Protobuf::RepeatedPtrField<envoy::api::v2::Resource> added_resources;
+  auto* resource = added_resources.Add();
+  resource->set_name("fare");
+  resource->set_version("1");
+  resource->mutable_resource()->PackFrom(cluster_load_assignment);
+
+  bool initialized = false;
+  cluster_->initialize([&initialized] { initialized = true; });
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(added_resources, {}, "1"));
+  EXPECT_TRUE(initialized);
+  EXPECT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+
+  Protobuf::RepeatedPtrField<std::string> removed_resources;
+  *removed_resources.Add() = "fare";
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate({}, removed_resources, "2"));
+  EXPECT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+}
+
+// Validate that assignments arriving within the debounce window are coalesced.
+TEST_F(EdsTest, OnConfigUpdateDebounced) {
+  auto* debounce_timer = new Event::MockTimer(&dispatcher_);
+  resetCluster(R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: EDS
+      lb_policy: ROUND_ROBIN
+      eds_cluster_config:
+        service_name: fare
+        update_debounce_window: 1s
+        eds_config:
+          api_config_source:
+            api_type: REST
+            cluster_names:
+            - eds
+            refresh_delay: 1s
+    )EOF");
+
+  Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources;
+  auto* cluster_load_assignment = resources.Add();
+  cluster_load_assignment->set_cluster_name("fare");
+  auto* endpoints = cluster_load_assignment->add_endpoints();
+  uint32_t port = 1000;
+  auto add_endpoint = [endpoints, &port]() {
+    auto* socket_address = endpoints->add_lb_endpoints()
+                               ->mutable_endpoint()
+                               ->mutable_address()
+                               ->mutable_socket_address();
+    socket_address->set_address("1.2.3.4");
+    socket_address->set_port_value(port++);
+  };
+  auto hosts_size = [this]() {
+    return cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size();
+  };
+
+  // The first assignment applies immediately.
+  add_endpoint();
+  bool initialized = false;
+  cluster_->initialize([&initialized] { initialized = true; });
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources, ""));
+  EXPECT_TRUE(initialized);
+  EXPECT_EQ(1UL, hosts_size());
+
+  // Later assignments wait for the window to expire.
+  EXPECT_CALL(*debounce_timer, enableTimer(std::chrono::milliseconds(1000)));
+  add_endpoint();
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources, ""));
+  add_endpoint();
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources, ""));
+  EXPECT_EQ(1UL, hosts_size());
+  EXPECT_EQ(1UL, stats_.counter("cluster.name.update_coalesced").value());
+
+  // Only the latest assignment is applied.
+  debounce_timer->invokeCallback();
+  EXPECT_EQ(3UL, hosts_size());
+
+  // The next assignment starts a new window.
+  EXPECT_CALL(*debounce_timer, enableTimer(std::chrono::milliseconds(1000)));
+  add_endpoint();
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources, ""));
+  debounce_timer->invokeCallback();
+  EXPECT_EQ(4UL, hosts_size());
+  EXPECT_EQ(1UL, stats_.counter("cluster.name.update_coalesced").value());
+}
+
 // Validate that onConfigUpdate() with no service name accepts config.
 TEST_F(EdsTest, NoServiceNameOnSuccessConfigUpdate) {
   resetCluster(R"EOF(
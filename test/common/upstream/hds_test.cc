@@ -219,6 +219,48 @@ TEST_F(HdsTest, TestProcessMessageHealthChecks) {
   EXPECT_EQ(hds_delegate_->hdsClusters()[1]->healthCheckers().size(), 3);
 }
 
+// Test that the clusters whose config is unchanged are kept across HealthCheckSpecifier messages,
+// along with their health checkers, and that the changed ones are rebuilt.
+TEST_F(HdsTest, TestProcessMessageKeepsUnchangedClusters) {
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  EXPECT_CALL(async_stream_, sendMessage(_, _));
+  createHdsDelegate();
+
+  auto create_message = [](uint32_t interval_seconds) {
+    auto message = std::make_unique<envoy::service::discovery::v2::HealthCheckSpecifier>();
+    message->mutable_interval()->set_seconds(1);
+    for (int i = 0; i < 2; i++) {
+      auto* health_check = message->add_cluster_health_checks();
+      health_check->set_cluster_name("minkowski" + std::to_string(i));
+      auto hc = health_check->add_health_checks();
+      hc->mutable_timeout()->set_seconds(1);
+      hc->mutable_interval()->set_seconds(i == 0 ? 1 : interval_seconds);
+      hc->mutable_unhealthy_threshold()->set_value(1);
+      hc->mutable_healthy_threshold()->set_value(1);
+      hc->mutable_http_health_check()->set_path("/healthcheck");
+    }
+    return message;
+  };
+
+  EXPECT_CALL(test_factory_, createClusterInfo(_)).Times(2).WillRepeatedly(Return(cluster_info_));
+  hds_delegate_friend_.processPrivateMessage(*hds_delegate_, create_message(1));
+  const std::vector<HdsClusterPtr> first_clusters = hds_delegate_->hdsClusters();
+  ASSERT_EQ(2, first_clusters.size());
+
+  // The same specifier keeps both clusters.
+  EXPECT_CALL(test_factory_, createClusterInfo(_)).Times(0);
+  hds_delegate_friend_.processPrivateMessage(*hds_delegate_, create_message(1));
+  EXPECT_EQ(first_clusters, hds_delegate_->hdsClusters());
+
+  // Changing the health check of the second cluster only rebuilds that one.
+  EXPECT_CALL(test_factory_, createClusterInfo(_)).WillOnce(Return(cluster_info_));
+  hds_delegate_friend_.processPrivateMessage(*hds_delegate_, create_message(2));
+  ASSERT_EQ(2, hds_delegate_->hdsClusters().size());
+  EXPECT_EQ(first_clusters[0], hds_delegate_->hdsClusters()[0]);
+  EXPECT_NE(first_clusters[1], hds_delegate_->hdsClusters()[1]);
+  EXPECT_EQ(1, hds_delegate_->hdsClusters()[1]->healthCheckers().size());
+}
+
 // Tests OnReceiveMessage given a minimal HealthCheckSpecifier message
 TEST_F(HdsTest, TestMinimalOnReceiveMessage) {
   EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
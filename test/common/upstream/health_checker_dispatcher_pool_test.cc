@@ -0,0 +1,46 @@
+#include <set>
+
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/upstream/health_checker_dispatcher_pool.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+TEST(HealthCheckerDispatcherPoolImplTest, RunsPostsOnEveryThread) {
+  Api::ApiPtr api = Api::createApiForTest();
+  HealthCheckerDispatcherPoolImpl pool(*api, 3);
+
+  // The dispatchers are handed out round robin.
+  std::set<Event::Dispatcher*> dispatchers;
+  for (uint32_t i = 0; i < 3; i++) {
+    dispatchers.insert(&pool.nextDispatcher());
+  }
+  EXPECT_EQ(3, dispatchers.size());
+  EXPECT_EQ(1, dispatchers.count(&pool.nextDispatcher()));
+
+  Thread::MutexBasicLockable lock;
+  Thread::CondVar ran;
+  uint32_t remaining = dispatchers.size();
+  for (Event::Dispatcher* dispatcher : dispatchers) {
+    dispatcher->post([&lock, &ran, &remaining]() -> void {
+      Thread::LockGuard guard(lock);
+      remaining--;
+      ran.notifyOne();
+    });
+  }
+
+  Thread::LockGuard guard(lock);
+  while (remaining > 0) {
+    ran.wait(lock);
+  }
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
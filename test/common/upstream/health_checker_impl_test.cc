@@ -65,7 +65,8 @@ TEST(HealthCheckerFactoryTest, GrpcHealthCheckHTTP2NotConfiguredException) {
   AccessLog::MockAccessLogManager log_manager;
 
   EXPECT_THROW_WITH_MESSAGE(HealthCheckerFactory::create(createGrpcHealthCheckConfig(), cluster,
-                                                         runtime, random, dispatcher, log_manager),
+                                                         runtime, random, dispatcher, log_manager,
+                                                         nullptr),
                             EnvoyException,
                             "fake_cluster cluster must support HTTP/2 for gRPC healthchecking");
 }
@@ -83,7 +84,8 @@ TEST(HealthCheckerFactoryTest, createGrpc) {
 
   EXPECT_NE(nullptr, dynamic_cast<GrpcHealthCheckerImpl*>(
                          HealthCheckerFactory::create(createGrpcHealthCheckConfig(), cluster,
-                                                      runtime, random, dispatcher, log_manager)
+                                                      runtime, random, dispatcher, log_manager,
+                                                      nullptr)
                              .get()));
 }
 
@@ -2229,6 +2231,127 @@ TEST_F(TcpHealthCheckerImplTest, Success) {
   read_filter_->onData(response, false);
 }
 
+// Tests that the timers of all sessions share the dispatcher timer of the timer wheel.
+TEST_F(TcpHealthCheckerImplTest, TimerWheel) {
+  Event::SimulatedTimeSystem time_system;
+  const std::string yaml = R"EOF(
+    timeout: 1s
+    interval: 1s
+    unhealthy_threshold: 1
+    healthy_threshold: 1
+    timer_wheel_resolution: 0.1s
+    tcp_health_check:
+      send:
+        text: "01"
+      receive:
+      - text: "02"
+    )EOF";
+
+  // The tick timer of the wheel is the only dispatcher timer.
+  auto* tick_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  health_checker_.reset(new TcpHealthCheckerImpl(*cluster_, parseHealthCheckFromV2Yaml(yaml),
+                                                 dispatcher_, runtime_, random_,
+                                                 HealthCheckEventLoggerPtr(event_logger_)));
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:80"),
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:81")};
+  auto* connection_1 = new NiceMock<Network::MockClientConnection>();
+  auto* connection_2 = new NiceMock<Network::MockClientConnection>();
+  EXPECT_CALL(dispatcher_, createClientConnection_(_, _, _, _))
+      .WillOnce(Return(connection_1))
+      .WillOnce(Return(connection_2));
+  health_checker_->start();
+  EXPECT_TRUE(tick_timer->enabled_);
+
+  // Both checks time out in the same tick.
+  EXPECT_CALL(*event_logger_, logEjectUnhealthy(_, _, _)).Times(2);
+  EXPECT_CALL(*event_logger_, logUnhealthy(_, _, _, true)).Times(2);
+  time_system.sleep(std::chrono::milliseconds(1000));
+  tick_timer->invokeCallback();
+  EXPECT_EQ(2UL, cluster_->info_->stats_store_.counter("health_check.network_failure").value());
+
+  // The next intervals keep the tick timer armed.
+  EXPECT_TRUE(tick_timer->enabled_);
+}
+
+class TestHealthCheckerDispatcherPool : public HealthCheckerDispatcherPool {
+public:
+  // Upstream::HealthCheckerDispatcherPool
+  Event::Dispatcher& nextDispatcher() override { return dispatcher_; }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+};
+
+// Tests that sessions on a dispatcher pool run on the pool's dispatcher, and that their results
+// reach the main thread in batches.
+TEST_F(TcpHealthCheckerImplTest, DispatcherPool) {
+  auto pool = std::make_shared<TestHealthCheckerDispatcherPool>();
+  setupData();
+  HealthCheckerSharedPtr health_checker =
+      HealthCheckerImplBase::runOnDispatcherPool(std::move(health_checker_), pool);
+
+  std::vector<HealthTransition> results;
+  health_checker->addHostCheckCompleteCb(
+      [&results](HostSharedPtr, HealthTransition changed_state) -> void {
+        results.push_back(changed_state);
+      });
+  std::vector<Event::PostCb> main_thread_posts;
+  ON_CALL(dispatcher_, post(_)).WillByDefault(Invoke([&main_thread_posts](Event::PostCb cb) {
+    main_thread_posts.push_back(cb);
+  }));
+  auto run_main_thread_posts = [&main_thread_posts]() -> void {
+    std::vector<Event::PostCb> posts;
+    posts.swap(main_thread_posts);
+    for (const Event::PostCb& cb : posts) {
+      cb();
+    }
+  };
+
+  Event::MockTimer* interval_timer;
+  Event::MockTimer* timeout_timer;
+  {
+    InSequence s;
+    interval_timer = new NiceMock<Event::MockTimer>(&pool->dispatcher_);
+    timeout_timer = new NiceMock<Event::MockTimer>(&pool->dispatcher_);
+  }
+  EXPECT_CALL(pool->dispatcher_, createClientConnection_(_, _, _, _))
+      .WillOnce(Return(new NiceMock<Network::MockClientConnection>()))
+      .WillOnce(Return(new NiceMock<Network::MockClientConnection>()));
+  EXPECT_CALL(dispatcher_, createTimer_(_)).Times(0);
+  EXPECT_CALL(dispatcher_, createClientConnection_(_, _, _, _)).Times(0);
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  health_checker->start();
+  EXPECT_TRUE(timeout_timer->enabled_);
+
+  // The first failure only queues a result behind the flush posted for the new session.
+  EXPECT_CALL(*event_logger_, logUnhealthy(_, _, _, true));
+  timeout_timer->invokeCallback();
+  EXPECT_TRUE(results.empty());
+  EXPECT_EQ(1, main_thread_posts.size());
+  run_main_thread_posts();
+  EXPECT_EQ(std::vector<HealthTransition>({HealthTransition::ChangePending}), results);
+  EXPECT_EQ(1UL, cluster_->info_->stats_store_.gauge("health_check.healthy").value());
+
+  // The second one ejects the host.
+  EXPECT_CALL(*event_logger_, logEjectUnhealthy(_, _, _));
+  interval_timer->invokeCallback();
+  timeout_timer->invokeCallback();
+  EXPECT_TRUE(cluster_->prioritySet().getMockHostSet(0)->hosts_[0]->healthFlagGet(
+      Host::HealthFlag::FAILED_ACTIVE_HC));
+  EXPECT_EQ(1, main_thread_posts.size());
+  run_main_thread_posts();
+  EXPECT_EQ(std::vector<HealthTransition>(
+                {HealthTransition::ChangePending, HealthTransition::Changed}),
+            results);
+  EXPECT_EQ(0UL, cluster_->info_->stats_store_.gauge("health_check.healthy").value());
+
+  // Releasing the health checker destroys the session on the pool's dispatcher.
+  health_checker.reset();
+  run_main_thread_posts();
+  EXPECT_EQ(2, results.size());
+}
+
 // Tests that a successful healthcheck will disconnect the client when reuse_connection is false.
 TEST_F(TcpHealthCheckerImplTest, DataWithoutReusingConnection) {
   InSequence s;
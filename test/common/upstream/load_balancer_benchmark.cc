@@ -9,6 +9,7 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 #include "benchmark/benchmark.h"
 
@@ -38,6 +39,7 @@ public:
   ClusterStats stats_{ClusterInfoImpl::generateStats(stats_store_)};
   NiceMock<Runtime::MockLoader> runtime_;
   Runtime::RandomGeneratorImpl random_;
+  Event::SimulatedTimeSystem time_system_;
   envoy::api::v2::Cluster::CommonLbConfig common_config_;
   std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
 };
@@ -48,7 +50,8 @@ public:
     config_ = envoy::api::v2::Cluster::RingHashLbConfig();
     config_.value().mutable_minimum_ring_size()->set_value(min_ring_size);
     ring_hash_lb_ = std::make_unique<RingHashLoadBalancer>(
-        priority_set_, stats_, stats_store_, runtime_, random_, config_, common_config_);
+        priority_set_, stats_, stats_store_, runtime_, random_, time_system_, config_,
+        common_config_);
   }
 
   absl::optional<envoy::api::v2::Cluster::RingHashLbConfig> config_;
@@ -60,7 +63,7 @@ public:
   MaglevTester(uint64_t num_hosts, uint32_t weighted_subset_percent = 0, uint32_t weight = 0)
       : BaseTester(num_hosts, weighted_subset_percent, weight) {
     maglev_lb_ = std::make_unique<MaglevLoadBalancer>(priority_set_, stats_, stats_store_, runtime_,
-                                                      random_, common_config_);
+                                                      random_, time_system_, common_config_);
   }
 
   std::unique_ptr<MaglevLoadBalancer> maglev_lb_;
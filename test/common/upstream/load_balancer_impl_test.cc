@@ -1155,6 +1155,52 @@ TEST_P(RoundRobinLoadBalancerTest, NoZoneAwareRoutingNoLocalLocality) {
 INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, RoundRobinLoadBalancerTest,
                          ::testing::Values(true, false));
 
+// The load balancers of the workers see the same host vectors, so the first one to regenerate its
+// locality routing structures on an update computes them for all of them.
+TEST(LocalityRoutingCacheTest, SharedBetweenLoadBalancers) {
+  Stats::IsolatedStoreImpl stats_store;
+  ClusterStats stats = ClusterInfoImpl::generateStats(stats_store);
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Runtime::MockRandomGenerator> random;
+  std::shared_ptr<MockClusterInfo> info{new NiceMock<MockClusterInfo>()};
+  envoy::api::v2::Cluster::CommonLbConfig common_config;
+  common_config.mutable_zone_aware_lb_config()->mutable_min_cluster_size()->set_value(1);
+  ON_CALL(runtime.snapshot_, featureEnabled("upstream.zone_routing.enabled", 100))
+      .WillByDefault(Return(true));
+
+  PrioritySetImpl priority_set;
+  priority_set.getOrCreateHostSet(0);
+  PrioritySetImpl local_priority_set;
+  local_priority_set.getOrCreateHostSet(0);
+  const LocalityRoutingCacheSharedPtr cache = std::make_shared<LocalityRoutingCache>();
+  RoundRobinLoadBalancer lb1(priority_set, &local_priority_set, stats, runtime, random,
+                             common_config, cache);
+  RoundRobinLoadBalancer lb2(priority_set, &local_priority_set, stats, runtime, random,
+                             common_config, cache);
+
+  HostVectorSharedPtr hosts;
+  auto update = [&](PrioritySetImpl& update_priority_set) {
+    hosts = std::make_shared<HostVector>(HostVector(
+        {makeTestHost(info, "tcp://127.0.0.1:80"), makeTestHost(info, "tcp://127.0.0.1:81")}));
+    HostsPerLocalitySharedPtr hosts_per_locality =
+        makeHostsPerLocality({{(*hosts)[0]}, {(*hosts)[1]}});
+    update_priority_set.updateHosts(
+        0, HostSetImpl::updateHostsParams(hosts, hosts_per_locality, hosts, hosts_per_locality),
+        {}, {}, {}, absl::nullopt);
+  };
+
+  update(local_priority_set);
+  EXPECT_EQ(1U, stats.lb_recalculate_zone_structures_.value());
+  update(priority_set);
+  EXPECT_EQ(2U, stats.lb_recalculate_zone_structures_.value());
+
+  // Both load balancers route directly to the local locality, which has as large a share of the
+  // upstream hosts as of the local ones.
+  EXPECT_EQ((*hosts)[0], lb1.chooseHost(nullptr));
+  EXPECT_EQ((*hosts)[0], lb2.chooseHost(nullptr));
+  EXPECT_EQ(2U, stats.lb_zone_routing_all_directly_.value());
+}
+
 class LeastRequestLoadBalancerTest : public LoadBalancerTestBase {
 public:
   LeastRequestLoadBalancer lb_{
@@ -1177,7 +1223,7 @@ TEST_P(LeastRequestLoadBalancerTest, SingleHost) {
 
   // Host weight is 100.
   {
-    EXPECT_CALL(random_, random()).WillOnce(Return(0));
+    EXPECT_CALL(random_, random()).Times(3).WillRepeatedly(Return(0));
     stats_.max_host_weight_.set(100UL);
     EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
   }
@@ -1185,7 +1231,7 @@ TEST_P(LeastRequestLoadBalancerTest, SingleHost) {
   HostVector empty;
   {
     hostSet().runCallbacks(empty, empty);
-    EXPECT_CALL(random_, random()).WillOnce(Return(0));
+    EXPECT_CALL(random_, random()).Times(3).WillRepeatedly(Return(0));
     EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
   }
 
@@ -1274,37 +1320,50 @@ TEST_P(LeastRequestLoadBalancerTest, WeightImbalance) {
   hostSet().hosts_ = hostSet().healthy_hosts_;
   hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
 
-  EXPECT_CALL(random_, random()).WillRepeatedly(Return(0));
+  // The low 32 bits of a random number pick a bucket of the alias table and the high 32 bits pick
+  // between the bucket and its alias. The bucket of hosts[0] has hosts[1] as its alias and keeps
+  // 2/3 of its probability; hosts[1] fills its own bucket.
+  const uint64_t sample_host0 = 0;
+  const uint64_t sample_host0_alias = 0xFFFFFFFFULL << 32;
+  const uint64_t sample_host1 = 1;
 
-  // We should see 2:1 ratio for hosts[1] to hosts[0].
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+  // With no active requests, the first sample is chosen. The first random number chooses the
+  // priority.
+  EXPECT_CALL(random_, random())
+      .WillOnce(Return(0))
+      .WillOnce(Return(sample_host0))
+      .WillOnce(Return(sample_host1));
   EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+  EXPECT_CALL(random_, random())
+      .WillOnce(Return(0))
+      .WillOnce(Return(sample_host0_alias))
+      .WillOnce(Return(sample_host0));
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
 
-  // Bringing hosts[1] to an active request should yield a 1:1 ratio.
+  // With one active request each, hosts[1] is less loaded relative to its weight.
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(1);
   hostSet().healthy_hosts_[1]->stats().rq_active_.set(1);
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+  EXPECT_CALL(random_, random())
+      .WillOnce(Return(0))
+      .WillOnce(Return(sample_host0))
+      .WillOnce(Return(sample_host1));
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
 
-  // Settings hosts[0] to an active request and hosts[1] to no active requests should yield a 4:1
-  // ratio.
-  hostSet().healthy_hosts_[0]->stats().rq_active_.set(1);
-  hostSet().healthy_hosts_[1]->stats().rq_active_.set(0);
-  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+  // Two active requests on hosts[1] is the same load as one on hosts[0], so the first sample is
+  // kept.
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(2);
+  EXPECT_CALL(random_, random())
+      .WillOnce(Return(0))
+      .WillOnce(Return(sample_host0))
+      .WillOnce(Return(sample_host1));
   EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // Three active requests on hosts[1] is more load than one on hosts[0].
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(3);
+  EXPECT_CALL(random_, random())
+      .WillOnce(Return(0))
+      .WillOnce(Return(sample_host1))
+      .WillOnce(Return(sample_host0));
   EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
 }
 
@@ -1316,10 +1375,9 @@ TEST_P(LeastRequestLoadBalancerTest, WeightImbalanceCallbacks) {
   hostSet().hosts_ = hostSet().healthy_hosts_;
   hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
 
-  EXPECT_CALL(random_, random()).WillRepeatedly(Return(0));
-
+  // Every sample picks the bucket of hosts[1].
+  EXPECT_CALL(random_, random()).WillRepeatedly(Return(1));
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
-  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
 
   // Remove and verify we get other host.
   HostVector empty;
@@ -1352,6 +1410,34 @@ TEST_P(RandomLoadBalancerTest, Normal) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
 }
 
+TEST_P(RandomLoadBalancerTest, Weighted) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 3)};
+  stats_.max_host_weight_.set(3UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  // The low 32 bits of a random number pick a bucket of the alias table and the high 32 bits pick
+  // between the bucket and its alias. The bucket of hosts[0] keeps half of its probability and
+  // has hosts[1] as its alias, so hosts[1] is picked 3/4 of the time.
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0x7FFFFFFFULL << 32));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0x80000000ULL << 32));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // The table is rebuilt when hosts are removed.
+  HostVector hosts_removed{hostSet().hosts_[1]};
+  hostSet().hosts_.erase(hostSet().hosts_.begin() + 1);
+  hostSet().healthy_hosts_.erase(hostSet().healthy_hosts_.begin() + 1);
+  hostSet().runCallbacks({}, hosts_removed);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+}
+
 INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, RandomLoadBalancerTest, ::testing::Values(true, false));
 
 TEST(LoadBalancerSubsetInfoImplTest, DefaultConfigIsDiabled) {
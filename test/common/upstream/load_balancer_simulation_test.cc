@@ -114,6 +114,9 @@ public:
   void run(std::vector<uint32_t> originating_cluster, std::vector<uint32_t> all_destination_cluster,
            std::vector<uint32_t> healthy_destination_cluster) {
     local_priority_set_ = new PrioritySetImpl;
+    // The host set is changed below without running its callbacks. Only the unweighted pick reads
+    // the host set at pick time, so keep the hosts unweighted.
+    stats_.max_host_weight_.set(1UL);
     // TODO(mattklein123): make load balancer per originating cluster host.
     RandomLoadBalancer lb(priority_set_, local_priority_set_, stats_, runtime_, random_,
                           common_config_);
@@ -216,6 +216,49 @@ TEST_F(LoadStatsReporterTest, ExistingClusters) {
   response_timer_cb_();
 }
 
+// Validate that the clusters are looked up in a single copy of the cluster map per report, rather
+// than in one copy per reported cluster.
+TEST_F(LoadStatsReporterTest, ClusterMapCopiedOncePerReport) {
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage({});
+  createLoadStatsReporter();
+  NiceMock<MockClusterMockPrioritySet> foo_cluster;
+  NiceMock<MockClusterMockPrioritySet> bar_cluster;
+  MockClusterManager::ClusterInfoMap cluster_info{{"foo", foo_cluster}, {"bar", bar_cluster}};
+  EXPECT_CALL(cm_, clusters()).WillOnce(Return(cluster_info));
+  deliverLoadStatsResponse({"foo", "bar", "baz"});
+
+  foo_cluster.info_->load_report_stats_.upstream_rq_dropped_.add(1);
+  bar_cluster.info_->load_report_stats_.upstream_rq_dropped_.add(2);
+  {
+    envoy::api::v2::endpoint::ClusterStats foo_cluster_stats;
+    foo_cluster_stats.set_cluster_name("foo");
+    foo_cluster_stats.set_total_dropped_requests(1);
+    foo_cluster_stats.mutable_load_report_interval()->MergeFrom(
+        Protobuf::util::TimeUtil::MicrosecondsToDuration(0));
+    envoy::api::v2::endpoint::ClusterStats bar_cluster_stats;
+    bar_cluster_stats.set_cluster_name("bar");
+    bar_cluster_stats.set_total_dropped_requests(2);
+    bar_cluster_stats.mutable_load_report_interval()->MergeFrom(
+        Protobuf::util::TimeUtil::MicrosecondsToDuration(0));
+    EXPECT_CALL(async_stream_, sendMessage(_, false))
+        .WillOnce(Invoke([&](const Protobuf::Message& message, bool) {
+          const auto& request =
+              dynamic_cast<const envoy::service::load_stats::v2::LoadStatsRequest&>(message);
+          // The order of the clusters follows the map of the tracked clusters.
+          ASSERT_EQ(2, request.cluster_stats().size());
+          for (const auto& cluster_stats : request.cluster_stats()) {
+            EXPECT_THAT(cluster_stats, ProtoEq(cluster_stats.cluster_name() == "foo"
+                                                   ? foo_cluster_stats
+                                                   : bar_cluster_stats));
+          }
+        }));
+  }
+  EXPECT_CALL(cm_, clusters()).WillOnce(Return(cluster_info));
+  EXPECT_CALL(*response_timer_, enableTimer(std::chrono::milliseconds(42000)));
+  response_timer_cb_();
+}
+
 // Validate that the client can recover from a remote stream closure via retry.
 TEST_F(LoadStatsReporterTest, RemoteStreamClose) {
   EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
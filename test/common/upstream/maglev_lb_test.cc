@@ -4,6 +4,7 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -27,7 +28,7 @@ public:
 
   void init(uint32_t table_size) {
     lb_ = std::make_unique<MaglevLoadBalancer>(priority_set_, stats_, stats_store_, runtime_,
-                                               random_, common_config_, table_size);
+                                               random_, time_system_, common_config_, table_size);
     lb_->initialize();
   }
 
@@ -39,6 +40,7 @@ public:
   envoy::api::v2::Cluster::CommonLbConfig common_config_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Runtime::MockRandomGenerator> random_;
+  Event::SimulatedTimeSystem time_system_;
   std::unique_ptr<MaglevLoadBalancer> lb_;
 };
 
@@ -79,6 +81,37 @@ TEST_F(MaglevLoadBalancerTest, Basic) {
   }
 }
 
+// A priority update only rebuilds the tables of the priorities whose hosts or weights changed.
+TEST_F(MaglevLoadBalancerTest, UnchangedPriorityIsReused) {
+  host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90"),
+                      makeTestHost(info_, "tcp://127.0.0.1:91")};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  init(7);
+  EXPECT_EQ("maglev_lb.table_build_time_us", lb_->stats().table_build_time_us_.name());
+  EXPECT_EQ(3, lb_->stats().min_entries_per_host_.value());
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context(0);
+  const HostConstSharedPtr host = lb->chooseHost(&context);
+
+  // An update of another priority leaves the table of priority 0 alone, which would otherwise
+  // have set the gauge again.
+  stats_store_.gauge("maglev_lb.min_entries_per_host").set(0);
+  priority_set_.getMockHostSet(1)->runCallbacks({}, {});
+  EXPECT_EQ(0, lb_->stats().min_entries_per_host_.value());
+  EXPECT_EQ(host, lb_->factory()->create()->chooseHost(&context));
+
+  // So does an update that does not change the hosts or weights of priority 0.
+  stats_store_.gauge("maglev_lb.min_entries_per_host").set(0);
+  host_set_.runCallbacks({}, {});
+  EXPECT_EQ(0, lb_->stats().min_entries_per_host_.value());
+
+  // Changing the weight of a host rebuilds the table.
+  host_set_.hosts_[1]->weight(2);
+  host_set_.runCallbacks({}, {});
+  EXPECT_NE(0, lb_->stats().min_entries_per_host_.value());
+}
+
 // Weighted sanity test.
 TEST_F(MaglevLoadBalancerTest, Weighted) {
   host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90", 1),
@@ -32,7 +32,6 @@ using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
 using testing::ReturnRef;
-using testing::SaveArg;
 
 namespace Envoy {
 namespace Upstream {
@@ -60,12 +59,7 @@ public:
 
 class OriginalDstClusterTest : public testing::Test {
 public:
-  // cleanup timer must be created before the cluster (in setup()), so that we can set expectations
-  // on it. Ownership is transferred to the cluster at the cluster constructor, so the cluster will
-  // take care of destructing it!
-  OriginalDstClusterTest()
-      : cleanup_timer_(new Event::MockTimer(&dispatcher_)),
-        api_(Api::createApiForTest(stats_store_)) {}
+  OriginalDstClusterTest() : api_(Api::createApiForTest(stats_store_)) {}
 
   void setupFromJson(const std::string& json) { setup(parseClusterFromJson(json)); }
   void setupFromYaml(const std::string& yaml) { setup(parseClusterFromV2Yaml(yaml)); }
@@ -87,6 +81,25 @@ public:
     cluster_->initialize([&]() -> void { initialized_.ready(); });
   }
 
+  // Create a worker load balancer, whose cleanup timer is saved in cleanup_timer_ and whose
+  // expired hosts are appended to hosts_removed_.
+  std::unique_ptr<OriginalDstCluster::LoadBalancer>
+  createLoadBalancer(std::chrono::milliseconds cleanup_interval = std::chrono::milliseconds(5000)) {
+    cleanup_timer_ = new Event::MockTimer(&dispatcher_);
+    EXPECT_CALL(*cleanup_timer_, enableTimer(cleanup_interval));
+    return std::make_unique<OriginalDstCluster::LoadBalancer>(
+        cluster_, cluster_->info()->lbOriginalDstConfig(), dispatcher_,
+        [this](const HostVector& hosts_removed) {
+          hosts_removed_.insert(hosts_removed_.end(), hosts_removed.begin(), hosts_removed.end());
+        });
+  }
+
+  // Run the cleanup of the last created load balancer.
+  void cleanup() {
+    EXPECT_CALL(*cleanup_timer_, enableTimer(_));
+    cleanup_timer_->callback_();
+  }
+
   Stats::IsolatedStoreImpl stats_store_;
   Ssl::MockContextManager ssl_context_manager_;
   ClusterSharedPtr cluster_;
@@ -94,7 +107,8 @@ public:
   ReadyWatcher initialized_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Event::MockDispatcher> dispatcher_;
-  Event::MockTimer* cleanup_timer_;
+  Event::MockTimer* cleanup_timer_{};
+  HostVector hosts_removed_;
   NiceMock<Runtime::MockRandomGenerator> random_;
   NiceMock<LocalInfo::MockLocalInfo> local_info_;
   NiceMock<Server::MockAdmin> admin_;
@@ -144,11 +158,14 @@ TEST_F(OriginalDstClusterTest, CleanupInterval) {
 
   EXPECT_CALL(initialized_, ready());
   EXPECT_CALL(membership_updated_, ready()).Times(0);
-  EXPECT_CALL(*cleanup_timer_, enableTimer(std::chrono::milliseconds(1000)));
+  EXPECT_CALL(dispatcher_, createTimer_(_)).Times(0);
   setupFromJson(json);
 
   EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
   EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHosts().size());
+
+  // The cleanup runs on the worker of each load balancer.
+  auto lb = createLoadBalancer(std::chrono::milliseconds(1000));
 }
 
 TEST_F(OriginalDstClusterTest, NoContext) {
@@ -163,7 +180,6 @@ TEST_F(OriginalDstClusterTest, NoContext) {
 
   EXPECT_CALL(initialized_, ready());
   EXPECT_CALL(membership_updated_, ready()).Times(0);
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
   setupFromJson(json);
 
   EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
@@ -176,10 +192,8 @@ TEST_F(OriginalDstClusterTest, NoContext) {
   // No downstream connection => no host.
   {
     TestLoadBalancerContext lb_context(nullptr);
-    OriginalDstCluster::LoadBalancer lb(cluster_->prioritySet(), cluster_,
-                                        cluster_->info()->lbOriginalDstConfig());
-    EXPECT_CALL(dispatcher_, post(_)).Times(0);
-    HostConstSharedPtr host = lb.chooseHost(&lb_context);
+    auto lb = createLoadBalancer();
+    HostConstSharedPtr host = lb->chooseHost(&lb_context);
     EXPECT_EQ(host, nullptr);
   }
 
@@ -189,13 +203,8 @@ TEST_F(OriginalDstClusterTest, NoContext) {
     TestLoadBalancerContext lb_context(&connection);
 
     EXPECT_CALL(connection, localAddressRestored()).WillOnce(Return(false));
-    // First argument is normally the reference to the ThreadLocalCluster's HostSet, but in these
-    // tests we do not have the thread local clusters, so we pass a reference to the HostSet of the
-    // primary cluster. The implementation handles both cases the same.
-    OriginalDstCluster::LoadBalancer lb(cluster_->prioritySet(), cluster_,
-                                        cluster_->info()->lbOriginalDstConfig());
-    EXPECT_CALL(dispatcher_, post(_)).Times(0);
-    HostConstSharedPtr host = lb.chooseHost(&lb_context);
+    auto lb = createLoadBalancer();
+    HostConstSharedPtr host = lb->chooseHost(&lb_context);
     EXPECT_EQ(host, nullptr);
   }
 
@@ -206,12 +215,12 @@ TEST_F(OriginalDstClusterTest, NoContext) {
     connection.local_address_ = std::make_shared<Network::Address::PipeInstance>("unix://foo");
     EXPECT_CALL(connection, localAddressRestored()).WillRepeatedly(Return(true));
 
-    OriginalDstCluster::LoadBalancer lb(cluster_->prioritySet(), cluster_,
-                                        cluster_->info()->lbOriginalDstConfig());
-    EXPECT_CALL(dispatcher_, post(_)).Times(0);
-    HostConstSharedPtr host = lb.chooseHost(&lb_context);
+    auto lb = createLoadBalancer();
+    HostConstSharedPtr host = lb->chooseHost(&lb_context);
     EXPECT_EQ(host, nullptr);
   }
+
+  EXPECT_TRUE(hosts_removed_.empty());
 }
 
 TEST_F(OriginalDstClusterTest, Membership) {
@@ -225,85 +234,55 @@ TEST_F(OriginalDstClusterTest, Membership) {
   )EOF";
 
   EXPECT_CALL(initialized_, ready());
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
   setupFromJson(json);
 
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHosts().size());
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hostsPerLocality().get().size());
-  EXPECT_EQ(
-      0UL,
-      cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHostsPerLocality().get().size());
-
-  EXPECT_CALL(membership_updated_, ready());
+  // Hosts are added by the worker load balancer without going through the main thread, and never
+  // show up in the cluster's host set.
+  EXPECT_CALL(membership_updated_, ready()).Times(0);
+  EXPECT_CALL(dispatcher_, post(_)).Times(0);
 
   // Host gets the local address of the downstream connection.
-
   NiceMock<Network::MockConnection> connection;
   TestLoadBalancerContext lb_context(&connection);
   connection.local_address_ = std::make_shared<Network::Address::Ipv4Instance>("10.10.11.11");
   EXPECT_CALL(connection, localAddressRestored()).WillRepeatedly(Return(true));
 
-  OriginalDstCluster::LoadBalancer lb(cluster_->prioritySet(), cluster_,
-                                      cluster_->info()->lbOriginalDstConfig());
-  Event::PostCb post_cb;
-  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
-  HostConstSharedPtr host = lb.chooseHost(&lb_context);
-  post_cb();
-  auto cluster_hosts = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts();
-
+  auto lb = createLoadBalancer();
+  HostConstSharedPtr host = lb->chooseHost(&lb_context);
   ASSERT_NE(host, nullptr);
   EXPECT_EQ(*connection.local_address_, *host->address());
-
-  EXPECT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  EXPECT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHosts().size());
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hostsPerLocality().get().size());
-  EXPECT_EQ(
-      0UL,
-      cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHostsPerLocality().get().size());
-
-  EXPECT_EQ(host, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]);
-  EXPECT_EQ(*connection.local_address_,
-            *cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]->address());
+  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
 
   // Same host is returned on the 2nd call
-  HostConstSharedPtr host2 = lb.chooseHost(&lb_context);
+  HostConstSharedPtr host2 = lb->chooseHost(&lb_context);
   EXPECT_EQ(host2, host);
 
-  // Make host time out, no membership changes happen on the first timeout.
-  ASSERT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  EXPECT_EQ(true, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]->used());
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
-  cleanup_timer_->callback_();
-  EXPECT_EQ(
-      cluster_hosts,
-      cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()); // hosts vector remains the same
-
-  // host gets removed on the 2nd timeout.
-  ASSERT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  EXPECT_EQ(false, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]->used());
+  // Make host time out, nothing is removed on the first timeout.
+  cleanup();
+  EXPECT_TRUE(hosts_removed_.empty());
 
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
-  EXPECT_CALL(membership_updated_, ready());
-  cleanup_timer_->callback_();
-  EXPECT_NE(cluster_hosts,
-            cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()); // hosts vector changes
+  // A host used again after the first timeout survives the 2nd timeout.
+  EXPECT_EQ(host, lb->chooseHost(&lb_context));
+  cleanup();
+  EXPECT_TRUE(hosts_removed_.empty());
 
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  cluster_hosts = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts();
+  // host gets removed on the 2nd timeout without use.
+  cleanup();
+  EXPECT_TRUE(hosts_removed_.empty());
+  cleanup();
+  ASSERT_EQ(1UL, hosts_removed_.size());
+  EXPECT_EQ(host, hosts_removed_[0]);
 
   // New host gets created
-  EXPECT_CALL(membership_updated_, ready());
-  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
-  HostConstSharedPtr host3 = lb.chooseHost(&lb_context);
-  post_cb();
+  HostConstSharedPtr host3 = lb->chooseHost(&lb_context);
   EXPECT_NE(host3, nullptr);
   EXPECT_NE(host3, host);
-  EXPECT_NE(cluster_hosts,
-            cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()); // hosts vector changes
+  EXPECT_EQ(*connection.local_address_, *host3->address());
 
-  EXPECT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  EXPECT_EQ(host3, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]);
+  // The remaining hosts are removed when the load balancer is destroyed.
+  lb.reset();
+  ASSERT_EQ(2UL, hosts_removed_.size());
+  EXPECT_EQ(host3, hosts_removed_[1]);
 }
 
 TEST_F(OriginalDstClusterTest, Membership2) {
@@ -317,16 +296,8 @@ TEST_F(OriginalDstClusterTest, Membership2) {
   )EOF";
 
   EXPECT_CALL(initialized_, ready());
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
   setupFromJson(json);
 
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHosts().size());
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hostsPerLocality().get().size());
-  EXPECT_EQ(
-      0UL,
-      cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHostsPerLocality().get().size());
-
   // Host gets the local address of the downstream connection.
 
   NiceMock<Network::MockConnection> connection1;
@@ -339,63 +310,31 @@ TEST_F(OriginalDstClusterTest, Membership2) {
   connection2.local_address_ = std::make_shared<Network::Address::Ipv4Instance>("10.10.11.12");
   EXPECT_CALL(connection2, localAddressRestored()).WillRepeatedly(Return(true));
 
-  OriginalDstCluster::LoadBalancer lb(cluster_->prioritySet(), cluster_,
-                                      cluster_->info()->lbOriginalDstConfig());
+  auto lb = createLoadBalancer();
 
-  EXPECT_CALL(membership_updated_, ready());
-  Event::PostCb post_cb;
-  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
-  HostConstSharedPtr host1 = lb.chooseHost(&lb_context1);
-  post_cb();
+  EXPECT_CALL(membership_updated_, ready()).Times(0);
+  HostConstSharedPtr host1 = lb->chooseHost(&lb_context1);
   ASSERT_NE(host1, nullptr);
   EXPECT_EQ(*connection1.local_address_, *host1->address());
 
-  EXPECT_CALL(membership_updated_, ready());
-  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
-  HostConstSharedPtr host2 = lb.chooseHost(&lb_context2);
-  post_cb();
+  HostConstSharedPtr host2 = lb->chooseHost(&lb_context2);
   ASSERT_NE(host2, nullptr);
   EXPECT_EQ(*connection2.local_address_, *host2->address());
+  EXPECT_NE(host1, host2);
 
-  EXPECT_EQ(2UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  EXPECT_EQ(2UL, cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHosts().size());
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hostsPerLocality().get().size());
-  EXPECT_EQ(
-      0UL,
-      cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHostsPerLocality().get().size());
-
-  EXPECT_EQ(host1, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]);
-  EXPECT_EQ(*connection1.local_address_,
-            *cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]->address());
-
-  EXPECT_EQ(host2, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[1]);
-  EXPECT_EQ(*connection2.local_address_,
-            *cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[1]->address());
-
-  auto cluster_hosts = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts();
-
-  // Make hosts time out, no membership changes happen on the first timeout.
-  ASSERT_EQ(2UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  EXPECT_EQ(true, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]->used());
-  EXPECT_EQ(true, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[1]->used());
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
-  cleanup_timer_->callback_();
-  EXPECT_EQ(
-      cluster_hosts,
-      cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()); // hosts vector remains the same
-
-  // both hosts get removed on the 2nd timeout.
-  ASSERT_EQ(2UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  EXPECT_EQ(false, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]->used());
-  EXPECT_EQ(false, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[1]->used());
+  // Make hosts time out, nothing is removed on the first timeout.
+  cleanup();
+  EXPECT_TRUE(hosts_removed_.empty());
 
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
-  EXPECT_CALL(membership_updated_, ready());
-  cleanup_timer_->callback_();
-  EXPECT_NE(cluster_hosts,
-            cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()); // hosts vector changes
+  // Only the host that was not used since expires on the 2nd timeout.
+  EXPECT_EQ(host2, lb->chooseHost(&lb_context2));
+  cleanup();
+  ASSERT_EQ(1UL, hosts_removed_.size());
+  EXPECT_EQ(host1, hosts_removed_[0]);
 
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+  cleanup();
+  ASSERT_EQ(2UL, hosts_removed_.size());
+  EXPECT_EQ(host2, hosts_removed_[1]);
 }
 
 TEST_F(OriginalDstClusterTest, Connection) {
@@ -409,30 +348,16 @@ TEST_F(OriginalDstClusterTest, Connection) {
   )EOF";
 
   EXPECT_CALL(initialized_, ready());
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
   setupFromJson(json);
 
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHosts().size());
-  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hostsPerLocality().get().size());
-  EXPECT_EQ(
-      0UL,
-      cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHostsPerLocality().get().size());
-
-  EXPECT_CALL(membership_updated_, ready());
-
   // Connection to the host is made to the downstream connection's local address.
   NiceMock<Network::MockConnection> connection;
   TestLoadBalancerContext lb_context(&connection);
   connection.local_address_ = std::make_shared<Network::Address::Ipv6Instance>("FD00::1");
   EXPECT_CALL(connection, localAddressRestored()).WillRepeatedly(Return(true));
 
-  OriginalDstCluster::LoadBalancer lb(cluster_->prioritySet(), cluster_,
-                                      cluster_->info()->lbOriginalDstConfig());
-  Event::PostCb post_cb;
-  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
-  HostConstSharedPtr host = lb.chooseHost(&lb_context);
-  post_cb();
+  auto lb = createLoadBalancer();
+  HostConstSharedPtr host = lb->chooseHost(&lb_context);
   ASSERT_NE(host, nullptr);
   EXPECT_EQ(*connection.local_address_, *host->address());
 
@@ -441,7 +366,9 @@ TEST_F(OriginalDstClusterTest, Connection) {
   host->createConnection(dispatcher_, nullptr, nullptr);
 }
 
-TEST_F(OriginalDstClusterTest, MultipleClusters) {
+// Each worker keeps its own hosts, so the same original destination gets a distinct host on each
+// of them, which expires independently.
+TEST_F(OriginalDstClusterTest, MultipleWorkers) {
   std::string json = R"EOF(
   {
     "name": "name",
@@ -452,49 +379,35 @@ TEST_F(OriginalDstClusterTest, MultipleClusters) {
   )EOF";
 
   EXPECT_CALL(initialized_, ready());
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
   setupFromJson(json);
 
-  PrioritySetImpl second;
-  cluster_->prioritySet().addPriorityUpdateCb(
-      [&](uint32_t, const HostVector& added, const HostVector& removed) -> void {
-        // Update second hostset accordingly;
-        HostVectorSharedPtr new_hosts(
-            new HostVector(cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()));
-        HostVectorSharedPtr healthy_hosts(
-            new HostVector(cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()));
-        const HostsPerLocalityConstSharedPtr empty_hosts_per_locality{new HostsPerLocalityImpl()};
-
-        second.updateHosts(0,
-                           HostSetImpl::updateHostsParams(new_hosts, empty_hosts_per_locality,
-                                                          healthy_hosts, empty_hosts_per_locality),
-                           {}, added, removed, absl::nullopt);
-      });
-
-  EXPECT_CALL(membership_updated_, ready());
-
-  // Connection to the host is made to the downstream connection's local address.
   NiceMock<Network::MockConnection> connection;
   TestLoadBalancerContext lb_context(&connection);
   connection.local_address_ = std::make_shared<Network::Address::Ipv6Instance>("FD00::1");
   EXPECT_CALL(connection, localAddressRestored()).WillRepeatedly(Return(true));
 
-  OriginalDstCluster::LoadBalancer lb1(cluster_->prioritySet(), cluster_,
-                                       cluster_->info()->lbOriginalDstConfig());
-  OriginalDstCluster::LoadBalancer lb2(second, cluster_, cluster_->info()->lbOriginalDstConfig());
-  Event::PostCb post_cb;
-  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
-  HostConstSharedPtr host = lb1.chooseHost(&lb_context);
-  post_cb();
-  ASSERT_NE(host, nullptr);
-  EXPECT_EQ(*connection.local_address_, *host->address());
+  auto lb1 = createLoadBalancer();
+  Event::MockTimer* cleanup_timer1 = cleanup_timer_;
+  auto lb2 = createLoadBalancer();
 
-  EXPECT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
-  // Check that lb2 also gets updated
-  EXPECT_EQ(1UL, second.hostSetsPerPriority()[0]->hosts().size());
-
-  EXPECT_EQ(host, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]);
-  EXPECT_EQ(host, second.hostSetsPerPriority()[0]->hosts()[0]);
+  EXPECT_CALL(dispatcher_, post(_)).Times(0);
+  HostConstSharedPtr host1 = lb1->chooseHost(&lb_context);
+  HostConstSharedPtr host2 = lb2->chooseHost(&lb_context);
+  ASSERT_NE(host1, nullptr);
+  ASSERT_NE(host2, nullptr);
+  EXPECT_NE(host1, host2);
+  EXPECT_EQ(*host1->address(), *host2->address());
+
+  // The hosts of the second worker expire while the first worker keeps using its host.
+  cleanup();
+  cleanup();
+  ASSERT_EQ(1UL, hosts_removed_.size());
+  EXPECT_EQ(host2, hosts_removed_[0]);
+  EXPECT_EQ(host1, lb1->chooseHost(&lb_context));
+
+  cleanup_timer_ = cleanup_timer1;
+  cleanup();
+  EXPECT_EQ(1UL, hosts_removed_.size());
 }
 
 TEST_F(OriginalDstClusterTest, UseHttpHeaderEnabled) {
@@ -508,7 +421,6 @@ TEST_F(OriginalDstClusterTest, UseHttpHeaderEnabled) {
   )EOF";
 
   EXPECT_CALL(initialized_, ready());
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
   setupFromYaml(yaml);
 
   EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
@@ -518,18 +430,15 @@ TEST_F(OriginalDstClusterTest, UseHttpHeaderEnabled) {
       0UL,
       cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHostsPerLocality().get().size());
 
-  OriginalDstCluster::LoadBalancer lb(cluster_->prioritySet(), cluster_,
-                                      cluster_->info()->lbOriginalDstConfig());
-  Event::PostCb post_cb;
+  auto lb = createLoadBalancer();
+  EXPECT_CALL(membership_updated_, ready()).Times(0);
+  EXPECT_CALL(dispatcher_, post(_)).Times(0);
 
   // HTTP header override.
   TestLoadBalancerContext lb_context1(nullptr, Http::Headers::get().EnvoyOriginalDstHost.get(),
                                       "127.0.0.1:5555");
 
-  EXPECT_CALL(membership_updated_, ready());
-  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
-  HostConstSharedPtr host1 = lb.chooseHost(&lb_context1);
-  post_cb();
+  HostConstSharedPtr host1 = lb->chooseHost(&lb_context1);
   ASSERT_NE(host1, nullptr);
   EXPECT_EQ("127.0.0.1:5555", host1->address()->asString());
 
@@ -542,19 +451,14 @@ TEST_F(OriginalDstClusterTest, UseHttpHeaderEnabled) {
   TestLoadBalancerContext lb_context2(&connection2, Http::Headers::get().EnvoyOriginalDstHost.get(),
                                       "127.0.0.1:5556");
 
-  EXPECT_CALL(membership_updated_, ready());
-  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
-  HostConstSharedPtr host2 = lb.chooseHost(&lb_context2);
-  post_cb();
+  HostConstSharedPtr host2 = lb->chooseHost(&lb_context2);
   ASSERT_NE(host2, nullptr);
   EXPECT_EQ("127.0.0.1:5556", host2->address()->asString());
 
   // HTTP header override with empty header value.
   TestLoadBalancerContext lb_context3(nullptr, Http::Headers::get().EnvoyOriginalDstHost.get(), "");
 
-  EXPECT_CALL(membership_updated_, ready()).Times(0);
-  EXPECT_CALL(dispatcher_, post(_)).Times(0);
-  HostConstSharedPtr host3 = lb.chooseHost(&lb_context3);
+  HostConstSharedPtr host3 = lb->chooseHost(&lb_context3);
   EXPECT_EQ(host3, nullptr);
   EXPECT_EQ(
       1, TestUtility::findCounter(stats_store_, "cluster.name.original_dst_host_invalid")->value());
@@ -563,9 +467,7 @@ TEST_F(OriginalDstClusterTest, UseHttpHeaderEnabled) {
   TestLoadBalancerContext lb_context4(nullptr, Http::Headers::get().EnvoyOriginalDstHost.get(),
                                       "a.b.c.d");
 
-  EXPECT_CALL(membership_updated_, ready()).Times(0);
-  EXPECT_CALL(dispatcher_, post(_)).Times(0);
-  HostConstSharedPtr host4 = lb.chooseHost(&lb_context4);
+  HostConstSharedPtr host4 = lb->chooseHost(&lb_context4);
   EXPECT_EQ(host4, nullptr);
   EXPECT_EQ(
       2, TestUtility::findCounter(stats_store_, "cluster.name.original_dst_host_invalid")->value());
@@ -580,7 +482,6 @@ TEST_F(OriginalDstClusterTest, UseHttpHeaderDisabled) {
   )EOF";
 
   EXPECT_CALL(initialized_, ready());
-  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
   setupFromYaml(yaml);
 
   EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
@@ -590,9 +491,9 @@ TEST_F(OriginalDstClusterTest, UseHttpHeaderDisabled) {
       0UL,
       cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHostsPerLocality().get().size());
 
-  OriginalDstCluster::LoadBalancer lb(cluster_->prioritySet(), cluster_,
-                                      cluster_->info()->lbOriginalDstConfig());
-  Event::PostCb post_cb;
+  auto lb = createLoadBalancer();
+  EXPECT_CALL(membership_updated_, ready()).Times(0);
+  EXPECT_CALL(dispatcher_, post(_)).Times(0);
 
   // Downstream connection with original_dst filter, HTTP header override ignored.
   NiceMock<Network::MockConnection> connection1;
@@ -601,10 +502,7 @@ TEST_F(OriginalDstClusterTest, UseHttpHeaderDisabled) {
   TestLoadBalancerContext lb_context1(&connection1, Http::Headers::get().EnvoyOriginalDstHost.get(),
                                       "127.0.0.1:5555");
 
-  EXPECT_CALL(membership_updated_, ready());
-  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
-  HostConstSharedPtr host1 = lb.chooseHost(&lb_context1);
-  post_cb();
+  HostConstSharedPtr host1 = lb->chooseHost(&lb_context1);
   ASSERT_NE(host1, nullptr);
   EXPECT_EQ(*connection1.local_address_, *host1->address());
 
@@ -615,9 +513,7 @@ TEST_F(OriginalDstClusterTest, UseHttpHeaderDisabled) {
   TestLoadBalancerContext lb_context2(&connection2, Http::Headers::get().EnvoyOriginalDstHost.get(),
                                       "127.0.0.1:5555");
 
-  EXPECT_CALL(membership_updated_, ready()).Times(0);
-  EXPECT_CALL(dispatcher_, post(_)).Times(0);
-  HostConstSharedPtr host2 = lb.chooseHost(&lb_context2);
+  HostConstSharedPtr host2 = lb->chooseHost(&lb_context2);
   EXPECT_EQ(host2, nullptr);
 
   // Downstream connection over Unix Domain Socket, HTTP header override ignored.
@@ -626,9 +522,7 @@ TEST_F(OriginalDstClusterTest, UseHttpHeaderDisabled) {
   TestLoadBalancerContext lb_context3(&connection3, Http::Headers::get().EnvoyOriginalDstHost.get(),
                                       "127.0.0.1:5555");
 
-  EXPECT_CALL(membership_updated_, ready()).Times(0);
-  EXPECT_CALL(dispatcher_, post(_)).Times(0);
-  HostConstSharedPtr host3 = lb.chooseHost(&lb_context3);
+  HostConstSharedPtr host3 = lb->chooseHost(&lb_context3);
   EXPECT_EQ(host3, nullptr);
 }
 
@@ -16,6 +16,7 @@
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
 
 #include "absl/types/optional.h"
 #include "gmock/gmock.h"
@@ -848,18 +849,55 @@ TEST(OutlierDetectionEventLoggerImplTest, All) {
 }
 
 TEST(OutlierUtility, SRThreshold) {
-  std::vector<HostSuccessRatePair> data = {
-      HostSuccessRatePair(nullptr, 50),  HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100), HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100),
-  };
-  double sum = 450;
-
-  Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(sum, data, 1.9);
+  SuccessRateStatistics statistics;
+  for (const double success_rate : {50, 100, 100, 100, 100}) {
+    statistics.add(success_rate);
+  }
+
+  Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(statistics, 1.9);
   EXPECT_EQ(52.0, ejection_pair.ejection_threshold_);
   EXPECT_EQ(90.0, ejection_pair.success_rate_average_);
 }
 
+TEST(OutlierUtility, SuccessRateStatistics) {
+  SuccessRateStatistics statistics;
+  EXPECT_EQ(0, statistics.count());
+  EXPECT_EQ(0, statistics.variance());
+
+  // Rates close to each other keep their small variance.
+  for (uint32_t i = 0; i < 10000; i++) {
+    statistics.add(i % 2 == 0 ? 99.99 : 99.97);
+  }
+  EXPECT_EQ(10000, statistics.count());
+  EXPECT_NEAR(99.98, statistics.mean(), 1e-9);
+  EXPECT_NEAR(0.0001, statistics.variance(), 1e-9);
+}
+
+// Requests counted on different threads land in different shards, which are summed.
+TEST(SuccessRateAccumulatorBucket, Shards) {
+  SuccessRateAccumulatorBucket bucket;
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < 8; i++) {
+    threads.emplace_back(Thread::threadFactoryForTest().createThread([&bucket, i]() -> void {
+      for (uint32_t j = 0; j < 1000; j++) {
+        bucket.incTotalRequests();
+        if (j % 4 != i % 4) {
+          bucket.incSuccessRequests();
+        }
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(8000, bucket.totalRequests());
+  EXPECT_EQ(6000, bucket.successRequests());
+
+  bucket.reset();
+  EXPECT_EQ(0, bucket.totalRequests());
+  EXPECT_EQ(0, bucket.successRequests());
+}
+
 TEST(DetectorHostMonitorImpl, resultToHttpCode) {
   EXPECT_EQ(Http::Code::OK, DetectorHostMonitorImpl::resultToHttpCode(Result::SUCCESS));
   EXPECT_EQ(Http::Code::GatewayTimeout, DetectorHostMonitorImpl::resultToHttpCode(Result::TIMEOUT));
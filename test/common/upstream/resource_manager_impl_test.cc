@@ -25,9 +25,10 @@ TEST(ResourceManagerImplTest, RuntimeResourceManager) {
   ON_CALL(store, gauge(_)).WillByDefault(ReturnRef(gauge));
 
   ResourceManagerImpl resource_manager(
-      runtime, "circuit_breakers.runtime_resource_manager_test.default.", 0, 0, 0, 1, 0,
+      runtime, "circuit_breakers.runtime_resource_manager_test.default.", 0, 0, 0, 1, 0, 0,
       ClusterCircuitBreakersStats{
-          ALL_CLUSTER_CIRCUIT_BREAKERS_STATS(POOL_GAUGE(store), POOL_GAUGE(store))});
+          ALL_CLUSTER_CIRCUIT_BREAKERS_STATS(POOL_GAUGE(store), POOL_GAUGE(store))},
+      absl::nullopt, absl::nullopt);
 
   EXPECT_CALL(
       runtime.snapshot_,
@@ -65,6 +66,13 @@ TEST(ResourceManagerImplTest, RuntimeResourceManager) {
       .WillRepeatedly(Return(5U));
   EXPECT_EQ(5U, resource_manager.connectionPools().max());
   EXPECT_TRUE(resource_manager.connectionPools().canCreate());
+
+  EXPECT_CALL(
+      runtime.snapshot_,
+      getInteger("circuit_breakers.runtime_resource_manager_test.default.max_connections_per_host",
+                 0U))
+      .WillOnce(Return(6U));
+  EXPECT_EQ(6U, resource_manager.maxConnectionsPerHost());
 }
 
 TEST(ResourceManagerImplTest, RemainingResourceGauges) {
@@ -73,8 +81,9 @@ TEST(ResourceManagerImplTest, RemainingResourceGauges) {
 
   auto stats = ClusterCircuitBreakersStats{
       ALL_CLUSTER_CIRCUIT_BREAKERS_STATS(POOL_GAUGE(store), POOL_GAUGE(store))};
-  ResourceManagerImpl resource_manager(
-      runtime, "circuit_breakers.runtime_resource_manager_test.default.", 1, 2, 1, 0, 3, stats);
+  ResourceManagerImpl resource_manager(runtime,
+                                       "circuit_breakers.runtime_resource_manager_test.default.", 1,
+                                       2, 1, 0, 3, 4, stats, absl::nullopt, absl::nullopt);
 
   // Test remaining_cx_ gauge
   EXPECT_EQ(1U, resource_manager.connections().max());
@@ -120,6 +129,67 @@ TEST(ResourceManagerImplTest, RemainingResourceGauges) {
   resource_manager.connectionPools().dec();
   EXPECT_EQ(3U, stats.remaining_cx_pools_.value());
 }
+
+TEST(ResourceManagerImplTest, RetryBudget) {
+  NiceMock<Runtime::MockLoader> runtime;
+  Stats::IsolatedStoreImpl store;
+
+  auto stats = ClusterCircuitBreakersStats{
+      ALL_CLUSTER_CIRCUIT_BREAKERS_STATS(POOL_GAUGE(store), POOL_GAUGE(store))};
+  ResourceManagerImpl resource_manager(runtime,
+                                       "circuit_breakers.runtime_resource_manager_test.default.",
+                                       1024, 1024, 1024, 1, 1024, 1024, stats, 25.0, 2);
+  EXPECT_TRUE(resource_manager.hasRetryBudget());
+
+  // Without requests, the minimum retry concurrency is allowed, regardless of max_retries.
+  EXPECT_EQ(2U, resource_manager.retries().max());
+  resource_manager.retries().inc();
+  EXPECT_EQ(1U, stats.remaining_retries_.value());
+  EXPECT_TRUE(resource_manager.retries().canCreate());
+  resource_manager.retries().inc();
+  EXPECT_FALSE(resource_manager.retries().canCreate());
+  EXPECT_EQ(1U, stats.rq_retry_open_.value());
+
+  // The budget is a percentage of the active and pending requests.
+  for (int i = 0; i < 8; i++) {
+    resource_manager.requests().inc();
+    resource_manager.pendingRequests().inc();
+  }
+  EXPECT_EQ(4U, resource_manager.retries().max());
+  EXPECT_TRUE(resource_manager.retries().canCreate());
+  resource_manager.retries().inc();
+  EXPECT_EQ(1U, stats.remaining_retries_.value());
+
+  // The minimum retry concurrency can be overridden by runtime.
+  EXPECT_CALL(runtime.snapshot_,
+              getInteger("circuit_breakers.runtime_resource_manager_test.default.retry_budget."
+                         "min_retry_concurrency",
+                         2U))
+      .WillRepeatedly(Return(10U));
+  EXPECT_EQ(10U, resource_manager.retries().max());
+
+  resource_manager.retries().decBy(3);
+  resource_manager.requests().decBy(8);
+  resource_manager.pendingRequests().decBy(8);
+}
+
+TEST(ResourceManagerImplTest, NoRetryBudget) {
+  NiceMock<Runtime::MockLoader> runtime;
+  Stats::IsolatedStoreImpl store;
+
+  auto stats = ClusterCircuitBreakersStats{
+      ALL_CLUSTER_CIRCUIT_BREAKERS_STATS(POOL_GAUGE(store), POOL_GAUGE(store))};
+  ResourceManagerImpl resource_manager(runtime,
+                                       "circuit_breakers.runtime_resource_manager_test.default.",
+                                       1024, 1024, 1024, 1, 1024, 1024, stats, absl::nullopt,
+                                       absl::nullopt);
+  EXPECT_FALSE(resource_manager.hasRetryBudget());
+  for (int i = 0; i < 8; i++) {
+    resource_manager.requests().inc();
+  }
+  EXPECT_EQ(1U, resource_manager.retries().max());
+  resource_manager.requests().decBy(8);
+}
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
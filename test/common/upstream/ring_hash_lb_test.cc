@@ -13,6 +13,7 @@
 #include "test/common/upstream/utility.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -41,7 +42,7 @@ public:
 
   void init() {
     lb_ = std::make_unique<RingHashLoadBalancer>(priority_set_, stats_, stats_store_, runtime_,
-                                                 random_, config_, common_config_);
+                                                 random_, time_system_, config_, common_config_);
     lb_->initialize();
   }
 
@@ -59,6 +60,7 @@ public:
   envoy::api::v2::Cluster::CommonLbConfig common_config_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Runtime::MockRandomGenerator> random_;
+  Event::SimulatedTimeSystem time_system_;
   std::unique_ptr<RingHashLoadBalancer> lb_;
 };
 
@@ -99,6 +101,7 @@ TEST_P(RingHashLoadBalancerTest, Basic) {
   EXPECT_EQ("ring_hash_lb.size", lb_->stats().size_.name());
   EXPECT_EQ("ring_hash_lb.min_hashes_per_host", lb_->stats().min_hashes_per_host_.name());
   EXPECT_EQ("ring_hash_lb.max_hashes_per_host", lb_->stats().max_hashes_per_host_.name());
+  EXPECT_EQ("ring_hash_lb.ring_build_time_us", lb_->stats().ring_build_time_us_.name());
   EXPECT_EQ(12, lb_->stats().size_.value());
   EXPECT_EQ(2, lb_->stats().min_hashes_per_host_.value());
   EXPECT_EQ(2, lb_->stats().max_hashes_per_host_.value());
@@ -158,6 +161,57 @@ TEST_P(RingHashLoadBalancerTest, Basic) {
   EXPECT_EQ(1UL, stats_.lb_healthy_panic_.value());
 }
 
+// Check every entry of the ring from the Basic test: a hash selects the first entry at or after
+// it, and a hash past the last entry wraps around to the first one.
+TEST_P(RingHashLoadBalancerTest, EveryRingPosition) {
+  hostSet().hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:90"), makeTestHost(info_, "tcp://127.0.0.1:91"),
+      makeTestHost(info_, "tcp://127.0.0.1:92"), makeTestHost(info_, "tcp://127.0.0.1:93"),
+      makeTestHost(info_, "tcp://127.0.0.1:94"), makeTestHost(info_, "tcp://127.0.0.1:95")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+
+  config_ = envoy::api::v2::Cluster::RingHashLbConfig();
+  config_.value().mutable_minimum_ring_size()->set_value(12);
+  init();
+
+  const std::vector<std::pair<uint64_t, uint32_t>> ring = {
+      {833437586790550860UL, 4},   {928266305478181108UL, 2},   {1033482794131418490UL, 0},
+      {3551244743356806947UL, 5},  {3851675632748031481UL, 3},  {5583722120771150861UL, 1},
+      {6311230543546372928UL, 1},  {7700377290971790572UL, 3},  {13144177310400110813UL, 5},
+      {13444792449719432967UL, 2}, {15516499411664133160UL, 4}, {16117243373044804889UL, 0}};
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  for (uint64_t i = 0; i < ring.size(); ++i) {
+    const uint32_t next = ring[(i + 1) % ring.size()].second;
+    TestLoadBalancerContext at_entry(ring[i].first);
+    EXPECT_EQ(hostSet().hosts_[ring[i].second], lb->chooseHost(&at_entry));
+    TestLoadBalancerContext before_entry(ring[i].first - 1);
+    EXPECT_EQ(hostSet().hosts_[ring[i].second], lb->chooseHost(&before_entry));
+    TestLoadBalancerContext after_entry(ring[i].first + 1);
+    EXPECT_EQ(hostSet().hosts_[next], lb->chooseHost(&after_entry));
+  }
+}
+
+// A ring with a single entry maps every hash to its host.
+TEST_P(RingHashLoadBalancerTest, SingleEntryRing) {
+  hostSet().hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+
+  config_ = envoy::api::v2::Cluster::RingHashLbConfig();
+  config_.value().mutable_minimum_ring_size()->set_value(1);
+  config_.value().mutable_maximum_ring_size()->set_value(1);
+  init();
+  EXPECT_EQ(1, lb_->stats().size_.value());
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  for (uint64_t hash : {0UL, 1033482794131418490UL, std::numeric_limits<uint64_t>::max()}) {
+    TestLoadBalancerContext context(hash);
+    EXPECT_EQ(hostSet().hosts_[0], lb->chooseHost(&context));
+  }
+}
+
 // Ensure if all the hosts with priority 0 unhealthy, the next priority hosts are used.
 TEST_P(RingHashFailoverTest, BasicFailover) {
   host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80")};
@@ -17,6 +17,7 @@
 #include "test/mocks/filesystem/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 #include "absl/types/optional.h"
 #include "gmock/gmock.h"
@@ -175,8 +176,9 @@ public:
     }
 
     lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, stats_store_,
-                                     runtime_, random_, subset_info_, ring_hash_lb_config_,
-                                     least_request_lb_config_, common_config_));
+                                     runtime_, random_, time_system_, subset_info_,
+                                     ring_hash_lb_config_, least_request_lb_config_,
+                                     common_config_));
   }
 
   void zoneAwareInit(const std::vector<HostURLMetadataMap>& host_metadata_per_locality,
@@ -222,7 +224,8 @@ public:
 
     lb_.reset(new SubsetLoadBalancer(
         lb_type_, priority_set_, &local_priority_set_, stats_, stats_store_, runtime_, random_,
-        subset_info_, ring_hash_lb_config_, least_request_lb_config_, common_config_));
+        time_system_, subset_info_, ring_hash_lb_config_, least_request_lb_config_,
+        common_config_));
   }
 
   HostSharedPtr makeHost(const std::string& url, const HostMetadata& metadata) {
@@ -387,6 +390,7 @@ public:
   envoy::api::v2::Cluster::CommonLbConfig common_config_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Runtime::MockRandomGenerator> random_;
+  Event::SimulatedTimeSystem time_system_;
   Stats::IsolatedStoreImpl stats_store_;
   ClusterStats stats_;
   PrioritySetImpl local_priority_set_;
@@ -1608,6 +1612,52 @@ TEST_P(SubsetLoadBalancerTest, GaugesUpdatedOnDestroy) {
 INSTANTIATE_TEST_SUITE_P(UpdateOrderings, SubsetLoadBalancerTest,
                          testing::ValuesIn({REMOVES_FIRST, SIMULTANEOUS}));
 
+TEST(SubsetHostsCacheTest, ComputesOncePerHostsVersion) {
+  std::shared_ptr<MockClusterInfo> info{new NiceMock<MockClusterInfo>()};
+  PrioritySetImpl priority_set;
+  const HostSet& host_set = priority_set.getOrCreateHostSet(0);
+  auto update = [&]() {
+    HostVectorSharedPtr hosts(new HostVector({makeTestHost(info, "tcp://127.0.0.1:80")}));
+    priority_set.updateHosts(
+        0, HostSetImpl::partitionHosts(hosts, HostsPerLocalityImpl::empty()), {}, {}, {},
+        absl::nullopt);
+  };
+  update();
+
+  uint32_t computed = 0;
+  auto compute = [&]() {
+    computed++;
+    return SubsetHostsCache::Hosts{std::make_shared<const HostVector>(host_set.hosts()),
+                                   HostsPerLocalityImpl::empty()};
+  };
+
+  SubsetHostsCache cache;
+  ProtobufWkt::Value value;
+  value.set_string_value("1");
+  const SubsetHostsCache::SubsetMetadata v1{{"version", value}};
+  value.set_string_value("2");
+  const SubsetHostsCache::SubsetMetadata v2{{"version", value}};
+  const SubsetHostsCache::Hosts hosts = cache.getOrCompute(1, v1, host_set, compute);
+  EXPECT_EQ(1U, computed);
+  EXPECT_EQ(hosts.hosts_, cache.getOrCompute(1, v1, host_set, compute).hosts_);
+  EXPECT_EQ(1U, computed);
+
+  // Subsets whose keys collide are told apart by their metadata.
+  cache.getOrCompute(1, v2, host_set, compute);
+  EXPECT_EQ(2U, computed);
+  cache.getOrCompute(1, absl::nullopt, host_set, compute);
+  EXPECT_EQ(3U, computed);
+  EXPECT_EQ(hosts.hosts_, cache.getOrCompute(1, v1, host_set, compute).hosts_);
+  EXPECT_EQ(3U, computed);
+
+  // A membership update replaces the hosts of the host set.
+  update();
+  EXPECT_NE(hosts.hosts_, cache.getOrCompute(1, v1, host_set, compute).hosts_);
+  EXPECT_EQ(4U, computed);
+  cache.getOrCompute(1, v1, host_set, compute);
+  EXPECT_EQ(4U, computed);
+}
+
 } // namespace SubsetLoadBalancerTest
 } // namespace Upstream
 } // namespace Envoy
@@ -1,6 +1,8 @@
 #include <chrono>
 #include <cstdint>
+#include <limits>
 #include <list>
+#include <random>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -1767,6 +1769,96 @@ TEST_F(ClusterInfoImplTest, Metadata) {
   EXPECT_EQ(LoadBalancerType::Maglev, cluster->info()->lbType());
 }
 
+// Per host connection limits are read from per_host_thresholds and checked against the host's
+// active connections.
+TEST_F(ClusterInfoImplTest, PerHostCircuitBreakers) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    circuit_breakers:
+      per_host_thresholds:
+      - priority: DEFAULT
+        max_connections: 2
+  )EOF";
+
+  auto cluster = makeCluster(yaml);
+  EXPECT_EQ(2U,
+            cluster->info()->resourceManager(ResourcePriority::Default).maxConnectionsPerHost());
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(),
+            cluster->info()->resourceManager(ResourcePriority::High).maxConnectionsPerHost());
+
+  HostSharedPtr host = makeTestHost(cluster->info(), "tcp://10.0.0.1:1234");
+  EXPECT_TRUE(host->canCreateConnection(ResourcePriority::Default));
+  host->stats().cx_active_.inc();
+  host->stats().cx_active_.inc();
+  EXPECT_FALSE(host->canCreateConnection(ResourcePriority::Default));
+  EXPECT_TRUE(host->canCreateConnection(ResourcePriority::High));
+  host->stats().cx_active_.dec();
+  EXPECT_TRUE(host->canCreateConnection(ResourcePriority::Default));
+  host->stats().cx_active_.dec();
+}
+
+// A retry budget replaces max_retries for its priority, with the default budget and minimum retry
+// concurrency when they are not specified.
+TEST_F(ClusterInfoImplTest, RetryBudget) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    circuit_breakers:
+      thresholds:
+      - priority: DEFAULT
+        max_retries: 1
+        retry_budget:
+          budget_percent:
+            value: 50
+      - priority: HIGH
+        max_retries: 1
+  )EOF";
+
+  auto cluster = makeCluster(yaml);
+  ResourceManager& default_manager = cluster->info()->resourceManager(ResourcePriority::Default);
+  EXPECT_TRUE(default_manager.hasRetryBudget());
+  EXPECT_EQ(3U, default_manager.retries().max());
+  for (int i = 0; i < 10; i++) {
+    default_manager.requests().inc();
+  }
+  EXPECT_EQ(5U, default_manager.retries().max());
+  default_manager.requests().decBy(10);
+
+  EXPECT_FALSE(cluster->info()->resourceManager(ResourcePriority::High).hasRetryBudget());
+  EXPECT_EQ(1U, cluster->info()->resourceManager(ResourcePriority::High).retries().max());
+}
+
+// With lazy_stats, cluster stats are only created in the store once written.
+TEST_F(ClusterInfoImplTest, LazyStats) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    lazy_stats: true
+  )EOF";
+
+  auto cluster = makeCluster(yaml);
+  EXPECT_EQ(nullptr, TestUtility::findCounter(stats_, "cluster.name.upstream_cx_total"));
+  EXPECT_EQ(nullptr,
+            TestUtility::findGauge(stats_, "cluster.name.circuit_breakers.default.cx_open"));
+  EXPECT_EQ(0U, cluster->info()->stats().upstream_cx_total_.value());
+
+  cluster->info()->stats().upstream_cx_total_.inc();
+  Stats::CounterSharedPtr counter =
+      TestUtility::findCounter(stats_, "cluster.name.upstream_cx_total");
+  ASSERT_NE(nullptr, counter);
+  EXPECT_EQ(1U, counter->value());
+}
+
 // Eds service_name is populated.
 TEST_F(ClusterInfoImplTest, EdsServiceNamePopulation) {
   const std::string yaml = R"EOF(
@@ -2394,6 +2486,30 @@ TEST(OverProvisioningFactorTest, LocalityPickChanges) {
   setUpHostSetWithOPFAndTestPicks(200, 50, 50);
 };
 
+// Test that the latency estimate starts at the first latency and follows the 95th percentile.
+TEST(LatencyEstimatorImplTest, Estimate) {
+  LatencyEstimatorImpl estimator;
+  EXPECT_FALSE(estimator.latencyP95().has_value());
+  estimator.recordLatency(std::chrono::milliseconds(10));
+  EXPECT_EQ(std::chrono::milliseconds(10), estimator.latencyP95().value());
+
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int64_t> latencies(1, 100);
+  for (int i = 0; i < 20000; i++) {
+    estimator.recordLatency(std::chrono::milliseconds(latencies(generator)));
+  }
+  EXPECT_LE(85, estimator.latencyP95().value().count());
+  EXPECT_GE(110, estimator.latencyP95().value().count());
+
+  // The estimate follows the latencies when they change.
+  latencies = std::uniform_int_distribution<int64_t>(1, 1000);
+  for (int i = 0; i < 20000; i++) {
+    estimator.recordLatency(std::chrono::milliseconds(latencies(generator)));
+  }
+  EXPECT_LE(850, estimator.latencyP95().value().count());
+  EXPECT_GE(1100, estimator.latencyP95().value().count());
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
@@ -9,6 +9,8 @@
 #include "extensions/access_loggers/well_known_names.h"
 
 #include "test/mocks/server/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -156,6 +158,59 @@ TEST(FileAccessLogConfigTest, FileAccessLogJsonWithNestedKeyTest) {
   }
 }
 
+TEST(FileAccessLogConfigTest, FileAccessLogProtoTest) {
+  envoy::config::filter::accesslog::v2::AccessLog config;
+  config.set_name(AccessLogNames::get().File);
+  envoy::config::accesslog::v2::FileAccessLog fal_config;
+  fal_config.set_path("/dev/null");
+  fal_config.mutable_proto_format()->add_additional_request_headers_to_log("x-custom");
+
+  EXPECT_EQ(fal_config.access_log_format_case(),
+            envoy::config::accesslog::v2::FileAccessLog::kProtoFormat);
+  MessageUtil::jsonConvert(fal_config, *config.mutable_config());
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  AccessLog::InstanceSharedPtr log = AccessLog::AccessLogFactory::fromProto(config, context);
+  EXPECT_NE(nullptr, log);
+  EXPECT_NE(nullptr, dynamic_cast<FileAccessLog*>(log.get()));
+}
+
+// The records of the proto format can be read back with the length-delimited protobuf framing.
+TEST(FileAccessLogConfigTest, ProtoFormatterWritesDelimitedEntries) {
+  envoy::config::accesslog::v2::FileAccessLog::ProtoFormat config;
+  config.add_additional_request_headers_to_log("x-custom");
+  ProtoFormatter formatter(config);
+
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  stream_info.response_code_ = 200;
+  Http::TestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/"}, {"x-custom", "a"}};
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}};
+  Http::TestHeaderMapImpl response_trailers;
+
+  // Two records appended to existing output.
+  std::string output = "prefix";
+  formatter.formatTo(request_headers, response_headers, response_trailers, stream_info, output);
+  output += formatter.format(request_headers, response_headers, response_trailers, stream_info);
+  ASSERT_EQ(0, output.compare(0, 6, "prefix"));
+
+  Protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t*>(output.data()) + 6,
+                                       output.size() - 6);
+  std::vector<std::string> paths;
+  std::vector<std::string> custom_headers;
+  uint32_t size;
+  while (input.ReadVarint32(&size)) {
+    const Protobuf::io::CodedInputStream::Limit limit = input.PushLimit(size);
+    envoy::data::accesslog::v2::HTTPAccessLogEntry entry;
+    ASSERT_TRUE(entry.ParseFromCodedStream(&input));
+    input.PopLimit(limit);
+    paths.push_back(entry.request().path());
+    custom_headers.push_back(entry.request().request_headers().at("x-custom"));
+    EXPECT_EQ(200, entry.response().response_code().value());
+  }
+  EXPECT_EQ((std::vector<std::string>{"/", "/"}), paths);
+  EXPECT_EQ((std::vector<std::string>{"a", "a"}), custom_headers);
+}
+
 } // namespace
 } // namespace File
 } // namespace AccessLoggers
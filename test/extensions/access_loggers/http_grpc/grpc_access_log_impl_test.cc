@@ -1,10 +1,12 @@
 #include <memory>
 
 #include "common/network/address_impl.h"
+#include "common/stats/isolated_store_impl.h"
 
 #include "extensions/access_loggers/http_grpc/grpc_access_log_impl.h"
 
 #include "test/mocks/access_log/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/grpc/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/ssl/mocks.h"
@@ -110,7 +112,7 @@ TEST_F(GrpcAccessLogStreamerImplTest, StreamFailure) {
 class MockGrpcAccessLogStreamer : public GrpcAccessLogStreamer {
 public:
   // GrpcAccessLogStreamer
-  MOCK_METHOD2(send, void(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
+  MOCK_METHOD2(send, bool(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
                           const std::string& log_name));
 };
 
@@ -119,12 +121,14 @@ public:
   void init() {
     ON_CALL(*filter_, evaluate(_, _, _, _)).WillByDefault(Return(true));
     config_.mutable_common_config()->set_log_name("hello_log");
-    access_log_ =
-        std::make_unique<HttpGrpcAccessLog>(AccessLog::FilterPtr{filter_}, config_, streamer_);
+    access_log_ = std::make_unique<HttpGrpcAccessLog>(AccessLog::FilterPtr{filter_}, config_,
+                                                      streamer_, tls_, stats_store_);
   }
 
   void expectLog(const std::string& expected_request_msg_yaml) {
     if (access_log_ == nullptr) {
+      // Send every log entry in a message of its own.
+      config_.mutable_common_config()->mutable_buffer_size_bytes()->set_value(0);
       init();
     }
 
@@ -135,15 +139,140 @@ public:
             [expected_request_msg](envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
                                    const std::string&) {
               EXPECT_EQ(message.DebugString(), expected_request_msg.DebugString());
+              return true;
             }));
   }
 
+  // Log through a separate access log to find the size of the log entry of the stream info.
+  uint64_t entryBytes(const StreamInfo::StreamInfo& stream_info) {
+    envoy::config::accesslog::v2::HttpGrpcAccessLogConfig config;
+    config.mutable_common_config()->set_log_name("entry_bytes");
+    config.mutable_common_config()->mutable_buffer_size_bytes()->set_value(0);
+    uint64_t entry_bytes = 0;
+    EXPECT_CALL(*streamer_, send(_, "entry_bytes"))
+        .WillOnce(Invoke([&entry_bytes](
+                             envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
+                             const std::string&) {
+          entry_bytes = message.http_logs().log_entry(0).ByteSizeLong();
+          return true;
+        }));
+    Stats::IsolatedStoreImpl stats_store;
+    HttpGrpcAccessLog(AccessLog::FilterPtr{}, config, streamer_, tls_, stats_store)
+        .log(nullptr, nullptr, nullptr, stream_info);
+    return entry_bytes;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("access_logs.grpc_access_log." + name).value();
+  }
+
   AccessLog::MockFilter* filter_{new NiceMock<AccessLog::MockFilter>()};
   envoy::config::accesslog::v2::HttpGrpcAccessLogConfig config_;
   std::shared_ptr<MockGrpcAccessLogStreamer> streamer_{new MockGrpcAccessLogStreamer()};
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Stats::IsolatedStoreImpl stats_store_;
   std::unique_ptr<HttpGrpcAccessLog> access_log_;
 };
 
+// Log entries are batched until the batch reaches the configured number of entries.
+TEST_F(HttpGrpcAccessLogTest, BatchByEntries) {
+  config_.mutable_common_config()->mutable_buffer_size_entries()->set_value(3);
+  init();
+
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  EXPECT_CALL(*streamer_, send(_, _)).Times(0);
+  access_log_->log(nullptr, nullptr, nullptr, stream_info);
+  access_log_->log(nullptr, nullptr, nullptr, stream_info);
+
+  EXPECT_CALL(*streamer_, send(_, "hello_log"))
+      .WillOnce(Invoke(
+          [](envoy::service::accesslog::v2::StreamAccessLogsMessage& message, const std::string&) {
+            EXPECT_EQ(3, message.http_logs().log_entry_size());
+            return true;
+          }));
+  access_log_->log(nullptr, nullptr, nullptr, stream_info);
+  EXPECT_EQ(1, counter("messages_sent"));
+  EXPECT_EQ(3, counter("logs_written"));
+}
+
+// Log entries are batched until the batch reaches the configured size.
+TEST_F(HttpGrpcAccessLogTest, BatchByBytes) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  const uint64_t entry_bytes = entryBytes(stream_info);
+  // A batch is sent by the second entry, whatever the size of the entries.
+  config_.mutable_common_config()->mutable_buffer_size_bytes()->set_value(
+      entry_bytes + 1);
+  init();
+
+  EXPECT_CALL(*streamer_, send(_, _)).Times(0);
+  access_log_->log(nullptr, nullptr, nullptr, stream_info);
+
+  EXPECT_CALL(*streamer_, send(_, "hello_log"))
+      .WillOnce(Invoke(
+          [](envoy::service::accesslog::v2::StreamAccessLogsMessage& message, const std::string&) {
+            EXPECT_EQ(2, message.http_logs().log_entry_size());
+            return true;
+          }));
+  access_log_->log(nullptr, nullptr, nullptr, stream_info);
+  EXPECT_EQ(2, counter("logs_written"));
+}
+
+// The batched log entries are sent by the flush timer.
+TEST_F(HttpGrpcAccessLogTest, BatchFlushedByTimer) {
+  config_.mutable_common_config()->mutable_buffer_flush_interval()->set_seconds(5);
+  auto* timer = new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(5000)));
+  init();
+
+  // Nothing is sent without log entries.
+  EXPECT_CALL(*streamer_, send(_, _)).Times(0);
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(5000)));
+  timer->callback_();
+
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  access_log_->log(nullptr, nullptr, nullptr, stream_info);
+
+  EXPECT_CALL(*streamer_, send(_, "hello_log"))
+      .WillOnce(Invoke(
+          [](envoy::service::accesslog::v2::StreamAccessLogsMessage& message, const std::string&) {
+            EXPECT_EQ(1, message.http_logs().log_entry_size());
+            return true;
+          }));
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(5000)));
+  timer->callback_();
+  EXPECT_EQ(1, counter("logs_written"));
+}
+
+// A batch that could not be sent is kept for the next flush, and the log entries that do not fit
+// in the buffer in the meantime are dropped.
+TEST_F(HttpGrpcAccessLogTest, BatchKeptUntilSentAndOverflowDropped) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  const uint64_t entry_bytes = entryBytes(stream_info);
+  config_.mutable_common_config()->mutable_buffer_size_bytes()->set_value(0);
+  config_.mutable_common_config()->mutable_max_buffered_bytes()->set_value(
+      2 * entry_bytes);
+  auto* timer = new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
+  init();
+
+  EXPECT_CALL(*streamer_, send(_, "hello_log")).Times(2).WillRepeatedly(Return(false));
+  access_log_->log(nullptr, nullptr, nullptr, stream_info);
+  access_log_->log(nullptr, nullptr, nullptr, stream_info);
+  access_log_->log(nullptr, nullptr, nullptr, stream_info);
+  EXPECT_EQ(2, counter("messages_failed"));
+  EXPECT_EQ(1, counter("logs_dropped"));
+  EXPECT_EQ(0, counter("logs_written"));
+
+  EXPECT_CALL(*streamer_, send(_, "hello_log"))
+      .WillOnce(Invoke(
+          [](envoy::service::accesslog::v2::StreamAccessLogsMessage& message, const std::string&) {
+            EXPECT_EQ(2, message.http_logs().log_entry_size());
+            return true;
+          }));
+  timer->callback_();
+  EXPECT_EQ(2, counter("logs_written"));
+  EXPECT_EQ(1, counter("logs_dropped"));
+}
+
 // Test HTTP log marshalling.
 TEST_F(HttpGrpcAccessLogTest, Marshalling) {
   InSequence s;
@@ -478,7 +607,8 @@ TEST(responseFlagsToAccessLogResponseFlagsTest, All) {
   NiceMock<StreamInfo::MockStreamInfo> stream_info;
   ON_CALL(stream_info, hasResponseFlag(_)).WillByDefault(Return(true));
   envoy::data::accesslog::v2::AccessLogCommon common_access_log;
-  HttpGrpcAccessLog::responseFlagsToAccessLogResponseFlags(common_access_log, stream_info);
+  Common::HttpAccessLogEntryBuilder::responseFlagsToAccessLogResponseFlags(common_access_log,
+                                                                          stream_info);
 
   envoy::data::accesslog::v2::AccessLogCommon common_access_log_expected;
   common_access_log_expected.mutable_response_flags()->set_failed_local_healthcheck(true);
@@ -0,0 +1,321 @@
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/common/dynamic_forward_proxy/dns_cache_impl.h"
+#include "extensions/common/dynamic_forward_proxy/dns_cache_manager_impl.h"
+
+#include "test/extensions/common/dynamic_forward_proxy/mocks.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+using testing::_;
+using testing::DoAll;
+using testing::InSequence;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace DynamicForwardProxy {
+namespace {
+
+class DnsCacheImplTest : public testing::Test {
+public:
+  void initialize() {
+    config_.set_name("foo");
+    config_.set_dns_lookup_family(envoy::api::v2::Cluster::V4_ONLY);
+
+    EXPECT_CALL(dispatcher_, createDnsResolver(_)).WillOnce(Return(resolver_));
+    dns_cache_ = std::make_shared<DnsCacheImpl>(dispatcher_, tls_, store_, config_);
+    update_callbacks_handle_ = dns_cache_->addUpdateCallbacks(update_callbacks_);
+  }
+
+  ~DnsCacheImplTest() {
+    dns_cache_.reset();
+    EXPECT_EQ(0, TestUtility::findGauge(store_, "dynamic_forward_proxy.dns_cache.foo.num_hosts")
+                     ->value());
+  }
+
+  // Expect a resolution of the given name, and save its callback.
+  void expectResolve(const std::string& dns_name, Network::DnsResolver::ResolveCb& resolve_cb) {
+    EXPECT_CALL(*resolver_, resolve(dns_name, _, _))
+        .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(store_, "dynamic_forward_proxy.dns_cache.foo." + name)
+        ->value();
+  }
+
+  envoy::config::common::dynamic_forward_proxy::v2alpha::DnsCacheConfig config_;
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  std::shared_ptr<Network::MockDnsResolver> resolver_{std::make_shared<Network::MockDnsResolver>()};
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Stats::IsolatedStoreImpl store_;
+  std::shared_ptr<DnsCache> dns_cache_;
+  MockUpdateCallbacks update_callbacks_;
+  DnsCache::AddUpdateCallbacksHandlePtr update_callbacks_handle_;
+};
+
+MATCHER_P(DnsHostInfoEquals, address, "") {
+  return arg->address() != nullptr && address == arg->address()->asString();
+}
+
+// Basic successful resolution, re-resolution with a new address, and removal on TTL expiry.
+TEST_F(DnsCacheImplTest, ResolveSuccess) {
+  initialize();
+  InSequence s;
+
+  MockLoadDnsCacheEntryCallbacks callbacks;
+  Network::DnsResolver::ResolveCb resolve_cb;
+  Event::MockTimer* refresh_timer = new Event::MockTimer(&dispatcher_);
+  expectResolve("foo.com", resolve_cb);
+  auto result = dns_cache_->loadDnsCacheEntry("foo.com", 80, callbacks);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::Loading, result.status_);
+  EXPECT_NE(result.handle_, nullptr);
+  EXPECT_EQ(1, counter("host_added"));
+
+  EXPECT_CALL(update_callbacks_,
+              onDnsHostAddOrUpdate("foo.com", DnsHostInfoEquals("10.0.0.1:80")));
+  EXPECT_CALL(callbacks, onLoadDnsCacheComplete());
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(60000)));
+  resolve_cb(TestUtility::makeDnsResponse({"10.0.0.1"}));
+
+  // The host is now served from the worker's copy of the cache.
+  result = dns_cache_->loadDnsCacheEntry("foo.com", 80, callbacks);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::InCache, result.status_);
+  EXPECT_EQ(result.handle_, nullptr);
+
+  // Re-resolve with the same address. Nothing is updated.
+  time_system_.sleep(std::chrono::milliseconds(60001));
+  expectResolve("foo.com", resolve_cb);
+  refresh_timer->callback_();
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(60000)));
+  resolve_cb(TestUtility::makeDnsResponse({"10.0.0.1"}));
+
+  // Re-resolve with a new address.
+  time_system_.sleep(std::chrono::milliseconds(60001));
+  expectResolve("foo.com", resolve_cb);
+  refresh_timer->callback_();
+  EXPECT_CALL(update_callbacks_,
+              onDnsHostAddOrUpdate("foo.com", DnsHostInfoEquals("10.0.0.2:80")));
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(60000)));
+  resolve_cb(TestUtility::makeDnsResponse({"10.0.0.2"}));
+  EXPECT_EQ(2, counter("host_address_changed"));
+
+  // The host has not been used for longer than its TTL, so it is removed.
+  time_system_.sleep(std::chrono::milliseconds(300000));
+  EXPECT_CALL(update_callbacks_, onDnsHostRemove("foo.com"));
+  refresh_timer->callback_();
+  EXPECT_EQ(1, counter("host_removed"));
+  EXPECT_EQ(0, TestUtility::findGauge(store_, "dynamic_forward_proxy.dns_cache.foo.num_hosts")
+                   ->value());
+}
+
+// A failed resolution still completes the loads waiting on it. The host stays in the cache without
+// an address until a later resolution succeeds.
+TEST_F(DnsCacheImplTest, ResolveFailure) {
+  initialize();
+  InSequence s;
+
+  MockLoadDnsCacheEntryCallbacks callbacks;
+  Network::DnsResolver::ResolveCb resolve_cb;
+  Event::MockTimer* refresh_timer = new Event::MockTimer(&dispatcher_);
+  expectResolve("foo.com", resolve_cb);
+  auto result = dns_cache_->loadDnsCacheEntry("foo.com", 80, callbacks);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::Loading, result.status_);
+
+  EXPECT_CALL(update_callbacks_, onDnsHostAddOrUpdate(_, _)).Times(0);
+  EXPECT_CALL(callbacks, onLoadDnsCacheComplete());
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(60000)));
+  resolve_cb(TestUtility::makeDnsResponse({}));
+  EXPECT_EQ(1, counter("dns_query_failure"));
+
+  result = dns_cache_->loadDnsCacheEntry("foo.com", 80, callbacks);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::InCache, result.status_);
+
+  expectResolve("foo.com", resolve_cb);
+  refresh_timer->callback_();
+  EXPECT_CALL(update_callbacks_,
+              onDnsHostAddOrUpdate("foo.com", DnsHostInfoEquals("10.0.0.1:80")));
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(60000)));
+  resolve_cb(TestUtility::makeDnsResponse({"10.0.0.1"}));
+}
+
+// Destroying the handle cancels the callback, and destroying the cache cancels the query.
+TEST_F(DnsCacheImplTest, CancelResolve) {
+  initialize();
+
+  MockLoadDnsCacheEntryCallbacks callbacks;
+  Network::DnsResolver::ResolveCb resolve_cb;
+  Event::MockTimer* refresh_timer = new Event::MockTimer(&dispatcher_);
+  expectResolve("foo.com", resolve_cb);
+  auto result = dns_cache_->loadDnsCacheEntry("foo.com", 80, callbacks);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::Loading, result.status_);
+  result.handle_.reset();
+
+  EXPECT_CALL(update_callbacks_,
+              onDnsHostAddOrUpdate("foo.com", DnsHostInfoEquals("10.0.0.1:80")));
+  EXPECT_CALL(callbacks, onLoadDnsCacheComplete()).Times(0);
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(60000)));
+  resolve_cb(TestUtility::makeDnsResponse({"10.0.0.1"}));
+
+  expectResolve("foo.com", resolve_cb);
+  refresh_timer->callback_();
+  EXPECT_CALL(resolver_->active_query_, cancel());
+}
+
+// Concurrent loads of the same host share one resolution.
+TEST_F(DnsCacheImplTest, MultipleResolveSameHost) {
+  initialize();
+
+  MockLoadDnsCacheEntryCallbacks callbacks1;
+  MockLoadDnsCacheEntryCallbacks callbacks2;
+  Network::DnsResolver::ResolveCb resolve_cb;
+  Event::MockTimer* refresh_timer = new Event::MockTimer(&dispatcher_);
+  expectResolve("foo.com", resolve_cb);
+  auto result1 = dns_cache_->loadDnsCacheEntry("foo.com", 80, callbacks1);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::Loading, result1.status_);
+  auto result2 = dns_cache_->loadDnsCacheEntry("foo.com", 80, callbacks2);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::Loading, result2.status_);
+
+  EXPECT_CALL(update_callbacks_,
+              onDnsHostAddOrUpdate("foo.com", DnsHostInfoEquals("10.0.0.1:80")));
+  EXPECT_CALL(callbacks1, onLoadDnsCacheComplete());
+  EXPECT_CALL(callbacks2, onLoadDnsCacheComplete());
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(60000)));
+  resolve_cb(TestUtility::makeDnsResponse({"10.0.0.1"}));
+  EXPECT_EQ(1, counter("dns_query_attempt"));
+}
+
+// Ports embedded in the host are stripped from the resolution and used for the address, while
+// IPv6 literals are resolved without their brackets.
+TEST_F(DnsCacheImplTest, HostWithPort) {
+  initialize();
+
+  MockLoadDnsCacheEntryCallbacks callbacks;
+  Network::DnsResolver::ResolveCb resolve_cb;
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  expectResolve("foo.com", resolve_cb);
+  auto result = dns_cache_->loadDnsCacheEntry("foo.com:8080", 80, callbacks);
+  EXPECT_CALL(update_callbacks_,
+              onDnsHostAddOrUpdate("foo.com:8080", DnsHostInfoEquals("10.0.0.1:8080")));
+  EXPECT_CALL(callbacks, onLoadDnsCacheComplete());
+  resolve_cb(TestUtility::makeDnsResponse({"10.0.0.1"}));
+
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  expectResolve("::1", resolve_cb);
+  result = dns_cache_->loadDnsCacheEntry("[::1]:9000", 80, callbacks);
+  EXPECT_CALL(update_callbacks_,
+              onDnsHostAddOrUpdate("[::1]:9000", DnsHostInfoEquals("[::1]:9000")));
+  EXPECT_CALL(callbacks, onLoadDnsCacheComplete());
+  resolve_cb(TestUtility::makeDnsResponse({"::1"}));
+
+  // An invalid port resolves the whole host, which will very likely fail.
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  expectResolve("foo.com:abc", resolve_cb);
+  result = dns_cache_->loadDnsCacheEntry("foo.com:abc", 80, callbacks);
+  EXPECT_CALL(callbacks, onLoadDnsCacheComplete());
+  resolve_cb(TestUtility::makeDnsResponse({}));
+}
+
+// A full cache evicts its least recently used host, unless all of its hosts are being resolved.
+TEST_F(DnsCacheImplTest, MaxHosts) {
+  config_.mutable_max_hosts()->set_value(2);
+  initialize();
+
+  MockLoadDnsCacheEntryCallbacks callbacks;
+  Network::DnsResolver::ResolveCb foo_resolve_cb;
+  Network::DnsResolver::ResolveCb bar_resolve_cb;
+  Network::DnsResolver::ResolveCb baz_resolve_cb;
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  expectResolve("foo.com", foo_resolve_cb);
+  auto foo_result = dns_cache_->loadDnsCacheEntry("foo.com", 80, callbacks);
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  expectResolve("bar.com", bar_resolve_cb);
+  auto bar_result = dns_cache_->loadDnsCacheEntry("bar.com", 80, callbacks);
+
+  // Both hosts are being resolved, so the new host goes over the limit.
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  expectResolve("baz.com", baz_resolve_cb);
+  auto baz_result = dns_cache_->loadDnsCacheEntry("baz.com", 80, callbacks);
+  EXPECT_EQ(1, counter("host_overflow"));
+
+  EXPECT_CALL(update_callbacks_, onDnsHostAddOrUpdate(_, _)).Times(3);
+  EXPECT_CALL(callbacks, onLoadDnsCacheComplete()).Times(3);
+  foo_resolve_cb(TestUtility::makeDnsResponse({"10.0.0.1"}));
+  time_system_.sleep(std::chrono::milliseconds(1));
+  bar_resolve_cb(TestUtility::makeDnsResponse({"10.0.0.2"}));
+  baz_resolve_cb(TestUtility::makeDnsResponse({"10.0.0.3"}));
+
+  // foo.com was used least recently.
+  time_system_.sleep(std::chrono::milliseconds(1));
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::InCache,
+            dns_cache_->loadDnsCacheEntry("bar.com", 80, callbacks).status_);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::InCache,
+            dns_cache_->loadDnsCacheEntry("baz.com", 80, callbacks).status_);
+  Network::DnsResolver::ResolveCb qux_resolve_cb;
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  EXPECT_CALL(update_callbacks_, onDnsHostRemove("foo.com"));
+  expectResolve("qux.com", qux_resolve_cb);
+  auto qux_result = dns_cache_->loadDnsCacheEntry("qux.com", 80, callbacks);
+  EXPECT_EQ(1, counter("host_evicted"));
+  EXPECT_EQ(1, counter("host_removed"));
+}
+
+// Update callbacks added after a host resolved are told about the host right away.
+TEST_F(DnsCacheImplTest, AddUpdateCallbacksReplaysHosts) {
+  initialize();
+
+  MockLoadDnsCacheEntryCallbacks callbacks;
+  Network::DnsResolver::ResolveCb resolve_cb;
+  new NiceMock<Event::MockTimer>(&dispatcher_);
+  expectResolve("foo.com", resolve_cb);
+  auto result = dns_cache_->loadDnsCacheEntry("foo.com", 80, callbacks);
+  EXPECT_CALL(update_callbacks_, onDnsHostAddOrUpdate("foo.com", _));
+  EXPECT_CALL(callbacks, onLoadDnsCacheComplete());
+  resolve_cb(TestUtility::makeDnsResponse({"10.0.0.1"}));
+
+  MockUpdateCallbacks update_callbacks;
+  EXPECT_CALL(update_callbacks,
+              onDnsHostAddOrUpdate("foo.com", DnsHostInfoEquals("10.0.0.1:80")));
+  auto handle = dns_cache_->addUpdateCallbacks(update_callbacks);
+}
+
+// The manager hands out one cache per name, and rejects a name reused with other settings.
+TEST(DnsCacheManagerImplTest, LoadViaConfig) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  Stats::IsolatedStoreImpl store;
+  DnsCacheManagerImpl cache_manager(dispatcher, tls, store);
+
+  envoy::config::common::dynamic_forward_proxy::v2alpha::DnsCacheConfig config1;
+  config1.set_name("foo");
+
+  DnsCacheSharedPtr cache1 = cache_manager.getCache(config1);
+  EXPECT_NE(cache1, nullptr);
+  EXPECT_EQ(cache1, cache_manager.getCache(config1));
+
+  envoy::config::common::dynamic_forward_proxy::v2alpha::DnsCacheConfig config2;
+  config2.set_name("bar");
+  DnsCacheSharedPtr cache2 = cache_manager.getCache(config2);
+  EXPECT_NE(cache2, nullptr);
+  EXPECT_NE(cache1, cache2);
+
+  envoy::config::common::dynamic_forward_proxy::v2alpha::DnsCacheConfig config3;
+  config3.set_name("foo");
+  config3.set_dns_lookup_family(envoy::api::v2::Cluster::V4_ONLY);
+  EXPECT_THROW_WITH_MESSAGE(cache_manager.getCache(config3), EnvoyException,
+                            "config specified DNS cache 'foo' with different settings");
+}
+
+} // namespace
+} // namespace DynamicForwardProxy
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,36 @@
+#include "test/extensions/common/dynamic_forward_proxy/mocks.h"
+
+using testing::_;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace DynamicForwardProxy {
+
+MockDnsCache::MockDnsCache() {}
+MockDnsCache::~MockDnsCache() {}
+
+MockLoadDnsCacheEntryHandle::MockLoadDnsCacheEntryHandle() {}
+MockLoadDnsCacheEntryHandle::~MockLoadDnsCacheEntryHandle() { onDestroy(); }
+
+MockDnsCacheManager::MockDnsCacheManager() {
+  ON_CALL(*this, getCache(_)).WillByDefault(Return(dns_cache_));
+}
+MockDnsCacheManager::~MockDnsCacheManager() {}
+
+MockDnsCacheManagerFactory::MockDnsCacheManagerFactory() {
+  ON_CALL(*this, get()).WillByDefault(Return(dns_cache_manager_));
+}
+MockDnsCacheManagerFactory::~MockDnsCacheManagerFactory() {}
+
+MockLoadDnsCacheEntryCallbacks::MockLoadDnsCacheEntryCallbacks() {}
+MockLoadDnsCacheEntryCallbacks::~MockLoadDnsCacheEntryCallbacks() {}
+
+MockUpdateCallbacks::MockUpdateCallbacks() {}
+MockUpdateCallbacks::~MockUpdateCallbacks() {}
+
+} // namespace DynamicForwardProxy
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
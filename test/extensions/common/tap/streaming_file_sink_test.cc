@@ -0,0 +1,132 @@
+#include <unistd.h>
+
+#include "envoy/common/exception.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/common/tap/streaming_file_sink.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace Tap {
+namespace {
+
+TEST(RingBuffer, PushAndDrain) {
+  RingBuffer ring_buffer(8);
+  std::string output;
+  ring_buffer.drain(output);
+  EXPECT_EQ("", output);
+
+  EXPECT_TRUE(ring_buffer.push("abc"));
+  EXPECT_TRUE(ring_buffer.push("defgh"));
+  // The ring buffer is full, and the record is dropped whole.
+  EXPECT_FALSE(ring_buffer.push("i"));
+  EXPECT_EQ(1, ring_buffer.dropped());
+  ring_buffer.drain(output);
+  EXPECT_EQ("abcdefgh", output);
+
+  // The records wrap around the end of the storage.
+  output.clear();
+  EXPECT_TRUE(ring_buffer.push("123"));
+  ring_buffer.drain(output);
+  EXPECT_TRUE(ring_buffer.push("4567890"));
+  EXPECT_FALSE(ring_buffer.push("ab"));
+  ring_buffer.drain(output);
+  EXPECT_EQ("1234567890", output);
+  EXPECT_EQ(2, ring_buffer.dropped());
+}
+
+class StreamingFileSinkTest : public testing::Test {
+public:
+  envoy::service::tap::v2alpha::StreamingFileSink config(uint32_t ring_buffer_bytes) {
+    envoy::service::tap::v2alpha::StreamingFileSink config;
+    config.set_path(path_);
+    config.mutable_ring_buffer_bytes()->set_value(ring_buffer_bytes);
+    return config;
+  }
+
+  TraceWrapperSharedPtr makeTrace(uint64_t trace_id, const std::string& body) {
+    TraceWrapperSharedPtr trace = makeTraceWrapper();
+    trace->mutable_http_streamed_trace_segment()->set_trace_id(trace_id);
+    trace->mutable_http_streamed_trace_segment()->mutable_request_body_chunk()->set_as_bytes(body);
+    return trace;
+  }
+
+  const std::string path_{TestEnvironment::temporaryPath("streaming_file_sink_test.pb_text")};
+};
+
+TEST_F(StreamingFileSinkTest, WriteTraces) {
+  ::unlink(path_.c_str());
+  {
+    StreamingFileSink sink(config(4096), envoy::service::tap::v2alpha::OutputSink::PROTO_TEXT,
+                           Thread::threadFactoryForTest());
+    PerTapSinkHandlePtr handle = sink.createPerTapSinkHandle(1);
+    handle->submitTrace(makeTrace(1, "hello"),
+                        envoy::service::tap::v2alpha::OutputSink::PROTO_TEXT);
+    handle->submitTrace(makeTrace(1, "world"),
+                        envoy::service::tap::v2alpha::OutputSink::PROTO_TEXT);
+    EXPECT_EQ(0, sink.droppedTraces());
+  }
+
+  // The sink drains its ring buffers when it is destroyed.
+  EXPECT_EQ(makeTrace(1, "hello")->DebugString() + makeTrace(1, "world")->DebugString(),
+            TestEnvironment::readFileToStringForTest(path_));
+}
+
+TEST_F(StreamingFileSinkTest, DropTracesOverRingBufferCapacity) {
+  ::unlink(path_.c_str());
+  {
+    StreamingFileSink sink(config(1024), envoy::service::tap::v2alpha::OutputSink::PROTO_TEXT,
+                           Thread::threadFactoryForTest());
+    PerTapSinkHandlePtr handle = sink.createPerTapSinkHandle(1);
+    handle->submitTrace(makeTrace(1, std::string(2048, 'a')),
+                        envoy::service::tap::v2alpha::OutputSink::PROTO_TEXT);
+    handle->submitTrace(makeTrace(1, "hello"),
+                        envoy::service::tap::v2alpha::OutputSink::PROTO_TEXT);
+    EXPECT_EQ(1, sink.droppedTraces());
+  }
+
+  EXPECT_EQ(makeTrace(1, "hello")->DebugString(), TestEnvironment::readFileToStringForTest(path_));
+}
+
+TEST_F(StreamingFileSinkTest, LengthDelimitedTraces) {
+  ::unlink(path_.c_str());
+  {
+    StreamingFileSink sink(
+        config(4096), envoy::service::tap::v2alpha::OutputSink::PROTO_BINARY_LENGTH_DELIMITED,
+        Thread::threadFactoryForTest());
+    sink.createPerTapSinkHandle(1)->submitTrace(
+        makeTrace(1, "hello"),
+        envoy::service::tap::v2alpha::OutputSink::PROTO_BINARY_LENGTH_DELIMITED);
+  }
+
+  const std::string output = TestEnvironment::readFileToStringForTest(path_);
+  Protobuf::io::ArrayInputStream stream(output.data(), output.size());
+  Protobuf::io::CodedInputStream coded_stream(&stream);
+  uint32_t length;
+  ASSERT_TRUE(coded_stream.ReadVarint32(&length));
+  std::string message;
+  ASSERT_TRUE(coded_stream.ReadString(&message, length));
+  envoy::data::tap::v2alpha::TraceWrapper trace;
+  ASSERT_TRUE(trace.ParseFromString(message));
+  EXPECT_EQ("hello", trace.http_streamed_trace_segment().request_body_chunk().as_bytes());
+}
+
+TEST_F(StreamingFileSinkTest, RejectProtoBinary) {
+  EXPECT_THROW_WITH_MESSAGE(
+      StreamingFileSink(config(4096), envoy::service::tap::v2alpha::OutputSink::PROTO_BINARY,
+                        Thread::threadFactoryForTest()),
+      EnvoyException, "streaming file tap sink does not support the PROTO_BINARY format");
+}
+
+} // namespace
+} // namespace Tap
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
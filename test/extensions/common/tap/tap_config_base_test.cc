@@ -1,4 +1,5 @@
 #include "common/buffer/buffer_impl.h"
+#include "common/protobuf/utility.h"
 
 #include "extensions/common/tap/tap_config_base.h"
 
@@ -157,6 +158,45 @@ TEST(TrimSlice, All) {
   }
 }
 
+class TestTapConfig : public TapConfigBaseImpl {
+public:
+  TestTapConfig(envoy::service::tap::v2alpha::TapConfig&& proto_config)
+      : TapConfigBaseImpl(std::move(proto_config), nullptr) {}
+};
+
+TEST(TapConfigBaseImpl, Sampling) {
+  const std::string yaml = R"EOF(
+match_config:
+  any_match: true
+output_config:
+  sinks:
+    - file_per_tap:
+        path_prefix: /dev/null
+)EOF";
+
+  {
+    envoy::service::tap::v2alpha::TapConfig proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+    TestTapConfig config(std::move(proto_config));
+    EXPECT_TRUE(config.sampled(0));
+    EXPECT_TRUE(config.sampled(99));
+  }
+
+  {
+    envoy::service::tap::v2alpha::TapConfig proto_config;
+    MessageUtil::loadFromYaml(yaml + R"EOF(
+sampling:
+  numerator: 10
+)EOF",
+                              proto_config);
+    TestTapConfig config(std::move(proto_config));
+    EXPECT_TRUE(config.sampled(9));
+    EXPECT_FALSE(config.sampled(10));
+    EXPECT_TRUE(config.sampled(105));
+    EXPECT_FALSE(config.sampled(199));
+  }
+}
+
 } // namespace
 } // namespace Tap
 } // namespace Common
@@ -0,0 +1,64 @@
+#include "envoy/config/compressor/gzip/v2alpha/gzip.pb.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/config/utility.h"
+#include "common/decompressor/zlib_decompressor_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/compressors/gzip/config.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace Compressors {
+namespace Gzip {
+namespace {
+
+// The library is registered and its compressors produce gzip streams.
+TEST(GzipCompressorLibraryFactoryTest, CreateCompressor) {
+  auto& factory =
+      Config::Utility::getAndCheckFactory<Compressor::NamedCompressorLibraryConfigFactory>(
+          "envoy.compressors.gzip");
+  envoy::config::compressor::gzip::v2alpha::Gzip config;
+  config.mutable_window_bits()->set_value(15);
+  config.set_compression_strategy(
+      envoy::config::compressor::gzip::v2alpha::Gzip_CompressionStrategy_HUFFMAN);
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  Compressor::CompressorFactoryPtr compressor_factory =
+      factory.createCompressorFactoryFromProto(config, context);
+  EXPECT_EQ("gzip", compressor_factory->contentEncoding());
+
+  for (uint32_t i = 0; i < 2; i++) {
+    Compressor::CompressorPtr compressor = compressor_factory->createCompressor();
+    Buffer::OwnedImpl data;
+    TestUtility::feedBufferWithRandomCharacters(data, 4096);
+    const std::string expected = data.toString();
+    compressor->compress(data, Compressor::State::Finish);
+    Decompressor::ZlibDecompressorImpl decompressor;
+    decompressor.init(31);
+    Buffer::OwnedImpl decompressed;
+    decompressor.decompress(data, decompressed);
+    EXPECT_EQ(expected, decompressed.toString());
+  }
+}
+
+// Invalid configurations are rejected.
+TEST(GzipCompressorLibraryFactoryTest, InvalidConfig) {
+  GzipCompressorLibraryFactory factory;
+  envoy::config::compressor::gzip::v2alpha::Gzip config;
+  config.mutable_memory_level()->set_value(10);
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  EXPECT_THROW(factory.createCompressorFactoryFromProto(config, context), ProtoValidationException);
+}
+
+} // namespace
+} // namespace Gzip
+} // namespace Compressors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,64 @@
+#include "envoy/config/decompressor/gzip/v2alpha/gzip.pb.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/compressor/zlib_compressor_impl.h"
+#include "common/config/utility.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/decompressors/gzip/config.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace Decompressors {
+namespace Gzip {
+namespace {
+
+// The library is registered and its decompressors decode gzip streams.
+TEST(GzipDecompressorLibraryFactoryTest, CreateDecompressor) {
+  auto& factory =
+      Config::Utility::getAndCheckFactory<Decompressor::NamedDecompressorLibraryConfigFactory>(
+          "envoy.decompressors.gzip");
+  envoy::config::decompressor::gzip::v2alpha::Gzip config;
+  config.mutable_chunk_size()->set_value(8192);
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  Decompressor::DecompressorFactoryPtr decompressor_factory =
+      factory.createDecompressorFactoryFromProto(config, context);
+  EXPECT_EQ("gzip", decompressor_factory->contentEncoding());
+
+  for (uint32_t i = 0; i < 2; i++) {
+    Buffer::OwnedImpl data;
+    TestUtility::feedBufferWithRandomCharacters(data, 4096);
+    const std::string expected = data.toString();
+    Compressor::ZlibCompressorImpl compressor;
+    compressor.init(Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+                    Compressor::ZlibCompressorImpl::CompressionStrategy::Standard, 31, 8);
+    compressor.compress(data, Compressor::State::Finish);
+    Decompressor::DecompressorPtr decompressor = decompressor_factory->createDecompressor();
+    Buffer::OwnedImpl decompressed;
+    EXPECT_TRUE(decompressor->decompress(data, decompressed, 4096));
+    EXPECT_EQ(expected, decompressed.toString());
+  }
+}
+
+// Invalid configurations are rejected.
+TEST(GzipDecompressorLibraryFactoryTest, InvalidConfig) {
+  GzipDecompressorLibraryFactory factory;
+  envoy::config::decompressor::gzip::v2alpha::Gzip config;
+  config.mutable_window_bits()->set_value(16);
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  EXPECT_THROW(factory.createDecompressorFactoryFromProto(config, context),
+               ProtoValidationException);
+}
+
+} // namespace
+} // namespace Gzip
+} // namespace Decompressors
+} // namespace Extensions
+} // namespace Envoy
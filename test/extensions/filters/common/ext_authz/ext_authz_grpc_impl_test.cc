@@ -111,6 +111,27 @@ TEST_P(ExtAuthzGrpcClientTest, AuthorizationOkWithAllAtributes) {
   client_->onSuccess(std::move(check_response), span_);
 }
 
+// Test that the cache TTL of an ok response is passed to the callbacks.
+TEST_P(ExtAuthzGrpcClientTest, AuthorizationOkWithCacheTtl) {
+  initialize(GetParam());
+
+  auto check_response = std::make_unique<envoy::service::auth::v2::CheckResponse>();
+  check_response->mutable_status()->set_code(Grpc::Status::GrpcStatus::Ok);
+  check_response->mutable_cache_ttl()->set_seconds(30);
+
+  envoy::service::auth::v2::CheckRequest request;
+  expectCallSend(request);
+  client_->check(request_callbacks_, request, Tracing::NullSpan::instance());
+
+  EXPECT_CALL(span_, setTag("ext_authz_status", "ext_authz_ok"));
+  EXPECT_CALL(request_callbacks_, onComplete_(_))
+      .WillOnce(Invoke([](ResponsePtr& response) -> void {
+        EXPECT_EQ(CheckStatus::OK, response->status);
+        EXPECT_EQ(std::chrono::milliseconds(30000), response->cache_ttl);
+      }));
+  client_->onSuccess(std::move(check_response), span_);
+}
+
 // Test the client when a denied response is received.
 TEST_P(ExtAuthzGrpcClientTest, AuthorizationDenied) {
   initialize(GetParam());
@@ -278,6 +278,30 @@ TEST_F(ExtAuthzHttpClientTest, AuthorizationOkWithAllowHeader) {
   client_.onSuccess(std::move(message_response));
 }
 
+// Verify that the max-age directive of a Cache-Control header sets the TTL of an OK response, and
+// that no-cache and no-store prevent caching it.
+TEST_F(ExtAuthzHttpClientTest, AuthorizationOkWithCacheControl) {
+  const auto expect_cache_ttl = [this](const std::string& cache_control,
+                                       absl::optional<std::chrono::milliseconds> expected) {
+    envoy::service::auth::v2::CheckRequest request;
+    client_.check(request_callbacks_, request, Tracing::NullSpan::instance());
+    EXPECT_CALL(request_callbacks_, onComplete_(_))
+        .WillOnce(Invoke([&expected](ResponsePtr& response) -> void {
+          EXPECT_EQ(CheckStatus::OK, response->status);
+          EXPECT_EQ(expected, response->cache_ttl);
+        }));
+    client_.onSuccess(TestCommon::makeMessageResponse(TestCommon::makeHeaderValueOption(
+        {{":status", "200", false}, {"cache-control", cache_control, false}})));
+  };
+
+  expect_cache_ttl("max-age=60", std::chrono::seconds(60));
+  expect_cache_ttl("private, Max-Age=5", std::chrono::seconds(5));
+  expect_cache_ttl("max-age=60, no-cache", std::chrono::seconds(0));
+  expect_cache_ttl("no-store", std::chrono::seconds(0));
+  expect_cache_ttl("private", absl::nullopt);
+  expect_cache_ttl("max-age=foo", absl::nullopt);
+}
+
 // Test the client when a denied response is received.
 TEST_F(ExtAuthzHttpClientTest, AuthorizationDenied) {
   const auto expected_headers = TestCommon::makeHeaderValueOption({{":status", "403", false}});
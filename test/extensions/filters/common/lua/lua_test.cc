@@ -3,6 +3,7 @@
 #include "extensions/filters/common/lua/lua.h"
 
 #include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/utility.h"
 
@@ -39,7 +40,7 @@ public:
   LuaTest() : yield_callback_([this]() { on_yield_.ready(); }) {}
 
   void setup(const std::string& code) {
-    state_ = std::make_unique<ThreadLocalState>(code, tls_);
+    state_ = std::make_unique<ThreadLocalState>(code, tls_, 0);
     state_->registerType<TestObject>();
   }
 
@@ -155,6 +156,40 @@ TEST_F(LuaTest, MarkDead) {
   lua_gc(cr1->luaState(), LUA_GCCOLLECT, 0);
 }
 
+// Incremental GC steps run on the dispatcher, and the steps scheduled before they run coalesce.
+TEST_F(LuaTest, GCStep) {
+  const std::string SCRIPT{R"EOF(
+    function garbage()
+      for i = 1, 1000 do
+        local t = {i}
+      end
+    end
+  )EOF"};
+
+  Event::MockTimer* timer = new Event::MockTimer(&tls_.dispatcher_);
+  state_ = std::make_unique<ThreadLocalState>(SCRIPT, tls_, 1);
+
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(0)));
+  state_->scheduleGCStep();
+  state_->scheduleGCStep();
+
+  CoroutinePtr cr(state_->createCoroutine());
+  cr->start(state_->getGlobalRef(state_->registerGlobal("garbage")), 0, yield_callback_);
+  const uint64_t bytes_used = state_->runtimeBytesUsed();
+  timer->invokeCallback();
+  EXPECT_GE(bytes_used, state_->runtimeBytesUsed());
+
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(0)));
+  state_->scheduleGCStep();
+}
+
+// Without a step size, no GC steps are scheduled.
+TEST_F(LuaTest, NoGCStep) {
+  EXPECT_CALL(tls_.dispatcher_, createTimer_(_)).Times(0);
+  setup("function callMe() end");
+  state_->scheduleGCStep();
+}
+
 } // namespace
 } // namespace Lua
 } // namespace Common
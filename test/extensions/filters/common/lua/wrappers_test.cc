@@ -85,6 +85,30 @@ TEST_F(LuaBufferWrapperTest, Methods) {
   start("callMe");
 }
 
+// Buffer wrapper getBytes() call within and across slices.
+TEST_F(LuaBufferWrapperTest, GetBytesSlices) {
+  const std::string SCRIPT{R"EOF(
+    function callMe(object)
+      testPrint(object:getBytes(0, 5))
+      testPrint(object:getBytes(7, 4))
+      testPrint(object:getBytes(3, 6))
+      testPrint(object:getBytes(11, 0))
+    end
+  )EOF"};
+
+  setup(SCRIPT);
+  Buffer::OwnedImpl data("hello ");
+  Buffer::BufferFragmentImpl fragment("world", 5, [](const void*, size_t,
+                                                     const Buffer::BufferFragmentImpl*) {});
+  data.addBufferFragment(fragment);
+  BufferWrapper::create(coroutine_->luaState(), data);
+  EXPECT_CALL(*this, testPrint("hello"));
+  EXPECT_CALL(*this, testPrint("orld"));
+  EXPECT_CALL(*this, testPrint("lo wor"));
+  EXPECT_CALL(*this, testPrint(""));
+  start("callMe");
+}
+
 // Invalid params for the buffer wrapper getBytes() call.
 TEST_F(LuaBufferWrapperTest, GetBytesInvalidParams) {
   const std::string SCRIPT{R"EOF(
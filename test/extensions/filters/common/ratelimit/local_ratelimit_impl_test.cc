@@ -0,0 +1,157 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/stats/isolated_store_impl.h"
+#include "common/tracing/http_tracer_impl.h"
+
+#include "extensions/filters/common/ratelimit/local_ratelimit_impl.h"
+
+#include "test/extensions/filters/common/ratelimit/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NotNull;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+namespace {
+
+class MockRequestCallbacks : public RequestCallbacks {
+public:
+  void complete(LimitStatus status, Http::HeaderMapPtr&& headers) {
+    complete_(status, headers.get());
+  }
+
+  MOCK_METHOD2(complete_, void(LimitStatus status, const Http::HeaderMap* headers));
+};
+
+class LocalRateLimitTest : public testing::Test {
+public:
+  void initialize(const std::string& yaml) {
+    envoy::config::common::ratelimit::v2alpha::LocalRateLimit config;
+    MessageUtil::loadFromYaml(yaml, config);
+    limiter_ = std::make_shared<LocalRateLimiter>(config, time_system_, "local.", stats_store_);
+  }
+
+  LocalLimitStatus consume(const std::vector<Envoy::RateLimit::Descriptor>& descriptors) {
+    return limiter_->consume(descriptors);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl stats_store_;
+  LocalRateLimiterSharedPtr limiter_;
+};
+
+const std::string TwoLimits = R"EOF(
+limits:
+- entries:
+  - key: path
+    value: /foo
+  max_tokens: 2
+  tokens_per_fill: 1
+  fill_interval: 1s
+- entries:
+  - key: remote_address
+  max_tokens: 1
+  fill_interval: 10s
+)EOF";
+
+// Test that matching descriptors take tokens until their bucket is empty, and that the bucket
+// fills again over time.
+TEST_F(LocalRateLimitTest, TokenBucket) {
+  initialize(TwoLimits);
+  const std::vector<Envoy::RateLimit::Descriptor> descriptors{{{{"path", "/foo"}}}};
+  EXPECT_EQ(LocalLimitStatus::OK, consume(descriptors));
+  EXPECT_EQ(LocalLimitStatus::OK, consume(descriptors));
+  EXPECT_EQ(LocalLimitStatus::OverLimit, consume(descriptors));
+  time_system_.sleep(std::chrono::seconds(1));
+  EXPECT_EQ(LocalLimitStatus::OK, consume(descriptors));
+  EXPECT_EQ(LocalLimitStatus::OverLimit, consume(descriptors));
+}
+
+// Test that descriptors only match limits with the same keys and values, and that limits without
+// a value have a bucket per value.
+TEST_F(LocalRateLimitTest, Match) {
+  initialize(TwoLimits);
+  EXPECT_EQ(LocalLimitStatus::NoMatch, consume({{{{"path", "/bar"}}}}));
+  EXPECT_EQ(LocalLimitStatus::NoMatch, consume({{{{"path", "/foo"}, {"method", "GET"}}}}));
+  EXPECT_EQ(LocalLimitStatus::NoMatch, consume({}));
+
+  EXPECT_EQ(LocalLimitStatus::OK, consume({{{{"remote_address", "10.0.0.1"}}}}));
+  EXPECT_EQ(LocalLimitStatus::OverLimit, consume({{{{"remote_address", "10.0.0.1"}}}}));
+  EXPECT_EQ(LocalLimitStatus::OK, consume({{{{"remote_address", "10.0.0.2"}}}}));
+
+  // A request is over limit if any of its descriptors is.
+  EXPECT_EQ(LocalLimitStatus::OverLimit,
+            consume({{{{"path", "/foo"}}}, {{{"remote_address", "10.0.0.1"}}}}));
+}
+
+// Test that the least recently used bucket is removed when there are too many.
+TEST_F(LocalRateLimitTest, MaxBuckets) {
+  initialize(TwoLimits + "max_buckets: 2\n");
+  EXPECT_EQ(LocalLimitStatus::OK, consume({{{{"remote_address", "10.0.0.1"}}}}));
+  EXPECT_EQ(LocalLimitStatus::OK, consume({{{{"remote_address", "10.0.0.2"}}}}));
+  EXPECT_EQ(LocalLimitStatus::OverLimit, consume({{{{"remote_address", "10.0.0.1"}}}}));
+  EXPECT_EQ(LocalLimitStatus::OK, consume({{{{"remote_address", "10.0.0.3"}}}}));
+  // The bucket of 10.0.0.2 was removed, and its new bucket is full.
+  EXPECT_EQ(LocalLimitStatus::OK, consume({{{{"remote_address", "10.0.0.2"}}}}));
+  EXPECT_EQ(LocalLimitStatus::OverLimit, consume({{{{"remote_address", "10.0.0.3"}}}}));
+}
+
+// Test that the local client decides locally without a global client.
+TEST_F(LocalRateLimitTest, LocalClient) {
+  initialize(TwoLimits);
+  LocalClientImpl client(limiter_, nullptr);
+  MockRequestCallbacks callbacks;
+  const std::vector<Envoy::RateLimit::Descriptor> descriptors{{{{"remote_address", "10.0.0.1"}}}};
+
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OK, NotNull()));
+  client.limit(callbacks, "foo", descriptors, Tracing::NullSpan::instance());
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OverLimit, NotNull()));
+  client.limit(callbacks, "foo", descriptors, Tracing::NullSpan::instance());
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OK, NotNull()));
+  client.limit(callbacks, "foo", {{{{"path", "/bar"}}}}, Tracing::NullSpan::instance());
+
+  EXPECT_EQ(2U, stats_store_.counter("local.ok").value());
+  EXPECT_EQ(1U, stats_store_.counter("local.over_limit").value());
+  EXPECT_EQ(0U, stats_store_.counter("local.forwarded").value());
+}
+
+// Test that the local client forwards the requests that the local limits don't allow to the
+// global client.
+TEST_F(LocalRateLimitTest, PreFilter) {
+  initialize(TwoLimits);
+  auto* global_client = new MockClient();
+  LocalClientImpl client(limiter_, ClientPtr{global_client});
+  MockRequestCallbacks callbacks;
+  const std::vector<Envoy::RateLimit::Descriptor> descriptors{{{{"remote_address", "10.0.0.1"}}}};
+
+  EXPECT_CALL(callbacks, complete_(LimitStatus::OK, NotNull()));
+  client.limit(callbacks, "foo", descriptors, Tracing::NullSpan::instance());
+
+  EXPECT_CALL(*global_client, limit(_, "foo", _, _)).Times(2);
+  client.limit(callbacks, "foo", descriptors, Tracing::NullSpan::instance());
+  client.limit(callbacks, "foo", {{{{"path", "/bar"}}}}, Tracing::NullSpan::instance());
+  EXPECT_CALL(*global_client, cancel());
+  client.cancel();
+
+  EXPECT_EQ(1U, stats_store_.counter("local.ok").value());
+  EXPECT_EQ(0U, stats_store_.counter("local.over_limit").value());
+  EXPECT_EQ(2U, stats_store_.counter("local.forwarded").value());
+}
+
+} // namespace
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -7,11 +7,15 @@
 
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
+#include "common/stats/isolated_store_impl.h"
 #include "common/tracing/http_tracer_impl.h"
 
 #include "extensions/filters/common/ratelimit/ratelimit_impl.h"
 
+#include "test/extensions/filters/common/ratelimit/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/grpc/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
@@ -21,7 +25,10 @@
 
 using testing::_;
 using testing::AtLeast;
+using testing::DoAll;
 using testing::Invoke;
+using testing::NiceMock;
+using testing::NotNull;
 using testing::Ref;
 using testing::Return;
 using testing::WithArg;
@@ -133,6 +140,142 @@ TEST_F(RateLimitGrpcClientTest, Cancel) {
   client_.cancel();
 }
 
+class RateLimitAggregationTest : public testing::Test {
+public:
+  RateLimitAggregationTest()
+      : flush_async_client_(new Grpc::MockAsyncClient()),
+        flush_timer_(new NiceMock<Event::MockTimer>(&tls_.dispatcher_)) {
+    auto* async_client_factory = new Grpc::MockAsyncClientFactory();
+    EXPECT_CALL(*async_client_factory, create()).WillOnce(Invoke([this]() -> Grpc::AsyncClientPtr {
+      return Grpc::AsyncClientPtr{flush_async_client_};
+    }));
+    aggregator_ = std::make_shared<Aggregator>(
+        Grpc::AsyncClientFactoryPtr{async_client_factory}, std::chrono::milliseconds(100),
+        std::chrono::milliseconds(20), tls_, "aggregation.", stats_store_);
+    client_ = new MockClient();
+    aggregating_client_ = std::make_unique<AggregatingClientImpl>(aggregator_, ClientPtr{client_});
+  }
+
+  // Send a request that the aggregator doesn't decide, and complete it with the status.
+  void limitByClient(LimitStatus status) {
+    RequestCallbacks* client_callbacks{};
+    EXPECT_CALL(*client_, limit(_, "foo", _, _)).WillOnce(WithArg<0>(Invoke(
+        [&client_callbacks](RequestCallbacks& callbacks) { client_callbacks = &callbacks; })));
+    aggregating_client_->limit(request_callbacks_, "foo", descriptors_,
+                               Tracing::NullSpan::instance());
+    ASSERT_NE(nullptr, client_callbacks);
+
+    EXPECT_CALL(request_callbacks_, complete_(status, NotNull()));
+    client_callbacks->complete(status, std::make_unique<Http::HeaderMapImpl>());
+  }
+
+  // Flush the aggregated hits and expect one report carrying them.
+  Grpc::AsyncRequestCallbacks* flush(uint32_t hits) {
+    envoy::service::ratelimit::v2::RateLimitRequest request;
+    GrpcClientImpl::createRequest(request, "foo", descriptors_);
+    request.set_hits_addend(hits);
+    Grpc::AsyncRequestCallbacks* callbacks{};
+    EXPECT_CALL(*flush_async_client_, send(_, ProtoEq(request), _, _, _))
+        .WillOnce(DoAll(WithArg<2>(Invoke([&callbacks](Grpc::AsyncRequestCallbacks& c) {
+                          callbacks = &c;
+                        })),
+                        Return(&async_request_)));
+    flush_timer_->invokeCallback();
+    return callbacks;
+  }
+
+  const std::vector<Envoy::RateLimit::Descriptor> descriptors_{{{{"foo", "bar"}}}};
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Stats::IsolatedStoreImpl stats_store_;
+  Grpc::MockAsyncClient* flush_async_client_;
+  Event::MockTimer* flush_timer_;
+  Grpc::MockAsyncRequest async_request_;
+  MockClient* client_;
+  MockRequestCallbacks request_callbacks_;
+  AggregatorSharedPtr aggregator_;
+  std::unique_ptr<AggregatingClientImpl> aggregating_client_;
+};
+
+// Test that once a status is known, requests are decided on it and their hits are reported
+// together.
+TEST_F(RateLimitAggregationTest, Aggregate) {
+  // The timer is enabled by the first status, and after each report.
+  EXPECT_CALL(*flush_timer_, enableTimer(std::chrono::milliseconds(100))).Times(3);
+  limitByClient(LimitStatus::OK);
+
+  EXPECT_CALL(*client_, limit(_, _, _, _)).Times(0);
+  EXPECT_CALL(request_callbacks_, complete_(LimitStatus::OK, NotNull())).Times(2);
+  aggregating_client_->limit(request_callbacks_, "foo", descriptors_,
+                             Tracing::NullSpan::instance());
+  aggregating_client_->limit(request_callbacks_, "foo", descriptors_,
+                             Tracing::NullSpan::instance());
+  EXPECT_EQ(2U, stats_store_.counter("aggregation.aggregated").value());
+
+  Grpc::AsyncRequestCallbacks* callbacks = flush(2);
+  ASSERT_NE(nullptr, callbacks);
+
+  // The status returned by the report decides the next requests.
+  auto response = std::make_unique<envoy::service::ratelimit::v2::RateLimitResponse>();
+  response->set_overall_code(envoy::service::ratelimit::v2::RateLimitResponse_Code_OVER_LIMIT);
+  auto* header = response->add_headers();
+  header->set_key("x-ratelimit");
+  header->set_value("over");
+  callbacks->onSuccessUntyped(std::move(response), Tracing::NullSpan::instance());
+  EXPECT_EQ(1U, stats_store_.counter("aggregation.flushed").value());
+
+  EXPECT_CALL(request_callbacks_, complete_(LimitStatus::OverLimit, NotNull()))
+      .WillOnce(Invoke([](LimitStatus, const Http::HeaderMap* headers) {
+        EXPECT_EQ("over",
+                  headers->get(Http::LowerCaseString("x-ratelimit"))->value().getStringView());
+      }));
+  aggregating_client_->limit(request_callbacks_, "foo", descriptors_,
+                             Tracing::NullSpan::instance());
+
+  // A report still in flight when the aggregation is destroyed is cancelled.
+  flush(1);
+  EXPECT_CALL(async_request_, cancel());
+}
+
+// Test that a status without hits for a whole window is forgotten.
+TEST_F(RateLimitAggregationTest, Idle) {
+  limitByClient(LimitStatus::OverLimit);
+
+  EXPECT_CALL(*flush_async_client_, send(_, _, _, _, _)).Times(0);
+  flush_timer_->invokeCallback();
+  EXPECT_FALSE(flush_timer_->enabled_);
+
+  limitByClient(LimitStatus::OK);
+  EXPECT_EQ(0U, stats_store_.counter("aggregation.aggregated").value());
+}
+
+// Test that a failed report makes the next requests go to the rate limit service again.
+TEST_F(RateLimitAggregationTest, FlushFailure) {
+  limitByClient(LimitStatus::OK);
+  EXPECT_CALL(request_callbacks_, complete_(LimitStatus::OK, NotNull()));
+  aggregating_client_->limit(request_callbacks_, "foo", descriptors_,
+                             Tracing::NullSpan::instance());
+
+  Grpc::AsyncRequestCallbacks* callbacks = flush(1);
+  ASSERT_NE(nullptr, callbacks);
+  callbacks->onFailure(Grpc::Status::Unavailable, "", Tracing::NullSpan::instance());
+  EXPECT_EQ(1U, stats_store_.counter("aggregation.flush_error").value());
+
+  limitByClient(LimitStatus::OK);
+}
+
+// Test that errors of the rate limit service aren't aggregated, and that requests sent to it can
+// be cancelled.
+TEST_F(RateLimitAggregationTest, ErrorAndCancel) {
+  limitByClient(LimitStatus::Error);
+  limitByClient(LimitStatus::Error);
+
+  EXPECT_CALL(*client_, limit(_, "foo", _, _));
+  aggregating_client_->limit(request_callbacks_, "foo", descriptors_,
+                             Tracing::NullSpan::instance());
+  EXPECT_CALL(*client_, cancel());
+  aggregating_client_->cancel();
+}
+
 } // namespace
 } // namespace RateLimit
 } // namespace Common
@@ -0,0 +1,78 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures the per request cost of RoleBasedAccessControlEngineImpl::allowed() with many policies
+// of source IP ranges and exact paths.
+
+#include <string>
+
+#include "common/network/utility.h"
+
+#include "extensions/filters/common/rbac/engine_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+// Policy i allows the source range 10.x.y.0/24 to request the path /service/i, where x.y is i.
+envoy::config::rbac::v2alpha::RBAC makeRules(uint32_t policies) {
+  envoy::config::rbac::v2alpha::RBAC rules;
+  rules.set_action(envoy::config::rbac::v2alpha::RBAC_Action::RBAC_Action_ALLOW);
+  for (uint32_t i = 0; i < policies; i++) {
+    envoy::config::rbac::v2alpha::Policy policy;
+    auto* header = policy.add_permissions()->mutable_header();
+    header->set_name(":path");
+    header->set_exact_match(fmt::format("/service/{}", i));
+    auto* cidr = policy.add_principals()->mutable_source_ip();
+    cidr->set_address_prefix(fmt::format("10.{}.{}.0", i / 256, i % 256));
+    cidr->mutable_prefix_len()->set_value(24);
+    (*rules.mutable_policies())[fmt::format("policy-{}", i)] = policy;
+  }
+  return rules;
+}
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
+
+// Evaluate a request that is allowed by the last policy. The Arg is the number of policies.
+static void BM_RbacAllowed(benchmark::State& state) {
+  const uint32_t policies = state.range(0);
+  const Envoy::Extensions::Filters::Common::RBAC::RoleBasedAccessControlEngineImpl engine(
+      Envoy::Extensions::Filters::Common::RBAC::makeRules(policies));
+  NiceMock<Envoy::Network::MockConnection> connection;
+  connection.remote_address_ = Envoy::Network::Utility::parseInternetAddress(
+      fmt::format("10.{}.{}.1", (policies - 1) / 256, (policies - 1) % 256), 1234, false);
+  const Envoy::Http::TestHeaderMapImpl headers{
+      {":method", "GET"},
+      {":path", fmt::format("/service/{}", policies - 1)},
+      {":authority", "www.example.com"},
+      {"user-agent", "Mozilla/5.0 (X11; Linux x86_64)"}};
+  const envoy::api::v2::core::Metadata metadata;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(engine.allowed(connection, headers, metadata, nullptr));
+  }
+}
+BENCHMARK(BM_RbacAllowed)->Arg(10)->Arg(100)->Arg(3000);
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
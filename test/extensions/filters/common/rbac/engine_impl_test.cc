@@ -4,6 +4,7 @@
 
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/ssl/mocks.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -79,6 +80,67 @@ TEST(RoleBasedAccessControlEngineImpl, DeniedBlacklist) {
   checkEngine(engine, true, conn);
 }
 
+// The policies are indexed by their source and destination IP ranges and their exact header
+// values, and the first matching policy by name determines the result whether it is indexed or not.
+TEST(RoleBasedAccessControlEngineImpl, IndexedPolicies) {
+  envoy::config::rbac::v2alpha::RBAC rbac;
+  rbac.set_action(envoy::config::rbac::v2alpha::RBAC_Action::RBAC_Action_ALLOW);
+
+  envoy::config::rbac::v2alpha::Policy policy;
+  policy.add_permissions()->set_any(true);
+  auto* cidr = policy.add_principals()->mutable_source_ip();
+  cidr->set_address_prefix("10.0.0.0");
+  cidr->mutable_prefix_len()->set_value(8);
+  (*rbac.mutable_policies())["a"] = policy;
+
+  policy.Clear();
+  auto* header = policy.add_permissions()->mutable_header();
+  header->set_name(":path");
+  header->set_exact_match("/admin");
+  policy.add_principals()->set_any(true);
+  (*rbac.mutable_policies())["b"] = policy;
+
+  policy.Clear();
+  policy.add_permissions()->set_any(true);
+  auto* ids = policy.add_principals()->mutable_or_ids();
+  cidr = ids->add_ids()->mutable_source_ip();
+  cidr->set_address_prefix("192.168.0.0");
+  cidr->mutable_prefix_len()->set_value(16);
+  header = ids->add_ids()->mutable_header();
+  header->set_name("X-Foo");
+  header->set_exact_match("bar");
+  (*rbac.mutable_policies())["c"] = policy;
+
+  policy.Clear();
+  policy.add_permissions()->set_destination_port(443);
+  policy.add_principals()->set_any(true);
+  (*rbac.mutable_policies())["d"] = policy;
+
+  RBAC::RoleBasedAccessControlEngineImpl engine(rbac);
+  testing::NiceMock<Envoy::Network::MockConnection> conn;
+  const auto check = [&](const std::string& remote, uint32_t port,
+                         const Envoy::Http::HeaderMap& headers, const std::string& expected) {
+    conn.remote_address_ = Envoy::Network::Utility::parseInternetAddress(remote, 1234, false);
+    conn.local_address_ = Envoy::Network::Utility::parseInternetAddress("1.1.1.1", port, false);
+    std::string policy_id = "none";
+    checkEngine(engine, expected != "none", conn, headers, envoy::api::v2::core::Metadata(),
+                &policy_id);
+    EXPECT_EQ(expected, policy_id);
+  };
+
+  const Envoy::Http::TestHeaderMapImpl no_headers;
+  check("10.1.2.3", 80, no_headers, "a");
+  check("1.2.3.4", 80, Envoy::Http::TestHeaderMapImpl{{":path", "/admin"}}, "b");
+  check("1.2.3.4", 80, Envoy::Http::TestHeaderMapImpl{{":path", "/admin/"}}, "none");
+  check("192.168.1.1", 80, no_headers, "c");
+  check("1.2.3.4", 80, Envoy::Http::TestHeaderMapImpl{{"x-foo", "bar"}}, "c");
+  check("1.2.3.4", 443, no_headers, "d");
+  check("1.2.3.4", 80, no_headers, "none");
+  check("::1", 80, no_headers, "none");
+  check("10.1.2.3", 443, Envoy::Http::TestHeaderMapImpl{{":path", "/admin"}}, "a");
+  check("1.2.3.4", 443, Envoy::Http::TestHeaderMapImpl{{"x-foo", "bar"}}, "c");
+}
+
 } // namespace
 } // namespace RBAC
 } // namespace Common
@@ -78,6 +78,23 @@ TEST(AndMatcher, Principal_Set) {
   checkMatcher(RBAC::AndMatcher(set), false, conn);
 }
 
+// The cheaper sub-matchers are evaluated first, whatever their configured order.
+TEST(AndMatcher, CheapestFirst) {
+  envoy::config::rbac::v2alpha::Principal_Set set;
+  set.add_ids()->mutable_authenticated();
+  auto* cidr = set.add_ids()->mutable_source_ip();
+  cidr->set_address_prefix("1.2.3.0");
+  cidr->mutable_prefix_len()->set_value(24);
+
+  Envoy::Network::MockConnection conn;
+  Envoy::Network::Address::InstanceConstSharedPtr addr =
+      Envoy::Network::Utility::parseInternetAddress("1.2.4.6", 123, false);
+  EXPECT_CALL(conn, remoteAddress()).WillOnce(ReturnRef(addr));
+  EXPECT_CALL(Const(conn), ssl()).Times(0);
+
+  checkMatcher(RBAC::AndMatcher(set), false, conn);
+}
+
 TEST(OrMatcher, Permission_Set) {
   envoy::config::rbac::v2alpha::Permission_Set set;
   envoy::config::rbac::v2alpha::Permission* perm = set.add_rules();
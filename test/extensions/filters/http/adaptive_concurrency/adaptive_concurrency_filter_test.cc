@@ -0,0 +1,127 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace {
+
+class AdaptiveConcurrencyFilterTest : public testing::Test {
+protected:
+  AdaptiveConcurrencyFilterTest() {
+    envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency config;
+    MessageUtil::loadFromYaml(R"EOF(
+gradient_controller_config:
+  concurrency_limit_params:
+    concurrency_update_interval: 0.1s
+  min_rtt_calc_params:
+    interval: 30s
+    request_count: 1
+    min_concurrency: 1
+)EOF",
+                              config);
+    config_ = std::make_shared<AdaptiveConcurrencyFilterConfig>(config, "test.", stats_store_,
+                                                                time_system_, tls_);
+  }
+
+  std::unique_ptr<AdaptiveConcurrencyFilter> newFilter() {
+    auto filter = std::make_unique<AdaptiveConcurrencyFilter>(config_);
+    filter->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter->setEncoderFilterCallbacks(encoder_callbacks_);
+    return filter;
+  }
+
+  uint64_t gauge(const std::string& name) {
+    return stats_store_.gauge("test.adaptive_concurrency.fake_cluster." + name).value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  AdaptiveConcurrencyFilterConfigSharedPtr config_;
+  Http::TestHeaderMapImpl request_headers_{{":method", "GET"}, {":path", "/"}};
+  Http::TestHeaderMapImpl response_headers_{{":status", "200"}};
+};
+
+// Test that the requests over the limit of their cluster are answered with a 503, and that the
+// latency of a forwarded request is sampled at the end of its response.
+TEST_F(AdaptiveConcurrencyFilterTest, BlockAndSample) {
+  auto forwarded = newFilter();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            forwarded->decodeHeaders(request_headers_, true));
+
+  auto blocked = newFilter();
+  EXPECT_CALL(decoder_callbacks_, sendLocalReply(Http::Code::ServiceUnavailable,
+                                                 "reached concurrency limit", _, _));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            blocked->decodeHeaders(request_headers_, true));
+  blocked->onDestroy();
+  EXPECT_EQ(1U, stats_store_.counter("test.adaptive_concurrency.fake_cluster.rq_blocked").value());
+
+  time_system_.sleep(std::chrono::milliseconds(20));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            forwarded->encodeHeaders(response_headers_, false));
+  EXPECT_EQ(1U, gauge("min_rtt_calculation_active"));
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, forwarded->encodeData(data, true));
+  forwarded->onDestroy();
+  EXPECT_EQ(0U, gauge("min_rtt_calculation_active"));
+  EXPECT_EQ(20U, gauge("min_rtt_msecs"));
+
+  auto next = newFilter();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, next->decodeHeaders(request_headers_, true));
+}
+
+// Test that a reset request no longer counts against the limit, without being sampled.
+TEST_F(AdaptiveConcurrencyFilterTest, Reset) {
+  auto reset = newFilter();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, reset->decodeHeaders(request_headers_, true));
+  reset->onDestroy();
+  EXPECT_EQ(1U, gauge("min_rtt_calculation_active"));
+
+  auto next = newFilter();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, next->decodeHeaders(request_headers_, true));
+  Http::TestHeaderMapImpl response_trailers{{"grpc-status", "0"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            next->encodeHeaders(response_headers_, false));
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, next->encodeTrailers(response_trailers));
+  EXPECT_EQ(0U, gauge("min_rtt_calculation_active"));
+}
+
+// Test that the requests without a route entry aren't limited.
+TEST_F(AdaptiveConcurrencyFilterTest, NoRouteEntry) {
+  EXPECT_CALL(*decoder_callbacks_.route_, routeEntry()).WillRepeatedly(Return(nullptr));
+  for (int i = 0; i < 2; i++) {
+    auto filter = newFilter();
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter->decodeHeaders(request_headers_, true));
+  }
+  EXPECT_EQ(0U, stats_store_.counter("test.adaptive_concurrency.fake_cluster.rq_blocked").value());
+}
+
+} // namespace
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,146 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/adaptive_concurrency/gradient_controller.h"
+
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace {
+
+class GradientControllerTest : public testing::Test {
+protected:
+  GradientControllerTest() {
+    envoy::config::filter::http::adaptive_concurrency::v2alpha::GradientControllerConfig config;
+    MessageUtil::loadFromYaml(R"EOF(
+sample_aggregate_percentile:
+  value: 50
+concurrency_limit_params:
+  max_concurrency_limit: 20
+  concurrency_update_interval: 0.1s
+min_rtt_calc_params:
+  interval: 30s
+  request_count: 5
+  min_concurrency: 2
+)EOF",
+                              config);
+    controller_ = std::make_unique<GradientController>(GradientControllerConfig(config),
+                                                       time_system_, stats_store_, "test.");
+  }
+
+  // Forwards a request and samples its latency.
+  void sample(std::chrono::milliseconds latency) {
+    ASSERT_EQ(RequestForwardingAction::Forward, controller_->forwardingDecision());
+    controller_->recordLatencySample(latency);
+  }
+
+  // Samples a latency after the update interval elapsed.
+  void update(std::chrono::milliseconds latency) {
+    time_system_.sleep(std::chrono::milliseconds(100));
+    sample(latency);
+  }
+
+  uint64_t gauge(const std::string& name) { return stats_store_.gauge("test." + name).value(); }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl stats_store_;
+  std::unique_ptr<GradientController> controller_;
+};
+
+// Test that the requests over the limit are blocked, and that cancelled requests no longer count.
+TEST_F(GradientControllerTest, Block) {
+  EXPECT_EQ(2U, controller_->concurrencyLimit());
+  EXPECT_EQ(RequestForwardingAction::Forward, controller_->forwardingDecision());
+  EXPECT_EQ(RequestForwardingAction::Forward, controller_->forwardingDecision());
+  EXPECT_EQ(RequestForwardingAction::Block, controller_->forwardingDecision());
+  EXPECT_EQ(1U, stats_store_.counter("test.rq_blocked").value());
+
+  controller_->cancelLatencySample();
+  EXPECT_EQ(RequestForwardingAction::Forward, controller_->forwardingDecision());
+}
+
+// Test that the minimum round-trip time is the percentile of the first samples.
+TEST_F(GradientControllerTest, MinRttCalculation) {
+  EXPECT_EQ(1U, gauge("min_rtt_calculation_active"));
+  EXPECT_EQ(1U, stats_store_.counter("test.min_rtt_calculations").value());
+  for (const uint64_t latency : {30, 10, 20, 50, 40}) {
+    sample(std::chrono::milliseconds(latency));
+  }
+  EXPECT_EQ(0U, gauge("min_rtt_calculation_active"));
+  EXPECT_EQ(30U, gauge("min_rtt_msecs"));
+  EXPECT_EQ(2U, controller_->concurrencyLimit());
+}
+
+// Test that the limit grows by its square root at the minimum round-trip time, up to the maximum,
+// and drops when the latencies grow.
+TEST_F(GradientControllerTest, LimitUpdates) {
+  for (int i = 0; i < 5; i++) {
+    sample(std::chrono::milliseconds(10));
+  }
+
+  // The samples within the update interval don't change the limit.
+  sample(std::chrono::milliseconds(10));
+  EXPECT_EQ(2U, controller_->concurrencyLimit());
+
+  update(std::chrono::milliseconds(10));
+  EXPECT_EQ(3U, controller_->concurrencyLimit());
+  EXPECT_EQ(3U, gauge("concurrency_limit"));
+  update(std::chrono::milliseconds(10));
+  EXPECT_EQ(5U, controller_->concurrencyLimit());
+  for (int i = 0; i < 10; i++) {
+    update(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(20U, controller_->concurrencyLimit());
+
+  // The gradient is bounded to 0.5: 20 * 0.5 + sqrt(20 * 0.5).
+  update(std::chrono::milliseconds(100));
+  EXPECT_EQ(100U, gauge("sample_rtt_msecs"));
+  EXPECT_EQ(13U, controller_->concurrencyLimit());
+  // The limit settles where its headroom makes up for the gradient.
+  for (int i = 0; i < 10; i++) {
+    update(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(3U, controller_->concurrencyLimit());
+}
+
+// Test that the minimum round-trip time is measured again after its interval, at the minimum
+// concurrency, and that the limit is then restored.
+TEST_F(GradientControllerTest, MinRttRecalculation) {
+  for (int i = 0; i < 5; i++) {
+    sample(std::chrono::milliseconds(10));
+  }
+  for (int i = 0; i < 5; i++) {
+    update(std::chrono::milliseconds(10));
+  }
+  const uint32_t limit = controller_->concurrencyLimit();
+  EXPECT_LT(2U, limit);
+
+  time_system_.sleep(std::chrono::seconds(30));
+  sample(std::chrono::milliseconds(10));
+  EXPECT_EQ(1U, gauge("min_rtt_calculation_active"));
+  EXPECT_EQ(2U, stats_store_.counter("test.min_rtt_calculations").value());
+  EXPECT_EQ(2U, controller_->concurrencyLimit());
+
+  for (int i = 0; i < 5; i++) {
+    sample(std::chrono::milliseconds(20));
+  }
+  EXPECT_EQ(0U, gauge("min_rtt_calculation_active"));
+  EXPECT_EQ(20U, gauge("min_rtt_msecs"));
+  EXPECT_EQ(limit, controller_->concurrencyLimit());
+}
+
+} // namespace
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -4,13 +4,16 @@
 #include "envoy/config/filter/http/buffer/v2/buffer.pb.h"
 #include "envoy/event/dispatcher.h"
 
+#include "common/api/os_sys_calls_impl.h"
 #include "common/http/header_map_impl.h"
+#include "common/stats/isolated_store_impl.h"
 
 #include "extensions/filters/http/buffer/buffer_filter.h"
 #include "extensions/filters/http/well_known_names.h"
 
 #include "test/mocks/buffer/mocks.h"
 #include "test/mocks/http/mocks.h"
+#include "test/test_common/environment.h"
 #include "test/test_common/printers.h"
 
 #include "gmock/gmock.h"
@@ -19,6 +22,7 @@
 using testing::_;
 using testing::DoAll;
 using testing::InSequence;
+using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
 using testing::SaveArg;
@@ -33,7 +37,25 @@ public:
   BufferFilterConfigSharedPtr setupConfig() {
     envoy::config::filter::http::buffer::v2::Buffer proto_config;
     proto_config.mutable_max_request_bytes()->set_value(1024 * 1024);
-    return std::make_shared<BufferFilterConfig>(proto_config);
+    return std::make_shared<BufferFilterConfig>(proto_config, "test.", stats_store_,
+                                                os_sys_calls_);
+  }
+
+  // Creates a filter that buffers 4 bytes in memory and spills the rest.
+  std::unique_ptr<BufferFilter> spillFilter(const std::string& directory) {
+    envoy::config::filter::http::buffer::v2::Buffer proto_config;
+    proto_config.mutable_max_request_bytes()->set_value(4);
+    proto_config.mutable_spill()->mutable_max_request_bytes()->set_value(16);
+    proto_config.mutable_spill()->set_directory(directory);
+    spill_config_ = std::make_shared<BufferFilterConfig>(proto_config, "test.", stats_store_,
+                                                         os_sys_calls_);
+    auto filter = std::make_unique<BufferFilter>(spill_config_);
+    filter->setDecoderFilterCallbacks(callbacks_);
+    return filter;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("test.buffer." + name).value();
   }
 
   BufferFilterTest() : config_(setupConfig()), filter_(config_) {
@@ -49,8 +71,11 @@ public:
         .WillByDefault(Return(vhost_settings));
   }
 
+  Stats::IsolatedStoreImpl stats_store_;
+  Api::OsSysCallsImpl os_sys_calls_;
   NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks_;
   BufferFilterConfigSharedPtr config_;
+  BufferFilterConfigSharedPtr spill_config_;
   BufferFilter filter_;
 };
 
@@ -134,6 +159,81 @@ TEST_F(BufferFilterTest, RouteDisabledConfigOverride) {
   EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(data1, true));
 }
 
+// Test that the bytes beyond the memory limit are written to a file, and forwarded after the
+// buffered bytes at the end of the request.
+TEST_F(BufferFilterTest, Spill) {
+  auto filter = spillFilter(TestEnvironment::temporaryDirectory());
+  EXPECT_CALL(callbacks_, setDecoderBufferLimit(_)).Times(0);
+
+  Http::TestHeaderMapImpl headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter->decodeHeaders(headers, false));
+
+  Buffer::OwnedImpl data1("hel");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter->decodeData(data1, false));
+  EXPECT_EQ(0U, data1.length());
+  EXPECT_EQ(0U, counter("rq_spilled"));
+
+  Buffer::OwnedImpl data2("lo wor");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter->decodeData(data2, false));
+  EXPECT_EQ(0U, data2.length());
+  EXPECT_EQ(1U, counter("rq_spilled"));
+
+  Buffer::OwnedImpl data3("ld");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter->decodeData(data3, true));
+  EXPECT_EQ("hello world", data3.toString());
+  EXPECT_EQ(8U, counter("spilled_bytes"));
+}
+
+// Test that the body is added before the trailers of a spilled request.
+TEST_F(BufferFilterTest, SpillWithTrailers) {
+  auto filter = spillFilter(TestEnvironment::temporaryDirectory());
+
+  Http::TestHeaderMapImpl headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter->decodeHeaders(headers, false));
+  Buffer::OwnedImpl data("hello world");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter->decodeData(data, false));
+
+  EXPECT_CALL(callbacks_, addDecodedData(_, false))
+      .WillOnce(Invoke(
+          [](Buffer::Instance& body, bool) -> void { EXPECT_EQ("hello world", body.toString()); }));
+  Http::TestHeaderMapImpl trailers;
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter->decodeTrailers(trailers));
+  EXPECT_EQ(11U, counter("spilled_bytes"));
+}
+
+// Test that a spilled request over its maximum size is answered with a 413.
+TEST_F(BufferFilterTest, SpillTooLarge) {
+  auto filter = spillFilter(TestEnvironment::temporaryDirectory());
+
+  Http::TestHeaderMapImpl headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter->decodeHeaders(headers, false));
+  Buffer::OwnedImpl data1("hello world");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter->decodeData(data1, false));
+
+  EXPECT_CALL(callbacks_, sendLocalReply(Http::Code::PayloadTooLarge, _, _, _));
+  Buffer::OwnedImpl data2("hello world");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter->decodeData(data2, false));
+  EXPECT_EQ(1U, counter("rq_too_large"));
+
+  Buffer::OwnedImpl data3("!");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter->decodeData(data3, true));
+}
+
+// Test that a request that can't be spilled is answered with a 500.
+TEST_F(BufferFilterTest, SpillFailure) {
+  auto filter = spillFilter(TestEnvironment::temporaryDirectory() + "/does_not_exist");
+
+  Http::TestHeaderMapImpl headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter->decodeHeaders(headers, false));
+  Buffer::OwnedImpl data1("hel");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter->decodeData(data1, false));
+
+  EXPECT_CALL(callbacks_, sendLocalReply(Http::Code::InternalServerError, _, _, _));
+  Buffer::OwnedImpl data2("lo world");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter->decodeData(data2, true));
+  EXPECT_EQ(1U, counter("spill_failed"));
+}
+
 } // namespace BufferFilter
 } // namespace HttpFilters
 } // namespace Extensions
@@ -0,0 +1,418 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/cache/cache_filter.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+class CacheFilterTest : public testing::Test {
+protected:
+  CacheFilterTest() { initialize(""); }
+
+  void initialize(const std::string& yaml) {
+    envoy::config::filter::http::cache::v2alpha::Cache cache;
+    MessageUtil::loadFromYaml(R"EOF(
+storage:
+  name: envoy.http_caches.in_memory
+  config:
+    max_bytes: 65536
+max_body_bytes: 16
+)EOF" + yaml,
+                              cache);
+    config_ = std::make_shared<CacheFilterConfig>(cache, "test.", context_);
+  }
+
+  // Creates the filter of a stream of other callbacks, which waits for the response of another
+  // request.
+  std::unique_ptr<CacheFilter>
+  waitingStream(Http::TestHeaderMapImpl& request_headers,
+                NiceMock<Http::MockStreamDecoderFilterCallbacks>& decoder_callbacks) {
+    auto filter = std::make_unique<CacheFilter>(config_);
+    filter->setDecoderFilterCallbacks(decoder_callbacks);
+    filter->setEncoderFilterCallbacks(encoder_callbacks_);
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              filter->decodeHeaders(request_headers, true));
+    return filter;
+  }
+
+  // Creates the filter of a new stream.
+  void newStream() {
+    filter_ = std::make_unique<CacheFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+  }
+
+  // Sends a response through the filter of a forwarded request.
+  void respond(Http::TestHeaderMapImpl& response_headers, const std::string& body) {
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              filter_->encodeHeaders(response_headers, body.empty()));
+    if (!body.empty()) {
+      Buffer::OwnedImpl data(body);
+      EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+    }
+  }
+
+  // Forwards a request and sends its response through the filter.
+  void forward(Http::TestHeaderMapImpl request_headers, Http::TestHeaderMapImpl response_headers,
+               const std::string& body) {
+    newStream();
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+    respond(response_headers, body);
+  }
+
+  // Expects a request to be served from the cache, and returns the headers it was served with.
+  Http::TestHeaderMapImpl serve(Http::TestHeaderMapImpl request_headers,
+                                const std::string& expected_body) {
+    newStream();
+    Http::TestHeaderMapImpl served_headers;
+    EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, expected_body.empty()))
+        .WillOnce(Invoke([&served_headers](Http::HeaderMap& headers, bool) {
+          served_headers = Http::TestHeaderMapImpl(headers);
+        }));
+    if (!expected_body.empty()) {
+      EXPECT_CALL(decoder_callbacks_, encodeData(_, true))
+          .WillOnce(Invoke([&expected_body](Buffer::Instance& data, bool) {
+            EXPECT_EQ(expected_body, data.toString());
+          }));
+    }
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              filter_->decodeHeaders(request_headers, true));
+    return served_headers;
+  }
+
+  uint64_t counter(const std::string& name) { return context_.scope_.counter(name).value(); }
+
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Server::Configuration::MockFactoryContext> context_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  CacheFilterConfigSharedPtr config_;
+  std::unique_ptr<CacheFilter> filter_;
+  const Http::TestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/path"}};
+};
+
+// Fresh responses are served from the cache with their age, until they are stale.
+TEST_F(CacheFilterTest, HitUntilStale) {
+  forward(request_headers_, {{":status", "200"}, {"cache-control", "max-age=60"}}, "body");
+  EXPECT_EQ(1U, counter("test.cache.miss"));
+  EXPECT_EQ(1U, counter("test.cache.stored"));
+
+  time_system_.sleep(std::chrono::seconds(10));
+  Http::TestHeaderMapImpl served_headers = serve(request_headers_, "body");
+  EXPECT_EQ("200", served_headers.get_(":status"));
+  EXPECT_EQ("10", served_headers.get_("age"));
+  EXPECT_EQ(1U, counter("test.cache.hit"));
+
+  // Another path isn't served from the cache.
+  newStream();
+  Http::TestHeaderMapImpl other_path{{":method", "GET"}, {":authority", "host"}, {":path", "/a"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(other_path, true));
+
+  // The stale response has no validator, so that the request is forwarded as it is.
+  time_system_.sleep(std::chrono::seconds(50));
+  forward(request_headers_, {{":status", "200"}, {"cache-control", "max-age=60"}}, "new");
+  EXPECT_EQ(2U, counter("test.cache.miss"));
+  serve(request_headers_, "new");
+}
+
+// The cache-control directives of the request limit which responses it accepts.
+TEST_F(CacheFilterTest, RequestDirectives) {
+  forward(request_headers_, {{":status", "200"}, {"cache-control", "max-age=60"}}, "body");
+  time_system_.sleep(std::chrono::seconds(10));
+
+  Http::TestHeaderMapImpl max_age(request_headers_);
+  max_age.addCopy("cache-control", "max-age=5");
+  newStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(max_age, true));
+
+  Http::TestHeaderMapImpl no_cache(request_headers_);
+  no_cache.addCopy("pragma", "no-cache");
+  newStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(no_cache, true));
+
+  time_system_.sleep(std::chrono::seconds(60));
+  Http::TestHeaderMapImpl max_stale(request_headers_);
+  max_stale.addCopy("cache-control", "max-stale=20");
+  serve(max_stale, "body");
+}
+
+// A stale response with an etag is validated, and a 304 makes it fresh again.
+TEST_F(CacheFilterTest, Validation) {
+  forward(request_headers_,
+          {{":status", "200"}, {"etag", "\"v1\""}, {"content-length", "4"}, {"x-old", "old"}},
+          "body");
+  EXPECT_EQ(1U, counter("test.cache.stored"));
+
+  newStream();
+  Http::TestHeaderMapImpl request_headers(request_headers_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  EXPECT_EQ("\"v1\"", request_headers.get_("if-none-match"));
+
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(_, false))
+      .WillOnce(Invoke(
+          [](Buffer::Instance& data, bool) -> void { EXPECT_EQ("body", data.toString()); }));
+  Http::TestHeaderMapImpl not_modified{
+      {":status", "304"}, {"cache-control", "max-age=60"}, {"x-old", "new"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(not_modified, true));
+  EXPECT_EQ("200", not_modified.get_(":status"));
+  EXPECT_EQ("4", not_modified.get_("content-length"));
+  EXPECT_EQ("\"v1\"", not_modified.get_("etag"));
+  EXPECT_EQ("new", not_modified.get_("x-old"));
+  EXPECT_EQ(1U, counter("test.cache.validated"));
+  EXPECT_EQ(0U, counter("test.cache.miss"));
+
+  Http::TestHeaderMapImpl served_headers = serve(request_headers_, "body");
+  EXPECT_EQ("new", served_headers.get_("x-old"));
+}
+
+// The body of a 304 answering a validation is replaced by the stored one.
+TEST_F(CacheFilterTest, ValidationWithBody) {
+  forward(request_headers_,
+          {{":status", "200"}, {"last-modified", "Sun, 06 Nov 1994 08:49:37 GMT"}}, "body");
+
+  newStream();
+  Http::TestHeaderMapImpl request_headers(request_headers_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  EXPECT_EQ("Sun, 06 Nov 1994 08:49:37 GMT", request_headers.get_("if-modified-since"));
+
+  Http::TestHeaderMapImpl not_modified{{":status", "304"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(not_modified, false));
+  Buffer::OwnedImpl data("junk");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, false));
+  EXPECT_EQ(0U, data.length());
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+  EXPECT_EQ("body", data.toString());
+}
+
+// A validation failing with a new response stores the new response.
+TEST_F(CacheFilterTest, ValidationFailed) {
+  forward(request_headers_, {{":status", "200"}, {"etag", "\"v1\""}}, "body");
+  forward(request_headers_,
+          {{":status", "200"}, {"etag", "\"v2\""}, {"cache-control", "max-age=5"}}, "new");
+  EXPECT_EQ(2U, counter("test.cache.miss"));
+  EXPECT_EQ(0U, counter("test.cache.validated"));
+  serve(request_headers_, "new");
+}
+
+// Conditional requests matching a fresh response are answered with a 304.
+TEST_F(CacheFilterTest, ConditionalHit) {
+  forward(request_headers_,
+          {{":status", "200"}, {"etag", "W/\"v1\""}, {"cache-control", "max-age=60"}}, "body");
+
+  Http::TestHeaderMapImpl matching(request_headers_);
+  matching.addCopy("if-none-match", "\"v0\", \"v1\"");
+  Http::TestHeaderMapImpl served_headers = serve(matching, "");
+  EXPECT_EQ("304", served_headers.get_(":status"));
+
+  Http::TestHeaderMapImpl not_matching(request_headers_);
+  not_matching.addCopy("if-none-match", "\"v2\"");
+  served_headers = serve(not_matching, "body");
+  EXPECT_EQ("200", served_headers.get_(":status"));
+}
+
+// The responses varying on request headers are stored per value of the headers.
+TEST_F(CacheFilterTest, Vary) {
+  Http::TestHeaderMapImpl gzip(request_headers_);
+  gzip.addCopy("accept-encoding", "gzip");
+  forward(gzip, {{":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "Accept-Encoding"}},
+          "gzip");
+  serve(gzip, "gzip");
+
+  Http::TestHeaderMapImpl br(request_headers_);
+  br.addCopy("accept-encoding", "br");
+  newStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(br, true));
+  Http::TestHeaderMapImpl response_headers{
+      {":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "accept-encoding"}};
+  respond(response_headers, "br");
+  serve(br, "br");
+  serve(gzip, "gzip");
+
+  // A request without the header gets its own variant.
+  newStream();
+  Http::TestHeaderMapImpl request_headers(request_headers_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+
+  // Responses varying on everything aren't stored.
+  forward(request_headers_, {{":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "*"}},
+          "body");
+  EXPECT_EQ(2U, counter("test.cache.stored"));
+}
+
+// The responses that a shared cache can't store aren't stored.
+TEST_F(CacheFilterTest, NotStorable) {
+  forward(request_headers_, {{":status", "200"}, {"cache-control", "no-store, max-age=60"}}, "a");
+  forward(request_headers_, {{":status", "200"}, {"cache-control", "private, max-age=60"}}, "b");
+  forward(request_headers_,
+          {{":status", "200"}, {"cache-control", "max-age=60"}, {"set-cookie", "a"}}, "c");
+  forward(request_headers_, {{":status", "500"}, {"cache-control", "max-age=60"}}, "d");
+  forward(request_headers_, {{":status", "200"}}, "e");
+  forward(request_headers_, {{":status", "200"}, {"cache-control", "max-age=60"}},
+          std::string(17, 'f'));
+
+  newStream();
+  Http::TestHeaderMapImpl request_headers(request_headers_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"cache-control", "max-age=60"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  Buffer::OwnedImpl data("g");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, false));
+  Http::TestHeaderMapImpl trailers{{"grpc-status", "0"}};
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->encodeTrailers(trailers));
+
+  EXPECT_EQ(0U, counter("test.cache.stored"));
+  EXPECT_EQ(7U, counter("test.cache.miss"));
+}
+
+// Requests with credentials or no-store don't use the cache.
+TEST_F(CacheFilterTest, NotCacheableRequest) {
+  forward(request_headers_, {{":status", "200"}, {"cache-control", "max-age=60"}}, "body");
+
+  Http::TestHeaderMapImpl authorization(request_headers_);
+  authorization.addCopy("authorization", "secret");
+  forward(authorization, {{":status", "200"}, {"cache-control", "max-age=60"}}, "secret");
+
+  Http::TestHeaderMapImpl no_store(request_headers_);
+  no_store.addCopy("cache-control", "no-store");
+  forward(no_store, {{":status", "200"}, {"cache-control", "max-age=60"}}, "other");
+
+  EXPECT_EQ(1U, counter("test.cache.miss"));
+  serve(request_headers_, "body");
+}
+
+// Successful unsafe requests remove the stored responses of their URL.
+TEST_F(CacheFilterTest, Invalidation) {
+  forward(request_headers_, {{":status", "200"}, {"cache-control", "max-age=60"}}, "body");
+
+  const Http::TestHeaderMapImpl post{
+      {":method", "POST"}, {":authority", "host"}, {":path", "/path"}};
+  forward(post, {{":status", "500"}}, "");
+  EXPECT_EQ(0U, counter("test.cache.invalidated"));
+  serve(request_headers_, "body");
+
+  forward(post, {{":status", "204"}}, "");
+  EXPECT_EQ(1U, counter("test.cache.invalidated"));
+  newStream();
+  Http::TestHeaderMapImpl request_headers(request_headers_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+}
+
+const std::string Coalescing = R"EOF(
+coalescing:
+  timeout: 1s
+)EOF";
+
+// The concurrent requests missing a response wait for the first one, and are served the response
+// it stores.
+TEST_F(CacheFilterTest, Coalescing) {
+  initialize(Coalescing);
+  newStream();
+  Http::TestHeaderMapImpl leader_headers(request_headers_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(leader_headers, true));
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> waiter_callbacks;
+  Http::TestHeaderMapImpl waiter_headers(request_headers_);
+  std::unique_ptr<CacheFilter> waiter = waitingStream(waiter_headers, waiter_callbacks);
+  EXPECT_EQ(1U, counter("test.cache.coalesced"));
+
+  EXPECT_CALL(waiter_callbacks, encodeHeaders_(_, false));
+  EXPECT_CALL(waiter_callbacks, encodeData(_, true))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) { EXPECT_EQ("body", data.toString()); }));
+  EXPECT_CALL(waiter_callbacks, continueDecoding()).Times(0);
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"cache-control", "max-age=60"}};
+  respond(response_headers, "body");
+  EXPECT_EQ(1U, counter("test.cache.miss"));
+  EXPECT_EQ(1U, counter("test.cache.hit"));
+
+  // The key was released, so that the next miss leads it again.
+  time_system_.sleep(std::chrono::seconds(60));
+  forward(request_headers_, {{":status", "200"}, {"cache-control", "max-age=60"}}, "new");
+  EXPECT_EQ(1U, counter("test.cache.coalesced"));
+}
+
+// The waiting requests are forwarded when the response of the first one isn't stored.
+TEST_F(CacheFilterTest, CoalescingNotStored) {
+  initialize(Coalescing);
+  newStream();
+  Http::TestHeaderMapImpl leader_headers(request_headers_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(leader_headers, true));
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> waiter_callbacks;
+  Http::TestHeaderMapImpl waiter_headers(request_headers_);
+  std::unique_ptr<CacheFilter> waiter = waitingStream(waiter_headers, waiter_callbacks);
+
+  EXPECT_CALL(waiter_callbacks, continueDecoding());
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"cache-control", "private"}};
+  respond(response_headers, "body");
+}
+
+// The waiting requests are forwarded when the first one is destroyed without a response.
+TEST_F(CacheFilterTest, CoalescingLeaderDestroyed) {
+  initialize(Coalescing);
+  newStream();
+  Http::TestHeaderMapImpl leader_headers(request_headers_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(leader_headers, true));
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> waiter_callbacks;
+  Http::TestHeaderMapImpl waiter_headers(request_headers_);
+  std::unique_ptr<CacheFilter> waiter = waitingStream(waiter_headers, waiter_callbacks);
+
+  EXPECT_CALL(waiter_callbacks, continueDecoding());
+  filter_->onDestroy();
+}
+
+// A waiting request is forwarded on its own after the timeout, and a destroyed one isn't woken.
+TEST_F(CacheFilterTest, CoalescingTimeout) {
+  initialize(Coalescing);
+  newStream();
+  Http::TestHeaderMapImpl leader_headers(request_headers_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(leader_headers, true));
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> waiter_callbacks;
+  auto* timer = new NiceMock<Event::MockTimer>(&waiter_callbacks.dispatcher_);
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(1000)));
+  Http::TestHeaderMapImpl waiter_headers(request_headers_);
+  std::unique_ptr<CacheFilter> waiter = waitingStream(waiter_headers, waiter_callbacks);
+  EXPECT_CALL(waiter_callbacks, continueDecoding());
+  timer->callback_();
+  EXPECT_EQ(1U, counter("test.cache.coalescing_timeout"));
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> destroyed_callbacks;
+  Http::TestHeaderMapImpl destroyed_headers(request_headers_);
+  std::unique_ptr<CacheFilter> destroyed = waitingStream(destroyed_headers, destroyed_callbacks);
+  destroyed->onDestroy();
+
+  EXPECT_CALL(waiter_callbacks, encodeHeaders_(_, _)).Times(0);
+  EXPECT_CALL(destroyed_callbacks, encodeHeaders_(_, _)).Times(0);
+  EXPECT_CALL(destroyed_callbacks, continueDecoding()).Times(0);
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"cache-control", "max-age=60"}};
+  respond(response_headers, "body");
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
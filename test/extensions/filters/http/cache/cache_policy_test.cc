@@ -0,0 +1,151 @@
+#include <chrono>
+#include <memory>
+
+#include "common/http/header_map_impl.h"
+
+#include "extensions/filters/http/cache/cache_policy.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+// Sun, 06 Nov 1994 08:49:37 GMT
+const SystemTime ResponseTime = std::chrono::system_clock::from_time_t(784111777);
+
+Envoy::HttpCache::CacheEntry entry(const Http::TestHeaderMapImpl& headers) {
+  Envoy::HttpCache::CacheEntry entry;
+  entry.headers_ = std::make_unique<Http::HeaderMapImpl>(headers);
+  entry.response_time_ = ResponseTime;
+  return entry;
+}
+
+TEST(CachePolicyTest, CacheControl) {
+  const CacheControl cache_control = CachePolicy::cacheControl(Http::TestHeaderMapImpl{
+      {"cache-control",
+       "No-Cache, private=\"set-cookie\", max-age=\"10\", s-maxage=x, max-stale"}});
+  EXPECT_TRUE(cache_control.no_cache_);
+  EXPECT_TRUE(cache_control.private_);
+  EXPECT_FALSE(cache_control.no_store_);
+  EXPECT_EQ(std::chrono::seconds(10), cache_control.max_age_.value());
+  // Malformed delta-seconds are zero.
+  EXPECT_EQ(std::chrono::seconds(0), cache_control.s_maxage_.value());
+  EXPECT_EQ(std::chrono::seconds(2147483648), cache_control.max_stale_.value());
+  EXPECT_FALSE(cache_control.min_fresh_.has_value());
+}
+
+TEST(CachePolicyTest, HttpDate) {
+  EXPECT_EQ(ResponseTime, CachePolicy::httpDate("Sun, 06 Nov 1994 08:49:37 GMT").value());
+  EXPECT_FALSE(CachePolicy::httpDate("Sunday, 06-Nov-94 08:49:37 GMT").has_value());
+  EXPECT_FALSE(CachePolicy::httpDate("0").has_value());
+}
+
+// s-maxage takes precedence over max-age, which takes precedence over expires.
+TEST(CachePolicyTest, FreshnessLifetime) {
+  EXPECT_EQ(std::chrono::seconds(5),
+            CachePolicy::freshnessLifetime(
+                entry({{"cache-control", "max-age=10, s-maxage=5"},
+                       {"expires", "Sun, 06 Nov 1994 08:50:37 GMT"}})));
+  EXPECT_EQ(std::chrono::seconds(10),
+            CachePolicy::freshnessLifetime(entry(
+                {{"cache-control", "max-age=10"}, {"expires", "Sun, 06 Nov 1994 08:50:37 GMT"}})));
+  EXPECT_EQ(std::chrono::seconds(30),
+            CachePolicy::freshnessLifetime(entry({{"date", "Sun, 06 Nov 1994 08:50:07 GMT"},
+                                                  {"expires", "Sun, 06 Nov 1994 08:50:37 GMT"}})));
+  // Without a date header, the lifetime is counted from the response time.
+  EXPECT_EQ(std::chrono::seconds(60), CachePolicy::freshnessLifetime(
+                                          entry({{"expires", "Sun, 06 Nov 1994 08:50:37 GMT"}})));
+  EXPECT_EQ(std::chrono::seconds(0), CachePolicy::freshnessLifetime(entry({{"expires", "0"}})));
+  EXPECT_EQ(std::chrono::seconds(0),
+            CachePolicy::freshnessLifetime(entry({{"cache-control", "no-cache, max-age=10"}})));
+}
+
+// The current age counts the age and date headers and the time since the response was received.
+TEST(CachePolicyTest, CurrentAge) {
+  const SystemTime now = ResponseTime + std::chrono::seconds(10);
+  EXPECT_EQ(std::chrono::seconds(10), CachePolicy::currentAge(entry({}), now));
+  EXPECT_EQ(std::chrono::seconds(30), CachePolicy::currentAge(entry({{"age", "20"}}), now));
+  EXPECT_EQ(std::chrono::seconds(40),
+            CachePolicy::currentAge(
+                entry({{"age", "20"}, {"date", "Sun, 06 Nov 1994 08:49:07 GMT"}}), now));
+}
+
+TEST(CachePolicyTest, ResponseStorable) {
+  EXPECT_TRUE(CachePolicy::responseStorable(
+      Http::TestHeaderMapImpl{{":status", "404"}, {"cache-control", "max-age=10"}}));
+  EXPECT_TRUE(CachePolicy::responseStorable(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"etag", "\"a\""}}));
+  EXPECT_FALSE(CachePolicy::responseStorable(
+      Http::TestHeaderMapImpl{{":status", "302"}, {"cache-control", "max-age=10"}}));
+  EXPECT_FALSE(CachePolicy::responseStorable(Http::TestHeaderMapImpl{{":status", "200"}}));
+  EXPECT_FALSE(CachePolicy::responseStorable(Http::TestHeaderMapImpl{
+      {":status", "200"}, {"cache-control", "max-age=10"}, {"vary", "accept, *"}}));
+}
+
+// Stale responses are only served to requests accepting them, unless they must be revalidated.
+TEST(CachePolicyTest, Fresh) {
+  const Envoy::HttpCache::CacheEntry fresh_entry = entry({{"cache-control", "max-age=10"}});
+  const SystemTime now = ResponseTime + std::chrono::seconds(5);
+  EXPECT_TRUE(CachePolicy::fresh(fresh_entry, Http::TestHeaderMapImpl{}, now));
+  EXPECT_FALSE(CachePolicy::fresh(fresh_entry,
+                                  Http::TestHeaderMapImpl{{"cache-control", "min-fresh=6"}}, now));
+  EXPECT_FALSE(CachePolicy::fresh(fresh_entry,
+                                  Http::TestHeaderMapImpl{{"cache-control", "max-age=4"}}, now));
+
+  const SystemTime later = ResponseTime + std::chrono::seconds(15);
+  EXPECT_FALSE(CachePolicy::fresh(fresh_entry, Http::TestHeaderMapImpl{}, later));
+  EXPECT_TRUE(CachePolicy::fresh(fresh_entry,
+                                 Http::TestHeaderMapImpl{{"cache-control", "max-stale=5"}}, later));
+  EXPECT_FALSE(CachePolicy::fresh(
+      fresh_entry, Http::TestHeaderMapImpl{{"cache-control", "max-stale=4"}}, later));
+  EXPECT_FALSE(CachePolicy::fresh(entry({{"cache-control", "max-age=10, must-revalidate"}}),
+                                  Http::TestHeaderMapImpl{{"cache-control", "max-stale"}}, later));
+}
+
+TEST(CachePolicyTest, NotModified) {
+  const Envoy::HttpCache::CacheEntry validated_entry =
+      entry({{"etag", "\"a\""}, {"last-modified", "Sun, 06 Nov 1994 08:49:37 GMT"}});
+  EXPECT_TRUE(CachePolicy::notModified(validated_entry,
+                                       Http::TestHeaderMapImpl{{"if-none-match", "W/\"a\""}}));
+  EXPECT_TRUE(
+      CachePolicy::notModified(validated_entry, Http::TestHeaderMapImpl{{"if-none-match", "*"}}));
+  EXPECT_FALSE(CachePolicy::notModified(validated_entry,
+                                        Http::TestHeaderMapImpl{{"if-none-match", "\"b\""}}));
+  EXPECT_TRUE(CachePolicy::notModified(
+      validated_entry,
+      Http::TestHeaderMapImpl{{"if-modified-since", "Sun, 06 Nov 1994 08:49:37 GMT"}}));
+  EXPECT_FALSE(CachePolicy::notModified(
+      validated_entry,
+      Http::TestHeaderMapImpl{{"if-modified-since", "Sun, 06 Nov 1994 08:49:36 GMT"}}));
+  // if-modified-since is ignored with if-none-match.
+  EXPECT_FALSE(CachePolicy::notModified(
+      validated_entry,
+      Http::TestHeaderMapImpl{{"if-none-match", "\"b\""},
+                              {"if-modified-since", "Sun, 06 Nov 1994 08:49:37 GMT"}}));
+}
+
+TEST(CachePolicyTest, VariantKey) {
+  const std::vector<std::string> vary = CachePolicy::varyHeaders(
+      Http::TestHeaderMapImpl{{"vary", "Accept-Encoding, X-Foo"}});
+  ASSERT_EQ(2U, vary.size());
+  EXPECT_EQ("accept-encoding", vary[0]);
+  EXPECT_EQ("x-foo", vary[1]);
+
+  const std::string gzip =
+      CachePolicy::variantKey("key", vary, Http::TestHeaderMapImpl{{"accept-encoding", "gzip"}});
+  EXPECT_EQ("key\n4:gzip\n-", gzip);
+  EXPECT_NE(gzip,
+            CachePolicy::variantKey(
+                "key", vary, Http::TestHeaderMapImpl{{"accept-encoding", "gzip"}, {"x-foo", ""}}));
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
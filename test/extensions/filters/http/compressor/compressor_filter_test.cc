@@ -0,0 +1,405 @@
+#include <deque>
+#include <memory>
+
+#include "envoy/registry/registry.h"
+
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/decompressor/zlib_decompressor_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/compressor/compressor_filter.h"
+
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+namespace {
+
+// Compressor that prefixes the data with the content coding of its library.
+class TestCompressor : public Envoy::Compressor::Compressor {
+public:
+  void compress(Buffer::Instance& buffer, Envoy::Compressor::State) override {
+    buffer.prepend("test:");
+  }
+};
+
+class TestCompressorFactory : public Envoy::Compressor::CompressorFactory {
+public:
+  Envoy::Compressor::CompressorPtr createCompressor() override {
+    return std::make_unique<TestCompressor>();
+  }
+  const std::string& contentEncoding() const override { return content_encoding_; }
+
+  const std::string content_encoding_{"test"};
+};
+
+class TestCompressorLibraryFactory : public Envoy::Compressor::NamedCompressorLibraryConfigFactory {
+public:
+  Envoy::Compressor::CompressorFactoryPtr
+  createCompressorFactoryFromProto(const Protobuf::Message&,
+                                   Server::Configuration::FactoryContext&) override {
+    return std::make_unique<TestCompressorFactory>();
+  }
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<ProtobufWkt::Struct>();
+  }
+  std::string name() const override { return "test.compressors.test"; }
+};
+
+Registry::RegisterFactory<TestCompressorLibraryFactory,
+                          Envoy::Compressor::NamedCompressorLibraryConfigFactory>
+    register_test_library_;
+
+class CompressorFilterTest : public testing::Test {
+protected:
+  CompressorFilterTest() {
+    ON_CALL(context_.runtime_loader_.snapshot_, featureEnabled("compressor.filter_enabled", 100))
+        .WillByDefault(Return(true));
+    decompressor_.init(31);
+  }
+
+  void setUpFilter(const std::string& yaml) {
+    envoy::config::filter::http::compressor::v2alpha::Compressor compressor;
+    MessageUtil::loadFromYaml(yaml, compressor);
+    config_ = std::make_shared<CompressorFilterConfig>(compressor, "test.", context_);
+    filter_ = std::make_unique<CompressorFilter>(config_);
+  }
+
+  void setUpGzipAndTest() {
+    setUpFilter(R"EOF(
+compressor_libraries:
+- name: envoy.compressors.gzip
+- name: test.compressors.test
+)EOF");
+  }
+
+  // Returns the content-encoding of the response to a request with the accept-encoding, empty if
+  // it isn't compressed.
+  std::string negotiate(const std::string& accept_encoding) {
+    filter_ = std::make_unique<CompressorFilter>(config_);
+    Http::TestHeaderMapImpl request_headers{{":method", "get"},
+                                            {"accept-encoding", accept_encoding}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              filter_->decodeHeaders(request_headers, false));
+    Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"content-length", "256"}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              filter_->encodeHeaders(response_headers, false));
+    return response_headers.get_("content-encoding");
+  }
+
+  uint64_t counter(const std::string& name) { return context_.scope_.counter(name).value(); }
+
+  NiceMock<Server::Configuration::MockFactoryContext> context_;
+  CompressorFilterConfigSharedPtr config_;
+  std::unique_ptr<CompressorFilter> filter_;
+  Decompressor::ZlibDecompressorImpl decompressor_;
+};
+
+// Responses are compressed with the gzip library and its stats are updated.
+TEST_F(CompressorFilterTest, GzipCompression) {
+  setUpFilter(R"EOF(
+compressor_libraries:
+- name: envoy.compressors.gzip
+  config:
+    memory_level: 9
+    compression_level: BEST
+)EOF");
+  Http::TestHeaderMapImpl request_headers{{":method", "get"}, {"accept-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, false));
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"content-length", "256"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_EQ("gzip", response_headers.get_("content-encoding"));
+  EXPECT_EQ("", response_headers.get_("content-length"));
+  EXPECT_EQ("Accept-Encoding", response_headers.get_("vary"));
+
+  Buffer::OwnedImpl data;
+  TestUtility::feedBufferWithRandomCharacters(data, 256);
+  const std::string expected = data.toString();
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+  Buffer::OwnedImpl decompressed;
+  decompressor_.decompress(data, decompressed);
+  EXPECT_EQ(expected, decompressed.toString());
+
+  EXPECT_EQ(1, counter("test.compressor.gzip.header_accepted"));
+  EXPECT_EQ(1, counter("test.compressor.gzip.compressed"));
+  EXPECT_EQ(256, counter("test.compressor.gzip.total_uncompressed_bytes"));
+  EXPECT_EQ(data.length(), counter("test.compressor.gzip.total_compressed_bytes"));
+  EXPECT_EQ(0, counter("test.compressor.not_compressed"));
+}
+
+// The library is chosen by the weights of the accept-encoding header, ties going to the first
+// configured library.
+TEST_F(CompressorFilterTest, Negotiation) {
+  setUpGzipAndTest();
+  EXPECT_EQ("gzip", negotiate("gzip, test"));
+  EXPECT_EQ("gzip", negotiate("test, gzip"));
+  EXPECT_EQ("test", negotiate("gzip;q=0.5, test"));
+  EXPECT_EQ("test", negotiate("gzip;q=0.5, TEST;q=0.8"));
+  EXPECT_EQ("test", negotiate("test"));
+  EXPECT_EQ("test", negotiate("gzip;q=0, *"));
+  EXPECT_EQ("gzip", negotiate("*"));
+  EXPECT_EQ("gzip", negotiate("br, *;q=0.1"));
+  EXPECT_EQ("gzip", negotiate("gzip; level=1; q=1, test;q=0.999"));
+  EXPECT_EQ("gzip", negotiate("gzip, identity"));
+  EXPECT_EQ(6, counter("test.compressor.gzip.header_accepted"));
+  EXPECT_EQ(4, counter("test.compressor.test.header_accepted"));
+  EXPECT_EQ(0, counter("test.compressor.not_compressed"));
+}
+
+// Responses aren't compressed when no library is acceptable or identity is preferred.
+TEST_F(CompressorFilterTest, NoAcceptableLibrary) {
+  setUpGzipAndTest();
+  EXPECT_EQ("", negotiate("br"));
+  EXPECT_EQ("", negotiate("gzip;q=0, test;q=0"));
+  EXPECT_EQ("", negotiate("*;q=0"));
+  EXPECT_EQ("", negotiate("gzip;q=invalid"));
+  EXPECT_EQ("", negotiate("gzip;q=2"));
+  EXPECT_EQ("", negotiate(""));
+  EXPECT_EQ(6, counter("test.compressor.header_not_valid"));
+
+  EXPECT_EQ("", negotiate("identity, gzip;q=0.5"));
+  EXPECT_EQ("", negotiate("identity;q=0.6, *;q=0.5"));
+  EXPECT_EQ(2, counter("test.compressor.header_identity"));
+  EXPECT_EQ(8, counter("test.compressor.not_compressed"));
+  EXPECT_EQ(0, counter("test.compressor.gzip.header_accepted"));
+}
+
+// Requests without accept-encoding, or when the filter is disabled by runtime, aren't compressed.
+TEST_F(CompressorFilterTest, NoAcceptHeaderAndRuntimeDisabled) {
+  setUpGzipAndTest();
+  Http::TestHeaderMapImpl request_headers{{":method", "get"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, false));
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"content-length", "256"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_EQ("", response_headers.get_("content-encoding"));
+  EXPECT_EQ(1, counter("test.compressor.no_accept_header"));
+
+  EXPECT_CALL(context_.runtime_loader_.snapshot_,
+              featureEnabled("compressor.filter_enabled", 100))
+      .WillOnce(Return(false));
+  EXPECT_EQ("", negotiate("gzip"));
+  EXPECT_EQ(2, counter("test.compressor.not_compressed"));
+}
+
+// The response headers can skip the compression of the chosen library.
+TEST_F(CompressorFilterTest, ResponseHeadersSkipCompression) {
+  setUpFilter(R"EOF(
+compressor_libraries:
+- name: test.compressors.test
+disable_on_etag_header: true
+remove_accept_encoding_header: true
+)EOF");
+  Http::TestHeaderMapImpl request_headers{{":method", "get"}, {"accept-encoding", "test"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, false));
+  EXPECT_EQ("", request_headers.get_("accept-encoding"));
+  Http::TestHeaderMapImpl response_headers{
+      {":status", "200"}, {"content-length", "256"}, {"etag", "12345"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_EQ("", response_headers.get_("content-encoding"));
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+  EXPECT_EQ("hello", data.toString());
+  EXPECT_EQ(1, counter("test.compressor.not_compressed_etag"));
+  EXPECT_EQ(1, counter("test.compressor.not_compressed"));
+
+  EXPECT_EQ("test", negotiate("test"));
+  EXPECT_EQ(1, counter("test.compressor.test.compressed"));
+}
+
+// The compressed bodies of the responses with a strong etag are cached and replace the bodies of
+// the later responses to the same resource.
+TEST_F(CompressorFilterTest, ResponseCache) {
+  setUpFilter(R"EOF(
+compressor_libraries:
+- name: test.compressors.test
+response_cache:
+  max_bytes: 1024
+)EOF");
+  const auto respond = [this](const std::string& path, const std::string& etag,
+                              const std::string& body) -> std::string {
+    filter_ = std::make_unique<CompressorFilter>(config_);
+    Http::TestHeaderMapImpl request_headers{
+        {":method", "get"}, {":authority", "host"}, {":path", path}, {"accept-encoding", "test"}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              filter_->decodeHeaders(request_headers, false));
+    Http::TestHeaderMapImpl response_headers{
+        {":status", "200"}, {"content-length", "256"}, {"etag", etag}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              filter_->encodeHeaders(response_headers, false));
+    EXPECT_EQ("test", response_headers.get_("content-encoding"));
+    Buffer::OwnedImpl first(body.substr(0, 3));
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(first, false));
+    Buffer::OwnedImpl last(body.substr(3));
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(last, true));
+    return first.toString() + last.toString();
+  };
+
+  EXPECT_EQ("test:heltest:lo", respond("/a", "\"1\"", "hello"));
+  EXPECT_EQ(1, counter("test.compressor.response_cache_miss"));
+  EXPECT_EQ("test:heltest:lo", respond("/a", "\"1\"", "world"));
+  EXPECT_EQ(1, counter("test.compressor.response_cache_hit"));
+
+  // Other paths, etags and weak etags miss.
+  EXPECT_EQ("test:wortest:ld", respond("/b", "\"1\"", "world"));
+  EXPECT_EQ("test:wortest:ld", respond("/a", "\"2\"", "world"));
+  EXPECT_EQ("test:wortest:ld", respond("/a", "W/\"1\"", "world"));
+  EXPECT_EQ("test:wortest:ld", respond("/a", "W/\"1\"", "world"));
+  EXPECT_EQ(3, counter("test.compressor.response_cache_miss"));
+  EXPECT_EQ(1, counter("test.compressor.response_cache_hit"));
+  EXPECT_EQ(6, counter("test.compressor.test.compressed"));
+}
+
+// A cached body is served before the trailers that end a response.
+TEST_F(CompressorFilterTest, ResponseCacheWithTrailers) {
+  setUpFilter(R"EOF(
+compressor_libraries:
+- name: test.compressors.test
+response_cache:
+  max_bytes: 1024
+)EOF");
+  for (uint32_t i = 0; i < 2; i++) {
+    filter_ = std::make_unique<CompressorFilter>(config_);
+    NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks;
+    filter_->setEncoderFilterCallbacks(encoder_callbacks);
+    Http::TestHeaderMapImpl request_headers{
+        {":method", "get"}, {":authority", "host"}, {":path", "/"}, {"accept-encoding", "test"}};
+    filter_->decodeHeaders(request_headers, false);
+    Http::TestHeaderMapImpl response_headers{
+        {":status", "200"}, {"content-length", "256"}, {"etag", "\"1\""}};
+    filter_->encodeHeaders(response_headers, false);
+    Buffer::OwnedImpl data("hello");
+    filter_->encodeData(data, i == 0);
+    Http::TestHeaderMapImpl trailers;
+    if (i == 0) {
+      EXPECT_EQ("test:hello", data.toString());
+    } else {
+      EXPECT_EQ("", data.toString());
+      EXPECT_CALL(encoder_callbacks, addEncodedData(BufferStringEqual("test:hello"), false));
+      EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->encodeTrailers(trailers));
+    }
+  }
+  EXPECT_EQ(1, counter("test.compressor.response_cache_hit"));
+}
+
+// Compresses large responses on a thread pool, one chunk at a time.
+class CompressorFilterOffloadTest : public CompressorFilterTest {
+protected:
+  CompressorFilterOffloadTest() {
+    ON_CALL(context_.api_, threadFactory())
+        .WillByDefault(ReturnRef(Thread::threadFactoryForTest()));
+    ON_CALL(encoder_callbacks_.dispatcher_, post(_))
+        .WillByDefault(Invoke([this](Event::PostCb callback) -> void {
+          Thread::LockGuard lock(lock_);
+          posted_.push_back(std::move(callback));
+          callback_posted_.notifyOne();
+        }));
+    setUpFilter(R"EOF(
+compressor_libraries:
+- name: test.compressors.test
+offload:
+  min_response_bytes: 10
+  threads: 1
+)EOF");
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+    Http::TestHeaderMapImpl request_headers{{":method", "get"}, {"accept-encoding", "test"}};
+    filter_->decodeHeaders(request_headers, false);
+    Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"content-length", "256"}};
+    filter_->encodeHeaders(response_headers, false);
+  }
+
+  // Runs the completion of a compression on the test thread, as on the thread of the stream.
+  void runCompletion() {
+    Event::PostCb callback;
+    {
+      Thread::LockGuard lock(lock_);
+      while (posted_.empty()) {
+        callback_posted_.wait(lock_);
+      }
+      callback = std::move(posted_.front());
+      posted_.pop_front();
+    }
+    callback();
+  }
+
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar callback_posted_;
+  std::deque<Event::PostCb> posted_;
+};
+
+// The data that arrives while a chunk is compressed is compressed after it, and the filter chain
+// is resumed once all the data is compressed.
+TEST_F(CompressorFilterOffloadTest, CompressOnThreadPool) {
+  Buffer::OwnedImpl first("hello world");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_->encodeData(first, false));
+  EXPECT_EQ(0, first.length());
+  Buffer::OwnedImpl last("bye");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_->encodeData(last, true));
+  EXPECT_EQ(0, last.length());
+
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(BufferStringEqual("test:hello world"), false));
+  EXPECT_CALL(encoder_callbacks_, continueEncoding()).Times(0);
+  runCompletion();
+  testing::Mock::VerifyAndClearExpectations(&encoder_callbacks_);
+
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(BufferStringEqual("test:bye"), false));
+  EXPECT_CALL(encoder_callbacks_, continueEncoding());
+  runCompletion();
+  EXPECT_EQ(2, counter("test.compressor.offloaded"));
+  EXPECT_EQ(14, counter("test.compressor.test.total_uncompressed_bytes"));
+  EXPECT_EQ(24, counter("test.compressor.test.total_compressed_bytes"));
+}
+
+// Trailers wait for the chunk being compressed.
+TEST_F(CompressorFilterOffloadTest, Trailers) {
+  Buffer::OwnedImpl data("hello world");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_->encodeData(data, false));
+  Http::TestHeaderMapImpl trailers;
+  EXPECT_EQ(Http::FilterTrailersStatus::StopIteration, filter_->encodeTrailers(trailers));
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(BufferStringEqual("test:hello world"), false));
+  EXPECT_CALL(encoder_callbacks_, continueEncoding());
+  runCompletion();
+}
+
+// The completion of a compression is ignored once the stream is destroyed.
+TEST_F(CompressorFilterOffloadTest, DestroyedStream) {
+  Buffer::OwnedImpl data("hello world");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_->encodeData(data, true));
+  filter_->onDestroy();
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(_, _)).Times(0);
+  EXPECT_CALL(encoder_callbacks_, continueEncoding()).Times(0);
+  runCompletion();
+}
+
+// Libraries must have distinct content codings.
+TEST_F(CompressorFilterTest, DuplicateContentEncoding) {
+  EXPECT_THROW_WITH_MESSAGE(setUpFilter(R"EOF(
+compressor_libraries:
+- name: test.compressors.test
+- name: test.compressors.test
+)EOF"),
+                            EnvoyException,
+                            "compressor filter: more than one compressor library encodes with "
+                            "'test'");
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
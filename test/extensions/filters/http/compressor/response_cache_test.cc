@@ -0,0 +1,61 @@
+#include <string>
+
+#include "extensions/filters/http/compressor/response_cache.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+namespace {
+
+// Cached bodies are returned by key.
+TEST(ResponseCacheTest, InsertAndLookup) {
+  ResponseCache cache(1024, 512);
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(0, cache.insert("a", "body"));
+  ASSERT_NE(nullptr, cache.lookup("a"));
+  EXPECT_EQ("body", *cache.lookup("a"));
+  EXPECT_EQ(5, cache.bytes());
+
+  // Inserting a key again replaces its body.
+  EXPECT_EQ(0, cache.insert("a", "other"));
+  EXPECT_EQ("other", *cache.lookup("a"));
+  EXPECT_EQ(6, cache.bytes());
+}
+
+// The least recently used bodies are evicted to stay under the maximum bytes.
+TEST(ResponseCacheTest, Eviction) {
+  ResponseCache cache(30, 30);
+  EXPECT_EQ(0, cache.insert("a", std::string(9, 'a')));
+  EXPECT_EQ(0, cache.insert("b", std::string(9, 'b')));
+  EXPECT_EQ(0, cache.insert("c", std::string(9, 'c')));
+  EXPECT_NE(nullptr, cache.lookup("a"));
+
+  EXPECT_EQ(1, cache.insert("d", std::string(9, 'd')));
+  EXPECT_EQ(nullptr, cache.lookup("b"));
+  EXPECT_NE(nullptr, cache.lookup("a"));
+  EXPECT_NE(nullptr, cache.lookup("c"));
+  EXPECT_NE(nullptr, cache.lookup("d"));
+
+  EXPECT_EQ(3, cache.insert("e", std::string(29, 'e')));
+  EXPECT_EQ(30, cache.bytes());
+  EXPECT_NE(nullptr, cache.lookup("e"));
+}
+
+// Bodies bigger than the maximum entry bytes aren't cached.
+TEST(ResponseCacheTest, TooBig) {
+  ResponseCache cache(30, 10);
+  EXPECT_EQ(0, cache.insert("a", std::string(11, 'a')));
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(0, cache.insert("aaaaaaaaaaaaaaaaaaaaaaa", std::string(10, 'a')));
+  EXPECT_EQ(nullptr, cache.lookup("aaaaaaaaaaaaaaaaaaaaaaa"));
+  EXPECT_EQ(0, cache.bytes());
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,233 @@
+#include <memory>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/compressor/zlib_compressor_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/decompressor/decompressor_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Decompressor {
+namespace {
+
+class DecompressorFilterTest : public testing::Test {
+protected:
+  DecompressorFilterTest() {
+    setUpFilter(R"EOF(
+decompressor_libraries:
+- name: envoy.decompressors.gzip
+)EOF");
+  }
+
+  void setUpFilter(const std::string& yaml) {
+    envoy::config::filter::http::decompressor::v2alpha::Decompressor decompressor;
+    MessageUtil::loadFromYaml(yaml, decompressor);
+    config_ = std::make_shared<DecompressorFilterConfig>(decompressor, "test.", context_);
+    filter_ = std::make_unique<DecompressorFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+  }
+
+  static std::string gzip(const std::string& data) {
+    Envoy::Compressor::ZlibCompressorImpl compressor;
+    compressor.init(Envoy::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+                    Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard, 31, 8);
+    Buffer::OwnedImpl buffer(data);
+    compressor.compress(buffer, Envoy::Compressor::State::Finish);
+    return buffer.toString();
+  }
+
+  uint64_t counter(const std::string& name) { return context_.scope_.counter(name).value(); }
+
+  NiceMock<Server::Configuration::MockFactoryContext> context_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  DecompressorFilterConfigSharedPtr config_;
+  std::unique_ptr<DecompressorFilter> filter_;
+};
+
+// The bodies of the requests are decompressed, one chunk at a time.
+TEST_F(DecompressorFilterTest, RequestDecompression) {
+  Http::TestHeaderMapImpl headers{{":method", "post"},
+                                  {"content-encoding", "gzip"},
+                                  {"content-length", "100"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+  EXPECT_FALSE(headers.has("content-encoding"));
+  EXPECT_FALSE(headers.has("content-length"));
+
+  const std::string body(10000, 'a');
+  const std::string compressed = gzip(body);
+  std::string decompressed;
+  Buffer::OwnedImpl first(compressed.substr(0, 10));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(first, false));
+  decompressed.append(first.toString());
+  Buffer::OwnedImpl second(compressed.substr(10));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(second, true));
+  decompressed.append(second.toString());
+  EXPECT_EQ(body, decompressed);
+
+  EXPECT_EQ(1U, counter("test.decompressor.gzip.request.decompressed"));
+  EXPECT_EQ(compressed.size(), counter("test.decompressor.gzip.request.total_compressed_bytes"));
+  EXPECT_EQ(body.size(), counter("test.decompressor.gzip.request.total_uncompressed_bytes"));
+}
+
+// Only the outermost content coding is decoded, and only by the library of that coding.
+TEST_F(DecompressorFilterTest, OutermostContentCoding) {
+  Http::TestHeaderMapImpl nested{{":method", "post"}, {"content-encoding", "br, GZIP"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(nested, false));
+  EXPECT_EQ("br", nested.get_("content-encoding"));
+
+  filter_ = std::make_unique<DecompressorFilter>(config_);
+  Http::TestHeaderMapImpl inner{{":method", "post"}, {"content-encoding", "gzip, br"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(inner, false));
+  EXPECT_EQ("gzip, br", inner.get_("content-encoding"));
+  Buffer::OwnedImpl data("compressed");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data, true));
+  EXPECT_EQ("compressed", data.toString());
+  EXPECT_EQ(1U, counter("test.decompressor.gzip.request.decompressed"));
+}
+
+// Bodies that must not be transformed, headers only requests, and the requests of a filter that
+// only decompresses responses are left alone.
+TEST_F(DecompressorFilterTest, RequestNotDecompressed) {
+  Http::TestHeaderMapImpl no_transform{
+      {":method", "post"}, {"content-encoding", "gzip"}, {"cache-control", "no-transform"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(no_transform, false));
+  EXPECT_EQ("gzip", no_transform.get_("content-encoding"));
+
+  filter_ = std::make_unique<DecompressorFilter>(config_);
+  Http::TestHeaderMapImpl headers_only{{":method", "get"}, {"content-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers_only, true));
+  EXPECT_EQ("gzip", headers_only.get_("content-encoding"));
+
+  setUpFilter(R"EOF(
+decompressor_libraries:
+- name: envoy.decompressors.gzip
+disable_request_decompression: true
+)EOF");
+  Http::TestHeaderMapImpl disabled{{":method", "post"}, {"content-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(disabled, false));
+  EXPECT_EQ("gzip", disabled.get_("content-encoding"));
+  EXPECT_EQ(0U, counter("test.decompressor.gzip.request.decompressed"));
+}
+
+// Malformed request bodies are answered with a 400.
+TEST_F(DecompressorFilterTest, MalformedRequest) {
+  Http::TestHeaderMapImpl headers{{":method", "post"}, {"content-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(HeaderHasValueRef(":status", "400"), false));
+  Buffer::OwnedImpl data("not a gzip stream");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->decodeData(data, false));
+  EXPECT_EQ(0U, data.length());
+
+  // The rest of the body is dropped.
+  Buffer::OwnedImpl more(gzip("more"));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->decodeData(more, true));
+  EXPECT_EQ(0U, more.length());
+  EXPECT_EQ(1U, counter("test.decompressor.gzip.request.decompression_error"));
+}
+
+// Request bodies that decompress to more than the maximum are answered with a 413.
+TEST_F(DecompressorFilterTest, RequestTooLarge) {
+  setUpFilter(R"EOF(
+decompressor_libraries:
+- name: envoy.decompressors.gzip
+max_decompressed_bytes: 10000
+)EOF");
+  Http::TestHeaderMapImpl headers{{":method", "post"}, {"content-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+
+  const std::string compressed = gzip(std::string(1024 * 1024, 'a'));
+  // The gzip header decompresses to nothing.
+  Buffer::OwnedImpl first(compressed.substr(0, 10));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(first, false));
+  EXPECT_EQ(0U, first.length());
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(HeaderHasValueRef(":status", "413"), false));
+  Buffer::OwnedImpl second(compressed.substr(10));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->decodeData(second, true));
+  EXPECT_EQ(0U, second.length());
+  EXPECT_EQ(1U, counter("test.decompressor.gzip.request.decompressed_too_large"));
+}
+
+// Responses are only decompressed for the clients that don't accept their content coding.
+TEST_F(DecompressorFilterTest, ResponseDecompression) {
+  const auto decompressed = [this](const std::string& accept_encoding) -> bool {
+    filter_ = std::make_unique<DecompressorFilter>(config_);
+    Http::TestHeaderMapImpl request_headers{{":method", "get"}};
+    if (!accept_encoding.empty()) {
+      request_headers.addCopy("accept-encoding", accept_encoding);
+    }
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+    Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"content-encoding", "gzip"}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              filter_->encodeHeaders(response_headers, false));
+    return !response_headers.has("content-encoding");
+  };
+
+  EXPECT_TRUE(decompressed(""));
+  EXPECT_TRUE(decompressed("identity"));
+  EXPECT_TRUE(decompressed("br, gzip;q=0"));
+  EXPECT_TRUE(decompressed("*;q=0"));
+  EXPECT_FALSE(decompressed("gzip"));
+  EXPECT_FALSE(decompressed("br, GZIP;q=0.5"));
+  EXPECT_FALSE(decompressed("br, *"));
+  EXPECT_EQ(4U, counter("test.decompressor.gzip.response.decompressed"));
+}
+
+// The strong etags of the decompressed responses are removed, the weak ones kept.
+TEST_F(DecompressorFilterTest, ResponseEtag) {
+  Http::TestHeaderMapImpl request_headers{{":method", "get"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  Http::TestHeaderMapImpl strong{
+      {":status", "200"}, {"content-encoding", "gzip"}, {"etag", "\"1\""}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(strong, false));
+  EXPECT_FALSE(strong.has("etag"));
+
+  filter_ = std::make_unique<DecompressorFilter>(config_);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  Http::TestHeaderMapImpl weak{
+      {":status", "200"}, {"content-encoding", "gzip"}, {"etag", "W/\"1\""}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(weak, false));
+  EXPECT_EQ("W/\"1\"", weak.get_("etag"));
+}
+
+// Responses that fail to decompress are reset.
+TEST_F(DecompressorFilterTest, MalformedResponse) {
+  Http::TestHeaderMapImpl request_headers{{":method", "get"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"content-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_CALL(encoder_callbacks_, resetStream());
+  Buffer::OwnedImpl data("not a gzip stream");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->encodeData(data, true));
+  EXPECT_EQ(1U, counter("test.decompressor.gzip.response.decompression_error"));
+}
+
+// Each library must decode a different content coding.
+TEST_F(DecompressorFilterTest, DuplicateContentCoding) {
+  EXPECT_THROW_WITH_MESSAGE(
+      setUpFilter(R"EOF(
+decompressor_libraries:
+- name: envoy.decompressors.gzip
+- name: envoy.decompressors.gzip
+)EOF"),
+      EnvoyException, "decompressor filter: more than one decompressor library decodes 'gzip'");
+}
+
+} // namespace
+} // namespace Decompressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
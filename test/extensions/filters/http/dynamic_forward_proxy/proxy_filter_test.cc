@@ -0,0 +1,136 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+
+#include "extensions/filters/http/dynamic_forward_proxy/proxy_filter.h"
+
+#include "test/extensions/common/dynamic_forward_proxy/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Eq;
+using testing::InSequence;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace DynamicForwardProxy {
+namespace {
+
+using LoadDnsCacheEntryStatus = Common::DynamicForwardProxy::DnsCache::LoadDnsCacheEntryStatus;
+using MockLoadDnsCacheEntryResult =
+    Common::DynamicForwardProxy::MockDnsCache::MockLoadDnsCacheEntryResult;
+
+class ProxyFilterTest : public testing::Test {
+public:
+  ProxyFilterTest() {
+    envoy::config::filter::http::dynamic_forward_proxy::v2alpha::FilterConfig proto_config;
+    EXPECT_CALL(*dns_cache_manager_factory_.dns_cache_manager_, getCache(_));
+    config_ = std::make_shared<ProxyFilterConfig>(proto_config, dns_cache_manager_factory_, cm_);
+    filter_ = std::make_unique<ProxyFilter>(config_);
+    filter_->setDecoderFilterCallbacks(callbacks_);
+  }
+
+  Common::DynamicForwardProxy::MockDnsCache& dnsCache() {
+    return *dns_cache_manager_factory_.dns_cache_manager_->dns_cache_;
+  }
+
+  NiceMock<Common::DynamicForwardProxy::MockDnsCacheManagerFactory> dns_cache_manager_factory_;
+  NiceMock<Upstream::MockClusterManager> cm_;
+  ProxyFilterConfigSharedPtr config_;
+  std::unique_ptr<ProxyFilter> filter_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks_;
+  Http::TestHeaderMapImpl request_headers_{{":authority", "foo"}};
+};
+
+// A cached host does not hold the request, and plain text clusters default to port 80.
+TEST_F(ProxyFilterTest, InCache) {
+  InSequence s;
+
+  EXPECT_CALL(callbacks_, route());
+  EXPECT_CALL(cm_, get(Eq("fake_cluster")));
+  EXPECT_CALL(dnsCache(), loadDnsCacheEntry_(Eq("foo"), 80, _))
+      .WillOnce(Return(MockLoadDnsCacheEntryResult{LoadDnsCacheEntryStatus::InCache, nullptr}));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data, false));
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->decodeTrailers(request_headers_));
+  filter_->onDestroy();
+}
+
+// A host that is loading holds the request until the load completes, and TLS clusters default to
+// port 443.
+TEST_F(ProxyFilterTest, HeldUntilLoaded) {
+  InSequence s;
+
+  Network::MockTransportSocketFactory transport_socket_factory;
+  EXPECT_CALL(callbacks_, route());
+  EXPECT_CALL(cm_, get(Eq("fake_cluster")));
+  EXPECT_CALL(*cm_.thread_local_cluster_.cluster_.info_, transportSocketFactory())
+      .WillOnce(ReturnRef(transport_socket_factory));
+  EXPECT_CALL(transport_socket_factory, implementsSecureTransport()).WillOnce(Return(true));
+  Common::DynamicForwardProxy::MockLoadDnsCacheEntryHandle* handle =
+      new Common::DynamicForwardProxy::MockLoadDnsCacheEntryHandle();
+  EXPECT_CALL(dnsCache(), loadDnsCacheEntry_(Eq("foo"), 443, _))
+      .WillOnce(Return(MockLoadDnsCacheEntryResult{LoadDnsCacheEntryStatus::Loading, handle}));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_->decodeHeaders(request_headers_, false));
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndWatermark, filter_->decodeData(data, false));
+  EXPECT_EQ(Http::FilterTrailersStatus::StopIteration, filter_->decodeTrailers(request_headers_));
+
+  EXPECT_CALL(*handle, onDestroy());
+  EXPECT_CALL(callbacks_, continueDecoding());
+  filter_->onLoadDnsCacheComplete();
+  filter_->onDestroy();
+}
+
+// Destroying a held request cancels its load.
+TEST_F(ProxyFilterTest, DestroyWhileHeld) {
+  InSequence s;
+
+  EXPECT_CALL(callbacks_, route());
+  EXPECT_CALL(cm_, get(Eq("fake_cluster")));
+  Common::DynamicForwardProxy::MockLoadDnsCacheEntryHandle* handle =
+      new Common::DynamicForwardProxy::MockLoadDnsCacheEntryHandle();
+  EXPECT_CALL(dnsCache(), loadDnsCacheEntry_(Eq("foo"), 80, _))
+      .WillOnce(Return(MockLoadDnsCacheEntryResult{LoadDnsCacheEntryStatus::Loading, handle}));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_->decodeHeaders(request_headers_, false));
+
+  EXPECT_CALL(*handle, onDestroy());
+  filter_->onDestroy();
+}
+
+// Requests without a route, without a cluster or without a host are not held.
+TEST_F(ProxyFilterTest, NotHeld) {
+  EXPECT_CALL(dnsCache(), loadDnsCacheEntry_(_, _, _)).Times(0);
+
+  EXPECT_CALL(callbacks_, route()).WillOnce(Return(nullptr));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+
+  EXPECT_CALL(callbacks_, route());
+  EXPECT_CALL(cm_, get(Eq("fake_cluster"))).WillOnce(Return(nullptr));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+
+  Http::TestHeaderMapImpl no_host_headers;
+  EXPECT_CALL(callbacks_, route());
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(no_host_headers, false));
+  filter_->onDestroy();
+}
+
+} // namespace
+} // namespace DynamicForwardProxy
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -22,9 +22,11 @@
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/tracing/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -52,12 +54,16 @@ public:
     if (!yaml.empty()) {
       MessageUtil::loadFromYaml(yaml, proto_config);
     }
-    config_.reset(
-        new FilterConfig(proto_config, local_info_, stats_store_, runtime_, http_context_));
+    config_.reset(new FilterConfig(proto_config, local_info_, stats_store_, runtime_,
+                                   http_context_, tls_, time_system_));
+    createFilter();
+    addr_ = std::make_shared<Network::Address::Ipv4Instance>("1.2.3.4", 1111);
+  }
+
+  void createFilter() {
     client_ = new Filters::Common::ExtAuthz::MockClient();
     filter_ = std::make_unique<Filter>(config_, Filters::Common::ExtAuthz::ClientPtr{client_});
     filter_->setDecoderFilterCallbacks(filter_callbacks_);
-    addr_ = std::make_shared<Network::Address::Ipv4Instance>("1.2.3.4", 1111);
   }
 
   FilterConfigSharedPtr config_;
@@ -71,6 +77,8 @@ public:
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Upstream::MockClusterManager> cm_;
   NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Event::SimulatedTimeSystem time_system_;
   Network::Address::InstanceConstSharedPtr addr_;
   NiceMock<Envoy::Network::MockConnection> connection_;
   Http::ContextImpl http_context_;
@@ -663,6 +671,113 @@ TEST_F(HttpFilterTestParam, ResetDuringCall) {
   filter_->onDestroy();
 }
 
+class HttpFilterDecisionCacheTest : public HttpFilterTest {
+public:
+  void SetUp() override {
+    initialize(R"EOF(
+    grpc_service:
+      envoy_grpc:
+        cluster_name: "ext_authz_server"
+    decision_cache:
+      key_headers: ["authorization"]
+      path_segments: 1
+      default_ttl: 10s
+    )EOF");
+  }
+
+  // Decodes the headers of a request on a new filter. If check_response is set, the request is
+  // expected to call the authorization service, which answers with it.
+  Http::FilterHeadersStatus
+  decodeHeaders(Http::TestHeaderMapImpl& headers,
+                const absl::optional<Filters::Common::ExtAuthz::Response>& check_response) {
+    createFilter();
+    if (check_response) {
+      prepareCheck();
+      EXPECT_CALL(*client_, check(_, _, _))
+          .WillOnce(WithArgs<0>(
+              Invoke([&](Filters::Common::ExtAuthz::RequestCallbacks& callbacks) -> void {
+                callbacks.onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(
+                    check_response.value()));
+              })));
+    } else {
+      EXPECT_CALL(*client_, check(_, _, _)).Times(0);
+    }
+    return filter_->decodeHeaders(headers, false);
+  }
+
+  uint64_t counter(const std::string& name) {
+    return filter_callbacks_.clusterInfo()->statsScope().counter("ext_authz." + name).value();
+  }
+
+  Filters::Common::ExtAuthz::Response okResponse() {
+    Filters::Common::ExtAuthz::Response response{};
+    response.status = Filters::Common::ExtAuthz::CheckStatus::OK;
+    response.headers_to_add = Http::HeaderVector{{Http::LowerCaseString{"x-user"}, "foo"}};
+    return response;
+  }
+};
+
+// Test that OK decisions are reused, with their headers, by the requests with the same key header
+// values and path prefix.
+TEST_F(HttpFilterDecisionCacheTest, CachesOkDecisions) {
+  Http::TestHeaderMapImpl first{{"authorization", "foo"}, {":path", "/api/users"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(first, okResponse()));
+  EXPECT_EQ("foo", first.get_("x-user"));
+
+  Http::TestHeaderMapImpl same_prefix{{"authorization", "foo"}, {":path", "/api/groups?id=1"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(same_prefix, absl::nullopt));
+  EXPECT_EQ("foo", same_prefix.get_("x-user"));
+  EXPECT_EQ(1U, counter("decision_cache_hit"));
+  EXPECT_EQ(1U, counter("decision_cache_miss"));
+  EXPECT_EQ(1U, counter("ok"));
+
+  Http::TestHeaderMapImpl other_prefix{{"authorization", "foo"}, {":path", "/admin"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(other_prefix, okResponse()));
+  Http::TestHeaderMapImpl other_value{{"authorization", "bar"}, {":path", "/api/users"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(other_value, okResponse()));
+  EXPECT_EQ(3U, counter("decision_cache_miss"));
+}
+
+// Test that decisions expire after the TTL of the check response, or the default TTL.
+TEST_F(HttpFilterDecisionCacheTest, Expiry) {
+  Http::TestHeaderMapImpl headers{{"authorization", "foo"}, {":path", "/api"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(headers, okResponse()));
+  time_system_.sleep(std::chrono::seconds(9));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(headers, absl::nullopt));
+  time_system_.sleep(std::chrono::seconds(1));
+  Filters::Common::ExtAuthz::Response response = okResponse();
+  response.cache_ttl = std::chrono::seconds(1);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(headers, response));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(headers, absl::nullopt));
+  time_system_.sleep(std::chrono::seconds(1));
+  response.cache_ttl = std::chrono::seconds(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(headers, response));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(headers, response));
+  EXPECT_EQ(2U, counter("decision_cache_hit"));
+  EXPECT_EQ(4U, counter("decision_cache_miss"));
+}
+
+// Test that denied decisions aren't cached.
+TEST_F(HttpFilterDecisionCacheTest, DeniedNotCached) {
+  Filters::Common::ExtAuthz::Response response{};
+  response.status = Filters::Common::ExtAuthz::CheckStatus::Denied;
+  response.status_code = Http::Code::Forbidden;
+  Http::TestHeaderMapImpl headers{{"authorization", "foo"}, {":path", "/api"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, decodeHeaders(headers, response));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, decodeHeaders(headers, response));
+  EXPECT_EQ(0U, counter("decision_cache_hit"));
+  EXPECT_EQ(2U, counter("decision_cache_miss"));
+}
+
+// Test that requests lacking a key header are neither looked up nor cached.
+TEST_F(HttpFilterDecisionCacheTest, MissingKeyHeader) {
+  Http::TestHeaderMapImpl headers{{":path", "/api"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(headers, okResponse()));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, decodeHeaders(headers, okResponse()));
+  EXPECT_EQ(0U, counter("decision_cache_hit"));
+  EXPECT_EQ(0U, counter("decision_cache_miss"));
+}
+
 } // namespace
 } // namespace ExtAuthz
 } // namespace HttpFilters
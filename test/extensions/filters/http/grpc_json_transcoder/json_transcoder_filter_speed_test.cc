@@ -0,0 +1,127 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/grpc/common.h"
+#include "common/protobuf/protobuf.h"
+
+#include "extensions/filters/http/grpc_json_transcoder/json_transcoder_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/proto/bookstore.pb.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+#include "google/api/httpbody.pb.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace GrpcJsonTranscoder {
+
+class TranscoderSpeedTest {
+public:
+  TranscoderSpeedTest() : api_(Api::createApiForTest()), config_(protoConfig(), *api_) {}
+
+  // Transcode a server streaming response of the given gRPC frames.
+  void transcode(const std::string& path, const Buffer::Instance& frame, uint64_t frames) {
+    testing::NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks;
+    testing::NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks;
+    JsonTranscoderFilter filter(config_);
+    filter.setDecoderFilterCallbacks(decoder_callbacks);
+    filter.setEncoderFilterCallbacks(encoder_callbacks);
+
+    Http::TestHeaderMapImpl request_headers{{":method", "GET"}, {":path", path}};
+    filter.decodeHeaders(request_headers, true);
+    Http::TestHeaderMapImpl response_headers{{"content-type", "application/grpc"},
+                                             {":status", "200"}};
+    filter.encodeHeaders(response_headers, false);
+    for (uint64_t i = 0; i < frames; i++) {
+      Buffer::OwnedImpl data(frame);
+      filter.encodeData(data, false);
+    }
+    Http::TestHeaderMapImpl response_trailers{{"grpc-status", "0"}};
+    filter.encodeTrailers(response_trailers);
+  }
+
+private:
+  // The descriptors of the bookstore service and their dependencies, so that the benchmark doesn't
+  // depend on runfiles.
+  static envoy::config::filter::http::transcoder::v2::GrpcJsonTranscoder protoConfig() {
+    Protobuf::FileDescriptorSet descriptor_set;
+    std::unordered_set<std::string> added;
+    addFile(*bookstore::Book::descriptor()->file(), descriptor_set, added);
+
+    envoy::config::filter::http::transcoder::v2::GrpcJsonTranscoder proto_config;
+    descriptor_set.SerializeToString(proto_config.mutable_proto_descriptor_bin());
+    proto_config.add_services("bookstore.Bookstore");
+    return proto_config;
+  }
+
+  static void addFile(const Protobuf::FileDescriptor& file,
+                      Protobuf::FileDescriptorSet& descriptor_set,
+                      std::unordered_set<std::string>& added) {
+    if (!added.insert(file.name()).second) {
+      return;
+    }
+    for (int i = 0; i < file.dependency_count(); i++) {
+      addFile(*file.dependency(i), descriptor_set, added);
+    }
+    file.CopyTo(descriptor_set.add_file());
+  }
+
+  Api::ApiPtr api_;
+  JsonTranscoderConfig config_;
+};
+
+} // namespace GrpcJsonTranscoder
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
+
+// Transcode server streaming Book messages of the given title size to JSON.
+static void BM_TranscodeServerStreamingJson(benchmark::State& state) {
+  Envoy::Extensions::HttpFilters::GrpcJsonTranscoder::TranscoderSpeedTest context;
+  bookstore::Book book;
+  book.set_id(1);
+  book.set_author("Leo Tolstoy");
+  book.set_title(std::string(state.range(0), 'a'));
+  const Envoy::Buffer::InstancePtr frame = Envoy::Grpc::Common::serializeBody(book);
+  constexpr uint64_t frames = 64;
+
+  for (auto _ : state) {
+    context.transcode("/shelves/1/books", *frame, frames);
+  }
+  state.SetBytesProcessed(state.iterations() * frames * frame->length());
+}
+BENCHMARK(BM_TranscodeServerStreamingJson)->Arg(64)->Arg(4096)->Arg(65536);
+
+// Transcode server streaming HttpBody messages of the given data size.
+static void BM_TranscodeServerStreamingHttpBody(benchmark::State& state) {
+  Envoy::Extensions::HttpFilters::GrpcJsonTranscoder::TranscoderSpeedTest context;
+  google::api::HttpBody http_body;
+  http_body.set_content_type("application/octet-stream");
+  http_body.set_data(std::string(state.range(0), 'a'));
+  const Envoy::Buffer::InstancePtr frame = Envoy::Grpc::Common::serializeBody(http_body);
+  constexpr uint64_t frames = 64;
+
+  for (auto _ : state) {
+    context.transcode("/indexStream", *frame, frames);
+  }
+  state.SetBytesProcessed(state.iterations() * frames * frame->length());
+}
+BENCHMARK(BM_TranscodeServerStreamingHttpBody)->Arg(64)->Arg(4096)->Arg(65536);
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
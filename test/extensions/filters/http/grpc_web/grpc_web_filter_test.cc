@@ -162,6 +162,27 @@ TEST_F(GrpcWebFilterTest, InvalidBase64) {
             filter_.decodeData(request_buffer, true));
 }
 
+// The padded base64 frames of a text request are decoded when they arrive together.
+TEST_F(GrpcWebFilterTest, Base64ConcatenatedFrames) {
+  Http::TestHeaderMapImpl request_headers;
+  request_headers.addCopy(Http::Headers::get().ContentType,
+                          Http::Headers::get().ContentTypeValues.GrpcWebText);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl request_buffer;
+  request_buffer.add(&B64_MESSAGE, B64_MESSAGE_SIZE);
+  request_buffer.add(&B64_MESSAGE, B64_MESSAGE_SIZE - 3);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(request_buffer, false));
+  Buffer::OwnedImpl decoded_buffer;
+  decoded_buffer.move(request_buffer);
+  request_buffer.add(B64_MESSAGE + B64_MESSAGE_SIZE - 3, 3);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(request_buffer, true));
+  decoded_buffer.move(request_buffer);
+  EXPECT_EQ(std::string(TEXT_MESSAGE, TEXT_MESSAGE_SIZE) +
+                std::string(TEXT_MESSAGE, TEXT_MESSAGE_SIZE),
+            decoded_buffer.toString());
+}
+
 TEST_F(GrpcWebFilterTest, Base64NoPadding) {
   Http::TestHeaderMapImpl request_headers;
   request_headers.addCopy(Http::Headers::get().ContentType,
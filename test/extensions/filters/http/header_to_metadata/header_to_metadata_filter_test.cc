@@ -9,7 +9,6 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
-using testing::_;
 using testing::NiceMock;
 
 namespace Envoy {
@@ -43,6 +42,10 @@ request_rules:
     filter_->setEncoderFilterCallbacks(encoder_callbacks_);
   }
 
+  const ProtobufWkt::Struct& dynamicMetadata(const std::string& name) const {
+    return req_info_.metadata_.filter_metadata().at(name);
+  }
+
   ConfigSharedPtr config_;
   std::shared_ptr<HeaderToMetadataFilter> filter_;
   NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
@@ -77,8 +80,8 @@ TEST_F(HeaderToMetadataTest, BasicRequestTest) {
   std::map<std::string, std::string> expected = {{"version", "0xdeadbeef"}};
 
   EXPECT_CALL(decoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
-  EXPECT_CALL(req_info_, setDynamicMetadata("envoy.lb", MapEq(expected)));
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(incoming_headers, false));
+  EXPECT_THAT(dynamicMetadata("envoy.lb"), MapEq(expected));
 }
 
 /**
@@ -90,8 +93,8 @@ TEST_F(HeaderToMetadataTest, DefaultEndpointsTest) {
   std::map<std::string, std::string> expected = {{"default", "true"}};
 
   EXPECT_CALL(decoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
-  EXPECT_CALL(req_info_, setDynamicMetadata("envoy.lb", MapEq(expected)));
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(incoming_headers, false));
+  EXPECT_THAT(dynamicMetadata("envoy.lb"), MapEq(expected));
 }
 
 /**
@@ -112,9 +115,8 @@ response_rules:
   Http::TestHeaderMapImpl empty_headers;
 
   EXPECT_CALL(encoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
-  EXPECT_CALL(req_info_,
-              setDynamicMetadata("envoy.filters.http.header_to_metadata", MapEq(expected)));
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(incoming_headers, false));
+  EXPECT_THAT(dynamicMetadata("envoy.filters.http.header_to_metadata"), MapEq(expected));
   EXPECT_EQ(empty_headers, incoming_headers);
   Http::MetadataMap metadata_map{{"metadata", "metadata"}};
   EXPECT_EQ(Http::FilterMetadataStatus::Continue, filter_->encodeMetadata(metadata_map));
@@ -137,9 +139,8 @@ response_rules:
   Http::TestHeaderMapImpl empty_headers;
 
   EXPECT_CALL(encoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
-  EXPECT_CALL(req_info_,
-              setDynamicMetadata("envoy.filters.http.header_to_metadata", MapEqNum(expected)));
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(incoming_headers, false));
+  EXPECT_THAT(dynamicMetadata("envoy.filters.http.header_to_metadata"), MapEqNum(expected));
 }
 
 /**
@@ -158,8 +159,8 @@ request_rules:
   Http::TestHeaderMapImpl incoming_headers{};
 
   EXPECT_CALL(decoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
-  EXPECT_CALL(req_info_, setDynamicMetadata(_, _)).Times(0);
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(incoming_headers, false));
+  EXPECT_TRUE(req_info_.metadata_.filter_metadata().empty());
 }
 
 /**
@@ -188,8 +189,8 @@ request_rules:
   std::map<std::string, std::string> expected = {{"version", "v4.0"}, {"python_version", "3.7"}};
 
   EXPECT_CALL(decoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
-  EXPECT_CALL(req_info_, setDynamicMetadata("envoy.lb", MapEq(expected)));
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(incoming_headers, false));
+  EXPECT_THAT(dynamicMetadata("envoy.lb"), MapEq(expected));
 }
 
 /**
@@ -200,8 +201,8 @@ TEST_F(HeaderToMetadataTest, EmptyHeaderValue) {
   Http::TestHeaderMapImpl incoming_headers{{"X-VERSION", ""}};
 
   EXPECT_CALL(decoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
-  EXPECT_CALL(req_info_, setDynamicMetadata(_, _)).Times(0);
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(incoming_headers, false));
+  EXPECT_TRUE(req_info_.metadata_.filter_metadata().empty());
 }
 
 /**
@@ -212,8 +213,8 @@ TEST_F(HeaderToMetadataTest, HeaderValueTooLong) {
   Http::TestHeaderMapImpl incoming_headers{{"X-VERSION", std::string(101, 'x')}};
 
   EXPECT_CALL(decoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
-  EXPECT_CALL(req_info_, setDynamicMetadata(_, _)).Times(0);
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(incoming_headers, false));
+  EXPECT_TRUE(req_info_.metadata_.filter_metadata().empty());
 }
 
 /**
@@ -235,9 +236,8 @@ response_rules:
   Http::TestHeaderMapImpl empty_headers;
 
   EXPECT_CALL(encoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
-  EXPECT_CALL(req_info_,
-              setDynamicMetadata("envoy.filters.http.header_to_metadata", MapEq(expected)));
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(incoming_headers, false));
+  EXPECT_THAT(dynamicMetadata("envoy.filters.http.header_to_metadata"), MapEq(expected));
   EXPECT_EQ(empty_headers, incoming_headers);
 }
 
@@ -270,8 +270,59 @@ request_rules:
   Http::TestHeaderMapImpl headers{{"x-version", ""}};
 
   EXPECT_CALL(decoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
-  EXPECT_CALL(req_info_, setDynamicMetadata(_, _)).Times(0);
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+  EXPECT_TRUE(req_info_.metadata_.filter_metadata().empty());
+}
+
+/**
+ * The rules of a header removed by an earlier rule find it missing.
+ */
+TEST_F(HeaderToMetadataTest, HeaderRemovedByEarlierRule) {
+  const std::string config = R"EOF(
+request_rules:
+  - header: x-version
+    on_header_present:
+      metadata_namespace: envoy.lb
+      key: version
+      type: STRING
+    remove: true
+  - header: x-version
+    on_header_present:
+      metadata_namespace: envoy.lb
+      key: version_again
+      type: STRING
+    on_header_missing:
+      metadata_namespace: envoy.lb
+      key: removed
+      value: 'true'
+      type: STRING
+)EOF";
+  initializeFilter(config);
+  Http::TestHeaderMapImpl incoming_headers{{"X-VERSION", "v1"}, {"X-FOO", "bar"}};
+  std::map<std::string, std::string> expected = {{"version", "v1"}, {"removed", "true"}};
+
+  EXPECT_CALL(decoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(incoming_headers, false));
+  EXPECT_THAT(dynamicMetadata("envoy.lb"), MapEq(expected));
+  EXPECT_EQ(0U, dynamicMetadata("envoy.lb").fields().count("version_again"));
+  EXPECT_EQ((Http::TestHeaderMapImpl{{"X-FOO", "bar"}}), incoming_headers);
+}
+
+/**
+ * The first of repeated headers is the one written to metadata, and the keys already in the
+ * namespace are kept.
+ */
+TEST_F(HeaderToMetadataTest, RepeatedHeaderAndExistingMetadata) {
+  initializeFilter(request_config_yaml);
+  Http::TestHeaderMapImpl incoming_headers{{"X-VERSION", "v1"}, {"X-VERSION", "v2"}};
+  ProtobufWkt::Struct existing;
+  (*existing.mutable_fields())["other"].set_string_value("value");
+  (*req_info_.metadata_.mutable_filter_metadata())["envoy.lb"] = existing;
+  std::map<std::string, std::string> expected = {{"version", "v1"}, {"other", "value"}};
+
+  EXPECT_CALL(decoder_callbacks_, streamInfo()).WillRepeatedly(ReturnRef(req_info_));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(incoming_headers, false));
+  EXPECT_THAT(dynamicMetadata("envoy.lb"), MapEq(expected));
 }
 
 } // namespace
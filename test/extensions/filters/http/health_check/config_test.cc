@@ -94,6 +94,44 @@ TEST(HealthCheckFilterConfig, NotFailingWhenNotPassThroughAndTimeoutNotSetProto)
   healthCheckFilterConfig.createFilterFactoryFromProto(config, "dummy_stats_prefix", context);
 }
 
+TEST(HealthCheckFilterConfig, FailsWhenCachingClusterHealthWithoutClustersProto) {
+  HealthCheckFilterConfig healthCheckFilterConfig;
+  envoy::config::filter::http::health_check::v2::HealthCheck config{};
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  config.mutable_pass_through_mode()->set_value(false);
+  config.set_cache_cluster_health(true);
+  envoy::api::v2::route::HeaderMatcher& header = *config.add_headers();
+  header.set_name(":path");
+  header.set_exact_match("foo");
+
+  EXPECT_THROW_WITH_MESSAGE(
+      healthCheckFilterConfig.createFilterFactoryFromProto(config, "dummy_stats_prefix", context),
+      EnvoyException,
+      "cache_cluster_health requires cluster_min_healthy_percentages and pass_through_mode to be "
+      "disabled");
+}
+
+TEST(HealthCheckFilterConfig, CachingClusterHealthProto) {
+  HealthCheckFilterConfig healthCheckFilterConfig;
+  envoy::config::filter::http::health_check::v2::HealthCheck config{};
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  config.mutable_pass_through_mode()->set_value(false);
+  config.set_cache_cluster_health(true);
+  (*config.mutable_cluster_min_healthy_percentages())["www1"].set_value(50.0);
+  envoy::api::v2::route::HeaderMatcher& header = *config.add_headers();
+  header.set_name(":path");
+  header.set_exact_match("foo");
+
+  EXPECT_CALL(context.cluster_manager_, addThreadLocalClusterUpdateCallbacks_(_));
+  Http::FilterFactoryCb cb =
+      healthCheckFilterConfig.createFilterFactoryFromProto(config, "dummy_stats_prefix", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamFilter(_));
+  cb(filter_callback);
+}
+
 TEST(HealthCheckFilterConfig, HealthCheckFilterWithEmptyProto) {
   HealthCheckFilterConfig healthCheckFilterConfig;
   NiceMock<Server::Configuration::MockFactoryContext> context;
@@ -45,14 +45,16 @@ public:
 
   void prepareFilter(
       bool pass_through,
-      ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages = nullptr) {
+      ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages = nullptr,
+      ClusterHealthCacheManagerSharedPtr cluster_health_cache_manager = nullptr) {
     header_data_ = std::make_shared<std::vector<Http::HeaderUtility::HeaderData>>();
     envoy::api::v2::route::HeaderMatcher matcher;
     matcher.set_name(":path");
     matcher.set_exact_match("/healthcheck");
     header_data_->emplace_back(matcher);
     filter_ = std::make_unique<HealthCheckFilter>(context_, pass_through, cache_manager_,
-                                                  header_data_, cluster_min_healthy_percentages);
+                                                  header_data_, cluster_min_healthy_percentages,
+                                                  cluster_health_cache_manager);
     filter_->setDecoderFilterCallbacks(callbacks_);
   }
 
@@ -207,6 +209,64 @@ TEST_F(HealthCheckFilterNoPassThroughTest, ComputedHealth) {
   }
 }
 
+TEST_F(HealthCheckFilterNoPassThroughTest, CachedClusterHealth) {
+  MockHealthCheckCluster cluster_www1(100, 50);
+  cluster_www1.cluster_.info_->name_ = "www1";
+  MockHealthCheckCluster cluster_other(100, 0);
+  cluster_other.cluster_.info_->name_ = "other";
+  EXPECT_CALL(context_.cluster_manager_, get("www1")).WillRepeatedly(Return(&cluster_www1));
+  EXPECT_CALL(context_.cluster_manager_, addThreadLocalClusterUpdateCallbacks_(_));
+  auto cluster_health_cache_manager = std::make_shared<ClusterHealthCacheManager>(
+      context_.cluster_manager_, context_.thread_local_,
+      ClusterMinHealthyPercentagesConstSharedPtr(
+          new ClusterMinHealthyPercentages{{"www1", 50.0}}));
+  prepareFilter(false,
+                ClusterMinHealthyPercentagesConstSharedPtr(
+                    new ClusterMinHealthyPercentages{{"www1", 50.0}}),
+                cluster_health_cache_manager);
+
+  // The health check requests don't look up the cluster.
+  EXPECT_CALL(context_, clusterManager()).Times(0);
+  {
+    Http::TestHeaderMapImpl health_check_response{{":status", "200"}};
+    EXPECT_CALL(callbacks_, encodeHeaders_(HeaderMapEqualRef(&health_check_response), true));
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              filter_->decodeHeaders(request_headers_, true));
+  }
+
+  // The response is updated when the hosts of the cluster are.
+  cluster_www1.info()->stats().membership_healthy_.set(49);
+  cluster_www1.cluster_.priority_set_.runUpdateCallbacks(0, {}, {});
+  {
+    Http::TestHeaderMapImpl health_check_response{{":status", "503"}};
+    EXPECT_CALL(callbacks_, encodeHeaders_(HeaderMapEqualRef(&health_check_response), true));
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              filter_->decodeHeaders(request_headers_, true));
+  }
+
+  // Clusters without a minimum healthy percentage are not watched.
+  cluster_health_cache_manager->onClusterAddOrUpdate(cluster_other);
+  EXPECT_EQ(Http::Code::ServiceUnavailable, cluster_health_cache_manager->getCachedResponse());
+
+  // A removed cluster is unhealthy, until it is added again.
+  EXPECT_CALL(context_.cluster_manager_, get("www1")).WillRepeatedly(Return(nullptr));
+  cluster_health_cache_manager->onClusterRemoval("www1");
+  EXPECT_EQ(Http::Code::ServiceUnavailable, cluster_health_cache_manager->getCachedResponse());
+  cluster_www1.info()->stats().membership_healthy_.set(50);
+  EXPECT_CALL(context_.cluster_manager_, get("www1")).WillRepeatedly(Return(&cluster_www1));
+  cluster_health_cache_manager->onClusterAddOrUpdate(cluster_www1);
+  {
+    Http::TestHeaderMapImpl health_check_response{{":status", "200"}};
+    EXPECT_CALL(callbacks_, encodeHeaders_(HeaderMapEqualRef(&health_check_response), true));
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              filter_->decodeHeaders(request_headers_, true));
+  }
+
+  // The cache manager unregisters its callbacks from the clusters, which must outlive it.
+  filter_.reset();
+  cluster_health_cache_manager.reset();
+}
+
 TEST_F(HealthCheckFilterNoPassThroughTest, HealthCheckFailedCallbackCalled) {
   EXPECT_CALL(context_, healthCheckFailed()).WillOnce(Return(true));
   EXPECT_CALL(callbacks_.stream_info_, healthCheck(true));
@@ -8,9 +8,11 @@
 
 #include "extensions/filters/http/ip_tagging/ip_tagging_filter.h"
 
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -45,12 +47,17 @@ ip_tags:
   void initializeFilter(const std::string& yaml) {
     envoy::config::filter::http::ip_tagging::v2::IPTagging config;
     MessageUtil::loadFromYaml(yaml, config);
-    config_.reset(new IpTaggingFilterConfig(config, "prefix.", stats_, runtime_));
+    config_.reset(
+        new IpTaggingFilterConfig(config, "prefix.", stats_, runtime_, provider_manager_));
     filter_ = std::make_unique<IpTaggingFilter>(config_);
     filter_->setDecoderFilterCallbacks(filter_callbacks_);
   }
 
-  ~IpTaggingFilterTest() { filter_->onDestroy(); }
+  ~IpTaggingFilterTest() {
+    if (filter_ != nullptr) {
+      filter_->onDestroy();
+    }
+  }
 
   IpTaggingFilterConfigSharedPtr config_;
   std::unique_ptr<IpTaggingFilter> filter_;
@@ -58,8 +65,25 @@ ip_tags:
   Buffer::OwnedImpl data_;
   NiceMock<Stats::MockStore> stats_;
   NiceMock<Runtime::MockLoader> runtime_;
+  Api::ApiPtr api_{Api::createApiForTest()};
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  IpTagsProviderManager provider_manager_{dispatcher_, tls_, *api_};
 };
 
+TEST_F(IpTaggingFilterTest, NoIpTags) {
+  EXPECT_THROW_WITH_MESSAGE(
+      initializeFilter("request_type: internal"), EnvoyException,
+      "HTTP IP Tagging Filter requires either ip_tags or ip_tags_path to be specified.");
+}
+
+TEST_F(IpTaggingFilterTest, IpTagsAndIpTagsPath) {
+  const std::string yaml = internal_request_yaml + "ip_tags_path: /tmp/ip_tags.yaml";
+  EXPECT_THROW_WITH_MESSAGE(
+      initializeFilter(yaml), EnvoyException,
+      "HTTP IP Tagging Filter requires either ip_tags or ip_tags_path to be specified.");
+}
+
 TEST_F(IpTaggingFilterTest, InternalRequest) {
   initializeFilter(internal_request_yaml);
   EXPECT_EQ(FilterRequestType::INTERNAL, config_->requestType());
@@ -0,0 +1,106 @@
+#include <string>
+#include <vector>
+
+#include "common/network/utility.h"
+
+#include "extensions/filters/http/ip_tagging/ip_tags_provider.h"
+
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::ElementsAre;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace IpTagging {
+namespace {
+
+class IpTagsProviderTest : public testing::Test {
+public:
+  IpTagsProviderTest() : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher()) {}
+
+  std::string writeIpTags(const std::string& filename, const std::string& tag,
+                          const std::string& address) {
+    return TestEnvironment::writeStringToFileForTest(filename, fmt::format(R"EOF(
+ip_tags:
+  - ip_tag_name: {}
+    ip_list:
+      - {{address_prefix: {}, prefix_len: 32}}
+)EOF",
+                                                                           tag, address));
+  }
+
+  std::vector<std::string> tags(const IpTagsProvider& provider, const std::string& address) {
+    return provider.trie().getData(Network::Utility::parseInternetAddress(address));
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  IpTagsProviderManager manager_{*dispatcher_, tls_, *api_};
+};
+
+TEST_F(IpTagsProviderTest, Load) {
+  const std::string path = writeIpTags("ip_tags_load.yaml", "tag_a", "1.2.3.4");
+  IpTagsProviderSharedPtr provider = manager_.getProvider(path);
+  EXPECT_THAT(tags(*provider, "1.2.3.4"), ElementsAre("tag_a"));
+  EXPECT_TRUE(tags(*provider, "1.2.3.5").empty());
+}
+
+TEST_F(IpTagsProviderTest, SharedByPath) {
+  const std::string path = writeIpTags("ip_tags_shared.yaml", "tag_a", "1.2.3.4");
+  IpTagsProviderSharedPtr provider = manager_.getProvider(path);
+  EXPECT_EQ(provider, manager_.getProvider(path));
+
+  // Once released, the file is loaded again for the next filter that uses it.
+  provider.reset();
+  writeIpTags("ip_tags_shared.yaml", "tag_b", "1.2.3.4");
+  provider = manager_.getProvider(path);
+  EXPECT_THAT(tags(*provider, "1.2.3.4"), ElementsAre("tag_b"));
+}
+
+TEST_F(IpTagsProviderTest, ReloadOnMove) {
+  const std::string path = writeIpTags("ip_tags_reload.yaml", "tag_a", "1.2.3.4");
+  IpTagsProviderSharedPtr provider = manager_.getProvider(path);
+
+  // The new trie is built off the main thread, and handed to the workers once built.
+  EXPECT_CALL(tls_, runOnAllThreads(_)).WillOnce(Invoke([this](Event::PostCb cb) -> void {
+    cb();
+    dispatcher_->exit();
+  }));
+  TestUtility::renameFile(writeIpTags("ip_tags_reload_new.yaml", "tag_b", "1.2.3.5"), path);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_TRUE(tags(*provider, "1.2.3.4").empty());
+  EXPECT_THAT(tags(*provider, "1.2.3.5"), ElementsAre("tag_b"));
+}
+
+TEST_F(IpTagsProviderTest, InvalidCidrRange) {
+  const std::string path = TestEnvironment::writeStringToFileForTest("ip_tags_invalid.yaml", R"EOF(
+ip_tags:
+  - ip_tag_name: tag_a
+    ip_list:
+      - {address_prefix: 1.2.3.4, prefix_len: 33}
+)EOF");
+  EXPECT_THROW_WITH_MESSAGE(manager_.getProvider(path), EnvoyException,
+                            "invalid ip/mask combo '1.2.3.4/33' (format is <ip>/<# mask bits>)");
+}
+
+TEST_F(IpTagsProviderTest, MissingFile) {
+  EXPECT_THROW(manager_.getProvider(TestEnvironment::temporaryPath("ip_tags_missing.yaml")),
+               EnvoyException);
+}
+
+} // namespace
+} // namespace IpTagging
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -43,7 +43,8 @@ public:
     raw_fetcher_ = new MockJwksFetcher;
     fetcher_.reset(raw_fetcher_);
     auth_ = Authenticator::create(check_audience, provider, !provider,
-                                  filter_config_->getCache().getJwksCache(), filter_config_->cm(),
+                                  filter_config_->getCache().getJwksCache(),
+                                  filter_config_->getCache().getTokenCache(), filter_config_->cm(),
                                   [this](Upstream::ClusterManager&) { return std::move(fetcher_); },
                                   filter_config_->timeSource());
     jwks_ = Jwks::createFrom(PublicKey, Jwks::JWKS);
@@ -94,6 +95,41 @@ TEST_F(AuthenticatorTest, TestOkJWTandCache) {
   }
 }
 
+// This test verifies that cached tokens skip their signature verification, but not their claims
+// checks.
+TEST_F(AuthenticatorTest, TestTokenCache) {
+  proto_config_.mutable_jwt_cache_size()->set_value(10);
+  CreateAuthenticator();
+  EXPECT_CALL(*raw_fetcher_, fetch(_, _))
+      .WillOnce(Invoke(
+          [this](const ::envoy::api::v2::core::HttpUri&, JwksFetcher::JwksReceiver& receiver) {
+            receiver.onJwksSuccess(std::move(jwks_));
+          }));
+
+  for (int i = 0; i < 2; i++) {
+    auto headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+    expectVerifyStatus(Status::Ok, headers);
+    EXPECT_EQ(headers.get_("sec-istio-auth-userinfo"), ExpectedPayloadValue);
+  }
+
+  // Tokens cached as verified by the keys of the provider are not verified again.
+  const auto* jwks_data =
+      filter_config_->getCache().getJwksCache().findByProvider(std::string(ProviderName));
+  ASSERT_NE(nullptr, jwks_data);
+  for (const char* token : {NonExistKidToken, ExpiredToken}) {
+    auto jwt = std::make_shared<::google::jwt_verify::Jwt>();
+    ASSERT_EQ(Status::Ok, jwt->parseFromString(token));
+    filter_config_->getCache().getTokenCache().insert(token, jwt, *jwks_data);
+  }
+
+  auto headers =
+      Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(NonExistKidToken)}};
+  expectVerifyStatus(Status::Ok, headers);
+
+  headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(ExpiredToken)}};
+  expectVerifyStatus(Status::JwtExpired, headers);
+}
+
 // This test verifies the Jwt is forwarded if "forward" flag is set.
 TEST_F(AuthenticatorTest, TestForwardJwt) {
   // Confit forward_jwt flag
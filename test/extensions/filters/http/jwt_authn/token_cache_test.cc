@@ -0,0 +1,94 @@
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/jwt_authn/jwks_cache.h"
+#include "extensions/filters/http/jwt_authn/token_cache.h"
+
+#include "test/extensions/filters/http/jwt_authn/test_common.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+using ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication;
+using ::google::jwt_verify::Status;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+namespace {
+
+class TokenCacheTest : public testing::Test {
+protected:
+  TokenCacheTest() : api_(Api::createApiForTest()) {}
+  void SetUp() override {
+    MessageUtil::loadFromYaml(ExampleConfig, config_);
+    jwks_cache_ = JwksCache::create(config_, time_system_, *api_);
+    jwks_data_ = jwks_cache_->findByProvider(ProviderName);
+    ASSERT_TRUE(jwks_data_ != nullptr);
+  }
+
+  void createCache(uint32_t size) {
+    config_.mutable_jwt_cache_size()->set_value(size);
+    cache_ = TokenCache::create(config_);
+  }
+
+  JwtConstSharedPtr parse(const std::string& token) {
+    auto jwt = std::make_shared<::google::jwt_verify::Jwt>();
+    EXPECT_EQ(jwt->parseFromString(token), Status::Ok);
+    return jwt;
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  JwtAuthentication config_;
+  Api::ApiPtr api_;
+  JwksCachePtr jwks_cache_;
+  JwksCache::JwksData* jwks_data_{};
+  TokenCachePtr cache_;
+};
+
+// Test that inserted tokens are found with their Jwks data object.
+TEST_F(TokenCacheTest, TestLookup) {
+  createCache(10);
+  EXPECT_TRUE(cache_->lookup(GoodToken) == nullptr);
+
+  const JwtConstSharedPtr jwt = parse(GoodToken);
+  cache_->insert(GoodToken, jwt, *jwks_data_);
+  const TokenCache::Entry* entry = cache_->lookup(GoodToken);
+  ASSERT_TRUE(entry != nullptr);
+  EXPECT_EQ(entry->jwt_, jwt);
+  EXPECT_EQ(entry->jwks_data_, jwks_data_);
+  EXPECT_TRUE(cache_->lookup(OtherGoodToken) == nullptr);
+}
+
+// Test that the least recently used token is evicted when the cache is full.
+TEST_F(TokenCacheTest, TestEviction) {
+  createCache(2);
+  cache_->insert(GoodToken, parse(GoodToken), *jwks_data_);
+  cache_->insert(ExpiredToken, parse(ExpiredToken), *jwks_data_);
+  EXPECT_TRUE(cache_->lookup(GoodToken) != nullptr);
+
+  cache_->insert(OtherGoodToken, parse(OtherGoodToken), *jwks_data_);
+  EXPECT_TRUE(cache_->lookup(GoodToken) != nullptr);
+  EXPECT_TRUE(cache_->lookup(ExpiredToken) == nullptr);
+  EXPECT_TRUE(cache_->lookup(OtherGoodToken) != nullptr);
+}
+
+// Test that clear() removes all the tokens.
+TEST_F(TokenCacheTest, TestClear) {
+  createCache(10);
+  cache_->insert(GoodToken, parse(GoodToken), *jwks_data_);
+  cache_->clear();
+  EXPECT_TRUE(cache_->lookup(GoodToken) == nullptr);
+}
+
+// Test that no tokens are cached by default.
+TEST_F(TokenCacheTest, TestDisabled) {
+  cache_ = TokenCache::create(config_);
+  cache_->insert(GoodToken, parse(GoodToken), *jwks_data_);
+  EXPECT_TRUE(cache_->lookup(GoodToken) == nullptr);
+}
+
+} // namespace
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -2,10 +2,12 @@
 
 #include "common/buffer/buffer_impl.h"
 #include "common/http/message_impl.h"
+#include "common/stats/isolated_store_impl.h"
 #include "common/stream_info/stream_info_impl.h"
 
 #include "extensions/filters/http/lua/lua_filter.h"
 
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/ssl/mocks.h"
@@ -68,7 +70,8 @@ public:
   ~LuaHttpFilterTest() { filter_->onDestroy(); }
 
   void setup(const std::string& lua_code) {
-    config_.reset(new FilterConfig(lua_code, tls_, cluster_manager_));
+    proto_config_.set_inline_code(lua_code);
+    config_.reset(new FilterConfig(proto_config_, tls_, cluster_manager_, "test.", stats_store_));
     setupFilter();
   }
 
@@ -91,6 +94,8 @@ public:
 
   NiceMock<ThreadLocal::MockInstance> tls_;
   Upstream::MockClusterManager cluster_manager_;
+  Stats::IsolatedStoreImpl stats_store_;
+  envoy::config::filter::http::lua::v2::Lua proto_config_;
   std::shared_ptr<FilterConfig> config_;
   std::unique_ptr<TestFilter> filter_;
   Http::MockStreamDecoderFilterCallbacks decoder_callbacks_;
@@ -159,6 +164,17 @@ public:
     end
   )EOF"};
 
+  const std::string BODY_PREFIX_SCRIPT{R"EOF(
+    function envoy_on_request(request_handle)
+      local body = request_handle:bodyPrefix(8)
+      if body ~= nil then
+        request_handle:logTrace(body:getBytes(0, math.min(body:length(), 8)))
+      else
+        request_handle:logTrace("no body")
+      end
+    end
+  )EOF"};
+
   const std::string BODY_TRAILERS_SCRIPT{R"EOF(
     function envoy_on_request(request_handle)
       request_handle:logTrace(request_handle:headers():get(":path"))
@@ -186,9 +202,13 @@ TEST(LuaHttpFilterConfigTest, BadCode) {
 
   NiceMock<ThreadLocal::MockInstance> tls;
   NiceMock<Upstream::MockClusterManager> cluster_manager;
-  EXPECT_THROW_WITH_MESSAGE(FilterConfig(SCRIPT, tls, cluster_manager),
-                            Filters::Common::Lua::LuaException,
-                            "script load error: [string \"...\"]:3: '=' expected near '<eof>'");
+  Stats::IsolatedStoreImpl stats_store;
+  envoy::config::filter::http::lua::v2::Lua proto_config;
+  proto_config.set_inline_code(SCRIPT);
+  EXPECT_THROW_WITH_MESSAGE(
+      FilterConfig(proto_config, tls, cluster_manager, "test.", stats_store),
+      Filters::Common::Lua::LuaException,
+      "script load error: [string \"...\"]:3: '=' expected near '<eof>'");
 }
 
 // Script touching headers only, request that is headers only.
@@ -429,6 +449,95 @@ TEST_F(LuaHttpFilterTest, ScriptBodyRequestBodyTwoFramesTrailers) {
   EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->decodeTrailers(request_trailers));
 }
 
+// Script asking for a body prefix, request that is headers only.
+TEST_F(LuaHttpFilterTest, ScriptBodyPrefixRequestHeadersOnly) {
+  InSequence s;
+  setup(BODY_PREFIX_SCRIPT);
+
+  Http::TestHeaderMapImpl request_headers{{":path", "/"}};
+  EXPECT_CALL(*filter_, scriptLog(spdlog::level::trace, StrEq("no body")));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+}
+
+// Script asking for a body prefix, request that has a body shorter than the prefix.
+TEST_F(LuaHttpFilterTest, ScriptBodyPrefixRequestShortBody) {
+  InSequence s;
+  setup(BODY_PREFIX_SCRIPT);
+
+  Http::TestHeaderMapImpl request_headers{{":path", "/"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_->decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_CALL(*filter_, scriptLog(spdlog::level::trace, StrEq("hello")));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data, true));
+}
+
+// Script asking for a body prefix, request whose second frame completes the prefix. The rest of
+// the body is streamed.
+TEST_F(LuaHttpFilterTest, ScriptBodyPrefixRequestBodyTwoFrames) {
+  InSequence s;
+  setup(BODY_PREFIX_SCRIPT);
+
+  Http::TestHeaderMapImpl request_headers{{":path", "/"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_->decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_->decodeData(data, false));
+  decoder_callbacks_.addDecodedData(data, false);
+
+  Buffer::OwnedImpl data2("world");
+  EXPECT_CALL(*filter_, scriptLog(spdlog::level::trace, StrEq("hellowor")));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data2, false));
+
+  Buffer::OwnedImpl data3("!");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data3, true));
+}
+
+// Script asking for a body prefix, request whose body is shorter than the prefix and followed by
+// trailers.
+TEST_F(LuaHttpFilterTest, ScriptBodyPrefixRequestBodyTrailers) {
+  InSequence s;
+  setup(BODY_PREFIX_SCRIPT);
+
+  Http::TestHeaderMapImpl request_headers{{":path", "/"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_->decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_->decodeData(data, false));
+  decoder_callbacks_.addDecodedData(data, false);
+
+  Http::TestHeaderMapImpl request_trailers{{"foo", "bar"}};
+  EXPECT_CALL(*filter_, scriptLog(spdlog::level::trace, StrEq("hello")));
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->decodeTrailers(request_trailers));
+}
+
+// Script calling body() after the body prefix.
+TEST_F(LuaHttpFilterTest, ScriptBodyAfterBodyPrefix) {
+  const std::string SCRIPT{R"EOF(
+    function envoy_on_request(request_handle)
+      request_handle:bodyPrefix(1)
+      request_handle:body()
+    end
+  )EOF"};
+
+  InSequence s;
+  setup(SCRIPT);
+
+  Http::TestHeaderMapImpl request_headers{{":path", "/"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_->decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_CALL(
+      *filter_,
+      scriptLog(spdlog::level::err,
+                StrEq("[string \"...\"]:4: cannot call body() after body has been streamed")));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data, true));
+}
+
 // Script asking for blocking body and trailers, request that is headers only.
 TEST_F(LuaHttpFilterTest, ScriptBodyTrailersRequestHeadersOnly) {
   InSequence s;
@@ -1279,6 +1388,43 @@ TEST_F(LuaHttpFilterTest, ImmediateResponse) {
   EXPECT_TRUE(config_->runtimeBytesUsed() < mem_use_at_start * 2);
 }
 
+// Scripts don't run while the Lua state uses more memory than the limit after a full GC.
+TEST_F(LuaHttpFilterTest, MemoryLimitExceeded) {
+  InSequence s;
+  proto_config_.mutable_max_memory_bytes()->set_value(1);
+  setup(HEADER_ONLY_SCRIPT);
+
+  Http::TestHeaderMapImpl request_headers{{":path", "/"}};
+  EXPECT_CALL(*filter_,
+              scriptLog(spdlog::level::err, StrEq("script not run: memory limit exceeded")));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  EXPECT_EQ(1U, stats_store_.counter("test.lua.memory_limit_gc").value());
+  EXPECT_EQ(1U, stats_store_.counter("test.lua.memory_limit_exceeded").value());
+}
+
+// Scripts run while the Lua state uses less memory than the limit.
+TEST_F(LuaHttpFilterTest, MemoryLimitNotExceeded) {
+  InSequence s;
+  proto_config_.mutable_max_memory_bytes()->set_value(1 << 30);
+  setup(HEADER_ONLY_SCRIPT);
+
+  Http::TestHeaderMapImpl request_headers{{":path", "/"}};
+  EXPECT_CALL(*filter_, scriptLog(spdlog::level::trace, StrEq("/")));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  EXPECT_EQ(0U, stats_store_.counter("test.lua.memory_limit_gc").value());
+}
+
+// A GC step is scheduled on the worker when a stream ends.
+TEST_F(LuaHttpFilterTest, GCStepOnDestroy) {
+  Event::MockTimer* timer = new Event::MockTimer(&tls_.dispatcher_);
+  proto_config_.mutable_gc_step_kb()->set_value(16);
+  setup(HEADER_ONLY_SCRIPT);
+
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(0)));
+  filter_->onDestroy();
+  timer->invokeCallback();
+}
+
 // Respond with bad status.
 TEST_F(LuaHttpFilterTest, ImmediateResponseBadStatus) {
   const std::string SCRIPT{R"EOF(
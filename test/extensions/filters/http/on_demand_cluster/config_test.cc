@@ -0,0 +1,55 @@
+#include "envoy/config/filter/http/on_demand_cluster/v2/on_demand_cluster.pb.validate.h"
+
+#include "extensions/filters/http/on_demand_cluster/config.h"
+
+#include "test/mocks/server/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace OnDemandCluster {
+namespace {
+
+TEST(OnDemandClusterFilterFactoryTest, OnDemandClusterFilterCorrectProto) {
+  envoy::config::filter::http::on_demand_cluster::v2::OnDemandCluster config;
+  config.mutable_timeout()->set_seconds(1);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  OnDemandClusterFilterFactory factory;
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(config, "stats", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamDecoderFilter(_));
+  cb(filter_callback);
+}
+
+TEST(OnDemandClusterFilterFactoryTest, OnDemandClusterFilterEmptyProto) {
+  OnDemandClusterFilterFactory factory;
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  auto config = factory.createEmptyConfigProto();
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(*config, "stats", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamDecoderFilter(_));
+  cb(filter_callback);
+}
+
+TEST(OnDemandClusterFilterFactoryTest, OnDemandClusterFilterZeroTimeout) {
+  envoy::config::filter::http::on_demand_cluster::v2::OnDemandCluster config;
+  config.mutable_timeout();
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  OnDemandClusterFilterFactory factory;
+  EXPECT_THROW(factory.createFilterFactoryFromProto(config, "stats", context),
+               ProtoValidationException);
+}
+
+} // namespace
+} // namespace OnDemandCluster
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,132 @@
+#include <chrono>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/on_demand_cluster/on_demand_cluster_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Eq;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace OnDemandCluster {
+namespace {
+
+class OnDemandClusterFilterTest : public testing::Test {
+public:
+  OnDemandClusterFilterTest() {
+    envoy::config::filter::http::on_demand_cluster::v2::OnDemandCluster proto_config;
+    proto_config.mutable_timeout()->set_seconds(2);
+    config_ = std::make_shared<OnDemandClusterFilterConfig>(proto_config, "test.", store_, cm_);
+    filter_ = std::make_unique<OnDemandClusterFilter>(config_);
+    filter_->setDecoderFilterCallbacks(callbacks_);
+    ON_CALL(cm_, get(_)).WillByDefault(Return(nullptr));
+  }
+
+  // Hold the request on a declared on-demand cluster, returning the mock handle.
+  Upstream::MockOnDemandClusterHandle* holdRequest() {
+    auto* handle = new Upstream::MockOnDemandClusterHandle();
+    EXPECT_CALL(cm_, requestOnDemandCluster_(Eq("fake_cluster"), _, _))
+        .WillOnce(Invoke([this, handle](const std::string&, Event::Dispatcher&,
+                                        Upstream::OnDemandClusterCallback callback)
+                             -> Upstream::OnDemandClusterHandle* {
+          callback_ = callback;
+          return handle;
+        }));
+    timer_ = new NiceMock<Event::MockTimer>(&callbacks_.dispatcher_);
+    EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(2000)));
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_->decodeHeaders(headers_, false));
+    EXPECT_EQ(1U, store_.counter("test.on_demand_cluster.rq_held").value());
+    return handle;
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<Upstream::MockClusterManager> cm_;
+  OnDemandClusterFilterConfigSharedPtr config_;
+  std::unique_ptr<OnDemandClusterFilter> filter_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks_;
+  Http::TestHeaderMapImpl headers_;
+  Upstream::OnDemandClusterCallback callback_;
+  Event::MockTimer* timer_{};
+};
+
+// Requests to clusters that exist and to clusters that are not on-demand are not held.
+TEST_F(OnDemandClusterFilterTest, NotHeld) {
+  EXPECT_CALL(cm_, get(Eq("fake_cluster"))).WillOnce(Return(&cm_.thread_local_cluster_));
+  EXPECT_CALL(cm_, requestOnDemandCluster_(_, _, _)).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers_, false));
+
+  EXPECT_CALL(cm_, requestOnDemandCluster_(Eq("fake_cluster"), _, _)).WillOnce(Return(nullptr));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers_, false));
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data, false));
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->decodeTrailers(headers_));
+  EXPECT_EQ(0U, store_.counter("test.on_demand_cluster.rq_held").value());
+}
+
+// Requests without a route entry are not held.
+TEST_F(OnDemandClusterFilterTest, NoRouteEntry) {
+  EXPECT_CALL(*callbacks_.route_, routeEntry()).WillOnce(Return(nullptr));
+  EXPECT_CALL(cm_, requestOnDemandCluster_(_, _, _)).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers_, false));
+}
+
+// A held request continues once the cluster is available.
+TEST_F(OnDemandClusterFilterTest, ClusterAvailable) {
+  auto* handle = holdRequest();
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndWatermark, filter_->decodeData(data, false));
+  EXPECT_EQ(Http::FilterTrailersStatus::StopIteration, filter_->decodeTrailers(headers_));
+
+  EXPECT_CALL(*handle, onDestroy());
+  EXPECT_CALL(*timer_, disableTimer());
+  EXPECT_CALL(callbacks_, continueDecoding());
+  callback_(true);
+  EXPECT_EQ(0U, store_.counter("test.on_demand_cluster.rq_unavailable").value());
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data, true));
+}
+
+// A held request continues to the router if the cluster could not be instantiated.
+TEST_F(OnDemandClusterFilterTest, ClusterUnavailable) {
+  auto* handle = holdRequest();
+  EXPECT_CALL(*handle, onDestroy());
+  EXPECT_CALL(callbacks_, continueDecoding());
+  callback_(false);
+  EXPECT_EQ(1U, store_.counter("test.on_demand_cluster.rq_unavailable").value());
+}
+
+// A held request continues after the timeout, cancelling the pending callback.
+TEST_F(OnDemandClusterFilterTest, Timeout) {
+  auto* handle = holdRequest();
+  EXPECT_CALL(*handle, onDestroy());
+  EXPECT_CALL(callbacks_, continueDecoding());
+  timer_->invokeCallback();
+  EXPECT_EQ(1U, store_.counter("test.on_demand_cluster.rq_timeout").value());
+}
+
+// Destroying the stream cancels the pending callback.
+TEST_F(OnDemandClusterFilterTest, Destroy) {
+  auto* handle = holdRequest();
+  EXPECT_CALL(*handle, onDestroy());
+  EXPECT_CALL(callbacks_, continueDecoding()).Times(0);
+  filter_->onDestroy();
+}
+
+} // namespace
+} // namespace OnDemandCluster
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -5,6 +5,7 @@
 #include "extensions/filters/http/ratelimit/config.h"
 
 #include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -52,6 +53,70 @@ TEST(RateLimitFilterConfigTest, RatelimitCorrectProto) {
   cb(filter_callback);
 }
 
+TEST(RateLimitFilterConfigTest, AggregationWindowProto) {
+  const std::string yaml = R"EOF(
+  domain: test
+  rate_limit_service:
+    grpc_service:
+      envoy_grpc:
+        cluster_name: ratelimit_cluster
+    aggregation_window: 0.1s
+  )EOF";
+
+  envoy::config::filter::http::rate_limit::v2::RateLimit proto_config{};
+  MessageUtil::loadFromYaml(yaml, proto_config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  // One factory for the reports of the aggregator, and one for the client of the filter.
+  EXPECT_CALL(context.cluster_manager_.async_client_manager_, factoryForGrpcService(_, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([](const envoy::api::v2::core::GrpcService&, Stats::Scope&, bool) {
+        return std::make_unique<NiceMock<Grpc::MockAsyncClientFactory>>();
+      }));
+
+  RateLimitFilterConfig factory;
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(proto_config, "stats", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamFilter(_));
+  cb(filter_callback);
+}
+
+TEST(RateLimitFilterConfigTest, LocalRateLimitProto) {
+  const std::string yaml = R"EOF(
+  domain: test
+  local_rate_limit:
+    limits:
+    - entries:
+      - key: remote_address
+      max_tokens: 10
+      fill_interval: 1s
+  )EOF";
+
+  envoy::config::filter::http::rate_limit::v2::RateLimit proto_config{};
+  MessageUtil::loadFromYaml(yaml, proto_config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  EXPECT_CALL(context.cluster_manager_.async_client_manager_, factoryForGrpcService(_, _, _))
+      .Times(0);
+
+  RateLimitFilterConfig factory;
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(proto_config, "stats", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamFilter(_));
+  cb(filter_callback);
+}
+
+TEST(RateLimitFilterConfigTest, NoRateLimitServiceOrLocalRateLimit) {
+  envoy::config::filter::http::rate_limit::v2::RateLimit proto_config{};
+  MessageUtil::loadFromYaml("domain: test", proto_config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  EXPECT_THROW_WITH_MESSAGE(
+      RateLimitFilterConfig().createFilterFactoryFromProto(proto_config, "stats", context),
+      EnvoyException, "rate limit filter: rate_limit_service or local_rate_limit must be set");
+}
+
 TEST(RateLimitFilterConfigTest, RateLimitFilterEmptyProto) {
   NiceMock<Server::Configuration::MockFactoryContext> context;
   NiceMock<Server::MockInstance> instance;
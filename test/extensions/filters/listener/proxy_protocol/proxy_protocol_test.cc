@@ -6,6 +6,7 @@
 
 #include "common/buffer/buffer_impl.h"
 #include "common/event/dispatcher_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/listener_impl.h"
 #include "common/network/raw_buffer_socket.h"
@@ -76,6 +77,10 @@ public:
   Stats::Scope& listenerScope() override { return stats_store_; }
   uint64_t listenerTag() const override { return 1; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
+  uint32_t maxConnectionsToAcceptPerSocketEvent() const override {
+    return Network::DefaultMaxConnectionsToAcceptPerSocketEvent;
+  }
 
   // Network::FilterChainManager
   const Network::FilterChain* findFilterChain(const Network::ConnectionSocket&) const override {
@@ -160,6 +165,7 @@ public:
   Network::MockConnectionCallbacks server_callbacks_;
   std::shared_ptr<Network::MockReadFilter> read_filter_;
   std::string name_;
+  Network::NopConnectionBalancerImpl connection_balancer_;
   const Network::FilterChainSharedPtr filter_chain_;
 };
 
@@ -293,15 +299,27 @@ TEST_P(ProxyProtocolTest, errorRecv_2) {
   expectProxyProtoError();
 }
 
-TEST_P(ProxyProtocolTest, errorFIONREAD_1) {
-  // A well formed v4/tcp message, no extensions, but introduce an error on ioctl(...FIONREAD...)
+TEST_P(ProxyProtocolTest, v2SingleRead) {
+  // A well formed v4/tcp message, no extensions, which is peeked at and consumed with a single read
   constexpr uint8_t buffer[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51, 0x55, 0x49,
                                 0x54, 0x0a, 0x21, 0x11, 0x00, 0x0c, 0x01, 0x02, 0x03, 0x04,
                                 0x00, 0x01, 0x01, 0x02, 0x03, 0x05, 0x00, 0x02, 'm',  'o',
                                 'r',  'e',  ' ',  'd',  'a',  't',  'a'};
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
-  EXPECT_CALL(os_sys_calls, ioctl(_, FIONREAD, _)).WillOnce(Return(Api::SysCallIntResult{-1, 0}));
+  EXPECT_CALL(os_sys_calls, ioctl(_, _, _)).Times(0);
+  EXPECT_CALL(os_sys_calls, recv(_, _, _, MSG_PEEK))
+      .Times(AtLeast(1))
+      .WillRepeatedly(Invoke([](int fd, void* buf, size_t len, int flags) {
+        const ssize_t rc = ::recv(fd, buf, len, flags);
+        return Api::SysCallSizeResult{rc, errno};
+      }));
+  EXPECT_CALL(os_sys_calls, recv(_, _, _, 0))
+      .WillOnce(Invoke([](int fd, void* buf, size_t len, int flags) {
+        EXPECT_EQ(sizeof(buffer) - 9, len);
+        const ssize_t rc = ::recv(fd, buf, len, flags);
+        return Api::SysCallSizeResult{rc, errno};
+      }));
   EXPECT_CALL(os_sys_calls, writev(_, _, _))
       .Times(AnyNumber())
       .WillRepeatedly(Invoke([](int fd, const struct iovec* iov, int iovcnt) {
@@ -315,10 +333,13 @@ TEST_P(ProxyProtocolTest, errorFIONREAD_1) {
         return Api::SysCallSizeResult{rc, errno};
       }));
 
-  connect(false);
+  connect();
   write(buffer, sizeof(buffer));
 
-  expectProxyProtoError();
+  expectData("more data");
+  EXPECT_EQ(server_connection_->remoteAddress()->ip()->addressAsString(), "1.2.3.4");
+
+  disconnect();
 }
 
 TEST_P(ProxyProtocolTest, v2NotLocalOrOnBehalf) {
@@ -616,8 +637,8 @@ TEST_P(ProxyProtocolTest, v2Fragmented2) {
 }
 
 TEST_P(ProxyProtocolTest, v2Fragmented3Error) {
-  // A well-formed ipv4/tcp header, delivering all of the signature +1, w/ an error
-  // simulated in recv() on the +1
+  // A well-formed ipv4/tcp header, delivering all of the signature +1, then the remainder, w/ an
+  // error simulated in the recv() consuming the header
   constexpr uint8_t buffer[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51, 0x55, 0x49,
                                 0x54, 0x0a, 0x21, 0x11, 0x00, 0x0c, 0x01, 0x02, 0x03, 0x04,
                                 0x00, 0x01, 0x01, 0x02, 0x03, 0x05, 0x00, 0x02, 'm',  'o',
@@ -632,7 +653,7 @@ TEST_P(ProxyProtocolTest, v2Fragmented3Error) {
         const ssize_t rc = ::recv(fd, buf, len, flags);
         return Api::SysCallSizeResult{rc, errno};
       }));
-  EXPECT_CALL(os_sys_calls, recv(_, _, 1, _))
+  EXPECT_CALL(os_sys_calls, recv(_, _, _, 0))
       .Times(AnyNumber())
       .WillOnce(Return(Api::SysCallSizeResult{-1, 0}));
 
@@ -657,13 +678,15 @@ TEST_P(ProxyProtocolTest, v2Fragmented3Error) {
 
   connect(false);
   write(buffer, 17);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  write(buffer + 17, 20);
 
   expectProxyProtoError();
 }
 
 TEST_P(ProxyProtocolTest, v2Fragmented4Error) {
   // A well-formed ipv4/tcp header, part of the signature with an error introduced
-  // in recv() on the remainder
+  // in the recv() peeking at the remainder
   constexpr uint8_t buffer[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51, 0x55, 0x49,
                                 0x54, 0x0a, 0x21, 0x11, 0x00, 0x0c, 0x01, 0x02, 0x03, 0x04,
                                 0x00, 0x01, 0x01, 0x02, 0x03, 0x05, 0x00, 0x02, 'm',  'o',
@@ -676,11 +699,11 @@ TEST_P(ProxyProtocolTest, v2Fragmented4Error) {
       .Times(AnyNumber())
       .WillRepeatedly(Invoke([](int fd, void* buf, size_t len, int flags) {
         const ssize_t rc = ::recv(fd, buf, len, flags);
+        if (rc == 20 && flags == MSG_PEEK) {
+          return Api::SysCallSizeResult{-1, 0};
+        }
         return Api::SysCallSizeResult{rc, errno};
       }));
-  EXPECT_CALL(os_sys_calls, recv(_, _, 4, _))
-      .Times(AnyNumber())
-      .WillOnce(Return(Api::SysCallSizeResult{-1, 0}));
 
   EXPECT_CALL(os_sys_calls, ioctl(_, _, _))
       .Times(AnyNumber())
@@ -904,6 +927,10 @@ public:
   Stats::Scope& listenerScope() override { return stats_store_; }
   uint64_t listenerTag() const override { return 1; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
+  uint32_t maxConnectionsToAcceptPerSocketEvent() const override {
+    return Network::DefaultMaxConnectionsToAcceptPerSocketEvent;
+  }
 
   // Network::FilterChainManager
   const Network::FilterChain* findFilterChain(const Network::ConnectionSocket&) const override {
@@ -966,6 +993,7 @@ public:
   Network::MockConnectionCallbacks server_callbacks_;
   std::shared_ptr<Network::MockReadFilter> read_filter_;
   std::string name_;
+  Network::NopConnectionBalancerImpl connection_balancer_;
   const Network::FilterChainSharedPtr filter_chain_;
 };
 
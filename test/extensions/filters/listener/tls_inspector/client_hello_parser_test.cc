@@ -0,0 +1,161 @@
+#include <string>
+#include <vector>
+
+#include "common/common/assert.h"
+
+#include "extensions/filters/listener/tls_inspector/client_hello_parser.h"
+
+#include "test/extensions/filters/listener/tls_inspector/tls_utility.h"
+
+#include "gtest/gtest.h"
+#include "openssl/bytestring.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ListenerFilters {
+namespace TlsInspector {
+namespace {
+
+typedef std::vector<std::pair<uint16_t, std::string>> Extensions;
+
+// Builds the body of a TLS 1.2 ClientHello with some extensions.
+std::string clientHelloBody(const Extensions& extensions) {
+  bssl::ScopedCBB cbb;
+  CBB session_id, cipher_suites, compression_methods, extensions_cbb;
+  const uint8_t random[SSL3_RANDOM_SIZE] = {};
+  RELEASE_ASSERT(CBB_init(cbb.get(), 0) && CBB_add_u16(cbb.get(), TLS1_2_VERSION) &&
+                     CBB_add_bytes(cbb.get(), random, sizeof(random)) &&
+                     CBB_add_u8_length_prefixed(cbb.get(), &session_id) &&
+                     CBB_add_u16_length_prefixed(cbb.get(), &cipher_suites) &&
+                     CBB_add_u16(&cipher_suites, 0xc02f) &&
+                     CBB_add_u8_length_prefixed(cbb.get(), &compression_methods) &&
+                     CBB_add_u8(&compression_methods, 0),
+                 "");
+  if (!extensions.empty()) {
+    RELEASE_ASSERT(CBB_add_u16_length_prefixed(cbb.get(), &extensions_cbb), "");
+    for (const auto& extension : extensions) {
+      CBB extension_cbb;
+      RELEASE_ASSERT(CBB_add_u16(&extensions_cbb, extension.first) &&
+                         CBB_add_u16_length_prefixed(&extensions_cbb, &extension_cbb) &&
+                         CBB_add_bytes(&extension_cbb,
+                                       reinterpret_cast<const uint8_t*>(extension.second.data()),
+                                       extension.second.size()),
+                     "");
+    }
+  }
+  uint8_t* data;
+  size_t len;
+  RELEASE_ASSERT(CBB_finish(cbb.get(), &data, &len), "");
+  bssl::UniquePtr<uint8_t> owned(data);
+  return std::string(reinterpret_cast<const char*>(data), len);
+}
+
+// Wraps a ClientHello body in its handshake header, split into records of at most
+// max_fragment_length bytes.
+std::vector<uint8_t> records(const std::string& body, size_t max_fragment_length = 16384) {
+  std::string handshake;
+  handshake.push_back(SSL3_MT_CLIENT_HELLO);
+  handshake.push_back(body.size() >> 16);
+  handshake.push_back(body.size() >> 8);
+  handshake.push_back(body.size());
+  handshake += body;
+
+  std::vector<uint8_t> records;
+  for (size_t offset = 0; offset < handshake.size(); offset += max_fragment_length) {
+    const size_t length = std::min(max_fragment_length, handshake.size() - offset);
+    records.insert(records.end(), {SSL3_RT_HANDSHAKE, 0x03, 0x01, static_cast<uint8_t>(length >> 8),
+                                   static_cast<uint8_t>(length)});
+    records.insert(records.end(), handshake.begin() + offset, handshake.begin() + offset + length);
+  }
+  return records;
+}
+
+std::string serverNameExtension(const std::string& host_name) {
+  std::string extension;
+  const size_t list_length = host_name.size() + 3;
+  extension.push_back(list_length >> 8);
+  extension.push_back(list_length);
+  extension.push_back(TLSEXT_NAMETYPE_host_name);
+  extension.push_back(host_name.size() >> 8);
+  extension.push_back(host_name.size());
+  return extension + host_name;
+}
+
+ClientHelloParser::Result parse(ClientHelloParser& parser, const std::vector<uint8_t>& data) {
+  return parser.parse(data.data(), data.size());
+}
+
+TEST(ClientHelloParserTest, BoringSslClientHello) {
+  const std::vector<uint8_t> client_hello =
+      Tls::Test::generateClientHello("example.com", "\x02h2\x08http/1.1");
+  ClientHelloParser parser;
+  EXPECT_EQ(ClientHelloParser::Result::ClientHello, parse(parser, client_hello));
+  EXPECT_EQ("example.com", parser.serverName());
+  ASSERT_TRUE(parser.applicationProtocols().has_value());
+  EXPECT_EQ(std::string("\x00\x0c\x02h2\x08http/1.1", 14), *parser.applicationProtocols());
+
+  // Every prefix needs more data.
+  for (size_t len = 0; len < client_hello.size(); len++) {
+    EXPECT_EQ(ClientHelloParser::Result::NeedMoreData, parser.parse(client_hello.data(), len));
+  }
+}
+
+TEST(ClientHelloParserTest, NoExtensions) {
+  ClientHelloParser parser;
+  EXPECT_EQ(ClientHelloParser::Result::ClientHello, parse(parser, records(clientHelloBody({}))));
+  EXPECT_EQ("", parser.serverName());
+  EXPECT_FALSE(parser.applicationProtocols().has_value());
+}
+
+// ClientHellos spanning several records are reassembled.
+TEST(ClientHelloParserTest, SeveralRecords) {
+  const std::vector<uint8_t> client_hello = records(
+      clientHelloBody({{TLSEXT_TYPE_server_name, serverNameExtension("www.example.com")}}), 7);
+  ClientHelloParser parser;
+  EXPECT_EQ(ClientHelloParser::Result::ClientHello, parse(parser, client_hello));
+  EXPECT_EQ("www.example.com", parser.serverName());
+  for (size_t len = 0; len < client_hello.size(); len++) {
+    EXPECT_EQ(ClientHelloParser::Result::NeedMoreData, parser.parse(client_hello.data(), len));
+  }
+}
+
+// Other protocols are told apart by the first bytes.
+TEST(ClientHelloParserTest, NotTls) {
+  ClientHelloParser parser;
+  const std::string request = "GET / HTTP/1.1\r\n";
+  EXPECT_EQ(ClientHelloParser::Result::NotClientHello,
+            parser.parse(reinterpret_cast<const uint8_t*>(request.data()), 1));
+  const std::vector<uint8_t> not_ssl3 = {SSL3_RT_HANDSHAKE, 0x02};
+  EXPECT_EQ(ClientHelloParser::Result::NotClientHello, parse(parser, not_ssl3));
+  const std::vector<uint8_t> server_hello = {SSL3_RT_HANDSHAKE, 0x03, 0x03, 0x00, 0x01,
+                                             SSL3_MT_SERVER_HELLO};
+  EXPECT_EQ(ClientHelloParser::Result::NotClientHello, parse(parser, server_hello));
+  const std::vector<uint8_t> record_too_large = {SSL3_RT_HANDSHAKE, 0x03, 0x03, 0x40, 0x01};
+  EXPECT_EQ(ClientHelloParser::Result::NotClientHello, parse(parser, record_too_large));
+}
+
+// ClientHellos BoringSSL rejects before its server name callback are rejected.
+TEST(ClientHelloParserTest, Malformed) {
+  ClientHelloParser parser;
+  const std::vector<uint8_t> empty_host_name =
+      records(clientHelloBody({{TLSEXT_TYPE_server_name, serverNameExtension("")}}));
+  EXPECT_EQ(ClientHelloParser::Result::NotClientHello, parse(parser, empty_host_name));
+  const std::vector<uint8_t> duplicate_server_name =
+      records(clientHelloBody({{TLSEXT_TYPE_server_name, serverNameExtension("a.com")},
+                               {TLSEXT_TYPE_server_name, serverNameExtension("b.com")}}));
+  EXPECT_EQ(ClientHelloParser::Result::NotClientHello, parse(parser, duplicate_server_name));
+  const std::vector<uint8_t> trailing_bytes = records(clientHelloBody({}) + "x");
+  EXPECT_EQ(ClientHelloParser::Result::NotClientHello, parse(parser, trailing_bytes));
+  EXPECT_EQ("", parser.serverName());
+
+  std::string ssl3_body = clientHelloBody({});
+  ssl3_body[1] = 0x00;
+  EXPECT_EQ(ClientHelloParser::Result::NotClientHello, parse(parser, records(ssl3_body)));
+}
+
+} // namespace
+} // namespace TlsInspector
+} // namespace ListenerFilters
+} // namespace Extensions
+} // namespace Envoy
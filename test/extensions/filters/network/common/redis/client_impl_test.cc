@@ -9,6 +9,7 @@
 
 #include "test/extensions/filters/network/common/redis/mocks.h"
 #include "test/extensions/filters/network/common/redis/test_utils.h"
+#include "test/mocks/buffer/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
@@ -291,10 +292,70 @@ TEST_F(RedisClientImplTest, ConnectFail) {
   EXPECT_EQ(1UL, host_->stats_.cx_connect_fail_.value());
 }
 
+TEST_F(RedisClientImplTest, BufferedRequests) {
+  InSequence s;
+
+  setup(std::make_unique<ConfigImpl>(createConnPoolSettings(16)));
+
+  Event::MockTimer* flush_timer = new Event::MockTimer(&dispatcher_);
+  Common::Redis::RespValue request1;
+  MockPoolCallbacks callbacks1;
+  EXPECT_CALL(*encoder_, encode(Ref(request1), _))
+      .WillOnce(Invoke([](const Common::Redis::RespValue&, Buffer::Instance& out) -> void {
+        out.add("get a");
+      }));
+  EXPECT_CALL(*flush_timer, enabled());
+  EXPECT_CALL(*flush_timer, enableTimer(std::chrono::milliseconds(3)));
+  EXPECT_CALL(*upstream_connection_, write(_, _)).Times(0);
+  PoolRequest* handle1 = client_->makeRequest(request1, callbacks1);
+  EXPECT_NE(nullptr, handle1);
+
+  onConnected();
+
+  // The second request is buffered with the first one, and the timer is left running.
+  Common::Redis::RespValue request2;
+  MockPoolCallbacks callbacks2;
+  EXPECT_CALL(*encoder_, encode(Ref(request2), _))
+      .WillOnce(Invoke([](const Common::Redis::RespValue&, Buffer::Instance& out) -> void {
+        out.add("get b");
+      }));
+  EXPECT_CALL(*flush_timer, enabled());
+  client_->makeRequest(request2, callbacks2);
+
+  // The timer writes both requests at once.
+  EXPECT_CALL(*flush_timer, enabled());
+  EXPECT_CALL(*upstream_connection_, write(BufferStringEqual("get aget b"), false))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) -> void { data.drain(data.length()); }));
+  flush_timer->invokeCallback();
+
+  // A request that fills the buffer is written immediately.
+  Common::Redis::RespValue request3;
+  MockPoolCallbacks callbacks3;
+  EXPECT_CALL(*encoder_, encode(Ref(request3), _))
+      .WillOnce(Invoke([](const Common::Redis::RespValue&, Buffer::Instance& out) -> void {
+        out.add("get 0123456789abcdef");
+      }));
+  EXPECT_CALL(*flush_timer, enabled());
+  EXPECT_CALL(*upstream_connection_, write(BufferStringEqual("get 0123456789abcdef"), false))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) -> void { data.drain(data.length()); }));
+  client_->makeRequest(request3, callbacks3);
+
+  EXPECT_CALL(host_->outlier_detector_, putResult(Upstream::Outlier::Result::SERVER_FAILURE));
+  EXPECT_CALL(callbacks1, onFailure());
+  EXPECT_CALL(callbacks2, onFailure());
+  EXPECT_CALL(callbacks3, onFailure());
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer());
+  upstream_connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+}
+
 class ConfigOutlierDisabled : public Config {
   bool disableOutlierEvents() const override { return true; }
   std::chrono::milliseconds opTimeout() const override { return std::chrono::milliseconds(25); }
   bool enableHashtagging() const override { return false; }
+  uint32_t maxBufferSizeBeforeFlush() const override { return 0; }
+  std::chrono::milliseconds bufferFlushTimeoutInMs() const override {
+    return std::chrono::milliseconds(0);
+  }
 };
 
 TEST_F(RedisClientImplTest, OutlierDisabled) {
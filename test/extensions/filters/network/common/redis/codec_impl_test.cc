@@ -2,6 +2,8 @@
 
 #include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/stack_array.h"
 
 #include "extensions/filters/network/common/redis/codec_impl.h"
 
@@ -78,6 +80,56 @@ TEST_F(RedisEncoderDecoderImplTest, BulkString) {
   EXPECT_EQ(0UL, buffer_.length());
 }
 
+TEST_F(RedisEncoderDecoderImplTest, MoveSmallBulkString) {
+  RespValue value;
+  value.type(RespType::BulkString);
+  value.asString() = "bulk string";
+  encoder_.move(value, buffer_);
+  EXPECT_EQ("$11\r\nbulk string\r\n", buffer_.toString());
+  EXPECT_EQ(1UL, buffer_.getRawSlices(nullptr, 0));
+}
+
+TEST_F(RedisEncoderDecoderImplTest, MoveLargeBulkString) {
+  const std::string body(EncoderImpl::MoveBulkStringThreshold, 'a');
+  auto make_value = [&body](RespValue& value) {
+    std::vector<RespValue> values(2);
+    values[0].type(RespType::BulkString);
+    values[0].asString() = "set";
+    values[1].type(RespType::BulkString);
+    values[1].asString() = body;
+    value.type(RespType::Array);
+    value.asArray().swap(values);
+  };
+
+  RespValue value;
+  make_value(value);
+  RespValue expected;
+  make_value(expected);
+  const char* body_data = value.asArray()[1].asString().data();
+  encoder_.move(value, buffer_);
+  EXPECT_EQ(fmt::format("*2\r\n$3\r\nset\r\n${}\r\n{}\r\n", body.size(), body),
+            buffer_.toString());
+
+  // The body is referenced by the buffer instead of being copied.
+  uint64_t num_slices = buffer_.getRawSlices(nullptr, 0);
+  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
+  buffer_.getRawSlices(slices.begin(), num_slices);
+  bool referenced = false;
+  for (const Buffer::RawSlice& slice : slices) {
+    referenced |= (slice.mem_ == body_data && slice.len_ == body.size());
+  }
+  EXPECT_TRUE(referenced);
+
+  // The large body is decoded whole even when it arrives in several buffers.
+  Buffer::OwnedImpl first_half;
+  first_half.move(buffer_, buffer_.length() / 2);
+  decoder_.decode(first_half);
+  EXPECT_TRUE(decoded_values_.empty());
+  decoder_.decode(buffer_);
+  EXPECT_EQ(expected, *decoded_values_[0]);
+  EXPECT_EQ(0UL, buffer_.length());
+}
+
 TEST_F(RedisEncoderDecoderImplTest, Integer) {
   RespValue value;
   value.type(RespType::Integer);
@@ -60,6 +60,10 @@ MockEncoder::MockEncoder() {
           Invoke([this](const Common::Redis::RespValue& value, Buffer::Instance& out) -> void {
             real_encoder_.encode(value, out);
           }));
+  ON_CALL(*this, move(_, _))
+      .WillByDefault(Invoke([this](Common::Redis::RespValue& value, Buffer::Instance& out) -> void {
+        real_encoder_.move(value, out);
+      }));
 }
 
 MockEncoder::~MockEncoder() {}
@@ -31,6 +31,7 @@ public:
   ~MockEncoder();
 
   MOCK_METHOD2(encode, void(const Common::Redis::RespValue& value, Buffer::Instance& out));
+  MOCK_METHOD2(move, void(Common::Redis::RespValue& value, Buffer::Instance& out));
 
 private:
   Common::Redis::EncoderImpl real_encoder_;
@@ -16,10 +16,11 @@ namespace Redis {
 namespace Client {
 
 inline envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings
-createConnPoolSettings() {
+createConnPoolSettings(uint32_t max_buffer_size_before_flush = 0) {
   envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings setting{};
   setting.mutable_op_timeout()->CopyFrom(Protobuf::util::TimeUtil::MillisecondsToDuration(20));
   setting.set_enable_hashtagging(true);
+  setting.set_max_buffer_size_before_flush(max_buffer_size_before_flush);
   return setting;
 }
 
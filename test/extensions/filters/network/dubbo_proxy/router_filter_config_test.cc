@@ -28,6 +28,19 @@ TEST(DubboProxyRouterFilterConfigTest, RouterV2Alpha1Filter) {
   cb(filter_callback);
 }
 
+TEST(DubboProxyRouterFilterConfigTest, RouterFilterWithMultiplexing) {
+  envoy::config::filter::dubbo::router::v2alpha1::Router router_config;
+  router_config.mutable_max_concurrent_requests_per_connection()->set_value(100);
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  RouterFilterConfig factory;
+  EXPECT_CALL(context.thread_local_, allocateSlot());
+  DubboFilters::FilterFactoryCb cb =
+      factory.createFilterFactoryFromProto(router_config, "stats", context);
+  DubboFilters::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addDecoderFilter(_));
+  cb(filter_callback);
+}
+
 TEST(DubboProxyRouterFilterConfigTest, RouterFilterWithEmptyProtoConfig) {
   NiceMock<Server::Configuration::MockFactoryContext> context;
   RouterFilterConfig factory;
@@ -1,5 +1,6 @@
 #include "extensions/filters/network/dubbo_proxy/app_exception.h"
 #include "extensions/filters/network/dubbo_proxy/deserializer.h"
+#include "extensions/filters/network/dubbo_proxy/dubbo_protocol_impl.h"
 #include "extensions/filters/network/dubbo_proxy/protocol.h"
 #include "extensions/filters/network/dubbo_proxy/router/router_impl.h"
 
@@ -79,7 +80,7 @@ public:
     route_ = new NiceMock<MockRoute>();
     route_ptr_.reset(route_);
 
-    router_ = std::make_unique<Router>(context_.clusterManager());
+    router_ = std::make_unique<Router>(context_.clusterManager(), multiplexer_.get());
 
     EXPECT_EQ(nullptr, router_->downstreamConnection());
 
@@ -191,6 +192,27 @@ public:
     upstream_callbacks_->onUpstreamData(buffer, false);
   }
 
+  std::string message(uint8_t flag, uint8_t status, int64_t request_id, const std::string& body) {
+    Buffer::OwnedImpl buffer;
+    buffer.writeBEInt<uint16_t>(0xdabb);
+    buffer.writeByte(flag);
+    buffer.writeByte(status);
+    buffer.writeBEInt<int64_t>(request_id);
+    buffer.writeBEInt<int32_t>(body.size());
+    buffer.add(body);
+    return buffer.toString();
+  }
+
+  std::string request(int64_t request_id) { return message(0xc2, 0, request_id, "request"); }
+  std::string response(int64_t request_id) { return message(0x02, 20, request_id, "response"); }
+
+  void sendRequest(Router& router, const std::string& request) {
+    Buffer::OwnedImpl buffer(request);
+    router.transferHeaderTo(buffer, DubboProtocolImpl::MessageSize);
+    router.transferBodyTo(buffer, buffer.length());
+    EXPECT_EQ(Network::FilterStatus::Continue, router.transportEnd());
+  }
+
   void destroyRouter() {
     router_->onDestroy();
     router_.reset();
@@ -205,6 +227,7 @@ public:
   std::function<void(MockProtocol*)> mock_protocol_cb_{};
 
   NiceMock<Server::Configuration::MockFactoryContext> context_;
+  std::unique_ptr<ConnectionMultiplexer> multiplexer_;
   NiceMock<Network::MockClientConnection> connection_;
   NiceMock<DubboFilters::MockDecoderFilterCallbacks> callbacks_;
   NiceMock<MockDeserializer>* deserializer_{};
@@ -528,6 +551,104 @@ TEST_F(DubboRouterTest, LocalClosedWhileResponseComplete) {
   destroyRouter();
 }
 
+// Requests of different downstream connections share an upstream connection, and the responses are
+// handed to their requests by request id.
+TEST_F(DubboRouterTest, MultiplexedCalls) {
+  multiplexer_ = std::make_unique<ConnectionMultiplexer>(context_.thread_local_, 2);
+  initializeRouter();
+  startRequest(MessageType::Request);
+  connectUpstream();
+
+  std::string upstream_data;
+  EXPECT_CALL(upstream_connection_, write(_, false))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) -> void {
+        upstream_data.append(data.toString());
+        data.drain(data.length());
+      }));
+
+  EXPECT_EQ(Network::FilterStatus::Continue, router_->transportBegin());
+  sendRequest(*router_, request(1));
+
+  // The second request reuses the connection of the first, while both use the same request id.
+  deserializer_ = nullptr;
+  protocol_ = nullptr;
+  NiceMock<DubboFilters::MockDecoderFilterCallbacks> callbacks2;
+  Router router2(context_.clusterManager(), multiplexer_.get());
+  router2.setDecoderFilterCallbacks(callbacks2);
+
+  EXPECT_CALL(callbacks2, route()).WillOnce(Return(route_ptr_));
+  EXPECT_CALL(*route_, routeEntry()).WillOnce(Return(&route_entry_));
+  EXPECT_CALL(callbacks2, downstreamSerializationType())
+      .WillOnce(Return(SerializationType::Hessian));
+  EXPECT_CALL(callbacks2, downstreamProtocolType()).WillOnce(Return(ProtocolType::Dubbo));
+  EXPECT_CALL(context_.cluster_manager_.tcp_conn_pool_, newConnection(_)).Times(0);
+
+  MessageMetadataSharedPtr metadata2 = std::make_shared<MessageMetadata>();
+  metadata2->setMessageType(MessageType::Request);
+  metadata2->setRequestId(1);
+  EXPECT_EQ(Network::FilterStatus::Continue, router2.transportBegin());
+  EXPECT_EQ(Network::FilterStatus::Continue, router2.messageEnd(metadata2));
+  sendRequest(router2, request(1));
+
+  EXPECT_EQ(request(0) + request(1), upstream_data);
+
+  EXPECT_CALL(callbacks2, startUpstreamResponse(_, _));
+  EXPECT_CALL(callbacks2, upstreamData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& data) -> DubboFilters::UpstreamResponseStatus {
+        EXPECT_EQ(response(1), data.toString());
+        return DubboFilters::UpstreamResponseStatus::Complete;
+      }));
+  EXPECT_CALL(callbacks_, startUpstreamResponse(_, _));
+  EXPECT_CALL(callbacks_, upstreamData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& data) -> DubboFilters::UpstreamResponseStatus {
+        EXPECT_EQ(response(1), data.toString());
+        return DubboFilters::UpstreamResponseStatus::Complete;
+      }));
+  EXPECT_CALL(upstream_connection_, close(_)).Times(0);
+  EXPECT_CALL(context_.cluster_manager_.tcp_conn_pool_, released(Ref(upstream_connection_)));
+
+  Buffer::OwnedImpl buffer(response(1) + response(0));
+  upstream_callbacks_->onUpstreamData(buffer, false);
+
+  router2.onDestroy();
+  destroyRouter();
+}
+
+// The response of a destroyed request may still arrive, so its connection isn't reused.
+TEST_F(DubboRouterTest, DestroyMultiplexedCall) {
+  multiplexer_ = std::make_unique<ConnectionMultiplexer>(context_.thread_local_, 2);
+  initializeRouter();
+  startRequest(MessageType::Request);
+  connectUpstream();
+
+  EXPECT_EQ(Network::FilterStatus::Continue, router_->transportBegin());
+  sendRequest(*router_, request(1));
+
+  EXPECT_CALL(upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(context_.cluster_manager_.tcp_conn_pool_, released(Ref(upstream_connection_)));
+  destroyRouter();
+}
+
+TEST_F(DubboRouterTest, MultiplexedConnectionRemoteClose) {
+  multiplexer_ = std::make_unique<ConnectionMultiplexer>(context_.thread_local_, 2);
+  initializeRouter();
+  startRequest(MessageType::Request);
+  connectUpstream();
+
+  EXPECT_EQ(Network::FilterStatus::Continue, router_->transportBegin());
+  sendRequest(*router_, request(1));
+
+  EXPECT_CALL(callbacks_, sendLocalReply(_, _))
+      .WillOnce(Invoke([&](const DubboFilters::DirectResponse& response, bool end_stream) -> void {
+        auto& app_ex = dynamic_cast<const AppException&>(response);
+        EXPECT_EQ(ResponseStatus::ServerError, app_ex.status_);
+        EXPECT_THAT(app_ex.what(), ContainsRegex(".*remote connection failure.*"));
+        EXPECT_FALSE(end_stream);
+      }));
+  upstream_callbacks_->onEvent(Network::ConnectionEvent::RemoteClose);
+  destroyRouter();
+}
+
 } // namespace Router
 } // namespace DubboProxy
 } // namespace NetworkFilters
@@ -105,6 +105,52 @@ http_filters:
   EXPECT_EQ(5 * 60 * 1000, config.streamIdleTimeout().count());
 }
 
+TEST_F(HttpConnectionManagerConfigTest, TailSamplingConfig) {
+  const std::string yaml_string = R"EOF(
+stat_prefix: router
+route_config:
+  name: local_route
+tracing:
+  operation_name: ingress
+  tail_sampling:
+    latency_threshold: 1.5s
+    errors: true
+    request_headers:
+    - name: x-debug
+      exact_match: "true"
+http_filters:
+- name: envoy.router
+  config: {}
+  )EOF";
+
+  HttpConnectionManagerConfig config(parseHttpConnectionManagerFromV2Yaml(yaml_string), context_,
+                                     date_provider_, route_config_provider_manager_);
+
+  const auto& tail_sampling = config.tracingConfig()->tail_sampling_;
+  ASSERT_TRUE(tail_sampling.has_value());
+  EXPECT_EQ(std::chrono::milliseconds(1500), tail_sampling->latency_threshold_.value());
+  EXPECT_TRUE(tail_sampling->errors_);
+  ASSERT_EQ(1, tail_sampling->request_headers_.size());
+  EXPECT_EQ(Http::LowerCaseString("x-debug"), tail_sampling->request_headers_[0].name_);
+}
+
+TEST_F(HttpConnectionManagerConfigTest, TailSamplingDisabledByDefault) {
+  const std::string yaml_string = R"EOF(
+stat_prefix: router
+route_config:
+  name: local_route
+tracing:
+  operation_name: ingress
+http_filters:
+- name: envoy.router
+  config: {}
+  )EOF";
+
+  HttpConnectionManagerConfig config(parseHttpConnectionManagerFromV2Yaml(yaml_string), context_,
+                                     date_provider_, route_config_provider_manager_);
+  EXPECT_FALSE(config.tracingConfig()->tail_sampling_.has_value());
+}
+
 TEST_F(HttpConnectionManagerConfigTest, UnixSocketInternalAddress) {
   const std::string yaml_string = R"EOF(
   stat_prefix: ingress_http
@@ -230,6 +276,36 @@ TEST_F(HttpConnectionManagerConfigTest, UnconfiguredRequestTimeout) {
   EXPECT_EQ(0, config.requestTimeout().count());
 }
 
+TEST_F(HttpConnectionManagerConfigTest, RouteCacheDisabledByDefault) {
+  const std::string yaml_string = R"EOF(
+  stat_prefix: ingress_http
+  route_config:
+    name: local_route
+  http_filters:
+  - name: envoy.router
+  )EOF";
+
+  HttpConnectionManagerConfig config(parseHttpConnectionManagerFromV2Yaml(yaml_string), context_,
+                                     date_provider_, route_config_provider_manager_);
+  EXPECT_EQ(nullptr, config.routeCache());
+}
+
+TEST_F(HttpConnectionManagerConfigTest, RouteCacheConfigured) {
+  const std::string yaml_string = R"EOF(
+  stat_prefix: ingress_http
+  route_cache_size: 16
+  route_config:
+    name: local_route
+  http_filters:
+  - name: envoy.router
+  )EOF";
+
+  HttpConnectionManagerConfig config(parseHttpConnectionManagerFromV2Yaml(yaml_string), context_,
+                                     date_provider_, route_config_provider_manager_);
+  ASSERT_NE(nullptr, config.routeCache());
+  EXPECT_EQ(0, config.routeCache()->size());
+}
+
 TEST_F(HttpConnectionManagerConfigTest, SingleDateProvider) {
   const std::string yaml_string = R"EOF(
 codec_type: http1
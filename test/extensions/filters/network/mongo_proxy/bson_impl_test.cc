@@ -52,6 +52,48 @@ TEST(BsonImplTest, InvalodDocumentTermination) {
   EXPECT_THROW(DocumentImpl::create(buffer), EnvoyException);
 }
 
+TEST(BsonImplTest, CreateFirstField) {
+  Buffer::OwnedImpl buffer;
+  DocumentImpl::create()
+      ->addArray("array", DocumentImpl::create()->addString("0", "foo")->addString("1", "bar"))
+      ->addString("hello", "world")
+      ->encode(buffer);
+  DocumentImpl::create()->addInt32("next", 1)->encode(buffer);
+
+  DocumentSharedPtr expected =
+      DocumentImpl::create()->addArray("array", DocumentImpl::create()->addString("0", "foo"));
+  EXPECT_EQ(*expected, *DocumentImpl::createFirstField(buffer));
+
+  // The rest of the document was skipped.
+  EXPECT_EQ(*DocumentImpl::create()->addInt32("next", 1), *DocumentImpl::create(buffer));
+  EXPECT_EQ(0U, buffer.length());
+}
+
+TEST(BsonImplTest, Skip) {
+  Buffer::OwnedImpl buffer;
+  DocumentSharedPtr doc = DocumentImpl::create()->addString("hello", "world");
+  doc->encode(buffer);
+  buffer.add("next");
+
+  EXPECT_EQ(doc->byteSize(), DocumentImpl::skip(buffer));
+  EXPECT_EQ("next", buffer.toString());
+}
+
+TEST(BsonImplTest, SkipInvalidMessageLength) {
+  {
+    Buffer::OwnedImpl buffer;
+    BufferHelper::writeInt32(buffer, 100);
+    EXPECT_THROW(DocumentImpl::skip(buffer), EnvoyException);
+  }
+
+  {
+    Buffer::OwnedImpl buffer;
+    BufferHelper::writeInt32(buffer, 4);
+    buffer.add(std::string(4, '\0'));
+    EXPECT_THROW(DocumentImpl::skip(buffer), EnvoyException);
+  }
+}
+
 TEST(BufferHelperTest, InvalidSize) {
   {
     Buffer::OwnedImpl buffer;
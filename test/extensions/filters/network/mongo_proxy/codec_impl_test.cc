@@ -11,9 +11,12 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::Eq;
+using testing::Invoke;
 using testing::NiceMock;
 using testing::Pointee;
+using testing::Return;
 
 namespace Envoy {
 namespace Extensions {
@@ -39,10 +42,13 @@ public:
   MOCK_METHOD1(decodeReply_, void(ReplyMessagePtr& message));
   MOCK_METHOD1(decodeCommand_, void(CommandMessagePtr& message));
   MOCK_METHOD1(decodeCommandReply_, void(CommandReplyMessagePtr& message));
+  MOCK_METHOD0(decodeDocuments, bool());
 };
 
 class MongoCodecImplTest : public testing::Test {
 public:
+  MongoCodecImplTest() { ON_CALL(callbacks_, decodeDocuments()).WillByDefault(Return(true)); }
+
   Buffer::OwnedImpl output_;
   EncoderImpl encoder_{output_};
   NiceMock<TestDecoderCallbacks> callbacks_;
@@ -123,6 +129,34 @@ TEST_F(MongoCodecImplTest, Query) {
   decoder_.onData(output_);
 }
 
+TEST_F(MongoCodecImplTest, LightweightQuery) {
+  QueryMessageImpl query(1, 1);
+  query.fullCollectionName("db.$cmd");
+  query.numberToReturn(-1);
+  query.query(Bson::DocumentImpl::create()
+                  ->addDocument("$query", Bson::DocumentImpl::create()
+                                              ->addString("find", "collection")
+                                              ->addString("comment", "comment"))
+                  ->addInt32("$maxTimeMS", 10));
+  query.returnFieldsSelector(Bson::DocumentImpl::create()->addDouble("double", 2.0));
+
+  encoder_.encodeQuery(query);
+  EXPECT_CALL(callbacks_, decodeDocuments()).WillOnce(Return(false));
+  EXPECT_CALL(callbacks_, decodeQuery_(_)).WillOnce(Invoke([](QueryMessagePtr& message) -> void {
+    EXPECT_FALSE(message->documentsDecoded());
+    EXPECT_EQ("db.$cmd", message->fullCollectionName());
+    EXPECT_EQ(-1, message->numberToReturn());
+    // Only the first field of the query, and of the document nested in it, is decoded.
+    EXPECT_EQ(*Bson::DocumentImpl::create()->addDocument(
+                  "$query", Bson::DocumentImpl::create()->addString("find", "collection")),
+              *message->query());
+    EXPECT_EQ(nullptr, message->returnFieldsSelector());
+    EXPECT_NO_THROW(Json::Factory::loadFromString(message->toString(true)));
+  }));
+  decoder_.onData(output_);
+  EXPECT_EQ(0U, output_.length());
+}
+
 TEST_F(MongoCodecImplTest, ReplyEqual) {
   {
     ReplyMessageImpl r1(0, 0);
@@ -164,6 +198,47 @@ TEST_F(MongoCodecImplTest, Reply) {
   encoder_.encodeReply(reply);
   EXPECT_CALL(callbacks_, decodeReply_(Pointee(Eq(reply))));
   decoder_.onData(output_);
+  EXPECT_EQ(10U, reply.documentsByteSize());
+}
+
+TEST_F(MongoCodecImplTest, LightweightReply) {
+  ReplyMessageImpl reply(2, 2);
+  reply.flags(0x8);
+  reply.cursorId(20000);
+  reply.numberReturned(2);
+  reply.documents().push_back(Bson::DocumentImpl::create()->addString("hello", "world"));
+  reply.documents().push_back(Bson::DocumentImpl::create());
+
+  encoder_.encodeReply(reply);
+  EXPECT_CALL(callbacks_, decodeDocuments()).WillOnce(Return(false));
+  EXPECT_CALL(callbacks_, decodeReply_(_))
+      .WillOnce(Invoke([&reply](ReplyMessagePtr& message) -> void {
+        EXPECT_FALSE(message->documentsDecoded());
+        EXPECT_EQ(0x8, message->flags());
+        EXPECT_EQ(20000, message->cursorId());
+        EXPECT_EQ(2, message->numberReturned());
+        EXPECT_TRUE(message->documents().empty());
+        EXPECT_EQ(reply.documentsByteSize(), message->documentsByteSize());
+        EXPECT_NE(std::string::npos, message->toString(true).find(R"EOF("documents": 2)EOF"));
+      }));
+  decoder_.onData(output_);
+  EXPECT_EQ(0U, output_.length());
+}
+
+TEST_F(MongoCodecImplTest, LightweightReplyInvalidDocument) {
+  ReplyMessageImpl reply(2, 2);
+  reply.numberReturned(1);
+  reply.documents().push_back(Bson::DocumentImpl::create());
+  encoder_.encodeReply(reply);
+
+  // The size of the document overflows the message.
+  Buffer::OwnedImpl data;
+  data.move(output_, output_.length() - 5);
+  Bson::BufferHelper::writeInt32(data, 6);
+  data.add(std::string(2, '\0'));
+
+  EXPECT_CALL(callbacks_, decodeDocuments()).WillOnce(Return(false));
+  EXPECT_THROW(decoder_.onData(data), EnvoyException);
 }
 
 TEST_F(MongoCodecImplTest, GetMoreEqual) {
@@ -237,6 +312,24 @@ TEST_F(MongoCodecImplTest, Insert) {
   decoder_.onData(output_);
 }
 
+TEST_F(MongoCodecImplTest, LightweightInsert) {
+  InsertMessageImpl insert(4, 4);
+  insert.fullCollectionName("test");
+  insert.documents().push_back(Bson::DocumentImpl::create()->addString("hello", "world"));
+  insert.documents().push_back(Bson::DocumentImpl::create());
+
+  encoder_.encodeInsert(insert);
+  EXPECT_CALL(callbacks_, decodeDocuments()).WillOnce(Return(false));
+  EXPECT_CALL(callbacks_, decodeInsert_(_)).WillOnce(Invoke([](InsertMessagePtr& message) -> void {
+    EXPECT_FALSE(message->documentsDecoded());
+    EXPECT_EQ("test", message->fullCollectionName());
+    EXPECT_TRUE(message->documents().empty());
+    EXPECT_NE(std::string::npos, message->toString(true).find(R"EOF("documents": 2)EOF"));
+  }));
+  decoder_.onData(output_);
+  EXPECT_EQ(0U, output_.length());
+}
+
 TEST_F(MongoCodecImplTest, KillCursorsEqual) {
   {
     KillCursorsMessageImpl k1(0, 0);
@@ -393,6 +486,31 @@ TEST_F(MongoCodecImplTest, Command) {
   decoder_.onData(output_);
 }
 
+TEST_F(MongoCodecImplTest, LightweightCommand) {
+  CommandMessageImpl command(15, 25);
+  command.database(std::string("database"));
+  command.commandName(std::string("command"));
+  command.metadata(Bson::DocumentImpl::create());
+  command.commandArgs(Bson::DocumentImpl::create()->addString("hello", "world"));
+  command.inputDocs().push_back(Bson::DocumentImpl::create()->addString("world", "hello"));
+
+  encoder_.encodeCommand(command);
+  EXPECT_CALL(callbacks_, decodeDocuments()).WillOnce(Return(false));
+  EXPECT_CALL(callbacks_, decodeCommand_(_))
+      .WillOnce(Invoke([](CommandMessagePtr& message) -> void {
+        EXPECT_FALSE(message->documentsDecoded());
+        EXPECT_EQ("database", message->database());
+        EXPECT_EQ("command", message->commandName());
+        EXPECT_EQ(nullptr, message->metadata());
+        EXPECT_EQ(nullptr, message->commandArgs());
+        EXPECT_TRUE(message->inputDocs().empty());
+        EXPECT_NO_THROW(Json::Factory::loadFromString(message->toString(true)));
+        EXPECT_NO_THROW(Json::Factory::loadFromString(message->toString(false)));
+      }));
+  decoder_.onData(output_);
+  EXPECT_EQ(0U, output_.length());
+}
+
 TEST_F(MongoCodecImplTest, CommandReplyEqual) {
   {
     CommandReplyMessageImpl m1(0, 0);
@@ -442,6 +560,26 @@ TEST_F(MongoCodecImplTest, CommandReply) {
   decoder_.onData(output_);
 }
 
+TEST_F(MongoCodecImplTest, LightweightCommandReply) {
+  CommandReplyMessageImpl command_reply(16, 26);
+  command_reply.metadata(Bson::DocumentImpl::create());
+  command_reply.commandReply(Bson::DocumentImpl::create()->addString("hello", "world"));
+  command_reply.outputDocs().push_back(Bson::DocumentImpl::create()->addString("world", "hello"));
+
+  encoder_.encodeCommandReply(command_reply);
+  EXPECT_CALL(callbacks_, decodeDocuments()).WillOnce(Return(false));
+  EXPECT_CALL(callbacks_, decodeCommandReply_(_))
+      .WillOnce(Invoke([](CommandReplyMessagePtr& message) -> void {
+        EXPECT_FALSE(message->documentsDecoded());
+        EXPECT_EQ(16, message->requestId());
+        EXPECT_EQ(nullptr, message->metadata());
+        EXPECT_EQ(nullptr, message->commandReply());
+        EXPECT_TRUE(message->outputDocs().empty());
+      }));
+  decoder_.onData(output_);
+  EXPECT_EQ(0U, output_.length());
+}
+
 } // namespace MongoProxy
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -52,6 +52,27 @@ TEST(MongoFilterConfigTest, ValidProtoConfigurationNoFaults) {
   cb(connection);
 }
 
+TEST(MongoFilterConfigTest, ValidProtoConfigurationLightweightDecode) {
+  const std::string yaml = R"EOF(
+stat_prefix: my_stat_prefix
+lightweight_decode: true
+full_decode_percent:
+  numerator: 1
+query_stats_percent:
+  numerator: 10
+  )EOF";
+
+  envoy::config::filter::network::mongo_proxy::v2::MongoProxy config;
+  MessageUtil::loadFromYaml(yaml, config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  MongoProxyFilterConfigFactory factory;
+  Network::FilterFactoryCb cb = factory.createFilterFactoryFromProto(config, context);
+  Network::MockConnection connection;
+  EXPECT_CALL(connection, addFilter(_));
+  cb(connection);
+}
+
 TEST(MongoFilterConfigTest, MongoFilterWithEmptyProto) {
   NiceMock<Server::Configuration::MockFactoryContext> context;
   MongoProxyFilterConfigFactory factory;
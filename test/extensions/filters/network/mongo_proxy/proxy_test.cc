@@ -71,6 +71,10 @@ public:
         .WillByDefault(Return(true));
     ON_CALL(runtime_.snapshot_, featureEnabled("mongo.logging_enabled", 100))
         .WillByDefault(Return(true));
+    ON_CALL(runtime_.snapshot_,
+            featureEnabled("mongo.query_stats_percent",
+                           Matcher<const envoy::type::FractionalPercent&>(Percent(100))))
+        .WillByDefault(Return(true));
 
     EXPECT_CALL(read_filter_callbacks_, connection())
         .WillRepeatedly(ReturnRef(read_filter_callbacks_.connection_));
@@ -82,9 +86,10 @@ public:
   }
 
   void initializeFilter(bool emit_dynamic_metadata = false) {
-    filter_ = std::make_unique<TestProxyFilter>("test.", store_, runtime_, access_log_,
-                                                fault_config_, drain_decision_,
-                                                dispatcher_.timeSource(), emit_dynamic_metadata);
+    filter_ = std::make_unique<TestProxyFilter>(
+        "test.", store_, runtime_, access_log_, fault_config_, drain_decision_,
+        dispatcher_.timeSource(), emit_dynamic_metadata, lightweight_decode_, full_decode_percent_,
+        query_stats_percent_);
     filter_->initializeReadFilterCallbacks(read_filter_callbacks_);
     filter_->onNewConnection();
 
@@ -125,6 +130,24 @@ public:
   Envoy::AccessLog::MockAccessLogManager log_manager_;
   NiceMock<Network::MockDrainDecision> drain_decision_;
   TestStreamInfo stream_info_;
+  bool lightweight_decode_{};
+  envoy::type::FractionalPercent full_decode_percent_;
+  envoy::type::FractionalPercent query_stats_percent_{percent(100)};
+
+  static envoy::type::FractionalPercent percent(uint32_t numerator) {
+    envoy::type::FractionalPercent percent;
+    percent.set_numerator(numerator);
+    percent.set_denominator(envoy::type::FractionalPercent::HUNDRED);
+    return percent;
+  }
+
+  // Decode the body of a message without its documents, as in lightweight mode.
+  template <class T> static std::unique_ptr<T> lightweightDecode(Buffer::Instance& message) {
+    message.drain(Message::MessageHeaderSize);
+    std::unique_ptr<T> decoded = std::make_unique<T>(0, 0);
+    decoded->fromBuffer(message.length(), message, false);
+    return decoded;
+  }
 };
 
 TEST_F(MongoProxyFilterTest, DelayFaults) {
@@ -410,6 +433,103 @@ TEST_F(MongoProxyFilterTest, CommandStats) {
   EXPECT_EQ(1U, store_.counter("test.cmd.foo.total").value());
 }
 
+TEST_F(MongoProxyFilterTest, DecodeDocuments) {
+  initializeFilter();
+  EXPECT_CALL(runtime_.snapshot_,
+              featureEnabled("mongo.full_decode_percent",
+                             Matcher<const envoy::type::FractionalPercent&>(_)))
+      .Times(0);
+  EXPECT_TRUE(filter_->decodeDocuments());
+
+  lightweight_decode_ = true;
+  full_decode_percent_ = percent(10);
+  initializeFilter();
+  EXPECT_CALL(runtime_.snapshot_,
+              featureEnabled("mongo.full_decode_percent",
+                             Matcher<const envoy::type::FractionalPercent&>(Percent(10))))
+      .WillOnce(Return(false))
+      .WillOnce(Return(true));
+  EXPECT_FALSE(filter_->decodeDocuments());
+  EXPECT_TRUE(filter_->decodeDocuments());
+}
+
+// Without the documents of the query, only the stats that don't depend on them are emitted, while
+// the stats of the reply are complete.
+TEST_F(MongoProxyFilterTest, LightweightDecodeStats) {
+  initializeFilter();
+
+  EXPECT_CALL(*filter_->decoder_, onData(_)).WillOnce(Invoke([&](Buffer::Instance&) -> void {
+    QueryMessageImpl query(0, 0);
+    query.fullCollectionName("db.test");
+    query.query(Bson::DocumentImpl::create()->addString("hello", "world"));
+    Buffer::OwnedImpl buffer;
+    EncoderImpl(buffer).encodeQuery(query);
+    filter_->callbacks_->decodeQuery(lightweightDecode<QueryMessageImpl>(buffer));
+  }));
+  filter_->onData(fake_data_, false);
+
+  EXPECT_CALL(store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "test.collection.test.query.reply_num_docs"), 2));
+  EXPECT_CALL(store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "test.collection.test.query.reply_size"), 27));
+  EXPECT_CALL(store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "test.collection.test.query.reply_time_ms"), _));
+
+  EXPECT_CALL(*filter_->decoder_, onData(_)).WillOnce(Invoke([&](Buffer::Instance&) -> void {
+    ReplyMessageImpl reply(0, 0);
+    reply.numberReturned(2);
+    reply.documents().push_back(Bson::DocumentImpl::create()->addString("hello", "world"));
+    reply.documents().push_back(Bson::DocumentImpl::create());
+    Buffer::OwnedImpl buffer;
+    EncoderImpl(buffer).encodeReply(reply);
+    filter_->callbacks_->decodeReply(lightweightDecode<ReplyMessageImpl>(buffer));
+  }));
+  filter_->onWrite(fake_data_, false);
+
+  EXPECT_EQ(1U, store_.counter("test.op_query").value());
+  EXPECT_EQ(0U, store_.counter("test.op_query_no_max_time").value());
+  EXPECT_EQ(0U, store_.counter("test.op_query_scatter_get").value());
+  EXPECT_EQ(1U, store_.counter("test.collection.test.query.total").value());
+  EXPECT_EQ(0U, store_.counter("test.collection.test.query.scatter_get").value());
+  EXPECT_EQ(1U, store_.counter("test.op_reply").value());
+}
+
+TEST_F(MongoProxyFilterTest, QueryStatsSampling) {
+  query_stats_percent_ = percent(10);
+  initializeFilter();
+
+  EXPECT_CALL(runtime_.snapshot_,
+              featureEnabled("mongo.query_stats_percent",
+                             Matcher<const envoy::type::FractionalPercent&>(Percent(10))))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*filter_->decoder_, onData(_)).WillOnce(Invoke([&](Buffer::Instance&) -> void {
+    QueryMessagePtr message(new QueryMessageImpl(0, 0));
+    message->fullCollectionName("db.test");
+    message->query(Bson::DocumentImpl::create());
+    filter_->callbacks_->decodeQuery(std::move(message));
+  }));
+  filter_->onData(fake_data_, false);
+  EXPECT_EQ(1U, store_.gauge("test.op_query_active").value());
+
+  EXPECT_CALL(store_, deliverHistogramToSinks(_, _)).Times(0);
+  EXPECT_CALL(*filter_->decoder_, onData(_)).WillOnce(Invoke([&](Buffer::Instance&) -> void {
+    ReplyMessagePtr message(new ReplyMessageImpl(0, 0));
+    message->documents().push_back(Bson::DocumentImpl::create());
+    filter_->callbacks_->decodeReply(std::move(message));
+  }));
+  filter_->onWrite(fake_data_, false);
+
+  // The global stats are still emitted.
+  EXPECT_EQ(1U, store_.counter("test.op_query").value());
+  EXPECT_EQ(1U, store_.counter("test.op_query_scatter_get").value());
+  EXPECT_EQ(0U, store_.counter("test.collection.test.query.total").value());
+  EXPECT_EQ(1U, store_.counter("test.op_reply").value());
+  EXPECT_EQ(0U, store_.gauge("test.op_query_active").value());
+}
+
 TEST_F(MongoProxyFilterTest, CallingFunctionStats) {
   initializeFilter();
 
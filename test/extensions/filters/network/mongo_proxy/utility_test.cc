@@ -1,5 +1,7 @@
 #include <string>
 
+#include "common/buffer/buffer_impl.h"
+
 #include "extensions/filters/network/mongo_proxy/bson_impl.h"
 #include "extensions/filters/network/mongo_proxy/codec_impl.h"
 #include "extensions/filters/network/mongo_proxy/utility.h"
@@ -191,6 +193,30 @@ TEST(QueryMessageInfoTest, Command) {
   }
 }
 
+TEST(QueryMessageInfoTest, LightweightDecode) {
+  std::string json = R"EOF({"callingFunction":"getByMongoId"})EOF";
+
+  QueryMessageImpl q(0, 0);
+  q.fullCollectionName("db.foo");
+  q.query(Bson::DocumentImpl::create()
+              ->addDocument("$query", Bson::DocumentImpl::create()->addInt32("_id", 2))
+              ->addString("$comment", std::move(json))
+              ->addInt32("$maxTimeMS", 100));
+
+  // Decode the body of the query without its documents.
+  Buffer::OwnedImpl buffer;
+  EncoderImpl(buffer).encodeQuery(q);
+  buffer.drain(Message::MessageHeaderSize);
+  QueryMessageImpl lightweight_q(0, 0);
+  lightweight_q.fromBuffer(buffer.length(), buffer, false);
+
+  QueryMessageInfo info(lightweight_q);
+  EXPECT_EQ("", info.command());
+  EXPECT_EQ("foo", info.collection());
+  EXPECT_EQ("", info.callsite());
+  EXPECT_EQ(0, info.max_time());
+}
+
 } // namespace MongoProxy
 } // namespace NetworkFilters
 } // namespace Extensions
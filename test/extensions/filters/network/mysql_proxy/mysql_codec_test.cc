@@ -1009,6 +1009,29 @@ TEST_F(MySQLCodecTest, MySQLCommandOther) {
   EXPECT_EQ(mysql_cmd_decode.getCmd(), Command::Cmd::COM_FIELD_LIST);
 }
 
+// Strings spanning several slices are copied out without linearizing the buffer.
+TEST_F(MySQLCodecTest, MySQLPeekStringsAcrossSlices) {
+  Buffer::OwnedImpl buffer;
+  buffer.appendSliceForTest("abc");
+  buffer.appendSliceForTest(std::string("def\0ghi", 7));
+  buffer.appendSliceForTest("jkl");
+
+  uint64_t offset = 1;
+  std::string str;
+  EXPECT_EQ(MYSQL_SUCCESS, BufferHelper::peekString(buffer, offset, str));
+  EXPECT_EQ("bcdef", str);
+  EXPECT_EQ(7U, offset);
+
+  EXPECT_EQ(MYSQL_SUCCESS, BufferHelper::peekStringBySize(buffer, offset, 5, str));
+  EXPECT_EQ("ghijk", str);
+  EXPECT_EQ(12U, offset);
+
+  EXPECT_EQ(MYSQL_FAILURE, BufferHelper::peekStringBySize(buffer, offset, 2, str));
+  EXPECT_EQ(MYSQL_FAILURE, BufferHelper::peekStringBySize(buffer, offset, -1, str));
+  EXPECT_EQ(12U, offset);
+  EXPECT_EQ(3U, buffer.getRawSlices(nullptr, 0));
+}
+
 } // namespace MySQLProxy
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -1,14 +1,19 @@
 #include "extensions/filters/network/mysql_proxy/mysql_codec.h"
 #include "extensions/filters/network/mysql_proxy/mysql_filter.h"
 #include "extensions/filters/network/mysql_proxy/mysql_utils.h"
+#include "extensions/filters/network/well_known_names.h"
 
 #include "test/mocks/network/mocks.h"
+#include "test/mocks/runtime/mocks.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "mysql_test_utils.h"
 
+using testing::_;
+using testing::Matcher;
 using testing::NiceMock;
+using testing::Return;
 
 namespace Envoy {
 namespace Extensions {
@@ -19,10 +24,19 @@ constexpr int SESSIONS = 5;
 
 class MySQLFilterTest : public testing::Test, public MySQLTestUtils {
 public:
-  MySQLFilterTest() { ENVOY_LOG_MISC(info, "test"); }
+  MySQLFilterTest() {
+    ENVOY_LOG_MISC(info, "test");
+    query_parse_percent_.set_numerator(100);
+    query_parse_percent_.set_denominator(envoy::type::FractionalPercent::HUNDRED);
+    ON_CALL(runtime_.snapshot_,
+            featureEnabled("mysql.query_parse_percent",
+                           Matcher<const envoy::type::FractionalPercent&>(_)))
+        .WillByDefault(Return(true));
+  }
 
   void initialize() {
-    config_ = std::make_shared<MySQLFilterConfig>(stat_prefix_, scope_);
+    config_ = std::make_shared<MySQLFilterConfig>(stat_prefix_, scope_, runtime_,
+                                                  query_parse_percent_);
     filter_ = std::make_unique<MySQLFilter>(config_);
     filter_->initializeReadFilterCallbacks(filter_callbacks_);
   }
@@ -31,6 +45,8 @@ public:
   std::unique_ptr<MySQLFilter> filter_;
   Stats::IsolatedStoreImpl scope_;
   std::string stat_prefix_{"test"};
+  NiceMock<Runtime::MockLoader> runtime_;
+  envoy::type::FractionalPercent query_parse_percent_;
   NiceMock<Network::MockReadFilterCallbacks> filter_callbacks_;
 };
 
@@ -828,6 +844,65 @@ TEST_F(MySQLFilterTest, MySqlLoginAndQueryTest) {
   EXPECT_EQ(MySQLSession::State::MYSQL_REQ, filter_->getSession().getState());
 }
 
+// Only the sampled queries are parsed and emit dynamic metadata.
+TEST_F(MySQLFilterTest, MySqlQueryParseSamplingTest) {
+  query_parse_percent_.set_numerator(10);
+  initialize();
+
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onNewConnection());
+
+  std::string greeting_data = encodeServerGreeting(MYSQL_PROTOCOL_10);
+  Buffer::InstancePtr greet_data(new Buffer::OwnedImpl(greeting_data));
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(*greet_data, false));
+
+  std::string clogin_data =
+      encodeClientLogin(MYSQL_CLIENT_CAPAB_41VS320, "user1", CHALLENGE_SEQ_NUM);
+  Buffer::InstancePtr client_login_data(new Buffer::OwnedImpl(clogin_data));
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(*client_login_data, false));
+
+  std::string srv_resp_data = encodeClientLoginResp(MYSQL_RESP_OK);
+  Buffer::InstancePtr server_resp_data(new Buffer::OwnedImpl(srv_resp_data));
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(*server_resp_data, false));
+  EXPECT_EQ(MySQLSession::State::MYSQL_REQ, filter_->getSession().getState());
+
+  Command mysql_cmd_encode{};
+  mysql_cmd_encode.setCmd(Command::Cmd::COM_QUERY);
+  std::string query = "SELECT * FROM students";
+  mysql_cmd_encode.setData(query);
+  std::string query_data = mysql_cmd_encode.encode();
+  std::string mysql_msg = BufferHelper::encodeHdr(query_data, 0);
+
+  EXPECT_CALL(runtime_.snapshot_,
+              featureEnabled("mysql.query_parse_percent",
+                             Matcher<const envoy::type::FractionalPercent&>(_)))
+      .WillOnce(Return(false));
+  Buffer::OwnedImpl skipped_query_data(mysql_msg);
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(skipped_query_data, false));
+  EXPECT_EQ(MySQLSession::State::MYSQL_REQ_RESP, filter_->getSession().getState());
+  EXPECT_EQ(0UL, config_->stats().queries_parsed_.value());
+  EXPECT_EQ(1UL, config_->stats().queries_parse_skipped_.value());
+  const auto& filter_metadata =
+      filter_callbacks_.connection_.stream_info_.metadata_.filter_metadata();
+  EXPECT_EQ(0, filter_metadata.at(NetworkFilterNames::get().MySQLProxy).fields().size());
+
+  srv_resp_data = encodeClientLoginResp(MYSQL_RESP_OK, 0, 1);
+  Buffer::InstancePtr query_resp_data(new Buffer::OwnedImpl(srv_resp_data));
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(*query_resp_data, false));
+  EXPECT_EQ(MySQLSession::State::MYSQL_REQ, filter_->getSession().getState());
+
+  EXPECT_CALL(runtime_.snapshot_,
+              featureEnabled("mysql.query_parse_percent",
+                             Matcher<const envoy::type::FractionalPercent&>(_)))
+      .WillOnce(Return(true));
+  Buffer::OwnedImpl sampled_query_data(mysql_msg);
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(sampled_query_data, false));
+  EXPECT_EQ(1UL, config_->stats().queries_parsed_.value());
+  EXPECT_EQ(1UL, config_->stats().queries_parse_skipped_.value());
+  const auto& fields = filter_metadata.at(NetworkFilterNames::get().MySQLProxy).fields();
+  ASSERT_EQ(1, fields.count("students"));
+  EXPECT_EQ("select", fields.at("students").list_value().values(0).string_value());
+}
+
 } // namespace MySQLProxy
 } // namespace NetworkFilters
 } // namespace Extensions
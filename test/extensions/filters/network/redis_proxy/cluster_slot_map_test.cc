@@ -0,0 +1,99 @@
+#include <string>
+#include <vector>
+
+#include "extensions/filters/network/redis_proxy/cluster_slot_map.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+class ClusterSlotMapTest : public testing::Test {
+public:
+  static Common::Redis::RespValue integer(int64_t value) {
+    Common::Redis::RespValue resp;
+    resp.type(Common::Redis::RespType::Integer);
+    resp.asInteger() = value;
+    return resp;
+  }
+
+  static Common::Redis::RespValue bulkString(const std::string& value) {
+    Common::Redis::RespValue resp;
+    resp.type(Common::Redis::RespType::BulkString);
+    resp.asString() = value;
+    return resp;
+  }
+
+  static Common::Redis::RespValue array(std::vector<Common::Redis::RespValue> values) {
+    Common::Redis::RespValue resp;
+    resp.type(Common::Redis::RespType::Array);
+    resp.asArray().swap(values);
+    return resp;
+  }
+
+  static Common::Redis::RespValue node(const std::string& ip, int64_t port) {
+    return array({bulkString(ip), integer(port), bulkString("node-id")});
+  }
+};
+
+TEST_F(ClusterSlotMapTest, KeySlot) {
+  // The slots computed by CLUSTER KEYSLOT.
+  EXPECT_EQ(12182, ClusterSlotMap::keySlot("foo"));
+  EXPECT_EQ(5061, ClusterSlotMap::keySlot("bar"));
+  EXPECT_EQ(12739, ClusterSlotMap::keySlot("123456789"));
+
+  // The keys with the same hash tag are in the same slot.
+  EXPECT_EQ(ClusterSlotMap::keySlot("user1000"), ClusterSlotMap::keySlot("{user1000}.following"));
+  EXPECT_EQ(ClusterSlotMap::keySlot("user1000"), ClusterSlotMap::keySlot("{user1000}.followers"));
+  EXPECT_EQ("foo{}{bar}", ClusterSlotMap::hashtag("foo{}{bar}"));
+  EXPECT_EQ("bar", ClusterSlotMap::hashtag("foo{bar}{zap}"));
+  EXPECT_EQ("foo{bar", ClusterSlotMap::hashtag("foo{bar"));
+}
+
+TEST_F(ClusterSlotMapTest, Create) {
+  ClusterSlotMapPtr slot_map = ClusterSlotMap::create(
+      array({array({integer(0), integer(5460), node("10.0.0.1", 6379), node("10.0.0.2", 6380)}),
+             array({integer(10923), integer(16383), node("::1", 6379)})}));
+  ASSERT_NE(nullptr, slot_map);
+
+  const ClusterSlotMap::Shard* shard = slot_map->shard(0);
+  ASSERT_NE(nullptr, shard);
+  EXPECT_EQ(shard, slot_map->shard(5460));
+  EXPECT_EQ("10.0.0.1:6379", shard->primary_);
+  EXPECT_EQ(std::vector<std::string>{"10.0.0.2:6380"}, shard->replicas_);
+
+  EXPECT_EQ(nullptr, slot_map->shard(5461));
+  EXPECT_EQ(nullptr, slot_map->shard(10922));
+
+  shard = slot_map->shard(16383);
+  ASSERT_NE(nullptr, shard);
+  EXPECT_EQ("[::1]:6379", shard->primary_);
+  EXPECT_TRUE(shard->replicas_.empty());
+}
+
+TEST_F(ClusterSlotMapTest, CreateInvalid) {
+  EXPECT_EQ(nullptr, ClusterSlotMap::create(integer(1)));
+  EXPECT_EQ(nullptr, ClusterSlotMap::create(array({integer(1)})));
+  EXPECT_EQ(nullptr, ClusterSlotMap::create(array({array({integer(0), integer(1)})})));
+  EXPECT_EQ(nullptr, ClusterSlotMap::create(array(
+                         {array({bulkString("0"), integer(1), node("10.0.0.1", 6379)})})));
+  EXPECT_EQ(nullptr, ClusterSlotMap::create(
+                         array({array({integer(2), integer(1), node("10.0.0.1", 6379)})})));
+  EXPECT_EQ(nullptr, ClusterSlotMap::create(
+                         array({array({integer(0), integer(16384), node("10.0.0.1", 6379)})})));
+  EXPECT_EQ(nullptr,
+            ClusterSlotMap::create(array({array({integer(0), integer(1), node("10.0.0.1", 0)})})));
+  EXPECT_EQ(nullptr,
+            ClusterSlotMap::create(array({array({integer(0), integer(1), node("", 6379)})})));
+  EXPECT_EQ(nullptr, ClusterSlotMap::create(array({array(
+                         {integer(0), integer(1), node("10.0.0.1", 6379), integer(1)})})));
+}
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -6,9 +6,11 @@
 #include <string>
 #include <vector>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/fmt.h"
 #include "common/stats/isolated_store_impl.h"
 
+#include "extensions/filters/network/common/redis/codec_impl.h"
 #include "extensions/filters/network/common/redis/supported_commands.h"
 #include "extensions/filters/network/redis_proxy/command_splitter_impl.h"
 
@@ -36,6 +38,7 @@ class NullRouterImpl : public Router {
                                                   Common::Redis::Client::PoolCallbacks&) override {
     return nullptr;
   }
+  std::string shard(const std::string& key) override { return key; }
 };
 
 class CommandLookUpSpeedTest {
@@ -69,11 +72,38 @@ public:
   Stats::IsolatedStoreImpl store_;
   Event::SimulatedTimeSystem time_system_;
   CommandSplitter::InstanceImpl splitter_{RouterPtr{router_}, store_, "redis.foo.", time_system_,
-                                          false};
+                                          false, nullptr};
   NoOpSplitCallbacks callbacks_;
   CommandSplitter::SplitRequestPtr handle_;
 };
 
+class CodecSpeedTest : public Common::Redis::DecoderCallbacks {
+public:
+  // Common::Redis::DecoderCallbacks
+  void onRespValue(Common::Redis::RespValuePtr&& value) override { value_ = std::move(value); }
+
+  static std::string bulkString(uint64_t size) {
+    return fmt::format("${}\r\n{}\r\n", size, std::string(size, 'a'));
+  }
+
+  // Decode a GET response, and encode it again as it would be forwarded downstream.
+  void decodeAndForward(const std::string& response, bool move) {
+    Buffer::OwnedImpl input(response);
+    decoder_.decode(input);
+    Buffer::OwnedImpl output;
+    if (move) {
+      encoder_.move(*value_, output);
+    } else {
+      encoder_.encode(*value_, output);
+    }
+    output.drain(output.length());
+  }
+
+  Common::Redis::DecoderImpl decoder_{*this};
+  Common::Redis::EncoderImpl encoder_;
+  Common::Redis::RespValuePtr value_;
+};
+
 } // namespace RedisProxy
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -88,6 +118,26 @@ static void BM_MakeRequests(benchmark::State& state) {
 }
 BENCHMARK(BM_MakeRequests);
 
+static void BM_DecodeAndEncodeBulkString(benchmark::State& state) {
+  Envoy::Extensions::NetworkFilters::RedisProxy::CodecSpeedTest context;
+  const std::string response = context.bulkString(state.range(0));
+
+  for (auto _ : state) {
+    context.decodeAndForward(response, false);
+  }
+}
+BENCHMARK(BM_DecodeAndEncodeBulkString)->Range(16, 1 << 20);
+
+static void BM_DecodeAndMoveBulkString(benchmark::State& state) {
+  Envoy::Extensions::NetworkFilters::RedisProxy::CodecSpeedTest context;
+  const std::string response = context.bulkString(state.range(0));
+
+  for (auto _ : state) {
+    context.decodeAndForward(response, true);
+  }
+}
+BENCHMARK(BM_DecodeAndMoveBulkString)->Range(16, 1 << 20);
+
 // Boilerplate main(), which discovers benchmarks in the same file and runs them.
 int main(int argc, char** argv) {
   benchmark::Initialize(&argc, argv);
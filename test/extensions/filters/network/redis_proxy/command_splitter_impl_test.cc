@@ -13,6 +13,7 @@
 #include "test/extensions/filters/network/redis_proxy/mocks.h"
 #include "test/mocks/common.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/simulated_time_system.h"
 
@@ -24,6 +25,7 @@ using testing::ByRef;
 using testing::DoAll;
 using testing::Eq;
 using testing::InSequence;
+using testing::Invoke;
 using testing::NiceMock;
 using testing::Property;
 using testing::Ref;
@@ -53,7 +55,8 @@ public:
   MockRouter* router_{new MockRouter()};
   NiceMock<Stats::MockIsolatedStatsStore> store_;
   Event::SimulatedTimeSystem time_system_;
-  InstanceImpl splitter_{RouterPtr{router_}, store_, "redis.foo.", time_system_, false};
+  InstanceImpl splitter_{RouterPtr{router_}, store_, "redis.foo.", time_system_, false,
+                        nullptr};
   MockSplitCallbacks callbacks_;
   SplitRequestPtr handle_;
 };
@@ -769,6 +772,141 @@ INSTANTIATE_TEST_SUITE_P(
     RedisSplitKeysSumResultHandlerTest, RedisSplitKeysSumResultHandlerTest,
     testing::ValuesIn(Common::Redis::SupportedCommands::hashMultipleSumResultCommands()));
 
+class RedisShardedFragmentedRequestTest : public RedisCommandSplitterImplTest {
+public:
+  // The odd and the even keys are in two shards.
+  void setupShards() {
+    EXPECT_CALL(*router_, shard(_))
+        .WillRepeatedly(Invoke([](const std::string& key) -> std::string {
+          return std::stoi(key) % 2 == 0 ? "even" : "odd";
+        }));
+  }
+
+  void expectRequest(const std::vector<std::string>& request_strings, uint32_t index) {
+    Common::Redis::RespValue expected_request;
+    makeBulkStringArray(expected_request, request_strings);
+    EXPECT_CALL(*router_, makeRequest(request_strings[1], Eq(expected_request), _))
+        .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_[index])),
+                        Return(&pool_requests_[index])));
+  }
+
+  Common::Redis::RespValuePtr bulkString(const std::string& value) {
+    Common::Redis::RespValuePtr response(new Common::Redis::RespValue());
+    response->type(Common::Redis::RespType::BulkString);
+    response->asString() = value;
+    return response;
+  }
+
+  Common::Redis::Client::PoolCallbacks* pool_callbacks_[2];
+  Common::Redis::Client::MockPoolRequest pool_requests_[2];
+};
+
+TEST_F(RedisShardedFragmentedRequestTest, MGET) {
+  setupShards();
+  expectRequest({"mget", "0", "2"}, 0);
+  expectRequest({"get", "1"}, 1);
+  Common::Redis::RespValue request;
+  makeBulkStringArray(request, {"mget", "0", "1", "2"});
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  Common::Redis::RespValuePtr response1(new Common::Redis::RespValue());
+  response1->type(Common::Redis::RespType::Array);
+  std::vector<Common::Redis::RespValue> values(2);
+  values[0] = *bulkString("a");
+  values[1] = *bulkString("c");
+  response1->asArray().swap(values);
+  pool_callbacks_[0]->onResponse(std::move(response1));
+
+  // The responses are in the order of the keys of the command.
+  Common::Redis::RespValue expected_response;
+  makeBulkStringArray(expected_response, {"a", "b", "c"});
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks_[1]->onResponse(bulkString("b"));
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.mget.success").value());
+}
+
+TEST_F(RedisShardedFragmentedRequestTest, MGETFailure) {
+  setupShards();
+  expectRequest({"mget", "0", "2"}, 0);
+  expectRequest({"get", "1"}, 1);
+  Common::Redis::RespValue request;
+  makeBulkStringArray(request, {"mget", "0", "1", "2"});
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  pool_callbacks_[0]->onFailure();
+
+  Common::Redis::RespValue expected_response;
+  makeBulkStringArray(expected_response, {Response::get().UpstreamFailure, "b",
+                                          Response::get().UpstreamFailure});
+  expected_response.asArray()[0].type(Common::Redis::RespType::Error);
+  expected_response.asArray()[2].type(Common::Redis::RespType::Error);
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks_[1]->onResponse(bulkString("b"));
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.mget.error").value());
+}
+
+TEST_F(RedisShardedFragmentedRequestTest, MSET) {
+  setupShards();
+  expectRequest({"mset", "0", "a", "2", "c"}, 0);
+  expectRequest({"set", "1", "b"}, 1);
+  Common::Redis::RespValue request;
+  makeBulkStringArray(request, {"mset", "0", "a", "1", "b", "2", "c"});
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  Common::Redis::RespValuePtr ok(new Common::Redis::RespValue());
+  ok->type(Common::Redis::RespType::SimpleString);
+  ok->asString() = Response::get().OK;
+  pool_callbacks_[1]->onResponse(std::move(ok));
+
+  // The errors are counted by key.
+  Common::Redis::RespValue expected_response;
+  expected_response.type(Common::Redis::RespType::Error);
+  expected_response.asString() = "finished with 2 error(s)";
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks_[0]->onFailure();
+}
+
+TEST_F(RedisShardedFragmentedRequestTest, SumResult) {
+  setupShards();
+  expectRequest({"DEL", "0", "2"}, 0);
+  expectRequest({"DEL", "1"}, 1);
+  Common::Redis::RespValue request;
+  makeBulkStringArray(request, {"DEL", "0", "1", "2"});
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  Common::Redis::RespValuePtr response1(new Common::Redis::RespValue());
+  response1->type(Common::Redis::RespType::Integer);
+  response1->asInteger() = 2;
+  pool_callbacks_[0]->onResponse(std::move(response1));
+
+  Common::Redis::RespValue expected_response;
+  expected_response.type(Common::Redis::RespType::Integer);
+  expected_response.asInteger() = 3;
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  Common::Redis::RespValuePtr response2(new Common::Redis::RespValue());
+  response2->type(Common::Redis::RespType::Integer);
+  response2->asInteger() = 1;
+  pool_callbacks_[1]->onResponse(std::move(response2));
+}
+
+TEST_F(RedisShardedFragmentedRequestTest, Cancel) {
+  setupShards();
+  expectRequest({"mget", "0", "2"}, 0);
+  expectRequest({"get", "1"}, 1);
+  Common::Redis::RespValue request;
+  makeBulkStringArray(request, {"mget", "0", "1", "2"});
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  EXPECT_CALL(pool_requests_[0], cancel());
+  EXPECT_CALL(pool_requests_[1], cancel());
+  handle_->cancel();
+}
+
 class RedisSingleServerRequestWithLatencyMicrosTest : public RedisSingleServerRequestTest {
 public:
   void makeRequest(const std::string& hash_key, const Common::Redis::RespValue& request) {
@@ -778,7 +916,7 @@ public:
   }
 
   MockRouter* router_{new MockRouter()};
-  InstanceImpl splitter_{RouterPtr{router_}, store_, "redis.foo.", time_system_, true};
+  InstanceImpl splitter_{RouterPtr{router_}, store_, "redis.foo.", time_system_, true, nullptr};
 };
 
 TEST_P(RedisSingleServerRequestWithLatencyMicrosTest, Success) {
@@ -809,6 +947,104 @@ INSTANTIATE_TEST_SUITE_P(RedisSingleServerRequestWithLatencyMicrosTest,
                          RedisSingleServerRequestWithLatencyMicrosTest,
                          testing::ValuesIn(Common::Redis::SupportedCommands::simpleCommands()));
 
+class RedisReadCacheSplitterTest : public RedisCommandSplitterImplTest {
+public:
+  RedisReadCacheSplitterTest() {
+    envoy::config::filter::network::redis_proxy::v2::RedisProxy::ReadCacheSettings config;
+    config.add_prefixes("hot:");
+    config.mutable_ttl()->set_seconds(1);
+    cached_splitter_ = std::make_unique<InstanceImpl>(
+        RouterPtr{cached_router_}, store_, "redis.foo.", time_system_, false,
+        std::make_unique<ReadCache>(config, tls_, store_, "redis.foo.", time_system_));
+  }
+
+  // Send a command upstream and respond to it.
+  void makeUpstreamRequest(const std::vector<std::string>& command,
+                           const Common::Redis::RespValue& response) {
+    Common::Redis::RespValue request;
+    makeBulkStringArray(request, command);
+    Common::Redis::Client::PoolCallbacks* pool_callbacks;
+    EXPECT_CALL(*cached_router_, makeRequest(command[1], Ref(request), _))
+        .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks)), Return(&pool_request_)));
+    handle_ = cached_splitter_->makeRequest(request, callbacks_);
+    EXPECT_NE(nullptr, handle_);
+
+    EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&response)));
+    pool_callbacks->onResponse(std::make_unique<Common::Redis::RespValue>(response));
+  }
+
+  Common::Redis::RespValue bulkString(const std::string& value) {
+    Common::Redis::RespValue response;
+    response.type(Common::Redis::RespType::BulkString);
+    response.asString() = value;
+    return response;
+  }
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  MockRouter* cached_router_{new MockRouter()};
+  std::unique_ptr<InstanceImpl> cached_splitter_;
+  Common::Redis::Client::MockPoolRequest pool_request_;
+};
+
+TEST_F(RedisReadCacheSplitterTest, GetFromCache) {
+  InSequence s;
+
+  makeUpstreamRequest({"get", "hot:a"}, bulkString("1"));
+
+  Common::Redis::RespValue request;
+  makeBulkStringArray(request, {"GET", "hot:a"});
+  Common::Redis::RespValue response = bulkString("1");
+  EXPECT_CALL(*cached_router_, makeRequest(_, _, _)).Times(0);
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&response)));
+  EXPECT_EQ(nullptr, cached_splitter_->makeRequest(request, callbacks_));
+
+  // The keys of the other prefixes aren't cached.
+  makeUpstreamRequest({"get", "cold:a"}, bulkString("2"));
+  makeUpstreamRequest({"get", "cold:a"}, bulkString("2"));
+
+  EXPECT_EQ(4UL, store_.counter("redis.foo.command.get.total").value());
+  EXPECT_EQ(4UL, store_.counter("redis.foo.command.get.success").value());
+  EXPECT_EQ(1UL, store_.counter("redis.foo.read_cache.hot:.hit").value());
+  EXPECT_EQ(1UL, store_.counter("redis.foo.read_cache.hot:.miss").value());
+}
+
+TEST_F(RedisReadCacheSplitterTest, WriteInvalidates) {
+  InSequence s;
+
+  Common::Redis::RespValue ok;
+  ok.type(Common::Redis::RespType::SimpleString);
+  ok.asString() = "OK";
+
+  makeUpstreamRequest({"get", "hot:a"}, bulkString("1"));
+  makeUpstreamRequest({"set", "hot:a", "2"}, ok);
+  makeUpstreamRequest({"get", "hot:a"}, bulkString("2"));
+
+  // Reads don't invalidate.
+  Common::Redis::RespValue integer;
+  integer.type(Common::Redis::RespType::Integer);
+  integer.asInteger() = 1;
+  makeUpstreamRequest({"strlen", "hot:a"}, integer);
+  EXPECT_EQ(1UL, store_.counter("redis.foo.read_cache.hot:.invalidation").value());
+
+  Common::Redis::RespValue request;
+  makeBulkStringArray(request, {"del", "cold:a", "hot:a"});
+  EXPECT_CALL(*cached_router_, makeRequest(_, _, _)).Times(2).WillRepeatedly(Return(nullptr));
+  EXPECT_CALL(callbacks_, onResponse_(_));
+  EXPECT_EQ(nullptr, cached_splitter_->makeRequest(request, callbacks_));
+  EXPECT_EQ(2UL, store_.counter("redis.foo.read_cache.hot:.invalidation").value());
+}
+
+TEST_F(RedisReadCacheSplitterTest, ErrorNotCached) {
+  InSequence s;
+
+  Common::Redis::RespValue error;
+  error.type(Common::Redis::RespType::Error);
+  error.asString() = "LOADING";
+  makeUpstreamRequest({"get", "hot:a"}, error);
+  makeUpstreamRequest({"get", "hot:a"}, bulkString("1"));
+  EXPECT_EQ(2UL, store_.counter("redis.foo.read_cache.hot:.miss").value());
+}
+
 } // namespace CommandSplitter
 } // namespace RedisProxy
 } // namespace NetworkFilters
@@ -9,6 +9,7 @@
 #include "test/extensions/filters/network/common/redis/mocks.h"
 #include "test/extensions/filters/network/common/redis/test_utils.h"
 #include "test/extensions/filters/network/redis_proxy/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
@@ -18,6 +19,8 @@
 #include "gtest/gtest.h"
 
 using testing::_;
+using testing::AnyNumber;
+using testing::ByRef;
 using testing::DoAll;
 using testing::Eq;
 using testing::InSequence;
@@ -27,6 +30,7 @@ using testing::Return;
 using testing::ReturnNew;
 using testing::ReturnRef;
 using testing::SaveArg;
+using testing::WithArg;
 
 namespace Envoy {
 namespace Extensions {
@@ -138,6 +142,22 @@ TEST_F(RedisConnPoolImplTest, Hashtagging) {
   tls_.shutdownThread();
 };
 
+TEST_F(RedisConnPoolImplTest, Shard) {
+  setup();
+
+  EXPECT_CALL(*cm_.thread_local_cluster_.lb_.host_, address())
+      .WillOnce(Return(Network::Utility::resolveUrl("tcp://10.0.0.1:6379")));
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_))
+      .WillOnce(Return(cm_.thread_local_cluster_.lb_.host_));
+  EXPECT_EQ("fake_cluster/10.0.0.1:6379", conn_pool_->shard("hash_key"));
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_)).WillOnce(Return(nullptr));
+  EXPECT_EQ("", conn_pool_->shard("hash_key"));
+
+  update_callbacks_->onClusterRemoval("fake_cluster");
+  EXPECT_EQ("", conn_pool_->shard("hash_key"));
+}
+
 // Conn pool created when no cluster exists at creation time. Dynamic cluster creation and removal
 // work correctly.
 TEST_F(RedisConnPoolImplTest, NoClusterAtConstruction) {
@@ -244,6 +264,257 @@ TEST_F(RedisConnPoolImplTest, NoHost) {
   tls_.shutdownThread();
 }
 
+class RedisClusterConnPoolImplTest : public RedisConnPoolImplTest {
+public:
+  // Create a pool to a Redis Cluster, which sends CLUSTER SLOTS to the host chosen by the load
+  // balancer of the upstream cluster.
+  void setupRedisCluster(uint32_t redirect_refresh_threshold, bool read_from_replicas) {
+    envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings settings =
+        Common::Redis::Client::createConnPoolSettings();
+    settings.mutable_redis_cluster()->mutable_redirect_refresh_threshold()->set_value(
+        redirect_refresh_threshold);
+    settings.mutable_redis_cluster()->set_read_from_replicas(read_from_replicas);
+
+    EXPECT_CALL(cm_, addThreadLocalClusterUpdateCallbacks_(_))
+        .WillOnce(DoAll(SaveArgAddress(&update_callbacks_),
+                        ReturnNew<Upstream::MockClusterUpdateCallbacksHandle>()));
+    refresh_timer_ = new Event::MockTimer(&tls_.dispatcher_);
+    EXPECT_CALL(*refresh_timer_, enableTimer(std::chrono::milliseconds(60000)));
+    EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(nullptr));
+    EXPECT_CALL(*this, create_(Eq(cm_.thread_local_cluster_.lb_.host_)))
+        .WillOnce(Return(seed_client_));
+    if (read_from_replicas) {
+      EXPECT_CALL(*seed_client_, makeRequest(Eq(command({"readonly"})), _));
+    }
+    EXPECT_CALL(*seed_client_, makeRequest(Eq(command({"cluster", "slots"})), _))
+        .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&slots_callbacks_)), Return(&slots_request_)));
+    conn_pool_ = std::make_shared<InstanceImpl>(cluster_name_, cm_, *this, tls_, settings);
+  }
+
+  static Common::Redis::RespValue command(const std::vector<std::string>& arguments) {
+    std::vector<Common::Redis::RespValue> values(arguments.size());
+    for (uint64_t i = 0; i < arguments.size(); i++) {
+      values[i].type(Common::Redis::RespType::BulkString);
+      values[i].asString() = arguments[i];
+    }
+    Common::Redis::RespValue value;
+    value.type(Common::Redis::RespType::Array);
+    value.asArray().swap(values);
+    return value;
+  }
+
+  static Common::Redis::RespValue node(const std::string& ip, int64_t port) {
+    std::vector<Common::Redis::RespValue> values(2);
+    values[0].type(Common::Redis::RespType::BulkString);
+    values[0].asString() = ip;
+    values[1].type(Common::Redis::RespType::Integer);
+    values[1].asInteger() = port;
+    Common::Redis::RespValue value;
+    value.type(Common::Redis::RespType::Array);
+    value.asArray().swap(values);
+    return value;
+  }
+
+  // A CLUSTER SLOTS response with all the slots served by a primary and its replicas.
+  static Common::Redis::RespValuePtr slotsResponse(const std::vector<std::string>& replicas) {
+    std::vector<Common::Redis::RespValue> values(3);
+    values[0].type(Common::Redis::RespType::Integer);
+    values[0].asInteger() = 0;
+    values[1].type(Common::Redis::RespType::Integer);
+    values[1].asInteger() = ClusterSlotMap::SlotCount - 1;
+    values[2] = node("10.0.0.2", 6379);
+    for (const std::string& replica : replicas) {
+      values.push_back(node(replica, 6379));
+    }
+
+    Common::Redis::RespValuePtr response(new Common::Redis::RespValue());
+    response->type(Common::Redis::RespType::Array);
+    response->asArray().resize(1);
+    response->asArray()[0].type(Common::Redis::RespType::Array);
+    response->asArray()[0].asArray().swap(values);
+    return response;
+  }
+
+  static Common::Redis::RespValuePtr error(const std::string& message) {
+    Common::Redis::RespValuePtr response(new Common::Redis::RespValue());
+    response->type(Common::Redis::RespType::Error);
+    response->asString() = message;
+    return response;
+  }
+
+  // Expect a client to be created for a node which isn't a host of the upstream cluster.
+  Common::Redis::Client::MockClient* expectNodeClient(const std::string& address) {
+    Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+    EXPECT_CALL(*this, create_(_))
+        .WillOnce(Invoke([client, address](Upstream::HostConstSharedPtr host) {
+          EXPECT_EQ(address, host->address()->asString());
+          return client;
+        }));
+    return client;
+  }
+
+  void shutdown() {
+    // The clients closed by the pool are deleted when the dispatcher is idle.
+    EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_)).Times(AnyNumber());
+    tls_.shutdownThread();
+  }
+
+  Event::MockTimer* refresh_timer_{};
+  Common::Redis::Client::MockClient* seed_client_{
+      new NiceMock<Common::Redis::Client::MockClient>()};
+  Common::Redis::Client::PoolCallbacks* slots_callbacks_{};
+  Common::Redis::Client::MockPoolRequest slots_request_;
+  Common::Redis::RespValue value_{command({"get", "foo"})};
+  Common::Redis::Client::MockPoolCallbacks callbacks_;
+  Common::Redis::Client::PoolCallbacks* request_callbacks_{};
+  Common::Redis::Client::MockPoolRequest active_request_;
+};
+
+TEST_F(RedisClusterConnPoolImplTest, SlotRouting) {
+  setupRedisCluster(5, false);
+  slots_callbacks_->onResponse(slotsResponse({"10.0.0.3"}));
+
+  // The key "foo" is in the slot 12182, which is served by the primary.
+  Common::Redis::Client::MockClient* primary = expectNodeClient("10.0.0.2:6379");
+  EXPECT_CALL(*primary, makeRequest(Eq(ByRef(value_)), _))
+      .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&request_callbacks_)), Return(&active_request_)));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value_, callbacks_));
+
+  EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(callbacks_, onResponse_(_));
+  request_callbacks_->onResponse(std::make_unique<Common::Redis::RespValue>());
+
+  shutdown();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, ShardBySlot) {
+  setupRedisCluster(5, false);
+
+  // The keys are grouped by slot, whether or not the slot map is known.
+  EXPECT_EQ("fake_cluster/12182", conn_pool_->shard("foo"));
+  EXPECT_EQ("fake_cluster/12182", conn_pool_->shard("{foo}.bar"));
+  slots_callbacks_->onResponse(slotsResponse({}));
+  EXPECT_EQ("fake_cluster/12182", conn_pool_->shard("foo"));
+  EXPECT_EQ("fake_cluster/5061", conn_pool_->shard("bar"));
+
+  shutdown();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, ReadFromReplicas) {
+  setupRedisCluster(5, true);
+  slots_callbacks_->onResponse(slotsResponse({"10.0.0.3"}));
+
+  // The reads are sent to the replica, and the writes to the primary.
+  Common::Redis::Client::MockClient* replica = expectNodeClient("10.0.0.3:6379");
+  EXPECT_CALL(*replica, makeRequest(Eq(command({"readonly"})), _));
+  EXPECT_CALL(*replica, makeRequest(Eq(ByRef(value_)), _)).WillOnce(Return(&active_request_));
+  Common::Redis::Client::PoolRequest* request =
+      conn_pool_->makeRequest("foo", value_, callbacks_);
+  EXPECT_NE(nullptr, request);
+
+  Common::Redis::RespValue write = command({"set", "foo", "bar"});
+  Common::Redis::Client::MockPoolRequest write_request;
+  Common::Redis::Client::MockClient* primary = expectNodeClient("10.0.0.2:6379");
+  EXPECT_CALL(*primary, makeRequest(Eq(command({"readonly"})), _));
+  EXPECT_CALL(*primary, makeRequest(Eq(ByRef(write)), _)).WillOnce(Return(&write_request));
+  Common::Redis::Client::PoolRequest* write_handle =
+      conn_pool_->makeRequest("foo", write, callbacks_);
+  EXPECT_NE(nullptr, write_handle);
+
+  EXPECT_CALL(active_request_, cancel());
+  EXPECT_CALL(write_request, cancel());
+  EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_)).Times(2);
+  request->cancel();
+  write_handle->cancel();
+
+  shutdown();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, MovedRedirection) {
+  setupRedisCluster(5, false);
+  slots_callbacks_->onFailure();
+
+  // Without a slot map, the request is sent to the host chosen by the load balancer.
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_));
+  EXPECT_CALL(*seed_client_, makeRequest(Eq(ByRef(value_)), _))
+      .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&request_callbacks_)), Return(&active_request_)));
+  Common::Redis::Client::PoolRequest* request =
+      conn_pool_->makeRequest("foo", value_, callbacks_);
+  EXPECT_NE(nullptr, request);
+
+  Common::Redis::Client::MockClient* node = expectNodeClient("10.0.0.3:6380");
+  Common::Redis::Client::PoolCallbacks* redirected_callbacks{};
+  EXPECT_CALL(*node, makeRequest(Eq(ByRef(value_)), _))
+      .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&redirected_callbacks)), Return(&active_request_)));
+  request_callbacks_->onResponse(error("MOVED 12182 10.0.0.3:6380"));
+
+  EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(callbacks_, onFailure());
+  redirected_callbacks->onFailure();
+
+  shutdown();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, AskRedirection) {
+  InSequence s;
+
+  setupRedisCluster(5, false);
+  slots_callbacks_->onFailure();
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_));
+  EXPECT_CALL(*seed_client_, makeRequest(Eq(ByRef(value_)), _))
+      .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&request_callbacks_)), Return(&active_request_)));
+  Common::Redis::Client::PoolRequest* request =
+      conn_pool_->makeRequest("foo", value_, callbacks_);
+  EXPECT_NE(nullptr, request);
+
+  // The redirected request is preceded by ASKING, and the slot map is not refreshed.
+  Common::Redis::Client::MockClient* node = expectNodeClient("10.0.0.3:6380");
+  EXPECT_CALL(*node, makeRequest(Eq(command({"asking"})), _));
+  EXPECT_CALL(*node, makeRequest(Eq(ByRef(value_)), _)).WillOnce(Return(&active_request_));
+  request_callbacks_->onResponse(error("ASK 12182 10.0.0.3:6380"));
+
+  EXPECT_CALL(active_request_, cancel());
+  EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_));
+  request->cancel();
+
+  shutdown();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, RefreshOnRedirections) {
+  setupRedisCluster(1, false);
+  slots_callbacks_->onFailure();
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_));
+  EXPECT_CALL(*seed_client_, makeRequest(Eq(ByRef(value_)), _))
+      .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&request_callbacks_)), Return(&active_request_)));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value_, callbacks_));
+
+  // The MOVED redirection reaches the threshold, so the slot map is refreshed.
+  EXPECT_CALL(*refresh_timer_, enableTimer(_));
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(nullptr));
+  EXPECT_CALL(*seed_client_, makeRequest(Eq(command({"cluster", "slots"})), _))
+      .WillOnce(Return(&slots_request_));
+  Common::Redis::Client::MockClient* node = expectNodeClient("10.0.0.3:6380");
+  Common::Redis::Client::PoolCallbacks* redirected_callbacks{};
+  EXPECT_CALL(*node, makeRequest(Eq(ByRef(value_)), _))
+      .Times(3)
+      .WillRepeatedly(
+          DoAll(WithArg<1>(SaveArgAddress(&redirected_callbacks)), Return(&active_request_)));
+  request_callbacks_->onResponse(error("MOVED 12182 10.0.0.3:6380"));
+
+  // The slot map is not requested again while it is being refreshed, and the response of the
+  // request is returned once it followed the most redirections.
+  EXPECT_CALL(*refresh_timer_, enableTimer(_)).Times(2);
+  redirected_callbacks->onResponse(error("MOVED 12182 10.0.0.3:6380"));
+  redirected_callbacks->onResponse(error("MOVED 12182 10.0.0.3:6380"));
+  EXPECT_CALL(tls_.dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(callbacks_, onResponse_(_));
+  redirected_callbacks->onResponse(error("MOVED 12182 10.0.0.3:6380"));
+
+  shutdown();
+}
+
 TEST_F(RedisConnPoolImplTest, RemoteClose) {
   InSequence s;
 
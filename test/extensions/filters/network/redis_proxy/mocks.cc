@@ -9,18 +9,24 @@
 
 using testing::_;
 using testing::Invoke;
+using testing::ReturnArg;
 
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
 namespace RedisProxy {
 
-MockRouter::MockRouter() {}
+MockRouter::MockRouter() {
+  // By default each key is in its own shard.
+  ON_CALL(*this, shard(_)).WillByDefault(ReturnArg<0>());
+}
 MockRouter::~MockRouter() {}
 
 namespace ConnPool {
 
-MockInstance::MockInstance() {}
+MockInstance::MockInstance() {
+  ON_CALL(*this, shard(_)).WillByDefault(ReturnArg<0>());
+}
 MockInstance::~MockInstance() {}
 
 } // namespace ConnPool
@@ -28,6 +28,7 @@ public:
                Common::Redis::Client::PoolRequest*(
                    const std::string& hash_key, const Common::Redis::RespValue& request,
                    Common::Redis::Client::PoolCallbacks& callbacks));
+  MOCK_METHOD1(shard, std::string(const std::string& hash_key));
 };
 
 namespace ConnPool {
@@ -41,6 +42,7 @@ public:
                Common::Redis::Client::PoolRequest*(
                    const std::string& hash_key, const Common::Redis::RespValue& request,
                    Common::Redis::Client::PoolCallbacks& callbacks));
+  MOCK_METHOD1(shard, std::string(const std::string& hash_key));
 };
 
 } // namespace ConnPool
@@ -154,8 +154,8 @@ TEST_F(RedisProxyFilterTest, OutOfOrderResponseWithDrainClose) {
   request_callbacks2->onResponse(std::move(response2));
 
   Common::Redis::RespValuePtr response1(new Common::Redis::RespValue());
-  EXPECT_CALL(*encoder_, encode(Ref(*response1), _));
-  EXPECT_CALL(*encoder_, encode(Ref(*response2_ptr), _));
+  EXPECT_CALL(*encoder_, move(Ref(*response1), _));
+  EXPECT_CALL(*encoder_, move(Ref(*response2_ptr), _));
   EXPECT_CALL(filter_callbacks_.connection_, write(_, _));
   EXPECT_CALL(drain_decision_, drainClose()).WillOnce(Return(true));
   EXPECT_CALL(runtime_.snapshot_, featureEnabled("redis.drain_close_enabled", 100))
@@ -230,7 +230,7 @@ TEST_F(RedisProxyFilterTest, ImmediateResponse) {
             Common::Redis::RespValuePtr error(new Common::Redis::RespValue());
             error->type(Common::Redis::RespType::Error);
             error->asString() = "no healthy upstream";
-            EXPECT_CALL(*encoder_, encode(Eq(ByRef(*error)), _));
+            EXPECT_CALL(*encoder_, move(Eq(ByRef(*error)), _));
             EXPECT_CALL(filter_callbacks_.connection_, write(_, _));
             callbacks.onResponse(std::move(error));
             return nullptr;
@@ -0,0 +1,142 @@
+#include <memory>
+#include <string>
+
+#include "envoy/common/exception.h"
+
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/network/redis_proxy/read_cache.h"
+
+#include "test/extensions/filters/network/common/redis/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+class RedisReadCacheTest : public testing::Test {
+public:
+  void setup(uint32_t max_entries = 0) {
+    envoy::config::filter::network::redis_proxy::v2::RedisProxy::ReadCacheSettings config;
+    config.add_prefixes("hot:");
+    config.add_prefixes("hot:users:");
+    config.mutable_ttl()->set_seconds(1);
+    if (max_entries > 0) {
+      config.mutable_max_entries()->set_value(max_entries);
+    }
+    read_cache_ = std::make_unique<ReadCache>(config, tls_, store_, "redis.foo.", time_system_);
+  }
+
+  Common::Redis::RespValue bulkString(const std::string& value) {
+    Common::Redis::RespValue response;
+    response.type(Common::Redis::RespType::BulkString);
+    response.asString() = value;
+    return response;
+  }
+
+  // Look up a key that is expected to miss, and insert its response.
+  void miss(const std::string& key, const Common::Redis::RespValue& response) {
+    Common::Redis::RespValuePtr cached_response;
+    uint64_t generation;
+    EXPECT_EQ(ReadCache::LookupStatus::Miss, read_cache_->lookup(key, cached_response, generation));
+    read_cache_->insert(key, response, generation);
+  }
+
+  void expectHit(const std::string& key, const Common::Redis::RespValue& response) {
+    Common::Redis::RespValuePtr cached_response;
+    uint64_t generation;
+    EXPECT_EQ(ReadCache::LookupStatus::Hit, read_cache_->lookup(key, cached_response, generation));
+    EXPECT_EQ(response, *cached_response);
+  }
+
+  uint64_t counter(const std::string& name) { return store_.counter(name).value(); }
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Stats::IsolatedStoreImpl store_;
+  Event::SimulatedTimeSystem time_system_;
+  ReadCachePtr read_cache_;
+};
+
+TEST_F(RedisReadCacheTest, NotCacheable) {
+  setup();
+  Common::Redis::RespValuePtr cached_response;
+  uint64_t generation;
+  EXPECT_EQ(ReadCache::LookupStatus::NotCacheable,
+            read_cache_->lookup("cold:a", cached_response, generation));
+  read_cache_->invalidate("cold:a");
+  EXPECT_EQ(0UL, counter("redis.foo.read_cache.hot:.invalidation"));
+}
+
+TEST_F(RedisReadCacheTest, HitUntilExpiry) {
+  setup();
+  miss("hot:a", bulkString("1"));
+  expectHit("hot:a", bulkString("1"));
+  expectHit("hot:a", bulkString("1"));
+
+  // A missing key is cached too.
+  Common::Redis::RespValue null_response;
+  miss("hot:users:b", null_response);
+  expectHit("hot:users:b", null_response);
+
+  time_system_.sleep(std::chrono::seconds(1));
+  miss("hot:a", bulkString("2"));
+  expectHit("hot:a", bulkString("2"));
+
+  EXPECT_EQ(3UL, counter("redis.foo.read_cache.hot:.hit"));
+  EXPECT_EQ(2UL, counter("redis.foo.read_cache.hot:.miss"));
+  EXPECT_EQ(1UL, counter("redis.foo.read_cache.hot:users:.hit"));
+  EXPECT_EQ(1UL, counter("redis.foo.read_cache.hot:users:.miss"));
+}
+
+TEST_F(RedisReadCacheTest, EvictLeastRecentlyUsed) {
+  setup(2);
+  miss("hot:a", bulkString("a"));
+  miss("hot:b", bulkString("b"));
+  expectHit("hot:a", bulkString("a"));
+  miss("hot:c", bulkString("c"));
+
+  expectHit("hot:a", bulkString("a"));
+  expectHit("hot:c", bulkString("c"));
+  miss("hot:b", bulkString("b"));
+  EXPECT_EQ(2UL, counter("redis.foo.read_cache.hot:.eviction"));
+}
+
+TEST_F(RedisReadCacheTest, Invalidate) {
+  setup();
+  miss("hot:a", bulkString("1"));
+  read_cache_->invalidate("hot:a");
+  EXPECT_EQ(1UL, counter("redis.foo.read_cache.hot:.invalidation"));
+
+  // The response of a GET that was in flight during the invalidation may be stale, and isn't
+  // inserted.
+  Common::Redis::RespValuePtr cached_response;
+  uint64_t generation;
+  EXPECT_EQ(ReadCache::LookupStatus::Miss,
+            read_cache_->lookup("hot:a", cached_response, generation));
+  read_cache_->invalidate("hot:b");
+  read_cache_->insert("hot:a", bulkString("1"), generation);
+  miss("hot:a", bulkString("2"));
+  expectHit("hot:a", bulkString("2"));
+}
+
+TEST_F(RedisReadCacheTest, DuplicatePrefix) {
+  envoy::config::filter::network::redis_proxy::v2::RedisProxy::ReadCacheSettings config;
+  config.add_prefixes("hot:");
+  config.add_prefixes("hot:");
+  config.mutable_ttl()->set_seconds(1);
+  EXPECT_THROW_WITH_MESSAGE(ReadCache(config, tls_, store_, "redis.foo.", time_system_),
+                            EnvoyException, "read cache prefix `hot:` already exists.");
+}
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -175,6 +175,32 @@ TEST(PrefixRoutesTest, DifferentPrefixesSameUpstream) {
   EXPECT_EQ(nullptr, router.makeRequest("also_route_to_b:bar", value, callbacks));
 }
 
+TEST(PrefixRoutesTest, Shard) {
+  auto upstream_a = std::make_shared<ConnPool::MockInstance>();
+  auto upstream_c = std::make_shared<ConnPool::MockInstance>();
+
+  Upstreams upstreams;
+  upstreams.emplace("fake_clusterA", upstream_a);
+  upstreams.emplace("fake_clusterB", std::make_shared<ConnPool::MockInstance>());
+  upstreams.emplace("fake_clusterC", upstream_c);
+
+  auto prefix_routes = createPrefixRoutes();
+  prefix_routes.set_catch_all_cluster("fake_clusterC");
+  {
+    auto* route = prefix_routes.mutable_routes()->Add();
+    route->set_prefix("abc");
+    route->set_cluster("fake_clusterA");
+    route->set_remove_prefix(true);
+  }
+
+  EXPECT_CALL(*upstream_a, shard(Eq(":bar"))).WillOnce(Return("fake_clusterA/10.0.0.1:6379"));
+  EXPECT_CALL(*upstream_c, shard(Eq("c:bar"))).WillOnce(Return("fake_clusterC/10.0.0.2:6379"));
+
+  PrefixRoutes router(prefix_routes, std::move(upstreams));
+  EXPECT_EQ("fake_clusterA/10.0.0.1:6379", router.shard("abc:bar"));
+  EXPECT_EQ("fake_clusterC/10.0.0.2:6379", router.shard("c:bar"));
+}
+
 TEST(PrefixRoutesTest, DuplicatePrefix) {
   Upstreams upstreams;
   upstreams.emplace("fake_clusterA", std::make_shared<ConnPool::MockInstance>());
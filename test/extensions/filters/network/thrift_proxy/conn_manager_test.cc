@@ -1043,6 +1043,65 @@ TEST_F(ThriftConnectionManagerTest, OnDataHandlesThriftCallWithMultipleFilters)
   EXPECT_EQ(1U, store_.gauge("test.request_active").value());
 }
 
+// Tests that the request payload is passed through when every filter supports it.
+TEST_F(ThriftConnectionManagerTest, OnDataPassesThroughPayload) {
+  const std::string yaml = R"EOF(
+transport: FRAMED
+protocol: BINARY
+stat_prefix: test
+payload_passthrough: true
+)EOF";
+
+  initializeFilter(yaml);
+  writeFramedBinaryMessage(buffer_, MessageType::Call, 0x0F);
+
+  InSequence s;
+  EXPECT_CALL(*decoder_filter_, messageBegin(_)).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(*decoder_filter_, passthroughSupported()).WillOnce(Return(true));
+  EXPECT_CALL(*decoder_filter_, structBegin(_)).Times(0);
+  EXPECT_CALL(*decoder_filter_, passthroughData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& data) -> FilterStatus {
+        // The "success" string field and the stop field of the call arguments struct.
+        EXPECT_EQ(13U, data.length());
+        return FilterStatus::Continue;
+      }));
+  EXPECT_CALL(*decoder_filter_, messageEnd()).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(*decoder_filter_, transportEnd()).WillOnce(Return(FilterStatus::Continue));
+
+  EXPECT_EQ(filter_->onData(buffer_, false), Network::FilterStatus::StopIteration);
+  EXPECT_EQ(0U, buffer_.length());
+  EXPECT_EQ(1U, store_.counter("test.request_call").value());
+  EXPECT_EQ(0U, store_.counter("test.request_decoding_error").value());
+}
+
+// Tests that the request payload is decoded when any filter requires it.
+TEST_F(ThriftConnectionManagerTest, OnDataDecodesPayloadUnsupportedByFilter) {
+  auto* filter = new NiceMock<ThriftFilters::MockDecoderFilter>();
+  custom_filter_.reset(filter);
+
+  const std::string yaml = R"EOF(
+transport: FRAMED
+protocol: BINARY
+stat_prefix: test
+payload_passthrough: true
+)EOF";
+
+  initializeFilter(yaml);
+  writeFramedBinaryMessage(buffer_, MessageType::Call, 0x0F);
+
+  ON_CALL(*decoder_filter_, passthroughSupported()).WillByDefault(Return(true));
+  EXPECT_CALL(*filter, passthroughSupported()).WillOnce(Return(false));
+  EXPECT_CALL(*decoder_filter_, structBegin(_)).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(*decoder_filter_, stringValue(absl::string_view("field")))
+      .WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(*filter, passthroughData(_)).Times(0);
+  EXPECT_CALL(*decoder_filter_, passthroughData(_)).Times(0);
+
+  EXPECT_EQ(filter_->onData(buffer_, false), Network::FilterStatus::StopIteration);
+  EXPECT_EQ(1U, store_.counter("test.request_call").value());
+  EXPECT_EQ(0U, store_.counter("test.request_decoding_error").value());
+}
+
 // Tests stop iteration/resume with multiple filters.
 TEST_F(ThriftConnectionManagerTest, OnDataResumesWithNextFilter) {
   auto* filter = new NiceMock<ThriftFilters::MockDecoderFilter>();
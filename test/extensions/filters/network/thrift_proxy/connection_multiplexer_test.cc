@@ -0,0 +1,220 @@
+#include <memory>
+
+#include "common/buffer/buffer_impl.h"
+
+#include "extensions/filters/network/thrift_proxy/binary_protocol_impl.h"
+#include "extensions/filters/network/thrift_proxy/framed_transport_impl.h"
+#include "extensions/filters/network/thrift_proxy/router/connection_multiplexer.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/tcp/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/mocks/upstream/host.h"
+#include "test/test_common/printers.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace ThriftProxy {
+namespace Router {
+
+class ConnectionMultiplexerTest : public testing::Test {
+public:
+  MultiplexedConnection& addConnection() {
+    auto conn_data = std::make_unique<NiceMock<Tcp::ConnectionPool::MockConnectionData>>();
+    ON_CALL(*conn_data, connection()).WillByDefault(ReturnRef(upstream_connection_));
+    ON_CALL(*conn_data, connectionState())
+        .WillByDefault(
+            Invoke([&]() -> Tcp::ConnectionPool::ConnectionState* { return conn_state_.get(); }));
+    ON_CALL(*conn_data, setConnectionState_(_))
+        .WillByDefault(Invoke(
+            [&](Tcp::ConnectionPool::ConnectionStatePtr& cs) -> void { conn_state_.swap(cs); }));
+    conn_data->release_callback_ = [&]() -> void { released_ = true; };
+
+    return multiplexer_.addConnection(key_, std::move(conn_data), host_, TransportType::Framed,
+                                      ProtocolType::Binary);
+  }
+
+  std::string response(int32_t sequence_id) {
+    MessageMetadata metadata;
+    metadata.setMethodName("method");
+    metadata.setMessageType(MessageType::Reply);
+    metadata.setSequenceId(sequence_id);
+
+    BinaryProtocolImpl protocol;
+    Buffer::OwnedImpl message;
+    protocol.writeMessageBegin(message, metadata);
+    protocol.writeStructBegin(message, "");
+    protocol.writeFieldBegin(message, "", FieldType::Stop, 0);
+    protocol.writeStructEnd(message);
+    protocol.writeMessageEnd(message);
+
+    Buffer::OwnedImpl frame;
+    FramedTransportImpl().encodeFrame(frame, metadata, message);
+    return frame.toString();
+  }
+
+  NiceMock<Network::MockClientConnection> upstream_connection_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  ConnectionMultiplexer multiplexer_{tls_};
+  std::shared_ptr<NiceMock<Upstream::MockHostDescription>> host_{
+      new NiceMock<Upstream::MockHostDescription>()};
+  Tcp::ConnectionPool::ConnectionStatePtr conn_state_;
+  const std::string key_{ConnectionMultiplexer::key("cluster", TransportType::Framed,
+                                                    ProtocolType::Binary)};
+  bool released_{};
+};
+
+TEST_F(ConnectionMultiplexerTest, Key) { EXPECT_EQ("cluster/framed/binary", key_); }
+
+TEST_F(ConnectionMultiplexerTest, NoConnection) {
+  EXPECT_EQ(nullptr, multiplexer_.connection(key_, 2));
+}
+
+// Responses are handed to their requests by sequence id, regardless of their order.
+TEST_F(ConnectionMultiplexerTest, MultiplexRequests) {
+  MultiplexedConnection& conn = addConnection();
+  EXPECT_EQ(host_, conn.host());
+
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks1;
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks2;
+  const int32_t sequence_id1 = conn.addRequest(callbacks1);
+  EXPECT_EQ(&conn, multiplexer_.connection(key_, 2));
+  const int32_t sequence_id2 = conn.addRequest(callbacks2);
+  EXPECT_NE(sequence_id1, sequence_id2);
+  EXPECT_EQ(2, conn.activeRequests());
+  EXPECT_EQ(nullptr, multiplexer_.connection(key_, 2));
+
+  const std::string response1 = response(sequence_id1);
+  const std::string response2 = response(sequence_id2);
+  EXPECT_CALL(callbacks2, onUpstreamData(_, false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+        EXPECT_EQ(response2, data.toString());
+        conn.removeRequest(sequence_id2);
+      }));
+  EXPECT_CALL(callbacks1, onUpstreamData(_, false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+        EXPECT_EQ(response1, data.toString());
+        conn.removeRequest(sequence_id1);
+      }));
+  EXPECT_CALL(upstream_connection_, close(_)).Times(0);
+  EXPECT_CALL(upstream_connection_.dispatcher_, deferredDelete_(&conn));
+
+  Buffer::OwnedImpl buffer(response2 + response1);
+  conn.onUpstreamData(buffer, false);
+
+  // The idle connection went back to its pool.
+  EXPECT_TRUE(released_);
+  EXPECT_EQ(nullptr, multiplexer_.connection(key_, 2));
+}
+
+TEST_F(ConnectionMultiplexerTest, PartialResponse) {
+  MultiplexedConnection& conn = addConnection();
+
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks;
+  const int32_t sequence_id = conn.addRequest(callbacks);
+  const std::string frame = response(sequence_id);
+
+  EXPECT_CALL(callbacks, onUpstreamData(_, _)).Times(0);
+  Buffer::OwnedImpl buffer(frame.substr(0, 2));
+  conn.onUpstreamData(buffer, false);
+  buffer.add(frame.substr(2, 8));
+  conn.onUpstreamData(buffer, false);
+
+  EXPECT_CALL(callbacks, onUpstreamData(_, false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+        EXPECT_EQ(frame, data.toString());
+        conn.removeRequest(sequence_id);
+      }));
+  buffer.add(frame.substr(10));
+  conn.onUpstreamData(buffer, false);
+  EXPECT_TRUE(released_);
+}
+
+// The response of a removed request is dropped.
+TEST_F(ConnectionMultiplexerTest, DropUnknownResponse) {
+  MultiplexedConnection& conn = addConnection();
+
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks;
+  const int32_t sequence_id = conn.addRequest(callbacks);
+
+  EXPECT_CALL(callbacks, onUpstreamData(_, _)).Times(0);
+  Buffer::OwnedImpl buffer(response(sequence_id + 1));
+  conn.onUpstreamData(buffer, false);
+  EXPECT_EQ(1, conn.activeRequests());
+  EXPECT_FALSE(released_);
+}
+
+// A connection may still receive the response of a reset request, so it is closed on release.
+TEST_F(ConnectionMultiplexerTest, ResetRequestClosesConnection) {
+  MultiplexedConnection& conn = addConnection();
+
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks1;
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks2;
+  const int32_t sequence_id1 = conn.addRequest(callbacks1);
+  const int32_t sequence_id2 = conn.addRequest(callbacks2);
+
+  conn.removeRequest(sequence_id1);
+  EXPECT_FALSE(released_);
+
+  EXPECT_CALL(upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(callbacks2, onEvent(_)).Times(0);
+  conn.removeRequest(sequence_id2);
+  EXPECT_TRUE(released_);
+}
+
+TEST_F(ConnectionMultiplexerTest, InvalidFrameClosesConnection) {
+  MultiplexedConnection& conn = addConnection();
+
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks;
+  conn.addRequest(callbacks);
+
+  EXPECT_CALL(upstream_connection_, close(Network::ConnectionCloseType::NoFlush))
+      .WillOnce(Invoke([&](Network::ConnectionCloseType) -> void {
+        conn.onEvent(Network::ConnectionEvent::LocalClose);
+      }));
+  EXPECT_CALL(callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(upstream_connection_.dispatcher_, deferredDelete_(&conn));
+
+  Buffer::OwnedImpl buffer(std::string("\x00\x00\x00\x00", 4));
+  conn.onUpstreamData(buffer, false);
+  EXPECT_TRUE(released_);
+  EXPECT_EQ(nullptr, multiplexer_.connection(key_, 2));
+}
+
+TEST_F(ConnectionMultiplexerTest, RemoteCloseResetsRequests) {
+  MultiplexedConnection& conn = addConnection();
+
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks1;
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks2;
+  conn.addRequest(callbacks1);
+  const int32_t sequence_id2 = conn.addRequest(callbacks2);
+
+  EXPECT_CALL(callbacks1, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        // The closed connection isn't handed out while its requests are reset.
+        EXPECT_EQ(nullptr, multiplexer_.connection(key_, 2));
+      }));
+  EXPECT_CALL(callbacks2, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke(
+          [&](Network::ConnectionEvent) -> void { conn.removeRequest(sequence_id2); }));
+  EXPECT_CALL(upstream_connection_.dispatcher_, deferredDelete_(&conn));
+
+  conn.onEvent(Network::ConnectionEvent::Connected);
+  conn.onEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_TRUE(released_);
+}
+
+} // namespace Router
+} // namespace ThriftProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
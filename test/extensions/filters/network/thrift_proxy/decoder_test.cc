@@ -738,6 +738,106 @@ TEST_P(DecoderStateMachineNestingTest, NestedTypes) {
   EXPECT_EQ(dsm.currentState(), ProtocolState::Done);
 }
 
+TEST_F(DecoderStateMachineTest, PassthroughData) {
+  Buffer::OwnedImpl buffer;
+  buffer.add(std::string(100, 'x'));
+  InSequence dummy;
+
+  EXPECT_CALL(proto_, readMessageBegin(Ref(buffer), _))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer, MessageMetadata&) -> bool {
+        buffer.drain(10);
+        return true;
+      }));
+  EXPECT_CALL(handler_, messageBegin(_)).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(handler_, passthroughSupported()).WillOnce(Return(true));
+  EXPECT_CALL(handler_, passthroughData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& data) -> FilterStatus {
+        EXPECT_EQ(std::string(90, 'x'), data.toString());
+        return FilterStatus::Continue;
+      }));
+  EXPECT_CALL(proto_, readMessageEnd(_)).Times(0);
+  EXPECT_CALL(handler_, messageEnd()).WillOnce(Return(FilterStatus::Continue));
+
+  DecoderStateMachine dsm(proto_, metadata_, handler_);
+  dsm.enablePassthrough(100);
+
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::Done);
+  EXPECT_EQ(0U, buffer.length());
+}
+
+TEST_F(DecoderStateMachineTest, PassthroughDataWaitsForFrame) {
+  Buffer::OwnedImpl buffer;
+  buffer.add(std::string(50, 'x'));
+  InSequence dummy;
+
+  EXPECT_CALL(proto_, readMessageBegin(Ref(buffer), _))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer, MessageMetadata&) -> bool {
+        buffer.drain(10);
+        return true;
+      }));
+  EXPECT_CALL(handler_, messageBegin(_)).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(handler_, passthroughSupported()).WillOnce(Return(true));
+
+  DecoderStateMachine dsm(proto_, metadata_, handler_);
+  dsm.enablePassthrough(100);
+
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::WaitForData);
+  EXPECT_EQ(dsm.currentState(), ProtocolState::PassthroughData);
+  EXPECT_EQ(40U, buffer.length());
+
+  buffer.add(std::string(50, 'x'));
+  EXPECT_CALL(handler_, passthroughSupported()).WillOnce(Return(true));
+  EXPECT_CALL(handler_, passthroughData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& data) -> FilterStatus {
+        EXPECT_EQ(90U, data.length());
+        return FilterStatus::Continue;
+      }));
+  EXPECT_CALL(handler_, messageEnd()).WillOnce(Return(FilterStatus::Continue));
+
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::Done);
+}
+
+TEST_F(DecoderStateMachineTest, PassthroughDataUnsupportedByHandler) {
+  Buffer::OwnedImpl buffer;
+  InSequence dummy;
+
+  EXPECT_CALL(proto_, readMessageBegin(Ref(buffer), _)).WillOnce(Return(true));
+  EXPECT_CALL(handler_, messageBegin(_)).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(handler_, passthroughSupported()).WillOnce(Return(false));
+
+  // The message is decoded in full.
+  EXPECT_CALL(proto_, readStructBegin(Ref(buffer), _)).WillOnce(Return(true));
+  EXPECT_CALL(handler_, structBegin(absl::string_view())).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(proto_, readFieldBegin(Ref(buffer), _, _, _))
+      .WillOnce(DoAll(SetArgReferee<2>(FieldType::Stop), Return(true)));
+  EXPECT_CALL(proto_, readStructEnd(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(handler_, structEnd()).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(proto_, readMessageEnd(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(handler_, messageEnd()).WillOnce(Return(FilterStatus::Continue));
+
+  DecoderStateMachine dsm(proto_, metadata_, handler_);
+  dsm.enablePassthrough(100);
+
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::Done);
+}
+
+TEST_F(DecoderStateMachineTest, PassthroughMessageBeginExceedsFrame) {
+  Buffer::OwnedImpl buffer;
+  buffer.add(std::string(20, 'x'));
+
+  EXPECT_CALL(proto_, readMessageBegin(Ref(buffer), _))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer, MessageMetadata&) -> bool {
+        buffer.drain(20);
+        return true;
+      }));
+
+  DecoderStateMachine dsm(proto_, metadata_, handler_);
+  dsm.enablePassthrough(10);
+
+  EXPECT_THROW_WITH_MESSAGE(dsm.run(buffer), EnvoyException,
+                            "message begin of 20 bytes exceeds frame size 10");
+}
+
 TEST(DecoderTest, OnData) {
   NiceMock<MockTransport> transport;
   NiceMock<MockProtocol> proto;
@@ -798,6 +898,46 @@ TEST(DecoderTest, OnData) {
   EXPECT_TRUE(underflow);
 }
 
+TEST(DecoderTest, OnDataWithPassthrough) {
+  NiceMock<MockTransport> transport;
+  NiceMock<MockProtocol> proto;
+  NiceMock<MockDecoderCallbacks> callbacks;
+  StrictMock<MockDecoderEventHandler> handler;
+  ON_CALL(callbacks, newDecoderEventHandler()).WillByDefault(ReturnRef(handler));
+  ON_CALL(callbacks, passthroughEnabled()).WillByDefault(Return(true));
+
+  InSequence dummy;
+  Decoder decoder(transport, proto, callbacks);
+  Buffer::OwnedImpl buffer;
+  buffer.add(std::string(100, 'x'));
+
+  EXPECT_CALL(transport, decodeFrameStart(Ref(buffer), _))
+      .WillOnce(Invoke([&](Buffer::Instance&, MessageMetadata& metadata) -> bool {
+        metadata.setFrameSize(100);
+        return true;
+      }));
+  EXPECT_CALL(handler, transportBegin(_)).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(proto, readMessageBegin(Ref(buffer), _))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer, MessageMetadata&) -> bool {
+        buffer.drain(10);
+        return true;
+      }));
+  EXPECT_CALL(handler, messageBegin(_)).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(handler, passthroughSupported()).WillOnce(Return(true));
+  EXPECT_CALL(handler, passthroughData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& data) -> FilterStatus {
+        EXPECT_EQ(90U, data.length());
+        return FilterStatus::Continue;
+      }));
+  EXPECT_CALL(handler, messageEnd()).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(transport, decodeFrameEnd(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(handler, transportEnd()).WillOnce(Return(FilterStatus::Continue));
+
+  bool underflow = false;
+  EXPECT_EQ(FilterStatus::Continue, decoder.onData(buffer, underflow));
+  EXPECT_TRUE(underflow);
+}
+
 TEST(DecoderTest, OnDataWithProtocolHint) {
   NiceMock<MockTransport> transport;
   NiceMock<MockProtocol> proto;
@@ -76,6 +76,7 @@ MockDecoderFilter::MockDecoderFilter() {
   ON_CALL(*this, listEnd()).WillByDefault(Return(FilterStatus::Continue));
   ON_CALL(*this, setBegin(_, _)).WillByDefault(Return(FilterStatus::Continue));
   ON_CALL(*this, setEnd()).WillByDefault(Return(FilterStatus::Continue));
+  ON_CALL(*this, passthroughData(_)).WillByDefault(Return(FilterStatus::Continue));
 }
 MockDecoderFilter::~MockDecoderFilter() {}
 
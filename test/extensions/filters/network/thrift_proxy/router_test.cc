@@ -85,7 +85,7 @@ public:
     route_ = new NiceMock<MockRoute>();
     route_ptr_.reset(route_);
 
-    router_ = std::make_unique<Router>(context_.clusterManager());
+    router_ = std::make_unique<Router>(context_.clusterManager(), multiplexer_);
 
     EXPECT_EQ(nullptr, router_->downstreamConnection());
 
@@ -306,6 +306,7 @@ public:
   std::function<void(MockProtocol*)> mock_protocol_cb_{};
 
   NiceMock<Server::Configuration::MockFactoryContext> context_;
+  ConnectionMultiplexer multiplexer_{context_.thread_local_};
   NiceMock<Network::MockClientConnection> connection_;
   NiceMock<ThriftFilters::MockDecoderFilterCallbacks> callbacks_;
   NiceMock<MockTransport>* transport_{};
@@ -733,6 +734,32 @@ TEST_P(ThriftRouterFieldTypeTest, Call) {
   destroyRouter();
 }
 
+TEST_F(ThriftRouterTest, PassthroughCall) {
+  initializeRouter();
+  startRequest(MessageType::Call);
+  connectUpstream();
+
+  // The upstream uses the downstream transport and protocol.
+  EXPECT_TRUE(router_->passthroughSupported());
+
+  Buffer::OwnedImpl payload("payload");
+  EXPECT_EQ(FilterStatus::Continue, router_->passthroughData(payload));
+  EXPECT_EQ(0U, payload.length());
+
+  EXPECT_CALL(*protocol_, writeMessageEnd(_));
+  EXPECT_CALL(*transport_, encodeFrame(_, _, _))
+      .WillOnce(Invoke([&](Buffer::Instance&, const MessageMetadata&,
+                           Buffer::Instance& message) -> void {
+        EXPECT_EQ("payload", message.toString());
+      }));
+  EXPECT_CALL(upstream_connection_, write(_, false));
+  EXPECT_EQ(FilterStatus::Continue, router_->messageEnd());
+  EXPECT_EQ(FilterStatus::Continue, router_->transportEnd());
+
+  returnResponse();
+  destroyRouter();
+}
+
 TEST_F(ThriftRouterTest, CallWithExistingConnection) {
   initializeRouter();
 
@@ -4,11 +4,14 @@
 #include "extensions/filters/network/zookeeper_proxy/zookeeper_filter.h"
 
 #include "test/mocks/network/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::NiceMock;
+using testing::Ref;
 
 namespace Envoy {
 namespace Extensions {
@@ -25,12 +28,18 @@ bool protoMapEq(const ProtobufWkt::Struct& obj, const std::map<std::string, std:
 
 MATCHER_P(MapEq, rhs, "") { return protoMapEq(arg, rhs); }
 
+class TestStatStore : public Stats::IsolatedStoreImpl {
+public:
+  MOCK_METHOD2(deliverHistogramToSinks, void(const Stats::Histogram& histogram, uint64_t value));
+};
+
 class ZooKeeperFilterTest : public testing::Test {
 public:
   ZooKeeperFilterTest() { ENVOY_LOG_MISC(info, "test"); }
 
-  void initialize() {
-    config_ = std::make_shared<ZooKeeperFilterConfig>(stat_prefix_, 1048576, scope_);
+  void initialize(const bool emit_dynamic_metadata = true) {
+    config_ = std::make_shared<ZooKeeperFilterConfig>(stat_prefix_, 1048576, emit_dynamic_metadata,
+                                                      scope_, time_system_);
     filter_ = std::make_unique<ZooKeeperFilter>(config_);
     filter_->initializeReadFilterCallbacks(filter_callbacks_);
   }
@@ -352,6 +361,32 @@ public:
     return buffer;
   }
 
+  Buffer::OwnedImpl encodeResponse(const int32_t xid, const std::string& body = "") const {
+    Buffer::OwnedImpl buffer;
+
+    buffer.writeBEInt<int32_t>(16 + body.length());
+    buffer.writeBEInt<int32_t>(xid);
+    // Zxid.
+    buffer.writeBEInt<int64_t>(2000);
+    // Error.
+    buffer.writeBEInt<int32_t>(0);
+    buffer.add(body);
+
+    return buffer;
+  }
+
+  Buffer::OwnedImpl encodeConnectResponse() const {
+    Buffer::OwnedImpl buffer;
+
+    buffer.writeBEInt<int32_t>(20);
+    buffer.writeBEInt<int32_t>(0); // Protocol version.
+    buffer.writeBEInt<int32_t>(10); // Session timeout.
+    buffer.writeBEInt<int64_t>(200); // Session id.
+    addString(buffer, "");
+
+    return buffer;
+  }
+
   void addString(Buffer::OwnedImpl& buffer, const std::string& str) const {
     buffer.writeBEInt<uint32_t>(str.length());
     buffer.add(str);
@@ -430,7 +465,8 @@ public:
 
   ZooKeeperFilterConfigSharedPtr config_;
   std::unique_ptr<ZooKeeperFilter> filter_;
-  Stats::IsolatedStoreImpl scope_;
+  TestStatStore scope_;
+  Event::SimulatedTimeSystem time_system_;
   std::string stat_prefix_{"test.zookeeper"};
   NiceMock<Network::MockReadFilterCallbacks> filter_callbacks_;
   NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info_;
@@ -868,6 +904,92 @@ TEST_F(ZooKeeperFilterTest, CloseRequest) {
   EXPECT_EQ(0UL, config_->stats().decoder_error_.value());
 }
 
+TEST_F(ZooKeeperFilterTest, NoDynamicMetadata) {
+  initialize(false);
+
+  Buffer::OwnedImpl data = encodePathWatch("/foo", true);
+
+  EXPECT_CALL(filter_callbacks_.connection_, streamInfo()).Times(0);
+
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(data, false));
+  EXPECT_EQ(1UL, config_->stats().getdata_rq_.value());
+  EXPECT_EQ(21UL, config_->stats().request_bytes_.value());
+}
+
+TEST_F(ZooKeeperFilterTest, ResponseLatency) {
+  initialize();
+
+  Buffer::OwnedImpl connect = encodeConnect();
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(connect, false));
+  time_system_.sleep(std::chrono::milliseconds(5));
+
+  EXPECT_CALL(scope_, deliverHistogramToSinks(Ref(config_->stats().connect_response_latency_), 5));
+  Buffer::OwnedImpl connect_response = encodeConnectResponse();
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onWrite(connect_response, false));
+
+  Buffer::OwnedImpl getdata = encodePathWatch("/foo", true);
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(getdata, false));
+  time_system_.sleep(std::chrono::milliseconds(10));
+
+  EXPECT_CALL(scope_, deliverHistogramToSinks(Ref(config_->stats().getdata_response_latency_), 10));
+  Buffer::OwnedImpl getdata_response = encodeResponse(1000, "bar");
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onWrite(getdata_response, false));
+
+  EXPECT_EQ(24UL + 23UL, config_->stats().response_bytes_.value());
+  EXPECT_EQ(0UL, config_->stats().decoder_error_.value());
+}
+
+TEST_F(ZooKeeperFilterTest, ResponsesSpanningWrites) {
+  initialize();
+
+  Buffer::OwnedImpl getdata = encodePathWatch("/foo", true);
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(getdata, false));
+  Buffer::OwnedImpl ping = encodePing();
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(ping, false));
+  time_system_.sleep(std::chrono::milliseconds(3));
+
+  Buffer::OwnedImpl responses = encodeResponse(enumToSignedInt(XidCodes::WATCH_XID), "/foo");
+  Buffer::OwnedImpl getdata_response = encodeResponse(1000, std::string(1024, 'x'));
+  responses.add(getdata_response);
+  Buffer::OwnedImpl ping_response = encodeResponse(enumToSignedInt(XidCodes::PING_XID));
+  responses.add(ping_response);
+
+  EXPECT_CALL(scope_, deliverHistogramToSinks(Ref(config_->stats().getdata_response_latency_), 3));
+  EXPECT_CALL(scope_, deliverHistogramToSinks(Ref(config_->stats().ping_response_latency_), 3));
+
+  // The 24 bytes of the watch event are followed by the 1044 bytes of the getdata response and
+  // the 20 bytes of the ping response. The writes end within the prefix of the watch event,
+  // within the body of the getdata response and within the prefix of the ping response.
+  for (const uint64_t write_length : {3UL, 521UL, 548UL}) {
+    Buffer::OwnedImpl write;
+    write.move(responses, write_length);
+    EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onWrite(write, false));
+  }
+  EXPECT_EQ(16UL, responses.length());
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onWrite(responses, false));
+
+  EXPECT_EQ(1UL, config_->stats().watch_event_.value());
+  EXPECT_EQ(24UL + 1044UL + 20UL, config_->stats().response_bytes_.value());
+  EXPECT_EQ(0UL, config_->stats().decoder_error_.value());
+}
+
+TEST_F(ZooKeeperFilterTest, BadResponse) {
+  initialize();
+
+  Buffer::OwnedImpl ping = encodePing();
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onData(ping, false));
+
+  Buffer::OwnedImpl bad_response = encodeBadMessage();
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onWrite(bad_response, false));
+  EXPECT_EQ(1UL, config_->stats().decoder_error_.value());
+
+  // The responses are no longer decoded once they are out of sync.
+  EXPECT_CALL(scope_, deliverHistogramToSinks(_, _)).Times(0);
+  Buffer::OwnedImpl ping_response = encodeResponse(enumToSignedInt(XidCodes::PING_XID));
+  EXPECT_EQ(Envoy::Network::FilterStatus::Continue, filter_->onWrite(ping_response, false));
+  EXPECT_EQ(0UL, config_->stats().response_bytes_.value());
+}
+
 } // namespace ZooKeeperProxy
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -0,0 +1,66 @@
+#include "envoy/config/filter/udp/udp_proxy/v2alpha/udp_proxy.pb.validate.h"
+
+#include "extensions/filters/udp/udp_proxy/config.h"
+#include "extensions/filters/udp/well_known_names.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+namespace {
+
+class MockUdpListenerFilterManager : public Network::UdpListenerFilterManager {
+public:
+  void addReadFilter(Network::UdpListenerReadFilterPtr&& filter) override {
+    filters_.emplace_back(std::move(filter));
+  }
+
+  std::vector<Network::UdpListenerReadFilterPtr> filters_;
+};
+
+TEST(UdpProxyFilterConfigFactoryTest, ValidateFail) {
+  NiceMock<Server::Configuration::MockListenerFactoryContext> context;
+  EXPECT_THROW(UdpProxyFilterConfigFactory().createFilterFactoryFromProto(
+                   envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig(), context),
+               ProtoValidationException);
+}
+
+TEST(UdpProxyFilterConfigFactoryTest, CreateFilter) {
+  const std::string yaml = R"EOF(
+stat_prefix: foo
+cluster: fake_cluster
+idle_timeout: 10s
+)EOF";
+  envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig proto_config;
+  MessageUtil::loadFromYaml(yaml, proto_config);
+
+  auto* factory = Registry::FactoryRegistry<
+      Server::Configuration::NamedUdpListenerFilterConfigFactory>::getFactory(UdpFilterNames::get()
+                                                                                  .UdpProxy);
+  ASSERT_NE(nullptr, factory);
+  NiceMock<Server::Configuration::MockListenerFactoryContext> context;
+  Network::UdpListenerFilterFactoryCb cb =
+      factory->createFilterFactoryFromProto(proto_config, context);
+
+  MockUdpListenerFilterManager filter_manager;
+  NiceMock<Network::MockUdpReadFilterCallbacks> callbacks;
+  cb(filter_manager, callbacks);
+  EXPECT_EQ(1, filter_manager.filters_.size());
+}
+
+} // namespace
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,251 @@
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/network/listen_socket_impl.h"
+#include "common/network/udp_packet_batch.h"
+#include "common/network/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::DoAll;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+namespace {
+
+class UdpProxyFilterTest : public testing::TestWithParam<Network::Address::IpVersion> {
+public:
+  UdpProxyFilterTest()
+      : upstream_(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true) {
+    ON_CALL(*cluster_manager_.thread_local_cluster_.lb_.host_, address())
+        .WillByDefault(Return(upstream_.localAddress()));
+  }
+
+  void setup(const std::string& yaml) {
+    envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+    config_ = std::make_shared<const UdpProxyFilterConfig>(proto_config, cluster_manager_,
+                                                           time_system_, stats_store_);
+    filter_ = std::make_unique<UdpProxyFilter>(callbacks_, config_);
+  }
+
+  // Expect a new session, and return its idle timer.
+  Event::MockTimer* expectSession(Event::FileReadyCb& read_cb) {
+    Event::MockDispatcher& dispatcher = callbacks_.udp_listener_.dispatcher_;
+    EXPECT_CALL(dispatcher, createFileEvent_(_, _, Event::FileTriggerType::Edge,
+                                             Event::FileReadyType::Read))
+        .WillOnce(DoAll(SaveArg<1>(&read_cb), Return(new NiceMock<Event::MockFileEvent>())));
+    Event::MockTimer* idle_timer = new NiceMock<Event::MockTimer>(&dispatcher);
+    EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(60000)));
+    return idle_timer;
+  }
+
+  void receiveDownstream(const std::string& peer, const std::vector<std::string>& datagrams) {
+    for (const std::string& datagram : datagrams) {
+      Network::UdpData data;
+      data.peer_address_ = Network::Utility::parseInternetAddressAndPort(peer);
+      data.buffer_ = std::make_unique<Buffer::OwnedImpl>(datagram);
+      filter_->onData(data);
+    }
+    filter_->onReceiveBatchComplete(datagrams.size());
+  }
+
+  // Receive the datagrams sent upstream, along with the address of their session's socket.
+  std::vector<std::string> receiveUpstream(Network::Address::InstanceConstSharedPtr& session) {
+    std::vector<std::string> datagrams;
+    Network::UdpPacketBatch batch(false);
+    EXPECT_GT(batch
+                  .receive(upstream_.ioHandle().fd(), true,
+                           [&](const Network::Address::InstanceConstSharedPtr& peer_address,
+                               Buffer::InstancePtr&& buffer) {
+                             session = peer_address;
+                             datagrams.push_back(buffer->toString());
+                           })
+                  .rc_,
+              0);
+    return datagrams;
+  }
+
+  void sendUpstream(const Network::Address::Instance& session, const std::string& datagram) {
+    Buffer::OwnedImpl buffer(datagram);
+    EXPECT_EQ(1, Network::UdpPacketBatch::sendTo(upstream_.ioHandle().fd(),
+                                                 *upstream_.localAddress(), {{session, buffer}})
+                     .rc_);
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("udp.foo." + name).value();
+  }
+
+  uint64_t gauge(const std::string& name) { return stats_store_.gauge("udp.foo." + name).value(); }
+
+  const std::string config_yaml_ = R"EOF(
+stat_prefix: foo
+cluster: fake_cluster
+)EOF";
+
+  Network::UdpListenSocket upstream_;
+  Stats::IsolatedStoreImpl stats_store_;
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Upstream::MockClusterManager> cluster_manager_;
+  NiceMock<Network::MockUdpReadFilterCallbacks> callbacks_;
+  UdpProxyFilterConfigSharedPtr config_;
+  std::unique_ptr<UdpProxyFilter> filter_;
+};
+
+INSTANTIATE_TEST_CASE_P(IpVersions, UdpProxyFilterTest,
+                        testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                        TestUtility::ipTestParamsToString);
+
+// The datagrams of a peer are sent upstream over its session, and the datagrams of the upstream
+// host are sent back to the peer.
+TEST_P(UdpProxyFilterTest, BasicFlow) {
+  setup(config_yaml_);
+  Event::FileReadyCb read_cb;
+  expectSession(read_cb);
+
+  receiveDownstream("10.0.0.1:1000", {"hello", "world"});
+  EXPECT_EQ(1, filter_->sessions());
+  EXPECT_EQ(1, counter("downstream_sess_total"));
+  EXPECT_EQ(1, gauge("downstream_sess_active"));
+  EXPECT_EQ(2, counter("downstream_rx_datagrams"));
+  EXPECT_EQ(2, counter("upstream_tx_datagrams"));
+
+  Network::Address::InstanceConstSharedPtr session;
+  std::vector<std::string> received = receiveUpstream(session);
+  if (received.size() < 2) {
+    const std::vector<std::string> rest = receiveUpstream(session);
+    received.insert(received.end(), rest.begin(), rest.end());
+  }
+  EXPECT_EQ((std::vector<std::string>{"hello", "world"}), received);
+
+  sendUpstream(*session, "response1");
+  sendUpstream(*session, "response2");
+  std::vector<std::string> responses;
+  EXPECT_CALL(callbacks_.udp_listener_, send(_))
+      .WillRepeatedly(Invoke([&](const std::vector<Network::UdpSendData>& datagrams) {
+        for (const Network::UdpSendData& datagram : datagrams) {
+          EXPECT_EQ("10.0.0.1:1000", datagram.peer_address_.asString());
+          responses.push_back(datagram.buffer_.toString());
+        }
+        return Api::SysCallIntResult{static_cast<int>(datagrams.size()), 0};
+      }));
+  read_cb(Event::FileReadyType::Read);
+  EXPECT_EQ((std::vector<std::string>{"response1", "response2"}), responses);
+  EXPECT_EQ(2, counter("upstream_rx_datagrams"));
+  EXPECT_EQ(2, counter("downstream_tx_datagrams"));
+  EXPECT_EQ(0, counter("downstream_tx_errors"));
+
+  // Further datagrams of the peer reuse its session.
+  receiveDownstream("10.0.0.1:1000", {"again"});
+  EXPECT_EQ(1, counter("downstream_sess_total"));
+  EXPECT_EQ((std::vector<std::string>{"again"}), receiveUpstream(session));
+
+  filter_.reset();
+  EXPECT_EQ(0, gauge("downstream_sess_active"));
+}
+
+// Each peer gets a session of its own.
+TEST_P(UdpProxyFilterTest, SessionPerPeer) {
+  setup(config_yaml_);
+  Event::FileReadyCb read_cb1;
+  Event::FileReadyCb read_cb2;
+  expectSession(read_cb1);
+  expectSession(read_cb2);
+
+  receiveDownstream("10.0.0.1:1000", {"hello"});
+  receiveDownstream("10.0.0.2:1000", {"world"});
+  EXPECT_EQ(2, filter_->sessions());
+  EXPECT_EQ(2, counter("downstream_sess_total"));
+  EXPECT_EQ(2, gauge("downstream_sess_active"));
+}
+
+// A session is closed once it has been idle for the idle timeout.
+TEST_P(UdpProxyFilterTest, IdleTimeout) {
+  setup(config_yaml_);
+  Event::FileReadyCb read_cb;
+  Event::MockTimer* idle_timer = expectSession(read_cb);
+
+  receiveDownstream("10.0.0.1:1000", {"hello"});
+  time_system_.sleep(std::chrono::seconds(40));
+  receiveDownstream("10.0.0.1:1000", {"world"});
+  time_system_.sleep(std::chrono::seconds(20));
+
+  // The timer is re-armed for the remainder of the timeout since the last datagram.
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(40000)));
+  idle_timer->invokeCallback();
+  EXPECT_EQ(1, filter_->sessions());
+
+  time_system_.sleep(std::chrono::seconds(40));
+  EXPECT_CALL(callbacks_.udp_listener_.dispatcher_, deferredDelete_(_));
+  idle_timer->invokeCallback();
+  EXPECT_EQ(0, filter_->sessions());
+  EXPECT_EQ(1, counter("idle_timeout"));
+
+  callbacks_.udp_listener_.dispatcher_.to_delete_.clear();
+  EXPECT_EQ(0, gauge("downstream_sess_active"));
+}
+
+TEST_P(UdpProxyFilterTest, NoCluster) {
+  setup(config_yaml_);
+  EXPECT_CALL(cluster_manager_, get("fake_cluster")).WillOnce(Return(nullptr));
+
+  receiveDownstream("10.0.0.1:1000", {"hello"});
+  EXPECT_EQ(0, filter_->sessions());
+  EXPECT_EQ(1, counter("downstream_sess_no_route"));
+  EXPECT_EQ(0, counter("downstream_sess_total"));
+}
+
+TEST_P(UdpProxyFilterTest, NoHealthyHost) {
+  setup(config_yaml_);
+  EXPECT_CALL(cluster_manager_.thread_local_cluster_.lb_, chooseHost(_)).WillOnce(Return(nullptr));
+
+  receiveDownstream("10.0.0.1:1000", {"hello"});
+  EXPECT_EQ(0, filter_->sessions());
+  EXPECT_EQ(1, counter("upstream_no_healthy_host"));
+  EXPECT_EQ(0, counter("downstream_sess_total"));
+}
+
+// A host without a socket bound to its port makes the session's socket report an error.
+TEST_P(UdpProxyFilterTest, UpstreamReceiveError) {
+  setup(config_yaml_);
+  Event::FileReadyCb read_cb;
+  expectSession(read_cb);
+
+  receiveDownstream("10.0.0.1:1000", {"hello"});
+  Network::Address::InstanceConstSharedPtr session;
+  EXPECT_EQ((std::vector<std::string>{"hello"}), receiveUpstream(session));
+  upstream_.close();
+
+  receiveDownstream("10.0.0.1:1000", {"world"});
+  EXPECT_CALL(callbacks_.udp_listener_, send(_)).Times(0);
+  read_cb(Event::FileReadyType::Read);
+  EXPECT_EQ(1, counter("upstream_rx_errors"));
+  EXPECT_EQ(1, filter_->sessions());
+}
+
+} // namespace
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
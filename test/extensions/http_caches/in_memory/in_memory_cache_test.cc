@@ -0,0 +1,105 @@
+#include <memory>
+#include <string>
+
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/http_caches/in_memory/in_memory_cache.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpCaches {
+namespace InMemory {
+namespace {
+
+class InMemoryCacheTest : public testing::Test {
+public:
+  void initialize(uint64_t max_bytes, uint32_t shards) {
+    cache_ = std::make_unique<InMemoryCache>(max_bytes, shards, "cache.in_memory.", stats_store_);
+  }
+
+  static Envoy::HttpCache::CacheEntryConstSharedPtr entry(const std::string& body) {
+    auto entry = std::make_shared<Envoy::HttpCache::CacheEntry>();
+    entry->body_ = std::make_shared<const std::string>(body);
+    return entry;
+  }
+
+  uint64_t gauge(const std::string& name) {
+    return stats_store_.gauge("cache.in_memory." + name).value();
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  std::unique_ptr<InMemoryCache> cache_;
+};
+
+// Entries are returned by key, and inserting a key again replaces its entry.
+TEST_F(InMemoryCacheTest, InsertLookupRemove) {
+  initialize(1024, 4);
+  EXPECT_EQ(nullptr, cache_->lookup("a"));
+  cache_->insert("a", entry("body"));
+  ASSERT_NE(nullptr, cache_->lookup("a"));
+  EXPECT_EQ("body", *cache_->lookup("a")->body_);
+  EXPECT_EQ(1, gauge("entries"));
+  EXPECT_EQ(5, gauge("bytes"));
+
+  cache_->insert("a", entry("other"));
+  EXPECT_EQ("other", *cache_->lookup("a")->body_);
+  EXPECT_EQ(1, gauge("entries"));
+  EXPECT_EQ(6, gauge("bytes"));
+
+  cache_->remove("a");
+  cache_->remove("b");
+  EXPECT_EQ(nullptr, cache_->lookup("a"));
+  EXPECT_EQ(0, gauge("entries"));
+  EXPECT_EQ(0, gauge("bytes"));
+}
+
+// The least recently used entries are evicted to stay under the maximum bytes.
+TEST_F(InMemoryCacheTest, Eviction) {
+  initialize(30, 1);
+  cache_->insert("a", entry(std::string(9, 'a')));
+  cache_->insert("b", entry(std::string(9, 'b')));
+  cache_->insert("c", entry(std::string(9, 'c')));
+  EXPECT_NE(nullptr, cache_->lookup("a"));
+
+  cache_->insert("d", entry(std::string(9, 'd')));
+  EXPECT_EQ(nullptr, cache_->lookup("b"));
+  EXPECT_NE(nullptr, cache_->lookup("a"));
+  EXPECT_NE(nullptr, cache_->lookup("c"));
+  EXPECT_NE(nullptr, cache_->lookup("d"));
+  EXPECT_EQ(1, stats_store_.counter("cache.in_memory.evicted").value());
+
+  cache_->insert("e", entry(std::string(29, 'e')));
+  EXPECT_EQ(4, stats_store_.counter("cache.in_memory.evicted").value());
+  EXPECT_EQ(1, gauge("entries"));
+  EXPECT_EQ(30, gauge("bytes"));
+  EXPECT_NE(nullptr, cache_->lookup("e"));
+}
+
+// Entries bigger than the share of a shard aren't stored, and remove the entry they replace.
+TEST_F(InMemoryCacheTest, TooBig) {
+  initialize(60, 2);
+  cache_->insert("a", entry("body"));
+  cache_->insert("a", entry(std::string(30, 'a')));
+  EXPECT_EQ(nullptr, cache_->lookup("a"));
+  EXPECT_EQ(0, gauge("entries"));
+  EXPECT_EQ(0, gauge("bytes"));
+  EXPECT_EQ(0, stats_store_.counter("cache.in_memory.evicted").value());
+}
+
+// The entries served to streams outlive their eviction.
+TEST_F(InMemoryCacheTest, EntryOutlivesEviction) {
+  initialize(10, 1);
+  cache_->insert("a", entry("body"));
+  Envoy::HttpCache::CacheEntryConstSharedPtr served = cache_->lookup("a");
+  cache_->insert("b", entry("other"));
+  EXPECT_EQ(nullptr, cache_->lookup("a"));
+  EXPECT_EQ("body", *served->body_);
+}
+
+} // namespace
+} // namespace InMemory
+} // namespace HttpCaches
+} // namespace Extensions
+} // namespace Envoy
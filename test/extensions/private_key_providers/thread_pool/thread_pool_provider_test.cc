@@ -0,0 +1,205 @@
+#include <string>
+#include <vector>
+
+#include "envoy/config/private_key_provider/thread_pool/v2alpha/thread_pool.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/private_key_providers/thread_pool/config.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+#include "openssl/ssl.h"
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyProviders {
+namespace ThreadPool {
+namespace {
+
+class TestCallbacks : public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  TestCallbacks(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  // Ssl::PrivateKeyConnectionCallbacks
+  void onPrivateKeyMethodComplete() override {
+    completed_++;
+    dispatcher_.exit();
+  }
+
+  Event::Dispatcher& dispatcher_;
+  uint32_t completed_{};
+};
+
+class ThreadPoolPrivateKeyMethodProviderTest : public testing::Test {
+protected:
+  ThreadPoolPrivateKeyMethodProviderTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher()),
+        callbacks_(*dispatcher_), ssl_ctx_(SSL_CTX_new(TLS_method())),
+        ssl_(SSL_new(ssl_ctx_.get())) {
+    ON_CALL(factory_context_, api()).WillByDefault(ReturnRef(*api_));
+  }
+
+  Ssl::PrivateKeyMethodProviderSharedPtr createProvider(const std::string& private_key) {
+    envoy::config::private_key_provider::thread_pool::v2alpha::ThreadPoolPrivateKeyProviderConfig
+        config;
+    config.mutable_private_key()->set_inline_string(private_key);
+    envoy::api::v2::auth::PrivateKeyProvider provider_config;
+    provider_config.set_provider_name("envoy.private_key_providers.thread_pool");
+    provider_config.mutable_typed_config()->PackFrom(config);
+
+    auto* factory =
+        Registry::FactoryRegistry<Ssl::PrivateKeyMethodProviderInstanceFactory>::getFactory(
+            "envoy.private_key_providers.thread_pool");
+    EXPECT_NE(nullptr, factory);
+    return factory->createPrivateKeyMethodProviderInstance(provider_config, factory_context_);
+  }
+
+  static std::string keyPem(const std::string& name) {
+    return TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/" + name));
+  }
+
+  static bssl::UniquePtr<EVP_PKEY> parseKey(const std::string& pem) {
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(const_cast<char*>(pem.data()), pem.size()));
+    return bssl::UniquePtr<EVP_PKEY>(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  }
+
+  // Waits for the pending operation and returns its output.
+  std::vector<uint8_t> complete(const SSL_PRIVATE_KEY_METHOD& method) {
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    EXPECT_EQ(1U, callbacks_.completed_);
+    std::vector<uint8_t> out(16 * 1024);
+    size_t out_len;
+    EXPECT_EQ(ssl_private_key_success,
+              method.complete(ssl_.get(), out.data(), &out_len, out.size()));
+    out.resize(out_len);
+    return out;
+  }
+
+  void signAndVerify(const std::string& key_file, uint16_t signature_algorithm) {
+    const std::string pem = keyPem(key_file);
+    Ssl::PrivateKeyMethodProviderSharedPtr provider = createProvider(pem);
+    provider->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+    const SSL_PRIVATE_KEY_METHOD& method = *provider->getBoringSslPrivateKeyMethod();
+
+    const std::string message = "handshake transcript";
+    const auto* in = reinterpret_cast<const uint8_t*>(message.data());
+    uint8_t unused_out;
+    size_t unused_out_len;
+    EXPECT_EQ(ssl_private_key_retry, method.sign(ssl_.get(), &unused_out, &unused_out_len, 0,
+                                                 signature_algorithm, in, message.size()));
+    const std::vector<uint8_t> signature = complete(method);
+
+    bssl::UniquePtr<EVP_PKEY> pkey = parseKey(pem);
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx;
+    ASSERT_TRUE(EVP_DigestVerifyInit(ctx.get(), &pctx,
+                                     SSL_get_signature_algorithm_digest(signature_algorithm),
+                                     nullptr, pkey.get()));
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm)) {
+      ASSERT_TRUE(EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING));
+      ASSERT_TRUE(EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1));
+    }
+    EXPECT_TRUE(
+        EVP_DigestVerify(ctx.get(), signature.data(), signature.size(), in, message.size()));
+    provider->unregisterPrivateKeyMethod(ssl_.get());
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  TestCallbacks callbacks_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  bssl::UniquePtr<SSL> ssl_;
+};
+
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, SignRsaPss) {
+  signAndVerify("selfsigned_key.pem", SSL_SIGN_RSA_PSS_RSAE_SHA256);
+}
+
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, SignRsaPkcs1) {
+  signAndVerify("selfsigned_key.pem", SSL_SIGN_RSA_PKCS1_SHA256);
+}
+
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, SignEcdsa) {
+  signAndVerify("selfsigned_ecdsa_p256_key.pem", SSL_SIGN_ECDSA_SECP256R1_SHA256);
+}
+
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, DecryptRsa) {
+  const std::string pem = keyPem("selfsigned_key.pem");
+  Ssl::PrivateKeyMethodProviderSharedPtr provider = createProvider(pem);
+  provider->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+  const SSL_PRIVATE_KEY_METHOD& method = *provider->getBoringSslPrivateKeyMethod();
+
+  bssl::UniquePtr<EVP_PKEY> pkey = parseKey(pem);
+  RSA* rsa = EVP_PKEY_get0_RSA(pkey.get());
+  const std::string secret = "premaster secret";
+  std::vector<uint8_t> encrypted(RSA_size(rsa));
+  size_t encrypted_len;
+  ASSERT_TRUE(RSA_encrypt(rsa, &encrypted_len, encrypted.data(), encrypted.size(),
+                          reinterpret_cast<const uint8_t*>(secret.data()), secret.size(),
+                          RSA_PKCS1_PADDING));
+
+  uint8_t unused_out;
+  size_t unused_out_len;
+  EXPECT_EQ(ssl_private_key_retry, method.decrypt(ssl_.get(), &unused_out, &unused_out_len, 0,
+                                                  encrypted.data(), encrypted_len));
+  // The decryption has no padding, so the secret ends the output.
+  const std::vector<uint8_t> decrypted = complete(method);
+  ASSERT_EQ(encrypted_len, decrypted.size());
+  EXPECT_EQ(secret, std::string(decrypted.end() - secret.size(), decrypted.end()));
+  provider->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+// Connections that unregister before their operation completes aren't notified.
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, UnregisterCancels) {
+  Ssl::PrivateKeyMethodProviderSharedPtr provider = createProvider(keyPem("selfsigned_key.pem"));
+  provider->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+  const SSL_PRIVATE_KEY_METHOD& method = *provider->getBoringSslPrivateKeyMethod();
+  const std::string message = "handshake transcript";
+  uint8_t unused_out;
+  size_t unused_out_len;
+  EXPECT_EQ(ssl_private_key_retry,
+            method.sign(ssl_.get(), &unused_out, &unused_out_len, 0, SSL_SIGN_RSA_PKCS1_SHA256,
+                        reinterpret_cast<const uint8_t*>(message.data()), message.size()));
+  provider->unregisterPrivateKeyMethod(ssl_.get());
+  EXPECT_EQ(ssl_private_key_failure,
+            method.complete(ssl_.get(), &unused_out, &unused_out_len, 0));
+
+  // Releasing the last provider of the pool joins its threads.
+  provider.reset();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(0U, callbacks_.completed_);
+}
+
+// Operations fail on connections that didn't register.
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, NotRegistered) {
+  Ssl::PrivateKeyMethodProviderSharedPtr provider = createProvider(keyPem("selfsigned_key.pem"));
+  const SSL_PRIVATE_KEY_METHOD& method = *provider->getBoringSslPrivateKeyMethod();
+  const std::string message = "handshake transcript";
+  uint8_t unused_out;
+  size_t unused_out_len;
+  EXPECT_EQ(ssl_private_key_failure,
+            method.sign(ssl_.get(), &unused_out, &unused_out_len, 0, SSL_SIGN_RSA_PKCS1_SHA256,
+                        reinterpret_cast<const uint8_t*>(message.data()), message.size()));
+}
+
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, InvalidKey) {
+  EXPECT_THROW_WITH_MESSAGE(createProvider("not a key"), EnvoyException,
+                            "Failed to load private key from <inline>");
+}
+
+} // namespace
+} // namespace ThreadPool
+} // namespace PrivateKeyProviders
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,104 @@
+#include "extensions/quic_listeners/quiche/connection_id_routing.h"
+
+#include "test/mocks/runtime/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace QuicListeners {
+namespace Quiche {
+namespace {
+
+TEST(ConnectionIdRoutingTest, LongHeader) {
+  // Initial packet: first byte, version, the lengths and values of the connection IDs.
+  const std::string packet("\xc0\xff\x00\x00\x17\x04"
+                           "abcd"
+                           "\x02"
+                           "xy"
+                           "payload",
+                           20);
+  const auto connection_id = ConnectionIdRouting::destinationConnectionId(packet);
+  ASSERT_TRUE(connection_id.has_value());
+  EXPECT_EQ("abcd", connection_id.value());
+}
+
+TEST(ConnectionIdRoutingTest, LongHeaderEmptyConnectionId) {
+  const std::string packet("\xc0\x00\x00\x00\x01\x00\x00", 7);
+  const auto connection_id = ConnectionIdRouting::destinationConnectionId(packet);
+  ASSERT_TRUE(connection_id.has_value());
+  EXPECT_TRUE(connection_id.value().empty());
+}
+
+TEST(ConnectionIdRoutingTest, ShortHeader) {
+  const std::string packet("\x40"
+                           "12345678"
+                           "payload");
+  const auto connection_id = ConnectionIdRouting::destinationConnectionId(packet);
+  ASSERT_TRUE(connection_id.has_value());
+  EXPECT_EQ("12345678", connection_id.value());
+}
+
+TEST(ConnectionIdRoutingTest, Truncated) {
+  EXPECT_FALSE(ConnectionIdRouting::destinationConnectionId("").has_value());
+  EXPECT_FALSE(ConnectionIdRouting::destinationConnectionId("\x40"
+                                                            "1234567")
+                   .has_value());
+  EXPECT_FALSE(
+      ConnectionIdRouting::destinationConnectionId(std::string("\xc0\xff\x00\x00\x17", 5))
+          .has_value());
+  EXPECT_FALSE(
+      ConnectionIdRouting::destinationConnectionId(std::string("\xc0\xff\x00\x00\x17\x04"
+                                                               "abc",
+                                                               9))
+          .has_value());
+}
+
+TEST(ConnectionIdRoutingTest, WorkerIndex) {
+  EXPECT_EQ(0, ConnectionIdRouting::workerIndex(std::string("\x00\x00\x00\x04zzzz", 8), 4));
+  EXPECT_EQ(1, ConnectionIdRouting::workerIndex(std::string("\x00\x00\x00\x05zzzz", 8), 4));
+  EXPECT_EQ(0, ConnectionIdRouting::workerIndex("abcdefgh", 1));
+
+  // Short connection IDs are hashed, consistently.
+  EXPECT_EQ(ConnectionIdRouting::workerIndex("ab", 7), ConnectionIdRouting::workerIndex("ab", 7));
+  EXPECT_GT(7, ConnectionIdRouting::workerIndex("ab", 7));
+  EXPECT_GT(7, ConnectionIdRouting::workerIndex("", 7));
+}
+
+TEST(ConnectionIdRoutingTest, GenerateConnectionId) {
+  NiceMock<Runtime::MockRandomGenerator> random;
+  for (const uint64_t bits : {0UL, 0x123456789abcdef0UL, ~0UL}) {
+    ON_CALL(random, random()).WillByDefault(Return(bits));
+    for (const uint32_t concurrency : {1, 3, 7, 16, 1000}) {
+      for (uint32_t worker_index = 0; worker_index < concurrency; worker_index++) {
+        const std::string connection_id =
+            ConnectionIdRouting::generateConnectionId(worker_index, concurrency, random);
+        EXPECT_EQ(ConnectionIdRouting::ServerConnectionIdLength, connection_id.size());
+        EXPECT_EQ(worker_index, ConnectionIdRouting::workerIndex(connection_id, concurrency));
+
+        // The packets that follow carry the connection ID in their short header.
+        const std::string packet = "\x40" + connection_id + "payload";
+        EXPECT_EQ(connection_id, ConnectionIdRouting::destinationConnectionId(packet).value());
+      }
+    }
+  }
+}
+
+TEST(ConnectionIdRoutingTest, GenerateConnectionIdKeepsRandomBytes) {
+  NiceMock<Runtime::MockRandomGenerator> random;
+  ON_CALL(random, random()).WillByDefault(Return(0x0807060504030201UL));
+  EXPECT_EQ(std::string("\x01\x02\x03\x04\x05\x06\x07\x08", 8),
+            ConnectionIdRouting::generateConnectionId(0x04, 0x100, random));
+  EXPECT_EQ(std::string("\x01\x02\x03\x05\x05\x06\x07\x08", 8),
+            ConnectionIdRouting::generateConnectionId(0x05, 0x100, random));
+}
+
+} // namespace
+} // namespace Quiche
+} // namespace QuicListeners
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,134 @@
+#include <vector>
+
+#include "extensions/resource_monitors/event_loop_lag/event_loop_lag_monitor.h"
+
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "absl/types/optional.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopLagMonitor {
+namespace {
+
+class ResourcePressure : public Server::ResourceMonitor::Callbacks {
+public:
+  void onSuccess(const Server::ResourceUsage& usage) override {
+    pressure_ = usage.resource_pressure_;
+  }
+
+  void onFailure(const EnvoyException& error) override { error_ = error; }
+
+  bool hasPressure() const { return pressure_.has_value(); }
+  bool hasError() const { return error_.has_value(); }
+
+  double pressure() const { return *pressure_; }
+
+private:
+  absl::optional<double> pressure_;
+  absl::optional<EnvoyException> error_;
+};
+
+// Slot that holds on to the posted callbacks, so that the test decides when each thread runs them.
+class ProbeCapturingSlot : public ThreadLocal::Slot {
+public:
+  ProbeCapturingSlot(std::vector<Event::PostCb>& thread_cbs,
+                     std::vector<Event::PostCb>& complete_cbs)
+      : thread_cbs_(thread_cbs), complete_cbs_(complete_cbs) {}
+
+  // ThreadLocal::Slot
+  ThreadLocal::ThreadLocalObjectSharedPtr get() override { return nullptr; }
+  void runOnAllThreads(Event::PostCb cb) override { thread_cbs_.push_back(cb); }
+  void runOnAllThreads(Event::PostCb cb, Event::PostCb all_threads_complete_cb) override {
+    thread_cbs_.push_back(cb);
+    complete_cbs_.push_back(all_threads_complete_cb);
+  }
+  void set(InitializeCb) override {}
+
+private:
+  std::vector<Event::PostCb>& thread_cbs_;
+  std::vector<Event::PostCb>& complete_cbs_;
+};
+
+class EventLoopLagMonitorTest : public testing::Test {
+public:
+  EventLoopLagMonitorTest() {
+    ON_CALL(tls_, allocateSlot()).WillByDefault(Invoke([this]() -> ThreadLocal::SlotPtr {
+      return std::make_unique<ProbeCapturingSlot>(thread_cbs_, complete_cbs_);
+    }));
+    config_.mutable_max_lag()->set_nanos(100 * 1000 * 1000);
+    monitor_ = std::make_unique<EventLoopLagMonitor>(config_, tls_, time_system_);
+  }
+
+  double update() {
+    ResourcePressure resource;
+    monitor_->updateResourceUsage(resource);
+    EXPECT_TRUE(resource.hasPressure());
+    EXPECT_FALSE(resource.hasError());
+    return resource.pressure();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  std::vector<Event::PostCb> thread_cbs_;
+  std::vector<Event::PostCb> complete_cbs_;
+  envoy::config::resource_monitor::event_loop_lag::v2alpha::EventLoopLagConfig config_;
+  std::unique_ptr<EventLoopLagMonitor> monitor_;
+};
+
+TEST_F(EventLoopLagMonitorTest, ReportsLongestProbeDelay) {
+  EXPECT_DOUBLE_EQ(0.0, update());
+  ASSERT_EQ(1UL, thread_cbs_.size());
+
+  // Two threads run the probe, 30ms and 50ms after it was posted.
+  time_system_.sleep(std::chrono::milliseconds(30));
+  thread_cbs_[0]();
+  time_system_.sleep(std::chrono::milliseconds(20));
+  thread_cbs_[0]();
+  complete_cbs_[0]();
+
+  EXPECT_DOUBLE_EQ(0.5, update());
+  EXPECT_EQ(2UL, thread_cbs_.size());
+  thread_cbs_[1]();
+  complete_cbs_[1]();
+  EXPECT_DOUBLE_EQ(0.0, update());
+}
+
+TEST_F(EventLoopLagMonitorTest, OutstandingProbe) {
+  EXPECT_DOUBLE_EQ(0.0, update());
+  time_system_.sleep(std::chrono::milliseconds(40));
+  thread_cbs_[0]();
+  complete_cbs_[0]();
+
+  // A thread that has not run the probe yet lags by at least the time since it was posted. No
+  // other probe is posted until it completes.
+  EXPECT_DOUBLE_EQ(0.4, update());
+  time_system_.sleep(std::chrono::milliseconds(250));
+  EXPECT_DOUBLE_EQ(2.5, update());
+  EXPECT_EQ(2UL, thread_cbs_.size());
+
+  thread_cbs_[1]();
+  complete_cbs_[1]();
+  EXPECT_DOUBLE_EQ(2.5, update());
+  EXPECT_EQ(3UL, thread_cbs_.size());
+}
+
+TEST_F(EventLoopLagMonitorTest, ProbeOutlivesMonitor) {
+  update();
+  monitor_.reset();
+  thread_cbs_[0]();
+  complete_cbs_[0]();
+}
+
+} // namespace
+} // namespace EventLoopLagMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
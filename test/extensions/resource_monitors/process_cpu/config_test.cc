@@ -0,0 +1,42 @@
+#include "envoy/config/resource_monitor/process_cpu/v2alpha/process_cpu.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "server/resource_monitor_config_impl.h"
+
+#include "extensions/resource_monitors/process_cpu/config.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace ProcessCpuMonitor {
+namespace {
+
+TEST(ProcessCpuMonitorFactoryTest, CreateMonitor) {
+  auto factory =
+      Registry::FactoryRegistry<Server::Configuration::ResourceMonitorFactory>::getFactory(
+          "envoy.resource_monitors.process_cpu");
+  EXPECT_NE(factory, nullptr);
+
+  envoy::config::resource_monitor::process_cpu::v2alpha::ProcessCpuConfig config;
+  config.set_max_cpu_cores(1.5);
+  Event::MockDispatcher dispatcher;
+  Api::ApiPtr api = Api::createApiForTest();
+  NiceMock<ThreadLocal::MockInstance> tls;
+  Server::Configuration::ResourceMonitorFactoryContextImpl context(dispatcher, *api, tls);
+  auto monitor = factory->createResourceMonitor(config, context);
+  EXPECT_NE(monitor, nullptr);
+}
+
+} // namespace
+} // namespace ProcessCpuMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,105 @@
+#include "extensions/resource_monitors/process_cpu/process_cpu_monitor.h"
+
+#include "test/test_common/simulated_time_system.h"
+
+#include "absl/types/optional.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Return;
+using testing::Throw;
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace ProcessCpuMonitor {
+namespace {
+
+class MockCpuTimeReader : public CpuTimeReader {
+public:
+  MockCpuTimeReader() {}
+
+  MOCK_METHOD0(processCpuTime, std::chrono::microseconds());
+};
+
+class ResourcePressure : public Server::ResourceMonitor::Callbacks {
+public:
+  void onSuccess(const Server::ResourceUsage& usage) override {
+    pressure_ = usage.resource_pressure_;
+  }
+
+  void onFailure(const EnvoyException& error) override { error_ = error; }
+
+  bool hasPressure() const { return pressure_.has_value(); }
+  bool hasError() const { return error_.has_value(); }
+
+  double pressure() const { return *pressure_; }
+
+private:
+  absl::optional<double> pressure_;
+  absl::optional<EnvoyException> error_;
+};
+
+class ProcessCpuMonitorTest : public testing::Test {
+public:
+  ProcessCpuMonitorTest() {
+    config_.set_max_cpu_cores(2);
+    auto reader = std::make_unique<MockCpuTimeReader>();
+    reader_ = reader.get();
+    EXPECT_CALL(*reader_, processCpuTime()).WillOnce(Return(std::chrono::seconds(10)));
+    monitor_ = std::make_unique<ProcessCpuMonitor>(config_, time_system_, std::move(reader));
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  envoy::config::resource_monitor::process_cpu::v2alpha::ProcessCpuConfig config_;
+  MockCpuTimeReader* reader_;
+  std::unique_ptr<ProcessCpuMonitor> monitor_;
+};
+
+TEST_F(ProcessCpuMonitorTest, ComputesCorrectUsage) {
+  // One CPU second in one wall clock second uses half of the two cores.
+  time_system_.sleep(std::chrono::seconds(1));
+  EXPECT_CALL(*reader_, processCpuTime()).WillOnce(Return(std::chrono::seconds(11)));
+  ResourcePressure resource;
+  monitor_->updateResourceUsage(resource);
+  EXPECT_TRUE(resource.hasPressure());
+  EXPECT_FALSE(resource.hasError());
+  EXPECT_DOUBLE_EQ(resource.pressure(), 0.5);
+
+  time_system_.sleep(std::chrono::seconds(2));
+  EXPECT_CALL(*reader_, processCpuTime()).WillOnce(Return(std::chrono::seconds(15)));
+  monitor_->updateResourceUsage(resource);
+  EXPECT_DOUBLE_EQ(resource.pressure(), 1.0);
+
+  // Without the clock moving, the previous pressure is reported again.
+  EXPECT_CALL(*reader_, processCpuTime()).WillOnce(Return(std::chrono::seconds(16)));
+  monitor_->updateResourceUsage(resource);
+  EXPECT_DOUBLE_EQ(resource.pressure(), 1.0);
+
+  // ... and the CPU time used meanwhile is accounted for in the next update.
+  time_system_.sleep(std::chrono::seconds(1));
+  EXPECT_CALL(*reader_, processCpuTime()).WillOnce(Return(std::chrono::seconds(16)));
+  monitor_->updateResourceUsage(resource);
+  EXPECT_DOUBLE_EQ(resource.pressure(), 0.5);
+}
+
+TEST_F(ProcessCpuMonitorTest, ReadFailure) {
+  time_system_.sleep(std::chrono::seconds(1));
+  EXPECT_CALL(*reader_, processCpuTime()).WillOnce(Throw(EnvoyException("failed")));
+  ResourcePressure resource;
+  monitor_->updateResourceUsage(resource);
+  EXPECT_FALSE(resource.hasPressure());
+  EXPECT_TRUE(resource.hasError());
+}
+
+TEST(CpuTimeReaderTest, ProcessCpuTimeIsMonotonic) {
+  CpuTimeReader reader;
+  const std::chrono::microseconds before = reader.processCpuTime();
+  EXPECT_LE(before, reader.processCpuTime());
+}
+
+} // namespace
+} // namespace ProcessCpuMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
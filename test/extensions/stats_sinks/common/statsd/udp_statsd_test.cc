@@ -1,4 +1,6 @@
 #include <chrono>
+#include <string>
+#include <vector>
 
 #include "common/network/address_impl.h"
 #include "common/network/utility.h"
@@ -15,7 +17,9 @@
 #include "gtest/gtest.h"
 #include "spdlog/spdlog.h"
 
+using testing::_;
 using testing::NiceMock;
+using testing::ReturnRef;
 
 namespace Envoy {
 namespace Extensions {
@@ -27,6 +31,7 @@ namespace {
 class MockWriter : public Writer {
 public:
   MOCK_METHOD1(write, void(const std::string& message));
+  MOCK_METHOD1(writeDatagrams, void(const std::vector<std::string>& datagrams));
 };
 
 class UdpStatsdSinkTest : public testing::TestWithParam<Network::Address::IpVersion> {};
@@ -73,6 +78,23 @@ TEST_P(UdpStatsdSinkTest, InitWithIpAddress) {
   tls_.shutdownThread();
 }
 
+TEST_P(UdpStatsdSinkTest, WriteDatagrams) {
+  auto server =
+      Network::Test::bindFreeLoopbackPort(GetParam(), Network::Address::SocketType::Datagram);
+  Writer writer(server.first);
+
+  const std::vector<std::string> datagrams{"envoy.a:1|c\nenvoy.b:2|c", "envoy.c:3|g"};
+  writer.writeDatagrams(datagrams);
+
+  // Each string arrives as its own datagram, in order.
+  for (const std::string& datagram : datagrams) {
+    char buffer[64];
+    const ssize_t rc = ::recv(server.second->fd(), buffer, sizeof(buffer), 0);
+    ASSERT_EQ(static_cast<ssize_t>(datagram.size()), rc);
+    EXPECT_EQ(datagram, std::string(buffer, rc));
+  }
+}
+
 class UdpStatsdSinkWithTagsTest : public testing::TestWithParam<Network::Address::IpVersion> {};
 INSTANTIATE_TEST_SUITE_P(IpVersions, UdpStatsdSinkWithTagsTest,
                          testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
@@ -158,6 +180,69 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
   tls_.shutdownThread();
 }
 
+TEST(UdpStatsdSinkTest, FlushChangedOnly) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, writer_ptr, false, "", true);
+  EXPECT_TRUE(sink.getFlushChangedOnlyForTest());
+
+  auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+  counter->name_ = "test_counter";
+  counter->used_ = true;
+  counter->latch_ = 1;
+  std::vector<Stats::CounterSharedPtr> changed_counters{counter};
+  source.counters_.push_back(std::make_shared<NiceMock<Stats::MockCounter>>());
+
+  // Only the changed view is flushed.
+  EXPECT_CALL(source, cachedCounters()).Times(0);
+  EXPECT_CALL(source, cachedGauges()).Times(0);
+  EXPECT_CALL(source, cachedChangedCounters()).WillOnce(ReturnRef(changed_counters));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
+              write("envoy.test_counter:1|c"));
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
+TEST(UdpStatsdSinkTest, BatchedDatagrams) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  // Room for two 23 byte counters and the newline between them.
+  UdpStatsdSink sink(tls_, writer_ptr, false, "", false, 47);
+  EXPECT_EQ(47, sink.getMaxBytesPerDatagramForTest());
+
+  for (const std::string& name : {"test_counter1", "test_counter2", "test_counter3"}) {
+    auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+    counter->name_ = name;
+    counter->used_ = true;
+    counter->latch_ = 1;
+    source.counters_.push_back(counter);
+  }
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "a_gauge_name_that_is_longer_than_a_whole_datagram";
+  gauge->value_ = 1;
+  gauge->used_ = true;
+  source.gauges_.push_back(gauge);
+
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), write(_)).Times(0);
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
+              writeDatagrams(std::vector<std::string>(
+                  {"envoy.test_counter1:1|c\nenvoy.test_counter2:1|c", "envoy.test_counter3:1|c",
+                   "envoy.a_gauge_name_that_is_longer_than_a_whole_datagram:1|g"})));
+  sink.flush(source);
+
+  // Nothing to send, nothing written.
+  source.counters_.clear();
+  source.gauges_.clear();
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_))
+      .Times(0);
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
 TEST(UdpStatsdSinkTest, CheckActualStatsWithCustomPrefix) {
   NiceMock<Stats::MockSource> source;
   auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
@@ -218,6 +303,48 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   tls_.shutdownThread();
 }
 
+TEST(UdpStatsdSinkWithTagsTest, RenderedMetricsCached) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, writer_ptr, true);
+
+  std::vector<Stats::Tag> tags = {Stats::Tag{"key1", "value1"}};
+  auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+  counter->name_ = "test_counter";
+  counter->used_ = true;
+  counter->latch_ = 1;
+  source.counters_.push_back(counter);
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "test_gauge";
+  gauge->value_ = 0;
+  gauge->used_ = true;
+  gauge->tags_ = tags;
+  source.gauges_.push_back(gauge);
+
+  // The tags of a metric are only rendered on its first flush.
+  EXPECT_CALL(*counter, tags()).WillOnce(ReturnRef(tags));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
+              write("envoy.test_counter:1|c|#key1:value1"))
+      .Times(2);
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
+              write("envoy.test_gauge:0|g|#key1:value1"));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
+              write("envoy.test_gauge:7|g|#key1:value1"));
+  sink.flush(source);
+  gauge->value_ = 7;
+  sink.flush(source);
+  EXPECT_EQ(2, sink.getRenderedMetricsForTest());
+
+  // Metrics that are gone from the store are forgotten on the next flush.
+  source.gauges_.clear();
+  gauge.reset();
+  sink.flush(source);
+  EXPECT_EQ(1, sink.getRenderedMetricsForTest());
+
+  tls_.shutdownThread();
+}
+
 } // namespace
 } // namespace Statsd
 } // namespace Common
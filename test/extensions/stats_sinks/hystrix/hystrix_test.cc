@@ -455,6 +455,39 @@ TEST_F(HystrixSinkTest, AddAndRemoveClusters) {
   validateResults(cluster_message_map[cluster2_name_], 0, 0, 0, 0, 0, window_size_);
 }
 
+TEST_F(HystrixSinkTest, StatsLookedUpOncePerClusterInfo) {
+  Buffer::OwnedImpl buffer = createClusterAndCallbacks();
+  sink_->registerConnection(&callbacks_);
+
+  // The stats of a cluster are looked up on its first flush only.
+  EXPECT_CALL(cluster1_.cluster_stats_scope_, counter("upstream_rq_2xx"));
+  EXPECT_CALL(cluster1_.cluster_stats_scope_, gauge("membership_total"));
+  const uint64_t success_step = 3;
+  for (uint64_t i = 0; i < (window_size_ + 1); i++) {
+    buffer.drain(buffer.length());
+    cluster1_.setCounterReturnValues(i, success_step, 0, 0, 0, 0, 0, 0, 0);
+    sink_->flush(source_);
+  }
+  std::unordered_map<std::string, std::string> cluster_message_map =
+      buildClusterMap(buffer.toString());
+  validateResults(cluster_message_map[cluster1_name_], success_step, 0, 0, 0, 0, window_size_);
+
+  // An updated cluster has a new cluster info, whose stats are looked up again while the rolling
+  // window carries on.
+  ClusterTestInfo updated_cluster1{cluster1_name_};
+  cluster_map_.erase(cluster1_name_);
+  addClusterToMap(cluster1_name_, updated_cluster1.cluster_);
+  EXPECT_CALL(updated_cluster1.cluster_stats_scope_, counter("upstream_rq_2xx"));
+  ON_CALL(updated_cluster1.success_counter_, value())
+      .WillByDefault(Return((window_size_ + 2) * success_step));
+  buffer.drain(buffer.length());
+  sink_->flush(source_);
+  cluster_message_map = buildClusterMap(buffer.toString());
+  Json::ObjectSharedPtr json_buffer =
+      Json::Factory::loadFromString(cluster_message_map[cluster1_name_]);
+  EXPECT_EQ(json_buffer->getInteger("rollingCountSuccess"), window_size_ * success_step);
+}
+
 TEST_F(HystrixSinkTest, HistogramTest) {
   InSequence s;
   std::vector<Stats::ParentHistogramSharedPtr> stored_histograms;
@@ -13,6 +13,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::ReturnRef;
 
 namespace Envoy {
 namespace Extensions {
@@ -154,6 +155,82 @@ TEST(MetricsServiceSinkTest, CheckStatsCount) {
   EXPECT_EQ(1, (*streamer_).metric_count);
 }
 
+TEST(MetricsServiceSinkTest, FlushChangedOnly) {
+  NiceMock<Stats::MockSource> source;
+  Event::SimulatedTimeSystem time_system;
+  std::shared_ptr<TestGrpcMetricsStreamer> streamer_{new TestGrpcMetricsStreamer()};
+
+  MetricsServiceSink sink(streamer_, time_system, true);
+
+  auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+  counter->name_ = "test_counter";
+  counter->used_ = true;
+  source.counters_.push_back(counter);
+
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "test_gauge";
+  gauge->used_ = true;
+  std::vector<Stats::GaugeSharedPtr> changed_gauges{gauge};
+
+  // Only the changed views are streamed.
+  std::vector<Stats::CounterSharedPtr> no_counters;
+  EXPECT_CALL(source, cachedCounters()).Times(0);
+  EXPECT_CALL(source, cachedGauges()).Times(0);
+  EXPECT_CALL(source, cachedHistograms()).Times(0);
+  EXPECT_CALL(source, cachedChangedCounters()).WillOnce(ReturnRef(no_counters));
+  EXPECT_CALL(source, cachedChangedGauges()).WillOnce(ReturnRef(changed_gauges));
+  sink.flush(source);
+  EXPECT_EQ(1, (*streamer_).metric_count);
+}
+
+class BatchingGrpcMetricsStreamer : public GrpcMetricsStreamer {
+public:
+  std::vector<std::vector<std::string>> messages_;
+  std::vector<int64_t> timestamps_ms_;
+  // GrpcMetricsStreamer
+  void send(envoy::service::metrics::v2::StreamMetricsMessage& message) {
+    messages_.emplace_back();
+    for (const auto& metrics_family : message.envoy_metrics()) {
+      messages_.back().push_back(metrics_family.name());
+      timestamps_ms_.push_back(metrics_family.metric(0).timestamp_ms());
+    }
+  }
+};
+
+TEST(MetricsServiceSinkTest, MaxMetricsPerMessage) {
+  NiceMock<Stats::MockSource> source;
+  Event::SimulatedTimeSystem time_system;
+  std::shared_ptr<BatchingGrpcMetricsStreamer> streamer_{new BatchingGrpcMetricsStreamer()};
+
+  MetricsServiceSink sink(streamer_, time_system, false, 2);
+
+  for (const char* name : {"counter_a", "counter_b", "counter_c"}) {
+    auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+    counter->name_ = name;
+    counter->used_ = true;
+    source.counters_.push_back(counter);
+  }
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "gauge";
+  gauge->used_ = true;
+  source.gauges_.push_back(gauge);
+
+  sink.flush(source);
+  EXPECT_EQ((std::vector<std::vector<std::string>>{{"counter_a", "counter_b"},
+                                                   {"counter_c", "gauge"}}),
+            streamer_->messages_);
+  // All the metrics of a flush have the same timestamp.
+  EXPECT_EQ(4, std::count(streamer_->timestamps_ms_.begin(), streamer_->timestamps_ms_.end(),
+                          streamer_->timestamps_ms_[0]));
+
+  // A flush without metrics still sends a single message.
+  streamer_->messages_.clear();
+  source.counters_.clear();
+  source.gauges_.clear();
+  sink.flush(source);
+  EXPECT_EQ((std::vector<std::vector<std::string>>{{}}), streamer_->messages_);
+}
+
 } // namespace
 } // namespace MetricsService
 } // namespace StatSinks
@@ -0,0 +1,65 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "envoy/config/metrics/v2/stats.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/stat_sinks/shared_memory/config.h"
+#include "extensions/stat_sinks/shared_memory/shared_memory_sink.h"
+#include "extensions/stat_sinks/well_known_names.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace SharedMemory {
+namespace {
+
+TEST(SharedMemoryConfigTest, ValidSharedMemorySink) {
+  const std::string name = StatsSinkNames::get().SharedMemory;
+
+  envoy::config::metrics::v2::SharedMemorySink sink_config;
+  sink_config.set_name(fmt::format("/envoy_shared_memory_config_test_{}", getpid()));
+
+  Server::Configuration::StatsSinkFactory* factory =
+      Registry::FactoryRegistry<Server::Configuration::StatsSinkFactory>::getFactory(name);
+  ASSERT_NE(factory, nullptr);
+
+  ProtobufTypes::MessagePtr message = factory->createEmptyConfigProto();
+  MessageUtil::jsonConvert(sink_config, *message);
+
+  NiceMock<Server::MockInstance> server;
+  Stats::SinkPtr sink = factory->createStatsSink(*message, server);
+  EXPECT_NE(sink, nullptr);
+  EXPECT_NE(dynamic_cast<SharedMemorySink*>(sink.get()), nullptr);
+  sink.reset();
+  shm_unlink(sink_config.name().c_str());
+}
+
+TEST(SharedMemoryConfigTest, EmptyName) {
+  const std::string name = StatsSinkNames::get().SharedMemory;
+
+  envoy::config::metrics::v2::SharedMemorySink sink_config;
+
+  Server::Configuration::StatsSinkFactory* factory =
+      Registry::FactoryRegistry<Server::Configuration::StatsSinkFactory>::getFactory(name);
+  ASSERT_NE(factory, nullptr);
+
+  NiceMock<Server::MockInstance> server;
+  EXPECT_THROW(factory->createStatsSink(sink_config, server), ProtoValidationException);
+}
+
+} // namespace
+} // namespace SharedMemory
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
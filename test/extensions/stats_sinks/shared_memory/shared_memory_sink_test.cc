@@ -0,0 +1,258 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/api/os_sys_calls_impl.h"
+
+#include "extensions/stat_sinks/shared_memory/segment.h"
+#include "extensions/stat_sinks/shared_memory/shared_memory_sink.h"
+
+#include "test/mocks/api/mocks.h"
+#include "test/mocks/stats/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace SharedMemory {
+namespace {
+
+class SharedMemorySinkTest : public testing::Test {
+public:
+  SharedMemorySinkTest() : name_(fmt::format("/envoy_shared_memory_sink_test_{}", getpid())) {
+    time_system_.setSystemTime(SystemTime(std::chrono::milliseconds(1234)));
+    sink_ =
+        std::make_unique<SharedMemorySink>(name_, time_system_, Api::OsSysCallsSingleton::get());
+  }
+
+  ~SharedMemorySinkTest() {
+    sink_.reset();
+    shm_unlink(name_.c_str());
+  }
+
+  std::shared_ptr<NiceMock<Stats::MockCounter>> addCounter(const std::string& name,
+                                                           uint64_t value) {
+    auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+    counter->name_ = name;
+    counter->value_ = value;
+    counter->used_ = value != 0;
+    source_.counters_.push_back(counter);
+    return counter;
+  }
+
+  std::shared_ptr<NiceMock<Stats::MockGauge>> addGauge(const std::string& name, uint64_t value) {
+    auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+    gauge->name_ = name;
+    gauge->value_ = value;
+    gauge->used_ = true;
+    source_.gauges_.push_back(gauge);
+    return gauge;
+  }
+
+  // Maps the segment the way an external reader would and reads a snapshot of it.
+  SegmentReader::Snapshot read() {
+    const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+    EXPECT_NE(-1, fd);
+    struct stat stat;
+    EXPECT_EQ(0, fstat(fd, &stat));
+    void* segment = mmap(nullptr, stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    EXPECT_NE(MAP_FAILED, segment);
+    SegmentReader::Snapshot snapshot;
+    EXPECT_TRUE(SegmentReader::read(segment, stat.st_size, snapshot));
+    munmap(segment, stat.st_size);
+    close(fd);
+    return snapshot;
+  }
+
+  const std::string name_;
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Stats::MockSource> source_;
+  std::unique_ptr<SharedMemorySink> sink_;
+};
+
+TEST_F(SharedMemorySinkTest, EmptySegment) {
+  SegmentReader::Snapshot snapshot = read();
+  EXPECT_EQ(0UL, snapshot.flags_);
+  EXPECT_EQ(sizeof(SegmentHeader), snapshot.segment_size_);
+  EXPECT_EQ(0UL, snapshot.layout_generation_);
+  EXPECT_TRUE(snapshot.quantiles_.empty());
+  EXPECT_TRUE(snapshot.records_.empty());
+}
+
+TEST_F(SharedMemorySinkTest, CountersGaugesAndHistograms) {
+  auto counter = addCounter("cluster.foo.upstream_rq_total", 5);
+  counter->tags_ = {{"envoy.cluster_name", "foo"}};
+  const std::string tag_extracted_name = "cluster.upstream_rq_total";
+  ON_CALL(*counter, tagExtractedName()).WillByDefault(testing::ReturnRef(tag_extracted_name));
+  addCounter("unused", 0);
+  addGauge("server.live", 1);
+
+  auto histogram = std::make_shared<NiceMock<Stats::MockParentHistogram>>();
+  histogram->name_ = "http.rq_time";
+  histogram->used_ = true;
+  source_.histograms_.push_back(histogram);
+
+  sink_->flush(source_);
+  SegmentReader::Snapshot snapshot = read();
+  EXPECT_EQ(1UL, snapshot.layout_generation_);
+  EXPECT_EQ(1234UL, snapshot.update_time_ms_);
+  EXPECT_EQ(histogram->histogram_stats_->supportedQuantiles(), snapshot.quantiles_);
+  ASSERT_EQ(4UL, snapshot.records_.size());
+
+  const SegmentReader::Record& counter_record = snapshot.records_[0];
+  EXPECT_EQ(RecordType::Counter, counter_record.type_);
+  EXPECT_TRUE(counter_record.used_);
+  EXPECT_EQ("cluster.foo.upstream_rq_total", counter_record.name_);
+  EXPECT_EQ(tag_extracted_name, counter_record.tag_extracted_name_);
+  ASSERT_EQ(1UL, counter_record.tags_.size());
+  EXPECT_EQ("envoy.cluster_name", counter_record.tags_[0].first);
+  EXPECT_EQ("foo", counter_record.tags_[0].second);
+  EXPECT_EQ(5UL, counter_record.value_);
+
+  EXPECT_EQ(RecordType::Counter, snapshot.records_[1].type_);
+  EXPECT_FALSE(snapshot.records_[1].used_);
+  EXPECT_EQ("unused", snapshot.records_[1].name_);
+
+  EXPECT_EQ(RecordType::Gauge, snapshot.records_[2].type_);
+  EXPECT_EQ("server.live", snapshot.records_[2].name_);
+  EXPECT_EQ(1UL, snapshot.records_[2].value_);
+
+  const SegmentReader::Record& histogram_record = snapshot.records_[3];
+  EXPECT_EQ(RecordType::Histogram, histogram_record.type_);
+  EXPECT_EQ("http.rq_time", histogram_record.name_);
+  EXPECT_EQ(0UL, histogram_record.value_);
+  EXPECT_EQ(snapshot.quantiles_.size(), histogram_record.quantile_values_.size());
+}
+
+TEST_F(SharedMemorySinkTest, ValuesAreUpdatedInPlace) {
+  auto counter = addCounter("counter", 1);
+  auto gauge = addGauge("gauge", 2);
+  sink_->flush(source_);
+  EXPECT_EQ(1UL, read().layout_generation_);
+
+  counter->value_ = 10;
+  gauge->value_ = 20;
+  time_system_.setSystemTime(SystemTime(std::chrono::milliseconds(5678)));
+  sink_->flush(source_);
+  SegmentReader::Snapshot snapshot = read();
+  EXPECT_EQ(1UL, snapshot.layout_generation_);
+  EXPECT_EQ(5678UL, snapshot.update_time_ms_);
+  EXPECT_EQ(10UL, snapshot.records_[0].value_);
+  EXPECT_EQ(20UL, snapshot.records_[1].value_);
+
+  // A new stat rewrites the layout.
+  addCounter("another_counter", 3);
+  sink_->flush(source_);
+  snapshot = read();
+  EXPECT_EQ(2UL, snapshot.layout_generation_);
+  ASSERT_EQ(3UL, snapshot.records_.size());
+  EXPECT_EQ("another_counter", snapshot.records_[1].name_);
+  EXPECT_EQ(3UL, snapshot.records_[1].value_);
+  EXPECT_EQ("gauge", snapshot.records_[2].name_);
+}
+
+TEST_F(SharedMemorySinkTest, SegmentGrows) {
+  const uint64_t initial_size = sink_->segmentSize();
+  const std::string long_name(1000, 'a');
+  for (uint64_t i = 0; i < 100; ++i) {
+    addCounter(fmt::format("{}{}", long_name, i), i);
+  }
+  sink_->flush(source_);
+  EXPECT_LT(initial_size, sink_->segmentSize());
+
+  SegmentReader::Snapshot snapshot = read();
+  ASSERT_EQ(100UL, snapshot.records_.size());
+  EXPECT_EQ(long_name + "99", snapshot.records_[99].name_);
+  EXPECT_EQ(99UL, snapshot.records_[99].value_);
+}
+
+TEST_F(SharedMemorySinkTest, ClosedOnDestruction) {
+  const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+  ASSERT_NE(-1, fd);
+  const uint64_t size = sink_->segmentSize();
+  void* segment = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ASSERT_NE(MAP_FAILED, segment);
+
+  sink_.reset();
+  SegmentReader::Snapshot snapshot;
+  EXPECT_TRUE(SegmentReader::read(segment, size, snapshot));
+  EXPECT_TRUE(snapshot.flags_ & SegmentFlags::Closed);
+  munmap(segment, size);
+  close(fd);
+}
+
+TEST(SegmentReaderTest, InvalidSegments) {
+  std::vector<uint64_t> storage(64);
+  SegmentHeader* header = reinterpret_cast<SegmentHeader*>(storage.data());
+  SegmentReader::Snapshot snapshot;
+
+  // Too small to hold a header.
+  EXPECT_FALSE(SegmentReader::read(header, sizeof(SegmentHeader) - 1, snapshot));
+
+  // Bad magic.
+  header->segment_size_ = sizeof(SegmentHeader);
+  EXPECT_FALSE(SegmentReader::read(header, storage.size() * sizeof(uint64_t), snapshot));
+
+  memcpy(header->magic_, SegmentMagic, sizeof(SegmentMagic));
+  header->version_ = SegmentVersion;
+  header->header_size_ = sizeof(SegmentHeader);
+  header->quantiles_offset_ = sizeof(SegmentHeader);
+  header->records_offset_ = sizeof(SegmentHeader);
+  EXPECT_TRUE(SegmentReader::read(header, storage.size() * sizeof(uint64_t), snapshot));
+
+  // An update in progress.
+  header->sequence_ = 1;
+  EXPECT_FALSE(SegmentReader::read(header, storage.size() * sizeof(uint64_t), snapshot));
+  header->sequence_ = 2;
+
+  // A record running past the end of the segment.
+  header->num_records_ = 1;
+  EXPECT_FALSE(SegmentReader::read(header, storage.size() * sizeof(uint64_t), snapshot));
+
+  // A segment larger than the mapping.
+  header->num_records_ = 0;
+  header->segment_size_ = 1024;
+  EXPECT_FALSE(SegmentReader::read(header, storage.size() * sizeof(uint64_t), snapshot));
+  EXPECT_EQ(1024UL, snapshot.segment_size_);
+}
+
+TEST(SharedMemorySinkCreateTest, OpenFailure) {
+  Event::SimulatedTimeSystem time_system;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  EXPECT_CALL(os_sys_calls, shmOpen(_, _, _)).WillOnce(Return(Api::SysCallIntResult{-1, EACCES}));
+  EXPECT_THROW_WITH_MESSAGE(SharedMemorySink("/envoy_stats", time_system, os_sys_calls),
+                            EnvoyException,
+                            "cannot create shared memory stats segment /envoy_stats: Permission "
+                            "denied");
+}
+
+TEST(SharedMemorySinkCreateTest, MapFailure) {
+  Event::SimulatedTimeSystem time_system;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  EXPECT_CALL(os_sys_calls, shmOpen(_, _, _)).WillOnce(Return(Api::SysCallIntResult{42, 0}));
+  EXPECT_CALL(os_sys_calls, ftruncate(42, _)).WillOnce(Return(Api::SysCallIntResult{-1, ENOSPC}));
+  EXPECT_CALL(os_sys_calls, close(42));
+  EXPECT_THROW_WITH_MESSAGE(SharedMemorySink("/envoy_stats", time_system, os_sys_calls),
+                            EnvoyException, "cannot map shared memory stats segment /envoy_stats");
+}
+
+} // namespace
+} // namespace SharedMemory
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -82,6 +82,36 @@ TEST_P(StatsConfigParameterizedTest, UdpSinkDefaultPrefix) {
   auto udp_sink = dynamic_cast<Common::Statsd::UdpStatsdSink*>(sink.get());
   ASSERT_NE(udp_sink, nullptr);
   EXPECT_EQ(udp_sink->getPrefix(), defaultPrefix);
+  EXPECT_FALSE(udp_sink->getFlushChangedOnlyForTest());
+  EXPECT_EQ(0, udp_sink->getMaxBytesPerDatagramForTest());
+}
+
+TEST_P(StatsConfigParameterizedTest, UdpSinkBatching) {
+  const std::string name = StatsSinkNames::get().Statsd;
+
+  envoy::config::metrics::v2::StatsdSink sink_config;
+  envoy::api::v2::core::SocketAddress& socket_address =
+      *sink_config.mutable_address()->mutable_socket_address();
+  socket_address.set_protocol(envoy::api::v2::core::SocketAddress::UDP);
+  socket_address.set_address(GetParam() == Network::Address::IpVersion::v4 ? "127.0.0.1" : "::1");
+  socket_address.set_port_value(8125);
+  sink_config.set_flush_changed_only(true);
+  sink_config.mutable_max_bytes_per_datagram()->set_value(1432);
+
+  Server::Configuration::StatsSinkFactory* factory =
+      Registry::FactoryRegistry<Server::Configuration::StatsSinkFactory>::getFactory(name);
+  ASSERT_NE(factory, nullptr);
+  ProtobufTypes::MessagePtr message = factory->createEmptyConfigProto();
+  MessageUtil::jsonConvert(sink_config, *message);
+
+  NiceMock<Server::MockInstance> server;
+  Stats::SinkPtr sink = factory->createStatsSink(*message, server);
+  ASSERT_NE(sink, nullptr);
+
+  auto udp_sink = dynamic_cast<Common::Statsd::UdpStatsdSink*>(sink.get());
+  ASSERT_NE(udp_sink, nullptr);
+  EXPECT_TRUE(udp_sink->getFlushChangedOnlyForTest());
+  EXPECT_EQ(1432, udp_sink->getMaxBytesPerDatagramForTest());
 }
 
 TEST_P(StatsConfigParameterizedTest, UdpSinkCustomPrefix) {
@@ -110,6 +110,25 @@ TEST(ZipkinSpanBufferTest, sizeConstructorEndtoEnd) {
   EXPECT_EQ("[]", buffer.toStringifiedJsonArray());
 }
 
+TEST(ZipkinSpanBufferTest, protoListOfSpans) {
+  DangerousDeprecatedTestTime test_time;
+  SpanBuffer buffer(2);
+
+  EXPECT_EQ("", buffer.toProtoListOfSpans());
+
+  buffer.addSpan(Span(test_time.timeSystem()));
+  buffer.addSpan(Span(test_time.timeSystem()));
+  // Each span only has its zero trace id and id.
+  const std::string span = std::string("\x0a\x08", 2) + std::string(8, '\0') +
+                           std::string("\x1a\x08", 2) + std::string(8, '\0');
+  const std::string expected =
+      std::string("\x0a\x14", 2) + span + std::string("\x0a\x14", 2) + span;
+  EXPECT_EQ(expected, buffer.toProtoListOfSpans());
+
+  buffer.clear();
+  EXPECT_EQ("", buffer.toProtoListOfSpans());
+}
+
 } // namespace
 } // namespace Zipkin
 } // namespace Tracers
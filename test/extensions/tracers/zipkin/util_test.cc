@@ -45,6 +45,29 @@ TEST(ZipkinUtilTest, utilTests) {
   EXPECT_EQ(expected_json, merged_json);
 }
 
+TEST(ZipkinUtilTest, protoWireFormat) {
+  std::string proto;
+  Util::addProtoVarint(proto, 1, 300);
+  EXPECT_EQ(std::string("\x08\xac\x02"), proto);
+
+  proto.clear();
+  Util::addProtoFixed64(proto, 6, 0x0102030405060708);
+  EXPECT_EQ(std::string("\x31\x08\x07\x06\x05\x04\x03\x02\x01"), proto);
+
+  proto.clear();
+  Util::addProtoBytes(proto, 5, "abc");
+  Util::addProtoBytes(proto, 20, "");
+  EXPECT_EQ(std::string("\x2a\x03"
+                        "abc"
+                        "\xa2\x01\x00",
+                        8),
+            proto);
+
+  std::string bytes;
+  Util::appendBigEndian(bytes, 0x0102030405060708);
+  EXPECT_EQ(std::string("\x01\x02\x03\x04\x05\x06\x07\x08"), bytes);
+}
+
 } // namespace
 } // namespace Zipkin
 } // namespace Tracers
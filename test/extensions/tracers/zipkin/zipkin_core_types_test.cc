@@ -579,6 +579,86 @@ TEST(ZipkinCoreTypesSpanTest, setTag) {
   EXPECT_EQ("value2", bann.value());
 }
 
+TEST(ZipkinCoreTypesEndpointTest, toProto) {
+  Endpoint ep(std::string("svc"), Network::Utility::parseInternetAddressAndPort("1.2.3.4:80"));
+  EXPECT_EQ(std::string("\x0a\x03"
+                        "svc"
+                        "\x12\x04\x01\x02\x03\x04"
+                        "\x20\x50"),
+            ep.toProto());
+
+  ep.setAddress(Network::Utility::parseInternetAddressAndPort("[1::2]:80"));
+  EXPECT_EQ(std::string("\x0a\x03"
+                        "svc"
+                        "\x1a\x10\x00\x01\x00\x00\x00\x00\x00\x00"
+                        "\x00\x00\x00\x00\x00\x00\x00\x02"
+                        "\x20\x50",
+                        25),
+            ep.toProto());
+
+  EXPECT_EQ("", Endpoint().toProto());
+}
+
+// A server span which shares the context of its client span is converted to a v2 shared span
+// whose timing comes from its SR and SS annotations.
+TEST(ZipkinCoreTypesSpanTest, sharedServerSpanToProto) {
+  DangerousDeprecatedTestTime test_time;
+  Span span(test_time.timeSystem());
+  span.setTraceId(1);
+  span.setId(2);
+  span.setName("n");
+  Endpoint ep(std::string("svc"), Network::Utility::parseInternetAddressAndPort("1.2.3.4:80"));
+  span.addAnnotation(Annotation(10, ZipkinCoreConstants::get().SERVER_RECV, ep));
+  span.addAnnotation(Annotation(12, "event", ep));
+  span.addAnnotation(Annotation(15, ZipkinCoreConstants::get().SERVER_SEND, ep));
+  span.setTag("k", "v");
+
+  const std::string expected =
+      // trace_id and id.
+      std::string("\x0a\x08\x00\x00\x00\x00\x00\x00\x00\x01", 10) +
+      std::string("\x1a\x08\x00\x00\x00\x00\x00\x00\x00\x02", 10) +
+      // SERVER kind, name, timestamp and duration.
+      std::string("\x20\x02\x2a\x01"
+                  "n") +
+      std::string("\x31\x0a\x00\x00\x00\x00\x00\x00\x00\x38\x05", 11) +
+      // local_endpoint.
+      std::string("\x42\x0d") + ep.toProto() +
+      // The "event" annotation.
+      std::string("\x52\x10\x09\x0c\x00\x00\x00\x00\x00\x00\x00\x12\x05", 13) + "event" +
+      // The tag, and shared.
+      std::string("\x5a\x06\x0a\x01"
+                  "k"
+                  "\x12\x01"
+                  "v"
+                  "\x68\x01");
+  EXPECT_EQ(expected, span.toProto());
+}
+
+TEST(ZipkinCoreTypesSpanTest, clientSpanToProto) {
+  DangerousDeprecatedTestTime test_time;
+  Span span(test_time.timeSystem());
+  span.setTraceIdHigh(3);
+  span.setTraceId(1);
+  span.setId(2);
+  span.setParentId(4);
+  span.setTimestamp(10);
+  span.setDuration(300);
+  span.setDebug();
+  Endpoint ep;
+  span.addAnnotation(Annotation(10, ZipkinCoreConstants::get().CLIENT_SEND, ep));
+
+  const std::string expected =
+      std::string("\x0a\x10\x00\x00\x00\x00\x00\x00\x00\x03"
+                  "\x00\x00\x00\x00\x00\x00\x00\x01",
+                  18) +
+      std::string("\x12\x08\x00\x00\x00\x00\x00\x00\x00\x04", 10) +
+      std::string("\x1a\x08\x00\x00\x00\x00\x00\x00\x00\x02", 10) +
+      // CLIENT kind, timestamp and duration, an empty local_endpoint and debug.
+      std::string("\x20\x01") +
+      std::string("\x31\x0a\x00\x00\x00\x00\x00\x00\x00\x38\xac\x02\x42\x00\x60\x01", 16);
+  EXPECT_EQ(expected, span.toProto());
+}
+
 } // namespace
 } // namespace Zipkin
 } // namespace Tracers
@@ -4,6 +4,7 @@
 #include <string>
 #include <unordered_map>
 
+#include "common/decompressor/zlib_decompressor_impl.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
 #include "common/http/message_impl.h"
@@ -181,6 +182,55 @@ TEST_F(ZipkinDriverTest, FlushSeveralSpans) {
   EXPECT_EQ(1U, stats_.counter("tracing.zipkin.reports_failed").value());
 }
 
+TEST_F(ZipkinDriverTest, FlushProtoSpansCompressed) {
+  EXPECT_CALL(cm_, get("fake_cluster")).WillRepeatedly(Return(&cm_.thread_local_cluster_));
+  const std::string yaml_string = R"EOF(
+  collector_cluster: fake_cluster
+  collector_endpoint: /api/v2/spans
+  collector_endpoint_version: HTTP_PROTO
+  compress_spans: true
+  )EOF";
+  envoy::config::trace::v2::ZipkinConfig zipkin_config;
+  MessageUtil::loadFromYaml(yaml_string, zipkin_config);
+  setup(zipkin_config, true);
+
+  Http::MockAsyncClientRequest request(&cm_.async_client_);
+  std::string body;
+  EXPECT_CALL(cm_.async_client_, send_(_, _, _))
+      .WillOnce(
+          Invoke([&](Http::MessagePtr& message, Http::AsyncClient::Callbacks&,
+                     const Http::AsyncClient::RequestOptions&) -> Http::AsyncClient::Request* {
+            EXPECT_STREQ("/api/v2/spans", message->headers().Path()->value().c_str());
+            EXPECT_STREQ("application/x-protobuf",
+                         message->headers().ContentType()->value().c_str());
+            EXPECT_STREQ("gzip", message->headers().ContentEncoding()->value().c_str());
+
+            Decompressor::ZlibDecompressorImpl decompressor;
+            decompressor.init(31);
+            Buffer::OwnedImpl decompressed;
+            decompressor.decompress(*message->body(), decompressed);
+            body = decompressed.toString();
+            return &request;
+          }));
+  EXPECT_CALL(runtime_.snapshot_, getInteger("tracing.zipkin.min_flush_spans", 5))
+      .WillOnce(Return(1));
+
+  Tracing::SpanPtr span = driver_->startSpan(config_, request_headers_, operation_name_,
+                                             start_time_, {Tracing::Reason::Sampling, true});
+  span->setTag("k", "v");
+  span->finishSpan();
+
+  // The body is a ListOfSpans message with a single span, which carries the tag.
+  ASSERT_GT(body.size(), 2U);
+  EXPECT_EQ('\x0a', body[0]);
+  EXPECT_EQ(body.size() - 2, static_cast<uint8_t>(body[1]));
+  EXPECT_NE(std::string::npos, body.find(std::string("\x0a\x01"
+                                                     "k"
+                                                     "\x12\x01"
+                                                     "v")));
+  EXPECT_EQ(1U, stats_.counter("tracing.zipkin.spans_sent").value());
+}
+
 TEST_F(ZipkinDriverTest, FlushOneSpanReportFailure) {
   setupValidDriver();
 
@@ -25,14 +25,17 @@ public:
   Network::Connection& connection() override { return connection_; }
   bool shouldDrainReadBuffer() override { return false; }
   void setReadBufferReady() override { set_read_buffer_ready_ = true; }
+  void flushWriteBuffer() override { flush_write_buffer_ = true; }
   void raiseEvent(Network::ConnectionEvent) override { event_raised_ = true; }
 
   bool event_raised() const { return event_raised_; }
   bool set_read_buffer_ready() const { return set_read_buffer_ready_; }
+  bool flush_write_buffer() const { return flush_write_buffer_; }
 
 private:
   bool event_raised_{false};
   bool set_read_buffer_ready_{false};
+  bool flush_write_buffer_{false};
   Network::IoHandlePtr io_handle_;
   Network::Connection& connection_;
 };
@@ -54,6 +57,8 @@ TEST_F(NoOpTransportSocketCallbacksTest, TestAllCallbacks) {
 
   wrapped_callbacks_.setReadBufferReady();
   EXPECT_FALSE(wrapper_callbacks_.set_read_buffer_ready());
+  wrapped_callbacks_.flushWriteBuffer();
+  EXPECT_FALSE(wrapper_callbacks_.flush_write_buffer());
   wrapped_callbacks_.raiseEvent(Network::ConnectionEvent::Connected);
   EXPECT_FALSE(wrapper_callbacks_.event_raised());
 }
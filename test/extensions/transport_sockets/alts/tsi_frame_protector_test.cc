@@ -68,6 +68,34 @@ TEST_F(TsiFrameProtectorTest, Protect) {
   }
 }
 
+// Inputs made of several slices are protected and unprotected slice by slice.
+TEST_F(TsiFrameProtectorTest, ProtectUnprotectSlices) {
+  const std::string foo = "foo";
+  const std::string payload(20000, 'a');
+  Buffer::BufferFragmentImpl foo_fragment(foo.data(), foo.size(), nullptr);
+  Buffer::BufferFragmentImpl payload_fragment(payload.data(), payload.size(), nullptr);
+  Buffer::OwnedImpl input, encrypted, decrypted;
+  input.addBufferFragment(foo_fragment);
+  input.addBufferFragment(payload_fragment);
+  input.add("bar");
+
+  EXPECT_EQ(TSI_OK, frame_protector_.protect(input, encrypted));
+  EXPECT_EQ(0, input.length());
+  std::string expected = "\0\x40\0\0"s + "foo" + std::string(16377, 'a') + "\x2e\x0e\0\0"s +
+                         std::string(3623, 'a') + "bar";
+  EXPECT_EQ(expected, encrypted.toString());
+
+  // Split the frames across slices, in the middle of a frame header.
+  Buffer::OwnedImpl fragmented;
+  fragmented.move(encrypted, 16386);
+  const std::string rest = encrypted.toString();
+  Buffer::BufferFragmentImpl rest_fragment(rest.data(), rest.size(), nullptr);
+  fragmented.addBufferFragment(rest_fragment);
+  EXPECT_EQ(TSI_OK, frame_protector_.unprotect(fragmented, decrypted));
+  EXPECT_EQ(0, fragmented.length());
+  EXPECT_EQ("foo" + payload + "bar", decrypted.toString());
+}
+
 TEST_F(TsiFrameProtectorTest, ProtectError) {
   const tsi_frame_protector_vtable* vtable = raw_frame_protector_->vtable;
   tsi_frame_protector_vtable mock_vtable = *raw_frame_protector_->vtable;
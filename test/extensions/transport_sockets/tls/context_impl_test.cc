@@ -4,7 +4,9 @@
 #include "envoy/api/v2/auth/cert.pb.validate.h"
 
 #include "common/json/json_loader.h"
+#include "common/network/utility.h"
 #include "common/secret/sds_api.h"
+#include "common/ssl/tls_certificate_config_impl.h"
 #include "common/stats/isolated_store_impl.h"
 
 #include "extensions/transport_sockets/tls/context_config_impl.h"
@@ -17,6 +19,7 @@
 #include "test/extensions/transport_sockets/tls/test_data/san_dns3_cert_info.h"
 #include "test/mocks/secret/mocks.h"
 #include "test/mocks/server/mocks.h"
+#include "test/mocks/stats/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
@@ -27,6 +30,7 @@
 using Envoy::Protobuf::util::MessageDifferencer;
 using testing::EndsWith;
 using testing::NiceMock;
+using testing::Property;
 using testing::ReturnRef;
 
 namespace Envoy {
@@ -455,10 +459,107 @@ TEST_F(SslServerContextImplTicketTest, TicketKeyInlineStringFailTooSmall) {
   EXPECT_THROW(loadConfigV2(cfg), EnvoyException);
 }
 
-TEST_F(SslServerContextImplTicketTest, TicketKeySdsFail) {
+// Validate that session ticket keys can be loaded from a static secret.
+TEST_F(SslServerContextImplTicketTest, TicketKeyStaticSecret) {
+  envoy::api::v2::auth::Secret secret_config;
+  const std::string yaml = R"EOF(
+name: "ticket_keys"
+session_ticket_keys:
+  keys:
+    - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_a"
+)EOF";
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(yaml), secret_config);
+  factory_context_.secretManager().addStaticSecret(secret_config);
+
   envoy::api::v2::auth::DownstreamTlsContext cfg;
-  cfg.mutable_session_ticket_keys_sds_secret_config();
-  EXPECT_THROW_WITH_MESSAGE(loadConfigV2(cfg), EnvoyException, "SDS not supported yet");
+  cfg.mutable_session_ticket_keys_sds_secret_config()->set_name("ticket_keys");
+  EXPECT_NO_THROW(loadConfigV2(cfg));
+
+  cfg.mutable_session_ticket_keys_sds_secret_config()->set_name("undefined");
+  EXPECT_THROW_WITH_MESSAGE(loadConfigV2(cfg), EnvoyException,
+                            "Unknown static TLS session ticket keys: undefined");
+}
+
+// Validate that session ticket keys are rotated by SDS updates, and that updates with invalid keys
+// are rejected.
+TEST_F(SslServerContextImplTicketTest, TicketKeySdsRotation) {
+  NiceMock<LocalInfo::MockLocalInfo> local_info;
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<Runtime::MockRandomGenerator> random;
+  Stats::IsolatedStoreImpl stats;
+  NiceMock<Upstream::MockClusterManager> cluster_manager;
+  NiceMock<Init::MockManager> init_manager;
+  EXPECT_CALL(factory_context_, localInfo()).WillOnce(ReturnRef(local_info));
+  EXPECT_CALL(factory_context_, dispatcher()).WillOnce(ReturnRef(dispatcher));
+  EXPECT_CALL(factory_context_, random()).WillOnce(ReturnRef(random));
+  EXPECT_CALL(factory_context_, stats()).WillOnce(ReturnRef(stats));
+  EXPECT_CALL(factory_context_, clusterManager()).WillOnce(ReturnRef(cluster_manager));
+  EXPECT_CALL(factory_context_, initManager()).WillRepeatedly(Return(&init_manager));
+
+  envoy::api::v2::auth::DownstreamTlsContext cfg;
+  envoy::api::v2::auth::TlsCertificate* server_cert =
+      cfg.mutable_common_tls_context()->add_tls_certificates();
+  server_cert->mutable_certificate_chain()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestcert.pem"));
+  server_cert->mutable_private_key()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestkey.pem"));
+  auto* sds_secret_config = cfg.mutable_session_ticket_keys_sds_secret_config();
+  sds_secret_config->set_name("ticket_keys");
+  sds_secret_config->mutable_sds_config();
+  ServerContextConfigImpl server_context_config(cfg, factory_context_);
+  // When the keys are not downloaded, the config is not ready.
+  EXPECT_FALSE(server_context_config.isReady());
+  EXPECT_TRUE(server_context_config.sessionTicketKeys().empty());
+  NiceMock<Secret::MockSecretCallbacks> secret_callback;
+  server_context_config.setSecretUpdateCallback(
+      [&secret_callback]() { secret_callback.onAddOrUpdateSecret(); });
+
+  // The config shares the provider of the secret with every other filter chain that refers to it.
+  auto* sds_api = dynamic_cast<Secret::TlsSessionTicketKeysSdsApi*>(
+      factory_context_.secretManager()
+          .findOrCreateTlsSessionTicketKeysProvider(sds_secret_config->sds_config(),
+                                                    "ticket_keys", factory_context_)
+          .get());
+  ASSERT_NE(nullptr, sds_api);
+  const auto update = [sds_api](const std::string& yaml) {
+    Protobuf::RepeatedPtrField<envoy::api::v2::auth::Secret> secret_resources;
+    MessageUtil::loadFromYaml(TestEnvironment::substitute(yaml), *secret_resources.Add());
+    sds_api->onConfigUpdate(secret_resources, "");
+  };
+
+  EXPECT_CALL(secret_callback, onAddOrUpdateSecret());
+  update(R"EOF(
+name: "ticket_keys"
+session_ticket_keys:
+  keys:
+    - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_a"
+)EOF");
+  EXPECT_TRUE(server_context_config.isReady());
+  EXPECT_EQ(1UL, server_context_config.sessionTicketKeys().size());
+  EXPECT_NO_THROW(loadConfig(server_context_config));
+
+  // Rotate to a new encryption key, and keep the previous one for decryption.
+  EXPECT_CALL(secret_callback, onAddOrUpdateSecret());
+  update(R"EOF(
+name: "ticket_keys"
+session_ticket_keys:
+  keys:
+    - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_b"
+    - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_a"
+)EOF");
+  ASSERT_EQ(2UL, server_context_config.sessionTicketKeys().size());
+  const auto rotated_name = server_context_config.sessionTicketKeys()[0].name_;
+
+  EXPECT_CALL(secret_callback, onAddOrUpdateSecret()).Times(0);
+  EXPECT_THROW(update(R"EOF(
+name: "ticket_keys"
+session_ticket_keys:
+  keys:
+    - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_wrong_len"
+)EOF"),
+               EnvoyException);
+  ASSERT_EQ(2UL, server_context_config.sessionTicketKeys().size());
+  EXPECT_EQ(rotated_name, server_context_config.sessionTicketKeys()[0].name_);
 }
 
 TEST_F(SslServerContextImplTicketTest, CRLSuccess) {
@@ -1027,6 +1128,49 @@ TEST_F(ClientContextConfigImplTest, MissingStaticCertificateValidationContext) {
       "Unknown static certificate validation context: missing");
 }
 
+// Validate that session keys are stored per SNI and upstream host address, and that the session
+// keys of the least recently used hosts are evicted first.
+TEST_F(ClientContextConfigImplTest, SessionKeysPerUpstreamHost) {
+  envoy::api::v2::auth::UpstreamTlsContext tls_context;
+  tls_context.set_sni("a.example.com");
+  tls_context.mutable_max_session_keys()->set_value(2);
+  ClientContextConfigImpl client_context_config(tls_context, factory_context_);
+  Event::SimulatedTimeSystem time_system;
+  ContextManagerImpl manager(time_system);
+  Stats::IsolatedStoreImpl store;
+  auto context = std::dynamic_pointer_cast<ClientContextImpl>(
+      manager.createSslClientContext(store, client_context_config));
+  const Network::Address::InstanceConstSharedPtr host1 =
+      Network::Utility::parseInternetAddressAndPort("10.0.0.1:443");
+  const Network::Address::InstanceConstSharedPtr host2 =
+      Network::Utility::parseInternetAddressAndPort("10.0.0.2:443");
+
+  // Sets up a connection like SslSocket does and checks the session it resumes, then stores a new
+  // session key like BoringSSL does after the handshake.
+  const auto connect = [&context](const Network::Address::InstanceConstSharedPtr& host,
+                                  const std::string& sni, const SSL_SESSION* expected_session) {
+    bssl::UniquePtr<SSL> ssl = context->newSsl(sni);
+    context->resumeSession(ssl.get(), host);
+    EXPECT_EQ(expected_session, SSL_get_session(ssl.get()));
+    SSL_CTX* ssl_ctx = SSL_get_SSL_CTX(ssl.get());
+    bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_new(ssl_ctx));
+    SSL_SESSION_up_ref(session.get());
+    EXPECT_EQ(1, SSL_CTX_sess_get_new_cb(ssl_ctx)(ssl.get(), session.get()));
+    return session;
+  };
+
+  bssl::UniquePtr<SSL_SESSION> session1 = connect(host1, "a.example.com", nullptr);
+  connect(host2, "a.example.com", nullptr);
+  // Resuming makes host1 the most recently used, so that host2 is evicted.
+  session1 = connect(host1, "a.example.com", session1.get());
+  bssl::UniquePtr<SSL_SESSION> session2 = connect(host2, "a.example.com", nullptr);
+  connect(host1, "b.example.com", nullptr);
+  connect(host2, "a.example.com", session2.get());
+
+  EXPECT_EQ(2UL, store.counter("ssl.session_cache_hit").value());
+  EXPECT_EQ(4UL, store.counter("ssl.session_cache_miss").value());
+}
+
 class ServerContextConfigImplTest : public SslCertsTest {};
 
 // Multiple TLS certificates are supported.
@@ -1164,6 +1308,37 @@ TEST_F(ServerContextConfigImplTest, TlsCertificateNonEmpty) {
       EnvoyException, "Server TlsCertificates must have a certificate specified");
 }
 
+// TlsCertificate messages can't have both a private key and a private key provider.
+TEST_F(ServerContextConfigImplTest, PrivateKeyAndPrivateKeyProvider) {
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  envoy::api::v2::auth::TlsCertificate* server_cert =
+      tls_context.mutable_common_tls_context()->add_tls_certificates();
+  server_cert->mutable_certificate_chain()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestcert.pem"));
+  server_cert->mutable_private_key()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestkey.pem"));
+  server_cert->mutable_private_key_provider()->set_provider_name("mock_provider");
+  EXPECT_THROW_WITH_MESSAGE(
+      ServerContextConfigImpl server_context_config(tls_context, factory_context_), EnvoyException,
+      "Certificate configuration can't have both private_key and private_key_provider");
+}
+
+// Private key providers must be registered.
+TEST_F(ServerContextConfigImplTest, UnknownPrivateKeyProvider) {
+  Event::SimulatedTimeSystem time_system;
+  ContextManagerImpl manager(time_system);
+  ON_CALL(factory_context_, sslContextManager()).WillByDefault(ReturnRef(manager));
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  envoy::api::v2::auth::TlsCertificate* server_cert =
+      tls_context.mutable_common_tls_context()->add_tls_certificates();
+  server_cert->mutable_certificate_chain()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestcert.pem"));
+  server_cert->mutable_private_key_provider()->set_provider_name("unknown_provider");
+  EXPECT_THROW_WITH_MESSAGE(
+      ServerContextConfigImpl server_context_config(tls_context, factory_context_), EnvoyException,
+      "Failed to load private key provider: unknown_provider");
+}
+
 // Cannot ignore certificate expiration without a trusted CA.
 TEST_F(ServerContextConfigImplTest, InvalidIgnoreCertsNoCA) {
   envoy::api::v2::auth::DownstreamTlsContext tls_context;
@@ -1201,6 +1376,171 @@ TEST_F(ServerContextConfigImplTest, InvalidIgnoreCertsNoCA) {
   EXPECT_NO_THROW(ServerContextConfigImpl server_context_config(tls_context, factory_context_));
 }
 
+// Client contexts with identical configs are shared while one of them is alive, and report their
+// stats in the context manager's scope.
+TEST_F(SslContextImplTest, SharedClientContexts) {
+  const std::string yaml = R"EOF(
+  common_tls_context:
+    validation_context:
+      trusted_ca:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ca_cert.pem"
+  sni: server1.example.com
+  )EOF";
+  envoy::api::v2::auth::UpstreamTlsContext tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(yaml), tls_context);
+  ClientContextConfigImpl config(tls_context, factory_context_);
+  ClientContextConfigImpl same_config(tls_context, factory_context_);
+  tls_context.set_sni("server2.example.com");
+  ClientContextConfigImpl other_config(tls_context, factory_context_);
+  EXPECT_EQ(ContextManagerImpl::clientContextDigest(config),
+            ContextManagerImpl::clientContextDigest(same_config));
+  EXPECT_NE(ContextManagerImpl::clientContextDigest(config),
+            ContextManagerImpl::clientContextDigest(other_config));
+
+  Stats::IsolatedStoreImpl cluster_store;
+  ContextManagerImpl manager(time_system_, store_, true);
+  Envoy::Ssl::ClientContextSharedPtr first(manager.createSslClientContext(cluster_store, config));
+  Envoy::Ssl::ClientContextSharedPtr second(
+      manager.createSslClientContext(cluster_store, same_config));
+  Envoy::Ssl::ClientContextSharedPtr other(
+      manager.createSslClientContext(cluster_store, other_config));
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, other);
+  EXPECT_EQ(3, store_.counter("ssl_context_manager.client_context_requested").value());
+  EXPECT_EQ(2, store_.counter("ssl_context_manager.client_context_created").value());
+  EXPECT_EQ(nullptr, TestUtility::findCounter(cluster_store, "ssl.handshake"));
+  EXPECT_NE(nullptr,
+            TestUtility::findCounter(store_, "ssl_context_manager.upstream.ssl.handshake"));
+
+  first.reset();
+  second.reset();
+  first = manager.createSslClientContext(cluster_store, config);
+  EXPECT_EQ(3, store_.counter("ssl_context_manager.client_context_created").value());
+}
+
+// Contexts with the same certificates parse them once and share them while one of them is alive.
+TEST_F(SslContextImplTest, SharedCertificates) {
+  const std::string yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns3_chain.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns3_key.pem"
+    validation_context:
+      trusted_ca:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ca_cert.pem"
+  )EOF";
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(yaml), tls_context);
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+
+  Envoy::Ssl::ServerContextSharedPtr first(
+      manager_.createSslServerContext(store_, server_context_config, {}));
+  EXPECT_EQ(3, manager_.certificateCache().size());
+  Envoy::Ssl::ServerContextSharedPtr second(
+      manager_.createSslServerContext(store_, server_context_config, {"server1.example.com"}));
+  EXPECT_EQ(3, manager_.certificateCache().size());
+  EXPECT_EQ(first->getCertChainInformation()[0]->serial_number(),
+            second->getCertChainInformation()[0]->serial_number());
+
+  first.reset();
+  EXPECT_EQ(3, manager_.certificateCache().size());
+  second.reset();
+  EXPECT_EQ(0, manager_.certificateCache().size());
+}
+
+// Prefetched certificates stay cached until the prefetch is released, and certificates that can't
+// be parsed are skipped.
+TEST_F(SslContextImplTest, PrefetchCertificates) {
+  envoy::api::v2::auth::TlsCertificate tls_certificate;
+  tls_certificate.mutable_certificate_chain()->set_filename(TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"));
+  tls_certificate.mutable_private_key()->set_filename(TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_key.pem"));
+  Ssl::TlsCertificateConfigImpl valid(tls_certificate, *api_);
+  tls_certificate.mutable_certificate_chain()->set_inline_string("not a certificate");
+  tls_certificate.mutable_private_key()->set_inline_string("not a key");
+  Ssl::TlsCertificateConfigImpl invalid(tls_certificate, *api_);
+
+  Envoy::Ssl::CertificatePrefetchPtr prefetch = manager_.prefetchCertificates(
+      {&valid, &valid, &invalid}, api_->threadFactory(), 4);
+  EXPECT_EQ(2, manager_.certificateCache().size());
+  EXPECT_NE(nullptr, manager_.certificateCache().certificateChain(valid.certificateChain()));
+  EXPECT_EQ(nullptr, manager_.certificateCache().certificateChain(invalid.certificateChain()));
+  prefetch.reset();
+  EXPECT_EQ(0, manager_.certificateCache().size());
+}
+
+// Large batches are parsed on several threads.
+TEST_F(SslContextImplTest, PrefetchCertificatesOnThreads) {
+  const std::vector<std::string> names = {"san_dns",          "san_dns2",     "san_dns3",
+                                          "san_uri",          "no_san",       "selfsigned",
+                                          "san_multiple_dns", "san_only_dns", "expired"};
+  std::vector<std::unique_ptr<Ssl::TlsCertificateConfigImpl>> configs;
+  std::vector<const Envoy::Ssl::TlsCertificateConfig*> tls_certificates;
+  for (const std::string& name : names) {
+    envoy::api::v2::auth::TlsCertificate tls_certificate;
+    tls_certificate.mutable_certificate_chain()->set_filename(TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/" + name +
+        "_cert.pem"));
+    tls_certificate.mutable_private_key()->set_filename(TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/" + name + "_key.pem"));
+    configs.push_back(
+        std::make_unique<Ssl::TlsCertificateConfigImpl>(tls_certificate, nullptr, *api_));
+    tls_certificates.push_back(configs.back().get());
+  }
+  // Keys with wrong passwords are distinct entries that fail to parse.
+  for (uint32_t i = 0; i < 2 * CertificateCache::MinEntriesPerPrefetchThread; i++) {
+    envoy::api::v2::auth::TlsCertificate tls_certificate;
+    tls_certificate.mutable_certificate_chain()->set_filename(TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"));
+    tls_certificate.mutable_private_key()->set_filename(TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/"
+        "password_protected_key.pem"));
+    tls_certificate.mutable_password()->set_inline_string(fmt::format("password {}", i));
+    configs.push_back(
+        std::make_unique<Ssl::TlsCertificateConfigImpl>(tls_certificate, nullptr, *api_));
+    tls_certificates.push_back(configs.back().get());
+  }
+
+  Envoy::Ssl::CertificatePrefetchPtr prefetch =
+      manager_.prefetchCertificates(tls_certificates, api_->threadFactory(), 2);
+  EXPECT_EQ(2 * names.size(), manager_.certificateCache().size());
+}
+
+// Handshake times are recorded per handshake type and key type of the server certificate, along
+// with the stat prefix of the context.
+TEST_F(SslContextImplTest, HandshakeTimes) {
+  const std::string yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns3_chain.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns3_key.pem"
+  stat_prefix: tenant
+  )EOF";
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(yaml), tls_context);
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+  EXPECT_EQ("tenant", server_context_config.statPrefix());
+
+  NiceMock<Stats::MockStore> store;
+  Envoy::Ssl::ServerContextSharedPtr server_context(
+      manager_.createSslServerContext(store, server_context_config, {}));
+  auto* context = dynamic_cast<ContextImpl*>(server_context.get());
+  bssl::UniquePtr<SSL> ssl = context->newSsl(absl::nullopt);
+
+  EXPECT_CALL(store, deliverHistogramToSinks(
+                         Property(&Stats::Metric::name, "ssl.handshake_time_us.full.rsa"), 2000));
+  EXPECT_CALL(store, deliverHistogramToSinks(Property(&Stats::Metric::name,
+                                                      "ssl.handshake_processing_time_us.full.rsa"),
+                                             500));
+  context->logHandshake(ssl.get(), std::chrono::microseconds(2000),
+                        std::chrono::microseconds(500));
+}
+
 } // namespace Tls
 } // namespace TransportSockets
 } // namespace Extensions
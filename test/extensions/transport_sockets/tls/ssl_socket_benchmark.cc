@@ -0,0 +1,175 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/network/io_socket_handle_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/transport_sockets/tls/context_config_impl.h"
+#include "extensions/transport_sockets/tls/context_manager_impl.h"
+#include "extensions/transport_sockets/tls/ssl_socket.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+#include "openssl/pem.h"
+#include "openssl/ssl.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+namespace {
+
+// Bytes written by the SSL socket per benchmark iteration.
+constexpr uint64_t WriteSize = 1024 * 1024;
+
+std::string pemContents(BIO* bio) {
+  const uint8_t* contents;
+  size_t length;
+  RELEASE_ASSERT(BIO_mem_contents(bio, &contents, &length), "");
+  return std::string(reinterpret_cast<const char*>(contents), length);
+}
+
+// Generates a self-signed ECDSA certificate and its key as PEM, so that the benchmark doesn't
+// depend on the test data.
+void generateCertificate(std::string& certificate_chain, std::string& private_key) {
+  bssl::UniquePtr<EC_KEY> ec_key(EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+  RELEASE_ASSERT(ec_key != nullptr && EC_KEY_generate_key(ec_key.get()), "");
+  bssl::UniquePtr<EVP_PKEY> pkey(EVP_PKEY_new());
+  RELEASE_ASSERT(EVP_PKEY_assign_EC_KEY(pkey.get(), ec_key.release()), "");
+
+  bssl::UniquePtr<X509> cert(X509_new());
+  X509_set_version(cert.get(), 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+  X509_gmtime_adj(X509_get_notBefore(cert.get()), 0);
+  X509_gmtime_adj(X509_get_notAfter(cert.get()), 24 * 60 * 60);
+  X509_NAME* name = X509_get_subject_name(cert.get());
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                             reinterpret_cast<const uint8_t*>("benchmark"), -1, -1, 0);
+  X509_set_issuer_name(cert.get(), name);
+  X509_set_pubkey(cert.get(), pkey.get());
+  RELEASE_ASSERT(X509_sign(cert.get(), pkey.get(), EVP_sha256()), "");
+
+  bssl::UniquePtr<BIO> bio(BIO_new(BIO_s_mem()));
+  RELEASE_ASSERT(PEM_write_bio_X509(bio.get(), cert.get()), "");
+  certificate_chain = pemContents(bio.get());
+  bio.reset(BIO_new(BIO_s_mem()));
+  RELEASE_ASSERT(
+      PEM_write_bio_PrivateKey(bio.get(), pkey.get(), nullptr, nullptr, 0, nullptr, nullptr), "");
+  private_key = pemContents(bio.get());
+}
+
+} // namespace
+
+// Measures SslSocket::doWrite() throughput for buffers made of slices of state.range(0) bytes,
+// written to a client SslSocket over a socket pair.
+static void BM_SslSocketWrite(benchmark::State& state) {
+  Event::SimulatedTimeSystem time_system;
+  Stats::IsolatedStoreImpl stats_store;
+  Api::ApiPtr api = Api::createApiForTest(stats_store, time_system);
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context;
+  ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
+  ContextManagerImpl manager(*time_system);
+
+  std::string certificate_chain;
+  std::string private_key;
+  generateCertificate(certificate_chain, private_key);
+  envoy::api::v2::auth::DownstreamTlsContext server_tls_context;
+  auto* tls_certificate = server_tls_context.mutable_common_tls_context()->add_tls_certificates();
+  tls_certificate->mutable_certificate_chain()->set_inline_string(certificate_chain);
+  tls_certificate->mutable_private_key()->set_inline_string(private_key);
+  ServerSslSocketFactory server_factory(
+      std::make_unique<ServerContextConfigImpl>(server_tls_context, factory_context), manager,
+      stats_store, std::vector<std::string>{});
+  ClientSslSocketFactory client_factory(
+      std::make_unique<ClientContextConfigImpl>(envoy::api::v2::auth::UpstreamTlsContext(),
+                                                factory_context),
+      manager, stats_store);
+
+  int fds[2];
+  RELEASE_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "");
+  for (int fd : fds) {
+    RELEASE_ASSERT(fcntl(fd, F_SETFL, O_NONBLOCK) == 0, "");
+  }
+  Network::IoSocketHandleImpl server_io_handle(fds[0]);
+  Network::IoSocketHandleImpl client_io_handle(fds[1]);
+  NiceMock<Network::MockTransportSocketCallbacks> server_callbacks;
+  NiceMock<Network::MockTransportSocketCallbacks> client_callbacks;
+  ON_CALL(server_callbacks, ioHandle()).WillByDefault(ReturnRef(server_io_handle));
+  ON_CALL(client_callbacks, ioHandle()).WillByDefault(ReturnRef(client_io_handle));
+  uint32_t connected = 0;
+  for (auto* callbacks : {&server_callbacks, &client_callbacks}) {
+    ON_CALL(*callbacks, raiseEvent(Network::ConnectionEvent::Connected))
+        .WillByDefault(Invoke([&connected](Network::ConnectionEvent) -> void { connected++; }));
+  }
+  Network::TransportSocketPtr server_socket = server_factory.createTransportSocket(nullptr);
+  Network::TransportSocketPtr client_socket = client_factory.createTransportSocket(nullptr);
+  server_socket->setTransportSocketCallbacks(server_callbacks);
+  client_socket->setTransportSocketCallbacks(client_callbacks);
+
+  Buffer::OwnedImpl empty_buffer;
+  for (uint32_t i = 0; connected < 2; i++) {
+    RELEASE_ASSERT(i < 100, "handshake did not complete");
+    client_socket->doWrite(empty_buffer, false);
+    server_socket->doWrite(empty_buffer, false);
+  }
+
+  const uint64_t slice_size = state.range(0);
+  const std::string data(WriteSize, 'a');
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<Buffer::BufferFragmentImpl>> fragments;
+    Buffer::OwnedImpl write_buffer;
+    for (uint64_t offset = 0; offset < WriteSize; offset += slice_size) {
+      fragments.push_back(std::make_unique<Buffer::BufferFragmentImpl>(
+          data.data() + offset, std::min(slice_size, WriteSize - offset), nullptr));
+      write_buffer.addBufferFragment(*fragments.back());
+    }
+
+    uint64_t bytes_read = 0;
+    Buffer::OwnedImpl read_buffer;
+    while (bytes_read < WriteSize) {
+      Network::IoResult result = server_socket->doWrite(write_buffer, false);
+      RELEASE_ASSERT(result.action_ == Network::PostIoAction::KeepOpen, "");
+      result = client_socket->doRead(read_buffer);
+      RELEASE_ASSERT(result.action_ == Network::PostIoAction::KeepOpen, "");
+      bytes_read += read_buffer.length();
+      read_buffer.drain(read_buffer.length());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * WriteSize);
+}
+
+BENCHMARK(BM_SslSocketWrite)->Arg(64)->Arg(1024)->Arg(4096)->Arg(16384)->Arg(65536);
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_context(spdlog::level::warn,
+                                         Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,292 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures the cost of a full request through a running server, i.e. the connection manager, the
+// filter chain, the router and the upstream connection pool, by driving headers only requests at a
+// fixed concurrency through the integration test harness to an AutonomousUpstream. Run with
+//   bazel run -c opt //test/integration:proxy_speed_test
+//
+// The client, the server and the upstream share the process, so the CPU time and the allocations
+// per request include the client and the upstream. They are meant to compare builds with each
+// other, not to size a deployment.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/http/codec.h"
+
+#include "common/common/assert.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/event/libevent.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/codec_impl.h"
+#include "common/http/utility.h"
+
+#include "test/integration/http_integration.h"
+#include "test/integration/ssl_utility.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+#ifdef TCMALLOC
+#include "gperftools/malloc_hook.h"
+#endif
+
+namespace Envoy {
+namespace {
+
+// The number of requests of a benchmark iteration.
+constexpr uint64_t RequestsPerIteration = 10000;
+
+#ifdef TCMALLOC
+std::atomic<uint64_t> allocations{0};
+
+void onAllocation(const void*, size_t) { allocations.fetch_add(1, std::memory_order_relaxed); }
+#endif
+
+} // namespace
+
+class ProxySpeedTest : public HttpIntegrationTest {
+public:
+  ProxySpeedTest(Http::CodecClient::Type downstream_protocol, bool tls, uint32_t concurrency)
+      : HttpIntegrationTest(downstream_protocol, TestEnvironment::getIpVersionsForTest()[0]),
+        tls_(tls), concurrency_(concurrency) {}
+
+  ~ProxySpeedTest() {
+    requesters_.clear();
+    for (auto& client : clients_) {
+      client->close();
+    }
+    clients_.clear();
+  }
+
+  void initialize() override {
+    autonomous_upstream_ = true;
+    if (downstream_protocol_ == Http::CodecClient::Type::HTTP2) {
+      setUpstreamProtocol(FakeHttpConnection::Type::HTTP2);
+    }
+    if (tls_) {
+      config_helper_.addSslConfig();
+    }
+    HttpIntegrationTest::initialize();
+
+    if (tls_) {
+      client_tls_factory_ = Ssl::createClientSslTransportSocketFactory(
+          Ssl::ClientSslTransportOptions().setAlpn(
+              downstream_protocol_ == Http::CodecClient::Type::HTTP2),
+          context_manager_, *api_);
+    }
+    // HTTP/1 requests are outstanding on a connection of their own, while HTTP/2 requests are
+    // multiplexed on a single connection.
+    const uint32_t connections =
+        downstream_protocol_ == Http::CodecClient::Type::HTTP2 ? 1 : concurrency_;
+    for (uint32_t i = 0; i < connections; i++) {
+      clients_.emplace_back(makeClient());
+    }
+    for (uint32_t i = 0; i < concurrency_; i++) {
+      requesters_.emplace_back(std::make_unique<Requester>(*this, *clients_[i % connections]));
+    }
+  }
+
+  /**
+   * Complete a number of requests, keeping concurrency requests outstanding at all times.
+   * @param requests supplies the number of requests to complete.
+   */
+  void run(uint64_t requests) {
+    ASSERT(requests >= concurrency_);
+    to_start_ = requests;
+    to_complete_ = requests;
+    for (auto& requester : requesters_) {
+      to_start_--;
+      requester->start();
+    }
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  std::vector<uint64_t>& latenciesUs() { return latencies_us_; }
+
+private:
+  // Sends a request at a time, and the next one once the response is complete.
+  class Requester : public Http::StreamDecoder, public Http::StreamCallbacks {
+  public:
+    Requester(ProxySpeedTest& parent, IntegrationCodecClient& client)
+        : parent_(parent), client_(client) {}
+
+    void start() {
+      start_time_ = std::chrono::steady_clock::now();
+      Http::StreamEncoder& encoder = client_.newStream(*this);
+      encoder.getStream().addCallbacks(*this);
+      encoder.encodeHeaders(parent_.request_headers_, true);
+    }
+
+    // Http::StreamDecoder
+    void decode100ContinueHeaders(Http::HeaderMapPtr&&) override {}
+    void decodeHeaders(Http::HeaderMapPtr&& headers, bool end_stream) override {
+      RELEASE_ASSERT(Http::Utility::getResponseStatus(*headers) == 200, "");
+      if (end_stream) {
+        onComplete();
+      }
+    }
+    void decodeData(Buffer::Instance&, bool end_stream) override {
+      if (end_stream) {
+        onComplete();
+      }
+    }
+    void decodeTrailers(Http::HeaderMapPtr&&) override { onComplete(); }
+    void decodeMetadata(Http::MetadataMapPtr&&) override {}
+
+    // Http::StreamCallbacks
+    void onResetStream(Http::StreamResetReason, absl::string_view) override {
+      RELEASE_ASSERT(false, "unexpected reset of a benchmark request");
+    }
+    void onAboveWriteBufferHighWatermark() override {}
+    void onBelowWriteBufferLowWatermark() override {}
+
+  private:
+    void onComplete() {
+      parent_.latencies_us_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                                          std::chrono::steady_clock::now() - start_time_)
+                                          .count());
+      if (--parent_.to_complete_ == 0) {
+        parent_.dispatcher_->exit();
+      } else if (parent_.to_start_ > 0) {
+        parent_.to_start_--;
+        // The stream of the response is only done with once the decoding callbacks return, e.g.
+        // the HTTP/1 codec client accepts the next request of the connection after that.
+        parent_.dispatcher_->post([this]() -> void { start(); });
+      }
+    }
+
+    ProxySpeedTest& parent_;
+    IntegrationCodecClient& client_;
+    std::chrono::steady_clock::time_point start_time_;
+  };
+
+  IntegrationCodecClientPtr makeClient() {
+    if (!tls_) {
+      return makeHttpConnection(lookupPort("http"));
+    }
+    return makeHttpConnection(dispatcher_->createClientConnection(
+        Ssl::getSslAddress(version_, lookupPort("http")),
+        Network::Address::InstanceConstSharedPtr(), client_tls_factory_->createTransportSocket({}),
+        nullptr));
+  }
+
+  const bool tls_;
+  const uint32_t concurrency_;
+  const Http::TestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":path", "/"}, {":scheme", "http"}, {":authority", "host"}};
+  Network::TransportSocketFactoryPtr client_tls_factory_;
+  std::vector<IntegrationCodecClientPtr> clients_;
+  std::vector<std::unique_ptr<Requester>> requesters_;
+  uint64_t to_start_{};
+  uint64_t to_complete_{};
+  std::vector<uint64_t> latencies_us_;
+};
+
+} // namespace Envoy
+
+// Proxy headers only requests to an upstream that replies with a 10 byte body. The Args are
+// whether the downstream and upstream connections use HTTP/2, whether the downstream connections
+// use TLS and the number of outstanding requests.
+static void BM_ProxyRequests(benchmark::State& state) {
+  Envoy::ProxySpeedTest test(state.range(0) != 0 ? Envoy::Http::CodecClient::Type::HTTP2
+                                                 : Envoy::Http::CodecClient::Type::HTTP1,
+                             state.range(1) != 0, state.range(2));
+  test.initialize();
+  // Warm up the connection pools, the route and the allocator caches.
+  test.run(std::max<uint64_t>(state.range(2) * 16, 1000));
+  test.latenciesUs().clear();
+
+  uint64_t requests = 0;
+#ifdef TCMALLOC
+  const uint64_t allocations_start = Envoy::allocations.load();
+#endif
+  const std::clock_t cpu_start = std::clock();
+  const auto wall_start = std::chrono::steady_clock::now();
+  for (auto _ : state) {
+    test.run(Envoy::RequestsPerIteration);
+    requests += Envoy::RequestsPerIteration;
+  }
+  const double wall_s = std::chrono::duration_cast<std::chrono::duration<double>>(
+                            std::chrono::steady_clock::now() - wall_start)
+                            .count();
+  const double cpu_us = 1e6 * (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+  std::vector<uint64_t>& latencies = test.latenciesUs();
+  std::sort(latencies.begin(), latencies.end());
+  const auto percentile = [&latencies](double p) -> double {
+    return latencies[std::min<size_t>(latencies.size() * p, latencies.size() - 1)];
+  };
+  state.counters["rps"] = requests / wall_s;
+  // std::clock() is the CPU time of all the threads of the process.
+  state.counters["cpu_us_per_rq"] = cpu_us / requests;
+#ifdef TCMALLOC
+  // Allocations are only counted with tcmalloc.
+  state.counters["allocs_per_rq"] =
+      static_cast<double>(Envoy::allocations.load() - allocations_start) / requests;
+#endif
+  state.counters["p50_us"] = percentile(0.5);
+  state.counters["p90_us"] = percentile(0.9);
+  state.counters["p99_us"] = percentile(0.99);
+  state.counters["p999_us"] = percentile(0.999);
+}
+BENCHMARK(BM_ProxyRequests)
+    ->ArgNames({"http2", "tls", "concurrency"})
+    ->Args({0, 0, 1})
+    ->Args({0, 0, 16})
+    ->Args({0, 1, 16})
+    ->Args({1, 0, 1})
+    ->Args({1, 0, 16})
+    ->Args({1, 1, 16})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Sets up the process the way the test runner does for the integration tests, then discovers
+// the benchmarks in the same file and runs them. The arguments that are not benchmark flags are
+// parsed as the options of the server, e.g. "-l debug".
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  Envoy::Thread::ThreadFactorySingleton::set(&Envoy::Thread::threadFactoryForTest());
+  // bazel test provides the runfiles tree in TEST_SRCDIR, while bazel run starts the binary in it.
+  if (std::getenv("TEST_SRCDIR") != nullptr) {
+    Envoy::TestEnvironment::setEnvVar(
+        "TEST_RUNDIR",
+        Envoy::TestEnvironment::getCheckedEnvVar("TEST_SRCDIR") + "/" +
+            Envoy::TestEnvironment::getCheckedEnvVar("TEST_WORKSPACE"),
+        1);
+  } else {
+    char cwd[PATH_MAX];
+    RELEASE_ASSERT(getcwd(cwd, sizeof(cwd)) != nullptr, "");
+    Envoy::TestEnvironment::setEnvVar("TEST_RUNDIR", cwd, 1);
+  }
+  Envoy::TestEnvironment::setEnvVar("TEST_UDSDIR",
+                                    Envoy::TestEnvironment::unixDomainSocketDirectory(), 1);
+  Envoy::Event::Libevent::Global::initialize();
+  Envoy::Http::Http2::initializeNghttp2Logging();
+
+  Envoy::TestEnvironment::initializeOptions(argc, argv);
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_state(Envoy::TestEnvironment::getOptions().logLevel(),
+                                       Envoy::TestEnvironment::getOptions().logFormat(), lock);
+
+#ifdef TCMALLOC
+  RELEASE_ASSERT(MallocHook::AddNewHook(&Envoy::onAllocation), "");
+#endif
+  benchmark::RunSpecifiedBenchmarks();
+#ifdef TCMALLOC
+  MallocHook::RemoveNewHook(&Envoy::onAllocation);
+#endif
+}
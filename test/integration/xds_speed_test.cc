@@ -0,0 +1,453 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures how long a running server takes to apply large CDS, EDS, RDS and LDS configurations,
+// both the initial load of all the resources and the update of a single one, and how long the
+// workers then take to process what the main thread posted to them. Run with
+//   bazel run -c opt //test/integration:xds_speed_test
+//
+// The updates are delivered through filesystem subscriptions as binary DiscoveryResponses, so
+// that they are parsed about as fast as the ones of a gRPC subscription. As with the v2 xDS
+// protocol, a single resource update of CDS, RDS and LDS delivers all the resources.
+//
+// The peak RSS is the one of the process so far, so it is only meaningful for the largest
+// configuration of a benchmark, or when the benchmarks are run one at a time with
+// --benchmark_filter.
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "envoy/api/v2/cds.pb.h"
+#include "envoy/api/v2/discovery.pb.h"
+#include "envoy/api/v2/eds.pb.h"
+#include "envoy/api/v2/lds.pb.h"
+#include "envoy/api/v2/rds.pb.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/config/resources.h"
+#include "common/event/libevent.h"
+#include "common/http/http2/codec_impl.h"
+#include "common/memory/stats.h"
+
+#include "test/integration/http_integration.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+
+class XdsSpeedTest : public HttpIntegrationTest {
+public:
+  // A filesystem subscription of the server.
+  struct Subscription {
+    Subscription(const std::string& name, const std::string& type_url)
+        : name_(name), type_url_(type_url) {}
+
+    const std::string name_;
+    const std::string type_url_;
+    std::string path_;
+    uint64_t version_{};
+    Stats::CounterSharedPtr update_success_;
+    Stats::CounterSharedPtr update_rejected_;
+  };
+
+  // The time from the delivery of an update until the main thread applied it, and the time the
+  // workers then took to process what the main thread posted to them while applying it.
+  struct UpdateTime {
+    std::chrono::nanoseconds apply_;
+    std::chrono::nanoseconds propagate_;
+  };
+
+  XdsSpeedTest()
+      : HttpIntegrationTest(Http::CodecClient::Type::HTTP1,
+                            TestEnvironment::getIpVersionsForTest()[0]) {}
+
+  ~XdsSpeedTest() {
+    if (barrier_slot_ != nullptr) {
+      runOnMainThread([this]() -> void { barrier_slot_.reset(); });
+    }
+  }
+
+  void initialize() override {
+    cds_.path_ = writeResponse(cds_, "", std::vector<envoy::api::v2::Cluster>());
+    lds_.path_ = writeResponse(lds_, "", std::vector<envoy::api::v2::Listener>());
+    eds_.path_ = writeResponse(eds_, "", loadAssignments(0));
+    rds_.path_ = writeResponse(rds_, "", routeConfigs(1));
+
+    config_helper_.addConfigModifier([this](envoy::config::bootstrap::v2::Bootstrap& bootstrap) {
+      bootstrap.mutable_dynamic_resources()->mutable_cds_config()->set_path(cds_.path_);
+      bootstrap.mutable_dynamic_resources()->mutable_lds_config()->set_path(lds_.path_);
+
+      auto* eds_cluster = bootstrap.mutable_static_resources()->add_clusters();
+      eds_cluster->MergeFrom(bootstrap.static_resources().clusters(0));
+      eds_cluster->set_name("eds_cluster");
+      eds_cluster->clear_hosts();
+      eds_cluster->clear_load_assignment();
+      eds_cluster->set_type(envoy::api::v2::Cluster::EDS);
+      eds_cluster->mutable_eds_cluster_config()->mutable_eds_config()->set_path(eds_.path_);
+
+      // The LDS listeners are copies of the static one, with its inline route configuration.
+      listener_template_ = bootstrap.static_resources().listeners(0);
+    });
+    config_helper_.addConfigModifier(
+        [this](envoy::config::filter::network::http_connection_manager::v2::HttpConnectionManager&
+                   hcm) {
+          hcm.clear_route_config();
+          hcm.mutable_rds()->set_route_config_name("rds_route");
+          hcm.mutable_rds()->mutable_config_source()->set_path(rds_.path_);
+        });
+    HttpIntegrationTest::initialize();
+
+    for (Subscription* subscription : {&cds_, &eds_, &rds_, &lds_}) {
+      subscription->update_success_ =
+          test_server_->counter(subscription->name_ + ".update_success");
+      subscription->update_rejected_ =
+          test_server_->counter(subscription->name_ + ".update_rejected");
+      RELEASE_ASSERT(subscription->update_success_ != nullptr, "");
+      RELEASE_ASSERT(subscription->update_rejected_ != nullptr, "");
+    }
+    runOnMainThread([this]() -> void {
+      barrier_slot_ = test_server_->server().threadLocal().allocateSlot();
+    });
+  }
+
+  /**
+   * Deliver the resources of a subscription and wait until the workers processed the update.
+   * @param subscription supplies the subscription.
+   * @param resources supplies all the resources of the subscription.
+   * @return UpdateTime the time the update took.
+   */
+  template <class Resource>
+  UpdateTime update(Subscription& subscription, const std::vector<Resource>& resources) {
+    const std::string update_path = writeResponse(subscription, ".update", resources);
+    const uint64_t successes = subscription.update_success_->value();
+    const uint64_t rejections = subscription.update_rejected_->value();
+
+    const auto start = std::chrono::steady_clock::now();
+    // The subscription watches for the file being moved into place.
+    TestUtility::renameFile(update_path, subscription.path_);
+    while (subscription.update_success_->value() == successes) {
+      RELEASE_ASSERT(subscription.update_rejected_->value() == rejections,
+                     fmt::format("{} update rejected", subscription.name_));
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    const auto applied = std::chrono::steady_clock::now();
+    waitForWorkers();
+    return {applied - start, std::chrono::steady_clock::now() - applied};
+  }
+
+  Subscription& cds() { return cds_; }
+  Subscription& eds() { return eds_; }
+  Subscription& rds() { return rds_; }
+  Subscription& lds() { return lds_; }
+
+  std::vector<envoy::api::v2::Cluster> clusters(uint32_t count) const {
+    std::vector<envoy::api::v2::Cluster> clusters(count);
+    for (uint32_t i = 0; i < count; i++) {
+      envoy::api::v2::Cluster& cluster = clusters[i];
+      cluster.set_name(fmt::format("cds_cluster_{}", i));
+      cluster.set_type(envoy::api::v2::Cluster::STATIC);
+      cluster.mutable_connect_timeout()->set_seconds(1);
+      auto* load_assignment = cluster.mutable_load_assignment();
+      load_assignment->set_cluster_name(cluster.name());
+      setEndpointAddress(*load_assignment->add_endpoints()->add_lb_endpoints()->mutable_endpoint(),
+                         Network::Test::getLoopbackAddressString(version_), 10000);
+    }
+    return clusters;
+  }
+
+  static std::vector<envoy::api::v2::ClusterLoadAssignment> loadAssignments(uint32_t endpoints) {
+    std::vector<envoy::api::v2::ClusterLoadAssignment> load_assignments(1);
+    load_assignments[0].set_cluster_name("eds_cluster");
+    auto* locality_lb_endpoints = load_assignments[0].add_endpoints();
+    for (uint32_t i = 0; i < endpoints; i++) {
+      setEndpointAddress(*locality_lb_endpoints->add_lb_endpoints()->mutable_endpoint(),
+                         fmt::format("10.{}.{}.{}", i >> 16, (i >> 8) & 0xff, i & 0xff), 80);
+    }
+    return load_assignments;
+  }
+
+  static std::vector<envoy::api::v2::RouteConfiguration> routeConfigs(uint32_t routes) {
+    std::vector<envoy::api::v2::RouteConfiguration> route_configs(1);
+    route_configs[0].set_name("rds_route");
+    auto* virtual_host = route_configs[0].add_virtual_hosts();
+    virtual_host->set_name("integration");
+    virtual_host->add_domains("*");
+    for (uint32_t i = 0; i < routes; i++) {
+      auto* route = virtual_host->add_routes();
+      route->mutable_match()->set_prefix(fmt::format("/route_{}", i));
+      route->mutable_route()->set_cluster("cluster_0");
+    }
+    return route_configs;
+  }
+
+  // The listeners do not bind to their port, since only their configuration is of interest.
+  std::vector<envoy::api::v2::Listener> listeners(uint32_t count) const {
+    std::vector<envoy::api::v2::Listener> listeners(count, listener_template_);
+    for (uint32_t i = 0; i < count; i++) {
+      envoy::api::v2::Listener& listener = listeners[i];
+      listener.set_name(fmt::format("lds_listener_{}", i));
+      listener.mutable_address()->mutable_socket_address()->set_port_value(20000 + i);
+      listener.mutable_deprecated_v1()->mutable_bind_to_port()->set_value(false);
+    }
+    return listeners;
+  }
+
+private:
+  static void setEndpointAddress(envoy::api::v2::endpoint::Endpoint& endpoint,
+                                 const std::string& address, uint32_t port) {
+    auto* socket_address = endpoint.mutable_address()->mutable_socket_address();
+    socket_address->set_address(address);
+    socket_address->set_port_value(port);
+  }
+
+  template <class Resource>
+  std::string writeResponse(Subscription& subscription, const std::string& suffix,
+                            const std::vector<Resource>& resources) {
+    envoy::api::v2::DiscoveryResponse response;
+    response.set_version_info(std::to_string(subscription.version_++));
+    response.set_type_url(subscription.type_url_);
+    for (const Resource& resource : resources) {
+      response.add_resources()->PackFrom(resource);
+    }
+    return TestEnvironment::writeStringToFileForTest(
+        fmt::format("xds_speed_test_{}{}.pb", subscription.name_, suffix),
+        response.SerializeAsString());
+  }
+
+  void runOnMainThread(std::function<void()> cb) {
+    ConditionalInitializer done;
+    test_server_->server().dispatcher().post([&cb, &done]() -> void {
+      cb();
+      done.setReady();
+    });
+    done.waitReady();
+  }
+
+  // Returns once the workers processed what the main thread posted to them so far, since the
+  // callbacks that a thread is posted run in order.
+  void waitForWorkers() {
+    ConditionalInitializer done;
+    test_server_->server().dispatcher().post([this, &done]() -> void {
+      barrier_slot_->runOnAllThreads([]() -> void {}, [&done]() -> void { done.setReady(); });
+    });
+    done.waitReady();
+  }
+
+  Subscription cds_{"cluster_manager.cds", Config::TypeUrl::get().Cluster};
+  Subscription eds_{"cluster.eds_cluster", Config::TypeUrl::get().ClusterLoadAssignment};
+  Subscription rds_{"http.config_test.rds.rds_route", Config::TypeUrl::get().RouteConfiguration};
+  Subscription lds_{"listener_manager.lds", Config::TypeUrl::get().Listener};
+  envoy::api::v2::Listener listener_template_;
+  ThreadLocal::SlotPtr barrier_slot_;
+};
+
+namespace {
+
+double toMs(std::chrono::nanoseconds duration) {
+  return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(duration).count();
+}
+
+void setCounters(benchmark::State& state, const std::vector<XdsSpeedTest::UpdateTime>& times) {
+  std::chrono::nanoseconds apply{0};
+  std::chrono::nanoseconds propagate{0};
+  for (const XdsSpeedTest::UpdateTime& time : times) {
+    apply += time.apply_;
+    propagate += time.propagate_;
+  }
+  state.counters["apply_ms"] = toMs(apply) / times.size();
+  state.counters["propagate_ms"] = toMs(propagate) / times.size();
+  struct rusage usage;
+  RELEASE_ASSERT(getrusage(RUSAGE_SELF, &usage) == 0, "");
+  state.counters["max_rss_mb"] = usage.ru_maxrss / 1024.0;
+}
+
+// Loads all the resources onto a server that has none of them, and then removes them again,
+// untimed. The heap growth of the load is only measured with tcmalloc.
+template <class Resource>
+void benchmarkLoad(benchmark::State& state, XdsSpeedTest& test,
+                   XdsSpeedTest::Subscription& subscription, const std::vector<Resource>& resources,
+                   const std::vector<Resource>& initial_resources) {
+  std::vector<XdsSpeedTest::UpdateTime> times;
+  int64_t heap_growth = 0;
+  for (auto _ : state) {
+    const int64_t heap_start = Memory::Stats::totalCurrentlyAllocated();
+    times.push_back(test.update(subscription, resources));
+    heap_growth = static_cast<int64_t>(Memory::Stats::totalCurrentlyAllocated()) - heap_start;
+    state.SetIterationTime(
+        std::chrono::duration<double>(times.back().apply_ + times.back().propagate_).count());
+    test.update(subscription, initial_resources);
+  }
+  setCounters(state, times);
+  state.counters["heap_growth_mb"] = heap_growth / (1024.0 * 1024.0);
+}
+
+// Loads all the resources, untimed, and then changes one resource per iteration.
+template <class Resource>
+void benchmarkUpdate(benchmark::State& state, XdsSpeedTest& test,
+                     XdsSpeedTest::Subscription& subscription, std::vector<Resource> resources,
+                     const std::function<void(Resource&, uint64_t)>& modify) {
+  test.update(subscription, resources);
+  std::vector<XdsSpeedTest::UpdateTime> times;
+  uint64_t iteration = 0;
+  for (auto _ : state) {
+    modify(resources[iteration % resources.size()], iteration);
+    iteration++;
+    times.push_back(test.update(subscription, resources));
+    state.SetIterationTime(
+        std::chrono::duration<double>(times.back().apply_ + times.back().propagate_).count());
+  }
+  setCounters(state, times);
+}
+
+} // namespace
+} // namespace Envoy
+
+// The Arg of each benchmark is the number of resources, i.e. of clusters, endpoints, routes or
+// listeners.
+
+static void BM_CdsLoad(benchmark::State& state) {
+  Envoy::XdsSpeedTest test;
+  test.initialize();
+  Envoy::benchmarkLoad(state, test, test.cds(), test.clusters(state.range(0)),
+                       std::vector<envoy::api::v2::Cluster>());
+}
+BENCHMARK(BM_CdsLoad)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond)->UseManualTime();
+
+static void BM_CdsUpdateOne(benchmark::State& state) {
+  Envoy::XdsSpeedTest test;
+  test.initialize();
+  Envoy::benchmarkUpdate<envoy::api::v2::Cluster>(
+      state, test, test.cds(), test.clusters(state.range(0)),
+      [](envoy::api::v2::Cluster& cluster, uint64_t iteration) {
+        cluster.mutable_connect_timeout()->set_seconds(2 + iteration);
+      });
+}
+BENCHMARK(BM_CdsUpdateOne)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+static void BM_EdsLoad(benchmark::State& state) {
+  Envoy::XdsSpeedTest test;
+  test.initialize();
+  Envoy::benchmarkLoad(state, test, test.eds(),
+                       Envoy::XdsSpeedTest::loadAssignments(state.range(0)),
+                       Envoy::XdsSpeedTest::loadAssignments(0));
+}
+BENCHMARK(BM_EdsLoad)->Arg(5000)->Arg(50000)->Unit(benchmark::kMillisecond)->UseManualTime();
+
+static void BM_EdsUpdateOne(benchmark::State& state) {
+  Envoy::XdsSpeedTest test;
+  test.initialize();
+  Envoy::benchmarkUpdate<envoy::api::v2::ClusterLoadAssignment>(
+      state, test, test.eds(), Envoy::XdsSpeedTest::loadAssignments(state.range(0)),
+      [&state](envoy::api::v2::ClusterLoadAssignment& load_assignment, uint64_t iteration) {
+        auto* endpoint = load_assignment.mutable_endpoints(0)->mutable_lb_endpoints(
+            iteration % state.range(0));
+        endpoint->set_health_status(endpoint->health_status() ==
+                                            envoy::api::v2::core::HealthStatus::UNHEALTHY
+                                        ? envoy::api::v2::core::HealthStatus::HEALTHY
+                                        : envoy::api::v2::core::HealthStatus::UNHEALTHY);
+      });
+}
+BENCHMARK(BM_EdsUpdateOne)
+    ->Arg(5000)
+    ->Arg(50000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+static void BM_RdsLoad(benchmark::State& state) {
+  Envoy::XdsSpeedTest test;
+  test.initialize();
+  Envoy::benchmarkLoad(state, test, test.rds(), Envoy::XdsSpeedTest::routeConfigs(state.range(0)),
+                       Envoy::XdsSpeedTest::routeConfigs(1));
+}
+BENCHMARK(BM_RdsLoad)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond)->UseManualTime();
+
+static void BM_RdsUpdateOne(benchmark::State& state) {
+  Envoy::XdsSpeedTest test;
+  test.initialize();
+  Envoy::benchmarkUpdate<envoy::api::v2::RouteConfiguration>(
+      state, test, test.rds(), Envoy::XdsSpeedTest::routeConfigs(state.range(0)),
+      [&state](envoy::api::v2::RouteConfiguration& route_config, uint64_t iteration) {
+        const uint64_t i = iteration % state.range(0);
+        route_config.mutable_virtual_hosts(0)->mutable_routes(i)->mutable_match()->set_prefix(
+            fmt::format("/route_{}/{}", i, iteration));
+      });
+}
+BENCHMARK(BM_RdsUpdateOne)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+static void BM_LdsLoad(benchmark::State& state) {
+  Envoy::XdsSpeedTest test;
+  test.initialize();
+  Envoy::benchmarkLoad(state, test, test.lds(), test.listeners(state.range(0)),
+                       std::vector<envoy::api::v2::Listener>());
+}
+BENCHMARK(BM_LdsLoad)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond)->UseManualTime();
+
+static void BM_LdsUpdateOne(benchmark::State& state) {
+  Envoy::XdsSpeedTest test;
+  test.initialize();
+  Envoy::benchmarkUpdate<envoy::api::v2::Listener>(
+      state, test, test.lds(), test.listeners(state.range(0)),
+      [](envoy::api::v2::Listener& listener, uint64_t iteration) {
+        listener.mutable_per_connection_buffer_limit_bytes()->set_value(1024 * 1024 + iteration);
+      });
+}
+BENCHMARK(BM_LdsUpdateOne)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+// Sets up the process the way the test runner does for the integration tests, then discovers
+// the benchmarks in the same file and runs them. The arguments that are not benchmark flags are
+// parsed as the options of the server, e.g. "-l debug".
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  Envoy::Thread::ThreadFactorySingleton::set(&Envoy::Thread::threadFactoryForTest());
+  // bazel test provides the runfiles tree in TEST_SRCDIR, while bazel run starts the binary in it.
+  if (std::getenv("TEST_SRCDIR") != nullptr) {
+    Envoy::TestEnvironment::setEnvVar(
+        "TEST_RUNDIR",
+        Envoy::TestEnvironment::getCheckedEnvVar("TEST_SRCDIR") + "/" +
+            Envoy::TestEnvironment::getCheckedEnvVar("TEST_WORKSPACE"),
+        1);
+  } else {
+    char cwd[PATH_MAX];
+    RELEASE_ASSERT(getcwd(cwd, sizeof(cwd)) != nullptr, "");
+    Envoy::TestEnvironment::setEnvVar("TEST_RUNDIR", cwd, 1);
+  }
+  Envoy::TestEnvironment::setEnvVar("TEST_UDSDIR",
+                                    Envoy::TestEnvironment::unixDomainSocketDirectory(), 1);
+  Envoy::Event::Libevent::Global::initialize();
+  Envoy::Http::Http2::initializeNghttp2Logging();
+
+  Envoy::TestEnvironment::initializeOptions(argc, argv);
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_state(Envoy::TestEnvironment::getOptions().logLevel(),
+                                       Envoy::TestEnvironment::getOptions().logFormat(), lock);
+
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -70,6 +70,7 @@ public:
   MOCK_METHOD2(ftruncate, SysCallIntResult(int fd, off_t length));
   MOCK_METHOD6(mmap, SysCallPtrResult(void* addr, size_t length, int prot, int flags, int fd,
                                       off_t offset));
+  MOCK_METHOD2(munmap, SysCallIntResult(void* addr, size_t length));
   MOCK_METHOD2(stat, SysCallIntResult(const char* name, struct stat* stat));
   MOCK_METHOD5(setsockopt_,
                int(int sockfd, int level, int optname, const void* optval, socklen_t optlen));
@@ -87,6 +88,8 @@ class MockLinuxOsSysCalls : public LinuxOsSysCallsImpl {
 public:
   // Api::LinuxOsSysCalls
   MOCK_METHOD3(sched_getaffinity, SysCallIntResult(pid_t pid, size_t cpusetsize, cpu_set_t* mask));
+  MOCK_METHOD3(sched_setaffinity,
+               SysCallIntResult(pid_t pid, size_t cpusetsize, const cpu_set_t* mask));
 };
 #endif
 
@@ -375,6 +375,7 @@ public:
   MOCK_METHOD1(addStreamEncoderFilter, void(Http::StreamEncoderFilterSharedPtr filter));
   MOCK_METHOD1(addStreamFilter, void(Http::StreamFilterSharedPtr filter));
   MOCK_METHOD1(addAccessLogHandler, void(AccessLog::InstanceSharedPtr handler));
+  MOCK_METHOD1(setFilterTimingStats, void(FilterTimingStats* stats));
 };
 
 class MockDownstreamWatermarkCallbacks : public DownstreamWatermarkCallbacks {
@@ -21,5 +21,11 @@ ExpectableTargetImpl::expectInitializeWillCallReady() {
   return expectInitialize().WillOnce(Invoke([this]() { ready(); }));
 }
 
+ExpectableSharedTargetImpl::ExpectableSharedTargetImpl(absl::string_view name)
+    : SharedTargetImpl(name, {[this]() { initialize(); }}) {}
+::testing::internal::TypedExpectation<void()>& ExpectableSharedTargetImpl::expectInitialize() {
+  return EXPECT_CALL(*this, initialize());
+}
+
 } // namespace Init
 } // namespace Envoy
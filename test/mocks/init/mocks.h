@@ -50,6 +50,22 @@ public:
   ::testing::internal::TypedExpectation<void()>& expectInitializeWillCallReady();
 };
 
+/**
+ * ExpectableSharedTargetImpl is a real SharedTargetImpl, subclassed to add a mock `initialize`
+ * method that you can set expectations on in tests.
+ */
+class ExpectableSharedTargetImpl : public SharedTargetImpl {
+public:
+  ExpectableSharedTargetImpl(absl::string_view name = "test");
+  MOCK_METHOD0(initialize, void());
+
+  /**
+   * Convenience method to provide a shorthand for EXPECT_CALL(target, initialize()). Can be
+   * chained, for example: target.expectInitialize().Times(0);
+   */
+  ::testing::internal::TypedExpectation<void()>& expectInitialize();
+};
+
 /**
  * MockManager is a typical mock. In many cases, it won't be necessary to mock any of its methods.
  * In cases where its `add` and `initialize` methods are actually called in a test, it's usually
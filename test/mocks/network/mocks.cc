@@ -29,9 +29,15 @@ MockListenerConfig::MockListenerConfig() {
   ON_CALL(*this, socket()).WillByDefault(ReturnRef(socket_));
   ON_CALL(*this, listenerScope()).WillByDefault(ReturnRef(scope_));
   ON_CALL(*this, name()).WillByDefault(ReturnRef(name_));
+  ON_CALL(*this, connectionBalancer()).WillByDefault(ReturnRef(connection_balancer_));
+  ON_CALL(*this, maxConnectionsToAcceptPerSocketEvent())
+      .WillByDefault(Return(DefaultMaxConnectionsToAcceptPerSocketEvent));
 }
 MockListenerConfig::~MockListenerConfig() {}
 
+MockConnectionBalancer::MockConnectionBalancer() = default;
+MockConnectionBalancer::~MockConnectionBalancer() = default;
+
 MockActiveDnsQuery::MockActiveDnsQuery() {}
 MockActiveDnsQuery::~MockActiveDnsQuery() {}
 
@@ -103,6 +109,7 @@ MockFilterChainManager::~MockFilterChainManager() {}
 
 MockFilterChainFactory::MockFilterChainFactory() {
   ON_CALL(*this, createListenerFilterChain(_)).WillByDefault(Return(true));
+  ON_CALL(*this, createUdpListenerFilterChain(_, _)).WillByDefault(Return(true));
 }
 MockFilterChainFactory::~MockFilterChainFactory() {}
 
@@ -134,6 +141,19 @@ MockConnectionSocket::MockConnectionSocket()
 MockListener::MockListener() {}
 MockListener::~MockListener() { onDestroy(); }
 
+MockUdpListener::MockUdpListener() {
+  ON_CALL(*this, dispatcher()).WillByDefault(ReturnRef(dispatcher_));
+}
+MockUdpListener::~MockUdpListener() { onDestroy(); }
+
+MockUdpReadFilterCallbacks::MockUdpReadFilterCallbacks() {
+  ON_CALL(*this, udpListener()).WillByDefault(ReturnRef(udp_listener_));
+}
+MockUdpReadFilterCallbacks::~MockUdpReadFilterCallbacks() {}
+
+MockUdpListenerReadFilter::MockUdpListenerReadFilter() {}
+MockUdpListenerReadFilter::~MockUdpListenerReadFilter() {}
+
 MockConnectionHandler::MockConnectionHandler() {}
 MockConnectionHandler::~MockConnectionHandler() {}
 
@@ -7,12 +7,14 @@
 
 #include "envoy/api/v2/core/address.pb.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/drain_decision.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/resolver.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/stats/scope.h"
 
+#include "common/network/connection_balancer_impl.h"
 #include "common/stats/isolated_store_impl.h"
 
 #include "test/mocks/event/mocks.h"
@@ -115,6 +117,7 @@ public:
 
   MOCK_METHOD2(onAccept_, void(ConnectionSocketPtr& socket, bool redirected));
   MOCK_METHOD1(onNewConnection_, void(ConnectionPtr& conn));
+  MOCK_METHOD2(onAcceptBatchComplete, void(std::chrono::microseconds duration, bool limit_reached));
 };
 
 class MockUdpListenerCallbacks : public UdpListenerCallbacks {
@@ -122,7 +125,7 @@ public:
   MockUdpListenerCallbacks();
   ~MockUdpListenerCallbacks();
 
-  void onData(const UdpData& data) override { onData_(data); }
+  void onData(UdpData& data) override { onData_(data); }
 
   void onWriteReady(const Socket& socket) override { onWriteReady_(socket); }
 
@@ -130,6 +133,8 @@ public:
 
   MOCK_METHOD1(onData_, void(const UdpData& data));
 
+  MOCK_METHOD1(onReceiveBatchComplete, void(uint32_t datagrams));
+
   MOCK_METHOD1(onWriteReady_, void(const Socket& socket));
 
   MOCK_METHOD2(onError_, void(const ErrorCode& err_code, int err));
@@ -189,6 +194,8 @@ public:
                bool(Connection& connection,
                     const std::vector<Network::FilterFactoryCb>& filter_factories));
   MOCK_METHOD1(createListenerFilterChain, bool(ListenerFilterManager& listener));
+  MOCK_METHOD2(createUdpListenerFilterChain,
+               bool(UdpListenerFilterManager& udp_listener, UdpReadFilterCallbacks& callbacks));
 };
 
 class MockListenSocket : public Socket {
@@ -288,11 +295,25 @@ public:
   MOCK_METHOD0(listenerScope, Stats::Scope&());
   MOCK_CONST_METHOD0(listenerTag, uint64_t());
   MOCK_CONST_METHOD0(name, const std::string&());
+  MOCK_METHOD0(connectionBalancer, ConnectionBalancer&());
+  MOCK_CONST_METHOD0(maxConnectionsToAcceptPerSocketEvent, uint32_t());
 
   testing::NiceMock<MockFilterChainFactory> filter_chain_factory_;
   testing::NiceMock<MockListenSocket> socket_;
   Stats::IsolatedStoreImpl scope_;
   std::string name_;
+  NopConnectionBalancerImpl connection_balancer_;
+};
+
+class MockConnectionBalancer : public ConnectionBalancer {
+public:
+  MockConnectionBalancer();
+  ~MockConnectionBalancer();
+
+  MOCK_METHOD1(registerHandler, void(BalancedConnectionHandler& handler));
+  MOCK_METHOD1(unregisterHandler, void(BalancedConnectionHandler& handler));
+  MOCK_METHOD2(balance,
+               bool(BalancedConnectionHandler& current_handler, ConnectionSocketPtr& socket));
 };
 
 class MockListener : public Listener {
@@ -305,6 +326,40 @@ public:
   MOCK_METHOD0(disable, void());
 };
 
+class MockUdpListener : public UdpListener {
+public:
+  MockUdpListener();
+  ~MockUdpListener();
+
+  MOCK_METHOD0(onDestroy, void());
+  MOCK_METHOD0(enable, void());
+  MOCK_METHOD0(disable, void());
+  MOCK_METHOD0(dispatcher, Event::Dispatcher&());
+  MOCK_CONST_METHOD0(localAddress, const Address::InstanceConstSharedPtr&());
+  MOCK_METHOD1(send, Api::SysCallIntResult(const std::vector<UdpSendData>& datagrams));
+
+  testing::NiceMock<Event::MockDispatcher> dispatcher_;
+};
+
+class MockUdpReadFilterCallbacks : public UdpReadFilterCallbacks {
+public:
+  MockUdpReadFilterCallbacks();
+  ~MockUdpReadFilterCallbacks();
+
+  MOCK_METHOD0(udpListener, UdpListener&());
+
+  testing::NiceMock<MockUdpListener> udp_listener_;
+};
+
+class MockUdpListenerReadFilter : public UdpListenerReadFilter {
+public:
+  MockUdpListenerReadFilter();
+  ~MockUdpListenerReadFilter();
+
+  MOCK_METHOD1(onData, void(UdpData& data));
+  MOCK_METHOD1(onReceiveBatchComplete, void(uint32_t datagrams));
+};
+
 class MockConnectionHandler : public ConnectionHandler {
 public:
   MockConnectionHandler();
@@ -316,6 +371,8 @@ public:
   MOCK_METHOD1(findListenerByAddress,
                Network::Listener*(const Network::Address::Instance& address));
   MOCK_METHOD1(removeListeners, void(uint64_t listener_tag));
+  MOCK_METHOD2(removeFilterChains,
+               void(uint64_t listener_tag, const std::list<const FilterChain*>& filter_chains));
   MOCK_METHOD1(stopListeners, void(uint64_t listener_tag));
   MOCK_METHOD0(stopListeners, void());
   MOCK_METHOD0(disableListeners, void());
@@ -396,6 +453,7 @@ public:
   MOCK_METHOD0(connection, Connection&());
   MOCK_METHOD0(shouldDrainReadBuffer, bool());
   MOCK_METHOD0(setReadBufferReady, void());
+  MOCK_METHOD0(flushWriteBuffer, void());
   MOCK_METHOD1(raiseEvent, void(ConnectionEvent));
 
   testing::NiceMock<MockConnection> connection_;
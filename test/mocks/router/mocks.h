@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <list>
@@ -45,7 +46,17 @@ class TestCorsPolicy : public CorsPolicy {
 public:
   // Router::CorsPolicy
   const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-  const std::list<std::regex>& allowOriginRegexes() const override { return allow_origin_regex_; };
+  const std::vector<Regex::CompiledMatcherPtr>& allowOriginRegexes() const override {
+    return allow_origin_regex_;
+  };
+  bool allowsOrigin(absl::string_view origin) const override {
+    return std::any_of(allow_origin_.begin(), allow_origin_.end(),
+                       [origin](const std::string& o) { return o == "*" || o == origin; });
+  };
+  bool allowsOriginRegex(absl::string_view origin) const override {
+    return std::any_of(allow_origin_regex_.begin(), allow_origin_regex_.end(),
+                       [origin](const Regex::CompiledMatcherPtr& r) { return r->match(origin); });
+  };
   const std::string& allowMethods() const override { return allow_methods_; };
   const std::string& allowHeaders() const override { return allow_headers_; };
   const std::string& exposeHeaders() const override { return expose_headers_; };
@@ -55,7 +66,7 @@ public:
   bool shadowEnabled() const override { return shadow_enabled_; };
 
   std::list<std::string> allow_origin_{};
-  std::list<std::regex> allow_origin_regex_{};
+  std::vector<Regex::CompiledMatcherPtr> allow_origin_regex_;
   std::string allow_methods_{};
   std::string allow_headers_{};
   std::string expose_headers_{};
@@ -73,10 +84,18 @@ public:
     return additional_request_chance_;
   }
   bool hedgeOnPerTryTimeout() const override { return hedge_on_per_try_timeout; }
+  bool hedgeOnLatency() const override { return hedge_on_latency_; }
+  std::chrono::milliseconds latencyHedgeMinDelay() const override {
+    return latency_hedge_min_delay_;
+  }
+  double latencyHedgeBudgetPercent() const override { return latency_hedge_budget_percent_; }
 
   uint32_t initial_requests_{};
   envoy::type::FractionalPercent additional_request_chance_{};
   bool hedge_on_per_try_timeout{};
+  bool hedge_on_latency_{};
+  std::chrono::milliseconds latency_hedge_min_delay_{};
+  double latency_hedge_budget_percent_{};
 };
 
 class TestRetryPolicy : public RetryPolicy {
@@ -160,10 +179,12 @@ public:
   const std::string& cluster() const override { return cluster_; }
   const std::string& runtimeKey() const override { return runtime_key_; }
   const envoy::type::FractionalPercent& defaultValue() const override { return default_value_; }
+  bool streaming() const override { return streaming_; }
 
   std::string cluster_;
   std::string runtime_key_;
   envoy::type::FractionalPercent default_value_;
+  bool streaming_{};
 };
 
 class MockShadowWriter : public ShadowWriter {
@@ -177,8 +198,25 @@ public:
     shadow_(cluster, request, timeout);
   }
 
+  ShadowStreamPtr streamingShadow(const std::string& cluster, Http::HeaderMapPtr&& headers,
+                                  std::chrono::milliseconds timeout) override {
+    return ShadowStreamPtr{streamingShadow_(cluster, *headers, timeout)};
+  }
+
   MOCK_METHOD3(shadow_, void(const std::string& cluster, Http::MessagePtr& request,
                              std::chrono::milliseconds timeout));
+  MOCK_METHOD3(streamingShadow_, ShadowStream*(const std::string& cluster, Http::HeaderMap& headers,
+                                               std::chrono::milliseconds timeout));
+};
+
+class MockShadowStream : public ShadowStream {
+public:
+  MockShadowStream();
+  ~MockShadowStream();
+
+  // Router::ShadowStream
+  MOCK_METHOD2(sendData, void(Buffer::Instance& data, bool end_stream));
+  MOCK_METHOD1(sendTrailers, void(Http::HeaderMap& trailers));
 };
 
 class TestVirtualCluster : public VirtualCluster {
@@ -198,7 +236,7 @@ public:
   MOCK_CONST_METHOD0(name, const std::string&());
   MOCK_CONST_METHOD0(rateLimitPolicy, const RateLimitPolicy&());
   MOCK_CONST_METHOD0(corsPolicy, const CorsPolicy*());
-  MOCK_CONST_METHOD0(routeConfig, const Config&());
+  MOCK_CONST_METHOD0(routeConfig, const CommonConfig&());
   MOCK_CONST_METHOD1(perFilterConfig, const RouteSpecificFilterConfig*(const std::string&));
   MOCK_CONST_METHOD0(includeAttemptCount, bool());
   MOCK_METHOD0(retryPriority, Upstream::RetryPrioritySharedPtr());
@@ -264,6 +302,7 @@ public:
   MOCK_CONST_METHOD0(priority, Upstream::ResourcePriority());
   MOCK_CONST_METHOD0(rateLimitPolicy, const RateLimitPolicy&());
   MOCK_CONST_METHOD0(retryPolicy, const RetryPolicy&());
+  MOCK_CONST_METHOD0(retryShadowBufferLimit, uint32_t());
   MOCK_CONST_METHOD0(shadowPolicy, const ShadowPolicy&());
   MOCK_CONST_METHOD0(timeout, std::chrono::milliseconds());
   MOCK_CONST_METHOD0(idleTimeout, absl::optional<std::chrono::milliseconds>());
@@ -321,6 +360,7 @@ public:
   MOCK_CONST_METHOD0(routeEntry, const RouteEntry*());
   MOCK_CONST_METHOD0(decorator, const Decorator*());
   MOCK_CONST_METHOD1(perFilterConfig, const RouteSpecificFilterConfig*(const std::string&));
+  MOCK_CONST_METHOD0(cacheable, bool());
 
   testing::NiceMock<MockRouteEntry> route_entry_;
   testing::NiceMock<MockDecorator> decorator_;
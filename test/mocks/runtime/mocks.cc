@@ -1,16 +1,23 @@
 #include "mocks.h"
 
+#include <cstring>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
 using testing::_;
+using testing::Invoke;
 using testing::Return;
 using testing::ReturnArg;
 
 namespace Envoy {
 namespace Runtime {
 
-MockRandomGenerator::MockRandomGenerator() { ON_CALL(*this, uuid()).WillByDefault(Return(uuid_)); }
+MockRandomGenerator::MockRandomGenerator() {
+  ON_CALL(*this, uuid()).WillByDefault(Return(uuid_));
+  ON_CALL(*this, uuid(_)).WillByDefault(
+      Invoke([this](char* buffer) { memcpy(buffer, uuid_.data(), uuid_.size()); }));
+}
 
 MockRandomGenerator::~MockRandomGenerator() {}
 
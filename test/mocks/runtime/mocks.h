@@ -18,6 +18,7 @@ public:
 
   MOCK_METHOD0(random, uint64_t());
   MOCK_METHOD0(uuid, std::string());
+  MOCK_METHOD1(uuid, void(char* buffer));
 
   const std::string uuid_{"a121e9e1-feae-4136-9e0e-6fac343d56c9"};
 };
@@ -42,6 +43,32 @@ public:
   MOCK_CONST_METHOD1(get, const std::string&(const std::string& key));
   MOCK_CONST_METHOD2(getInteger, uint64_t(const std::string& key, uint64_t default_value));
   MOCK_CONST_METHOD0(getLayers, const std::vector<OverrideLayerConstPtr>&());
+
+  // The lookups by handle are forwarded to the lookups by key, so that tests set their
+  // expectations on keys.
+  bool featureEnabled(const FeatureHandle& handle, uint64_t default_value) const override {
+    return featureEnabled(handle.key(), default_value);
+  }
+  bool featureEnabled(const FeatureHandle& handle, uint64_t default_value,
+                      uint64_t random_value) const override {
+    return featureEnabled(handle.key(), default_value, random_value);
+  }
+  bool featureEnabled(const FeatureHandle& handle, uint64_t default_value, uint64_t random_value,
+                      uint64_t num_buckets) const override {
+    return featureEnabled(handle.key(), default_value, random_value, num_buckets);
+  }
+  bool featureEnabled(const FeatureHandle& handle,
+                      const envoy::type::FractionalPercent& default_value) const override {
+    return featureEnabled(handle.key(), default_value);
+  }
+  bool featureEnabled(const FeatureHandle& handle,
+                      const envoy::type::FractionalPercent& default_value,
+                      uint64_t random_value) const override {
+    return featureEnabled(handle.key(), default_value, random_value);
+  }
+  uint64_t getInteger(const FeatureHandle& handle, uint64_t default_value) const override {
+    return getInteger(handle.key(), default_value);
+  }
 };
 
 class MockLoader : public Loader {
@@ -7,6 +7,7 @@
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
 #include "envoy/ssl/context_manager.h"
+#include "envoy/ssl/private_key/private_key.h"
 #include "envoy/stats/scope.h"
 
 #include "test/mocks/secret/mocks.h"
@@ -28,6 +29,10 @@ public:
                                       const std::vector<std::string>& server_names));
   MOCK_CONST_METHOD0(daysUntilFirstCertExpires, size_t());
   MOCK_METHOD1(iterateContexts, void(std::function<void(const Context&)> callback));
+  MOCK_METHOD3(prefetchCertificates,
+               CertificatePrefetchPtr(const std::vector<const TlsCertificateConfig*>& certificates,
+                                      Thread::ThreadFactory& thread_factory, uint32_t threads));
+  MOCK_METHOD0(privateKeyMethodManager, PrivateKeyMethodManager&());
 };
 
 class MockConnectionInfo : public ConnectionInfo {
@@ -60,5 +65,28 @@ public:
   MOCK_CONST_METHOD0(getCertChainInformation, std::vector<CertificateDetailsPtr>());
 };
 
+class MockPrivateKeyMethodManager : public PrivateKeyMethodManager {
+public:
+  MockPrivateKeyMethodManager();
+  ~MockPrivateKeyMethodManager();
+
+  MOCK_METHOD2(createPrivateKeyMethodProvider,
+               PrivateKeyMethodProviderSharedPtr(
+                   const envoy::api::v2::auth::PrivateKeyProvider& config,
+                   Envoy::Server::Configuration::TransportSocketFactoryContext& factory_context));
+};
+
+class MockPrivateKeyMethodProvider : public PrivateKeyMethodProvider {
+public:
+  MockPrivateKeyMethodProvider();
+  ~MockPrivateKeyMethodProvider();
+
+  MOCK_METHOD3(registerPrivateKeyMethod,
+               void(SSL* ssl, PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher));
+  MOCK_METHOD1(unregisterPrivateKeyMethod, void(SSL* ssl));
+  MOCK_METHOD0(checkFips, bool());
+  MOCK_METHOD0(getBoringSslPrivateKeyMethod, BoringSslPrivateKeyMethodSharedPtr());
+};
+
 } // namespace Ssl
 } // namespace Envoy
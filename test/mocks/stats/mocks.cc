@@ -17,6 +17,11 @@ using testing::ReturnRef;
 namespace Envoy {
 namespace Stats {
 
+StatName MockStatName::statName(const std::string& name) const {
+  storage_ = std::make_unique<StatNameTempStorage>(name, *symbol_table_);
+  return storage_->statName();
+}
+
 MockCounter::MockCounter() {
   ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnRef(name_));
   ON_CALL(*this, tags()).WillByDefault(ReturnRef(tags_));
@@ -65,6 +70,9 @@ MockSource::MockSource() {
   ON_CALL(*this, cachedCounters()).WillByDefault(ReturnRef(counters_));
   ON_CALL(*this, cachedGauges()).WillByDefault(ReturnRef(gauges_));
   ON_CALL(*this, cachedHistograms()).WillByDefault(ReturnRef(histograms_));
+  ON_CALL(*this, cachedChangedCounters()).WillByDefault(ReturnRef(counters_));
+  ON_CALL(*this, cachedChangedGauges()).WillByDefault(ReturnRef(gauges_));
+  ON_CALL(*this, cachedChangedHistograms()).WillByDefault(ReturnRef(histograms_));
 }
 
 MockSource::~MockSource() {}
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <list>
+#include <memory>
 #include <string>
 
 #include "envoy/stats/histogram.h"
@@ -26,6 +27,19 @@
 namespace Envoy {
 namespace Stats {
 
+/**
+ * Symbolizes the name_ of a mock metric on demand, so that mocks can implement
+ * Metric::statName() while tests continue to set the name as a string.
+ */
+class MockStatName {
+public:
+  StatName statName(const std::string& name) const;
+
+private:
+  mutable Test::Global<FakeSymbolTableImpl> symbol_table_;
+  mutable std::unique_ptr<StatNameTempStorage> storage_;
+};
+
 class MockCounter : public Counter {
 public:
   MockCounter();
@@ -34,7 +48,7 @@ public:
   // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
   // creates a deadlock in gmock and is an unintended use of mock functions.
   std::string name() const override { return name_; };
-  const char* nameCStr() const override { return name_.c_str(); };
+  StatName statName() const override { return stat_name_.statName(name_); };
 
   MOCK_METHOD1(add, void(uint64_t amount));
   MOCK_METHOD0(inc, void());
@@ -49,6 +63,7 @@ public:
   uint64_t value_;
   uint64_t latch_;
   std::string name_;
+  MockStatName stat_name_;
   std::vector<Tag> tags_;
 };
 
@@ -60,7 +75,7 @@ public:
   // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
   // creates a deadlock in gmock and is an unintended use of mock functions.
   std::string name() const override { return name_; };
-  const char* nameCStr() const override { return name_.c_str(); };
+  StatName statName() const override { return stat_name_.statName(name_); };
 
   MOCK_METHOD1(add, void(uint64_t amount));
   MOCK_METHOD0(dec, void());
@@ -75,6 +90,7 @@ public:
   bool used_;
   uint64_t value_;
   std::string name_;
+  MockStatName stat_name_;
   std::vector<Tag> tags_;
 };
 
@@ -86,7 +102,7 @@ public:
   // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
   // creates a deadlock in gmock and is an unintended use of mock functions.
   std::string name() const override { return name_; };
-  const char* nameCStr() const override { return name_.c_str(); };
+  StatName statName() const override { return stat_name_.statName(name_); };
 
   MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
   MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
@@ -94,6 +110,7 @@ public:
   MOCK_CONST_METHOD0(used, bool());
 
   std::string name_;
+  MockStatName stat_name_;
   std::vector<Tag> tags_;
   Store* store_;
 };
@@ -106,7 +123,7 @@ public:
   // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
   // creates a deadlock in gmock and is an unintended use of mock functions.
   std::string name() const override { return name_; };
-  const char* nameCStr() const override { return name_.c_str(); };
+  StatName statName() const override { return stat_name_.statName(name_); };
   void merge() override {}
   const std::string quantileSummary() const override { return ""; };
   const std::string bucketSummary() const override { return ""; };
@@ -119,6 +136,7 @@ public:
   MOCK_CONST_METHOD0(intervalStatistics, const HistogramStatistics&());
 
   std::string name_;
+  MockStatName stat_name_;
   std::vector<Tag> tags_;
   bool used_;
   Store* store_;
@@ -134,6 +152,9 @@ public:
   MOCK_METHOD0(cachedCounters, const std::vector<CounterSharedPtr>&());
   MOCK_METHOD0(cachedGauges, const std::vector<GaugeSharedPtr>&());
   MOCK_METHOD0(cachedHistograms, const std::vector<ParentHistogramSharedPtr>&());
+  MOCK_METHOD0(cachedChangedCounters, const std::vector<CounterSharedPtr>&());
+  MOCK_METHOD0(cachedChangedGauges, const std::vector<GaugeSharedPtr>&());
+  MOCK_METHOD0(cachedChangedHistograms, const std::vector<ParentHistogramSharedPtr>&());
   MOCK_METHOD0(clearCache, void());
 
   std::vector<CounterSharedPtr> counters_;
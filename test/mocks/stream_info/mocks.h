@@ -25,6 +25,8 @@ public:
   MOCK_CONST_METHOD0(lastDownstreamRxByteReceived, absl::optional<std::chrono::nanoseconds>());
   MOCK_METHOD0(onLastDownstreamRxByteReceived, void());
   MOCK_METHOD1(setUpstreamTiming, void(const UpstreamTiming&));
+  MOCK_METHOD0(upstreamTiming, UpstreamTiming&());
+  MOCK_CONST_METHOD0(upstreamTiming, const UpstreamTiming&());
   MOCK_CONST_METHOD0(firstUpstreamTxByteSent, absl::optional<std::chrono::nanoseconds>());
   MOCK_METHOD0(onFirstUpstreamTxByteSent, void());
   MOCK_CONST_METHOD0(lastUpstreamTxByteSent, absl::optional<std::chrono::nanoseconds>());
@@ -88,6 +90,7 @@ public:
   absl::optional<std::chrono::nanoseconds> first_downstream_tx_byte_sent_;
   absl::optional<std::chrono::nanoseconds> last_downstream_tx_byte_sent_;
   absl::optional<std::chrono::nanoseconds> end_time_;
+  UpstreamTiming upstream_timing_;
   absl::optional<Http::Protocol> protocol_;
   absl::optional<uint32_t> response_code_;
   envoy::api::v2::core::Metadata metadata_;
@@ -25,6 +25,8 @@ public:
   MOCK_METHOD0(shutdownGlobalThreading, void());
   MOCK_METHOD0(shutdownThread, void());
   MOCK_METHOD0(dispatcher, Event::Dispatcher&());
+  // Updates already run synchronously, so there is nothing to batch.
+  UpdateBatchPtr startUpdateBatch() override { return std::make_unique<UpdateBatch>(); }
 
   SlotPtr allocateSlot_() { return SlotPtr{new SlotImpl(*this, current_slot_++)}; }
   void runOnAllThreads_(Event::PostCb cb) { cb(); }
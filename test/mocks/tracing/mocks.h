@@ -30,6 +30,11 @@ public:
   ~MockSpan();
 
   MOCK_METHOD1(setOperation, void(const std::string& operation));
+  // Tags are matched as strings, which the views passed by the code under test are only valid
+  // for the duration of the call.
+  void setTag(absl::string_view name, absl::string_view value) override {
+    setTag(std::string(name), std::string(value));
+  }
   MOCK_METHOD2(setTag, void(const std::string& name, const std::string& value));
   MOCK_METHOD2(log, void(SystemTime timestamp, const std::string& event));
   MOCK_METHOD0(finishSpan, void());
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 
@@ -48,8 +49,15 @@ public:
 
   void resetResourceManager(uint64_t cx, uint64_t rq_pending, uint64_t rq, uint64_t rq_retry,
                             uint64_t conn_pool) {
+    resetResourceManager(cx, rq_pending, rq, rq_retry, conn_pool,
+                         std::numeric_limits<uint64_t>::max());
+  }
+
+  void resetResourceManager(uint64_t cx, uint64_t rq_pending, uint64_t rq, uint64_t rq_retry,
+                            uint64_t conn_pool, uint64_t cx_per_host) {
     resource_manager_ = std::make_unique<ResourceManagerImpl>(
-        runtime_, name_, cx, rq_pending, rq, rq_retry, conn_pool, circuit_breakers_stats_);
+        runtime_, name_, cx, rq_pending, rq, rq_retry, conn_pool, cx_per_host,
+        circuit_breakers_stats_, absl::nullopt, absl::nullopt);
   }
 
   // Upstream::ClusterInfo
@@ -58,6 +66,7 @@ public:
   MOCK_CONST_METHOD0(idleTimeout, const absl::optional<std::chrono::milliseconds>());
   MOCK_CONST_METHOD0(perConnectionBufferLimitBytes, uint32_t());
   MOCK_CONST_METHOD0(features, uint64_t());
+  MOCK_CONST_METHOD0(http1Settings, const Http::Http1Settings&());
   MOCK_CONST_METHOD0(http2Settings, const Http::Http2Settings&());
   MOCK_CONST_METHOD1(extensionProtocolOptions,
                      ProtocolOptionsConfigConstSharedPtr(const std::string&));
@@ -84,10 +93,14 @@ public:
   MOCK_CONST_METHOD0(typedMetadata, const Envoy::Config::TypedMetadata&());
   MOCK_CONST_METHOD0(clusterSocketOptions, const Network::ConnectionSocket::OptionsSharedPtr&());
   MOCK_CONST_METHOD0(drainConnectionsOnHostRemoval, bool());
+  MOCK_CONST_METHOD0(perUpstreamPrefetchRatio, float());
+  MOCK_CONST_METHOD0(prefetchOnHostAdd, bool());
   MOCK_CONST_METHOD0(eds_service_name, absl::optional<std::string>());
+  MOCK_CONST_METHOD0(latencyEstimator, LatencyEstimator&());
 
   std::string name_{"fake_cluster"};
   absl::optional<std::string> eds_service_name_;
+  Http::Http1Settings http1_settings_{};
   Http::Http2Settings http2_settings_{};
   ProtocolOptionsConfigConstSharedPtr extension_protocol_options_;
   uint64_t max_requests_per_connection_{};
@@ -107,6 +120,7 @@ public:
   absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig> lb_original_dst_config_;
   Network::ConnectionSocket::OptionsSharedPtr cluster_socket_options_;
   envoy::api::v2::Cluster::CommonLbConfig lb_config_;
+  LatencyEstimatorImpl latency_estimator_;
 };
 
 class MockIdleTimeEnabledClusterInfo : public MockClusterInfo {
@@ -46,6 +46,7 @@ MockHost::MockHost() {
   ON_CALL(*this, cluster()).WillByDefault(ReturnRef(cluster_));
   ON_CALL(*this, outlierDetector()).WillByDefault(ReturnRef(outlier_detector_));
   ON_CALL(*this, stats()).WillByDefault(ReturnRef(stats_));
+  ON_CALL(*this, canCreateConnection(_)).WillByDefault(Return(true));
 }
 
 MockHost::~MockHost() {}
@@ -139,6 +139,7 @@ public:
   MOCK_METHOD1(metadata, void(const envoy::api::v2::core::Metadata&));
   MOCK_CONST_METHOD0(cluster, const ClusterInfo&());
   MOCK_CONST_METHOD0(counters, std::vector<Stats::CounterSharedPtr>());
+  MOCK_CONST_METHOD1(canCreateConnection, bool(ResourcePriority priority));
   MOCK_CONST_METHOD2(
       createConnection_,
       MockCreateConnectionData(Event::Dispatcher& dispatcher,
@@ -33,6 +33,28 @@ MockHostSet::MockHostSet(uint32_t priority, uint32_t overprovisioning_factor)
   ON_CALL(*this, degradedHostsPerLocality())
       .WillByDefault(
           Invoke([this]() -> const HostsPerLocality& { return *degraded_hosts_per_locality_; }));
+  // The mock's vectors are mutable, so hand out copies of them.
+  ON_CALL(*this, hostsPtr()).WillByDefault(Invoke([this]() -> HostVectorConstSharedPtr {
+    return std::make_shared<const HostVector>(hosts_);
+  }));
+  ON_CALL(*this, healthyHostsPtr()).WillByDefault(Invoke([this]() -> HostVectorConstSharedPtr {
+    return std::make_shared<const HostVector>(healthy_hosts_);
+  }));
+  ON_CALL(*this, degradedHostsPtr()).WillByDefault(Invoke([this]() -> HostVectorConstSharedPtr {
+    return std::make_shared<const HostVector>(degraded_hosts_);
+  }));
+  ON_CALL(*this, hostsPerLocalityPtr())
+      .WillByDefault(Invoke([this]() -> HostsPerLocalityConstSharedPtr {
+        return hosts_per_locality_->clone();
+      }));
+  ON_CALL(*this, healthyHostsPerLocalityPtr())
+      .WillByDefault(Invoke([this]() -> HostsPerLocalityConstSharedPtr {
+        return healthy_hosts_per_locality_->clone();
+      }));
+  ON_CALL(*this, degradedHostsPerLocalityPtr())
+      .WillByDefault(Invoke([this]() -> HostsPerLocalityConstSharedPtr {
+        return degraded_hosts_per_locality_->clone();
+      }));
   ON_CALL(*this, localityWeights()).WillByDefault(Invoke([this]() -> LocalityWeightsConstSharedPtr {
     return locality_weights_;
   }));
@@ -109,6 +131,9 @@ MockThreadLocalCluster::~MockThreadLocalCluster() = default;
 MockClusterUpdateCallbacksHandle::MockClusterUpdateCallbacksHandle() = default;
 MockClusterUpdateCallbacksHandle::~MockClusterUpdateCallbacksHandle() = default;
 
+MockOnDemandClusterHandle::MockOnDemandClusterHandle() = default;
+MockOnDemandClusterHandle::~MockOnDemandClusterHandle() { onDestroy(); }
+
 MockClusterManager::MockClusterManager(TimeSource&) : MockClusterManager() {}
 
 MockClusterManager::MockClusterManager() {
@@ -55,6 +55,12 @@ public:
   MOCK_CONST_METHOD0(hostsPerLocality, const HostsPerLocality&());
   MOCK_CONST_METHOD0(healthyHostsPerLocality, const HostsPerLocality&());
   MOCK_CONST_METHOD0(degradedHostsPerLocality, const HostsPerLocality&());
+  MOCK_CONST_METHOD0(hostsPtr, HostVectorConstSharedPtr());
+  MOCK_CONST_METHOD0(healthyHostsPtr, HostVectorConstSharedPtr());
+  MOCK_CONST_METHOD0(degradedHostsPtr, HostVectorConstSharedPtr());
+  MOCK_CONST_METHOD0(hostsPerLocalityPtr, HostsPerLocalityConstSharedPtr());
+  MOCK_CONST_METHOD0(healthyHostsPerLocalityPtr, HostsPerLocalityConstSharedPtr());
+  MOCK_CONST_METHOD0(degradedHostsPerLocalityPtr, HostsPerLocalityConstSharedPtr());
   MOCK_CONST_METHOD0(localityWeights, LocalityWeightsConstSharedPtr());
   MOCK_METHOD0(chooseHealthyLocality, absl::optional<uint32_t>());
   MOCK_METHOD0(chooseDegradedLocality, absl::optional<uint32_t>());
@@ -161,6 +167,7 @@ public:
   MOCK_METHOD1(initialize, void(std::function<void()> callback));
   MOCK_CONST_METHOD0(initializePhase, InitializePhase());
   MOCK_CONST_METHOD0(sourceAddress, const Network::Address::InstanceConstSharedPtr&());
+  ThreadAwareLoadBalancerPtr createThreadAwareLoadBalancer() override { return nullptr; }
 
   std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
   std::function<void()> initialize_callback_;
@@ -248,8 +255,8 @@ public:
                                 Outlier::EventLoggerSharedPtr outlier_event_logger,
                                 bool added_via_api));
 
-  MOCK_METHOD2(createCds,
-               CdsApiPtr(const envoy::api::v2::core::ConfigSource& cds_config, ClusterManager& cm));
+  MOCK_METHOD3(createCds, CdsApiPtr(const envoy::api::v2::core::ConfigSource& cds_config,
+                                    uint32_t config_threads, ClusterManager& cm));
 
 private:
   NiceMock<Secret::MockSecretManager> secret_manager_;
@@ -261,6 +268,14 @@ public:
   ~MockClusterUpdateCallbacksHandle();
 };
 
+class MockOnDemandClusterHandle : public OnDemandClusterHandle {
+public:
+  MockOnDemandClusterHandle();
+  ~MockOnDemandClusterHandle();
+
+  MOCK_METHOD0(onDestroy, void());
+};
+
 class MockClusterManager : public ClusterManager {
 public:
   explicit MockClusterManager(TimeSource& time_source);
@@ -272,6 +287,12 @@ public:
     return ClusterUpdateCallbacksHandlePtr{addThreadLocalClusterUpdateCallbacks_(callbacks)};
   }
 
+  OnDemandClusterHandlePtr requestOnDemandCluster(const std::string& cluster,
+                                                  Event::Dispatcher& dispatcher,
+                                                  OnDemandClusterCallback callback) override {
+    return OnDemandClusterHandlePtr{requestOnDemandCluster_(cluster, dispatcher, callback)};
+  }
+
   Host::CreateConnectionData tcpConnForCluster(const std::string& cluster,
                                                LoadBalancerContext* context,
                                                Network::TransportSocketOptionsSharedPtr) override {
@@ -311,6 +332,11 @@ public:
   MOCK_METHOD1(addThreadLocalClusterUpdateCallbacks_,
                ClusterUpdateCallbacksHandle*(ClusterUpdateCallbacks& callbacks));
   MOCK_CONST_METHOD0(warmingClusterCount, std::size_t());
+  MOCK_METHOD0(healthCheckerDispatcherPool, HealthCheckerDispatcherPoolSharedPtr());
+  MOCK_METHOD3(requestOnDemandCluster_,
+               OnDemandClusterHandle*(const std::string& cluster, Event::Dispatcher& dispatcher,
+                                      OnDemandClusterCallback callback));
+  MOCK_CONST_METHOD0(declaredOnDemandClusters, std::vector<std::string>());
 
   NiceMock<Http::ConnectionPool::MockInstance> conn_pool_;
   NiceMock<Http::MockAsyncClient> async_client_;
@@ -73,6 +73,18 @@ TEST_F(ConfigurationImplTest, DefaultStatsFlushInterval) {
   config.initialize(bootstrap, server_, cluster_manager_factory_);
 
   EXPECT_EQ(std::chrono::milliseconds(5000), config.statsFlushInterval());
+  EXPECT_FALSE(config.histogramMergeInterval().has_value());
+}
+
+TEST_F(ConfigurationImplTest, CustomHistogramMergeInterval) {
+  envoy::config::bootstrap::v2::Bootstrap bootstrap;
+  bootstrap.mutable_histogram_merge_interval()->set_seconds(60);
+
+  MainImpl config;
+  config.initialize(bootstrap, server_, cluster_manager_factory_);
+
+  EXPECT_EQ(std::chrono::milliseconds(5000), config.statsFlushInterval());
+  EXPECT_EQ(std::chrono::milliseconds(60000), config.histogramMergeInterval().value());
 }
 
 TEST_F(ConfigurationImplTest, CustomStatsFlushInterval) {
@@ -2,6 +2,7 @@
 
 #include "common/common/utility.h"
 #include "common/network/address_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
 
@@ -57,6 +58,10 @@ public:
     Stats::Scope& listenerScope() override { return parent_.stats_store_; }
     uint64_t listenerTag() const override { return tag_; }
     const std::string& name() const override { return name_; }
+    Network::ConnectionBalancer& connectionBalancer() override { return *connection_balancer_; }
+    uint32_t maxConnectionsToAcceptPerSocketEvent() const override {
+      return max_connections_to_accept_per_socket_event_;
+    }
 
     ConnectionHandlerTest& parent_;
     Network::MockListenSocket socket_;
@@ -65,6 +70,10 @@ public:
     const bool hand_off_restored_destination_connections_;
     const std::string name_;
     const std::chrono::milliseconds listener_filters_timeout_;
+    Network::ConnectionBalancerPtr connection_balancer_{
+        std::make_unique<Network::NopConnectionBalancerImpl>()};
+    uint32_t max_connections_to_accept_per_socket_event_{
+        Network::DefaultMaxConnectionsToAcceptPerSocketEvent};
   };
 
   typedef std::unique_ptr<TestListener> TestListenerPtr;
@@ -94,12 +103,12 @@ TEST_F(ConnectionHandlerTest, RemoveListener) {
 
   Network::MockListener* listener = new NiceMock<Network::MockListener>();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   TestListener* test_listener = addListener(1, true, false, "test_listener");
   EXPECT_CALL(test_listener->socket_, localAddress());
   handler_->addListener(*test_listener);
@@ -125,17 +134,72 @@ TEST_F(ConnectionHandlerTest, RemoveListener) {
   handler_->removeListeners(0);
 }
 
+// Adding a listener with the tag of an existing listener swaps its config, and removing filter
+// chains only closes the connections created from them.
+TEST_F(ConnectionHandlerTest, InPlaceUpdateAndRemoveFilterChains) {
+  InSequence s;
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  Network::MockConnection* old_connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).WillOnce(Return(old_connection));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  // The update keeps the listener, so no new listener is created.
+  TestListener* updated_listener = addListener(1, true, false, "test_listener");
+  handler_->addListener(*updated_listener);
+
+  const Network::FilterChainSharedPtr new_filter_chain =
+      Network::Test::createEmptyFilterChainWithRawBufferSockets();
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(new_filter_chain.get()));
+  Network::MockConnection* new_connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).WillOnce(Return(new_connection));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  EXPECT_EQ(2UL, handler_->numConnections());
+
+  // Removing filter chains of another listener closes nothing.
+  EXPECT_CALL(dispatcher_, clearDeferredDeleteList());
+  handler_->removeFilterChains(2, {filter_chain_.get()});
+  EXPECT_EQ(2UL, handler_->numConnections());
+
+  EXPECT_CALL(*old_connection, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(dispatcher_, clearDeferredDeleteList());
+  handler_->removeFilterChains(1, {filter_chain_.get()});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  EXPECT_CALL(*new_connection, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(dispatcher_, clearDeferredDeleteList());
+  EXPECT_CALL(*listener, onDestroy());
+  handler_.reset();
+}
+
 TEST_F(ConnectionHandlerTest, DisableListener) {
   InSequence s;
 
   Network::MockListener* listener = new NiceMock<Network::MockListener>();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   TestListener* test_listener = addListener(1, false, false, "test_listener");
   EXPECT_CALL(test_listener->socket_, localAddress());
   handler_->addListener(*test_listener);
@@ -151,12 +215,12 @@ TEST_F(ConnectionHandlerTest, AddDisabledListener) {
 
   Network::MockListener* listener = new NiceMock<Network::MockListener>();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   TestListener* test_listener = addListener(1, false, false, "test_listener");
 
   EXPECT_CALL(*listener, disable());
@@ -172,12 +236,12 @@ TEST_F(ConnectionHandlerTest, DestroyCloseConnections) {
 
   Network::MockListener* listener = new NiceMock<Network::MockListener>();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   TestListener* test_listener = addListener(1, true, false, "test_listener");
   EXPECT_CALL(test_listener->socket_, localAddress());
   handler_->addListener(*test_listener);
@@ -197,12 +261,12 @@ TEST_F(ConnectionHandlerTest, CloseDuringFilterChainCreate) {
 
   Network::MockListener* listener = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   TestListener* test_listener = addListener(1, true, false, "test_listener");
   EXPECT_CALL(test_listener->socket_, localAddress());
   handler_->addListener(*test_listener);
@@ -225,12 +289,12 @@ TEST_F(ConnectionHandlerTest, CloseConnectionOnEmptyFilterChain) {
 
   Network::MockListener* listener = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   TestListener* test_listener = addListener(1, true, false, "test_listener");
   EXPECT_CALL(test_listener->socket_, localAddress());
   handler_->addListener(*test_listener);
@@ -254,7 +318,7 @@ TEST_F(ConnectionHandlerTest, FindListenerByAddress) {
       new Network::Address::Ipv4Instance("127.0.0.1", 10001));
 
   Network::MockListener* listener = new Network::MockListener();
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, true))
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, true, _))
       .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks&, bool,
                            bool) -> Network::Listener* { return listener; }));
   EXPECT_CALL(test_listener1->socket_, localAddress()).WillRepeatedly(ReturnRef(alt_address));
@@ -269,7 +333,7 @@ TEST_F(ConnectionHandlerTest, FindListenerByAddress) {
       new Network::Address::Ipv4Instance("127.0.0.2", 10001));
 
   Network::MockListener* listener2 = new Network::MockListener();
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
       .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks&, bool,
                            bool) -> Network::Listener* { return listener2; }));
   EXPECT_CALL(test_listener2->socket_, localAddress()).WillRepeatedly(ReturnRef(alt_address2));
@@ -287,7 +351,7 @@ TEST_F(ConnectionHandlerTest, FindListenerByAddress) {
   handler_->stopListeners(2);
 
   Network::MockListener* listener3 = new Network::MockListener();
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _))
       .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks&, bool,
                            bool) -> Network::Listener* { return listener3; }));
   handler_->addListener(*test_listener2);
@@ -302,12 +366,12 @@ TEST_F(ConnectionHandlerTest, NormalRedirect) {
   TestListener* test_listener1 = addListener(1, true, true, "test_listener1");
   Network::MockListener* listener1 = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks1;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, true))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks1 = &cb;
-            return listener1;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, true, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks1 = &cb;
+        return listener1;
+      }));
   Network::Address::InstanceConstSharedPtr normal_address(
       new Network::Address::Ipv4Instance("127.0.0.1", 10001));
   EXPECT_CALL(test_listener1->socket_, localAddress()).WillRepeatedly(ReturnRef(normal_address));
@@ -316,12 +380,12 @@ TEST_F(ConnectionHandlerTest, NormalRedirect) {
   TestListener* test_listener2 = addListener(1, false, false, "test_listener2");
   Network::MockListener* listener2 = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks2;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks2 = &cb;
-            return listener2;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks2 = &cb;
+        return listener2;
+      }));
   Network::Address::InstanceConstSharedPtr alt_address(
       new Network::Address::Ipv4Instance("127.0.0.2", 20002));
   EXPECT_CALL(test_listener2->socket_, localAddress()).WillRepeatedly(ReturnRef(alt_address));
@@ -358,16 +422,130 @@ TEST_F(ConnectionHandlerTest, NormalRedirect) {
   EXPECT_CALL(*listener1, onDestroy());
 }
 
+// Sockets are handed to the worker with the fewest connections of the listener before the
+// listener filters run.
+TEST_F(ConnectionHandlerTest, ExactConnectionBalancing) {
+  NiceMock<Event::MockDispatcher> dispatcher2;
+  ConnectionHandlerImpl handler2(ENVOY_LOGGER(), dispatcher2);
+
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->connection_balancer_ = std::make_unique<Network::ExactConnectionBalancerImpl>();
+  EXPECT_CALL(test_listener->socket_, localAddress()).Times(2);
+
+  Network::MockListener* listener1 = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks1;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks1 = &cb;
+        return listener1;
+      }));
+  handler_->addListener(*test_listener);
+
+  Network::MockListener* listener2 = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher2, createListener_(_, _, _, false, _)).WillOnce(Return(listener2));
+  handler2.addListener(*test_listener);
+
+  // The first worker already owns a connection, so the next socket goes to the second worker.
+  listener_callbacks1->onNewConnection(
+      Network::ConnectionPtr{new NiceMock<Network::MockConnection>()});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  EXPECT_CALL(dispatcher2, post(_));
+  EXPECT_CALL(factory_, createListenerFilterChain(_)).WillOnce(Return(true));
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).Times(0);
+  EXPECT_CALL(dispatcher2, createServerConnection_(_, _))
+      .WillOnce(Return(new NiceMock<Network::MockConnection>()));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  listener_callbacks1->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+  EXPECT_EQ(1UL, handler_->numConnections());
+  EXPECT_EQ(1UL, handler2.numConnections());
+
+  // With a tie the socket stays with the worker that accepted it.
+  EXPECT_CALL(dispatcher2, post(_)).Times(0);
+  EXPECT_CALL(factory_, createListenerFilterChain(_)).WillOnce(Return(true));
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _))
+      .WillOnce(Return(new NiceMock<Network::MockConnection>()));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  listener_callbacks1->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+  EXPECT_EQ(2UL, handler_->numConnections());
+  EXPECT_EQ(1UL, handler2.numConnections());
+
+  EXPECT_CALL(*listener2, onDestroy());
+  handler2.removeListeners(1);
+  EXPECT_CALL(*listener1, onDestroy());
+}
+
+// A socket handed over to a worker that removed the listener in the meantime is dropped.
+TEST_F(ConnectionHandlerTest, BalancedSocketForRemovedListener) {
+  ConnectionHandlerImpl handler2(ENVOY_LOGGER(), dispatcher_);
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  Network::BalancedConnectionHandler* balanced_handler = nullptr;
+  auto balancer = std::make_unique<NiceMock<Network::MockConnectionBalancer>>();
+  EXPECT_CALL(*balancer, registerHandler(_))
+      .WillOnce(Invoke([&](Network::BalancedConnectionHandler& handler) -> void {
+        balanced_handler = &handler;
+      }));
+  test_listener->connection_balancer_ = std::move(balancer);
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _)).WillOnce(Return(listener));
+  handler2.addListener(*test_listener);
+  ASSERT_NE(nullptr, balanced_handler);
+
+  // Post the socket once the listener has gone away.
+  std::function<void()> post_cb;
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(testing::SaveArg<0>(&post_cb));
+  auto accepted_socket = new NiceMock<Network::MockConnectionSocket>();
+  balanced_handler->incNumConnections();
+  balanced_handler->post(Network::ConnectionSocketPtr{accepted_socket});
+  EXPECT_CALL(*listener, onDestroy());
+  handler2.removeListeners(1);
+
+  EXPECT_CALL(factory_, createListenerFilterChain(_)).Times(0);
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).Times(0);
+  post_cb();
+  EXPECT_EQ(0UL, handler2.numConnections());
+}
+
+TEST_F(ConnectionHandlerTest, AcceptBatchStats) {
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->max_connections_to_accept_per_socket_event_ = 16;
+  EXPECT_CALL(test_listener->socket_, localAddress());
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, 16))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
+  handler_->addListener(*test_listener);
+
+  listener_callbacks->onAcceptBatchComplete(std::chrono::microseconds(5), false);
+  EXPECT_EQ(0UL, stats_store_.counter("downstream_cx_accept_backlog_overflow").value());
+  listener_callbacks->onAcceptBatchComplete(std::chrono::microseconds(50), true);
+  EXPECT_EQ(1UL, stats_store_.counter("downstream_cx_accept_backlog_overflow").value());
+
+  EXPECT_CALL(*listener, onDestroy());
+}
+
 TEST_F(ConnectionHandlerTest, FallbackToWildcardListener) {
   TestListener* test_listener1 = addListener(1, true, true, "test_listener1");
   Network::MockListener* listener1 = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks1;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, true))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks1 = &cb;
-            return listener1;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, true, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks1 = &cb;
+        return listener1;
+      }));
   Network::Address::InstanceConstSharedPtr normal_address(
       new Network::Address::Ipv4Instance("127.0.0.1", 10001));
   EXPECT_CALL(test_listener1->socket_, localAddress()).WillRepeatedly(ReturnRef(normal_address));
@@ -376,12 +554,12 @@ TEST_F(ConnectionHandlerTest, FallbackToWildcardListener) {
   TestListener* test_listener2 = addListener(1, false, false, "test_listener2");
   Network::MockListener* listener2 = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks2;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks2 = &cb;
-            return listener2;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks2 = &cb;
+        return listener2;
+      }));
   Network::Address::InstanceConstSharedPtr any_address = Network::Utility::getIpv4AnyAddress();
   EXPECT_CALL(test_listener2->socket_, localAddress()).WillRepeatedly(ReturnRef(any_address));
   handler_->addListener(*test_listener2);
@@ -424,12 +602,12 @@ TEST_F(ConnectionHandlerTest, WildcardListenerWithOriginalDst) {
   TestListener* test_listener1 = addListener(1, true, true, "test_listener1");
   Network::MockListener* listener1 = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks1;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, true))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks1 = &cb;
-            return listener1;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, true, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks1 = &cb;
+        return listener1;
+      }));
   Network::Address::InstanceConstSharedPtr normal_address(
       new Network::Address::Ipv4Instance("127.0.0.1", 80));
   // Original dst address nor port number match that of the listener's address.
@@ -470,12 +648,12 @@ TEST_F(ConnectionHandlerTest, WildcardListenerWithNoOriginalDst) {
   TestListener* test_listener1 = addListener(1, true, true, "test_listener1");
   Network::MockListener* listener1 = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks1;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, true))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks1 = &cb;
-            return listener1;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, true, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks1 = &cb;
+        return listener1;
+      }));
   Network::Address::InstanceConstSharedPtr normal_address(
       new Network::Address::Ipv4Instance("127.0.0.1", 80));
   Network::Address::InstanceConstSharedPtr any_address = Network::Utility::getAddressWithPort(
@@ -508,12 +686,12 @@ TEST_F(ConnectionHandlerTest, TransportProtocolDefault) {
   TestListener* test_listener = addListener(1, true, false, "test_listener");
   Network::MockListener* listener = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   EXPECT_CALL(test_listener->socket_, localAddress());
   handler_->addListener(*test_listener);
 
@@ -531,12 +709,12 @@ TEST_F(ConnectionHandlerTest, TransportProtocolCustom) {
   TestListener* test_listener = addListener(1, true, false, "test_listener");
   Network::MockListener* listener = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   EXPECT_CALL(test_listener->socket_, localAddress());
   handler_->addListener(*test_listener);
 
@@ -568,12 +746,12 @@ TEST_F(ConnectionHandlerTest, ListenerFilterTimeout) {
   TestListener* test_listener = addListener(1, true, false, "test_listener");
   Network::MockListener* listener = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   EXPECT_CALL(test_listener->socket_, localAddress());
   handler_->addListener(*test_listener);
 
@@ -609,12 +787,12 @@ TEST_F(ConnectionHandlerTest, ListenerFilterTimeoutResetOnSuccess) {
   TestListener* test_listener = addListener(1, true, false, "test_listener");
   Network::MockListener* listener = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   EXPECT_CALL(test_listener->socket_, localAddress());
   handler_->addListener(*test_listener);
 
@@ -650,12 +828,12 @@ TEST_F(ConnectionHandlerTest, ListenerFilterDisabledTimeout) {
       addListener(1, true, false, "test_listener", std::chrono::milliseconds());
   Network::MockListener* listener = new Network::MockListener();
   Network::ListenerCallbacks* listener_callbacks;
-  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
-      .WillOnce(Invoke(
-          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
-            listener_callbacks = &cb;
-            return listener;
-          }));
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false, _))
+      .WillOnce(Invoke([&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool,
+                           uint32_t) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
   EXPECT_CALL(test_listener->socket_, localAddress());
   handler_->addListener(*test_listener);
 
@@ -676,6 +854,45 @@ TEST_F(ConnectionHandlerTest, ListenerFilterDisabledTimeout) {
   EXPECT_CALL(*listener, onDestroy());
 }
 
+// A UDP listener hands its datagrams to the read filter created by the filter chain factory.
+TEST_F(ConnectionHandlerTest, UdpListener) {
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  ON_CALL(test_listener->socket_, socketType())
+      .WillByDefault(Return(Network::Address::SocketType::Datagram));
+
+  Network::MockUdpListener* listener = new NiceMock<Network::MockUdpListener>();
+  Network::UdpListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createUdpListener_(_, _))
+      .WillOnce(Invoke([&](Network::Socket&,
+                           Network::UdpListenerCallbacks& cb) -> Network::UdpListener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
+  Network::MockUdpListenerReadFilter* read_filter = new Network::MockUdpListenerReadFilter();
+  EXPECT_CALL(factory_, createUdpListenerFilterChain(_, _))
+      .WillOnce(Invoke([&](Network::UdpListenerFilterManager& filter_manager,
+                           Network::UdpReadFilterCallbacks& callbacks) -> bool {
+        EXPECT_EQ(listener, &callbacks.udpListener());
+        filter_manager.addReadFilter(Network::UdpListenerReadFilterPtr{read_filter});
+        return true;
+      }));
+  handler_->addListener(*test_listener);
+
+  Network::UdpData data;
+  EXPECT_CALL(*read_filter, onData(_));
+  listener_callbacks->onData(data);
+  EXPECT_CALL(*read_filter, onReceiveBatchComplete(1));
+  listener_callbacks->onReceiveBatchComplete(1);
+
+  EXPECT_CALL(*listener, disable());
+  handler_->disableListeners();
+  EXPECT_CALL(*listener, enable());
+  handler_->enableListeners();
+
+  EXPECT_CALL(*listener, onDestroy());
+  handler_->removeListeners(1);
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy
@@ -65,6 +65,42 @@ TEST_F(DrainManagerImplTest, Default) {
   EXPECT_TRUE(drain_manager.drainClose());
 }
 
+TEST_F(DrainManagerImplTest, RateLimited) {
+  // 2 workers closing at most 3 connections per second each.
+  ON_CALL(server_.options_, drainRatePerWorker()).WillByDefault(Return(3));
+  ON_CALL(server_.options_, concurrency()).WillByDefault(Return(2));
+  ON_CALL(server_.options_, drainTime()).WillByDefault(Return(std::chrono::seconds(2)));
+  ON_CALL(server_, healthCheckFailed()).WillByDefault(Return(false));
+  ON_CALL(server_.random_, random()).WillByDefault(Return(0));
+  DrainManagerImpl drain_manager(server_, envoy::api::v2::Listener_DrainType_DEFAULT);
+
+  Event::MockTimer* drain_timer = new Event::MockTimer(&server_.dispatcher_);
+  EXPECT_CALL(*drain_timer, enableTimer(_));
+  drain_manager.startDrainSequence(nullptr);
+
+  // Only 6 connections are drain closed in the first second.
+  for (int i = 0; i < 6; i++) {
+    EXPECT_TRUE(drain_manager.drainClose());
+  }
+  EXPECT_FALSE(drain_manager.drainClose());
+  EXPECT_FALSE(drain_manager.drainClose());
+  EXPECT_EQ(6U, server_.stats_store_.counter("server.drain_close").value());
+  EXPECT_EQ(2U, server_.stats_store_.counter("server.drain_close_rate_limited").value());
+
+  // The budget is refilled, without what was left of the previous second, on the next tick.
+  drain_timer->callback_();
+  for (int i = 0; i < 6; i++) {
+    EXPECT_TRUE(drain_manager.drainClose());
+  }
+  EXPECT_FALSE(drain_manager.drainClose());
+  EXPECT_EQ(12U, server_.stats_store_.counter("server.drain_close").value());
+  EXPECT_EQ(3U, server_.stats_store_.counter("server.drain_close_rate_limited").value());
+
+  // Failing health checks still drain close every connection.
+  EXPECT_CALL(server_, healthCheckFailed()).WillOnce(Return(true));
+  EXPECT_TRUE(drain_manager.drainClose());
+}
+
 TEST_F(DrainManagerImplTest, ModifyOnly) {
   InSequence s;
   DrainManagerImpl drain_manager(server_, envoy::api::v2::Listener_DrainType_MODIFY_ONLY);
@@ -12,6 +12,7 @@
 #include "test/mocks/common.h"
 #include "test/mocks/server/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/test_common/logging.h"
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
@@ -154,9 +155,12 @@ TEST_F(GuardDogMissTest, MissTest) {
   time_system_.sleep(std::chrono::milliseconds(300));
   gd.forceCheckForTest();
   EXPECT_EQ(0UL, stats_store_.counter("server.watchdog_miss").value());
-  // This should push it past the 500ms limit:
+  // This should push it past the 500ms limit, and log which thread stalled:
   time_system_.sleep(std::chrono::milliseconds(250));
-  gd.forceCheckForTest();
+  EXPECT_LOG_CONTAINS("warn",
+                      "GuardDog: thread " + unpet_dog->threadId().debugString() +
+                          " has not touched its watchdog for 550 ms (miss)",
+                      gd.forceCheckForTest());
   EXPECT_EQ(1UL, stats_store_.counter("server.watchdog_miss").value());
   gd.stopWatching(unpet_dog);
   unpet_dog = nullptr;
@@ -93,6 +93,34 @@ TEST_F(HotRestartImplTest, versionString) {
   }
 }
 
+// Transferring stats leaves them on the heap, which removes them from the shared memory and the
+// version string.
+TEST_F(HotRestartImplTest, StatsTransfer) {
+  std::string version;
+  uint64_t shared_memory_size;
+  {
+    setup();
+    version = hot_restart_->version();
+    shared_memory_size = buffer_.size();
+    EXPECT_TRUE(hot_restart_->statsAllocator().requiresBoundedStatNameSize());
+    TearDown();
+  }
+
+  options_.hot_restart_stats_transfer_ = true;
+  setup();
+  EXPECT_NE(version, hot_restart_->version());
+  EXPECT_EQ(HotRestartImpl::hotRestartVersion(options_.maxStats(),
+                                              stats_options_.maxNameLength(), true),
+            hot_restart_->version());
+  EXPECT_TRUE(absl::EndsWith(hot_restart_->version(), ".transfer"));
+  EXPECT_LT(buffer_.size(), shared_memory_size);
+  EXPECT_FALSE(hot_restart_->statsAllocator().requiresBoundedStatNameSize());
+  Stats::CounterSharedPtr counter =
+      hot_restart_->statsAllocator().makeCounter("a.long.counter.name", "", {});
+  counter->inc();
+  EXPECT_EQ(1, counter->value());
+}
+
 // Check consistency of internal raw stat representation by comparing hash of
 // memory contents against a previously recorded value.
 TEST_F(HotRestartImplTest, Consistency) {
@@ -106,24 +134,24 @@ TEST_F(HotRestartImplTest, Consistency) {
   const uint64_t max_name_length = stats_options_.maxNameLength();
 
   const std::string name_1(max_name_length, 'A');
-  Stats::RawStatData* stat_1 = hot_restart_->statsAllocator().alloc(name_1);
+  Stats::RawStatData* stat_1 = hot_restart_->rawStatsAllocator().alloc(name_1);
   const uint64_t stat_size = sizeof(Stats::RawStatData) + max_name_length;
   const std::string stat_hex_dump_1 = Hex::encode(reinterpret_cast<uint8_t*>(stat_1), stat_size);
   EXPECT_EQ(HashUtil::xxHash64(stat_hex_dump_1), expected_hash);
   EXPECT_EQ(name_1, stat_1->key());
-  hot_restart_->statsAllocator().free(*stat_1);
+  hot_restart_->rawStatsAllocator().free(*stat_1);
 }
 
 TEST_F(HotRestartImplTest, crossAlloc) {
   setup();
 
-  Stats::RawStatData* stat1 = hot_restart_->statsAllocator().alloc("stat1");
-  Stats::RawStatData* stat2 = hot_restart_->statsAllocator().alloc("stat2");
-  Stats::RawStatData* stat3 = hot_restart_->statsAllocator().alloc("stat3");
-  Stats::RawStatData* stat4 = hot_restart_->statsAllocator().alloc("stat4");
-  Stats::RawStatData* stat5 = hot_restart_->statsAllocator().alloc("stat5");
-  hot_restart_->statsAllocator().free(*stat2);
-  hot_restart_->statsAllocator().free(*stat4);
+  Stats::RawStatData* stat1 = hot_restart_->rawStatsAllocator().alloc("stat1");
+  Stats::RawStatData* stat2 = hot_restart_->rawStatsAllocator().alloc("stat2");
+  Stats::RawStatData* stat3 = hot_restart_->rawStatsAllocator().alloc("stat3");
+  Stats::RawStatData* stat4 = hot_restart_->rawStatsAllocator().alloc("stat4");
+  Stats::RawStatData* stat5 = hot_restart_->rawStatsAllocator().alloc("stat5");
+  hot_restart_->rawStatsAllocator().free(*stat2);
+  hot_restart_->rawStatsAllocator().free(*stat4);
   stat2 = nullptr;
   stat4 = nullptr;
 
@@ -133,9 +161,9 @@ TEST_F(HotRestartImplTest, crossAlloc) {
       .WillOnce(Return(Api::SysCallPtrResult{buffer_.data(), 0}));
   EXPECT_CALL(os_sys_calls_, bind(_, _, _));
   HotRestartImpl hot_restart2(options_, symbol_table_);
-  Stats::RawStatData* stat1_prime = hot_restart2.statsAllocator().alloc("stat1");
-  Stats::RawStatData* stat3_prime = hot_restart2.statsAllocator().alloc("stat3");
-  Stats::RawStatData* stat5_prime = hot_restart2.statsAllocator().alloc("stat5");
+  Stats::RawStatData* stat1_prime = hot_restart2.rawStatsAllocator().alloc("stat1");
+  Stats::RawStatData* stat3_prime = hot_restart2.rawStatsAllocator().alloc("stat3");
+  Stats::RawStatData* stat5_prime = hot_restart2.rawStatsAllocator().alloc("stat5");
   EXPECT_EQ(stat1, stat1_prime);
   EXPECT_EQ(stat3, stat3_prime);
   EXPECT_EQ(stat5, stat5_prime);
@@ -145,9 +173,9 @@ TEST_F(HotRestartImplTest, allocFail) {
   EXPECT_CALL(options_, maxStats()).WillRepeatedly(Return(2));
   setup();
 
-  Stats::RawStatData* s1 = hot_restart_->statsAllocator().alloc("1");
-  Stats::RawStatData* s2 = hot_restart_->statsAllocator().alloc("2");
-  Stats::RawStatData* s3 = hot_restart_->statsAllocator().alloc("3");
+  Stats::RawStatData* s1 = hot_restart_->rawStatsAllocator().alloc("1");
+  Stats::RawStatData* s2 = hot_restart_->rawStatsAllocator().alloc("2");
+  Stats::RawStatData* s3 = hot_restart_->rawStatsAllocator().alloc("3");
   EXPECT_NE(s1, nullptr);
   EXPECT_NE(s2, nullptr);
   EXPECT_EQ(s3, nullptr);
@@ -178,7 +206,7 @@ TEST_P(HotRestartImplAlignmentTest, objectAlignment) {
 
   std::set<Stats::RawStatData*> used;
   for (uint64_t i = 0; i < num_stats_; i++) {
-    Stats::RawStatData* stat = hot_restart_->statsAllocator().alloc(fmt::format("stat {}", i));
+    Stats::RawStatData* stat = hot_restart_->rawStatsAllocator().alloc(fmt::format("stat {}", i));
     EXPECT_TRUE((reinterpret_cast<uintptr_t>(stat) % alignof(decltype(*stat))) == 0);
     EXPECT_TRUE(used.find(stat) == used.end());
     used.insert(stat);
@@ -201,7 +229,7 @@ TEST_P(HotRestartImplAlignmentTest, objectOverlap) {
                                    i)
                            .substr(0, stats_options_.maxNameLength());
     TestStat ts;
-    ts.stat_ = hot_restart_->statsAllocator().alloc(name);
+    ts.stat_ = hot_restart_->rawStatsAllocator().alloc(name);
     ts.name_ = ts.stat_->name_;
     ts.index_ = i;
 
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <fstream>
+#include <limits>
 #include <regex>
 #include <unordered_map>
 
@@ -9,8 +10,10 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/stats.h"
 
+#include "common/common/perf_annotation.h"
 #include "common/http/message_impl.h"
 #include "common/json/json_loader.h"
+#include "common/profiler/cpu_sampler.h"
 #include "common/profiler/profiler.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
@@ -34,7 +37,9 @@
 
 using testing::_;
 using testing::AllOf;
+using testing::ElementsAre;
 using testing::Ge;
+using testing::Gt;
 using testing::HasSubstr;
 using testing::InSequence;
 using testing::Invoke;
@@ -655,6 +660,51 @@ TEST_P(AdminInstanceTest, AdminCpuProfiler) {
   EXPECT_FALSE(Profiler::Cpu::profilerEnabled());
 }
 
+TEST_P(AdminInstanceTest, AdminCpuSampler) {
+  Buffer::OwnedImpl data;
+  Http::HeaderMapImpl header_map;
+
+  EXPECT_EQ(Http::Code::BadRequest, postCallback("/cpuprofiler/sampling", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest,
+            postCallback("/cpuprofiler/sampling?enable=y&hz=0", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest,
+            postCallback("/cpuprofiler/sampling?enable=y&hz=1001", header_map, data));
+  EXPECT_FALSE(Profiler::CpuSampler::running());
+
+  EXPECT_EQ(Http::Code::OK, postCallback("/cpuprofiler/sampling?enable=y&hz=50", header_map, data));
+  EXPECT_TRUE(Profiler::CpuSampler::running());
+  // The gperftools profiler also relies on SIGPROF.
+  EXPECT_EQ(Http::Code::BadRequest, postCallback("/cpuprofiler?enable=y", header_map, data));
+
+  Http::HeaderMapImpl samples_headers;
+  Buffer::OwnedImpl samples;
+  EXPECT_EQ(Http::Code::OK, getCallback("/cpuprofiler/samples", samples_headers, samples));
+  EXPECT_EQ("application/octet-stream", samples_headers.ContentType()->value().getStringView());
+  // The profile holds at least the header and the trailer.
+  EXPECT_GE(samples.length(), 8 * sizeof(uintptr_t));
+
+  EXPECT_EQ(Http::Code::OK, postCallback("/cpuprofiler/sampling?enable=n", header_map, data));
+  EXPECT_FALSE(Profiler::CpuSampler::running());
+}
+
+TEST_P(AdminInstanceTest, AdminPerfAnnotation) {
+  Buffer::OwnedImpl data;
+  Http::HeaderMapImpl header_map;
+
+  EXPECT_EQ(Http::Code::BadRequest, postCallback("/perf_annotation", header_map, data));
+  EXPECT_EQ(Http::Code::OK, postCallback("/perf_annotation?enable=y", header_map, data));
+  EXPECT_TRUE(PerfAnnotationContext::enabled());
+  PerfAnnotationContext::getOrCreate()->record(std::chrono::microseconds(10), "alpha", "0");
+
+  Buffer::OwnedImpl dump;
+  EXPECT_EQ(Http::Code::OK, getCallback("/perf_annotation/dump", header_map, dump));
+  EXPECT_NE(std::string::npos, dump.toString().find(" alpha ")) << dump.toString();
+
+  EXPECT_EQ(Http::Code::OK, postCallback("/perf_annotation?enable=n", header_map, data));
+  EXPECT_FALSE(PerfAnnotationContext::enabled());
+  PERF_CLEAR();
+}
+
 TEST_P(AdminInstanceTest, AdminHeapProfilerOnRepeatedRequest) {
   Buffer::OwnedImpl data;
   Http::HeaderMapImpl header_map;
@@ -882,7 +932,57 @@ TEST_P(AdminInstanceTest, ConfigDumpMaintainsOrder) {
   }
 }
 
+TEST_P(AdminInstanceTest, ConfigDumpFilter) {
+  auto bootstrap_entry = admin_.getConfigTracker().add("bootstrap", [] {
+    auto msg = std::make_unique<ProtobufWkt::StringValue>();
+    msg->set_value("bootstrap_config");
+    return msg;
+  });
+  auto listener_entry = admin_.getConfigTracker().add("listeners", [] {
+    auto msg = std::make_unique<ProtobufWkt::StringValue>();
+    msg->set_value("listeners_config");
+    return msg;
+  });
+  auto route_entry = admin_.getConfigTracker().add("routes", [] {
+    auto msg = std::make_unique<ProtobufWkt::StringValue>();
+    msg->set_value("routes_config");
+    return msg;
+  });
+  const std::string expected_json = R"EOF({
+ "configs": [
+  {
+   "@type": "type.googleapis.com/google.protobuf.StringValue",
+   "value": "bootstrap_config"
+  },
+  {
+   "@type": "type.googleapis.com/google.protobuf.StringValue",
+   "value": "routes_config"
+  }
+ ]
+}
+)EOF";
+  {
+    Buffer::OwnedImpl response;
+    Http::HeaderMapImpl header_map;
+    EXPECT_EQ(Http::Code::OK,
+              getCallback("/config_dump?filter=^(bootstrap|routes)$", header_map, response));
+    EXPECT_EQ(expected_json, response.toString());
+  }
+  {
+    Buffer::OwnedImpl response;
+    Http::HeaderMapImpl header_map;
+    EXPECT_EQ(Http::Code::OK, getCallback("/config_dump?filter=secrets", header_map, response));
+    EXPECT_EQ("{\n}\n", response.toString());
+  }
+  {
+    Buffer::OwnedImpl response;
+    Http::HeaderMapImpl header_map;
+    EXPECT_EQ(Http::Code::BadRequest, getCallback("/config_dump?filter=(", header_map, response));
+  }
+}
+
 TEST_P(AdminInstanceTest, Memory) {
+  server_.stats().counter("memory.test_counter");
   Http::HeaderMapImpl header_map;
   Buffer::OwnedImpl response;
   EXPECT_EQ(Http::Code::OK, getCallback("/memory", header_map, response));
@@ -894,7 +994,9 @@ TEST_P(AdminInstanceTest, Memory) {
                     Property(&envoy::admin::v2alpha::Memory::heap_size, Ge(0)),
                     Property(&envoy::admin::v2alpha::Memory::pageheap_unmapped, Ge(0)),
                     Property(&envoy::admin::v2alpha::Memory::pageheap_free, Ge(0)),
-                    Property(&envoy::admin::v2alpha::Memory::total_thread_cache, Ge(0))));
+                    Property(&envoy::admin::v2alpha::Memory::total_thread_cache, Ge(0)),
+                    Property(&envoy::admin::v2alpha::Memory::num_stats, Ge(1)),
+                    Property(&envoy::admin::v2alpha::Memory::stat_name_bytes, Gt(0))));
 }
 
 TEST_P(AdminInstanceTest, ContextThatReturnsNullCertDetails) {
@@ -1158,6 +1260,81 @@ TEST_P(AdminInstanceTest, ClustersJson) {
   EXPECT_THROW(MessageUtil::loadFromJson(text_output, failed_conversion_proto), EnvoyException);
 }
 
+TEST_P(AdminInstanceTest, ClustersFilterAndPagination) {
+  Upstream::ClusterManager::ClusterInfoMap cluster_map;
+  ON_CALL(server_.cluster_manager_, clusters()).WillByDefault(ReturnPointee(&cluster_map));
+  NiceMock<Upstream::MockClusterMockPrioritySet> cluster_a;
+  NiceMock<Upstream::MockClusterMockPrioritySet> cluster_b;
+  NiceMock<Upstream::MockClusterMockPrioritySet> cluster_c;
+  cluster_a.info_->name_ = "cluster_a";
+  cluster_b.info_->name_ = "cluster_b";
+  cluster_c.info_->name_ = "cluster_c";
+  cluster_map.emplace("cluster_c", cluster_c);
+  cluster_map.emplace("cluster_a", cluster_a);
+  cluster_map.emplace("cluster_b", cluster_b);
+
+  auto cluster_names = [this](absl::string_view path) {
+    Buffer::OwnedImpl response;
+    Http::HeaderMapImpl header_map;
+    EXPECT_EQ(Http::Code::OK, getCallback(path, header_map, response));
+    envoy::admin::v2alpha::Clusters clusters;
+    MessageUtil::loadFromJson(response.toString(), clusters);
+    std::vector<std::string> names;
+    for (const auto& cluster_status : clusters.cluster_statuses()) {
+      names.push_back(cluster_status.name());
+    }
+    return names;
+  };
+
+  // Clusters are listed in name order, which the offset and limit page through.
+  EXPECT_THAT(cluster_names("/clusters?format=json"),
+              ElementsAre("cluster_a", "cluster_b", "cluster_c"));
+  EXPECT_THAT(cluster_names("/clusters?format=json&filter=_[bc]$"),
+              ElementsAre("cluster_b", "cluster_c"));
+  EXPECT_THAT(cluster_names("/clusters?format=json&offset=1&limit=1"), ElementsAre("cluster_b"));
+  EXPECT_THAT(cluster_names("/clusters?format=json&filter=_[bc]$&offset=1&limit=5"),
+              ElementsAre("cluster_c"));
+  EXPECT_THAT(cluster_names("/clusters?format=json&offset=3"), ElementsAre());
+
+  Buffer::OwnedImpl response;
+  Http::HeaderMapImpl header_map;
+  EXPECT_EQ(Http::Code::OK, getCallback("/clusters?filter=cluster_a", header_map, response));
+  EXPECT_THAT(response.toString(), HasSubstr("cluster_a::added_via_api::false\n"));
+  EXPECT_EQ(std::string::npos, response.toString().find("cluster_b"));
+  EXPECT_EQ(Http::Code::BadRequest, getCallback("/clusters?filter=(", header_map, response));
+  EXPECT_EQ(Http::Code::BadRequest, getCallback("/clusters?limit=all", header_map, response));
+}
+
+TEST_P(AdminInstanceTest, ClustersFormatterChunks) {
+  Upstream::ClusterManager::ClusterInfoMap cluster_map;
+  std::vector<std::unique_ptr<NiceMock<Upstream::MockClusterMockPrioritySet>>> clusters;
+  for (int i = 0; i < 5; ++i) {
+    clusters.push_back(std::make_unique<NiceMock<Upstream::MockClusterMockPrioritySet>>());
+    clusters.back()->info_->name_ = fmt::format("cluster_{}", i);
+    cluster_map.emplace(clusters.back()->info_->name_, *clusters.back());
+  }
+
+  for (const bool json : {false, true}) {
+    Buffer::OwnedImpl expected;
+    EXPECT_TRUE(ClustersFormatter(cluster_map, json, absl::nullopt, 0, 0)
+                    .next(expected, std::numeric_limits<uint64_t>::max()));
+
+    // With a tiny chunk size every cluster ends up in its own chunk.
+    ClustersFormatter formatter(cluster_map, json, absl::nullopt, 0, 0);
+    std::string output;
+    uint32_t chunks = 0;
+    bool done = false;
+    while (!done) {
+      Buffer::OwnedImpl chunk;
+      done = formatter.next(chunk, 1);
+      output += chunk.toString();
+      ++chunks;
+    }
+    EXPECT_EQ(5U, chunks);
+    EXPECT_EQ(expected.toString(), output);
+  }
+}
+
 TEST_P(AdminInstanceTest, GetRequest) {
   EXPECT_CALL(server_.options_, toCommandLineOptions()).WillRepeatedly(Invoke([] {
     Server::CommandLineOptionsPtr command_line_options =
@@ -1549,5 +1726,56 @@ TEST_F(PrometheusStatsFormatterTest, OutputWithUsedOnlyHistogram) {
   }
 }
 
+TEST_F(PrometheusStatsFormatterTest, OutputWithPrefix) {
+  addCounter("cluster.test_1.upstream_cx_total", {{"a.tag-name", "a.tag-value"}});
+  addCounter("http.test_2.downstream_cx_total", {{"another_tag_name", "another_tag-value"}});
+  addGauge("cluster.test_3.upstream_cx_active", {});
+  addGauge("http.test_4.downstream_cx_active", {});
+
+  Buffer::OwnedImpl response;
+  auto size = PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_, response,
+                                                          false, std::string("cluster."));
+  EXPECT_EQ(2UL, size);
+
+  const std::string expected_output = R"EOF(# TYPE envoy_cluster_test_1_upstream_cx_total counter
+envoy_cluster_test_1_upstream_cx_total{a_tag_name="a.tag-value"} 0
+# TYPE envoy_cluster_test_3_upstream_cx_active gauge
+envoy_cluster_test_3_upstream_cx_active{} 0
+)EOF";
+
+  EXPECT_EQ(expected_output, response.toString());
+}
+
+TEST_F(PrometheusStatsFormatterTest, GeneratorChunks) {
+  for (int i = 0; i < 10; ++i) {
+    addCounter(fmt::format("cluster.test_{}.upstream_cx_total", i), {{"a.tag-name", "value"}});
+    addGauge(fmt::format("cluster.test_{}.upstream_cx_active", i), {});
+  }
+
+  Buffer::OwnedImpl expected;
+  EXPECT_EQ(20UL, PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_,
+                                                              expected, false));
+
+  auto name_cache = std::make_shared<PrometheusStatsFormatter::NameCache>();
+  PrometheusStatsFormatter::Generator generator(
+      std::vector<Stats::CounterSharedPtr>(counters_), std::vector<Stats::GaugeSharedPtr>(gauges_),
+      std::vector<Stats::ParentHistogramSharedPtr>(histograms_), false, absl::nullopt, name_cache);
+
+  // Each call returns at least the requested number of bytes until the output runs out, so with a
+  // tiny chunk size every metric ends up in its own chunk.
+  std::string output;
+  uint32_t chunks = 0;
+  bool done = false;
+  while (!done) {
+    Buffer::OwnedImpl chunk;
+    done = generator.next(chunk, 1);
+    output += chunk.toString();
+    ++chunks;
+  }
+  EXPECT_EQ(20UL, chunks);
+  EXPECT_EQ(20UL, generator.metricTypes());
+  EXPECT_EQ(expected.toString(), output);
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -60,8 +60,9 @@ class ListenerManagerImplTest : public testing::Test {
 protected:
   ListenerManagerImplTest() : api_(Api::createApiForTest()) {
     ON_CALL(server_, api()).WillByDefault(ReturnRef(*api_));
-    EXPECT_CALL(worker_factory_, createWorker_()).WillOnce(Return(worker_));
-    manager_ = std::make_unique<ListenerManagerImpl>(server_, listener_factory_, worker_factory_);
+    EXPECT_CALL(worker_factory_, createWorker_(_)).WillOnce(Return(worker_));
+    manager_ =
+        std::make_unique<ListenerManagerImpl>(server_, listener_factory_, worker_factory_, false);
   }
 
   /**
@@ -145,6 +146,14 @@ public:
               return ProdListenerComponentFactory::createListenerFilterFactoryList_(filters,
                                                                                     context);
             }));
+    ON_CALL(listener_factory_, createUdpListenerFilterFactoryList(_, _))
+        .WillByDefault(Invoke(
+            [](const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
+               Configuration::ListenerFactoryContext& context)
+                -> std::vector<Network::UdpListenerFilterFactoryCb> {
+              return ProdListenerComponentFactory::createUdpListenerFilterFactoryList_(filters,
+                                                                                       context);
+            }));
     socket_ = std::make_unique<NiceMock<Network::MockConnectionSocket>>();
     local_address_.reset(new Network::Address::Ipv4Instance("127.0.0.1", 1234));
     remote_address_.reset(new Network::Address::Ipv4Instance("127.0.0.1", 1234));
@@ -235,11 +244,11 @@ public:
   void
   expectCreateListenSocket(const envoy::api::v2::core::SocketOption::SocketState& expected_state,
                            Network::Socket::Options::size_type expected_num_options) {
-    EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true))
+    EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _))
         .WillOnce(Invoke([this, expected_num_options, &expected_state](
                              Network::Address::InstanceConstSharedPtr, Network::Address::SocketType,
-                             const Network::Socket::OptionsSharedPtr& options,
-                             bool) -> Network::SocketSharedPtr {
+                             const Network::Socket::OptionsSharedPtr& options, bool,
+                             uint32_t) -> Network::SocketSharedPtr {
           EXPECT_NE(options.get(), nullptr);
           EXPECT_EQ(options->size(), expected_num_options);
           EXPECT_TRUE(
@@ -308,7 +317,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, EmptyFilter) {
   )EOF";
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromJson(json), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
   EXPECT_EQ(std::chrono::milliseconds(15000),
@@ -323,7 +332,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, DefaultListenerPerConnectionBuffe
   }
   )EOF";
 
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromJson(json), "", true);
   EXPECT_EQ(1024 * 1024U, manager_->listeners().back().get().perConnectionBufferLimitBytes());
 }
@@ -337,7 +346,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SetListenerPerConnectionBufferLim
   }
   )EOF";
 
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromJson(json), "", true);
   EXPECT_EQ(8192U, manager_->listeners().back().get().perConnectionBufferLimitBytes());
 }
@@ -360,7 +369,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SslContext) {
   )EOF",
                                                        Network::Address::IpVersion::v4);
 
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromJson(json), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -386,7 +395,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, UdpAddress) {
 
   EXPECT_CALL(server_.random_, uuid());
   EXPECT_CALL(listener_factory_,
-              createListenSocket(_, Network::Address::SocketType::Datagram, _, true));
+              createListenSocket(_, Network::Address::SocketType::Datagram, _, true, 0));
   manager_->addOrUpdateListener(listener_proto, "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 }
@@ -468,7 +477,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, StatsScopeTest) {
   }
   )EOF";
 
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, false));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, false, _));
   manager_->addOrUpdateListener(parseListenerFromJson(json), "", true);
   manager_->listeners().front().get().listenerScope().counter("foo").inc();
 
@@ -486,7 +495,7 @@ TEST_F(ListenerManagerImplTest, NotDefaultListenerFiltersTimeout) {
     listener_filters_timeout: 0s
   )EOF";
 
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(json), "", true));
   EXPECT_EQ(std::chrono::milliseconds(),
             manager_->listeners().front().get().listenerFiltersTimeout());
@@ -507,7 +516,7 @@ TEST_F(ListenerManagerImplTest, ModifyOnlyDrainType) {
 
   ListenerHandle* listener_foo =
       expectListenerCreate(false, envoy::api::v2::Listener_DrainType_MODIFY_ONLY);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_yaml), "", true));
   checkStats(1, 0, 0, 0, 1, 0);
 
@@ -528,7 +537,7 @@ TEST_F(ListenerManagerImplTest, AddListenerAddressNotMatching) {
   )EOF";
 
   ListenerHandle* listener_foo = expectListenerCreate(false);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", true));
   checkStats(1, 0, 0, 0, 1, 0);
 
@@ -578,7 +587,7 @@ TEST_F(ListenerManagerImplTest, AddListenerOnIpv4OnlySetups) {
   EXPECT_CALL(os_sys_calls, socket(AF_INET, _, 0)).WillOnce(Return(Api::SysCallIntResult{5, 0}));
   EXPECT_CALL(os_sys_calls, socket(AF_INET6, _, 0)).WillOnce(Return(Api::SysCallIntResult{-1, 0}));
 
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
 
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", true));
   checkStats(1, 0, 0, 0, 1, 0);
@@ -608,13 +617,166 @@ TEST_F(ListenerManagerImplTest, AddListenerOnIpv6OnlySetups) {
   EXPECT_CALL(os_sys_calls, socket(AF_INET, _, 0)).WillOnce(Return(Api::SysCallIntResult{-1, 0}));
   EXPECT_CALL(os_sys_calls, socket(AF_INET6, _, 0)).WillOnce(Return(Api::SysCallIntResult{5, 0}));
 
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
 
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", true));
   checkStats(1, 0, 0, 0, 1, 0);
   EXPECT_CALL(*listener_foo, onDestroy());
 }
 
+TEST_F(ListenerManagerImplTest, DispatcherStats) {
+  manager_.reset();
+  worker_ = new MockWorker();
+  EXPECT_CALL(worker_factory_, createWorker_(_)).WillOnce(Return(worker_));
+  EXPECT_CALL(*worker_, initializeStats(_, "listener_manager.worker_0."));
+  manager_ =
+      std::make_unique<ListenerManagerImpl>(server_, listener_factory_, worker_factory_, true);
+}
+
+class ListenerManagerImplReusePortTest : public ListenerManagerImplTest {
+protected:
+  ListenerManagerImplReusePortTest() {
+    // Replace the manager with one that runs two workers.
+    manager_.reset();
+    worker_ = new MockWorker();
+    server_.options_.concurrency_ = 2;
+    EXPECT_CALL(worker_factory_, createWorker_(_))
+        .WillOnce(Return(worker_))
+        .WillOnce(Return(worker2_));
+    manager_ =
+        std::make_unique<ListenerManagerImpl>(server_, listener_factory_, worker_factory_, false);
+  }
+
+  envoy::api::v2::Listener reusePortListener(bool reuse_port) {
+    auto listener = parseListenerFromV2Yaml(R"EOF(
+      name: foo
+      address:
+        socket_address: { address: 127.0.0.1, port_value: 1234 }
+      filter_chains:
+      - filters:
+    )EOF");
+    listener.set_reuse_port(reuse_port);
+    return listener;
+  }
+
+  MockWorker* worker2_ = new MockWorker();
+};
+
+// Make sure that every worker of a reuse_port listener listens on a socket of its own, and that the
+// sockets can be found for hot restart.
+TEST_F(ListenerManagerImplReusePortTest, SocketPerWorker) {
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  auto worker2_socket = std::make_shared<NiceMock<Network::MockListenSocket>>();
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, 0));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, 1))
+      .WillOnce(Return(worker2_socket));
+  EXPECT_TRUE(manager_->addOrUpdateListener(reusePortListener(true), "", true));
+
+  const Network::Address::Instance& address = *listener_factory_.socket_->localAddress();
+  EXPECT_EQ(listener_factory_.socket_.get(), manager_->findListenSocket(address, 0));
+  EXPECT_EQ(worker2_socket.get(), manager_->findListenSocket(address, 1));
+  EXPECT_EQ(nullptr, manager_->findListenSocket(address, 2));
+  EXPECT_EQ(nullptr, manager_->findListenSocket(Network::Address::Ipv4Instance("1.2.3.4", 80), 0));
+
+  EXPECT_CALL(*worker_, addListener(_, _))
+      .WillOnce(Invoke([&](Network::ListenerConfig& config, Worker::AddListenerCompletion) {
+        EXPECT_EQ(listener_factory_.socket_.get(), &config.socket());
+      }));
+  EXPECT_CALL(*worker_, start(_));
+  EXPECT_CALL(*worker2_, addListener(_, _))
+      .WillOnce(Invoke([&](Network::ListenerConfig& config, Worker::AddListenerCompletion) {
+        EXPECT_EQ(worker2_socket.get(), &config.socket());
+        EXPECT_EQ("foo", config.name());
+        EXPECT_EQ(manager_->listeners()[0].get().listenerTag(), config.listenerTag());
+      }));
+  EXPECT_CALL(*worker2_, start(_));
+  manager_->startWorkers(guard_dog_);
+
+  EXPECT_CALL(*listener_foo, onDestroy());
+}
+
+// Make sure that workers share a single socket when reuse_port is not set.
+TEST_F(ListenerManagerImplReusePortTest, SharedSocket) {
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, 0));
+  EXPECT_TRUE(manager_->addOrUpdateListener(reusePortListener(false), "", true));
+
+  const Network::Address::Instance& address = *listener_factory_.socket_->localAddress();
+  EXPECT_EQ(listener_factory_.socket_.get(), manager_->findListenSocket(address, 0));
+  EXPECT_EQ(nullptr, manager_->findListenSocket(address, 1));
+
+  EXPECT_CALL(*listener_foo, onDestroy());
+}
+
+// Make sure that reuse_port cannot be changed on update, since the sockets are handed over.
+TEST_F(ListenerManagerImplReusePortTest, UpdateReusePort) {
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _)).Times(2);
+  EXPECT_TRUE(manager_->addOrUpdateListener(reusePortListener(true), "", true));
+
+  ListenerHandle* listener_foo_update = expectListenerCreate(false);
+  EXPECT_CALL(*listener_foo_update, onDestroy());
+  EXPECT_THROW_WITH_MESSAGE(
+      manager_->addOrUpdateListener(reusePortListener(false), "", true), EnvoyException,
+      "error updating listener: 'foo' has a different reuse_port setting from existing listener");
+
+  EXPECT_CALL(*listener_foo, onDestroy());
+}
+
+// Make sure that the workers are pinned to the configured CPUs, and that the reuse_port socket of
+// each worker is given the CPU of its worker.
+TEST_F(ListenerManagerImplReusePortTest, WorkerCpus) {
+  manager_.reset();
+  worker_ = new MockWorker();
+  worker2_ = new MockWorker();
+  server_.options_.worker_cpus_ = {4, 6};
+  EXPECT_CALL(worker_factory_, createWorker_(absl::optional<uint32_t>(4)))
+      .WillOnce(Return(worker_));
+  EXPECT_CALL(worker_factory_, createWorker_(absl::optional<uint32_t>(6)))
+      .WillOnce(Return(worker2_));
+  manager_ =
+      std::make_unique<ListenerManagerImpl>(server_, listener_factory_, worker_factory_, false);
+
+  // The CPU the options of a socket give it, if any.
+  auto incoming_cpu = [this](const Network::Socket::OptionsSharedPtr& options) {
+    absl::optional<int> cpu;
+    for (const auto& option : *options) {
+      const auto details = option->getOptionDetails(
+          *listener_factory_.socket_, envoy::api::v2::core::SocketOption::STATE_PREBIND);
+      if (details.has_value() && details->name_ == ENVOY_SOCKET_SO_INCOMING_CPU) {
+        int value;
+        memcpy(&value, details->value_.data(), sizeof(value));
+        cpu = value;
+      }
+    }
+    return cpu;
+  };
+  const absl::optional<int> expected_cpu_0 =
+      ENVOY_SOCKET_SO_INCOMING_CPU.has_value() ? absl::optional<int>(4) : absl::nullopt;
+  const absl::optional<int> expected_cpu_1 =
+      ENVOY_SOCKET_SO_INCOMING_CPU.has_value() ? absl::optional<int>(6) : absl::nullopt;
+
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  auto worker2_socket = std::make_shared<NiceMock<Network::MockListenSocket>>();
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, 0))
+      .WillOnce(Invoke([&](Network::Address::InstanceConstSharedPtr, Network::Address::SocketType,
+                           const Network::Socket::OptionsSharedPtr& options, bool,
+                           uint32_t) -> Network::SocketSharedPtr {
+        EXPECT_EQ(expected_cpu_0, incoming_cpu(options));
+        return listener_factory_.socket_;
+      }));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, 1))
+      .WillOnce(Invoke([&](Network::Address::InstanceConstSharedPtr, Network::Address::SocketType,
+                           const Network::Socket::OptionsSharedPtr& options, bool,
+                           uint32_t) -> Network::SocketSharedPtr {
+        EXPECT_EQ(expected_cpu_1, incoming_cpu(options));
+        return worker2_socket;
+      }));
+  EXPECT_TRUE(manager_->addOrUpdateListener(reusePortListener(true), "", true));
+
+  EXPECT_CALL(*listener_foo, onDestroy());
+}
+
 // Make sure that a listener that is not modifiable cannot be updated or removed.
 TEST_F(ListenerManagerImplTest, UpdateRemoveNotModifiableListener) {
   time_system_.setSystemTime(std::chrono::milliseconds(1001001001001));
@@ -631,7 +793,7 @@ TEST_F(ListenerManagerImplTest, UpdateRemoveNotModifiableListener) {
   )EOF";
 
   ListenerHandle* listener_foo = expectListenerCreate(false);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", false));
   checkStats(1, 0, 0, 0, 1, 0);
   checkConfigDump(R"EOF(
@@ -702,7 +864,7 @@ filter_chains: {}
   )EOF";
 
   ListenerHandle* listener_foo = expectListenerCreate(false);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_TRUE(
       manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_yaml), "version1", true));
   checkStats(1, 0, 0, 0, 1, 0);
@@ -844,7 +1006,7 @@ filter_chains: {}
   )EOF";
 
   ListenerHandle* listener_bar = expectListenerCreate(false);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_CALL(*worker_, addListener(_, _));
   EXPECT_TRUE(
       manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_bar_yaml), "version4", true));
@@ -865,7 +1027,7 @@ filter_chains: {}
   )EOF";
 
   ListenerHandle* listener_baz = expectListenerCreate(true);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_CALL(listener_baz->target_, initialize());
   EXPECT_TRUE(
       manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_baz_yaml), "version5", true));
@@ -971,7 +1133,7 @@ TEST_F(ListenerManagerImplTest, AddDrainingListener) {
   ON_CALL(*listener_factory_.socket_, localAddress()).WillByDefault(ReturnRef(local_address));
 
   ListenerHandle* listener_foo = expectListenerCreate(false);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_CALL(*worker_, addListener(_, _));
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", true));
   worker_->callAddCompletion(true);
@@ -1015,7 +1177,7 @@ TEST_F(ListenerManagerImplTest, CantBindSocket) {
   )EOF";
 
   ListenerHandle* listener_foo = expectListenerCreate(true);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true))
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _))
       .WillOnce(Throw(EnvoyException("can't bind")));
   EXPECT_CALL(*listener_foo, onDestroy());
   EXPECT_THROW(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", true),
@@ -1037,7 +1199,7 @@ TEST_F(ListenerManagerImplTest, ListenerDraining) {
   )EOF";
 
   ListenerHandle* listener_foo = expectListenerCreate(false);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_CALL(*worker_, addListener(_, _));
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", true));
   worker_->callAddCompletion(true);
@@ -1070,6 +1232,93 @@ TEST_F(ListenerManagerImplTest, ListenerDraining) {
   checkStats(1, 0, 1, 0, 0, 0);
 }
 
+// An update that only changes filter chains keeps the workers' listener and the unchanged filter
+// chains, and only drains the connections on the removed filter chains.
+TEST_F(ListenerManagerImplTest, FilterChainOnlyUpdate) {
+  InSequence s;
+
+  EXPECT_CALL(*worker_, start(_));
+  manager_->startWorkers(guard_dog_);
+
+  const std::string listener_foo_yaml = R"EOF(
+name: foo
+address:
+  socket_address: { address: 127.0.0.1, port_value: 1234 }
+filter_chains:
+- filter_chain_match: { destination_port: 8080 }
+  )EOF";
+
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
+  EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_yaml), "", true));
+  worker_->callAddCompletion(true);
+  const uint64_t listener_tag = manager_->listeners().front().get().listenerTag();
+
+  // Add a filter chain. Only the new filter chain is created, and the old listener is released
+  // after a worker round trip.
+  const std::string listener_foo_update1_yaml = R"EOF(
+name: foo
+address:
+  socket_address: { address: 127.0.0.1, port_value: 1234 }
+filter_chains:
+- filter_chain_match: { destination_port: 8080 }
+- filter_chain_match: { destination_port: 8081 }
+  )EOF";
+
+  ListenerHandle* listener_foo_update1 = expectListenerCreate(false);
+  EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_CALL(*worker_, removeFilterChains(listener_tag, std::list<const Network::FilterChain*>{},
+                                           _));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_update1_yaml),
+                                            "", true));
+  worker_->callAddCompletion(true);
+  checkStats(1, 1, 0, 0, 1, 0);
+  EXPECT_EQ(listener_tag, manager_->listeners().front().get().listenerTag());
+  EXPECT_EQ(1UL,
+            server_.stats_store_.counter("listener_manager.listener_in_place_updated").value());
+  worker_->callRemoveFilterChainsCompletion();
+
+  // The unchanged filter chain now drains with the updated listener.
+  EXPECT_CALL(*listener_foo_update1->drain_manager_, drainClose()).WillOnce(Return(true));
+  EXPECT_TRUE(listener_foo->context_->drainDecision().drainClose());
+
+  // Remove the first filter chain, which drains and then closes its connections.
+  const std::string listener_foo_update2_yaml = R"EOF(
+name: foo
+address:
+  socket_address: { address: 127.0.0.1, port_value: 1234 }
+filter_chains:
+- filter_chain_match: { destination_port: 8081 }
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createDrainManager_(_)).WillOnce(Return(new MockDrainManager()));
+  EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_CALL(*listener_foo_update1->drain_manager_, startDrainSequence(_));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_update2_yaml),
+                                            "", true));
+  worker_->callAddCompletion(true);
+  checkStats(1, 2, 0, 0, 1, 0);
+  EXPECT_EQ(1UL,
+            server_.stats_store_.gauge("listener_manager.total_filter_chains_draining").value());
+
+  EXPECT_CALL(*worker_, removeFilterChains(listener_tag, _, _))
+      .WillOnce(Invoke([this](uint64_t, const std::list<const Network::FilterChain*>& filter_chains,
+                              std::function<void()> completion) -> void {
+        EXPECT_EQ(1UL, filter_chains.size());
+        worker_->remove_filter_chains_completion_ = completion;
+      }));
+  listener_foo_update1->drain_manager_->drain_sequence_completion_();
+  EXPECT_CALL(*listener_foo, onDestroy());
+  worker_->callRemoveFilterChainsCompletion();
+  EXPECT_EQ(0UL,
+            server_.stats_store_.gauge("listener_manager.total_filter_chains_draining").value());
+  EXPECT_EQ(2UL,
+            server_.stats_store_.counter("listener_manager.listener_in_place_updated").value());
+
+  EXPECT_CALL(*listener_foo_update1, onDestroy());
+}
+
 TEST_F(ListenerManagerImplTest, RemoveListener) {
   InSequence s;
 
@@ -1089,7 +1338,7 @@ TEST_F(ListenerManagerImplTest, RemoveListener) {
   )EOF";
 
   ListenerHandle* listener_foo = expectListenerCreate(true);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_CALL(listener_foo->target_, initialize());
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", true));
   EXPECT_EQ(0UL, manager_->listeners().size());
@@ -1103,7 +1352,7 @@ TEST_F(ListenerManagerImplTest, RemoveListener) {
 
   // Add foo again and initialize it.
   listener_foo = expectListenerCreate(true);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_CALL(listener_foo->target_, initialize());
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", true));
   checkStats(2, 0, 1, 1, 0, 0);
@@ -1162,7 +1411,7 @@ TEST_F(ListenerManagerImplTest, AddListenerFailure) {
   )EOF";
 
   ListenerHandle* listener_foo = expectListenerCreate(false);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   EXPECT_CALL(*worker_, addListener(_, _));
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", true));
 
@@ -1211,7 +1460,7 @@ TEST_F(ListenerManagerImplTest, DuplicateAddressDontBind) {
   )EOF";
 
   ListenerHandle* listener_foo = expectListenerCreate(true);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, false));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, false, _));
   EXPECT_CALL(listener_foo->target_, initialize());
   EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), "", true));
 
@@ -1274,7 +1523,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SingleFilterChainWithDestinationP
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1320,7 +1569,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SingleFilterChainWithDestinationI
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1366,7 +1615,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SingleFilterChainWithServerNamesM
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1412,7 +1661,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SingleFilterChainWithTransportPro
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1454,7 +1703,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SingleFilterChainWithApplicationP
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1496,7 +1745,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SingleFilterChainWithSourceTypeMa
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1564,7 +1813,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, MultipleFilterChainWithSourceType
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1640,7 +1889,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, MultipleFilterChainsWithDestinati
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1721,7 +1970,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, MultipleFilterChainsWithDestinati
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1811,7 +2060,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, MultipleFilterChainsWithServerNam
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1881,7 +2130,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, MultipleFilterChainsWithTransport
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1925,7 +2174,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, MultipleFilterChainsWithApplicati
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -1971,7 +2220,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, MultipleFilterChainsWithMultipleR
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -2037,7 +2286,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, MultipleFilterChainsWithDifferent
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 }
@@ -2072,7 +2321,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest,
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 }
@@ -2169,7 +2418,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, TlsFilterChainWithoutTlsInspector
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -2196,7 +2445,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SniFilterChainWithoutTlsInspector
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -2223,7 +2472,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, AlpnFilterChainWithoutTlsInspecto
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -2251,7 +2500,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, CustomTransportProtocolWithSniWit
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -2287,7 +2536,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, TlsCertificateInline) {
   )EOF");
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 }
@@ -2309,7 +2558,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, TlsCertificateChainInlinePrivateK
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 }
@@ -2450,7 +2699,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, OriginalDstFilter) {
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -2540,7 +2789,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, OriginalDstTestFilter) {
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -2612,7 +2861,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, OriginalDstTestFilterOptionFail)
   )EOF",
                                                        Network::Address::IpVersion::v4);
 
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
 
   EXPECT_THROW_WITH_MESSAGE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true),
                             EnvoyException,
@@ -2683,7 +2932,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, OriginalDstTestFilterIPv6) {
                                                        Network::Address::IpVersion::v6);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 
@@ -2755,7 +3004,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, OriginalDstTestFilterOptionFailIP
   )EOF",
                                                        Network::Address::IpVersion::v6);
 
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
 
   EXPECT_THROW_WITH_MESSAGE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true),
                             EnvoyException,
@@ -2774,10 +3023,10 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, TransparentFreebindListenerDisabl
     - filters:
   )EOF",
                                                        Network::Address::IpVersion::v4);
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true))
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _))
       .WillOnce(Invoke([&](Network::Address::InstanceConstSharedPtr, Network::Address::SocketType,
-                           const Network::Socket::OptionsSharedPtr& options,
-                           bool) -> Network::SocketSharedPtr {
+                           const Network::Socket::OptionsSharedPtr& options, bool,
+                           uint32_t) -> Network::SocketSharedPtr {
         EXPECT_EQ(options, nullptr);
         return listener_factory_.socket_;
       }));
@@ -2828,6 +3077,126 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, FastOpenListenerEnabled) {
                    ENVOY_SOCKET_TCP_FASTOPEN, /* expected_value */ 1);
 }
 
+// Validate that when reuse_port is set in the Listener, we see the socket option
+// propagated to setsockopt().
+TEST_F(ListenerManagerImplWithRealFiltersTest, ReusePortListenerEnabled) {
+  auto listener = createIPv4Listener("ReusePortListener");
+  listener.set_reuse_port(true);
+
+  testSocketOption(listener, envoy::api::v2::core::SocketOption::STATE_PREBIND,
+                   ENVOY_SOCKET_SO_REUSEPORT, /* expected_value */ 1);
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, ReusePortPipeListener) {
+  const std::string yaml = R"EOF(
+    name: foo
+    address:
+      pipe:
+        path: /foo
+    reuse_port: true
+    filter_chains:
+    - filters:
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(
+      manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true), EnvoyException,
+      "error adding listener '/foo': reuse_port is only supported for IP listeners");
+}
+
+// Validate that reuse_port_steering attaches the steering program once the socket is bound.
+TEST_F(ListenerManagerImplWithRealFiltersTest, ReusePortSteeringUdpListener) {
+  const std::string yaml = R"EOF(
+    name: foo
+    address:
+      socket_address: { protocol: UDP, address: 127.0.0.1, port_value: 1234 }
+    reuse_port: true
+    reuse_port_steering: { flow_key: QUIC_CONNECTION_ID }
+    filter_chains:
+    - filters:
+  )EOF";
+
+  const auto expected_option = ENVOY_SOCKET_SO_ATTACH_REUSEPORT_CBPF;
+  if (!expected_option.has_value()) {
+    return;
+  }
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  EXPECT_CALL(listener_factory_,
+              createListenSocket(_, Network::Address::SocketType::Datagram, _, true, 0));
+  EXPECT_CALL(os_sys_calls, setsockopt_(_, expected_option.value().first,
+                                        expected_option.value().second, _, _))
+      .WillOnce(Return(0));
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+  EXPECT_EQ(1U, manager_->listeners().size());
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, ReusePortSteeringTcpListener) {
+  const std::string yaml = R"EOF(
+    name: foo
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    reuse_port: true
+    reuse_port_steering: { flow_key: SOURCE_IP }
+    filter_chains:
+    - filters:
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true),
+                            EnvoyException,
+                            "error adding listener '127.0.0.1:1234': reuse_port_steering is only "
+                            "supported for UDP listeners that use reuse_port");
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, ReusePortSteeringWithoutReusePort) {
+  const std::string yaml = R"EOF(
+    name: foo
+    address:
+      socket_address: { protocol: UDP, address: 127.0.0.1, port_value: 1234 }
+    reuse_port_steering: { flow_key: SOURCE_IP }
+    filter_chains:
+    - filters:
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true),
+                            EnvoyException,
+                            "error adding listener '127.0.0.1:1234': reuse_port_steering is only "
+                            "supported for UDP listeners that use reuse_port");
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, ExactConnectionBalanceConfig) {
+  const std::string yaml = R"EOF(
+    name: foo
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    connection_balance_config:
+      exact_balance: {}
+    filter_chains:
+    - filters:
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+  ASSERT_EQ(1U, manager_->listeners().size());
+  EXPECT_NE(nullptr, dynamic_cast<Network::ExactConnectionBalancerImpl*>(
+                         &manager_->listeners().front().get().connectionBalancer()));
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, DefaultConnectionBalanceConfig) {
+  const std::string yaml = R"EOF(
+    name: foo
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    filter_chains:
+    - filters:
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+  ASSERT_EQ(1U, manager_->listeners().size());
+  EXPECT_NE(nullptr, dynamic_cast<Network::NopConnectionBalancerImpl*>(
+                         &manager_->listeners().front().get().connectionBalancer()));
+}
+
 TEST_F(ListenerManagerImplWithRealFiltersTest, LiteralSockoptListenerEnabled) {
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
@@ -2879,7 +3248,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, AddressResolver) {
 
   Registry::InjectFactory<Network::Address::Resolver> register_resolver(mock_resolver);
 
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 }
@@ -2901,7 +3270,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, CRLFilename) {
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 }
@@ -2926,7 +3295,7 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, CRLInline) {
                                                        Network::Address::IpVersion::v4);
 
   EXPECT_CALL(server_.random_, uuid());
-  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, true, _));
   manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
   EXPECT_EQ(1U, manager_->listeners().size());
 }
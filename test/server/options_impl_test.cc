@@ -41,7 +41,7 @@ public:
       argv.push_back(s.c_str());
     }
     return std::make_unique<OptionsImpl>(argv.size(), argv.data(),
-                                         [](uint64_t, uint64_t, bool) { return "1"; },
+                                         [](uint64_t, uint64_t, bool, bool) { return "1"; },
                                          spdlog::level::warn);
   }
 };
@@ -74,9 +74,10 @@ TEST_F(OptionsImplTest, All) {
       "envoy --mode validate --concurrency 2 -c hello --admin-address-path path --restart-epoch 1 "
       "--local-address-ip-version v6 -l info --component-log-level upstream:debug,connection:trace "
       "--service-cluster cluster --service-node node --service-zone zone "
-      "--file-flush-interval-msec 9000 "
-      "--drain-time-s 60 --log-format [%v] --parent-shutdown-time-s 90 --log-path /foo/bar "
-      "--disable-hot-restart --cpuset-threads");
+      "--file-flush-interval-msec 9000 --file-max-buffered-bytes 1048576 "
+      "--drain-time-s 60 --drain-rate-per-worker 100 --log-format [%v] --parent-shutdown-time-s 90 "
+      "--log-path /foo/bar --worker-cpus 0-2,8 "
+      "--disable-hot-restart --hot-restart-stats-transfer --cpuset-threads");
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ(2U, options->concurrency());
   EXPECT_EQ("hello", options->configPath());
@@ -91,10 +92,13 @@ TEST_F(OptionsImplTest, All) {
   EXPECT_EQ("node", options->serviceNodeName());
   EXPECT_EQ("zone", options->serviceZone());
   EXPECT_EQ(std::chrono::milliseconds(9000), options->fileFlushIntervalMsec());
+  EXPECT_EQ(1048576U, options->fileMaxBufferedBytes());
   EXPECT_EQ(std::chrono::seconds(60), options->drainTime());
+  EXPECT_EQ(100U, options->drainRatePerWorker());
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 2, 8}), options->workerCpus());
   EXPECT_EQ(std::chrono::seconds(90), options->parentShutdownTime());
   EXPECT_EQ(true, options->hotRestartDisabled());
-  EXPECT_EQ(true, options->libeventBufferEnabled());
+  EXPECT_EQ(true, options->hotRestartStatsTransfer());
   EXPECT_EQ(true, options->cpusetThreadsEnabled());
 
   options = createOptionsImpl("envoy --mode init_only");
@@ -123,6 +127,9 @@ TEST_F(OptionsImplTest, SetAll) {
   options->setParentShutdownTime(std::chrono::seconds(43));
   options->setRestartEpoch(44);
   options->setFileFlushIntervalMsec(std::chrono::milliseconds(45));
+  options->setFileMaxBufferedBytes(4096);
+  options->setDrainRatePerWorker(46);
+  options->setWorkerCpus({4, 5});
   options->setMode(Server::Mode::Validate);
   options->setServiceClusterName("cluster_foo");
   options->setServiceNodeName("node_foo");
@@ -130,6 +137,7 @@ TEST_F(OptionsImplTest, SetAll) {
   options->setMaxStats(12345);
   options->setStatsOptions(stats_options);
   options->setHotRestartDisabled(!options->hotRestartDisabled());
+  options->setHotRestartStatsTransfer(true);
   options->setSignalHandling(!options->signalHandlingEnabled());
   options->setCpusetThreads(!options->cpusetThreadsEnabled());
 
@@ -146,6 +154,9 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(std::chrono::seconds(43), options->parentShutdownTime());
   EXPECT_EQ(44, options->restartEpoch());
   EXPECT_EQ(std::chrono::milliseconds(45), options->fileFlushIntervalMsec());
+  EXPECT_EQ(4096U, options->fileMaxBufferedBytes());
+  EXPECT_EQ(46U, options->drainRatePerWorker());
+  EXPECT_EQ(std::vector<uint32_t>({4, 5}), options->workerCpus());
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ("cluster_foo", options->serviceClusterName());
   EXPECT_EQ("node_foo", options->serviceNodeName());
@@ -154,6 +165,7 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(stats_options.max_obj_name_length_, options->statsOptions().maxObjNameLength());
   EXPECT_EQ(stats_options.max_stat_suffix_length_, options->statsOptions().maxStatSuffixLength());
   EXPECT_EQ(!hot_restart_disabled, options->hotRestartDisabled());
+  EXPECT_TRUE(options->hotRestartStatsTransfer());
   EXPECT_EQ(!signal_handling_enabled, options->signalHandlingEnabled());
   EXPECT_EQ(!cpuset_threads_enabled, options->cpusetThreadsEnabled());
 
@@ -178,6 +190,9 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(options->restartEpoch(), command_line_options->restart_epoch());
   EXPECT_EQ(options->fileFlushIntervalMsec().count() / 1000,
             command_line_options->file_flush_interval().seconds());
+  EXPECT_EQ(options->fileMaxBufferedBytes(), command_line_options->file_max_buffered_bytes());
+  EXPECT_EQ(options->drainRatePerWorker(), command_line_options->drain_rate_per_worker());
+  EXPECT_EQ("4,5", command_line_options->worker_cpus());
   EXPECT_EQ(envoy::admin::v2alpha::CommandLineOptions::Validate, command_line_options->mode());
   EXPECT_EQ(options->serviceClusterName(), command_line_options->service_cluster());
   EXPECT_EQ(options->serviceNodeName(), command_line_options->service_node());
@@ -185,6 +200,7 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(options->maxStats(), command_line_options->max_stats());
   EXPECT_EQ(options->statsOptions().maxObjNameLength(), command_line_options->max_obj_name_len());
   EXPECT_EQ(options->hotRestartDisabled(), command_line_options->disable_hot_restart());
+  EXPECT_EQ(options->hotRestartStatsTransfer(), command_line_options->hot_restart_stats_transfer());
   EXPECT_EQ(options->mutexTracingEnabled(), command_line_options->enable_mutex_tracing());
   EXPECT_EQ(options->cpusetThreadsEnabled(), command_line_options->cpuset_threads());
 }
@@ -197,7 +213,11 @@ TEST_F(OptionsImplTest, DefaultParams) {
   EXPECT_EQ(Network::Address::IpVersion::v4, options->localAddressIpVersion());
   EXPECT_EQ(Server::Mode::Serve, options->mode());
   EXPECT_EQ(false, options->hotRestartDisabled());
+  EXPECT_EQ(false, options->hotRestartStatsTransfer());
   EXPECT_EQ(false, options->cpusetThreadsEnabled());
+  EXPECT_EQ(0U, options->fileMaxBufferedBytes());
+  EXPECT_EQ(0U, options->drainRatePerWorker());
+  EXPECT_TRUE(options->workerCpus().empty());
 
   // Validate that CommandLineOptions is constructed correctly with default params.
   Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
@@ -209,7 +229,9 @@ TEST_F(OptionsImplTest, DefaultParams) {
             command_line_options->local_address_ip_version());
   EXPECT_EQ(envoy::admin::v2alpha::CommandLineOptions::Serve, command_line_options->mode());
   EXPECT_EQ(false, command_line_options->disable_hot_restart());
+  EXPECT_EQ(false, command_line_options->hot_restart_stats_transfer());
   EXPECT_EQ(false, command_line_options->cpuset_threads());
+  EXPECT_EQ("", command_line_options->worker_cpus());
 }
 
 // Validates that the server_info proto is in sync with the options.
@@ -218,12 +240,11 @@ TEST_F(OptionsImplTest, OptionsAreInSyncWithProto) {
   Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
   // Failure of this condition indicates that the server_info proto is not in sync with the options.
   // If an option is added/removed, please update server_info proto as well to keep it in sync.
-  // Currently the following 4 options are not defined in proto, hence the count differs by 5.
+  // Currently the following 3 options are not defined in proto, hence the count differs by 3.
   // 1. version        - default TCLAP argument.
   // 2. help           - default TCLAP argument.
   // 3. ignore_rest    - default TCLAP argument.
-  // 4. use-libevent-buffers  - short-term override for rollout of new buffer implementation.
-  EXPECT_EQ(options->count() - 4, command_line_options->GetDescriptor()->field_count());
+  EXPECT_EQ(options->count() - 3, command_line_options->GetDescriptor()->field_count());
 }
 
 TEST_F(OptionsImplTest, BadCliOption) {
@@ -265,6 +286,18 @@ TEST_F(OptionsImplTest, InvalidComponent) {
                           "error: invalid component specified 'blah'");
 }
 
+TEST_F(OptionsImplTest, InvalidWorkerCpus) {
+  std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy --mode init_only");
+  EXPECT_THROW_WITH_REGEX(options->parseWorkerCpus("0-3,x"), MalformedArgvException,
+                          "error: invalid worker CPUs specified 'x'");
+  EXPECT_THROW_WITH_REGEX(options->parseWorkerCpus("3-1"), MalformedArgvException,
+                          "error: invalid worker CPUs specified '3-1'");
+  EXPECT_THROW_WITH_REGEX(options->parseWorkerCpus("0,,1"), MalformedArgvException,
+                          "error: invalid worker CPUs specified ''");
+  EXPECT_THROW_WITH_REGEX(options->parseWorkerCpus("0-4096"), MalformedArgvException,
+                          "error: invalid worker CPUs specified '0-4096'");
+}
+
 TEST_F(OptionsImplTest, InvalidLogLevel) {
   std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy --mode init_only");
   EXPECT_THROW_WITH_REGEX(options->parseComponentLogLevels("upstream:blah,connection:trace"),
@@ -306,6 +339,7 @@ TEST_F(OptionsImplTest, SaneTestConstructor) {
   EXPECT_EQ(regular_options_impl->localAddressIpVersion(),
             test_options_impl.localAddressIpVersion());
   EXPECT_EQ(regular_options_impl->drainTime(), test_options_impl.drainTime());
+  EXPECT_EQ(regular_options_impl->workerCpus(), test_options_impl.workerCpus());
   EXPECT_EQ(spdlog::level::level_enum::info, test_options_impl.logLevel());
   EXPECT_EQ(regular_options_impl->componentLogLevels(), test_options_impl.componentLogLevels());
   EXPECT_EQ(regular_options_impl->logPath(), test_options_impl.logPath());
@@ -322,6 +356,8 @@ TEST_F(OptionsImplTest, SaneTestConstructor) {
   EXPECT_EQ(regular_options_impl->statsOptions().maxStatSuffixLength(),
             test_options_impl.statsOptions().maxStatSuffixLength());
   EXPECT_EQ(regular_options_impl->hotRestartDisabled(), test_options_impl.hotRestartDisabled());
+  EXPECT_EQ(regular_options_impl->hotRestartStatsTransfer(),
+            test_options_impl.hotRestartStatsTransfer());
   EXPECT_EQ(regular_options_impl->cpusetThreadsEnabled(), test_options_impl.cpusetThreadsEnabled());
 }
 
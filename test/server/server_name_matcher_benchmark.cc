@@ -0,0 +1,82 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+#include <vector>
+
+#include "common/common/fmt.h"
+
+#include "server/server_name_matcher.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Server {
+
+namespace {
+
+// The number of exact server names and of wildcard domains of the filter chains, so that a
+// listener has 8k server names.
+constexpr uint32_t ServerNames = 4096;
+
+ServerNameMatcher<uint32_t> createMatcher() {
+  ServerNameMatcher<uint32_t> matcher;
+  for (uint32_t i = 0; i < ServerNames; i++) {
+    matcher[fmt::format("www.tenant{}.example{}.com", i, i % 16)] = i;
+    matcher[fmt::format("*.tenant{}.example{}.net", i, i % 16)] = i;
+  }
+  matcher[""] = ServerNames;
+  return matcher;
+}
+
+void lookup(benchmark::State& state, const std::vector<std::string>& server_names) {
+  const ServerNameMatcher<uint32_t> matcher = createMatcher();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(matcher.find(server_names[i++ % server_names.size()]));
+  }
+}
+
+} // namespace
+
+// Requested server names that are configured exactly.
+static void BM_ServerNameMatcherExact(benchmark::State& state) {
+  std::vector<std::string> server_names;
+  for (uint32_t i = 0; i < ServerNames; i++) {
+    server_names.push_back(fmt::format("www.tenant{}.example{}.com", i, i % 16));
+  }
+  lookup(state, server_names);
+}
+BENCHMARK(BM_ServerNameMatcherExact);
+
+// Requested server names matching a wildcard domain, several labels below it.
+static void BM_ServerNameMatcherWildcard(benchmark::State& state) {
+  std::vector<std::string> server_names;
+  for (uint32_t i = 0; i < ServerNames; i++) {
+    server_names.push_back(fmt::format("a.b.c.tenant{}.example{}.net", i, i % 16));
+  }
+  lookup(state, server_names);
+}
+BENCHMARK(BM_ServerNameMatcherWildcard);
+
+// Requested server names matching no configured name, which fall back to the catch-all.
+static void BM_ServerNameMatcherCatchAll(benchmark::State& state) {
+  std::vector<std::string> server_names;
+  for (uint32_t i = 0; i < ServerNames; i++) {
+    server_names.push_back(fmt::format("a.b.c.tenant{}.example{}.org", i, i % 16));
+  }
+  lookup(state, server_names);
+}
+BENCHMARK(BM_ServerNameMatcherCatchAll);
+
+} // namespace Server
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,61 @@
+#include <string>
+
+#include "server/server_name_matcher.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Server {
+namespace {
+
+std::string match(const ServerNameMatcher<std::string>& matcher, absl::string_view server_name) {
+  const std::string* value = matcher.find(server_name);
+  return value != nullptr ? *value : "none";
+}
+
+TEST(ServerNameMatcherTest, MostSpecificMatch) {
+  ServerNameMatcher<std::string> matcher;
+  matcher["www.example.com"] = "exact";
+  matcher["*.example.com"] = "wildcard";
+  matcher["*.com"] = "tld";
+
+  EXPECT_EQ("exact", match(matcher, "www.example.com"));
+  EXPECT_EQ("wildcard", match(matcher, "api.example.com"));
+  EXPECT_EQ("wildcard", match(matcher, "a.b.example.com"));
+  EXPECT_EQ("tld", match(matcher, "example.com"));
+  EXPECT_EQ("tld", match(matcher, "www.example2.com"));
+  EXPECT_EQ("none", match(matcher, "www.example.org"));
+  EXPECT_EQ("none", match(matcher, ""));
+
+  matcher[""] = "any";
+  EXPECT_EQ("any", match(matcher, "www.example.org"));
+  EXPECT_EQ("any", match(matcher, ""));
+}
+
+// Wildcard domains match neither the whole name nor a trailing dot, and they aren't exact names.
+TEST(ServerNameMatcherTest, WildcardBoundaries) {
+  ServerNameMatcher<std::string> matcher;
+  matcher["*.example.com"] = "wildcard";
+  matcher["*."] = "dot";
+
+  EXPECT_EQ("none", match(matcher, ".example.com"));
+  EXPECT_EQ("none", match(matcher, "*.example.com"));
+  EXPECT_EQ("none", match(matcher, "example."));
+  EXPECT_EQ("none", match(matcher, "example.com"));
+  EXPECT_EQ("wildcard", match(matcher, "www.example.com"));
+}
+
+// Suffixes shorter or longer than every wildcard domain are skipped without changing the match.
+TEST(ServerNameMatcherTest, WildcardLengths) {
+  ServerNameMatcher<std::string> matcher;
+  matcher["*.b.example.com"] = "long";
+  matcher["*.example.com"] = "short";
+
+  EXPECT_EQ("long", match(matcher, "x.y.z.b.example.com"));
+  EXPECT_EQ("short", match(matcher, "x.y.z.c.example.com"));
+  EXPECT_EQ("none", match(matcher, "x.y.z.b.example.org"));
+}
+
+} // namespace
+} // namespace Server
+} // namespace Envoy
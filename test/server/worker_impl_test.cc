@@ -2,10 +2,13 @@
 #include "common/event/dispatcher_impl.h"
 
 #include "server/worker_impl.h"
+#include "server/worker_impl_platform.h"
 
+#include "test/mocks/api/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -28,7 +31,7 @@ public:
       : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher()),
         no_exit_timer_(dispatcher_->createTimer([]() -> void {})),
         worker_(tls_, hooks_, std::move(dispatcher_), Network::ConnectionHandlerPtr{handler_},
-                overload_manager_, *api_) {
+                overload_manager_, *api_, absl::nullopt) {
     // In the real worker the watchdog has timers that prevent exit. Here we need to prevent event
     // loop exit since we use mock timers.
     no_exit_timer_->enableTimer(std::chrono::hours(1));
@@ -106,6 +109,17 @@ TEST_F(WorkerImplTest, BasicFlow) {
   });
   ci.waitReady();
 
+  EXPECT_CALL(*handler_, removeFilterChains(1, _))
+      .WillOnce(Invoke([current_thread_id](uint64_t,
+                                           const std::list<const Network::FilterChain*>&) -> void {
+        EXPECT_NE(current_thread_id, std::this_thread::get_id());
+      }));
+  worker_.removeFilterChains(1, {}, [current_thread_id, &ci]() -> void {
+    EXPECT_NE(current_thread_id, std::this_thread::get_id());
+    ci.setReady();
+  });
+  ci.waitReady();
+
   // Now test adding and removing a listener without stopping it first.
   NiceMock<Network::MockListenerConfig> listener3;
   ON_CALL(listener3, listenerTag()).WillByDefault(Return(3UL));
@@ -144,6 +158,25 @@ TEST_F(WorkerImplTest, ListenerException) {
   worker_.stop();
 }
 
+#if defined(__linux__)
+TEST(WorkerImplPlatformLinuxTest, PinCurrentThread) {
+  Api::MockLinuxOsSysCalls linux_os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::LinuxOsSysCallsImpl> linux_os_calls(&linux_os_sys_calls);
+
+  EXPECT_CALL(linux_os_sys_calls, sched_setaffinity(0, sizeof(cpu_set_t), _))
+      .WillOnce(Invoke([](pid_t, size_t, const cpu_set_t* mask) -> Api::SysCallIntResult {
+        EXPECT_EQ(1, CPU_COUNT(mask));
+        EXPECT_TRUE(CPU_ISSET(3, mask));
+        return {0, 0};
+      }))
+      .WillOnce(Return(Api::SysCallIntResult{-1, EINVAL}));
+  EXPECT_TRUE(WorkerImplPlatform::pinCurrentThread(3));
+  EXPECT_FALSE(WorkerImplPlatform::pinCurrentThread(3));
+  // CPUs that don't fit in a cpu_set_t aren't passed to the kernel.
+  EXPECT_FALSE(WorkerImplPlatform::pinCurrentThread(CPU_SETSIZE));
+}
+#endif
+
 } // namespace
 } // namespace Server
 } // namespace Envoy